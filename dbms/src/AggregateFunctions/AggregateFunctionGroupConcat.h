@@ -16,6 +16,7 @@
 
 #include <AggregateFunctions/AggregateFunctionGroupUniqArray.h>
 #include <AggregateFunctions/AggregateFunctionNull.h>
+#include <IO/WriteBufferFromVector.h>
 
 
 namespace DB
@@ -49,10 +50,23 @@ public:
 
         number_of_concat_items = all_columns_names_and_types.size() - sort_desc.size();
 
+        /// Without order and distinct, the result is the first rows collected until `max_len` is reached, the later rows
+        /// can be dropped at once.
+        stop_early = sort_desc.empty() && !has_distinct;
+        length_offset = (this->prefix_size + this->nested_function->sizeOfData() + alignof(UInt64) - 1) / alignof(UInt64) * alignof(UInt64);
+
         is_nullable.resize(number_of_concat_items);
+        min_text_sizes.resize(number_of_concat_items);
         for (size_t i = 0; i < number_of_concat_items; ++i)
         {
             is_nullable[i] = all_columns_names_and_types[i].type->isNullable();
+            auto type = removeNullable(all_columns_names_and_types[i].type);
+            if (type->isStringOrFixedString())
+                min_text_sizes[i] = -1;
+            else if (type->isNumber() || type->isDecimal())
+                min_text_sizes[i] = 1;
+            else
+                min_text_sizes[i] = 0;
             /// the inputs of a nested agg reject null, but for more than one args, tuple(args...) is already not nullable,
             /// so here just remove null for the only_one_column case
             if constexpr (only_one_column)
@@ -106,6 +120,22 @@ public:
             : ret_type;
     }
 
+    size_t sizeOfData() const override
+    {
+        return length_offset + sizeof(UInt64);
+    }
+
+    size_t alignOfData() const override
+    {
+        return std::max(this->nested_function->alignOfData(), alignof(UInt64));
+    }
+
+    void create(AggregateDataPtr __restrict place) const override
+    {
+        AggregateFunctionNullBase<result_is_nullable, AggregateFunctionGroupConcat<result_is_nullable, only_one_column>>::create(place);
+        collectedLength(place) = 0;
+    }
+
     /// reject nulls before add() of nested agg
     void add(AggregateDataPtr __restrict place, const IColumn ** columns, size_t row_num, Arena * arena) const override
     {
@@ -118,7 +148,7 @@ public:
                 {
                     this->setFlag(place);
                     const IColumn * nested_column = &column->getNestedColumn();
-                    this->nested_function->add(this->nestedPlace(place), &nested_column, row_num, arena);
+                    addNotNull(place, &nested_column, row_num, arena);
                 }
                 return;
             }
@@ -142,7 +172,37 @@ public:
             }
         }
         this->setFlag(place);
-        this->nested_function->add(this->nestedPlace(place), columns, row_num, arena);
+        addNotNull(place, columns, row_num, arena);
+    }
+
+    void merge(AggregateDataPtr __restrict place, ConstAggregateDataPtr rhs, Arena * arena) const override
+    {
+        if (stop_early)
+        {
+            /// The rows of `place` come first, nothing of `rhs` is needed once they reach `max_len`.
+            UInt64 & length = collectedLength(place);
+            if (length >= max_len)
+            {
+                if (this->getFlag(rhs))
+                    this->setFlag(place);
+                return;
+            }
+            UInt64 rhs_length = collectedLength(rhs);
+            length += (length > 0 && rhs_length > 0 ? separator.size() : 0) + rhs_length;
+        }
+        AggregateFunctionNullBase<result_is_nullable, AggregateFunctionGroupConcat<result_is_nullable, only_one_column>>::merge(place, rhs, arena);
+    }
+
+    void serialize(ConstAggregateDataPtr __restrict place, WriteBuffer & buf) const override
+    {
+        AggregateFunctionNullBase<result_is_nullable, AggregateFunctionGroupConcat<result_is_nullable, only_one_column>>::serialize(place, buf);
+        writeVarUInt(collectedLength(place), buf);
+    }
+
+    void deserialize(AggregateDataPtr __restrict place, ReadBuffer & buf, Arena * arena) const override
+    {
+        AggregateFunctionNullBase<result_is_nullable, AggregateFunctionGroupConcat<result_is_nullable, only_one_column>>::deserialize(place, buf, arena);
+        readVarUInt(collectedLength(place), buf);
     }
 
     void insertResultInto(ConstAggregateDataPtr __restrict place, IColumn & to, Arena * arena) const override
@@ -209,6 +269,52 @@ public:
     }
 
 private:
+    /// A lower bound of the length of the text collected so far, only maintained if `stop_early`.
+    UInt64 & collectedLength(AggregateDataPtr __restrict place) const
+    {
+        return *reinterpret_cast<UInt64 *>(place + length_offset);
+    }
+
+    const UInt64 & collectedLength(ConstAggregateDataPtr __restrict place) const
+    {
+        return *reinterpret_cast<const UInt64 *>(place + length_offset);
+    }
+
+    /// add a row without nulls to the nested agg, unless the rows collected already reach `max_len`
+    void addNotNull(AggregateDataPtr __restrict place, const IColumn ** columns, size_t row_num, Arena * arena) const
+    {
+        if (stop_early)
+        {
+            UInt64 & length = collectedLength(place);
+            if (length >= max_len)
+                return;
+            if (length > 0)
+                length += separator.size();
+            if constexpr (only_one_column)
+            {
+                length += minTextSize(0, *columns[0], row_num);
+            }
+            else
+            {
+                const ColumnTuple & tuple = static_cast<const ColumnTuple &>(*columns[0]);
+                for (size_t i = 0; i < number_of_concat_items; ++i)
+                {
+                    const IColumn * column = &tuple.getColumn(i);
+                    if (is_nullable[i])
+                        column = &static_cast<const ColumnNullable *>(column)->getNestedColumn();
+                    length += minTextSize(i, *column, row_num);
+                }
+            }
+        }
+        this->nested_function->add(this->nestedPlace(place), columns, row_num, arena);
+    }
+
+    /// the text of a string is itself, and the text of a number has at least one char
+    size_t minTextSize(size_t i, const IColumn & column, size_t row_num) const
+    {
+        return min_text_sizes[i] < 0 ? column.getDataAt(row_num).size : min_text_sizes[i];
+    }
+
     /// construct a block to sort in the case with order-by requirement
     void sortColumns(Columns & nested_cols) const
     {
@@ -246,10 +352,12 @@ private:
         }
     }
 
-    /// write each column cell to string with separator
+    /// write each column cell to string with separator, directly into the chars of the result column
     void writeToStringColumn(const Columns & cols, ColumnString * const col_str, const std::vector<bool> & unique) const
     {
-        WriteBufferFromOwnString write_buffer;
+        auto & chars = col_str->getChars();
+        size_t old_chars_size = chars.size();
+        WriteBufferFromVector<ColumnString::Chars_t> write_buffer(chars, WriteBufferFromVector<ColumnString::Chars_t>::AppendModeTag());
         auto size = cols[0]->size();
         for (size_t i = 0; i < size; ++i)
         {
@@ -270,10 +378,16 @@ private:
                 break;
             }
         }
-        col_str->insertData(write_buffer.str().c_str(), std::min(max_len, write_buffer.count()));
+        size_t length = std::min(max_len, write_buffer.count());
+        write_buffer.finalize();
+        chars.resize(old_chars_size + length);
+        chars.push_back(0);
+        col_str->getOffsets().push_back(chars.size());
     }
 
     bool to_get_unique = false;
+    bool stop_early = false;
+    size_t length_offset = 0;
     DataTypePtr ret_type = std::make_shared<DataTypeString>();
     DataTypePtr nested_type;
     size_t number_of_concat_items = 0;
@@ -283,5 +397,7 @@ private:
     NamesAndTypes all_columns_names_and_types;
     TiDB::TiDBCollators collators;
     BoolVec is_nullable;
+    /// the lower bound of the text size of each concat item, -1 means the size of the string value
+    std::vector<Int8> min_text_sizes;
 };
 } // namespace DB
@@ -171,6 +171,47 @@ public:
             return false;
     }
 
+    /// Change to the min (or max) of the first `batch_size` rows not in `null_map`, if it is better.
+    /// The loops are branchless so that they are vectorized for the arithmetic types, see `SingleValueDataBatchTraits`.
+    template <bool is_less>
+    void changeIfBetterBatch(const IColumn & column, size_t batch_size, const UInt8 * __restrict null_map)
+    {
+        auto better = [](const T & a, const T & b) {
+            if constexpr (is_less)
+                return a < b;
+            else
+                return a > b;
+        };
+
+        const T * __restrict data = static_cast<const ColumnType &>(column).getData().data();
+        size_t i = 0;
+        if (null_map)
+        {
+            while (i < batch_size && null_map[i])
+                ++i;
+        }
+        if (i == batch_size)
+            return;
+
+        T best = data[i];
+        if (null_map)
+        {
+            for (++i; i < batch_size; ++i)
+                best = (!null_map[i] && better(data[i], best)) ? data[i] : best;
+        }
+        else
+        {
+            for (++i; i < batch_size; ++i)
+                best = better(data[i], best) ? data[i] : best;
+        }
+
+        if (!has() || better(best, value))
+        {
+            has_value = true;
+            value = best;
+        }
+    }
+
     bool isEqualTo(const Self & to) const
     {
         return has() && to.value == value;
@@ -636,6 +677,28 @@ struct AggregateFunctionMaxData : Data
     static const char * name() { return "max"; }
 };
 
+/// Whether `Data` can be updated by `changeIfBetterBatch`, and in which direction.
+/// Only the min and max of arithmetic values are vectorized, the other cases keep the row by row `changeIfBetter`.
+template <typename Data>
+struct SingleValueDataBatchTraits
+{
+    static constexpr bool value = false;
+};
+
+template <typename T>
+struct SingleValueDataBatchTraits<AggregateFunctionMinData<SingleValueDataFixed<T>>>
+{
+    static constexpr bool value = std::is_arithmetic_v<T>;
+    static constexpr bool is_less = true;
+};
+
+template <typename T>
+struct SingleValueDataBatchTraits<AggregateFunctionMaxData<SingleValueDataFixed<T>>>
+{
+    static constexpr bool value = std::is_arithmetic_v<T>;
+    static constexpr bool is_less = false;
+};
+
 template <typename Data>
 struct AggregateFunctionAnyData : Data
 {
@@ -769,6 +832,43 @@ public:
         this->data(place).changeIfBetter(*columns[0], row_num, arena);
     }
 
+    void addBatchSinglePlace(
+        size_t batch_size,
+        AggregateDataPtr place,
+        const IColumn ** columns,
+        Arena * arena,
+        ssize_t if_argument_pos) const override
+    {
+        if constexpr (SingleValueDataBatchTraits<Data>::value)
+        {
+            if (if_argument_pos < 0)
+            {
+                this->data(place).template changeIfBetterBatch<SingleValueDataBatchTraits<Data>::is_less>(*columns[0], batch_size, nullptr);
+                return;
+            }
+        }
+        IAggregateFunctionDataHelper<Data, AggregateFunctionsSingleValue<Data>, true>::addBatchSinglePlace(batch_size, place, columns, arena, if_argument_pos);
+    }
+
+    void addBatchSinglePlaceNotNull(
+        size_t batch_size,
+        AggregateDataPtr place,
+        const IColumn ** columns,
+        const UInt8 * null_map,
+        Arena * arena,
+        ssize_t if_argument_pos) const override
+    {
+        if constexpr (SingleValueDataBatchTraits<Data>::value)
+        {
+            if (if_argument_pos < 0)
+            {
+                this->data(place).template changeIfBetterBatch<SingleValueDataBatchTraits<Data>::is_less>(*columns[0], batch_size, null_map);
+                return;
+            }
+        }
+        IAggregateFunctionDataHelper<Data, AggregateFunctionsSingleValue<Data>, true>::addBatchSinglePlaceNotNull(batch_size, place, columns, null_map, arena, if_argument_pos);
+    }
+
     void merge(AggregateDataPtr __restrict place, ConstAggregateDataPtr rhs, Arena * arena) const override
     {
         this->data(place).changeIfBetter(this->data(rhs), arena);
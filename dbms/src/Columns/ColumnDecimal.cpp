@@ -291,7 +291,7 @@ void ColumnDecimal<T>::insertRangeFrom(const IColumn & src, size_t start, size_t
 #pragma GCC diagnostic pop
 
 template <typename T>
-ColumnPtr ColumnDecimal<T>::filter(const IColumn::Filter & filt, ssize_t result_size_hint) const
+ColumnPtr ColumnDecimal<T>::filter(const IColumn::Filter & filt, ssize_t /*result_size_hint*/) const
 {
     size_t size = data.size();
     if (size != filt.size())
@@ -300,17 +300,31 @@ ColumnPtr ColumnDecimal<T>::filter(const IColumn::Filter & filt, ssize_t result_
     auto res = this->create(0, scale);
     Container & res_data = res->getData();
 
-    if (result_size_hint)
-        res_data.reserve(result_size_hint > 0 ? result_size_hint : size);
+    /// The result is sized exactly by the selected rows, so the hint is not needed.
+    const auto selection = buildFilterSelection(filt);
+    res_data.resize(selection.selected_rows);
+    if (selection.selected_rows == size)
+    {
+        std::copy(data.begin(), data.end(), res_data.begin());
+        return res;
+    }
+
+    if (selection.isSparse())
+    {
+        for (size_t i = 0; i < selection.selected_rows; ++i)
+            res_data[i] = data[selection.indexes[i]];
+        return res;
+    }
 
     const UInt8 * filt_pos = filt.data();
     const UInt8 * filt_end = filt_pos + size;
     const T * data_pos = data.data();
+    T * res_pos = res_data.data();
 
     while (filt_pos < filt_end)
     {
         if (*filt_pos)
-            res_data.push_back(*data_pos);
+            *res_pos++ = *data_pos;
 
         ++filt_pos;
         ++data_pos;
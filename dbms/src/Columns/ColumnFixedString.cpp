@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Columns/ColumnFixedString.h>
+#include <Columns/ColumnsCommon.h>
 #include <Common/Arena.h>
 #include <Common/HashTable/Hash.h>
 #include <Common/SipHash.h>
@@ -195,7 +196,7 @@ void ColumnFixedString::insertRangeFrom(const IColumn & src, size_t start, size_
     memcpy(&chars[old_size], &src_concrete.chars[start * n], length * n);
 }
 
-ColumnPtr ColumnFixedString::filter(const IColumn::Filter & filt, ssize_t result_size_hint) const
+ColumnPtr ColumnFixedString::filter(const IColumn::Filter & filt, ssize_t /*result_size_hint*/) const
 {
     size_t col_size = size();
     if (col_size != filt.size())
@@ -203,8 +204,20 @@ ColumnPtr ColumnFixedString::filter(const IColumn::Filter & filt, ssize_t result
 
     auto res = ColumnFixedString::create(n);
 
-    if (result_size_hint)
-        res->chars.reserve(result_size_hint > 0 ? result_size_hint * n : chars.size());
+    const auto selection = buildFilterSelection(filt);
+    if (selection.isSparse())
+    {
+        res->chars.resize(selection.selected_rows * n);
+        UInt8 * res_pos = res->chars.data();
+        for (auto row : selection.indexes)
+        {
+            memcpy(res_pos, &chars[row * n], n);
+            res_pos += n;
+        }
+        return res;
+    }
+
+    res->chars.reserve(selection.selected_rows * n);
 
     const UInt8 * filt_pos = &filt[0];
     const UInt8 * filt_end = filt_pos + col_size;
@@ -14,6 +14,7 @@
 
 #include <Columns/ColumnConst.h>
 #include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsCommon.h>
 #include <Common/Arena.h>
 #include <Common/NaNUtils.h>
 #include <Common/SipHash.h>
@@ -30,6 +31,7 @@ namespace ErrorCodes
 extern const int LOGICAL_ERROR;
 extern const int ILLEGAL_COLUMN;
 extern const int SIZES_OF_NESTED_COLUMNS_ARE_INCONSISTENT;
+extern const int SIZES_OF_COLUMNS_DOESNT_MATCH;
 } // namespace ErrorCodes
 
 
@@ -247,6 +249,20 @@ void ColumnNullable::popBack(size_t n)
 
 ColumnPtr ColumnNullable::filter(const Filter & filt, ssize_t result_size_hint) const
 {
+    if (size() != filt.size())
+        throw Exception("Size of filter doesn't match size of column.", ErrorCodes::SIZES_OF_COLUMNS_DOESNT_MATCH);
+
+    /// Scan the filter once for both the nested column and the null map.
+    const auto selection = buildFilterSelection(filt);
+    if (selection.isSparse())
+    {
+        ColumnPtr filtered_data = getNestedColumn().permute(selection.indexes, selection.selected_rows);
+        ColumnPtr filtered_null_map = getNullMapColumn().permute(selection.indexes, selection.selected_rows);
+        return ColumnNullable::create(filtered_data, filtered_null_map);
+    }
+
+    if (result_size_hint)
+        result_size_hint = selection.selected_rows;
     ColumnPtr filtered_data = getNestedColumn().filter(filt, result_size_hint);
     ColumnPtr filtered_null_map = getNullMapColumn().filter(filt, result_size_hint);
     return ColumnNullable::create(filtered_data, filtered_null_map);
@@ -122,6 +122,31 @@ ColumnPtr ColumnString::filter(const Filter & filt, ssize_t result_size_hint) co
     Chars_t & res_chars = res->chars;
     Offsets & res_offsets = res->offsets;
 
+    if (offsets.size() != filt.size())
+        throw Exception("Size of filter doesn't match size of column.", ErrorCodes::SIZES_OF_COLUMNS_DOESNT_MATCH);
+
+    const auto selection = buildFilterSelection(filt);
+    if (selection.isSparse())
+    {
+        /// Size the result by the selected strings first, and then copy them without any reallocation.
+        res_offsets.resize(selection.selected_rows);
+        Offset res_offset = 0;
+        for (size_t i = 0; i < selection.selected_rows; ++i)
+        {
+            res_offset += sizeAt(selection.indexes[i]);
+            res_offsets[i] = res_offset;
+        }
+        res_chars.resize(res_offset);
+        for (size_t i = 0; i < selection.selected_rows; ++i)
+        {
+            size_t row = selection.indexes[i];
+            memcpy(&res_chars[res_offsets[i] - sizeAt(row)], &chars[offsetAt(row)], sizeAt(row));
+        }
+        return res;
+    }
+
+    if (result_size_hint)
+        result_size_hint = selection.selected_rows;
     filterArraysImpl<UInt8>(chars, offsets, res_chars, res_offsets, filt, result_size_hint);
     return res;
 }
@@ -17,6 +17,7 @@
 #include <Common/Exception.h>
 #include <Common/HashTable/Hash.h>
 #include <Common/NaNUtils.h>
+#include <Common/RadixSort.h>
 #include <Common/SipHash.h>
 #include <DataStreams/ColumnGathererStream.h>
 #include <IO/WriteHelpers.h>
@@ -119,17 +120,35 @@ struct ColumnVector<T>::greater
     bool operator()(size_t lhs, size_t rhs) const { return CompareHelper<T>::greater(parent.data[lhs], parent.data[rhs], nan_direction_hint); }
 };
 
+namespace
+{
+/// Radix sort is used for the integer keys of at least this many rows.
+constexpr size_t RADIX_SORT_MIN_ROWS = 256;
+}
+
 template <typename T>
 void ColumnVector<T>::getPermutation(bool reverse, size_t limit, int nan_direction_hint, IColumn::Permutation & res) const
 {
     size_t s = data.size();
     res.resize(s);
-    for (size_t i = 0; i < s; ++i)
-        res[i] = i;
 
     if (limit >= s)
         limit = 0;
 
+    if constexpr (std::is_integral_v<T> && sizeof(T) <= 8)
+    {
+        /// A small limit is served by the heap selection of `std::partial_sort` below, which only keeps `limit` rows
+        /// sorted. For a large one it is cheaper to radix sort all the rows.
+        if (s >= RADIX_SORT_MIN_ROWS && s <= std::numeric_limits<UInt32>::max() && (limit == 0 || limit * 16 >= s))
+        {
+            radixSortGetPermutation(data.data(), s, reverse, res.data());
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < s; ++i)
+        res[i] = i;
+
     if (limit)
     {
         if (reverse)
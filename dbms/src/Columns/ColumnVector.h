@@ -359,6 +359,11 @@ public:
         return this->template scatterImpl<Self>(num_columns, selector);
     }
 
+    void scatterTo(IColumn::ScatterColumns & columns, const IColumn::Selector & selector) const override
+    {
+        this->template scatterToImpl<Self>(columns, selector);
+    }
+
     void gather(ColumnGathererStream & gatherer_stream) override;
 
     bool canBeInsideNullable() const override { return true; }
@@ -18,6 +18,7 @@
 
 #include <Columns/ColumnsCommon.h>
 #include <Columns/IColumn.h>
+#include <Common/TargetSpecific.h>
 
 
 namespace DB
@@ -98,6 +99,84 @@ size_t countBytesInFilterWithNull(const IColumn::Filter & filt, const UInt8 * nu
     return count;
 }
 
+namespace
+{
+// Branch free, so that the cost does not depend on the pattern of the filter.
+TIFLASH_DECLARE_MULTITARGET_FUNCTION(
+    size_t,
+    filterToIndexesImpl,
+    (filt, size, indexes),
+    (const UInt8 * filt, size_t size, IColumn::Permutation::value_type * indexes),
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            indexes[count] = i;
+            count += filt[i] != 0;
+        }
+        return count;
+    })
+
+#ifdef TIFLASH_ENABLE_AVX512_SUPPORT
+TIFLASH_BEGIN_AVX512_SPECIFIC_CODE
+/// Compress the indexes of 16 filter bytes at a time. Each half is stored as a whole vector of 8 indexes, which
+/// is safe because `count <= i` and the stores end before `i + 16 <= size`.
+size_t filterToIndexesAVX512(const UInt8 * filt, size_t size, IColumn::Permutation::value_type * indexes)
+{
+    static_assert(sizeof(IColumn::Permutation::value_type) == sizeof(Int64));
+    size_t count = 0;
+    size_t i = 0;
+    const __m512i lane_offsets = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i half_offset = _mm512_set1_epi64(8);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(filt + i));
+        __mmask16 mask = _mm_test_epi8_mask(bytes, bytes);
+        if (mask == 0)
+            continue;
+        __m512i low_indexes = _mm512_add_epi64(_mm512_set1_epi64(static_cast<Int64>(i)), lane_offsets);
+        auto low_mask = static_cast<__mmask8>(mask & 0xFF);
+        auto high_mask = static_cast<__mmask8>(mask >> 8);
+        _mm512_storeu_si512(indexes + count, _mm512_maskz_compress_epi64(low_mask, low_indexes));
+        count += __builtin_popcount(low_mask);
+        _mm512_storeu_si512(indexes + count, _mm512_maskz_compress_epi64(high_mask, _mm512_add_epi64(low_indexes, half_offset)));
+        count += __builtin_popcount(high_mask);
+    }
+    for (; i < size; ++i)
+    {
+        indexes[count] = i;
+        count += filt[i] != 0;
+    }
+    return count;
+}
+TIFLASH_END_TARGET_SPECIFIC_CODE
+#endif
+} // namespace
+
+size_t filterToIndexes(const UInt8 * filt, size_t size, IColumn::Permutation::value_type * indexes)
+{
+#ifdef TIFLASH_ENABLE_AVX512_SUPPORT
+    if (TargetSpecific::AVX512Checker::runtimeSupport())
+        return filterToIndexesAVX512(filt, size, indexes);
+#endif
+    return filterToIndexesImpl(filt, size, indexes);
+}
+
+FilterSelection buildFilterSelection(const IColumn::Filter & filt)
+{
+    FilterSelection selection;
+    selection.selected_rows = countBytesInFilter(filt);
+    if (filt.size() < FILTER_SELECTION_MIN_ROWS || selection.selected_rows == 0
+        || selection.selected_rows * FILTER_SPARSE_RATIO >= filt.size())
+        return selection;
+
+    selection.sparse = true;
+    selection.indexes.resize(filt.size());
+    size_t count = filterToIndexes(filt.data(), filt.size(), selection.indexes.data());
+    selection.indexes.resize(count);
+    return selection;
+}
+
 std::vector<size_t> countColumnsSizeInSelector(IColumn::ColumnIndex num_columns, const IColumn::Selector & selector)
 {
     std::vector<size_t> counts(num_columns);
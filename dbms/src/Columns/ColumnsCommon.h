@@ -26,6 +26,32 @@ size_t countBytesInFilter(const UInt8 * filt, size_t sz);
 size_t countBytesInFilter(const IColumn::Filter & filt);
 size_t countBytesInFilterWithNull(const IColumn::Filter & filt, const UInt8 * null_map);
 
+/// Writes the indexes of the bytes of `filt` which are not zero to `indexes` in order, and returns the
+/// number of them. `indexes` must have room for `size` elements, as it may be written beyond the result.
+size_t filterToIndexes(const UInt8 * filt, size_t size, IColumn::Permutation::value_type * indexes);
+
+/// The rows selected by a filter.
+/// A dense filter is applied by copying the runs of selected rows, while a sparse one is cheaper to apply by
+/// gathering the rows through the selection vector, which does not branch on each row. So the selection
+/// vector is only built for the sparse filters.
+struct FilterSelection
+{
+    size_t selected_rows = 0;
+    /// The indexes of the selected rows, resized to `selected_rows`. Empty if not `isSparse()`.
+    /// Never sparse if no row is selected.
+    IColumn::Permutation indexes;
+    bool sparse = false;
+
+    bool isSparse() const { return sparse; }
+};
+
+/// A filter is sparse if less than 1 / FILTER_SPARSE_RATIO of the rows are selected.
+static constexpr size_t FILTER_SPARSE_RATIO = 8;
+/// The filters shorter than this are always applied by copying.
+static constexpr size_t FILTER_SELECTION_MIN_ROWS = 64;
+
+FilterSelection buildFilterSelection(const IColumn::Filter & filt);
+
 /// Returns vector with num_columns elements. vector[i] is the count of i values in selector.
 /// Selector must contain values from 0 to num_columns - 1. NOTE: this is not checked.
 std::vector<size_t> countColumnsSizeInSelector(IColumn::ColumnIndex num_columns, const IColumn::Selector & selector);
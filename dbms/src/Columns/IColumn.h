@@ -273,6 +273,16 @@ public:
     using Selector = PaddedPODArray<ColumnIndex>;
     virtual std::vector<MutablePtr> scatter(ColumnIndex num_columns, const Selector & selector) const = 0;
 
+    /** Same as scatter, but append the values to the existing `columns` of the same type as this column,
+      * so that the caller can reuse them across calls. The number of columns is `columns.size()`.
+      * For default implementation, see scatterToImpl.
+      */
+    using ScatterColumns = std::vector<MutablePtr>;
+    virtual void scatterTo(ScatterColumns & columns, const Selector & selector) const
+    {
+        scatterToImpl<IColumn>(columns, selector);
+    }
+
     /// Insert data from several other columns according to source mask (used in vertical merge).
     /// For now it is a helper to de-virtualize calls to insert*() functions inside gather loop
     /// (descendants should call gatherer_stream.gather(*this) to implement this function.)
@@ -417,6 +427,29 @@ protected:
 
         return columns;
     }
+
+    /// In derived classes (that use final keyword), implement scatterTo method as call to scatterToImpl.
+    template <typename Derived>
+    void scatterToImpl(ScatterColumns & columns, const Selector & selector) const
+    {
+        size_t num_rows = size();
+
+        if (num_rows != selector.size())
+            throw Exception(
+                fmt::format("Size of selector: {} doesn't match size of column: {}", selector.size(), num_rows),
+                ErrorCodes::SIZES_OF_COLUMNS_DOESNT_MATCH);
+
+        {
+            size_t reserve_size = num_rows * 1.1 / columns.size(); /// 1.1 is just a guess. Better to use n-sigma rule.
+
+            if (reserve_size > 1)
+                for (auto & column : columns)
+                    column->reserve(column->size() + reserve_size);
+        }
+
+        for (size_t i = 0; i < num_rows; ++i)
+            static_cast<Derived &>(*columns[selector[i]]).insertFrom(*this, i);
+    }
 };
 
 using ColumnPtr = IColumn::Ptr;
@@ -0,0 +1,154 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Columns/ColumnDecimal.h>
+#include <Columns/ColumnFixedString.h>
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsCommon.h>
+#include <Columns/ColumnsNumber.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+class ColumnFilterTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t rows = 1000;
+
+    /// Select each row with the probability `1 / one_in`, 0 selects nothing.
+    static IColumn::Filter createFilter(size_t size, size_t one_in, UInt64 seed)
+    {
+        std::mt19937_64 rng(seed);
+        IColumn::Filter filt(size);
+        for (size_t i = 0; i < size; ++i)
+            filt[i] = one_in != 0 && rng() % one_in == 0;
+        return filt;
+    }
+
+    static ColumnPtr filterByRows(const IColumn & column, const IColumn::Filter & filt)
+    {
+        auto res = column.cloneEmpty();
+        for (size_t i = 0; i < filt.size(); ++i)
+        {
+            if (filt[i])
+                res->insertFrom(column, i);
+        }
+        return res;
+    }
+
+    static void checkFilter(const IColumn & column)
+    {
+        for (size_t one_in : {0, 1, 2, 10, 100})
+        {
+            auto filt = createFilter(column.size(), one_in, one_in);
+            auto expected = filterByRows(column, filt);
+            for (ssize_t hint : {0, -1, 1})
+            {
+                auto res = column.filter(filt, hint);
+                ASSERT_EQ(res->size(), expected->size()) << column.getName() << " one_in=" << one_in;
+                for (size_t i = 0; i < res->size(); ++i)
+                    ASSERT_EQ(res->compareAt(i, i, *expected, 1), 0) << column.getName() << " one_in=" << one_in << " row=" << i;
+            }
+        }
+    }
+
+    static MutableColumnPtr createStrings()
+    {
+        auto column = ColumnString::create();
+        for (size_t i = 0; i < rows; ++i)
+            column->insert(Field(String(i % 37, 'a' + i % 26)));
+        return column;
+    }
+};
+
+TEST_F(ColumnFilterTest, FilterToIndexes)
+{
+    for (size_t size : {0, 1, 15, 16, 17, 64, 100, 1000})
+    {
+        for (size_t one_in : {0, 1, 3, 50})
+        {
+            auto filt = createFilter(size, one_in, size + one_in);
+            IColumn::Permutation indexes(size);
+            size_t count = filterToIndexes(filt.data(), size, indexes.data());
+
+            IColumn::Permutation expected;
+            for (size_t i = 0; i < size; ++i)
+            {
+                if (filt[i])
+                    expected.push_back(i);
+            }
+            ASSERT_EQ(count, expected.size());
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(indexes[i], expected[i]);
+        }
+    }
+}
+
+TEST_F(ColumnFilterTest, BuildFilterSelection)
+{
+    auto dense = buildFilterSelection(createFilter(rows, 2, 1));
+    ASSERT_FALSE(dense.isSparse());
+    ASSERT_TRUE(dense.indexes.empty());
+
+    auto filt = createFilter(rows, 100, 1);
+    auto sparse = buildFilterSelection(filt);
+    ASSERT_TRUE(sparse.isSparse());
+    ASSERT_EQ(sparse.selected_rows, countBytesInFilter(filt));
+    ASSERT_EQ(sparse.indexes.size(), sparse.selected_rows);
+
+    ASSERT_FALSE(buildFilterSelection(createFilter(rows, 0, 1)).isSparse());
+    ASSERT_FALSE(buildFilterSelection(createFilter(FILTER_SELECTION_MIN_ROWS - 1, 100, 1)).isSparse());
+}
+
+TEST_F(ColumnFilterTest, String)
+{
+    checkFilter(*createStrings());
+}
+
+TEST_F(ColumnFilterTest, FixedString)
+{
+    auto column = ColumnFixedString::create(5);
+    for (size_t i = 0; i < rows; ++i)
+        column->insert(Field(std::to_string(10000 + i)));
+    checkFilter(*column);
+}
+
+TEST_F(ColumnFilterTest, Decimal)
+{
+    auto column = ColumnDecimal<Decimal64>::create(0, 2);
+    for (size_t i = 0; i < rows; ++i)
+        column->getData().push_back(Decimal64(static_cast<Int64>(i * 7)));
+    checkFilter(*column);
+}
+
+TEST_F(ColumnFilterTest, Nullable)
+{
+    auto null_map = ColumnUInt8::create();
+    for (size_t i = 0; i < rows; ++i)
+        null_map->getData().push_back(i % 3 == 0);
+
+    auto ints = ColumnInt64::create();
+    for (size_t i = 0; i < rows; ++i)
+        ints->getData().push_back(i);
+    checkFilter(*ColumnNullable::create(std::move(ints), null_map->clone()));
+    checkFilter(*ColumnNullable::create(createStrings(), std::move(null_map)));
+}
+
+} // namespace tests
+} // namespace DB
@@ -18,7 +18,9 @@
 #include <malloc.h>
 #endif
 
+#include <Common/ColumnBufferPool.h>
 #include <Common/Exception.h>
+#include <Common/HugePages.h>
 #include <Common/MemoryTracker.h>
 #include <Common/formatReadable.h>
 #include <IO/WriteHelpers.h>
@@ -84,8 +86,24 @@ void * Allocator<clear_memory_>::alloc(size_t size, size_t alignment)
 
         DB::allocator_mmap_counter.fetch_add(size, std::memory_order_acq_rel);
     }
+    else if (clear_memory && alignment <= DB::HugePages::HUGE_PAGE_SIZE && DB::HugePages::shouldUse(size))
+    {
+        buf = DB::HugePages::allocZeroed(size);
+        if (nullptr == buf)
+            DB::throwFromErrno("Allocator: Cannot allocate huge pages " + formatReadableSizeWithBinarySuffix(size) + ".", DB::ErrorCodes::CANNOT_ALLOCATE_MEMORY);
+    }
     else
     {
+        if (!clear_memory && alignment <= MALLOC_MIN_ALIGNMENT)
+        {
+            /// Reuse the buffer freed by temporary columns of current pipeline.
+            if (auto * pool = DB::ColumnBufferPool::current(); pool != nullptr)
+            {
+                if (void * pooled_buf = pool->tryGet(size); pooled_buf != nullptr)
+                    return pooled_buf;
+            }
+        }
+
         if (alignment <= MALLOC_MIN_ALIGNMENT)
         {
             if (clear_memory)
@@ -124,7 +142,9 @@ void Allocator<clear_memory_>::free(void * buf, size_t size)
     }
     else
     {
-        ::free(buf);
+        auto * pool = DB::ColumnBufferPool::current();
+        if (pool == nullptr || !pool->tryPut(buf, size))
+            ::free(buf);
     }
 
     CurrentMemoryTracker::free(size);
@@ -138,7 +158,8 @@ void * Allocator<clear_memory_>::realloc(void * buf, size_t old_size, size_t new
     {
         /// nothing to do.
     }
-    else if (old_size < MMAP_THRESHOLD && new_size < MMAP_THRESHOLD && alignment <= MALLOC_MIN_ALIGNMENT)
+    else if (old_size < MMAP_THRESHOLD && new_size < MMAP_THRESHOLD && alignment <= MALLOC_MIN_ALIGNMENT
+             && !(clear_memory && new_size > old_size && DB::HugePages::shouldUse(new_size)))
     {
         CurrentMemoryTracker::realloc(old_size, new_size);
 
@@ -14,11 +14,68 @@
 
 #include <Common/Checksum.h>
 
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 namespace DB
 {
+namespace
+{
+[[maybe_unused]] constexpr std::array<uint32_t, 256> makeCRC32CTable()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; ++k)
+            crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+        table[i] = crc;
+    }
+    return table;
+}
+
+[[maybe_unused]] constexpr auto crc32c_table = makeCRC32CTable();
+} // namespace
+
+uint32_t crc32c(uint32_t crc, const void * src, size_t length)
+{
+    const auto * p = static_cast<const uint8_t *>(src);
+    uint64_t state = ~crc;
+#if defined(__SSE4_2__)
+    for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t), p += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        state = _mm_crc32_u64(state, word);
+    }
+    for (; length > 0; --length, ++p)
+        state = _mm_crc32_u8(static_cast<uint32_t>(state), *p);
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t), p += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        state = __crc32cd(static_cast<uint32_t>(state), word);
+    }
+    for (; length > 0; --length, ++p)
+        state = __crc32cb(static_cast<uint32_t>(state), *p);
+#else
+    for (; length > 0; --length, ++p)
+        state = crc32c_table[(state ^ *p) & 0xFF] ^ (state >> 8);
+#endif
+    return ~static_cast<uint32_t>(state);
+}
+
 template class UnifiedDigest<Digest::None>;
 template class UnifiedDigest<Digest::CRC32>;
 template class UnifiedDigest<Digest::CRC64>;
 template class UnifiedDigest<Digest::City128>;
 template class UnifiedDigest<Digest::XXH3>;
+template class UnifiedDigest<Digest::CRC32C>;
 } // namespace DB
\ No newline at end of file
@@ -44,8 +44,14 @@ enum class ChecksumAlgo : uint64_t
     CRC64,
     City128,
     XXH3,
+    CRC32C,
 };
 
+/// CRC32 with the Castagnoli polynomial, which is computed by the `crc32` instructions of SSE4.2
+/// and ARMv8 when they are available, and by a table driven fallback otherwise.
+/// Chained in the same way as the `crc32` of zlib, so `crc32c(0, "123456789", 9) == 0xE3069283`.
+uint32_t crc32c(uint32_t crc, const void * src, size_t length);
+
 namespace Digest
 {
 class None
@@ -75,6 +81,23 @@ private:
     uLong state = 0;
 };
 
+class CRC32C
+{
+public:
+    using HashType = uint32_t;
+    static constexpr size_t hash_size = sizeof(HashType);
+    static constexpr auto algorithm = ::DB::ChecksumAlgo::CRC32C;
+    void update(const void * src, size_t length)
+    {
+        ProfileEvents::increment(ProfileEvents::ChecksumDigestBytes, length);
+        state = ::DB::crc32c(state, src, length);
+    }
+    [[nodiscard]] HashType checksum() const { return state; }
+
+private:
+    uint32_t state = 0;
+};
+
 class City128
 {
 public:
@@ -149,6 +172,7 @@ BASIC_CHECK_FOR_FRAME(CRC64)
 BASIC_CHECK_FOR_FRAME(City128)
 BASIC_CHECK_FOR_FRAME(None)
 BASIC_CHECK_FOR_FRAME(XXH3)
+BASIC_CHECK_FOR_FRAME(CRC32C)
 #undef BASIC_CHECK_FOR_FRAME
 
 using FrameUnion = std::aligned_union_t<
@@ -157,7 +181,8 @@ using FrameUnion = std::aligned_union_t<
     ChecksumFrame<Digest::CRC32>,
     ChecksumFrame<Digest::CRC64>,
     ChecksumFrame<Digest::City128>,
-    ChecksumFrame<Digest::XXH3>>;
+    ChecksumFrame<Digest::XXH3>,
+    ChecksumFrame<Digest::CRC32C>>;
 
 
 struct UnifiedDigestBase
@@ -0,0 +1,79 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/ColumnBufferPool.h>
+
+#include <cstdlib>
+
+namespace DB
+{
+std::atomic<size_t> ColumnBufferPool::max_bytes_per_thread{16 * 1024 * 1024};
+thread_local ColumnBufferPool * ColumnBufferPool::current_pool = nullptr;
+
+ColumnBufferPool::Scope::Scope()
+{
+    if (current_pool != nullptr || getMaxBytesPerThread() == 0)
+        return;
+    pool = new ColumnBufferPool();
+    pool->max_bytes = getMaxBytesPerThread();
+    current_pool = pool;
+}
+
+ColumnBufferPool::Scope::~Scope()
+{
+    if (pool == nullptr)
+        return;
+    current_pool = nullptr;
+    delete pool;
+}
+
+ColumnBufferPool::~ColumnBufferPool()
+{
+    for (auto & free_list : free_lists)
+    {
+        for (void * buf : free_list)
+            ::free(buf);
+    }
+}
+
+size_t ColumnBufferPool::sizeClass(size_t size)
+{
+    if (size < MIN_SIZE || size > MAX_SIZE || (size & (size - 1)) != 0)
+        return NUM_SIZE_CLASSES;
+    return __builtin_ctzll(size) - MIN_SIZE_SHIFT;
+}
+
+void * ColumnBufferPool::tryGet(size_t size)
+{
+    size_t cls = sizeClass(size);
+    if (cls >= NUM_SIZE_CLASSES || free_lists[cls].empty())
+        return nullptr;
+    void * buf = free_lists[cls].back();
+    free_lists[cls].pop_back();
+    pooled_bytes -= size;
+    return buf;
+}
+
+bool ColumnBufferPool::tryPut(void * buf, size_t size)
+{
+    size_t cls = sizeClass(size);
+    if (cls >= NUM_SIZE_CLASSES || pooled_bytes + size > max_bytes)
+        return false;
+    free_lists[cls].push_back(buf);
+    pooled_bytes += size;
+    return true;
+}
+
+} // namespace DB
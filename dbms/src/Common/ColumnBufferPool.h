@@ -0,0 +1,89 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <vector>
+
+namespace DB
+{
+/** A thread local pool that recycles the memory of temporary column buffers.
+  *
+  * Blocks going through a pipeline allocate and free column buffers of the same sizes again and again.
+  * When a `ColumnBufferPool::Scope` is active on current thread, buffers freed by `Allocator` are kept
+  * in per size class free lists instead of going back to malloc, and later allocations of the same size
+  * class on this thread reuse them.
+  *
+  * The pooled buffers are plain malloc-ed memory, so a buffer allocated from the pool can be freed in
+  * any thread, with or without an active scope.
+  * The memory tracker is not aware of the pool: the pooled buffers are untracked, and the pool size of
+  * each thread is bounded by `setMaxBytesPerThread`.
+  */
+class ColumnBufferPool : private boost::noncopyable
+{
+public:
+    /// Only the buffers whose size is a power of two in [MIN_SIZE, MAX_SIZE] are pooled.
+    /// PODArray always allocates power of two sizes.
+    static constexpr size_t MIN_SIZE_SHIFT = 12;
+    static constexpr size_t MAX_SIZE_SHIFT = 23;
+    static constexpr size_t MIN_SIZE = 1ULL << MIN_SIZE_SHIFT;
+    static constexpr size_t MAX_SIZE = 1ULL << MAX_SIZE_SHIFT;
+
+    /// Activate a pool on current thread. Nested scopes share the outer pool.
+    /// All the pooled buffers are freed when the outermost scope is destroyed.
+    class Scope : private boost::noncopyable
+    {
+    public:
+        Scope();
+        ~Scope();
+
+    private:
+        ColumnBufferPool * pool = nullptr;
+    };
+
+    /// The max bytes of pooled buffers of each thread, 0 means disable the pool.
+    static void setMaxBytesPerThread(size_t bytes) { max_bytes_per_thread.store(bytes, std::memory_order_relaxed); }
+    static size_t getMaxBytesPerThread() { return max_bytes_per_thread.load(std::memory_order_relaxed); }
+
+    /// The pool of current thread, nullptr if there is no active scope.
+    static ColumnBufferPool * current() { return current_pool; }
+
+    /// Return a pooled buffer of `size` bytes, or nullptr if there is no one.
+    void * tryGet(size_t size);
+
+    /// Try to keep the buffer in the pool, return false if the buffer should be freed by the caller.
+    bool tryPut(void * buf, size_t size);
+
+    size_t pooledBytes() const { return pooled_bytes; }
+
+    ~ColumnBufferPool();
+
+private:
+    ColumnBufferPool() = default;
+
+    static size_t sizeClass(size_t size);
+
+    static constexpr size_t NUM_SIZE_CLASSES = MAX_SIZE_SHIFT - MIN_SIZE_SHIFT + 1;
+    std::vector<void *> free_lists[NUM_SIZE_CLASSES];
+    size_t pooled_bytes = 0;
+    size_t max_bytes = 0;
+
+    static std::atomic<size_t> max_bytes_per_thread;
+    static thread_local ColumnBufferPool * current_pool;
+};
+
+} // namespace DB
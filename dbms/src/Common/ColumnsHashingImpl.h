@@ -134,6 +134,14 @@ public:
         return emplaceImpl(key_holder, data);
     }
 
+    /// Same as above, but use the hash value of the key calculated by the caller, see `getHash`.
+    template <typename Data>
+    ALWAYS_INLINE EmplaceResult emplaceKey(Data & data, size_t row, Arena & pool, std::vector<String> & sort_key_containers, size_t hash_value)
+    {
+        auto key_holder = static_cast<Derived &>(*this).getKeyHolder(row, &pool, sort_key_containers);
+        return emplaceImpl<true>(key_holder, data, hash_value);
+    }
+
     template <typename Data>
     ALWAYS_INLINE FindResult findKey(Data & data, size_t row, Arena & pool, std::vector<String> & sort_key_containers)
     {
@@ -166,8 +174,8 @@ protected:
         }
     }
 
-    template <typename Data, typename KeyHolder>
-    ALWAYS_INLINE EmplaceResult emplaceImpl(KeyHolder & key_holder, Data & data)
+    template <bool use_hash_value = false, typename Data, typename KeyHolder>
+    ALWAYS_INLINE EmplaceResult emplaceImpl(KeyHolder & key_holder, Data & data, [[maybe_unused]] size_t hash_value = 0)
     {
         if constexpr (Cache::consecutive_keys_optimization)
         {
@@ -182,7 +190,10 @@ protected:
 
         typename Data::LookupResult it;
         bool inserted = false;
-        data.emplace(key_holder, it, inserted);
+        if constexpr (use_hash_value)
+            data.emplace(key_holder, it, inserted, hash_value);
+        else
+            data.emplace(key_holder, it, inserted);
 
         [[maybe_unused]] Mapped * cached = nullptr;
         if constexpr (has_mapped)
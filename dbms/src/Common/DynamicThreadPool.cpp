@@ -15,6 +15,8 @@
 #include <Common/DynamicThreadPool.h>
 #include <Common/TiFlashMetrics.h>
 
+#include <ext/scope_guard.h>
+
 namespace DB
 {
 DynamicThreadPool::~DynamicThreadPool()
@@ -43,6 +45,7 @@ DynamicThreadPool::ThreadCount DynamicThreadPool::threadCount() const
     ThreadCount cnt;
     cnt.fixed = fixed_threads.size();
     cnt.dynamic = alive_dynamic_threads.load();
+    cnt.active = active_threads.load();
     return cnt;
 }
 
@@ -98,6 +101,8 @@ void DynamicThreadPool::scheduledToNewDynamicThread(TaskPtr & task)
 void DynamicThreadPool::executeTask(TaskPtr & task)
 {
     UPDATE_CUR_AND_MAX_METRIC(tiflash_thread_count, type_active_threads_of_thdpool, type_max_active_threads_of_thdpool);
+    active_threads.fetch_add(1);
+    SCOPE_EXIT({ active_threads.fetch_sub(1); });
     task->execute();
     task.reset();
 }
@@ -72,6 +72,8 @@ public:
     {
         Int32 fixed = 0;
         Int32 dynamic = 0;
+        /// The threads running a task, the idle fixed and dynamic threads are not counted.
+        Int32 active = 0;
     };
 
     ThreadCount threadCount() const;
@@ -88,7 +90,7 @@ private:
     void fixedWork(size_t index);
     void dynamicWork(TaskPtr initial_task);
 
-    static void executeTask(TaskPtr & task);
+    void executeTask(TaskPtr & task);
 
     const std::chrono::nanoseconds dynamic_auto_shrink_cooldown;
 
@@ -102,5 +104,6 @@ private:
     bool in_destructing = false;
 
     std::atomic<Int64> alive_dynamic_threads = 0;
+    std::atomic<Int64> active_threads = 0;
 };
 } // namespace DB
@@ -390,6 +390,8 @@ extern const int DECIMAL_OVERFLOW = 446;
 extern const int CANNOT_PARSE_BOOL = 447;
 extern const int CANNOT_FTRUNCATE = 448;
 extern const int UNKNOWN_WINDOW_FUNCTION = 449;
+extern const int CANNOT_SET_SIGNAL_HANDLER = 450;
+extern const int CANNOT_SET_TIMER_PERIOD = 451;
 
 extern const int KEEPER_EXCEPTION = 999;
 extern const int POCO_EXCEPTION = 1000;
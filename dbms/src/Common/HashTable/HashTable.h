@@ -1061,6 +1061,12 @@ public:
         return const_cast<std::decay_t<decltype(*this)> *>(this)->find(x);
     }
 
+    /// Prefetch the cell where the lookup of a key with `hash_value` starts, so that the cache misses of a batch of lookups overlap.
+    void ALWAYS_INLINE prefetchByHash(size_t hash_value) const
+    {
+        __builtin_prefetch(&buf[grower.place(hash_value)]);
+    }
+
     LookupResult ALWAYS_INLINE find(const Key & x, size_t hash_value)
     {
         if (Cell::isZero(x, *this))
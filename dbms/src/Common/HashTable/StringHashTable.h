@@ -238,6 +238,18 @@ public:
     {
     }
 
+    void reserve(size_t num_elements)
+    {
+        /// Note that `HashTable::reserve(0)` grows the table.
+        size_t num_elements_per_table = num_elements / 4;
+        if (num_elements_per_table == 0)
+            return;
+        m1.reserve(num_elements_per_table);
+        m2.reserve(num_elements_per_table);
+        m3.reserve(num_elements_per_table);
+        ms.reserve(num_elements_per_table);
+    }
+
     StringHashTable(StringHashTable && rhs)
         : m1(std::move(rhs.m1))
         , m2(std::move(rhs.m2))
@@ -0,0 +1,55 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/HugePages.h>
+#include <Common/ProfileEvents.h>
+#include <sys/mman.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace ProfileEvents
+{
+extern const Event HugePageAllocations;
+extern const Event HugePageAllocatedBytes;
+} // namespace ProfileEvents
+
+namespace DB
+{
+std::atomic<size_t> HugePages::threshold{0};
+thread_local int HugePages::depth = 0;
+
+void * HugePages::allocZeroed(size_t size)
+{
+    void * buf = nullptr;
+    if (0 != posix_memalign(&buf, HUGE_PAGE_SIZE, size))
+        return nullptr;
+
+#ifdef MADV_HUGEPAGE
+    /// Advise the whole huge pages in the buffer. It is only a hint, just ignore the failure.
+    size_t advised_size = size / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (advised_size > 0 && 0 == madvise(buf, advised_size, MADV_HUGEPAGE))
+    {
+        ProfileEvents::increment(ProfileEvents::HugePageAllocations);
+        ProfileEvents::increment(ProfileEvents::HugePageAllocatedBytes, advised_size);
+    }
+#endif
+
+    /// Zero-fill also pre-faults the pages in current thread.
+    memset(buf, 0, size);
+    return buf;
+}
+
+} // namespace DB
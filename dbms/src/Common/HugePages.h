@@ -0,0 +1,82 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <cstddef>
+
+namespace DB
+{
+/** Huge page allocation mode for large hash tables.
+  *
+  * The buffers of big hash tables (e.g. the maps of Join and the buckets of two-level aggregation) are
+  * accessed randomly, so TLB misses and page faults on the first touch dominate the build phase.
+  * When a `HugePages::Scope` is active on current thread, zero-filled allocations of `Allocator<true>`
+  * not smaller than `getThreshold()` are aligned to `HUGE_PAGE_SIZE`, advised with `MADV_HUGEPAGE` and
+  * pre-faulted by the allocating thread, so the build threads pre-fault their own maps in parallel.
+  *
+  * The buffers are still allocated by malloc and freed by `::free`, so they can be freed or resized by
+  * any thread.
+  */
+class HugePages
+{
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /// Mark that allocations of current thread are for the hash tables that prefer huge pages.
+    class Scope : private boost::noncopyable
+    {
+    public:
+        explicit Scope(bool enable_ = true)
+            : enable(enable_)
+        {
+            if (enable)
+                ++depth;
+        }
+        ~Scope()
+        {
+            if (enable)
+                --depth;
+        }
+
+    private:
+        bool enable;
+    };
+
+    /// The min size of the hash table buffer that uses huge pages, 0 means disabled.
+    static void setThreshold(size_t bytes) { threshold.store(bytes, std::memory_order_relaxed); }
+    static size_t getThreshold() { return threshold.load(std::memory_order_relaxed); }
+
+    /// Whether an allocation of `size` bytes on current thread should use huge pages.
+    static bool shouldUse(size_t size)
+    {
+        if (depth <= 0)
+            return false;
+        size_t t = getThreshold();
+        return t != 0 && size >= t;
+    }
+
+    /// Allocate a zero-filled and pre-faulted buffer backed by transparent huge pages if possible.
+    /// Return nullptr if the allocation fails.
+    static void * allocZeroed(size_t size);
+
+private:
+    static std::atomic<size_t> threshold;
+    static thread_local int depth;
+};
+
+} // namespace DB
@@ -171,6 +171,29 @@ public:
         return cells.size();
     }
 
+    /// Evict the least recently used entries until `bytes_to_free` bytes are freed or the cache is empty.
+    /// Return the bytes freed. Used to reclaim memory under memory pressure, see `MemoryArbiter`.
+    size_t evict(size_t bytes_to_free)
+    {
+        std::lock_guard cache_lock(mutex);
+        size_t freed = 0;
+        while (freed < bytes_to_free && !queue.empty())
+        {
+            auto it = cells.find(queue.front());
+            if (it == cells.end())
+            {
+                LOG_FMT_ERROR(&Poco::Logger::get("LRUCache"), "LRUCache became inconsistent. There must be a bug in it.");
+                abort();
+            }
+            freed += it->second.size;
+            cells.erase(it);
+            queue.pop_front();
+        }
+        current_size -= freed;
+        onRemoveOverflowWeightLoss(freed);
+        return freed;
+    }
+
     void reset()
     {
         std::lock_guard cache_lock(mutex);
@@ -0,0 +1,378 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/MPMCQueue.h>
+#include <Common/nocopyable.h>
+#include <common/defines.h>
+#include <common/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace DB
+{
+/// LockFreeMPMCQueue is a bounded FIFO queue with the same interface and the same `MPMCQueueStatus` semantics as `MPMCQueue`.
+///
+/// It is a ring of cells with sequence numbers (the bounded MPMC queue of Dmitry Vyukov), so a push or pop that doesn't
+/// need to wait only takes a CAS on the position and a store on the cell, without any mutex. A blocked reader or writer
+/// yields for a while, then parks on a condition variable. The condition variables are only notified if some thread is parked.
+///
+/// T must be nothrow move constructible and assignable, because an object can't be given back once its cell is taken.
+template <typename T>
+class LockFreeMPMCQueue
+{
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>);
+
+public:
+    using Status = MPMCQueueStatus;
+
+    explicit LockFreeMPMCQueue(Int64 capacity_)
+        : capacity(capacity_)
+        , cells(std::make_unique<Cell[]>(capacity))
+    {
+        for (Int64 i = 0; i < capacity; ++i)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    ~LockFreeMPMCQueue()
+    {
+        for (Int64 pos = read_pos.load(); pos < write_pos.load(); ++pos)
+        {
+            auto & cell = cells[pos % capacity];
+            if (cell.seq.load() == pos + 1)
+                destruct(cell.obj());
+        }
+    }
+
+    DISALLOW_COPY_AND_MOVE(LockFreeMPMCQueue);
+
+    /// See `MPMCQueue::pop`.
+    ALWAYS_INLINE bool pop(T & obj)
+    {
+        return popObj<true>(obj);
+    }
+
+    template <typename Duration>
+    ALWAYS_INLINE bool popTimeout(T & obj, const Duration & timeout)
+    {
+        auto deadline = std::chrono::system_clock::now() + timeout;
+        return popObj<true>(obj, &deadline);
+    }
+
+    ALWAYS_INLINE bool tryPop(T & obj)
+    {
+        return popObj<false>(obj);
+    }
+
+    /// See `MPMCQueue::push`.
+    template <typename U>
+    ALWAYS_INLINE bool push(U && u)
+    {
+        return pushObj<true>(T(std::forward<U>(u)));
+    }
+
+    template <typename U, typename Duration>
+    ALWAYS_INLINE bool pushTimeout(U && u, const Duration & timeout)
+    {
+        auto deadline = std::chrono::system_clock::now() + timeout;
+        return pushObj<true>(T(std::forward<U>(u)), &deadline);
+    }
+
+    template <typename U>
+    ALWAYS_INLINE bool tryPush(U && u)
+    {
+        return pushObj<false>(T(std::forward<U>(u)));
+    }
+
+    /// The object is constructed before taking a cell, so that a throwing constructor leaves the queue unchanged.
+    template <typename... Args>
+    ALWAYS_INLINE bool emplace(Args &&... args)
+    {
+        return pushObj<true>(T(std::forward<Args>(args)...));
+    }
+
+    template <typename... Args, typename Duration>
+    ALWAYS_INLINE bool emplaceTimeout(Args &&... args, const Duration & timeout)
+    {
+        auto deadline = std::chrono::system_clock::now() + timeout;
+        return pushObj<true>(T(std::forward<Args>(args)...), &deadline);
+    }
+
+    template <typename... Args>
+    ALWAYS_INLINE bool tryEmplace(Args &&... args)
+    {
+        return pushObj<false>(T(std::forward<Args>(args)...));
+    }
+
+    /// See `MPMCQueue::cancel`.
+    void cancel()
+    {
+        auto expected = Status::NORMAL;
+        if (status.compare_exchange_strong(expected, Status::CANCELLED))
+            notifyAll();
+    }
+
+    /// See `MPMCQueue::finish`.
+    bool finish()
+    {
+        auto expected = Status::NORMAL;
+        if (status.compare_exchange_strong(expected, Status::FINISHED))
+        {
+            notifyAll();
+            return true;
+        }
+        return false;
+    }
+
+    bool isNextPopNonBlocking() const
+    {
+        return canPop() || !isNormal();
+    }
+
+    bool isNextPushNonBlocking() const
+    {
+        return canPush() || !isNormal();
+    }
+
+    MPMCQueueStatus getStatus() const
+    {
+        return status.load();
+    }
+
+    /// The pushes and pops in progress are counted, so the size is only exact when the queue is not being modified.
+    size_t size() const
+    {
+        Int64 size = write_pos.load() - read_pos.load();
+        return size > 0 ? static_cast<size_t>(size) : 0;
+    }
+
+private:
+    using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+
+    /// The times a blocked reader or writer yields before it parks.
+    static constexpr size_t max_yield_count = 64;
+
+    /// A cell is empty for the writer of `pos` if `seq == pos`, and full for the reader of `pos` if `seq == pos + 1`.
+    /// The reader of `pos` sets `seq` to `pos + capacity`, the position of the next writer of the cell.
+    struct Cell
+    {
+        std::atomic<Int64> seq;
+        alignas(T) char storage[sizeof(T)];
+
+        T & obj() { return *reinterpret_cast<T *>(storage); }
+    };
+
+    bool tryDequeue(T & res)
+    {
+        Int64 pos = read_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto & cell = cells[pos % capacity];
+            Int64 diff = cell.seq.load(std::memory_order_acquire) - (pos + 1);
+            if (diff == 0)
+            {
+                if (read_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    res = std::move(cell.obj());
+                    destruct(cell.obj());
+                    cell.seq.store(pos + capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; /// empty
+            else
+                pos = read_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool tryEnqueue(T & obj)
+    {
+        Int64 pos = write_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto & cell = cells[pos % capacity];
+            Int64 diff = cell.seq.load(std::memory_order_acquire) - pos;
+            if (diff == 0)
+            {
+                if (write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    new (cell.storage) T(std::move(obj));
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; /// full
+            else
+                pos = write_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    template <bool need_wait>
+    bool popObj(T & res, [[maybe_unused]] const TimePoint * deadline = nullptr)
+    {
+        for (size_t wait_count = 0;; ++wait_count)
+        {
+            if (isCancelled())
+                return false;
+            if (tryDequeue(res))
+            {
+                notifyOne(parked_writers, writer_cv);
+                return true;
+            }
+            /// A push that started before `finish` may still be in progress, it must be popped.
+            if (isFinishedAndNoPendingPush())
+            {
+                if (!tryDequeue(res))
+                    return false;
+                notifyOne(parked_writers, writer_cv);
+                return true;
+            }
+            if constexpr (!need_wait)
+                return false;
+            else if (!waitOrPark(parked_readers, reader_cv, wait_count, deadline, [&] {
+                         return canPop() || isCancelled() || isFinishedAndNoPendingPush();
+                     }))
+                return false;
+        }
+    }
+
+    template <bool need_wait>
+    bool pushObj(T && obj, [[maybe_unused]] const TimePoint * deadline = nullptr)
+    {
+        pending_pushes.fetch_add(1);
+        bool pushed = false;
+        for (size_t wait_count = 0;; ++wait_count)
+        {
+            if (!isNormal())
+                break;
+            if (tryEnqueue(obj))
+            {
+                pushed = true;
+                break;
+            }
+            if constexpr (!need_wait)
+                break;
+            else if (!waitOrPark(parked_writers, writer_cv, wait_count, deadline, [&] { return canPush() || !isNormal(); }))
+                break;
+        }
+        pending_pushes.fetch_sub(1);
+        if (pushed)
+            notifyOne(parked_readers, reader_cv);
+        else if (!isNormal())
+            notifyAll(); /// the readers of a finished queue may wait for this push to end
+        return pushed;
+    }
+
+    /// Return false if `deadline` is exceeded while `pred` is still false.
+    template <typename Pred>
+    bool waitOrPark(std::atomic<Int64> & parked, std::condition_variable & cv, size_t wait_count, const TimePoint * deadline, Pred pred)
+    {
+        if (deadline && std::chrono::system_clock::now() >= *deadline)
+            return pred();
+        if (wait_count < max_yield_count)
+        {
+            std::this_thread::yield();
+            return true;
+        }
+
+        std::unique_lock lock(park_mu);
+        parked.fetch_add(1);
+        /// pairs with the fence in `notifyOne`, either this thread sees the change or the notifier sees this thread parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool res = true;
+        if (deadline)
+            res = cv.wait_until(lock, *deadline, pred);
+        else
+            cv.wait(lock, pred);
+        parked.fetch_sub(1);
+        return res;
+    }
+
+    void notifyOne(std::atomic<Int64> & parked, std::condition_variable & cv)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard lock(park_mu);
+            cv.notify_one();
+        }
+    }
+
+    void notifyAll()
+    {
+        std::lock_guard lock(park_mu);
+        reader_cv.notify_all();
+        writer_cv.notify_all();
+    }
+
+    bool canPop() const
+    {
+        Int64 pos = read_pos.load(std::memory_order_relaxed);
+        return cells[pos % capacity].seq.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    bool canPush() const
+    {
+        Int64 pos = write_pos.load(std::memory_order_relaxed);
+        return cells[pos % capacity].seq.load(std::memory_order_acquire) == pos;
+    }
+
+    ALWAYS_INLINE bool isNormal() const
+    {
+        return likely(status.load() == Status::NORMAL);
+    }
+
+    ALWAYS_INLINE bool isCancelled() const
+    {
+        return unlikely(status.load() == Status::CANCELLED);
+    }
+
+    ALWAYS_INLINE bool isFinishedAndNoPendingPush() const
+    {
+        return status.load() == Status::FINISHED && pending_pushes.load() == 0;
+    }
+
+    ALWAYS_INLINE void destruct(T & obj)
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            obj.~T();
+    }
+
+private:
+    const Int64 capacity;
+    std::unique_ptr<Cell[]> cells;
+
+    /// The positions are on their own cache lines, they are written by the readers and the writers respectively.
+    alignas(64) std::atomic<Int64> read_pos{0};
+    alignas(64) std::atomic<Int64> write_pos{0};
+    alignas(64) std::atomic<Int64> pending_pushes{0};
+    std::atomic<Status> status{Status::NORMAL};
+
+    std::mutex park_mu;
+    std::condition_variable reader_cv;
+    std::condition_variable writer_cv;
+    std::atomic<Int64> parked_readers{0};
+    std::atomic<Int64> parked_writers{0};
+};
+
+} // namespace DB
@@ -0,0 +1,167 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/CurrentMetrics.h>
+#include <Common/MemoryArbiter.h>
+
+#include <algorithm>
+
+namespace CurrentMetrics
+{
+extern const Metric MemoryTracking;
+} // namespace CurrentMetrics
+
+namespace DB
+{
+MemoryArbiter & MemoryArbiter::instance()
+{
+    static MemoryArbiter arbiter;
+    return arbiter;
+}
+
+MemoryArbiter::MemoryArbiter()
+    : log(&Poco::Logger::get("MemoryArbiter"))
+{}
+
+void MemoryArbiter::setLimit(UInt64 limit_)
+{
+    limit.store(limit_, std::memory_order_relaxed);
+    LOG_FMT_INFO(log, "Set memory limit to {} bytes", limit_);
+}
+
+MemoryArbiter::ConsumerId MemoryArbiter::registerCache(const String & name, GetBytes get_bytes, Evict evict)
+{
+    std::lock_guard lock(mutex);
+    auto id = next_id++;
+    consumers.emplace(id, Consumer{name, std::move(get_bytes), std::move(evict), nullptr});
+    return id;
+}
+
+MemoryArbiter::ConsumerId MemoryArbiter::registerSpillable(const String & name, GetBytes get_bytes, RequestSpill request_spill)
+{
+    std::lock_guard lock(mutex);
+    auto id = next_id++;
+    consumers.emplace(id, Consumer{name, std::move(get_bytes), nullptr, std::move(request_spill)});
+    return id;
+}
+
+void MemoryArbiter::unregister(ConsumerId id)
+{
+    std::lock_guard lock(mutex);
+    consumers.erase(id);
+}
+
+UInt64 MemoryArbiter::getUsage() const
+{
+    UInt64 cache_bytes = 0;
+    {
+        std::lock_guard lock(mutex);
+        for (const auto & [id, consumer] : consumers)
+        {
+            if (consumer.evict)
+                cache_bytes += consumer.get_bytes();
+        }
+    }
+    auto query_bytes = static_cast<UInt64>(std::max<Int64>(CurrentMetrics::get(CurrentMetrics::MemoryTracking), 0));
+    return std::max(query_bytes, reserved.load(std::memory_order_relaxed)) + cache_bytes;
+}
+
+bool MemoryArbiter::tryReserve(size_t bytes)
+{
+    const auto mem_limit = getLimit();
+    if (mem_limit == 0 || getUsage() + bytes <= mem_limit)
+    {
+        reserved += bytes;
+        return true;
+    }
+
+    std::lock_guard reclaim_lock(reclaim_mutex);
+    auto usage = getUsage();
+    if (usage + bytes > mem_limit)
+    {
+        auto bytes_to_free = usage + bytes - mem_limit;
+        if (reclaim(bytes_to_free) < bytes_to_free)
+        {
+            LOG_FMT_WARNING(log, "Failed to reserve {} bytes, usage {} bytes, limit {} bytes", bytes, usage, mem_limit);
+            return false;
+        }
+    }
+    reserved += bytes;
+    return true;
+}
+
+void MemoryArbiter::release(size_t bytes)
+{
+    reserved -= bytes;
+}
+
+void MemoryArbiter::reclaimIfNeeded()
+{
+    const auto mem_limit = getLimit();
+    if (mem_limit == 0)
+        return;
+    std::lock_guard reclaim_lock(reclaim_mutex);
+    if (auto usage = getUsage(); usage > mem_limit)
+    {
+        // Leave some headroom so that it is not triggered again soon.
+        reclaim(usage - mem_limit + mem_limit / 10);
+    }
+}
+
+size_t MemoryArbiter::reclaim(size_t bytes_to_free)
+{
+    std::lock_guard lock(mutex);
+
+    size_t freed_by_caches = 0;
+    for (auto & [id, consumer] : consumers)
+    {
+        if (freed_by_caches >= bytes_to_free)
+            break;
+        if (!consumer.evict)
+            continue;
+        auto freed = consumer.evict(bytes_to_free - freed_by_caches);
+        if (freed > 0)
+            LOG_FMT_INFO(log, "Evicted {} bytes from {}", freed, consumer.name);
+        freed_by_caches += freed;
+    }
+
+    size_t freed = freed_by_caches;
+    if (freed < bytes_to_free)
+    {
+        std::vector<std::pair<size_t, Consumer *>> spillables;
+        for (auto & [id, consumer] : consumers)
+        {
+            if (consumer.request_spill)
+            {
+                if (auto bytes = consumer.get_bytes(); bytes > 0)
+                    spillables.emplace_back(bytes, &consumer);
+            }
+        }
+        std::sort(spillables.begin(), spillables.end(), [](const auto & lhs, const auto & rhs) { return lhs.first > rhs.first; });
+        for (auto & [bytes, consumer] : spillables)
+        {
+            if (freed >= bytes_to_free)
+                break;
+            LOG_FMT_INFO(log, "Request {} holding {} bytes to spill", consumer->name, bytes);
+            consumer->request_spill();
+            freed += bytes;
+        }
+    }
+
+    LOG_FMT_INFO(log, "Reclaimed memory, requested {} bytes, freed {} bytes by caches, {} bytes by spilling", bytes_to_free, freed_by_caches, freed - freed_by_caches);
+    return freed;
+}
+
+} // namespace DB
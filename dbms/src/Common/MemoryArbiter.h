@@ -0,0 +1,129 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Core/Types.h>
+#include <common/logger_useful.h>
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace DB
+{
+/** Process-wide arbiter of the memory shared by the queries and the caches that are not tracked by any `MemoryTracker`
+  * (MarkCache, MinMaxIndexCache, UncompressedCache, DeltaIndexManager, ...).
+  *
+  * The usage of memory is the memory tracked by all queries (or the bytes reserved by them if larger) plus the bytes held by the caches.
+  * Once the usage passes the limit, memory is reclaimed in order:
+  *  1. evict the registered caches, in the order of registration;
+  *  2. ask the registered spillable operators, the largest first, to spill their data to disk.
+  * Only when there is still not enough memory, `tryReserve` fails and the query degrades or fails by its own limits.
+  *
+  * It does nothing if the limit is 0.
+  */
+class MemoryArbiter : private boost::noncopyable
+{
+public:
+    using ConsumerId = UInt64;
+    /// Return the bytes held by the consumer.
+    using GetBytes = std::function<size_t()>;
+    /// Evict about `bytes` from the cache, return the bytes actually freed.
+    using Evict = std::function<size_t(size_t bytes)>;
+    /// Ask the operator to spill its data.
+    /// All the callbacks are called under the lock of the arbiter, so that the consumer can not be unregistered meanwhile.
+    /// They must be cheap and must not call the arbiter.
+    using RequestSpill = std::function<void()>;
+
+    static MemoryArbiter & instance();
+
+    void setLimit(UInt64 limit_);
+    UInt64 getLimit() const { return limit.load(std::memory_order_relaxed); }
+
+    ConsumerId registerCache(const String & name, GetBytes get_bytes, Evict evict);
+    ConsumerId registerSpillable(const String & name, GetBytes get_bytes, RequestSpill request_spill);
+    void unregister(ConsumerId id);
+
+    /// Reserve `bytes` before running a heavy operator. Reclaim memory if necessary.
+    /// Return false if the memory is still not enough, and nothing is reserved.
+    bool tryReserve(size_t bytes);
+    void release(size_t bytes);
+
+    /// Reclaim memory if the usage passes the limit. Called periodically by a background task.
+    void reclaimIfNeeded();
+
+    UInt64 getUsage() const;
+
+private:
+    MemoryArbiter();
+
+    struct Consumer
+    {
+        String name;
+        GetBytes get_bytes;
+        Evict evict;
+        RequestSpill request_spill;
+    };
+
+    /// Try to free `bytes_to_free` bytes, return the bytes freed by caches plus the bytes held by the operators asked to spill.
+    size_t reclaim(size_t bytes_to_free);
+
+    std::atomic<UInt64> limit{0};
+    std::atomic<UInt64> reserved{0};
+
+    mutable std::mutex mutex;
+    // Ordered by id, which is the order of registration.
+    std::map<ConsumerId, Consumer> consumers;
+    ConsumerId next_id = 1;
+
+    /// Serialize the reclaiming, so that the memory is not reclaimed again and again by concurrent reservations.
+    std::mutex reclaim_mutex;
+
+    Poco::Logger * log;
+};
+
+/// Reserve memory from `MemoryArbiter` and release it on destruction.
+class MemoryReservation : private boost::noncopyable
+{
+public:
+    MemoryReservation() = default;
+    ~MemoryReservation() { reset(); }
+
+    /// Add `bytes` to this reservation, return false if the memory is not enough.
+    bool tryReserve(size_t bytes)
+    {
+        if (!MemoryArbiter::instance().tryReserve(bytes))
+            return false;
+        reserved += bytes;
+        return true;
+    }
+
+    void reset()
+    {
+        if (reserved)
+            MemoryArbiter::instance().release(reserved);
+        reserved = 0;
+    }
+
+    size_t getReserved() const { return reserved; }
+
+private:
+    size_t reserved = 0;
+};
+
+} // namespace DB
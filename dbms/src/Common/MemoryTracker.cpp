@@ -173,14 +173,17 @@ namespace CurrentMemoryTracker
 static Int64 MEMORY_TRACER_SUBMIT_THRESHOLD = 8 * 1024 * 1024; // 8 MiB
 #if __APPLE__ && __clang__
 static __thread Int64 local_delta{};
+static __thread Int64 local_amount{};
 #else
 static thread_local Int64 local_delta{};
+static thread_local Int64 local_amount{};
 #endif
 
 __attribute__((always_inline)) inline void checkSubmitAndUpdateLocalDelta(Int64 updated_local_delta)
 {
     if (current_memory_tracker)
     {
+        local_amount += updated_local_delta - local_delta;
         if (unlikely(updated_local_delta > MEMORY_TRACER_SUBMIT_THRESHOLD))
         {
             current_memory_tracker->alloc(updated_local_delta);
@@ -231,6 +234,11 @@ Int64 getLocalDeltaMemory()
     return local_delta;
 }
 
+Int64 getThreadMemoryAmount()
+{
+    return local_amount;
+}
+
 void alloc(Int64 size)
 {
     checkSubmitAndUpdateLocalDelta(local_delta + size);
@@ -112,6 +112,8 @@ namespace CurrentMemoryTracker
 void disableThreshold();
 void submitLocalDeltaMemory();
 Int64 getLocalDeltaMemory();
+/// The net amount of memory tracked in current thread since it started, including the delta not submitted yet.
+Int64 getThreadMemoryAmount();
 void alloc(Int64 size);
 void realloc(Int64 old_size, Int64 new_size);
 void free(Int64 size);
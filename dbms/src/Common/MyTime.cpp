@@ -929,8 +929,7 @@ void convertTimeZoneImpl(UInt64 from_time, UInt64 & to_time, const DateLUTImpl &
             return;
         }
     }
-    MyDateTime to_my_time(time_zone_to.toYear(to_epoch), time_zone_to.toMonth(to_epoch), time_zone_to.toDayOfMonth(to_epoch), time_zone_to.toHour(to_epoch), time_zone_to.toMinute(to_epoch), time_zone_to.toSecond(to_epoch), from_my_time.micro_second);
-    to_time = to_my_time.toPackedUInt();
+    to_time = convertUTC2TimeZone(to_epoch, from_my_time.micro_second, time_zone_to).toPackedUInt();
 }
 
 void convertTimeZone(UInt64 from_time, UInt64 & to_time, const DateLUTImpl & time_zone_from, const DateLUTImpl & time_zone_to, bool throw_exception)
@@ -946,7 +945,16 @@ void convertTimeZoneByOffset(UInt64 from_time, UInt64 & to_time, bool from_utc,
 
 MyDateTime convertUTC2TimeZone(time_t utc_ts, UInt32 micro_second, const DateLUTImpl & time_zone_to)
 {
-    return MyDateTime(time_zone_to.toYear(utc_ts), time_zone_to.toMonth(utc_ts), time_zone_to.toDayOfMonth(utc_ts), time_zone_to.toHour(utc_ts), time_zone_to.toMinute(utc_ts), time_zone_to.toSecond(utc_ts), micro_second);
+    // Same as calling toYear, toMonth, toDayOfMonth, toHour, toMinute and toSecond of `time_zone_to`,
+    // but looks up the day in the lut only once.
+    const auto & values = time_zone_to.getValues(utc_ts);
+    time_t time = utc_ts - values.date;
+    if (time >= static_cast<time_t>(values.time_at_offset_change()))
+        time += values.amount_of_offset_change();
+    // In case time was changed backwards at the start of next day, the hour 23 is repeated.
+    UInt16 hour = std::min<time_t>(time / 3600, 23);
+    UInt8 minute = time / 60 % 60;
+    return MyDateTime(values.year, values.month, values.day_of_month, hour, minute, time_zone_to.toSecond(utc_ts), micro_second);
 }
 
 MyDateTime convertUTC2TimeZoneByOffset(time_t utc_ts, UInt32 micro_second, Int64 offset)
@@ -974,33 +982,6 @@ std::pair<time_t, UInt32> roundTimeByFsp(time_t second, UInt64 nano_second, UInt
     return std::pair<time_t, UInt32>{second, nano_second / 1000};
 }
 
-// the implementation is the same as TiDB
-int calcDayNum(int year, int month, int day)
-{
-    if (year == 0 && month == 0)
-        return 0;
-    int delsum = 365 * year + 31 * (month - 1) + day;
-    if (month <= 2)
-    {
-        year--;
-    }
-    else
-    {
-        delsum -= (month * 4 + 23) / 10;
-    }
-    int temp = ((year / 100 + 1) * 3) / 4;
-    return delsum + year / 4 - temp;
-}
-
-UInt64 calcSeconds(int year, int month, int day, int hour, int minute, int second)
-{
-    if (year == 0 && month == 0)
-        return 0;
-    Int32 current_days = calcDayNum(year, month, day);
-    return current_days * MyTimeBase::SECOND_IN_ONE_DAY + hour * MyTimeBase::SECOND_IN_ONE_HOUR
-        + minute * MyTimeBase::SECOND_IN_ONE_MINUTE + second;
-}
-
 size_t maxFormattedDateTimeStringLength(const String & format)
 {
     size_t result = 0;
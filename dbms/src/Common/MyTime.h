@@ -194,11 +194,78 @@ MyDateTime convertUTC2TimeZoneByOffset(time_t utc_ts, UInt32 micro_second, Int64
 
 std::pair<time_t, UInt32> roundTimeByFsp(time_t second, UInt64 nano_second, UInt8 fsp);
 
-int calcDayNum(int year, int month, int day);
+// the implementation is the same as TiDB
+inline int calcDayNum(int year, int month, int day)
+{
+    if (year == 0 && month == 0)
+        return 0;
+    int delsum = 365 * year + 31 * (month - 1) + day;
+    if (month <= 2)
+    {
+        year--;
+    }
+    else
+    {
+        delsum -= (month * 4 + 23) / 10;
+    }
+    int temp = ((year / 100 + 1) * 3) / 4;
+    return delsum + year / 4 - temp;
+}
+
 void fromDayNum(MyDateTime & t, int day_num);
 
 // returns seconds since '0000-00-00'
-UInt64 calcSeconds(int year, int month, int day, int hour, int minute, int second);
+inline UInt64 calcSeconds(int year, int month, int day, int hour, int minute, int second)
+{
+    if (year == 0 && month == 0)
+        return 0;
+    Int32 current_days = calcDayNum(year, month, day);
+    return current_days * MyTimeBase::SECOND_IN_ONE_DAY + hour * MyTimeBase::SECOND_IN_ONE_HOUR
+        + minute * MyTimeBase::SECOND_IN_ONE_MINUTE + second;
+}
+
+// Read the fields directly from the packed MyDate/MyDateTime value, see `MyTimeBase::toPackedUInt`.
+// They are cheaper than unpacking the whole value into MyTimeBase when a function only needs a few fields.
+namespace PackedMyTime
+{
+inline UInt16 year(UInt64 packed)
+{
+    return static_cast<UInt16>((packed >> 46) / 13);
+}
+inline UInt8 month(UInt64 packed)
+{
+    return static_cast<UInt8>((packed >> 46) % 13);
+}
+inline UInt8 day(UInt64 packed)
+{
+    return static_cast<UInt8>((packed >> 41) & ((1 << 5) - 1));
+}
+inline UInt8 hour(UInt64 packed)
+{
+    return static_cast<UInt8>((packed >> 36) & ((1 << 5) - 1));
+}
+inline UInt8 minute(UInt64 packed)
+{
+    return static_cast<UInt8>((packed >> 30) & ((1 << 6) - 1));
+}
+inline UInt8 second(UInt64 packed)
+{
+    return static_cast<UInt8>((packed >> 24) & ((1 << 6) - 1));
+}
+inline UInt32 microSecond(UInt64 packed)
+{
+    return static_cast<UInt32>(packed % (1 << 24));
+}
+// Whether the month or the day is zero, which most of the date functions treat as an invalid time.
+inline bool hasZeroMonthOrDay(UInt64 packed)
+{
+    return month(packed) == 0 || day(packed) == 0;
+}
+inline int dayNum(UInt64 packed)
+{
+    return calcDayNum(year(packed), month(packed), day(packed));
+}
+} // namespace PackedMyTime
 
 size_t maxFormattedDateTimeStringLength(const String & format);
 
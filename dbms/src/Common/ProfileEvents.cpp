@@ -27,6 +27,10 @@
     M(WriteBufferFromFileDescriptorWriteBytes) \
     M(ReadBufferAIORead)                       \
     M(ReadBufferAIOReadBytes)                  \
+    M(DirectIORead)                            \
+    M(DirectIOReadBytes)                       \
+    M(MMapFileOpen)                            \
+    M(MMapFileOpenBytes)                       \
     M(WriteBufferAIOWrite)                     \
     M(WriteBufferAIOWriteBytes)                \
                                                \
@@ -35,6 +39,11 @@
     M(UncompressedCacheWeightLost)             \
     M(MarkCacheHits)                           \
     M(MarkCacheMisses)                         \
+    M(DecompressedBlockCacheHits)              \
+    M(DecompressedBlockCacheMisses)            \
+    M(DecompressedBlockCacheWeightLost)        \
+    M(TableScanColumnsCacheHits)               \
+    M(TableScanColumnsCacheMisses)             \
                                                \
     M(ExternalAggregationCompressedBytes)      \
     M(ExternalAggregationUncompressedBytes)    \
@@ -45,6 +54,8 @@
     M(RWLockAcquiredWriteLocks)                \
     M(RWLockReadersWaitMilliseconds)           \
     M(RWLockWritersWaitMilliseconds)           \
+    M(ProfilingLockContended)                  \
+    M(ProfilingLockWaitMicroseconds)           \
                                                \
     M(PSMWritePages)                           \
     M(PSMWriteIOCalls)                         \
@@ -99,16 +110,24 @@
     M(DMFlushDeltaCache)                       \
     M(DMFlushDeltaCacheNS)                     \
     M(DMCleanReadRows)                         \
+    M(DMDeltaIndexEvict)                       \
+    M(DMDeltaIndexEvictBytes)                  \
+    M(DMDeltaIndexRebuild)                     \
                                                \
     M(FileFSync)                               \
                                                \
     M(DMFileFilterNoFilter)                    \
     M(DMFileFilterAftPKAndPackSet)             \
     M(DMFileFilterAftRoughSet)                 \
+    M(DMFileSingleFileMergedReads)             \
+    M(DMFileSingleFileMergedReadBytes)         \
                                                \
     M(ChecksumDigestBytes)                     \
                                                \
-    M(RaftWaitIndexTimeout)
+    M(RaftWaitIndexTimeout)                    \
+                                               \
+    M(HugePageAllocations)                     \
+    M(HugePageAllocatedBytes)
 
 namespace ProfileEvents
 {
@@ -0,0 +1,100 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/ProfileEvents.h>
+#include <Common/ProfilingMutex.h>
+#include <Common/TiFlashMetrics.h>
+
+namespace ProfileEvents
+{
+extern const Event ProfilingLockContended;
+extern const Event ProfilingLockWaitMicroseconds;
+} // namespace ProfileEvents
+
+namespace DB
+{
+std::atomic<bool> LockProfiler::enabled{false};
+
+namespace
+{
+ShardedHistogram & waitHistogram(ProfilingLockType type)
+{
+    switch (type)
+    {
+    case ProfilingLockType::DeltaMergeStore:
+        return GET_METRIC(tiflash_lock_wait_duration_seconds, type_delta_merge_store);
+    case ProfilingLockType::PageDirectory:
+        return GET_METRIC(tiflash_lock_wait_duration_seconds, type_page_directory);
+    case ProfilingLockType::KVStoreTask:
+        return GET_METRIC(tiflash_lock_wait_duration_seconds, type_kvstore_task);
+    case ProfilingLockType::MPPTaskManager:
+        return GET_METRIC(tiflash_lock_wait_duration_seconds, type_mpp_task_manager);
+    case ProfilingLockType::Join:
+        return GET_METRIC(tiflash_lock_wait_duration_seconds, type_join);
+    }
+    __builtin_unreachable();
+}
+
+ShardedHistogram & holdHistogram(ProfilingLockType type)
+{
+    switch (type)
+    {
+    case ProfilingLockType::DeltaMergeStore:
+        return GET_METRIC(tiflash_lock_hold_duration_seconds, type_delta_merge_store);
+    case ProfilingLockType::PageDirectory:
+        return GET_METRIC(tiflash_lock_hold_duration_seconds, type_page_directory);
+    case ProfilingLockType::KVStoreTask:
+        return GET_METRIC(tiflash_lock_hold_duration_seconds, type_kvstore_task);
+    case ProfilingLockType::MPPTaskManager:
+        return GET_METRIC(tiflash_lock_hold_duration_seconds, type_mpp_task_manager);
+    case ProfilingLockType::Join:
+        return GET_METRIC(tiflash_lock_hold_duration_seconds, type_join);
+    }
+    __builtin_unreachable();
+}
+
+ShardedCounter & contendedCounter(ProfilingLockType type)
+{
+    switch (type)
+    {
+    case ProfilingLockType::DeltaMergeStore:
+        return GET_METRIC(tiflash_lock_contended_count, type_delta_merge_store);
+    case ProfilingLockType::PageDirectory:
+        return GET_METRIC(tiflash_lock_contended_count, type_page_directory);
+    case ProfilingLockType::KVStoreTask:
+        return GET_METRIC(tiflash_lock_contended_count, type_kvstore_task);
+    case ProfilingLockType::MPPTaskManager:
+        return GET_METRIC(tiflash_lock_contended_count, type_mpp_task_manager);
+    case ProfilingLockType::Join:
+        return GET_METRIC(tiflash_lock_contended_count, type_join);
+    }
+    __builtin_unreachable();
+}
+} // namespace
+
+void LockProfiler::recordContended(ProfilingLockType type, UInt64 wait_ns)
+{
+    ProfileEvents::increment(ProfileEvents::ProfilingLockContended);
+    ProfileEvents::increment(ProfileEvents::ProfilingLockWaitMicroseconds, wait_ns / 1000);
+    contendedCounter(type).Increment();
+    waitHistogram(type).Observe(wait_ns / 1e9);
+}
+
+void LockProfiler::recordHold(ProfilingLockType type, UInt64 hold_ns)
+{
+    holdHistogram(type).Observe(hold_ns / 1e9);
+}
+
+} // namespace DB
@@ -0,0 +1,141 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/Stopwatch.h>
+#include <common/types.h>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+namespace DB
+{
+/// The kinds of the locks profiled by `ProfilingMutex` and `ProfilingSharedMutex`.
+/// The locks of the same kind share the metrics, e.g. the `read_write_mutex` of all the DeltaMergeStores.
+enum class ProfilingLockType
+{
+    DeltaMergeStore,
+    PageDirectory,
+    KVStoreTask,
+    MPPTaskManager,
+    Join,
+};
+
+/// Records the contention of the profiled locks into the ProfileEvents and the `tiflash_lock_*` metrics.
+/// It is disabled by default since it reads the clock on every acquisition, see `enable_lock_profiling` in the config.
+class LockProfiler
+{
+public:
+    static void setEnabled(bool enabled_) { enabled.store(enabled_, std::memory_order_relaxed); }
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /// Called after an acquisition that has waited `wait_ns` for the lock.
+    static void recordContended(ProfilingLockType type, UInt64 wait_ns);
+
+    /// Called after an exclusive lock held for `hold_ns` is released.
+    static void recordHold(ProfilingLockType type, UInt64 hold_ns);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+namespace detail
+{
+template <typename Mutex>
+class ProfilingMutexImpl
+{
+public:
+    explicit ProfilingMutexImpl(ProfilingLockType type_)
+        : type(type_)
+    {}
+
+    void lock()
+    {
+        if (!LockProfiler::isEnabled())
+        {
+            mutex.lock();
+            acquired_ns = 0;
+            return;
+        }
+        // Only the contended acquisitions are timed, an uncontended `try_lock` is as cheap as `lock`.
+        if (!mutex.try_lock())
+        {
+            auto start_ns = clock_gettime_ns();
+            mutex.lock();
+            LockProfiler::recordContended(type, clock_gettime_ns() - start_ns);
+        }
+        acquired_ns = clock_gettime_ns();
+    }
+
+    bool try_lock()
+    {
+        if (!mutex.try_lock())
+            return false;
+        acquired_ns = LockProfiler::isEnabled() ? clock_gettime_ns() : 0;
+        return true;
+    }
+
+    void unlock()
+    {
+        // Read `acquired_ns` before releasing the lock, it is protected by the lock.
+        UInt64 hold_ns = acquired_ns == 0 ? 0 : clock_gettime_ns() - acquired_ns;
+        mutex.unlock();
+        if (hold_ns != 0)
+            LockProfiler::recordHold(type, hold_ns);
+    }
+
+protected:
+    Mutex mutex;
+    const ProfilingLockType type;
+    // The time when the exclusive lock is acquired, 0 if the lock profiling was disabled then.
+    UInt64 acquired_ns = 0;
+};
+} // namespace detail
+
+/// A drop-in replacement of `std::mutex` that records the time waiting for and holding the lock.
+/// Note that it can not be used with `std::condition_variable`, use `std::condition_variable_any` instead.
+using ProfilingMutex = detail::ProfilingMutexImpl<std::mutex>;
+
+/// A drop-in replacement of `std::shared_mutex` that records the time waiting for the lock.
+/// The time holding the lock is only recorded for the exclusive owner.
+class ProfilingSharedMutex : public detail::ProfilingMutexImpl<std::shared_mutex>
+{
+public:
+    using ProfilingMutexImpl::ProfilingMutexImpl;
+
+    void lock_shared()
+    {
+        if (!LockProfiler::isEnabled())
+        {
+            mutex.lock_shared();
+            return;
+        }
+        if (!mutex.try_lock_shared())
+        {
+            auto start_ns = clock_gettime_ns();
+            mutex.lock_shared();
+            LockProfiler::recordContended(type, clock_gettime_ns() - start_ns);
+        }
+    }
+
+    bool try_lock_shared() { return mutex.try_lock_shared(); }
+
+    void unlock_shared() { mutex.unlock_shared(); }
+};
+
+} // namespace DB
@@ -274,3 +274,56 @@ radixSort(T * arr, size_t size)
 {
     return RadixSort<RadixSortFloatTraits<T>>::execute(arr, size);
 }
+
+
+/** Radix-get-permutation for integer keys: sorts the indexes of the rows instead of the keys.
+  * The key of each row is transformed into an unsigned integer, and stored along with the row index.
+  */
+template <typename KeyBits_>
+struct RadixSortIndexedElement
+{
+    KeyBits_ key;
+    uint32_t index;
+};
+
+template <typename KeyBits_>
+struct RadixSortIndexedTraits
+{
+    using Element = RadixSortIndexedElement<KeyBits_>;
+    using Key = KeyBits_;
+    using CountType = uint32_t;
+    using KeyBits = KeyBits_;
+
+    static constexpr size_t PART_SIZE_BITS = 8;
+
+    using Transform = RadixSortIdentityTransform<KeyBits>;
+    using Allocator = RadixSortMallocAllocator;
+
+    static Key & extractKey(Element & elem) { return elem.key; }
+};
+
+/// Write the stable permutation that sorts `keys` to `res`, in descending order if `reverse`.
+/// The indexes are stored in 32 bits, so `size` must be less than 2^32.
+template <typename T, typename Index>
+std::enable_if_t<std::is_integral_v<T>, void>
+radixSortGetPermutation(const T * keys, size_t size, bool reverse, Index * res)
+{
+    using KeyBits = std::make_unsigned_t<T>;
+    using Traits = RadixSortIndexedTraits<KeyBits>;
+    using Element = typename Traits::Element;
+
+    /// Flip the sign bit of the signed keys, and all the bits for the descending order.
+    constexpr KeyBits sign_bit = std::is_signed_v<T> ? KeyBits(KeyBits(1) << (sizeof(KeyBits) * 8 - 1)) : KeyBits(0);
+    const KeyBits flip_bits = reverse ? KeyBits(~sign_bit) : sign_bit;
+
+    typename Traits::Allocator allocator;
+    auto * elems = reinterpret_cast<Element *>(allocator.allocate(size * sizeof(Element)));
+    for (size_t i = 0; i < size; ++i)
+        elems[i] = Element{static_cast<KeyBits>(static_cast<KeyBits>(keys[i]) ^ flip_bits), static_cast<uint32_t>(i)};
+
+    RadixSort<Traits>::execute(elems, size);
+
+    for (size_t i = 0; i < size; ++i)
+        res[i] = elems[i].index;
+    allocator.deallocate(elems, size * sizeof(Element));
+}
@@ -0,0 +1,241 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <Common/FmtUtils.h>
+#include <Common/SamplingProfiler.h>
+#include <Common/setThreadName.h>
+#include <Symbolization/Symbolization.h>
+#include <common/demangle.h>
+#include <common/logger_useful.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+extern const int CANNOT_SET_SIGNAL_HANDLER;
+extern const int CANNOT_SET_TIMER_PERIOD;
+} // namespace ErrorCodes
+
+namespace
+{
+thread_local char thread_tag[SamplingProfiler::max_tag_size] = {0};
+
+/// The frames of `collectSample`, `signalHandler` and the signal trampoline of kernel
+constexpr int frames_to_skip = 3;
+
+void setProfilingTimer(UInt64 interval_us)
+{
+    struct itimerval timer;
+    timer.it_interval.tv_sec = interval_us / 1000000;
+    timer.it_interval.tv_usec = interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0)
+        throwFromErrno("Cannot set the timer of sampling profiler", ErrorCodes::CANNOT_SET_TIMER_PERIOD);
+}
+} // namespace
+
+SamplingProfiler & SamplingProfiler::instance()
+{
+    static SamplingProfiler profiler;
+    return profiler;
+}
+
+SamplingProfiler::SamplingProfiler()
+    : ring_buffer(ring_buffer_size)
+{}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+void SamplingProfiler::setThreadTag(const String & tag)
+{
+    /// The signal handler may interrupt current thread at any time, so the tag is kept empty while copying
+    size_t size = std::min(tag.size(), max_tag_size - 1);
+    thread_tag[0] = '\0';
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    if (size > 1)
+        memcpy(thread_tag + 1, tag.data() + 1, size - 1);
+    thread_tag[size] = '\0';
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    if (size > 0)
+        thread_tag[0] = tag[0];
+}
+
+String SamplingProfiler::getThreadTag()
+{
+    return String(thread_tag);
+}
+
+bool SamplingProfiler::start(UInt64 interval_us)
+{
+    if (interval_us == 0)
+        throw Exception("The interval of sampling profiler must be positive", ErrorCodes::LOGICAL_ERROR);
+
+    std::lock_guard lock(drain_thread_mutex);
+    if (running.load(std::memory_order_acquire))
+        return false;
+
+    /// The first call of `backtrace` may load libgcc and allocate memory, which is not safe in the signal handler
+    void * warm_up_frames[max_frames];
+    backtrace(warm_up_frames, max_frames);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = &SamplingProfiler::signalHandler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, nullptr) != 0)
+        throwFromErrno("Cannot set signal handler of sampling profiler", ErrorCodes::CANNOT_SET_SIGNAL_HANDLER);
+
+    running.store(true, std::memory_order_release);
+    drain_thread = std::thread([this] { drainLoop(); });
+    setProfilingTimer(interval_us);
+    LOG_FMT_INFO(&Poco::Logger::get("SamplingProfiler"), "Sampling profiler started, interval: {}us", interval_us);
+    return true;
+}
+
+void SamplingProfiler::stop()
+{
+    {
+        std::lock_guard lock(drain_thread_mutex);
+        if (!running.load(std::memory_order_acquire))
+            return;
+        /// The signal handler is kept installed, a pending SIGPROF after stopping the timer is ignored by `collectSample`
+        setProfilingTimer(0);
+        running.store(false, std::memory_order_release);
+    }
+    drain_thread_cv.notify_all();
+    drain_thread.join();
+    drain();
+    LOG_FMT_INFO(&Poco::Logger::get("SamplingProfiler"), "Sampling profiler stopped, samples: {}, dropped: {}", samples.load(), dropped.load());
+}
+
+void SamplingProfiler::reset()
+{
+    std::lock_guard lock(aggregated_mutex);
+    aggregated_samples.clear();
+    samples = 0;
+    dropped = 0;
+}
+
+SamplingProfiler::Stats SamplingProfiler::getStats() const
+{
+    return Stats{samples.load(std::memory_order_relaxed), dropped.load(std::memory_order_relaxed)};
+}
+
+void SamplingProfiler::signalHandler(int)
+{
+    auto saved_errno = errno;
+    instance().collectSample();
+    errno = saved_errno;
+}
+
+void __attribute__((noinline)) SamplingProfiler::collectSample()
+{
+    if (!running.load(std::memory_order_relaxed))
+        return;
+
+    auto & sample = ring_buffer[write_pos.fetch_add(1, std::memory_order_relaxed) % ring_buffer_size];
+    UInt8 expected = 0;
+    if (!sample.state.compare_exchange_strong(expected, 1, std::memory_order_acquire))
+    {
+        /// The drain thread can not keep up, drop the sample
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    void * frames[max_frames + frames_to_skip];
+    int size = backtrace(frames, max_frames + frames_to_skip);
+    size = std::max(0, size - frames_to_skip);
+    memcpy(sample.frames, frames + frames_to_skip, size * sizeof(void *));
+    sample.frames_size = size;
+    memcpy(sample.tag, thread_tag, max_tag_size);
+    sample.tag[max_tag_size - 1] = '\0';
+
+    sample.state.store(2, std::memory_order_release);
+    samples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::drain()
+{
+    std::lock_guard lock(aggregated_mutex);
+    for (auto & sample : ring_buffer)
+    {
+        if (sample.state.load(std::memory_order_acquire) != 2)
+            continue;
+        StackKey key{String(sample.tag), std::vector<void *>(sample.frames, sample.frames + sample.frames_size)};
+        ++aggregated_samples[key];
+        sample.state.store(0, std::memory_order_release);
+    }
+}
+
+void SamplingProfiler::drainLoop()
+{
+    setThreadName("SampleProfiler");
+    std::unique_lock lock(drain_thread_mutex);
+    while (running.load(std::memory_order_acquire))
+    {
+        drain_thread_cv.wait_for(lock, std::chrono::milliseconds(100));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+String SamplingProfiler::dumpFolded() const
+{
+    std::map<StackKey, UInt64> snapshot;
+    {
+        std::lock_guard lock(aggregated_mutex);
+        snapshot = aggregated_samples;
+    }
+
+    FmtBuffer buffer;
+    std::unordered_map<void *, String> symbols;
+    for (const auto & [key, count] : snapshot)
+    {
+        const auto & [tag, frames] = key;
+        buffer.append(tag.empty() ? "[untagged]" : tag);
+        /// `backtrace` returns the leaf frame first, the folded format starts from the root frame
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+        {
+            auto symbol_it = symbols.find(*it);
+            if (symbol_it == symbols.end())
+            {
+                auto sym_info = _tiflash_symbolize(*it);
+                String symbol = sym_info.symbol_name ? demangle(sym_info.symbol_name) : fmt::format("{}", *it);
+                std::replace(symbol.begin(), symbol.end(), ';', ':');
+                symbol_it = symbols.emplace(*it, std::move(symbol)).first;
+            }
+            buffer.append(";").append(symbol_it->second);
+        }
+        buffer.fmtAppend(" {}\n", count);
+    }
+    return buffer.toString();
+}
+
+} // namespace DB
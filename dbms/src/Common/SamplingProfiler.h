@@ -0,0 +1,123 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/Stopwatch.h>
+#include <common/types.h>
+
+#include <atomic>
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DB
+{
+/// A process wide sampling cpu profiler.
+/// When it is running, a SIGPROF interval timer samples the stack of the thread consuming cpu. Each sample is
+/// tagged by the profiling tag of the sampled thread, e.g. the id of the MPP task it is working for, so that the
+/// hot paths can be attributed to queries without attaching external tools.
+///
+/// The signal handler only copies the frames into a preallocated ring buffer, a background thread drains the
+/// buffer and aggregates the samples by (tag, stack).
+class SamplingProfiler : private boost::noncopyable
+{
+public:
+    static constexpr size_t max_frames = 32;
+    static constexpr size_t max_tag_size = 64;
+
+    static SamplingProfiler & instance();
+
+    /// Start sampling every `interval_us` of the cpu time consumed by this process.
+    /// Return false if the profiler is already running.
+    bool start(UInt64 interval_us);
+    /// Stop sampling, the samples aggregated so far are kept until `reset`.
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    void reset();
+
+    /// Dump the aggregated samples in the folded format consumed by flame graph tools, one stack per line:
+    /// "<tag>;<root frame>;...;<leaf frame> <count>"
+    String dumpFolded() const;
+
+    struct Stats
+    {
+        UInt64 samples = 0;
+        UInt64 dropped = 0;
+    };
+    Stats getStats() const;
+
+    /// The tag of current thread, at most `max_tag_size - 1` characters are kept.
+    static void setThreadTag(const String & tag);
+    static String getThreadTag();
+
+    /// Set the tag of current thread in the scope, and restore the previous one on exit.
+    class ThreadTagSetter : private boost::noncopyable
+    {
+    public:
+        explicit ThreadTagSetter(const String & tag)
+            : prev_tag(getThreadTag())
+        {
+            setThreadTag(tag);
+        }
+        ~ThreadTagSetter() { setThreadTag(prev_tag); }
+
+    private:
+        String prev_tag;
+    };
+
+    ~SamplingProfiler();
+
+private:
+    SamplingProfiler();
+
+    static void signalHandler(int sig);
+
+    /// Called in the signal handler, must be async signal safe.
+    void collectSample();
+    /// Move the samples in the ring buffer into `aggregated_samples`.
+    void drain();
+    void drainLoop();
+
+    struct Sample
+    {
+        /// 0: empty, 1: being written, 2: ready to drain
+        std::atomic<UInt8> state{0};
+        UInt8 frames_size = 0;
+        void * frames[max_frames];
+        char tag[max_tag_size];
+    };
+
+    static constexpr size_t ring_buffer_size = 16384;
+    std::vector<Sample> ring_buffer;
+    std::atomic<UInt64> write_pos{0};
+    std::atomic<UInt64> samples{0};
+    std::atomic<UInt64> dropped{0};
+
+    std::atomic<bool> running{false};
+    std::thread drain_thread;
+    std::mutex drain_thread_mutex;
+    std::condition_variable drain_thread_cv;
+
+    using StackKey = std::pair<String, std::vector<void *>>;
+    mutable std::mutex aggregated_mutex;
+    std::map<StackKey, UInt64> aggregated_samples;
+};
+
+} // namespace DB
@@ -0,0 +1,81 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/ShardedMetric.h>
+
+namespace DB
+{
+size_t IShardedMetric::getShardIndex()
+{
+    static std::atomic<size_t> next_index{0};
+    thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+    return index;
+}
+
+void ShardedCounter::flush()
+{
+    double value = 0;
+    for (auto & shard : shards)
+        value += shard.value.exchange(0.0, std::memory_order_relaxed);
+    if (value != 0)
+        counter.Increment(value);
+}
+
+ShardedHistogram::ShardedHistogram(prometheus::Histogram & histogram_, prometheus::Histogram::BucketBoundaries boundaries_)
+    : histogram(histogram_)
+    , boundaries(std::move(boundaries_))
+{
+    for (auto & shard : shards)
+    {
+        shard.bucket_counts = std::make_unique<std::atomic<UInt64>[]>(boundaries.size() + 1);
+        for (size_t i = 0; i <= boundaries.size(); ++i)
+            shard.bucket_counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void ShardedHistogram::flush()
+{
+    std::vector<double> bucket_increments(boundaries.size() + 1, 0);
+    double sum = 0;
+    bool observed = false;
+    for (auto & shard : shards)
+    {
+        for (size_t i = 0; i < bucket_increments.size(); ++i)
+        {
+            if (auto count = shard.bucket_counts[i].exchange(0, std::memory_order_relaxed); count > 0)
+            {
+                bucket_increments[i] += count;
+                observed = true;
+            }
+        }
+        sum += shard.sum.exchange(0.0, std::memory_order_relaxed);
+    }
+    if (observed)
+        histogram.ObserveMultiple(bucket_increments, sum);
+}
+
+ShardedMetrics & ShardedMetrics::instance()
+{
+    static ShardedMetrics sharded_metrics;
+    return sharded_metrics;
+}
+
+void ShardedMetrics::flush()
+{
+    std::lock_guard lock(mutex);
+    for (auto & metric : metrics)
+        metric->flush();
+}
+
+} // namespace DB
@@ -0,0 +1,141 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/nocopyable.h>
+#include <common/types.h>
+#include <prometheus/counter.h>
+#include <prometheus/histogram.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace DB
+{
+/// The metrics of prometheus-cpp update the same atomics on each call, which bounce between the cores when they are
+/// updated by many threads on the hot paths. The sharded metrics accumulate the updates in the shard of the calling
+/// thread, and the shards are merged into the prometheus metric by `flush`, which is called by `MetricsPrometheus`
+/// like the way it copies the profile events.
+class IShardedMetric
+{
+public:
+    static constexpr size_t NUM_SHARDS = 16;
+
+    virtual ~IShardedMetric() = default;
+
+    virtual void flush() = 0;
+
+protected:
+    /// Each thread sticks to one shard, and the threads are spread over the shards by round robin.
+    static size_t getShardIndex();
+
+    static void atomicAdd(std::atomic<double> & target, double value)
+    {
+        auto current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+        {
+        }
+    }
+};
+
+class ShardedCounter final : public IShardedMetric
+{
+public:
+    explicit ShardedCounter(prometheus::Counter & counter_)
+        : counter(counter_)
+    {}
+
+    void Increment(double value = 1.0) { atomicAdd(shards[getShardIndex()].value, value); }
+
+    /// Including the updates not flushed yet.
+    double Value() const
+    {
+        double value = counter.Value();
+        for (const auto & shard : shards)
+            value += shard.value.load(std::memory_order_relaxed);
+        return value;
+    }
+
+    void flush() override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<double> value{0.0};
+    };
+
+    prometheus::Counter & counter;
+    std::array<Shard, NUM_SHARDS> shards;
+};
+
+class ShardedHistogram final : public IShardedMetric
+{
+public:
+    ShardedHistogram(prometheus::Histogram & histogram_, prometheus::Histogram::BucketBoundaries boundaries_);
+
+    void Observe(double value)
+    {
+        /// The same bucket as prometheus::Histogram::Observe, the last one is for +Inf.
+        size_t bucket = std::lower_bound(boundaries.begin(), boundaries.end(), value) - boundaries.begin();
+        auto & shard = shards[getShardIndex()];
+        shard.bucket_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        atomicAdd(shard.sum, value);
+    }
+
+    void flush() override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::unique_ptr<std::atomic<UInt64>[]> bucket_counts;
+        std::atomic<double> sum{0.0};
+    };
+
+    prometheus::Histogram & histogram;
+    const prometheus::Histogram::BucketBoundaries boundaries;
+    std::array<Shard, NUM_SHARDS> shards;
+};
+
+/// Owns all the sharded metrics, so that they can be flushed together.
+class ShardedMetrics
+{
+public:
+    static ShardedMetrics & instance();
+
+    template <typename T, typename... Args>
+    T & add(Args &&... args)
+    {
+        auto metric = std::make_unique<T>(std::forward<Args>(args)...);
+        auto & res = *metric;
+        std::lock_guard lock(mutex);
+        metrics.push_back(std::move(metric));
+        return res;
+    }
+
+    void flush();
+
+private:
+    ShardedMetrics() = default;
+    DISALLOW_COPY_AND_MOVE(ShardedMetrics);
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<IShardedMetric>> metrics;
+};
+
+} // namespace DB
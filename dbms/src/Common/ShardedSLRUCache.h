@@ -0,0 +1,449 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/LRUCache.h>
+#include <common/logger_useful.h>
+
+#include <atomic>
+#include <chrono>
+#include <ext/scope_guard.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace DB
+{
+/// Thread-safe cache with the same interface as `LRUCache`, but
+/// - the entries are split into several shards by the hash of key, each shard has its own lock, and
+/// - each shard is a segmented LRU (SLRU) which is resistant to scans.
+///
+/// A shard keeps two LRU queues: new entries are inserted into the probationary queue, and are
+/// promoted to the protected queue when they are hit again. Entries are always evicted from the
+/// probationary queue first, so a full scan which touches every entry only once can not flush the
+/// hot entries in the protected queue. When the protected queue exceeds its quota, its least recently
+/// used entries are demoted back to the probationary queue.
+///
+/// Like `LRUCache`, an entry is only evicted when its expiration time is due.
+template <typename TKey,
+          typename TMapped,
+          typename HashFunction = std::hash<TKey>,
+          typename WeightFunction = TrivialWeightFunction<TMapped>>
+class ShardedSLRUCache
+{
+public:
+    using Key = TKey;
+    using Mapped = TMapped;
+    using MappedPtr = std::shared_ptr<Mapped>;
+    using Delay = std::chrono::seconds;
+
+    static constexpr size_t DEFAULT_NUM_SHARDS = 16;
+    /// The percent of weight of a shard that can be used by the protected queue.
+    static constexpr size_t PROTECTED_PERCENT = 80;
+
+    explicit ShardedSLRUCache(size_t max_size_, const Delay & expiration_delay_ = Delay::zero(), size_t num_shards = DEFAULT_NUM_SHARDS)
+    {
+        num_shards = std::max(static_cast<size_t>(1), num_shards);
+        size_t shard_max_size = std::max(static_cast<size_t>(1), max_size_ / num_shards);
+        shards.reserve(num_shards);
+        for (size_t i = 0; i < num_shards; ++i)
+            shards.emplace_back(std::make_unique<Shard>(shard_max_size, expiration_delay_));
+    }
+
+    virtual ~ShardedSLRUCache() = default;
+
+    MappedPtr get(const Key & key)
+    {
+        auto & shard = getShard(key);
+        std::lock_guard lock(shard.mutex);
+        auto res = shard.getImpl(key, lock);
+        if (res)
+            ++hits;
+        else
+            ++misses;
+        return res;
+    }
+
+    void set(const Key & key, const MappedPtr & mapped)
+    {
+        auto & shard = getShard(key);
+        size_t weight_lost = 0;
+        {
+            std::lock_guard lock(shard.mutex);
+            weight_lost = shard.setImpl(key, mapped, lock);
+        }
+        onRemoveOverflowWeightLoss(weight_lost);
+    }
+
+    /// The same as `LRUCache::getOrSet`: only one of several concurrent threads calling getOrSet()
+    /// for the same key will call load_func(), others will wait for that call to complete and reuse its result.
+    ///
+    /// Returns std::pair of the cached value and a bool indicating whether the value was produced during this call.
+    template <typename LoadFunc>
+    std::pair<MappedPtr, bool> getOrSet(const Key & key, LoadFunc && load_func)
+    {
+        auto & shard = getShard(key);
+        std::shared_ptr<InsertToken> token;
+        {
+            std::lock_guard lock(shard.mutex);
+            if (auto val = shard.getImpl(key, lock); val)
+            {
+                ++hits;
+                return std::make_pair(val, false);
+            }
+            auto & t = shard.insert_tokens[key];
+            if (!t)
+                t = std::make_shared<InsertToken>();
+            token = t;
+            ++token->refcount;
+        }
+
+        /// Remove the token from the shard when the last user of it is done.
+        SCOPE_EXIT({
+            std::lock_guard lock(shard.mutex);
+            if (--token->refcount == 0)
+            {
+                auto it = shard.insert_tokens.find(key);
+                if (it != shard.insert_tokens.end() && it->second == token)
+                    shard.insert_tokens.erase(it);
+            }
+        });
+
+        std::lock_guard token_lock(token->mutex);
+        if (token->value)
+        {
+            /// Another thread already produced the value while we waited for token->mutex.
+            ++hits;
+            return std::make_pair(token->value, false);
+        }
+
+        ++misses;
+        token->value = load_func();
+
+        size_t weight_lost = 0;
+        {
+            std::lock_guard lock(shard.mutex);
+            /// Insert the new value only if the token is still present (it may be removed by a concurrent reset()).
+            auto it = shard.insert_tokens.find(key);
+            if (it != shard.insert_tokens.end() && it->second == token)
+                weight_lost = shard.setImpl(key, token->value, lock);
+        }
+        onRemoveOverflowWeightLoss(weight_lost);
+        return std::make_pair(token->value, true);
+    }
+
+    void remove(const Key & key)
+    {
+        auto & shard = getShard(key);
+        std::lock_guard lock(shard.mutex);
+        shard.removeImpl(key, lock);
+    }
+
+    void getStats(size_t & out_hits, size_t & out_misses) const
+    {
+        out_hits = hits;
+        out_misses = misses;
+    }
+
+    size_t weight() const
+    {
+        size_t res = 0;
+        for (const auto & shard : shards)
+        {
+            std::lock_guard lock(shard->mutex);
+            res += shard->current_size;
+        }
+        return res;
+    }
+
+    size_t count() const
+    {
+        size_t res = 0;
+        for (const auto & shard : shards)
+        {
+            std::lock_guard lock(shard->mutex);
+            res += shard->cells.size();
+        }
+        return res;
+    }
+
+    /// Evict entries from each shard (probationary ones first) until `bytes_to_free` bytes are freed
+    /// or the cache is empty. Return the bytes freed. Used to reclaim memory under memory pressure, see `MemoryArbiter`.
+    size_t evict(size_t bytes_to_free)
+    {
+        size_t freed = 0;
+        /// Evict evenly from the shards so that a single shard is not flushed.
+        size_t bytes_per_shard = bytes_to_free / shards.size() + 1;
+        for (auto & shard : shards)
+        {
+            std::lock_guard lock(shard->mutex);
+            freed += shard->evictImpl(bytes_per_shard, lock);
+        }
+        for (auto & shard : shards)
+        {
+            if (freed >= bytes_to_free)
+                break;
+            std::lock_guard lock(shard->mutex);
+            freed += shard->evictImpl(bytes_to_free - freed, lock);
+        }
+        onRemoveOverflowWeightLoss(freed);
+        return freed;
+    }
+
+    void reset()
+    {
+        for (auto & shard : shards)
+        {
+            std::lock_guard lock(shard->mutex);
+            shard->probation.clear();
+            shard->protect.clear();
+            shard->cells.clear();
+            shard->insert_tokens.clear();
+            shard->current_size = 0;
+            shard->protected_size = 0;
+        }
+        hits = 0;
+        misses = 0;
+    }
+
+protected:
+    /// Override this method if you want to track how much weight was lost by eviction.
+    virtual void onRemoveOverflowWeightLoss(size_t /*weight_loss*/) {}
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Timestamp = Clock::time_point;
+
+    /// Represents pending insertion attempt.
+    struct InsertToken
+    {
+        std::mutex mutex;
+        MappedPtr value; /// Protected by the token mutex
+        size_t refcount = 0; /// Protected by the shard mutex
+    };
+
+    using Queue = std::list<Key>;
+    using QueueIterator = typename Queue::iterator;
+
+    struct Cell
+    {
+        bool expired(const Timestamp & last_timestamp, const Delay & expiration_delay) const
+        {
+            return (expiration_delay == Delay::zero())
+                || ((last_timestamp > timestamp) && ((last_timestamp - timestamp) > expiration_delay));
+        }
+
+        MappedPtr value;
+        size_t size = 0;
+        bool is_protected = false;
+        QueueIterator queue_iterator;
+        Timestamp timestamp;
+    };
+
+    struct Shard
+    {
+        Shard(size_t max_size_, const Delay & expiration_delay_)
+            : max_size(max_size_)
+            , max_protected_size(std::max(static_cast<size_t>(1), max_size_ * PROTECTED_PERCENT / 100))
+            , expiration_delay(expiration_delay_)
+        {}
+
+        MappedPtr getImpl(const Key & key, [[maybe_unused]] std::lock_guard<std::mutex> & lock)
+        {
+            auto it = cells.find(key);
+            if (it == cells.end())
+                return MappedPtr();
+
+            Cell & cell = it->second;
+            updateCellTimestamp(cell);
+            if (cell.is_protected)
+            {
+                protect.splice(protect.end(), protect, cell.queue_iterator);
+            }
+            else
+            {
+                /// Hit again in the probationary queue, promote it.
+                protect.splice(protect.end(), probation, cell.queue_iterator);
+                cell.is_protected = true;
+                protected_size += cell.size;
+                demoteOverflow();
+            }
+            return cell.value;
+        }
+
+        /// Return the weight evicted.
+        size_t setImpl(const Key & key, const MappedPtr & mapped, [[maybe_unused]] std::lock_guard<std::mutex> & lock)
+        {
+            auto res = cells.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+            Cell & cell = res.first->second;
+            if (res.second)
+            {
+                try
+                {
+                    cell.queue_iterator = probation.insert(probation.end(), key);
+                }
+                catch (...)
+                {
+                    // If insert() throws exception, cells and queue will be in inconsistent.
+                    cells.erase(res.first);
+                    throw;
+                }
+            }
+            else
+            {
+                current_size -= cell.size;
+                if (cell.is_protected)
+                {
+                    protected_size -= cell.size;
+                    protect.splice(protect.end(), protect, cell.queue_iterator);
+                }
+                else
+                {
+                    probation.splice(probation.end(), probation, cell.queue_iterator);
+                }
+            }
+
+            cell.value = mapped;
+            cell.size = cell.value ? WeightFunction()(*cell.value) : 0;
+            current_size += cell.size;
+            if (cell.is_protected)
+            {
+                protected_size += cell.size;
+                demoteOverflow();
+            }
+            updateCellTimestamp(cell);
+
+            return removeOverflow(cell.timestamp);
+        }
+
+        void removeImpl(const Key & key, [[maybe_unused]] std::lock_guard<std::mutex> & lock)
+        {
+            auto it = cells.find(key);
+            if (it == cells.end())
+                return;
+            eraseCell(it);
+        }
+
+        size_t evictImpl(size_t bytes_to_free, [[maybe_unused]] std::lock_guard<std::mutex> & lock)
+        {
+            size_t freed = 0;
+            while (freed < bytes_to_free && !cells.empty())
+            {
+                Queue & queue = probation.empty() ? protect : probation;
+                freed += eraseCell(findCell(queue.front()));
+            }
+            return freed;
+        }
+
+        /// Move the least recently used protected entries to the probationary queue if the protected queue
+        /// exceeds its quota.
+        void demoteOverflow()
+        {
+            while (protected_size > max_protected_size && protect.size() > 1)
+            {
+                auto it = findCell(protect.front());
+                Cell & cell = it->second;
+                probation.splice(probation.end(), protect, cell.queue_iterator);
+                cell.is_protected = false;
+                protected_size -= cell.size;
+            }
+        }
+
+        size_t removeOverflow(const Timestamp & last_timestamp)
+        {
+            size_t weight_lost = 0;
+            while (current_size > max_size && cells.size() > 1)
+            {
+                Queue & queue = probation.empty() ? protect : probation;
+                auto it = findCell(queue.front());
+                if (!it->second.expired(last_timestamp, expiration_delay))
+                    break;
+                weight_lost += eraseCell(it);
+            }
+
+            if (current_size > (1ull << 63))
+            {
+                LOG_FMT_ERROR(&Poco::Logger::get("ShardedSLRUCache"), "ShardedSLRUCache became inconsistent. There must be a bug in it.");
+                abort();
+            }
+            return weight_lost;
+        }
+
+        typename std::unordered_map<Key, Cell, HashFunction>::iterator findCell(const Key & key)
+        {
+            auto it = cells.find(key);
+            if (it == cells.end())
+            {
+                LOG_FMT_ERROR(&Poco::Logger::get("ShardedSLRUCache"), "ShardedSLRUCache became inconsistent. There must be a bug in it.");
+                abort();
+            }
+            return it;
+        }
+
+        size_t eraseCell(typename std::unordered_map<Key, Cell, HashFunction>::iterator it)
+        {
+            Cell & cell = it->second;
+            size_t size = cell.size;
+            if (cell.is_protected)
+            {
+                protect.erase(cell.queue_iterator);
+                protected_size -= size;
+            }
+            else
+            {
+                probation.erase(cell.queue_iterator);
+            }
+            current_size -= size;
+            cells.erase(it);
+            return size;
+        }
+
+        void updateCellTimestamp(Cell & cell)
+        {
+            if (expiration_delay != Delay::zero())
+                cell.timestamp = Clock::now();
+        }
+
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Cell, HashFunction> cells;
+        std::unordered_map<Key, std::shared_ptr<InsertToken>, HashFunction> insert_tokens;
+        Queue probation;
+        Queue protect;
+
+        /// Total weight of values.
+        size_t current_size = 0;
+        /// Weight of values in the protected queue.
+        size_t protected_size = 0;
+        const size_t max_size;
+        const size_t max_protected_size;
+        const Delay expiration_delay;
+    };
+
+    Shard & getShard(const Key & key)
+    {
+        /// The low bits are used by the hash table inside the shard, use the high bits to choose the shard.
+        size_t hash = HashFunction()(key);
+        return *shards[((hash >> 32) ^ hash) % shards.size()];
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+};
+
+} // namespace DB
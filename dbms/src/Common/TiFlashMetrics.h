@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/ShardedMetric.h>
 #include <Common/TiFlashBuildInfo.h>
 #include <Common/nocopyable.h>
 #include <prometheus/counter.h>
@@ -41,15 +42,19 @@ namespace DB
 /// 2. Keep metrics with same prefix next to each other.
 /// 3. Add metrics of new subsystems at tail.
 /// 4. Keep it proper formatted using clang-format.
+/// 5. Use ShardedCounter/ShardedHistogram instead of Counter/Histogram for the metrics updated by many threads on the hot
+///    paths, their values are exported after being flushed by MetricsPrometheus.
 // clang-format off
 #define APPLY_FOR_METRICS(M, F)                                                                                                           \
     M(tiflash_coprocessor_request_count, "Total number of request", Counter, F(type_batch, {"type", "batch"}),                            \
         F(type_batch_cop, {"type", "batch_cop"}), F(type_cop, {"type", "cop"}), F(type_cop_dag, {"type", "cop_dag"}),                     \
+        F(type_cop_stream, {"type", "cop_stream"}),                                                                                       \
         F(type_super_batch, {"type", "super_batch"}), F(type_super_batch_cop_dag, {"type", "super_batch_cop_dag"}),                       \
         F(type_dispatch_mpp_task, {"type", "dispatch_mpp_task"}), F(type_mpp_establish_conn, {"type", "mpp_establish_conn"}),             \
         F(type_cancel_mpp_task, {"type", "cancel_mpp_task"}), F(type_run_mpp_task, {"type", "run_mpp_task"}))                             \
     M(tiflash_coprocessor_handling_request_count, "Number of handling request", Gauge, F(type_batch, {"type", "batch"}),                  \
         F(type_batch_cop, {"type", "batch_cop"}), F(type_cop, {"type", "cop"}), F(type_cop_dag, {"type", "cop_dag"}),                     \
+        F(type_cop_stream, {"type", "cop_stream"}),                                                                                       \
         F(type_super_batch, {"type", "super_batch"}), F(type_super_batch_cop_dag, {"type", "super_batch_cop_dag"}),                       \
         F(type_dispatch_mpp_task, {"type", "dispatch_mpp_task"}), F(type_mpp_establish_conn, {"type", "mpp_establish_conn"}),             \
         F(type_cancel_mpp_task, {"type", "cancel_mpp_task"}), F(type_run_mpp_task, {"type", "run_mpp_task"}))                             \
@@ -61,6 +66,7 @@ namespace DB
         F(type_window, {"type", "window"}), F(type_window_sort, {"type", "window_sort"}))                                                 \
     M(tiflash_coprocessor_request_duration_seconds, "Bucketed histogram of request duration", Histogram,                                  \
         F(type_batch, {{"type", "batch"}}, ExpBuckets{0.001, 2, 20}), F(type_cop, {{"type", "cop"}}, ExpBuckets{0.001, 2, 20}),           \
+        F(type_cop_stream, {{"type", "cop_stream"}}, ExpBuckets{0.001, 2, 20}),                                                           \
         F(type_super_batch, {{"type", "super_batch"}}, ExpBuckets{0.001, 2, 20}),                                                         \
         F(type_dispatch_mpp_task, {{"type", "dispatch_mpp_task"}}, ExpBuckets{0.001, 2, 20}),                                             \
         F(type_mpp_establish_conn, {{"type", "mpp_establish_conn"}}, ExpBuckets{0.001, 2, 20}),                                           \
@@ -125,6 +131,13 @@ namespace DB
         F(type_seg_split_fg, {{"type", "seg_split_fg"}}, ExpBuckets{0.001, 2, 20}),                                                       \
         F(type_seg_merge, {{"type", "seg_merge"}}, ExpBuckets{0.001, 2, 20}),                                                             \
         F(type_place_index_update, {{"type", "place_index_update"}}, ExpBuckets{0.001, 2, 20}))                                           \
+    M(tiflash_storage_background_task_wait_seconds, "Bucketed histogram of storage's background task waiting time", Histogram,            \
+        F(type_delta_merge, {{"type", "delta_merge"}}, ExpBuckets{0.001, 2, 20}),                                                         \
+        F(type_delta_compact, {{"type", "delta_compact"}}, ExpBuckets{0.001, 2, 20}),                                                     \
+        F(type_delta_flush, {{"type", "delta_flush"}}, ExpBuckets{0.001, 2, 20}),                                                         \
+        F(type_seg_split, {{"type", "seg_split"}}, ExpBuckets{0.001, 2, 20}),                                                             \
+        F(type_seg_merge, {{"type", "seg_merge"}}, ExpBuckets{0.001, 2, 20}),                                                             \
+        F(type_place_index_update, {{"type", "place_index_update"}}, ExpBuckets{0.001, 2, 20}))                                           \
     M(tiflash_storage_throughput_bytes, "Calculate the throughput of tasks of storage in bytes", Gauge,           /**/                    \
         F(type_write, {"type", "write"}),                                                                         /**/                    \
         F(type_ingest, {"type", "ingest"}),                                                                       /**/                    \
@@ -150,6 +163,19 @@ namespace DB
         F(type_exec, {{"type", "exec"}}, ExpBuckets{0.0005, 2, 20}),                                                                      \
         F(type_migrate, {{"type", "migrate"}}, ExpBuckets{0.0005, 2, 20}),                                                                \
         F(type_v3, {{"type", "v3"}}, ExpBuckets{0.0005, 2, 20}))                                                                          \
+    M(tiflash_storage_page_restore_duration_seconds, "Bucketed histogram of page restore duration", Histogram,                            \
+        F(type_wal, {{"type", "wal"}}, ExpBuckets{0.001, 2, 20}),                                                                         \
+        F(type_gc_in_mem, {{"type", "gc_in_mem"}}, ExpBuckets{0.001, 2, 20}),                                                             \
+        F(type_blob_stats, {{"type", "blob_stats"}}, ExpBuckets{0.001, 2, 20}))                                                           \
+    M(tiflash_storage_page_transform_bytes, "Total bytes of pages transformed from PageStorage V2 to V3", Counter,                        \
+        F(type_kvstore, {"type", "kvstore"}),                                                                                             \
+        F(type_meta, {"type", "meta"}))                                                                                                   \
+    M(tiflash_storage_page_cache_count, "Total number of page cache lookups of PageStorage", ShardedCounter,                              \
+        F(type_hit, {"type", "hit"}),                                                                                                     \
+        F(type_miss, {"type", "miss"}))                                                                                                   \
+    M(tiflash_encryption_file_info_lookup_count, "Total number of encryption info lookups of files", Counter,                             \
+        F(type_hit, {"type", "hit"}),                                                                                                     \
+        F(type_miss, {"type", "miss"}))                                                                                                   \
     M(tiflash_storage_logical_throughput_bytes, "The logical throughput of read tasks of storage in bytes", Histogram,                    \
         F(type_read, {{"type", "read"}}, EqualWidthBuckets{1 * 1024 * 1024, 60, 50 * 1024 * 1024}))                                       \
     M(tiflash_storage_io_limiter, "Storage I/O limiter metrics", Counter, F(type_fg_read_req_bytes, {"type", "fg_read_req_bytes"}),       \
@@ -157,7 +183,7 @@ namespace DB
         F(type_bg_read_alloc_bytes, {"type", "bg_read_alloc_bytes"}), F(type_fg_write_req_bytes, {"type", "fg_write_req_bytes"}),         \
         F(type_fg_write_alloc_bytes, {"type", "fg_write_alloc_bytes"}), F(type_bg_write_req_bytes, {"type", "bg_write_req_bytes"}),       \
         F(type_bg_write_alloc_bytes, {"type", "bg_write_alloc_bytes"}))                                                                   \
-    M(tiflash_storage_rough_set_filter_rate, "Bucketed histogram of rough set filter rate", Histogram,                                    \
+    M(tiflash_storage_rough_set_filter_rate, "Bucketed histogram of rough set filter rate", ShardedHistogram,                             \
         F(type_dtfile_pack, {{"type", "dtfile_pack"}}, EqualWidthBuckets{0, 6, 20}))                                                      \
     M(tiflash_raft_command_duration_seconds, "Bucketed histogram of some raft command: apply snapshot",                                   \
         Histogram, /* these command usually cost servel seconds, increase the start bucket to 50ms */                                     \
@@ -171,12 +197,14 @@ namespace DB
         F(type_write, {{"type", "write"}}, ExpBuckets{0.0005, 2, 20}), F(type_admin, {{"type", "admin"}}, ExpBuckets{0.0005, 2, 20}))     \
     M(tiflash_raft_upstream_latency, "The latency that tikv sends raft log to tiflash.", Histogram,                                       \
         F(type_write, {{"type", "write"}}, ExpBuckets{0.001, 2, 30}))                                                                     \
+    M(tiflash_raft_write_postponed_count, "Total number of raft writes kept in the regions because the storage is stalled", Counter)      \
     M(tiflash_raft_write_data_to_storage_duration_seconds, "Bucketed histogram of writting region into storage layer", Histogram,         \
         F(type_decode, {{"type", "decode"}}, ExpBuckets{0.0005, 2, 20}), F(type_write, {{"type", "write"}}, ExpBuckets{0.0005, 2, 20}))   \
     M(tiflash_server_info, "Indicate the tiflash server info, and the value is the start timestamp (s).", Gauge,                          \
         F(start_time, {"version", TiFlashBuildInfo::getReleaseVersion()}, {"hash", TiFlashBuildInfo::getGitHash()}))                      \
     M(tiflash_object_count, "Number of objects", Gauge,                                                                                   \
         F(type_count_of_establish_calldata, {"type", "count_of_establish_calldata"}),                                                     \
+        F(type_count_of_coprocessor_calldata, {"type", "count_of_coprocessor_calldata"}),                                                 \
         F(type_count_of_mpptunnel, {"type", "count_of_mpptunnel"}))                                                                       \
     M(tiflash_thread_count, "Number of threads", Gauge,                                                                                   \
         F(type_max_threads_of_thdpool, {"type", "thread_pool_total_max"}),                                                                \
@@ -201,12 +229,15 @@ namespace DB
         F(type_waiting_tasks_count, {"type", "waiting_tasks_count"}),                                                                     \
         F(type_active_tasks_count, {"type", "active_tasks_count"}),                                                                       \
         F(type_estimated_thread_usage, {"type", "estimated_thread_usage"}),                                                               \
+        F(type_observed_thread_usage, {"type", "observed_thread_usage"}),                                                                 \
         F(type_thread_soft_limit, {"type", "thread_soft_limit"}),                                                                         \
         F(type_thread_hard_limit, {"type", "thread_hard_limit"}),                                                                         \
+        F(type_estimated_memory_usage, {"type", "estimated_memory_usage"}),                                                               \
+        F(type_memory_limit, {"type", "memory_limit"}),                                                                                   \
         F(type_hard_limit_exceeded_count, {"type", "hard_limit_exceeded_count"}))                                                         \
     M(tiflash_task_scheduler_waiting_duration_seconds, "Bucketed histogram of task waiting for scheduling duration", Histogram,           \
         F(type_task_scheduler_waiting_duration, {{"type", "task_waiting_duration"}}, ExpBuckets{0.001, 2, 20}))                           \
-    M(tiflash_storage_read_thread_counter, "The counter of storage read thread", Counter,                                                 \
+    M(tiflash_storage_read_thread_counter, "The counter of storage read thread", ShardedCounter,                                          \
         F(type_sche_no_pool, {"type", "sche_no_pool"}),                                                                                   \
         F(type_sche_no_slot, {"type", "sche_no_slot"}),                                                                                   \
         F(type_sche_no_segment, {"type", "sche_no_segment"}),                                                                             \
@@ -217,11 +248,52 @@ namespace DB
         F(type_get_cache_miss, {"type", "get_cache_miss"}),                                                                               \
         F(type_get_cache_part, {"type", "get_cache_part"}),                                                                               \
         F(type_get_cache_hit, {"type", "get_cache_hit"}),                                                                                 \
-        F(type_get_cache_copy, {"type", "get_cache_copy"}))                                                                               \
+        F(type_get_cache_copy, {"type", "get_cache_copy"}),                                                                               \
+        F(type_sche_join_scan, {"type", "sche_join_scan"}),                                                                               \
+        F(type_join_scan, {"type", "join_scan"}),                                                                                         \
+        F(type_numa_local_task, {"type", "numa_local_task"}),                                                                             \
+        F(type_numa_cross_node_task, {"type", "numa_cross_node_task"}))                                                                   \
+    M(tiflash_storage_read_thread_shared_bytes, "Total bytes of column data shared between the reads of the same DTFile", Counter)        \
     M(tiflash_storage_read_thread_gauge, "The gauge of storage read thread", Gauge,                                                       \
-        F(type_merged_task, {"type", "merged_task"}))                                                                                     \
+        F(type_merged_task, {"type", "merged_task"}),                                                                                     \
+        F(type_concurrency, {"type", "concurrency"}))                                                                                     \
     M(tiflash_storage_read_thread_seconds, "Bucketed histogram of read thread", Histogram,                                                \
-        F(type_merged_task, {{"type", "merged_task"}}, ExpBuckets{0.001, 2, 20}))
+        F(type_merged_task, {{"type", "merged_task"}}, ExpBuckets{0.001, 2, 20}),                                                         \
+        F(type_pool, {{"type", "pool"}}, ExpBuckets{0.001, 2, 20}))                                                                       \
+    M(tiflash_storage_read_stage_duration_seconds, "Bucketed histogram of the time spent on the stages of storage reads",                 \
+        ShardedHistogram,                                                                                                                 \
+        F(type_snapshot, {{"type", "snapshot"}}, ExpBuckets{0.0001, 2, 20}),                                                              \
+        F(type_read_info, {{"type", "read_info"}}, ExpBuckets{0.0001, 2, 20}),                                                            \
+        F(type_rough_set_filter, {{"type", "rough_set_filter"}}, ExpBuckets{0.0001, 2, 20}),                                              \
+        F(type_file_io, {{"type", "file_io"}}, ExpBuckets{0.0001, 2, 20}),                                                                \
+        F(type_decompress, {{"type", "decompress"}}, ExpBuckets{0.0001, 2, 20}),                                                          \
+        F(type_delta_merge, {{"type", "delta_merge"}}, ExpBuckets{0.0001, 2, 20}),                                                        \
+        F(type_version_filter, {{"type", "version_filter"}}, ExpBuckets{0.0001, 2, 20}))                                                  \
+    M(tiflash_spilled_bytes, "Total bytes of data spilled to disk by operators", Counter,                                                 \
+        F(type_sort, {"type", "sort"}),                                                                                                   \
+        F(type_aggregation, {"type", "aggregation"}),                                                                                     \
+        F(type_join, {"type", "join"}))                                                                                                   \
+    M(tiflash_lock_wait_duration_seconds, "Bucketed histogram of the time waiting for the profiled locks", ShardedHistogram,              \
+        F(type_delta_merge_store, {{"type", "delta_merge_store"}}, ExpBuckets{0.00001, 2, 20}),                                           \
+        F(type_page_directory, {{"type", "page_directory"}}, ExpBuckets{0.00001, 2, 20}),                                                 \
+        F(type_kvstore_task, {{"type", "kvstore_task"}}, ExpBuckets{0.00001, 2, 20}),                                                     \
+        F(type_mpp_task_manager, {{"type", "mpp_task_manager"}}, ExpBuckets{0.00001, 2, 20}),                                             \
+        F(type_join, {{"type", "join"}}, ExpBuckets{0.00001, 2, 20}))                                                                     \
+    M(tiflash_lock_hold_duration_seconds, "Bucketed histogram of the time holding the profiled exclusive locks", ShardedHistogram,        \
+        F(type_delta_merge_store, {{"type", "delta_merge_store"}}, ExpBuckets{0.00001, 2, 20}),                                           \
+        F(type_page_directory, {{"type", "page_directory"}}, ExpBuckets{0.00001, 2, 20}),                                                 \
+        F(type_kvstore_task, {{"type", "kvstore_task"}}, ExpBuckets{0.00001, 2, 20}),                                                     \
+        F(type_mpp_task_manager, {{"type", "mpp_task_manager"}}, ExpBuckets{0.00001, 2, 20}),                                             \
+        F(type_join, {{"type", "join"}}, ExpBuckets{0.00001, 2, 20}))                                                                     \
+    M(tiflash_lock_contended_count, "Total number of the contended acquisitions of the profiled locks", ShardedCounter,                   \
+        F(type_delta_merge_store, {"type", "delta_merge_store"}),                                                                         \
+        F(type_page_directory, {"type", "page_directory"}),                                                                               \
+        F(type_kvstore_task, {"type", "kvstore_task"}),                                                                                   \
+        F(type_mpp_task_manager, {"type", "mpp_task_manager"}),                                                                           \
+        F(type_join, {"type", "join"}))                                                                                                   \
+    M(tiflash_exchange_packet_size_bytes, "Bucketed histogram of the bytes of the packets sent by mpp exchange", ShardedHistogram,        \
+        F(type_hash, {{"type", "hash"}}, ExpBuckets{1024, 2, 16}),                                                                        \
+        F(type_others, {{"type", "others"}}, ExpBuckets{1024, 2, 16}))
 // clang-format on
 
 struct ExpBuckets
@@ -291,6 +363,38 @@ struct MetricFamilyTrait<prometheus::Histogram>
     }
 };
 
+template <>
+struct MetricFamilyTrait<ShardedCounter>
+{
+    using ArgType = std::map<std::string, std::string>;
+    static auto build() { return prometheus::BuildCounter(); }
+    static auto & add(prometheus::Family<prometheus::Counter> & family, ArgType && arg)
+    {
+        return ShardedMetrics::instance().add<ShardedCounter>(family.Add(std::forward<ArgType>(arg)));
+    }
+};
+template <>
+struct MetricFamilyTrait<ShardedHistogram>
+{
+    using ArgType = std::tuple<std::map<std::string, std::string>, prometheus::Histogram::BucketBoundaries>;
+    static auto build() { return prometheus::BuildHistogram(); }
+    static auto & add(prometheus::Family<prometheus::Histogram> & family, ArgType && arg)
+    {
+        auto & histogram = family.Add(std::move(std::get<0>(arg)), std::get<1>(arg));
+        return ShardedMetrics::instance().add<ShardedHistogram>(histogram, std::move(std::get<1>(arg)));
+    }
+};
+
+/// The types of the metrics that can be used in APPLY_FOR_METRICS.
+namespace metric_types
+{
+using prometheus::Counter;
+using prometheus::Gauge;
+using prometheus::Histogram;
+using DB::ShardedCounter;
+using DB::ShardedHistogram;
+} // namespace metric_types
+
 template <typename T>
 struct MetricFamily
 {
@@ -347,7 +451,7 @@ private:
 
 public:
 #define MAKE_METRIC_MEMBER_M(family_name, help, type, ...) \
-    MetricFamily<prometheus::type> family_name = MetricFamily<prometheus::type>(*registry, #family_name, #help, {__VA_ARGS__});
+    MetricFamily<metric_types::type> family_name = MetricFamily<metric_types::type>(*registry, #family_name, #help, {__VA_ARGS__});
 #define MAKE_METRIC_MEMBER_F(field_name, ...) \
     {                                         \
         __VA_ARGS__                           \
@@ -0,0 +1,88 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Allocator.h>
+#include <Common/ColumnBufferPool.h>
+#include <gtest/gtest.h>
+
+#include <ext/scope_guard.h>
+#include <thread>
+
+using namespace DB;
+
+TEST(ColumnBufferPool, ReuseInScope)
+{
+    Allocator<false> allocator;
+    const size_t size = ColumnBufferPool::MIN_SIZE * 4;
+    {
+        ColumnBufferPool::Scope scope;
+        auto * pool = ColumnBufferPool::current();
+        ASSERT_NE(pool, nullptr);
+
+        {
+            // Nested scope shares the outer pool
+            ColumnBufferPool::Scope nested_scope;
+            ASSERT_EQ(ColumnBufferPool::current(), pool);
+        }
+        ASSERT_EQ(ColumnBufferPool::current(), pool);
+
+        void * buf = allocator.alloc(size);
+        allocator.free(buf, size);
+        ASSERT_EQ(pool->pooledBytes(), size);
+
+        // The same size class reuses the freed buffer
+        void * buf2 = allocator.alloc(size);
+        ASSERT_EQ(buf2, buf);
+        ASSERT_EQ(pool->pooledBytes(), 0);
+
+        // Not a pooled size class
+        void * buf3 = allocator.alloc(size + 1);
+        allocator.free(buf3, size + 1);
+        ASSERT_EQ(pool->pooledBytes(), 0);
+
+        // The buffer can be freed by another thread without scope
+        std::thread t([&] { allocator.free(buf2, size); });
+        t.join();
+        ASSERT_EQ(pool->pooledBytes(), 0);
+    }
+    ASSERT_EQ(ColumnBufferPool::current(), nullptr);
+}
+
+TEST(ColumnBufferPool, Limit)
+{
+    auto old_limit = ColumnBufferPool::getMaxBytesPerThread();
+    SCOPE_EXIT({ ColumnBufferPool::setMaxBytesPerThread(old_limit); });
+
+    Allocator<false> allocator;
+    const size_t size = ColumnBufferPool::MAX_SIZE;
+    ColumnBufferPool::setMaxBytesPerThread(size);
+    {
+        ColumnBufferPool::Scope scope;
+        auto * pool = ColumnBufferPool::current();
+        ASSERT_NE(pool, nullptr);
+
+        void * buf1 = allocator.alloc(size);
+        void * buf2 = allocator.alloc(size);
+        allocator.free(buf1, size);
+        allocator.free(buf2, size);
+        ASSERT_EQ(pool->pooledBytes(), size);
+    }
+
+    ColumnBufferPool::setMaxBytesPerThread(0);
+    {
+        ColumnBufferPool::Scope scope;
+        ASSERT_EQ(ColumnBufferPool::current(), nullptr);
+    }
+}
@@ -108,6 +108,34 @@ try
 }
 CATCH
 
+TEST_F(DynamicThreadPoolTest, testActiveThreads)
+try
+{
+    DynamicThreadPool pool(1, std::chrono::milliseconds(10));
+    ASSERT_EQ(pool.threadCount().active, 0);
+
+    auto wait_for_active = [&](Int32 expected) {
+        for (int i = 0; i < 1000 && pool.threadCount().active != expected; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return pool.threadCount().active;
+    };
+
+    std::atomic<bool> stop = false;
+    auto job = [&] {
+        while (!stop.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+    auto f0 = pool.schedule(true, job);
+    auto f1 = pool.schedule(true, job);
+    ASSERT_EQ(wait_for_active(2), 2);
+
+    stop.store(true);
+    f0.wait();
+    f1.wait();
+    ASSERT_EQ(wait_for_active(0), 0);
+}
+CATCH
+
 TEST_F(DynamicThreadPoolTest, testExceptionSafe)
 try
 {
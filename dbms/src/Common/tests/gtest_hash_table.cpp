@@ -15,6 +15,7 @@
 #include <Common/HashTable/Hash.h>
 #include <Common/HashTable/HashMap.h>
 #include <Common/HashTable/HashSet.h>
+#include <Common/HashTable/StringHashMap.h>
 #include <IO/ReadBufferFromString.h>
 #include <IO/WriteHelpers.h>
 #include <Interpreters/AggregationCommon.h>
@@ -382,3 +383,34 @@ TEST(HashTable, Resize)
         ASSERT_EQ(actual, expected);
     }
 }
+
+TEST(HashTable, Reserve)
+{
+    {
+        using Cont = HashSet<int, DefaultHash<int>>;
+        Cont cont;
+        size_t initial_bytes = cont.getBufferSizeInBytes();
+
+        cont.reserve(100000);
+        size_t reserved_bytes = cont.getBufferSizeInBytes();
+        ASSERT_GT(reserved_bytes, initial_bytes);
+
+        /// No rehash happens until the reserved elements are inserted.
+        for (int i = 0; i < 100000; ++i)
+            cont.insert(i);
+        ASSERT_EQ(cont.size(), 100000u);
+        ASSERT_EQ(cont.getBufferSizeInBytes(), reserved_bytes);
+    }
+    {
+        using Cont = StringHashMap<UInt64>;
+        Cont cont;
+        size_t initial_bytes = cont.getBufferSizeInBytes();
+
+        /// Too few elements to reserve for the sub maps.
+        cont.reserve(3);
+        ASSERT_EQ(cont.getBufferSizeInBytes(), initial_bytes);
+
+        cont.reserve(100000);
+        ASSERT_GT(cont.getBufferSizeInBytes(), initial_bytes);
+    }
+}
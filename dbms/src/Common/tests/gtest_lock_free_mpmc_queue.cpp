@@ -0,0 +1,163 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/LockFreeMPMCQueue.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace DB::tests
+{
+namespace
+{
+class LockFreeMPMCQueueTest : public ::testing::Test
+{
+};
+
+TEST_F(LockFreeMPMCQueueTest, SequentialPushPop)
+try
+{
+    LockFreeMPMCQueue<std::unique_ptr<int>> queue(3);
+    ASSERT_EQ(queue.getStatus(), MPMCQueueStatus::NORMAL);
+    ASSERT_FALSE(queue.isNextPopNonBlocking());
+    for (int i = 0; i < 3; ++i)
+        ASSERT_TRUE(queue.push(std::make_unique<int>(i)));
+    ASSERT_EQ(queue.size(), 3);
+    ASSERT_FALSE(queue.isNextPushNonBlocking());
+    ASSERT_FALSE(queue.tryPush(std::make_unique<int>(-1)));
+    ASSERT_FALSE(queue.pushTimeout(std::make_unique<int>(-1), std::chrono::milliseconds(1)));
+
+    /// the positions wrap around the cells
+    for (int i = 3; i < 10; ++i)
+    {
+        std::unique_ptr<int> v;
+        ASSERT_TRUE(queue.pop(v));
+        ASSERT_EQ(*v, i - 3);
+        ASSERT_TRUE(queue.emplace(new int(i)));
+    }
+    ASSERT_EQ(queue.size(), 3);
+}
+CATCH
+
+TEST_F(LockFreeMPMCQueueTest, FinishAndCancel)
+try
+{
+    {
+        LockFreeMPMCQueue<std::shared_ptr<int>> queue(4);
+        ASSERT_TRUE(queue.push(std::make_shared<int>(1)));
+        ASSERT_TRUE(queue.finish());
+        ASSERT_FALSE(queue.finish());
+        queue.cancel();
+        ASSERT_EQ(queue.getStatus(), MPMCQueueStatus::FINISHED);
+        ASSERT_FALSE(queue.push(std::make_shared<int>(2)));
+        ASSERT_TRUE(queue.isNextPopNonBlocking());
+
+        /// the objects pushed before finish can still be popped
+        std::shared_ptr<int> v;
+        ASSERT_TRUE(queue.pop(v));
+        ASSERT_EQ(*v, 1);
+        ASSERT_FALSE(queue.pop(v));
+    }
+    {
+        LockFreeMPMCQueue<std::shared_ptr<int>> queue(4);
+        ASSERT_TRUE(queue.push(std::make_shared<int>(1)));
+        queue.cancel();
+        ASSERT_EQ(queue.getStatus(), MPMCQueueStatus::CANCELLED);
+        std::shared_ptr<int> v;
+        ASSERT_FALSE(queue.pop(v));
+        ASSERT_FALSE(queue.push(std::make_shared<int>(2)));
+    }
+}
+CATCH
+
+TEST_F(LockFreeMPMCQueueTest, WakeUpBlocked)
+try
+{
+    LockFreeMPMCQueue<int> queue(1);
+    std::thread reader([&] {
+        int v;
+        ASSERT_TRUE(queue.pop(v));
+        ASSERT_EQ(v, 1);
+        /// blocks until cancelled
+        ASSERT_FALSE(queue.pop(v));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(queue.push(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.cancel();
+    reader.join();
+
+    int v;
+    ASSERT_FALSE(queue.popTimeout(v, std::chrono::milliseconds(1)));
+}
+CATCH
+
+TEST_F(LockFreeMPMCQueueTest, ConcurrentPushPop)
+try
+{
+    constexpr int thread_num = 4;
+    constexpr Int64 count_per_writer = 20000;
+    LockFreeMPMCQueue<Int64> queue(5);
+    std::atomic<Int64> sum = 0;
+    std::atomic<Int64> count = 0;
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < thread_num; ++i)
+        writers.emplace_back([&] {
+            for (Int64 v = 0; v < count_per_writer; ++v)
+                ASSERT_TRUE(queue.push(v));
+        });
+    std::vector<std::thread> readers;
+    for (int i = 0; i < thread_num; ++i)
+        readers.emplace_back([&] {
+            Int64 v;
+            while (queue.pop(v))
+            {
+                sum += v;
+                ++count;
+            }
+        });
+    for (auto & t : writers)
+        t.join();
+    queue.finish();
+    for (auto & t : readers)
+        t.join();
+
+    ASSERT_EQ(count.load(), thread_num * count_per_writer);
+    ASSERT_EQ(sum.load(), thread_num * (count_per_writer - 1) * count_per_writer / 2);
+}
+CATCH
+
+TEST_F(LockFreeMPMCQueueTest, ObjectsDestructed)
+try
+{
+    auto obj = std::make_shared<int>(0);
+    {
+        LockFreeMPMCQueue<std::shared_ptr<int>> queue(4);
+        ASSERT_TRUE(queue.push(obj));
+        ASSERT_TRUE(queue.push(obj));
+        std::shared_ptr<int> v;
+        ASSERT_TRUE(queue.pop(v));
+        v.reset();
+        ASSERT_EQ(obj.use_count(), 2);
+    }
+    ASSERT_EQ(obj.use_count(), 1);
+}
+CATCH
+
+} // namespace
+} // namespace DB::tests
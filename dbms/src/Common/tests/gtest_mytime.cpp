@@ -582,5 +582,59 @@ catch (Exception & e)
     GTEST_FAIL();
 }
 
+TEST_F(TestMyTime, PackedFields)
+try
+{
+    std::vector<MyDateTime> date_time_vec{
+        MyDateTime(0, 0, 0, 0, 0, 0, 0),
+        MyDateTime(0, 1, 1, 0, 0, 0, 0),
+        MyDateTime(1970, 1, 1, 0, 0, 0, 0),
+        MyDateTime(2020, 2, 29, 23, 59, 59, 999999),
+        MyDateTime(2021, 12, 0, 12, 30, 45, 123456),
+        MyDateTime(9999, 12, 31, 23, 59, 59, 999999)};
+    for (const auto & datetime : date_time_vec)
+    {
+        UInt64 packed = datetime.toPackedUInt();
+        EXPECT_EQ(PackedMyTime::year(packed), datetime.year);
+        EXPECT_EQ(PackedMyTime::month(packed), datetime.month);
+        EXPECT_EQ(PackedMyTime::day(packed), datetime.day);
+        EXPECT_EQ(PackedMyTime::hour(packed), datetime.hour);
+        EXPECT_EQ(PackedMyTime::minute(packed), datetime.minute);
+        EXPECT_EQ(PackedMyTime::second(packed), datetime.second);
+        EXPECT_EQ(PackedMyTime::microSecond(packed), datetime.micro_second);
+        EXPECT_EQ(PackedMyTime::hasZeroMonthOrDay(packed), datetime.month == 0 || datetime.day == 0);
+        EXPECT_EQ(PackedMyTime::dayNum(packed), calcDayNum(datetime.year, datetime.month, datetime.day));
+    }
+}
+CATCH
+
+TEST_F(TestMyTime, ConvertUTC2TimeZone)
+try
+{
+    // Covers the daylight saving time changes of America/New_York in 2021-03-14 and 2021-11-07
+    std::vector<String> time_zones{"UTC", "Asia/Shanghai", "America/New_York", "Australia/Lord_Howe"};
+    for (const auto & name : time_zones)
+    {
+        const auto & time_zone = DateLUT::instance(name);
+        for (time_t t = 1615680000; t < 1615680000 + 3 * 86400; t += 599)
+        {
+            MyDateTime datetime = convertUTC2TimeZone(t, 1, time_zone);
+            EXPECT_EQ(datetime.year, time_zone.toYear(t)) << name << " " << t;
+            EXPECT_EQ(datetime.month, time_zone.toMonth(t)) << name << " " << t;
+            EXPECT_EQ(datetime.day, time_zone.toDayOfMonth(t)) << name << " " << t;
+            EXPECT_EQ(datetime.hour, time_zone.toHour(t)) << name << " " << t;
+            EXPECT_EQ(datetime.minute, time_zone.toMinute(t)) << name << " " << t;
+            EXPECT_EQ(datetime.second, time_zone.toSecond(t)) << name << " " << t;
+        }
+        for (time_t t = 1636257600; t < 1636257600 + 86400; t += 599)
+        {
+            MyDateTime datetime = convertUTC2TimeZone(t, 1, time_zone);
+            EXPECT_EQ(datetime.hour, time_zone.toHour(t)) << name << " " << t;
+            EXPECT_EQ(datetime.minute, time_zone.toMinute(t)) << name << " " << t;
+        }
+    }
+}
+CATCH
+
 } // namespace tests
 } // namespace DB
@@ -0,0 +1,115 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/ProfileEvents.h>
+#include <Common/ProfilingMutex.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <ext/scope_guard.h>
+#include <thread>
+
+namespace ProfileEvents
+{
+extern const Event ProfilingLockContended;
+extern const Event ProfilingLockWaitMicroseconds;
+} // namespace ProfileEvents
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+ProfileEvents::Count getContended()
+{
+    return ProfileEvents::counters[ProfileEvents::ProfilingLockContended].load();
+}
+} // namespace
+
+TEST(ProfilingMutexTest, Uncontended)
+{
+    LockProfiler::setEnabled(true);
+    SCOPE_EXIT({ LockProfiler::setEnabled(false); });
+
+    auto contended = getContended();
+    ProfilingMutex mutex{ProfilingLockType::KVStoreTask};
+    {
+        std::lock_guard lock(mutex);
+    }
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+
+    ProfilingSharedMutex shared_mutex{ProfilingLockType::DeltaMergeStore};
+    {
+        std::shared_lock lock1(shared_mutex);
+        // The shared owners do not contend with each other
+        std::shared_lock lock2(shared_mutex);
+        ASSERT_FALSE(shared_mutex.try_lock());
+    }
+    {
+        std::unique_lock lock(shared_mutex);
+        ASSERT_FALSE(shared_mutex.try_lock_shared());
+    }
+    ASSERT_EQ(getContended(), contended);
+}
+
+TEST(ProfilingMutexTest, Contended)
+{
+    using namespace std::chrono_literals;
+    LockProfiler::setEnabled(true);
+    SCOPE_EXIT({ LockProfiler::setEnabled(false); });
+
+    auto contended = getContended();
+    auto wait_us = ProfileEvents::counters[ProfileEvents::ProfilingLockWaitMicroseconds].load();
+    ProfilingSharedMutex mutex{ProfilingLockType::Join};
+    std::unique_lock lock(mutex);
+    std::thread reader([&] {
+        std::shared_lock read_lock(mutex);
+    });
+    std::thread writer([&] {
+        std::unique_lock write_lock(mutex);
+    });
+    std::this_thread::sleep_for(50ms);
+    lock.unlock();
+    reader.join();
+    writer.join();
+
+    ASSERT_GE(getContended(), contended + 2);
+    ASSERT_GT(ProfileEvents::counters[ProfileEvents::ProfilingLockWaitMicroseconds].load(), wait_us);
+}
+
+TEST(ProfilingMutexTest, Disabled)
+{
+    auto contended = getContended();
+    ProfilingMutex mutex{ProfilingLockType::MPPTaskManager};
+    std::condition_variable_any cv;
+    bool ready = false;
+    std::thread waiter([&] {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return ready; });
+    });
+    {
+        std::lock_guard lock(mutex);
+        ready = true;
+    }
+    cv.notify_all();
+    waiter.join();
+    ASSERT_EQ(getContended(), contended);
+}
+
+} // namespace tests
+} // namespace DB
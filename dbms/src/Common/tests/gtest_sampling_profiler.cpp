@@ -0,0 +1,84 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/SamplingProfiler.h>
+#include <Common/Stopwatch.h>
+#include <Common/wrapInvocable.h>
+#include <common/defines.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace DB
+{
+namespace tests
+{
+NO_INLINE UInt64 burnCPU(UInt64 ms)
+{
+    Stopwatch watch(CLOCK_THREAD_CPUTIME_ID);
+    volatile UInt64 x = 0;
+    while (watch.elapsedMilliseconds() < ms)
+        x = x + 1;
+    return x;
+}
+
+TEST(SamplingProfiler, ThreadTag)
+{
+    ASSERT_EQ(SamplingProfiler::getThreadTag(), "");
+    {
+        SamplingProfiler::ThreadTagSetter setter("MPP<query:1,task:1>");
+        ASSERT_EQ(SamplingProfiler::getThreadTag(), "MPP<query:1,task:1>");
+        {
+            SamplingProfiler::ThreadTagSetter inner_setter(String(SamplingProfiler::max_tag_size * 2, 'a'));
+            ASSERT_EQ(SamplingProfiler::getThreadTag(), String(SamplingProfiler::max_tag_size - 1, 'a'));
+        }
+        ASSERT_EQ(SamplingProfiler::getThreadTag(), "MPP<query:1,task:1>");
+
+        // the tag is propagated to the tasks run in other threads
+        String tag_in_thread;
+        std::thread t(wrapInvocable(false, [&] { tag_in_thread = SamplingProfiler::getThreadTag(); }));
+        t.join();
+        ASSERT_EQ(tag_in_thread, "MPP<query:1,task:1>");
+    }
+    ASSERT_EQ(SamplingProfiler::getThreadTag(), "");
+}
+
+// SIGPROF and the unwinding in signal handler are not friendly to sanitizers
+#if !defined(THREAD_SANITIZER) && !defined(ADDRESS_SANITIZER)
+TEST(SamplingProfiler, Sample)
+{
+    auto & profiler = SamplingProfiler::instance();
+    profiler.reset();
+    ASSERT_TRUE(profiler.start(1000));
+    ASSERT_FALSE(profiler.start(1000));
+    {
+        SamplingProfiler::ThreadTagSetter setter("MPP<query:42,task:1>");
+        burnCPU(200);
+    }
+    profiler.stop();
+    ASSERT_FALSE(profiler.isRunning());
+
+    auto stats = profiler.getStats();
+    ASSERT_GT(stats.samples, 0);
+    auto folded = profiler.dumpFolded();
+    ASSERT_NE(folded.find("MPP<query:42,task:1>;"), String::npos) << folded;
+
+    profiler.reset();
+    ASSERT_EQ(profiler.dumpFolded(), "");
+}
+#endif
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,107 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/ShardedSLRUCache.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace DB
+{
+namespace tests
+{
+using Cache = ShardedSLRUCache<int, int>;
+
+TEST(ShardedSLRUCacheTest, GetSet)
+{
+    Cache cache(100);
+    ASSERT_EQ(cache.get(1), nullptr);
+    cache.set(1, std::make_shared<int>(10));
+    ASSERT_EQ(*cache.get(1), 10);
+    cache.set(1, std::make_shared<int>(11));
+    ASSERT_EQ(*cache.get(1), 11);
+    ASSERT_EQ(cache.count(), 1);
+    ASSERT_EQ(cache.weight(), 1);
+
+    cache.remove(1);
+    ASSERT_EQ(cache.get(1), nullptr);
+    ASSERT_EQ(cache.count(), 0);
+
+    size_t hits = 0, misses = 0;
+    cache.getStats(hits, misses);
+    ASSERT_EQ(hits, 2);
+    ASSERT_EQ(misses, 2);
+}
+
+TEST(ShardedSLRUCacheTest, ScanResistant)
+{
+    // Only one shard to make the eviction order deterministic.
+    Cache cache(10, Cache::Delay::zero(), 1);
+    // Hot entries, hit twice so that they are promoted to the protected queue.
+    for (int i = 0; i < 5; ++i)
+    {
+        cache.set(i, std::make_shared<int>(i));
+        ASSERT_NE(cache.get(i), nullptr);
+    }
+    // A scan touches many entries once.
+    for (int i = 100; i < 200; ++i)
+        cache.set(i, std::make_shared<int>(i));
+    ASSERT_LE(cache.count(), 10);
+    for (int i = 0; i < 5; ++i)
+        ASSERT_NE(cache.get(i), nullptr) << i;
+}
+
+TEST(ShardedSLRUCacheTest, GetOrSet)
+{
+    Cache cache(100);
+    std::atomic<int> load_count{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&] {
+            auto value = cache.getOrSet(42, [&] {
+                                  ++load_count;
+                                  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                  return std::make_shared<int>(42);
+                              })
+                             .first;
+            ASSERT_EQ(*value, 42);
+        });
+    }
+    for (auto & t : threads)
+        t.join();
+    ASSERT_EQ(load_count.load(), 1);
+
+    auto [value, produced] = cache.getOrSet(42, [] { return std::make_shared<int>(0); });
+    ASSERT_EQ(*value, 42);
+    ASSERT_FALSE(produced);
+}
+
+TEST(ShardedSLRUCacheTest, Evict)
+{
+    Cache cache(1000, Cache::Delay::zero(), 4);
+    for (int i = 0; i < 100; ++i)
+        cache.set(i, std::make_shared<int>(i));
+    ASSERT_EQ(cache.weight(), 100);
+    ASSERT_GE(cache.evict(60), 60);
+    ASSERT_LE(cache.weight(), 40);
+    cache.reset();
+    ASSERT_EQ(cache.weight(), 0);
+    ASSERT_EQ(cache.count(), 0);
+}
+
+} // namespace tests
+} // namespace DB
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include <ext/singleton.h>
+#include <thread>
 
 namespace DB
 {
@@ -31,7 +32,9 @@ namespace tests
     M(test_gauge_with_2_labels, "Test gauge metric with 2 labels", Gauge, F(m1, {"label1", "value1"}), F(m2, {"label21", "value22"}, {"label22", "value22"}))       \
     M(test_histogram, "Test histogram metric w/o labels", Histogram)                                                                                                \
     M(test_histogram_with_1_label, "Test histogram metric with 1 label", Histogram, F(m1, {{"label1", "value1"}}, ExpBuckets{1.0, 2, 1024}))                        \
-    M(test_histogram_with_2_labels, "Test histogram metric with 2 labels", Histogram, F(m1, {{"label1", "value1"}}, ExpBuckets{1.0, 2, 1024}), F(m2, {{"label21", "value21"}, {"label22", "value22"}}, {1, 2, 3, 4}))
+    M(test_histogram_with_2_labels, "Test histogram metric with 2 labels", Histogram, F(m1, {{"label1", "value1"}}, ExpBuckets{1.0, 2, 1024}), F(m2, {{"label21", "value21"}, {"label22", "value22"}}, {1, 2, 3, 4})) \
+    M(test_sharded_counter, "Test sharded counter metric", ShardedCounter, F(m1, {"label1", "value1"}))                                                              \
+    M(test_sharded_histogram, "Test sharded histogram metric", ShardedHistogram, F(m1, {{"label1", "value1"}}, {1, 2, 3, 4}))
 
 class TestMetrics : public ext::Singleton<TestMetrics>
 {
@@ -89,6 +92,51 @@ TEST(TiFlashMetrics, Histogram)
     ASSERT_NO_THROW(GET_METRIC(test_histogram_with_2_labels, m2).Observe(3));
 }
 
+TEST(TiFlashMetrics, ShardedCounter)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([] {
+            for (size_t j = 0; j < 1000; ++j)
+                GET_METRIC(test_sharded_counter, m1).Increment();
+        });
+    }
+    for (auto & thread : threads)
+        thread.join();
+    ASSERT_DOUBLE_EQ(GET_METRIC(test_sharded_counter, m1).Value(), 8000);
+    ShardedMetrics::instance().flush();
+    ASSERT_DOUBLE_EQ(GET_METRIC(test_sharded_counter, m1).Value(), 8000);
+}
+
+TEST(TiFlashMetrics, ShardedHistogram)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([] {
+            for (double value : {0.5, 1.0, 2.5, 3.0, 10.0})
+                GET_METRIC(test_sharded_histogram, m1).Observe(value);
+        });
+    }
+    for (auto & thread : threads)
+        thread.join();
+    ShardedMetrics::instance().flush();
+
+    auto families = TestMetrics::instance().registry->Collect();
+    auto family = std::find_if(families.begin(), families.end(), [](const auto & f) { return f.name == "test_sharded_histogram"; });
+    ASSERT_NE(family, families.end());
+    ASSERT_EQ(family->metric.size(), 1);
+    const auto & histogram = family->metric[0].histogram;
+    ASSERT_EQ(histogram.sample_count, 20);
+    ASSERT_DOUBLE_EQ(histogram.sample_sum, 4 * 17.0);
+    // The buckets are cumulative: <= 1, <= 2, <= 3, <= 4, +Inf
+    std::vector<UInt64> expected{8, 8, 16, 16, 20};
+    ASSERT_EQ(histogram.bucket.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT_EQ(histogram.bucket[i].cumulative_count, expected[i]);
+}
+
 } // namespace tests
 
 } // namespace DB
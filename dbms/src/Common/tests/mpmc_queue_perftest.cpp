@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Common/ConcurrentBoundedQueue.h>
+#include <Common/LockFreeMPMCQueue.h>
 #include <Common/MPMCQueue.h>
 #include <common/types.h>
 #include <fmt/core.h>
@@ -91,6 +92,22 @@ struct Helper<MPMCQueue<T>>
     }
 };
 
+template <typename T>
+struct Helper<LockFreeMPMCQueue<T>>
+{
+    static void popOneFrom(LockFreeMPMCQueue<T> & queue)
+    {
+        T t;
+        queue.pop(t);
+    }
+
+    template <typename U>
+    static void pushOneTo(LockFreeMPMCQueue<T> & queue, U && data)
+    {
+        queue.pushTimeout(std::forward<U>(data), std::chrono::milliseconds(1));
+    }
+};
+
 template <typename T>
 struct Helper<ConcurrentBoundedQueue<T>>
 {
@@ -194,7 +211,7 @@ int main(int argc, char ** argv)
     if (argc < 3 || argc > 7)
     {
         auto usage = fmt::format(
-            "Usage: {} [MPMCQueue|ConcurrentBoundedQueue] [Int|ShortString|LongString] <capacity=4> <reader=4> <writer=4> <seconds=10>",
+            "Usage: {} [MPMCQueue|LockFreeMPMCQueue|ConcurrentBoundedQueue] [Int|ShortString|LongString] <capacity=4> <reader=4> <writer=4> <seconds=10>",
             argv[0]);
         std::cerr << usage << std::endl;
         exit(1);
@@ -216,6 +233,10 @@ int main(int argc, char ** argv)
              {{"Int", DB::tests::test<DB::MPMCQueue, int>},
               {"ShortString", DB::tests::test<DB::MPMCQueue, DB::tests::ShortString>},
               {"LongString", DB::tests::test<DB::MPMCQueue, DB::tests::LongString>}}},
+            {"LockFreeMPMCQueue",
+             {{"Int", DB::tests::test<DB::LockFreeMPMCQueue, int>},
+              {"ShortString", DB::tests::test<DB::LockFreeMPMCQueue, DB::tests::ShortString>},
+              {"LongString", DB::tests::test<DB::LockFreeMPMCQueue, DB::tests::LongString>}}},
             {"ConcurrentBoundedQueue",
              {{"Int", DB::tests::test<ConcurrentBoundedQueue, int>},
               {"ShortString", DB::tests::test<ConcurrentBoundedQueue, DB::tests::ShortString>},
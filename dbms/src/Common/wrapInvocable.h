@@ -15,6 +15,7 @@
 #pragma once
 
 #include <Common/MemoryTrackerSetter.h>
+#include <Common/SamplingProfiler.h>
 
 namespace DB
 {
@@ -25,13 +26,17 @@ inline auto wrapInvocable(bool propagate_memory_tracker, Func && func, Args &&..
     if (propagate_memory_tracker)
         CurrentMemoryTracker::submitLocalDeltaMemory();
     auto * memory_tracker = current_memory_tracker;
+    // the samples of the sampling profiler taken in the new thread are attributed to the same query
+    auto profiling_tag = SamplingProfiler::getThreadTag();
 
     // capature our task into lambda with all its parameters
     auto capture = [propagate_memory_tracker,
                     memory_tracker,
+                    profiling_tag = std::move(profiling_tag),
                     func = std::forward<Func>(func),
                     args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
         MemoryTrackerSetter setter(propagate_memory_tracker, memory_tracker);
+        SamplingProfiler::ThreadTagSetter tag_setter(profiling_tag);
         // run the task with the parameters provided
         return std::apply(std::move(func), std::move(args));
     };
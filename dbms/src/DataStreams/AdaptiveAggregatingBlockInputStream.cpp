@@ -0,0 +1,187 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <DataStreams/AdaptiveAggregatingBlockInputStream.h>
+#include <DataStreams/AggregatingBlockInputStream.h>
+
+namespace DB
+{
+namespace
+{
+Aggregator::Params withoutReserveKeysHint(const Aggregator::Params & params)
+{
+    Aggregator::Params res = params;
+    res.reserve_keys_hint = 0;
+    return res;
+}
+
+/// Reads the sampled blocks again before the rest of the input. The input is not a child,
+/// its prefix and suffix are handled by AdaptiveAggregatingBlockInputStream.
+class SampleReplayBlockInputStream : public IProfilingBlockInputStream
+{
+public:
+    SampleReplayBlockInputStream(BlocksList && blocks_, const BlockInputStreamPtr & input_, bool input_finished_)
+        : blocks(std::move(blocks_))
+        , input(input_)
+        , input_finished(input_finished_)
+    {}
+
+    String getName() const override { return "SampleReplay"; }
+    Block getHeader() const override { return input->getHeader(); }
+
+protected:
+    Block readImpl() override
+    {
+        if (!blocks.empty())
+        {
+            Block block = std::move(blocks.front());
+            blocks.pop_front();
+            return block;
+        }
+        if (input_finished)
+            return {};
+        return input->read();
+    }
+
+private:
+    BlocksList blocks;
+    BlockInputStreamPtr input;
+    bool input_finished;
+};
+} // namespace
+
+AdaptiveAggregatingBlockInputStream::AdaptiveAggregatingBlockInputStream(
+    const BlockInputStreamPtr & input,
+    const Aggregator::Params & params_,
+    const FileProviderPtr & file_provider_,
+    size_t sample_rows_,
+    double pass_through_ratio_,
+    const String & req_id)
+    : log(Logger::get(NAME, req_id))
+    , params(params_)
+    , aggregator(withoutReserveKeysHint(params_), req_id)
+    , file_provider(file_provider_)
+    , sample_rows(std::max(sample_rows_, static_cast<size_t>(1)))
+    , pass_through_ratio(pass_through_ratio_)
+    , key_columns(params_.keys_size)
+    , aggregate_columns(params_.aggregates_size)
+{
+    children.push_back(input);
+    aggregator.setCancellationHook([this]() { return isCancelled(); });
+}
+
+void AdaptiveAggregatingBlockInputStream::sample()
+{
+    AggregatedDataVariants sample_data;
+    size_t rows = 0;
+    while (rows < sample_rows)
+    {
+        Block block = children.back()->read();
+        if (!block)
+        {
+            input_finished = true;
+            break;
+        }
+        rows += block.rows();
+        aggregator.executeOnBlock(block, sample_data, file_provider, key_columns, aggregate_columns, local_delta_memory, no_more_keys);
+        sample_blocks.push_back(std::move(block));
+    }
+    if (isCancelled())
+        return;
+
+    /// The sampled data may be flushed to the disk with a small `max_bytes_before_external_group_by`,
+    /// then aggregate the whole stream again, which merges the temporary files.
+    if (!aggregator.hasTemporaryFiles())
+    {
+        size_t groups = sample_data.sizeWithoutOverflowRow();
+        if (input_finished)
+        {
+            /// The whole stream is sampled, its groups are the result.
+            sample_blocks.clear();
+            convertToOutput(sample_data);
+            return;
+        }
+        if (static_cast<double>(groups) >= pass_through_ratio * rows)
+        {
+            LOG_FMT_DEBUG(log, "Pass through the partial aggregation, {} groups of {} sampled rows", groups, rows);
+            pass_through = true;
+            pass_through_rows = rows;
+            sample_blocks.clear();
+            convertToOutput(sample_data);
+            return;
+        }
+        LOG_FMT_DEBUG(log, "Keep the partial aggregation, {} groups of {} sampled rows", groups, rows);
+    }
+
+    impl = std::make_unique<AggregatingBlockInputStream>(
+        std::make_shared<SampleReplayBlockInputStream>(std::move(sample_blocks), children.back(), input_finished),
+        params,
+        file_provider,
+        true,
+        log->identifier());
+}
+
+void AdaptiveAggregatingBlockInputStream::aggregateBlock(const Block & block)
+{
+    pass_through_rows += block.rows();
+    AggregatedDataVariants block_data;
+    aggregator.executeOnBlock(block, block_data, file_provider, key_columns, aggregate_columns, local_delta_memory, no_more_keys);
+    convertToOutput(block_data);
+}
+
+void AdaptiveAggregatingBlockInputStream::convertToOutput(AggregatedDataVariants & data_variants)
+{
+    if (data_variants.empty())
+        return;
+    for (auto & block : aggregator.convertToBlocks(data_variants, true, 1))
+    {
+        if (block.rows() > 0)
+            output_blocks.push_back(std::move(block));
+    }
+}
+
+Block AdaptiveAggregatingBlockInputStream::readImpl()
+{
+    if (!sampled)
+    {
+        sampled = true;
+        sample();
+    }
+
+    if (isCancelledOrThrowIfKilled())
+        return {};
+
+    if (impl)
+        return impl->read();
+
+    while (output_blocks.empty())
+    {
+        if (!pass_through)
+            return {};
+        Block block = children.back()->read();
+        if (!block)
+            return {};
+        aggregateBlock(block);
+    }
+    Block res = std::move(output_blocks.front());
+    output_blocks.pop_front();
+    return res;
+}
+
+void AdaptiveAggregatingBlockInputStream::appendInfo(FmtBuffer & buffer) const
+{
+    buffer.fmtAppend(", pass_through = {}, sample_rows = {}", pass_through, sample_rows);
+}
+
+} // namespace DB
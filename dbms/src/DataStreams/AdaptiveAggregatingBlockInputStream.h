@@ -0,0 +1,87 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <DataStreams/IProfilingBlockInputStream.h>
+#include <Encryption/FileProvider.h>
+#include <Interpreters/Aggregator.h>
+
+namespace DB
+{
+/** The partial aggregation of one stream, which gives up the hash table when it does not reduce the rows.
+  * The first `sample_rows` rows are aggregated, and if the groups are not less than `pass_through_ratio`
+  * of the sampled rows, the keys are nearly unique and the final aggregation has to do all the work anyway.
+  * Then the sampled groups are output and every following block is aggregated alone and output at once,
+  * which keeps the memory of the stream small. Otherwise the whole stream is aggregated as by
+  * AggregatingBlockInputStream. The result is always finalized, as the partial aggregation of MPP.
+  */
+class AdaptiveAggregatingBlockInputStream : public IProfilingBlockInputStream
+{
+    static constexpr auto NAME = "AdaptiveAggregating";
+
+public:
+    AdaptiveAggregatingBlockInputStream(
+        const BlockInputStreamPtr & input,
+        const Aggregator::Params & params_,
+        const FileProviderPtr & file_provider_,
+        size_t sample_rows_,
+        double pass_through_ratio_,
+        const String & req_id);
+
+    String getName() const override { return NAME; }
+    Block getHeader() const override { return aggregator.getHeader(true); }
+
+    bool isPassThrough() const { return pass_through; }
+    /// The input rows that are output without the hash table of the whole stream.
+    size_t getPassThroughRows() const { return pass_through_rows; }
+
+protected:
+    Block readImpl() override;
+    void appendInfo(FmtBuffer & buffer) const override;
+
+private:
+    /// Aggregate the first rows of the input and decide whether to pass through the rest.
+    void sample();
+    /// Aggregate `block` alone and queue the results.
+    void aggregateBlock(const Block & block);
+    void convertToOutput(AggregatedDataVariants & data_variants);
+
+    const LoggerPtr log;
+
+    Aggregator::Params params;
+    /// Without the reserved keys, the tables of the sample and of every passed through block are small.
+    Aggregator aggregator;
+    FileProviderPtr file_provider;
+    const size_t sample_rows;
+    const double pass_through_ratio;
+
+    bool sampled = false;
+    bool pass_through = false;
+    size_t pass_through_rows = 0;
+
+    ColumnRawPtrs key_columns;
+    Aggregator::AggregateColumns aggregate_columns;
+    Int64 local_delta_memory = 0;
+    bool no_more_keys = false;
+
+    /// The blocks read by the sample, aggregated again by `impl` if the stream is aggregated as a whole.
+    BlocksList sample_blocks;
+    bool input_finished = false;
+    std::unique_ptr<IBlockInputStream> impl;
+
+    BlocksList output_blocks;
+};
+
+} // namespace DB
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <Common/Stopwatch.h>
 
@@ -48,6 +49,14 @@ struct BlockStreamProfileInfo
     // time spent on current stream and all its children streams, but also the time of its
     // parent streams
     UInt64 execution_time = 0;
+    // cpu time is the thread cpu time spent on current stream and its children streams read in the same thread,
+    // the difference between `execution_time` and it is the time waiting for io, exchange, locks or other threads
+    UInt64 execution_cpu_time = 0;
+    // the memory held by current stream and its children streams read in the same thread, not including the
+    // blocks returned to the parent stream. It is computed from the memory tracked by the reading threads, so it
+    // is an approximation when the blocks are allocated and freed in different threads.
+    Int64 held_memory = 0;
+    Int64 peak_memory = 0;
 
     using BlockStreamProfileInfos = std::vector<const BlockStreamProfileInfo *>;
 
@@ -66,6 +75,16 @@ struct BlockStreamProfileInfo
 
     void updateExecutionTime(UInt64 time) { execution_time += time; }
 
+    void updateExecutionCPUTime(UInt64 time) { execution_cpu_time += time; }
+
+    /// `memory_delta` is the memory tracked by current thread during a read, `output_bytes` is the size of the block returned.
+    void updateMemory(Int64 memory_delta, Int64 output_bytes)
+    {
+        held_memory = std::max<Int64>(0, held_memory + memory_delta);
+        peak_memory = std::max(peak_memory, held_memory);
+        held_memory = std::max<Int64>(0, held_memory - output_bytes);
+    }
+
     /// Binary serialization and deserialization of main fields.
     /// Writes only main fields i.e. fields that required by internal transmission protocol.
     void read(ReadBuffer & in);
@@ -119,10 +119,19 @@ void CreatingSetsBlockInputStream::createAll()
         {
             for (auto & elem : subqueries_for_sets)
             {
-                if (elem.second.join)
+                if (elem.second.join && !elem.second.drain_only)
                     elem.second.join->setBuildTableState(Join::BuildTableState::WAITING);
             }
         }
+        /// the probe side can read its blocks ahead while the hash tables are being built.
+        for (auto & subqueries_for_sets : subqueries_for_sets_list)
+        {
+            for (auto & elem : subqueries_for_sets)
+            {
+                if (elem.second.join && !elem.second.drain_only)
+                    elem.second.join->startProbePrefetch();
+            }
+        }
         Stopwatch watch;
         auto thread_manager = newThreadManager();
         for (auto & subqueries_for_sets : subqueries_for_sets_list)
@@ -174,6 +183,17 @@ void CreatingSetsBlockInputStream::createOne(SubqueryForSet & subquery)
     try
     {
         LOG_FMT_DEBUG(log, "{}", gen_log_msg());
+        if (subquery.drain_only)
+        {
+            while (subquery.source->read())
+            {
+                if (isCancelled())
+                    return;
+            }
+            LOG_FMT_DEBUG(log, "Drained the source of a join built by another task in {} sec.", watch.elapsedSeconds());
+            return;
+        }
+
         BlockOutputStreamPtr table_out;
         if (subquery.table)
             table_out = subquery.table->write({}, {});
@@ -239,6 +259,7 @@ void CreatingSetsBlockInputStream::createOne(SubqueryForSet & subquery)
         if (subquery.join)
         {
             FAIL_POINT_TRIGGER_EXCEPTION(FailPoints::exception_mpp_hash_build);
+            subquery.join->finishBuild();
             subquery.join->setBuildTableState(Join::BuildTableState::SUCCEED);
         }
 
@@ -290,7 +311,7 @@ void CreatingSetsBlockInputStream::createOne(SubqueryForSet & subquery)
     {
         std::unique_lock lock(exception_mutex);
         exception_from_workers.push_back(std::current_exception());
-        if (subquery.join)
+        if (subquery.join && !subquery.drain_only)
             subquery.join->setBuildTableState(Join::BuildTableState::FAILED);
         LOG_FMT_ERROR(log, "{} throw exception: {} In {} sec. ", gen_log_msg(), getCurrentExceptionMessage(false, true), watch.elapsedSeconds());
     }
@@ -14,6 +14,7 @@
 
 #include <Common/FailPoint.h>
 #include <DataStreams/ExchangeSenderBlockInputStream.h>
+#include <Flash/Mpp/MPPTunnelSet.h>
 
 namespace DB
 {
@@ -36,6 +37,15 @@ Block ExchangeSenderBlockInputStream::readImpl()
         FAIL_POINT_TRIGGER_EXCEPTION(FailPoints::exception_during_mpp_non_root_task_run);
     }
 
+    /// Every receiver has got enough data, e.g. their LIMIT are reached, stop the pipeline to release the resources early.
+    const auto & tunnel_set = writer->dagContext().tunnel_set;
+    if (tunnel_set != nullptr && tunnel_set->isAllReceiversDone())
+    {
+        LOG_FMT_DEBUG(log, "all the receivers are done, stop sending after {} rows", total_rows);
+        cancel(false);
+        return {};
+    }
+
     Block block = children.back()->read();
     if (block)
     {
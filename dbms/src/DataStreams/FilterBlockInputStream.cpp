@@ -33,7 +33,8 @@ FilterBlockInputStream::FilterBlockInputStream(
     const BlockInputStreamPtr & input,
     const ExpressionActionsPtr & expression_,
     const String & filter_column_name,
-    const String & req_id)
+    const String & req_id,
+    const Names & output_columns_)
     : expression(expression_)
     , log(Logger::get(NAME, req_id))
 {
@@ -56,6 +57,30 @@ FilterBlockInputStream::FilterBlockInputStream(
         FilterDescription filter_description_check(*column_elem.column);
         column_elem.column = column_elem.type->createColumnConst(header.rows(), UInt64(1));
     }
+
+    output_filter_column = filter_column;
+    if (!output_columns_.empty())
+    {
+        output_filter_column = -1;
+        for (const auto & name : output_columns_)
+        {
+            size_t position = header.getPositionByName(name);
+            if (position == static_cast<size_t>(filter_column))
+                output_filter_column = output_positions.size();
+            output_positions.push_back(position);
+        }
+        header = projectOutput(header);
+    }
+}
+
+Block FilterBlockInputStream::projectOutput(const Block & block) const
+{
+    if (output_positions.empty())
+        return block;
+    Block res;
+    for (size_t position : output_positions)
+        res.insert(block.getByPosition(position));
+    return res;
 }
 
 Block FilterBlockInputStream::getTotals()
@@ -64,6 +89,8 @@ Block FilterBlockInputStream::getTotals()
     {
         totals = child->getTotals();
         expression->executeOnTotals(totals);
+        if (totals)
+            totals = projectOutput(totals);
     }
 
     return totals;
@@ -95,12 +122,14 @@ Block FilterBlockInputStream::readImpl()
 
         expression->execute(res);
 
-        if (constant_filter_description.always_true && !child_filter)
-            return res;
-
-        size_t columns = res.columns();
         size_t rows = res.rows();
         ColumnPtr column_of_filter = res.safeGetByPosition(filter_column).column;
+        /// Drop the columns not output before filtering them.
+        res = projectOutput(res);
+        size_t columns = res.columns();
+
+        if (constant_filter_description.always_true && !child_filter)
+            return res;
 
         if (unlikely(child_filter && child_filter->size() != rows))
             throw Exception("Unexpected child filter size", ErrorCodes::LOGICAL_ERROR);
@@ -159,13 +188,13 @@ Block FilterBlockInputStream::readImpl()
             {
                 first_non_constant_column = i;
 
-                if (first_non_constant_column != static_cast<size_t>(filter_column))
+                if (first_non_constant_column != static_cast<size_t>(output_filter_column))
                     break;
             }
         }
 
         size_t filtered_rows = 0;
-        if (first_non_constant_column != static_cast<size_t>(filter_column))
+        if (first_non_constant_column != static_cast<size_t>(output_filter_column))
         {
             ColumnWithTypeAndName & current_column = res.safeGetByPosition(first_non_constant_column);
             current_column.column = current_column.column->filter(*filter, -1);
@@ -184,8 +213,9 @@ Block FilterBlockInputStream::readImpl()
         if (filtered_rows == rows)
         {
             /// Replace the column with the filter by a constant.
-            res.safeGetByPosition(filter_column).column
-                = res.safeGetByPosition(filter_column).type->createColumnConst(filtered_rows, UInt64(1));
+            if (output_filter_column >= 0)
+                res.safeGetByPosition(output_filter_column).column
+                    = res.safeGetByPosition(output_filter_column).type->createColumnConst(filtered_rows, UInt64(1));
             /// No need to touch the rest of the columns.
             return res;
         }
@@ -195,7 +225,7 @@ Block FilterBlockInputStream::readImpl()
         {
             ColumnWithTypeAndName & current_column = res.safeGetByPosition(i);
 
-            if (i == static_cast<size_t>(filter_column))
+            if (i == static_cast<size_t>(output_filter_column))
             {
                 /// The column with filter itself is replaced with a column with a constant `1`, since after filtering, nothing else will remain.
                 /// NOTE User could pass column with something different than 0 and 1 for filter.
@@ -26,6 +26,8 @@ class ExpressionActions;
 /** Implements WHERE, HAVING operations.
   * A stream of blocks and an expression, which adds to the block one ColumnUInt8 column containing the filtering conditions, are passed as input.
   * The expression is evaluated and a stream of blocks is returned, which contains only the filtered rows.
+  * If `output_columns_` is not empty, only these columns are filtered and returned, so the columns used only by the filter
+  *  or dropped by the next projection are not filtered.
   */
 class FilterBlockInputStream : public IProfilingBlockInputStream
 {
@@ -39,7 +41,8 @@ public:
         const BlockInputStreamPtr & input,
         const ExpressionActionsPtr & expression_,
         const String & filter_column_name_,
-        const String & req_id);
+        const String & req_id,
+        const Names & output_columns_ = {});
 
     String getName() const override { return NAME; }
     Block getTotals() override;
@@ -49,10 +52,19 @@ protected:
     Block readImpl() override;
 
 private:
+    /// Keep only the columns at output_positions of `block`.
+    Block projectOutput(const Block & block) const;
+
     ExpressionActionsPtr expression;
     Block header;
+    /// The position of the filter column in the block after the expression is executed.
     ssize_t filter_column;
 
+    /// The positions of the output columns in the block after the expression, empty means all of them.
+    std::vector<size_t> output_positions;
+    /// The position of the filter column in the output block, -1 if it is not output.
+    ssize_t output_filter_column;
+
     ConstantFilterDescription constant_filter_description;
 
     const LoggerPtr log;
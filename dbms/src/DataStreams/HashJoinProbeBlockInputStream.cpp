@@ -14,15 +14,20 @@
 
 #include <DataStreams/HashJoinProbeBlockInputStream.h>
 #include <Interpreters/ExpressionActions.h>
+#include <common/logger_useful.h>
 
 namespace DB
 {
 HashJoinProbeBlockInputStream::HashJoinProbeBlockInputStream(
     const BlockInputStreamPtr & input,
     const ExpressionActionsPtr & join_probe_actions_,
+    const JoinPtr & join_,
+    size_t max_block_size_,
     const String & req_id)
     : log(Logger::get(name, req_id))
     , join_probe_actions(join_probe_actions_)
+    , join(join_)
+    , max_block_size(max_block_size_)
 {
     children.push_back(input);
 
@@ -53,6 +58,9 @@ Block HashJoinProbeBlockInputStream::getHeader() const
 
 Block HashJoinProbeBlockInputStream::readImpl()
 {
+    if (join->isSpilled())
+        return readFromSpilledJoin();
+
     Block res = children.back()->read();
     if (!res)
         return res;
@@ -65,4 +73,39 @@ Block HashJoinProbeBlockInputStream::readImpl()
     return res;
 }
 
+Block HashJoinProbeBlockInputStream::readFromSpilledJoin()
+{
+    if (!probe_spilled)
+    {
+        while (Block block = children.back()->read())
+            join->spillProbeBlock(block);
+        probe_spilled = true;
+        join->finishOneProbe();
+        /// All the probe rows must be spilled before any partition is restored.
+        while (!join->waitProbeFinished(std::chrono::milliseconds(100)))
+        {
+            if (isCancelledOrThrowIfKilled())
+                return {};
+        }
+        LOG_FMT_DEBUG(log, "Finish spilling probe data, start joining spilled partitions");
+    }
+
+    while (!isCancelledOrThrowIfKilled())
+    {
+        if (!restore_stream)
+        {
+            size_t partition_index = join->fetchNextRestorePartition();
+            if (partition_index >= join->getSpillPartitionNum())
+                return {};
+            restore_stream = join->createStreamForSpilledPartition(partition_index, children.back()->getHeader(), getHeader(), max_block_size);
+            restore_stream->readPrefix();
+        }
+        if (Block block = restore_stream->read())
+            return block;
+        restore_stream->readSuffix();
+        restore_stream.reset();
+    }
+    return {};
+}
+
 } // namespace DB
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <DataStreams/IProfilingBlockInputStream.h>
+#include <Interpreters/Join.h>
 
 namespace DB
 {
@@ -27,6 +28,9 @@ class ExpressionActions;
   * The join probe action is different from the general expression
   * and needs to be executed after join hash map building.
   * We should separate it from the ExpressionBlockInputStream.
+  *
+  * If the join is spilled, the probe blocks are spilled into the partitions of the join first,
+  * and then the spilled partitions are restored and joined one by one.
   */
 class HashJoinProbeBlockInputStream : public IProfilingBlockInputStream
 {
@@ -38,6 +42,8 @@ public:
     HashJoinProbeBlockInputStream(
         const BlockInputStreamPtr & input,
         const ExpressionActionsPtr & join_probe_actions_,
+        const JoinPtr & join_,
+        size_t max_block_size_,
         const String & req_id);
 
     String getName() const override { return name; }
@@ -47,9 +53,17 @@ public:
 protected:
     Block readImpl() override;
 
+private:
+    Block readFromSpilledJoin();
+
 private:
     const LoggerPtr log;
     ExpressionActionsPtr join_probe_actions;
+    JoinPtr join;
+    size_t max_block_size;
+
+    bool probe_spilled = false;
+    BlockInputStreamPtr restore_stream;
 };
 
 } // namespace DB
@@ -0,0 +1,140 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <DataStreams/HashJoinProbePrefetchBlockInputStream.h>
+
+namespace DB
+{
+HashJoinProbePrefetchBlockInputStream::HashJoinProbePrefetchBlockInputStream(
+    const BlockInputStreamPtr & input,
+    size_t max_prefetch_blocks,
+    const String & req_id)
+    : queue(max_prefetch_blocks)
+    , log(Logger::get(name, req_id))
+{
+    children.push_back(input);
+}
+
+HashJoinProbePrefetchBlockInputStream::~HashJoinProbePrefetchBlockInputStream()
+{
+    try
+    {
+        cancel(false);
+        readSuffix();
+    }
+    catch (...)
+    {
+        tryLogCurrentException(log, __PRETTY_FUNCTION__);
+    }
+}
+
+void HashJoinProbePrefetchBlockInputStream::startPrefetch()
+{
+    std::lock_guard lock(mutex);
+    if (prefetch_started || read_suffixed)
+        return;
+    prefetch_started = true;
+    thread_manager = newThreadManager();
+    thread_manager->schedule(true, "JoinProbePrefetch", [this] { prefetchBlocks(); });
+}
+
+void HashJoinProbePrefetchBlockInputStream::readPrefix()
+{
+    /// the input is read prefixed by the prefetch thread
+    startPrefetch();
+}
+
+void HashJoinProbePrefetchBlockInputStream::readSuffix()
+{
+    std::lock_guard lock(mutex);
+    if (read_suffixed)
+        return;
+    read_suffixed = true;
+    queue.cancel();
+    waitThread();
+}
+
+/// Different from the default implementation by cancelling the queue to wake up the prefetch thread.
+void HashJoinProbePrefetchBlockInputStream::cancel(bool kill)
+{
+    if (kill)
+        is_killed = true;
+
+    bool old_val = false;
+    if (!is_cancelled.compare_exchange_strong(old_val, true, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return;
+
+    queue.cancel();
+    if (auto * child = dynamic_cast<IProfilingBlockInputStream *>(children.back().get()))
+        child->cancel(kill);
+}
+
+Block HashJoinProbePrefetchBlockInputStream::readImpl()
+{
+    Block block;
+    if (!queue.pop(block))
+    {
+        if (!isCancelled())
+        {
+            /// the prefetch thread has finished, get its final status
+            std::lock_guard lock(mutex);
+            waitThread();
+        }
+        return {};
+    }
+    return block;
+}
+
+void HashJoinProbePrefetchBlockInputStream::prefetchBlocks()
+{
+    try
+    {
+        auto & input = children.back();
+        input->readPrefix();
+        while (true)
+        {
+            Block block = input->read();
+            /// the input is finished or the queue is cancelled
+            if (!block || !queue.push(std::move(block)))
+                break;
+        }
+        input->readSuffix();
+    }
+    catch (Exception & e)
+    {
+        exception_msg = e.message();
+    }
+    catch (std::exception & e)
+    {
+        exception_msg = e.what();
+    }
+    catch (...)
+    {
+        exception_msg = "other error";
+    }
+    queue.finish();
+}
+
+void HashJoinProbePrefetchBlockInputStream::waitThread()
+{
+    if (thread_manager)
+    {
+        thread_manager->wait();
+        thread_manager.reset();
+    }
+    if (!exception_msg.empty())
+        throw Exception(exception_msg);
+}
+
+} // namespace DB
@@ -0,0 +1,75 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/MPMCQueue.h>
+#include <Common/ThreadManager.h>
+#include <DataStreams/IProfilingBlockInputStream.h>
+
+#include <mutex>
+
+namespace DB
+{
+/** Reads the probe side of a hash join ahead in a background thread while the hash table is being built.
+  * The blocks are buffered in a bounded queue, so the probe starts with its input ready instead of
+  * waiting for the upstream after the build, and the upstream senders are not stalled during the build.
+  *
+  * The prefetch is started by `startPrefetch`, which is registered to the join by `Join::addProbePrefetcher`,
+  * or by `readPrefix` if the join never starts it.
+  */
+class HashJoinProbePrefetchBlockInputStream : public IProfilingBlockInputStream
+{
+    static constexpr auto name = "HashJoinProbePrefetch";
+
+public:
+    HashJoinProbePrefetchBlockInputStream(
+        const BlockInputStreamPtr & input,
+        size_t max_prefetch_blocks,
+        const String & req_id);
+
+    ~HashJoinProbePrefetchBlockInputStream() override;
+
+    String getName() const override { return name; }
+    Block getHeader() const override { return children.back()->getHeader(); }
+
+    /// Start reading the input in the background, it is a no-op if the prefetch has started.
+    void startPrefetch();
+
+    void readPrefix() override;
+    void readSuffix() override;
+    void cancel(bool kill) override;
+
+    void collectNewThreadCountOfThisLevel(int & cnt) override { ++cnt; }
+
+protected:
+    Block readImpl() override;
+
+private:
+    void prefetchBlocks();
+    void waitThread();
+
+private:
+    MPMCQueue<Block> queue;
+
+    std::mutex mutex;
+    bool prefetch_started = false;
+    bool read_suffixed = false;
+    std::shared_ptr<ThreadManager> thread_manager;
+    String exception_msg;
+
+    const LoggerPtr log;
+};
+
+} // namespace DB
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/MemoryTracker.h>
 #include <Interpreters/Quota.h>
 #include <Interpreters/ProcessList.h>
 #include <DataStreams/IProfilingBlockInputStream.h>
@@ -63,6 +64,8 @@ Block IProfilingBlockInputStream::read(FilterPtr & res_filter, bool return_filte
         return res;
 
     auto start_time = info.total_stopwatch.elapsed();
+    auto start_cpu_time = clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID);
+    auto start_memory = CurrentMemoryTracker::getThreadMemoryAmount();
 
     if (!checkTimeLimit())
         limit_exceeded_need_break = true;
@@ -111,6 +114,8 @@ Block IProfilingBlockInputStream::read(FilterPtr & res_filter, bool return_filte
 #endif
 
     info.updateExecutionTime(info.total_stopwatch.elapsed() - start_time);
+    info.updateExecutionCPUTime(clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID) - start_cpu_time);
+    info.updateMemory(CurrentMemoryTracker::getThreadMemoryAmount() - start_memory, res ? res.allocatedBytes() : 0);
     return res;
 }
 
@@ -118,6 +123,8 @@ Block IProfilingBlockInputStream::read(FilterPtr & res_filter, bool return_filte
 void IProfilingBlockInputStream::readPrefix()
 {
     auto start_time = info.total_stopwatch.elapsed();
+    auto start_cpu_time = clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID);
+    auto start_memory = CurrentMemoryTracker::getThreadMemoryAmount();
     readPrefixImpl();
 
     forEachChild([&] (IBlockInputStream & child)
@@ -126,12 +133,16 @@ void IProfilingBlockInputStream::readPrefix()
         return false;
     });
     info.updateExecutionTime(info.total_stopwatch.elapsed() - start_time);
+    info.updateExecutionCPUTime(clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID) - start_cpu_time);
+    info.updateMemory(CurrentMemoryTracker::getThreadMemoryAmount() - start_memory, 0);
 }
 
 
 void IProfilingBlockInputStream::readSuffix()
 {
     auto start_time = info.total_stopwatch.elapsed();
+    auto start_cpu_time = clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID);
+    auto start_memory = CurrentMemoryTracker::getThreadMemoryAmount();
     forEachChild([&] (IBlockInputStream & child)
     {
         child.readSuffix();
@@ -140,6 +151,8 @@ void IProfilingBlockInputStream::readSuffix()
 
     readSuffixImpl();
     info.updateExecutionTime(info.total_stopwatch.elapsed() - start_time);
+    info.updateExecutionCPUTime(clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID) - start_cpu_time);
+    info.updateMemory(CurrentMemoryTracker::getThreadMemoryAmount() - start_memory, 0);
 }
 
 
@@ -410,6 +423,20 @@ void IProfilingBlockInputStream::setProcessListElement(ProcessListElement * elem
 }
 
 
+size_t IProfilingBlockInputStream::getTotalRowsApprox()
+{
+    size_t res = total_rows_approx;
+
+    forEachProfilingChild([&] (IProfilingBlockInputStream & child)
+    {
+        res += child.getTotalRowsApprox();
+        return false;
+    });
+
+    return res;
+}
+
+
 Block IProfilingBlockInputStream::getTotals()
 {
     if (totals)
@@ -125,6 +125,11 @@ public:
       */
     void addTotalRowsApprox(size_t value) { total_rows_approx += value; }
 
+    /** The approximate total number of rows to read by this stream and its children,
+      *  as set by `addTotalRowsApprox`. Only meaningful before reading begins.
+      */
+    size_t getTotalRowsApprox();
+
 
     /** Ask to abort the receipt of data as soon as possible.
       * By default - just sets the flag is_cancelled and asks that all children be interrupted.
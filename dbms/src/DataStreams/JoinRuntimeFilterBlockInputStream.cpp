@@ -0,0 +1,79 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnsCommon.h>
+#include <Common/FmtUtils.h>
+#include <DataStreams/JoinRuntimeFilterBlockInputStream.h>
+
+namespace DB
+{
+JoinRuntimeFilterBlockInputStream::JoinRuntimeFilterBlockInputStream(
+    const BlockInputStreamPtr & input,
+    const JoinPtr & join_,
+    const String & key_name,
+    const String & req_id)
+    : join(join_)
+    , log(Logger::get(NAME, req_id))
+{
+    children.push_back(input);
+    key_position = input->getHeader().getPositionByName(key_name);
+    RUNTIME_CHECK(join->getRuntimeFilter() != nullptr, Exception, "The join has no runtime filter");
+}
+
+Block JoinRuntimeFilterBlockInputStream::readImpl()
+{
+    while (true)
+    {
+        Block block = children.back()->read();
+        if (!block)
+            return block;
+
+        if (!build_finished)
+        {
+            join->waitBuildTableFinished();
+            build_finished = true;
+        }
+
+        size_t rows = block.rows();
+        input_rows += rows;
+        IColumn::Filter filter(rows, 1);
+        join->getRuntimeFilter()->filter(*block.getByPosition(key_position).column, filter);
+        size_t passed_rows = countBytesInFilter(filter);
+        filtered_rows += rows - passed_rows;
+        if (passed_rows == 0)
+            continue;
+        if (passed_rows == rows)
+            return block;
+
+        for (size_t i = 0; i < block.columns(); ++i)
+        {
+            auto & column = block.getByPosition(i).column;
+            column = column->filter(filter, passed_rows);
+        }
+        return block;
+    }
+}
+
+void JoinRuntimeFilterBlockInputStream::readSuffixImpl()
+{
+    LOG_FMT_DEBUG(log, "Runtime filter {} dropped {} of {} probe rows", join->getRuntimeFilter()->toString(), filtered_rows, input_rows);
+}
+
+void JoinRuntimeFilterBlockInputStream::appendInfo(FmtBuffer & buffer) const
+{
+    buffer.fmtAppend(", key_position = {}", key_position);
+}
+
+} // namespace DB
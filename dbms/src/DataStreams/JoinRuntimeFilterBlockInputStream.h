@@ -0,0 +1,56 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <DataStreams/IProfilingBlockInputStream.h>
+#include <Interpreters/Join.h>
+
+namespace DB
+{
+/** Drops the probe rows that can not match the build side of `join`, by the runtime filter of the join.
+  * It waits until the build side finishes before returning the first block.
+  */
+class JoinRuntimeFilterBlockInputStream : public IProfilingBlockInputStream
+{
+    static constexpr auto NAME = "JoinRuntimeFilter";
+
+public:
+    JoinRuntimeFilterBlockInputStream(
+        const BlockInputStreamPtr & input,
+        const JoinPtr & join_,
+        const String & key_name,
+        const String & req_id);
+
+    String getName() const override { return NAME; }
+    Block getHeader() const override { return children.back()->getHeader(); }
+
+protected:
+    Block readImpl() override;
+    void readSuffixImpl() override;
+    void appendInfo(FmtBuffer & buffer) const override;
+
+private:
+    JoinPtr join;
+    size_t key_position;
+    bool build_finished = false;
+
+    size_t input_rows = 0;
+    size_t filtered_rows = 0;
+
+    const LoggerPtr log;
+};
+
+} // namespace DB
@@ -0,0 +1,162 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <DataStreams/LocalShuffleBlockInputStream.h>
+#include <DataStreams/materializeBlock.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+} // namespace ErrorCodes
+
+BlockInputStreams LocalShuffleBlockInputStream::build(
+    const BlockInputStreams & inputs,
+    size_t stream_count,
+    const std::vector<Int64> & partition_col_ids,
+    const TiDB::TiDBCollators & collators,
+    const String & req_id)
+{
+    if (unlikely(inputs.empty() || stream_count < inputs.size()))
+        throw Exception(fmt::format("Can not shuffle {} streams into {} streams", inputs.size(), stream_count), ErrorCodes::LOGICAL_ERROR);
+
+    auto state = std::make_shared<LocalShuffleState>(stream_count, inputs.size());
+    const auto header = inputs.front()->getHeader();
+    BlockInputStreams streams;
+    streams.reserve(stream_count);
+    for (size_t i = 0; i < stream_count; ++i)
+    {
+        const auto & input = i < inputs.size() ? inputs[i] : nullptr;
+        streams.push_back(std::make_shared<LocalShuffleBlockInputStream>(input, header, i, state, partition_col_ids, collators, req_id));
+    }
+    return streams;
+}
+
+LocalShuffleBlockInputStream::LocalShuffleBlockInputStream(
+    const BlockInputStreamPtr & input,
+    const Block & header_,
+    size_t stream_index_,
+    const LocalShuffleStatePtr & state_,
+    const std::vector<Int64> & partition_col_ids,
+    const TiDB::TiDBCollators & collators,
+    const String & req_id)
+    : header(materializeBlock(header_).cloneEmpty())
+    , stream_index(stream_index_)
+    , state(state_)
+    , partitioner(partition_col_ids, collators, state->queues.size())
+    , input_finished(input == nullptr)
+    , log(Logger::get(NAME, req_id))
+{
+    if (input)
+        children.push_back(input);
+}
+
+void LocalShuffleBlockInputStream::cancel(bool kill)
+{
+    IProfilingBlockInputStream::cancel(kill);
+    {
+        std::lock_guard lock(state->mutex);
+        state->cancelled = true;
+    }
+    state->cv.notify_all();
+}
+
+bool LocalShuffleBlockInputStream::shuffleOneBlock()
+{
+    Block block;
+    try
+    {
+        block = children.back()->read();
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard lock(state->mutex);
+            state->failed = true;
+        }
+        state->cv.notify_all();
+        throw;
+    }
+
+    if (!block)
+    {
+        {
+            std::lock_guard lock(state->mutex);
+            --state->unfinished_inputs;
+        }
+        state->cv.notify_all();
+        return false;
+    }
+    if (block.rows() == 0)
+        return true;
+    // The constant columns can not be scattered into the columns of the header.
+    block = materializeBlock(block);
+
+    const size_t bucket_num = state->queues.size();
+    std::vector<MutableColumns> dest_columns(bucket_num);
+    for (auto & columns : dest_columns)
+        columns = header.cloneEmptyColumns();
+    partitioner.partition(block, dest_columns);
+
+    {
+        std::lock_guard lock(state->mutex);
+        for (size_t bucket_idx = 0; bucket_idx < bucket_num; ++bucket_idx)
+        {
+            if (!dest_columns[bucket_idx].empty() && dest_columns[bucket_idx][0]->empty())
+                continue;
+            state->queues[bucket_idx].push_back(header.cloneWithColumns(std::move(dest_columns[bucket_idx])));
+        }
+    }
+    state->cv.notify_all();
+    return true;
+}
+
+Block LocalShuffleBlockInputStream::readImpl()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(state->mutex);
+            // Keep reading the input before waiting for the others, so that every input is always consumed.
+            if (input_finished)
+            {
+                state->cv.wait(lock, [&] {
+                    return !state->queues[stream_index].empty() || state->unfinished_inputs == 0 || state->cancelled || state->failed;
+                });
+            }
+            if (state->failed)
+                throw Exception("Some stream of the local shuffle failed", ErrorCodes::LOGICAL_ERROR);
+            if (state->cancelled)
+                return {};
+
+            auto & queue = state->queues[stream_index];
+            if (!queue.empty())
+            {
+                Block block = std::move(queue.front());
+                queue.pop_front();
+                return block;
+            }
+            if (input_finished && state->unfinished_inputs == 0)
+            {
+                LOG_FMT_TRACE(log, "local shuffle stream {} finished", stream_index);
+                return {};
+            }
+        }
+        if (!input_finished && !shuffleOneBlock())
+            input_finished = true;
+    }
+}
+
+} // namespace DB
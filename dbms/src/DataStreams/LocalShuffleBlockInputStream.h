@@ -0,0 +1,95 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/Logger.h>
+#include <DataStreams/IProfilingBlockInputStream.h>
+#include <Flash/Coprocessor/HashPartitioner.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace DB
+{
+/// The state shared by the streams of one local shuffle.
+struct LocalShuffleState
+{
+    LocalShuffleState(size_t stream_count, size_t input_count)
+        : queues(stream_count)
+        , unfinished_inputs(input_count)
+    {}
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    /// The shuffled blocks of each output stream.
+    std::vector<std::deque<Block>> queues;
+    size_t unfinished_inputs;
+    bool cancelled = false;
+    bool failed = false;
+};
+using LocalShuffleStatePtr = std::shared_ptr<LocalShuffleState>;
+
+/** Shuffle the blocks of several streams into `stream_count` streams by the hash of the partition columns,
+  * so that the rows with the same partition keys are always output by the same stream. It works like an
+  * exchange inside one task: the i-th stream reads the i-th input stream (if any), scatters its blocks to
+  * all the streams, and outputs the blocks scattered to itself. A stream only waits for the others after
+  * its own input is exhausted.
+  */
+class LocalShuffleBlockInputStream : public IProfilingBlockInputStream
+{
+    static constexpr auto NAME = "LocalShuffle";
+
+public:
+    /// Create `stream_count` streams which shuffle `inputs` by `partition_col_ids`, `stream_count` should not be less than the size of `inputs`.
+    static BlockInputStreams build(
+        const BlockInputStreams & inputs,
+        size_t stream_count,
+        const std::vector<Int64> & partition_col_ids,
+        const TiDB::TiDBCollators & collators,
+        const String & req_id);
+
+    LocalShuffleBlockInputStream(
+        const BlockInputStreamPtr & input,
+        const Block & header_,
+        size_t stream_index_,
+        const LocalShuffleStatePtr & state_,
+        const std::vector<Int64> & partition_col_ids,
+        const TiDB::TiDBCollators & collators,
+        const String & req_id);
+
+    String getName() const override { return NAME; }
+
+    Block getHeader() const override { return header; }
+
+    void cancel(bool kill) override;
+
+protected:
+    Block readImpl() override;
+
+private:
+    /// Read a block from the input and scatter it to the queues, return false if the input is exhausted.
+    bool shuffleOneBlock();
+
+    const Block header;
+    const size_t stream_index;
+    LocalShuffleStatePtr state;
+    HashPartitioner partitioner;
+    bool input_finished;
+
+    const LoggerPtr log;
+};
+
+} // namespace DB
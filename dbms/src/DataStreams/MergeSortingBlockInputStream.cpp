@@ -12,12 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/TiFlashMetrics.h>
 #include <DataStreams/MergeSortingBlockInputStream.h>
 #include <DataStreams/MergingSortedBlockInputStream.h>
 #include <DataStreams/NativeBlockOutputStream.h>
 #include <DataStreams/copyData.h>
+#include <Encryption/WriteBufferFromFileProvider.h>
 #include <IO/CompressedWriteBuffer.h>
-#include <IO/WriteBufferFromFile.h>
 
 namespace DB
 {
@@ -75,12 +76,14 @@ MergeSortingBlockInputStream::MergeSortingBlockInputStream(
     size_t limit_,
     size_t max_bytes_before_external_sort_,
     const std::string & tmp_path_,
+    const FileProviderPtr & file_provider_,
     const String & req_id)
     : description(description_)
     , max_merged_block_size(max_merged_block_size_)
     , limit(limit_)
     , max_bytes_before_external_sort(max_bytes_before_external_sort_)
     , tmp_path(tmp_path_)
+    , file_provider(file_provider_)
     , log(Logger::get(NAME, req_id))
 {
     children.push_back(input);
@@ -90,6 +93,18 @@ MergeSortingBlockInputStream::MergeSortingBlockInputStream(
     removeConstantsFromSortDescription(header, description);
 }
 
+MergeSortingBlockInputStream::~MergeSortingBlockInputStream()
+{
+    /// Close the readers before removing the sorted runs they are reading.
+    impl.reset();
+    inputs_to_merge.clear();
+    temporary_inputs.clear();
+    for (const auto & file : temporary_files)
+        file_provider->deleteRegularFile(file->path(), EncryptionPath(file->path(), ""));
+    if (!temporary_files.empty())
+        LOG_FMT_DEBUG(log, "Removed {} temporary sorted parts, {} bytes spilled in total", temporary_files.size(), spilled_bytes);
+}
+
 
 Block MergeSortingBlockInputStream::readImpl()
 {
@@ -123,14 +138,18 @@ Block MergeSortingBlockInputStream::readImpl()
             {
                 temporary_files.emplace_back(new Poco::TemporaryFile(tmp_path));
                 const std::string & path = temporary_files.back()->path();
-                WriteBufferFromFile file_buf(path);
+                WriteBufferFromFileProvider file_buf(file_provider, path, EncryptionPath(path, ""));
                 CompressedWriteBuffer compressed_buf(file_buf);
                 NativeBlockOutputStream block_out(compressed_buf, 0, header_without_constants);
                 MergeSortingBlocksBlockInputStream block_in(blocks, description, log->identifier(), max_merged_block_size, limit);
 
                 LOG_FMT_INFO(log, "Sorting and writing part of data into temporary file {}", path);
                 copyData(block_in, block_out, &is_cancelled); /// NOTE. Possibly limit disk usage.
-                LOG_FMT_INFO(log, "Done writing part of data into temporary file {}", path);
+                compressed_buf.next();
+                file_buf.next();
+                spilled_bytes += file_buf.count();
+                GET_METRIC(tiflash_spilled_bytes, type_sort).Increment(file_buf.count());
+                LOG_FMT_INFO(log, "Done writing part of data into temporary file {}, {} bytes written", path, file_buf.count());
 
                 blocks.clear();
                 sum_bytes_in_blocks = 0;
@@ -148,12 +167,12 @@ Block MergeSortingBlockInputStream::readImpl()
         {
             /// If there was temporary files.
 
-            LOG_FMT_INFO(log, "There are {} temporary sorted parts to merge.", temporary_files.size());
+            LOG_FMT_INFO(log, "There are {} temporary sorted parts to merge, {} bytes spilled in total.", temporary_files.size(), spilled_bytes);
 
             /// Create sorted streams to merge.
             for (const auto & file : temporary_files)
             {
-                temporary_inputs.emplace_back(std::make_unique<TemporaryFileStream>(file->path(), header_without_constants));
+                temporary_inputs.emplace_back(std::make_unique<TemporaryFileStream>(file_provider, file->path(), header_without_constants));
                 inputs_to_merge.emplace_back(temporary_inputs.back()->block_in);
             }
 
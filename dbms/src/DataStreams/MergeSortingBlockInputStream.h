@@ -18,8 +18,9 @@
 #include <Core/SortDescription.h>
 #include <DataStreams/IProfilingBlockInputStream.h>
 #include <DataStreams/NativeBlockInputStream.h>
+#include <Encryption/FileProvider.h>
+#include <Encryption/ReadBufferFromFileProvider.h>
 #include <IO/CompressedReadBuffer.h>
-#include <IO/ReadBufferFromFile.h>
 #include <Poco/TemporaryFile.h>
 #include <common/logger_useful.h>
 
@@ -97,8 +98,11 @@ public:
         size_t limit_,
         size_t max_bytes_before_external_sort_,
         const std::string & tmp_path_,
+        const FileProviderPtr & file_provider_,
         const String & req_id);
 
+    ~MergeSortingBlockInputStream() override;
+
     String getName() const override { return NAME; }
 
     bool isGroupedOutput() const override { return true; }
@@ -118,6 +122,7 @@ private:
 
     size_t max_bytes_before_external_sort;
     const std::string tmp_path;
+    const FileProviderPtr file_provider;
 
     LoggerPtr log;
 
@@ -133,16 +138,17 @@ private:
 
     /// Everything below is for external sorting.
     std::vector<std::unique_ptr<Poco::TemporaryFile>> temporary_files;
+    size_t spilled_bytes = 0;
 
     /// For reading data from temporary file.
     struct TemporaryFileStream
     {
-        ReadBufferFromFile file_in;
+        ReadBufferFromFileProvider file_in;
         CompressedReadBuffer<> compressed_in;
         BlockInputStreamPtr block_in;
 
-        TemporaryFileStream(const std::string & path, const Block & header)
-            : file_in(path)
+        TemporaryFileStream(const FileProviderPtr & file_provider, const std::string & path, const Block & header)
+            : file_in(file_provider, path, EncryptionPath(path, ""))
             , compressed_in(file_in)
             , block_in(std::make_shared<NativeBlockInputStream>(compressed_in, header, 0))
         {}
@@ -234,9 +234,10 @@ void ParallelAggregatingBlockInputStream::execute()
         size_t rows = many_data[i]->size();
         LOG_FMT_TRACE(
             log,
-            "Aggregated. {} to {} rows (from {:.3f} MiB) in {:.3f} sec. ({:.3f} rows/sec., {:.3f} MiB/sec.)",
+            "Aggregated. {} to {} rows (reserved {} keys, from {:.3f} MiB) in {:.3f} sec. ({:.3f} rows/sec., {:.3f} MiB/sec.)",
             threads_data[i].src_rows,
             rows,
+            params.reserve_keys_hint,
             (threads_data[i].src_bytes / 1048576.0),
             elapsed_seconds,
             threads_data[i].src_rows / elapsed_seconds,
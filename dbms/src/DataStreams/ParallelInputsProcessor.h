@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/ColumnBufferPool.h>
 #include <Common/CurrentMetrics.h>
 #include <Common/Logger.h>
 #include <Common/MPMCQueue.h>
@@ -250,6 +251,9 @@ private:
 
     void thread(size_t thread_num)
     {
+        /// Temporary columns of the blocks in this thread reuse the buffers of the previous blocks.
+        ColumnBufferPool::Scope column_buffer_pool_scope;
+
         work(thread_num, working_inputs);
         work(thread_num, working_additional_inputs);
 
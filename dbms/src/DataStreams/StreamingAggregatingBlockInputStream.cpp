@@ -0,0 +1,220 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/FmtUtils.h>
+#include <DataStreams/StreamingAggregatingBlockInputStream.h>
+
+namespace DB
+{
+namespace
+{
+/// The arena of the states is replaced between two groups once it is larger than this, so that
+/// the memory does not grow with the number of groups.
+constexpr size_t arena_reset_bytes = 4 * 1024 * 1024;
+} // namespace
+
+StreamingAggregatingBlockInputStream::StreamingAggregatingBlockInputStream(
+    const BlockInputStreamPtr & input,
+    const Aggregator::Params & params_,
+    size_t max_block_size_,
+    const String & req_id)
+    : params(params_)
+    , header(params.getHeader(true))
+    , max_block_size(max_block_size_)
+    , arena(std::make_shared<Arena>())
+    , log(Logger::get(NAME, req_id))
+{
+    children.push_back(input);
+    RUNTIME_CHECK(params.keys_size > 0, Exception, "Streaming aggregation requires group by keys");
+
+    /// The same layout of the states as Aggregator.
+    offsets_of_aggregate_states.resize(params.aggregates_size);
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+    {
+        offsets_of_aggregate_states[i] = total_size_of_aggregate_states;
+        total_size_of_aggregate_states += params.aggregates[i].function->sizeOfData();
+        align_aggregate_states = std::max(align_aggregate_states, params.aggregates[i].function->alignOfData());
+        if (i + 1 < params.aggregates_size)
+        {
+            size_t alignment_of_next_state = params.aggregates[i + 1].function->alignOfData();
+            total_size_of_aggregate_states = (total_size_of_aggregate_states + alignment_of_next_state - 1) / alignment_of_next_state * alignment_of_next_state;
+        }
+    }
+    place = states_pool.alignedAlloc(total_size_of_aggregate_states, align_aggregate_states);
+
+    const Block & src_header = input->getHeader();
+    for (size_t i = 0; i < params.keys_size; ++i)
+        group_keys.push_back(src_header.getByPosition(params.keys[i]).type->createColumn());
+    result_columns = header.cloneEmptyColumns();
+}
+
+StreamingAggregatingBlockInputStream::~StreamingAggregatingBlockInputStream()
+{
+    if (has_group)
+        destroyStates();
+}
+
+void StreamingAggregatingBlockInputStream::destroyStates() noexcept
+{
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+        params.aggregates[i].function->destroy(place + offsets_of_aggregate_states[i]);
+    has_group = false;
+}
+
+void StreamingAggregatingBlockInputStream::startGroup(const ColumnRawPtrs & key_columns, size_t row)
+{
+    for (size_t i = 0; i < params.keys_size; ++i)
+    {
+        if (!group_keys[i]->empty())
+            group_keys[i]->popBack(1);
+        group_keys[i]->insertFrom(*key_columns[i], row);
+    }
+
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+    {
+        try
+        {
+            params.aggregates[i].function->create(place + offsets_of_aggregate_states[i]);
+        }
+        catch (...)
+        {
+            for (size_t rollback_i = 0; rollback_i < i; ++rollback_i)
+                params.aggregates[rollback_i].function->destroy(place + offsets_of_aggregate_states[rollback_i]);
+            throw;
+        }
+    }
+    has_group = true;
+}
+
+void StreamingAggregatingBlockInputStream::finishGroup()
+{
+    for (size_t i = 0; i < params.keys_size; ++i)
+        result_columns[i]->insertFrom(*group_keys[i], 0);
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+        params.aggregates[i].function->insertResultInto(place + offsets_of_aggregate_states[i], *result_columns[params.keys_size + i], arena.get());
+    destroyStates();
+    ++output_groups;
+
+    if (arena->size() > arena_reset_bytes)
+        arena = std::make_shared<Arena>();
+}
+
+void StreamingAggregatingBlockInputStream::consume(const Block & block)
+{
+    size_t rows = block.rows();
+    input_rows += rows;
+
+    /// Hold the materialized columns until the block is consumed.
+    Columns materialized_columns;
+    auto get_column = [&](size_t position) -> const IColumn * {
+        const auto & column = block.getByPosition(position).column;
+        if (auto converted = column->convertToFullColumnIfConst())
+        {
+            materialized_columns.push_back(converted);
+            return converted.get();
+        }
+        return column.get();
+    };
+
+    ColumnRawPtrs key_columns(params.keys_size);
+    for (size_t i = 0; i < params.keys_size; ++i)
+        key_columns[i] = get_column(params.keys[i]);
+
+    std::vector<ColumnRawPtrs> aggregate_columns(params.aggregates_size);
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+    {
+        aggregate_columns[i].resize(params.aggregates[i].arguments.size());
+        for (size_t j = 0; j < aggregate_columns[i].size(); ++j)
+            aggregate_columns[i][j] = get_column(params.aggregates[i].arguments[j]);
+    }
+
+    auto add_rows = [&](size_t begin, size_t end) {
+        for (size_t i = 0; i < params.aggregates_size; ++i)
+            params.aggregates[i].function->addBatchSinglePlaceFromInterval(begin, end, place + offsets_of_aggregate_states[i], aggregate_columns[i].data(), arena.get());
+    };
+    auto same_keys = [&](size_t row, const ColumnRawPtrs & rhs_columns, size_t rhs_row) {
+        for (size_t i = 0; i < params.keys_size; ++i)
+        {
+            if (key_columns[i]->compareAt(row, rhs_row, *rhs_columns[i], 1) != 0)
+                return false;
+        }
+        return true;
+    };
+
+    ColumnRawPtrs group_key_columns(params.keys_size);
+    for (size_t i = 0; i < params.keys_size; ++i)
+        group_key_columns[i] = group_keys[i].get();
+
+    size_t begin = 0;
+    if (!has_group || !same_keys(0, group_key_columns, 0))
+    {
+        if (has_group)
+            finishGroup();
+        startGroup(key_columns, 0);
+    }
+    for (size_t row = 1; row < rows; ++row)
+    {
+        if (same_keys(row, key_columns, row - 1))
+            continue;
+        add_rows(begin, row);
+        finishGroup();
+        startGroup(key_columns, row);
+        begin = row;
+    }
+    add_rows(begin, rows);
+}
+
+Block StreamingAggregatingBlockInputStream::popResult()
+{
+    Block res = header.cloneWithColumns(std::move(result_columns));
+    result_columns = header.cloneEmptyColumns();
+    return res;
+}
+
+Block StreamingAggregatingBlockInputStream::readImpl()
+{
+    while (!input_finished)
+    {
+        Block block = children.back()->read();
+        if (!block)
+        {
+            input_finished = true;
+            if (has_group)
+                finishGroup();
+            break;
+        }
+        if (block.rows() == 0)
+            continue;
+
+        consume(block);
+        if (result_columns[0]->size() >= max_block_size)
+            return popResult();
+    }
+
+    if (result_columns[0]->empty())
+        return {};
+    return popResult();
+}
+
+void StreamingAggregatingBlockInputStream::readSuffixImpl()
+{
+    LOG_FMT_DEBUG(log, "Aggregated {} sorted rows into {} groups", input_rows, output_groups);
+}
+
+void StreamingAggregatingBlockInputStream::appendInfo(FmtBuffer & buffer) const
+{
+    buffer.fmtAppend(", keys_size = {}, aggregates_size = {}", params.keys_size, params.aggregates_size);
+}
+
+} // namespace DB
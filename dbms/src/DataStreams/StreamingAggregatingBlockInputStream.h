@@ -0,0 +1,88 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/Arena.h>
+#include <DataStreams/IProfilingBlockInputStream.h>
+#include <Interpreters/Aggregator.h>
+
+namespace DB
+{
+/** Aggregates the stream of blocks which is sorted (or at least grouped) by the key columns.
+  * The rows of a group are consecutive, so only the states of the current group are kept and the group
+  * is output as soon as the keys change, without any hash table. The result is always finalized and has
+  * the same header as AggregatingBlockInputStream with final = true.
+  * The keys are compared exactly, so the collators of the keys are not supported.
+  */
+class StreamingAggregatingBlockInputStream : public IProfilingBlockInputStream
+{
+    static constexpr auto NAME = "StreamingAggregating";
+
+public:
+    StreamingAggregatingBlockInputStream(
+        const BlockInputStreamPtr & input,
+        const Aggregator::Params & params_,
+        size_t max_block_size_,
+        const String & req_id);
+
+    ~StreamingAggregatingBlockInputStream() override;
+
+    String getName() const override { return NAME; }
+    Block getHeader() const override { return header; }
+
+protected:
+    Block readImpl() override;
+    void readSuffixImpl() override;
+    void appendInfo(FmtBuffer & buffer) const override;
+
+private:
+    /// Add the rows of `block` to the current group, and output the groups finished by the key changes.
+    void consume(const Block & block);
+    /// Start a new group with the keys of `row`.
+    void startGroup(const ColumnRawPtrs & key_columns, size_t row);
+    /// Append the keys and the results of the current group to the output columns and destroy its states.
+    void finishGroup();
+    void destroyStates() noexcept;
+
+    Block popResult();
+
+    Aggregator::Params params;
+    Block header;
+    size_t max_block_size;
+
+    std::vector<size_t> offsets_of_aggregate_states;
+    size_t total_size_of_aggregate_states = 0;
+    size_t align_aggregate_states = 1;
+
+    /// The states of the current group, allocated once and reused by every group.
+    Arena states_pool;
+    AggregateDataPtr place = nullptr;
+    /// For the data referenced by the states, replaced when it grows too large and no group is open.
+    ArenaPtr arena;
+
+    /// The keys of the current group, one row each.
+    MutableColumns group_keys;
+    bool has_group = false;
+
+    MutableColumns result_columns;
+    bool input_finished = false;
+
+    size_t input_rows = 0;
+    size_t output_groups = 0;
+
+    const LoggerPtr log;
+};
+
+} // namespace DB
@@ -160,6 +160,9 @@ class TiRemoteBlockInputStream : public IProfilingBlockInputStream
 
         ++connection_profile_infos[index].packets;
         connection_profile_infos[index].bytes += decode_detail.packet_bytes;
+        connection_profile_infos[index].uncompressed_bytes += decode_detail.uncompressed_bytes;
+        connection_profile_infos[index].compressed_bytes += decode_detail.compressed_bytes;
+        connection_profile_infos[index].compression_time_ns += decode_detail.decompression_time_ns;
 
         total_rows += decode_detail.rows;
         LOG_FMT_TRACE(
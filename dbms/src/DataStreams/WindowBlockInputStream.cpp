@@ -70,10 +70,35 @@ void WindowBlockInputStream::initialWorkspaces()
     {
         WindowFunctionWorkspace workspace;
         workspace.window_function = window_function_description.window_function;
+        if (const auto * aggregate = dynamic_cast<const WindowFunctionAggregate *>(workspace.window_function.get()))
+        {
+            // The rows only need to be kept for removing when the frame start can move.
+            bool removable = window_description.frame.begin_type != WindowFrame::BoundaryType::Unbounded;
+            workspace.aggregation = std::make_unique<SlidingWindowAggregation>(aggregate->getAggregateFunction(), removable);
+            for (const auto & argument_name : window_function_description.argument_names)
+                workspace.argument_column_indices.push_back(output_header.getPositionByName(argument_name));
+        }
         workspaces.push_back(std::move(workspace));
     }
     only_have_row_number = onlyHaveRowNumber();
     only_have_pure_window = onlyHaveRowNumberAndRank();
+
+    if (!only_have_pure_window)
+    {
+        for (const auto & ws : workspaces)
+        {
+            if (!ws.aggregation)
+                throw Exception(ErrorCodes::NOT_IMPLEMENTED,
+                                "window function '{}' can not be used with the aggregate functions in one window.",
+                                ws.window_function->getName());
+        }
+        const auto & frame = window_description.frame;
+        if (frame.type == WindowFrame::FrameType::Groups)
+            throw Exception(ErrorCodes::NOT_IMPLEMENTED, "window function only support frame type row and range.");
+        if (frame.type == WindowFrame::FrameType::Ranges
+            && (frame.begin_type == WindowFrame::BoundaryType::Offset || frame.end_type == WindowFrame::BoundaryType::Offset))
+            throw Exception(ErrorCodes::NOT_IMPLEMENTED, "The range frame with offset is not implemented");
+    }
 }
 
 Block WindowBlockInputStream::readImpl()
@@ -246,8 +271,65 @@ void WindowBlockInputStream::advanceFrameStart()
         return;
     }
 
-    throw Exception(ErrorCodes::NOT_IMPLEMENTED,
-                    "window function only support pure window function now.");
+    const auto & frame = window_description.frame;
+    switch (frame.begin_type)
+    {
+    case WindowFrame::BoundaryType::Unbounded:
+        frame_start = partition_start;
+        frame_start_row_number = 1;
+        frame_started = true;
+        break;
+    case WindowFrame::BoundaryType::Current:
+        if (frame.type == WindowFrame::FrameType::Rows)
+        {
+            advanceFrameStartRowsTo(current_row_number);
+        }
+        else
+        {
+            // The first peer of the current row, frame_start never passes the current row here.
+            while (frame_start < current_row && !arePeers(frame_start, current_row))
+            {
+                advanceRowNumber(frame_start);
+                ++frame_start_row_number;
+            }
+            frame_started = true;
+        }
+        break;
+    case WindowFrame::BoundaryType::Offset:
+    {
+        // Only the ROWS frame reaches here, see `initialWorkspaces`.
+        const auto offset = frame.begin_offset.safeGet<UInt64>();
+        if (frame.begin_preceding)
+            advanceFrameStartRowsTo(current_row_number > offset ? current_row_number - offset : 1);
+        else
+            advanceFrameStartRowsTo(current_row_number + offset);
+        break;
+    }
+    default:
+        throw Exception(ErrorCodes::NOT_IMPLEMENTED,
+                        "The frame begin type '{}' is not implemented",
+                        frame.begin_type);
+    }
+}
+
+void WindowBlockInputStream::advanceFrameStartRowsTo(UInt64 target_row_number)
+{
+    // The frame start only moves forward, and stops at the partition end.
+    while (frame_start_row_number < target_row_number)
+    {
+        if (frame_start == partition_end)
+        {
+            if (!partition_ended)
+            {
+                // Wait for more input data.
+                return;
+            }
+            break;
+        }
+        advanceRowNumber(frame_start);
+        ++frame_start_row_number;
+    }
+    frame_started = true;
 }
 
 bool WindowBlockInputStream::arePeers(const RowNumber & x, const RowNumber & y) const
@@ -303,9 +385,6 @@ bool WindowBlockInputStream::arePeers(const RowNumber & x, const RowNumber & y)
 
 void WindowBlockInputStream::advanceFrameEndCurrentRow()
 {
-    assert(frame_end.block == partition_end.block
-           || frame_end.block + 1 == partition_end.block);
-
     // If window only have row_number or rank/dense_rank functions, set frame_end to the next row of current_row and frame_ended to true
     if (only_have_pure_window)
     {
@@ -315,8 +394,43 @@ void WindowBlockInputStream::advanceFrameEndCurrentRow()
         return;
     }
 
-    throw Exception(ErrorCodes::NOT_IMPLEMENTED,
-                    "window function only support pure window function now.");
+    if (window_description.frame.type == WindowFrame::FrameType::Rows)
+    {
+        advanceFrameEndRowsTo(current_row_number + 1);
+        return;
+    }
+
+    // For the RANGE frame, the frame ends after the last peer of the current row.
+    while (frame_end < partition_end && arePeers(current_row, frame_end))
+    {
+        advanceRowNumber(frame_end);
+        ++frame_end_row_number;
+    }
+    if (frame_end == partition_end && !partition_ended)
+    {
+        // The next block may have more peers.
+        return;
+    }
+    frame_ended = true;
+}
+
+void WindowBlockInputStream::advanceFrameEndRowsTo(UInt64 target_row_number)
+{
+    while (frame_end_row_number < target_row_number)
+    {
+        if (frame_end == partition_end)
+        {
+            if (!partition_ended)
+            {
+                // Wait for more input data.
+                return;
+            }
+            break;
+        }
+        advanceRowNumber(frame_end);
+        ++frame_end_row_number;
+    }
+    frame_ended = true;
 }
 
 void WindowBlockInputStream::advanceFrameEnd()
@@ -327,6 +441,7 @@ void WindowBlockInputStream::advanceFrameEnd()
     if (frame_end < frame_start)
     {
         frame_end = frame_start;
+        frame_end_row_number = frame_start_row_number;
     }
 
     // No reason for this function to be called again after it succeeded.
@@ -339,7 +454,23 @@ void WindowBlockInputStream::advanceFrameEnd()
         advanceFrameEndCurrentRow();
         break;
     case WindowFrame::BoundaryType::Unbounded:
+        // UNBOUNDED FOLLOWING, wait for the end of the partition.
+        if (partition_ended)
+        {
+            frame_end = partition_end;
+            frame_ended = true;
+        }
+        break;
     case WindowFrame::BoundaryType::Offset:
+    {
+        // Only the ROWS frame reaches here, see `initialWorkspaces`.
+        const auto offset = window_description.frame.end_offset.safeGet<UInt64>();
+        if (window_description.frame.end_preceding)
+            advanceFrameEndRowsTo(current_row_number + 1 > offset ? current_row_number + 1 - offset : 1);
+        else
+            advanceFrameEndRowsTo(current_row_number + 1 + offset);
+        break;
+    }
     default:
         throw Exception(ErrorCodes::NOT_IMPLEMENTED,
                         "The frame end type '{}' is not implemented",
@@ -347,6 +478,42 @@ void WindowBlockInputStream::advanceFrameEnd()
     }
 }
 
+void WindowBlockInputStream::updateAggregationStates()
+{
+    // Both the frame start and the frame end only move forward in a partition, so the rows
+    // before the new frame start are removed, and the rows after the previous frame end are added.
+    if (prev_frame_end <= frame_start)
+    {
+        resetAggregationStates();
+        prev_frame_end = frame_start;
+    }
+    else
+    {
+        for (auto row = prev_frame_start; row < frame_start; advanceRowNumber(row))
+        {
+            for (auto & ws : workspaces)
+                ws.aggregation->remove();
+        }
+    }
+
+    for (auto row = prev_frame_end; row < frame_end; advanceRowNumber(row))
+    {
+        auto & block = blockAt(row);
+        for (size_t wi = 0; wi < workspaces.size(); ++wi)
+            workspaces[wi].aggregation->add(block.argument_columns[wi].data(), row.row);
+    }
+    prev_frame_end = frame_end;
+}
+
+void WindowBlockInputStream::resetAggregationStates()
+{
+    for (auto & ws : workspaces)
+    {
+        if (ws.aggregation)
+            ws.aggregation->reset();
+    }
+}
+
 void WindowBlockInputStream::writeOutCurrentRow()
 {
     assert(current_row < partition_end);
@@ -465,6 +632,16 @@ void WindowBlockInputStream::appendBlock(Block & current_block)
     }
 
     window_block.input_columns = current_block.getColumns();
+
+    if (!only_have_pure_window)
+    {
+        window_block.argument_columns.resize(workspaces.size());
+        for (size_t wi = 0; wi < workspaces.size(); ++wi)
+        {
+            for (auto index : workspaces[wi].argument_column_indices)
+                window_block.argument_columns[wi].push_back(window_block.input_columns[index].get());
+        }
+    }
 }
 
 void WindowBlockInputStream::tryCalculate()
@@ -526,6 +703,9 @@ void WindowBlockInputStream::tryCalculate()
             assert(frame_ended);
             assert(frame_start <= frame_end);
 
+            if (!only_have_pure_window)
+                updateAggregationStates();
+
             // Write out the results.
             writeOutCurrentRow();
 
@@ -568,6 +748,10 @@ void WindowBlockInputStream::tryCalculate()
         frame_start = partition_start;
         frame_end = partition_start;
         prev_frame_start = partition_start;
+        prev_frame_end = partition_start;
+        frame_start_row_number = 1;
+        frame_end_row_number = 1;
+        resetAggregationStates();
         assert(current_row == partition_start);
         current_row_number = 1;
         peer_group_last = partition_start;
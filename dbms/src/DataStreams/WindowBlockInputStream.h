@@ -15,9 +15,11 @@
 #pragma once
 
 #include <Common/FmtUtils.h>
+#include <Core/ColumnNumbers.h>
 #include <DataStreams/IProfilingBlockInputStream.h>
 #include <Interpreters/AggregateDescription.h>
 #include <Interpreters/WindowDescription.h>
+#include <WindowFunctions/WindowFunctionAggregate.h>
 
 #include <deque>
 #include <memory>
@@ -27,14 +29,19 @@ namespace DB
 // Runtime data for computing one window function.
 struct WindowFunctionWorkspace
 {
-    // TODO add aggregation function
     WindowFunctionPtr window_function = nullptr;
+
+    // For the aggregate functions, the state of the current frame and the argument positions in block.
+    std::unique_ptr<SlidingWindowAggregation> aggregation;
+    ColumnNumbers argument_column_indices;
 };
 
 struct WindowBlock
 {
     Columns input_columns;
     MutableColumns output_columns;
+    // The argument columns of the aggregate functions, indexed by workspace.
+    std::vector<std::vector<const IColumn *>> argument_columns;
 
     size_t rows = 0;
 };
@@ -80,9 +87,15 @@ public:
     bool arePeers(const RowNumber & x, const RowNumber & y) const;
 
     void advanceFrameStart();
+    void advanceFrameStartRowsTo(UInt64 target_row_number);
     void advanceFrameEndCurrentRow();
+    void advanceFrameEndRowsTo(UInt64 target_row_number);
     void advanceFrameEnd();
 
+    // Move the aggregation states from [prev_frame_start, prev_frame_end) to [frame_start, frame_end).
+    void updateAggregationStates();
+    void resetAggregationStates();
+
     void writeOutCurrentRow();
 
     Block tryGetOutputBlock();
@@ -244,6 +257,12 @@ public:
     // aggregate function. We use them to determine how to update the aggregation
     // state after we find the new frame.
     RowNumber prev_frame_start;
+    RowNumber prev_frame_end;
+
+    // The numbers in partition of the rows at frame_start and frame_end, counted as current_row_number,
+    // for the ROWS frame with offsets.
+    UInt64 frame_start_row_number = 1;
+    UInt64 frame_end_row_number = 1;
 
     //TODO: used as template parameters
     bool only_have_row_number = false;
@@ -0,0 +1,153 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <AggregateFunctions/AggregateFunctionFactory.h>
+#include <AggregateFunctions/registerAggregateFunctions.h>
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <DataStreams/AdaptiveAggregatingBlockInputStream.h>
+#include <DataStreams/BlocksListBlockInputStream.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <map>
+
+namespace DB
+{
+namespace tests
+{
+class AdaptiveAggregatingTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase()
+    {
+        try
+        {
+            registerAggregateFunctions();
+        }
+        catch (DB::Exception &)
+        {
+            // Maybe another test has already registered, ignore exception here.
+        }
+    }
+
+    struct Result
+    {
+        /// a -> (sum(b), count(b)), the partial results of a key are added up as the final aggregation does.
+        std::map<Int64, std::pair<Int64, UInt64>> groups;
+        size_t output_rows = 0;
+        bool pass_through = false;
+        size_t pass_through_rows = 0;
+    };
+
+    /// select a, sum(b), count(b) from blocks group by a
+    static Result aggregate(const BlocksList & blocks, size_t sample_rows)
+    {
+        const Block & header = blocks.front();
+        auto b_type = header.getByName("b").type;
+        AggregateDescriptions aggregates(2);
+        aggregates[0].function = AggregateFunctionFactory::instance().get("sum", {b_type});
+        aggregates[0].arguments = {1};
+        aggregates[0].column_name = "sum(b)";
+        aggregates[1].function = AggregateFunctionFactory::instance().get("count", {b_type});
+        aggregates[1].arguments = {1};
+        aggregates[1].column_name = "count(b)";
+        Aggregator::Params params(header.cloneEmpty(), {0}, aggregates, false, 0, OverflowMode::THROW, 0, 0, 0, false, "");
+
+        auto input = std::make_shared<BlocksListBlockInputStream>(BlocksList(blocks));
+        AdaptiveAggregatingBlockInputStream stream(input, params, nullptr, sample_rows, 0.9, "test");
+        Result res;
+        stream.readPrefix();
+        while (Block block = stream.read())
+        {
+            const auto & a = typeid_cast<const ColumnVector<Int64> &>(*block.getByName("a").column).getData();
+            const auto & sum = typeid_cast<const ColumnVector<Int64> &>(*block.getByName("sum(b)").column).getData();
+            const auto & count = typeid_cast<const ColumnVector<UInt64> &>(*block.getByName("count(b)").column).getData();
+            for (size_t i = 0; i < block.rows(); ++i)
+            {
+                auto & group = res.groups[a[i]];
+                group.first += sum[i];
+                group.second += count[i];
+            }
+            res.output_rows += block.rows();
+        }
+        stream.readSuffix();
+        res.pass_through = stream.isPassThrough();
+        res.pass_through_rows = stream.getPassThroughRows();
+        return res;
+    }
+
+    static std::map<Int64, std::pair<Int64, UInt64>> expectGroups(const BlocksList & blocks)
+    {
+        std::map<Int64, std::pair<Int64, UInt64>> res;
+        for (const auto & block : blocks)
+        {
+            const auto & a = typeid_cast<const ColumnVector<Int64> &>(*block.getByName("a").column).getData();
+            const auto & b = typeid_cast<const ColumnVector<Int64> &>(*block.getByName("b").column).getData();
+            for (size_t i = 0; i < block.rows(); ++i)
+            {
+                auto & group = res[a[i]];
+                group.first += b[i];
+                group.second += 1;
+            }
+        }
+        return res;
+    }
+};
+
+TEST_F(AdaptiveAggregatingTest, PassThroughUniqueKeys)
+{
+    BlocksList blocks;
+    blocks.push_back(Block{createColumn<Int64>({1, 2, 3, 4}, "a"), createColumn<Int64>({1, 2, 3, 4}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({5, 6, 6}, "a"), createColumn<Int64>({5, 6, 7}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({1, 7, 8}, "a"), createColumn<Int64>({8, 9, 10}, "b")});
+
+    auto res = aggregate(blocks, 4);
+    ASSERT_TRUE(res.pass_through);
+    ASSERT_EQ(res.pass_through_rows, 10);
+    ASSERT_EQ(res.groups, expectGroups(blocks));
+    /// Only the duplicated keys in the same block are aggregated.
+    ASSERT_EQ(res.output_rows, 9);
+}
+
+TEST_F(AdaptiveAggregatingTest, AggregateDuplicatedKeys)
+{
+    BlocksList blocks;
+    blocks.push_back(Block{createColumn<Int64>({1, 1, 2, 2}, "a"), createColumn<Int64>({1, 2, 3, 4}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({3, 4, 5}, "a"), createColumn<Int64>({5, 6, 7}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({1, 3, 5}, "a"), createColumn<Int64>({8, 9, 10}, "b")});
+
+    auto res = aggregate(blocks, 4);
+    ASSERT_FALSE(res.pass_through);
+    ASSERT_EQ(res.pass_through_rows, 0);
+    ASSERT_EQ(res.groups, expectGroups(blocks));
+    ASSERT_EQ(res.output_rows, 5);
+}
+
+TEST_F(AdaptiveAggregatingTest, SampleWholeInput)
+{
+    BlocksList blocks;
+    blocks.push_back(Block{createColumn<Int64>({1, 2, 3}, "a"), createColumn<Int64>({1, 2, 3}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({1, 4}, "a"), createColumn<Int64>({4, 5}, "b")});
+
+    /// The groups of the whole input are output directly, though the keys are nearly unique.
+    auto res = aggregate(blocks, 100);
+    ASSERT_FALSE(res.pass_through);
+    ASSERT_EQ(res.groups, expectGroups(blocks));
+    ASSERT_EQ(res.output_rows, 4);
+}
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,99 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <DataStreams/BlocksListBlockInputStream.h>
+#include <DataStreams/FilterBlockInputStream.h>
+#include <Interpreters/Context.h>
+#include <Interpreters/ExpressionActions.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+class FilterBlockInputStreamTest : public ::testing::Test
+{
+protected:
+    static Block createBlock()
+    {
+        return Block{
+            createColumn<Int64>({1, 2, 3, 4, 5}, "a"),
+            createColumn<Int64>({10, 20, 30, 40, 50}, "b"),
+            createColumn<UInt8>({1, 0, 1, 0, 1}, "f")};
+    }
+
+    static Blocks filter(const Names & output_columns, Block & header)
+    {
+        Block block = createBlock();
+        auto actions = std::make_shared<ExpressionActions>(block.getNamesAndTypesList(), TiFlashTestEnv::getContext().getSettingsRef());
+        auto input = std::make_shared<BlocksListBlockInputStream>(BlocksList{block});
+        FilterBlockInputStream stream(input, actions, "f", "test", output_columns);
+        header = stream.getHeader();
+        Blocks res;
+        stream.readPrefix();
+        while (Block res_block = stream.read())
+            res.push_back(std::move(res_block));
+        stream.readSuffix();
+        return res;
+    }
+
+    static std::vector<Int64> values(const Block & block, const String & name)
+    {
+        const auto & data = typeid_cast<const ColumnInt64 &>(*block.getByName(name).column).getData();
+        return std::vector<Int64>(data.begin(), data.end());
+    }
+};
+
+TEST_F(FilterBlockInputStreamTest, AllColumns)
+try
+{
+    Block header;
+    auto res = filter({}, header);
+    ASSERT_EQ(header.columns(), 3);
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(res[0].columns(), 3);
+    ASSERT_EQ(values(res[0], "a"), (std::vector<Int64>{1, 3, 5}));
+    ASSERT_EQ(values(res[0], "b"), (std::vector<Int64>{10, 30, 50}));
+    ASSERT_TRUE(res[0].getByName("f").column->isColumnConst());
+}
+CATCH
+
+TEST_F(FilterBlockInputStreamTest, OutputColumns)
+try
+{
+    Block header;
+    auto res = filter({"b"}, header);
+    ASSERT_EQ(header.columns(), 1);
+    ASSERT_TRUE(header.has("b"));
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(res[0].columns(), 1);
+    ASSERT_EQ(values(res[0], "b"), (std::vector<Int64>{10, 30, 50}));
+
+    // The filter column is replaced by a constant when it is output.
+    res = filter({"f", "a"}, header);
+    ASSERT_EQ(header.columns(), 2);
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(res[0].columns(), 2);
+    ASSERT_EQ(res[0].getByPosition(1).name, "a");
+    ASSERT_EQ(values(res[0], "a"), (std::vector<Int64>{1, 3, 5}));
+    ASSERT_TRUE(res[0].getByName("f").column->isColumnConst());
+    ASSERT_EQ(res[0].rows(), 3);
+}
+CATCH
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,108 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <AggregateFunctions/AggregateFunctionFactory.h>
+#include <AggregateFunctions/registerAggregateFunctions.h>
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <DataStreams/BlocksListBlockInputStream.h>
+#include <DataStreams/StreamingAggregatingBlockInputStream.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+class StreamingAggregatingTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase()
+    {
+        try
+        {
+            registerAggregateFunctions();
+        }
+        catch (DB::Exception &)
+        {
+            // Maybe another test has already registered, ignore exception here.
+        }
+    }
+
+    /// select a, sum(b), count(b) from blocks group by a
+    static std::vector<Block> aggregate(const BlocksList & blocks, size_t max_block_size)
+    {
+        const Block & header = blocks.front();
+        auto b_type = header.getByName("b").type;
+        AggregateDescriptions aggregates(2);
+        aggregates[0].function = AggregateFunctionFactory::instance().get("sum", {b_type});
+        aggregates[0].arguments = {1};
+        aggregates[0].column_name = "sum(b)";
+        aggregates[1].function = AggregateFunctionFactory::instance().get("count", {b_type});
+        aggregates[1].arguments = {1};
+        aggregates[1].column_name = "count(b)";
+        Aggregator::Params params(header.cloneEmpty(), {0}, aggregates, false, 0, OverflowMode::THROW, 0, 0, 0, false, "");
+
+        auto input = std::make_shared<BlocksListBlockInputStream>(BlocksList(blocks));
+        StreamingAggregatingBlockInputStream stream(input, params, max_block_size, "test");
+        std::vector<Block> res;
+        stream.readPrefix();
+        while (Block block = stream.read())
+            res.push_back(std::move(block));
+        stream.readSuffix();
+        return res;
+    }
+
+    template <typename T>
+    static std::vector<T> values(const std::vector<Block> & blocks, const String & name)
+    {
+        std::vector<T> res;
+        for (const auto & block : blocks)
+        {
+            const auto & data = typeid_cast<const ColumnVector<T> &>(*block.getByName(name).column).getData();
+            res.insert(res.end(), data.begin(), data.end());
+        }
+        return res;
+    }
+};
+
+TEST_F(StreamingAggregatingTest, GroupsAcrossBlocks)
+{
+    BlocksList blocks;
+    blocks.push_back(Block{createColumn<Int64>({1, 1, 2}, "a"), createColumn<Int64>({1, 2, 3}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({2, 2}, "a"), createColumn<Int64>({4, 5}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({3, 4, 4}, "a"), createColumn<Int64>({6, 7, 8}, "b")});
+
+    auto res = aggregate(blocks, 65536);
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(values<Int64>(res, "a"), (std::vector<Int64>{1, 2, 3, 4}));
+    ASSERT_EQ(values<Int64>(res, "sum(b)"), (std::vector<Int64>{3, 12, 6, 15}));
+    ASSERT_EQ(values<UInt64>(res, "count(b)"), (std::vector<UInt64>{2, 3, 1, 2}));
+}
+
+TEST_F(StreamingAggregatingTest, OutputByMaxBlockSize)
+{
+    BlocksList blocks;
+    blocks.push_back(Block{createColumn<Int64>({1, 2, 3, 4, 5}, "a"), createColumn<Int64>({1, 1, 1, 1, 1}, "b")});
+    blocks.push_back(Block{createColumn<Int64>({5, 6, 7}, "a"), createColumn<Int64>({1, 1, 1}, "b")});
+
+    auto res = aggregate(blocks, 2);
+    ASSERT_EQ(res.size(), 3);
+    ASSERT_EQ(values<Int64>(res, "a"), (std::vector<Int64>{1, 2, 3, 4, 5, 6, 7}));
+    ASSERT_EQ(values<UInt64>(res, "count(b)"), (std::vector<UInt64>{1, 1, 1, 1, 2, 1, 1}));
+}
+
+} // namespace tests
+} // namespace DB
@@ -134,6 +134,8 @@ std::unordered_map<String, tipb::ScalarFuncSig> func_name_to_sig({
     {"in", tipb::ScalarFuncSig::InInt},
     {"notin", tipb::ScalarFuncSig::InInt},
     {"date_format", tipb::ScalarFuncSig::DateFormatSig},
+    {"date", tipb::ScalarFuncSig::Date},
+    {"year", tipb::ScalarFuncSig::Year},
     {"if", tipb::ScalarFuncSig::IfInt},
     {"from_unixtime", tipb::ScalarFuncSig::FromUnixTime2Arg},
     /// bit_and/bit_or/bit_xor is aggregated function in clickhouse/mysql
@@ -195,6 +197,11 @@ std::unordered_map<String, tipb::ExprType> window_func_name_to_sig({
     {"RowNumber", tipb::ExprType::RowNumber},
     {"Rank", tipb::ExprType::Rank},
     {"DenseRank", tipb::ExprType::DenseRank},
+    {"count", tipb::ExprType::Count},
+    {"sum", tipb::ExprType::Sum},
+    {"min", tipb::ExprType::Min},
+    {"max", tipb::ExprType::Max},
+    {"avg", tipb::ExprType::Avg},
 });
 
 DAGColumnInfo toNullableDAGColumnInfo(const DAGColumnInfo & input)
@@ -1384,12 +1391,23 @@ bool Window::toTiPBExecutor(tipb::Executor * tipb_executor, int32_t collator_id,
         auto window_sig = window_sig_it->second;
         window_expr->set_tp(window_sig);
         auto * ft = window_expr->mutable_field_type();
-        // TODO: Maybe more window functions with different field type.
-        ft->set_tp(TiDB::TypeLongLong);
-        ft->set_flag(TiDB::ColumnFlagBinary);
-        ft->set_collate(collator_id);
-        ft->set_flen(21);
-        ft->set_decimal(-1);
+        if (window_sig == tipb::ExprType::Min || window_sig == tipb::ExprType::Max)
+        {
+            // The result is NULL for the empty frames.
+            ft->set_tp(window_expr->children(0).field_type().tp());
+            ft->set_decimal(window_expr->children(0).field_type().decimal());
+            ft->set_flag(window_expr->children(0).field_type().flag() & (~TiDB::ColumnFlagNotNull));
+            ft->set_collate(collator_id);
+        }
+        else
+        {
+            // TODO: Maybe more window functions with different field type.
+            ft->set_tp(window_sig == tipb::ExprType::Avg ? TiDB::TypeDouble : TiDB::TypeLongLong);
+            ft->set_flag(TiDB::ColumnFlagBinary);
+            ft->set_collate(collator_id);
+            ft->set_flen(21);
+            ft->set_decimal(-1);
+        }
     }
 
     for (const auto & child : order_by_exprs)
@@ -1735,11 +1753,26 @@ ExecutorPtr compileWindow(ExecutorPtr input, size_t & executor_index, ASTPtr fun
             case tipb::ExprType::RowNumber:
             case tipb::ExprType::Rank:
             case tipb::ExprType::DenseRank:
+            case tipb::ExprType::Count:
+            case tipb::ExprType::Sum:
             {
                 ci.tp = TiDB::TypeLongLong;
                 ci.flag = TiDB::ColumnFlagBinary;
                 break;
             }
+            case tipb::ExprType::Avg:
+            {
+                ci.tp = TiDB::TypeDouble;
+                ci.flag = TiDB::ColumnFlagBinary;
+                break;
+            }
+            case tipb::ExprType::Min:
+            case tipb::ExprType::Max:
+            {
+                ci = children_ci.at(0);
+                ci.clearNotNullFlag();
+                break;
+            }
             default:
                 throw Exception(fmt::format("Unsupported window function {}", func->name), ErrorCodes::LOGICAL_ERROR);
             }
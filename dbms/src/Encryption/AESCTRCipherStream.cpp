@@ -17,8 +17,9 @@
 #include <Encryption/AESCTRCipherStream.h>
 #include <Encryption/KeyManager.h>
 #include <Storages/Transaction/FileEncryption.h>
+#include <ext/scope_guard.h>
 
-#include <cassert>
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 
@@ -44,6 +45,39 @@ size_t KeySize(EncryptionMethod method)
     }
 }
 
+namespace
+{
+#if OPENSSL_VERSION_NUMBER >= 0x01010000f
+// Creating and freeing an `EVP_CIPHER_CTX` for every read buffer is a visible cost
+// when scanning encrypted data. Keep one context per thread and reset it on reuse.
+struct ThreadLocalCipherContext
+{
+    EVP_CIPHER_CTX * ctx = nullptr;
+
+    ~ThreadLocalCipherContext()
+    {
+        if (ctx != nullptr)
+            EVP_CIPHER_CTX_free(ctx);
+    }
+
+    EVP_CIPHER_CTX * get()
+    {
+        if (ctx == nullptr)
+            ctx = EVP_CIPHER_CTX_new();
+        else if (EVP_CIPHER_CTX_reset(ctx) != 1)
+            return nullptr;
+        return ctx;
+    }
+};
+
+thread_local ThreadLocalCipherContext thread_cipher_context;
+#endif
+
+// EVP_CipherUpdate takes an `int` length, split larger ranges into chunks of
+// whole blocks so that the counter keeps advancing continuously.
+constexpr size_t MAX_CIPHER_CHUNK_SIZE = (static_cast<size_t>(std::numeric_limits<int>::max()) / AES_BLOCK_SIZE) * AES_BLOCK_SIZE;
+} // namespace
+
 void AESCTRCipherStream::cipher(uint64_t file_offset, char * data, size_t data_size, bool is_encrypt)
 {
 #if OPENSSL_VERSION_NUMBER < 0x01000200f
@@ -55,11 +89,23 @@ void AESCTRCipherStream::cipher(uint64_t file_offset, char * data, size_t data_s
 #else
     int ret = 1;
     EVP_CIPHER_CTX * ctx = nullptr;
+#if OPENSSL_VERSION_NUMBER < 0x01010000f
     InitCipherContext(ctx);
+#else
+    ctx = thread_cipher_context.get();
+#endif
     if (ctx == nullptr)
     {
         throw DB::TiFlashException("Failed to create cipher context.", Errors::Encryption::Internal);
     }
+    // The context owns the expanded key, clean it up no matter how we leave.
+    SCOPE_EXIT({
+#if OPENSSL_VERSION_NUMBER < 0x01010000f
+        EVP_CIPHER_CTX_cleanup(ctx);
+#else
+        EVP_CIPHER_CTX_reset(ctx);
+#endif
+    });
 
     uint64_t block_index = file_offset / AES_BLOCK_SIZE;
     uint64_t block_offset = file_offset % AES_BLOCK_SIZE;
@@ -78,96 +124,62 @@ void AESCTRCipherStream::cipher(uint64_t file_offset, char * data, size_t data_s
     memcpy(iv, &iv_high, sizeof(uint64_t));
     memcpy(iv + sizeof(uint64_t), &iv_low, sizeof(uint64_t));
 
-    ret = EVP_CipherInit(ctx, cipher_, reinterpret_cast<const unsigned char *>(key_.data()), iv, (is_encrypt ? 1 : 0));
+    ret = EVP_CipherInit_ex(ctx, cipher_, nullptr, reinterpret_cast<const unsigned char *>(key_.data()), iv, (is_encrypt ? 1 : 0));
     if (ret != 1)
     {
         throw DB::TiFlashException("Failed to create cipher context.", Errors::Encryption::Internal);
     }
 
-    // Disable padding. After disabling padding, data size should always be
-    // multiply of block size.
+    // Disable padding. CTR is a stream mode so the output size always equals
+    // the input size.
     ret = EVP_CIPHER_CTX_set_padding(ctx, 0);
     if (ret != 1)
     {
         throw DB::TiFlashException("Failed to disable padding for cipher context.", Errors::Encryption::Internal);
     }
 
-    uint64_t data_offset = 0;
-    size_t remaining_data_size = data_size;
     int output_size = 0;
-    unsigned char partial_block[AES_BLOCK_SIZE];
 
-    // In the following we assume EVP_CipherUpdate allow in and out buffer are
-    // the same, to save one memcpy. This is not specified in official man page.
-
-    // Handle partial block at the beginning. The partial block is copied to
-    // buffer to fake a full block.
+    // Skip the key stream of the leading bytes in the first block, so that the
+    // whole range can be handled by a single pass in place instead of faking
+    // partial blocks with extra copies. OpenSSL keeps the position inside the
+    // current block across updates in CTR mode.
     if (block_offset > 0)
     {
-        size_t partial_block_size = std::min<size_t>(AES_BLOCK_SIZE - block_offset, remaining_data_size);
-        memcpy(partial_block + block_offset, data, partial_block_size);
-        ret = EVP_CipherUpdate(ctx, partial_block, &output_size, partial_block, AES_BLOCK_SIZE);
-        if (ret != 1)
+        unsigned char skip_block[AES_BLOCK_SIZE] = {};
+        ret = EVP_CipherUpdate(ctx, skip_block, &output_size, skip_block, static_cast<int>(block_offset));
+        if (ret != 1 || output_size != static_cast<int>(block_offset))
         {
             throw DB::TiFlashException(
                 "Crypter failed for first block, offset " + std::to_string(file_offset),
                 Errors::Encryption::Internal);
         }
-        if (output_size != AES_BLOCK_SIZE)
-        {
-            throw DB::TiFlashException("Unexpected crypter output size for first block, expected " + std::to_string(AES_BLOCK_SIZE)
-                                           + " vs actual " + std::to_string(output_size),
-                                       Errors::Encryption::Internal);
-        }
-        memcpy(data, partial_block + block_offset, partial_block_size);
-        data_offset += partial_block_size;
-        remaining_data_size -= partial_block_size;
     }
 
-    // Handle full blocks in the middle.
-    if (remaining_data_size >= AES_BLOCK_SIZE)
+    // In the following we assume EVP_CipherUpdate allow in and out buffer are
+    // the same. This is the case for the CTR implementations (including the
+    // AES-NI ones, which pipeline multiple blocks per call), but is not
+    // specified in official man page.
+    uint64_t data_offset = 0;
+    while (data_offset < data_size)
     {
-        size_t actual_data_size = remaining_data_size - remaining_data_size % AES_BLOCK_SIZE;
-        unsigned char * full_blocks = reinterpret_cast<unsigned char *>(data) + data_offset;
-        ret = EVP_CipherUpdate(ctx, full_blocks, &output_size, full_blocks, static_cast<int>(actual_data_size));
+        size_t chunk_size = std::min(data_size - data_offset, MAX_CIPHER_CHUNK_SIZE);
+        auto * chunk = reinterpret_cast<unsigned char *>(data) + data_offset;
+        ret = EVP_CipherUpdate(ctx, chunk, &output_size, chunk, static_cast<int>(chunk_size));
         if (ret != 1)
         {
             throw DB::TiFlashException(
                 "Crypter failed at offset " + std::to_string(file_offset + data_offset),
                 Errors::Encryption::Internal);
         }
-        if (output_size != static_cast<int>(actual_data_size))
+        if (output_size != static_cast<int>(chunk_size))
         {
-            throw DB::TiFlashException("Unexpected crypter output size, expected " + std::to_string(actual_data_size) + " vs actual "
+            throw DB::TiFlashException("Unexpected crypter output size, expected " + std::to_string(chunk_size) + " vs actual "
                                            + std::to_string(output_size),
                                        Errors::Encryption::Internal);
         }
-        data_offset += actual_data_size;
-        remaining_data_size -= actual_data_size;
-    }
-
-    // Handle partial block at the end. The partial block is copied to buffer to
-    // fake a full block.
-    if (remaining_data_size > 0)
-    {
-        assert(remaining_data_size < AES_BLOCK_SIZE);
-        memcpy(partial_block, data + data_offset, remaining_data_size);
-        ret = EVP_CipherUpdate(ctx, partial_block, &output_size, partial_block, AES_BLOCK_SIZE);
-        if (ret != 1)
-        {
-            throw DB::TiFlashException(
-                "Crypter failed for last block, offset " + std::to_string(file_offset + data_offset),
-                Errors::Encryption::Internal);
-        }
-        if (output_size != AES_BLOCK_SIZE)
-        {
-            throw DB::TiFlashException("Unexpected crypter output size for last block, expected " + std::to_string(AES_BLOCK_SIZE)
-                                           + " vs actual " + std::to_string(output_size),
-                                       Errors::Encryption::Internal);
-        }
-        memcpy(data + data_offset, partial_block, remaining_data_size);
+        data_offset += chunk_size;
     }
-    FreeCipherContext(ctx);
 #endif
 }
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Encryption/CompressedReadBufferFromFileProvider.h>
+#include <Encryption/ReadBufferFromFileProvider.h>
 #include <Encryption/createReadBufferFromFileBaseByFileProvider.h>
 #include <IO/WriteHelpers.h>
 
@@ -27,6 +28,9 @@ extern const int SEEK_POSITION_OUT_OF_BOUND;
 template <bool has_checksum>
 bool CompressedReadBufferFromFileProvider<has_checksum>::nextImpl()
 {
+    if (block_cache)
+        return nextImplWithCache();
+
     size_t size_decompressed;
     size_t size_compressed_without_checksum;
     size_compressed = this->readCompressedData(size_decompressed, size_compressed_without_checksum);
@@ -41,6 +45,54 @@ bool CompressedReadBufferFromFileProvider<has_checksum>::nextImpl()
     return true;
 }
 
+template <bool has_checksum>
+bool CompressedReadBufferFromFileProvider<has_checksum>::nextImplWithCache()
+{
+    UInt128 key = DecompressedBlockCache::hash(block_cache_path, block_cache_file_pos);
+    owned_cell = block_cache->get(key);
+
+    if (!owned_cell)
+    {
+        if (file_in.getPositionInFile() != static_cast<off_t>(block_cache_file_pos))
+            file_in.seek(block_cache_file_pos);
+
+        auto cell = std::make_shared<UncompressedCacheCell>();
+        size_t size_decompressed;
+        size_t size_compressed_without_checksum;
+        cell->compressed_size = this->readCompressedData(size_decompressed, size_compressed_without_checksum);
+        if (!cell->compressed_size)
+        {
+            size_compressed = 0;
+            return false;
+        }
+
+        cell->data.resize(size_decompressed);
+        this->decompress(cell->data.m_data, size_decompressed, size_compressed_without_checksum);
+        block_cache->set(key, cell);
+        owned_cell = std::move(cell);
+    }
+
+    if (owned_cell->data.m_size == 0)
+    {
+        owned_cell = nullptr;
+        size_compressed = 0;
+        return false;
+    }
+
+    size_compressed = owned_cell->compressed_size;
+    working_buffer = Buffer(owned_cell->data.m_data, owned_cell->data.m_data + owned_cell->data.m_size);
+    block_cache_file_pos += size_compressed;
+    return true;
+}
+
+template <bool has_checksum>
+void CompressedReadBufferFromFileProvider<has_checksum>::setDecompressedBlockCache(DecompressedBlockCache * cache, const String & cache_path)
+{
+    block_cache = cache;
+    block_cache_path = cache_path;
+    block_cache_file_pos = file_in.getPositionInFile();
+}
+
 template <bool has_checksum>
 CompressedReadBufferFromFileProvider<has_checksum>::CompressedReadBufferFromFileProvider(
     FileProviderPtr & file_provider,
@@ -49,7 +101,8 @@ CompressedReadBufferFromFileProvider<has_checksum>::CompressedReadBufferFromFile
     size_t estimated_size,
     size_t aio_threshold,
     const ReadLimiterPtr & read_limiter_,
-    size_t buf_size)
+    size_t buf_size,
+    bool use_io_uring)
     : CompressedSeekableReaderBuffer()
     , p_file_in(createReadBufferFromFileBaseByFileProvider(
           file_provider,
@@ -58,7 +111,11 @@ CompressedReadBufferFromFileProvider<has_checksum>::CompressedReadBufferFromFile
           estimated_size,
           aio_threshold,
           read_limiter_,
-          buf_size))
+          buf_size,
+          /*flags_*/ -1,
+          /*existing_memory_*/ nullptr,
+          /*alignment*/ 0,
+          use_io_uring))
     , file_in(*p_file_in)
 {
     this->compressed_in = &file_in;
@@ -72,10 +129,30 @@ CompressedReadBufferFromFileProvider<has_checksum>::CompressedReadBufferFromFile
     size_t estimated_size,
     const ReadLimiterPtr & read_limiter_,
     ChecksumAlgo checksum_algorithm,
-    size_t checksum_frame_size)
+    size_t checksum_frame_size,
+    bool use_io_uring,
+    bool use_direct_io)
+    : CompressedSeekableReaderBuffer()
+    , p_file_in(createReadBufferFromFileBaseByFileProvider(
+          file_provider,
+          path,
+          encryption_path,
+          estimated_size,
+          read_limiter_,
+          checksum_algorithm,
+          checksum_frame_size,
+          /*flags_*/ -1,
+          use_io_uring,
+          use_direct_io))
+    , file_in(*p_file_in)
+{
+    this->compressed_in = &file_in;
+}
+
+template <bool has_checksum>
+CompressedReadBufferFromFileProvider<has_checksum>::CompressedReadBufferFromFileProvider(const RandomAccessFilePtr & file, size_t buf_size)
     : CompressedSeekableReaderBuffer()
-    , p_file_in(
-          createReadBufferFromFileBaseByFileProvider(file_provider, path, encryption_path, estimated_size, read_limiter_, checksum_algorithm, checksum_frame_size))
+    , p_file_in(std::make_unique<ReadBufferFromFileProvider>(file, buf_size))
     , file_in(*p_file_in)
 {
     this->compressed_in = &file_in;
@@ -84,7 +161,7 @@ CompressedReadBufferFromFileProvider<has_checksum>::CompressedReadBufferFromFile
 template <bool has_checksum>
 void CompressedReadBufferFromFileProvider<has_checksum>::seek(size_t offset_in_compressed_file, size_t offset_in_decompressed_block)
 {
-    if (size_compressed && offset_in_compressed_file == file_in.getPositionInFile() - size_compressed
+    if (size_compressed && offset_in_compressed_file == getEndOfBlockInFile() - size_compressed
         && offset_in_decompressed_block <= working_buffer.size())
     {
         bytes += offset();
@@ -94,7 +171,10 @@ void CompressedReadBufferFromFileProvider<has_checksum>::seek(size_t offset_in_c
     }
     else
     {
-        file_in.seek(offset_in_compressed_file);
+        if (block_cache)
+            block_cache_file_pos = offset_in_compressed_file;
+        else
+            file_in.seek(offset_in_compressed_file);
 
         bytes += offset();
         nextImpl();
@@ -113,6 +193,10 @@ void CompressedReadBufferFromFileProvider<has_checksum>::seek(size_t offset_in_c
 template <bool has_checksum>
 size_t CompressedReadBufferFromFileProvider<has_checksum>::readBig(char * to, size_t n)
 {
+    /// The blocks must be decompressed into the cache cells.
+    if (block_cache)
+        return ReadBuffer::readBig(to, n);
+
     size_t bytes_read = 0;
 
     /// If there are unread bytes in the buffer, then we copy needed to `to`.
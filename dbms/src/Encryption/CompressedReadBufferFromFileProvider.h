@@ -17,6 +17,7 @@
 #include <Common/Checksum.h>
 #include <Encryption/FileProvider.h>
 #include <IO/CompressedReadBufferBase.h>
+#include <IO/DecompressedBlockCache.h>
 #include <IO/ReadBufferFromFileBase.h>
 #include <time.h>
 
@@ -36,6 +37,15 @@ struct CompressedSeekableReaderBuffer : public BufferWithOwnMemory<ReadBuffer>
 
     virtual void seek(size_t offset_in_compressed_file, size_t offset_in_decompressed_block) = 0;
 
+    /// Reuse the decompressed blocks in `cache`. `cache_path` identifies the file in the cache.
+    virtual void setDecompressedBlockCache(DecompressedBlockCache * /*cache*/, const String & /*cache_path*/) {}
+
+    /// See `ReadBufferFromFileBase::getIOUringPrefetchRange`, the offsets are in the compressed file.
+    virtual bool getIOUringPrefetchRange(size_t /*begin*/, size_t /*end*/, IOUringPrefetchRange & /*range*/) { return false; }
+
+    /// See `ReadBufferFromFileBase::readAhead`, the offsets are in the compressed file.
+    virtual void readAhead(size_t /*begin*/, size_t /*end*/) {}
+
     CompressedSeekableReaderBuffer()
         : BufferWithOwnMemory<ReadBuffer>(0)
     {}
@@ -60,7 +70,17 @@ private:
     ReadBufferFromFileBase & file_in;
     size_t size_compressed = 0;
 
+    /// If `block_cache` is set, the decompressed blocks are read from and put into it, and `working_buffer`
+    /// points to `owned_cell`. `file_in` is only used when the block is not in cache, so the end of current
+    /// block in file is tracked by `block_cache_file_pos` instead of `file_in`.
+    DecompressedBlockCache * block_cache = nullptr;
+    String block_cache_path;
+    size_t block_cache_file_pos = 0;
+    DecompressedBlockCache::MappedPtr owned_cell;
+
     bool nextImpl() override;
+    bool nextImplWithCache();
+    size_t getEndOfBlockInFile() const { return block_cache ? block_cache_file_pos : file_in.getPositionInFile(); }
 
 public:
     CompressedReadBufferFromFileProvider(
@@ -70,7 +90,11 @@ public:
         size_t estimated_size,
         size_t aio_threshold,
         const ReadLimiterPtr & read_limiter_,
-        size_t buf_size = DBMS_DEFAULT_BUFFER_SIZE);
+        size_t buf_size = DBMS_DEFAULT_BUFFER_SIZE,
+        bool use_io_uring = false);
+
+    /// Read the compressed data from an opened `file`, see `ReadBufferFromFileProvider`.
+    CompressedReadBufferFromFileProvider(const RandomAccessFilePtr & file, size_t buf_size);
 
     /// @attention: estimated_size should be at least DBMS_DEFAULT_BUFFER_SIZE if one want to do seeking; however, if one knows that target file
     /// only consists of a single small frame, one can use a smaller estimated_size to reduce memory footprint.
@@ -81,10 +105,14 @@ public:
         size_t estimated_size,
         const ReadLimiterPtr & read_limiter,
         ChecksumAlgo checksum_algorithm,
-        size_t checksum_frame_size);
+        size_t checksum_frame_size,
+        bool use_io_uring = false,
+        bool use_direct_io = false);
 
     void seek(size_t offset_in_compressed_file, size_t offset_in_decompressed_block) override;
 
+    void setDecompressedBlockCache(DecompressedBlockCache * cache, const String & cache_path) override;
+
     size_t readBig(char * to, size_t n) override;
 
     void setProfileCallback(
@@ -93,6 +121,13 @@ public:
     {
         file_in.setProfileCallback(profile_callback_, clock_type_);
     }
+
+    bool getIOUringPrefetchRange(size_t begin, size_t end, IOUringPrefetchRange & range) override
+    {
+        return file_in.getIOUringPrefetchRange(begin, end, range);
+    }
+
+    void readAhead(size_t begin, size_t end) override { file_in.readAhead(begin, end); }
 };
 
 } // namespace DB
@@ -12,29 +12,73 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/TiFlashMetrics.h>
 #include <Encryption/DataKeyManager.h>
 #include <Storages/Transaction/FileEncryption.h>
 #include <Storages/Transaction/ProxyFFI.h>
 
 namespace DB
 {
-DataKeyManager::DataKeyManager(EngineStoreServerWrap * tiflash_instance_wrap_)
+DataKeyManager::DataKeyManager(EngineStoreServerWrap * tiflash_instance_wrap_, size_t file_info_cache_size)
     : tiflash_instance_wrap{tiflash_instance_wrap_}
+    , file_info_cache(file_info_cache_size)
 {}
 
+FileEncryptionInfo DataKeyManager::CachedFileInfo::toFileEncryptionInfo() const
+{
+    return FileEncryptionInfo(
+        res,
+        method,
+        key ? RawCppString::New(*key) : nullptr,
+        iv ? RawCppString::New(*iv) : nullptr,
+        nullptr);
+}
+
+void DataKeyManager::cacheFileInfo(const String & fname, const FileEncryptionInfo & info)
+{
+    auto cached = std::make_shared<CachedFileInfo>();
+    cached->res = info.res;
+    cached->method = info.method;
+    if (info.key)
+        cached->key = *info.key;
+    if (info.iv)
+        cached->iv = *info.iv;
+    file_info_cache.set(fname, cached);
+}
+
+void DataKeyManager::invalidateFileInfo(const String & fname)
+{
+    invalidate_epoch.fetch_add(1, std::memory_order_acq_rel);
+    file_info_cache.remove(fname);
+}
+
 FileEncryptionInfo DataKeyManager::getFile(const String & fname)
 {
-    auto r = tiflash_instance_wrap->proxy_helper->getFile(Poco::Path(fname).toString());
+    auto path = Poco::Path(fname).toString();
+    if (auto cached = file_info_cache.get(path); cached)
+    {
+        GET_METRIC(tiflash_encryption_file_info_lookup_count, type_hit).Increment();
+        return cached->toFileEncryptionInfo();
+    }
+
+    GET_METRIC(tiflash_encryption_file_info_lookup_count, type_miss).Increment();
+    auto epoch = invalidate_epoch.load(std::memory_order_acquire);
+    auto r = tiflash_instance_wrap->proxy_helper->getFile(path);
     if (unlikely(r.res != FileEncryptionRes::Ok && r.res != FileEncryptionRes::Disabled))
     {
         throw DB::TiFlashException("Get encryption info for file: " + fname + " meet error: " + *r.error_msg, Errors::Encryption::Internal);
     }
+    // Do not cache the result if the file may be changed during the lookup.
+    if (epoch == invalidate_epoch.load(std::memory_order_acquire))
+        cacheFileInfo(path, r);
     return r;
 }
 
 FileEncryptionInfo DataKeyManager::newFile(const String & fname)
 {
-    auto r = tiflash_instance_wrap->proxy_helper->newFile(Poco::Path(fname).toString());
+    auto path = Poco::Path(fname).toString();
+    invalidateFileInfo(path);
+    auto r = tiflash_instance_wrap->proxy_helper->newFile(path);
     if (unlikely(r.res != FileEncryptionRes::Ok && r.res != FileEncryptionRes::Disabled))
     {
         throw DB::TiFlashException(
@@ -46,7 +90,9 @@ FileEncryptionInfo DataKeyManager::newFile(const String & fname)
 
 void DataKeyManager::deleteFile(const String & fname, bool throw_on_error)
 {
-    auto r = tiflash_instance_wrap->proxy_helper->deleteFile(Poco::Path(fname).toString());
+    auto path = Poco::Path(fname).toString();
+    invalidateFileInfo(path);
+    auto r = tiflash_instance_wrap->proxy_helper->deleteFile(path);
     if (unlikely(r.res != FileEncryptionRes::Ok && r.res != FileEncryptionRes::Disabled && throw_on_error))
     {
         throw DB::TiFlashException(
@@ -57,7 +103,9 @@ void DataKeyManager::deleteFile(const String & fname, bool throw_on_error)
 
 void DataKeyManager::linkFile(const String & src_fname, const String & dst_fname)
 {
-    auto r = tiflash_instance_wrap->proxy_helper->linkFile(Poco::Path(src_fname).toString(), Poco::Path(dst_fname).toString());
+    auto dst_path = Poco::Path(dst_fname).toString();
+    invalidateFileInfo(dst_path);
+    auto r = tiflash_instance_wrap->proxy_helper->linkFile(Poco::Path(src_fname).toString(), dst_path);
     if (unlikely(r.res != FileEncryptionRes::Ok && r.res != FileEncryptionRes::Disabled))
     {
         throw DB::TiFlashException("Link encryption info from file: " + src_fname + " to " + dst_fname + " meet error: " + *r.error_msg,
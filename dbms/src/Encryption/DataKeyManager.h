@@ -16,17 +16,29 @@
 
 #include <Common/Exception.h>
 #include <Common/TiFlashException.h>
+#include <Common/LRUCache.h>
 #include <Encryption/KeyManager.h>
 #include <Poco/Path.h>
+#include <Storages/Transaction/FileEncryption.h>
 #include <common/likely.h>
 
+#include <atomic>
+#include <optional>
+
 namespace DB
 {
 struct EngineStoreServerWrap;
+
+/// Manages the data keys by the key manager of the proxy.
+/// The result of `getFile` is cached by the encryption path (the DMFile directory, the blob file, ...), so that
+/// opening the sub-files of a DMFile does not go through the FFI each time. The cache is invalidated by
+/// `newFile`, `deleteFile` and `linkFile`.
 class DataKeyManager : public KeyManager
 {
 public:
-    DataKeyManager(EngineStoreServerWrap * tiflash_instance_wrap_);
+    static constexpr size_t DEFAULT_FILE_INFO_CACHE_SIZE = 65536;
+
+    explicit DataKeyManager(EngineStoreServerWrap * tiflash_instance_wrap_, size_t file_info_cache_size = DEFAULT_FILE_INFO_CACHE_SIZE);
 
     ~DataKeyManager() = default;
 
@@ -39,6 +51,24 @@ public:
     void linkFile(const String & src_fname, const String & dst_fname) override;
 
 private:
+    /// A copy of `FileEncryptionInfo` without error, which owns its key and iv.
+    struct CachedFileInfo
+    {
+        FileEncryptionRes res;
+        EncryptionMethod method;
+        std::optional<String> key;
+        std::optional<String> iv;
+
+        FileEncryptionInfo toFileEncryptionInfo() const;
+    };
+
+    void cacheFileInfo(const String & fname, const FileEncryptionInfo & info);
+    void invalidateFileInfo(const String & fname);
+
     EngineStoreServerWrap * tiflash_instance_wrap;
+
+    LRUCache<String, CachedFileInfo> file_info_cache;
+    /// Increased by each invalidation, so that a result of the proxy got before an invalidation is not cached.
+    std::atomic<UInt64> invalidate_epoch = 0;
 };
 } // namespace DB
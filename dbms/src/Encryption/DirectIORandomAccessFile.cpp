@@ -0,0 +1,145 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <Common/ProfileEvents.h>
+#include <Encryption/DirectIORandomAccessFile.h>
+#include <Encryption/PosixRandomAccessFile.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ProfileEvents
+{
+extern const Event DirectIORead;
+extern const Event DirectIOReadBytes;
+} // namespace ProfileEvents
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int ARGUMENT_OUT_OF_BOUND;
+} // namespace ErrorCodes
+
+namespace
+{
+inline bool isAligned(size_t value)
+{
+    return value % DirectIORandomAccessFile::ALIGNMENT == 0;
+}
+} // namespace
+
+DirectIORandomAccessFile::DirectIORandomAccessFile(const std::string & file_name_, int flags, const ReadLimiterPtr & read_limiter_, size_t window_size)
+    : window((window_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, ALIGNMENT)
+{
+    flags = (flags == -1 ? O_RDONLY : flags) | O_DIRECT;
+    try
+    {
+        file = std::make_shared<PosixRandomAccessFile>(file_name_, flags, read_limiter_);
+    }
+    catch (const ErrnoException & e)
+    {
+        if (e.getErrno() != EINVAL)
+            throw;
+        // O_DIRECT is not supported by the file system, fallback to the buffered io.
+        direct_io = false;
+        file = std::make_shared<PosixRandomAccessFile>(file_name_, flags & ~O_DIRECT, read_limiter_);
+    }
+}
+
+off_t DirectIORandomAccessFile::seek(off_t offset, int whence)
+{
+    if (whence == SEEK_SET)
+        file_offset = offset;
+    else if (whence == SEEK_CUR)
+        file_offset += offset;
+    else if (whence == SEEK_END)
+        file_offset = file->seek(offset, SEEK_END);
+    else
+        throw Exception("DirectIORandomAccessFile::seek expects SEEK_SET, SEEK_CUR or SEEK_END as whence", ErrorCodes::ARGUMENT_OUT_OF_BOUND);
+    return file_offset;
+}
+
+ssize_t DirectIORandomAccessFile::read(char * buf, size_t size)
+{
+    ssize_t bytes_read = pread(buf, size, file_offset);
+    if (bytes_read > 0)
+        file_offset += bytes_read;
+    return bytes_read;
+}
+
+ssize_t DirectIORandomAccessFile::alignedRead(char * buf, size_t size, off_t offset) const
+{
+    while (true)
+    {
+        ssize_t res = file->pread(buf, size, offset);
+        if (res == -1 && errno == EINTR)
+            continue;
+        if (res > 0)
+        {
+            ProfileEvents::increment(ProfileEvents::DirectIORead);
+            ProfileEvents::increment(ProfileEvents::DirectIOReadBytes, res);
+        }
+        return res;
+    }
+}
+
+ssize_t DirectIORandomAccessFile::pread(char * buf, size_t size, off_t offset) const
+{
+    std::lock_guard lock(mutex);
+
+    size_t copied = 0;
+    while (copied < size)
+    {
+        const off_t cur = offset + copied;
+        if (cur < window_offset || cur >= window_offset + static_cast<off_t>(window_bytes))
+        {
+            // Large aligned requests are read into the caller's memory directly.
+            const size_t remaining = size - copied;
+            if (remaining >= window.size() && isAligned(cur) && isAligned(reinterpret_cast<uintptr_t>(buf + copied)))
+            {
+                const size_t aligned_size = remaining / ALIGNMENT * ALIGNMENT;
+                ssize_t res = alignedRead(buf + copied, aligned_size, cur);
+                if (res < 0)
+                    return copied > 0 ? static_cast<ssize_t>(copied) : res;
+                copied += res;
+                if (static_cast<size_t>(res) < aligned_size)
+                    break; // EOF
+                continue;
+            }
+
+            const off_t aligned_offset = cur / ALIGNMENT * ALIGNMENT;
+            ssize_t res = alignedRead(window.data(), window.size(), aligned_offset);
+            if (res < 0)
+            {
+                window_bytes = 0;
+                return copied > 0 ? static_cast<ssize_t>(copied) : res;
+            }
+            window_offset = aligned_offset;
+            window_bytes = res;
+            if (cur >= window_offset + static_cast<off_t>(window_bytes))
+                break; // EOF
+        }
+
+        const size_t n = std::min(size - copied, static_cast<size_t>(window_offset + window_bytes - cur));
+        memcpy(buf + copied, window.data() + (cur - window_offset), n);
+        copied += n;
+    }
+    return static_cast<ssize_t>(copied);
+}
+
+} // namespace DB
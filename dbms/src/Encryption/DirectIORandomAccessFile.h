@@ -0,0 +1,83 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Encryption/RandomAccessFile.h>
+#include <IO/BufferWithOwnMemory.h>
+
+#include <mutex>
+#include <string>
+
+namespace DB
+{
+class ReadLimiter;
+using ReadLimiterPtr = std::shared_ptr<ReadLimiter>;
+
+/// Read a file by O_DIRECT, bypassing the page cache.
+///
+/// O_DIRECT requires the offset, the size and the memory of each read to be aligned, while the callers
+/// (e.g. `FramedChecksumReadBuffer`, `CompressedReadBufferFromFileProvider`) read arbitrary ranges. The
+/// reads are served from an aligned window of the file, which is refilled by one aligned read when the
+/// requested range is out of it. Large aligned requests are read into the caller's memory directly.
+///
+/// It is the innermost file, `EncryptedRandomAccessFile` can be stacked on it and decrypts the data in
+/// the caller's memory as usual.
+///
+/// If the file system does not support O_DIRECT (e.g. tmpfs), the file is opened without it and the
+/// reads are still aligned.
+class DirectIORandomAccessFile : public RandomAccessFile
+{
+public:
+    static constexpr size_t ALIGNMENT = 4096;
+    static constexpr size_t DEFAULT_WINDOW_SIZE = 1024 * 1024;
+
+    DirectIORandomAccessFile(const std::string & file_name_, int flags, const ReadLimiterPtr & read_limiter_, size_t window_size = DEFAULT_WINDOW_SIZE);
+
+    ~DirectIORandomAccessFile() override = default;
+
+    off_t seek(off_t offset, int whence) override;
+
+    ssize_t read(char * buf, size_t size) override;
+
+    ssize_t pread(char * buf, size_t size, off_t offset) const override;
+
+    std::string getFileName() const override { return file->getFileName(); }
+
+    int getFd() const override { return file->getFd(); }
+
+    bool isClosed() const override { return file->isClosed(); }
+
+    void close() override { file->close(); }
+
+    /// Whether the file is opened with O_DIRECT actually.
+    bool isDirectIO() const { return direct_io; }
+
+private:
+    /// Read `size` bytes at `offset` from the underlying file, retry on EINTR. All the params must be aligned.
+    ssize_t alignedRead(char * buf, size_t size, off_t offset) const;
+
+    RandomAccessFilePtr file;
+    bool direct_io = true;
+    /// The offset of `read`.
+    off_t file_offset = 0;
+
+    mutable std::mutex mutex;
+    mutable Memory<> window;
+    mutable off_t window_offset = 0;
+    mutable size_t window_bytes = 0;
+};
+
+} // namespace DB
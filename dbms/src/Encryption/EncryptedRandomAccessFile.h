@@ -46,6 +46,11 @@ public:
 
     void close() override;
 
+    void readAhead(off_t offset, size_t size) override { file->readAhead(offset, size); }
+
+    /// The data is read ahead as ciphertext and decrypted in `pread`, so it is safe to forward.
+    IOUringRandomAccessFile * getIOUringFile() override { return file->getIOUringFile(); }
+
 private:
     RandomAccessFilePtr file;
 
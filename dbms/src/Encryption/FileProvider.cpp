@@ -13,10 +13,14 @@
 // limitations under the License.
 
 #include <Common/TiFlashException.h>
+#include <Encryption/DirectIORandomAccessFile.h>
 #include <Encryption/EncryptedRandomAccessFile.h>
 #include <Encryption/EncryptedWritableFile.h>
 #include <Encryption/EncryptedWriteReadableFile.h>
 #include <Encryption/FileProvider.h>
+#include <Encryption/IOUring.h>
+#include <Encryption/IOUringRandomAccessFile.h>
+#include <Encryption/MMapRandomAccessFile.h>
 #include <Encryption/PosixRandomAccessFile.h>
 #include <Encryption/PosixWritableFile.h>
 #include <Encryption/PosixWriteReadableFile.h>
@@ -30,9 +34,18 @@ RandomAccessFilePtr FileProvider::newRandomAccessFile(
     const String & file_path_,
     const EncryptionPath & encryption_path_,
     const ReadLimiterPtr & read_limiter,
-    int flags) const
+    int flags,
+    bool use_io_uring) const
 {
-    RandomAccessFilePtr file = std::make_shared<PosixRandomAccessFile>(file_path_, flags, read_limiter);
+    RandomAccessFilePtr file;
+    // io_uring is only used for buffered reads, the prefetched buffer is not aligned for O_DIRECT.
+    if (use_io_uring && (flags == -1 || !(flags & O_DIRECT)) && IOUring::isSupported())
+        file = std::make_shared<IOUringRandomAccessFile>(file_path_, flags, read_limiter);
+    else if (flags != -1 && (flags & O_DIRECT))
+        file = std::make_shared<DirectIORandomAccessFile>(file_path_, flags, read_limiter);
+    else
+        file = std::make_shared<PosixRandomAccessFile>(file_path_, flags, read_limiter);
+    // The encrypted file is stacked on the direct io file, the data is decrypted in the caller's memory.
     auto encryption_info = key_manager->getFile(encryption_path_.full_path);
     if (encryption_info.res != FileEncryptionRes::Disabled && encryption_info.method != EncryptionMethod::Plaintext)
     {
@@ -41,6 +54,17 @@ RandomAccessFilePtr FileProvider::newRandomAccessFile(
     return file;
 }
 
+MMapRandomAccessFilePtr FileProvider::newMMapRandomAccessFile(
+    const String & file_path_,
+    const EncryptionPath & encryption_path_,
+    const ReadLimiterPtr & read_limiter) const
+{
+    auto encryption_info = key_manager->getFile(encryption_path_.full_path);
+    if (encryption_info.res != FileEncryptionRes::Disabled && encryption_info.method != EncryptionMethod::Plaintext)
+        return nullptr;
+    return std::make_shared<MMapRandomAccessFile>(file_path_, read_limiter);
+}
+
 WritableFilePtr FileProvider::newWritableFile(
     const String & file_path_,
     const EncryptionPath & encryption_path_,
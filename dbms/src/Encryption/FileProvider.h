@@ -31,6 +31,8 @@ class WriteLimiter;
 using WriteLimiterPtr = std::shared_ptr<WriteLimiter>;
 class ReadLimiter;
 using ReadLimiterPtr = std::shared_ptr<ReadLimiter>;
+class MMapRandomAccessFile;
+using MMapRandomAccessFilePtr = std::shared_ptr<MMapRandomAccessFile>;
 
 class FileProvider
 {
@@ -40,11 +42,20 @@ public:
         , encryption_enabled{encryption_enabled_}
     {}
 
+    // If `flags` contains O_DIRECT, the file is read by `DirectIORandomAccessFile`, which accepts unaligned reads.
     RandomAccessFilePtr newRandomAccessFile(
         const String & file_path_,
         const EncryptionPath & encryption_path_,
         const ReadLimiterPtr & read_limiter = nullptr,
-        int flags = -1) const;
+        int flags = -1,
+        bool use_io_uring = false) const;
+
+    // Open the file by `MMapRandomAccessFile`. Returns nullptr if the file is encrypted, whose mapped bytes
+    // are not the content, the callers should read it by `newRandomAccessFile` then.
+    MMapRandomAccessFilePtr newMMapRandomAccessFile(
+        const String & file_path_,
+        const EncryptionPath & encryption_path_,
+        const ReadLimiterPtr & read_limiter = nullptr) const;
 
     WritableFilePtr newWritableFile(
         const String & file_path_,
@@ -0,0 +1,279 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/Exception.h>
+#include <Encryption/IOUring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <deque>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#define TIFLASH_HAS_IO_URING 1
+#else
+#define TIFLASH_HAS_IO_URING 0
+#endif
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int CANNOT_READ_FROM_FILE_DESCRIPTOR;
+} // namespace ErrorCodes
+
+namespace
+{
+constexpr unsigned IO_URING_ENTRIES = 64;
+} // namespace
+
+bool IOUring::isSupported()
+{
+    static const bool supported = IOUring(1).valid();
+    return supported;
+}
+
+IOUring * IOUring::getThreadLocal()
+{
+    if (!isSupported())
+        return nullptr;
+    thread_local IOUring ring(IO_URING_ENTRIES);
+    return ring.valid() ? &ring : nullptr;
+}
+
+#if TIFLASH_HAS_IO_URING
+
+namespace
+{
+int ioUringSetup(unsigned entries, io_uring_params * params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+} // namespace
+
+IOUring::IOUring(unsigned entries_)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd = ioUringSetup(entries_, &params);
+    if (ring_fd < 0)
+        return;
+
+    entries = params.sq_entries;
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+#endif
+    if (single_mmap)
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+    sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED)
+    {
+        sq_ring = nullptr;
+        release();
+        return;
+    }
+    if (single_mmap)
+    {
+        cq_ring = sq_ring;
+    }
+    else
+    {
+        cq_ring = ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED)
+        {
+            cq_ring = nullptr;
+            release();
+            return;
+        }
+    }
+    sqes = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        sqes = nullptr;
+        release();
+        return;
+    }
+
+    auto * sq_ptr = static_cast<char *>(sq_ring);
+    sq_tail = reinterpret_cast<unsigned *>(sq_ptr + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned *>(sq_ptr + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq_ptr + params.sq_off.array);
+    auto * cq_ptr = static_cast<char *>(cq_ring);
+    cq_head = reinterpret_cast<unsigned *>(cq_ptr + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq_ptr + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq_ptr + params.cq_off.ring_mask);
+    cqes = cq_ptr + params.cq_off.cqes;
+}
+
+void IOUring::release()
+{
+    if (sqes != nullptr)
+        ::munmap(sqes, sqes_size);
+    if (cq_ring != nullptr && cq_ring != sq_ring)
+        ::munmap(cq_ring, cq_ring_size);
+    if (sq_ring != nullptr)
+        ::munmap(sq_ring, sq_ring_size);
+    sqes = cq_ring = sq_ring = nullptr;
+    if (ring_fd >= 0)
+        ::close(ring_fd);
+    ring_fd = -1;
+}
+
+void IOUring::readBatch(std::vector<ReadRequest> & requests)
+{
+    if (unlikely(!valid()))
+        throw Exception("io_uring is not available", ErrorCodes::CANNOT_READ_FROM_FILE_DESCRIPTOR);
+
+    // The buffers of the in-flight reads must be kept valid until they are finished, so we always wait for
+    // all of them, even if some of them fail.
+    std::deque<size_t> to_submit;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        requests[i].result = 0;
+        if (requests[i].size > 0)
+            to_submit.push_back(i);
+    }
+    iovecs.resize(requests.size());
+
+    auto * sqe_array = static_cast<io_uring_sqe *>(sqes);
+    auto * cqe_array = static_cast<io_uring_cqe *>(cqes);
+    // Submitted to the ring but not consumed by kernel yet.
+    unsigned pending = 0;
+    // Consumed by kernel but not completed yet. Keep `pending + inflight` no more than `entries`
+    // so that the completion queue never overflows.
+    unsigned inflight = 0;
+    int enter_errno = 0;
+    while (true)
+    {
+        if (enter_errno == 0)
+        {
+            unsigned tail = *sq_tail;
+            while (!to_submit.empty() && pending + inflight < entries)
+            {
+                auto idx = to_submit.front();
+                to_submit.pop_front();
+                auto & req = requests[idx];
+                iovecs[idx].iov_base = req.buf + req.result;
+                iovecs[idx].iov_len = req.size - req.result;
+
+                unsigned index = tail & *sq_mask;
+                auto & sqe = sqe_array[index];
+                memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = IORING_OP_READV;
+                sqe.fd = req.fd;
+                sqe.addr = reinterpret_cast<UInt64>(&iovecs[idx]);
+                sqe.len = 1;
+                sqe.off = req.offset + req.result;
+                sqe.user_data = idx;
+                sq_array[index] = index;
+                ++tail;
+                ++pending;
+            }
+            __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+        }
+
+        if (pending + inflight == 0)
+            break;
+
+        unsigned to_enter = enter_errno == 0 ? pending : 0;
+        int ret = ioUringEnter(ring_fd, to_enter, inflight + to_enter > 0 ? 1 : 0, IORING_ENTER_GETEVENTS);
+        if (ret < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            // Stop submitting, and only wait for the in-flight reads.
+            enter_errno = errno;
+            if (inflight == 0)
+                break;
+        }
+        else if (to_enter > 0)
+        {
+            pending -= ret;
+            inflight += ret;
+        }
+
+        unsigned head = *cq_head;
+        unsigned cq_tail_now = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != cq_tail_now; ++head)
+        {
+            const auto & cqe = cqe_array[head & *cq_mask];
+            auto idx = static_cast<size_t>(cqe.user_data);
+            auto & req = requests[idx];
+            --inflight;
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN)
+            {
+                to_submit.push_back(idx);
+            }
+            else if (cqe.res < 0)
+            {
+                req.result = cqe.res;
+            }
+            else if (cqe.res > 0 && static_cast<size_t>(req.result + cqe.res) < req.size)
+            {
+                // Short read, continue reading the rest.
+                req.result += cqe.res;
+                to_submit.push_back(idx);
+            }
+            else
+            {
+                // Finished or reaching EOF.
+                req.result += cqe.res;
+            }
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    if (enter_errno != 0)
+    {
+        errno = enter_errno;
+        throwFromErrno("Cannot submit reads to io_uring", ErrorCodes::CANNOT_READ_FROM_FILE_DESCRIPTOR);
+    }
+}
+
+#else
+
+IOUring::IOUring(unsigned)
+{
+}
+
+void IOUring::release()
+{
+}
+
+void IOUring::readBatch(std::vector<ReadRequest> &)
+{
+    throw Exception("io_uring is not available", ErrorCodes::CANNOT_READ_FROM_FILE_DESCRIPTOR);
+}
+
+#endif
+
+IOUring::~IOUring()
+{
+    release();
+}
+
+} // namespace DB
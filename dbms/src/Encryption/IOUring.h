@@ -0,0 +1,81 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Core/Types.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace DB
+{
+/// A minimal io_uring instance built on the raw system calls, which is only used to submit reads in batch,
+/// so that the reads of different files can be served by the disk in parallel.
+/// Each thread owns its instance, see `getThreadLocal`.
+class IOUring : private boost::noncopyable
+{
+public:
+    struct ReadRequest
+    {
+        int fd;
+        char * buf;
+        size_t size;
+        off_t offset;
+        /// The bytes read, which is less than `size` only if reaching EOF. Or -errno if failed.
+        ssize_t result = 0;
+    };
+
+    /// Whether io_uring is available. It could be unsupported by the kernel, or forbidden by seccomp.
+    static bool isSupported();
+
+    /// Returns nullptr if io_uring is not available.
+    static IOUring * getThreadLocal();
+
+    ~IOUring();
+
+    /// Submit all the reads and wait for all of them to finish.
+    void readBatch(std::vector<ReadRequest> & requests);
+
+private:
+    explicit IOUring(unsigned entries);
+
+    bool valid() const { return ring_fd >= 0; }
+
+    void release();
+
+    int ring_fd = -1;
+    unsigned entries = 0;
+
+    void * sq_ring = nullptr;
+    size_t sq_ring_size = 0;
+    void * cq_ring = nullptr;
+    size_t cq_ring_size = 0;
+    void * sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned * sq_tail = nullptr;
+    unsigned * sq_mask = nullptr;
+    unsigned * sq_array = nullptr;
+    unsigned * cq_head = nullptr;
+    unsigned * cq_tail = nullptr;
+    unsigned * cq_mask = nullptr;
+    void * cqes = nullptr;
+
+    std::vector<iovec> iovecs;
+};
+
+} // namespace DB
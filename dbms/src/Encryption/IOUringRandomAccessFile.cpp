@@ -0,0 +1,174 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/Exception.h>
+#include <Common/ProfileEvents.h>
+#include <Encryption/IOUring.h>
+#include <Encryption/IOUringRandomAccessFile.h>
+#include <Encryption/RateLimiter.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace ProfileEvents
+{
+extern const Event FileOpen;
+extern const Event FileOpenFailed;
+} // namespace ProfileEvents
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int FILE_DOESNT_EXIST;
+extern const int CANNOT_OPEN_FILE;
+extern const int CANNOT_CLOSE_FILE;
+extern const int CANNOT_READ_FROM_FILE_DESCRIPTOR;
+} // namespace ErrorCodes
+
+IOUringRandomAccessFile::IOUringRandomAccessFile(const std::string & file_name_, int flags, const ReadLimiterPtr & read_limiter_)
+    : file_name{file_name_}
+    , read_limiter(read_limiter_)
+{
+    ProfileEvents::increment(ProfileEvents::FileOpen);
+
+    fd = open(file_name.c_str(), flags == -1 ? O_RDONLY : flags);
+
+    if (-1 == fd)
+    {
+        ProfileEvents::increment(ProfileEvents::FileOpenFailed);
+        throwFromErrno("Cannot open file " + file_name, errno == ENOENT ? ErrorCodes::FILE_DOESNT_EXIST : ErrorCodes::CANNOT_OPEN_FILE);
+    }
+}
+
+IOUringRandomAccessFile::~IOUringRandomAccessFile()
+{
+    if (fd < 0)
+        return;
+
+    ::close(fd);
+}
+
+void IOUringRandomAccessFile::close()
+{
+    if (fd < 0)
+        return;
+    while (::close(fd) != 0)
+        if (errno != EINTR)
+            throwFromErrno("Cannot close file " + file_name, ErrorCodes::CANNOT_CLOSE_FILE);
+
+    fd = -1;
+    metric_increment.destroy();
+    prefetched_data = {};
+    prefetched_size = 0;
+}
+
+off_t IOUringRandomAccessFile::seek(off_t offset, int whence)
+{
+    off_t new_offset;
+    switch (whence)
+    {
+    case SEEK_SET:
+        new_offset = offset;
+        break;
+    case SEEK_CUR:
+        new_offset = cur_offset + offset;
+        break;
+    default:
+        new_offset = ::lseek(fd, offset, whence);
+        break;
+    }
+    if (new_offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    cur_offset = new_offset;
+    return cur_offset;
+}
+
+ssize_t IOUringRandomAccessFile::read(char * buf, size_t size)
+{
+    ssize_t bytes_read = pread(buf, size, cur_offset);
+    if (bytes_read > 0)
+        cur_offset += bytes_read;
+    return bytes_read;
+}
+
+void IOUringRandomAccessFile::readAhead(off_t offset, size_t size)
+{
+    if (fd >= 0 && !hasPrefetched(offset, size))
+        ::posix_fadvise(fd, offset, size, POSIX_FADV_WILLNEED);
+}
+
+ssize_t IOUringRandomAccessFile::pread(char * buf, size_t size, off_t offset) const
+{
+    if (prefetched_size > 0 && offset >= prefetched_offset && offset < prefetched_offset + static_cast<off_t>(prefetched_size))
+    {
+        // The read limiter has been charged when prefetching.
+        size_t copy_size = std::min(size, prefetched_size - static_cast<size_t>(offset - prefetched_offset));
+        memcpy(buf, prefetched_data.data() + (offset - prefetched_offset), copy_size);
+        return copy_size;
+    }
+
+    if (read_limiter != nullptr)
+    {
+        read_limiter->request(size);
+    }
+    return ::pread(fd, buf, size, offset);
+}
+
+void IOUringRandomAccessFile::prefetch(const std::vector<IOUringPrefetchRange> & ranges)
+{
+    auto * ring = IOUring::getThreadLocal();
+    if (ring == nullptr)
+        return;
+
+    std::vector<IOUring::ReadRequest> requests;
+    std::vector<IOUringRandomAccessFile *> files;
+    requests.reserve(ranges.size());
+    files.reserve(ranges.size());
+    for (const auto & range : ranges)
+    {
+        auto * file = range.file;
+        if (file == nullptr || file->isClosed() || range.size == 0 || file->hasPrefetched(range.offset, range.size))
+            continue;
+        if (file->read_limiter != nullptr)
+            file->read_limiter->request(range.size);
+        file->prefetched_size = 0;
+        file->prefetched_data.resize(range.size);
+        requests.push_back(IOUring::ReadRequest{file->fd, file->prefetched_data.data(), range.size, range.offset});
+        files.push_back(file);
+    }
+    if (requests.empty())
+        return;
+
+    ring->readBatch(requests);
+
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const auto & req = requests[i];
+        auto * file = files[i];
+        if (req.result < 0)
+        {
+            errno = static_cast<int>(-req.result);
+            throwFromErrno("Cannot read from file " + file->file_name, ErrorCodes::CANNOT_READ_FROM_FILE_DESCRIPTOR);
+        }
+        file->prefetched_offset = req.offset;
+        file->prefetched_size = req.result;
+    }
+}
+
+} // namespace DB
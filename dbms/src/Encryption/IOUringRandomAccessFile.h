@@ -0,0 +1,86 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/CurrentMetrics.h>
+#include <Common/PODArray.h>
+#include <Encryption/RandomAccessFile.h>
+
+#include <string>
+#include <vector>
+
+namespace CurrentMetrics
+{
+extern const Metric OpenFileForRead;
+}
+
+namespace DB
+{
+class ReadLimiter;
+using ReadLimiterPtr = std::shared_ptr<ReadLimiter>;
+
+/// A RandomAccessFile which is able to read ahead ranges of many files in one batch by io_uring.
+/// The data read ahead is kept in memory and served by the following `read` or `pread` calls, so
+/// the callers (read buffers, decompressing, checksum, decrypting) are unchanged.
+/// Not thread-safe, as the buffers it reads from are.
+class IOUringRandomAccessFile : public RandomAccessFile
+{
+public:
+    IOUringRandomAccessFile(const std::string & file_name_, int flags, const ReadLimiterPtr & read_limiter_ = nullptr);
+
+    ~IOUringRandomAccessFile() override;
+
+    off_t seek(off_t offset, int whence) override;
+
+    ssize_t read(char * buf, size_t size) override;
+
+    ssize_t pread(char * buf, size_t size, off_t offset) const override;
+
+    std::string getFileName() const override { return file_name; }
+
+    bool isClosed() const override { return fd == -1; }
+
+    int getFd() const override { return fd; }
+
+    void close() override;
+
+    void readAhead(off_t offset, size_t size) override;
+
+    IOUringRandomAccessFile * getIOUringFile() override { return this; }
+
+    /// Read the ranges by one batch of io_uring and keep the data in the files. Each file keeps only the data
+    /// of its last range, so the callers should pass at most one range for each file.
+    /// Fallback to do nothing if io_uring is not supported.
+    static void prefetch(const std::vector<IOUringPrefetchRange> & ranges);
+
+    bool hasPrefetched(off_t offset, size_t size) const
+    {
+        return offset >= prefetched_offset && offset + static_cast<off_t>(size) <= prefetched_offset + static_cast<off_t>(prefetched_size);
+    }
+
+private:
+    CurrentMetrics::Increment metric_increment{CurrentMetrics::OpenFileForRead};
+    std::string file_name;
+    int fd;
+    ReadLimiterPtr read_limiter;
+
+    off_t cur_offset = 0;
+
+    PODArray<char> prefetched_data;
+    off_t prefetched_offset = 0;
+    size_t prefetched_size = 0;
+};
+
+} // namespace DB
@@ -0,0 +1,144 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/Exception.h>
+#include <Common/ProfileEvents.h>
+#include <Encryption/MMapRandomAccessFile.h>
+#include <Encryption/RateLimiter.h>
+#include <fmt/core.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ProfileEvents
+{
+extern const Event FileOpen;
+extern const Event FileOpenFailed;
+extern const Event MMapFileOpen;
+extern const Event MMapFileOpenBytes;
+} // namespace ProfileEvents
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int FILE_DOESNT_EXIST;
+extern const int CANNOT_OPEN_FILE;
+extern const int CANNOT_CLOSE_FILE;
+extern const int CANNOT_ALLOCATE_MEMORY;
+extern const int ARGUMENT_OUT_OF_BOUND;
+} // namespace ErrorCodes
+
+MMapRandomAccessFile::MMapRandomAccessFile(const std::string & file_name_, const ReadLimiterPtr & read_limiter)
+    : file_name{file_name_}
+{
+    ProfileEvents::increment(ProfileEvents::FileOpen);
+
+    fd = ::open(file_name.c_str(), O_RDONLY);
+    if (-1 == fd)
+    {
+        ProfileEvents::increment(ProfileEvents::FileOpenFailed);
+        throwFromErrno("Cannot open file " + file_name, errno == ENOENT ? ErrorCodes::FILE_DOESNT_EXIST : ErrorCodes::CANNOT_OPEN_FILE);
+    }
+
+    struct stat st;
+    if (0 != ::fstat(fd, &st))
+    {
+        ProfileEvents::increment(ProfileEvents::FileOpenFailed);
+        auto saved_errno = errno;
+        ::close(fd);
+        throwFromErrno("Cannot fstat file " + file_name, ErrorCodes::CANNOT_OPEN_FILE, saved_errno);
+    }
+    file_size = st.st_size;
+
+    // An empty file can not be mapped, and there is nothing to read.
+    if (file_size == 0)
+        return;
+
+    // The whole file is faulted in soon by the callers, so the read limiter is requested at once.
+    if (read_limiter != nullptr)
+        read_limiter->request(file_size);
+
+    void * addr = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == addr)
+    {
+        auto saved_errno = errno;
+        ::close(fd);
+        throwFromErrno(fmt::format("Cannot mmap file {} of size {}", file_name, file_size), ErrorCodes::CANNOT_ALLOCATE_MEMORY, saved_errno);
+    }
+    mapped = static_cast<char *>(addr);
+    ProfileEvents::increment(ProfileEvents::MMapFileOpen);
+    ProfileEvents::increment(ProfileEvents::MMapFileOpenBytes, file_size);
+}
+
+MMapRandomAccessFile::~MMapRandomAccessFile()
+{
+    if (mapped != nullptr)
+        ::munmap(mapped, file_size);
+    if (fd >= 0)
+        ::close(fd);
+}
+
+void MMapRandomAccessFile::close()
+{
+    if (fd < 0)
+        return;
+    while (::close(fd) != 0)
+        if (errno != EINTR)
+            throwFromErrno("Cannot close file " + file_name, ErrorCodes::CANNOT_CLOSE_FILE);
+
+    fd = -1;
+    metric_increment.destroy();
+}
+
+off_t MMapRandomAccessFile::seek(off_t offset, int whence)
+{
+    if (whence == SEEK_SET)
+        file_offset = offset;
+    else if (whence == SEEK_CUR)
+        file_offset += offset;
+    else if (whence == SEEK_END)
+        file_offset = file_size + offset;
+    else
+        throw Exception("MMapRandomAccessFile::seek expects SEEK_SET, SEEK_CUR or SEEK_END as whence", ErrorCodes::ARGUMENT_OUT_OF_BOUND);
+    return file_offset;
+}
+
+ssize_t MMapRandomAccessFile::read(char * buf, size_t size)
+{
+    ssize_t bytes_read = pread(buf, size, file_offset);
+    if (bytes_read > 0)
+        file_offset += bytes_read;
+    return bytes_read;
+}
+
+ssize_t MMapRandomAccessFile::pread(char * buf, size_t size, off_t offset) const
+{
+    if (offset < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if (static_cast<size_t>(offset) >= file_size)
+        return 0;
+    size_t bytes_read = std::min(size, file_size - offset);
+    std::memcpy(buf, mapped + offset, bytes_read);
+    return static_cast<ssize_t>(bytes_read);
+}
+
+} // namespace DB
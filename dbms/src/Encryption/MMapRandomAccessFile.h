@@ -0,0 +1,78 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Common/CurrentMetrics.h>
+#include <Encryption/RandomAccessFile.h>
+
+#include <string>
+
+namespace CurrentMetrics
+{
+extern const Metric OpenFileForRead;
+}
+
+namespace DB
+{
+class ReadLimiter;
+using ReadLimiterPtr = std::shared_ptr<ReadLimiter>;
+
+/// A read-only file which is mapped into memory as a whole when it is opened.
+///
+/// The reads are served by copying from the mapping, so a small file (e.g. the marks and the min-max index
+/// of a DMFile) costs no read syscalls and no read buffers. `data()` exposes the mapped bytes for the
+/// callers who can use them in place. The mapping is released when the file is destroyed, while `close()`
+/// only closes the file descriptor.
+///
+/// It reads the raw bytes of the file, so it can not be used for the encrypted files.
+class MMapRandomAccessFile : public RandomAccessFile
+{
+public:
+    MMapRandomAccessFile(const std::string & file_name_, const ReadLimiterPtr & read_limiter);
+
+    ~MMapRandomAccessFile() override;
+
+    off_t seek(off_t offset, int whence) override;
+
+    ssize_t read(char * buf, size_t size) override;
+
+    ssize_t pread(char * buf, size_t size, off_t offset) const override;
+
+    std::string getFileName() const override { return file_name; }
+
+    int getFd() const override { return fd; }
+
+    bool isClosed() const override { return fd == -1; }
+
+    void close() override;
+
+    const char * data() const { return mapped; }
+
+    size_t size() const { return file_size; }
+
+private:
+    std::string file_name;
+    int fd = -1;
+    char * mapped = nullptr;
+    size_t file_size = 0;
+    /// The offset of `read`.
+    off_t file_offset = 0;
+
+    CurrentMetrics::Increment metric_increment{CurrentMetrics::OpenFileForRead};
+};
+
+using MMapRandomAccessFilePtr = std::shared_ptr<MMapRandomAccessFile>;
+
+} // namespace DB
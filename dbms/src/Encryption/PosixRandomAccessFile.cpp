@@ -102,6 +102,17 @@ ssize_t PosixRandomAccessFile::read(char * buf, size_t size)
     return ::read(fd, buf, size);
 }
 
+void PosixRandomAccessFile::readAhead(off_t offset, size_t size)
+{
+#ifdef POSIX_FADV_WILLNEED
+    if (fd >= 0)
+        ::posix_fadvise(fd, offset, size, POSIX_FADV_WILLNEED);
+#else
+    (void)offset;
+    (void)size;
+#endif
+}
+
 ssize_t PosixRandomAccessFile::pread(char * buf, size_t size, off_t offset) const
 {
     if (read_limiter != nullptr)
@@ -50,6 +50,8 @@ public:
 
     void close() override;
 
+    void readAhead(off_t offset, size_t size) override;
+
 private:
     CurrentMetrics::Increment metric_increment{CurrentMetrics::OpenFileForRead};
     std::string file_name;
@@ -24,6 +24,16 @@
 
 namespace DB
 {
+class IOUringRandomAccessFile;
+
+/// A range of a file to be read ahead by io_uring, see `IOUringRandomAccessFile::prefetch`.
+struct IOUringPrefetchRange
+{
+    IOUringRandomAccessFile * file = nullptr;
+    off_t offset = 0;
+    size_t size = 0;
+};
+
 class RandomAccessFile
 {
 public:
@@ -42,6 +52,13 @@ public:
     virtual bool isClosed() const = 0;
 
     virtual void close() = 0;
+
+    /// Hint the OS to load the range into page cache in background, the following reads of it are then
+    /// served from memory. It is only a hint, errors are ignored.
+    virtual void readAhead(off_t /*offset*/, size_t /*size*/) {}
+
+    /// Returns the underlying file which supports batching reads by io_uring, or nullptr if not supported.
+    virtual IOUringRandomAccessFile * getIOUringFile() { return nullptr; }
 };
 
 using RandomAccessFilePtr = std::shared_ptr<RandomAccessFile>;
@@ -22,6 +22,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <cassert>
+#include <iterator>
 #include <fstream>
 
 namespace CurrentMetrics
@@ -109,12 +110,34 @@ WriteLimiter::WriteLimiter(Int64 rate_limit_per_sec_, LimiterType type_, UInt64
     , alloc_bytes{0}
 {}
 
+WriteLimiter::WriteLimiter(WriteLimiterPtr parent_, IOClass io_class_)
+    : refill_period_ms{0}
+    , refill_balance_per_period{0}
+    , available_balance{0}
+    , stop{false}
+    , requests_to_wait{0}
+    , type(parent_->type)
+    , parent(std::move(parent_))
+    , io_class(std::move(io_class_))
+    , alloc_bytes{0}
+{}
+
 WriteLimiter::~WriteLimiter()
 {
     setStop();
 }
 
 void WriteLimiter::request(Int64 bytes)
+{
+    if (parent)
+    {
+        parent->request(bytes, io_class);
+        return;
+    }
+    request(bytes, IOClass{});
+}
+
+void WriteLimiter::request(Int64 bytes, const IOClass & req_class)
 {
     std::unique_lock lock(request_mutex);
 
@@ -136,7 +159,7 @@ void WriteLimiter::request(Int64 bytes)
 
     // request cannot be satisfied at this moment, enqueue
     Request r(bytes);
-    req_queue.push_back(&r);
+    enqueueRequest(&r, req_class);
     while (!r.granted)
     {
         assert(!req_queue.empty());
@@ -217,6 +240,34 @@ size_t WriteLimiter::setStop()
     return sz;
 }
 
+void WriteLimiter::enqueueRequest(Request * r, const IOClass & req_class)
+{
+    // Start-time fair queuing: the requests of a class are tagged with a virtual time span that is
+    // proportional to `bytes / weight` and served in the order of their finish tags. A class that
+    // was idle restarts from the current virtual time, so it can not accumulate credits.
+    auto & last_finish_tag = class_finish_tags[req_class.name];
+    r->start_tag = std::max(virtual_time, last_finish_tag);
+    r->finish_tag = r->start_tag + static_cast<double>(r->bytes) / std::max<UInt64>(req_class.weight, 1);
+    last_finish_tag = r->finish_tag;
+
+    // The front request may be partially allocated, keep it at the front.
+    auto pos = req_queue.end();
+    while (pos != req_queue.begin() && std::prev(pos) != req_queue.begin() && (*std::prev(pos))->finish_tag > r->finish_tag)
+        --pos;
+    req_queue.insert(pos, r);
+}
+
+void WriteLimiter::popFrontRequest()
+{
+    virtual_time = std::max(virtual_time, req_queue.front()->start_tag);
+    req_queue.pop_front();
+    if (req_queue.empty())
+    {
+        virtual_time = 0;
+        class_finish_tags.clear();
+    }
+}
+
 bool WriteLimiter::canGrant(Int64 bytes)
 {
     return available_balance >= bytes;
@@ -251,7 +302,7 @@ void WriteLimiter::refillAndAlloc()
         consumeBytes(next_req->remaining_bytes);
         next_req->remaining_bytes = 0;
         next_req->granted = true;
-        req_queue.pop_front();
+        popFrontRequest();
         // quota granted, signal the thread
         if (next_req != head_req)
             next_req->cv.notify_one();
@@ -302,6 +353,15 @@ ReadLimiter::ReadLimiter(
     , get_io_statistic_period_us(get_io_stat_period_us)
 {}
 
+ReadLimiter::ReadLimiter(const std::shared_ptr<ReadLimiter> & parent_, IOClass io_class_)
+    : WriteLimiter(parent_, std::move(io_class_))
+    , getIOStatistic([]() -> Int64 { return 0; })
+    , last_stat_bytes(0)
+    , last_stat_time(now())
+    , log(parent_->log)
+    , get_io_statistic_period_us(0)
+{}
+
 Int64 ReadLimiter::getAvailableBalance()
 {
     TimePoint us = now();
@@ -373,7 +433,7 @@ void ReadLimiter::refillAndAlloc()
         next_req->remaining_bytes = 0;
         next_req->granted = true;
 
-        req_queue.pop_front();
+        popFrontRequest();
         if (next_req != head_req)
         {
             next_req->cv.notify_one();
@@ -419,6 +479,18 @@ ReadLimiterPtr IORateLimiter::getReadLimiter()
     return is_background_thread ? bg_read_limiter : fg_read_limiter;
 }
 
+WriteLimiterPtr IORateLimiter::getWriteLimiter(const IOClass & io_class)
+{
+    auto limiter = getWriteLimiter();
+    return limiter ? std::make_shared<WriteLimiter>(limiter, io_class) : nullptr;
+}
+
+ReadLimiterPtr IORateLimiter::getReadLimiter(const IOClass & io_class)
+{
+    auto limiter = getReadLimiter();
+    return limiter ? std::make_shared<ReadLimiter>(limiter, io_class) : nullptr;
+}
+
 void IORateLimiter::updateConfig(Poco::Util::AbstractConfiguration & config_)
 {
     StorageIORateLimitConfig new_io_config;
@@ -26,6 +26,7 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 
 // TODO: separate IO utility(i.e. FileProvider, RateLimiter) from Encryption directory
 namespace Poco::Util
@@ -46,6 +47,22 @@ enum class LimiterType
     BG_READ = 4,
 };
 
+// IOClass is the scheduling class of the I/O requests of a limiter, e.g. a tenant or resource group
+// with a query priority. When the requests are throttled, the balance of the limiter is shared by the
+// classes with pending requests in proportion to their weights (start-time fair queuing), so a class
+// issuing a lot of I/O, such as a big ad-hoc scan, can not starve the latency-sensitive ones. The
+// background and foreground I/O are separated by different limiters, see IORateLimiter.
+struct IOClass
+{
+    static constexpr UInt64 DEFAULT_WEIGHT = 100;
+
+    String name;
+    UInt64 weight = DEFAULT_WEIGHT;
+};
+
+class WriteLimiter;
+using WriteLimiterPtr = std::shared_ptr<WriteLimiter>;
+
 // WriteLimiter is to control write rate (bytes per second).
 // Because of the storage engine is append-only, the amount of data written by the storage engine
 // is equal to the amount of data written to the disk by the operating system. So, WriteLimiter
@@ -66,6 +83,9 @@ class WriteLimiter
 public:
     WriteLimiter(Int64 rate_limit_per_sec_, LimiterType type_, UInt64 refill_period_ms_ = 100);
 
+    // A view of `parent_` whose requests are scheduled as `io_class_`. It has no balance of its own.
+    WriteLimiter(WriteLimiterPtr parent_, IOClass io_class_);
+
     virtual ~WriteLimiter();
 
     // `request()` is the main interface used by clients.
@@ -73,6 +93,9 @@ public:
     // and blocks until the request balance is satisfied.
     void request(Int64 bytes);
 
+    // The same as `request(bytes)`, but the request is scheduled as `req_class`.
+    void request(Int64 bytes, const IOClass & req_class);
+
     // just for test purpose
     inline UInt64 getTotalBytesThrough() const { return alloc_bytes; }
 
@@ -113,8 +136,16 @@ protected:
         Int64 bytes;
         std::condition_variable cv;
         bool granted;
+        // The virtual start and finish time of the request in its IOClass.
+        double start_tag = 0;
+        double finish_tag = 0;
     };
 
+    // Put `r` into `req_queue` ordered by the finish tags. The front request is being served and is not preempted.
+    void enqueueRequest(Request * r, const IOClass & req_class);
+    // Remove the front request, which is granted.
+    void popFrontRequest();
+
     UInt64 refill_period_ms;
     AtomicStopwatch refill_stop_watch;
 
@@ -128,16 +159,23 @@ protected:
     using RequestQueue = std::deque<Request *>;
     RequestQueue req_queue;
 
+    // The start tag of the last granted request. Reset when `req_queue` is empty.
+    double virtual_time = 0;
+    // The finish tag of the last enqueued request of each IOClass.
+    std::unordered_map<String, double> class_finish_tags;
+
     std::mutex request_mutex;
 
     LimiterType type;
 
+    // Not null if this is a view of another limiter for one IOClass.
+    const WriteLimiterPtr parent;
+    const IOClass io_class;
+
     Stopwatch stat_stop_watch;
     UInt64 alloc_bytes;
 };
 
-using WriteLimiterPtr = std::shared_ptr<WriteLimiter>;
-
 // ReadLimiter is to control read rate (bytes per second).
 // Because of the page cache, the amount of data read by the storage engine
 // is NOT equal to the amount of data read from the disk by the operating system.
@@ -162,6 +200,9 @@ public:
         Int64 get_io_stat_period_us = 2000,
         UInt64 refill_period_ms_ = 100);
 
+    // A view of `parent_` whose requests are scheduled as `io_class_`, see WriteLimiter.
+    ReadLimiter(const std::shared_ptr<ReadLimiter> & parent_, IOClass io_class_);
+
 #ifndef DBMS_PUBLIC_GTEST
 protected:
 #endif
@@ -202,6 +243,9 @@ public:
 
     WriteLimiterPtr getWriteLimiter();
     ReadLimiterPtr getReadLimiter();
+    // The limiters whose requests are scheduled as `io_class`. nullptr if the I/O is not limited.
+    WriteLimiterPtr getWriteLimiter(const IOClass & io_class);
+    ReadLimiterPtr getReadLimiter(const IOClass & io_class);
     void init(Poco::Util::AbstractConfiguration & config_);
     void updateConfig(Poco::Util::AbstractConfiguration & config_);
 
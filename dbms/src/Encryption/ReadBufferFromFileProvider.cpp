@@ -41,9 +41,21 @@ ReadBufferFromFileProvider::ReadBufferFromFileProvider(
     const ReadLimiterPtr & read_limiter,
     int flags,
     char * existing_memory,
+    size_t alignment,
+    bool use_io_uring)
+    : ReadBufferFromFileDescriptor(-1, buf_size, existing_memory, alignment)
+    , file(file_provider_->newRandomAccessFile(file_name_, encryption_path_, read_limiter, flags, use_io_uring))
+{
+    fd = file->getFd();
+}
+
+ReadBufferFromFileProvider::ReadBufferFromFileProvider(
+    RandomAccessFilePtr file_,
+    size_t buf_size,
+    char * existing_memory,
     size_t alignment)
     : ReadBufferFromFileDescriptor(-1, buf_size, existing_memory, alignment)
-    , file(file_provider_->newRandomAccessFile(file_name_, encryption_path_, read_limiter, flags))
+    , file(std::move(file_))
 {
     fd = file->getFd();
 }
@@ -90,6 +102,15 @@ bool ReadBufferFromFileProvider::nextImpl()
     return true;
 }
 
+bool ReadBufferFromFileProvider::getIOUringPrefetchRange(size_t begin, size_t end, IOUringPrefetchRange & range)
+{
+    auto * io_uring_file = file->getIOUringFile();
+    if (io_uring_file == nullptr || end <= begin)
+        return false;
+    range = IOUringPrefetchRange{io_uring_file, static_cast<off_t>(begin), end - begin};
+    return true;
+}
+
 off_t ReadBufferFromFileProvider::doSeekInFile(off_t offset, int whence)
 {
     return file->seek(offset, whence);
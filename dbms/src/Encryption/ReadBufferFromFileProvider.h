@@ -41,6 +41,14 @@ public:
         const ReadLimiterPtr & read_limiter = nullptr,
         int flags = -1,
         char * existing_memory = nullptr,
+        size_t alignment = 0,
+        bool use_io_uring = false);
+
+    /// Read from an opened `file_`, e.g. a file shared with other buffers.
+    explicit ReadBufferFromFileProvider(
+        RandomAccessFilePtr file_,
+        size_t buf_size = DBMS_DEFAULT_BUFFER_SIZE,
+        char * existing_memory = nullptr,
         size_t alignment = 0);
 
     ReadBufferFromFileProvider(ReadBufferFromFileProvider &&) = default;
@@ -53,6 +61,14 @@ public:
 
     int getFD() const override { return file->getFd(); }
 
+    bool getIOUringPrefetchRange(size_t begin, size_t end, IOUringPrefetchRange & range) override;
+
+    void readAhead(size_t begin, size_t end) override
+    {
+        if (end > begin)
+            file->readAhead(begin, end - begin);
+    }
+
 private:
     off_t doSeekInFile(off_t offset, int whence) override;
 
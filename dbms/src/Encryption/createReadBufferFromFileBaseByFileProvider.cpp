@@ -20,14 +20,10 @@
 #endif
 #include <Common/ProfileEvents.h>
 #include <IO/ChecksumBuffer.h>
+#include <fcntl.h>
 
 namespace DB
 {
-namespace ErrorCodes
-{
-extern const int NOT_IMPLEMENTED;
-}
-
 std::unique_ptr<ReadBufferFromFileBase> createReadBufferFromFileBaseByFileProvider(
     FileProviderPtr & file_provider,
     const std::string & filename_,
@@ -38,7 +34,8 @@ std::unique_ptr<ReadBufferFromFileBase> createReadBufferFromFileBaseByFileProvid
     size_t buffer_size_,
     int flags_,
     char * existing_memory_,
-    size_t alignment)
+    size_t alignment,
+    bool use_io_uring)
 {
     if ((aio_threshold == 0) || (estimated_size < aio_threshold))
     {
@@ -50,12 +47,22 @@ std::unique_ptr<ReadBufferFromFileBase> createReadBufferFromFileBaseByFileProvid
             read_limiter,
             flags_,
             existing_memory_,
-            alignment);
+            alignment,
+            use_io_uring);
     }
     else
     {
-        // TODO: support encryption when AIO enabled
-        throw Exception("AIO is not implemented when create file using FileProvider", ErrorCodes::NOT_IMPLEMENTED);
+        // Bypass the page cache by O_DIRECT, see `DirectIORandomAccessFile`. io_uring is only used for buffered reads.
+        return std::make_unique<ReadBufferFromFileProvider>(
+            file_provider,
+            filename_,
+            encryption_path_,
+            buffer_size_,
+            read_limiter,
+            (flags_ == -1 ? O_RDONLY : flags_) | O_DIRECT,
+            existing_memory_,
+            alignment,
+            /*use_io_uring*/ false);
     }
 }
 
@@ -68,9 +75,26 @@ createReadBufferFromFileBaseByFileProvider(
     const ReadLimiterPtr & read_limiter,
     ChecksumAlgo checksum_algorithm,
     size_t checksum_frame_size,
-    int flags_)
+    int flags_,
+    bool use_io_uring,
+    bool use_direct_io)
+{
+    if (use_direct_io)
+    {
+        flags_ = (flags_ == -1 ? O_RDONLY : flags_) | O_DIRECT;
+        use_io_uring = false;
+    }
+    auto file = file_provider->newRandomAccessFile(filename_, encryption_path_, read_limiter, flags_, use_io_uring);
+    return createReadBufferFromFileBaseByFileProvider(file, estimated_size, checksum_algorithm, checksum_frame_size);
+}
+
+std::unique_ptr<ReadBufferFromFileBase>
+createReadBufferFromFileBaseByFileProvider(
+    const RandomAccessFilePtr & file,
+    size_t estimated_size,
+    ChecksumAlgo checksum_algorithm,
+    size_t checksum_frame_size)
 {
-    auto file = file_provider->newRandomAccessFile(filename_, encryption_path_, read_limiter, flags_);
     auto allocation_size = std::min(estimated_size, checksum_frame_size);
     switch (checksum_algorithm)
     {
@@ -84,6 +108,8 @@ createReadBufferFromFileBaseByFileProvider(
         return std::make_unique<FramedChecksumReadBuffer<Digest::City128>>(file, allocation_size);
     case ChecksumAlgo::XXH3:
         return std::make_unique<FramedChecksumReadBuffer<Digest::XXH3>>(file, allocation_size);
+    case ChecksumAlgo::CRC32C:
+        return std::make_unique<FramedChecksumReadBuffer<Digest::CRC32C>>(file, allocation_size);
     }
     throw Exception("error creating framed checksum buffer instance: checksum unrecognized");
 }
@@ -26,12 +26,10 @@ namespace DB
 {
 /** Create an object to read data from a file.
   * estimated_size - the number of bytes to read
-  * aio_threshold - the minimum number of bytes for asynchronous reads
+  * aio_threshold - the minimum number of bytes for bypassing the page cache
   *
-  * Caution: (AIO is not supported yet.)
-  *
-  * If aio_threshold = 0 or estimated_size < aio_threshold, read operations are executed synchronously.
-  * Otherwise, the read operations are performed asynchronously.
+  * If aio_threshold = 0 or estimated_size < aio_threshold, read operations go through the page cache.
+  * Otherwise, the file is read by O_DIRECT, see `DirectIORandomAccessFile`.
   */
 
 std::unique_ptr<ReadBufferFromFileBase>
@@ -45,7 +43,8 @@ createReadBufferFromFileBaseByFileProvider(
     size_t buffer_size_ = DBMS_DEFAULT_BUFFER_SIZE,
     int flags_ = -1,
     char * existing_memory_ = nullptr,
-    size_t alignment = 0);
+    size_t alignment = 0,
+    bool use_io_uring = false);
 
 /// @attention: estimated_size should be at least DBMS_DEFAULT_BUFFER_SIZE if one want to do seeking; however, if one knows that target file
 /// only consists of a single small frame, one can use a smaller estimated_size to reduce memory footprint.
@@ -58,5 +57,15 @@ createReadBufferFromFileBaseByFileProvider(
     const ReadLimiterPtr & read_limiter,
     ChecksumAlgo checksum_algorithm,
     size_t checksum_frame_size,
-    int flags_ = -1);
+    int flags_ = -1,
+    bool use_io_uring = false,
+    bool use_direct_io = false);
+
+/// The same as above, but reads the checksum framed data from an opened `file`.
+std::unique_ptr<ReadBufferFromFileBase>
+createReadBufferFromFileBaseByFileProvider(
+    const RandomAccessFilePtr & file,
+    size_t estimated_size,
+    ChecksumAlgo checksum_algorithm,
+    size_t checksum_frame_size);
 } // namespace DB
@@ -89,6 +89,8 @@ createWriteBufferFromFileBaseByFileProvider(
         return std::make_unique<FramedChecksumWriteBuffer<Digest::City128>>(file_ptr, checksum_frame_size);
     case ChecksumAlgo::XXH3:
         return std::make_unique<FramedChecksumWriteBuffer<Digest::XXH3>>(file_ptr, checksum_frame_size);
+    case ChecksumAlgo::CRC32C:
+        return std::make_unique<FramedChecksumWriteBuffer<Digest::CRC32C>>(file_ptr, checksum_frame_size);
     }
     throw Exception("error creating framed checksum buffer instance: checksum unrecognized");
 }
@@ -0,0 +1,131 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Encryption/DirectIORandomAccessFile.h>
+#include <Encryption/FileProvider.h>
+#include <Encryption/MockKeyManager.h>
+#include <Encryption/ReadBufferFromFileProvider.h>
+#include <IO/ChecksumBuffer.h>
+#include <IO/WriteHelpers.h>
+#include <TestUtils/TiFlashTestBasic.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+class DirectIOTest : public testing::TestWithParam<bool>
+{
+public:
+    void SetUp() override
+    {
+        const bool encryption_enabled = GetParam();
+        file_provider = std::make_shared<FileProvider>(std::make_shared<MockKeyManager>(encryption_enabled), encryption_enabled);
+    }
+
+    String writeFile(const String & name, size_t size, std::vector<char> & data)
+    {
+        String file_path = TiFlashTestEnv::getTemporaryPath(name);
+        data.resize(size);
+        std::mt19937 generator(size);
+        for (auto & c : data)
+            c = static_cast<char>(generator());
+        auto file = file_provider->newWriteReadableFile(file_path, EncryptionPath(file_path, ""));
+        EXPECT_EQ(static_cast<ssize_t>(size), file->pwrite(data.data(), size, 0));
+        file->close();
+        return file_path;
+    }
+
+protected:
+    FileProviderPtr file_provider;
+};
+
+TEST_P(DirectIOTest, UnalignedRead)
+try
+{
+    std::vector<char> expected;
+    // Not a multiple of the alignment, and larger than the window.
+    const size_t file_size = 3 * DirectIORandomAccessFile::DEFAULT_WINDOW_SIZE + 12345;
+    auto file_path = writeFile("direct_io_file", file_size, expected);
+    auto file = file_provider->newRandomAccessFile(file_path, EncryptionPath(file_path, ""), nullptr, O_RDONLY | O_DIRECT);
+
+    // Random reads at unaligned offsets.
+    std::mt19937 generator(0);
+    std::vector<char> buf(2 * DirectIORandomAccessFile::DEFAULT_WINDOW_SIZE);
+    for (size_t i = 0; i < 100; ++i)
+    {
+        size_t offset = generator() % file_size;
+        size_t size = std::min(generator() % buf.size() + 1, file_size - offset);
+        ASSERT_EQ(static_cast<ssize_t>(size), file->pread(buf.data(), size, offset));
+        ASSERT_EQ(0, memcmp(buf.data(), expected.data() + offset, size)) << fmt::format("offset={} size={}", offset, size);
+    }
+
+    // Sequential reads from an unaligned offset to the end of file.
+    ASSERT_EQ(7, file->seek(7, SEEK_SET));
+    size_t offset = 7;
+    while (offset < file_size)
+    {
+        auto n = file->read(buf.data(), 100000);
+        ASSERT_GT(n, 0);
+        ASSERT_EQ(0, memcmp(buf.data(), expected.data() + offset, n));
+        offset += n;
+    }
+    ASSERT_EQ(0, file->read(buf.data(), 100000));
+
+    // Large aligned reads go to the caller's memory directly.
+    Memory<> aligned_buf(2 * DirectIORandomAccessFile::DEFAULT_WINDOW_SIZE, DirectIORandomAccessFile::ALIGNMENT);
+    ASSERT_EQ(static_cast<ssize_t>(aligned_buf.size()), file->pread(aligned_buf.data(), aligned_buf.size(), DirectIORandomAccessFile::ALIGNMENT));
+    ASSERT_EQ(0, memcmp(aligned_buf.data(), expected.data() + DirectIORandomAccessFile::ALIGNMENT, aligned_buf.size()));
+
+    // Read across the end of file.
+    ASSERT_EQ(45, file->pread(buf.data(), 100, file_size - 45));
+    ASSERT_EQ(0, memcmp(buf.data(), expected.data() + file_size - 45, 45));
+}
+CATCH
+
+TEST_P(DirectIOTest, ChecksumFramedRead)
+try
+{
+    // The frames of the checksum framed file are not aligned.
+    String file_path = TiFlashTestEnv::getTemporaryPath("direct_io_checksum_file");
+    constexpr size_t frame_size = 1000;
+    constexpr size_t num_values = 100000;
+    {
+        auto file = file_provider->newWritableFile(file_path, EncryptionPath(file_path, ""), true, true);
+        FramedChecksumWriteBuffer<Digest::CRC64> buf(file, frame_size);
+        for (UInt64 i = 0; i < num_values; ++i)
+            writeIntBinary(i, buf);
+    }
+
+    auto file = file_provider->newRandomAccessFile(file_path, EncryptionPath(file_path, ""), nullptr, O_RDONLY | O_DIRECT);
+    FramedChecksumReadBuffer<Digest::CRC64> buf(file, frame_size);
+    buf.seek(sizeof(UInt64) * 1234, SEEK_SET);
+    for (UInt64 i = 1234; i < num_values; ++i)
+    {
+        UInt64 v = 0;
+        readIntBinary(v, buf);
+        ASSERT_EQ(v, i);
+    }
+    ASSERT_TRUE(buf.eof());
+}
+CATCH
+
+INSTANTIATE_TEST_CASE_P(Encryption, DirectIOTest, testing::Bool());
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,169 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Encryption/FileProvider.h>
+#include <Encryption/IOUring.h>
+#include <Encryption/IOUringRandomAccessFile.h>
+#include <Encryption/MockKeyManager.h>
+#include <Encryption/RateLimiter.h>
+#include <TestUtils/TiFlashTestBasic.h>
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+const unsigned char IO_URING_TEST_KEY[33] = "\xe4\x3e\x8e\xca\x2a\x83\xe1\x88\xfb\xd8\x02\xdc\xf3\x62\x65\x3e"
+                                            "\x00\xee\x31\x39\xe7\xfd\x1d\x92\x20\xb1\x62\xae\xb2\xaf\x0f\x1a";
+const unsigned char IO_URING_TEST_IV[17] = "\x77\x9b\x82\x72\x26\xb5\x76\x50\xf7\x05\xd2\xd6\xb8\xaa\xa9\x2c";
+
+class CountingReadLimiter : public ReadLimiter
+{
+public:
+    CountingReadLimiter()
+        : ReadLimiter([]() { return 0; }, 1024 * 1024 * 1024, LimiterType::UNKNOW)
+    {}
+
+    Int64 requested_bytes = 0;
+
+protected:
+    void consumeBytes(Int64 bytes) override
+    {
+        requested_bytes += bytes;
+        ReadLimiter::consumeBytes(bytes);
+    }
+};
+} // namespace
+
+class IOUringTest : public testing::TestWithParam<bool>
+{
+public:
+    void SetUp() override
+    {
+        const bool encryption_enabled = GetParam();
+        KeyManagerPtr key_manager;
+        if (encryption_enabled)
+        {
+            std::string key_str(reinterpret_cast<const char *>(IO_URING_TEST_KEY), KeySize(EncryptionMethod::Aes128Ctr));
+            std::string iv_str(reinterpret_cast<const char *>(IO_URING_TEST_IV), 16);
+            key_manager = std::make_shared<MockKeyManager>(EncryptionMethod::Aes128Ctr, key_str, iv_str);
+        }
+        else
+        {
+            key_manager = std::make_shared<MockKeyManager>(false);
+        }
+        file_provider = std::make_shared<FileProvider>(key_manager, encryption_enabled);
+    }
+
+    String writeFile(const String & name, size_t size, std::vector<char> & data)
+    {
+        String file_path = TiFlashTestEnv::getTemporaryPath(name);
+        data.resize(size);
+        std::mt19937 generator(size);
+        for (auto & c : data)
+            c = static_cast<char>(generator());
+        auto file = file_provider->newWriteReadableFile(file_path, EncryptionPath(file_path, ""));
+        EXPECT_EQ(static_cast<ssize_t>(size), file->pwrite(data.data(), size, 0));
+        file->close();
+        return file_path;
+    }
+
+protected:
+    FileProviderPtr file_provider;
+};
+
+TEST_P(IOUringTest, PrefetchAndRead)
+try
+{
+    if (!IOUring::isSupported())
+        return;
+
+    constexpr size_t num_files = 4;
+    std::vector<std::vector<char>> data(num_files);
+    std::vector<RandomAccessFilePtr> files;
+    std::vector<IOUringPrefetchRange> ranges;
+    for (size_t i = 0; i < num_files; ++i)
+    {
+        auto file_path = writeFile(fmt::format("io_uring_file_{}", i), 100000 + i * 4096 + 7, data[i]);
+        auto file = file_provider->newRandomAccessFile(file_path, EncryptionPath(file_path, ""), nullptr, -1, /*use_io_uring*/ true);
+        ASSERT_NE(file->getIOUringFile(), nullptr);
+        // The last range exceeds the end of file.
+        ranges.push_back(IOUringPrefetchRange{file->getIOUringFile(), static_cast<off_t>(i * 1000), i == num_files - 1 ? data[i].size() : 50000});
+        files.push_back(file);
+    }
+    IOUringRandomAccessFile::prefetch(ranges);
+
+    for (size_t i = 0; i < num_files; ++i)
+    {
+        auto & file = files[i];
+        const auto & expected = data[i];
+        ASSERT_TRUE(file->getIOUringFile()->hasPrefetched(i * 1000, 100));
+
+        // Read inside the prefetched range.
+        std::vector<char> buf(10000);
+        ASSERT_EQ(10000, file->pread(buf.data(), 10000, i * 1000 + 123));
+        ASSERT_EQ(0, memcmp(buf.data(), expected.data() + i * 1000 + 123, 10000));
+
+        // Sequential read across the end of the prefetched range.
+        ASSERT_EQ(static_cast<off_t>(i * 1000), file->seek(i * 1000, SEEK_SET));
+        size_t offset = i * 1000;
+        while (offset < expected.size())
+        {
+            auto n = file->read(buf.data(), buf.size());
+            ASSERT_GT(n, 0);
+            ASSERT_EQ(0, memcmp(buf.data(), expected.data() + offset, n));
+            offset += n;
+        }
+        ASSERT_EQ(0, file->read(buf.data(), buf.size()));
+
+        // Read outside the prefetched range.
+        ASSERT_EQ(100, file->pread(buf.data(), 100, 0));
+        ASSERT_EQ(0, memcmp(buf.data(), expected.data(), 100));
+    }
+}
+CATCH
+
+TEST_P(IOUringTest, PrefetchChargeReadLimiter)
+try
+{
+    if (!IOUring::isSupported())
+        return;
+
+    std::vector<char> data;
+    auto file_path = writeFile("io_uring_limiter_file", 8192, data);
+    auto read_limiter = std::make_shared<CountingReadLimiter>();
+    auto file = file_provider->newRandomAccessFile(file_path, EncryptionPath(file_path, ""), read_limiter, -1, /*use_io_uring*/ true);
+    IOUringRandomAccessFile::prefetch({IOUringPrefetchRange{file->getIOUringFile(), 0, 4096}});
+    ASSERT_EQ(read_limiter->requested_bytes, 4096);
+
+    // Served by the prefetched data, not charged again.
+    std::vector<char> buf(4096);
+    ASSERT_EQ(4096, file->pread(buf.data(), 4096, 0));
+    ASSERT_EQ(read_limiter->requested_bytes, 4096);
+    ASSERT_EQ(0, memcmp(buf.data(), data.data(), 4096));
+
+    ASSERT_EQ(4096, file->pread(buf.data(), 4096, 4096));
+    ASSERT_EQ(read_limiter->requested_bytes, 8192);
+    ASSERT_EQ(0, memcmp(buf.data(), data.data() + 4096, 4096));
+}
+CATCH
+
+INSTANTIATE_TEST_CASE_P(Encryption, IOUringTest, testing::Bool());
+
+} // namespace tests
+} // namespace DB
@@ -268,6 +268,44 @@ TEST(WriteLimiterTest, setStop)
     }
 }
 
+TEST(WriteLimiterTest, IOClassWeights)
+{
+    // 100KB/s, so the requests of the 8 threads below are always throttled.
+    WriteLimiter limiter(100 * 1024, LimiterType::UNKNOW, 100);
+    auto light = std::make_shared<WriteLimiter>(std::shared_ptr<WriteLimiter>(&limiter, [](WriteLimiter *) {}), IOClass{"light", 100});
+    auto heavy = std::make_shared<WriteLimiter>(std::shared_ptr<WriteLimiter>(&limiter, [](WriteLimiter *) {}), IOClass{"heavy", 300});
+
+    constexpr Int64 request_bytes = 4096;
+    std::atomic<bool> stop{false};
+    std::atomic<Int64> light_bytes{0};
+    std::atomic<Int64> heavy_bytes{0};
+    auto worker = [&](const WriteLimiterPtr & class_limiter, std::atomic<Int64> & granted_bytes) {
+        while (!stop)
+        {
+            class_limiter->request(request_bytes);
+            if (!stop)
+                granted_bytes += request_bytes;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back(worker, light, std::ref(light_bytes));
+        threads.emplace_back(worker, heavy, std::ref(heavy_bytes));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    stop = true;
+    limiter.setStop();
+    for (auto & t : threads)
+        t.join();
+
+    ASSERT_GT(light_bytes, 0);
+    double ratio = static_cast<double>(heavy_bytes) / light_bytes;
+    ASSERT_GE(ratio, 2.0) << "light_bytes=" << light_bytes << " heavy_bytes=" << heavy_bytes;
+    ASSERT_LE(ratio, 4.5) << "light_bytes=" << light_bytes << " heavy_bytes=" << heavy_bytes;
+}
+
 TEST(ReadLimiterTest, LimiterStat)
 {
     Int64 consumed = 0;
@@ -16,6 +16,8 @@
 #include <Core/ColumnNumbers.h>
 #include <Flash/Coprocessor/AggregationInterpreterHelper.h>
 #include <Flash/Coprocessor/DAGContext.h>
+#include <Flash/Coprocessor/DAGUtils.h>
+#include <Flash/Coprocessor/InterpreterUtils.h>
 #include <Interpreters/Context.h>
 
 namespace DB::AggregationInterpreterHelper
@@ -56,6 +58,42 @@ bool isFinalAgg(const tipb::Aggregation & aggregation)
     return is_final_agg;
 }
 
+bool isRowCountOnly(const tipb::Aggregation & aggregation)
+{
+    if (aggregation.group_by_size() > 0 || aggregation.agg_func_size() == 0)
+        return false;
+    for (const auto & agg_func : aggregation.agg_func())
+    {
+        if (agg_func.tp() != tipb::ExprType::Count)
+            return false;
+        /// The constant arguments do not depend on the values of the input.
+        for (const auto & child : agg_func.children())
+        {
+            if (!isLiteralExpr(child))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool isSortedByKeys(const Names & sort_column_names, const Names & key_names, const TiDB::TiDBCollators & collators)
+{
+    if (key_names.empty() || key_names.size() > sort_column_names.size())
+        return false;
+    for (const auto & collator : collators)
+    {
+        if (collator != nullptr)
+            return false;
+    }
+    /// The order of the keys does not matter, the group is the same.
+    for (size_t i = 0; i < key_names.size(); ++i)
+    {
+        if (std::find(key_names.begin(), key_names.end(), sort_column_names[i]) == key_names.end())
+            return false;
+    }
+    return true;
+}
+
 bool isGroupByCollationSensitive(const Context & context)
 {
     // todo now we can tell if the aggregation is final stage or partial stage,
@@ -97,10 +135,24 @@ Aggregator::Params buildParams(
         allow_to_use_two_level_group_by ? settings.group_by_two_level_threshold_bytes : SettingUInt64(0),
         settings.max_bytes_before_external_group_by,
         !is_final_agg,
-        context.getTemporaryPath(),
+        getSpillPath(context),
         has_collator ? collators : TiDB::dummy_collators);
 }
 
+void setReserveKeysHint(const Context & context, Aggregator::Params & params, size_t total_rows_approx, size_t concurrency)
+{
+    const Settings & settings = context.getSettingsRef();
+    if (settings.hash_table_reserve_max_rows == 0 || params.keys_size == 0)
+        return;
+
+    /// Every stream aggregates into a hash table of its own, and the number of keys is at most the number of rows.
+    size_t hint = std::min(total_rows_approx / std::max<size_t>(concurrency, 1), static_cast<size_t>(settings.hash_table_reserve_max_rows));
+    /// Beyond the threshold the data is converted to two-level, the reserved single-level table is useless then.
+    if (params.group_by_two_level_threshold > 0)
+        hint = std::min(hint, params.group_by_two_level_threshold);
+    params.reserve_keys_hint = hint;
+}
+
 void fillArgColumnNumbers(AggregateDescriptions & aggregate_descriptions, const Block & before_agg_header)
 {
     for (auto & descr : aggregate_descriptions)
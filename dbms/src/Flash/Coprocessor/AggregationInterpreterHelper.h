@@ -30,6 +30,13 @@ bool isFinalAgg(const tipb::Aggregation & aggregation);
 
 bool isGroupByCollationSensitive(const Context & context);
 
+/// Whether the aggregation only depends on the row count of its input, such as `count(*)` or `count(1)` without group by.
+bool isRowCountOnly(const tipb::Aggregation & aggregation);
+
+/// Whether the rows of every group are consecutive in the input sorted by `sort_column_names`, that is the keys
+/// are a prefix of the sort columns and compared without collators, so the aggregation can be done by streaming.
+bool isSortedByKeys(const Names & sort_column_names, const Names & key_names, const TiDB::TiDBCollators & collators);
+
 Aggregator::Params buildParams(
     const Context & context,
     const Block & before_agg_header,
@@ -39,6 +46,9 @@ Aggregator::Params buildParams(
     const AggregateDescriptions & aggregate_descriptions,
     bool is_final_agg);
 
+/// Let the aggregator reserve its hash tables from the `total_rows_approx` rows read by `concurrency` streams, see `Settings::hash_table_reserve_max_rows`.
+void setReserveKeysHint(const Context & context, Aggregator::Params & params, size_t total_rows_approx, size_t concurrency);
+
 void fillArgColumnNumbers(AggregateDescriptions & aggregate_descriptions, const Block & before_agg_header);
 } // namespace AggregationInterpreterHelper
 } // namespace DB
\ No newline at end of file
@@ -45,6 +45,17 @@ const IColumn * getNestedCol(const IColumn * flash_col)
         return flash_col;
 }
 
+template <bool is_nullable>
+const NullMap * getNullMap(const IColumn * flash_col)
+{
+    if constexpr (is_nullable)
+    {
+        if (flash_col->isColumnNullable())
+            return &static_cast<const ColumnNullable *>(flash_col)->getNullMapData();
+    }
+    return nullptr;
+}
+
 template <typename T>
 void decimalToVector(T value, std::vector<Int32> & vec, UInt32 scale)
 {
@@ -122,22 +133,7 @@ bool flashIntegerColToArrowColInternal(TiDBColumn & dag_column, const IColumn *
     const IColumn * nested_col = getNestedCol(flash_col_untyped);
     if (const auto * flash_col = checkAndGetColumn<ColumnVector<T>>(nested_col))
     {
-        constexpr bool is_unsigned = std::is_unsigned_v<T>;
-        for (size_t i = start_index; i < end_index; i++)
-        {
-            if constexpr (is_nullable)
-            {
-                if (flash_col_untyped->isNullAt(i))
-                {
-                    dag_column.appendNull();
-                    continue;
-                }
-            }
-            if constexpr (is_unsigned)
-                dag_column.append(static_cast<UInt64>(flash_col->getElement(i)));
-            else
-                dag_column.append(static_cast<UInt64>(flash_col->getElement(i)));
-        }
+        dag_column.appendFixedBulk(flash_col->getData(), getNullMap<is_nullable>(flash_col_untyped), start_index, end_index);
         return true;
     }
     return false;
@@ -149,18 +145,7 @@ void flashDoubleColToArrowCol(TiDBColumn & dag_column, const IColumn * flash_col
     const IColumn * nested_col = getNestedCol(flash_col_untyped);
     if (const auto * flash_col = checkAndGetColumn<ColumnVector<T>>(nested_col))
     {
-        for (size_t i = start_index; i < end_index; i++)
-        {
-            if constexpr (is_nullable)
-            {
-                if (flash_col_untyped->isNullAt(i))
-                {
-                    dag_column.appendNull();
-                    continue;
-                }
-            }
-            dag_column.append(static_cast<T>(flash_col->getElement(i)));
-        }
+        dag_column.appendFixedBulk(flash_col->getData(), getNullMap<is_nullable>(flash_col_untyped), start_index, end_index);
         return;
     }
     throw TiFlashException(
@@ -217,19 +202,7 @@ void flashStringColToArrowCol(TiDBColumn & dag_column, const IColumn * flash_col
     const IColumn * nested_col = getNestedCol(flash_col_untyped);
     // columnFixedString is not used so do not check it
     const auto * flash_col = checkAndGetColumn<ColumnString>(nested_col);
-    for (size_t i = start_index; i < end_index; i++)
-    {
-        // todo check if we can convert flash_col to DAG col directly since the internal representation is almost the same
-        if constexpr (is_nullable)
-        {
-            if (flash_col_untyped->isNullAt(i))
-            {
-                dag_column.appendNull();
-                continue;
-            }
-        }
-        dag_column.append(flash_col->getDataAt(i));
-    }
+    dag_column.appendStringBulk(*flash_col, getNullMap<is_nullable>(flash_col_untyped), start_index, end_index);
 }
 
 template <bool is_nullable>
@@ -17,10 +17,22 @@
 #include <DataStreams/NativeBlockInputStream.h>
 #include <Flash/Coprocessor/CHBlockChunkCodec.h>
 #include <Flash/Coprocessor/DAGUtils.h>
+#include <IO/CompressedReadBuffer.h>
+#include <IO/CompressedWriteBuffer.h>
+#include <IO/ReadBufferFromMemory.h>
 #include <IO/ReadBufferFromString.h>
+#include <IO/copyData.h>
 
 namespace DB
 {
+namespace
+{
+/// A compressed chunk is `compressed_chunk_magic` followed by the frames written by CompressedWriteBuffer.
+/// An uncompressed chunk never starts with it, since writeVarUInt never writes `columns` as a redundant zero byte.
+constexpr char compressed_chunk_magic[] = {'\x80', '\x00'};
+constexpr size_t compressed_chunk_magic_size = sizeof(compressed_chunk_magic);
+} // namespace
+
 class CHBlockChunkCodecStream : public ChunkCodecStream
 {
 public:
@@ -120,8 +132,43 @@ std::unique_ptr<ChunkCodecStream> CHBlockChunkCodec::newCodecStream(const std::v
     return std::make_unique<CHBlockChunkCodecStream>(field_types);
 }
 
+bool CHBlockChunkCodec::isCompressed(const String & chunk)
+{
+    return chunk.size() > compressed_chunk_magic_size && memcmp(chunk.data(), compressed_chunk_magic, compressed_chunk_magic_size) == 0;
+}
+
+String CHBlockChunkCodec::compress(const String & chunk, CompressionMethod method)
+{
+    if (chunk.empty())
+        return chunk;
+
+    WriteBufferFromOwnString out;
+    out.write(compressed_chunk_magic, compressed_chunk_magic_size);
+    {
+        CompressedWriteBuffer<> compressed_out(out, CompressionSettings(method), std::min(chunk.size(), static_cast<size_t>(DBMS_DEFAULT_BUFFER_SIZE)));
+        compressed_out.write(chunk.data(), chunk.size());
+        compressed_out.next();
+    }
+    if (out.count() >= chunk.size())
+        return chunk;
+    return out.releaseStr();
+}
+
+String CHBlockChunkCodec::decompress(const String & chunk)
+{
+    assert(isCompressed(chunk));
+    ReadBufferFromMemory compressed_in(chunk.data() + compressed_chunk_magic_size, chunk.size() - compressed_chunk_magic_size);
+    CompressedReadBuffer<> in(compressed_in);
+    WriteBufferFromOwnString out;
+    copyData(in, out);
+    return out.releaseStr();
+}
+
 Block CHBlockChunkCodec::decode(const String & str, const DAGSchema & schema)
 {
+    if (isCompressed(str))
+        return decode(decompress(str), schema);
+
     ReadBufferFromString read_buffer(str);
     std::vector<String> output_names;
     for (const auto & c : schema)
@@ -132,6 +179,9 @@ Block CHBlockChunkCodec::decode(const String & str, const DAGSchema & schema)
 
 Block CHBlockChunkCodec::decode(const String & str, const Block & header)
 {
+    if (isCompressed(str))
+        return decode(decompress(str), header);
+
     ReadBufferFromString read_buffer(str);
     NativeBlockInputStream block_in(read_buffer, header, 0, /*align_column_name_with_header=*/true);
     return block_in.read();
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <Flash/Coprocessor/ChunkCodec.h>
+#include <IO/CompressedStream.h>
 
 namespace DB
 {
@@ -25,6 +26,12 @@ public:
     Block decode(const String &, const DAGSchema & schema) override;
     static Block decode(const String &, const Block & header);
     std::unique_ptr<ChunkCodecStream> newCodecStream(const std::vector<tipb::FieldType> & field_types) override;
+
+    /// Compress an encoded chunk for the exchange between TiFlash nodes. Return `chunk` itself if
+    /// the compressed one is not smaller. Both `decode` accept the compressed chunks transparently.
+    static String compress(const String & chunk, CompressionMethod method);
+    static bool isCompressed(const String & chunk);
+    static String decompress(const String & chunk);
 };
 
 } // namespace DB
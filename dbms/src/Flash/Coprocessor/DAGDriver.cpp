@@ -64,6 +64,19 @@ DAGDriver<false>::DAGDriver(
     context.getTimezoneInfo().resetByDAGRequest(dagRequest());
 }
 
+template <>
+DAGDriver<false>::DAGDriver(
+    Context & context_,
+    UInt64 start_ts,
+    UInt64 schema_ver,
+    tipb::SelectResponse * dag_response_,
+    ::grpc::ServerWriter<::coprocessor::Response> * cop_writer_,
+    bool internal_)
+    : DAGDriver(context_, start_ts, schema_ver, dag_response_, internal_)
+{
+    cop_writer = cop_writer_;
+}
+
 template <>
 DAGDriver<true>::DAGDriver(
     Context & context_,
@@ -105,10 +118,31 @@ try
     BlockOutputStreamPtr dag_output_stream = nullptr;
     if constexpr (!batch)
     {
-        std::unique_ptr<DAGResponseWriter> response_writer = std::make_unique<UnaryDAGResponseWriter>(
-            dag_response,
-            context.getSettingsRef().dag_records_per_chunk,
-            dag_context);
+        std::unique_ptr<DAGResponseWriter> response_writer;
+        if (cop_writer)
+        {
+            // Send the chunks as soon as they are encoded, so that the memory of the response is bounded
+            // by `batch_send_min_limit` instead of the size of the region.
+            TiDB::TiDBCollators collators;
+            response_writer = std::make_unique<StreamingDAGResponseWriter<StreamWriterPtr, false>>(
+                std::make_shared<StreamWriter>(cop_writer),
+                std::vector<Int64>(),
+                collators,
+                tipb::ExchangeType::PassThrough,
+                context.getSettingsRef().dag_records_per_chunk,
+                context.getSettingsRef().batch_send_min_limit,
+                true,
+                dag_context,
+                /*fine_grained_shuffle_stream_count=*/0,
+                /*fine_grained_shuffle_batch_size=*/0);
+        }
+        else
+        {
+            response_writer = std::make_unique<UnaryDAGResponseWriter>(
+                dag_response,
+                context.getSettingsRef().dag_records_per_chunk,
+                dag_context);
+        }
         dag_output_stream = std::make_shared<DAGBlockOutputStream>(streams.in->getHeader(), std::move(response_writer));
         copyData(*streams.in, *dag_output_stream);
     }
@@ -140,7 +174,9 @@ try
             true,
             dag_context,
             /*fine_grained_shuffle_stream_count=*/0,
-            /*fine_grained_shuffle_batch_size=*/0);
+            /*fine_grained_shuffle_batch_size=*/0,
+            context.getSettingsRef().batch_cop_batch_bytes,
+            context.getSettingsRef().batch_cop_batch_max_delay_ms);
         dag_output_stream = std::make_shared<DAGBlockOutputStream>(streams.in->getHeader(), std::move(response_writer));
         copyData(*streams.in, *dag_output_stream);
     }
@@ -176,7 +212,8 @@ try
         {
             // Under some test cases, there may be dag response whose size is bigger than INT_MAX, and GRPC can not limit it.
             // Throw exception to prevent receiver from getting wrong response.
-            if (accurate::greaterOp(p_stream->getProfileInfo().bytes, std::numeric_limits<int>::max()))
+            // The streamed response is sent by chunks, so it is not limited.
+            if (!cop_writer && accurate::greaterOp(p_stream->getProfileInfo().bytes, std::numeric_limits<int>::max()))
                 throw TiFlashException("DAG response is too big, please check config about region size or region merge scheduler",
                                        Errors::Coprocessor::Internal);
         }
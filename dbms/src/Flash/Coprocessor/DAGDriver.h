@@ -50,6 +50,16 @@ public:
         tipb::SelectResponse * dag_response_,
         bool internal_ = false);
 
+    /// Stream the chunks of a non-batch request by `cop_writer_` instead of collecting them into one response,
+    /// only the error is recorded in `dag_response_`.
+    DAGDriver(
+        Context & context_,
+        UInt64 start_ts,
+        UInt64 schema_ver,
+        tipb::SelectResponse * dag_response_,
+        ::grpc::ServerWriter<::coprocessor::Response> * cop_writer_,
+        bool internal_ = false);
+
     DAGDriver(
         Context & context_,
         UInt64 start_ts,
@@ -70,6 +80,8 @@ private:
 
     ::grpc::ServerWriter<::coprocessor::BatchResponse> * writer;
 
+    ::grpc::ServerWriter<::coprocessor::Response> * cop_writer = nullptr;
+
     bool internal;
 
     Poco::Logger * log;
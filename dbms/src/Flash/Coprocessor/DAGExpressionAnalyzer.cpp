@@ -14,6 +14,7 @@
 
 #include <AggregateFunctions/AggregateFunctionFactory.h>
 #include <AggregateFunctions/AggregateFunctionGroupConcat.h>
+#include <Columns/ColumnConst.h>
 #include <Columns/ColumnSet.h>
 #include <Common/FmtUtils.h>
 #include <Common/TiFlashException.h>
@@ -33,6 +34,7 @@
 #include <Interpreters/convertFieldToType.h>
 #include <Parsers/ASTIdentifier.h>
 #include <Storages/Transaction/TypeMapping.h>
+#include <WindowFunctions/WindowFunctionAggregate.h>
 #include <WindowFunctions/WindowFunctionFactory.h>
 
 namespace DB
@@ -408,6 +410,27 @@ std::tuple<Names, TiDB::TiDBCollators, AggregateDescriptions, ExpressionActionsP
     return {aggregation_keys, collators, aggregate_descriptions, before_agg};
 }
 
+/// The aggregate functions that can be evaluated over the sliding frames of a window.
+String getWindowAggFunctionName(const tipb::Expr & expr)
+{
+    if (!expr.has_distinct())
+    {
+        switch (expr.tp())
+        {
+        case tipb::ExprType::Count:
+        case tipb::ExprType::Sum:
+        case tipb::ExprType::Min:
+        case tipb::ExprType::Max:
+            return getAggFunctionName(expr);
+        case tipb::ExprType::Avg:
+            return "avg";
+        default:
+            break;
+        }
+    }
+    throw TiFlashException(fmt::format("Unsupported agg function {} in window.", tipb::ExprType_Name(expr.tp())), Errors::Coprocessor::BadRequest);
+}
+
 bool isWindowFunctionsValid(const tipb::Window & window)
 {
     bool has_agg_func = false;
@@ -468,7 +491,28 @@ std::tuple<WindowDescription, NamesAndTypes> DAGExpressionAnalyzer::appendWindow
     {
         if (isAggFunctionExpr(expr))
         {
-            throw TiFlashException("Unsupported agg function in window.", Errors::Coprocessor::BadRequest);
+            String agg_func_name = getWindowAggFunctionName(expr);
+            Names arg_names;
+            DataTypes arg_types;
+            TiDB::TiDBCollators arg_collators;
+            for (Int32 i = 0; i < expr.children_size(); ++i)
+            {
+                fillArgumentDetail(step.actions, expr.children(i), arg_names, arg_types, arg_collators);
+            }
+            step.required_output.insert(step.required_output.end(), arg_names.begin(), arg_names.end());
+
+            WindowFunctionDescription window_function_description;
+            window_function_description.argument_names = arg_names;
+            String func_string = genFuncString(agg_func_name, arg_names, arg_collators);
+            window_function_description.column_name = func_string;
+            // The frame can be empty, in which case the result is NULL except for count.
+            auto aggregate_function = AggregateFunctionFactory::instance().get(agg_func_name, arg_types, {}, 0, /*empty_input_as_null=*/true);
+            aggregate_function->setCollators(arg_collators);
+            window_function_description.window_function = std::make_shared<WindowFunctionAggregate>(agg_func_name, arg_types, aggregate_function);
+            DataTypePtr result_type = window_function_description.window_function->getReturnType();
+            window_description.window_functions_descriptions.push_back(window_function_description);
+            window_columns.emplace_back(func_string, result_type);
+            source_columns.emplace_back(func_string, result_type);
         }
         else if (isWindowFunctionExpr(expr))
         {
@@ -549,11 +593,66 @@ String DAGExpressionAnalyzer::applyFunction(
     if (actions->getSampleBlock().has(result_name))
         return result_name;
     const FunctionBuilderPtr & function_builder = FunctionFactory::instance().get(func_name, context);
+    if (tryFoldConstantFunction(function_builder, arg_names, result_name, actions, collator))
+        return result_name;
     const ExpressionAction & action = ExpressionAction::applyFunction(function_builder, arg_names, result_name, collator);
     actions->add(action);
     return result_name;
 }
 
+bool DAGExpressionAnalyzer::tryFoldConstantFunction(
+    const FunctionBuilderPtr & function_builder,
+    const Names & arg_names,
+    const String & result_name,
+    const ExpressionActionsPtr & actions,
+    const TiDB::TiDBCollatorPtr & collator)
+{
+    /// ExpressionActions only folds a function of constants when the function itself returns a constant column,
+    /// while most of the tidb functions (casts, date and string functions...) always return a full column, so
+    /// they would be evaluated again for every block. Evaluate the deterministic ones once here instead.
+    if (arg_names.empty())
+        return false;
+
+    const Block & sample_block = actions->getSampleBlock();
+    Block block;
+    ColumnNumbers arguments;
+    ColumnsWithTypeAndName argument_columns;
+    for (const auto & name : arg_names)
+    {
+        const auto & argument = sample_block.getByName(name);
+        if (!argument.column || !argument.column->isColumnConst() || argument.column->size() != 1)
+            return false;
+        if (!block.has(name))
+            block.insert(argument);
+        arguments.push_back(block.getPositionByName(name));
+        argument_columns.push_back(argument);
+    }
+
+    try
+    {
+        auto function = function_builder->build(argument_columns, collator);
+        if (!function->isDeterministic() || !function->isSuitableForConstantFolding())
+            return false;
+
+        size_t result_position = block.columns();
+        block.insert({nullptr, function->getReturnType(), result_name});
+        function->execute(block, arguments, result_position);
+
+        ColumnPtr result = block.getByPosition(result_position).column;
+        if (!result || result->size() != 1)
+            return false;
+        if (!result->isColumnConst())
+            result = ColumnConst::create(result, 1);
+        actions->add(ExpressionAction::addColumn({result, function->getReturnType(), result_name}));
+        return true;
+    }
+    catch (const Exception &)
+    {
+        /// Leave the error to the execution, so that it is only reported when there are rows to evaluate.
+        return false;
+    }
+}
+
 String DAGExpressionAnalyzer::buildFilterColumn(
     const ExpressionActionsPtr & actions,
     const std::vector<const tipb::Expr *> & conditions)
@@ -273,6 +273,13 @@ private:
         const ExpressionActionsPtr & actions,
         const TiDB::TiDBCollatorPtr & collator);
 
+    bool tryFoldConstantFunction(
+        const FunctionBuilderPtr & function_builder,
+        const Names & arg_names,
+        const String & result_name,
+        const ExpressionActionsPtr & actions,
+        const TiDB::TiDBCollatorPtr & collator);
+
     String appendTimeZoneCast(
         const String & tz_col,
         const String & ts_col,
@@ -311,6 +318,9 @@ private:
     // all columns from table scan
     NamesAndTypes source_columns;
     DAGPreparedSets prepared_sets;
+    // set columns added for in expressions, keyed by the key column and the in expression, so
+    // that the same in expression appearing several times is only evaluated once
+    std::unordered_map<String, ColumnWithTypeAndName> set_columns;
     const Context & context;
     Settings settings;
 
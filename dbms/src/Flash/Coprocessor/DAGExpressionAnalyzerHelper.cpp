@@ -23,6 +23,7 @@
 #include <Flash/Coprocessor/DAGUtils.h>
 #include <Functions/FunctionFactory.h>
 #include <Functions/FunctionsTiDBConversion.h>
+#include <Functions/likePatternToRegexp.h>
 #include <Storages/Transaction/TypeMapping.h>
 
 namespace DB
@@ -70,6 +71,59 @@ const std::unordered_map<String, String> DateSub::unit_to_func_name_map
         {"HOUR", "subtractHours"},
         {"MINUTE", "subtractMinutes"},
         {"SECOND", "subtractSeconds"}};
+
+/// Collects the needles if every leaf of the `or` tree is a `haystack LIKE '%needle%'` on the same
+/// haystack with the default escape char and a binary collation.
+bool collectStrstrLikeNeedles(
+    const tipb::Expr & expr,
+    const tipb::Expr *& haystack,
+    String & haystack_key,
+    std::vector<String> & needles)
+{
+    if (isScalarFunctionExpr(expr) && expr.sig() == tipb::ScalarFuncSig::LogicalOr)
+    {
+        for (const auto & child : expr.children())
+        {
+            if (!collectStrstrLikeNeedles(child, haystack, haystack_key, needles))
+                return false;
+        }
+        return true;
+    }
+
+    if (!isScalarFunctionExpr(expr) || expr.sig() != tipb::ScalarFuncSig::LikeSig || expr.children_size() != 3)
+        return false;
+    if (!isLiteralExpr(expr.children(1)) || !isLiteralExpr(expr.children(2)))
+        return false;
+
+    Field pattern = decodeLiteral(expr.children(1));
+    Field escape = decodeLiteral(expr.children(2));
+    if (pattern.getType() != Field::Types::String)
+        return false;
+    bool default_escape = (escape.getType() == Field::Types::Int64 && escape.get<Int64>() == '\\')
+        || (escape.getType() == Field::Types::UInt64 && escape.get<UInt64>() == '\\');
+    if (!default_escape)
+        return false;
+
+    auto collator = getCollatorFromExpr(expr);
+    if (collator != nullptr && !collator->isBinary() && !collator->isBin())
+        return false;
+
+    String needle;
+    if (!likePatternIsStrstr(pattern.get<String>(), needle))
+        return false;
+
+    String key = expr.children(0).SerializeAsString();
+    if (haystack == nullptr)
+    {
+        haystack = &expr.children(0);
+        haystack_key = std::move(key);
+    }
+    else if (key != haystack_key)
+        return false;
+
+    needles.push_back(std::move(needle));
+    return true;
+}
 } // namespace
 
 String DAGExpressionAnalyzerHelper::buildMultiIfFunction(
@@ -160,12 +214,18 @@ String DAGExpressionAnalyzerHelper::buildInFunction(
     argument_names.push_back(key_name);
     const DAGSetPtr & set = analyzer->getPreparedSets()[&expr];
 
-    ColumnWithTypeAndName column;
-    column.type = std::make_shared<DataTypeSet>();
-
-    column.name = getUniqueName(actions->getSampleBlock(), "___set");
-    column.column = ColumnSet::create(1, set->constant_set);
-    actions->add(ExpressionAction::addColumn(column));
+    // Reuse the set column of an identical in expression on the same key, so the `in` function below is
+    // deduplicated by name as well. The column is checked by pointer since the set names are only unique
+    // within one chain of actions.
+    ColumnWithTypeAndName & column = analyzer->set_columns[key_name + "_" + expr.SerializeAsString()];
+    if (!column.column || !actions->getSampleBlock().has(column.name)
+        || actions->getSampleBlock().getByName(column.name).column.get() != column.column.get())
+    {
+        column.type = std::make_shared<DataTypeSet>();
+        column.name = getUniqueName(actions->getSampleBlock(), "___set");
+        column.column = ColumnSet::create(1, set->constant_set);
+        actions->add(ExpressionAction::addColumn(column));
+    }
     argument_names.push_back(column.name);
 
     const auto * collator = getCollatorFromExpr(expr);
@@ -200,6 +260,22 @@ String DAGExpressionAnalyzerHelper::buildLogicalFunction(
     const ExpressionActionsPtr & actions)
 {
     const String & func_name = getFunctionName(expr);
+    if (expr.sig() == tipb::ScalarFuncSig::LogicalOr)
+    {
+        // `s like '%a%' or s like '%b%' or ...` => multiSearchAny(s, 'a', 'b', ...), which
+        // scans the haystack column once per needle instead of evaluating and or-ing every like.
+        const tipb::Expr * haystack = nullptr;
+        String haystack_key;
+        std::vector<String> needles;
+        if (collectStrstrLikeNeedles(expr, haystack, haystack_key, needles) && needles.size() > 1)
+        {
+            Names argument_names{analyzer->getActions(*haystack, actions, false)};
+            for (const auto & needle : needles)
+                argument_names.push_back(analyzer->getActions(constructStringLiteralTiExpr(needle), actions, false));
+            return analyzer->applyFunction("multiSearchAny", argument_names, actions, nullptr);
+        }
+    }
+
     Names argument_names;
     for (const auto & child : expr.children())
     {
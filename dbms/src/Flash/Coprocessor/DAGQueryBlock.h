@@ -68,6 +68,11 @@ public:
     String qb_column_prefix;
     std::vector<std::shared_ptr<DAGQueryBlock>> children;
     bool can_restore_pipeline_concurrency = true;
+    /// The window local shuffle is enabled on the window and its sort, the input of the sort is hash partitioned by
+    /// its leading `window_local_shuffle_keys` sort keys, which are the partition keys of the window. 0 means disabled.
+    size_t window_local_shuffle_keys = 0;
+    /// The output must keep the order of the sort in this block, e.g. it is the input of a window without sort.
+    bool require_ordered_output = false;
 
     bool isRootQueryBlock() const { return id == 1; };
     bool isTableScanSource() const { return source->tp() == tipb::ExecType::TypeTableScan || source->tp() == tipb::ExecType::TypePartitionTableScan; }
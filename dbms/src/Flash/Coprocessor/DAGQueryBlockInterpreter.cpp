@@ -15,14 +15,19 @@
 #include <Common/FailPoint.h>
 #include <Common/TiFlashException.h>
 #include <Core/NamesAndTypes.h>
+#include <DataStreams/AdaptiveAggregatingBlockInputStream.h>
 #include <DataStreams/AggregatingBlockInputStream.h>
 #include <DataStreams/ConcatBlockInputStream.h>
 #include <DataStreams/ExchangeSenderBlockInputStream.h>
 #include <DataStreams/FilterBlockInputStream.h>
 #include <DataStreams/HashJoinBuildBlockInputStream.h>
 #include <DataStreams/HashJoinProbeBlockInputStream.h>
+#include <DataStreams/HashJoinProbePrefetchBlockInputStream.h>
+#include <DataStreams/JoinRuntimeFilterBlockInputStream.h>
 #include <DataStreams/LimitBlockInputStream.h>
+#include <DataStreams/LocalShuffleBlockInputStream.h>
 #include <DataStreams/MergeSortingBlockInputStream.h>
+#include <DataStreams/MergingSortedBlockInputStream.h>
 #include <DataStreams/MockExchangeReceiverInputStream.h>
 #include <DataStreams/MockExchangeSenderInputStream.h>
 #include <DataStreams/MockTableScanBlockInputStream.h>
@@ -30,10 +35,13 @@
 #include <DataStreams/ParallelAggregatingBlockInputStream.h>
 #include <DataStreams/PartialSortingBlockInputStream.h>
 #include <DataStreams/SquashingBlockInputStream.h>
+#include <DataStreams/StreamingAggregatingBlockInputStream.h>
 #include <DataStreams/TiRemoteBlockInputStream.h>
 #include <DataStreams/WindowBlockInputStream.h>
+#include <DataTypes/DataTypeNullable.h>
 #include <DataTypes/DataTypesNumber.h>
 #include <Flash/Coprocessor/AggregationInterpreterHelper.h>
+#include <Flash/Coprocessor/DAGCodec.h>
 #include <Flash/Coprocessor/DAGExpressionAnalyzer.h>
 #include <Flash/Coprocessor/DAGQueryBlockInterpreter.h>
 #include <Flash/Coprocessor/DAGUtils.h>
@@ -45,10 +53,12 @@
 #include <Flash/Coprocessor/PushDownFilter.h>
 #include <Flash/Coprocessor/StreamingDAGResponseWriter.h>
 #include <Flash/Mpp/ExchangeReceiver.h>
+#include <Flash/Mpp/MPPTaskManager.h>
 #include <Interpreters/Aggregator.h>
 #include <Interpreters/ExpressionAnalyzer.h>
 #include <Interpreters/Join.h>
 #include <Parsers/ASTSelectQuery.h>
+#include <Storages/Transaction/TMTContext.h>
 
 namespace DB
 {
@@ -71,6 +81,8 @@ DAGQueryBlockInterpreter::DAGQueryBlockInterpreter(
 
 namespace
 {
+const String window_local_shuffle_extra_info = "window local shuffle";
+
 struct AnalysisResult
 {
     ExpressionActionsPtr before_where;
@@ -183,9 +195,26 @@ void DAGQueryBlockInterpreter::handleTableScan(const TiDBTableScan & table_scan,
     const auto push_down_filter = PushDownFilter::toPushDownFilter(query_block.selection_name, query_block.selection);
 
     DAGStorageInterpreter storage_interpreter(context, table_scan, push_down_filter, max_streams);
+    /// The values are not used if there is no selection and the aggregation only counts rows, e.g. `select count(*) from t`.
+    if (context.getSettingsRef().dt_enable_read_rows_only && !query_block.selection && query_block.aggregation
+        && AggregationInterpreterHelper::isRowCountOnly(query_block.aggregation->aggregation()))
+        storage_interpreter.setReadRowsOnly(true);
+    /// All the rows read from storage are sorted by the TopN if there is no selection and aggregation.
+    if (context.getSettingsRef().dt_enable_top_n_pushdown && !query_block.selection && !query_block.aggregation
+        && query_block.limit_or_topn && query_block.limit_or_topn->tp() == tipb::ExecType::TypeTopN)
+    {
+        const auto & top_n = query_block.limit_or_topn->topn();
+        if (top_n.order_by_size() == 1 && isColumnExpr(top_n.order_by(0).expr()))
+            storage_interpreter.setTopN(decodeDAGInt64(top_n.order_by(0).expr().val()), top_n.order_by(0).desc(), top_n.limit());
+    }
+    /// Any `limit` rows read from storage satisfy the Limit if there is no selection and aggregation.
+    if (context.getSettingsRef().dt_enable_limit_pushdown && !query_block.selection && !query_block.aggregation
+        && query_block.limit_or_topn && query_block.limit_or_topn->tp() == tipb::ExecType::TypeLimit)
+        storage_interpreter.setLimit(query_block.limit_or_topn->limit().limit());
     storage_interpreter.execute(pipeline);
 
     analyzer = std::move(storage_interpreter.analyzer);
+    source_sort_column_names = std::move(storage_interpreter.sort_column_names);
 }
 
 void DAGQueryBlockInterpreter::handleJoin(const tipb::Join & join, DAGPipeline & pipeline, SubqueryForSet & right_query)
@@ -262,31 +291,90 @@ void DAGQueryBlockInterpreter::handleJoin(const tipb::Join & join, DAGPipeline &
         max_block_size_for_cross_join,
         match_helper_name);
 
-    recordJoinExecuteInfo(tiflash_join.build_side_index, join_ptr);
+    if (settings.max_bytes_before_external_join > 0)
+        join_ptr->setSpillConfig(settings.max_bytes_before_external_join, settings.join_spill_partition_num, getSpillPath(context), context.getFileProvider());
+    join_ptr->setPartitionedBuild(settings.join_partitioned_build);
+    join_ptr->setNestedLoopCrossJoin(settings.join_nested_loop_cross_join);
 
-    auto & join_execute_info = dagContext().getJoinExecuteInfoMap()[query_block.source_name];
+    /// The runtime filter is a superset of the build keys, so it only applies to the joins that drop the unmatched probe rows.
+    if (settings.enable_join_runtime_filter && build_key_names.size() == 1
+        && (tiflash_join.kind == ASTTableJoin::Kind::Inner || tiflash_join.kind == ASTTableJoin::Kind::Right))
+    {
+        const auto & key_type = build_side_prepare_actions->getSampleBlock().getByName(build_key_names[0]).type;
+        if (JoinRuntimeFilter::isSupportedKeyType(key_type))
+            join_ptr->setRuntimeFilter(std::make_shared<JoinRuntimeFilter>(key_type, settings.join_runtime_filter_max_in_values));
+    }
 
     size_t join_build_concurrency = settings.join_concurrent_build ? std::min(max_streams, build_pipeline.streams.size()) : 1;
 
+    /// The rows read by the build side is an upper bound of the build rows, the filters and aggregations shrink them.
+    if (settings.hash_table_reserve_max_rows > 0)
+        join_ptr->setBuildRowsHint(std::min(getPipelineTotalRowsApprox(build_pipeline), static_cast<size_t>(settings.hash_table_reserve_max_rows)));
+
     /// build side streams
     executeExpression(build_pipeline, build_side_prepare_actions, log, "append join key and join filters for build side");
-    // add a HashJoinBuildBlockInputStream to build a shared hash table
-    auto get_concurrency_build_index = JoinInterpreterHelper::concurrencyBuildIndexGenerator(join_build_concurrency);
-    build_pipeline.transform([&](auto & stream) {
-        stream = std::make_shared<HashJoinBuildBlockInputStream>(stream, join_ptr, get_concurrency_build_index(), log->identifier());
-        stream->setExtraInfo(
-            fmt::format("join build, build_side_root_executor_id = {}", dagContext().getJoinExecuteInfoMap()[query_block.source_name].build_side_root_executor_id));
-        join_execute_info.join_build_streams.push_back(stream);
-    });
+    join_ptr->init(build_pipeline.firstStream()->getHeader(), join_build_concurrency);
+
+    /// Every task of a broadcast join receives the same build side, so the tasks of the query on this node can probe
+    /// the hash table built by one of them. The other tasks still read their build side to the end to not block the senders.
+    const auto & build_query_block = *query_block.children[tiflash_join.build_side_index];
+    if (settings.enable_broadcast_join_sharing && dagContext().isMPPTask() && !is_tiflash_right_join && settings.max_bytes_before_external_join == 0
+        && build_query_block.root == build_query_block.source && build_query_block.source->tp() == tipb::ExecType::TypeExchangeReceiver
+        && build_query_block.source->exchange_receiver().tp() == tipb::ExchangeType::Broadcast)
+    {
+        /// the probes of the other tasks must wait for the build even if it has not started yet
+        join_ptr->setBuildTableState(Join::BuildTableState::WAITING);
+        if (auto shared_join = context.getTMTContext().getMPPTaskManager()->getOrRegisterBroadcastJoin(dagContext().getMPPTaskId(), query_block.source_name, join_ptr))
+        {
+            LOG_FMT_DEBUG(log, "Probe the hash table of join {} built by another task", query_block.source_name);
+            join_ptr = shared_join;
+            right_query.drain_only = true;
+        }
+    }
+
+    recordJoinExecuteInfo(tiflash_join.build_side_index, join_ptr);
+
+    auto & join_execute_info = dagContext().getJoinExecuteInfoMap()[query_block.source_name];
+
+    if (!right_query.drain_only)
+    {
+        // add a HashJoinBuildBlockInputStream to build a shared hash table
+        auto get_concurrency_build_index = JoinInterpreterHelper::concurrencyBuildIndexGenerator(join_build_concurrency);
+        build_pipeline.transform([&](auto & stream) {
+            stream = std::make_shared<HashJoinBuildBlockInputStream>(stream, join_ptr, get_concurrency_build_index(), log->identifier());
+            stream->setExtraInfo(
+                fmt::format("join build, build_side_root_executor_id = {}", dagContext().getJoinExecuteInfoMap()[query_block.source_name].build_side_root_executor_id));
+            join_execute_info.join_build_streams.push_back(stream);
+        });
+    }
     // for test, join executor need the return blocks to output.
     executeUnion(build_pipeline, max_streams, log, /*ignore_block=*/!dagContext().isTest(), "for join");
 
     right_query.source = build_pipeline.firstStream();
     right_query.join = join_ptr;
-    join_ptr->init(right_query.source->getHeader(), join_build_concurrency);
 
     /// probe side streams
     executeExpression(probe_pipeline, probe_side_prepare_actions, log, "append join key and join filters for probe side");
+    /// read the probe side ahead during the build, the join keys are materialized by the prefetch threads.
+    if (settings.join_probe_prefetch_blocks > 0 && !right_query.drain_only)
+    {
+        probe_pipeline.transform([&](auto & stream) {
+            auto prefetch_stream = std::make_shared<HashJoinProbePrefetchBlockInputStream>(stream, settings.join_probe_prefetch_blocks, log->identifier());
+            prefetch_stream->setExtraInfo("join probe prefetch");
+            join_ptr->addProbePrefetcher([weak_stream = std::weak_ptr<HashJoinProbePrefetchBlockInputStream>(prefetch_stream)] {
+                if (auto ptr = weak_stream.lock())
+                    ptr->startPrefetch();
+            });
+            stream = prefetch_stream;
+        });
+    }
+    if (join_ptr->getRuntimeFilter())
+    {
+        probe_pipeline.transform([&](auto & stream) {
+            stream = std::make_shared<JoinRuntimeFilterBlockInputStream>(stream, join_ptr, probe_key_names[0], log->identifier());
+            stream->setExtraInfo("join runtime filter");
+        });
+    }
     NamesAndTypes source_columns;
     for (const auto & p : probe_pipeline.firstStream()->getHeader())
         source_columns.emplace_back(p.name, p.type);
@@ -310,9 +398,11 @@ void DAGQueryBlockInterpreter::handleJoin(const tipb::Join & join, DAGPipeline &
             join_execute_info.non_joined_streams.push_back(non_joined_stream);
         }
     }
+    if (!right_query.drain_only)
+        join_ptr->setProbeConcurrency(pipeline.streams.size());
     for (auto & stream : pipeline.streams)
     {
-        stream = std::make_shared<HashJoinProbeBlockInputStream>(stream, chain.getLastActions(), log->identifier());
+        stream = std::make_shared<HashJoinProbeBlockInputStream>(stream, chain.getLastActions(), join_ptr, settings.max_block_size, log->identifier());
         stream->setExtraInfo(fmt::format("join probe, join_executor_id = {}", query_block.source_name));
     }
 
@@ -338,10 +428,10 @@ void DAGQueryBlockInterpreter::recordJoinExecuteInfo(size_t build_side_index, co
     dagContext().getJoinExecuteInfoMap()[query_block.source_name] = std::move(join_execute_info);
 }
 
-void DAGQueryBlockInterpreter::executeWhere(DAGPipeline & pipeline, const ExpressionActionsPtr & expr, String & filter_column, const String & extra_info)
+void DAGQueryBlockInterpreter::executeWhere(DAGPipeline & pipeline, const ExpressionActionsPtr & expr, String & filter_column, const String & extra_info, const Names & output_columns)
 {
     pipeline.transform([&](auto & stream) {
-        stream = std::make_shared<FilterBlockInputStream>(stream, expr, filter_column, log->identifier());
+        stream = std::make_shared<FilterBlockInputStream>(stream, expr, filter_column, log->identifier(), output_columns);
         stream->setExtraInfo(extra_info);
     });
 }
@@ -353,12 +443,14 @@ void DAGQueryBlockInterpreter::executeWindow(
 {
     executeExpression(pipeline, window_description.before_window, log, "before window");
 
-    if (enable_fine_grained_shuffle)
+    if (enable_fine_grained_shuffle || query_block.window_local_shuffle_keys > 0)
     {
-        /// Window function can be multiple threaded when fine grained shuffle is enabled.
+        /// Window function can be multiple threaded when fine grained shuffle or local shuffle is enabled,
+        /// because the rows of a partition are always in the same stream.
+        const auto & extra_info = enable_fine_grained_shuffle ? enableFineGrainedShuffleExtraInfo : window_local_shuffle_extra_info;
         pipeline.transform([&](auto & stream) {
             stream = std::make_shared<WindowBlockInputStream>(stream, window_description, log->identifier());
-            stream->setExtraInfo(enableFineGrainedShuffleExtraInfo);
+            stream->setExtraInfo(extra_info);
         });
     }
     else
@@ -391,6 +483,49 @@ void DAGQueryBlockInterpreter::executeAggregation(
         collators,
         aggregate_descriptions,
         is_final_agg);
+    AggregationInterpreterHelper::setReserveKeysHint(context, params, getPipelineTotalRowsApprox(pipeline), pipeline.streams.size() + pipeline.streams_with_non_joined_data.size());
+
+    /// The rows of every group are consecutive in each stream, so aggregate them one group after another without hash table.
+    if (context.getSettingsRef().enable_streaming_aggregation && pipeline.streams_with_non_joined_data.empty()
+        && AggregationInterpreterHelper::isSortedByKeys(source_sort_column_names, key_names, collators))
+    {
+        const Settings & settings = context.getSettingsRef();
+        /// A group may be split into several streams, merge them in order so that the final results are not duplicated.
+        /// The partial results are merged by the final aggregation anyway.
+        if (is_final_agg && pipeline.streams.size() > 1)
+        {
+            SortDescription sort_desc;
+            for (size_t i = 0; i < key_names.size(); ++i)
+                sort_desc.emplace_back(source_sort_column_names[i], 1, 1);
+            BlockInputStreamPtr stream = std::make_shared<MergingSortedBlockInputStream>(pipeline.streams, sort_desc, settings.max_block_size);
+            pipeline.streams.resize(1);
+            pipeline.firstStream() = std::move(stream);
+        }
+        pipeline.transform([&](auto & stream) {
+            stream = std::make_shared<StreamingAggregatingBlockInputStream>(stream, params, settings.max_block_size, log->identifier());
+        });
+        recordProfileStreams(pipeline, query_block.aggregation_name);
+        return;
+    }
+
+    /// The partial aggregation of every stream gives up the hash table if the sampled rows are not reduced,
+    /// the partial results of the streams are merged by the final aggregation anyway.
+    if (context.getSettingsRef().enable_adaptive_partial_aggregation && !is_final_agg && !key_names.empty()
+        && pipeline.streams_with_non_joined_data.empty())
+    {
+        const Settings & settings = context.getSettingsRef();
+        pipeline.transform([&](auto & stream) {
+            stream = std::make_shared<AdaptiveAggregatingBlockInputStream>(
+                stream,
+                params,
+                context.getFileProvider(),
+                settings.adaptive_partial_aggregation_sample_rows,
+                settings.adaptive_partial_aggregation_ratio,
+                log->identifier());
+        });
+        recordProfileStreams(pipeline, query_block.aggregation_name);
+        return;
+    }
 
     /// If there are several sources, then we perform parallel aggregation
     if (pipeline.streams.size() > 1 || pipeline.streams_with_non_joined_data.size() > 1)
@@ -444,7 +579,18 @@ void DAGQueryBlockInterpreter::executeWindowOrder(DAGPipeline & pipeline, SortDe
 void DAGQueryBlockInterpreter::executeOrder(DAGPipeline & pipeline, const NamesAndTypes & order_columns)
 {
     Int64 limit = query_block.limit_or_topn->topn().limit();
-    orderStreams(pipeline, max_streams, getSortDescription(order_columns, query_block.limit_or_topn->topn().order_by()), limit, false, context, log);
+    SortDescription order_descr = getSortDescription(order_columns, query_block.limit_or_topn->topn().order_by());
+    if (source_sorted_by_topn)
+    {
+        /// Merge the sorted senders directly, the merge stops once `limit` rows are output, then the receiver
+        /// is closed with the query and the senders are cancelled.
+        BlockInputStreamPtr stream = std::make_shared<MergingSortedBlockInputStream>(pipeline.streams, order_descr, context.getSettingsRef().max_block_size, limit);
+        stream->setExtraInfo("merge the ordered exchange receiver");
+        pipeline.streams.resize(1);
+        pipeline.firstStream() = std::move(stream);
+        return;
+    }
+    orderStreams(pipeline, max_streams, order_descr, limit, false, context, log);
 }
 
 void DAGQueryBlockInterpreter::recordProfileStreams(DAGPipeline & pipeline, const String & key)
@@ -469,13 +615,20 @@ void DAGQueryBlockInterpreter::handleExchangeReceiver(DAGPipeline & pipeline)
         extra_info += ", " + enableFineGrainedShuffleExtraInfo;
         stream_count = std::min(max_streams, exchange_receiver->getFineGrainedShuffleStreamCount());
     }
+    else if (exchange_receiver->isOrdered())
+    {
+        /// One stream per sender, they are merged in order by the TopN, see `executeOrder`.
+        extra_info += ", ordered";
+        stream_count = exchange_receiver->getSourceNum();
+        source_sorted_by_topn = true;
+    }
 
     for (size_t i = 0; i < stream_count; ++i)
     {
         BlockInputStreamPtr stream = std::make_shared<ExchangeReceiverInputStream>(exchange_receiver,
                                                                                    log->identifier(),
                                                                                    query_block.source_name,
-                                                                                   /*stream_id=*/enable_fine_grained_shuffle ? i : 0);
+                                                                                   /*stream_id=*/enable_fine_grained_shuffle || source_sorted_by_topn ? i : 0);
         exchange_receiver_io_input_streams.push_back(stream);
         stream = std::make_shared<SquashingBlockInputStream>(stream, 8192, 0, log->identifier());
         stream->setExtraInfo(extra_info);
@@ -564,7 +717,31 @@ void DAGQueryBlockInterpreter::handleWindowOrder(DAGPipeline & pipeline, const t
         input_columns.emplace_back(p.name, p.type);
     DAGExpressionAnalyzer dag_analyzer(input_columns, context);
     auto order_columns = dag_analyzer.buildWindowOrderColumns(window_sort);
-    executeWindowOrder(pipeline, getSortDescription(order_columns, window_sort.byitems()), enable_fine_grained_shuffle);
+    auto sort_desc = getSortDescription(order_columns, window_sort.byitems());
+    if (!enable_fine_grained_shuffle && query_block.window_local_shuffle_keys > 0)
+    {
+        /// Hash partition the input by the partition keys of the window, then sort every stream independently.
+        const auto header = pipeline.firstStream()->getHeader();
+        std::vector<Int64> partition_col_ids;
+        TiDB::TiDBCollators collators;
+        for (size_t i = 0; i < query_block.window_local_shuffle_keys; ++i)
+        {
+            partition_col_ids.push_back(header.getPositionByName(order_columns[i].name));
+            const bool is_string = removeNullable(order_columns[i].type)->isString();
+            collators.push_back(is_string ? getCollatorFromExpr(window_sort.byitems(i).expr()) : nullptr);
+        }
+        pipeline.streams = LocalShuffleBlockInputStream::build(
+            pipeline.streams,
+            std::max(max_streams, pipeline.streams.size()),
+            partition_col_ids,
+            collators,
+            log->identifier());
+        orderStreams(pipeline, max_streams, sort_desc, 0, true, context, log, window_local_shuffle_extra_info);
+    }
+    else
+    {
+        executeWindowOrder(pipeline, sort_desc, enable_fine_grained_shuffle);
+    }
 
     analyzer = std::make_unique<DAGExpressionAnalyzer>(std::move(input_columns), context);
 }
@@ -636,8 +813,9 @@ void DAGQueryBlockInterpreter::executeImpl(DAGPipeline & pipeline)
 
     if (res.before_where)
     {
-        // execute where
-        executeWhere(pipeline, res.before_where, res.filter_column_name, "execute where");
+        // execute where, only the columns required by the next expression are filtered.
+        const auto & next_actions = res.before_aggregation ? res.before_aggregation : res.before_order_and_select;
+        executeWhere(pipeline, res.before_where, res.filter_column_name, "execute where", next_actions ? next_actions->getRequiredColumns() : Names{});
         recordProfileStreams(pipeline, query_block.selection_name);
     }
 
@@ -657,7 +835,7 @@ void DAGQueryBlockInterpreter::executeImpl(DAGPipeline & pipeline)
     if (res.before_having)
     {
         // execute having
-        executeWhere(pipeline, res.before_having, res.having_column_name, "execute having");
+        executeWhere(pipeline, res.before_having, res.having_column_name, "execute having", res.before_order_and_select ? res.before_order_and_select->getRequiredColumns() : Names{});
         recordProfileStreams(pipeline, query_block.having_name);
     }
     if (res.before_order_and_select)
@@ -741,7 +919,9 @@ void DAGQueryBlockInterpreter::handleExchangeSender(DAGPipeline & pipeline)
                 stream_id++ == 0, /// only one stream needs to sending execution summaries for the last response
                 dagContext(),
                 stream_count,
-                batch_size);
+                batch_size,
+                context.getSettingsRef().mpp_exchange_batch_bytes,
+                context.getSettingsRef().mpp_exchange_batch_max_delay_ms);
             stream = std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), log->identifier());
             stream->setExtraInfo(enableFineGrainedShuffleExtraInfo);
         });
@@ -761,7 +941,9 @@ void DAGQueryBlockInterpreter::handleExchangeSender(DAGPipeline & pipeline)
                 stream_id++ == 0, /// only one stream needs to sending execution summaries for the last response
                 dagContext(),
                 stream_count,
-                batch_size);
+                batch_size,
+                context.getSettingsRef().mpp_exchange_batch_bytes,
+                context.getSettingsRef().mpp_exchange_batch_max_delay_ms);
             stream = std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), log->identifier());
         });
     }
@@ -66,7 +66,8 @@ private:
     void handleProjection(DAGPipeline & pipeline, const tipb::Projection & projection);
     void handleWindow(DAGPipeline & pipeline, const tipb::Window & window, bool enable_fine_grained_shuffle);
     void handleWindowOrder(DAGPipeline & pipeline, const tipb::Sort & window_sort, bool enable_fine_grained_shuffle);
-    void executeWhere(DAGPipeline & pipeline, const ExpressionActionsPtr & expressionActionsPtr, String & filter_column, const String & extra_info = "");
+    /// Only the `output_columns` are filtered and kept if it is not empty, they are usually the required columns of the next expression.
+    void executeWhere(DAGPipeline & pipeline, const ExpressionActionsPtr & expressionActionsPtr, String & filter_column, const String & extra_info = "", const Names & output_columns = {});
     void executeWindowOrder(DAGPipeline & pipeline, SortDescription sort_desc, bool enable_fine_grained_shuffle);
     void executeOrder(DAGPipeline & pipeline, const NamesAndTypes & order_columns);
     void executeLimit(DAGPipeline & pipeline);
@@ -103,6 +104,10 @@ private:
     size_t max_streams = 1;
 
     std::unique_ptr<DAGExpressionAnalyzer> analyzer;
+    /// Every stream of the source is sorted by these columns, see `DAGStorageInterpreter::sort_column_names`.
+    Names source_sort_column_names;
+    /// Every stream of the source reads one sender of an ordered exchange receiver, which is sorted by the TopN.
+    bool source_sorted_by_topn = false;
 
     LoggerPtr log;
 };
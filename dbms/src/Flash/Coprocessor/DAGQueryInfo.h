@@ -43,5 +43,24 @@ struct DAGQueryInfo
     const NamesAndTypes & source_columns;
 
     const TimezoneInfo & timezone_info;
+
+    // The actions and the filter column name of the pushed down filter, used by storage engine
+    // to do late materialization. `before_where` is nullptr if it is not applicable.
+    ExpressionActionsPtr before_where;
+    String filter_column_name;
+
+    // Only the row count of the table scan is used, e.g. `select count(*) from t`.
+    bool read_rows_only = false;
+
+    // The TopN on a single column right above the table scan, e.g. `select * from t order by a desc limit 10`.
+    // Used by storage engine to skip the packs which could not be in the result. `top_n_column_index`
+    // is the index in the columns of table scan, -1 if there is no such TopN.
+    Int64 top_n_column_index = -1;
+    bool top_n_is_desc = false;
+    UInt64 top_n_limit = 0;
+
+    // The Limit without order right above the table scan, e.g. `select * from t limit 10`.
+    // Used by storage engine to stop reading once enough rows are read, 0 if there is no such Limit.
+    UInt64 limit = 0;
 };
 } // namespace DB
@@ -28,6 +28,7 @@
 #include <Flash/Coprocessor/DAGStorageInterpreter.h>
 #include <Flash/Coprocessor/InterpreterUtils.h>
 #include <Flash/Coprocessor/RemoteRequest.h>
+#include <Flash/Coprocessor/TableScanColumnsCache.h>
 #include <Interpreters/Context.h>
 #include <Parsers/makeDummyQuery.h>
 #include <Storages/IManageableStorage.h>
@@ -43,6 +44,8 @@
 #include <tipb/select.pb.h>
 #pragma GCC diagnostic pop
 
+#include <algorithm>
+
 
 namespace DB
 {
@@ -270,6 +273,10 @@ void DAGStorageInterpreter::executeImpl(DAGPipeline & pipeline)
     // after buildRemoteStreams, remote read stream will be appended in pipeline.streams.
     size_t remote_read_streams_start_index = pipeline.streams.size();
 
+    // The streams read from other nodes are not sorted.
+    if (remote_requests.empty())
+        sort_column_names = getSortColumnNames();
+
     // For those regions which are not presented in this tiflash node, we will try to fetch streams by key ranges from other tiflash nodes, only happens in batch cop / mpp mode.
     if (!remote_requests.empty())
         buildRemoteStreams(std::move(remote_requests), pipeline);
@@ -344,6 +351,37 @@ void DAGStorageInterpreter::prepare()
     std::tie(required_columns, source_columns, is_need_add_cast_column) = getColumnsForTableScan(settings.max_columns_to_read);
 
     analyzer = std::make_unique<DAGExpressionAnalyzer>(std::move(source_columns), context);
+
+    if (settings.dt_enable_late_materialization && push_down_filter.hasValue())
+        std::tie(late_materialization_before_where, late_materialization_filter_column_name) = buildLateMaterializationFilter();
+}
+
+std::pair<ExpressionActionsPtr, String> DAGStorageInterpreter::buildLateMaterializationFilter() const
+{
+    // Use another analyzer so that the state of `analyzer` won't be changed.
+    const auto & storage_columns = analyzer->getCurrentInputColumns();
+    DAGExpressionAnalyzer filter_analyzer(storage_columns, context);
+    ExpressionActionsChain chain;
+    filter_analyzer.initChain(chain, storage_columns);
+    String filter_column_name = filter_analyzer.appendWhere(chain, push_down_filter.conditions);
+    chain.finalize();
+    ExpressionActionsPtr before_where = chain.getLastActions();
+    chain.clear();
+
+    // The filter is evaluated on the columns after timezone/duration cast, so we can not
+    // push it down to storage if any of the columns it depends on need extra cast.
+    const auto filter_required_columns = before_where->getRequiredColumns();
+    for (size_t i = 0; i < is_need_add_cast_column.size(); ++i)
+    {
+        if (is_need_add_cast_column[i] == ExtraCastAfterTSMode::None)
+            continue;
+        if (std::find(filter_required_columns.begin(), filter_required_columns.end(), storage_columns[i].name) != filter_required_columns.end())
+        {
+            LOG_FMT_DEBUG(log, "Late materialization is disabled because column {} need extra cast", storage_columns[i].name);
+            return {nullptr, ""};
+        }
+    }
+    return {before_where, filter_column_name};
 }
 
 void DAGStorageInterpreter::executePushedDownFilter(
@@ -374,7 +412,7 @@ void DAGStorageInterpreter::executePushedDownFilter(
     for (size_t i = 0; i < remote_read_streams_start_index; ++i)
     {
         auto & stream = pipeline.streams[i];
-        stream = std::make_shared<FilterBlockInputStream>(stream, before_where, filter_column_name, log->identifier());
+        stream = std::make_shared<FilterBlockInputStream>(stream, before_where, filter_column_name, log->identifier(), project_after_where->getRequiredColumns());
         stream->setExtraInfo("push down filter");
         // after filter, do project action to keep the schema of local streams and remote streams the same.
         stream = std::make_shared<ExpressionBlockInputStream>(stream, project_after_where, log->identifier());
@@ -473,7 +511,12 @@ void DAGStorageInterpreter::buildRemoteStreams(std::vector<RemoteRequest> && rem
         all_tasks.insert(all_tasks.end(), tasks.begin(), tasks.end());
     }
 
-    size_t concurrent_num = std::min<size_t>(context.getSettingsRef().max_threads, all_tasks.size());
+    /// The remote regions are read in the order of their key ranges, and each stream fetches the cop
+    /// responses of its tasks one by one, so the number of streams bounds the responses held in memory.
+    const auto & settings = context.getSettingsRef();
+    size_t max_streams = settings.max_remote_read_streams ? static_cast<size_t>(settings.max_remote_read_streams) : static_cast<size_t>(settings.max_threads);
+    size_t concurrent_num = std::max<size_t>(1, std::min<size_t>(max_streams, all_tasks.size()));
+    LOG_FMT_DEBUG(log, "Build {} remote streams for {} cop tasks of {} remote requests", concurrent_num, all_tasks.size(), remote_requests.size());
     size_t task_per_thread = all_tasks.size() / concurrent_num;
     size_t rest_task = all_tasks.size() % concurrent_num;
     for (size_t i = 0, task_start = 0; i < concurrent_num; ++i)
@@ -598,6 +641,13 @@ std::unordered_map<TableID, SelectQueryInfo> DAGStorageInterpreter::generateSele
             analyzer->getPreparedSets(),
             analyzer->getCurrentInputColumns(),
             context.getTimezoneInfo());
+        query_info.dag_query->before_where = late_materialization_before_where;
+        query_info.dag_query->filter_column_name = late_materialization_filter_column_name;
+        query_info.dag_query->read_rows_only = read_rows_only;
+        query_info.dag_query->top_n_column_index = top_n_column_index;
+        query_info.dag_query->top_n_is_desc = top_n_is_desc;
+        query_info.dag_query->top_n_limit = top_n_limit;
+        query_info.dag_query->limit = limit;
         query_info.req_id = fmt::format("{} Table<{}>", log->identifier(), table_id);
         query_info.keep_order = table_scan.keepOrder();
         return query_info;
@@ -640,6 +690,11 @@ void DAGStorageInterpreter::buildLocalStreams(DAGPipeline & pipeline, size_t max
     bool has_multiple_partitions = table_query_infos.size() > 1;
     // MultiPartitionStreamPool will be disabled in no partition mode or single-partition case
     std::shared_ptr<MultiPartitionStreamPool> stream_pool = has_multiple_partitions ? std::make_shared<MultiPartitionStreamPool>() : nullptr;
+    /// The streams of all the partitions are multiplexed into `max_streams` streams, so every partition only needs
+    /// the streams of its share of the regions, instead of `max_streams` streams and their read tasks for each of them.
+    size_t total_partition_region_num = 0;
+    for (const auto & table_query_info : table_query_infos)
+        total_partition_region_num += table_query_info.second.mvcc_query_info->regions_query_info.size();
     for (const auto & table_query_info : table_query_infos)
     {
         DAGPipeline current_pipeline;
@@ -657,7 +712,10 @@ void DAGStorageInterpreter::buildLocalStreams(DAGPipeline & pipeline, size_t max
         {
             try
             {
-                current_pipeline.streams = storage->read(required_columns, query_info, context, from_stage, max_block_size, max_streams);
+                size_t partition_streams = max_streams;
+                if (has_multiple_partitions)
+                    partition_streams = std::clamp<size_t>((max_streams * region_num + total_partition_region_num - 1) / total_partition_region_num, 1, max_streams);
+                current_pipeline.streams = storage->read(required_columns, query_info, context, from_stage, max_block_size, partition_streams);
 
                 // After getting streams from storage, we need to validate whether Regions have changed or not after learner read.
                 // (by calling `validateQueryInfo`). In case the key ranges of Regions have changed (Region merge/split), those `streams`
@@ -969,6 +1027,20 @@ std::tuple<Names, NamesAndTypes, std::vector<ExtraCastAfterTSMode>> DAGStorageIn
             Errors::BroadcastJoin::TooManyColumns);
     }
 
+    if (auto cache = context.getTableScanColumnsCache(); cache)
+    {
+        auto key = TableScanColumnsCache::hash(logical_table_id, storage_for_logical_table->getTableInfo().schema_version, table_scan.getColumns());
+        auto columns = cache->getOrSet(key, [&] {
+            auto [required_columns_tmp, source_columns_tmp, need_cast_column] = genColumnsForTableScan();
+            return std::make_shared<TableScanColumns>(TableScanColumns{std::move(required_columns_tmp), std::move(source_columns_tmp), std::move(need_cast_column)});
+        });
+        return {columns->required_columns, columns->source_columns, columns->need_cast_column};
+    }
+    return genColumnsForTableScan();
+}
+
+std::tuple<Names, NamesAndTypes, std::vector<ExtraCastAfterTSMode>> DAGStorageInterpreter::genColumnsForTableScan() const
+{
     Names required_columns_tmp;
     NamesAndTypes source_columns_tmp;
     std::vector<ExtraCastAfterTSMode> need_cast_column;
@@ -1054,6 +1126,53 @@ std::vector<RemoteRequest> DAGStorageInterpreter::buildRemoteRequests()
     return remote_requests;
 }
 
+Names DAGStorageInterpreter::getSortColumnNames() const
+{
+    // The read tasks are taken by the streams in the order of the handle only if keep order is required,
+    // and the rows are sorted by the handle only if they are merged by MVCC, not read in fast mode.
+    if (!table_scan.keepOrder() || storage_for_logical_table->engineType() != ::TiDB::StorageEngine::DT)
+        return {};
+    const auto & table_info = storage_for_logical_table->getTableInfo();
+    if (table_info.tiflash_mode == TiDB::TiFlashMode::Fast)
+        return {};
+
+    Names handle_columns;
+    if (!table_info.is_common_handle)
+    {
+        if (auto pk_handle_col = table_info.getPKHandleColumn())
+            handle_columns.push_back(pk_handle_col->get().name);
+        else
+            handle_columns.push_back(MutableSupport::tidb_pk_column_name);
+    }
+    else
+    {
+        // The common handle is memcomparable encoded, its order is the order of the primary key columns
+        // as long as they are integers.
+        for (const auto & idx_col : table_info.getPrimaryIndexInfo().idx_cols)
+        {
+            auto iter = std::find_if(table_info.columns.begin(), table_info.columns.end(), [&](const TiDB::ColumnInfo & column) {
+                return column.name == idx_col.name;
+            });
+            if (iter == table_info.columns.end())
+                break;
+            if (iter->tp != TiDB::TypeTiny && iter->tp != TiDB::TypeShort && iter->tp != TiDB::TypeInt24
+                && iter->tp != TiDB::TypeLong && iter->tp != TiDB::TypeLongLong)
+                break;
+            handle_columns.push_back(idx_col.name);
+        }
+    }
+
+    // Only the prefix which is read from the storage.
+    Names res;
+    for (auto & name : handle_columns)
+    {
+        if (std::find(required_columns.begin(), required_columns.end(), name) == required_columns.end())
+            break;
+        res.push_back(std::move(name));
+    }
+    return res;
+}
+
 TableLockHolders DAGStorageInterpreter::releaseAlterLocks()
 {
     TableLockHolders drop_locks;
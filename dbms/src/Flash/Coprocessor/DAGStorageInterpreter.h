@@ -50,9 +50,26 @@ public:
 
     void execute(DAGPipeline & pipeline);
 
+    /// Only the row count of the table scan is used by the executors above, so the storage can skip reading the values.
+    void setReadRowsOnly(bool read_rows_only_) { read_rows_only = read_rows_only_; }
+
+    /// The executor above is a TopN on the `column_index`-th column of the table scan, so the storage can
+    /// skip the data which could not be in the result.
+    void setTopN(Int64 column_index, bool is_desc, UInt64 limit)
+    {
+        top_n_column_index = column_index;
+        top_n_is_desc = is_desc;
+        top_n_limit = limit;
+    }
+
+    /// The executor above is a Limit without order, so the storage can stop reading once `limit` rows are read.
+    void setLimit(UInt64 limit_) { limit = limit_; }
+
     /// Members will be transferred to DAGQueryBlockInterpreter after execute
 
     std::unique_ptr<DAGExpressionAnalyzer> analyzer;
+    /// Every stream of the pipeline is sorted by these columns, empty if the order is not guaranteed.
+    Names sort_column_names;
 
 private:
     struct StorageWithStructureLock
@@ -69,9 +86,13 @@ private:
     std::unordered_map<TableID, StorageWithStructureLock> getAndLockStorages(Int64 query_schema_version);
 
     std::tuple<Names, NamesAndTypes, std::vector<ExtraCastAfterTSMode>> getColumnsForTableScan(Int64 max_columns_to_read);
+    std::tuple<Names, NamesAndTypes, std::vector<ExtraCastAfterTSMode>> genColumnsForTableScan() const;
 
     std::vector<RemoteRequest> buildRemoteRequests();
 
+    /// The columns that the rows read from the local storage are sorted by.
+    Names getSortColumnNames() const;
+
     TableLockHolders releaseAlterLocks();
 
     std::unordered_map<TableID, SelectQueryInfo> generateSelectQueryInfos();
@@ -92,6 +113,10 @@ private:
 
     void prepare();
 
+    /// Build the actions of pushed down filter for storage to do late materialization.
+    /// Return nullptr if the filter can not be evaluated on the columns read from storage.
+    std::pair<ExpressionActionsPtr, String> buildLateMaterializationFilter() const;
+
     void executeImpl(DAGPipeline & pipeline);
 
 private:
@@ -127,6 +152,14 @@ private:
     ManageableStoragePtr storage_for_logical_table;
     Names required_columns;
     NamesAndTypes source_columns;
+    // The pushed down filter executed by storage for late materialization, nullptr if disabled.
+    ExpressionActionsPtr late_materialization_before_where;
+    String late_materialization_filter_column_name;
+    bool read_rows_only = false;
+    Int64 top_n_column_index = -1;
+    bool top_n_is_desc = false;
+    UInt64 top_n_limit = 0;
+    UInt64 limit = 0;
 };
 
 } // namespace DB
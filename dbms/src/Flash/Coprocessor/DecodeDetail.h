@@ -28,5 +28,10 @@ struct DecodeDetail
 
     // Total byte size of the origin packet, even for fine grained shuffle.
     Int64 packet_bytes = 0;
+
+    // The compressed chunks decoded by this ExchangeReceiver/thread.
+    Int64 uncompressed_bytes = 0;
+    Int64 compressed_bytes = 0;
+    UInt64 decompression_time_ns = 0;
 };
 } // namespace DB
@@ -0,0 +1,70 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Flash/Coprocessor/HashPartitioner.h>
+
+namespace DB
+{
+HashPartitioner::HashPartitioner(const std::vector<Int64> & partition_col_ids_, const TiDB::TiDBCollators & collators_, uint32_t bucket_num_)
+    : partition_col_ids(partition_col_ids_)
+    , collators(collators_)
+    , bucket_num(bucket_num_)
+    , hash(0)
+    , partition_key_containers(collators_.size())
+    , scatter_columns(bucket_num_)
+{
+    assert(partition_col_ids.size() == collators.size());
+    assert(bucket_num > 0);
+}
+
+const IColumn::Selector & HashPartitioner::computeSelector(const Block & block)
+{
+    size_t rows = block.rows();
+    hash.reset(rows);
+
+    // get hash values by all partition key columns
+    for (size_t i = 0; i < partition_col_ids.size(); ++i)
+    {
+        block.getByPosition(partition_col_ids[i]).column->updateWeakHash32(hash, collators[i], partition_key_containers[i]);
+    }
+
+    /// Row from interval [(2^32 / bucket_num) * i, (2^32 / bucket_num) * (i + 1)) goes to bucket with number i.
+    /// There is no dependency between rows, so the loop is vectorized by the compiler.
+    const UInt32 * __restrict hash_data = hash.getData().data();
+    selector.resize(rows);
+    IColumn::ColumnIndex * __restrict selector_data = selector.data();
+    const UInt64 num = bucket_num;
+    for (size_t row = 0; row < rows; ++row)
+        selector_data[row] = (static_cast<UInt64>(hash_data[row]) * num) >> 32u;
+    return selector;
+}
+
+void HashPartitioner::partition(const Block & block, std::vector<MutableColumns> & dest_columns)
+{
+    assert(dest_columns.size() == bucket_num);
+    const auto & block_selector = computeSelector(block);
+
+    for (size_t col_id = 0; col_id < block.columns(); ++col_id)
+    {
+        // Scatter each column to the buckets in one pass of the selector
+        for (size_t bucket_idx = 0; bucket_idx < bucket_num; ++bucket_idx)
+            scatter_columns[bucket_idx] = std::move(dest_columns[bucket_idx][col_id]);
+        block.getByPosition(col_id).column->scatterTo(scatter_columns, block_selector);
+        for (size_t bucket_idx = 0; bucket_idx < bucket_num; ++bucket_idx)
+            dest_columns[bucket_idx][col_id] = std::move(scatter_columns[bucket_idx]);
+    }
+}
+
+} // namespace DB
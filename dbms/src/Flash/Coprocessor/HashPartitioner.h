@@ -0,0 +1,52 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Columns/IColumn.h>
+#include <Common/WeakHash.h>
+#include <Core/Block.h>
+#include <Storages/Transaction/Collator.h>
+
+namespace DB
+{
+/// Partition the rows of blocks into `bucket_num` buckets by the hash of the partition key columns.
+/// The hash values, the selector and the sort key containers are kept across blocks, and the rows are
+/// appended to the per-bucket columns given by the caller, so that they can be reused too.
+class HashPartitioner
+{
+public:
+    HashPartitioner(const std::vector<Int64> & partition_col_ids_, const TiDB::TiDBCollators & collators_, uint32_t bucket_num_);
+
+    /// Compute the bucket of each row of `block`. The result is valid until the next call.
+    const IColumn::Selector & computeSelector(const Block & block);
+
+    /// Append the rows of `block` to `dest_columns[bucket]`, which have the same structure as `block`.
+    void partition(const Block & block, std::vector<MutableColumns> & dest_columns);
+
+    uint32_t getBucketNum() const { return bucket_num; }
+
+private:
+    const std::vector<Int64> partition_col_ids;
+    const TiDB::TiDBCollators collators;
+    const uint32_t bucket_num;
+
+    WeakHash32 hash;
+    IColumn::Selector selector;
+    std::vector<String> partition_key_containers;
+    IColumn::ScatterColumns scatter_columns;
+};
+
+} // namespace DB
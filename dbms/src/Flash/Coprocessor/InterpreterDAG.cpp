@@ -36,6 +36,41 @@ void setRestorePipelineConcurrency(DAGQueryBlock & query_block)
     }
 }
 
+/// Hash partition the input of the window by its partition keys inside the task, so that the sort and the window
+/// can run in parallel without fine grained shuffle. It requires the leading sort keys are the partition keys.
+void setWindowLocalShuffle(DAGQueryBlock & query_block, const Settings & settings, size_t max_streams)
+{
+    if (query_block.source->tp() != tipb::ExecType::TypeWindow)
+        return;
+    assert(query_block.children.size() == 1);
+    auto & child = query_block.children.back();
+    if (child->source->tp() == tipb::ExecType::TypeWindow)
+    {
+        /// The window without sort relies on the order of the child window.
+        child->require_ordered_output = true;
+        return;
+    }
+
+    if (!settings.enable_window_local_shuffle || max_streams <= 1 || query_block.require_ordered_output)
+        return;
+    if (enableFineGrainedShuffle(query_block.source->fine_grained_shuffle_stream_count()))
+        return;
+    if (child->source->tp() != tipb::ExecType::TypeSort || !child->source->sort().ispartialsort())
+        return;
+
+    const auto & window = query_block.source->window();
+    const auto & sort = child->source->sort();
+    if (window.partition_by_size() == 0 || window.partition_by_size() > sort.byitems_size())
+        return;
+    for (int i = 0; i < window.partition_by_size(); ++i)
+    {
+        if (window.partition_by(i).expr().SerializeAsString() != sort.byitems(i).expr().SerializeAsString())
+            return;
+    }
+    query_block.window_local_shuffle_keys = window.partition_by_size();
+    child->window_local_shuffle_keys = window.partition_by_size();
+}
+
 DAGContext & InterpreterDAG::dagContext() const
 {
     return *context.getDAGContext();
@@ -48,6 +83,7 @@ BlockInputStreams InterpreterDAG::executeQueryBlock(DAGQueryBlock & query_block)
 {
     std::vector<BlockInputStreams> input_streams_vec;
     setRestorePipelineConcurrency(query_block);
+    setWindowLocalShuffle(query_block, context.getSettingsRef(), max_streams);
     for (auto & child : query_block.children)
     {
         BlockInputStreams child_streams = executeQueryBlock(*child);
@@ -21,6 +21,7 @@
 #include <Flash/Coprocessor/DAGContext.h>
 #include <Flash/Coprocessor/InterpreterUtils.h>
 #include <Interpreters/Context.h>
+#include <Storages/PathPool.h>
 
 namespace DB
 {
@@ -116,12 +117,13 @@ void orderStreams(
     Int64 limit,
     bool enable_fine_grained_shuffle,
     const Context & context,
-    const LoggerPtr & log)
+    const LoggerPtr & log,
+    const String & fine_grained_shuffle_extra_info)
 {
     const Settings & settings = context.getSettingsRef();
     String extra_info;
     if (enable_fine_grained_shuffle)
-        extra_info = enableFineGrainedShuffleExtraInfo;
+        extra_info = fine_grained_shuffle_extra_info;
 
     pipeline.transform([&](auto & stream) {
         auto sorting_stream = std::make_shared<PartialSortingBlockInputStream>(stream, order_descr, log->identifier(), limit);
@@ -145,9 +147,10 @@ void orderStreams(
                 settings.max_block_size,
                 limit,
                 settings.max_bytes_before_external_sort,
-                context.getTemporaryPath(),
+                getSpillPath(context),
+                context.getFileProvider(),
                 log->identifier());
-            stream->setExtraInfo(enableFineGrainedShuffleExtraInfo);
+            stream->setExtraInfo(fine_grained_shuffle_extra_info);
         });
     }
     else
@@ -162,11 +165,34 @@ void orderStreams(
             settings.max_block_size,
             limit,
             settings.max_bytes_before_external_sort,
-            context.getTemporaryPath(),
+            getSpillPath(context),
+            context.getFileProvider(),
             log->identifier());
     }
 }
 
+String getSpillPath(const Context & context)
+{
+    auto spill_path = context.getPathPool().choosePathForSpill();
+    if (spill_path.empty())
+        return context.getTemporaryPath();
+    return spill_path;
+}
+
+size_t getPipelineTotalRowsApprox(const DAGPipeline & pipeline)
+{
+    size_t res = 0;
+    auto add_rows = [&](const BlockInputStreamPtr & stream) {
+        if (auto * p_stream = dynamic_cast<IProfilingBlockInputStream *>(stream.get()); p_stream)
+            res += p_stream->getTotalRowsApprox();
+    };
+    for (const auto & stream : pipeline.streams)
+        add_rows(stream);
+    for (const auto & stream : pipeline.streams_with_non_joined_data)
+        add_rows(stream);
+    return res;
+}
+
 void executeCreatingSets(
     DAGPipeline & pipeline,
     const Context & context,
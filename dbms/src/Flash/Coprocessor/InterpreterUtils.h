@@ -22,6 +22,7 @@
 namespace DB
 {
 class Context;
+extern const String enableFineGrainedShuffleExtraInfo;
 
 void restoreConcurrency(
     DAGPipeline & pipeline,
@@ -59,7 +60,16 @@ void orderStreams(
     Int64 limit,
     bool enable_fine_grained_shuffle,
     const Context & context,
-    const LoggerPtr & log);
+    const LoggerPtr & log,
+    const String & fine_grained_shuffle_extra_info = enableFineGrainedShuffleExtraInfo);
+
+/// Choose a directory for the data spilled by the query, e.g. external aggregation and spilled join.
+/// Use the spill paths managed by PathPool if possible, otherwise fallback to the temporary path.
+String getSpillPath(const Context & context);
+
+/// The approximate rows read by the streams of the pipeline, as set by the storage, or 0 if unknown.
+/// Must be called before the pipeline is executed.
+size_t getPipelineTotalRowsApprox(const DAGPipeline & pipeline);
 
 void executeCreatingSets(
     DAGPipeline & pipeline,
@@ -34,14 +34,20 @@ class MPPDataPacket;
 
 namespace DB
 {
+/// Writes the chunks of a streaming coprocessor request, either a batch coprocessor request or
+/// a non-batch coprocessor request served by `CoprocessorStream`.
 struct StreamWriter
 {
-    ::grpc::ServerWriter<::coprocessor::BatchResponse> * writer;
+    ::grpc::ServerWriter<::coprocessor::BatchResponse> * writer = nullptr;
+    ::grpc::ServerWriter<::coprocessor::Response> * cop_writer = nullptr;
     std::mutex write_mutex;
 
     explicit StreamWriter(::grpc::ServerWriter<::coprocessor::BatchResponse> * writer_)
         : writer(writer_)
     {}
+    explicit StreamWriter(::grpc::ServerWriter<::coprocessor::Response> * cop_writer_)
+        : cop_writer(cop_writer_)
+    {}
     void write(mpp::MPPDataPacket &)
     {
         throw Exception("StreamWriter::write(mpp::MPPDataPacket &) do not support writing MPPDataPacket!");
@@ -52,6 +58,16 @@ struct StreamWriter
     }
     void write(tipb::SelectResponse & response, [[maybe_unused]] uint16_t id = 0)
     {
+        if (cop_writer)
+        {
+            ::coprocessor::Response resp;
+            if (!response.SerializeToString(resp.mutable_data()))
+                throw Exception("Fail to serialize response, response size: " + std::to_string(response.ByteSizeLong()));
+            std::lock_guard lk(write_mutex);
+            if (!cop_writer->Write(resp))
+                throw Exception("Failed to write resp");
+            return;
+        }
         ::coprocessor::BatchResponse resp;
         if (!response.SerializeToString(resp.mutable_data()))
             throw Exception("Fail to serialize response, response size: " + std::to_string(response.ByteSizeLong()));
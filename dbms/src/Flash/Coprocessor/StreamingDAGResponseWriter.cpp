@@ -14,6 +14,7 @@
 
 #include <Common/Logger.h>
 #include <Common/TiFlashException.h>
+#include <Common/TiFlashMetrics.h>
 #include <DataStreams/IProfilingBlockInputStream.h>
 #include <Flash/Coprocessor/ArrowChunkCodec.h>
 #include <Flash/Coprocessor/CHBlockChunkCodec.h>
@@ -39,6 +40,18 @@ inline void serializeToPacket(mpp::MPPDataPacket & packet, const tipb::SelectRes
         throw Exception(fmt::format("Fail to serialize response, response size: {}", response.ByteSizeLong()));
 }
 
+inline void initInputBlocks(std::vector<Block> & input_blocks)
+{
+    for (auto & input_block : input_blocks)
+    {
+        for (size_t i = 0; i < input_block.columns(); ++i)
+        {
+            if (ColumnPtr converted = input_block.getByPosition(i).column->convertToFullColumnIfConst())
+                input_block.getByPosition(i).column = converted;
+        }
+    }
+}
+
 template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
 StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::StreamingDAGResponseWriter(
     StreamWriterPtr writer_,
@@ -50,7 +63,9 @@ StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::Stream
     bool should_send_exec_summary_at_last_,
     DAGContext & dag_context_,
     uint64_t fine_grained_shuffle_stream_count_,
-    UInt64 fine_grained_shuffle_batch_size_)
+    UInt64 fine_grained_shuffle_batch_size_,
+    UInt64 batch_send_min_bytes_,
+    UInt64 batch_send_max_delay_ms_)
     : DAGResponseWriter(records_per_chunk_, dag_context_)
     , batch_send_min_limit(batch_send_min_limit_)
     , should_send_exec_summary_at_last(should_send_exec_summary_at_last_)
@@ -60,6 +75,8 @@ StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::Stream
     , collators(std::move(collators_))
     , fine_grained_shuffle_stream_count(fine_grained_shuffle_stream_count_)
     , fine_grained_shuffle_batch_size(fine_grained_shuffle_batch_size_)
+    , batch_send_min_bytes(batch_send_min_bytes_)
+    , batch_send_max_delay_ms(batch_send_max_delay_ms_)
 {
     rows_in_blocks = 0;
     partition_num = writer_->getPartitionNum();
@@ -75,6 +92,30 @@ StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::Stream
         chunk_codec_stream = std::make_unique<CHBlockChunkCodec>()->newCodecStream(dag_context.result_field_types);
         break;
     }
+    if (exchange_type == tipb::ExchangeType::Hash)
+    {
+        // fine_grained_shuffle_stream_count is in [0, 1024], and partition_num is uint16_t, so will not overflow.
+        uint32_t bucket_num = enable_fine_grained_shuffle ? partition_num * fine_grained_shuffle_stream_count : partition_num;
+        partitioner = std::make_unique<HashPartitioner>(partition_col_ids, collators, bucket_num);
+    }
+}
+
+template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
+bool StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::canWriteBlocks(size_t partition_id) const
+{
+    if constexpr (std::is_same_v<StreamWriterPtr, MPPTunnelSetPtr>)
+        return writer->canWriteBlocks(partition_id);
+    else
+        return false;
+}
+
+template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
+bool StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::hasBlockTunnel() const
+{
+    if constexpr (std::is_same_v<StreamWriterPtr, MPPTunnelSetPtr>)
+        return writer->getBlockTunnelCnt() > 0;
+    else
+        return false;
 }
 
 template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
@@ -115,7 +156,23 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::w
     rows_in_blocks += rows;
     if (rows > 0)
     {
+        if (blocks.empty())
+            batch_watch.restart();
         blocks.push_back(block);
+        bytes_in_blocks += block.bytes();
+    }
+
+    if (batchByBytes())
+    {
+        if (!blocks.empty()
+            && (bytes_in_blocks >= batch_send_min_bytes * std::max<UInt64>(partition_num, 1) || batch_watch.elapsedMilliseconds() >= batch_send_max_delay_ms))
+        {
+            if constexpr (enable_fine_grained_shuffle)
+                batchWriteFineGrainedShuffle<false>();
+            else
+                batchWrite<false>();
+        }
+        return;
     }
 
     if constexpr (enable_fine_grained_shuffle)
@@ -154,12 +211,34 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::e
                 }
                 return;
             }
+            if constexpr (std::is_same_v<StreamWriterPtr, MPPTunnelSetPtr>)
+            {
+                if (hasBlockTunnel())
+                {
+                    // Only encode the blocks for the tunnels which can not accept blocks.
+                    if (writer->getBlockTunnelCnt() < writer->getPartitionNum())
+                    {
+                        for (const auto & block : input_blocks)
+                        {
+                            chunk_codec_stream->encode(block, 0, block.rows());
+                            packet.add_chunks(chunk_codec_stream->getString());
+                            chunk_codec_stream->clear();
+                        }
+                        GET_METRIC(tiflash_exchange_packet_size_bytes, type_others).Observe(packet.ByteSizeLong());
+                    }
+                    std::vector<Block> full_blocks = input_blocks;
+                    initInputBlocks(full_blocks);
+                    writer->write(packet, full_blocks);
+                    return;
+                }
+            }
             for (const auto & block : input_blocks)
             {
                 chunk_codec_stream->encode(block, 0, block.rows());
                 packet.add_chunks(chunk_codec_stream->getString());
                 chunk_codec_stream->clear();
             }
+            GET_METRIC(tiflash_exchange_packet_size_bytes, type_others).Observe(packet.ByteSizeLong());
             writer->write(packet);
         }
         else /// passthrough data to a non-TiFlash node, like sending data to TiSpark
@@ -243,6 +322,7 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::b
     }
     blocks.clear();
     rows_in_blocks = 0;
+    bytes_in_blocks = 0;
 }
 
 template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
@@ -272,31 +352,28 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::h
 template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
 template <bool send_exec_summary_at_last>
 void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::writePackets(const std::vector<size_t> & responses_row_count,
-                                                                                            std::vector<mpp::MPPDataPacket> & packets) const
+                                                                                            std::vector<mpp::MPPDataPacket> & packets,
+                                                                                            std::vector<PartitionBlocks> & partition_blocks) const
 {
     for (size_t part_id = 0; part_id < packets.size(); ++part_id)
     {
-        if constexpr (send_exec_summary_at_last)
-        {
-            writer->write(packets[part_id], part_id);
-        }
-        else
+        if constexpr (!send_exec_summary_at_last)
         {
-            if (responses_row_count[part_id] > 0)
-                writer->write(packets[part_id], part_id);
+            if (responses_row_count[part_id] == 0)
+                continue;
         }
-    }
-}
-
-inline void initInputBlocks(std::vector<Block> & input_blocks)
-{
-    for (auto & input_block : input_blocks)
-    {
-        for (size_t i = 0; i < input_block.columns(); ++i)
+        if constexpr (std::is_same_v<StreamWriterPtr, MPPTunnelSetPtr>)
         {
-            if (ColumnPtr converted = input_block.getByPosition(i).column->convertToFullColumnIfConst())
-                input_block.getByPosition(i).column = converted;
+            if (canWriteBlocks(part_id))
+            {
+                auto & part_blocks = partition_blocks[part_id];
+                writer->write(packets[part_id], std::move(part_blocks.blocks), std::move(part_blocks.stream_ids), part_id);
+                continue;
+            }
         }
+        if (packets[part_id].chunks_size() > 0)
+            GET_METRIC(tiflash_exchange_packet_size_bytes, type_hash).Observe(packets[part_id].ByteSizeLong());
+        writer->write(packets[part_id], part_id);
     }
 }
 
@@ -308,44 +385,16 @@ inline void initDestColumns(const Block & input_block, std::vector<MutableColumn
     }
 }
 
-void computeHash(const Block & input_block,
-                 uint32_t bucket_num,
-                 const TiDB::TiDBCollators & collators,
-                 std::vector<String> & partition_key_containers,
-                 const std::vector<Int64> & partition_col_ids,
-                 std::vector<std::vector<MutableColumnPtr>> & result_columns)
+/// Move the columns out of `block` and clear them, so that their memory can be reused.
+inline MutableColumns takeColumnsForReuse(Block & block)
 {
-    size_t rows = input_block.rows();
-    WeakHash32 hash(rows);
-
-    // get hash values by all partition key columns
-    for (size_t i = 0; i < partition_col_ids.size(); ++i)
+    MutableColumns columns(block.columns());
+    for (size_t i = 0; i < block.columns(); ++i)
     {
-        input_block.getByPosition(partition_col_ids[i]).column->updateWeakHash32(hash, collators[i], partition_key_containers[i]);
-    }
-
-    const auto & hash_data = hash.getData();
-
-    // partition each row
-    IColumn::Selector selector(rows);
-    for (size_t row = 0; row < rows; ++row)
-    {
-        /// Row from interval [(2^32 / bucket_num) * i, (2^32 / bucket_num) * (i + 1)) goes to bucket with number i.
-        selector[row] = hash_data[row]; /// [0, 2^32)
-        selector[row] *= bucket_num; /// [0, bucket_num * 2^32), selector stores 64 bit values.
-        selector[row] >>= 32u; /// [0, bucket_num)
-    }
-
-    for (size_t col_id = 0; col_id < input_block.columns(); ++col_id)
-    {
-        // Scatter columns to different partitions
-        std::vector<MutableColumnPtr> part_columns = input_block.getByPosition(col_id).column->scatter(bucket_num, selector);
-        assert(part_columns.size() == bucket_num);
-        for (size_t bucket_idx = 0; bucket_idx < bucket_num; ++bucket_idx)
-        {
-            result_columns[bucket_idx][col_id] = std::move(part_columns[bucket_idx]);
-        }
+        columns[i] = (*std::move(block.getByPosition(i).column)).mutate();
+        columns[i]->popBack(columns[i]->size());
     }
+    return columns;
 }
 
 /// Hash exchanging data among only TiFlash nodes. Only be called when enable_fine_grained_shuffle is false.
@@ -358,31 +407,56 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::p
     static_assert(!enable_fine_grained_shuffle);
     std::vector<mpp::MPPDataPacket> packet(partition_num);
     std::vector<size_t> responses_row_count(partition_num);
+    std::vector<PartitionBlocks> partition_blocks(partition_num);
     handleExecSummary<send_exec_summary_at_last>(input_blocks, packet, response);
     if (input_blocks.empty())
         return;
 
     initInputBlocks(input_blocks);
     Block dest_block = input_blocks[0].cloneEmpty();
-    std::vector<String> partition_key_containers(collators.size());
-    for (const auto & block : input_blocks)
-    {
-        std::vector<MutableColumns> dest_tbl_cols(partition_num);
-        initDestColumns(block, dest_tbl_cols);
-
-        computeHash(block, partition_num, collators, partition_key_containers, partition_col_ids, dest_tbl_cols);
+    std::vector<MutableColumns> dest_tbl_cols(partition_num);
+    initDestColumns(input_blocks[0], dest_tbl_cols);
+    /// Move the rows of part_id out of dest_tbl_cols into its packet or its blocks.
+    auto flush_partition = [&](size_t part_id) {
+        dest_block.setColumns(std::move(dest_tbl_cols[part_id]));
+        responses_row_count[part_id] += dest_block.rows();
+        if (canWriteBlocks(part_id))
+        {
+            // The columns are passed to the receiver, so they can not be reused.
+            if (dest_block.rows() > 0)
+                partition_blocks[part_id].blocks.push_back(dest_block);
+            dest_tbl_cols[part_id] = input_blocks[0].cloneEmptyColumns();
+            return;
+        }
+        chunk_codec_stream->encode(dest_block, 0, dest_block.rows());
+        packet[part_id].add_chunks(chunk_codec_stream->getString());
+        chunk_codec_stream->clear();
+        dest_tbl_cols[part_id] = takeColumnsForReuse(dest_block);
+    };
 
+    if (batchByBytes())
+    {
+        // The rows of each partition are squashed into one chunk.
+        for (const auto & block : input_blocks)
+            partitioner->partition(block, dest_tbl_cols);
         for (size_t part_id = 0; part_id < partition_num; ++part_id)
         {
-            dest_block.setColumns(std::move(dest_tbl_cols[part_id]));
-            responses_row_count[part_id] += dest_block.rows();
-            chunk_codec_stream->encode(dest_block, 0, dest_block.rows());
-            packet[part_id].add_chunks(chunk_codec_stream->getString());
-            chunk_codec_stream->clear();
+            if (!dest_tbl_cols[part_id].empty() && !dest_tbl_cols[part_id][0]->empty())
+                flush_partition(part_id);
+        }
+    }
+    else
+    {
+        // The columns of each partition are reused across the input blocks after they are encoded.
+        for (const auto & block : input_blocks)
+        {
+            partitioner->partition(block, dest_tbl_cols);
+            for (size_t part_id = 0; part_id < partition_num; ++part_id)
+                flush_partition(part_id);
         }
     }
 
-    writePackets<send_exec_summary_at_last>(responses_row_count, packet);
+    writePackets<send_exec_summary_at_last>(responses_row_count, packet, partition_blocks);
 }
 
 /// Hash exchanging data among only TiFlash nodes. Only be called when enable_fine_grained_shuffle is true.
@@ -400,9 +474,10 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::b
 
     std::vector<mpp::MPPDataPacket> packet(partition_num);
     std::vector<size_t> responses_row_count(partition_num, 0);
+    std::vector<PartitionBlocks> partition_blocks(partition_num);
 
-    // fine_grained_shuffle_stream_count is in [0, 1024], and partition_num is uint16_t, so will not overflow.
-    uint32_t bucket_num = partition_num * fine_grained_shuffle_stream_count;
+    uint32_t bucket_num = partitioner->getBucketNum();
+    assert(bucket_num == partition_num * fine_grained_shuffle_stream_count);
     handleExecSummary<send_exec_summary_at_last>(blocks, packet, response);
     if (!blocks.empty())
     {
@@ -410,22 +485,9 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::b
         initInputBlocks(blocks);
         initDestColumns(blocks[0], final_dest_tbl_columns);
 
-        // Hash partition input_blocks into bucket_num.
+        // Hash partition input_blocks into bucket_num, the rows are appended to the final columns directly.
         for (const auto & block : blocks)
-        {
-            std::vector<String> partition_key_containers(collators.size());
-            std::vector<MutableColumns> dest_tbl_columns(bucket_num);
-            initDestColumns(block, dest_tbl_columns);
-            computeHash(block, bucket_num, collators, partition_key_containers, partition_col_ids, dest_tbl_columns);
-            for (size_t bucket_idx = 0; bucket_idx < bucket_num; ++bucket_idx)
-            {
-                for (size_t col_id = 0; col_id < block.columns(); ++col_id)
-                {
-                    const MutableColumnPtr & src_col = dest_tbl_columns[bucket_idx][col_id];
-                    final_dest_tbl_columns[bucket_idx][col_id]->insertRangeFrom(*src_col, 0, src_col->size());
-                }
-            }
-        }
+            partitioner->partition(block, final_dest_tbl_columns);
 
         // For i-th stream_count buckets, send to i-th tiflash node.
         for (size_t bucket_idx = 0; bucket_idx < bucket_num; bucket_idx += fine_grained_shuffle_stream_count)
@@ -439,6 +501,15 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::b
                 dest_block.setColumns(std::move(final_dest_tbl_columns[bucket_idx + stream_idx]));
                 row_count_per_part += dest_block.rows();
 
+                if (canWriteBlocks(part_id))
+                {
+                    if (dest_block.rows() > 0)
+                    {
+                        partition_blocks[part_id].blocks.push_back(std::move(dest_block));
+                        partition_blocks[part_id].stream_ids.push_back(stream_idx);
+                    }
+                    continue;
+                }
                 chunk_codec_stream->encode(dest_block, 0, dest_block.rows());
                 packet[part_id].add_chunks(chunk_codec_stream->getString());
                 packet[part_id].add_stream_ids(stream_idx);
@@ -448,10 +519,11 @@ void StreamingDAGResponseWriter<StreamWriterPtr, enable_fine_grained_shuffle>::b
         }
     }
 
-    writePackets<send_exec_summary_at_last>(responses_row_count, packet);
+    writePackets<send_exec_summary_at_last>(responses_row_count, packet, partition_blocks);
 
     blocks.clear();
     rows_in_blocks = 0;
+    bytes_in_blocks = 0;
 }
 
 template class StreamingDAGResponseWriter<StreamWriterPtr, /*enable_fine_grained_shuffle=*/true>;
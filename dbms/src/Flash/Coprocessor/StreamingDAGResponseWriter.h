@@ -15,11 +15,13 @@
 #pragma once
 
 #include <Common/Logger.h>
+#include <Common/Stopwatch.h>
 #include <Core/Types.h>
 #include <DataTypes/IDataType.h>
 #include <Flash/Coprocessor/ChunkCodec.h>
 #include <Flash/Coprocessor/DAGQuerySource.h>
 #include <Flash/Coprocessor/DAGResponseWriter.h>
+#include <Flash/Coprocessor/HashPartitioner.h>
 #include <common/logger_useful.h>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -33,6 +35,7 @@ namespace DB
 /// Serializes the stream of blocks and sends them to TiDB or TiFlash with different serialization paths.
 /// When sending data to TiDB, blocks with extra info are written into tipb::SelectResponse, then the whole tipb::SelectResponse is further serialized into mpp::MPPDataPacket.data.
 /// Differently when sending data to TiFlash, blocks with only tuples are directly serialized into mpp::MPPDataPacket.chunks, but for the last block, its extra info (like execution summaries) is written into tipb::SelectResponse, then further serialized into mpp::MPPDataPacket.data.
+/// When sending data to TiFlash in the same process through a local tunnel, blocks are passed as they are, without being serialized.
 template <class StreamWriterPtr, bool enable_fine_grained_shuffle>
 class StreamingDAGResponseWriter : public DAGResponseWriter
 {
@@ -47,11 +50,25 @@ public:
         bool should_send_exec_summary_at_last,
         DAGContext & dag_context_,
         UInt64 fine_grained_shuffle_stream_count_,
-        UInt64 fine_grained_shuffle_batch_size);
+        UInt64 fine_grained_shuffle_batch_size,
+        UInt64 batch_send_min_bytes_ = 0,
+        UInt64 batch_send_max_delay_ms_ = 0);
     void write(const Block & block) override;
     void finishWrite() override;
 
 private:
+    /// The blocks written to a local tunnel directly, and their stream ids for fine grained shuffle.
+    struct PartitionBlocks
+    {
+        std::vector<Block> blocks;
+        std::vector<UInt64> stream_ids;
+    };
+
+    bool canWriteBlocks(size_t partition_id) const;
+    bool hasBlockTunnel() const;
+    /// Whether the blocks of the hash exchange or the batch coprocessor stream are squashed by bytes, see batch_send_min_bytes.
+    bool batchByBytes() const { return batch_send_min_bytes > 0 && (exchange_type == tipb::ExchangeType::Hash || !dag_context.isMPPTask()); }
+
     template <bool send_exec_summary_at_last>
     void batchWrite();
     template <bool send_exec_summary_at_last>
@@ -67,7 +84,9 @@ private:
                            std::vector<mpp::MPPDataPacket> & packet,
                            tipb::SelectResponse & response) const;
     template <bool send_exec_summary_at_last>
-    void writePackets(const std::vector<size_t> & responses_row_count, std::vector<mpp::MPPDataPacket> & packets) const;
+    void writePackets(const std::vector<size_t> & responses_row_count,
+                      std::vector<mpp::MPPDataPacket> & packets,
+                      std::vector<PartitionBlocks> & partition_blocks) const;
 
     Int64 batch_send_min_limit;
     bool should_send_exec_summary_at_last; /// only one stream needs to sending execution summaries at last.
@@ -81,6 +100,17 @@ private:
     std::unique_ptr<ChunkCodecStream> chunk_codec_stream;
     UInt64 fine_grained_shuffle_stream_count;
     UInt64 fine_grained_shuffle_batch_size;
+    /// For hash exchange, the blocks are squashed until each partition has about batch_send_min_bytes bytes, and the rows
+    /// of each partition are encoded into one chunk. The squashed blocks are sent anyway once the first of them has waited
+    /// for batch_send_max_delay_ms, so a slow input does not stall the receivers. 0 means batching by rows as usual.
+    /// For the batch coprocessor stream, the squashed blocks are sent in one response, which saves the per-response
+    /// overhead of bulk reads like exports.
+    UInt64 batch_send_min_bytes;
+    UInt64 batch_send_max_delay_ms;
+    size_t bytes_in_blocks = 0;
+    Stopwatch batch_watch;
+    /// only for hash exchange, its buckets are partition_num * fine_grained_shuffle_stream_count with fine grained shuffle.
+    std::unique_ptr<HashPartitioner> partitioner;
 };
 
 } // namespace DB
@@ -0,0 +1,88 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/HashTable/Hash.h>
+#include <Common/LRUCache.h>
+#include <Common/ProfileEvents.h>
+#include <Common/SipHash.h>
+#include <Core/NamesAndTypes.h>
+#include <Flash/Coprocessor/DAGExpressionAnalyzer.h>
+#include <tipb/executor.pb.h>
+
+namespace ProfileEvents
+{
+extern const Event TableScanColumnsCacheHits;
+extern const Event TableScanColumnsCacheMisses;
+} // namespace ProfileEvents
+
+namespace DB
+{
+/// The columns read by a table scan, mapped from the column infos of the `TiDBTableScan` to the columns of the storage.
+struct TableScanColumns
+{
+    Names required_columns;
+    NamesAndTypes source_columns;
+    std::vector<ExtraCastAfterTSMode> need_cast_column;
+};
+
+/** Cache of the columns read by the table scans in the coprocessor requests, thread-safe.
+  * The requests of the same shape only differ in regions and start_ts, so the column mapping, which looks up the
+  * columns of the storage one by one, is shared by them.
+  * The key is the hash of (logical table id, schema version of the storage, column infos of the table scan), the schema
+  * version changes whenever the columns of the storage are altered.
+  */
+class TableScanColumnsCache : public LRUCache<UInt128, TableScanColumns, TrivialHash>
+{
+private:
+    using Base = LRUCache<UInt128, TableScanColumns, TrivialHash>;
+
+public:
+    explicit TableScanColumnsCache(size_t max_entries)
+        : Base(max_entries)
+    {}
+
+    static UInt128 hash(Int64 logical_table_id, Int64 storage_schema_version, const google::protobuf::RepeatedPtrField<tipb::ColumnInfo> & columns)
+    {
+        UInt128 key;
+        SipHash hash;
+        hash.update(logical_table_id);
+        hash.update(storage_schema_version);
+        hash.update(columns.size());
+        for (const auto & ci : columns)
+        {
+            hash.update(ci.column_id());
+            hash.update(ci.tp());
+        }
+        hash.get128(key);
+        return key;
+    }
+
+    template <typename LoadFunc>
+    MappedPtr getOrSet(const Key & key, LoadFunc && load)
+    {
+        auto [res, loaded] = Base::getOrSet(key, std::forward<LoadFunc>(load));
+        if (loaded)
+            ProfileEvents::increment(ProfileEvents::TableScanColumnsCacheMisses);
+        else
+            ProfileEvents::increment(ProfileEvents::TableScanColumnsCacheHits);
+        return res;
+    }
+};
+
+using TableScanColumnsCachePtr = std::shared_ptr<TableScanColumnsCache>;
+
+} // namespace DB
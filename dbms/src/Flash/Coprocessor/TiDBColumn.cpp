@@ -72,6 +72,42 @@ void TiDBColumn::appendNullBitMap(bool value)
     }
 }
 
+void TiDBColumn::appendNullBitMapBulk(const NullMap * null_map, size_t start_index, size_t end_index)
+{
+    const size_t rows = end_index - start_index;
+    null_bitmap.resize((length + rows + 7) >> 3, 0);
+    size_t i = 0;
+    // Fill bit by bit until the bitmap is aligned to byte.
+    for (; i < rows && ((length + i) & 7); ++i)
+    {
+        if (null_map == nullptr || !(*null_map)[start_index + i])
+            null_bitmap[(length + i) >> 3] |= (1 << ((length + i) & 7));
+        else
+            null_cnt++;
+    }
+    // Fill 8 rows at a time. The bytes in null map are 0 or 1, so the multiplication gathers
+    // the lowest bit of the i-th byte into the i-th bit of the highest byte, without carry.
+    for (; i + 8 <= rows; i += 8)
+    {
+        UInt8 nulls = 0;
+        if (null_map != nullptr)
+        {
+            UInt64 word;
+            std::memcpy(&word, &(*null_map)[start_index + i], sizeof(word));
+            nulls = static_cast<UInt8>(((toLittleEndian(word) & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56);
+        }
+        null_bitmap[(length + i) >> 3] = static_cast<UInt8>(~nulls);
+        null_cnt += __builtin_popcount(nulls);
+    }
+    for (; i < rows; ++i)
+    {
+        if (null_map == nullptr || !(*null_map)[start_index + i])
+            null_bitmap[(length + i) >> 3] |= (1 << ((length + i) & 7));
+        else
+            null_cnt++;
+    }
+}
+
 void TiDBColumn::finishAppendFixed()
 {
     current_data_size += fixed_size;
@@ -173,6 +209,91 @@ void TiDBColumn::append(DB::Float64 value)
     finishAppendFixed();
 }
 
+template <typename T>
+void TiDBColumn::appendFixedBulk(const PaddedPODArray<T> & values, const NullMap * null_map, size_t start_index, size_t end_index)
+{
+    static_assert(std::is_arithmetic_v<T>);
+    if (unlikely(!isFixed() || (std::is_floating_point_v<T> ? sizeof(T) != static_cast<size_t>(fixed_size) : sizeof(UInt64) != static_cast<size_t>(fixed_size))))
+        throw Exception(fmt::format("Unexpected element length {} of chunk column for bulk append", fixed_size), ErrorCodes::LOGICAL_ERROR);
+
+    std::vector<UInt64> widened;
+    auto write_run = [&](size_t begin, size_t end) {
+        if (begin == end)
+            return;
+        if constexpr (sizeof(T) == sizeof(UInt64) || std::is_floating_point_v<T>)
+        {
+            // The values are stored in little endian on the platforms TiFlash runs on, copy them directly.
+            data->write(reinterpret_cast<const char *>(&values[begin]), (end - begin) * sizeof(T));
+        }
+        else
+        {
+            widened.resize(end - begin);
+            for (size_t i = begin; i < end; ++i)
+                widened[i - begin] = toLittleEndian(static_cast<UInt64>(values[i]));
+            data->write(reinterpret_cast<const char *>(widened.data()), widened.size() * sizeof(UInt64));
+        }
+    };
+
+    if (null_map == nullptr)
+    {
+        write_run(start_index, end_index);
+    }
+    else
+    {
+        size_t run_begin = start_index;
+        for (size_t i = start_index; i < end_index; ++i)
+        {
+            if (!(*null_map)[i])
+                continue;
+            write_run(run_begin, i);
+            writeString(default_value, *data);
+            run_begin = i + 1;
+        }
+        write_run(run_begin, end_index);
+    }
+
+    appendNullBitMapBulk(null_map, start_index, end_index);
+    current_data_size += (end_index - start_index) * fixed_size;
+    length += end_index - start_index;
+}
+
+template void TiDBColumn::appendFixedBulk<UInt8>(const PaddedPODArray<UInt8> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<UInt16>(const PaddedPODArray<UInt16> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<UInt32>(const PaddedPODArray<UInt32> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<UInt64>(const PaddedPODArray<UInt64> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<Int8>(const PaddedPODArray<Int8> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<Int16>(const PaddedPODArray<Int16> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<Int32>(const PaddedPODArray<Int32> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<Int64>(const PaddedPODArray<Int64> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<Float32>(const PaddedPODArray<Float32> &, const NullMap *, size_t, size_t);
+template void TiDBColumn::appendFixedBulk<Float64>(const PaddedPODArray<Float64> &, const NullMap *, size_t, size_t);
+
+void TiDBColumn::appendStringBulk(const ColumnString & column, const NullMap * null_map, size_t start_index, size_t end_index)
+{
+    if (unlikely(isFixed()))
+        throw Exception(fmt::format("Unexpected element length {} of chunk column for bulk append", fixed_size), ErrorCodes::LOGICAL_ERROR);
+
+    const auto & chars = column.getChars();
+    const auto & offsets = column.getOffsets();
+    var_offsets.reserve(var_offsets.size() + end_index - start_index);
+    // The strings in ColumnString are ended with '\0' which is not encoded, convert the offsets row by row.
+    size_t prev_offset = start_index == 0 ? 0 : offsets[start_index - 1];
+    for (size_t i = start_index; i < end_index; ++i)
+    {
+        if (null_map == nullptr || !(*null_map)[i])
+        {
+            const size_t size = offsets[i] - prev_offset - 1;
+            data->write(reinterpret_cast<const char *>(&chars[prev_offset]), size);
+            current_data_size += size;
+        }
+        var_offsets.push_back(current_data_size);
+        prev_offset = offsets[i];
+    }
+
+    appendNullBitMapBulk(null_map, start_index, end_index);
+    length += end_index - start_index;
+}
+
 void TiDBColumn::encodeColumn(WriteBuffer & ss)
 {
     encodeLittleEndian<UInt32>(length, ss);
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
 #include <DataStreams/IBlockInputStream.h>
 #include <Flash/Coprocessor/DAGUtils.h>
 #include <Flash/Coprocessor/TiDBBit.h>
@@ -41,6 +43,12 @@ public:
     void append(const TiDBDecimal & decimal);
     void append(const TiDBBit & bit);
     void append(const TiDBEnum & ti_enum);
+    /// Append the rows in [start_index, end_index) in bulk, `null_map` is nullptr if the column is not nullable.
+    /// The fixed-length values are copied into the chunk by runs of not null rows, the integers are widened to
+    /// `fixed_size` bytes like `append(Int64)` / `append(UInt64)`.
+    template <typename T>
+    void appendFixedBulk(const PaddedPODArray<T> & values, const NullMap * null_map, size_t start_index, size_t end_index);
+    void appendStringBulk(const ColumnString & column, const NullMap * null_map, size_t start_index, size_t end_index);
     void encodeColumn(WriteBuffer & ss);
     void clear();
 
@@ -49,6 +57,7 @@ private:
     void finishAppendFixed();
     void finishAppendVar(UInt32 size);
     void appendNullBitMap(bool value);
+    void appendNullBitMapBulk(const NullMap * null_map, size_t start_index, size_t end_index);
 
     UInt32 length;
     UInt32 null_cnt;
@@ -180,5 +180,190 @@ try
 }
 CATCH
 
+TEST_F(TestStreamingDAGResponseWriter, testBatchWriteByBytes)
+try
+{
+    const size_t block_rows = 256;
+    const size_t block_num = 8;
+    const uint16_t part_num = 4;
+    std::vector<Int64> data_set;
+    for (size_t i = 0; i < block_rows; ++i)
+        data_set.push_back(i);
+    BlockPtr block = prepareBlock(data_set);
+
+    auto run = [&](UInt64 batch_send_max_delay_ms) {
+        std::vector<std::vector<mpp::MPPDataPacket>> packets(part_num);
+        auto checker = [&packets](mpp::MPPDataPacket & packet, uint16_t part_id) {
+            packets[part_id].push_back(packet);
+        };
+        auto mock_writer = std::make_shared<MockStreamWriter>(checker, part_num);
+        // batch_send_min_limit is 1, so every block would be sent alone without batch_send_min_bytes.
+        auto dag_writer = std::make_shared<StreamingDAGResponseWriter<std::shared_ptr<MockStreamWriter>, /*enable_fine_grained_shuffle=*/false>>(
+            mock_writer,
+            part_col_ids,
+            part_col_collators,
+            tipb::ExchangeType::Hash,
+            /*records_per_chunk=*/1,
+            /*batch_send_min_limit=*/1,
+            /*should_send_exec_summary_at_last=*/false,
+            *dag_context_ptr,
+            /*fine_grained_shuffle_stream_count=*/0,
+            /*fine_grained_shuffle_batch_size=*/0,
+            /*batch_send_min_bytes=*/1024 * 1024 * 1024,
+            batch_send_max_delay_ms);
+        for (size_t i = 0; i < block_num; ++i)
+            dag_writer->write(*block);
+        dag_writer->finishWrite();
+        return packets;
+    };
+
+    // All the blocks are squashed into one chunk of each partition.
+    auto packets = run(/*batch_send_max_delay_ms=*/3600 * 1000);
+    size_t total_rows = 0;
+    for (const auto & part_packets : packets)
+    {
+        ASSERT_EQ(part_packets.size(), 1);
+        ASSERT_EQ(part_packets[0].chunks_size(), 1);
+        total_rows += CHBlockChunkCodec::decode(part_packets[0].chunks(0), *block).rows();
+    }
+    ASSERT_EQ(total_rows, block_rows * block_num);
+
+    // The blocks are sent without waiting when the delay is 0.
+    packets = run(/*batch_send_max_delay_ms=*/0);
+    for (const auto & part_packets : packets)
+        ASSERT_EQ(part_packets.size(), block_num);
+}
+CATCH
+
+struct MockResponseWriter
+{
+    void write(mpp::MPPDataPacket &) { FAIL() << "cannot reach here, only consider the batch coprocessor stream"; }
+    void write(mpp::MPPDataPacket &, uint16_t) { FAIL() << "cannot reach here, only consider the batch coprocessor stream"; }
+    void write(tipb::SelectResponse &, uint16_t) { FAIL() << "cannot reach here, only consider the batch coprocessor stream"; }
+    void write(tipb::SelectResponse & response) { responses.push_back(response); }
+    uint16_t getPartitionNum() const { return 0; }
+
+    std::vector<tipb::SelectResponse> responses;
+};
+
+TEST_F(TestStreamingDAGResponseWriter, testBatchCopWriteByBytes)
+try
+{
+    dag_context_ptr->is_mpp_task = false;
+    const size_t block_rows = 256;
+    const size_t block_num = 8;
+    std::vector<Int64> data_set;
+    for (size_t i = 0; i < block_rows; ++i)
+        data_set.push_back(i);
+    BlockPtr block = prepareBlock(data_set);
+
+    auto run = [&](UInt64 batch_send_min_bytes) {
+        auto mock_writer = std::make_shared<MockResponseWriter>();
+        auto dag_writer = std::make_shared<StreamingDAGResponseWriter<std::shared_ptr<MockResponseWriter>, /*enable_fine_grained_shuffle=*/false>>(
+            mock_writer,
+            std::vector<Int64>(),
+            TiDB::TiDBCollators(),
+            tipb::ExchangeType::PassThrough,
+            /*records_per_chunk=*/1,
+            /*batch_send_min_limit=*/1,
+            /*should_send_exec_summary_at_last=*/false,
+            *dag_context_ptr,
+            /*fine_grained_shuffle_stream_count=*/0,
+            /*fine_grained_shuffle_batch_size=*/0,
+            batch_send_min_bytes,
+            /*batch_send_max_delay_ms=*/3600 * 1000);
+        for (size_t i = 0; i < block_num; ++i)
+            dag_writer->write(*block);
+        dag_writer->finishWrite();
+        return mock_writer->responses;
+    };
+
+    // Every block is sent in its own response without batch_send_min_bytes.
+    auto responses = run(/*batch_send_min_bytes=*/0);
+    ASSERT_EQ(responses.size(), block_num);
+
+    // The blocks are squashed until about 2 blocks of bytes.
+    responses = run(/*batch_send_min_bytes=*/block->bytes() * 2);
+    ASSERT_EQ(responses.size(), block_num / 2);
+    size_t total_rows = 0;
+    for (const auto & response : responses)
+    {
+        ASSERT_EQ(response.chunks_size(), 2);
+        for (const auto & chunk : response.chunks())
+            total_rows += CHBlockChunkCodec::decode(chunk.rows_data(), *block).rows();
+    }
+    ASSERT_EQ(total_rows, block_rows * block_num);
+}
+CATCH
+
+TEST_F(TestStreamingDAGResponseWriter, testHashPartitioner)
+try
+{
+    std::vector<Int64> data_set;
+    for (Int64 i = 0; i < 1024; ++i)
+        data_set.push_back(i);
+    BlockPtr block = prepareBlock(data_set);
+
+    const uint32_t bucket_num = 8;
+    HashPartitioner partitioner(part_col_ids, part_col_collators, bucket_num);
+    IColumn::Selector selector = partitioner.computeSelector(*block);
+    std::vector<size_t> bucket_rows(bucket_num, 0);
+    for (auto bucket : selector)
+    {
+        ASSERT_LT(bucket, bucket_num);
+        ++bucket_rows[bucket];
+    }
+
+    // The rows are appended to the given columns, so partitioning the block twice doubles the rows.
+    std::vector<MutableColumns> dest_columns(bucket_num);
+    for (auto & columns : dest_columns)
+        columns = block->cloneEmptyColumns();
+    partitioner.partition(*block, dest_columns);
+    partitioner.partition(*block, dest_columns);
+    for (size_t bucket = 0; bucket < bucket_num; ++bucket)
+    {
+        for (const auto & column : dest_columns[bucket])
+            ASSERT_EQ(column->size(), bucket_rows[bucket] * 2);
+    }
+}
+CATCH
+
+TEST_F(TestStreamingDAGResponseWriter, testCompressChunk)
+try
+{
+    std::vector<Int64> data_set(8192, 1);
+    BlockPtr block = prepareBlock(data_set);
+
+    CHBlockChunkCodec codec;
+    auto codec_stream = codec.newCodecStream(makeFields());
+    codec_stream->encode(*block, 0, block->rows());
+    String chunk = codec_stream->getString();
+    ASSERT_FALSE(CHBlockChunkCodec::isCompressed(chunk));
+
+    for (auto method : {CompressionMethod::LZ4, CompressionMethod::ZSTD})
+    {
+        String compressed_chunk = CHBlockChunkCodec::compress(chunk, method);
+        ASSERT_TRUE(CHBlockChunkCodec::isCompressed(compressed_chunk));
+        ASSERT_LT(compressed_chunk.size(), chunk.size());
+        ASSERT_EQ(CHBlockChunkCodec::decompress(compressed_chunk), chunk);
+
+        Block decoded_block = CHBlockChunkCodec::decode(compressed_chunk, *block);
+        ASSERT_EQ(decoded_block.rows(), block->rows());
+        ASSERT_EQ(decoded_block.columns(), block->columns());
+        for (size_t i = 0; i < block->columns(); ++i)
+        {
+            const auto & decoded_column = decoded_block.getByPosition(i).column;
+            const auto & column = block->getByPosition(i).column;
+            for (size_t row = 0; row < block->rows(); ++row)
+                ASSERT_EQ((*decoded_column)[row], (*column)[row]);
+        }
+    }
+
+    // fall back to the uncompressed chunk if it can not be compressed.
+    String tiny_chunk = "\x01";
+    ASSERT_EQ(CHBlockChunkCodec::compress(tiny_chunk, CompressionMethod::LZ4), tiny_chunk);
+}
+CATCH
+
 } // namespace tests
 } // namespace DB
@@ -0,0 +1,82 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Flash/Coprocessor/TableScanColumnsCache.h>
+#include <Storages/Transaction/TiDB.h>
+#include <gtest/gtest.h>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+google::protobuf::RepeatedPtrField<tipb::ColumnInfo> makeColumns(const std::vector<std::pair<Int64, Int32>> & ids_and_types)
+{
+    google::protobuf::RepeatedPtrField<tipb::ColumnInfo> columns;
+    for (const auto & [id, tp] : ids_and_types)
+    {
+        auto * ci = columns.Add();
+        ci->set_column_id(id);
+        ci->set_tp(tp);
+    }
+    return columns;
+}
+} // namespace
+
+TEST(TableScanColumnsCacheTest, Hash)
+{
+    auto columns = makeColumns({{1, TiDB::TypeLongLong}, {2, TiDB::TypeString}});
+    auto key = TableScanColumnsCache::hash(100, 10, columns);
+    ASSERT_EQ(key, TableScanColumnsCache::hash(100, 10, makeColumns({{1, TiDB::TypeLongLong}, {2, TiDB::TypeString}})));
+
+    // Another table or schema version
+    ASSERT_NE(key, TableScanColumnsCache::hash(101, 10, columns));
+    ASSERT_NE(key, TableScanColumnsCache::hash(100, 11, columns));
+    // Other columns, in another order, or of another type
+    ASSERT_NE(key, TableScanColumnsCache::hash(100, 10, makeColumns({{1, TiDB::TypeLongLong}})));
+    ASSERT_NE(key, TableScanColumnsCache::hash(100, 10, makeColumns({{2, TiDB::TypeString}, {1, TiDB::TypeLongLong}})));
+    ASSERT_NE(key, TableScanColumnsCache::hash(100, 10, makeColumns({{1, TiDB::TypeLongLong}, {2, TiDB::TypeTimestamp}})));
+}
+
+TEST(TableScanColumnsCacheTest, GetOrSet)
+{
+    TableScanColumnsCache cache(2);
+    size_t loads = 0;
+    auto load = [&] {
+        ++loads;
+        return std::make_shared<TableScanColumns>(TableScanColumns{
+            {"a", "b"},
+            {{"a", std::make_shared<DataTypeInt64>()}, {"b", std::make_shared<DataTypeString>()}},
+            {ExtraCastAfterTSMode::None, ExtraCastAfterTSMode::None}});
+    };
+
+    auto key = TableScanColumnsCache::hash(100, 10, makeColumns({{1, TiDB::TypeLongLong}, {2, TiDB::TypeString}}));
+    auto columns = cache.getOrSet(key, load);
+    ASSERT_EQ(loads, 1);
+    ASSERT_EQ(columns->required_columns, (Names{"a", "b"}));
+    ASSERT_EQ(cache.getOrSet(key, load), columns);
+    ASSERT_EQ(loads, 1);
+
+    // The columns of the table altered
+    auto new_key = TableScanColumnsCache::hash(100, 11, makeColumns({{1, TiDB::TypeLongLong}, {2, TiDB::TypeString}}));
+    ASSERT_NE(cache.getOrSet(new_key, load), columns);
+    ASSERT_EQ(loads, 2);
+}
+
+} // namespace tests
+} // namespace DB
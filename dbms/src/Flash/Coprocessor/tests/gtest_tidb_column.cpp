@@ -0,0 +1,120 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Flash/Coprocessor/TiDBColumn.h>
+#include <IO/WriteBufferFromString.h>
+#include <gtest/gtest.h>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+String encode(TiDBColumn & column)
+{
+    WriteBufferFromOwnString buf;
+    column.encodeColumn(buf);
+    return buf.releaseStr();
+}
+
+NullMap genNullMap(size_t rows)
+{
+    NullMap null_map(rows);
+    for (size_t i = 0; i < rows; ++i)
+        null_map[i] = (i % 3 == 1 || i % 7 == 0) ? 1 : 0;
+    return null_map;
+}
+} // namespace
+
+TEST(TiDBColumn_test, AppendFixedBulk)
+{
+    constexpr size_t rows = 45;
+    // Append some rows first so that the null bitmap is not aligned to byte.
+    constexpr size_t start = 3;
+    PaddedPODArray<Int32> values(rows);
+    for (size_t i = 0; i < rows; ++i)
+        values[i] = static_cast<Int32>(i) - 20;
+    const auto null_map = genNullMap(rows);
+
+    for (const auto * nulls : {static_cast<const NullMap *>(nullptr), &null_map})
+    {
+        TiDBColumn expected(8);
+        TiDBColumn actual(8);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            if (nulls != nullptr && (*nulls)[i])
+                expected.appendNull();
+            else
+                expected.append(static_cast<UInt64>(values[i]));
+        }
+        actual.appendFixedBulk(values, nulls, 0, start);
+        actual.appendFixedBulk(values, nulls, start, rows);
+        ASSERT_EQ(encode(actual), encode(expected));
+    }
+}
+
+TEST(TiDBColumn_test, AppendFloatBulk)
+{
+    constexpr size_t rows = 20;
+    PaddedPODArray<Float64> values(rows);
+    for (size_t i = 0; i < rows; ++i)
+        values[i] = static_cast<Float64>(i) / 3;
+    const auto null_map = genNullMap(rows);
+
+    TiDBColumn expected(8);
+    TiDBColumn actual(8);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (null_map[i])
+            expected.appendNull();
+        else
+            expected.append(values[i]);
+    }
+    actual.appendFixedBulk(values, &null_map, 0, rows);
+    ASSERT_EQ(encode(actual), encode(expected));
+}
+
+TEST(TiDBColumn_test, AppendStringBulk)
+{
+    constexpr size_t rows = 30;
+    constexpr size_t start = 5;
+    auto column = ColumnString::create();
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const String value(i % 4, 'a' + i % 26);
+        column->insertData(value.data(), value.size());
+    }
+    const auto null_map = genNullMap(rows);
+
+    for (const auto * nulls : {static_cast<const NullMap *>(nullptr), &null_map})
+    {
+        TiDBColumn expected(VAR_SIZE);
+        TiDBColumn actual(VAR_SIZE);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            if (nulls != nullptr && (*nulls)[i])
+                expected.appendNull();
+            else
+                expected.append(column->getDataAt(i));
+        }
+        actual.appendStringBulk(*column, nulls, 0, start);
+        actual.appendStringBulk(*column, nulls, start, rows);
+        ASSERT_EQ(encode(actual), encode(expected));
+    }
+}
+
+} // namespace tests
+} // namespace DB
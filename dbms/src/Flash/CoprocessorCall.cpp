@@ -0,0 +1,78 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/TiFlashMetrics.h>
+#include <Flash/CoprocessorCall.h>
+
+namespace DB
+{
+CoprocessorCallData::CoprocessorCallData(AsyncFlashService * service, grpc::ServerCompletionQueue * cq, grpc::ServerCompletionQueue * notify_cq, const std::shared_ptr<std::atomic<bool>> & is_shutdown)
+    : service(service)
+    , cq(cq)
+    , notify_cq(notify_cq)
+    , is_shutdown(is_shutdown)
+    , responder(&ctx)
+    , state(NEW_REQUEST)
+{
+    GET_METRIC(tiflash_object_count, type_count_of_coprocessor_calldata).Increment();
+    service->requestCoprocessor(&ctx, &request, &responder, cq, notify_cq, asTag());
+}
+
+CoprocessorCallData::~CoprocessorCallData()
+{
+    GET_METRIC(tiflash_object_count, type_count_of_coprocessor_calldata).Decrement();
+}
+
+CoprocessorCallData * CoprocessorCallData::spawn(AsyncFlashService * service, grpc::ServerCompletionQueue * cq, grpc::ServerCompletionQueue * notify_cq, const std::shared_ptr<std::atomic<bool>> & is_shutdown)
+{
+    return new CoprocessorCallData(service, cq, notify_cq, is_shutdown);
+}
+
+void CoprocessorCallData::finish(const grpc::Status & status)
+{
+    state = FINISH;
+    // The tag comes back to `proceed` or `cancel` when the response is sent or the server is shutdown.
+    responder.Finish(response, status, asTag());
+}
+
+void CoprocessorCallData::proceed()
+{
+    if (state == NEW_REQUEST)
+    {
+        state = PROCESSING;
+
+        spawn(service, cq, notify_cq, is_shutdown);
+        if (*is_shutdown)
+        {
+            finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Server is shutting down"));
+            return;
+        }
+        // `finish` is called by the thread of the cop pool, no more event of this call arrives before it.
+        service->asyncCoprocessor(&ctx, &request, &response, [this](const grpc::Status & status) { finish(status); });
+    }
+    else
+    {
+        assert(state == FINISH);
+        delete this;
+    }
+}
+
+void CoprocessorCallData::cancel()
+{
+    // Only the events of NEW_REQUEST and FINISH are delivered, see `proceed`.
+    assert(state == NEW_REQUEST || state == FINISH);
+    delete this;
+}
+} // namespace DB
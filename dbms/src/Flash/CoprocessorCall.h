@@ -0,0 +1,71 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Flash/EstablishCall.h>
+#include <Flash/FlashService.h>
+
+namespace DB
+{
+/// A state machine used for the async grpc api Coprocessor, in the style of `EstablishCallData`.
+/// The request is handled in the cop pool of `FlashService` by `asyncCoprocessor`, so neither gRPC threads nor
+/// the pollers of the completion queues are blocked by it. The response is sent by the thread that handles it.
+class CoprocessorCallData final : public IAsyncCallData
+{
+public:
+    // Spawn a new CoprocessorCallData instance to serve new clients while we process the one for this CoprocessorCallData.
+    // The instance will deallocate itself as part of its FINISH state.
+    static CoprocessorCallData * spawn(
+        AsyncFlashService * service,
+        grpc::ServerCompletionQueue * cq,
+        grpc::ServerCompletionQueue * notify_cq,
+        const std::shared_ptr<std::atomic<bool>> & is_shutdown);
+
+    ~CoprocessorCallData() override;
+
+    void proceed() override;
+
+    void cancel() override;
+
+private:
+    CoprocessorCallData(
+        AsyncFlashService * service,
+        grpc::ServerCompletionQueue * cq,
+        grpc::ServerCompletionQueue * notify_cq,
+        const std::shared_ptr<std::atomic<bool>> & is_shutdown);
+
+    void finish(const grpc::Status & status);
+
+    AsyncFlashService * service;
+
+    ::grpc::ServerCompletionQueue * cq;
+    ::grpc::ServerCompletionQueue * notify_cq;
+    std::shared_ptr<std::atomic<bool>> is_shutdown;
+    ::grpc::ServerContext ctx;
+
+    ::coprocessor::Request request;
+    ::coprocessor::Response response;
+    ::grpc::ServerAsyncResponseWriter<::coprocessor::Response> responder;
+
+    enum CallStatus
+    {
+        NEW_REQUEST,
+        PROCESSING,
+        FINISH
+    };
+    CallStatus state;
+};
+} // namespace DB
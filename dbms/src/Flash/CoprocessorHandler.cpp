@@ -46,10 +46,12 @@ CoprocessorContext::CoprocessorContext(
 CoprocessorHandler::CoprocessorHandler(
     CoprocessorContext & cop_context_,
     const coprocessor::Request * cop_request_,
-    coprocessor::Response * cop_response_)
+    coprocessor::Response * cop_response_,
+    grpc::ServerWriter<coprocessor::Response> * cop_writer_)
     : cop_context(cop_context_)
     , cop_request(cop_request_)
     , cop_response(cop_response_)
+    , cop_writer(cop_writer_)
     , log(&Poco::Logger::get("CoprocessorHandler"))
 {}
 
@@ -109,9 +111,12 @@ grpc::Status CoprocessorHandler::execute()
             dag_context.tidb_host = cop_context.db_context.getClientInfo().current_address.toString();
             cop_context.db_context.setDAGContext(&dag_context);
 
-            DAGDriver driver(cop_context.db_context, cop_request->start_ts() > 0 ? cop_request->start_ts() : dag_request.start_ts_fallback(), cop_request->schema_ver(), &dag_response);
+            const UInt64 start_ts = cop_request->start_ts() > 0 ? cop_request->start_ts() : dag_request.start_ts_fallback();
+            DAGDriver driver(cop_context.db_context, start_ts, cop_request->schema_ver(), &dag_response, cop_writer);
             driver.execute();
-            cop_response->set_data(dag_response.SerializeAsString());
+            // The streamed chunks are already sent, only the error is left in `dag_response`.
+            if (!cop_writer || dag_response.ByteSizeLong() > 0)
+                cop_response->set_data(dag_response.SerializeAsString());
             LOG_FMT_DEBUG(log, "Handle DAG request done");
             break;
         }
@@ -21,6 +21,7 @@
 #ifdef __clang__
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #endif
+#include <grpcpp/impl/codegen/sync_stream.h>
 #include <grpcpp/server_context.h>
 #include <kvproto/coprocessor.pb.h>
 #include <tipb/select.pb.h>
@@ -47,7 +48,13 @@ struct CoprocessorContext
 class CoprocessorHandler
 {
 public:
-    CoprocessorHandler(CoprocessorContext & cop_context_, const coprocessor::Request * cop_request_, coprocessor::Response * response_);
+    /// If `cop_writer_` is not null, the chunks of the DAG request are streamed by it, and only the
+    /// errors are left in `response_`.
+    CoprocessorHandler(
+        CoprocessorContext & cop_context_,
+        const coprocessor::Request * cop_request_,
+        coprocessor::Response * response_,
+        grpc::ServerWriter<coprocessor::Response> * cop_writer_ = nullptr);
 
     virtual ~CoprocessorHandler() = default;
 
@@ -70,6 +77,7 @@ protected:
     CoprocessorContext & cop_context;
     const coprocessor::Request * cop_request;
     coprocessor::Response * cop_response;
+    grpc::ServerWriter<coprocessor::Response> * cop_writer;
 
     Poco::Logger * log;
 };
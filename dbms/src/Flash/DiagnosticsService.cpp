@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <Common/Exception.h>
+#include <Common/MPMCQueue.h>
+#include <Common/setThreadName.h>
 #include <Flash/DiagnosticsService.h>
 #include <Flash/LogSearch.h>
 #include <Poco/DirectoryIterator.h>
@@ -20,6 +22,7 @@
 #include <Storages/Transaction/KVStore.h>
 #include <Storages/Transaction/ProxyFFI.h>
 #include <Storages/Transaction/TMTContext.h>
+#include <common/ThreadPool.h>
 #include <fmt/ranges.h>
 
 #include <ext/scope_guard.h>
@@ -102,37 +105,38 @@ std::list<std::string> getFilesToSearch(IServer & server, Poco::Logger * log, co
     return files_to_search;
 }
 
-grpc::Status searchLog(Poco::Logger * log, ::grpc::ServerWriter<::diagnosticspb::SearchLogResponse> * stream, LogIterator & log_itr)
+namespace
 {
-    static constexpr size_t LOG_BATCH_SIZE = 256;
-
-    for (;;)
+constexpr size_t LOG_BATCH_SIZE = 256;
+/// The number of the log files searched concurrently, which is small to not occupy the CPU of the production node.
+constexpr size_t SEARCH_LOG_CONCURRENCY = 4;
+/// The number of the batches buffered for each file being searched.
+constexpr Int64 SEARCH_LOG_QUEUE_SIZE = 8;
+} // namespace
+
+void searchLog(LogIterator & log_itr, MPMCQueue<SearchLogResponse> & queue)
+{
+    for (bool finished = false; !finished;)
     {
         size_t i = 0;
-        auto resp = SearchLogResponse::default_instance();
-        for (; i < LOG_BATCH_SIZE;)
+        SearchLogResponse resp;
+        for (; i < LOG_BATCH_SIZE; ++i)
         {
-            if (auto tmp_msg = log_itr.next(); !tmp_msg)
+            auto tmp_msg = log_itr.next();
+            if (!tmp_msg)
             {
+                finished = true;
                 break;
             }
-            else
-            {
-                i++;
-                resp.mutable_messages()->Add(std::move(*tmp_msg));
-            }
+            resp.mutable_messages()->Add(std::move(*tmp_msg));
         }
 
         if (i == 0)
             break;
-
-        if (!stream->Write(resp))
-        {
-            LOG_FMT_DEBUG(log, "Write response failed for unknown reason.");
-            return grpc::Status(grpc::StatusCode::UNKNOWN, "Write response failed for unknown reason.");
-        }
+        // Cancelled since the response can not be written
+        if (!queue.push(std::move(resp)))
+            break;
     }
-    return ::grpc::Status::OK;
 }
 
 ::grpc::Status DiagnosticsService::search_log(
@@ -163,20 +167,61 @@ grpc::Status searchLog(Poco::Logger * log, ::grpc::ServerWriter<::diagnosticspb:
         LOG_FMT_DEBUG(log, "Handling SearchLog done: {}", request->DebugString());
     });
 
-    auto files_to_search = getFilesToSearch(server, log, start_time);
+    auto files = getFilesToSearch(server, log, start_time);
+    if (files.empty())
+        return ::grpc::Status::OK;
+    std::vector<std::string> files_to_search(files.begin(), files.end());
+
+    // Search the files concurrently, but write the logs file by file, so that the logs of a file are still in order.
+    std::vector<std::unique_ptr<MPMCQueue<SearchLogResponse>>> queues;
+    for (size_t i = 0; i < files_to_search.size(); ++i)
+        queues.push_back(std::make_unique<MPMCQueue<SearchLogResponse>>(SEARCH_LOG_QUEUE_SIZE));
 
-    for (const auto & path : files_to_search)
+    ThreadPool pool(std::min(files_to_search.size(), SEARCH_LOG_CONCURRENCY), [] { setThreadName("SearchLog"); });
+    for (size_t i = 0; i < files_to_search.size(); ++i)
     {
-        LOG_FMT_DEBUG(log, "start to search file {}", path);
-        auto status = grpc::Status::OK;
-        ReadLogFile(path, [&](std::istream & istr) {
-            LogIterator log_itr(start_time, end_time, levels, patterns, istr);
-            status = searchLog(log, stream, log_itr);
+        pool.schedule([&, i] {
+            const auto & path = files_to_search[i];
+            LOG_FMT_DEBUG(log, "start to search file {}", path);
+            try
+            {
+                ReadLogFile(
+                    path,
+                    [&](std::istream & istr) {
+                        LogIterator log_itr(start_time, end_time, levels, patterns, istr);
+                        searchLog(log_itr, *queues[i]);
+                    },
+                    start_time);
+            }
+            catch (...)
+            {
+                tryLogCurrentException(log, fmt::format("search file {} failed", path));
+            }
+            queues[i]->finish();
         });
-        if (!status.ok())
-            return status;
     }
 
-    return ::grpc::Status::OK;
+    auto status = ::grpc::Status::OK;
+    for (auto & queue : queues)
+    {
+        SearchLogResponse resp;
+        while (status.ok() && queue->pop(resp))
+        {
+            if (!stream->Write(resp))
+            {
+                LOG_FMT_DEBUG(log, "Write response failed for unknown reason.");
+                status = grpc::Status(grpc::StatusCode::UNKNOWN, "Write response failed for unknown reason.");
+            }
+        }
+        if (!status.ok())
+            break;
+    }
+    if (!status.ok())
+    {
+        for (auto & queue : queues)
+            queue->cancel();
+    }
+    pool.wait();
+    return status;
 }
 } // namespace DB
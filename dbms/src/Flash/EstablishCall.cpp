@@ -37,7 +37,7 @@ EstablishCallData::EstablishCallData(AsyncFlashService * service, grpc::ServerCo
     // As part of the initial CREATE state, we *request* that the system
     // start processing requests. In this request, "this" acts are
     // the tag uniquely identifying the request.
-    service->requestEstablishMPPConnection(&ctx, &request, &responder, cq, notify_cq, this);
+    service->requestEstablishMPPConnection(&ctx, &request, &responder, cq, notify_cq, asTag());
 }
 
 EstablishCallData::~EstablishCallData()
@@ -69,7 +69,7 @@ void EstablishCallData::responderFinish(const grpc::Status & status)
     if (*is_shutdown)
         finishTunnelAndResponder();
     else
-        responder.Finish(status, this);
+        responder.Finish(status, asTag());
 }
 
 void EstablishCallData::initRpc()
@@ -99,7 +99,7 @@ bool EstablishCallData::write(const mpp::MPPDataPacket & packet)
         finishTunnelAndResponder();
         return true;
     }
-    responder.Write(packet, this);
+    responder.Write(packet, asTag());
     return true;
 }
 
@@ -151,9 +151,13 @@ void EstablishCallData::cancel()
 
 void EstablishCallData::finishTunnelAndResponder()
 {
+    /// A write fails without the server shutdown when the receiver cancels the call, because it needs no more data,
+    /// e.g. its LIMIT is reached. The tunnel drops the packets written afterwards instead of failing the task.
+    if (!*is_shutdown && state == PROCESSING && async_tunnel_sender && !async_tunnel_sender->isConsumerFinished())
+        async_tunnel_sender->consumerFinish("", /*receiver_done_=*/true);
     setFinishState("finishTunnelAndResponder called");
     grpc::Status status(static_cast<grpc::StatusCode>(GRPC_STATUS_UNKNOWN), "Consumer exits unexpected, grpc writes failed.");
-    responder.Finish(status, this);
+    responder.Finish(status, asTag());
 }
 
 void EstablishCallData::proceed()
@@ -29,17 +29,38 @@ class AsyncFlashService;
 class SyncPacketWriter : public PacketWriter
 {
 public:
-    explicit SyncPacketWriter(grpc::ServerWriter<mpp::MPPDataPacket> * writer)
+    SyncPacketWriter(grpc::ServerWriter<mpp::MPPDataPacket> * writer, grpc::ServerContext * grpc_context = nullptr)
         : writer(writer)
+        , grpc_context(grpc_context)
     {}
 
     bool write(const mpp::MPPDataPacket & packet) override { return writer->Write(packet); }
 
+    bool isCancelledByReceiver() const override { return grpc_context != nullptr && grpc_context->IsCancelled(); }
+
 private:
     ::grpc::ServerWriter<::mpp::MPPDataPacket> * writer;
+    ::grpc::ServerContext * grpc_context;
+};
+
+/// The calls of the async rpc server, whose addresses are the tags of the events in the completion queues.
+/// Pass `asTag()` rather than `this` to gRPC, so `handleRpcs` can dispatch the events by `proceed` and `cancel`.
+class IAsyncCallData
+{
+public:
+    virtual ~IAsyncCallData() = default;
+
+    // Called when an event of this call arrives.
+    virtual void proceed() = 0;
+
+    // Called when an event of this call fails, e.g. the server is shutdown.
+    virtual void cancel() = 0;
+
+    void * asTag() { return static_cast<IAsyncCallData *>(this); }
 };
 
 class EstablishCallData : public PacketWriter
+    , public IAsyncCallData
 {
 public:
     // A state machine used for async grpc api EstablishMPPConnection. When a relative grpc event arrives,
@@ -62,9 +83,9 @@ public:
 
     void writeErr(const mpp::MPPDataPacket & packet);
 
-    void proceed();
+    void proceed() override;
 
-    void cancel();
+    void cancel() override;
 
     virtual void attachAsyncTunnelSender(const std::shared_ptr<DB::AsyncTunnelSender> & async_tunnel_sender_) override;
 
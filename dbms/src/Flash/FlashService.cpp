@@ -70,6 +70,18 @@ FlashService::FlashService(IServer & server_)
 
 FlashService::~FlashService() = default;
 
+AsyncFlashService::AsyncFlashService(IServer & server_)
+    : FlashService(server_)
+{
+    is_async = true;
+    ::grpc::Service::MarkMethodAsync(EstablishMPPConnectionApiID);
+    if (server_.context().getSettingsRef().enable_async_cop)
+    {
+        is_async_cop = true;
+        ::grpc::Service::MarkMethodAsync(CoprocessorApiID);
+    }
+}
+
 // Use executeInThreadPool to submit job to thread pool which return grpc::Status.
 grpc::Status executeInThreadPool(ThreadPool & pool, std::function<grpc::Status()> job)
 {
@@ -101,6 +113,86 @@ grpc::Status FlashService::Coprocessor(
         GET_METRIC(tiflash_coprocessor_response_bytes).Increment(response->ByteSizeLong());
     });
 
+    grpc::Status ret = executeInThreadPool(*cop_pool, [&] { return executeCoprocessor(grpc_context, request, response); });
+
+    LOG_FMT_DEBUG(log, "Handle coprocessor request done: {}, {}", ret.error_code(), ret.error_message());
+    return ret;
+}
+
+void FlashService::asyncCoprocessor(
+    grpc::ServerContext * grpc_context,
+    const coprocessor::Request * request,
+    coprocessor::Response * response,
+    std::function<void(const grpc::Status &)> done)
+{
+    LOG_FMT_DEBUG(log, "Handling coprocessor request: {}", request->DebugString());
+
+    if (!security_config.checkGrpcContext(grpc_context))
+    {
+        done(grpc::Status(grpc::PERMISSION_DENIED, tls_err_msg));
+        return;
+    }
+
+    GET_METRIC(tiflash_coprocessor_request_count, type_cop).Increment();
+    GET_METRIC(tiflash_coprocessor_handling_request_count, type_cop).Increment();
+
+    // Unlike `Coprocessor`, the gRPC thread returns at once, and `done` is called by the thread of `cop_pool`.
+    cop_pool->schedule([this, grpc_context, request, response, done = std::move(done), watch = Stopwatch()] {
+        grpc::Status ret;
+        {
+            SCOPE_EXIT({
+                GET_METRIC(tiflash_coprocessor_handling_request_count, type_cop).Decrement();
+                GET_METRIC(tiflash_coprocessor_request_duration_seconds, type_cop).Observe(watch.elapsedSeconds());
+                GET_METRIC(tiflash_coprocessor_response_bytes).Increment(response->ByteSizeLong());
+            });
+            try
+            {
+                ret = executeCoprocessor(grpc_context, request, response);
+            }
+            catch (...)
+            {
+                ret = grpc::Status(grpc::StatusCode::UNKNOWN, getCurrentExceptionMessage(false));
+            }
+        }
+
+        LOG_FMT_DEBUG(log, "Handle coprocessor request done: {}, {}", ret.error_code(), ret.error_message());
+        done(ret);
+    });
+}
+
+grpc::Status FlashService::executeCoprocessor(
+    grpc::ServerContext * grpc_context,
+    const coprocessor::Request * request,
+    coprocessor::Response * response)
+{
+    auto [context, status] = createDBContext(grpc_context);
+    if (!status.ok())
+    {
+        return status;
+    }
+    CoprocessorContext cop_context(*context, request->context(), *grpc_context);
+    CoprocessorHandler cop_handler(cop_context, request, response);
+    return cop_handler.execute();
+}
+
+::grpc::Status FlashService::CoprocessorStream(::grpc::ServerContext * grpc_context, const ::coprocessor::Request * request, ::grpc::ServerWriter<::coprocessor::Response> * writer)
+{
+    CPUAffinityManager::getInstance().bindSelfGrpcThread();
+    LOG_FMT_DEBUG(log, "Handling coprocessor stream request: {}", request->DebugString());
+
+    if (!security_config.checkGrpcContext(grpc_context))
+    {
+        return grpc::Status(grpc::PERMISSION_DENIED, tls_err_msg);
+    }
+
+    GET_METRIC(tiflash_coprocessor_request_count, type_cop_stream).Increment();
+    GET_METRIC(tiflash_coprocessor_handling_request_count, type_cop_stream).Increment();
+    Stopwatch watch;
+    SCOPE_EXIT({
+        GET_METRIC(tiflash_coprocessor_handling_request_count, type_cop_stream).Decrement();
+        GET_METRIC(tiflash_coprocessor_request_duration_seconds, type_cop_stream).Observe(watch.elapsedSeconds());
+    });
+
     grpc::Status ret = executeInThreadPool(*cop_pool, [&] {
         auto [context, status] = createDBContext(grpc_context);
         if (!status.ok())
@@ -108,11 +200,16 @@ grpc::Status FlashService::Coprocessor(
             return status;
         }
         CoprocessorContext cop_context(*context, request->context(), *grpc_context);
-        CoprocessorHandler cop_handler(cop_context, request, response);
-        return cop_handler.execute();
+        coprocessor::Response response;
+        CoprocessorHandler cop_handler(cop_context, request, &response, writer);
+        auto cop_status = cop_handler.execute();
+        // The region error, lock or other error is sent as the last response of the stream.
+        if (cop_status.ok() && response.ByteSizeLong() > 0)
+            writer->Write(response);
+        return cop_status;
     });
 
-    LOG_FMT_DEBUG(log, "Handle coprocessor request done: {}, {}", ret.error_code(), ret.error_message());
+    LOG_FMT_DEBUG(log, "Handle coprocessor stream request done: {}, {}", ret.error_code(), ret.error_message());
     return ret;
 }
 
@@ -303,7 +400,7 @@ grpc::Status FlashService::Coprocessor(
     }
     else
     {
-        SyncPacketWriter writer(sync_writer);
+        SyncPacketWriter writer(sync_writer, grpc_context);
         tunnel->connect(&writer);
         LOG_FMT_DEBUG(tunnel->getLogger(), "connect tunnel successfully and begin to wait");
         tunnel->waitForFinish();
@@ -55,6 +55,19 @@ public:
         const coprocessor::Request * request,
         coprocessor::Response * response) override;
 
+    // Handle the coprocessor request in `cop_pool` without blocking the calling thread, and call `done` with the result.
+    // Used by the async rpc server, see `CoprocessorCallData`.
+    void asyncCoprocessor(
+        grpc::ServerContext * grpc_context,
+        const coprocessor::Request * request,
+        coprocessor::Response * response,
+        std::function<void(const grpc::Status &)> done);
+
+    // Handle the non-batch coprocessor request, but send the chunks as soon as they are encoded instead of one large response.
+    ::grpc::Status CoprocessorStream(::grpc::ServerContext * context,
+                                     const ::coprocessor::Request * request,
+                                     ::grpc::ServerWriter<::coprocessor::Response> * writer) override;
+
     ::grpc::Status BatchCoprocessor(::grpc::ServerContext * context,
                                     const ::coprocessor::BatchRequest * request,
                                     ::grpc::ServerWriter<::coprocessor::BatchResponse> * writer) override;
@@ -83,6 +96,11 @@ public:
 protected:
     std::tuple<ContextPtr, ::grpc::Status> createDBContext(const grpc::ServerContext * grpc_context) const;
 
+    grpc::Status executeCoprocessor(
+        grpc::ServerContext * grpc_context,
+        const coprocessor::Request * request,
+        coprocessor::Response * response);
+
     IServer & server;
     const TiFlashSecurityConfig & security_config;
     Poco::Logger * log;
@@ -103,11 +121,25 @@ public:
     // 48 is EstablishMPPConnection API ID of GRPC
     // note: if the kvrpc protocal is updated, please keep consistent with the generated code.
     static constexpr int EstablishMPPConnectionApiID = 48;
-    explicit AsyncFlashService(IServer & server)
-        : FlashService(server)
+    // 34 is Coprocessor API ID of GRPC
+    static constexpr int CoprocessorApiID = 34;
+    explicit AsyncFlashService(IServer & server_);
+
+    bool isAsyncCop() const { return is_async_cop; }
+
+    // disable synchronous version of this method if it is async
+    ::grpc::Status Coprocessor(::grpc::ServerContext * context, const ::coprocessor::Request * request, ::coprocessor::Response * response) override
     {
-        is_async = true;
-        ::grpc::Service::MarkMethodAsync(EstablishMPPConnectionApiID);
+        if (is_async_cop)
+        {
+            abort();
+            return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+        }
+        return FlashService::Coprocessor(context, request, response);
+    }
+    void requestCoprocessor(::grpc::ServerContext * context, ::coprocessor::Request * request, ::grpc::ServerAsyncResponseWriter<::coprocessor::Response> * responder, ::grpc::CompletionQueue * new_call_cq, ::grpc::ServerCompletionQueue * notification_cq, void * tag)
+    {
+        ::grpc::Service::RequestAsyncUnary(CoprocessorApiID, context, request, responder, new_call_cq, notification_cq, tag);
     }
 
     // disable synchronous version of this method
@@ -120,6 +152,9 @@ public:
     {
         ::grpc::Service::RequestAsyncServerStreaming(EstablishMPPConnectionApiID, context, request, writer, new_call_cq, notification_cq, tag);
     }
+
+private:
+    bool is_async_cop = false;
 };
 
 } // namespace DB
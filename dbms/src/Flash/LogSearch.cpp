@@ -126,6 +126,12 @@ bool LogIterator::match(const int64_t time, const LogLevel level, const char * c
         return false;
 
     // Grep
+    for (auto && searcher : literal_patterns)
+    {
+        const auto * begin = reinterpret_cast<const UInt8 *>(c);
+        if (searcher->search(begin, begin + sz) == begin + sz)
+            return false;
+    }
     re2::StringPiece content{c, sz};
     for (auto && regex : compiled_patterns)
     {
@@ -338,14 +344,16 @@ std::optional<LogIterator::Error> LogIterator::readLog(LogEntry & entry)
 
 void LogIterator::init()
 {
-    // Check empty, if empty then fill with ".*"
-    if (patterns.empty() || (patterns.size() == 1 && patterns[0].empty()))
-    {
-        patterns = {".*"};
-    }
+    // Empty patterns match all the logs
+    if (patterns.size() == 1 && patterns[0].empty())
+        patterns.clear();
+    static const std::string regex_meta_chars = "\\^$.|?*+()[]{}";
     for (auto && pattern : patterns)
     {
-        compiled_patterns.push_back(std::make_unique<RE2>(pattern));
+        if (!pattern.empty() && pattern.find_first_of(regex_meta_chars) == std::string::npos)
+            literal_patterns.push_back(std::make_unique<ASCIICaseSensitiveStringSearcher>(pattern.data(), pattern.size()));
+        else
+            compiled_patterns.push_back(std::make_unique<RE2>(pattern));
     }
 }
 
@@ -358,6 +366,74 @@ LogIterator::~LogIterator()
     }
 }
 
+bool ReadLogTime(const char * s, size_t size, int64_t & time)
+{
+    int year, month, day, hour, minute, second, milli_second, timezone_hour, timezone_min;
+    size_t loglevel_s, loglevel_size;
+    if (!LogIterator::readDate(size, s, year, month, day, hour, minute, second, milli_second, timezone_hour, timezone_min)
+        || !LogIterator::readLevel(size, s, loglevel_s, loglevel_size))
+        return false;
+    std::tm tm{};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    time = fast_mktime(&tm) * 1000 + milli_second;
+    return true;
+}
+
+void SeekLogByTime(std::istream & istr, const int64_t start_time)
+{
+    /// Stop the binary search when the range is smaller than it, and scan the rest.
+    static constexpr std::streamoff min_seek_range = 1024 * 1024;
+    /// The number of lines read to find a log head after a probed offset, the rest of a multi-line log is skipped.
+    static constexpr size_t max_probe_lines = 64;
+    /// The logs of different threads may be a little out of order.
+    static constexpr int64_t time_disorder_ms = 1000;
+
+    istr.clear();
+    istr.seekg(0, std::ios::end);
+    const std::streamoff size = istr.tellg();
+    if (size <= 0)
+    {
+        istr.clear();
+        istr.seekg(0);
+        return;
+    }
+
+    /// The probed log at `lo` is earlier than `start_time`, or `lo` is 0.
+    std::streamoff lo = 0;
+    std::streamoff hi = size;
+    std::string line;
+    auto probe_time = [&](std::streamoff offset) -> std::optional<int64_t> {
+        istr.clear();
+        istr.seekg(offset);
+        std::getline(istr, line); // skip the partial line
+        for (size_t i = 0; i < max_probe_lines && std::getline(istr, line); ++i)
+        {
+            int64_t time;
+            if (ReadLogTime(line.data(), line.size(), time))
+                return time;
+        }
+        return std::nullopt;
+    };
+    while (hi - lo > min_seek_range)
+    {
+        std::streamoff mid = lo + (hi - lo) / 2;
+        if (auto time = probe_time(mid); time && *time + time_disorder_ms < start_time)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    istr.clear();
+    istr.seekg(lo);
+    if (lo > 0)
+        std::getline(istr, line); // skip the partial line
+}
+
 // read approximate timestamp, round up to second, return -1 if failed.
 int64_t readApproxiTimestamp(const char * start, const char * date_format)
 {
@@ -446,7 +522,7 @@ bool FilterFileByDatetime(
 }
 
 // if path ends with `.gz`, try to read by `Poco::InflatingInputStream`
-void ReadLogFile(const std::string & path, std::function<void(std::istream &)> && cb)
+void ReadLogFile(const std::string & path, std::function<void(std::istream &)> && cb, int64_t start_time)
 {
     if (endsWith(path, gz_suffix))
     {
@@ -458,6 +534,8 @@ void ReadLogFile(const std::string & path, std::function<void(std::istream &)> &
     else
     {
         std::ifstream istr(path);
+        if (start_time > 0)
+            SeekLogByTime(istr, start_time);
         cb(istr);
         istr.close();
     }
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/StringSearcher.h>
 #include <Poco/File.h>
 #include <common/logger_useful.h>
 #include <re2/re2.h>
@@ -125,6 +126,8 @@ private:
     std::vector<::diagnosticspb::LogLevel> levels;
     std::vector<std::string> patterns;
     std::vector<std::unique_ptr<RE2>> compiled_patterns;
+    /// The patterns without any regex meta character are searched by SIMD instead of RE2.
+    std::vector<std::unique_ptr<ASCIICaseSensitiveStringSearcher>> literal_patterns;
     std::istream & log_input_stream;
     std::string line;
 
@@ -134,7 +137,16 @@ private:
     std::optional<std::pair<uint32_t, Error::Type>> err_info; // <lineno, Error::Type>
 };
 
-void ReadLogFile(const std::string & path, std::function<void(std::istream &)> && cb);
+/// If `start_time` is not 0, the plain log file is seeked by `SeekLogByTime` before calling `cb`.
+void ReadLogFile(const std::string & path, std::function<void(std::istream &)> && cb, int64_t start_time = 0);
+
+/// Read the time of a log line, return false if it is not the head of a log.
+bool ReadLogTime(const char * s, size_t size, int64_t & time);
+
+/// The logs of a file are appended in the time order, so binary search the offset of the file to skip the logs
+/// earlier than `start_time`, instead of parsing all of them. `istr` must be seekable. After that, `istr` is at the
+/// start of a line, and no log at or after `start_time` is before it.
+void SeekLogByTime(std::istream & istr, int64_t start_time);
 
 bool FilterFileByDatetime(
     const std::string & path,
@@ -15,6 +15,7 @@
 #include <Common/CPUAffinityManager.h>
 #include <Common/Exception.h>
 #include <Common/FailPoint.h>
+#include <Common/Stopwatch.h>
 #include <Common/ThreadFactory.h>
 #include <Common/TiFlashMetrics.h>
 #include <Flash/Coprocessor/CoprocessorReader.h>
@@ -52,15 +53,17 @@ String getReceiverStateStr(const ExchangeReceiverState & s)
 // If enable_fine_grained_shuffle:
 //      Seperate chunks according to packet.stream_ids[i], then push to msg_channels[stream_id].
 // If fine grained_shuffle is disabled:
-//      Push all chunks to msg_channels[0].
+//      Push all chunks to msg_channels[0], or to msg_channels[source_index] in the ordered mode.
 // Return true if all push succeed, otherwise return false.
 // NOTE: shared_ptr<MPPDataPacket> will be hold by all ExchangeReceiverBlockInputStream to make chunk pointer valid.
+// The blocks in `local_packet` from a local tunnel, if any, are dispatched in the same way as the chunks.
 template <bool enable_fine_grained_shuffle, bool is_sync>
 bool pushPacket(size_t source_index,
                 const String & req_info,
                 MPPDataPacketPtr & packet,
                 const std::vector<MsgChannelPtr> & msg_channels,
-                LoggerPtr & log)
+                LoggerPtr & log,
+                const TunnelPacketPtr & local_packet = nullptr)
 {
     bool push_succeed = true;
 
@@ -97,10 +100,20 @@ bool pushPacket(size_t source_index,
                 chunks[stream_id].push_back(&packet->chunks(i));
             }
         }
+        std::vector<std::vector<Block>> blocks(msg_channels.size());
+        if (local_packet != nullptr && !local_packet->blocks.empty())
+        {
+            assert(local_packet->blocks.size() == local_packet->stream_ids.size());
+            for (size_t i = 0; i < local_packet->blocks.size(); ++i)
+            {
+                UInt64 stream_id = local_packet->stream_ids[i] % msg_channels.size();
+                blocks[stream_id].push_back(std::move(local_packet->blocks[i]));
+            }
+        }
         // Still need to send error_ptr or resp_ptr even if packet.chunks_size() is zero.
         for (size_t i = 0; i < msg_channels.size() && push_succeed; ++i)
         {
-            if (resp_ptr == nullptr && error_ptr == nullptr && chunks[i].empty())
+            if (resp_ptr == nullptr && error_ptr == nullptr && chunks[i].empty() && blocks[i].empty())
                 continue;
 
             std::shared_ptr<ReceivedMessage> recv_msg = std::make_shared<ReceivedMessage>(
@@ -109,7 +122,9 @@ bool pushPacket(size_t source_index,
                 packet,
                 error_ptr,
                 resp_ptr,
-                std::move(chunks[i]));
+                std::move(chunks[i]),
+                std::move(blocks[i]),
+                local_packet);
             push_succeed = msg_channels[i]->push(std::move(recv_msg));
             if constexpr (is_sync)
                 fiu_do_on(FailPoints::random_receiver_sync_msg_push_failure_failpoint, push_succeed = false;);
@@ -127,8 +142,11 @@ bool pushPacket(size_t source_index,
         {
             chunks[i] = &packet->chunks(i);
         }
+        std::vector<Block> blocks;
+        if (local_packet != nullptr)
+            blocks = std::move(local_packet->blocks);
 
-        if (!(resp_ptr == nullptr && error_ptr == nullptr && chunks.empty()))
+        if (!(resp_ptr == nullptr && error_ptr == nullptr && chunks.empty() && blocks.empty()))
         {
             std::shared_ptr<ReceivedMessage> recv_msg = std::make_shared<ReceivedMessage>(
                 source_index,
@@ -136,9 +154,12 @@ bool pushPacket(size_t source_index,
                 packet,
                 error_ptr,
                 resp_ptr,
-                std::move(chunks));
+                std::move(chunks),
+                std::move(blocks),
+                local_packet);
 
-            push_succeed = msg_channels[0]->push(std::move(recv_msg));
+            // There is either one msg channel shared by all the sources, or one msg channel per source in the ordered mode.
+            push_succeed = msg_channels[source_index % msg_channels.size()]->push(std::move(recv_msg));
             if constexpr (is_sync)
                 fiu_do_on(FailPoints::random_receiver_sync_msg_push_failure_failpoint, push_succeed = false;);
             else
@@ -149,6 +170,27 @@ bool pushPacket(size_t source_index,
     return push_succeed;
 }
 
+// Keep the same as `CHBlockChunkCodec::decode`: the blocks from a local tunnel use the column names of
+// the header, and their column types must be the same as the header.
+Block alignBlockWithHeader(Block && block, const Block & header)
+{
+    if (unlikely(block.columns() != header.columns()))
+        throw Exception(fmt::format("Block from local tunnel has {} columns, but the header has {} columns", block.columns(), header.columns()));
+    for (size_t i = 0; i < block.columns(); ++i)
+    {
+        auto & column = block.getByPosition(i);
+        const auto & header_column = header.getByPosition(i);
+        if (unlikely(!column.type->equals(*header_column.type)))
+            throw Exception(fmt::format(
+                "Type mismatch of the block from local tunnel, expected {}, got {}",
+                header_column.type->getName(),
+                column.type->getName()));
+        column.name = header_column.name;
+        column.type = header_column.type;
+    }
+    return std::move(block);
+}
+
 enum class AsyncRequestStage
 {
     NEED_INIT,
@@ -251,7 +293,11 @@ public:
             if (auto packet = getErrorPacket())
                 setDone("Exchange receiver meet error : " + packet->error().msg());
             else if (!sendPackets())
+            {
+                /// The msg channels are finished or cancelled, no more data is needed from the sender.
+                reader->cancel();
                 setDone("Exchange receiver meet error : push packets fail");
+            }
             else if (read_packet_index < batch_packet_count)
             {
                 stage = AsyncRequestStage::WAIT_FINISH;
@@ -306,6 +352,7 @@ public:
     bool meetError() const { return meet_error; }
     const String & getErrMsg() const { return err_msg; }
     const LoggerPtr & getLog() const { return log; }
+    size_t getSourceIndex() const { return request->source_index; }
 
 private:
     void notifyReactor()
@@ -404,7 +451,8 @@ ExchangeReceiverBase<RPCContext>::ExchangeReceiverBase(
     size_t max_streams_,
     const String & req_id,
     const String & executor_id,
-    uint64_t fine_grained_shuffle_stream_count_)
+    uint64_t fine_grained_shuffle_stream_count_,
+    bool ordered_)
     : rpc_context(std::move(rpc_context_))
     , source_num(source_num_)
     , max_streams(max_streams_)
@@ -415,6 +463,7 @@ ExchangeReceiverBase<RPCContext>::ExchangeReceiverBase(
     , exc_log(Logger::get("ExchangeReceiver", req_id, executor_id))
     , collected(false)
     , fine_grained_shuffle_stream_count(fine_grained_shuffle_stream_count_)
+    , ordered(ordered_ && !enableFineGrainedShuffle(fine_grained_shuffle_stream_count_))
 {
     try
     {
@@ -422,12 +471,18 @@ ExchangeReceiverBase<RPCContext>::ExchangeReceiverBase(
         {
             for (size_t i = 0; i < max_streams_; ++i)
             {
-                msg_channels.push_back(std::make_unique<MPMCQueue<std::shared_ptr<ReceivedMessage>>>(max_buffer_size));
+                msg_channels.push_back(std::make_unique<MsgChannel>(max_buffer_size));
             }
         }
+        else if (ordered)
+        {
+            /// Every channel is read by one stream only, so a small buffer is enough to keep the sources busy.
+            for (size_t i = 0; i < source_num; ++i)
+                msg_channels.push_back(std::make_unique<MsgChannel>(batch_packet_count));
+        }
         else
         {
-            msg_channels.push_back(std::make_unique<MPMCQueue<std::shared_ptr<ReceivedMessage>>>(max_buffer_size));
+            msg_channels.push_back(std::make_unique<MsgChannel>(max_buffer_size));
         }
         rpc_context->fillSchema(schema);
         setUpConnection();
@@ -497,7 +552,10 @@ void ExchangeReceiverBase<RPCContext>::setUpConnection()
         }
     }
 
-    // TODO: reduce this thread in the future.
+    /// All the remote sources are read by one reactor thread, the gRPC callbacks run on the threads of `GRPCCompletionQueuePool`
+    /// and only hand the ready requests to the reactor, because pushing to the msg channels may block. A local source is read by
+    /// its own thread, because reading a local tunnel blocks, and reading them one after another can deadlock when their senders
+    /// also write to the other receivers of this node.
     if (!async_requests.empty())
     {
         thread_manager->schedule(true, "RecvReactor", [this, async_requests = std::move(async_requests)] {
@@ -549,7 +607,7 @@ void ExchangeReceiverBase<RPCContext>::reactor(const std::vector<Request> & asyn
             if (handler->finished())
             {
                 --alive_async_connections;
-                connectionDone(handler->meetError(), handler->getErrMsg(), handler->getLog());
+                connectionDone(handler->getSourceIndex(), handler->meetError(), handler->getErrMsg(), handler->getLog());
             }
             else if (handler->waitingForRetry())
             {
@@ -600,16 +658,19 @@ void ExchangeReceiverBase<RPCContext>::readLoop(const Request & req)
             for (;;)
             {
                 LOG_FMT_TRACE(log, "begin next ");
-                MPPDataPacketPtr packet = std::make_shared<MPPDataPacket>();
-                bool success = reader->read(packet);
+                TunnelPacketPtr tunnel_packet = std::make_shared<TunnelPacket>(std::make_shared<MPPDataPacket>());
+                bool success = reader->read(tunnel_packet);
                 if (!success)
                     break;
                 has_data = true;
+                MPPDataPacketPtr & packet = tunnel_packet->packet;
                 if (packet->has_error())
                     throw Exception("Exchange receiver meet error : " + packet->error().msg());
 
-                if (!pushPacket<enable_fine_grained_shuffle, true>(req.source_index, req_info, packet, msg_channels, log))
+                if (!pushPacket<enable_fine_grained_shuffle, true>(req.source_index, req_info, packet, msg_channels, log, tunnel_packet))
                 {
+                    /// The msg channels are finished or cancelled, no more data is needed from the sender.
+                    reader->cancel();
                     meet_error = true;
                     auto local_state = getState();
                     local_err_msg = "receiver's state is " + getReceiverStateStr(local_state) + ", exit from readLoop";
@@ -666,7 +727,7 @@ void ExchangeReceiverBase<RPCContext>::readLoop(const Request & req)
         meet_error = true;
         local_err_msg = "fatal error";
     }
-    connectionDone(meet_error, local_err_msg, log);
+    connectionDone(req.source_index, meet_error, local_err_msg, log);
 }
 
 template <typename RPCContext>
@@ -678,7 +739,7 @@ DecodeDetail ExchangeReceiverBase<RPCContext>::decodeChunks(
     assert(recv_msg != nullptr);
     DecodeDetail detail;
 
-    if (recv_msg->chunks.empty())
+    if (recv_msg->chunks.empty() && recv_msg->blocks.empty())
         return detail;
 
     // Record total packet size even if fine grained shuffle is enabled.
@@ -686,12 +747,33 @@ DecodeDetail ExchangeReceiverBase<RPCContext>::decodeChunks(
 
     for (const String * chunk : recv_msg->chunks)
     {
-        Block block = CHBlockChunkCodec::decode(*chunk, header);
+        Block block;
+        if (CHBlockChunkCodec::isCompressed(*chunk))
+        {
+            Stopwatch watch;
+            String uncompressed_chunk = CHBlockChunkCodec::decompress(*chunk);
+            detail.decompression_time_ns += watch.elapsed();
+            detail.compressed_bytes += chunk->size();
+            detail.uncompressed_bytes += uncompressed_chunk.size();
+            block = CHBlockChunkCodec::decode(uncompressed_chunk, header);
+        }
+        else
+        {
+            block = CHBlockChunkCodec::decode(*chunk, header);
+        }
         detail.rows += block.rows();
         if (unlikely(block.rows() == 0))
             continue;
         block_queue.push(std::move(block));
     }
+    for (auto & block : recv_msg->blocks)
+    {
+        detail.packet_bytes += block.bytes();
+        detail.rows += block.rows();
+        if (unlikely(block.rows() == 0))
+            continue;
+        block_queue.push(alignBlockWithHeader(std::move(block), header));
+    }
     return detail;
 }
 
@@ -759,7 +841,7 @@ ExchangeReceiverResult ExchangeReceiverBase<RPCContext>::nextResult(std::queue<B
         {
             result = {nullptr, recv_msg->source_index, recv_msg->req_info, false, "", false};
         }
-        if (!result.meet_error && !recv_msg->chunks.empty())
+        if (!result.meet_error && (!recv_msg->chunks.empty() || !recv_msg->blocks.empty()))
         {
             assert(result.decode_detail.rows == 0);
             result.decode_detail = decodeChunks(recv_msg, block_queue, header);
@@ -790,6 +872,7 @@ ExchangeReceiverState ExchangeReceiverBase<RPCContext>::getState()
 
 template <typename RPCContext>
 void ExchangeReceiverBase<RPCContext>::connectionDone(
+    size_t source_index,
     bool meet_error,
     const String & local_err_msg,
     const LoggerPtr & log)
@@ -822,6 +905,12 @@ void ExchangeReceiverBase<RPCContext>::connectionDone(
 
     if (meet_error || copy_live_conn == 0)
         finishAllMsgChannels();
+    else if (ordered)
+    {
+        /// The stream of this source is merged with the others, it must end as soon as the source ends, otherwise
+        /// the merge waits for it while the other sources wait for their full channels to be consumed.
+        msg_channels[source_index]->finish();
+    }
 }
 
 template <typename RPCContext>
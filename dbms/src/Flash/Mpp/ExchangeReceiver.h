@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/LockFreeMPMCQueue.h>
 #include <Common/MPMCQueue.h>
 #include <Common/ThreadManager.h>
 #include <Flash/Coprocessor/CHBlockChunkCodec.h>
@@ -42,6 +43,10 @@ struct ReceivedMessage
     const mpp::Error * error_ptr;
     const String * resp_ptr;
     std::vector<const String *> chunks;
+    // The blocks passed from a local tunnel without being encoded.
+    std::vector<Block> blocks;
+    // Hold the packet from a local tunnel until it is decoded, so that the tunnel credits are granted back after that.
+    TunnelPacketPtr tunnel_packet;
 
     // Constructor that move chunks.
     ReceivedMessage(size_t source_index_,
@@ -49,13 +54,17 @@ struct ReceivedMessage
                     const std::shared_ptr<const MPPDataPacket> & packet_,
                     const mpp::Error * error_ptr_,
                     const String * resp_ptr_,
-                    std::vector<const String *> && chunks_)
+                    std::vector<const String *> && chunks_,
+                    std::vector<Block> && blocks_ = {},
+                    const TunnelPacketPtr & tunnel_packet_ = nullptr)
         : source_index(source_index_)
         , req_info(req_info_)
         , packet(packet_)
         , error_ptr(error_ptr_)
         , resp_ptr(resp_ptr_)
         , chunks(chunks_)
+        , blocks(std::move(blocks_))
+        , tunnel_packet(tunnel_packet_)
     {}
 };
 
@@ -97,7 +106,9 @@ enum class ExchangeReceiverState
     CLOSED,
 };
 
-using MsgChannelPtr = std::unique_ptr<MPMCQueue<std::shared_ptr<ReceivedMessage>>>;
+/// Every received packet goes through a msg channel, so it is lock free.
+using MsgChannel = LockFreeMPMCQueue<std::shared_ptr<ReceivedMessage>>;
+using MsgChannelPtr = std::unique_ptr<MsgChannel>;
 
 template <typename RPCContext>
 class ExchangeReceiverBase
@@ -113,7 +124,8 @@ public:
         size_t max_streams_,
         const String & req_id,
         const String & executor_id,
-        uint64_t fine_grained_shuffle_stream_count);
+        uint64_t fine_grained_shuffle_stream_count,
+        bool ordered_ = false);
 
     ~ExchangeReceiverBase();
 
@@ -130,6 +142,9 @@ public:
 
     size_t getSourceNum() const { return source_num; }
     uint64_t getFineGrainedShuffleStreamCount() const { return fine_grained_shuffle_stream_count; }
+    /// In the ordered mode, the packets of every source go to their own msg channel, so that the stream_id of `nextResult`
+    /// is the source index and the sorted data sent by each source can be merged in order.
+    bool isOrdered() const { return ordered; }
 
     int computeNewThreadCount() const { return thread_count; }
 
@@ -166,6 +181,7 @@ private:
         const Block & header);
 
     void connectionDone(
+        size_t source_index,
         bool meet_error,
         const String & local_err_msg,
         const LoggerPtr & log);
@@ -197,6 +213,7 @@ private:
     bool collected = false;
     int thread_count = 0;
     uint64_t fine_grained_shuffle_stream_count;
+    const bool ordered;
 };
 
 class ExchangeReceiver : public ExchangeReceiverBase<GRPCReceiverContext>
@@ -72,6 +72,11 @@ struct GrpcExchangePacketReader : public ExchangePacketReader
     {
         return reader->Finish();
     }
+
+    void cancel() override
+    {
+        client_context.TryCancel();
+    }
 };
 
 struct AsyncGrpcExchangePacketReader : public AsyncExchangePacketReader
@@ -110,6 +115,11 @@ struct AsyncGrpcExchangePacketReader : public AsyncExchangePacketReader
     {
         reader->Finish(&status, callback);
     }
+
+    void cancel() override
+    {
+        client_context.TryCancel();
+    }
 };
 
 struct LocalExchangePacketReader : public ExchangePacketReader
@@ -133,10 +143,23 @@ struct LocalExchangePacketReader : public ExchangePacketReader
 
     bool read(MPPDataPacketPtr & packet) override
     {
-        MPPDataPacketPtr tmp_packet = local_tunnel_sender->readForLocal();
+        TunnelPacketPtr tmp_packet = local_tunnel_sender->readForLocal();
         bool success = tmp_packet != nullptr;
         if (success)
-            packet = tmp_packet;
+        {
+            // The caller only accepts the packet
+            assert(tmp_packet->blocks.empty());
+            packet = tmp_packet->packet;
+        }
+        return success;
+    }
+
+    bool read(TunnelPacketPtr & tunnel_packet) override
+    {
+        TunnelPacketPtr tmp_packet = local_tunnel_sender->readForLocal();
+        bool success = tmp_packet != nullptr;
+        if (success)
+            tunnel_packet = tmp_packet;
         return success;
     }
 
@@ -147,6 +170,13 @@ struct LocalExchangePacketReader : public ExchangePacketReader
         local_tunnel_sender.reset();
         return ::grpc::Status::OK;
     }
+
+    void cancel() override
+    {
+        if (local_tunnel_sender)
+            local_tunnel_sender->consumerFinish("", /*receiver_done_=*/true);
+        local_tunnel_sender.reset();
+    }
 };
 
 std::tuple<MPPTunnelPtr, grpc::Status> establishMPPConnectionLocal(
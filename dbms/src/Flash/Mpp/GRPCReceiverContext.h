@@ -17,6 +17,7 @@
 #include <Common/UnaryCallback.h>
 #include <Flash/Coprocessor/ChunkCodec.h>
 #include <Flash/Mpp/MPPTaskManager.h>
+#include <Flash/Mpp/TunnelPacket.h>
 #include <common/types.h>
 #include <grpc++/grpc++.h>
 #include <kvproto/mpp.pb.h>
@@ -36,7 +37,16 @@ class ExchangePacketReader
 public:
     virtual ~ExchangePacketReader() = default;
     virtual bool read(MPPDataPacketPtr & packet) = 0;
+    /// Besides the packet, the reader of a local tunnel may return the blocks passed without being encoded.
+    virtual bool read(TunnelPacketPtr & tunnel_packet)
+    {
+        if (tunnel_packet == nullptr)
+            tunnel_packet = std::make_shared<TunnelPacket>(std::make_shared<MPPDataPacket>());
+        return read(tunnel_packet->packet);
+    }
     virtual ::grpc::Status finish() = 0;
+    /// Tell the sender that no more data is needed, e.g. the LIMIT of the receiver is reached.
+    virtual void cancel() {}
 };
 using ExchangePacketReaderPtr = std::shared_ptr<ExchangePacketReader>;
 
@@ -47,6 +57,8 @@ public:
     virtual void init(UnaryCallback<bool> * callback) = 0;
     virtual void read(MPPDataPacketPtr & packet, UnaryCallback<bool> * callback) = 0;
     virtual void finish(::grpc::Status & status, UnaryCallback<bool> * callback) = 0;
+    /// Tell the sender that no more data is needed, e.g. the LIMIT of the receiver is reached.
+    virtual void cancel() {}
 };
 using AsyncExchangePacketReaderPtr = std::shared_ptr<AsyncExchangePacketReader>;
 
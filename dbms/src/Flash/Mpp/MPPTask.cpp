@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include <Common/CPUAffinityManager.h>
+#include <Common/ColumnBufferPool.h>
 #include <Common/FailPoint.h>
+#include <Common/SamplingProfiler.h>
+#include <Common/Stopwatch.h>
 #include <Common/ThreadFactory.h>
 #include <Common/ThreadManager.h>
 #include <Common/TiFlashMetrics.h>
@@ -39,6 +42,7 @@
 #include <chrono>
 #include <ext/scope_guard.h>
 #include <map>
+#include <unordered_set>
 
 namespace DB
 {
@@ -61,6 +65,7 @@ MPPTask::MPPTask(const mpp::TaskMeta & meta_, const ContextPtr & context_)
     , log(Logger::get("MPPTask", id.toString()))
     , mpp_task_statistics(id, meta.address())
     , needed_threads(0)
+    , needed_memory(0)
     , schedule_state(ScheduleState::WAITING)
 {}
 
@@ -75,7 +80,7 @@ MPPTask::~MPPTask()
     {
         /// the threads of this task are not fully freed now, since the BlockIO and DAGContext are not destructed
         /// TODO: finish all threads before here, except the current one.
-        manager.load()->releaseThreadsFromScheduler(needed_threads);
+        manager.load()->releaseResourcesFromScheduler(needed_threads, needed_memory);
         schedule_state = ScheduleState::COMPLETED;
     }
     LOG_FMT_DEBUG(log, "finish MPPTask: {}", id.toString());
@@ -128,7 +133,19 @@ void MPPTask::run()
 
 void MPPTask::registerTunnels(const mpp::DispatchTaskRequest & task_request)
 {
-    tunnel_set = std::make_shared<MPPTunnelSet>(log->identifier());
+    const auto & settings = context->getSettingsRef();
+    /// TiDB can not decode the compressed chunks, so only compress the data sent between TiFlash nodes.
+    CompressionMethod compression_method = CompressionMethod::NONE;
+    if (settings.enable_mpp_exchange_compression && !dag_context->isRootMPPTask())
+        compression_method = settings.mpp_exchange_compression_method;
+    /// The root task sends to TiDB, which does not decode the compressed chunks.
+    const size_t broadcast_compression_threshold = dag_context->isRootMPPTask() ? 0 : settings.mpp_broadcast_compression_threshold;
+    tunnel_set = std::make_shared<MPPTunnelSet>(
+        log->identifier(),
+        settings.enable_local_tunnel_block_exchange,
+        compression_method,
+        settings.mpp_exchange_compression_method,
+        broadcast_compression_threshold);
     std::chrono::seconds timeout(task_request.timeout());
     const auto & exchange_sender = dag_req.root_executor().exchange_sender();
 
@@ -140,7 +157,7 @@ void MPPTask::registerTunnels(const mpp::DispatchTaskRequest & task_request)
             throw TiFlashException("Failed to decode task meta info in ExchangeSender", Errors::Coprocessor::BadRequest);
         bool is_local = context->getSettingsRef().enable_local_tunnel && meta.address() == task_meta.address();
         bool is_async = !is_local && context->getSettingsRef().enable_async_server;
-        MPPTunnelPtr tunnel = std::make_shared<MPPTunnel>(task_meta, task_request.meta(), timeout, context->getSettingsRef().max_threads, is_local, is_async, log->identifier());
+        MPPTunnelPtr tunnel = std::make_shared<MPPTunnel>(task_meta, task_request.meta(), timeout, settings.max_threads, is_local, is_async, log->identifier(), settings.mpp_tunnel_max_inflight_bytes);
         LOG_FMT_DEBUG(log, "begin to register the tunnel {}", tunnel->id());
         if (status != INITIALIZING)
             throw Exception(fmt::format("The tunnel {} can not be registered, because the task is not in initializing state", tunnel->id()));
@@ -155,7 +172,15 @@ void MPPTask::registerTunnels(const mpp::DispatchTaskRequest & task_request)
 void MPPTask::initExchangeReceivers()
 {
     receiver_set = std::make_shared<MPPReceiverSet>(log->identifier());
+    /// The exchange receivers right under a TopN, whose senders sort the data by the partial TopN.
+    /// The executors are traversed in pre order, so the TopN is visited before its child.
+    std::unordered_set<String> ordered_receivers;
     traverseExecutors(&dag_req, [&](const tipb::Executor & executor) {
+        if (executor.tp() == tipb::ExecType::TypeTopN && context->getSettingsRef().enable_ordered_exchange_receiver
+            && executor.topn().child().tp() == tipb::ExecType::TypeExchangeReceiver)
+        {
+            ordered_receivers.insert(executor.topn().child().executor_id());
+        }
         if (executor.tp() == tipb::ExecType::TypeExchangeReceiver)
         {
             assert(executor.has_executor_id());
@@ -173,7 +198,8 @@ void MPPTask::initExchangeReceivers()
                 context->getMaxStreams(),
                 log->identifier(),
                 executor_id,
-                executor.fine_grained_shuffle_stream_count());
+                executor.fine_grained_shuffle_stream_count(),
+                ordered_receivers.count(executor_id) > 0);
             if (status != RUNNING)
                 throw Exception("exchange receiver map can not be initialized, because the task is not in running state");
 
@@ -226,11 +252,14 @@ void MPPTask::unregisterTask()
 
 void MPPTask::prepare(const mpp::DispatchTaskRequest & task_request)
 {
+    Stopwatch watch;
     dag_req = getDAGRequestFromStringWithRetry(task_request.encoded_plan());
+    const UInt64 decode_plan_ns = watch.elapsedFromLastTime();
     TMTContext & tmt_context = context->getTMTContext();
     /// MPP task will only use key ranges in mpp::DispatchTaskRequest::regions/mpp::DispatchTaskRequest::table_regions.
     /// The ones defined in tipb::TableScan will never be used and can be removed later.
     TablesRegionsInfo tables_regions_info = TablesRegionsInfo::create(task_request.regions(), task_request.table_regions(), tmt_context);
+    const UInt64 build_regions_info_ns = watch.elapsedFromLastTime();
     LOG_FMT_DEBUG(
         log,
         "Handling {} regions from {} physical tables in MPP task",
@@ -290,7 +319,9 @@ void MPPTask::prepare(const mpp::DispatchTaskRequest & task_request)
     }
 
     // register tunnels
+    watch.elapsedFromLastTime();
     registerTunnels(task_request);
+    const UInt64 register_tunnels_ns = watch.elapsedFromLastTime();
 
     dag_context->tunnel_set = tunnel_set;
     // register task.
@@ -309,7 +340,16 @@ void MPPTask::prepare(const mpp::DispatchTaskRequest & task_request)
     {
         throw TiFlashException(std::string(__PRETTY_FUNCTION__) + ": Failed to register MPP Task", Errors::Coprocessor::BadRequest);
     }
+    const UInt64 register_task_ns = watch.elapsedFromLastTime();
+    LOG_FMT_DEBUG(
+        log,
+        "MPP task prepared, decode plan: {} ns, build regions info: {} ns, register tunnels: {} ns, register task: {} ns",
+        decode_plan_ns,
+        build_regions_info_ns,
+        register_tunnels_ns,
+        register_task_ns);
 
+    mpp_task_statistics.setPrepareTime(decode_plan_ns, build_regions_info_ns, register_tunnels_ns, register_task_ns);
     mpp_task_statistics.initializeExecutorDAG(dag_context.get());
     mpp_task_statistics.logTracingJson();
 }
@@ -329,6 +369,7 @@ void MPPTask::preprocess()
 void MPPTask::runImpl()
 {
     CPUAffinityManager::getInstance().bindSelfQueryThread();
+    SamplingProfiler::ThreadTagSetter profiling_tag_setter(id.toString());
     if (!switchStatus(INITIALIZING, RUNNING))
     {
         LOG_WARNING(log, "task not in initializing state, skip running");
@@ -348,6 +389,8 @@ void MPPTask::runImpl()
         preprocess();
         needed_threads = estimateCountOfNewThreads();
         LOG_FMT_DEBUG(log, "Estimate new thread count of query :{} including tunnel_threads: {} , receiver_threads: {}", needed_threads, dag_context->tunnel_set->getRemoteTunnelCnt(), new_thread_count_of_exchange_receiver);
+        needed_memory = estimateMemoryUsage();
+        LOG_FMT_DEBUG(log, "Estimate memory usage of query: {}", needed_memory);
 
         scheduleOrWait();
 
@@ -361,6 +404,7 @@ void MPPTask::runImpl()
             throw Exception("task not in running state, may be cancelled");
         }
         mpp_task_statistics.start();
+        ColumnBufferPool::Scope column_buffer_pool_scope;
         auto from = dag_context->getBlockIO().in;
         from->readPrefix();
         LOG_DEBUG(log, "begin read ");
@@ -552,6 +596,30 @@ int MPPTask::estimateCountOfNewThreads()
         + dag_context->tunnel_set->getRemoteTunnelCnt();
 }
 
+UInt64 MPPTask::estimateMemoryUsage()
+{
+    /// The memory of the stateless executors is bounded by the block size, so only count the executors that hold
+    /// their whole input, such as the hash table of join and aggregation.
+    size_t stateful_executor_count = 0;
+    traverseExecutors(&dag_req, [&](const tipb::Executor & executor) {
+        switch (executor.tp())
+        {
+        case tipb::ExecType::TypeJoin:
+        case tipb::ExecType::TypeAggregation:
+        case tipb::ExecType::TypeStreamAgg:
+        case tipb::ExecType::TypeTopN:
+        case tipb::ExecType::TypeWindow:
+        case tipb::ExecType::TypeSort:
+            ++stateful_executor_count;
+            break;
+        default:
+            break;
+        }
+        return true;
+    });
+    return stateful_executor_count * context->getSettingsRef().task_scheduler_memory_per_stateful_executor;
+}
+
 int MPPTask::getNeededThreads()
 {
     if (needed_threads == 0)
@@ -67,6 +67,8 @@ public:
 
     int getNeededThreads();
 
+    UInt64 getNeededMemory() const { return needed_memory; }
+
     enum class ScheduleState
     {
         WAITING,
@@ -118,6 +120,9 @@ private:
 
     int estimateCountOfNewThreads();
 
+    /// Estimate the memory usage by the stateful executors in the DAG, for the memory admission of MinTSOScheduler.
+    UInt64 estimateMemoryUsage();
+
     void registerTunnels(const mpp::DispatchTaskRequest & task_request);
 
     void initExchangeReceivers();
@@ -152,6 +157,7 @@ private:
     friend class MPPTaskManager;
 
     int needed_threads;
+    UInt64 needed_memory;
 
     std::mutex schedule_mu;
     std::condition_variable schedule_cv;
@@ -15,8 +15,10 @@
 #include <Common/FailPoint.h>
 #include <Common/FmtUtils.h>
 #include <Flash/Mpp/MPPTaskManager.h>
+#include <Interpreters/Join.h>
 #include <fmt/core.h>
 
+#include <ext/scope_guard.h>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -39,7 +41,7 @@ MPPTaskPtr MPPTaskManager::findTaskWithTimeout(const mpp::TaskMeta & meta, std::
     std::unordered_map<MPPTaskId, MPPTaskPtr>::iterator it;
     bool cancelled = false;
     std::unique_lock lock(mu);
-    auto ret = cv.wait_for(lock, timeout, [&] {
+    auto is_task_found = [&] {
         auto query_it = mpp_query_map.find(id.start_ts);
         // TODO: how about the query has been cancelled in advance?
         if (query_it == mpp_query_map.end())
@@ -55,7 +57,16 @@ MPPTaskPtr MPPTaskManager::findTaskWithTimeout(const mpp::TaskMeta & meta, std::
         }
         it = query_it->second->task_map.find(id);
         return it != query_it->second->task_map.end();
-    });
+    };
+    bool ret = is_task_found();
+    if (!ret)
+    {
+        std::condition_variable_any task_cv;
+        auto waiter_it = task_waiters.emplace(id, &task_cv);
+        /// `lock` is held again when `wait_for` returns
+        SCOPE_EXIT({ task_waiters.erase(waiter_it); });
+        ret = task_cv.wait_for(lock, timeout, is_task_found);
+    }
     fiu_do_on(FailPoints::random_task_manager_find_task_failure_failpoint, ret = false;);
     if (cancelled)
     {
@@ -91,8 +102,11 @@ void MPPTaskManager::cancelMPPQuery(UInt64 query_id, const String & reason)
         }
         it->second->to_be_cancelled = true;
         task_set = it->second;
+        /// the tasks probing a shared join may be waiting for a builder that will never finish
+        for (auto & shared_join : task_set->broadcast_joins)
+            shared_join.second.join->cancelBuildIfWaiting();
         scheduler->deleteQuery(query_id, *this, true);
-        cv.notify_all();
+        notifyQueryWaiters(query_id);
     }
     LOG_WARNING(log, fmt::format("Begin cancel query: {}", query_id));
     FmtBuffer fmt_buf;
@@ -125,7 +139,7 @@ bool MPPTaskManager::registerTask(MPPTaskPtr task)
     if (it != mpp_query_map.end() && it->second->to_be_cancelled)
     {
         LOG_WARNING(log, "Do not register task: " + task->id.toString() + " because the query is to be cancelled.");
-        cv.notify_all();
+        notifyQueryWaiters(task->id.start_ts);
         return false;
     }
     if (it != mpp_query_map.end() && it->second->task_map.find(task->id) != it->second->task_map.end())
@@ -143,10 +157,26 @@ bool MPPTaskManager::registerTask(MPPTaskPtr task)
         mpp_query_map[task->id.start_ts]->task_map.emplace(task->id, task);
     }
     task->manager = this;
-    cv.notify_all();
+    notifyTaskWaiters(task->id);
     return true;
 }
 
+void MPPTaskManager::notifyTaskWaiters(const MPPTaskId & task_id)
+{
+    auto [begin, end] = task_waiters.equal_range(task_id);
+    for (auto it = begin; it != end; ++it)
+        it->second->notify_all();
+}
+
+void MPPTaskManager::notifyQueryWaiters(UInt64 query_id)
+{
+    for (auto & waiter : task_waiters)
+    {
+        if (waiter.first.start_ts == query_id)
+            waiter.second->notify_all();
+    }
+}
+
 bool MPPTaskManager::isQueryToBeCancelled(UInt64 query_id)
 {
     std::unique_lock lock(mu);
@@ -165,6 +195,16 @@ void MPPTaskManager::unregisterTask(MPPTask * task)
         auto task_it = it->second->task_map.find(task->id);
         if (task_it != it->second->task_map.end())
         {
+            for (auto join_it = it->second->broadcast_joins.begin(); join_it != it->second->broadcast_joins.end();)
+            {
+                if (join_it->second.builder == task->id)
+                {
+                    join_it->second.join->cancelBuildIfWaiting();
+                    join_it = it->second->broadcast_joins.erase(join_it);
+                }
+                else
+                    ++join_it;
+            }
             it->second->task_map.erase(task_it);
             if (it->second->task_map.empty())
             {
@@ -178,6 +218,18 @@ void MPPTaskManager::unregisterTask(MPPTask * task)
     LOG_ERROR(log, "The task " + task->id.toString() + " cannot be found and fail to unregister");
 }
 
+JoinPtr MPPTaskManager::getOrRegisterBroadcastJoin(const MPPTaskId & task_id, const String & join_executor_id, const JoinPtr & join)
+{
+    std::lock_guard lock(mu);
+    auto it = mpp_query_map.find(task_id.start_ts);
+    if (it == mpp_query_map.end() || it->second->to_be_cancelled)
+        return nullptr;
+    auto [join_it, inserted] = it->second->broadcast_joins.try_emplace(join_executor_id, SharedBroadcastJoin{task_id, join});
+    if (inserted)
+        return nullptr;
+    return join_it->second.join;
+}
+
 std::vector<UInt64> MPPTaskManager::getCurrentQueries()
 {
     std::vector<UInt64> ret;
@@ -225,10 +277,10 @@ bool MPPTaskManager::tryToScheduleTask(const MPPTaskPtr & task)
     return scheduler->tryToSchedule(task, *this);
 }
 
-void MPPTaskManager::releaseThreadsFromScheduler(const int needed_threads)
+void MPPTaskManager::releaseResourcesFromScheduler(const int needed_threads, const UInt64 needed_memory)
 {
     std::lock_guard lock(mu);
-    scheduler->releaseThreadsThenSchedule(needed_threads, *this);
+    scheduler->releaseResourcesThenSchedule(needed_threads, needed_memory, *this);
 }
 
 } // namespace DB
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/ProfilingMutex.h>
 #include <Flash/Mpp/MPPTask.h>
 #include <Flash/Mpp/MinTSOScheduler.h>
 #include <common/logger_useful.h>
@@ -25,6 +26,17 @@
 
 namespace DB
 {
+class Join;
+using JoinPtr = std::shared_ptr<Join>;
+
+/// A broadcast join whose hash table is built by `builder` and probed by all the tasks of the query on this node
+/// running the same join, the build side of a broadcast join is the same for all of them.
+struct SharedBroadcastJoin
+{
+    MPPTaskId builder;
+    JoinPtr join;
+};
+
 struct MPPQueryTaskSet
 {
     /// to_be_cancelled is kind of lock, if to_be_cancelled is set
@@ -36,6 +48,8 @@ struct MPPQueryTaskSet
     MPPTaskMap task_map;
     /// only used in scheduler
     std::queue<MPPTaskId> waiting_tasks;
+    /// key: executor id of the join
+    std::unordered_map<String, SharedBroadcastJoin> broadcast_joins;
 };
 
 using MPPQueryTaskSetPtr = std::shared_ptr<MPPQueryTaskSet>;
@@ -50,13 +64,18 @@ class MPPTaskManager : private boost::noncopyable
 {
     MPPTaskSchedulerPtr scheduler;
 
-    std::mutex mu;
+    ProfilingMutex mu{ProfilingLockType::MPPTaskManager};
 
     MPPQueryMap mpp_query_map;
 
     Poco::Logger * log;
 
-    std::condition_variable cv;
+    /// The connections waiting in `findTaskWithTimeout` for a task to be registered. A waiter is only woken up by the
+    /// registration of its own task or the cancellation of its query, instead of every registration of the node.
+    std::unordered_multimap<MPPTaskId, std::condition_variable_any *> task_waiters;
+
+    void notifyTaskWaiters(const MPPTaskId & task_id);
+    void notifyQueryWaiters(UInt64 query_id);
 
 public:
     explicit MPPTaskManager(MPPTaskSchedulerPtr scheduler);
@@ -77,12 +96,16 @@ public:
 
     bool tryToScheduleTask(const MPPTaskPtr & task);
 
-    void releaseThreadsFromScheduler(const int needed_threads);
+    void releaseResourcesFromScheduler(const int needed_threads, const UInt64 needed_memory);
 
     MPPTaskPtr findTaskWithTimeout(const mpp::TaskMeta & meta, std::chrono::seconds timeout, std::string & errMsg);
 
     void cancelMPPQuery(UInt64 query_id, const String & reason);
 
+    /// Return the join registered by another task of the query for `join_executor_id`, or register `join` to be built by `task_id`
+    /// and return nullptr. The registered join is dropped when its builder is unregistered, and its build is failed if unfinished.
+    JoinPtr getOrRegisterBroadcastJoin(const MPPTaskId & task_id, const String & join_executor_id, const JoinPtr & join);
+
     String toString();
 };
 
@@ -103,6 +103,7 @@ void MPPTaskStatistics::logTracingJson()
         R"(,"task_init_timestamp":{},"task_start_timestamp":{},"task_end_timestamp":{})"
         R"(,"compile_start_timestamp":{},"compile_end_timestamp":{})"
         R"(,"read_wait_index_start_timestamp":{},"read_wait_index_end_timestamp":{})"
+        R"(,"decode_plan_time_ns":{},"build_regions_info_time_ns":{},"register_tunnels_time_ns":{},"register_task_time_ns":{})"
         R"(,"local_input_bytes":{},"remote_input_bytes":{},"output_bytes":{})"
         R"(,"status":"{}","error_message":"{}","working_time":{},"memory_peak":{}}})",
         id.start_ts,
@@ -118,6 +119,10 @@ void MPPTaskStatistics::logTracingJson()
         toNanoseconds(compile_end_timestamp),
         toNanoseconds(read_wait_index_start_timestamp),
         toNanoseconds(read_wait_index_end_timestamp),
+        decode_plan_time_ns,
+        build_regions_info_time_ns,
+        register_tunnels_time_ns,
+        register_task_time_ns,
         local_input_bytes,
         remote_input_bytes,
         output_bytes,
@@ -138,6 +143,14 @@ void MPPTaskStatistics::setCompileTimestamp(const Timestamp & start_timestamp, c
     compile_end_timestamp = end_timestamp;
 }
 
+void MPPTaskStatistics::setPrepareTime(UInt64 decode_plan_ns, UInt64 build_regions_info_ns, UInt64 register_tunnels_ns, UInt64 register_task_ns)
+{
+    decode_plan_time_ns = decode_plan_ns;
+    build_regions_info_time_ns = build_regions_info_ns;
+    register_tunnels_time_ns = register_tunnels_ns;
+    register_task_time_ns = register_task_ns;
+}
+
 void MPPTaskStatistics::recordInputBytes(DAGContext & dag_context)
 {
     for (const auto & map_entry : dag_context.getInBoundIOInputStreamsMap())
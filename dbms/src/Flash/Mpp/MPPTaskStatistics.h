@@ -53,6 +53,9 @@ public:
 
     void setCompileTimestamp(const Timestamp & start_timestamp, const Timestamp & end_timestamp);
 
+    /// The time of the phases in `MPPTask::prepare`, in nanoseconds.
+    void setPrepareTime(UInt64 decode_plan_ns, UInt64 build_regions_info_ns, UInt64 register_tunnels_ns, UInt64 register_task_ns);
+
 private:
     void recordInputBytes(DAGContext & dag_context);
 
@@ -68,6 +71,10 @@ private:
     Timestamp compile_end_timestamp{Clock::duration::zero()};
     Timestamp read_wait_index_start_timestamp{Clock::duration::zero()};
     Timestamp read_wait_index_end_timestamp{Clock::duration::zero()};
+    UInt64 decode_plan_time_ns = 0;
+    UInt64 build_regions_info_time_ns = 0;
+    UInt64 register_tunnels_time_ns = 0;
+    UInt64 register_task_time_ns = 0;
     TaskStatus status;
     String error_message;
 
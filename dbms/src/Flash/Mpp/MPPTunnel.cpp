@@ -35,8 +35,9 @@ MPPTunnel::MPPTunnel(
     int input_steams_num_,
     bool is_local_,
     bool is_async_,
-    const String & req_id)
-    : MPPTunnel(fmt::format("tunnel{}+{}", sender_meta_.task_id(), receiver_meta_.task_id()), timeout_, input_steams_num_, is_local_, is_async_, req_id)
+    const String & req_id,
+    size_t max_inflight_bytes)
+    : MPPTunnel(fmt::format("tunnel{}+{}", sender_meta_.task_id(), receiver_meta_.task_id()), timeout_, input_steams_num_, is_local_, is_async_, req_id, max_inflight_bytes)
 {}
 
 MPPTunnel::MPPTunnel(
@@ -45,11 +46,13 @@ MPPTunnel::MPPTunnel(
     int input_steams_num_,
     bool is_local_,
     bool is_async_,
-    const String & req_id)
+    const String & req_id,
+    size_t max_inflight_bytes)
     : status(TunnelStatus::Unconnected)
     , timeout(timeout_)
     , tunnel_id(tunnel_id_)
-    , send_queue(std::make_shared<MPMCQueue<MPPDataPacketPtr>>(std::max(5, input_steams_num_ * 5))) // MPMCQueue can benefit from a slightly larger queue size
+    , send_queue(std::make_shared<MPMCQueue<TunnelPacketPtr>>(std::max(5, input_steams_num_ * 5))) // MPMCQueue can benefit from a slightly larger queue size
+    , credits(max_inflight_bytes > 0 ? std::make_shared<TunnelCredits>(max_inflight_bytes) : nullptr)
     , log(Logger::get("MPPTunnel", req_id, tunnel_id))
 {
     RUNTIME_ASSERT(!(is_local_ && is_async_), log, "is_local: {}, is_async: {}.", is_local_, is_async_);
@@ -113,12 +116,15 @@ void MPPTunnel::close(const String & reason)
             return;
         case TunnelStatus::Connected:
         {
+            // wake up the writer waiting for credits, the error packet below doesn't need credits.
+            if (credits)
+                credits->cancel();
             if (!reason.empty())
             {
                 try
                 {
                     FAIL_POINT_TRIGGER_EXCEPTION(FailPoints::exception_during_mpp_close_tunnel);
-                    send_queue->push(std::make_shared<mpp::MPPDataPacket>(getPacketWithError(reason)));
+                    send_queue->push(std::make_shared<TunnelPacket>(std::make_shared<mpp::MPPDataPacket>(getPacketWithError(reason))));
                     if (mode == TunnelSenderMode::ASYNC_GRPC)
                         async_tunnel_sender->tryFlushOne();
                 }
@@ -143,6 +149,25 @@ void MPPTunnel::close(const String & reason)
 
 // TODO: consider to hold a buffer
 void MPPTunnel::write(const mpp::MPPDataPacket & data, bool close_after_write)
+{
+    writeImpl(std::make_shared<TunnelPacket>(std::make_shared<mpp::MPPDataPacket>(data)), data.ByteSizeLong(), close_after_write);
+}
+
+void MPPTunnel::write(mpp::MPPDataPacket && data, bool close_after_write)
+{
+    const size_t bytes = data.ByteSizeLong();
+    writeImpl(std::make_shared<TunnelPacket>(std::make_shared<mpp::MPPDataPacket>(std::move(data))), bytes, close_after_write);
+}
+
+void MPPTunnel::write(const mpp::MPPDataPacket & data, std::vector<Block> blocks, std::vector<UInt64> stream_ids)
+{
+    RUNTIME_ASSERT(mode == TunnelSenderMode::LOCAL, log, "Only local tunnel can write blocks directly");
+    auto tunnel_packet = std::make_shared<TunnelPacket>(std::make_shared<mpp::MPPDataPacket>(data), std::move(blocks), std::move(stream_ids));
+    const size_t bytes = data.ByteSizeLong() + tunnel_packet->blocksBytes();
+    writeImpl(std::move(tunnel_packet), bytes, /*close_after_write=*/false);
+}
+
+void MPPTunnel::writeImpl(TunnelPacketPtr && data, size_t bytes, bool close_after_write)
 {
     LOG_FMT_TRACE(log, "ready to write");
     {
@@ -150,12 +175,28 @@ void MPPTunnel::write(const mpp::MPPDataPacket & data, bool close_after_write)
             std::unique_lock lk(mu);
             waitUntilConnectedOrFinished(lk);
             if (status == TunnelStatus::Finished)
+            {
+                if (tunnel_sender && tunnel_sender->isReceiverDone())
+                    return;
                 throw Exception(fmt::format("write to tunnel which is already closed,{}", tunnel_sender ? tunnel_sender->getConsumerFinishMsg() : ""));
+            }
         }
 
-        if (send_queue->push(std::make_shared<mpp::MPPDataPacket>(data)))
+        bool has_credits = true;
+        if (credits)
         {
-            connection_profile_info.bytes += data.ByteSizeLong();
+            // block here if the receiver has not consumed enough of the packets in flight
+            has_credits = credits->acquire(bytes);
+            if (has_credits)
+            {
+                data->credits = credits;
+                data->credit_bytes = bytes;
+            }
+        }
+
+        if (has_credits && send_queue->push(std::move(data)))
+        {
+            connection_profile_info.bytes += bytes;
             connection_profile_info.packets += 1;
             if (mode == TunnelSenderMode::ASYNC_GRPC)
                 async_tunnel_sender->tryFlushOne();
@@ -178,7 +219,11 @@ void MPPTunnel::writeDone()
     {
         std::unique_lock lk(mu);
         if (status == TunnelStatus::Finished)
+        {
+            if (tunnel_sender && tunnel_sender->isReceiverDone())
+                return;
             throw Exception(fmt::format("write to tunnel which is already closed,{}", tunnel_sender ? tunnel_sender->getConsumerFinishMsg() : ""));
+        }
         /// make sure to finish the tunnel after it is connected
         waitUntilConnectedOrFinished(lk);
         finishSendQueue();
@@ -198,18 +243,18 @@ void MPPTunnel::connect(PacketWriter * writer)
         {
         case TunnelSenderMode::LOCAL:
             RUNTIME_ASSERT(writer == nullptr, log);
-            local_tunnel_sender = std::make_shared<LocalTunnelSender>(mode, send_queue, nullptr, log, tunnel_id);
+            local_tunnel_sender = std::make_shared<LocalTunnelSender>(mode, send_queue, nullptr, log, tunnel_id, credits);
             tunnel_sender = local_tunnel_sender;
             break;
         case TunnelSenderMode::SYNC_GRPC:
             RUNTIME_ASSERT(writer != nullptr, log, "Sync writer shouldn't be null");
-            sync_tunnel_sender = std::make_shared<SyncTunnelSender>(mode, send_queue, writer, log, tunnel_id);
+            sync_tunnel_sender = std::make_shared<SyncTunnelSender>(mode, send_queue, writer, log, tunnel_id, credits);
             sync_tunnel_sender->startSendThread();
             tunnel_sender = sync_tunnel_sender;
             break;
         case TunnelSenderMode::ASYNC_GRPC:
             RUNTIME_ASSERT(writer != nullptr, log, "Async writer shouldn't be null");
-            async_tunnel_sender = std::make_shared<AsyncTunnelSender>(mode, send_queue, writer, log, tunnel_id);
+            async_tunnel_sender = std::make_shared<AsyncTunnelSender>(mode, send_queue, writer, log, tunnel_id, credits);
             tunnel_sender = async_tunnel_sender;
             writer->attachAsyncTunnelSender(async_tunnel_sender);
             break;
@@ -222,6 +267,12 @@ void MPPTunnel::connect(PacketWriter * writer)
     LOG_DEBUG(log, "connected");
 }
 
+bool MPPTunnel::isReceiverDone()
+{
+    std::unique_lock lk(mu);
+    return tunnel_sender && tunnel_sender->isReceiverDone();
+}
+
 void MPPTunnel::waitForFinish()
 {
     waitForSenderFinish(/*allow_throw=*/true);
@@ -295,11 +346,13 @@ StringRef MPPTunnel::statusToString()
     }
 }
 
-void TunnelSender::consumerFinish(const String & msg)
+void TunnelSender::consumerFinish(const String & msg, bool receiver_done_)
 {
-    LOG_FMT_TRACE(log, "calling consumer Finish");
+    LOG_FMT_TRACE(log, "calling consumer Finish, receiver done: {}", receiver_done_);
     send_queue->finish();
-    consumer_state.setMsg(msg);
+    if (credits)
+        credits->cancel();
+    consumer_state.setMsg(receiver_done_ ? "" : msg, receiver_done_);
 }
 
 SyncTunnelSender::~SyncTunnelSender()
@@ -313,14 +366,17 @@ void SyncTunnelSender::sendJob()
     GET_METRIC(tiflash_thread_count, type_active_threads_of_establish_mpp).Increment();
     GET_METRIC(tiflash_thread_count, type_max_threads_of_establish_mpp).Set(std::max(GET_METRIC(tiflash_thread_count, type_max_threads_of_establish_mpp).Value(), GET_METRIC(tiflash_thread_count, type_active_threads_of_establish_mpp).Value()));
     String err_msg;
+    bool receiver_done = false;
     try
     {
-        MPPDataPacketPtr res;
+        TunnelPacketPtr res;
         while (send_queue->pop(res))
         {
-            if (!writer->write(*res))
+            if (!writer->write(*res->packet))
             {
-                err_msg = "grpc writes failed.";
+                receiver_done = writer->isCancelledByReceiver();
+                if (!receiver_done)
+                    err_msg = "grpc writes failed.";
                 break;
             }
         }
@@ -335,7 +391,9 @@ void SyncTunnelSender::sendJob()
         LOG_ERROR(log, err_msg);
         trimStackTrace(err_msg);
     }
-    consumerFinish(err_msg);
+    if (receiver_done)
+        LOG_FMT_DEBUG(log, "{} is cancelled by the receiver", tunnel_id);
+    consumerFinish(err_msg, receiver_done);
     GET_METRIC(tiflash_thread_count, type_active_threads_of_establish_mpp).Decrement();
 }
 
@@ -365,11 +423,11 @@ void AsyncTunnelSender::sendOne()
     bool queue_empty_flag = false;
     try
     {
-        MPPDataPacketPtr res;
+        TunnelPacketPtr res;
         queue_empty_flag = !send_queue->pop(res);
         if (!queue_empty_flag)
         {
-            if (!writer->write(*res))
+            if (!writer->write(*res->packet))
             {
                 err_msg = "grpc writes failed.";
             }
@@ -392,9 +450,9 @@ void AsyncTunnelSender::sendOne()
     }
 }
 
-LocalTunnelSender::MPPDataPacketPtr LocalTunnelSender::readForLocal()
+TunnelPacketPtr LocalTunnelSender::readForLocal()
 {
-    MPPDataPacketPtr res;
+    TunnelPacketPtr res;
     if (send_queue->pop(res))
         return res;
     consumerFinish("");
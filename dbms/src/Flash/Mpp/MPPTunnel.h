@@ -19,6 +19,7 @@
 #include <Common/ThreadManager.h>
 #include <Flash/FlashService.h>
 #include <Flash/Mpp/PacketWriter.h>
+#include <Flash/Mpp/TunnelPacket.h>
 #include <Flash/Statistics/ConnectionProfileInfo.h>
 #include <common/logger_useful.h>
 #include <common/types.h>
@@ -61,22 +62,23 @@ enum class TunnelSenderMode
 class TunnelSender : private boost::noncopyable
 {
 public:
-    using MPPDataPacketPtr = std::shared_ptr<mpp::MPPDataPacket>;
-    using DataPacketMPMCQueuePtr = std::shared_ptr<MPMCQueue<MPPDataPacketPtr>>;
+    using DataPacketMPMCQueuePtr = std::shared_ptr<MPMCQueue<TunnelPacketPtr>>;
     virtual ~TunnelSender() = default;
-    TunnelSender(TunnelSenderMode mode_, DataPacketMPMCQueuePtr send_queue_, PacketWriter * writer_, const LoggerPtr log_, const String & tunnel_id_)
+    TunnelSender(TunnelSenderMode mode_, DataPacketMPMCQueuePtr send_queue_, PacketWriter * writer_, const LoggerPtr log_, const String & tunnel_id_, TunnelCreditsPtr credits_ = nullptr)
         : mode(mode_)
         , send_queue(send_queue_)
         , writer(writer_)
         , log(log_)
         , tunnel_id(tunnel_id_)
+        , credits(std::move(credits_))
     {
     }
     DataPacketMPMCQueuePtr getSendQueue()
     {
         return send_queue;
     }
-    void consumerFinish(const String & err_msg);
+    /// `receiver_done` means the receiver stops reading on purpose, e.g. its LIMIT is reached, which is not an error.
+    void consumerFinish(const String & err_msg, bool receiver_done_ = false);
     String getConsumerFinishMsg()
     {
         return consumer_state.getMsg();
@@ -85,6 +87,10 @@ public:
     {
         return consumer_state.msgHasSet();
     }
+    bool isReceiverDone() const
+    {
+        return consumer_state.isReceiverDone();
+    }
     const LoggerPtr & getLogger() const { return log; }
     String getTunnelId()
     {
@@ -105,22 +111,28 @@ protected:
             future.wait();
             return future.get();
         }
-        void setMsg(const String & msg)
+        void setMsg(const String & msg, bool receiver_done_ = false)
         {
             bool old_value = false;
             if (!msg_has_set.compare_exchange_strong(old_value, true, std::memory_order_seq_cst, std::memory_order_relaxed))
                 return;
+            receiver_done.store(receiver_done_);
             promise.set_value(msg);
         }
         bool msgHasSet() const
         {
             return msg_has_set.load();
         }
+        bool isReceiverDone() const
+        {
+            return receiver_done.load();
+        }
 
     private:
         std::promise<String> promise;
         std::shared_future<String> future;
         std::atomic<bool> msg_has_set{false};
+        std::atomic<bool> receiver_done{false};
     };
     TunnelSenderMode mode;
     DataPacketMPMCQueuePtr send_queue;
@@ -128,6 +140,8 @@ protected:
     PacketWriter * writer;
     const LoggerPtr log;
     String tunnel_id;
+    // cancelled when the consumer finishes, to wake up the writer waiting for credits.
+    TunnelCreditsPtr credits;
 };
 
 /// SyncTunnelSender maintains a new thread itself to consume and send data
@@ -163,7 +177,7 @@ class LocalTunnelSender : public TunnelSender
 public:
     using Base = TunnelSender;
     using Base::Base;
-    MPPDataPacketPtr readForLocal();
+    TunnelPacketPtr readForLocal();
 };
 
 using TunnelSenderPtr = std::shared_ptr<TunnelSender>;
@@ -207,7 +221,8 @@ public:
         int input_steams_num_,
         bool is_local_,
         bool is_async_,
-        const String & req_id);
+        const String & req_id,
+        size_t max_inflight_bytes = 0);
 
     // For gtest usage
     MPPTunnel(
@@ -216,7 +231,8 @@ public:
         int input_steams_num_,
         bool is_local_,
         bool is_async_,
-        const String & req_id);
+        const String & req_id,
+        size_t max_inflight_bytes = 0);
 
     ~MPPTunnel();
 
@@ -224,6 +240,11 @@ public:
 
     // write a single packet to the tunnel, it will block if tunnel is not ready.
     void write(const mpp::MPPDataPacket & data, bool close_after_write = false);
+    // same as above, but the packet is moved into the tunnel without copying the chunks.
+    void write(mpp::MPPDataPacket && data, bool close_after_write = false);
+
+    // write a packet along with the blocks not encoded, only for the local tunnel.
+    void write(const mpp::MPPDataPacket & data, std::vector<Block> blocks, std::vector<UInt64> stream_ids = {});
 
     // finish the writing.
     void writeDone();
@@ -240,6 +261,17 @@ public:
 
     const ConnectionProfileInfo & getConnectionProfileInfo() const { return connection_profile_info; }
 
+    // record the compressed chunks written to this tunnel, see `ConnectionProfileInfo`.
+    void addCompressionProfile(Int64 uncompressed_bytes, Int64 compressed_bytes, UInt64 compression_time_ns)
+    {
+        connection_profile_info.uncompressed_bytes += uncompressed_bytes;
+        connection_profile_info.compressed_bytes += compressed_bytes;
+        connection_profile_info.compression_time_ns += compression_time_ns;
+    }
+
+    // whether the receiver has stopped reading on purpose, the packets written afterwards are dropped silently.
+    bool isReceiverDone();
+
     bool isLocal() const { return mode == TunnelSenderMode::LOCAL; }
     bool isAsync() const { return mode == TunnelSenderMode::ASYNC_GRPC; }
 
@@ -268,6 +300,8 @@ private:
 
     void waitForSenderFinish(bool allow_throw);
 
+    void writeImpl(TunnelPacketPtr && data, size_t bytes, bool close_after_write);
+
     std::mutex mu;
     std::condition_variable cv_for_status_changed;
 
@@ -278,9 +312,10 @@ private:
     // tunnel id is in the format like "tunnel[sender]+[receiver]"
     String tunnel_id;
 
-    using MPPDataPacketPtr = std::shared_ptr<mpp::MPPDataPacket>;
-    using DataPacketMPMCQueuePtr = std::shared_ptr<MPMCQueue<MPPDataPacketPtr>>;
+    using DataPacketMPMCQueuePtr = std::shared_ptr<MPMCQueue<TunnelPacketPtr>>;
     DataPacketMPMCQueuePtr send_queue;
+    // the bytes of the packets in flight are bounded by `credits` if it is not null, see `TunnelCredits`.
+    TunnelCreditsPtr credits;
     ConnectionProfileInfo connection_profile_info;
     const LoggerPtr log;
     TunnelSenderMode mode; // Tunnel transfer data mode
@@ -14,10 +14,14 @@
 
 #include <Common/Exception.h>
 #include <Common/FailPoint.h>
+#include <Common/Stopwatch.h>
+#include <Flash/Coprocessor/CHBlockChunkCodec.h>
 #include <Flash/Mpp/MPPTunnelSet.h>
 #include <Flash/Mpp/Utils.h>
 #include <fmt/core.h>
 
+#include <optional>
+
 namespace DB
 {
 namespace FailPoints
@@ -76,22 +80,88 @@ void MPPTunnelSetBase<Tunnel>::write(tipb::SelectResponse & response)
     }
 }
 
+template <typename Tunnel>
+void MPPTunnelSetBase<Tunnel>::compressPacket(mpp::MPPDataPacket & packet, size_t partition_id, CompressionMethod method)
+{
+    Stopwatch watch;
+    Int64 uncompressed_bytes = 0;
+    Int64 compressed_bytes = 0;
+    for (auto & chunk : *packet.mutable_chunks())
+    {
+        String compressed_chunk = CHBlockChunkCodec::compress(chunk, method);
+        if (!CHBlockChunkCodec::isCompressed(compressed_chunk))
+            continue;
+        uncompressed_bytes += chunk.size();
+        compressed_bytes += compressed_chunk.size();
+        chunk = std::move(compressed_chunk);
+    }
+    tunnels[partition_id]->addCompressionProfile(uncompressed_bytes, compressed_bytes, watch.elapsed());
+}
+
+template <typename Tunnel>
+CompressionMethod MPPTunnelSetBase<Tunnel>::getBroadcastCompressionMethod(size_t packet_bytes)
+{
+    if (compression_method != CompressionMethod::NONE || broadcast_compression_threshold == 0)
+        return compression_method;
+    if (broadcast_compression_started.load(std::memory_order_relaxed))
+        return broadcast_compression_method;
+
+    const size_t bytes = packet_bytes * remote_tunnel_cnt;
+    const size_t total_bytes = broadcast_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (total_bytes <= broadcast_compression_threshold)
+        return CompressionMethod::NONE;
+
+    bool started = false;
+    if (broadcast_compression_started.compare_exchange_strong(started, true))
+        LOG_FMT_INFO(log, "broadcast {} bytes to {} remote tunnels, start to compress the chunks", total_bytes, remote_tunnel_cnt);
+    return broadcast_compression_method;
+}
+
 template <typename Tunnel>
 void MPPTunnelSetBase<Tunnel>::write(mpp::MPPDataPacket & packet)
 {
     checkPacketSize(packet.ByteSizeLong());
-    tunnels[0]->write(packet);
-    auto tunnels_size = tunnels.size();
-    if (tunnels_size > 1)
+    const CompressionMethod method = getBroadcastCompressionMethod(packet.ByteSizeLong());
+    /// the chunks are compressed only once for all the remote tunnels
+    std::optional<mpp::MPPDataPacket> compressed_packet;
+    /// the packets are moved to the last tunnels writing them instead of copied
+    size_t last_plain_index = tunnels.size();
+    size_t last_compressed_index = tunnels.size();
+    for (size_t i = 0; i < tunnels.size(); ++i)
     {
-        if (!packet.data().empty())
+        if (needCompress(i, method))
         {
-            packet.mutable_data()->clear();
+            if (!compressed_packet)
+            {
+                compressed_packet = packet;
+                compressPacket(*compressed_packet, i, method);
+            }
+            last_compressed_index = i;
         }
-        for (size_t i = 1; i < tunnels_size; ++i)
+        else
         {
-            tunnels[i]->write(packet);
+            last_plain_index = i;
+        }
+    }
+
+    for (size_t i = 0; i < tunnels.size(); ++i)
+    {
+        /// only the first tunnel gets the execution summaries
+        if (i == 1 && !packet.data().empty())
+        {
+            packet.mutable_data()->clear();
+            if (compressed_packet)
+                compressed_packet->mutable_data()->clear();
         }
+
+        if (i == last_compressed_index)
+            tunnels[i]->write(std::move(*compressed_packet));
+        else if (i == last_plain_index)
+            tunnels[i]->write(std::move(packet));
+        else if (needCompress(i, method))
+            tunnels[i]->write(*compressed_packet);
+        else
+            tunnels[i]->write(packet);
     }
 }
 
@@ -111,7 +181,58 @@ void MPPTunnelSetBase<Tunnel>::write(mpp::MPPDataPacket & packet, int16_t partit
     if (partition_id != 0 && !packet.data().empty())
         packet.mutable_data()->clear();
 
-    tunnels[partition_id]->write(packet);
+    if (needCompress(partition_id))
+        compressPacket(packet, partition_id, compression_method);
+    tunnels[partition_id]->write(std::move(packet));
+}
+
+template <typename Tunnel>
+void MPPTunnelSetBase<Tunnel>::write(mpp::MPPDataPacket & packet, const std::vector<Block> & blocks)
+{
+    checkPacketSize(packet.ByteSizeLong());
+    const CompressionMethod method = getBroadcastCompressionMethod(packet.ByteSizeLong());
+    std::optional<mpp::MPPDataPacket> compressed_packet;
+    for (size_t i = 0; i < tunnels.size(); ++i)
+    {
+        /// only the first tunnel gets the execution summaries
+        if (i == 1 && !packet.data().empty())
+        {
+            packet.mutable_data()->clear();
+            if (compressed_packet)
+                compressed_packet->mutable_data()->clear();
+        }
+
+        if (canWriteBlocks(i))
+        {
+            mpp::MPPDataPacket block_packet;
+            if (!packet.data().empty())
+                block_packet.set_data(packet.data());
+            tunnels[i]->write(block_packet, blocks);
+        }
+        else if (needCompress(i, method))
+        {
+            if (!compressed_packet)
+            {
+                compressed_packet = packet;
+                compressPacket(*compressed_packet, i, method);
+            }
+            tunnels[i]->write(*compressed_packet);
+        }
+        else
+        {
+            tunnels[i]->write(packet);
+        }
+    }
+}
+
+template <typename Tunnel>
+void MPPTunnelSetBase<Tunnel>::write(mpp::MPPDataPacket & packet, std::vector<Block> && blocks, std::vector<UInt64> && stream_ids, int16_t partition_id)
+{
+    assert(canWriteBlocks(partition_id));
+    if (partition_id != 0 && !packet.data().empty())
+        packet.mutable_data()->clear();
+
+    tunnels[partition_id]->write(packet, std::move(blocks), std::move(stream_ids));
 }
 
 template <typename Tunnel>
@@ -144,6 +265,10 @@ void MPPTunnelSetBase<Tunnel>::registerTunnel(const MPPTaskId & receiver_task_id
     {
         remote_tunnel_cnt++;
     }
+    else if (enable_local_block_exchange)
+    {
+        block_tunnel_cnt++;
+    }
 }
 
 template <typename Tunnel>
@@ -162,6 +287,17 @@ void MPPTunnelSetBase<Tunnel>::finishWrite()
     }
 }
 
+template <typename Tunnel>
+bool MPPTunnelSetBase<Tunnel>::isAllReceiversDone() const
+{
+    for (const auto & tunnel : tunnels)
+    {
+        if (!tunnel->isReceiverDone())
+            return false;
+    }
+    return !tunnels.empty();
+}
+
 template <typename Tunnel>
 typename MPPTunnelSetBase<Tunnel>::TunnelPtr MPPTunnelSetBase<Tunnel>::getTunnelByReceiverTaskId(const MPPTaskId & id)
 {
@@ -16,6 +16,7 @@
 
 #include <Flash/Mpp/MPPTaskId.h>
 #include <Flash/Mpp/MPPTunnel.h>
+#include <IO/CompressedStream.h>
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
@@ -26,6 +27,8 @@
 #endif
 #include <boost/noncopyable.hpp>
 
+#include <atomic>
+
 namespace DB
 {
 template <typename Tunnel>
@@ -33,8 +36,17 @@ class MPPTunnelSetBase : private boost::noncopyable
 {
 public:
     using TunnelPtr = std::shared_ptr<Tunnel>;
-    explicit MPPTunnelSetBase(const String & req_id)
+    explicit MPPTunnelSetBase(
+        const String & req_id,
+        bool enable_local_block_exchange_ = false,
+        CompressionMethod compression_method_ = CompressionMethod::NONE,
+        CompressionMethod broadcast_compression_method_ = CompressionMethod::NONE,
+        size_t broadcast_compression_threshold_ = 0)
         : log(Logger::get("MPPTunnelSet", req_id))
+        , enable_local_block_exchange(enable_local_block_exchange_)
+        , compression_method(compression_method_)
+        , broadcast_compression_method(broadcast_compression_method_)
+        , broadcast_compression_threshold(broadcast_compression_threshold_)
     {}
 
     void clearExecutionSummaries(tipb::SelectResponse & response);
@@ -48,15 +60,35 @@ public:
     /// information in TiDB will be amplified, which may make
     /// user confused.
     // this is a broadcast writing.
+    // `packet` is moved to the last tunnel writing it, so the chunks are copied only for the other tunnels.
     void write(tipb::SelectResponse & response);
     void write(mpp::MPPDataPacket & packet);
 
     // this is a partition writing.
+    // `packet` is moved to the tunnel without copying the chunks, so it should not be used after writing.
     void write(tipb::SelectResponse & response, int16_t partition_id);
     void write(mpp::MPPDataPacket & packet, int16_t partition_id);
+
+    /// The local tunnels are able to pass the blocks to the receivers in the same process directly,
+    /// without encoding them into MPPDataPacket.chunks.
+    // this is a broadcast writing, `blocks` are written to the local tunnels, and `packet`
+    // with the chunks encoded from `blocks` is written to others.
+    void write(mpp::MPPDataPacket & packet, const std::vector<Block> & blocks);
+    // this is a partition writing, only for the tunnel that `canWriteBlocks`.
+    void write(mpp::MPPDataPacket & packet, std::vector<Block> && blocks, std::vector<UInt64> && stream_ids, int16_t partition_id);
+
+    bool canWriteBlocks(size_t partition_id) const { return enable_local_block_exchange && tunnels[partition_id]->isLocal(); }
+    /// The chunks written to the remote tunnels are compressed by `compression_method` unless it is NONE,
+    /// the local tunnels don't go through the network and are never compressed.
+    bool needCompress(size_t partition_id) const { return needCompress(partition_id, compression_method); }
+    /// Whether the broadcast writing has switched to compress the chunks, see `getBroadcastCompressionMethod`.
+    bool isBroadcastCompressionStarted() const { return broadcast_compression_started.load(); }
+    int getBlockTunnelCnt() const { return block_tunnel_cnt; }
     void writeError(const String & msg);
     void close(const String & reason);
     void finishWrite();
+    /// Whether every receiver has stopped reading on purpose, e.g. their LIMIT are reached, then the sender can stop early.
+    bool isAllReceiversDone() const;
     void registerTunnel(const MPPTaskId & id, const TunnelPtr & tunnel);
 
     TunnelPtr getTunnelByReceiverTaskId(const MPPTaskId & id);
@@ -71,11 +103,28 @@ public:
     const std::vector<TunnelPtr> & getTunnels() const { return tunnels; }
 
 private:
+    bool needCompress(size_t partition_id, CompressionMethod method) const { return method != CompressionMethod::NONE && !tunnels[partition_id]->isLocal(); }
+    // compress the chunks of `packet` in place and record the profile to the tunnel of `partition_id`.
+    void compressPacket(mpp::MPPDataPacket & packet, size_t partition_id, CompressionMethod method);
+    /// A broadcast writing sends the same packet to every remote tunnel, so a large build side of a broadcast join
+    /// multiplies the network traffic. If `compression_method` is NONE, the broadcast writing switches to
+    /// `broadcast_compression_method` once it has sent more than `broadcast_compression_threshold` bytes to the
+    /// remote tunnels. The method is returned per packet, so all the tunnels of a packet agree on it.
+    CompressionMethod getBroadcastCompressionMethod(size_t packet_bytes);
+
     std::vector<TunnelPtr> tunnels;
     std::unordered_map<MPPTaskId, size_t> receiver_task_id_to_index_map;
     const LoggerPtr log;
+    const bool enable_local_block_exchange;
+    const CompressionMethod compression_method;
+    const CompressionMethod broadcast_compression_method;
+    const size_t broadcast_compression_threshold;
+    std::atomic<size_t> broadcast_bytes{0};
+    std::atomic<bool> broadcast_compression_started{false};
 
     int remote_tunnel_cnt = 0;
+    // The number of tunnels that `canWriteBlocks`.
+    int block_tunnel_cnt = 0;
 };
 
 class MPPTunnelSet : public MPPTunnelSetBase<MPPTunnel>
@@ -12,11 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/CurrentMetrics.h>
+#include <Common/DynamicThreadPool.h>
 #include <Common/FailPoint.h>
 #include <Common/TiFlashMetrics.h>
 #include <Flash/Mpp/MPPTaskManager.h>
 #include <Flash/Mpp/MinTSOScheduler.h>
 
+namespace CurrentMetrics
+{
+extern const Metric MemoryTracking;
+} // namespace CurrentMetrics
+
 namespace DB
 {
 namespace FailPoints
@@ -27,11 +34,13 @@ extern const char random_min_tso_scheduler_failpoint[];
 constexpr UInt64 MAX_UINT64 = std::numeric_limits<UInt64>::max();
 constexpr UInt64 OS_THREAD_SOFT_LIMIT = 100000;
 
-MinTSOScheduler::MinTSOScheduler(UInt64 soft_limit, UInt64 hard_limit)
+MinTSOScheduler::MinTSOScheduler(UInt64 soft_limit, UInt64 hard_limit, UInt64 memory_limit_)
     : min_tso(MAX_UINT64)
     , thread_soft_limit(soft_limit)
     , thread_hard_limit(hard_limit)
     , estimated_thread_usage(0)
+    , memory_limit(memory_limit_)
+    , estimated_memory_usage(0)
     , log(&Poco::Logger::get("MinTSOScheduler"))
 {
     auto cores = getNumberOfPhysicalCPUCores();
@@ -52,10 +61,13 @@ MinTSOScheduler::MinTSOScheduler(UInt64 soft_limit, UInt64 hard_limit)
         {
             LOG_FMT_INFO(log, "thread_hard_limit is {}, thread_soft_limit is {}, and active_set_soft_limit is {} in MinTSOScheduler.", thread_hard_limit, thread_soft_limit, active_set_soft_limit);
         }
+        LOG_FMT_INFO(log, "memory_limit is {} in MinTSOScheduler.", memory_limit);
         GET_METRIC(tiflash_task_scheduler, type_min_tso).Set(min_tso);
         GET_METRIC(tiflash_task_scheduler, type_thread_soft_limit).Set(thread_soft_limit);
         GET_METRIC(tiflash_task_scheduler, type_thread_hard_limit).Set(thread_hard_limit);
         GET_METRIC(tiflash_task_scheduler, type_estimated_thread_usage).Set(estimated_thread_usage);
+        GET_METRIC(tiflash_task_scheduler, type_memory_limit).Set(memory_limit);
+        GET_METRIC(tiflash_task_scheduler, type_estimated_memory_usage).Set(estimated_memory_usage);
         GET_METRIC(tiflash_task_scheduler, type_waiting_queries_count).Set(0);
         GET_METRIC(tiflash_task_scheduler, type_active_queries_count).Set(0);
         GET_METRIC(tiflash_task_scheduler, type_waiting_tasks_count).Set(0);
@@ -121,7 +133,7 @@ void MinTSOScheduler::deleteQuery(const UInt64 tso, MPPTaskManager & task_manage
 }
 
 /// NOTE: should not throw exceptions due to being called when destruction.
-void MinTSOScheduler::releaseThreadsThenSchedule(const int needed_threads, MPPTaskManager & task_manager)
+void MinTSOScheduler::releaseResourcesThenSchedule(const int needed_threads, const UInt64 needed_memory, MPPTaskManager & task_manager)
 {
     if (isDisabled())
     {
@@ -134,9 +146,11 @@ void MinTSOScheduler::releaseThreadsThenSchedule(const int needed_threads, MPPTa
         std::terminate();
     }
     estimated_thread_usage -= needed_threads;
+    estimated_memory_usage -= std::min(estimated_memory_usage, needed_memory);
     GET_METRIC(tiflash_task_scheduler, type_estimated_thread_usage).Set(estimated_thread_usage);
+    GET_METRIC(tiflash_task_scheduler, type_estimated_memory_usage).Set(estimated_memory_usage);
     GET_METRIC(tiflash_task_scheduler, type_active_tasks_count).Decrement();
-    /// as tasks release some threads, so some tasks would get scheduled.
+    /// as tasks release some threads and memory, so some tasks would get scheduled.
     scheduleWaitingQueries(task_manager);
 }
 
@@ -183,16 +197,19 @@ void MinTSOScheduler::scheduleWaitingQueries(MPPTaskManager & task_manager)
 bool MinTSOScheduler::scheduleImp(const UInt64 tso, const MPPQueryTaskSetPtr & query_task_set, const MPPTaskPtr & task, const bool isWaiting, bool & has_error)
 {
     auto needed_threads = task->getNeededThreads();
+    auto needed_memory = task->getNeededMemory();
     auto check_for_new_min_tso = tso <= min_tso && estimated_thread_usage + needed_threads <= thread_hard_limit;
-    auto check_for_not_min_tso = (active_set.size() < active_set_soft_limit || tso <= *active_set.rbegin()) && (estimated_thread_usage + needed_threads <= thread_soft_limit);
+    auto check_for_not_min_tso = (active_set.size() < active_set_soft_limit || tso <= *active_set.rbegin()) && hasEnoughThreads(needed_threads) && hasEnoughMemory(needed_memory);
     if (check_for_new_min_tso || check_for_not_min_tso)
     {
         updateMinTSO(tso, false, isWaiting ? "from the waiting set" : "when directly schedule it");
         active_set.insert(tso);
         estimated_thread_usage += needed_threads;
+        estimated_memory_usage += needed_memory;
         task->scheduleThisTask(MPPTask::ScheduleState::SCHEDULED);
         GET_METRIC(tiflash_task_scheduler, type_active_queries_count).Set(active_set.size());
         GET_METRIC(tiflash_task_scheduler, type_estimated_thread_usage).Set(estimated_thread_usage);
+        GET_METRIC(tiflash_task_scheduler, type_estimated_memory_usage).Set(estimated_memory_usage);
         GET_METRIC(tiflash_task_scheduler, type_active_tasks_count).Increment();
         LOG_FMT_INFO(log, "{} is scheduled (active set size = {}) due to available threads {}, after applied for {} threads, used {} of the thread {} limit {}.", task->getId().toString(), active_set.size(), isWaiting ? " from the waiting set" : " directly", needed_threads, estimated_thread_usage, min_tso == tso ? "hard" : "soft", min_tso == tso ? thread_hard_limit : thread_soft_limit);
         return true;
@@ -226,11 +243,32 @@ bool MinTSOScheduler::scheduleImp(const UInt64 tso, const MPPQueryTaskSetPtr & q
             GET_METRIC(tiflash_task_scheduler, type_waiting_queries_count).Set(waiting_set.size());
             GET_METRIC(tiflash_task_scheduler, type_waiting_tasks_count).Increment();
         }
-        LOG_FMT_INFO(log, "threads are unavailable for the query {} or active set is full (size =  {}), need {}, but used {} of the thread soft limit {},{} waiting set size = {}", tso, active_set.size(), needed_threads, estimated_thread_usage, thread_soft_limit, isWaiting ? "" : " put into", waiting_set.size());
+        LOG_FMT_INFO(log, "threads or memory are unavailable for the query {} or active set is full (size =  {}), need {} threads and {} bytes, but used {} of the thread soft limit {} and {} of the memory limit {},{} waiting set size = {}", tso, active_set.size(), needed_threads, needed_memory, estimated_thread_usage, thread_soft_limit, estimated_memory_usage, memory_limit, isWaiting ? "" : " put into", waiting_set.size());
         return false;
     }
 }
 
+/// The observed memory of all queries catches the underestimated queries, and the estimated memory covers the just admitted
+/// queries that have not allocated yet.
+bool MinTSOScheduler::hasEnoughMemory(const UInt64 needed_memory) const
+{
+    if (memory_limit == 0)
+        return true;
+    auto observed_memory_usage = static_cast<UInt64>(std::max<Int64>(CurrentMetrics::get(CurrentMetrics::MemoryTracking), 0));
+    return std::max(estimated_memory_usage, observed_memory_usage) + needed_memory <= memory_limit;
+}
+
+/// Like `hasEnoughMemory`, the observed threads catch the underestimated queries, and the estimated threads cover the just
+/// admitted queries that have not started their threads yet.
+bool MinTSOScheduler::hasEnoughThreads(const UInt64 needed_threads) const
+{
+    UInt64 observed_thread_usage = 0;
+    if (DynamicThreadPool::global_instance)
+        observed_thread_usage = static_cast<UInt64>(DynamicThreadPool::global_instance->threadCount().active);
+    GET_METRIC(tiflash_task_scheduler, type_observed_thread_usage).Set(observed_thread_usage);
+    return std::max(estimated_thread_usage, observed_thread_usage) + needed_threads <= thread_soft_limit;
+}
+
 /// if return true, then need to schedule the waiting tasks of the min_tso.
 bool MinTSOScheduler::updateMinTSO(const UInt64 tso, const bool retired, const String msg)
 {
@@ -32,10 +32,15 @@ using MPPQueryTaskSetPtr = std::shared_ptr<MPPQueryTaskSet>;
 /// The min_tso query avoids the deadlock resulted from threads competition among nodes.
 /// schedule tasks under the lock protection of the task manager.
 /// NOTE: if the updated min-tso query has waiting tasks, necessarily scheduling them, otherwise the query would hang.
+/// If the memory limit is set, the queries newer than the min_tso query are also admitted only when the larger one of the estimated
+/// and the observed memory usage leaves room for the estimated memory of the task, otherwise they wait instead of running into OOM.
+/// The min_tso query is never blocked by memory, for the same deadlock reason as above.
+/// The same goes for threads, the newer queries are admitted under the soft limit by the larger one of the estimated threads
+/// and the threads really running in `DynamicThreadPool`, so an underestimated query doesn't let more queries run on top of it.
 class MinTSOScheduler : private boost::noncopyable
 {
 public:
-    MinTSOScheduler(UInt64 soft_limit, UInt64 hard_limit);
+    MinTSOScheduler(UInt64 soft_limit, UInt64 hard_limit, UInt64 memory_limit_ = 0);
     ~MinTSOScheduler() = default;
     /// try to schedule this task if it is the min_tso query or there are enough threads, otherwise put it into the waiting set.
     /// NOTE: call tryToSchedule under the lock protection of MPPTaskManager
@@ -45,13 +50,15 @@ public:
     /// NOTE: call deleteQuery under the lock protection of MPPTaskManager
     void deleteQuery(const UInt64 tso, MPPTaskManager & task_manager, const bool is_cancelled);
 
-    /// all scheduled tasks should finally call this function to release threads and schedule new tasks
-    void releaseThreadsThenSchedule(const int needed_threads, MPPTaskManager & task_manager);
+    /// all scheduled tasks should finally call this function to release threads and memory and schedule new tasks
+    void releaseResourcesThenSchedule(const int needed_threads, const UInt64 needed_memory, MPPTaskManager & task_manager);
 
 private:
     bool scheduleImp(const UInt64 tso, const MPPQueryTaskSetPtr & query_task_set, const MPPTaskPtr & task, const bool isWaiting, bool & has_error);
     bool updateMinTSO(const UInt64 tso, const bool retired, const String msg);
     void scheduleWaitingQueries(MPPTaskManager & task_manager);
+    bool hasEnoughMemory(const UInt64 needed_memory) const;
+    bool hasEnoughThreads(const UInt64 needed_threads) const;
     bool isDisabled()
     {
         return thread_hard_limit == 0 && thread_soft_limit == 0;
@@ -62,6 +69,9 @@ private:
     UInt64 thread_soft_limit;
     UInt64 thread_hard_limit;
     UInt64 estimated_thread_usage;
+    /// 0 means no memory admission control.
+    UInt64 memory_limit;
+    UInt64 estimated_memory_usage;
     /// to prevent from too many queries just issue a part of tasks to occupy threads, in proportion to the hardware cores.
     size_t active_set_soft_limit;
     Poco::Logger * log;
@@ -48,5 +48,9 @@ public:
 
     // Finish rpc with a status. Needed by async writer. For sync writer it is useless but not harmful.
     virtual void writeDone(const ::grpc::Status & /*status*/) {}
+
+    // Whether the rpc is cancelled by the receiver, which needs no more data, e.g. its LIMIT is reached.
+    // It tells a failed `write` caused by the receiver from the real errors.
+    virtual bool isCancelledByReceiver() const { return false; }
 };
 }; // namespace DB
@@ -0,0 +1,85 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <cassert>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace DB
+{
+/// Credit-based flow control between a MPPTunnel and its ExchangeReceiver.
+/// The tunnel owns `capacity` bytes of credits granted by the receiver. It acquires credits for each packet
+/// before queueing it, and blocks when they run out, so the writer stops encoding more data. The credits are
+/// granted back when the packet is released: for a local tunnel that is after the ExchangeReceiver has
+/// decoded it, for a remote tunnel that is after it is written to gRPC, whose own flow control takes over.
+class TunnelCredits : private boost::noncopyable
+{
+public:
+    explicit TunnelCredits(size_t capacity_)
+        : capacity(capacity_)
+    {}
+
+    /// Return false if cancelled. A packet larger than `capacity` is admitted only when no other packet is in flight.
+    bool acquire(size_t bytes)
+    {
+        std::unique_lock lock(mu);
+        cv.wait(lock, [&] { return cancelled || used == 0 || used + bytes <= capacity; });
+        if (cancelled)
+            return false;
+        used += bytes;
+        return true;
+    }
+
+    void release(size_t bytes)
+    {
+        {
+            std::lock_guard lock(mu);
+            assert(used >= bytes);
+            used -= bytes;
+        }
+        cv.notify_all();
+    }
+
+    /// Wake up and fail all the current and future `acquire`.
+    void cancel()
+    {
+        {
+            std::lock_guard lock(mu);
+            cancelled = true;
+        }
+        cv.notify_all();
+    }
+
+    size_t getUsed() const
+    {
+        std::lock_guard lock(mu);
+        return used;
+    }
+
+private:
+    const size_t capacity;
+
+    mutable std::mutex mu;
+    std::condition_variable cv;
+    size_t used = 0;
+    bool cancelled = false;
+};
+using TunnelCreditsPtr = std::shared_ptr<TunnelCredits>;
+
+} // namespace DB
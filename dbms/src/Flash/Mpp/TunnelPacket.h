@@ -0,0 +1,67 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Core/Block.h>
+#include <Flash/Mpp/TunnelCredits.h>
+#include <kvproto/mpp.pb.h>
+
+#include <memory>
+#include <vector>
+
+namespace DB
+{
+/// The element in the send queue of MPPTunnel.
+/// Besides `packet`, a local tunnel may carry `blocks`, which are passed to the ExchangeReceiver in the
+/// same process as they are, without being encoded into `packet.chunks`. The columns of `blocks` may
+/// be shared by the receivers of a broadcast, so they must be treated as immutable.
+/// The credits acquired for the packet, if any, are granted back to the tunnel when it is destroyed.
+struct TunnelPacket : private boost::noncopyable
+{
+    explicit TunnelPacket(std::shared_ptr<mpp::MPPDataPacket> packet_)
+        : packet(std::move(packet_))
+    {}
+
+    TunnelPacket(std::shared_ptr<mpp::MPPDataPacket> packet_, std::vector<Block> blocks_, std::vector<UInt64> stream_ids_)
+        : packet(std::move(packet_))
+        , blocks(std::move(blocks_))
+        , stream_ids(std::move(stream_ids_))
+    {}
+
+    ~TunnelPacket()
+    {
+        if (credits)
+            credits->release(credit_bytes);
+    }
+
+    size_t blocksBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto & block : blocks)
+            bytes += block.bytes();
+        return bytes;
+    }
+
+    std::shared_ptr<mpp::MPPDataPacket> packet;
+    std::vector<Block> blocks;
+    /// Only used by fine grained shuffle, `blocks[i]` belongs to the stream `stream_ids[i]`.
+    std::vector<UInt64> stream_ids;
+
+    TunnelCreditsPtr credits;
+    size_t credit_bytes = 0;
+};
+using TunnelPacketPtr = std::shared_ptr<TunnelPacket>;
+
+} // namespace DB
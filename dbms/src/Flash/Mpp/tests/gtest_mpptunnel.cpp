@@ -13,10 +13,12 @@
 // limitations under the License.
 
 #include <Common/Exception.h>
+#include <DataTypes/DataTypesNumber.h>
 #include <Flash/Mpp/GRPCReceiverContext.h>
 #include <Flash/Mpp/MPPTunnel.h>
 #include <TestUtils/TiFlashTestBasic.h>
 
+#include <future>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -46,10 +48,22 @@ class MockFailedWriter : public PacketWriter
     }
 };
 
+/// Fails to write because the receiver cancels the rpc.
+class MockCancelledWriter : public PacketWriter
+{
+    bool write(const mpp::MPPDataPacket &) override
+    {
+        return false;
+    }
+
+    bool isCancelledByReceiver() const override { return true; }
+};
+
 struct MockLocalReader
 {
     LocalTunnelSenderPtr local_sender;
     std::vector<String> write_packet_vec;
+    std::vector<Block> write_block_vec;
     std::shared_ptr<ThreadManager> thread_manager;
 
     explicit MockLocalReader(const LocalTunnelSenderPtr & local_sender_)
@@ -77,11 +91,13 @@ struct MockLocalReader
     {
         while (true)
         {
-            MPPDataPacketPtr tmp_packet = local_sender->readForLocal();
+            TunnelPacketPtr tmp_packet = local_sender->readForLocal();
             bool success = tmp_packet != nullptr;
             if (success)
             {
-                write_packet_vec.push_back(tmp_packet->data());
+                write_packet_vec.push_back(tmp_packet->packet->data());
+                for (auto & block : tmp_packet->blocks)
+                    write_block_vec.push_back(std::move(block));
             }
             else
             {
@@ -118,7 +134,7 @@ struct MockTerminateLocalReader
 
     void read() const
     {
-        MPPDataPacketPtr tmp_packet = local_sender->readForLocal();
+        TunnelPacketPtr tmp_packet = local_sender->readForLocal();
         local_sender->consumerFinish("Receiver closed");
     }
 };
@@ -248,6 +264,11 @@ public:
     {
         return sender->isConsumerFinished();
     }
+
+    size_t getTunnelUsedCredits(MPPTunnelPtr tunnel)
+    {
+        return tunnel->credits->getUsed();
+    }
 };
 
 TEST_F(TestMPPTunnel, ConnectWhenFinished)
@@ -444,6 +465,26 @@ TEST_F(TestMPPTunnel, WriteAfterFinished)
     }
 }
 
+TEST_F(TestMPPTunnel, WriteAfterReceiverDone)
+try
+{
+    auto mpp_tunnel_ptr = constructRemoteSyncTunnel();
+    std::unique_ptr<PacketWriter> writer_ptr = std::make_unique<MockCancelledWriter>();
+    mpp_tunnel_ptr->connect(writer_ptr.get());
+    auto data_packet_ptr = std::make_unique<mpp::MPPDataPacket>();
+    data_packet_ptr->set_data("First");
+    mpp_tunnel_ptr->write(*data_packet_ptr);
+    waitSyncTunnelSenderThread(mpp_tunnel_ptr->getSyncTunnelSender());
+    GTEST_ASSERT_EQ(mpp_tunnel_ptr->isReceiverDone(), true);
+
+    /// The packets written after the receiver is done are dropped without error.
+    mpp_tunnel_ptr->write(*data_packet_ptr);
+    mpp_tunnel_ptr->write(*data_packet_ptr);
+    mpp_tunnel_ptr->writeDone();
+    GTEST_ASSERT_EQ(getTunnelFinishedFlag(mpp_tunnel_ptr), true);
+}
+CATCH
+
 /// Test Local MPPTunnel
 TEST_F(TestMPPTunnel, LocalConnectWhenFinished)
 try
@@ -532,6 +573,115 @@ try
 }
 CATCH
 
+TEST_F(TestMPPTunnel, LocalReceiverDone)
+try
+{
+    auto mpp_tunnel_ptr = constructLocalSyncTunnel();
+    mpp_tunnel_ptr->connect(nullptr);
+    std::unique_ptr<mpp::MPPDataPacket> data_packet_ptr = std::make_unique<mpp::MPPDataPacket>();
+    data_packet_ptr->set_data("First");
+    mpp_tunnel_ptr->write(*data_packet_ptr);
+    GTEST_ASSERT_EQ(mpp_tunnel_ptr->isReceiverDone(), false);
+
+    mpp_tunnel_ptr->getLocalTunnelSender()->consumerFinish("", /*receiver_done_=*/true);
+    GTEST_ASSERT_EQ(mpp_tunnel_ptr->isReceiverDone(), true);
+    mpp_tunnel_ptr->write(*data_packet_ptr);
+    mpp_tunnel_ptr->writeDone();
+    GTEST_ASSERT_EQ(getTunnelFinishedFlag(mpp_tunnel_ptr), true);
+}
+CATCH
+
+TEST_F(TestMPPTunnel, LocalConnectWriteMovedPacket)
+try
+{
+    auto mpp_tunnel_ptr = constructLocalSyncTunnel();
+    auto local_reader_ptr = connectLocalSyncTunnel(mpp_tunnel_ptr);
+    GTEST_ASSERT_EQ(getTunnelConnectedFlag(mpp_tunnel_ptr), true);
+
+    mpp::MPPDataPacket packet;
+    packet.set_data("First");
+    mpp_tunnel_ptr->write(std::move(packet));
+    mpp_tunnel_ptr->writeDone();
+    local_reader_ptr->thread_manager->wait(); // Join local read thread
+    GTEST_ASSERT_EQ(getTunnelSenderConsumerFinishedFlag(mpp_tunnel_ptr->getTunnelSender()), true);
+    GTEST_ASSERT_EQ(local_reader_ptr->write_packet_vec.size(), 1);
+    GTEST_ASSERT_EQ(local_reader_ptr->write_packet_vec[0], "First");
+}
+CATCH
+
+TEST_F(TestMPPTunnel, LocalConnectWriteBlocks)
+try
+{
+    auto mpp_tunnel_ptr = constructLocalSyncTunnel();
+    auto local_reader_ptr = connectLocalSyncTunnel(mpp_tunnel_ptr);
+    GTEST_ASSERT_EQ(getTunnelConnectedFlag(mpp_tunnel_ptr), true);
+
+    auto type = std::make_shared<DataTypeInt64>();
+    auto column = type->createColumn();
+    for (Int64 i = 0; i < 10; ++i)
+        column->insert(Field(i));
+    std::vector<Block> blocks;
+    blocks.emplace_back(ColumnsWithTypeAndName{ColumnWithTypeAndName(std::move(column), type, "a")});
+
+    mpp::MPPDataPacket packet;
+    packet.set_data("First");
+    mpp_tunnel_ptr->write(packet, std::move(blocks));
+    mpp_tunnel_ptr->writeDone();
+    local_reader_ptr->thread_manager->wait(); // Join local read thread
+    GTEST_ASSERT_EQ(getTunnelSenderConsumerFinishedFlag(mpp_tunnel_ptr->getTunnelSender()), true);
+    GTEST_ASSERT_EQ(local_reader_ptr->write_packet_vec.size(), 1);
+    GTEST_ASSERT_EQ(local_reader_ptr->write_packet_vec[0], "First");
+    GTEST_ASSERT_EQ(local_reader_ptr->write_block_vec.size(), 1);
+    GTEST_ASSERT_EQ(local_reader_ptr->write_block_vec[0].rows(), 10);
+}
+CATCH
+
+TEST_F(TestMPPTunnel, TunnelCredits)
+try
+{
+    TunnelCredits credits(10);
+    ASSERT_TRUE(credits.acquire(6));
+    ASSERT_TRUE(credits.acquire(4));
+    ASSERT_EQ(credits.getUsed(), 10);
+
+    // blocked until the credits are granted back
+    auto acquire_future = std::async(std::launch::async, [&] { return credits.acquire(5); });
+    ASSERT_EQ(acquire_future.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+    credits.release(6);
+    ASSERT_TRUE(acquire_future.get());
+    ASSERT_EQ(credits.getUsed(), 9);
+
+    // a packet larger than the capacity is admitted when nothing is in flight
+    credits.release(9);
+    ASSERT_TRUE(credits.acquire(100));
+    credits.release(100);
+
+    ASSERT_TRUE(credits.acquire(10));
+    auto cancelled_future = std::async(std::launch::async, [&] { return credits.acquire(1); });
+    credits.cancel();
+    ASSERT_FALSE(cancelled_future.get());
+    ASSERT_FALSE(credits.acquire(1));
+}
+CATCH
+
+TEST_F(TestMPPTunnel, LocalWriteWithCredits)
+try
+{
+    auto mpp_tunnel_ptr = std::make_shared<MPPTunnel>(String("0000_0001"), timeout, 2, true, false, String("0"), /*max_inflight_bytes=*/1);
+    auto local_reader_ptr = connectLocalSyncTunnel(mpp_tunnel_ptr);
+
+    mpp::MPPDataPacket packet;
+    packet.set_data("First");
+    // every write has to wait for the previous packet to be consumed
+    for (size_t i = 0; i < 10; ++i)
+        mpp_tunnel_ptr->write(packet);
+    mpp_tunnel_ptr->writeDone();
+    local_reader_ptr->thread_manager->wait(); // Join local read thread
+    GTEST_ASSERT_EQ(local_reader_ptr->write_packet_vec.size(), 10);
+    GTEST_ASSERT_EQ(getTunnelUsedCredits(mpp_tunnel_ptr), 0);
+}
+CATCH
+
 TEST_F(TestMPPTunnel, LocalConsumerFinish)
 try
 {
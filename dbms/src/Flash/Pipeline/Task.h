@@ -0,0 +1,52 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <memory>
+
+namespace DB
+{
+enum class ExecTaskStatus
+{
+    WAITING,
+    RUNNING,
+    FINISHED,
+    ERROR,
+    CANCELLED,
+};
+
+/// A Task is a piece of a pipeline run by TaskScheduler.
+/// Unlike the IBlockInputStream tree, a task never parks its thread: `execute` does a small piece of CPU work
+/// and returns, and a task that has to wait for I/O or exchange data returns WAITING and is polled by `await`.
+class Task
+{
+public:
+    virtual ~Task() = default;
+
+    /// Run a small piece of work without blocking.
+    /// RUNNING: there is more work, WAITING: blocked on something, `await` is called until it is ready.
+    virtual ExecTaskStatus execute() = 0;
+
+    /// Check whether a WAITING task can go on, it must not block. Return RUNNING to be scheduled again.
+    virtual ExecTaskStatus await() { return ExecTaskStatus::RUNNING; }
+
+    /// Called exactly once when the task leaves the scheduler with FINISHED, ERROR or CANCELLED.
+    /// `execute` or `await` throwing an exception counts as ERROR.
+    virtual void finalize(ExecTaskStatus /*status*/) {}
+};
+using TaskPtr = std::unique_ptr<Task>;
+
+} // namespace DB
@@ -0,0 +1,239 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <Common/Stopwatch.h>
+#include <Common/getNumberOfPhysicalCPUCores.h>
+#include <Common/setThreadName.h>
+#include <Flash/Pipeline/TaskScheduler.h>
+#include <common/logger_useful.h>
+
+namespace DB
+{
+namespace
+{
+/// The interval of polling the waiting tasks when none of them is ready.
+constexpr auto wait_reactor_poll_interval = std::chrono::milliseconds(1);
+} // namespace
+
+TaskScheduler::TaskScheduler(size_t worker_num, std::chrono::milliseconds time_slice_)
+    : time_slice(time_slice_)
+    , log(Logger::get("TaskScheduler"))
+{
+    if (worker_num == 0)
+        worker_num = getNumberOfPhysicalCPUCores();
+    worker_queues.reserve(worker_num);
+    for (size_t i = 0; i < worker_num; ++i)
+        worker_queues.push_back(std::make_unique<WorkerQueue>());
+
+    workers.reserve(worker_num);
+    for (size_t i = 0; i < worker_num; ++i)
+        workers.emplace_back([this, i] { workerLoop(i); });
+    reactor = std::thread([this] { reactorLoop(); });
+    LOG_FMT_INFO(log, "TaskScheduler started with {} workers", worker_num);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard idle_lock(idle_mu);
+        std::lock_guard wait_lock(wait_mu);
+        is_shutdown = true;
+    }
+    idle_cv.notify_all();
+    wait_cv.notify_all();
+    for (auto & worker : workers)
+        worker.join();
+    reactor.join();
+
+    for (auto & queue : worker_queues)
+    {
+        for (auto & task : queue->tasks)
+            finalizeTask(std::move(task), ExecTaskStatus::CANCELLED);
+    }
+    for (auto & task : waiting_tasks)
+        finalizeTask(std::move(task), ExecTaskStatus::CANCELLED);
+    LOG_FMT_INFO(log, "TaskScheduler stopped");
+}
+
+void TaskScheduler::submit(TaskPtr && task)
+{
+    assert(task);
+    submitTo(next_queue.fetch_add(1, std::memory_order_relaxed) % worker_queues.size(), std::move(task));
+}
+
+void TaskScheduler::submitTo(size_t queue_index, TaskPtr && task)
+{
+    {
+        auto & queue = *worker_queues[queue_index];
+        std::lock_guard lock(queue.mu);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard lock(idle_mu);
+        ++queued_tasks;
+    }
+    idle_cv.notify_one();
+}
+
+bool TaskScheduler::popTask(size_t worker_index, TaskPtr & task)
+{
+    /// Take from the front of its own queue first, then steal from the back of the others.
+    for (size_t i = 0; i < worker_queues.size(); ++i)
+    {
+        auto & queue = *worker_queues[(worker_index + i) % worker_queues.size()];
+        std::lock_guard lock(queue.mu);
+        if (queue.tasks.empty())
+            continue;
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        else
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        --queued_tasks;
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::workerLoop(size_t worker_index)
+{
+    setThreadName("TaskWorker");
+    while (true)
+    {
+        TaskPtr task;
+        if (!popTask(worker_index, task))
+        {
+            std::unique_lock lock(idle_mu);
+            idle_cv.wait(lock, [&] { return is_shutdown || queued_tasks > 0; });
+            if (is_shutdown)
+                return;
+            continue;
+        }
+        auto status = runTask(*task);
+        handleTaskStatus(worker_index, std::move(task), status);
+        if (is_shutdown)
+            return;
+    }
+}
+
+ExecTaskStatus TaskScheduler::runTask(Task & task)
+{
+    Stopwatch watch;
+    try
+    {
+        while (true)
+        {
+            auto status = task.execute();
+            if (status != ExecTaskStatus::RUNNING || watch.elapsed() >= static_cast<UInt64>(std::chrono::nanoseconds(time_slice).count()))
+                return status;
+        }
+    }
+    catch (...)
+    {
+        tryLogCurrentException(log, "Task execution failed");
+        return ExecTaskStatus::ERROR;
+    }
+}
+
+void TaskScheduler::handleTaskStatus(size_t worker_index, TaskPtr && task, ExecTaskStatus status)
+{
+    switch (status)
+    {
+    case ExecTaskStatus::RUNNING:
+        /// The time slice is used up, give the other tasks in the queue a chance.
+        submitTo(worker_index, std::move(task));
+        break;
+    case ExecTaskStatus::WAITING:
+    {
+        {
+            std::lock_guard lock(wait_mu);
+            waiting_tasks.push_back(std::move(task));
+        }
+        wait_cv.notify_one();
+        break;
+    }
+    default:
+        finalizeTask(std::move(task), status);
+        break;
+    }
+}
+
+void TaskScheduler::reactorLoop()
+{
+    setThreadName("TaskReactor");
+    std::list<TaskPtr> local_waiting_tasks;
+    while (true)
+    {
+        {
+            std::unique_lock lock(wait_mu);
+            if (local_waiting_tasks.empty())
+                wait_cv.wait(lock, [&] { return is_shutdown || !waiting_tasks.empty(); });
+            else
+                wait_cv.wait_for(lock, wait_reactor_poll_interval, [&] { return is_shutdown.load() || !waiting_tasks.empty(); });
+            if (is_shutdown)
+            {
+                waiting_tasks.splice(waiting_tasks.end(), local_waiting_tasks);
+                return;
+            }
+            local_waiting_tasks.splice(local_waiting_tasks.end(), waiting_tasks);
+        }
+
+        for (auto it = local_waiting_tasks.begin(); it != local_waiting_tasks.end();)
+        {
+            ExecTaskStatus status;
+            try
+            {
+                status = (*it)->await();
+            }
+            catch (...)
+            {
+                tryLogCurrentException(log, "Task await failed");
+                status = ExecTaskStatus::ERROR;
+            }
+
+            if (status == ExecTaskStatus::WAITING)
+            {
+                ++it;
+                continue;
+            }
+            if (status == ExecTaskStatus::RUNNING)
+                submit(std::move(*it));
+            else
+                finalizeTask(std::move(*it), status);
+            it = local_waiting_tasks.erase(it);
+        }
+    }
+}
+
+void TaskScheduler::finalizeTask(TaskPtr && task, ExecTaskStatus status)
+{
+    TaskPtr finished_task = std::move(task);
+    try
+    {
+        finished_task->finalize(status);
+    }
+    catch (...)
+    {
+        tryLogCurrentException("TaskScheduler", "Task finalize failed");
+    }
+}
+
+} // namespace DB
@@ -0,0 +1,89 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/Logger.h>
+#include <Flash/Pipeline/Task.h>
+
+#include <atomic>
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DB
+{
+/// TaskScheduler runs the tasks on a fixed number of worker threads, one per core by default.
+/// - Each worker has its own queue. It runs the task at the front of its queue for a time slice, and steals
+///   from the back of the other queues when its own is empty.
+/// - A task returning WAITING is moved to the wait reactor thread, which polls `Task::await` of all the waiting
+///   tasks and submits them again once they are ready. So the workers are never blocked by I/O or exchange.
+/// The tasks left in the scheduler when it is destructed are finalized with CANCELLED.
+class TaskScheduler : private boost::noncopyable
+{
+public:
+    /// `worker_num` == 0 means the number of physical cores.
+    explicit TaskScheduler(size_t worker_num, std::chrono::milliseconds time_slice_ = std::chrono::milliseconds(100));
+
+    ~TaskScheduler();
+
+    void submit(TaskPtr && task);
+
+    size_t getWorkerNum() const { return worker_queues.size(); }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mu;
+        std::deque<TaskPtr> tasks;
+    };
+
+    void submitTo(size_t queue_index, TaskPtr && task);
+    bool popTask(size_t worker_index, TaskPtr & task);
+    void workerLoop(size_t worker_index);
+    void reactorLoop();
+
+    /// Run the task until it is not RUNNING or the time slice is used up.
+    ExecTaskStatus runTask(Task & task);
+    void handleTaskStatus(size_t worker_index, TaskPtr && task, ExecTaskStatus status);
+    static void finalizeTask(TaskPtr && task, ExecTaskStatus status);
+
+    const std::chrono::milliseconds time_slice;
+
+    std::vector<std::unique_ptr<WorkerQueue>> worker_queues;
+    std::atomic<size_t> next_queue{0};
+
+    /// The idle workers wait on `idle_cv` until there are queued tasks.
+    std::mutex idle_mu;
+    std::condition_variable idle_cv;
+    std::atomic<size_t> queued_tasks{0};
+    std::atomic<bool> is_shutdown{false};
+
+    std::mutex wait_mu;
+    std::condition_variable wait_cv;
+    std::list<TaskPtr> waiting_tasks;
+
+    std::vector<std::thread> workers;
+    std::thread reactor;
+
+    LoggerPtr log;
+};
+
+} // namespace DB
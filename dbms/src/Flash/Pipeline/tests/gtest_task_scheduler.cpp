@@ -0,0 +1,168 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <Flash/Pipeline/TaskScheduler.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <atomic>
+#include <future>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+/// Runs `total_slices` slices, then finishes.
+class SliceTask : public Task
+{
+public:
+    SliceTask(size_t total_slices_, std::atomic<size_t> & executed_slices_, std::promise<ExecTaskStatus> && promise_)
+        : total_slices(total_slices_)
+        , executed_slices(executed_slices_)
+        , promise(std::move(promise_))
+    {}
+
+    ExecTaskStatus execute() override
+    {
+        if (slices == total_slices)
+            return ExecTaskStatus::FINISHED;
+        ++slices;
+        ++executed_slices;
+        return ExecTaskStatus::RUNNING;
+    }
+
+    void finalize(ExecTaskStatus status) override { promise.set_value(status); }
+
+private:
+    const size_t total_slices;
+    size_t slices = 0;
+    std::atomic<size_t> & executed_slices;
+    std::promise<ExecTaskStatus> promise;
+};
+
+/// Waits until `ready` is set, then finishes.
+class WaitTask : public Task
+{
+public:
+    WaitTask(std::atomic<bool> & ready_, std::promise<ExecTaskStatus> && promise_)
+        : ready(ready_)
+        , promise(std::move(promise_))
+    {}
+
+    ExecTaskStatus execute() override { return ready ? ExecTaskStatus::FINISHED : ExecTaskStatus::WAITING; }
+
+    ExecTaskStatus await() override { return ready ? ExecTaskStatus::RUNNING : ExecTaskStatus::WAITING; }
+
+    void finalize(ExecTaskStatus status) override { promise.set_value(status); }
+
+private:
+    std::atomic<bool> & ready;
+    std::promise<ExecTaskStatus> promise;
+};
+
+class ThrowTask : public Task
+{
+public:
+    explicit ThrowTask(std::promise<ExecTaskStatus> && promise_)
+        : promise(std::move(promise_))
+    {}
+
+    ExecTaskStatus execute() override { throw Exception("mock task error"); }
+
+    void finalize(ExecTaskStatus status) override { promise.set_value(status); }
+
+private:
+    std::promise<ExecTaskStatus> promise;
+};
+} // namespace
+
+class TestTaskScheduler : public testing::Test
+{
+};
+
+TEST_F(TestTaskScheduler, RunCpuTasks)
+try
+{
+    constexpr size_t task_num = 100;
+    constexpr size_t slices_per_task = 50;
+    std::atomic<size_t> executed_slices{0};
+    std::vector<std::future<ExecTaskStatus>> futures;
+    {
+        TaskScheduler scheduler(4, std::chrono::milliseconds(1));
+        ASSERT_EQ(scheduler.getWorkerNum(), 4);
+        for (size_t i = 0; i < task_num; ++i)
+        {
+            std::promise<ExecTaskStatus> promise;
+            futures.push_back(promise.get_future());
+            scheduler.submit(std::make_unique<SliceTask>(slices_per_task, executed_slices, std::move(promise)));
+        }
+        for (auto & future : futures)
+            ASSERT_EQ(future.get(), ExecTaskStatus::FINISHED);
+    }
+    ASSERT_EQ(executed_slices, task_num * slices_per_task);
+}
+CATCH
+
+TEST_F(TestTaskScheduler, WaitingTask)
+try
+{
+    TaskScheduler scheduler(2);
+    std::atomic<bool> ready{false};
+    std::promise<ExecTaskStatus> wait_promise;
+    auto wait_future = wait_promise.get_future();
+    scheduler.submit(std::make_unique<WaitTask>(ready, std::move(wait_promise)));
+
+    /// The waiting task must not occupy the workers.
+    std::atomic<size_t> executed_slices{0};
+    std::promise<ExecTaskStatus> cpu_promise;
+    auto cpu_future = cpu_promise.get_future();
+    scheduler.submit(std::make_unique<SliceTask>(10, executed_slices, std::move(cpu_promise)));
+    ASSERT_EQ(cpu_future.get(), ExecTaskStatus::FINISHED);
+    ASSERT_EQ(wait_future.wait_for(std::chrono::milliseconds(10)), std::future_status::timeout);
+
+    ready = true;
+    ASSERT_EQ(wait_future.get(), ExecTaskStatus::FINISHED);
+}
+CATCH
+
+TEST_F(TestTaskScheduler, TaskThrows)
+try
+{
+    TaskScheduler scheduler(1);
+    std::promise<ExecTaskStatus> promise;
+    auto future = promise.get_future();
+    scheduler.submit(std::make_unique<ThrowTask>(std::move(promise)));
+    ASSERT_EQ(future.get(), ExecTaskStatus::ERROR);
+}
+CATCH
+
+TEST_F(TestTaskScheduler, CancelOnShutdown)
+try
+{
+    std::atomic<bool> ready{false};
+    std::promise<ExecTaskStatus> promise;
+    auto future = promise.get_future();
+    {
+        TaskScheduler scheduler(1);
+        scheduler.submit(std::make_unique<WaitTask>(ready, std::move(promise)));
+    }
+    ASSERT_EQ(future.get(), ExecTaskStatus::CANCELLED);
+}
+CATCH
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,53 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <DataStreams/AdaptiveAggregatingBlockInputStream.h>
+#include <Flash/Statistics/AggImpl.h>
+
+namespace DB
+{
+void AggStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
+{
+    fmt_buffer.fmtAppend(
+        R"("adaptive_streams":{},"pass_through_streams":{},"pass_through_rows":{})",
+        adaptive_streams,
+        pass_through_streams,
+        pass_through_rows);
+}
+
+void AggStatistics::collectExtraRuntimeDetail()
+{
+    const auto & profile_streams_map = dag_context.getProfileStreamsMap();
+    auto it = profile_streams_map.find(executor_id);
+    if (it != profile_streams_map.end())
+    {
+        for (const auto & stream : it->second)
+        {
+            if (const auto * adaptive_stream = dynamic_cast<const AdaptiveAggregatingBlockInputStream *>(stream.get()); adaptive_stream)
+            {
+                ++adaptive_streams;
+                if (adaptive_stream->isPassThrough())
+                {
+                    ++pass_through_streams;
+                    pass_through_rows += adaptive_stream->getPassThroughRows();
+                }
+            }
+        }
+    }
+}
+
+AggStatistics::AggStatistics(const tipb::Executor * executor, DAGContext & dag_context_)
+    : AggStatisticsBase(executor, dag_context_)
+{}
+} // namespace DB
@@ -22,5 +22,11 @@ struct ConnectionProfileInfo
 {
     Int64 packets = 0;
     Int64 bytes = 0;
+
+    /// Only count the compressed chunks: their sizes before and after compression,
+    /// and the time spent on compressing (sender) or decompressing (receiver) them.
+    Int64 uncompressed_bytes = 0;
+    Int64 compressed_bytes = 0;
+    UInt64 compression_time_ns = 0;
 };
 } // namespace DB
\ No newline at end of file
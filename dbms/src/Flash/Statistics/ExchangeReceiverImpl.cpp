@@ -20,10 +20,13 @@ namespace DB
 String ExchangeReceiveDetail::toJson() const
 {
     return fmt::format(
-        R"({{"receiver_source_task_id":{},"packets":{},"bytes":{}}})",
+        R"({{"receiver_source_task_id":{},"packets":{},"bytes":{},"uncompressed_bytes":{},"compressed_bytes":{},"decompression_time_ns":{}}})",
         receiver_source_task_id,
         packets,
-        bytes);
+        bytes,
+        uncompressed_bytes,
+        compressed_bytes,
+        compression_time_ns);
 }
 
 void ExchangeReceiverStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
@@ -57,6 +60,9 @@ void ExchangeReceiverStatistics::collectExtraRuntimeDetail()
             {
                 exchange_receive_details[i].packets += connection_profile_infos[i].packets;
                 exchange_receive_details[i].bytes += connection_profile_infos[i].bytes;
+                exchange_receive_details[i].uncompressed_bytes += connection_profile_infos[i].uncompressed_bytes;
+                exchange_receive_details[i].compressed_bytes += connection_profile_infos[i].compressed_bytes;
+                exchange_receive_details[i].compression_time_ns += connection_profile_infos[i].compression_time_ns;
             }
         }
     }
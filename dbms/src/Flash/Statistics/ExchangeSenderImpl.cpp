@@ -22,22 +22,26 @@ namespace DB
 String MPPTunnelDetail::toJson() const
 {
     return fmt::format(
-        R"({{"tunnel_id":"{}","sender_target_task_id":{},"sender_target_host":"{}","is_local":{},"packets":{},"bytes":{}}})",
+        R"({{"tunnel_id":"{}","sender_target_task_id":{},"sender_target_host":"{}","is_local":{},"packets":{},"bytes":{},"uncompressed_bytes":{},"compressed_bytes":{},"compression_time_ns":{}}})",
         tunnel_id,
         sender_target_task_id,
         sender_target_host,
         is_local,
         packets,
-        bytes);
+        bytes,
+        uncompressed_bytes,
+        compressed_bytes,
+        compression_time_ns);
 }
 
 void ExchangeSenderStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
 {
     fmt_buffer.fmtAppend(
-        R"("partition_num":{},"sender_target_task_ids":[{}],"exchange_type":"{}","connection_details":[)",
+        R"("partition_num":{},"sender_target_task_ids":[{}],"exchange_type":"{}","broadcast_compression_started":{},"connection_details":[)",
         partition_num,
         fmt::join(sender_target_task_ids, ","),
-        getExchangeTypeName(exchange_type));
+        getExchangeTypeName(exchange_type),
+        broadcast_compression_started);
     fmt_buffer.joinStr(
         mpp_tunnel_details.cbegin(),
         mpp_tunnel_details.cend(),
@@ -48,12 +52,16 @@ void ExchangeSenderStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
 
 void ExchangeSenderStatistics::collectExtraRuntimeDetail()
 {
+    broadcast_compression_started = dag_context.tunnel_set->isBroadcastCompressionStarted();
     const auto & mpp_tunnels = dag_context.tunnel_set->getTunnels();
     for (UInt16 i = 0; i < partition_num; ++i)
     {
         const auto & connection_profile_info = mpp_tunnels[i]->getConnectionProfileInfo();
         mpp_tunnel_details[i].packets = connection_profile_info.packets;
         mpp_tunnel_details[i].bytes = connection_profile_info.bytes;
+        mpp_tunnel_details[i].uncompressed_bytes = connection_profile_info.uncompressed_bytes;
+        mpp_tunnel_details[i].compressed_bytes = connection_profile_info.compressed_bytes;
+        mpp_tunnel_details[i].compression_time_ns = connection_profile_info.compression_time_ns;
     }
 }
 
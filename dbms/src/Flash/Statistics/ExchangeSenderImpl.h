@@ -62,6 +62,8 @@ private:
     std::vector<Int64> sender_target_task_ids;
 
     std::vector<MPPTunnelDetail> mpp_tunnel_details;
+    /// Whether the broadcast writing switched to compress the chunks at runtime, see `MPPTunnelSetBase::getBroadcastCompressionMethod`.
+    bool broadcast_compression_started = false;
 
 protected:
     void appendExtraJson(FmtBuffer &) const override;
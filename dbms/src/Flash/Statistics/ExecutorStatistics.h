@@ -62,11 +62,14 @@ public:
             [](const String & child, FmtBuffer & bf) { bf.fmtAppend(R"("{}")", child); },
             ",");
         fmt_buffer.fmtAppend(
-            R"(],"outbound_rows":{},"outbound_blocks":{},"outbound_bytes":{},"execution_time_ns":{})",
+            R"(],"outbound_rows":{},"outbound_blocks":{},"outbound_bytes":{},"execution_time_ns":{},"execution_cpu_time_ns":{},"wait_time_ns":{},"peak_memory_bytes":{})",
             base.rows,
             base.blocks,
             base.bytes,
-            base.execution_time_ns);
+            base.execution_time_ns,
+            base.execution_cpu_time_ns,
+            base.wait_time_ns,
+            base.peak_memory_bytes);
         if constexpr (ExecutorImpl::has_extra_info)
         {
             fmt_buffer.append(",");
@@ -23,5 +23,10 @@ void BaseRuntimeStatistics::append(const BlockStreamProfileInfo & profile_info)
     blocks += profile_info.blocks;
     bytes += profile_info.bytes;
     execution_time_ns = std::max(execution_time_ns, profile_info.execution_time);
+    execution_cpu_time_ns += profile_info.execution_cpu_time;
+    // the execution time is measured by a coarse clock, so it can be a little less than the cpu time
+    if (profile_info.execution_time > profile_info.execution_cpu_time)
+        wait_time_ns += profile_info.execution_time - profile_info.execution_cpu_time;
+    peak_memory_bytes += profile_info.peak_memory;
 }
 } // namespace DB
\ No newline at end of file
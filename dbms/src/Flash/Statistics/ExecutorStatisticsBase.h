@@ -28,6 +28,10 @@ struct BaseRuntimeStatistics
     size_t bytes = 0;
 
     UInt64 execution_time_ns = 0;
+    // sum of the concurrent streams
+    UInt64 execution_cpu_time_ns = 0;
+    UInt64 wait_time_ns = 0;
+    Int64 peak_memory_bytes = 0;
 
     void append(const BlockStreamProfileInfo &);
 };
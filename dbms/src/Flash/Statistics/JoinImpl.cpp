@@ -22,7 +22,9 @@ void JoinStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
     fmt_buffer.fmtAppend(
         R"("hash_table_bytes":{},"build_side_child":"{}",)"
         R"("non_joined_outbound_rows":{},"non_joined_outbound_blocks":{},"non_joined_outbound_bytes":{},"non_joined_execution_time_ns":{},)"
-        R"("join_build_inbound_rows":{},"join_build_inbound_blocks":{},"join_build_inbound_bytes":{},"join_build_execution_time_ns":{})",
+        R"("join_build_inbound_rows":{},"join_build_inbound_blocks":{},"join_build_inbound_bytes":{},"join_build_execution_time_ns":{},)"
+        R"("join_build_execution_cpu_time_ns":{},"join_build_wait_time_ns":{},)"
+        R"("join_build_rows_hint":{})",
         hash_table_bytes,
         build_side_child,
         non_joined_base.rows,
@@ -32,7 +34,10 @@ void JoinStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
         join_build_base.rows,
         join_build_base.blocks,
         join_build_base.bytes,
-        join_build_base.execution_time_ns);
+        join_build_base.execution_time_ns,
+        join_build_base.execution_cpu_time_ns,
+        join_build_base.wait_time_ns,
+        join_build_rows_hint);
 }
 
 void JoinStatistics::collectExtraRuntimeDetail()
@@ -43,6 +48,7 @@ void JoinStatistics::collectExtraRuntimeDetail()
     {
         const auto & join_execute_info = it->second;
         hash_table_bytes = join_execute_info.join_ptr->getTotalByteCount();
+        join_build_rows_hint = join_execute_info.join_ptr->getBuildRowsHint();
         build_side_child = join_execute_info.build_side_root_executor_id;
         for (const auto & non_joined_stream : join_execute_info.non_joined_streams)
         {
@@ -45,6 +45,8 @@ private:
     BaseRuntimeStatistics non_joined_base;
 
     BaseRuntimeStatistics join_build_base;
+    /// The rows the hash table is reserved for, compare it with `join_build_base.rows` for the misprediction.
+    size_t join_build_rows_hint = 0;
 
 protected:
     void appendExtraJson(FmtBuffer &) const override;
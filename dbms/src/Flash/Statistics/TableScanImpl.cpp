@@ -15,6 +15,10 @@
 #include <DataStreams/TiRemoteBlockInputStream.h>
 #include <Flash/Statistics/TableScanImpl.h>
 #include <Interpreters/Join.h>
+#include <Storages/DeltaMerge/DMSegmentThreadInputStream.h>
+#include <Storages/DeltaMerge/ReadThread/UnorderedInputStream.h>
+
+#include <unordered_set>
 
 namespace DB
 {
@@ -30,10 +34,57 @@ String TableScanDetail::toJson() const
 void TableScanStatistics::appendExtraJson(FmtBuffer & fmt_buffer) const
 {
     fmt_buffer.fmtAppend(
-        R"("connection_details":[{},{}])",
+        R"("connection_details":[{},{}],"local_block_rows":{},"read_stages_ns":{{)",
         local_table_scan_detail.toJson(),
-        cop_table_scan_detail.toJson());
+        cop_table_scan_detail.toJson(),
+        local_block_rows);
+    for (size_t i = 0; i < read_stages_ns.size(); ++i)
+    {
+        if (i > 0)
+            fmt_buffer.append(",");
+        fmt_buffer.fmtAppend(R"("{}":{})", DM::readStageToString(static_cast<DM::ReadStage>(i)), read_stages_ns[i]);
+    }
+    fmt_buffer.append("}");
+}
+
+namespace
+{
+/// Find the DeltaMerge streams under `stream`, e.g. the ones wrapped by `MultiplexInputStream` for partition tables.
+size_t getLocalBlockRows(IBlockInputStream & stream)
+{
+    if (auto * dm_stream = dynamic_cast<DM::DMSegmentThreadInputStream *>(&stream))
+        return dm_stream->getExpectedBlockSize();
+    if (auto * unordered_stream = dynamic_cast<DM::UnorderedInputStream *>(&stream))
+        return unordered_stream->getExpectedBlockSize();
+    size_t block_rows = 0;
+    stream.forEachChild([&](IBlockInputStream & child) {
+        block_rows = std::max(block_rows, getLocalBlockRows(child));
+        return false;
+    });
+    return block_rows;
+}
+
+/// The streams of a table scan share the profile of the read, collect the distinct ones.
+void collectReadStageProfiles(IBlockInputStream & stream, std::unordered_set<const DM::ReadStageProfile *> & profiles)
+{
+    if (auto * dm_stream = dynamic_cast<DM::DMSegmentThreadInputStream *>(&stream))
+    {
+        if (const auto & profile = dm_stream->getReadStageProfile(); profile)
+            profiles.insert(profile.get());
+        return;
+    }
+    if (auto * unordered_stream = dynamic_cast<DM::UnorderedInputStream *>(&stream))
+    {
+        if (const auto & profile = unordered_stream->getReadStageProfile(); profile)
+            profiles.insert(profile.get());
+        return;
+    }
+    stream.forEachChild([&](IBlockInputStream & child) {
+        collectReadStageProfiles(child, profiles);
+        return false;
+    });
 }
+} // namespace
 
 void TableScanStatistics::collectExtraRuntimeDetail()
 {
@@ -41,6 +92,7 @@ void TableScanStatistics::collectExtraRuntimeDetail()
     auto it = io_stream_map.find(executor_id);
     if (it != io_stream_map.end())
     {
+        std::unordered_set<const DM::ReadStageProfile *> read_stage_profiles;
         for (const auto & io_stream : it->second)
         {
             if (auto * cop_stream = dynamic_cast<CoprocessorBlockInputStream *>(io_stream.get()))
@@ -56,8 +108,12 @@ void TableScanStatistics::collectExtraRuntimeDetail()
                 auto * p_stream = dynamic_cast<IProfilingBlockInputStream *>(io_stream.get());
                 assert(p_stream);
                 local_table_scan_detail.bytes += p_stream->getProfileInfo().bytes;
+                local_block_rows = std::max(local_block_rows, getLocalBlockRows(*io_stream));
+                collectReadStageProfiles(*io_stream, read_stage_profiles);
             }
         }
+        for (const auto * profile : read_stage_profiles)
+            profile->mergeTo(read_stages_ns);
     }
 }
 
@@ -16,6 +16,7 @@
 
 #include <Flash/Statistics/ConnectionProfileInfo.h>
 #include <Flash/Statistics/ExecutorStatistics.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
 #include <tipb/executor.pb.h>
 
 namespace DB
@@ -52,6 +53,10 @@ public:
 private:
     TableScanDetail local_table_scan_detail{true};
     TableScanDetail cop_table_scan_detail{false};
+    // The rows of the blocks read from the local storage, may be adapted to the bytes per row, 0 if unknown.
+    size_t local_block_rows = 0;
+    // The time spent on the stages of reading the local storage, see `DM::ReadStageProfile`.
+    std::array<UInt64, static_cast<size_t>(DM::ReadStage::Count)> read_stages_ns{};
 
 protected:
     void appendExtraJson(FmtBuffer &) const override;
@@ -12,13 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
+#include <Common/MemoryTrackerSetter.h>
+#include <Common/Stopwatch.h>
 #include <Flash/tests/bench_exchange.h>
 #include <fmt/core.h>
 
-#include <Flash/Coprocessor/StreamingDAGResponseWriter.cpp> // to include the implementation of StreamingDAGResponseWriter
 #include <Flash/Mpp/ExchangeReceiver.cpp> // to include the implementation of ExchangeReceiver
-#include <Flash/Mpp/MPPTunnel.cpp> // to include the implementation of MPPTunnel
-#include <Flash/Mpp/MPPTunnelSet.cpp> // to include the implementation of MPPTunnelSet
 #include <atomic>
 #include <chrono>
 
@@ -27,17 +27,8 @@ namespace DB
 {
 namespace tests
 {
-
 std::random_device rd;
 
-MockBlockInputStream::MockBlockInputStream(const std::vector<Block> & blocks_, StopFlag & stop_flag_)
-    : blocks(blocks_)
-    , header(blocks[0].cloneEmpty())
-    , mt(rd())
-    , dist(0, blocks.size() - 1)
-    , stop_flag(stop_flag_)
-{}
-
 MockFixedRowsBlockInputStream::MockFixedRowsBlockInputStream(size_t total_rows_, const std::vector<Block> & blocks_)
     : header(blocks_[0].cloneEmpty())
     , mt(rd())
@@ -47,218 +38,107 @@ MockFixedRowsBlockInputStream::MockFixedRowsBlockInputStream(size_t total_rows_,
     , blocks(blocks_)
 {}
 
-Block makeBlock(int row_num, bool skew)
+Block makeBlock(int row_num, const BlockShape & shape, bool skew)
 {
-    InferredDataVector<Nullable<Int64>> int64_vec;
-    InferredDataVector<Nullable<Int64>> int64_vec2;
-    InferredDataVector<Nullable<String>> string_vec;
+    std::mt19937 mt(rd());
+    std::uniform_int_distribution<Int64> int64_dist;
+    std::uniform_int_distribution<int> len_dist(shape.string_length / 2, shape.string_length * 3 / 2);
+    std::uniform_int_distribution<char> char_dist;
 
-    if (skew)
+    ColumnsWithTypeAndName columns;
+    auto int64_data_type = makeDataType<Nullable<Int64>>();
+    for (int col = 0; col < shape.int64_columns; ++col)
     {
+        InferredDataVector<Nullable<Int64>> int64_vec;
         for (int i = 0; i < row_num; ++i)
-        {
-            int64_vec.emplace_back(100);
-            int64_vec2.emplace_back(100);
-        }
-
-        for (int i = 0; i < row_num; ++i)
-        {
-            string_vec.push_back("abcdefg");
-        }
+            int64_vec.emplace_back(skew ? 100 : int64_dist(mt));
+        columns.emplace_back(makeColumn<Nullable<Int64>>(int64_data_type, int64_vec), int64_data_type, fmt::format("int64_{}", col));
     }
-    else
-    {
-        std::mt19937 mt(rd());
-        std::uniform_int_distribution<Int64> int64_dist;
-        std::uniform_int_distribution<int> len_dist(10, 20);
-        std::uniform_int_distribution<char> char_dist;
-
-        for (int i = 0; i < row_num; ++i)
-        {
-            int64_vec.emplace_back(int64_dist(mt));
-            int64_vec2.emplace_back(int64_dist(mt));
-        }
 
+    auto string_data_type = makeDataType<Nullable<String>>();
+    for (int col = 0; col < shape.string_columns; ++col)
+    {
+        InferredDataVector<Nullable<String>> string_vec;
         for (int i = 0; i < row_num; ++i)
         {
+            if (skew)
+            {
+                string_vec.push_back(String(shape.string_length, 'a'));
+                continue;
+            }
             int len = len_dist(mt);
             String s;
             for (int j = 0; j < len; ++j)
                 s.push_back(char_dist(mt));
             string_vec.push_back(std::move(s));
         }
+        columns.emplace_back(makeColumn<Nullable<String>>(string_data_type, string_vec), string_data_type, fmt::format("string_{}", col));
     }
 
-    auto int64_data_type = makeDataType<Nullable<Int64>>();
-    ColumnWithTypeAndName int64_column(makeColumn<Nullable<Int64>>(int64_data_type, int64_vec), int64_data_type, "int64_1");
-    ColumnWithTypeAndName int64_column2(makeColumn<Nullable<Int64>>(int64_data_type, int64_vec2), int64_data_type, "int64_2");
-
-    auto string_data_type = makeDataType<Nullable<String>>();
-    ColumnWithTypeAndName string_column(makeColumn<Nullable<String>>(string_data_type, string_vec), string_data_type, "string");
-
-    return Block({int64_column, string_column, int64_column2});
+    return Block(columns);
 }
 
-std::vector<Block> makeBlocks(int block_num, int row_num, bool skew)
+std::vector<Block> makeBlocks(int block_num, int row_num, const BlockShape & shape, bool skew)
 {
     std::vector<Block> blocks;
     for (int i = 0; i < block_num; ++i)
-        blocks.push_back(makeBlock(row_num, skew));
+        blocks.push_back(makeBlock(row_num, shape, skew));
     return blocks;
 }
 
-mpp::MPPDataPacket makePacket(ChunkCodecStream & codec, int row_num)
-{
-    auto block = makeBlock(row_num);
-    codec.encode(block, 0, row_num);
-
-    mpp::MPPDataPacket packet;
-    packet.add_chunks(codec.getString());
-    codec.clear();
-
-    return packet;
-}
-
-std::vector<PacketPtr> makePackets(ChunkCodecStream & codec, int packet_num, int row_num)
-{
-    std::vector<PacketPtr> packets;
-    for (int i = 0; i < packet_num; ++i)
-        packets.push_back(std::make_shared<Packet>(makePacket(codec, row_num)));
-    return packets;
-}
-
-std::vector<PacketQueuePtr> makePacketQueues(int source_num, int queue_size)
+std::vector<tipb::FieldType> makeFields(const BlockShape & shape)
 {
-    std::vector<PacketQueuePtr> queues(source_num);
-    for (int i = 0; i < source_num; ++i)
-        queues[i] = std::make_shared<PacketQueue>(queue_size);
-    return queues;
-}
-
-std::vector<tipb::FieldType> makeFields()
-{
-    std::vector<tipb::FieldType> fields(3);
-    fields[0].set_tp(TiDB::TypeLongLong);
-    fields[1].set_tp(TiDB::TypeString);
-    fields[2].set_tp(TiDB::TypeLongLong);
+    std::vector<tipb::FieldType> fields(shape.int64_columns + shape.string_columns);
+    for (int i = 0; i < shape.int64_columns; ++i)
+        fields[i].set_tp(TiDB::TypeLongLong);
+    for (int i = 0; i < shape.string_columns; ++i)
+        fields[shape.int64_columns + i].set_tp(TiDB::TypeString);
     return fields;
 }
 
-void printException(const Exception & e)
-{
-    std::string text = e.displayText();
-
-    auto embedded_stack_trace_pos = text.find("Stack trace");
-    std::cerr << "Code: " << e.code() << ". " << text << std::endl
-              << std::endl;
-    if (std::string::npos == embedded_stack_trace_pos)
-        std::cerr << "Stack trace:" << std::endl
-                  << e.getStackTrace().toString() << std::endl;
-}
-
-ReceiverHelper::ReceiverHelper(int concurrency_, int source_num_, uint32_t fine_grained_shuffle_stream_count_)
-    : concurrency(concurrency_)
-    , source_num(source_num_)
-    , fine_grained_shuffle_stream_count(fine_grained_shuffle_stream_count_)
-{
-    pb_exchange_receiver.set_tp(tipb::Hash);
-    for (int i = 0; i < source_num; ++i)
-    {
-        mpp::TaskMeta task;
-        task.set_start_ts(0);
-        task.set_task_id(i);
-        task.set_partition_id(i);
-        task.set_address("");
-
-        String encoded_task;
-        task.SerializeToString(&encoded_task);
-
-        pb_exchange_receiver.add_encoded_task_meta(encoded_task);
-    }
-
-    fields = makeFields();
-    *pb_exchange_receiver.add_field_types() = fields[0];
-    *pb_exchange_receiver.add_field_types() = fields[1];
-    *pb_exchange_receiver.add_field_types() = fields[2];
-
-    task_meta.set_task_id(100);
-
-    queues = makePacketQueues(source_num, 10);
-}
-
-MockExchangeReceiverPtr ReceiverHelper::buildReceiver()
-{
-    return std::make_shared<MockExchangeReceiver>(
-        std::make_shared<MockReceiverContext>(queues, fields),
-        source_num,
-        concurrency,
-        "mock_req_id",
-        "mock_exchange_receiver_id",
-        fine_grained_shuffle_stream_count);
-}
-
-std::vector<BlockInputStreamPtr> ReceiverHelper::buildExchangeReceiverStream()
-{
-    auto receiver = buildReceiver();
-    std::vector<BlockInputStreamPtr> streams(concurrency);
-    // NOTE: check if need fine_grained_shuffle_stream_count
-    for (int i = 0; i < concurrency; ++i)
-    {
-        streams[i] = std::make_shared<MockExchangeReceiverInputStream>(receiver,
-                                                                       "mock_req_id",
-                                                                       "mock_executor_id" + std::to_string(i),
-                                                                       /*stream_id=*/enableFineGrainedShuffle(fine_grained_shuffle_stream_count) ? i : 0);
-    }
-    return streams;
-}
-
-BlockInputStreamPtr ReceiverHelper::buildUnionStream()
-{
-    auto streams = buildExchangeReceiverStream();
-    return std::make_shared<UnionBlockInputStream<>>(streams, BlockInputStreams{}, concurrency, /*req_id=*/"");
-}
-
-void ReceiverHelper::finish()
-{
-    if (join_ptr)
-    {
-        join_ptr->setBuildTableState(Join::BuildTableState::SUCCEED);
-        std::cout << fmt::format("Hash table size: {} bytes", join_ptr->getTotalByteCount()) << std::endl;
-    }
-}
-
 SenderHelper::SenderHelper(
-    int source_num_,
+    int tunnel_num_,
     int concurrency_,
-    uint32_t fine_grained_shuffle_stream_count_,
-    int64_t fine_grained_shuffle_batch_size_,
-    const std::vector<PacketQueuePtr> & queues_,
+    tipb::ExchangeType exchange_type_,
+    TunnelMode tunnel_mode,
+    CompressionMethod compression_method,
+    uint64_t fine_grained_shuffle_stream_count_,
+    uint64_t fine_grained_shuffle_batch_size_,
     const std::vector<tipb::FieldType> & fields)
-    : source_num(source_num_)
+    : tunnel_num(tunnel_num_)
     , concurrency(concurrency_)
+    , exchange_type(exchange_type_)
     , fine_grained_shuffle_stream_count(fine_grained_shuffle_stream_count_)
     , fine_grained_shuffle_batch_size(fine_grained_shuffle_batch_size_)
-    , queues(queues_)
 {
-    mpp::TaskMeta task_meta;
-    tunnel_set = std::make_shared<MockTunnelSet>("mock_req_id");
-    for (int i = 0; i < source_num; ++i)
+    const bool is_local = tunnel_mode != TunnelMode::Remote;
+    tunnel_set = std::make_shared<MPPTunnelSet>(
+        "mock_req_id",
+        /*enable_local_block_exchange=*/tunnel_mode == TunnelMode::LocalBlock,
+        compression_method);
+    for (int i = 0; i < tunnel_num; ++i)
     {
-        auto writer = std::make_shared<MockWriter>(queues[i]);
-        mock_writers.push_back(writer);
-
-        auto tunnel = std::make_shared<MockTunnel>(
-            task_meta,
-            task_meta,
+        auto tunnel = std::make_shared<MPPTunnel>(
+            fmt::format("tunnel{}", i),
             std::chrono::seconds(60),
             concurrency,
-            false,
-            false,
+            is_local,
+            /*is_async=*/false,
             "mock_req_id");
-        tunnel->connect(writer.get());
+        if (is_local)
+        {
+            tunnel->connect(nullptr);
+        }
+        else
+        {
+            auto queue = std::make_shared<WireQueue>(/*capacity=*/10);
+            auto writer = std::make_shared<MockWriter>(queue, wire_bytes);
+            tunnel->connect(writer.get());
+            queues.push_back(queue);
+            mock_writers.push_back(writer);
+        }
         tunnels.push_back(tunnel);
-        MPPTaskId id(0, i);
-        tunnel_set->registerTunnel(id, tunnel);
+        tunnel_set->registerTunnel(MPPTaskId(0, i), tunnel);
     }
 
     tipb::DAGRequest dag_request;
@@ -273,102 +153,77 @@ SenderHelper::SenderHelper(
     dag_context->result_field_types = fields;
 }
 
-BlockInputStreamPtr SenderHelper::buildUnionStream(
-    StopFlag & stop_flag,
-    const std::vector<Block> & blocks)
+BlockInputStreamPtr SenderHelper::buildUnionStream(size_t total_rows, const std::vector<Block> & blocks)
 {
     std::vector<BlockInputStreamPtr> send_streams;
     for (int i = 0; i < concurrency; ++i)
     {
-        BlockInputStreamPtr stream = std::make_shared<MockBlockInputStream>(blocks, stop_flag);
+        BlockInputStreamPtr stream = std::make_shared<MockFixedRowsBlockInputStream>(total_rows / concurrency, blocks);
+        std::unique_ptr<DAGResponseWriter> response_writer;
+        // Hash partition by the first column.
         if (enableFineGrainedShuffle(fine_grained_shuffle_stream_count))
-        {
-            std::unique_ptr<DAGResponseWriter> response_writer(
-                new StreamingDAGResponseWriter<MockTunnelSetPtr, true>(
-                    tunnel_set,
-                    {0, 1, 2},
-                    TiDB::TiDBCollators(3),
-                    tipb::Hash,
-                    -1,
-                    -1,
-                    true,
-                    *dag_context,
-                    fine_grained_shuffle_stream_count,
-                    fine_grained_shuffle_batch_size));
-            send_streams.push_back(std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), /*req_id=*/""));
-        }
+            response_writer = std::make_unique<StreamingDAGResponseWriter<MPPTunnelSetPtr, true>>(
+                tunnel_set,
+                std::vector<Int64>{0},
+                TiDB::TiDBCollators(1),
+                exchange_type,
+                -1,
+                -1,
+                true,
+                *dag_context,
+                fine_grained_shuffle_stream_count,
+                fine_grained_shuffle_batch_size);
         else
-        {
-            std::unique_ptr<DAGResponseWriter> response_writer(
-                new StreamingDAGResponseWriter<MockTunnelSetPtr, false>(
-                    tunnel_set,
-                    {0, 1, 2},
-                    TiDB::TiDBCollators(3),
-                    tipb::Hash,
-                    -1,
-                    -1,
-                    true,
-                    *dag_context,
-                    fine_grained_shuffle_stream_count,
-                    fine_grained_shuffle_batch_size));
-            send_streams.push_back(std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), /*req_id=*/""));
-        }
+            response_writer = std::make_unique<StreamingDAGResponseWriter<MPPTunnelSetPtr, false>>(
+                tunnel_set,
+                std::vector<Int64>{0},
+                TiDB::TiDBCollators(1),
+                exchange_type,
+                -1,
+                -1,
+                true,
+                *dag_context,
+                fine_grained_shuffle_stream_count,
+                fine_grained_shuffle_batch_size);
+        send_streams.push_back(std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), /*req_id=*/""));
     }
 
     return std::make_shared<UnionBlockInputStream<>>(send_streams, BlockInputStreams{}, concurrency, /*req_id=*/"");
 }
 
-BlockInputStreamPtr SenderHelper::buildUnionStream(size_t total_rows, const std::vector<Block> & blocks)
+void SenderHelper::finish()
 {
-    std::vector<BlockInputStreamPtr> send_streams;
-    for (int i = 0; i < concurrency; ++i)
-    {
-        BlockInputStreamPtr stream = std::make_shared<MockFixedRowsBlockInputStream>(total_rows / concurrency, blocks);
-        if (enableFineGrainedShuffle(fine_grained_shuffle_stream_count))
-        {
-            std::unique_ptr<DAGResponseWriter> response_writer(
-                new StreamingDAGResponseWriter<MockTunnelSetPtr, true>(
-                    tunnel_set,
-                    {0, 1, 2},
-                    TiDB::TiDBCollators(3),
-                    tipb::Hash,
-                    -1,
-                    -1,
-                    true,
-                    *dag_context,
-                    fine_grained_shuffle_stream_count,
-                    fine_grained_shuffle_batch_size));
-            send_streams.push_back(std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), /*req_id=*/""));
-        }
-        else
-        {
-            std::unique_ptr<DAGResponseWriter> response_writer(
-                new StreamingDAGResponseWriter<MockTunnelSetPtr, false>(
-                    tunnel_set,
-                    {0, 1, 2},
-                    TiDB::TiDBCollators(3),
-                    tipb::Hash,
-                    -1,
-                    -1,
-                    true,
-                    *dag_context,
-                    fine_grained_shuffle_stream_count,
-                    fine_grained_shuffle_batch_size));
-            send_streams.push_back(std::make_shared<ExchangeSenderBlockInputStream>(stream, std::move(response_writer), /*req_id=*/""));
-        }
-    }
+    // Wait for the tunnels to send all the packets, then tell the receiver no more packets.
+    tunnel_set->finishWrite();
+    for (auto & queue : queues)
+        queue->finish();
+}
 
-    return std::make_shared<UnionBlockInputStream<>>(send_streams, BlockInputStreams{}, concurrency, /*req_id=*/"");
+ReceiverHelper::ReceiverHelper(int concurrency_, uint64_t fine_grained_shuffle_stream_count_, SenderHelper & sender_helper, const std::vector<tipb::FieldType> & fields)
+    : concurrency(concurrency_)
+    , fine_grained_shuffle_stream_count(fine_grained_shuffle_stream_count_)
+{
+    receiver = std::make_shared<MockExchangeReceiver>(
+        std::make_shared<MockReceiverContext>(sender_helper.tunnels, sender_helper.queues, sender_helper.wire_bytes, fields),
+        sender_helper.tunnel_num,
+        concurrency,
+        "mock_req_id",
+        "mock_exchange_receiver_id",
+        fine_grained_shuffle_stream_count);
 }
 
-void SenderHelper::finish()
+BlockInputStreamPtr ReceiverHelper::buildUnionStream()
 {
-    for (size_t i = 0; i < tunnels.size(); ++i)
+    std::vector<BlockInputStreamPtr> streams(concurrency);
+    for (int i = 0; i < concurrency; ++i)
     {
-        tunnels[i]->writeDone();
-        tunnels[i]->waitForFinish();
-        mock_writers[i]->finish();
+        streams[i] = std::make_shared<MockExchangeReceiverInputStream>(
+            receiver,
+            "mock_req_id",
+            "mock_executor_id" + std::to_string(i),
+            /*stream_id=*/enableFineGrainedShuffle(fine_grained_shuffle_stream_count) ? i : 0);
     }
+    return std::make_shared<UnionBlockInputStream<>>(streams, BlockInputStreams{}, concurrency, /*req_id=*/"");
 }
 
 void ExchangeBench::SetUp(const benchmark::State &)
@@ -377,89 +232,217 @@ void ExchangeBench::SetUp(const benchmark::State &)
         /*fixed_thread_num=*/300,
         std::chrono::milliseconds(100000));
 
-    uniform_blocks = makeBlocks(/*block_num=*/100, /*row_num=*/1024);
-    skew_blocks = makeBlocks(/*block_num=*/100, /*row_num=*/1024, /*skew=*/true);
-
-    try
-    {
-        DB::registerWindowFunctions();
-        DB::registerFunctions();
-    }
-    catch (DB::Exception &)
-    {
-        // Maybe another test has already registered, ignore exception here.
-    }
+    uniform_blocks = makeBlocks(/*block_num=*/100, /*row_num=*/1024, BlockShape{});
 }
 
 void ExchangeBench::TearDown(const benchmark::State &)
 {
     uniform_blocks.clear();
-    skew_blocks.clear();
     // NOTE: Must reset here, otherwise DynamicThreadPool::fixedWork() may core because metrics already destroyed.
     DynamicThreadPool::global_instance.reset();
 }
 
-void ExchangeBench::runAndWait(std::shared_ptr<ReceiverHelper> receiver_helper,
-                               BlockInputStreamPtr receiver_stream,
-                               std::shared_ptr<SenderHelper> & sender_helper,
-                               BlockInputStreamPtr sender_stream)
+void ExchangeBench::runAndWait(
+    const std::shared_ptr<ReceiverHelper> & receiver_helper,
+    const BlockInputStreamPtr & receiver_stream,
+    const std::shared_ptr<SenderHelper> & sender_helper,
+    const BlockInputStreamPtr & sender_stream)
 {
-    std::future<void> sender_future = DynamicThreadPool::global_instance->schedule(/*memory_tracker=*/false,
-                                                                                   [sender_stream, sender_helper] {
-                                                                                       sender_stream->readPrefix();
-                                                                                       while (const auto & block = sender_stream->read()) {}
-                                                                                       sender_stream->readSuffix();
-                                                                                       sender_helper->finish();
-                                                                                   });
-    std::future<void> receiver_future = DynamicThreadPool::global_instance->schedule(/*memory_tracker=*/false,
-                                                                                     [receiver_stream, receiver_helper] {
-                                                                                         receiver_stream->readPrefix();
-                                                                                         while (const auto & block = receiver_stream->read()) {}
-                                                                                         receiver_stream->readSuffix();
-                                                                                         receiver_helper->finish();
-                                                                                     });
+    std::future<void> sender_future = DynamicThreadPool::global_instance->schedule(/*propagate_memory_tracker=*/true, [sender_stream, sender_helper] {
+        sender_stream->readPrefix();
+        while (const auto & block = sender_stream->read()) {}
+        sender_stream->readSuffix();
+        sender_helper->finish();
+    });
+    std::future<void> receiver_future = DynamicThreadPool::global_instance->schedule(/*propagate_memory_tracker=*/true, [receiver_stream, receiver_helper] {
+        receiver_stream->readPrefix();
+        while (const auto & block = receiver_stream->read()) {}
+        receiver_stream->readSuffix();
+    });
     sender_future.get();
     receiver_future.get();
 }
 
-BENCHMARK_DEFINE_F(ExchangeBench, basic_send_receive)
+/// Send `total_rows` rows from the sender to the receiver through `tunnel_num` tunnels in every iteration.
+/// Besides the time, it reports
+/// - items_per_second/bytes_per_second: the rows and the bytes of the blocks sent per second.
+/// - cpu_ns_per_byte: the cpu time of the process, including all the threads of the sender and receiver, per byte sent.
+/// - peak_memory_bytes: the peak memory of the sender and receiver, mostly the packets and blocks queued in the
+///   tunnels and the receiver.
+/// - peak_wire_bytes: the peak bytes of the serialized packets in flight between the remote tunnels and the receiver.
+BENCHMARK_DEFINE_F(ExchangeBench, exchange)
+(benchmark::State & state)
+try
+{
+    const auto exchange_type = static_cast<tipb::ExchangeType>(state.range(0));
+    const auto tunnel_mode = static_cast<TunnelMode>(state.range(1));
+    const int concurrency = state.range(2);
+    const int tunnel_num = state.range(3);
+    const int block_rows = state.range(4);
+    const BlockShape shape{static_cast<int>(state.range(5)), static_cast<int>(state.range(6)), static_cast<int>(state.range(7))};
+    const uint64_t fine_grained_shuffle_stream_count = state.range(8);
+    const auto compression_method = static_cast<CompressionMethod>(state.range(9));
+    constexpr size_t total_rows = 1024 * 1024;
+    constexpr uint64_t fine_grained_shuffle_batch_size = 4096;
+
+    const auto fields = makeFields(shape);
+    const auto blocks = makeBlocks(/*block_num=*/16, block_rows, shape);
+    size_t bytes_per_row = 0;
+    {
+        size_t bytes = 0, rows = 0;
+        for (const auto & block : blocks)
+        {
+            bytes += block.bytes();
+            rows += block.rows();
+        }
+        bytes_per_row = bytes / rows;
+    }
+
+    UInt64 cpu_ns = 0;
+    Int64 peak_memory_bytes = 0;
+    Int64 peak_wire_bytes = 0;
+    for (auto _ : state)
+    {
+        MemoryTracker memory_tracker;
+        MemoryTrackerSetter memory_tracker_setter(true, &memory_tracker);
+        Stopwatch cpu_watch(CLOCK_PROCESS_CPUTIME_ID);
+        {
+            auto sender_helper = std::make_shared<SenderHelper>(
+                tunnel_num,
+                concurrency,
+                exchange_type,
+                tunnel_mode,
+                compression_method,
+                fine_grained_shuffle_stream_count,
+                fine_grained_shuffle_batch_size,
+                fields);
+            auto receiver_helper = std::make_shared<ReceiverHelper>(concurrency, fine_grained_shuffle_stream_count, *sender_helper, fields);
+            auto sender_stream = sender_helper->buildUnionStream(total_rows, blocks);
+            auto receiver_stream = receiver_helper->buildUnionStream();
+
+            runAndWait(receiver_helper, receiver_stream, sender_helper, sender_stream);
+            peak_wire_bytes = std::max(peak_wire_bytes, sender_helper->wire_bytes.peak.load());
+        }
+        cpu_ns += cpu_watch.elapsed();
+        peak_memory_bytes = std::max(peak_memory_bytes, memory_tracker.getPeak());
+    }
+
+    const size_t total_bytes = total_rows * bytes_per_row * state.iterations();
+    state.SetItemsProcessed(total_rows * state.iterations());
+    state.SetBytesProcessed(total_bytes);
+    state.counters["cpu_ns_per_byte"] = total_bytes == 0 ? 0 : static_cast<double>(cpu_ns) / total_bytes;
+    state.counters["peak_memory_bytes"] = peak_memory_bytes;
+    state.counters["peak_wire_bytes"] = peak_wire_bytes;
+}
+CATCH
+
+namespace
+{
+void exchangeArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgNames({"exchange", "tunnel", "concurrency", "tunnels", "block_rows", "int64_cols", "string_cols", "string_len", "fgs", "codec"});
+    constexpr int64_t pass_through = tipb::ExchangeType::PassThrough;
+    constexpr int64_t broadcast = tipb::ExchangeType::Broadcast;
+    constexpr int64_t hash = tipb::ExchangeType::Hash;
+    constexpr auto local_block = static_cast<int64_t>(TunnelMode::LocalBlock);
+    constexpr auto local_packet = static_cast<int64_t>(TunnelMode::LocalPacket);
+    constexpr auto remote = static_cast<int64_t>(TunnelMode::Remote);
+    constexpr auto none = static_cast<int64_t>(CompressionMethod::NONE);
+    constexpr auto lz4 = static_cast<int64_t>(CompressionMethod::LZ4);
+    constexpr auto zstd = static_cast<int64_t>(CompressionMethod::ZSTD);
+
+    // exchange types and tunnels
+    for (auto tunnel : {local_block, local_packet, remote})
+    {
+        b->Args({pass_through, tunnel, 8, 1, 8192, 2, 1, 16, 0, none});
+        b->Args({broadcast, tunnel, 8, 4, 8192, 2, 1, 16, 0, none});
+        b->Args({hash, tunnel, 8, 4, 8192, 2, 1, 16, 0, none});
+        b->Args({hash, tunnel, 8, 4, 8192, 2, 1, 16, 8, none});
+    }
+    // fine grained shuffle
+    for (auto fgs : {4, 16, 32})
+        b->Args({hash, remote, 8, 4, 8192, 2, 1, 16, fgs, none});
+    // codecs
+    for (auto codec : {lz4, zstd})
+    {
+        b->Args({hash, remote, 8, 4, 8192, 2, 1, 16, 0, codec});
+        b->Args({broadcast, remote, 8, 4, 8192, 2, 1, 16, 0, codec});
+    }
+    // column types and widths
+    b->Args({hash, remote, 8, 4, 8192, 1, 0, 0, 0, none});
+    b->Args({hash, remote, 8, 4, 8192, 8, 0, 0, 0, none});
+    b->Args({hash, remote, 8, 4, 8192, 1, 4, 64, 0, none});
+    b->Args({hash, remote, 8, 4, 8192, 1, 1, 256, 0, none});
+    // block sizes
+    for (auto block_rows : {1024, 65536})
+        b->Args({hash, remote, 8, 4, block_rows, 2, 1, 16, 0, none});
+    // concurrency of the sender and receiver, and the number of tunnels
+    for (auto concurrency : {1, 4, 16})
+    {
+        b->Args({hash, remote, concurrency, 4, 8192, 2, 1, 16, 0, none});
+        b->Args({hash, remote, 8, concurrency, 8192, 2, 1, 16, 0, none});
+    }
+}
+} // namespace
+
+BENCHMARK_REGISTER_F(ExchangeBench, exchange)
+    ->Apply(exchangeArgs)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_DEFINE_F(ExchangeBench, hash_partition)
+(benchmark::State & state)
+try
+{
+    const uint32_t bucket_num = state.range(0);
+    HashPartitioner partitioner({0}, {nullptr}, bucket_num);
+    std::vector<MutableColumns> dest_columns(bucket_num);
+    for (auto & columns : dest_columns)
+        columns = uniform_blocks[0].cloneEmptyColumns();
+
+    for (auto _ : state)
+    {
+        for (const auto & block : uniform_blocks)
+        {
+            partitioner.partition(block, dest_columns);
+            for (auto & columns : dest_columns)
+            {
+                for (auto & column : columns)
+                    column->popBack(column->size());
+            }
+        }
+    }
+}
+CATCH
+BENCHMARK_REGISTER_F(ExchangeBench, hash_partition)
+    ->Arg(4)
+    ->Arg(32)
+    ->Arg(256);
+
+// The way before HashPartitioner, which scatters each block into new columns.
+BENCHMARK_DEFINE_F(ExchangeBench, hash_partition_by_scatter)
 (benchmark::State & state)
 try
 {
-    const int concurrency = state.range(0);
-    const int source_num = state.range(1);
-    const int total_rows = state.range(2);
-    const int fine_grained_shuffle_stream_count = state.range(3);
-    const int fine_grained_shuffle_batch_size = state.range(4);
-    Context context = TiFlashTestEnv::getContext();
+    const uint32_t bucket_num = state.range(0);
+    HashPartitioner partitioner({0}, {nullptr}, bucket_num);
 
     for (auto _ : state)
     {
-        std::shared_ptr<ReceiverHelper> receiver_helper = std::make_shared<ReceiverHelper>(concurrency, source_num, fine_grained_shuffle_stream_count);
-        BlockInputStreamPtr receiver_stream = receiver_helper->buildUnionStream();
-
-        std::shared_ptr<SenderHelper> sender_helper = std::make_shared<SenderHelper>(source_num,
-                                                                                     concurrency,
-                                                                                     fine_grained_shuffle_stream_count,
-                                                                                     fine_grained_shuffle_batch_size,
-                                                                                     receiver_helper->queues,
-                                                                                     receiver_helper->fields);
-        BlockInputStreamPtr sender_stream = sender_helper->buildUnionStream(total_rows, uniform_blocks);
-
-        runAndWait(receiver_helper, receiver_stream, sender_helper, sender_stream);
+        for (const auto & block : uniform_blocks)
+        {
+            const auto & selector = partitioner.computeSelector(block);
+            for (size_t col_id = 0; col_id < block.columns(); ++col_id)
+                benchmark::DoNotOptimize(block.getByPosition(col_id).column->scatter(bucket_num, selector));
+        }
     }
 }
 CATCH
-BENCHMARK_REGISTER_F(ExchangeBench, basic_send_receive)
-    ->Args({8, 1, 1024 * 1000, 0, 4096})
-    ->Args({8, 1, 1024 * 1000, 4, 4096})
-    ->Args({8, 1, 1024 * 1000, 8, 4096})
-    ->Args({8, 1, 1024 * 1000, 16, 4096})
-    ->Args({8, 1, 1024 * 1000, 32, 4096})
-    ->Args({8, 1, 1024 * 1000, 8, 1})
-    ->Args({8, 1, 1024 * 1000, 8, 1000})
-    ->Args({8, 1, 1024 * 1000, 8, 10000})
-    ->Args({8, 1, 1024 * 1000, 8, 100000});
+BENCHMARK_REGISTER_F(ExchangeBench, hash_partition_by_scatter)
+    ->Arg(4)
+    ->Arg(32)
+    ->Arg(256);
 
 
 } // namespace tests
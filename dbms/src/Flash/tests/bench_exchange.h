@@ -12,25 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
 #pragma once
 
 #include <Common/DynamicThreadPool.h>
 #include <Common/MPMCQueue.h>
-#include <Common/ThreadManager.h>
+#include <Common/MemoryTracker.h>
 #include <DataStreams/ExchangeSenderBlockInputStream.h>
-#include <DataStreams/HashJoinBuildBlockInputStream.h>
-#include <DataStreams/SquashingBlockInputStream.h>
-#include <DataStreams/SquashingBlockOutputStream.h>
 #include <DataStreams/TiRemoteBlockInputStream.h>
 #include <DataStreams/UnionBlockInputStream.h>
-#include <Flash/Coprocessor/DAGBlockOutputStream.h>
-#include <Flash/Coprocessor/DAGPipeline.h>
-#include <Flash/Coprocessor/DAGQueryBlockInterpreter.h>
-#include <Flash/tests/WindowTestUtil.h>
-#include <Interpreters/Join.h>
+#include <Flash/Coprocessor/StreamingDAGResponseWriter.h>
+#include <Flash/Mpp/ExchangeReceiver.h>
+#include <Flash/Mpp/GRPCReceiverContext.h>
+#include <Flash/Mpp/MPPTunnel.h>
+#include <Flash/Mpp/MPPTunnelSet.h>
+#include <IO/CompressedStream.h>
 #include <TestUtils/FunctionTestUtils.h>
 #include <TestUtils/TiFlashTestEnv.h>
-#include <WindowFunctions/registerWindowFunctions.h>
 #include <benchmark/benchmark.h>
 
 #include <random>
@@ -39,76 +37,149 @@ namespace DB
 {
 namespace tests
 {
+/// The serialized packets in flight between a remote tunnel and the receiver, which stands for the network.
+using WireQueue = MPMCQueue<std::shared_ptr<String>>;
+using WireQueuePtr = std::shared_ptr<WireQueue>;
 
-
-using Packet = mpp::MPPDataPacket;
-using PacketPtr = std::shared_ptr<Packet>;
-using PacketQueue = MPMCQueue<PacketPtr>;
-using PacketQueuePtr = std::shared_ptr<PacketQueue>;
-using StopFlag = std::atomic<bool>;
-
-// NOLINTBEGIN(readability-convert-member-functions-to-static)
-struct MockReceiverContext
+/// The bytes of the serialized packets in the wire queues and the peak of it.
+struct WireBytes
 {
-    using Status = ::grpc::Status;
-    struct Request
+    std::atomic<Int64> bytes{0};
+    std::atomic<Int64> peak{0};
+
+    void add(Int64 delta)
     {
-        String debugString() const
+        auto current = bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+        auto prev_peak = peak.load(std::memory_order_relaxed);
+        while (current > prev_peak && !peak.compare_exchange_weak(prev_peak, current, std::memory_order_relaxed))
         {
-            return "{Request}";
         }
+    }
 
-        int source_index = 0;
-        int send_task_id = 0;
-        int recv_task_id = -1;
-    };
+    void sub(Int64 delta) { bytes.fetch_sub(delta, std::memory_order_relaxed); }
+};
 
-    struct Reader
+enum class TunnelMode
+{
+    // Local tunnels passing the blocks to the receiver directly, see `MPPTunnelSetBase::canWriteBlocks`.
+    LocalBlock = 0,
+    // Local tunnels passing the encoded packets.
+    LocalPacket = 1,
+    // Sync tunnels writing the packets to `MockWriter`, which serializes the packets as the gRPC writer does
+    // but passes them to the receiver through a `WireQueue` instead of the network.
+    Remote = 2,
+};
+
+/// The columns of the blocks exchanged. All the columns are nullable as the ones from TiDB.
+struct BlockShape
+{
+    int int64_columns = 2;
+    int string_columns = 1;
+    // The strings are of random lengths in [string_length / 2, string_length * 3 / 2].
+    int string_length = 16;
+};
+
+struct MockWriter : public PacketWriter
+{
+    MockWriter(WireQueuePtr queue_, WireBytes & wire_bytes_)
+        : queue(std::move(queue_))
+        , wire_bytes(wire_bytes_)
+    {}
+
+    bool write(const mpp::MPPDataPacket & packet) override
     {
-        explicit Reader(const PacketQueuePtr & queue_)
-            : queue(queue_)
-        {}
+        auto wire = std::make_shared<String>();
+        packet.SerializeToString(wire.get());
+        wire_bytes.add(wire->size());
+        return queue->push(std::move(wire));
+    }
 
-        void initialize() const
-        {
-        }
+    WireQueuePtr queue;
+    WireBytes & wire_bytes;
+};
+using MockWriterPtr = std::shared_ptr<MockWriter>;
 
-        bool read(PacketPtr & packet [[maybe_unused]]) const
-        {
-            PacketPtr res;
-            if (queue->pop(res))
-            {
-                *packet = *res; // avoid change shared packets
-                return true;
-            }
+struct MockRemoteReader : public ExchangePacketReader
+{
+    MockRemoteReader(WireQueuePtr queue_, WireBytes & wire_bytes_)
+        : queue(std::move(queue_))
+        , wire_bytes(wire_bytes_)
+    {}
+
+    bool read(MPPDataPacketPtr & packet) override
+    {
+        std::shared_ptr<String> wire;
+        if (!queue->pop(wire))
             return false;
-        }
+        wire_bytes.sub(wire->size());
+        return packet->ParseFromString(*wire);
+    }
 
-        Status finish() const
-        {
-            return ::grpc::Status();
-        }
+    ::grpc::Status finish() override { return ::grpc::Status::OK; }
+
+    WireQueuePtr queue;
+    WireBytes & wire_bytes;
+};
+
+struct MockLocalReader : public ExchangePacketReader
+{
+    explicit MockLocalReader(LocalTunnelSenderPtr local_tunnel_sender_)
+        : local_tunnel_sender(std::move(local_tunnel_sender_))
+    {}
+
+    ~MockLocalReader() override
+    {
+        if (local_tunnel_sender)
+            local_tunnel_sender->consumerFinish("Receiver closed");
+    }
+
+    bool read(MPPDataPacketPtr & packet) override
+    {
+        auto tunnel_packet = local_tunnel_sender->readForLocal();
+        if (tunnel_packet == nullptr)
+            return false;
+        packet = tunnel_packet->packet;
+        return true;
+    }
 
-        PacketQueuePtr queue;
-    };
+    bool read(TunnelPacketPtr & tunnel_packet) override
+    {
+        auto tmp_packet = local_tunnel_sender->readForLocal();
+        if (tmp_packet == nullptr)
+            return false;
+        tunnel_packet = std::move(tmp_packet);
+        return true;
+    }
 
-    struct MockAsyncGrpcExchangePacketReader
+    ::grpc::Status finish() override
     {
-        // Not implement benchmark for Async GRPC for now.
-        void init(UnaryCallback<bool> *) { assert(0); }
-        void read(MPPDataPacketPtr &, UnaryCallback<bool> *) { assert(0); }
-        void finish(::grpc::Status &, UnaryCallback<bool> *) { assert(0); }
-    };
+        if (local_tunnel_sender)
+            local_tunnel_sender->consumerFinish("Receiver finished!");
+        local_tunnel_sender.reset();
+        return ::grpc::Status::OK;
+    }
+
+    LocalTunnelSenderPtr local_tunnel_sender;
+};
 
-    using AsyncReader = MockAsyncGrpcExchangePacketReader;
+/// Connects the ExchangeReceiver to the tunnels of `SenderHelper` in the same process.
+struct MockReceiverContext
+{
+    using Status = ::grpc::Status;
+    using Request = ExchangeRecvRequest;
+    using Reader = ExchangePacketReader;
+    using AsyncReader = AsyncExchangePacketReader;
 
     MockReceiverContext(
-        const std::vector<PacketQueuePtr> & queues_,
+        const std::vector<MPPTunnelPtr> & tunnels_,
+        const std::vector<WireQueuePtr> & queues_,
+        WireBytes & wire_bytes_,
         const std::vector<tipb::FieldType> & field_types_)
-        : queues(queues_)
+        : tunnels(tunnels_)
+        , queues(queues_)
+        , wire_bytes(wire_bytes_)
         , field_types(field_types_)
-    {
-    }
+    {}
 
     void fillSchema(DAGSchema & schema) const
     {
@@ -123,82 +194,38 @@ struct MockReceiverContext
 
     Request makeRequest(int index) const
     {
-        return {index, index, -1};
+        Request request;
+        request.source_index = index;
+        request.send_task_id = index;
+        request.recv_task_id = -1;
+        request.is_local = tunnels[index]->isLocal();
+        return request;
     }
 
-    std::shared_ptr<Reader> makeReader(const Request & request)
-    {
-        return std::make_shared<Reader>(queues[request.send_task_id]);
-    }
+    bool supportAsync(const Request &) const { return false; }
 
-    static Status getStatusOK()
+    ExchangePacketReaderPtr makeReader(const Request & request) const
     {
-        return ::grpc::Status();
+        if (request.is_local)
+            return std::make_shared<MockLocalReader>(tunnels[request.send_task_id]->getLocalTunnelSender());
+        return std::make_shared<MockRemoteReader>(queues[request.send_task_id], wire_bytes);
     }
 
-    bool supportAsync(const Request &) const { return false; }
-    void makeAsyncReader(
-        const Request &,
-        std::shared_ptr<AsyncReader> &,
-        UnaryCallback<bool> *) const {}
+    void makeAsyncReader(const Request &, AsyncExchangePacketReaderPtr &, UnaryCallback<bool> *) const {}
+
+    static Status getStatusOK() { return ::grpc::Status::OK; }
 
-    std::vector<PacketQueuePtr> queues;
+    std::vector<MPPTunnelPtr> tunnels;
+    std::vector<WireQueuePtr> queues;
+    WireBytes & wire_bytes;
     std::vector<tipb::FieldType> field_types;
 };
-// NOLINTEND(readability-convert-member-functions-to-static)
 
 using MockExchangeReceiver = ExchangeReceiverBase<MockReceiverContext>;
 using MockExchangeReceiverPtr = std::shared_ptr<MockExchangeReceiver>;
 using MockExchangeReceiverInputStream = TiRemoteBlockInputStream<MockExchangeReceiver>;
 
-struct MockWriter : public PacketWriter
-{
-    explicit MockWriter(PacketQueuePtr queue_)
-        : queue(std::move(queue_))
-    {}
-
-    bool write(const Packet & packet) override
-    {
-        queue->push(std::make_shared<Packet>(packet));
-        return true;
-    }
-
-    void finish()
-    {
-        queue->finish();
-    }
-
-    PacketQueuePtr queue;
-};
-
-using MockWriterPtr = std::shared_ptr<MockWriter>;
-using MockTunnel = MPPTunnelBase<MockWriter>;
-using MockTunnelPtr = std::shared_ptr<MockTunnel>;
-using MockTunnelSet = MPPTunnelSetBase<MockTunnel>;
-using MockTunnelSetPtr = std::shared_ptr<MockTunnelSet>;
-
-struct MockBlockInputStream : public IProfilingBlockInputStream
-{
-    const std::vector<Block> & blocks;
-    Block header;
-    std::mt19937 mt;
-    std::uniform_int_distribution<int> dist;
-    StopFlag & stop_flag;
-
-    MockBlockInputStream(const std::vector<Block> & blocks_, StopFlag & stop_flag_);
-
-    String getName() const override { return "MockBlockInputStream"; }
-    Block getHeader() const override { return header; }
-
-    Block readImpl() override
-    {
-        if (stop_flag.load(std::memory_order_relaxed))
-            return Block{};
-        return blocks[dist(mt)];
-    }
-};
-
-// Similar to MockBlockInputStream, but return fixed count of rows.
+// Return fixed count of rows picked from `blocks` randomly.
 struct MockFixedRowsBlockInputStream : public IProfilingBlockInputStream
 {
     Block header;
@@ -223,77 +250,67 @@ struct MockFixedRowsBlockInputStream : public IProfilingBlockInputStream
     }
 };
 
-Block makeBlock(int row_num, bool skew = false);
-std::vector<Block> makeBlocks(int block_num, int row_num, bool skew = false);
-mpp::MPPDataPacket makePacket(ChunkCodecStream & codec, int row_num);
-std::vector<PacketPtr> makePackets(ChunkCodecStream & codec, int packet_num, int row_num);
-std::vector<PacketQueuePtr> makePacketQueues(int source_num, int queue_size);
-std::vector<tipb::FieldType> makeFields();
-void printException(const Exception & e);
-void sendPacket(const std::vector<PacketPtr> & packets, const PacketQueuePtr & queue, StopFlag & stop_flag);
-void receivePacket(const PacketQueuePtr & queue);
-
-struct ReceiverHelper
-{
-    const int concurrency;
-    const int source_num;
-    const uint32_t fine_grained_shuffle_stream_count;
-    tipb::ExchangeReceiver pb_exchange_receiver;
-    std::vector<tipb::FieldType> fields;
-    mpp::TaskMeta task_meta;
-    std::vector<PacketQueuePtr> queues;
-    std::shared_ptr<Join> join_ptr;
-
-    explicit ReceiverHelper(int concurrency_, int source_num_, uint32_t fine_grained_shuffle_stream_count_);
-    MockExchangeReceiverPtr buildReceiver();
-    std::vector<BlockInputStreamPtr> buildExchangeReceiverStream();
-    BlockInputStreamPtr buildUnionStream();
-    void finish();
-};
+Block makeBlock(int row_num, const BlockShape & shape, bool skew = false);
+std::vector<Block> makeBlocks(int block_num, int row_num, const BlockShape & shape, bool skew = false);
+std::vector<tipb::FieldType> makeFields(const BlockShape & shape);
 
+/// The sender of an exchange with `tunnel_num` tunnels, which are all read by the receiver of `ReceiverHelper`
+/// as its sources, so that one pair of them covers all the tunnels of an exchange.
 struct SenderHelper
 {
-    const int source_num;
+    const int tunnel_num;
     const int concurrency;
-    const uint32_t fine_grained_shuffle_stream_count;
-    const int64_t fine_grained_shuffle_batch_size;
+    const tipb::ExchangeType exchange_type;
+    const uint64_t fine_grained_shuffle_stream_count;
+    const uint64_t fine_grained_shuffle_batch_size;
 
-    std::vector<PacketQueuePtr> queues;
+    std::vector<MPPTunnelPtr> tunnels;
+    std::vector<WireQueuePtr> queues;
     std::vector<MockWriterPtr> mock_writers;
-    std::vector<MockTunnelPtr> tunnels;
-    MockTunnelSetPtr tunnel_set;
+    WireBytes wire_bytes;
+    MPPTunnelSetPtr tunnel_set;
     std::unique_ptr<DAGContext> dag_context;
 
     SenderHelper(
-        int source_num_,
+        int tunnel_num_,
         int concurrency_,
-        uint32_t fine_grained_shuffle_stream_count_,
-        int64_t fine_grained_shuffle_batch_size_,
-        const std::vector<PacketQueuePtr> & queues_,
+        tipb::ExchangeType exchange_type_,
+        TunnelMode tunnel_mode,
+        CompressionMethod compression_method,
+        uint64_t fine_grained_shuffle_stream_count_,
+        uint64_t fine_grained_shuffle_batch_size_,
         const std::vector<tipb::FieldType> & fields);
 
-    // Using MockBlockInputStream to build streams.
-    BlockInputStreamPtr buildUnionStream(StopFlag & stop_flag, const std::vector<Block> & blocks);
-    // Using MockFixedRowsBlockInputStream to build streams.
     BlockInputStreamPtr buildUnionStream(size_t total_rows, const std::vector<Block> & blocks);
 
     void finish();
 };
 
+struct ReceiverHelper
+{
+    const int concurrency;
+    const uint64_t fine_grained_shuffle_stream_count;
+    MockExchangeReceiverPtr receiver;
+
+    ReceiverHelper(int concurrency_, uint64_t fine_grained_shuffle_stream_count_, SenderHelper & sender_helper, const std::vector<tipb::FieldType> & fields);
+
+    BlockInputStreamPtr buildUnionStream();
+};
+
 class ExchangeBench : public benchmark::Fixture
 {
 public:
     void SetUp(const benchmark::State &) override;
     void TearDown(const benchmark::State &) override;
-    void runAndWait(std::shared_ptr<ReceiverHelper> receiver_helper,
-                    BlockInputStreamPtr receiver_stream,
-                    std::shared_ptr<SenderHelper> & sender_helper,
-                    BlockInputStreamPtr sender_stream);
+
+    static void runAndWait(
+        const std::shared_ptr<ReceiverHelper> & receiver_helper,
+        const BlockInputStreamPtr & receiver_stream,
+        const std::shared_ptr<SenderHelper> & sender_helper,
+        const BlockInputStreamPtr & sender_stream);
 
     std::vector<Block> uniform_blocks;
-    std::vector<Block> skew_blocks;
 };
 
-
 } // namespace tests
 } // namespace DB
@@ -29,7 +29,7 @@ public:
         ExchangeBench::SetUp(state);
     }
 
-    static void setupPB(uint64_t fine_grained_shuffle_stream_count, tipb::Window & window, tipb::Sort & sort)
+    static void setupPB(uint64_t fine_grained_shuffle_stream_count, tipb::Window & window, tipb::Sort & sort, ASTPtr window_func, const MockWindowFrame & frame)
     {
         MockColumnInfoVec columns{
             {"c1", TiDB::TP::TypeLongLong},
@@ -41,10 +41,10 @@ public:
         builder
             .mockTable("test", "t1", columns)
             .sort({{"c1", false}, {"c2", false}, {"c3", false}}, true, fine_grained_shuffle_stream_count)
-            .window(RowNumber(),
+            .window(window_func,
                     {{"c1", false}, {"c2", false}, {"c3", false}},
                     {{"c1", false}, {"c2", false}, {"c3", false}},
-                    buildDefaultRowsFrame(),
+                    frame,
                     fine_grained_shuffle_stream_count);
         tipb::DAGRequest req;
         MPPInfo mpp_info(0, -1, -1, {}, std::unordered_map<String, std::vector<Int64>>{});
@@ -55,11 +55,11 @@ public:
         sort = window.child().sort();
     }
 
-    static void prepareWindowStream(Context & context, int concurrency, int source_num, int total_rows, uint32_t fine_grained_shuffle_stream_count, uint64_t fine_grained_shuffle_batch_size, const std::vector<Block> & blocks, BlockInputStreamPtr & sender_stream, BlockInputStreamPtr & receiver_stream, std::shared_ptr<SenderHelper> & sender_helper, std::shared_ptr<ReceiverHelper> & receiver_helper, bool build_window = true)
+    static void prepareWindowStream(Context & context, int concurrency, int source_num, int total_rows, uint32_t fine_grained_shuffle_stream_count, uint64_t fine_grained_shuffle_batch_size, const std::vector<Block> & blocks, BlockInputStreamPtr & sender_stream, BlockInputStreamPtr & receiver_stream, std::shared_ptr<SenderHelper> & sender_helper, std::shared_ptr<ReceiverHelper> & receiver_helper, bool build_window = true, ASTPtr window_func = RowNumber(), const MockWindowFrame & frame = buildDefaultRowsFrame())
     {
         tipb::Window window;
         tipb::Sort sort;
-        setupPB(fine_grained_shuffle_stream_count, window, sort);
+        setupPB(fine_grained_shuffle_stream_count, window, sort, window_func, frame);
 
         DAGPipeline pipeline;
         receiver_helper = std::make_shared<ReceiverHelper>(concurrency, source_num, fine_grained_shuffle_stream_count);
@@ -131,6 +131,44 @@ BENCHMARK_REGISTER_F(WindowFunctionBench, basic_row_number)
     ->Args({8, 1, 1024 * 1000, 8, 4096, true})
     ->Args({8, 1, 1024 * 1000, 16, 4096, true});
 
+BENCHMARK_DEFINE_F(WindowFunctionBench, sliding_frame_sum)
+(benchmark::State & state)
+try
+{
+    // select sum(c3) over (partition by c1, c2, c3 order by c1, c2, c3 rows between N preceding and current row) from t1;
+    // The sliding aggregation should take about the same time for any frame size.
+    const int concurrency = state.range(0);
+    const int source_num = state.range(1);
+    const int total_rows = state.range(2);
+    const int fine_grained_shuffle_stream_count = state.range(3);
+    const int fine_grained_shuffle_batch_size = state.range(4);
+    const UInt64 frame_rows = state.range(5);
+    Context context = TiFlashTestEnv::getContext();
+
+    MockWindowFrame frame;
+    frame.type = tipb::WindowFrameType::Rows;
+    frame.start = {tipb::WindowBoundType::Preceding, false, frame_rows};
+    frame.end = {tipb::WindowBoundType::CurrentRow, false, 0};
+
+    for (auto _ : state)
+    {
+        std::shared_ptr<SenderHelper> sender_helper;
+        std::shared_ptr<ReceiverHelper> receiver_helper;
+        BlockInputStreamPtr sender_stream;
+        BlockInputStreamPtr receiver_stream;
+
+        prepareWindowStream(context, concurrency, source_num, total_rows, fine_grained_shuffle_stream_count, fine_grained_shuffle_batch_size, skew_blocks, sender_stream, receiver_stream, sender_helper, receiver_helper, /*build_window=*/true, Sum(col("c3")), frame);
+
+        runAndWait(receiver_helper, receiver_stream, sender_helper, sender_stream);
+    }
+}
+CATCH
+BENCHMARK_REGISTER_F(WindowFunctionBench, sliding_frame_sum)
+    ->Args({8, 1, 1024 * 1000, 8, 4096, 1}) // Test the frame size.
+    ->Args({8, 1, 1024 * 1000, 8, 4096, 16})
+    ->Args({8, 1, 1024 * 1000, 8, 4096, 256})
+    ->Args({8, 1, 1024 * 1000, 8, 4096, 4096});
+
 BENCHMARK_DEFINE_F(WindowFunctionBench, partial_sort_skew_dataset)
 (benchmark::State & state)
 try
@@ -231,6 +231,21 @@ try
 }
 CATCH
 
+TEST_F(ExecutorAggTestRunner, GroupByMergeInTwoLevel)
+try
+{
+    /// Every stream aggregates less keys than the threshold, but the total is larger than that,
+    /// so the results of the streams are merged in two-level.
+    context.context.setSetting("group_by_two_level_threshold", Field(static_cast<UInt64>(4)));
+
+    auto request = buildDAGRequest(std::make_pair(db_name, table_types), {}, {col(types_col_name[2])}, {types_col_name[2]});
+    executeWithConcurrency(request, {toNullableVec<Int8>(types_col_name[2], ColumnWithNullableInt8{-1, 2, {}, 0, 1, 3, -2})});
+
+    request = buildDAGRequest(std::make_pair(db_name, table_types), {}, {col(types_col_name[10])}, {types_col_name[10]});
+    executeWithConcurrency(request, {toNullableVec<String>(types_col_name[10], ColumnWithNullableString{{}, "pingcap", "PingCAP", "PINGCAP", "Shanghai"})});
+}
+CATCH
+
 TEST_F(ExecutorAggTestRunner, AggregationMaxAndMin)
 try
 {
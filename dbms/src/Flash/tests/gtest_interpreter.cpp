@@ -389,6 +389,56 @@ Union: <for test>
 }
 CATCH
 
+TEST_F(InterpreterExecuteTest, WindowLocalShuffle)
+try
+{
+    context.context.setSetting("enable_window_local_shuffle", Field(static_cast<UInt64>(1)));
+    // The leading sort keys are the partition keys of the window.
+    auto request = context
+                       .scan("test_db", "test_table")
+                       .sort({{"s2", false}, {"s1", true}}, true)
+                       .window(RowNumber(), {"s1", true}, {"s2", false}, buildDefaultRowsFrame())
+                       .build(context);
+    {
+        String expected = R"(
+Union: <for test>
+ Expression x 10: <final projection>
+  Expression: <cast after window>
+   Window: <window local shuffle>, function: {row_number}, frame: {type: Rows, boundary_begin: Current, boundary_end: Current}
+    Expression: <final projection>
+     MergeSorting: <window local shuffle>, limit = 0
+      PartialSorting: <window local shuffle>: limit = 0
+       LocalShuffle
+        Expression: <final projection>
+         MockTableScan)";
+        ASSERT_BLOCKINPUTSTREAM_EQAUL(expected, request, 10);
+    }
+
+    // The partition keys are not the leading sort keys, the window runs in one stream.
+    request = context
+                  .scan("test_db", "test_table")
+                  .sort({{"s1", true}, {"s2", false}}, true)
+                  .window(RowNumber(), {"s1", true}, {"s2", false}, buildDefaultRowsFrame())
+                  .build(context);
+    {
+        String expected = R"(
+Union: <for test>
+ Expression x 10: <final projection>
+  SharedQuery: <restore concurrency>
+   Expression: <cast after window>
+    Window, function: {row_number}, frame: {type: Rows, boundary_begin: Current, boundary_end: Current}
+     Expression: <final projection>
+      MergeSorting, limit = 0
+       Union: <for partial order>
+        PartialSorting x 10: limit = 0
+         Expression: <final projection>
+          MockTableScan)";
+        ASSERT_BLOCKINPUTSTREAM_EQAUL(expected, request, 10);
+    }
+    context.context.setSetting("enable_window_local_shuffle", Field(static_cast<UInt64>(0)));
+}
+CATCH
+
 TEST_F(InterpreterExecuteTest, Join)
 try
 {
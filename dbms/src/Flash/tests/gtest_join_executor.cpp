@@ -192,6 +192,64 @@ try
 }
 CATCH
 
+TEST_F(JoinExecutorTestRunner, SpillJoin)
+try
+{
+    /// Spilling is triggered once the first build block is inserted.
+    context.context.setSetting("max_bytes_before_external_join", Field(static_cast<UInt64>(1)));
+
+    auto request = context.scan("simple_test", "t1")
+                       .join(context.scan("simple_test", "t2"), {col("a")}, ASTTableJoin::Kind::Inner)
+                       .build(context);
+    {
+        executeWithConcurrency(request, {toNullableVec<String>({"1", "1", "1", "1"}), toNullableVec<String>({{}, "3", {}, "3"}), toNullableVec<String>({"1", "1", "1", "1"}), toNullableVec<String>({"3", "3", {}, {}})});
+    }
+
+    request = context.scan("simple_test", "t1")
+                  .join(context.scan("simple_test", "t2"), {col("a")}, ASTTableJoin::Kind::Left)
+                  .build(context);
+    {
+        executeWithConcurrency(request, {toNullableVec<String>({"1", "1", "2", {}, "1", "1", {}}), toNullableVec<String>({"3", "3", "4", "3", {}, {}, {}}), toNullableVec<String>({"1", "1", {}, {}, "1", "1", {}}), toNullableVec<String>({{}, "3", {}, {}, {}, "3", {}})});
+    }
+
+    request = context.scan("simple_test", "t1")
+                  .join(context.scan("simple_test", "t2"), {col("a")}, ASTTableJoin::Kind::Right)
+                  .build(context);
+    {
+        executeWithConcurrency(request, {toNullableVec<String>({"1", "1", {}, {}, "1", "1", {}}), toNullableVec<String>({{}, "3", {}, {}, {}, "3", {}}), toNullableVec<String>({"1", "1", "3", {}, "1", "1", {}}), toNullableVec<String>({"3", "3", "4", "3", {}, {}, {}})});
+    }
+}
+CATCH
+
+TEST_F(JoinExecutorTestRunner, PartitionedBuildJoin)
+try
+{
+    context.context.setSetting("join_partitioned_build", Field(static_cast<UInt64>(1)));
+
+    auto request = context.scan("simple_test", "t1")
+                       .join(context.scan("simple_test", "t2"), {col("a")}, ASTTableJoin::Kind::Inner)
+                       .build(context);
+    {
+        executeWithConcurrency(request, {toNullableVec<String>({"1", "1", "1", "1"}), toNullableVec<String>({{}, "3", {}, "3"}), toNullableVec<String>({"1", "1", "1", "1"}), toNullableVec<String>({"3", "3", {}, {}})});
+    }
+
+    request = context.scan("simple_test", "t1")
+                  .join(context.scan("simple_test", "t2"), {col("a")}, ASTTableJoin::Kind::Left)
+                  .build(context);
+    {
+        executeWithConcurrency(request, {toNullableVec<String>({"1", "1", "2", {}, "1", "1", {}}), toNullableVec<String>({"3", "3", "4", "3", {}, {}, {}}), toNullableVec<String>({"1", "1", {}, {}, "1", "1", {}}), toNullableVec<String>({{}, "3", {}, {}, {}, "3", {}})});
+    }
+
+    /// The rows with NULL keys are kept for the non-joined streams.
+    request = context.scan("simple_test", "t1")
+                  .join(context.scan("simple_test", "t2"), {col("a")}, ASTTableJoin::Kind::Right)
+                  .build(context);
+    {
+        executeWithConcurrency(request, {toNullableVec<String>({"1", "1", {}, {}, "1", "1", {}}), toNullableVec<String>({{}, "3", {}, {}, {}, "3", {}}), toNullableVec<String>({"1", "1", "3", {}, "1", "1", {}}), toNullableVec<String>({"3", "3", "4", "3", {}, {}, {}})});
+    }
+}
+CATCH
+
 TEST_F(JoinExecutorTestRunner, MultiInnerLeftJoin)
 try
 {
@@ -15,6 +15,7 @@
 #include <Flash/LogSearch.h>
 #include <Poco/DeflatingStream.h>
 #include <common/types.h>
+#include <fmt/format.h>
 #include <gtest/gtest.h>
 
 #include <ext/scope_guard.h>
@@ -206,5 +207,60 @@ TEST_F(LogSearchTest, SearchDir)
     }
 }
 
+TEST_F(LogSearchTest, LiteralPattern)
+{
+    std::string s = "[2020/04/23 13:11:02.329 +08:00] [DEBUG] [\"Application : Load metadata done.\"]\n";
+    auto match = [&](const std::vector<std::string> & patterns) {
+        auto in = std::istringstream(s);
+        LogIterator itr(0l, 1587830400000l, {}, patterns, in);
+        return itr.next().has_value();
+    };
+    ASSERT_TRUE(match({"metadata"}));
+    ASSERT_TRUE(match({"metadata", "Load"}));
+    ASSERT_TRUE(match({"metadata", "Load.*done"}));
+    ASSERT_FALSE(match({"metadata", "nothing"}));
+    ASSERT_FALSE(match({"Metadata"}));
+    ASSERT_FALSE(match({"Load.*metadata", "nothing"}));
+}
+
+TEST_F(LogSearchTest, SeekByTime)
+{
+    // 10 logs per second, about 3MB in total
+    constexpr size_t num_logs = 50000;
+    std::string s;
+    std::vector<std::pair<size_t, Int64>> logs; // <offset, time>
+    for (size_t i = 0; i < num_logs; ++i)
+    {
+        size_t seconds = i / 10;
+        auto line = fmt::format(
+            "[2020/04/23 {:02}:{:02}:{:02}.{:03} +08:00] [INFO] [\"log {}\"]\n",
+            10 + seconds / 3600,
+            seconds / 60 % 60,
+            seconds % 60,
+            i % 10 * 100,
+            i);
+        Int64 time;
+        ASSERT_TRUE(ReadLogTime(line.data(), line.size(), time));
+        logs.emplace_back(s.size(), time);
+        s += line;
+    }
+
+    for (size_t target : {0, 1, 5000, 25003, 49999})
+    {
+        auto in = std::istringstream(s);
+        SeekLogByTime(in, logs[target].second);
+        size_t offset = in.tellg();
+        ASSERT_LE(offset, logs[target].first);
+        if (target > 10000)
+            ASSERT_GT(offset, 0); // skip some logs
+
+        LogIterator itr(logs[target].second, std::numeric_limits<Int64>::max(), {}, {}, in);
+        auto log = itr.next();
+        ASSERT_TRUE(log.has_value());
+        ASSERT_EQ(log->time(), logs[target].second);
+        ASSERT_EQ(log->message(), fmt::format("[\"log {}\"]", target));
+    }
+}
+
 } // namespace tests
 } // namespace DB
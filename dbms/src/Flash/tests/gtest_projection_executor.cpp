@@ -155,6 +155,14 @@ try
                             toNullableVec<Int32>(col_names[4], col4_sorted_asc)});
 
 
+    /// The same expression projected twice is only evaluated once
+    request = buildDAGRequest<MockAstVec>({eq(col(col_names[3]), col(col_names[4])), eq(col(col_names[3]), col(col_names[4])), col(col_names[4])});
+    executeWithConcurrency(request,
+                           {toNullableVec<UInt64>({{}, 0, 0, 0, {}, 1, 0}),
+                            toNullableVec<UInt64>({{}, 0, 0, 0, {}, 1, 0}),
+                            toNullableVec<Int32>(col_names[4], col4_sorted_asc)});
+
+
     /// Test "greater" function
 
     /// Data type: TypeString
@@ -218,6 +218,14 @@ struct DecimalBinaryOperation
     static constexpr bool need_promote_type = (std::is_same_v<OpResultType, A> || std::is_same_v<OpResultType, B>)&&(is_plus_minus_compare || is_division || is_multiply || is_modulo); // And is multiple / division / modulo
     static constexpr bool check_overflow = need_promote_type && std::is_same_v<OpResultType, Decimal256>; // Check if exceeds 10 * 66;
 
+    /// The result precision of +, -, least and greatest is inferred so that the scaled operands are below 10^(prec - 1),
+    /// so the results always fit in the native type of the result, even for Decimal256 whose precision is capped at 65.
+    /// The promotion is only needed by the overflow check of Decimal256, which is deferred to the end of the block.
+    static constexpr bool native_plus_minus_compare = need_promote_type && is_plus_minus_compare;
+    /// The same holds for * when the product is not rescaled, unless the precision of the result is capped.
+    static constexpr bool native_multiply = need_promote_type && is_multiply && !std::is_same_v<OpResultType, Decimal256>;
+    static constexpr bool deferred_overflow_check = check_overflow && native_plus_minus_compare;
+
     using ResultType = OpResultType;
     using NativeResultType = typename ResultType::NativeType;
     using ColVecA = std::conditional_t<IsDecimal<A>, ColumnDecimal<A>, ColumnVector<A>>;
@@ -226,8 +234,9 @@ struct DecimalBinaryOperation
     using ArrayB = typename ColVecB::Container;
     using ArrayC = typename ColumnDecimal<ResultType>::Container;
     using PromoteResultType = typename PromoteType<NativeResultType>::Type;
-    using InputType = std::conditional_t<need_promote_type, PromoteResultType, NativeResultType>;
+    using InputType = std::conditional_t<need_promote_type && !native_plus_minus_compare, PromoteResultType, NativeResultType>;
     using Op = Operation<InputType, InputType>;
+    using NativeOp = Operation<NativeResultType, NativeResultType>;
 
     static void inline evaluateNullmap(size_t size, const ColumnUInt8 * a_nullmap, const ColumnUInt8 * b_nullmap, typename ColumnUInt8::Container & res_null)
     {
@@ -246,7 +255,14 @@ struct DecimalBinaryOperation
         }
     }
 
-    static void NO_INLINE vectorVector(const ArrayA & a, const ArrayB & b, ArrayC & c, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
+    static void NO_INLINE vectorVector(const ArrayA & a, const ArrayB & b, ArrayC & c, NativeResultType scale_a, NativeResultType scale_b, NativeResultType scale_result)
+    {
+        vectorVectorImpl(a, b, c, scale_a, scale_b, scale_result);
+        if constexpr (deferred_overflow_check)
+            checkOverflow(c);
+    }
+
+    static void vectorVectorImpl(const ArrayA & a, const ArrayB & b, ArrayC & c, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
     {
         size_t size = a.size();
         if constexpr (is_plus_minus_compare)
@@ -266,6 +282,15 @@ struct DecimalBinaryOperation
         }
         else if constexpr (is_multiply)
         {
+            if constexpr (native_multiply)
+            {
+                if (scale_result == 1)
+                {
+                    for (size_t i = 0; i < size; ++i)
+                        c[i] = applyNativeMul(a[i], b[i]);
+                    return;
+                }
+            }
             for (size_t i = 0; i < size; ++i)
                 c[i] = applyScaledMul(a[i], b[i], scale_result);
             return;
@@ -313,7 +338,14 @@ struct DecimalBinaryOperation
         throw Exception("Should not reach here");
     }
 
-    static void NO_INLINE vectorConstant(const ArrayA & a, B b, ArrayC & c, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
+    static void NO_INLINE vectorConstant(const ArrayA & a, B b, ArrayC & c, NativeResultType scale_a, NativeResultType scale_b, NativeResultType scale_result)
+    {
+        vectorConstantImpl(a, b, c, scale_a, scale_b, scale_result);
+        if constexpr (deferred_overflow_check)
+            checkOverflow(c);
+    }
+
+    static void vectorConstantImpl(const ArrayA & a, B b, ArrayC & c, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
     {
         size_t size = a.size();
         if constexpr (is_plus_minus_compare)
@@ -333,6 +365,15 @@ struct DecimalBinaryOperation
         }
         else if constexpr (is_multiply)
         {
+            if constexpr (native_multiply)
+            {
+                if (scale_result == 1)
+                {
+                    for (size_t i = 0; i < size; ++i)
+                        c[i] = applyNativeMul(a[i], b);
+                    return;
+                }
+            }
             for (size_t i = 0; i < size; ++i)
                 c[i] = applyScaledMul(a[i], b, scale_result);
             return;
@@ -380,7 +421,14 @@ struct DecimalBinaryOperation
         throw Exception("Should not reach here");
     }
 
-    static void NO_INLINE constantVector(A a, const ArrayB & b, ArrayC & c, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
+    static void NO_INLINE constantVector(A a, const ArrayB & b, ArrayC & c, NativeResultType scale_a, NativeResultType scale_b, NativeResultType scale_result)
+    {
+        constantVectorImpl(a, b, c, scale_a, scale_b, scale_result);
+        if constexpr (deferred_overflow_check)
+            checkOverflow(c);
+    }
+
+    static void constantVectorImpl(A a, const ArrayB & b, ArrayC & c, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
     {
         size_t size = b.size();
         if constexpr (is_plus_minus_compare)
@@ -400,6 +448,15 @@ struct DecimalBinaryOperation
         }
         else if constexpr (is_multiply)
         {
+            if constexpr (native_multiply)
+            {
+                if (scale_result == 1)
+                {
+                    for (size_t i = 0; i < size; ++i)
+                        c[i] = applyNativeMul(a, b[i]);
+                    return;
+                }
+            }
             for (size_t i = 0; i < size; ++i)
                 c[i] = applyScaledMul(a, b[i], scale_result);
             return;
@@ -447,7 +504,18 @@ struct DecimalBinaryOperation
         throw Exception("Should not reach here");
     }
 
-    static ResultType constantConstant(A a, B b, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
+    static ResultType constantConstant(A a, B b, NativeResultType scale_a, NativeResultType scale_b, NativeResultType scale_result)
+    {
+        ResultType res = constantConstantImpl(a, b, scale_a, scale_b, scale_result);
+        if constexpr (deferred_overflow_check)
+        {
+            if (res.value > static_cast<NativeResultType>(DecimalMaxValue::maxValue()))
+                throw Exception("Decimal math overflow", ErrorCodes::DECIMAL_OVERFLOW);
+        }
+        return res;
+    }
+
+    static ResultType constantConstantImpl(A a, B b, NativeResultType scale_a [[maybe_unused]], NativeResultType scale_b [[maybe_unused]], NativeResultType scale_result [[maybe_unused]])
     {
         if constexpr (is_plus_minus_compare)
         {
@@ -484,6 +552,21 @@ struct DecimalBinaryOperation
     }
 
 private:
+    static void checkOverflow(const ArrayC & c)
+    {
+        const auto max_value = static_cast<NativeResultType>(DecimalMaxValue::maxValue());
+        bool overflow = false;
+        for (size_t i = 0; i < c.size(); ++i)
+            overflow |= c[i].value > max_value;
+        if (overflow)
+            throw Exception("Decimal math overflow", ErrorCodes::DECIMAL_OVERFLOW);
+    }
+
+    static NativeResultType applyNativeMul(NativeResultType a, NativeResultType b)
+    {
+        return NativeOp::template apply<NativeResultType>(a, b);
+    }
+
     static NativeResultType applyScaledMul(NativeResultType a, NativeResultType b, NativeResultType scale)
     {
         if constexpr (is_multiply)
@@ -513,7 +596,11 @@ private:
     /// there's implicit type convertion here
     static NativeResultType apply(NativeResultType a, NativeResultType b)
     {
-        if constexpr (need_promote_type)
+        if constexpr (native_plus_minus_compare)
+        {
+            return NativeOp::template apply<NativeResultType>(a, b);
+        }
+        else if constexpr (need_promote_type)
         {
             auto res = Op::template apply<PromoteResultType>(a, b);
             if constexpr (check_overflow)
@@ -545,7 +632,7 @@ private:
 
             res = Op::template apply<InputType>(a, b);
 
-            if constexpr (check_overflow)
+            if constexpr (check_overflow && !deferred_overflow_check)
             {
                 if (res > DecimalMaxValue::maxValue())
                 {
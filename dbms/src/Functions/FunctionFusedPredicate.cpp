@@ -0,0 +1,469 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnConst.h>
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsNumber.h>
+#include <Common/assert_cast.h>
+#include <Common/typeid_cast.h>
+#include <Core/AccurateComparison.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <Functions/FunctionFusedPredicate.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+} // namespace ErrorCodes
+
+namespace
+{
+using NodeType = FunctionFusedPredicate::NodeType;
+using ValueType = FunctionFusedPredicate::ValueType;
+
+bool isFusableNumber(const DataTypePtr & type)
+{
+    switch (removeNullable(type)->getTypeId())
+    {
+    case TypeIndex::UInt8:
+    case TypeIndex::UInt16:
+    case TypeIndex::UInt32:
+    case TypeIndex::UInt64:
+    case TypeIndex::Int8:
+    case TypeIndex::Int16:
+    case TypeIndex::Int32:
+    case TypeIndex::Int64:
+    case TypeIndex::Float32:
+    case TypeIndex::Float64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// The state of a node for the current chunk.
+struct NodeState
+{
+    /// For Input, the argument column without Nullable and Const.
+    const IColumn * column = nullptr;
+    TypeIndex type_id = TypeIndex::Nothing;
+    const UInt8 * null_map = nullptr;
+    bool is_const = false;
+
+    PaddedPODArray<Int64> ints;
+    PaddedPODArray<UInt64> uints;
+    PaddedPODArray<Float64> floats;
+    PaddedPODArray<UInt8> bools;
+    PaddedPODArray<UInt8> nulls;
+
+    /// The values of the current chunk, in the value type of the node.
+    const void * values = nullptr;
+    /// The values of the current chunk as booleans, only for the nodes which are not Input or used as boolean.
+    const UInt8 * bool_values = nullptr;
+    /// The nulls of the current chunk, nullptr if there is no NULL in it.
+    const UInt8 * chunk_nulls = nullptr;
+};
+
+template <typename T, typename V>
+const V * loadValuesImpl(const IColumn & column, size_t offset, size_t n, PaddedPODArray<V> & buf)
+{
+    const auto & data = assert_cast<const ColumnVector<T> &>(column).getData();
+    if constexpr (std::is_same_v<T, V>)
+    {
+        return data.data() + offset;
+    }
+    else
+    {
+        buf.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            buf[i] = static_cast<V>(data[offset + i]);
+        return buf.data();
+    }
+}
+
+template <typename V>
+const V * loadValues(const IColumn & column, TypeIndex type_id, size_t offset, size_t n, PaddedPODArray<V> & buf)
+{
+    switch (type_id)
+    {
+    case TypeIndex::UInt8:
+        return loadValuesImpl<UInt8>(column, offset, n, buf);
+    case TypeIndex::UInt16:
+        return loadValuesImpl<UInt16>(column, offset, n, buf);
+    case TypeIndex::UInt32:
+        return loadValuesImpl<UInt32>(column, offset, n, buf);
+    case TypeIndex::UInt64:
+        return loadValuesImpl<UInt64>(column, offset, n, buf);
+    case TypeIndex::Int8:
+        return loadValuesImpl<Int8>(column, offset, n, buf);
+    case TypeIndex::Int16:
+        return loadValuesImpl<Int16>(column, offset, n, buf);
+    case TypeIndex::Int32:
+        return loadValuesImpl<Int32>(column, offset, n, buf);
+    case TypeIndex::Int64:
+        return loadValuesImpl<Int64>(column, offset, n, buf);
+    case TypeIndex::Float32:
+        return loadValuesImpl<Float32>(column, offset, n, buf);
+    case TypeIndex::Float64:
+        return loadValuesImpl<Float64>(column, offset, n, buf);
+    default:
+        throw Exception("Unexpected type of column " + column.getName() + " in " + String(FunctionFusedPredicate::name), ErrorCodes::LOGICAL_ERROR);
+    }
+}
+
+/// Loads the values of the chunk, a constant is loaded only once and broadcasted to the whole chunk.
+template <typename V>
+const V * loadInput(NodeState & state, size_t offset, size_t n, PaddedPODArray<V> & buf)
+{
+    if (!state.is_const)
+        return loadValues(*state.column, state.type_id, offset, n, buf);
+
+    V value = loadValues(*state.column, state.type_id, 0, 1, buf)[0];
+    buf.assign(FunctionFusedPredicate::chunk_rows, value);
+    return buf.data();
+}
+
+template <typename A, typename B>
+void compareValues(NodeType type, const A * a, const B * b, size_t n, UInt8 * res)
+{
+    switch (type)
+    {
+    case NodeType::Less:
+        for (size_t i = 0; i < n; ++i)
+            res[i] = accurate::lessOp(a[i], b[i]);
+        break;
+    case NodeType::Greater:
+        for (size_t i = 0; i < n; ++i)
+            res[i] = accurate::greaterOp(a[i], b[i]);
+        break;
+    case NodeType::LessOrEquals:
+        for (size_t i = 0; i < n; ++i)
+            res[i] = accurate::lessOrEqualsOp(a[i], b[i]);
+        break;
+    case NodeType::GreaterOrEquals:
+        for (size_t i = 0; i < n; ++i)
+            res[i] = accurate::greaterOrEqualsOp(a[i], b[i]);
+        break;
+    case NodeType::Equals:
+        for (size_t i = 0; i < n; ++i)
+            res[i] = accurate::equalsOp(a[i], b[i]);
+        break;
+    case NodeType::NotEquals:
+        for (size_t i = 0; i < n; ++i)
+            res[i] = accurate::notEqualsOp(a[i], b[i]);
+        break;
+    default:
+        throw Exception("Unexpected comparison in " + String(FunctionFusedPredicate::name), ErrorCodes::LOGICAL_ERROR);
+    }
+}
+
+template <typename A>
+void compareWith(NodeType type, const A * a, ValueType b_type, const void * b, size_t n, UInt8 * res)
+{
+    switch (b_type)
+    {
+    case ValueType::Int64:
+        return compareValues(type, a, static_cast<const Int64 *>(b), n, res);
+    case ValueType::UInt64:
+        return compareValues(type, a, static_cast<const UInt64 *>(b), n, res);
+    case ValueType::Float64:
+        return compareValues(type, a, static_cast<const Float64 *>(b), n, res);
+    case ValueType::Bool:
+        return compareValues(type, a, static_cast<const UInt8 *>(b), n, res);
+    }
+}
+
+void compare(NodeType type, ValueType a_type, const void * a, ValueType b_type, const void * b, size_t n, UInt8 * res)
+{
+    switch (a_type)
+    {
+    case ValueType::Int64:
+        return compareWith(type, static_cast<const Int64 *>(a), b_type, b, n, res);
+    case ValueType::UInt64:
+        return compareWith(type, static_cast<const UInt64 *>(a), b_type, b, n, res);
+    case ValueType::Float64:
+        return compareWith(type, static_cast<const Float64 *>(a), b_type, b, n, res);
+    case ValueType::Bool:
+        return compareWith(type, static_cast<const UInt8 *>(a), b_type, b, n, res);
+    }
+}
+
+const UInt8 * mergeNulls(const UInt8 * a, const UInt8 * b, size_t n, PaddedPODArray<UInt8> & buf)
+{
+    if (!a)
+        return b;
+    if (!b)
+        return a;
+    for (size_t i = 0; i < n; ++i)
+        buf[i] = a[i] | b[i];
+    return buf.data();
+}
+} // namespace
+
+std::optional<FunctionFusedPredicate::NodeType> FunctionFusedPredicate::getNodeType(const String & function_name, const DataTypes & argument_types)
+{
+    for (const auto & type : argument_types)
+    {
+        if (!isFusableNumber(type))
+            return std::nullopt;
+    }
+
+    static const std::unordered_map<String, NodeType> comparisons = {
+        {"less", NodeType::Less},
+        {"greater", NodeType::Greater},
+        {"lessOrEquals", NodeType::LessOrEquals},
+        {"greaterOrEquals", NodeType::GreaterOrEquals},
+        {"equals", NodeType::Equals},
+        {"notEquals", NodeType::NotEquals},
+    };
+    if (auto it = comparisons.find(function_name); it != comparisons.end())
+        return argument_types.size() == 2 ? std::make_optional(it->second) : std::nullopt;
+
+    if (function_name == "and" && argument_types.size() >= 2)
+        return NodeType::And;
+    if (function_name == "or" && argument_types.size() >= 2)
+        return NodeType::Or;
+    if (function_name == "not" && argument_types.size() == 1)
+        return NodeType::Not;
+    return std::nullopt;
+}
+
+FunctionFusedPredicate::FunctionFusedPredicate(std::vector<Node> nodes_, DataTypes argument_types_, DataTypePtr return_type_)
+    : nodes(std::move(nodes_))
+    , value_types(nodes.size(), ValueType::Bool)
+    , used_as_bool(nodes.size(), false)
+    , argument_types(std::move(argument_types_))
+    , return_type(std::move(return_type_))
+{
+    if (nodes.empty() || nodes.back().type == NodeType::Input)
+        throw Exception("The root of " + getName() + " must be a function", ErrorCodes::LOGICAL_ERROR);
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const auto & node = nodes[i];
+        if (node.type == NodeType::Input)
+        {
+            if (node.argument >= argument_types.size() || !isFusableNumber(argument_types[node.argument]))
+                throw Exception("Illegal input of " + getName(), ErrorCodes::LOGICAL_ERROR);
+
+            auto type = removeNullable(argument_types[node.argument]);
+            if (type->isFloatingPoint())
+                value_types[i] = ValueType::Float64;
+            else if (type->isUnsignedInteger())
+                value_types[i] = ValueType::UInt64;
+            else
+                value_types[i] = ValueType::Int64;
+            continue;
+        }
+
+        for (auto child : node.children)
+        {
+            if (child >= i)
+                throw Exception("Children of " + getName() + " must come before their parent", ErrorCodes::LOGICAL_ERROR);
+            if (node.type == NodeType::And || node.type == NodeType::Or || node.type == NodeType::Not)
+                used_as_bool[child] = true;
+        }
+    }
+}
+
+void FunctionFusedPredicate::executeImpl(Block & block, const ColumnNumbers & arguments, size_t result) const
+{
+    const size_t rows = block.getByPosition(arguments[0]).column->size();
+
+    std::vector<NodeState> states(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto & state = states[i];
+        if (nodes[i].type != NodeType::Input)
+        {
+            state.bools.resize(chunk_rows);
+            state.nulls.resize(chunk_rows);
+            state.values = state.bools.data();
+            state.bool_values = state.bools.data();
+            continue;
+        }
+
+        state.column = block.getByPosition(arguments[nodes[i].argument]).column.get();
+        state.type_id = removeNullable(argument_types[nodes[i].argument])->getTypeId();
+        if (const auto * column_const = typeid_cast<const ColumnConst *>(state.column))
+        {
+            state.is_const = true;
+            state.column = &column_const->getDataColumn();
+        }
+        if (const auto * column_nullable = typeid_cast<const ColumnNullable *>(state.column))
+        {
+            state.null_map = column_nullable->getNullMapData().data();
+            state.column = &column_nullable->getNestedColumn();
+        }
+        if (state.is_const && state.null_map && state.null_map[0])
+        {
+            state.nulls.assign(chunk_rows, static_cast<UInt8>(1));
+            state.chunk_nulls = state.nulls.data();
+        }
+    }
+
+    auto col_res = ColumnUInt8::create(rows, 0);
+    auto & res = col_res->getData();
+    ColumnUInt8::MutablePtr col_null_map;
+    if (return_type->isNullable())
+        col_null_map = ColumnUInt8::create(rows, 0);
+
+    for (size_t offset = 0; offset < rows; offset += chunk_rows)
+    {
+        const size_t n = std::min(chunk_rows, rows - offset);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const auto & node = nodes[i];
+            auto & state = states[i];
+            switch (node.type)
+            {
+            case NodeType::Input:
+            {
+                /// A constant is the same for all the chunks.
+                if (state.is_const && offset > 0)
+                    break;
+
+                switch (value_types[i])
+                {
+                case ValueType::Int64:
+                    state.values = loadInput(state, offset, n, state.ints);
+                    break;
+                case ValueType::UInt64:
+                    state.values = loadInput(state, offset, n, state.uints);
+                    break;
+                case ValueType::Float64:
+                    state.values = loadInput(state, offset, n, state.floats);
+                    break;
+                case ValueType::Bool:
+                    throw Exception("Unexpected value type of input in " + getName(), ErrorCodes::LOGICAL_ERROR);
+                }
+                if (!state.is_const && state.null_map)
+                    state.chunk_nulls = state.null_map + offset;
+
+                if (used_as_bool[i])
+                {
+                    const size_t bool_rows = state.is_const ? chunk_rows : n;
+                    state.bools.resize(bool_rows);
+                    for (size_t j = 0; j < bool_rows; ++j)
+                    {
+                        switch (value_types[i])
+                        {
+                        case ValueType::Int64:
+                            state.bools[j] = static_cast<const Int64 *>(state.values)[j] != 0;
+                            break;
+                        case ValueType::UInt64:
+                            state.bools[j] = static_cast<const UInt64 *>(state.values)[j] != 0;
+                            break;
+                        default:
+                            state.bools[j] = static_cast<const Float64 *>(state.values)[j] != 0;
+                            break;
+                        }
+                    }
+                    state.bool_values = state.bools.data();
+                }
+                break;
+            }
+            case NodeType::Less:
+            case NodeType::Greater:
+            case NodeType::LessOrEquals:
+            case NodeType::GreaterOrEquals:
+            case NodeType::Equals:
+            case NodeType::NotEquals:
+            {
+                const auto & left = states[node.children[0]];
+                const auto & right = states[node.children[1]];
+                compare(node.type, value_types[node.children[0]], left.values, value_types[node.children[1]], right.values, n, state.bools.data());
+                state.chunk_nulls = mergeNulls(left.chunk_nulls, right.chunk_nulls, n, state.nulls);
+                break;
+            }
+            case NodeType::And:
+            case NodeType::Or:
+            {
+                /// Three-valued logic: for `and`, false wins over NULL, for `or`, true wins over NULL.
+                const bool is_and = node.type == NodeType::And;
+                UInt8 * values = state.bools.data();
+                UInt8 * nulls = state.nulls.data();
+                std::fill(values, values + n, static_cast<UInt8>(is_and));
+                bool has_null = false;
+                for (auto child : node.children)
+                {
+                    const UInt8 * child_values = states[child].bool_values;
+                    const UInt8 * child_nulls = states[child].chunk_nulls;
+                    if (child_nulls)
+                    {
+                        if (!has_null)
+                            std::fill(nulls, nulls + n, 0);
+                        has_null = true;
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            if (is_and)
+                                values[j] &= child_values[j] | child_nulls[j];
+                            else
+                                values[j] |= child_values[j] & !child_nulls[j];
+                            nulls[j] |= child_nulls[j];
+                        }
+                    }
+                    else if (is_and)
+                    {
+                        for (size_t j = 0; j < n; ++j)
+                            values[j] &= child_values[j];
+                    }
+                    else
+                    {
+                        for (size_t j = 0; j < n; ++j)
+                            values[j] |= child_values[j];
+                    }
+                }
+                if (has_null)
+                {
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        nulls[j] = is_and ? (values[j] & nulls[j]) : (!values[j] & nulls[j]);
+                        values[j] &= !nulls[j];
+                    }
+                }
+                state.chunk_nulls = has_null ? nulls : nullptr;
+                break;
+            }
+            case NodeType::Not:
+            {
+                const auto & child = states[node.children[0]];
+                for (size_t j = 0; j < n; ++j)
+                    state.bools[j] = !child.bool_values[j];
+                state.chunk_nulls = child.chunk_nulls;
+                break;
+            }
+            }
+        }
+
+        const auto & root = states.back();
+        memcpy(&res[offset], root.bool_values, n);
+        if (col_null_map && root.chunk_nulls)
+            memcpy(&col_null_map->getData()[offset], root.chunk_nulls, n);
+    }
+
+    if (col_null_map)
+        block.getByPosition(result).column = ColumnNullable::create(std::move(col_res), std::move(col_null_map));
+    else
+        block.getByPosition(result).column = std::move(col_res);
+}
+
+} // namespace DB
@@ -0,0 +1,102 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Functions/IFunction.h>
+
+#include <optional>
+
+namespace DB
+{
+/** Evaluates a tree of numeric comparisons combined by `and`, `or` and `not` in one pass over its arguments.
+  *
+  * ExpressionActions executes the functions of a predicate like `a > 1 and (b < c or not d)` one by one,
+  * and materializes a full column for every node of it. Here the rows are processed in chunks small enough
+  * to keep the intermediate values of all the nodes in cache, and only the final result is materialized.
+  * The result is the same as executing the functions one by one, including the three-valued logic of
+  * `and` and `or` in presence of NULLs.
+  *
+  * It is not registered in FunctionFactory, ExpressionActions builds it from the actions it replaces.
+  */
+class FunctionFusedPredicate : public IFunction
+{
+public:
+    static constexpr auto name = "fusedPredicate";
+    /// Rows processed by every node at a time.
+    static constexpr size_t chunk_rows = 1024;
+
+    enum class NodeType : UInt8
+    {
+        Input,
+        Less,
+        Greater,
+        LessOrEquals,
+        GreaterOrEquals,
+        Equals,
+        NotEquals,
+        And,
+        Or,
+        Not,
+    };
+
+    /// Inputs are compared as their widest type of the same kind, the other nodes are booleans.
+    enum class ValueType : UInt8
+    {
+        Int64,
+        UInt64,
+        Float64,
+        Bool,
+    };
+
+    struct Node
+    {
+        NodeType type;
+        /// For Input, the position of the column in the arguments.
+        size_t argument = 0;
+        /// Positions of the children in the nodes, they always come before their parent.
+        std::vector<size_t> children;
+    };
+
+    /// Returns the type of the node that can replace the function applied to the arguments,
+    /// or nullopt if it can not be fused.
+    static std::optional<NodeType> getNodeType(const String & function_name, const DataTypes & argument_types);
+
+    /// The last node is the root of the tree.
+    FunctionFusedPredicate(std::vector<Node> nodes_, DataTypes argument_types_, DataTypePtr return_type_);
+
+    String getName() const override { return name; }
+
+    bool isVariadic() const override { return true; }
+    size_t getNumberOfArguments() const override { return 0; }
+
+    bool useDefaultImplementationForNulls() const override { return false; }
+
+    DataTypePtr getReturnTypeImpl(const DataTypes &) const override { return return_type; }
+
+    void executeImpl(Block & block, const ColumnNumbers & arguments, size_t result) const override;
+
+    const std::vector<Node> & getNodes() const { return nodes; }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<ValueType> value_types;
+    /// Whether the input node is an argument of `and`, `or` or `not`.
+    std::vector<bool> used_as_bool;
+    DataTypes argument_types;
+    DataTypePtr return_type;
+};
+
+} // namespace DB
@@ -2691,42 +2691,38 @@ struct ExtractMyDateTimeImpl
         return datetime.week(0);
     }
 
-    static Int64 extractDay(UInt64 packed) { return (packed >> 41) & ((1 << 5) - 1); }
+    static Int64 extractDay(UInt64 packed) { return PackedMyTime::day(packed); }
 
     static Int64 extractDayMicrosecond(UInt64 packed)
     {
-        MyDateTime datetime(packed);
-        Int64 day = datetime.day;
-        Int64 h = datetime.hour;
-        Int64 m = datetime.minute;
-        Int64 s = datetime.second;
-        return (day * 1000000 + h * 10000 + m * 100 + s) * 1000000 + datetime.micro_second;
+        Int64 day = PackedMyTime::day(packed);
+        Int64 h = PackedMyTime::hour(packed);
+        Int64 m = PackedMyTime::minute(packed);
+        Int64 s = PackedMyTime::second(packed);
+        return (day * 1000000 + h * 10000 + m * 100 + s) * 1000000 + PackedMyTime::microSecond(packed);
     }
 
     static Int64 extractDaySecond(UInt64 packed)
     {
-        MyDateTime datetime(packed);
-        Int64 day = datetime.day;
-        Int64 h = datetime.hour;
-        Int64 m = datetime.minute;
-        Int64 s = datetime.second;
+        Int64 day = PackedMyTime::day(packed);
+        Int64 h = PackedMyTime::hour(packed);
+        Int64 m = PackedMyTime::minute(packed);
+        Int64 s = PackedMyTime::second(packed);
         return day * 1000000 + h * 10000 + m * 100 + s;
     }
 
     static Int64 extractDayMinute(UInt64 packed)
     {
-        MyDateTime datetime(packed);
-        Int64 day = datetime.day;
-        Int64 h = datetime.hour;
-        Int64 m = datetime.minute;
+        Int64 day = PackedMyTime::day(packed);
+        Int64 h = PackedMyTime::hour(packed);
+        Int64 m = PackedMyTime::minute(packed);
         return day * 10000 + h * 100 + m;
     }
 
     static Int64 extractDayHour(UInt64 packed)
     {
-        MyDateTime datetime(packed);
-        Int64 day = datetime.day;
-        Int64 h = datetime.hour;
+        Int64 day = PackedMyTime::day(packed);
+        Int64 h = PackedMyTime::hour(packed);
         return day * 100 + h;
     }
 
@@ -3132,6 +3128,36 @@ private:
     const Context & context;
 };
 
+/// Applies `Transformer::transform` to the packed values whose month and day are both non zero, and sets the
+/// others to null. The invalid rows are reported after the main loop, so that the loop only works on the bits
+/// of the packed values and is free of the error handling.
+template <typename Transformer, typename ToFieldType>
+void executeOnValidMyTime(const Context & context,
+                          const ColumnVector<DataTypeMyTimeBase::FieldType>::Container & vec_from,
+                          typename ColumnVector<ToFieldType>::Container & vec_to,
+                          typename ColumnVector<UInt8>::Container & vec_null_map)
+{
+    const size_t size = vec_from.size();
+    UInt8 has_invalid = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        UInt8 is_null = PackedMyTime::hasZeroMonthOrDay(vec_from[i]);
+        vec_to[i] = is_null ? 0 : Transformer::transform(vec_from[i]);
+        vec_null_map[i] = is_null;
+        has_invalid |= is_null;
+    }
+    if (likely(!has_invalid))
+        return;
+    for (size_t i = 0; i < size; ++i)
+    {
+        // TiDB also considers NO_ZERO_DATE sql_mode. But sql_mode is not handled by TiFlash for now.
+        if (vec_null_map[i])
+            context.getDAGContext()->handleInvalidTime(
+                fmt::format("Invalid time value: month({}) or day({}) is zero", PackedMyTime::month(vec_from[i]), PackedMyTime::day(vec_from[i])),
+                Errors::Types::WrongValue);
+    }
+}
+
 template <typename ToFieldType>
 struct TiDBLastDayTransformerImpl
 {
@@ -3143,28 +3169,14 @@ struct TiDBLastDayTransformerImpl
                         typename ColumnVector<ToFieldType>::Container & vec_to,
                         typename ColumnVector<UInt8>::Container & vec_null_map)
     {
-        for (size_t i = 0; i < vec_from.size(); ++i)
-        {
-            bool is_null = false;
-            MyTimeBase val(vec_from[i]);
-            vec_to[i] = execute(context, val, is_null);
-            vec_null_map[i] = is_null;
-        }
+        executeOnValidMyTime<TiDBLastDayTransformerImpl, ToFieldType>(context, vec_from, vec_to, vec_null_map);
     }
 
-    static ToFieldType execute(const Context & context, const MyTimeBase & val, bool & is_null)
+    static ToFieldType transform(UInt64 packed)
     {
-        // TiDB also considers NO_ZERO_DATE sql_mode. But sql_mode is not handled by TiFlash for now.
-        if (val.month == 0 || val.day == 0)
-        {
-            context.getDAGContext()->handleInvalidTime(
-                fmt::format("Invalid time value: month({}) or day({}) is zero", val.month, val.day),
-                Errors::Types::WrongValue);
-            is_null = true;
-            return 0;
-        }
-        UInt8 last_day = getLastDay(val.year, val.month);
-        return MyDate(val.year, val.month, last_day).toPackedUInt();
+        UInt16 year = PackedMyTime::year(packed);
+        UInt8 month = PackedMyTime::month(packed);
+        return MyDate(year, month, getLastDay(year, month)).toPackedUInt();
     }
 };
 
@@ -3178,30 +3190,20 @@ struct TiDBDayOfWeekTransformerImpl
                         typename ColumnVector<ToFieldType>::Container & vec_to,
                         typename ColumnVector<UInt8>::Container & vec_null_map)
     {
-        for (size_t i = 0; i < vec_from.size(); ++i)
-        {
-            bool is_null = false;
-            MyTimeBase val(vec_from[i]);
-            vec_to[i] = execute(context, val, is_null);
-            vec_null_map[i] = is_null;
-        }
+        executeOnValidMyTime<TiDBDayOfWeekTransformerImpl, ToFieldType>(context, vec_from, vec_to, vec_null_map);
     }
 
-    static ToFieldType execute(const Context & context, const MyTimeBase & val, bool & is_null)
+    static ToFieldType transform(UInt64 packed)
     {
-        // TiDB also considers NO_ZERO_DATE sql_mode. But sql_mode is not handled by TiFlash for now.
-        if (val.month == 0 || val.day == 0)
-        {
-            context.getDAGContext()->handleInvalidTime(
-                fmt::format("Invalid time value: month({}) or day({}) is zero", val.month, val.day),
-                Errors::Types::WrongValue);
-            is_null = true;
-            return 0;
-        }
         /// Behavior differences from TiDB:
         /// for date in ['0000-01-01', '0000-03-01'), dayOfWeek is the same with MySQL, while TiDB is offset by one day
         /// In TiDB dayOfWeek('0000-01-01') = 7, in MySQL/TiFlash dayOfWeek('0000-01-01') = 1
-        return static_cast<ToFieldType>(val.weekDay() + 1);
+        /// Same as `MyTimeBase::weekDay`, 1986-01-05 is sunday.
+        static const int reference_day_num = calcDayNum(1986, 1, 5);
+        int diff = PackedMyTime::dayNum(packed) - reference_day_num;
+        if (diff < 0)
+            diff += (-diff / 7 + 1) * 7;
+        return static_cast<ToFieldType>(diff % 7 + 1);
     }
 };
 
@@ -3215,27 +3217,13 @@ struct TiDBDayOfYearTransformerImpl
                         typename ColumnVector<ToFieldType>::Container & vec_to,
                         typename ColumnVector<UInt8>::Container & vec_null_map)
     {
-        for (size_t i = 0; i < vec_from.size(); ++i)
-        {
-            bool is_null = false;
-            MyTimeBase val(vec_from[i]);
-            vec_to[i] = execute(context, val, is_null);
-            vec_null_map[i] = is_null;
-        }
+        executeOnValidMyTime<TiDBDayOfYearTransformerImpl, ToFieldType>(context, vec_from, vec_to, vec_null_map);
     }
 
-    static ToFieldType execute(const Context & context, const MyTimeBase & val, bool & is_null)
+    static ToFieldType transform(UInt64 packed)
     {
-        // TiDB also considers NO_ZERO_DATE sql_mode. But sql_mode is not handled by TiFlash for now.
-        if (val.month == 0 || val.day == 0)
-        {
-            context.getDAGContext()->handleInvalidTime(
-                fmt::format("Invalid time value: month({}) or day({}) is zero", val.month, val.day),
-                Errors::Types::WrongValue);
-            is_null = true;
-            return 0;
-        }
-        return static_cast<ToFieldType>(val.yearDay());
+        UInt16 year = PackedMyTime::year(packed);
+        return static_cast<ToFieldType>(PackedMyTime::dayNum(packed) - calcDayNum(year, 1, 1) + 1);
     }
 };
 
@@ -3249,31 +3237,15 @@ struct TiDBWeekOfYearTransformerImpl
                         typename ColumnVector<ToFieldType>::Container & vec_to,
                         typename ColumnVector<UInt8>::Container & vec_null_map)
     {
-        bool is_null = false;
-        for (size_t i = 0; i < vec_from.size(); ++i)
-        {
-            MyTimeBase val(vec_from[i]);
-            vec_to[i] = execute(context, val, is_null);
-            vec_null_map[i] = is_null;
-            is_null = false;
-        }
+        executeOnValidMyTime<TiDBWeekOfYearTransformerImpl, ToFieldType>(context, vec_from, vec_to, vec_null_map);
     }
 
-    static ToFieldType execute(const Context & context, const MyTimeBase & val, bool & is_null)
+    static ToFieldType transform(UInt64 packed)
     {
-        // TiDB also considers NO_ZERO_DATE sql_mode. But sql_mode is not handled by TiFlash for now.
-        if (val.month == 0 || val.day == 0)
-        {
-            context.getDAGContext()->handleInvalidTime(
-                fmt::format("Invalid time value: month({}) or day({}) is zero", val.month, val.day),
-                Errors::Types::WrongValue);
-            is_null = true;
-            return 0;
-        }
         /// Behavior differences from TiDB:
         /// for '0000-01-02', weekofyear is the same with MySQL, while TiDB is offset by one day
         /// TiDB_weekofyear('0000-01-02') = 52, MySQL/TiFlash_weekofyear('0000-01-02') = 1
-        return static_cast<ToFieldType>(val.week(3));
+        return static_cast<ToFieldType>(MyTimeBase(packed).week(3));
     }
 };
 
@@ -3287,29 +3259,20 @@ struct TiDBToSecondsTransformerImpl
                         typename ColumnVector<ToFieldType>::Container & vec_to,
                         typename ColumnVector<UInt8>::Container & vec_null_map)
     {
-        bool is_null = false;
-        for (size_t i = 0; i < vec_from.size(); ++i)
-        {
-            MyTimeBase val(vec_from[i]);
-            vec_to[i] = execute(context, val, is_null);
-            vec_null_map[i] = is_null;
-            is_null = false;
-        }
+        // TiDB returns normal value if one of month/day is zero for to_seconds function, while MySQL return null if either of them is zero.
+        // TiFlash aligns with MySQL to align the behavior with other functions like last_day.
+        executeOnValidMyTime<TiDBToSecondsTransformerImpl, ToFieldType>(context, vec_from, vec_to, vec_null_map);
     }
 
-    static ToFieldType execute(const Context & context, const MyTimeBase & val, bool & is_null)
+    static ToFieldType transform(UInt64 packed)
     {
-        // TiDB returns normal value if one of month/day is zero for to_seconds function, while MySQL return null if either of them is zero.
-        // TiFlash aligns with MySQL to align the behavior with other functions like last_day.
-        if (val.month == 0 || val.day == 0)
-        {
-            context.getDAGContext()->handleInvalidTime(
-                fmt::format("Invalid time value: month({}) or day({}) is zero", val.month, val.day),
-                Errors::Types::WrongValue);
-            is_null = true;
-            return 0;
-        }
-        return static_cast<ToFieldType>(calcSeconds(val.year, val.month, val.day, val.hour, val.minute, val.second));
+        return static_cast<ToFieldType>(calcSeconds(
+            PackedMyTime::year(packed),
+            PackedMyTime::month(packed),
+            PackedMyTime::day(packed),
+            PackedMyTime::hour(packed),
+            PackedMyTime::minute(packed),
+            PackedMyTime::second(packed)));
     }
 };
 
@@ -3323,29 +3286,14 @@ struct TiDBToDaysTransformerImpl
                         typename ColumnVector<ToFieldType>::Container & vec_to,
                         typename ColumnVector<UInt8>::Container & vec_null_map)
     {
-        bool is_null = false;
-        for (size_t i = 0; i < vec_from.size(); ++i)
-        {
-            MyTimeBase val(vec_from[i]);
-            vec_to[i] = execute(context, val, is_null);
-            vec_null_map[i] = is_null;
-            is_null = false;
-        }
+        // TiDB returns normal value if one of month/day is zero for to_days function, while MySQL return null if either of them is zero.
+        // TiFlash aligns with MySQL to align the behavior with other functions like last_day.
+        executeOnValidMyTime<TiDBToDaysTransformerImpl, ToFieldType>(context, vec_from, vec_to, vec_null_map);
     }
 
-    static ToFieldType execute(const Context & context, const MyTimeBase & val, bool & is_null)
+    static ToFieldType transform(UInt64 packed)
     {
-        // TiDB returns normal value if one of month/day is zero for to_seconds function, while MySQL return null if either of them is zero.
-        // TiFlash aligns with MySQL to align the behavior with other functions like last_day.
-        if (val.month == 0 || val.day == 0)
-        {
-            context.getDAGContext()->handleInvalidTime(
-                fmt::format("Invalid time value: month({}) or day({}) is zero", val.month, val.day),
-                Errors::Types::WrongValue);
-            is_null = true;
-            return 0;
-        }
-        return static_cast<ToFieldType>(calcDayNum(val.year, val.month, val.day));
+        return static_cast<ToFieldType>(PackedMyTime::dayNum(packed));
     }
 };
 
@@ -685,6 +685,24 @@ void TiDBLowerUpperUTF8Impl<not_case_lower_bound, not_case_upper_bound, to_case>
         to_case>(src, src_end, dst);
 }
 
+/// Number of the code points in data[begin, end), stepping by `UTF8::seqLength` like the substring loops do.
+inline size_t countCodePoints(const ColumnString::Chars_t & data, ColumnString::Offset begin, ColumnString::Offset end)
+{
+    size_t count = 0;
+    for (ColumnString::Offset current = begin; current < end; current += UTF8::seqLength(data[current]))
+        ++count;
+    return count;
+}
+
+/// Offset of the code point that is `count` code points after `begin`.
+inline ColumnString::Offset skipCodePoints(const ColumnString::Chars_t & data, ColumnString::Offset begin, size_t count)
+{
+    ColumnString::Offset current = begin;
+    for (size_t i = 0; i < count; ++i)
+        current += UTF8::seqLength(data[current]);
+    return current;
+}
+
 /** If the string is encoded in UTF-8, then it selects a substring of code points in it.
   * Otherwise, the behavior is undefined.
   */
@@ -767,14 +785,8 @@ private:
         else
         {
             // set the start as string_length - abs(original_start) + 1
-            std::vector<ColumnString::Offset> start_offsets;
-            ColumnString::Offset current = prev_offset;
-            while (current < offsets[column_index] - 1)
-            {
-                start_offsets.push_back(current);
-                current += UTF8::seqLength(data[current]);
-            }
-            if (original_start_abs > start_offsets.size())
+            size_t string_length = countCodePoints(data, prev_offset, offsets[column_index] - 1);
+            if (original_start_abs > string_length)
             {
                 // return empty string
                 res_data.resize(res_data.size() + 1);
@@ -783,9 +795,9 @@ private:
                 res_offsets[column_index] = res_offset;
                 return;
             }
-            start = start_offsets.size() - original_start_abs + 1;
+            start = string_length - original_start_abs + 1;
             pos = start;
-            j = start_offsets[start - 1];
+            j = skipCodePoints(data, prev_offset, start - 1);
         }
         while (j < offsets[column_index] - 1)
         {
@@ -920,17 +932,9 @@ private:
         ColumnString::Chars_t & res_data,
         const ColumnString::Offset & res_offset)
     {
-        std::vector<ColumnString::Offset> start_offsets;
-        ColumnString::Offset current = start_offset;
-        // TODO: break this loop in advance
         // NOTE: data[end_offset -1] = 0, so ignore it
-        auto end_flag = end_offset - 1;
-        while (current < end_flag)
-        {
-            start_offsets.push_back(current);
-            current += UTF8::seqLength(data[current]);
-        }
-        if (start_offsets.empty())
+        size_t string_length = countCodePoints(data, start_offset, end_offset - 1);
+        if (string_length == 0)
         {
             // null
             return appendEmptyString(res_data, res_offset);
@@ -939,11 +943,12 @@ private:
         {
             // not null
             // if(string_length > length, string_length - length, 0)
-            auto start_index = start_offsets.size() > length ? start_offsets.size() - length : 0;
+            auto start_index = string_length > length ? string_length - length : 0;
+            ColumnString::Offset start = skipCodePoints(data, start_offset, start_index);
             // copy data from start to end of this string
-            size_t bytes_to_copy = end_offset - start_offsets[start_index];
+            size_t bytes_to_copy = end_offset - start;
             res_data.resize(res_data.size() + bytes_to_copy);
-            memcpySmallAllowReadWriteOverflow15(&res_data[res_offset], &data[start_offsets[start_index]], bytes_to_copy);
+            memcpySmallAllowReadWriteOverflow15(&res_data[res_offset], &data[start], bytes_to_copy);
             return bytes_to_copy;
         }
     }
@@ -1419,6 +1424,11 @@ public:
         auto result_null_map = ColumnUInt8::create(rows);
         auto res = ColumnString::create();
         StringSink sink(*res, rows);
+        // The separator is written at most once between every two of the other arguments.
+        size_t size_to_reserve = sources.size() > 2 ? (sources.size() - 2) * sources[0]->getSizeForReserve() : 0;
+        for (size_t col = 1; col < sources.size(); ++col)
+            size_to_reserve += sources[col]->getSizeForReserve();
+        sink.reserve(size_to_reserve);
 
         for (size_t row = 0; row < rows; ++row)
         {
@@ -19,8 +19,10 @@
 #include <DataTypes/DataTypeFixedString.h>
 #include <Functions/FunctionFactory.h>
 #include <Functions/FunctionsStringSearch.h>
+#include <Functions/LikeMatcherCache.h>
 #include <Functions/Regexps.h>
 #include <Functions/StringUtil.h>
+#include <Functions/likePatternToRegexp.h>
 #include <IO/WriteHelpers.h>
 #include <Poco/UTF8String.h>
 #include <re2/re2.h>
@@ -41,6 +43,7 @@ namespace DB
 namespace ErrorCodes
 {
 extern const int BAD_ARGUMENTS;
+extern const int NUMBER_OF_ARGUMENTS_DOESNT_MATCH;
 }
 
 /** Implementation details for functions of 'position' family depending on ASCII/UTF8 and case sensitiveness.
@@ -391,46 +394,6 @@ static String getRE2ModeModifiers(const std::string & match_type, const TiDB::Ti
         return "";
 }
 
-/// Is the LIKE expression reduced to finding a substring in a string?
-inline bool likePatternIsStrstr(const String & pattern, String & res)
-{
-    res = "";
-
-    if (pattern.size() < 2 || pattern.front() != '%' || pattern.back() != '%')
-        return false;
-
-    res.reserve(pattern.size() * 2);
-
-    const char * pos = pattern.data();
-    const char * end = pos + pattern.size();
-
-    ++pos;
-    --end;
-
-    while (pos < end)
-    {
-        switch (*pos)
-        {
-        case '%':
-        case '_':
-            return false;
-        case '\\':
-            ++pos;
-            if (pos == end)
-                return false;
-            else
-                res += *pos;
-            break;
-        default:
-            res += *pos;
-            break;
-        }
-        ++pos;
-    }
-
-    return true;
-}
-
 // replace the escape_char in orig_string with '\'
 // this function does not check the validation of the orig_string
 // for example, for string "abcd" and escape char 'd', it will
@@ -504,8 +467,7 @@ struct MatchImpl
         /// fully supported.(Only case sensitive/insensitive is supported)
         if (like && collator != nullptr)
         {
-            auto matcher = collator->pattern();
-            matcher->compile(orig_pattern, escape_char);
+            auto matcher = LikeMatcherCache::instance().getPattern(orig_pattern, collator, escape_char);
             size_t size = offsets.size();
             size_t prev_offset = 0;
             for (size_t i = 0; i < size; ++i)
@@ -529,11 +491,11 @@ struct MatchImpl
             /// The current index in the array of strings.
             size_t i = 0;
 
-            /// TODO You need to make that `searcher` is common to all the calls of the function.
-            Volnitsky searcher(strstr_pattern.data(), strstr_pattern.size(), end - pos);
+            /// The searcher is shared by all the calls with the same pattern.
+            auto searcher = LikeMatcherCache::instance().getSearcher(strstr_pattern);
 
             /// We will search for the next occurrence in all rows at once.
-            while (pos < end && end != (pos = searcher.search(pos, end - pos)))
+            while (pos < end && end != (pos = searcher->search(pos, end - pos)))
             {
                 /// Let's determine which index it refers to.
                 while (begin + offsets[i] <= pos)
@@ -615,10 +577,10 @@ struct MatchImpl
                 /// The current index in the array of strings.
                 size_t i = 0;
 
-                Volnitsky searcher(required_substring.data(), required_substring.size(), end - pos);
+                auto searcher = LikeMatcherCache::instance().getSearcher(required_substring);
 
                 /// We will search for the next occurrence in all rows at once.
-                while (pos < end && end != (pos = searcher.search(pos, end - pos)))
+                while (pos < end && end != (pos = searcher->search(pos, end - pos)))
                 {
                     /// Determine which index it refers to.
                     while (begin + offsets[i] <= pos)
@@ -2068,6 +2030,109 @@ private:
     TiDB::TiDBCollatorPtr collator;
 };
 
+/** multiSearchAny(haystack, needle1, needle2, ...) - whether any of the constant needles is a substring of haystack.
+  * The whole column is scanned once per needle by the shared Volnitsky searchers, it is used to evaluate
+  * `haystack LIKE '%needle1%' OR haystack LIKE '%needle2%' ...` without a regexp per pattern.
+  */
+class FunctionMultiSearchAny : public IFunction
+{
+public:
+    static constexpr auto name = "multiSearchAny";
+    static FunctionPtr create(const Context &)
+    {
+        return std::make_shared<FunctionMultiSearchAny>();
+    }
+
+    String getName() const override
+    {
+        return name;
+    }
+
+    size_t getNumberOfArguments() const override
+    {
+        return 0;
+    }
+
+    bool isVariadic() const override { return true; }
+
+    DataTypePtr getReturnTypeImpl(const DataTypes & arguments) const override
+    {
+        if (arguments.size() < 2)
+            throw Exception(
+                "Number of arguments for function " + getName() + " doesn't match: passed " + toString(arguments.size()) + ", should be at least 2.",
+                ErrorCodes::NUMBER_OF_ARGUMENTS_DOESNT_MATCH);
+
+        for (const auto & argument : arguments)
+        {
+            if (!argument->isString())
+                throw Exception(
+                    "Illegal type " + argument->getName() + " of argument of function " + getName(),
+                    ErrorCodes::ILLEGAL_TYPE_OF_ARGUMENT);
+        }
+        return std::make_shared<DataTypeUInt8>();
+    }
+
+    void executeImpl(Block & block, const ColumnNumbers & arguments, size_t result) const override
+    {
+        const ColumnPtr column_haystack = block.getByPosition(arguments[0]).column->convertToFullColumnIfConst();
+        const auto * col_haystack = checkAndGetColumn<ColumnString>(column_haystack.get());
+        if (col_haystack == nullptr)
+            throw Exception(
+                "Illegal column " + block.getByPosition(arguments[0]).column->getName() + " of argument of function " + getName(),
+                ErrorCodes::ILLEGAL_COLUMN);
+
+        const auto & data = col_haystack->getChars();
+        const auto & offsets = col_haystack->getOffsets();
+        size_t size = offsets.size();
+
+        auto col_res = ColumnUInt8::create(size, 0);
+        auto & res = col_res->getData();
+
+        size_t matched = 0;
+        for (size_t arg = 1; arg < arguments.size() && matched < size; ++arg)
+        {
+            const auto * col_needle = typeid_cast<const ColumnConst *>(block.getByPosition(arguments[arg]).column.get());
+            if (col_needle == nullptr)
+                throw Exception("Needle arguments of function " + getName() + " must be constants", ErrorCodes::ILLEGAL_COLUMN);
+
+            String needle = col_needle->getValue<String>();
+            if (needle.empty())
+            {
+                memset(res.data(), 1, size * sizeof(res[0]));
+                break;
+            }
+
+            auto searcher = LikeMatcherCache::instance().getSearcher(needle);
+            const UInt8 * begin = data.data();
+            const UInt8 * pos = begin;
+            const UInt8 * end = pos + data.size();
+
+            /// The current index in the array of strings.
+            size_t i = 0;
+
+            /// We will search for the next occurrence in all rows at once.
+            while (pos < end && end != (pos = searcher->search(pos, end - pos)))
+            {
+                /// Let's determine which index it refers to.
+                while (begin + offsets[i] <= pos)
+                    ++i;
+
+                /// We check that the entry does not pass through the boundaries of strings.
+                if (!res[i] && pos + needle.size() < begin + offsets[i])
+                {
+                    res[i] = 1;
+                    ++matched;
+                }
+
+                pos = begin + offsets[i];
+                ++i;
+            }
+        }
+
+        block.getByPosition(result).column = std::move(col_res);
+    }
+};
+
 struct NamePosition
 {
     static constexpr auto name = "position";
@@ -2161,5 +2226,6 @@ void registerFunctionsStringSearch(FunctionFactory & factory)
     factory.registerFunction<FunctionLike3Args>();
     factory.registerFunction<FunctionNotLike>();
     factory.registerFunction<FunctionExtract>();
+    factory.registerFunction<FunctionMultiSearchAny>();
 }
 } // namespace DB
@@ -231,6 +231,11 @@ void concat(const std::vector<std::unique_ptr<IArraySource>> & array_sources, Si
 template <typename Sink>
 void NO_INLINE concat(StringSources & sources, Sink && sink)
 {
+    size_t size_to_reserve = 0;
+    for (const auto & source : sources)
+        size_to_reserve += source->getSizeForReserve();
+    sink.reserve(size_to_reserve);
+
     while (!sink.isEnd())
     {
         for (auto & source : sources)
@@ -0,0 +1,63 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Functions/LikeMatcherCache.h>
+
+namespace DB
+{
+namespace
+{
+/// The collator patterns are small, the searchers have a 64KB hash table each.
+constexpr size_t max_cached_patterns = 4096;
+constexpr size_t max_cached_searcher_bytes = 16 * 1024 * 1024;
+} // namespace
+
+LikeMatcherCache::LikeMatcherCache()
+    : patterns(max_cached_patterns)
+    , searchers(max_cached_searcher_bytes)
+{}
+
+LikeMatcherCache & LikeMatcherCache::instance()
+{
+    static LikeMatcherCache cache;
+    return cache;
+}
+
+LikeMatcherCache::PatternPtr LikeMatcherCache::getPattern(const String & pattern, const TiDB::TiDBCollatorPtr & collator, UInt8 escape_char)
+{
+    Int32 collator_id = collator->getCollatorId();
+    String key;
+    key.reserve(sizeof(collator_id) + 1 + pattern.size());
+    key.append(reinterpret_cast<const char *>(&collator_id), sizeof(collator_id));
+    key.push_back(static_cast<char>(escape_char));
+    key.append(pattern);
+
+    return patterns.getOrSet(key, [&]() -> PatternPtr {
+                       auto matcher = collator->pattern();
+                       matcher->compile(pattern, escape_char);
+                       return matcher;
+                   })
+        .first;
+}
+
+LikeMatcherCache::SearcherPtr LikeMatcherCache::getSearcher(const String & needle)
+{
+    return searchers.getOrSet(needle, [&]() {
+                        return std::make_shared<const Volnitsky>(needle.data(), needle.size());
+                    })
+        .first;
+}
+
+} // namespace DB
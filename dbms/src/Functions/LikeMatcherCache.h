@@ -0,0 +1,57 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/LRUCache.h>
+#include <Common/Volnitsky.h>
+#include <Storages/Transaction/Collator.h>
+
+#include <boost/noncopyable.hpp>
+
+namespace DB
+{
+/** Process-wide caches of the compiled LIKE matchers, so that the short requests running the
+  * same constant patterns do not compile them again for every block. The cached matchers are
+  * immutable and shared by all the threads. The re2 objects are pooled by `Regexps::get`.
+  */
+class LikeMatcherCache : private boost::noncopyable
+{
+public:
+    using Pattern = const TiDB::ITiDBCollator::IPattern;
+    using PatternPtr = std::shared_ptr<Pattern>;
+    using SearcherPtr = std::shared_ptr<const Volnitsky>;
+
+    static LikeMatcherCache & instance();
+
+    /// The pattern compiled by the collator, keyed by (pattern, collation, escape).
+    PatternPtr getPattern(const String & pattern, const TiDB::TiDBCollatorPtr & collator, UInt8 escape_char);
+
+    /// The substring searcher for `LIKE '%needle%'`.
+    SearcherPtr getSearcher(const String & needle);
+
+private:
+    LikeMatcherCache();
+
+    struct SearcherWeightFunction
+    {
+        size_t operator()(const Volnitsky &) const { return sizeof(Volnitsky); }
+    };
+
+    LRUCache<String, Pattern> patterns;
+    LRUCache<String, const Volnitsky, std::hash<String>, SearcherWeightFunction> searchers;
+};
+
+} // namespace DB
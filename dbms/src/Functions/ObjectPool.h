@@ -40,6 +40,7 @@ protected:
 
     /// Specialized deleter for std::unique_ptr.
     /// Returns underlying pointer back to stack thus reclaiming its ownership.
+    /// The objects created without a pool are simply destroyed.
     struct Deleter
     {
         SimpleObjectPool<T> * parent;
@@ -50,6 +51,11 @@ protected:
 
         void operator()(T * owning_ptr) const
         {
+            if (parent == nullptr)
+            {
+                delete owning_ptr;
+                return;
+            }
             std::lock_guard lock{parent->mutex};
             parent->stack.emplace(owning_ptr);
         }
@@ -85,7 +91,8 @@ public:
 };
 
 
-/// Like SimpleObjectPool, but additionally allows store different kind of objects that are identified by Key
+/// Like SimpleObjectPool, but additionally allows store different kind of objects that are identified by Key.
+/// If `max_keys` is not zero, the objects of the keys beyond the first `max_keys` ones are not pooled.
 template <typename T, typename Key>
 class ObjectPoolMap
 {
@@ -97,10 +104,15 @@ private:
 
     Container container;
     std::mutex mutex;
+    const size_t max_keys;
 
 public:
     using Pointer = typename Object::Pointer;
 
+    explicit ObjectPoolMap(size_t max_keys_ = 0)
+        : max_keys(max_keys_)
+    {}
+
     template <typename Factory>
     Pointer get(const Key & key, Factory && f)
     {
@@ -108,7 +120,14 @@ public:
 
         auto it = container.find(key);
         if (container.end() == it)
+        {
+            if (max_keys != 0 && container.size() >= max_keys)
+            {
+                lock.unlock();
+                return Pointer{f(), nullptr};
+            }
             it = container.emplace(key, std::make_unique<Object>()).first;
+        }
 
         return it->second->get(std::forward<Factory>(f));
     }
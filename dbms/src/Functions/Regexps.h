@@ -17,6 +17,7 @@
 #include <Common/ProfileEvents.h>
 #include <Functions/ObjectPool.h>
 #include <Functions/likePatternToRegexp.h>
+#include <fmt/format.h>
 
 namespace DB
 {
@@ -25,6 +26,8 @@ namespace Regexps
 using Regexp = OptimizedRegularExpressionImpl<false>;
 using Pool = ObjectPoolMap<Regexp, String>;
 
+constexpr size_t max_pooled_patterns = 4096;
+
 template <bool like>
 inline Regexp createRegexp(const std::string & pattern, int flags)
 {
@@ -41,9 +44,12 @@ template <bool like, bool no_capture>
 inline Pool::Pointer get(const std::string & pattern, int flags)
 {
     /// C++11 has thread-safe function-local statics on most modern compilers.
-    static Pool known_regexps; /// Different variables for different pattern parameters.
+    /// Different variables for different pattern parameters. The pool is bounded so that the
+    /// ad-hoc patterns of many queries do not pile up compiled regexps forever.
+    static Pool known_regexps(max_pooled_patterns);
 
-    return known_regexps.get(pattern, [&pattern, &flags] {
+    /// The same pattern compiled with different flags (e.g. the case insensitive collations) is a different regexp.
+    return known_regexps.get(fmt::format("{}/{}", flags, pattern), [&pattern, &flags] {
         if (no_capture)
             flags |= OptimizedRegularExpression::RE_NO_CAPTURE;
 
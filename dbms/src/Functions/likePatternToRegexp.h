@@ -84,4 +84,44 @@ inline String likePatternToRegexp(const String & pattern)
     return res;
 }
 
+/// Is the LIKE expression reduced to finding a substring in a string?
+inline bool likePatternIsStrstr(const String & pattern, String & res)
+{
+    res = "";
+
+    if (pattern.size() < 2 || pattern.front() != '%' || pattern.back() != '%')
+        return false;
+
+    res.reserve(pattern.size() * 2);
+
+    const char * pos = pattern.data();
+    const char * end = pos + pattern.size();
+
+    ++pos;
+    --end;
+
+    while (pos < end)
+    {
+        switch (*pos)
+        {
+        case '%':
+        case '_':
+            return false;
+        case '\\':
+            ++pos;
+            if (pos == end)
+                return false;
+            else
+                res += *pos;
+            break;
+        default:
+            res += *pos;
+            break;
+        }
+        ++pos;
+    }
+
+    return true;
+}
+
 } // namespace DB
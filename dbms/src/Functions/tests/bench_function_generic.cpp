@@ -0,0 +1,324 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Columns/ColumnConst.h>
+#include <Columns/ColumnNullable.h>
+#include <Common/Stopwatch.h>
+#include <DataTypes/DataTypeDecimal.h>
+#include <DataTypes/DataTypeFactory.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <Functions/FunctionFactory.h>
+#include <Functions/registerFunctions.h>
+#include <IO/ReadBufferFromString.h>
+#include <Interpreters/Context.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+#include <benchmark/benchmark.h>
+
+#include <boost/algorithm/string.hpp>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+/// A data driven benchmark of the functions built by `FunctionFactory`. A case is the function name followed by its
+/// arguments, separated by '|', e.g. "plus|Nullable(Int64)@null=0.1|Int64@const=1". Each argument is a data type name
+/// with some options separated by '@':
+///   null=<ratio>   The ratio of null values of a nullable argument. 0 by default.
+///   len=<n>        The max length of the random strings. 16 by default.
+///   max=<n>        The max absolute value of the random numbers. 1000 by default.
+///   const=<value>  A constant argument, the value is in the escaped text format of the data type.
+/// Besides the baseline suite below, more cases can be given by the environment variable
+/// `TIFLASH_BENCH_FUNCTION_CASES`, separated by ';'. The block size is the argument of the benchmark, which is
+/// `TIFLASH_BENCH_FUNCTION_BLOCK_SIZE` or 8192 by default. Each case reports the average ns/row.
+namespace
+{
+struct ArgumentSpec
+{
+    String type_name;
+    double null_ratio = 0;
+    size_t max_length = 16;
+    size_t max_value = 1000;
+    std::optional<String> const_value;
+};
+
+struct FunctionBenchCase
+{
+    String spec;
+    String function;
+    std::vector<ArgumentSpec> arguments;
+};
+
+FunctionBenchCase parseCase(const String & spec)
+{
+    FunctionBenchCase bench_case;
+    bench_case.spec = spec;
+    std::vector<String> parts;
+    boost::split(parts, spec, boost::is_any_of("|"));
+    bench_case.function = parts[0];
+    for (size_t i = 1; i < parts.size(); ++i)
+    {
+        std::vector<String> options;
+        boost::split(options, parts[i], boost::is_any_of("@"));
+        ArgumentSpec arg;
+        arg.type_name = options[0];
+        for (size_t j = 1; j < options.size(); ++j)
+        {
+            auto pos = options[j].find('=');
+            if (pos == String::npos)
+                throw Exception(fmt::format("Invalid option {} of function bench case {}", options[j], spec));
+            auto key = options[j].substr(0, pos);
+            auto value = options[j].substr(pos + 1);
+            if (key == "null")
+                arg.null_ratio = std::stod(value);
+            else if (key == "len")
+                arg.max_length = std::stoul(value);
+            else if (key == "max")
+                arg.max_value = std::stoul(value);
+            else if (key == "const")
+                arg.const_value = value;
+            else
+                throw Exception(fmt::format("Unknown option {} of function bench case {}", key, spec));
+        }
+        bench_case.arguments.push_back(std::move(arg));
+    }
+    return bench_case;
+}
+
+/// Generate a random value of `type` in the escaped text format.
+String randomValueText(const IDataType & type, const ArgumentSpec & arg, std::mt19937_64 & rng)
+{
+    if (type.isMyDateOrMyDateTime())
+    {
+        std::uniform_int_distribution<int> year(1990, 2030), month(1, 12), day(1, 28), hour(0, 23), minute(0, 59);
+        if (type.getFamilyName() == String("MyDate"))
+            return fmt::format("{:04}-{:02}-{:02}", year(rng), month(rng), day(rng));
+        return fmt::format("{:04}-{:02}-{:02} {:02}:{:02}:{:02}", year(rng), month(rng), day(rng), hour(rng), minute(rng), minute(rng));
+    }
+    if (type.isDecimal())
+    {
+        auto prec = getDecimalPrecision(type, 0);
+        auto scale = getDecimalScale(type, 0);
+        UInt64 max_integral = 1;
+        for (size_t i = scale; i < prec && max_integral <= arg.max_value; ++i)
+            max_integral *= 10;
+        std::uniform_int_distribution<UInt64> integral(0, std::min<UInt64>(max_integral - 1, arg.max_value));
+        std::uniform_int_distribution<int> digit(0, 9), sign(0, 1);
+        String text = fmt::format("{}{}", sign(rng) ? "-" : "", integral(rng));
+        if (scale > 0)
+        {
+            text += '.';
+            for (size_t i = 0; i < scale; ++i)
+                text += static_cast<char>('0' + digit(rng));
+        }
+        return text;
+    }
+    if (type.isFloatingPoint())
+    {
+        std::uniform_real_distribution<double> value(-static_cast<double>(arg.max_value), static_cast<double>(arg.max_value));
+        return fmt::format("{:.3f}", value(rng));
+    }
+    if (type.isInteger())
+    {
+        // Keep the values of Int8 and UInt8 in range.
+        Int64 max_value = type.getSizeOfValueInMemory() == 1 ? std::min<Int64>(arg.max_value, 127) : arg.max_value;
+        std::uniform_int_distribution<Int64> value(type.isUnsignedInteger() ? 0 : -max_value, max_value);
+        return fmt::format("{}", value(rng));
+    }
+    if (type.isString())
+    {
+        std::uniform_int_distribution<size_t> length(0, arg.max_length);
+        std::uniform_int_distribution<int> ch('a', 'z');
+        String text(length(rng), ' ');
+        for (auto & c : text)
+            c = static_cast<char>(ch(rng));
+        return text;
+    }
+    throw Exception(fmt::format("Unsupported argument type {} of function bench", type.getName()));
+}
+
+ColumnWithTypeAndName generateArgument(const ArgumentSpec & arg, size_t rows, std::mt19937_64 & rng, size_t index)
+{
+    auto type = DataTypeFactory::instance().get(arg.type_name);
+    auto name = fmt::format("arg{}", index);
+    if (arg.const_value)
+    {
+        auto column = type->createColumn();
+        ReadBufferFromString buf(*arg.const_value);
+        type->deserializeTextEscaped(*column, buf);
+        return {ColumnConst::create(std::move(column), rows), type, name};
+    }
+
+    auto nested_type = removeNullable(type);
+    auto nested_column = nested_type->createColumn();
+    nested_column->reserve(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        auto text = randomValueText(*nested_type, arg, rng);
+        ReadBufferFromString buf(text);
+        nested_type->deserializeTextEscaped(*nested_column, buf);
+    }
+    if (!type->isNullable())
+        return {std::move(nested_column), type, name};
+
+    auto null_map = ColumnUInt8::create(rows, 0);
+    std::bernoulli_distribution is_null(arg.null_ratio);
+    for (auto & v : null_map->getData())
+        v = is_null(rng);
+    return {ColumnNullable::create(std::move(nested_column), std::move(null_map)), type, name};
+}
+
+void benchFunction(benchmark::State & state, const FunctionBenchCase & bench_case)
+try
+{
+    try
+    {
+        DB::registerFunctions();
+    }
+    catch (DB::Exception &)
+    {
+        // Maybe another test has already registered, ignore exception here.
+    }
+
+    auto context = TiFlashTestEnv::getContext();
+    const size_t rows = state.range(0);
+    std::mt19937_64 rng(0);
+    ColumnsWithTypeAndName arguments;
+    for (size_t i = 0; i < bench_case.arguments.size(); ++i)
+        arguments.push_back(generateArgument(bench_case.arguments[i], rows, rng, i));
+    ColumnNumbers argument_numbers(arguments.size());
+    std::iota(argument_numbers.begin(), argument_numbers.end(), 0);
+
+    // Build the function once, so that only the execution is measured.
+    auto function = FunctionFactory::instance().get(bench_case.function, context)->build(arguments);
+    Block block(arguments);
+    block.insert({nullptr, function->getReturnType(), "result"});
+    const size_t result = arguments.size();
+
+    Stopwatch watch;
+    for (auto _ : state)
+    {
+        function->execute(block, argument_numbers, result);
+        benchmark::DoNotOptimize(block.getByPosition(result).column);
+    }
+    auto total_rows = state.iterations() * rows;
+    state.SetItemsProcessed(total_rows);
+    state.counters["ns/row"] = total_rows ? static_cast<double>(watch.elapsedNanoseconds()) / total_rows : 0;
+}
+CATCH
+
+/// The baseline suite of the most frequently pushed down functions.
+// clang-format off
+const std::vector<String> baseline_cases = {
+    // arithmetic
+    "plus|Nullable(Int64)|Nullable(Int64)",
+    "minus|Nullable(Int64)|Nullable(Int64)",
+    "multiply|Nullable(Int64)|Nullable(Int64)",
+    "tidbDivide|Nullable(Float64)|Nullable(Float64)",
+    "modulo|Nullable(Int64)|Int64@const=7",
+    "intDiv|Nullable(Int64)|Int64@const=7",
+    "plus|Nullable(Decimal(20,2))|Nullable(Decimal(20,2))",
+    "multiply|Nullable(Decimal(20,2))|Nullable(Decimal(20,2))",
+    "tidbDivide|Nullable(Decimal(20,2))|Nullable(Decimal(20,2))",
+    // comparison
+    "equals|Nullable(Int64)|Nullable(Int64)",
+    "notEquals|Nullable(Int64)|Nullable(Int64)",
+    "less|Nullable(Int64)|Int64@const=500",
+    "lessOrEquals|Nullable(Float64)|Nullable(Float64)",
+    "greater|Nullable(Decimal(20,2))|Nullable(Decimal(20,2))",
+    "greaterOrEquals|Nullable(MyDateTime(0))|Nullable(MyDateTime(0))",
+    "equals|Nullable(String)@len=8|Nullable(String)@len=8",
+    "tidbIn|Nullable(Int64)|Int64@const=1|Int64@const=10|Int64@const=100",
+    // logical and null handling
+    "and|Nullable(UInt8)@max=1|Nullable(UInt8)@max=1",
+    "or|Nullable(UInt8)@max=1|Nullable(UInt8)@max=1",
+    "xor|Nullable(UInt8)@max=1|Nullable(UInt8)@max=1",
+    "not|Nullable(UInt8)@max=1",
+    "isNull|Nullable(Int64)@null=0.5",
+    "ifNull|Nullable(Int64)@null=0.5|Int64@const=0",
+    "coalesce|Nullable(Int64)@null=0.5|Nullable(Int64)@null=0.5|Int64@const=0",
+    "multiIf|Nullable(UInt8)@max=1|Nullable(Int64)|Nullable(Int64)",
+    // math
+    "abs|Nullable(Int64)",
+    "floor|Nullable(Float64)",
+    "ceil|Nullable(Float64)",
+    "sqrt|Nullable(Float64)",
+    "tidbRoundWithFrac|Nullable(Decimal(20,4))|Int64@const=2",
+    "tidbLeast|Nullable(Int64)|Nullable(Int64)",
+    "tidbGreatest|Nullable(Int64)|Nullable(Int64)",
+    // cast
+    "tidb_cast|Nullable(Int64)|String@const=Nullable(Decimal(20,2))",
+    "tidb_cast|Nullable(Int64)|String@const=Nullable(Float64)",
+    "tidb_cast|Nullable(Decimal(20,2))|String@const=Nullable(String)",
+    // string
+    "length|Nullable(String)",
+    "lengthUTF8|Nullable(String)",
+    "lowerUTF8|Nullable(String)",
+    "upperUTF8|Nullable(String)",
+    "substringUTF8|Nullable(String)|Int64@const=2|Int64@const=8",
+    "rightUTF8|Nullable(String)|Int64@const=4",
+    "tidbConcat|Nullable(String)|Nullable(String)",
+    "tidbConcatWS|String@const=,|Nullable(String)|Nullable(String)",
+    "replaceAll|Nullable(String)|String@const=ab|String@const=xy",
+    "tidbTrim|Nullable(String)",
+    "position|Nullable(String)@len=2|Nullable(String)",
+    "strcmp|Nullable(String)@len=4|Nullable(String)@len=4",
+    "like3Args|Nullable(String)|String@const=%ab%|Int32@const=92",
+    // date and time
+    "toYear|Nullable(MyDateTime(0))",
+    "toMonth|Nullable(MyDateTime(0))",
+    "toDayOfMonth|Nullable(MyDateTime(0))",
+    "tidbDateDiff|Nullable(MyDateTime(0))|Nullable(MyDateTime(0))",
+    "dateFormat|Nullable(MyDateTime(0))|String@const=%Y-%m-%d",
+    "tidbUnixTimeStampInt|Nullable(MyDateTime(0))",
+    "extractMyDateTime|String@const=day|Nullable(MyDateTime(0))",
+};
+// clang-format on
+
+struct FunctionBenchRegister
+{
+    FunctionBenchRegister()
+    {
+        std::vector<String> specs = baseline_cases;
+        if (const char * extra = std::getenv("TIFLASH_BENCH_FUNCTION_CASES"); extra != nullptr)
+        {
+            std::vector<String> extra_specs;
+            boost::split(extra_specs, String(extra), boost::is_any_of(";"));
+            for (auto & spec : extra_specs)
+            {
+                if (!spec.empty())
+                    specs.push_back(spec);
+            }
+        }
+        Int64 block_size = 8192;
+        if (const char * size = std::getenv("TIFLASH_BENCH_FUNCTION_BLOCK_SIZE"); size != nullptr)
+            block_size = std::stoll(size);
+
+        for (const auto & spec : specs)
+        {
+            auto bench_case = parseCase(spec);
+            benchmark::RegisterBenchmark(fmt::format("FunctionBench/{}", spec).c_str(), benchFunction, bench_case)
+                ->Arg(block_size);
+        }
+    }
+};
+
+const FunctionBenchRegister function_bench_register;
+} // namespace
+
+} // namespace tests
+} // namespace DB
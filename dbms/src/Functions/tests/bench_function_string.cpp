@@ -0,0 +1,94 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Functions/FunctionFactory.h>
+#include <Functions/registerFunctions.h>
+#include <Interpreters/Context.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+class StringFunctionBench : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State &) override
+    {
+        try
+        {
+            DB::registerFunctions();
+        }
+        catch (DB::Exception &)
+        {
+            // Maybe another test has already registered, ignore exception here.
+        }
+        initData();
+    }
+
+    void initData()
+    {
+        std::mt19937 mt(0);
+        std::uniform_int_distribution<size_t> dist_length(0, 64);
+        std::uniform_int_distribution<int> dist_char('a', 'z');
+        for (auto & col : str_cols)
+        {
+            std::vector<String> data(row_num);
+            for (auto & str : data)
+            {
+                str.resize(dist_length(mt));
+                for (auto & c : str)
+                    c = static_cast<char>(dist_char(mt));
+            }
+            col = createColumn<String>(data);
+        }
+        separator_col = createConstColumn<String>(row_num, ",");
+        negative_start_col = createConstColumn<Int64>(row_num, -16);
+        length_col = createConstColumn<Int64>(row_num, 8);
+    }
+
+    const size_t row_num = 10000;
+    ColumnWithTypeAndName str_cols[3];
+    ColumnWithTypeAndName separator_col;
+    ColumnWithTypeAndName negative_start_col;
+    ColumnWithTypeAndName length_col;
+};
+
+#define STRING_BENCHMARK(CASE_NAME, FUNC_NAME, ...)                \
+    BENCHMARK_DEFINE_F(StringFunctionBench, CASE_NAME)             \
+    (benchmark::State & state)                                     \
+    try                                                            \
+    {                                                              \
+        auto context = DB::tests::TiFlashTestEnv::getContext();    \
+        ColumnsWithTypeAndName columns{__VA_ARGS__};               \
+        for (auto _ : state)                                       \
+        {                                                          \
+            executeFunction(context, FUNC_NAME, columns);          \
+        }                                                          \
+    }                                                              \
+    CATCH                                                          \
+    BENCHMARK_REGISTER_F(StringFunctionBench, CASE_NAME)->Iterations(1000);
+
+STRING_BENCHMARK(concat3, "concat", str_cols[0], str_cols[1], str_cols[2])
+STRING_BENCHMARK(tidbConcatWS3, "tidbConcatWS", separator_col, str_cols[0], str_cols[1], str_cols[2])
+STRING_BENCHMARK(substringUTF8NegativeStart, "substringUTF8", str_cols[0], negative_start_col, length_col)
+STRING_BENCHMARK(rightUTF8, "rightUTF8", str_cols[0], length_col)
+
+} // namespace tests
+} // namespace DB
@@ -1056,5 +1056,51 @@ try
 CATCH
 
 
+TEST_F(TestBinaryArithmeticFunctions, DecimalPlusMinusMultiply)
+try
+{
+    // Decimal(10, 2) + Decimal(12, 4) = Decimal(13, 4), computed on Int64.
+    ASSERT_COLUMN_EQ(
+        createColumn<Decimal64>(
+            std::make_tuple(13, 4),
+            {DecimalField64(1000000000099, 4), DecimalField64(-99989900, 4), DecimalField64(0, 4)}),
+        executeFunction(
+            "plus",
+            createColumn<Decimal64>(std::make_tuple(10, 2), {DecimalField64(1234567891, 2), DecimalField64(-999999, 2), DecimalField64(1, 2)}),
+            createColumn<Decimal64>(std::make_tuple(12, 4), {DecimalField64(876543210999, 4), DecimalField64(10000, 4), DecimalField64(-100, 4)})));
+
+    ASSERT_COLUMN_EQ(
+        createColumn<Decimal64>(std::make_tuple(13, 4), {DecimalField64(123455789100, 4), DecimalField64(-100999900, 4)}),
+        executeFunction(
+            "minus",
+            createColumn<Decimal64>(std::make_tuple(10, 2), {DecimalField64(1234567891, 2), DecimalField64(-999999, 2)}),
+            createConstColumn<Decimal64>(std::make_tuple(12, 4), 2, DecimalField64(1000000, 4))));
+
+    // Decimal(10, 2) * Decimal(8, 3) = Decimal(18, 5), the product needs no rescale and fits in Int64.
+    ASSERT_COLUMN_EQ(
+        createColumn<Decimal64>(std::make_tuple(18, 5), {DecimalField64(999999989900000001, 5), DecimalField64(-300000, 5)}),
+        executeFunction(
+            "multiply",
+            createColumn<Decimal64>(std::make_tuple(10, 2), {DecimalField64(9999999999, 2), DecimalField64(-150, 2)}),
+            createColumn<Decimal32>(std::make_tuple(8, 3), {DecimalField32(99999999, 3), DecimalField32(2000, 3)})));
+
+    // the precision of Decimal256 is capped at 65, the overflow is still detected.
+    auto decimal256_max = GetValue<Decimal256, 0>::Max();
+    ASSERT_COLUMN_EQ(
+        createColumn<Decimal256>(std::make_tuple(65, 0), {DecimalField256(decimal256_max.getValue().value - 1, 0)}),
+        executeFunction(
+            "minus",
+            createColumn<Decimal256>(std::make_tuple(65, 0), {decimal256_max}),
+            createColumn<Decimal256>(std::make_tuple(65, 0), {DecimalField256(static_cast<Int256>(1), 0)})));
+    ASSERT_THROW(
+        executeFunction(
+            "plus",
+            createColumn<Decimal256>(std::make_tuple(65, 0), {DecimalField256(static_cast<Int256>(1), 0), decimal256_max}),
+            createColumn<Decimal256>(std::make_tuple(65, 0), {DecimalField256(static_cast<Int256>(1), 0), DecimalField256(static_cast<Int256>(1), 0)})),
+        DB::Exception);
+}
+CATCH
+
+
 } // namespace tests
 } // namespace DB
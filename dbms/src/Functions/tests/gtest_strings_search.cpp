@@ -371,5 +371,58 @@ TEST_F(StringMatch, LikeConstWithConst)
             escape));
 }
 
+TEST_F(StringMatch, MultiSearchAny)
+{
+    std::vector<std::optional<String>> haystack = {"我爱tiflash", "", "a", "abab", "xxbaxx", "tidb", "ti", long_str};
+    std::vector<std::optional<UInt64>> expect = {1, 0, 0, 1, 1, 1, 0, 1};
+    std::vector<std::optional<UInt64>> expect1 = {0, 0, 0, 0, 0, 0, 0, 1};
+    std::vector<std::optional<UInt64>> expect_empty = {1, 1, 1, 1, 1, 1, 1, 1};
+
+    ASSERT_COLUMN_EQ(
+        toVec(expect),
+        executeFunction(
+            "multiSearchAny",
+            toVec(haystack),
+            toConst("ba"),
+            toConst("tif"),
+            toConst("idb")));
+
+    ASSERT_COLUMN_EQ(
+        toNullableVec(expect),
+        executeFunction(
+            "multiSearchAny",
+            toNullableVec(haystack),
+            toConst("ba"),
+            toConst("tif"),
+            toConst("idb")));
+
+    /// The searchers are cached across calls, the results must not depend on the previous calls.
+    ASSERT_COLUMN_EQ(
+        toVec(expect1),
+        executeFunction(
+            "multiSearchAny",
+            toVec(haystack),
+            toConst("xyzab"),
+            toConst("不爱")));
+
+    ASSERT_COLUMN_EQ(
+        toVec(expect_empty),
+        executeFunction(
+            "multiSearchAny",
+            toVec(haystack),
+            toConst("不爱"),
+            toConst("")));
+
+    std::vector<std::optional<String>> haystack_null = {{}, "abc"};
+    std::vector<std::optional<UInt64>> expect_null = {{}, 1};
+    ASSERT_COLUMN_EQ(
+        toNullableVec(expect_null),
+        executeFunction(
+            "multiSearchAny",
+            toNullableVec(haystack_null),
+            toConst("x"),
+            toConst("bc")));
+}
+
 } // namespace tests
 } // namespace DB
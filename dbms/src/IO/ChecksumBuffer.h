@@ -215,6 +215,24 @@ public:
 
     off_t getPositionInFile() override { return (current_frame == -1ull) ? 0 : current_frame * frame_size + offset(); }
 
+    bool getIOUringPrefetchRange(size_t begin, size_t end, IOUringPrefetchRange & range) override
+    {
+        auto * io_uring_file = in->getIOUringFile();
+        if (io_uring_file == nullptr || end <= begin)
+            return false;
+        auto [offset, size] = physicalRange(begin, end);
+        range = IOUringPrefetchRange{io_uring_file, offset, size};
+        return true;
+    }
+
+    void readAhead(size_t begin, size_t end) override
+    {
+        if (end <= begin)
+            return;
+        auto [offset, size] = physicalRange(begin, end);
+        in->readAhead(offset, size);
+    }
+
     size_t readBig(char * buffer, size_t size) override
     {
         const auto expected = size;
@@ -299,6 +317,15 @@ public:
     }
 
 private:
+    /// Map the logical range to the physical range of the whole frames covering it.
+    std::pair<off_t, size_t> physicalRange(size_t begin, size_t end) const
+    {
+        constexpr auto header_size = sizeof(ChecksumFrame<Backend>);
+        auto begin_frame = begin / frame_size;
+        auto end_frame = (end + frame_size - 1) / frame_size;
+        return {static_cast<off_t>(begin_frame * (header_size + frame_size)), (end_frame - begin_frame) * (header_size + frame_size)};
+    }
+
     size_t current_frame;
     const size_t frame_size;
     const bool skip_checksum;
@@ -15,13 +15,16 @@
 #include <Common/Exception.h>
 #include <Common/PODArray.h>
 #include <Common/ProfileEvents.h>
+#include <Common/Stopwatch.h>
 #include <IO/BufferWithOwnMemory.h>
 #include <IO/CompressedReadBufferBase.h>
 #include <IO/CompressedStream.h>
+#include <IO/DeltaFORCompression.h>
 #include <IO/ReadBuffer.h>
 #include <IO/WriteHelpers.h>
 #include <city.h>
 #include <common/unaligned.h>
+#include <ext/scope_guard.h>
 #include <lz4.h>
 #include <string.h>
 #include <zstd.h>
@@ -64,7 +67,7 @@ size_t CompressedReadBufferBase<has_checksum>::readCompressedData(size_t & size_
     size_t & size_compressed = size_compressed_without_checksum;
 
     if (method == static_cast<UInt8>(CompressionMethodByte::LZ4) || method == static_cast<UInt8>(CompressionMethodByte::ZSTD)
-        || method == static_cast<UInt8>(CompressionMethodByte::NONE))
+        || method == static_cast<UInt8>(CompressionMethodByte::NONE) || method == static_cast<UInt8>(CompressionMethodByte::DeltaFOR))
     {
         size_compressed = unalignedLoad<UInt32>(&own_compressed_buffer[1]);
         size_decompressed = unalignedLoad<UInt32>(&own_compressed_buffer[5]);
@@ -102,9 +105,22 @@ size_t CompressedReadBufferBase<has_checksum>::readCompressedData(size_t & size_
     }
 }
 
+namespace
+{
+thread_local UInt64 thread_decompress_ns = 0;
+}
+
+UInt64 getThreadDecompressNanoseconds()
+{
+    return thread_decompress_ns;
+}
+
 template <bool has_checksum>
 void CompressedReadBufferBase<has_checksum>::decompress(char * to, size_t size_decompressed, size_t size_compressed_without_checksum)
 {
+    const auto start_ns = clock_gettime_ns();
+    SCOPE_EXIT({ thread_decompress_ns += clock_gettime_ns() - start_ns; });
+
     UInt8 method = compressed_buffer[0]; /// See CompressedWriteBuffer.h
 
     if (method == static_cast<UInt8>(CompressionMethodByte::LZ4))
@@ -123,6 +139,10 @@ void CompressedReadBufferBase<has_checksum>::decompress(char * to, size_t size_d
     {
         memcpy(to, &compressed_buffer[COMPRESSED_BLOCK_HEADER_SIZE], size_decompressed);
     }
+    else if (method == static_cast<UInt8>(CompressionMethodByte::DeltaFOR))
+    {
+        decompressDeltaFOR(compressed_buffer + COMPRESSED_BLOCK_HEADER_SIZE, size_compressed_without_checksum - COMPRESSED_BLOCK_HEADER_SIZE, to, size_decompressed);
+    }
     else
         throw Exception("Unknown compression method: " + toString(method), ErrorCodes::UNKNOWN_COMPRESSION_METHOD);
 }
@@ -21,6 +21,10 @@ namespace DB
 {
 class ReadBuffer;
 
+/// The total nanoseconds spent on decompressing by `CompressedReadBufferBase` in current thread,
+/// used to split the time of reading compressed files into the time of io and decompression.
+UInt64 getThreadDecompressNanoseconds();
+
 /** Basic functionality for implementation of
   *  CompressedReadBuffer, CompressedReadBufferFromFile and CachedCompressedReadBuffer.
   */
@@ -32,6 +32,7 @@ enum class CompressionMethod
     LZ4HC = 2, /// The format is the same as for LZ4. The difference is only in compression.
     ZSTD = 3, /// Experimental algorithm: https://github.com/Cyan4973/zstd
     NONE = 4, /// No compression
+    DeltaFOR = 5, /// Delta and frame of reference with bit-packing for fixed-width integers, see DeltaFORCompression.h. Falls back to LZ4 for other data.
 };
 
 /** The compressed block format is as follows:
@@ -52,6 +53,9 @@ enum class CompressionMethod
   *
   * 0x90 - ZSTD
   *
+  * 0x91 - DeltaFOR
+  *        The sizes are the same as LZ4. The format of the rest is described in DeltaFORCompression.h.
+  *
   * All sizes are little endian.
   */
 
@@ -60,6 +64,7 @@ enum class CompressionMethodByte : uint8_t
     NONE = 0x02,
     LZ4 = 0x82,
     ZSTD = 0x90,
+    DeltaFOR = 0x91,
     // COL_END is not a compreesion method, but a flag of column end used in compact file.
     COL_END = 0x66,
 };
@@ -14,6 +14,7 @@
 
 #include <Core/Types.h>
 #include <IO/CompressedWriteBuffer.h>
+#include <IO/DeltaFORCompression.h>
 #include <city.h>
 #include <common/unaligned.h>
 #include <lz4.h>
@@ -48,6 +49,31 @@ void CompressedWriteBuffer<add_checksum>::nextImpl()
 
     switch (compression_settings.method)
     {
+    case CompressionMethod::DeltaFOR:
+    {
+        static constexpr size_t header_size = 1 + sizeof(UInt32) + sizeof(UInt32);
+
+        compressed_buffer.resize(header_size + uncompressed_size);
+
+        size_t res = compressDeltaFOR(working_buffer.begin(), uncompressed_size, compression_settings.value_size, &compressed_buffer[header_size]);
+        if (res != 0)
+        {
+            compressed_buffer[0] = static_cast<UInt8>(CompressionMethodByte::DeltaFOR);
+
+            compressed_size = header_size + res;
+
+            UInt32 compressed_size_32 = compressed_size;
+            UInt32 uncompressed_size_32 = uncompressed_size;
+
+            unalignedStore<UInt32>(&compressed_buffer[1], compressed_size_32);
+            unalignedStore<UInt32>(&compressed_buffer[5], uncompressed_size_32);
+
+            compressed_buffer_ptr = &compressed_buffer[0];
+            break;
+        }
+        /// The data is not fixed-width integers or can not be encoded smaller, fall back to LZ4.
+        [[fallthrough]];
+    }
     case CompressionMethod::LZ4:
     case CompressionMethod::LZ4HC:
     {
@@ -60,7 +86,7 @@ void CompressedWriteBuffer<add_checksum>::nextImpl()
 
         compressed_buffer[0] = static_cast<UInt8>(CompressionMethodByte::LZ4);
 
-        if (compression_settings.method == CompressionMethod::LZ4)
+        if (compression_settings.method != CompressionMethod::LZ4HC)
             compressed_size = header_size + LZ4_compress_fast(working_buffer.begin(), &compressed_buffer[header_size], uncompressed_size, LZ4_COMPRESSBOUND(uncompressed_size), compression_settings.level);
         else
             compressed_size = header_size + LZ4_compress_HC(working_buffer.begin(), &compressed_buffer[header_size], uncompressed_size, LZ4_COMPRESSBOUND(uncompressed_size), compression_settings.level);
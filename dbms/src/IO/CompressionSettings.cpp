@@ -43,6 +43,8 @@ int CompressionSettings::getDefaultLevel(CompressionMethod method)
         return LZ4HC_CLEVEL_DEFAULT;
     case CompressionMethod::ZSTD:
         return 1;
+    case CompressionMethod::DeltaFOR:
+        return 1; /// The level of LZ4 when falling back
     default:
         return -1;
     }
@@ -25,6 +25,8 @@ struct CompressionSettings
 {
     CompressionMethod method;
     int level;
+    /// The size of the fixed-width values in the data, or 0 if unknown. Only used by `CompressionMethod::DeltaFOR`.
+    size_t value_size = 0;
 
     CompressionSettings()
         : CompressionSettings(CompressionMethod::LZ4)
@@ -0,0 +1,69 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/ProfileEvents.h>
+#include <Common/ShardedSLRUCache.h>
+#include <IO/UncompressedCache.h>
+
+namespace ProfileEvents
+{
+extern const Event DecompressedBlockCacheHits;
+extern const Event DecompressedBlockCacheMisses;
+extern const Event DecompressedBlockCacheWeightLost;
+} // namespace ProfileEvents
+
+namespace DB
+{
+/** Cache of decompressed blocks of the hot columns in DTFiles, used by `CompressedReadBufferFromFileProvider`. thread-safe.
+  * The key is the hash of (data file path, offset of the compressed block). The data file path of a column contains
+  * the DTFile id and the column id, and is unique among the stores.
+  * Unlike `UncompressedCache`, it is sharded and resistant to full table scans, see `ShardedSLRUCache`.
+  */
+class DecompressedBlockCache : public ShardedSLRUCache<UInt128, UncompressedCacheCell, TrivialHash, UncompressedSizeWeightFunction>
+{
+private:
+    using Base = ShardedSLRUCache<UInt128, UncompressedCacheCell, TrivialHash, UncompressedSizeWeightFunction>;
+
+public:
+    explicit DecompressedBlockCache(size_t max_size_in_bytes)
+        : Base(max_size_in_bytes)
+    {}
+
+    static UInt128 hash(const String & data_path, size_t offset) { return UncompressedCache::hash(data_path, offset); }
+
+    MappedPtr get(const Key & key)
+    {
+        MappedPtr res = Base::get(key);
+
+        if (res)
+            ProfileEvents::increment(ProfileEvents::DecompressedBlockCacheHits);
+        else
+            ProfileEvents::increment(ProfileEvents::DecompressedBlockCacheMisses);
+
+        return res;
+    }
+
+private:
+    void onRemoveOverflowWeightLoss(size_t weight_loss) override
+    {
+        ProfileEvents::increment(ProfileEvents::DecompressedBlockCacheWeightLost, weight_loss);
+    }
+};
+
+using DecompressedBlockCachePtr = std::shared_ptr<DecompressedBlockCache>;
+
+} // namespace DB
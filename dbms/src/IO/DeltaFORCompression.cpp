@@ -0,0 +1,235 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <IO/DeltaFORCompression.h>
+#include <common/unaligned.h>
+#include <string.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int CANNOT_DECOMPRESS;
+} // namespace ErrorCodes
+
+namespace
+{
+constexpr size_t header_size = 3 + sizeof(UInt64) + sizeof(UInt64);
+constexpr size_t padding_size = sizeof(UInt64);
+
+enum Mode : UInt8
+{
+    FrameOfReference = 0,
+    DeltaFrameOfReference = 1,
+};
+
+inline UInt8 getBitWidth(UInt64 range)
+{
+    return range == 0 ? 0 : 64 - __builtin_clzll(range);
+}
+
+inline size_t getPackedBytes(size_t count, UInt8 bit_width)
+{
+    return (count * bit_width + 7) / 8 + padding_size;
+}
+
+/// `packed` must be zero-filled.
+inline void pack(UInt64 value, size_t i, UInt8 bit_width, char * packed)
+{
+    size_t bit_pos = i * bit_width;
+    char * p = packed + bit_pos / 8;
+    unalignedStore<UInt64>(p, unalignedLoad<UInt64>(p) | (value << (bit_pos % 8)));
+}
+
+/// Every value is unpacked independently, so that the loop can be vectorized.
+template <typename U>
+void unpack(const char * packed, size_t count, UInt8 bit_width, U reference, char * out)
+{
+    const UInt64 mask = (1ULL << bit_width) - 1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t bit_pos = i * bit_width;
+        UInt64 value = (unalignedLoad<UInt64>(packed + bit_pos / 8) >> (bit_pos % 8)) & mask;
+        unalignedStore<U>(out + i * sizeof(U), static_cast<U>(reference + static_cast<U>(value)));
+    }
+}
+
+template <typename S>
+size_t compressImpl(const char * source, size_t source_size, char * dest)
+{
+    using U = std::make_unsigned_t<S>;
+    const size_t count = source_size / sizeof(S);
+    if (count == 0)
+        return 0;
+
+    auto load = [&](size_t i) {
+        return unalignedLoad<S>(source + i * sizeof(S));
+    };
+    auto delta = [&](size_t i) {
+        return static_cast<S>(static_cast<U>(load(i)) - static_cast<U>(load(i - 1)));
+    };
+
+    S min_value = load(0);
+    S max_value = min_value;
+    for (size_t i = 1; i < count; ++i)
+    {
+        S v = load(i);
+        min_value = std::min(min_value, v);
+        max_value = std::max(max_value, v);
+    }
+    UInt8 bit_width = getBitWidth(static_cast<U>(static_cast<U>(max_value) - static_cast<U>(min_value)));
+    Mode mode = FrameOfReference;
+    S reference = min_value;
+
+    if (count > 1)
+    {
+        S min_delta = delta(1);
+        S max_delta = min_delta;
+        for (size_t i = 2; i < count; ++i)
+        {
+            S d = delta(i);
+            min_delta = std::min(min_delta, d);
+            max_delta = std::max(max_delta, d);
+        }
+        UInt8 delta_bit_width = getBitWidth(static_cast<U>(static_cast<U>(max_delta) - static_cast<U>(min_delta)));
+        if (delta_bit_width < bit_width)
+        {
+            bit_width = delta_bit_width;
+            mode = DeltaFrameOfReference;
+            reference = min_delta;
+        }
+    }
+
+    if (bit_width > DELTA_FOR_MAX_BIT_WIDTH)
+        return 0;
+
+    const size_t packed_count = mode == DeltaFrameOfReference ? count - 1 : count;
+    const size_t packed_bytes = getPackedBytes(packed_count, bit_width);
+    const size_t tail_bytes = source_size - count * sizeof(S);
+    const size_t compressed_size = header_size + packed_bytes + tail_bytes;
+    if (compressed_size >= source_size)
+        return 0;
+
+    dest[0] = static_cast<char>(sizeof(S));
+    dest[1] = static_cast<char>(mode);
+    dest[2] = static_cast<char>(bit_width);
+    unalignedStore<UInt64>(dest + 3, static_cast<UInt64>(static_cast<Int64>(load(0))));
+    unalignedStore<UInt64>(dest + 3 + sizeof(UInt64), static_cast<UInt64>(static_cast<Int64>(reference)));
+
+    char * packed = dest + header_size;
+    memset(packed, 0, packed_bytes);
+    if (bit_width > 0)
+    {
+        if (mode == DeltaFrameOfReference)
+        {
+            for (size_t i = 1; i < count; ++i)
+                pack(static_cast<U>(static_cast<U>(delta(i)) - static_cast<U>(reference)), i - 1, bit_width, packed);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                pack(static_cast<U>(static_cast<U>(load(i)) - static_cast<U>(reference)), i, bit_width, packed);
+        }
+    }
+    memcpy(packed + packed_bytes, source + count * sizeof(S), tail_bytes);
+    return compressed_size;
+}
+
+template <typename S>
+void decompressImpl(const char * source, size_t source_size, char * dest, size_t dest_size)
+{
+    using U = std::make_unsigned_t<S>;
+    const size_t count = dest_size / sizeof(S);
+    const auto mode = static_cast<UInt8>(source[1]);
+    const auto bit_width = static_cast<UInt8>(source[2]);
+    if (unlikely((mode != FrameOfReference && mode != DeltaFrameOfReference) || bit_width > DELTA_FOR_MAX_BIT_WIDTH))
+        throw Exception("Cannot decompress DeltaFOR: corrupted header", ErrorCodes::CANNOT_DECOMPRESS);
+
+    const auto first = static_cast<U>(unalignedLoad<UInt64>(source + 3));
+    const auto reference = static_cast<U>(unalignedLoad<UInt64>(source + 3 + sizeof(UInt64)));
+    const size_t packed_count = mode == DeltaFrameOfReference ? (count == 0 ? 0 : count - 1) : count;
+    const size_t packed_bytes = getPackedBytes(packed_count, bit_width);
+    const size_t tail_bytes = dest_size - count * sizeof(S);
+    if (unlikely(header_size + packed_bytes + tail_bytes != source_size))
+        throw Exception("Cannot decompress DeltaFOR: size doesn't match", ErrorCodes::CANNOT_DECOMPRESS);
+
+    const char * packed = source + header_size;
+    if (mode == DeltaFrameOfReference)
+    {
+        if (count > 0)
+        {
+            unalignedStore<U>(dest, first);
+            unpack(packed, packed_count, bit_width, reference, dest + sizeof(U));
+        }
+        // The prefix sum is done in a separate pass so that it doesn't serialize the unpacking above.
+        U sum = first;
+        for (size_t i = 1; i < count; ++i)
+        {
+            char * p = dest + i * sizeof(U);
+            sum += unalignedLoad<U>(p);
+            unalignedStore<U>(p, sum);
+        }
+    }
+    else
+    {
+        unpack(packed, packed_count, bit_width, reference, dest);
+    }
+    memcpy(dest + count * sizeof(S), packed + packed_bytes, tail_bytes);
+}
+} // namespace
+
+size_t compressDeltaFOR(const char * source, size_t source_size, size_t value_size, char * dest)
+{
+    switch (value_size)
+    {
+    case 1:
+        return compressImpl<Int8>(source, source_size, dest);
+    case 2:
+        return compressImpl<Int16>(source, source_size, dest);
+    case 4:
+        return compressImpl<Int32>(source, source_size, dest);
+    case 8:
+        return compressImpl<Int64>(source, source_size, dest);
+    default:
+        // Not a fixed-width integer array, let the caller fall back to another method.
+        return 0;
+    }
+}
+
+void decompressDeltaFOR(const char * source, size_t source_size, char * dest, size_t dest_size)
+{
+    if (unlikely(source_size < header_size))
+        throw Exception("Cannot decompress DeltaFOR: too small compressed size", ErrorCodes::CANNOT_DECOMPRESS);
+
+    switch (static_cast<UInt8>(source[0]))
+    {
+    case 1:
+        return decompressImpl<Int8>(source, source_size, dest, dest_size);
+    case 2:
+        return decompressImpl<Int16>(source, source_size, dest, dest_size);
+    case 4:
+        return decompressImpl<Int32>(source, source_size, dest, dest_size);
+    case 8:
+        return decompressImpl<Int64>(source, source_size, dest, dest_size);
+    default:
+        throw Exception("Cannot decompress DeltaFOR: unknown value size " + std::to_string(static_cast<UInt8>(source[0])), ErrorCodes::CANNOT_DECOMPRESS);
+    }
+}
+
+} // namespace DB
@@ -0,0 +1,49 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Core/Types.h>
+
+namespace DB
+{
+/** A lightweight codec for arrays of fixed-width integers, see `CompressionMethod::DeltaFOR`.
+  *
+  * The uncompressed data is taken as an array of little-endian integers of `value_size` (1, 2, 4 or 8) bytes.
+  * The values are encoded either as a frame of reference over the values (every value is stored as `value - min`),
+  * or as a frame of reference over the deltas of neighbouring values, whichever needs fewer bits, and the results
+  * are bit-packed. Monotonic columns like the handle and version columns, and narrow-range columns like the delete
+  * mark, usually need only a few bits per value.
+  *
+  * The layout of the compressed data, after the block header (see CompressedStream.h):
+  *   UInt8  value_size
+  *   UInt8  mode          0 = frame of reference over the values, 1 = over the deltas
+  *   UInt8  bit_width     0 ~ DELTA_FOR_MAX_BIT_WIDTH
+  *   UInt64 first         the first value, only used by the delta mode
+  *   UInt64 reference     the minimum of the encoded values or deltas, sign-extended
+  *   the bit-packed values, followed by 8 bytes of padding so that they can be decoded word by word
+  *   the trailing bytes that do not make a whole value, as is
+  */
+static constexpr size_t DELTA_FOR_MAX_BIT_WIDTH = 56;
+
+/// Encode `source` into `dest`, which must have room for `source_size` bytes.
+/// Returns the size of the encoded data, or 0 if the data is not smaller after encoding. The caller
+/// should compress the data by another method in that case.
+size_t compressDeltaFOR(const char * source, size_t source_size, size_t value_size, char * dest);
+
+/// Decode the data encoded by `compressDeltaFOR` into `dest` of `dest_size` bytes.
+void decompressDeltaFOR(const char * source, size_t source_size, char * dest, size_t dest_size);
+
+} // namespace DB
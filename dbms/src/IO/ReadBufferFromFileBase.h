@@ -28,6 +28,8 @@
 
 namespace DB
 {
+struct IOUringPrefetchRange;
+
 class ReadBufferFromFileBase : public BufferWithOwnMemory<ReadBuffer>
 {
 public:
@@ -39,6 +41,13 @@ public:
     virtual std::string getFileName() const = 0;
     virtual int getFD() const = 0;
 
+    /// Get the range in the underlying file that covers [begin, end) of this buffer, which could be read ahead by io_uring.
+    /// Returns false if the underlying file does not support it.
+    virtual bool getIOUringPrefetchRange(size_t /*begin*/, size_t /*end*/, IOUringPrefetchRange & /*range*/) { return false; }
+
+    /// Hint the underlying file to load the data of [begin, end) of this buffer in background.
+    virtual void readAhead(size_t /*begin*/, size_t /*end*/) {}
+
     /// It is possible to get information about the time of each reading.
     struct ProfileInfo
     {
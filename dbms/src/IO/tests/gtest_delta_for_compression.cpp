@@ -0,0 +1,152 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <IO/CompressedReadBuffer.h>
+#include <IO/CompressedWriteBuffer.h>
+#include <IO/DeltaFORCompression.h>
+#include <IO/ReadBufferFromString.h>
+#include <IO/WriteBufferFromString.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+constexpr size_t checksum_size = 16;
+
+template <typename T>
+String toBytes(const std::vector<T> & values)
+{
+    return String(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+/// Compress `data` as one block, check the method byte of the block and that it can be read back.
+/// Returns the compressed size.
+size_t compressAndCheck(const String & data, size_t value_size, CompressionMethodByte expected_method)
+{
+    WriteBufferFromOwnString out;
+    {
+        CompressionSettings settings(CompressionMethod::DeltaFOR);
+        settings.value_size = value_size;
+        CompressedWriteBuffer<true> compressed_out(out, settings, std::max<size_t>(data.size(), 1));
+        compressed_out.write(data.data(), data.size());
+    }
+    String compressed = out.releaseStr();
+    if (data.empty())
+    {
+        EXPECT_TRUE(compressed.empty());
+        return 0;
+    }
+    EXPECT_EQ(static_cast<UInt8>(compressed[checksum_size]), static_cast<UInt8>(expected_method));
+
+    ReadBufferFromString in(compressed);
+    CompressedReadBuffer<true> compressed_in(in);
+    String decompressed(data.size(), '\0');
+    compressed_in.readStrict(decompressed.data(), decompressed.size());
+    EXPECT_TRUE(compressed_in.eof());
+    EXPECT_EQ(decompressed, data);
+    return compressed.size();
+}
+} // namespace
+
+TEST(DeltaFORCompressionTest, MonotonicValues)
+{
+    std::vector<Int64> handles(8192);
+    std::vector<UInt64> versions(8192);
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        handles[i] = static_cast<Int64>(i) * 3 - 1000;
+        versions[i] = 440000000000000000ULL + i * i;
+    }
+    auto size = compressAndCheck(toBytes(handles), sizeof(Int64), CompressionMethodByte::DeltaFOR);
+    // The deltas are the same, 0 bit for each value.
+    EXPECT_LT(size, 64);
+    size = compressAndCheck(toBytes(versions), sizeof(UInt64), CompressionMethodByte::DeltaFOR);
+    EXPECT_LT(size, versions.size() * 2 + 64);
+
+    std::vector<Int32> decreasing(1000);
+    for (size_t i = 0; i < decreasing.size(); ++i)
+        decreasing[i] = 100 - static_cast<Int32>(i) * 7;
+    compressAndCheck(toBytes(decreasing), sizeof(Int32), CompressionMethodByte::DeltaFOR);
+}
+
+TEST(DeltaFORCompressionTest, NarrowRangeValues)
+{
+    std::mt19937_64 rng(42);
+    std::vector<Int16> values(4096);
+    for (auto & v : values)
+        v = static_cast<Int16>(-5 + static_cast<Int16>(rng() % 16));
+    auto size = compressAndCheck(toBytes(values), sizeof(Int16), CompressionMethodByte::DeltaFOR);
+    // 4 bits for each value.
+    EXPECT_LT(size, values.size() / 2 + 64);
+
+    std::vector<UInt8> del_marks(8192, 0);
+    compressAndCheck(toBytes(del_marks), sizeof(UInt8), CompressionMethodByte::DeltaFOR);
+    del_marks[100] = 1;
+    compressAndCheck(toBytes(del_marks), sizeof(UInt8), CompressionMethodByte::DeltaFOR);
+
+    // Too small to be worth encoding.
+    std::vector<Int64> single{-7};
+    compressAndCheck(toBytes(single), sizeof(Int64), CompressionMethodByte::LZ4);
+}
+
+TEST(DeltaFORCompressionTest, TrailingBytes)
+{
+    std::vector<UInt32> values(1000);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = 1000000 + i;
+    String data = toBytes(values) + "abc";
+    compressAndCheck(data, sizeof(UInt32), CompressionMethodByte::DeltaFOR);
+}
+
+TEST(DeltaFORCompressionTest, FallbackToLZ4)
+{
+    std::mt19937_64 rng(42);
+    std::vector<UInt64> random_values(4096);
+    for (auto & v : random_values)
+        v = rng();
+    compressAndCheck(toBytes(random_values), sizeof(UInt64), CompressionMethodByte::LZ4);
+
+    // Unknown value size, like the data of string columns.
+    String chars(4096, 'a');
+    compressAndCheck(chars, 0, CompressionMethodByte::LZ4);
+    compressAndCheck("", sizeof(UInt64), CompressionMethodByte::LZ4);
+}
+
+TEST(DeltaFORCompressionTest, CorruptedData)
+{
+    std::vector<UInt32> values(100, 1);
+    String data = toBytes(values);
+    String compressed(data.size(), '\0');
+    size_t size = compressDeltaFOR(data.data(), data.size(), sizeof(UInt32), compressed.data());
+    ASSERT_GT(size, 0);
+
+    String decompressed(data.size(), '\0');
+    decompressDeltaFOR(compressed.data(), size, decompressed.data(), decompressed.size());
+    ASSERT_EQ(decompressed, data);
+
+    // The decompressed size doesn't match.
+    ASSERT_THROW(decompressDeltaFOR(compressed.data(), size, decompressed.data(), decompressed.size() - 1), Exception);
+    // Unknown value size.
+    compressed[0] = 3;
+    ASSERT_THROW(decompressDeltaFOR(compressed.data(), size, decompressed.data(), decompressed.size()), Exception);
+}
+
+} // namespace tests
+} // namespace DB
@@ -132,6 +132,25 @@ TEST_STREAM(CRC32)
 TEST_STREAM(CRC64)
 TEST_STREAM(City128)
 TEST_STREAM(XXH3)
+TEST_STREAM(CRC32C)
+
+TEST(ChecksumBufferCRC32C, KnownValue)
+{
+    const std::string check = "123456789";
+    ASSERT_EQ(crc32c(0, check.data(), check.size()), 0xE3069283);
+
+    // digests are chained across updates, whatever the split points and the alignment
+    auto [data, size] = randomData(4099);
+    auto whole = Digest::CRC32C{};
+    whole.update(data.data(), size);
+    for (size_t split : {0, 1, 7, 8, 9, 2049, 4098})
+    {
+        auto digest = Digest::CRC32C{};
+        digest.update(data.data(), split);
+        digest.update(data.data() + split, size - split);
+        ASSERT_EQ(digest.checksum(), whole.checksum()) << "split: " << split;
+    }
+}
 
 #define TEST_SEEK(ALGO) \
     TEST(ChecksumBuffer##ALGO, Seeking) { runSeekingTest<Digest::ALGO>(); } // NOLINT(cert-err58-cpp)
@@ -182,6 +201,7 @@ TEST_SEEK(CRC32)
 TEST_SEEK(CRC64)
 TEST_SEEK(City128)
 TEST_SEEK(XXH3)
+TEST_SEEK(CRC32C)
 
 template <class D>
 void runReadBigTest()
@@ -227,6 +247,7 @@ TEST_BIG_READING(CRC32)
 TEST_BIG_READING(CRC64)
 TEST_BIG_READING(City128)
 TEST_BIG_READING(XXH3)
+TEST_BIG_READING(CRC32C)
 
 template <ChecksumAlgo D>
 void runStackingTest()
@@ -279,6 +300,7 @@ TEST_STACKING(CRC32)
 TEST_STACKING(CRC64)
 TEST_STACKING(City128)
 TEST_STACKING(XXH3)
+TEST_STACKING(CRC32C)
 
 
 template <ChecksumAlgo D>
@@ -351,5 +373,6 @@ TEST_STACKED_SEEKING(CRC32)
 TEST_STACKED_SEEKING(CRC64)
 TEST_STACKED_SEEKING(City128)
 TEST_STACKED_SEEKING(XXH3)
+TEST_STACKED_SEEKING(CRC32C)
 } // namespace tests
 } // namespace DB
@@ -18,8 +18,10 @@
 #include <Columns/ColumnTuple.h>
 #include <Common/ClickHouseRevision.h>
 #include <Common/FailPoint.h>
+#include <Common/HugePages.h>
 #include <Common/MemoryTracker.h>
 #include <Common/Stopwatch.h>
+#include <Common/TiFlashMetrics.h>
 #include <Common/ThreadManager.h>
 #include <Common/typeid_cast.h>
 #include <Common/wrapInvocable.h>
@@ -32,6 +34,7 @@
 #include <Encryption/WriteBufferFromFileProvider.h>
 #include <IO/CompressedWriteBuffer.h>
 #include <Interpreters/Aggregator.h>
+#include <Interpreters/CollatorSortKeys.h>
 #include <common/demangle.h>
 
 #include <future>
@@ -76,6 +79,8 @@ void AggregatedDataVariants::convertToTwoLevel()
     if (aggregator)
         LOG_FMT_TRACE(aggregator->log, "Converting aggregation data to two-level.");
 
+    HugePages::Scope huge_pages_scope;
+
     switch (type)
     {
 #define M(NAME)                                                                                 \
@@ -525,6 +530,9 @@ bool Aggregator::executeOnBlock(
     Int64 & local_delta_memory,
     bool & no_more_keys)
 {
+    /// The buckets of two-level aggregation can be large, prefer huge pages for them.
+    HugePages::Scope huge_pages_scope(result.isTwoLevel());
+
     if (isCancelled())
         return true;
 
@@ -535,10 +543,12 @@ bool Aggregator::executeOnBlock(
     if (result.empty())
     {
         result.init(method_chosen);
+        if (params.reserve_keys_hint > 0)
+            result.reserve(params.reserve_keys_hint);
         result.keys_size = params.keys_size;
         result.key_sizes = key_sizes;
         result.collators = params.collators;
-        LOG_FMT_TRACE(log, "Aggregation method: {}", result.getMethodName());
+        LOG_FMT_TRACE(log, "Aggregation method: {}, reserved keys: {}", result.getMethodName(), params.reserve_keys_hint);
     }
 
     /** Constant columns are not supported directly during aggregation.
@@ -560,6 +570,10 @@ bool Aggregator::executeOnBlock(
         }
     }
 
+    /// Convert the ci collated keys to their sort keys once per block instead of once per row in the hash methods.
+    TiDB::TiDBCollators key_collators = result.collators;
+    materializeSortKeys(key_columns, key_collators, materialized_columns);
+
     AggregateFunctionInstructions aggregate_functions_instructions;
     prepareAggregateInstructions(columns, aggregate_columns, materialized_columns, aggregate_functions_instructions);
 
@@ -589,7 +603,7 @@ bool Aggregator::executeOnBlock(
 
 #define M(NAME, IS_TWO_LEVEL)                                   \
     else if (result.type == AggregatedDataVariants::Type::NAME) \
-        executeImpl(*result.NAME, result.aggregates_pool, num_rows, key_columns, result.collators, aggregate_functions_instructions.data(), no_more_keys, overflow_row_ptr);
+        executeImpl(*result.NAME, result.aggregates_pool, num_rows, key_columns, key_collators, aggregate_functions_instructions.data(), no_more_keys, overflow_row_ptr);
 
         if (false) // NOLINT
         {
@@ -679,6 +693,7 @@ void Aggregator::writeToTemporaryFile(AggregatedDataVariants & data_variants, co
     double elapsed_seconds = watch.elapsedSeconds();
     double compressed_bytes = file_buf.count();
     double uncompressed_bytes = compressed_buf.count();
+    GET_METRIC(tiflash_spilled_bytes, type_aggregation).Increment(compressed_bytes);
 
     {
         std::lock_guard lock(temporary_files.mutex);
@@ -831,9 +846,10 @@ void Aggregator::execute(const BlockInputStreamPtr & stream, AggregatedDataVaria
     size_t rows = result.sizeWithoutOverflowRow();
     LOG_FMT_TRACE(
         log,
-        "Aggregated. {} to {} rows (from {:.3f} MiB) in {:.3f} sec. ({:.3f} rows/sec., {:.3f} MiB/sec.)",
+        "Aggregated. {} to {} rows (reserved {} keys, from {:.3f} MiB) in {:.3f} sec. ({:.3f} rows/sec., {:.3f} MiB/sec.)",
         src_rows,
         rows,
+        params.reserve_keys_hint,
         src_bytes / 1048576.0,
         elapsed_seconds,
         src_rows / elapsed_seconds,
@@ -1373,25 +1389,47 @@ void NO_INLINE Aggregator::mergeDataOnlyExistingKeysImpl(
 }
 
 
-void NO_INLINE Aggregator::mergeWithoutKeyDataImpl(
-    ManyAggregatedDataVariants & non_empty_data) const
+void Aggregator::mergeWithoutKeyStates(AggregatedDataVariants & res, AggregatedDataVariants & current) const
 {
-    AggregatedDataVariantsPtr & res = non_empty_data[0];
+    AggregatedDataWithoutKey & res_data = res.without_key;
+    AggregatedDataWithoutKey & current_data = current.without_key;
 
-    /// We merge all aggregation results to the first.
-    for (size_t result_num = 1, size = non_empty_data.size(); result_num < size; ++result_num)
-    {
-        AggregatedDataWithoutKey & res_data = res->without_key;
-        AggregatedDataWithoutKey & current_data = non_empty_data[result_num]->without_key;
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+        aggregate_functions[i]->merge(res_data + offsets_of_aggregate_states[i], current_data + offsets_of_aggregate_states[i], res.aggregates_pool);
 
-        for (size_t i = 0; i < params.aggregates_size; ++i)
-            aggregate_functions[i]->merge(res_data + offsets_of_aggregate_states[i], current_data + offsets_of_aggregate_states[i], res->aggregates_pool);
+    for (size_t i = 0; i < params.aggregates_size; ++i)
+        aggregate_functions[i]->destroy(current_data + offsets_of_aggregate_states[i]);
 
-        for (size_t i = 0; i < params.aggregates_size; ++i)
-            aggregate_functions[i]->destroy(current_data + offsets_of_aggregate_states[i]);
+    current_data = nullptr;
+}
 
-        current_data = nullptr;
+void NO_INLINE Aggregator::mergeWithoutKeyDataImpl(
+    ManyAggregatedDataVariants & non_empty_data,
+    size_t max_threads) const
+{
+    size_t size = non_empty_data.size();
+
+    if (max_threads > 1 && size > 2)
+    {
+        /// At every level, the state `i + step` is merged into the state `i`, each merge writes to its own state and arena.
+        for (size_t step = 1; step < size; step *= 2)
+        {
+            size_t merges = (size - step + 2 * step - 1) / (2 * step);
+            auto thread_pool = newThreadPoolManager(std::min(max_threads, merges));
+            for (size_t result_num = 0; result_num + step < size; result_num += 2 * step)
+            {
+                thread_pool->schedule(true, [this, &res = *non_empty_data[result_num], &current = *non_empty_data[result_num + step]] {
+                    mergeWithoutKeyStates(res, current);
+                });
+            }
+            thread_pool->wait();
+        }
+        return;
     }
+
+    /// We merge all aggregation results to the first.
+    for (size_t result_num = 1; result_num < size; ++result_num)
+        mergeWithoutKeyStates(*non_empty_data[0], *non_empty_data[result_num]);
 }
 
 
@@ -1444,6 +1482,8 @@ void NO_INLINE Aggregator::mergeBucketImpl(
     Int32 bucket,
     Arena * arena) const
 {
+    HugePages::Scope huge_pages_scope;
+
     /// We merge all aggregation results to the first.
     AggregatedDataVariantsPtr & res = data[0];
     for (size_t result_num = 1, size = data.size(); result_num < size; ++result_num)
@@ -1499,7 +1539,14 @@ public:
         /// We need to wait for threads to finish before destructor of 'parallel_merge_data',
         ///  because the threads access 'parallel_merge_data'.
         if (parallel_merge_data && parallel_merge_data->thread_pool)
+        {
+            {
+                std::lock_guard lock(parallel_merge_data->mutex);
+                parallel_merge_data->stopped = true;
+            }
+            parallel_merge_data->condvar.notify_all();
             parallel_merge_data->thread_pool->wait();
+        }
     }
 
 protected:
@@ -1521,7 +1568,7 @@ protected:
 
             if (first->type == AggregatedDataVariants::Type::without_key || aggregator.params.overflow_row)
             {
-                aggregator.mergeWithoutKeyDataImpl(data);
+                aggregator.mergeWithoutKeyDataImpl(data, threads);
                 return aggregator.prepareBlockAndFillWithoutKey(
                     *first,
                     final,
@@ -1557,7 +1604,7 @@ protected:
             {
                 parallel_merge_data = std::make_unique<ParallelMergeData>(threads);
                 for (size_t i = 0; i < threads; ++i)
-                    scheduleThreadForNextBucket();
+                    parallel_merge_data->thread_pool->schedule(true, [this, i] { thread(i); });
             }
 
             Block res;
@@ -1573,15 +1620,19 @@ protected:
                 if (it != parallel_merge_data->ready_blocks.end())
                 {
                     ++current_bucket_num;
-                    scheduleThreadForNextBucket();
+                    Block block = std::move(it->second);
+                    parallel_merge_data->ready_blocks.erase(it);
+                    /// Wake up the threads waiting for the consumption to catch up.
+                    parallel_merge_data->condvar.notify_all();
 
-                    if (it->second)
+                    if (block)
                     {
-                        res.swap(it->second);
+                        res.swap(block);
                         break;
                     }
                     else if (current_bucket_num >= NUM_BUCKETS)
                         break;
+                    continue;
                 }
 
                 parallel_merge_data->condvar.wait(lock);
@@ -1599,7 +1650,6 @@ private:
     size_t threads;
 
     std::atomic<Int32> current_bucket_num = -1;
-    std::atomic<Int32> max_scheduled_bucket_num = -1;
     static constexpr Int32 NUM_BUCKETS = 256;
 
     struct ParallelMergeData
@@ -1609,6 +1659,9 @@ private:
         std::mutex mutex;
         std::condition_variable condvar;
         std::shared_ptr<ThreadPoolManager> thread_pool;
+        /// The next bucket to be taken by an idle thread.
+        Int32 next_bucket_num = 0;
+        bool stopped = false;
 
         explicit ParallelMergeData(size_t threads)
             : thread_pool(newThreadPoolManager(threads))
@@ -1617,30 +1670,41 @@ private:
 
     std::unique_ptr<ParallelMergeData> parallel_merge_data;
 
-    void scheduleThreadForNextBucket()
-    {
-        int num = max_scheduled_bucket_num.fetch_add(1) + 1;
-        if (num >= NUM_BUCKETS)
-            return;
-
-        parallel_merge_data->thread_pool->schedule(true, [this, num] { thread(num); });
-    }
+    /// How many buckets the threads can merge ahead of the consumption, which bounds the memory of `ready_blocks`.
+    /// It is larger than `threads`, so that a big bucket doesn't keep the other threads idle.
+    Int32 maxBucketsAhead() const { return static_cast<Int32>(threads) * 2; }
 
-    void thread(Int32 bucket_num)
+    /// Every thread keeps taking the next unmerged bucket until all of them are taken,
+    /// so the threads that finish the small buckets take over the rest of the work.
+    void thread(size_t thread_number)
     {
-        try
+        auto & merged_data = *data[0];
+        auto method = merged_data.type;
+        /// Select Arena to avoid race conditions
+        Arena * arena = merged_data.aggregates_pools.at(thread_number).get();
+
+        while (true)
         {
-            /// TODO: add no_more_keys support maybe
+            Int32 bucket_num;
+            {
+                std::unique_lock lock(parallel_merge_data->mutex);
+                parallel_merge_data->condvar.wait(lock, [&] {
+                    return parallel_merge_data->stopped || parallel_merge_data->exception
+                        || parallel_merge_data->next_bucket_num >= NUM_BUCKETS
+                        || parallel_merge_data->next_bucket_num < current_bucket_num + maxBucketsAhead();
+                });
+                if (parallel_merge_data->stopped || parallel_merge_data->exception || parallel_merge_data->next_bucket_num >= NUM_BUCKETS)
+                    return;
+                bucket_num = parallel_merge_data->next_bucket_num++;
+            }
 
-            auto & merged_data = *data[0];
-            auto method = merged_data.type;
-            Block block;
+            try
+            {
+                /// TODO: add no_more_keys support maybe
 
-            /// Select Arena to avoid race conditions
-            size_t thread_number = static_cast<size_t>(bucket_num) % threads;
-            Arena * arena = merged_data.aggregates_pools.at(thread_number).get();
+                Block block;
 
-            if (false) {} // NOLINT
+                if (false) {} // NOLINT
 #define M(NAME)                                                                                               \
     else if (method == AggregatedDataVariants::Type::NAME)                                                    \
     {                                                                                                         \
@@ -1648,22 +1712,77 @@ private:
         block = aggregator.convertOneBucketToBlock(merged_data, *merged_data.NAME, arena, final, bucket_num); \
     }
 
-            APPLY_FOR_VARIANTS_TWO_LEVEL(M)
+                APPLY_FOR_VARIANTS_TWO_LEVEL(M)
 #undef M
 
-            std::lock_guard lock(parallel_merge_data->mutex);
-            parallel_merge_data->ready_blocks[bucket_num] = std::move(block);
+                std::lock_guard lock(parallel_merge_data->mutex);
+                parallel_merge_data->ready_blocks[bucket_num] = std::move(block);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(parallel_merge_data->mutex);
+                if (!parallel_merge_data->exception)
+                    parallel_merge_data->exception = std::current_exception();
+            }
+
+            parallel_merge_data->condvar.notify_all();
         }
-        catch (...)
+    }
+};
+
+
+void Aggregator::convertToTwoLevelForMerge(ManyAggregatedDataVariants & non_empty_data, size_t max_threads) const
+{
+    /// If at least one of the options is two-level, then convert all the options into two-level ones, if there are not such.
+    /// Note - perhaps it would be more optimal not to convert single-level versions before the merge, but merge them separately, at the end.
+
+    bool has_at_least_one_two_level = false;
+    for (const auto & variant : non_empty_data)
+    {
+        if (variant->isTwoLevel())
         {
-            std::lock_guard lock(parallel_merge_data->mutex);
-            if (!parallel_merge_data->exception)
-                parallel_merge_data->exception = std::current_exception();
+            has_at_least_one_two_level = true;
+            break;
         }
+    }
 
-        parallel_merge_data->condvar.notify_all();
+    /// Each thread only checks its own size against `group_by_two_level_threshold`, so many mid-sized single-level
+    /// results could be left, which are merged into the first one by a single thread. Convert them too when they
+    /// are large enough in total, so that they are merged bucket by bucket in parallel.
+    if (!has_at_least_one_two_level && max_threads > 1 && non_empty_data.size() > 1
+        && params.group_by_two_level_threshold && non_empty_data[0]->isConvertibleToTwoLevel())
+    {
+        size_t total_size = 0;
+        for (const auto & variant : non_empty_data)
+            total_size += variant->sizeWithoutOverflowRow();
+        if (total_size >= params.group_by_two_level_threshold)
+        {
+            LOG_FMT_TRACE(log, "Converting {} single-level aggregation data of {} rows in total to two-level for parallel merge", non_empty_data.size(), total_size);
+            has_at_least_one_two_level = true;
+        }
     }
-};
+
+    if (!has_at_least_one_two_level)
+        return;
+
+    ManyAggregatedDataVariants to_convert;
+    for (auto & variant : non_empty_data)
+        if (!variant->isTwoLevel())
+            to_convert.push_back(variant);
+
+    if (max_threads > 1 && to_convert.size() > 1)
+    {
+        auto thread_pool = newThreadPoolManager(std::min(max_threads, to_convert.size()));
+        for (auto & variant : to_convert)
+            thread_pool->schedule(true, [&variant] { variant->convertToTwoLevel(); });
+        thread_pool->wait();
+    }
+    else
+    {
+        for (auto & variant : to_convert)
+            variant->convertToTwoLevel();
+    }
+}
 
 
 std::unique_ptr<IBlockInputStream> Aggregator::mergeAndConvertToBlocks(
@@ -1693,23 +1812,7 @@ std::unique_ptr<IBlockInputStream> Aggregator::mergeAndConvertToBlocks(
         });
     }
 
-    /// If at least one of the options is two-level, then convert all the options into two-level ones, if there are not such.
-    /// Note - perhaps it would be more optimal not to convert single-level versions before the merge, but merge them separately, at the end.
-
-    bool has_at_least_one_two_level = false;
-    for (const auto & variant : non_empty_data)
-    {
-        if (variant->isTwoLevel())
-        {
-            has_at_least_one_two_level = true;
-            break;
-        }
-    }
-
-    if (has_at_least_one_two_level)
-        for (auto & variant : non_empty_data)
-            if (!variant->isTwoLevel())
-                variant->convertToTwoLevel();
+    convertToTwoLevelForMerge(non_empty_data, max_threads);
 
     AggregatedDataVariantsPtr & first = non_empty_data[0];
 
@@ -1754,23 +1857,7 @@ ManyAggregatedDataVariants Aggregator::prepareVariantsToMerge(ManyAggregatedData
         });
     }
 
-    /// If at least one of the options is two-level, then convert all the options into two-level ones, if there are not such.
-    /// Note - perhaps it would be more optimal not to convert single-level versions before the merge, but merge them separately, at the end.
-
-    bool has_at_least_one_two_level = false;
-    for (const auto & variant : non_empty_data)
-    {
-        if (variant->isTwoLevel())
-        {
-            has_at_least_one_two_level = true;
-            break;
-        }
-    }
-
-    if (has_at_least_one_two_level)
-        for (auto & variant : non_empty_data)
-            if (!variant->isTwoLevel())
-                variant->convertToTwoLevel();
+    convertToTwoLevelForMerge(non_empty_data, 1);
 
     AggregatedDataVariantsPtr & first = non_empty_data[0];
 
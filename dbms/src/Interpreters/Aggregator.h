@@ -535,6 +535,38 @@ struct AggregatedDataVariants : private boost::noncopyable
         type = type_;
     }
 
+    template <typename Data>
+    static auto reserveImpl(Data & data, size_t num_keys, int) -> decltype(data.reserve(num_keys), void())
+    {
+        data.reserve(num_keys);
+    }
+    /// The fixed and two-level tables can not be reserved.
+    template <typename Data>
+    static void reserveImpl(Data &, size_t, long)
+    {}
+
+    /// Reserve the hash table for `num_keys` keys ahead, only the single-level tables that can grow support it.
+    void reserve(size_t num_keys)
+    {
+        switch (type)
+        {
+        case Type::EMPTY:
+            break;
+        case Type::without_key:
+            break;
+
+#define M(NAME, IS_TWO_LEVEL)                 \
+    case Type::NAME:                          \
+        reserveImpl(NAME->data, num_keys, 0); \
+        break;
+            APPLY_FOR_AGGREGATED_VARIANTS(M)
+#undef M
+
+        default:
+            throw Exception("Unknown aggregated data variant.", ErrorCodes::UNKNOWN_AGGREGATED_DATA_VARIANT);
+        }
+    }
+
     /// Number of rows (different keys).
     size_t size() const
     {
@@ -737,6 +769,9 @@ public:
 
         TiDB::TiDBCollators collators;
 
+        /// Reserve the single-level hash table for so many keys ahead, 0 means growing on demand.
+        size_t reserve_keys_hint = 0;
+
         Params(
             const Block & src_header_,
             const ColumnNumbers & keys_,
@@ -826,6 +861,10 @@ public:
 
     ManyAggregatedDataVariants prepareVariantsToMerge(ManyAggregatedDataVariants & data_variants) const;
 
+    /// Convert all the non-empty data to two-level if any of them is two-level, or if they are large enough in total
+    /// to be worth merging in parallel by `max_threads` threads.
+    void convertToTwoLevelForMerge(ManyAggregatedDataVariants & non_empty_data, size_t max_threads) const;
+
     /** Merge several aggregation data structures and output the result as a block stream.
       */
     std::unique_ptr<IBlockInputStream> mergeAndConvertToBlocks(ManyAggregatedDataVariants & data_variants, bool final, size_t max_threads) const;
@@ -1002,8 +1041,14 @@ protected:
         Table & table_src,
         Arena * arena) const;
 
+    /// Merge the states into the first one. With `max_threads` > 1, the states are merged pairwise in a tree,
+    /// the merges at the same level run in parallel, so the states expensive to merge, e.g. the exact sets of
+    /// `uniqExact`, are not merged all by one thread.
     void mergeWithoutKeyDataImpl(
-        ManyAggregatedDataVariants & non_empty_data) const;
+        ManyAggregatedDataVariants & non_empty_data,
+        size_t max_threads = 1) const;
+
+    void mergeWithoutKeyStates(AggregatedDataVariants & res, AggregatedDataVariants & current) const;
 
     template <typename Method>
     void mergeSingleLevelDataImpl(
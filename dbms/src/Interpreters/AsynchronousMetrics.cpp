@@ -21,6 +21,7 @@
 #include <IO/UncompressedCache.h>
 #include <Interpreters/AsynchronousMetrics.h>
 #include <Storages/DeltaMerge/DeltaMergeStore.h>
+#include <Storages/DeltaMerge/ReadThread/SegmentReader.h>
 #include <Storages/DeltaMerge/StoragePool.h>
 #include <Storages/MarkCache.h>
 #include <Storages/Page/FileUsage.h>
@@ -28,8 +29,10 @@
 #include <Storages/Transaction/KVStore.h>
 #include <Storages/Transaction/TMTContext.h>
 #include <common/config_common.h>
+#include <fmt/core.h>
 
 #include <chrono>
+#include <fstream>
 
 #if USE_JEMALLOC
 #include <jemalloc/jemalloc.h>
@@ -177,7 +180,11 @@ void AsynchronousMetrics::update()
 
                 if (auto dt_storage = std::dynamic_pointer_cast<StorageDeltaMerge>(table); dt_storage)
                 {
-                    auto stat = dt_storage->getStore()->getStat();
+                    // Do not create the store of the table that has not been accessed yet.
+                    auto store = dt_storage->getStoreIfInited();
+                    if (!store)
+                        continue;
+                    auto stat = store->getSnapshotStat();
                     calculateMax(max_dt_stable_oldest_snapshot_lifetime, stat.storage_stable_oldest_snapshot_lifetime);
                     calculateMax(max_dt_delta_oldest_snapshot_lifetime, stat.storage_delta_oldest_snapshot_lifetime);
                     calculateMax(max_dt_meta_oldest_snapshot_lifetime, stat.storage_meta_oldest_snapshot_lifetime);
@@ -192,6 +199,18 @@ void AsynchronousMetrics::update()
         set("MaxDTBackgroundTasksLength", max_dt_background_tasks_length);
     }
 
+    {
+        // The utilization of read threads of each NUMA node
+        auto stats = DM::SegmentReaderPoolManager::instance().getPoolStats();
+        for (size_t i = 0; i < stats.size(); ++i)
+        {
+            set(fmt::format("ReadThreadNode{}ActiveReaders", i), stats[i].active_readers);
+            set(fmt::format("ReadThreadNode{}PendingTasks", i), stats[i].pending_tasks);
+            set(fmt::format("ReadThreadNode{}Concurrency", i), stats[i].concurrency);
+            set(fmt::format("ReadThreadNode{}Utilization", i), stats[i].concurrency == 0 ? 0.0 : static_cast<double>(stats[i].active_readers) / stats[i].concurrency);
+        }
+    }
+
     {
         const FileUsageStatistics usage = getPageStorageFileUsage();
         set("BlobFileNums", usage.total_file_num);
@@ -255,6 +274,23 @@ void AsynchronousMetrics::update()
 #endif
 
 
+#ifdef __linux__
+    {
+        /// The memory of this process that is backed by transparent huge pages.
+        std::ifstream smaps("/proc/self/smaps_rollup");
+        std::string line;
+        while (std::getline(smaps, line))
+        {
+            static const std::string anon_huge_pages = "AnonHugePages:";
+            if (line.compare(0, anon_huge_pages.size(), anon_huge_pages) == 0)
+            {
+                set("AnonHugePagesBytes", std::stoull(line.substr(anon_huge_pages.size())) * 1024);
+                break;
+            }
+        }
+    }
+#endif
+
     /// Add more metrics as you wish.
     set("mmap.alive", DB::allocator_mmap_counter.load(std::memory_order_relaxed));
 }
@@ -0,0 +1,132 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
+#include <Common/typeid_cast.h>
+#include <Interpreters/CollatorSortKeys.h>
+
+#include <array>
+#include <cstring>
+
+
+namespace DB
+{
+namespace
+{
+/// Direct-mapped, so a lookup is one hash and one comparison.
+constexpr size_t sort_key_cache_size = 256;
+/// The cache is given up for the rest of the block if less than a quarter of these rows hit it.
+constexpr size_t sort_key_cache_probe_rows = 1024;
+
+struct SortKeyCacheEntry
+{
+    StringRef value;
+    size_t sort_key_offset = 0;
+    size_t sort_key_size = 0;
+    bool used = false;
+};
+
+ColumnPtr materializeStringSortKeys(const ColumnString & column, const TiDB::TiDBCollatorPtr & collator)
+{
+    const auto & chars = column.getChars();
+    const auto & offsets = column.getOffsets();
+    const size_t rows = offsets.size();
+
+    auto res = ColumnString::create();
+    auto & res_chars = res->getChars();
+    auto & res_offsets = res->getOffsets();
+    res_chars.reserve(chars.size());
+    res_offsets.resize(rows);
+
+    std::array<SortKeyCacheEntry, sort_key_cache_size> cache{};
+    bool use_cache = true;
+    size_t hits = 0;
+    String sort_key_container;
+
+    auto append = [&](const char * data, size_t size) {
+        size_t old_size = res_chars.size();
+        res_chars.resize(old_size + size + 1);
+        memcpy(&res_chars[old_size], data, size);
+        res_chars[old_size + size] = 0;
+        return old_size;
+    };
+
+    IColumn::Offset prev_offset = 0;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        /// Remove the last zero byte.
+        StringRef value(&chars[prev_offset], offsets[i] - prev_offset - 1);
+        prev_offset = offsets[i];
+
+        if (use_cache && i == sort_key_cache_probe_rows && hits * 4 < sort_key_cache_probe_rows)
+            use_cache = false;
+
+        SortKeyCacheEntry * entry = nullptr;
+        if (use_cache)
+        {
+            entry = &cache[StringRefHash()(value) % sort_key_cache_size];
+            if (entry->used && entry->value == value)
+            {
+                ++hits;
+                /// The cached sort key is before the end, append it by its offset since `res_chars` may be reallocated.
+                size_t old_size = res_chars.size();
+                res_chars.resize(old_size + entry->sort_key_size + 1);
+                memcpy(&res_chars[old_size], &res_chars[entry->sort_key_offset], entry->sort_key_size + 1);
+                res_offsets[i] = res_chars.size();
+                continue;
+            }
+        }
+
+        auto sort_key = collator->sortKey(value.data, value.size, sort_key_container);
+        size_t sort_key_offset = append(sort_key.data, sort_key.size);
+        res_offsets[i] = res_chars.size();
+        if (entry)
+            *entry = SortKeyCacheEntry{value, sort_key_offset, sort_key.size, true};
+    }
+    return res;
+}
+} // namespace
+
+ColumnPtr materializeSortKeys(const IColumn & column, const TiDB::TiDBCollatorPtr & collator)
+{
+    if (const auto * column_nullable = typeid_cast<const ColumnNullable *>(&column))
+    {
+        auto nested = materializeSortKeys(column_nullable->getNestedColumn(), collator);
+        if (!nested)
+            return nullptr;
+        return ColumnNullable::create(nested, column_nullable->getNullMapColumnPtr());
+    }
+    if (const auto * column_string = typeid_cast<const ColumnString *>(&column))
+        return materializeStringSortKeys(*column_string, collator);
+    return nullptr;
+}
+
+void materializeSortKeys(ColumnRawPtrs & key_columns, TiDB::TiDBCollators & collators, Columns & materialized_columns)
+{
+    for (size_t i = 0; i < key_columns.size() && i < collators.size(); ++i)
+    {
+        if (collators[i] == nullptr || !collators[i]->isCI())
+            continue;
+        if (ColumnPtr sort_keys = materializeSortKeys(*key_columns[i], collators[i]))
+        {
+            materialized_columns.push_back(sort_keys);
+            key_columns[i] = materialized_columns.back().get();
+            collators[i] = nullptr;
+        }
+    }
+}
+
+} // namespace DB
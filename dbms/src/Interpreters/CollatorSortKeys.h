@@ -0,0 +1,37 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Columns/IColumn.h>
+#include <Storages/Transaction/Collator.h>
+
+
+namespace DB
+{
+/** Returns the sort keys of a collated ColumnString, or Nullable of it, as a ColumnString.
+  * A few recent values and their sort keys are remembered, so the repeated values of a low
+  * cardinality column are not converted again. Returns nullptr for the other columns.
+  */
+ColumnPtr materializeSortKeys(const IColumn & column, const TiDB::TiDBCollatorPtr & collator);
+
+/** Replace the string key_columns with a ci collator by their sort keys, computed once per block,
+  * and reset their collators, so that the hash methods use the sort keys directly instead of
+  * converting every row. The binary collators are left as they are, their sort keys only trim the tail spaces.
+  * The replaced key columns are owned by materialized_columns.
+  */
+void materializeSortKeys(ColumnRawPtrs & key_columns, TiDB::TiDBCollators & collators, Columns & materialized_columns);
+
+} // namespace DB
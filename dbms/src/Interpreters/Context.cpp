@@ -17,6 +17,7 @@
 #include <Common/FailPoint.h>
 #include <Common/FmtUtils.h>
 #include <Common/Macros.h>
+#include <Common/MemoryArbiter.h>
 #include <Common/Stopwatch.h>
 #include <Common/TiFlashMetrics.h>
 #include <Common/escapeForFileName.h>
@@ -29,7 +30,9 @@
 #include <Encryption/FileProvider.h>
 #include <Encryption/RateLimiter.h>
 #include <Flash/Coprocessor/DAGContext.h>
+#include <Flash/Coprocessor/TableScanColumnsCache.h>
 #include <IO/ReadBufferFromFile.h>
+#include <IO/DecompressedBlockCache.h>
 #include <IO/UncompressedCache.h>
 #include <Interpreters/Context.h>
 #include <Interpreters/EmbeddedDictionaries.h>
@@ -52,6 +55,7 @@
 #include <Poco/UUID.h>
 #include <Storages/BackgroundProcessingPool.h>
 #include <Storages/DeltaMerge/DeltaIndexManager.h>
+#include <Storages/DeltaMerge/Index/BloomFilterIndex.h>
 #include <Storages/DeltaMerge/Index/MinMaxIndex.h>
 #include <Storages/DeltaMerge/StoragePool.h>
 #include <Storages/IStorage.h>
@@ -69,6 +73,7 @@
 
 #include <boost/functional/hash/hash.hpp>
 #include <pcg_random.hpp>
+#include <optional>
 #include <set>
 #include <unordered_map>
 
@@ -144,7 +149,10 @@ struct ContextShared
     mutable UncompressedCachePtr uncompressed_cache; /// The cache of decompressed blocks.
     mutable DBGInvoker dbg_invoker; /// Execute inner functions, debug only.
     mutable MarkCachePtr mark_cache; /// Cache of marks in compressed files.
+    mutable DecompressedBlockCachePtr decompressed_block_cache; /// Cache of decompressed blocks of the hot columns in DTFiles.
+    TableScanColumnsCachePtr table_scan_columns_cache; /// Cache of the columns read by the table scans in coprocessor requests.
     mutable DM::MinMaxIndexCachePtr minmax_index_cache; /// Cache of minmax index in compressed files.
+    mutable DM::BloomFilterIndexCachePtr bloom_filter_index_cache; /// Cache of bloom filter index in DTFiles.
     mutable DM::DeltaIndexManagerPtr delta_index_manager; /// Manage the Delta Indies of Segments.
     ProcessList process_list; /// Executing queries at the moment.
     ViewDependencies view_dependencies; /// Current dependencies
@@ -1316,6 +1324,25 @@ DAGContext * Context::getDAGContext() const
     return dag_context;
 }
 
+/// Register the cache to `MemoryArbiter`, so that it can be evicted under memory pressure.
+template <typename Cache, typename GetBytes>
+static void registerCacheToMemoryArbiter(const String & name, const std::shared_ptr<Cache> & cache, GetBytes get_bytes)
+{
+    std::weak_ptr<Cache> weak_cache = cache;
+    MemoryArbiter::instance().registerCache(
+        name,
+        [weak_cache, get_bytes]() -> size_t {
+            if (auto c = weak_cache.lock(); c)
+                return std::invoke(get_bytes, *c);
+            return 0;
+        },
+        [weak_cache](size_t bytes) -> size_t {
+            if (auto c = weak_cache.lock(); c)
+                return c->evict(bytes);
+            return 0;
+        });
+}
+
 void Context::setUncompressedCache(size_t max_size_in_bytes)
 {
     auto lock = getLock();
@@ -1324,6 +1351,7 @@ void Context::setUncompressedCache(size_t max_size_in_bytes)
         throw Exception("Uncompressed cache has been already created.", ErrorCodes::LOGICAL_ERROR);
 
     shared->uncompressed_cache = std::make_shared<UncompressedCache>(max_size_in_bytes);
+    registerCacheToMemoryArbiter("UncompressedCache", shared->uncompressed_cache, &UncompressedCache::weight);
 }
 
 
@@ -1362,6 +1390,7 @@ void Context::setMarkCache(size_t cache_size_in_bytes)
         throw Exception("Mark cache has been already created.", ErrorCodes::LOGICAL_ERROR);
 
     shared->mark_cache = std::make_shared<MarkCache>(cache_size_in_bytes, std::chrono::seconds(settings.mark_cache_min_lifetime));
+    registerCacheToMemoryArbiter("MarkCache", shared->mark_cache, &MarkCache::weight);
 }
 
 
@@ -1379,6 +1408,46 @@ void Context::dropMarkCache() const
         shared->mark_cache->reset();
 }
 
+void Context::setDecompressedBlockCache(size_t cache_size_in_bytes)
+{
+    auto lock = getLock();
+
+    if (shared->decompressed_block_cache)
+        throw Exception("Decompressed block cache has been already created.", ErrorCodes::LOGICAL_ERROR);
+
+    shared->decompressed_block_cache = std::make_shared<DecompressedBlockCache>(cache_size_in_bytes);
+    registerCacheToMemoryArbiter("DecompressedBlockCache", shared->decompressed_block_cache, &DecompressedBlockCache::weight);
+}
+
+DecompressedBlockCachePtr Context::getDecompressedBlockCache() const
+{
+    auto lock = getLock();
+    return shared->decompressed_block_cache;
+}
+
+void Context::dropDecompressedBlockCache() const
+{
+    auto lock = getLock();
+    if (shared->decompressed_block_cache)
+        shared->decompressed_block_cache->reset();
+}
+
+void Context::setTableScanColumnsCache(size_t max_entries)
+{
+    auto lock = getLock();
+
+    if (shared->table_scan_columns_cache)
+        throw Exception("Table scan columns cache has been already created.", ErrorCodes::LOGICAL_ERROR);
+
+    shared->table_scan_columns_cache = std::make_shared<TableScanColumnsCache>(max_entries);
+}
+
+TableScanColumnsCachePtr Context::getTableScanColumnsCache() const
+{
+    auto lock = getLock();
+    return shared->table_scan_columns_cache;
+}
+
 
 void Context::setMinMaxIndexCache(size_t cache_size_in_bytes)
 {
@@ -1388,6 +1457,7 @@ void Context::setMinMaxIndexCache(size_t cache_size_in_bytes)
         throw Exception("Minmax index cache has been already created.", ErrorCodes::LOGICAL_ERROR);
 
     shared->minmax_index_cache = std::make_shared<DM::MinMaxIndexCache>(cache_size_in_bytes, std::chrono::seconds(settings.mark_cache_min_lifetime));
+    registerCacheToMemoryArbiter("MinMaxIndexCache", shared->minmax_index_cache, &DM::MinMaxIndexCache::weight);
 }
 
 DM::MinMaxIndexCachePtr Context::getMinMaxIndexCache() const
@@ -1403,6 +1473,30 @@ void Context::dropMinMaxIndexCache() const
         shared->minmax_index_cache->reset();
 }
 
+void Context::setBloomFilterIndexCache(size_t cache_size_in_bytes)
+{
+    auto lock = getLock();
+
+    if (shared->bloom_filter_index_cache)
+        throw Exception("Bloom filter index cache has been already created.", ErrorCodes::LOGICAL_ERROR);
+
+    shared->bloom_filter_index_cache = std::make_shared<DM::BloomFilterIndexCache>(cache_size_in_bytes, std::chrono::seconds(settings.mark_cache_min_lifetime));
+    registerCacheToMemoryArbiter("BloomFilterIndexCache", shared->bloom_filter_index_cache, &DM::BloomFilterIndexCache::weight);
+}
+
+DM::BloomFilterIndexCachePtr Context::getBloomFilterIndexCache() const
+{
+    auto lock = getLock();
+    return shared->bloom_filter_index_cache;
+}
+
+void Context::dropBloomFilterIndexCache() const
+{
+    auto lock = getLock();
+    if (shared->bloom_filter_index_cache)
+        shared->bloom_filter_index_cache->reset();
+}
+
 bool Context::isDeltaIndexLimited() const
 {
     // Don't need to use a lock here, as delta_index_manager should be set at starting up.
@@ -1419,6 +1513,7 @@ void Context::setDeltaIndexManager(size_t cache_size_in_bytes)
         throw Exception("DeltaIndexManager has been already created.", ErrorCodes::LOGICAL_ERROR);
 
     shared->delta_index_manager = std::make_shared<DM::DeltaIndexManager>(cache_size_in_bytes);
+    registerCacheToMemoryArbiter("DeltaIndexManager", shared->delta_index_manager, &DM::DeltaIndexManager::currentSize);
 }
 
 DM::DeltaIndexManagerPtr Context::getDeltaIndexManager() const
@@ -1544,8 +1639,26 @@ void Context::initializeRateLimiter(Poco::Util::AbstractConfiguration & config,
     getIORateLimiter().setBackgroundThreadIds(tids);
 }
 
+namespace
+{
+// The I/O class of the queries with `settings`, std::nullopt if the I/O classes are not used.
+std::optional<IOClass> getIOClass(const Settings & settings)
+{
+    const String & group = settings.io_scheduling_group;
+    if (group.empty() && settings.priority == 0)
+        return std::nullopt;
+
+    UInt64 weight = settings.io_scheduling_weight;
+    if (settings.priority > 0)
+        weight /= settings.priority;
+    return IOClass{fmt::format("{}#{}", group, settings.priority), std::max<UInt64>(weight, 1)};
+}
+} // namespace
+
 WriteLimiterPtr Context::getWriteLimiter() const
 {
+    if (auto io_class = getIOClass(settings); io_class)
+        return getIORateLimiter().getWriteLimiter(*io_class);
     return getIORateLimiter().getWriteLimiter();
 }
 
@@ -1556,6 +1669,8 @@ IORateLimiter & Context::getIORateLimiter() const
 
 ReadLimiterPtr Context::getReadLimiter() const
 {
+    if (auto io_class = getIOClass(settings); io_class)
+        return getIORateLimiter().getReadLimiter(*io_class);
     return getIORateLimiter().getReadLimiter();
 }
 
@@ -54,6 +54,8 @@ class BackgroundProcessingPool;
 class MergeList;
 class MarkCache;
 class UncompressedCache;
+class DecompressedBlockCache;
+class TableScanColumnsCache;
 class DBGInvoker;
 class TMTContext;
 using TMTContextPtr = std::shared_ptr<TMTContext>;
@@ -102,6 +104,7 @@ enum class PageStorageRunMode : UInt8;
 namespace DM
 {
 class MinMaxIndexCache;
+class BloomFilterIndexCache;
 class DeltaIndexManager;
 class GlobalStoragePool;
 using GlobalStoragePoolPtr = std::shared_ptr<GlobalStoragePool>;
@@ -360,10 +363,22 @@ public:
     std::shared_ptr<MarkCache> getMarkCache() const;
     void dropMarkCache() const;
 
+    /// Create a cache of decompressed blocks of the hot columns in DTFiles. This can be done only once.
+    void setDecompressedBlockCache(size_t cache_size_in_bytes);
+    std::shared_ptr<DecompressedBlockCache> getDecompressedBlockCache() const;
+    void dropDecompressedBlockCache() const;
+
+    void setTableScanColumnsCache(size_t max_entries);
+    std::shared_ptr<TableScanColumnsCache> getTableScanColumnsCache() const;
+
     void setMinMaxIndexCache(size_t cache_size_in_bytes);
     std::shared_ptr<DM::MinMaxIndexCache> getMinMaxIndexCache() const;
     void dropMinMaxIndexCache() const;
 
+    void setBloomFilterIndexCache(size_t cache_size_in_bytes);
+    std::shared_ptr<DM::BloomFilterIndexCache> getBloomFilterIndexCache() const;
+    void dropBloomFilterIndexCache() const;
+
     bool isDeltaIndexLimited() const;
     void setDeltaIndexManager(size_t cache_size_in_bytes);
     std::shared_ptr<DM::DeltaIndexManager> getDeltaIndexManager() const;
@@ -20,10 +20,13 @@
 #include <DataTypes/DataTypeArray.h>
 #include <DataTypes/DataTypeNullable.h>
 #include <Functions/FunctionFactory.h>
+#include <Functions/FunctionFusedPredicate.h>
 #include <Functions/IFunction.h>
 #include <Interpreters/ExpressionActions.h>
+#include <Interpreters/FunctionShortCircuitLogical.h>
 #include <Interpreters/Join.h>
 
+#include <functional>
 #include <optional>
 #include <set>
 
@@ -931,6 +934,319 @@ std::string ExpressionActions::dumpActions() const
 void ExpressionActions::optimize()
 {
     optimizeArrayJoin();
+    if (settings.enable_expression_fusion)
+        fusePredicates();
+    if (settings.enable_short_circuit_evaluation)
+        shortCircuitLogicalFunctions();
+}
+
+void ExpressionActions::fusePredicates()
+{
+    using NodeType = FunctionFusedPredicate::NodeType;
+
+    auto get_node_type = [](const ExpressionAction & action) -> std::optional<NodeType> {
+        if (action.type != ExpressionAction::APPLY_FUNCTION || !action.function || action.collator)
+            return std::nullopt;
+        return FunctionFusedPredicate::getNodeType(action.function->getName(), action.function->getArgumentTypes());
+    };
+
+    /// A function can be absorbed into its parent only if nothing else reads its result.
+    std::unordered_map<String, size_t> reads;
+    std::unordered_map<String, size_t> producers;
+    for (size_t i = 0; i < actions.size(); ++i)
+    {
+        const auto & action = actions[i];
+        if (action.type != ExpressionAction::REMOVE_COLUMN)
+        {
+            for (const auto & name : action.getNeededColumns())
+                ++reads[name];
+        }
+        if (action.type == ExpressionAction::APPLY_FUNCTION)
+            producers[action.result_name] = i;
+    }
+    for (const auto & column : sample_block)
+        ++reads[column.name];
+
+    std::vector<bool> erased(actions.size(), false);
+    std::vector<Actions> moved_after(actions.size());
+    NameSet fused_columns;
+
+    for (int root = static_cast<int>(actions.size()) - 1; root >= 0; --root)
+    {
+        if (erased[root] || !get_node_type(actions[root]))
+            continue;
+
+        std::vector<FunctionFusedPredicate::Node> nodes;
+        Names inputs;
+        std::unordered_map<String, size_t> input_positions;
+        std::vector<size_t> absorbed;
+
+        /// Returns the position of the node of the column in `nodes`.
+        std::function<size_t(const String &, size_t)> build = [&](const String & name, size_t consumer) -> size_t {
+            auto it = producers.find(name);
+            std::optional<NodeType> node_type;
+            if (it != producers.end() && it->second < consumer && !erased[it->second] && reads[name] == 1)
+                node_type = get_node_type(actions[it->second]);
+
+            FunctionFusedPredicate::Node node;
+            if (!node_type)
+            {
+                node.type = NodeType::Input;
+                auto [input_it, inserted] = input_positions.emplace(name, inputs.size());
+                if (inserted)
+                    inputs.push_back(name);
+                node.argument = input_it->second;
+            }
+            else
+            {
+                size_t position = it->second;
+                absorbed.push_back(position);
+                node.type = *node_type;
+                for (const auto & argument : actions[position].argument_names)
+                    node.children.push_back(build(argument, position));
+            }
+            nodes.push_back(std::move(node));
+            return nodes.size() - 1;
+        };
+
+        const auto & root_action = actions[root];
+        FunctionFusedPredicate::Node root_node;
+        root_node.type = *get_node_type(root_action);
+        for (const auto & argument : root_action.argument_names)
+            root_node.children.push_back(build(argument, root));
+        nodes.push_back(std::move(root_node));
+
+        if (absorbed.empty())
+            continue;
+
+        /// Do not move the leaves over the actions that change the set of rows or columns.
+        size_t begin = *std::min_element(absorbed.begin(), absorbed.end());
+        bool has_barrier = false;
+        for (size_t i = begin; i < static_cast<size_t>(root); ++i)
+        {
+            if (actions[i].type == ExpressionAction::PROJECT || actions[i].type == ExpressionAction::ARRAY_JOIN || actions[i].type == ExpressionAction::JOIN)
+                has_barrier = true;
+        }
+        if (has_barrier)
+            continue;
+
+        /// The types of the inputs are the argument types of the functions reading them.
+        DataTypes input_types(inputs.size());
+        auto fill_input_types = [&](const ExpressionAction & action) {
+            const auto & argument_types = action.function->getArgumentTypes();
+            for (size_t i = 0; i < action.argument_names.size(); ++i)
+            {
+                if (auto it = input_positions.find(action.argument_names[i]); it != input_positions.end())
+                    input_types[it->second] = argument_types[i];
+            }
+        };
+        fill_input_types(root_action);
+        for (auto position : absorbed)
+            fill_input_types(actions[position]);
+
+        for (auto position : absorbed)
+        {
+            erased[position] = true;
+            fused_columns.insert(actions[position].result_name);
+        }
+
+        /// The leaves may be removed right after the absorbed functions, keep them until the fused one.
+        for (size_t i = begin; i < static_cast<size_t>(root); ++i)
+        {
+            if (!erased[i] && actions[i].type == ExpressionAction::REMOVE_COLUMN && input_positions.count(actions[i].source_name))
+            {
+                erased[i] = true;
+                moved_after[root].push_back(actions[i]);
+            }
+        }
+
+        auto function = std::make_shared<FunctionFusedPredicate>(std::move(nodes), input_types, root_action.result_type);
+        ExpressionAction & fused = actions[root];
+        fused.function_builder = nullptr;
+        fused.function = std::make_shared<DefaultFunctionBase>(function, input_types, fused.result_type);
+        fused.argument_names = std::move(inputs);
+    }
+
+    if (fused_columns.empty())
+        return;
+
+    removeAbsorbedActions(erased, moved_after, fused_columns);
+}
+
+void ExpressionActions::removeAbsorbedActions(const std::vector<bool> & erased, std::vector<Actions> & moved_after, const NameSet & absorbed_columns)
+{
+    Actions new_actions;
+    new_actions.reserve(actions.size());
+    for (size_t i = 0; i < actions.size(); ++i)
+    {
+        if (erased[i])
+            continue;
+        /// The absorbed columns are never materialized.
+        if (actions[i].type == ExpressionAction::REMOVE_COLUMN && absorbed_columns.count(actions[i].source_name))
+            continue;
+        new_actions.push_back(std::move(actions[i]));
+        for (auto & action : moved_after[i])
+            new_actions.push_back(std::move(action));
+    }
+    actions.swap(new_actions);
+}
+
+void ExpressionActions::shortCircuitLogicalFunctions()
+{
+    auto is_bool = [](const DataTypePtr & type) {
+        return removeNullable(type)->getTypeId() == TypeIndex::UInt8;
+    };
+    auto is_logical_root = [&](const ExpressionAction & action) {
+        if (action.type != ExpressionAction::APPLY_FUNCTION || !action.function || action.argument_names.size() < 2)
+            return false;
+        const auto & name = action.function->getName();
+        if ((name != "and" && name != "or") || !is_bool(action.result_type))
+            return false;
+        const auto & argument_types = action.function->getArgumentTypes();
+        return std::all_of(argument_types.begin(), argument_types.end(), is_bool);
+    };
+
+    /// A function can be moved into a term only if nothing else reads its result.
+    std::unordered_map<String, size_t> reads;
+    std::unordered_map<String, size_t> producers;
+    for (size_t i = 0; i < actions.size(); ++i)
+    {
+        const auto & action = actions[i];
+        if (action.type != ExpressionAction::REMOVE_COLUMN)
+        {
+            for (const auto & name : action.getNeededColumns())
+                ++reads[name];
+        }
+        if (action.type == ExpressionAction::APPLY_FUNCTION)
+            producers[action.result_name] = i;
+    }
+    for (const auto & column : sample_block)
+        ++reads[column.name];
+
+    std::vector<bool> erased(actions.size(), false);
+    std::vector<Actions> moved_after(actions.size());
+    NameSet absorbed_columns;
+
+    for (int root = static_cast<int>(actions.size()) - 1; root >= 0; --root)
+    {
+        if (erased[root] || !is_logical_root(actions[root]))
+            continue;
+
+        const auto & root_action = actions[root];
+        const auto & root_argument_types = root_action.function->getArgumentTypes();
+
+        Names argument_names;
+        DataTypes argument_types;
+        std::unordered_map<String, size_t> argument_positions;
+        auto add_argument = [&](const String & name, const DataTypePtr & type) {
+            auto [it, inserted] = argument_positions.emplace(name, argument_names.size());
+            if (inserted)
+            {
+                argument_names.push_back(name);
+                argument_types.push_back(type);
+            }
+            return it->second;
+        };
+
+        std::vector<FunctionShortCircuitLogical::Term> terms;
+        std::vector<size_t> absorbed;
+        for (size_t t = 0; t < root_action.argument_names.size(); ++t)
+        {
+            const auto & term_name = root_action.argument_names[t];
+            FunctionShortCircuitLogical::Term term;
+            term.result_name = term_name;
+
+            /// The first term is always computed on all the rows.
+            std::vector<size_t> term_absorbed;
+            NamesAndTypesList inputs;
+            NameSet input_names;
+            std::function<void(const String &, const DataTypePtr &, size_t)> collect = [&](const String & name, const DataTypePtr & type, size_t consumer) {
+                auto it = producers.find(name);
+                if (it != producers.end() && it->second < consumer && !erased[it->second] && reads[name] == 1)
+                {
+                    size_t position = it->second;
+                    term_absorbed.push_back(position);
+                    const auto & action = actions[position];
+                    const auto & types = action.function->getArgumentTypes();
+                    for (size_t i = 0; i < action.argument_names.size(); ++i)
+                        collect(action.argument_names[i], types[i], position);
+                }
+                else if (input_names.insert(name).second)
+                    inputs.emplace_back(name, type);
+            };
+            if (t > 0)
+                collect(term_name, root_argument_types[t], root);
+
+            if (term_absorbed.empty() || inputs.empty())
+            {
+                term.argument = add_argument(term_name, root_argument_types[t]);
+                terms.push_back(std::move(term));
+                continue;
+            }
+
+            std::sort(term_absorbed.begin(), term_absorbed.end());
+            auto term_actions = std::make_shared<ExpressionActions>(inputs, settings);
+            for (auto position : term_absorbed)
+                term_actions->actions.push_back(actions[position]);
+            /// The term is the only output of its actions.
+            term_actions->sample_block = Block{{nullptr, actions[term_absorbed.back()].result_type, term_name}};
+
+            for (const auto & input : inputs)
+                term.input_arguments.push_back(add_argument(input.name, input.type));
+            term.actions = std::move(term_actions);
+            terms.push_back(std::move(term));
+            absorbed.insert(absorbed.end(), term_absorbed.begin(), term_absorbed.end());
+        }
+
+        if (absorbed.empty())
+            continue;
+
+        /// Do not move the actions over the actions that change the set of rows or columns.
+        size_t begin = *std::min_element(absorbed.begin(), absorbed.end());
+        bool has_barrier = false;
+        for (size_t i = begin; i < static_cast<size_t>(root); ++i)
+        {
+            if (actions[i].type == ExpressionAction::PROJECT || actions[i].type == ExpressionAction::ARRAY_JOIN || actions[i].type == ExpressionAction::JOIN)
+                has_barrier = true;
+        }
+        if (has_barrier)
+            continue;
+
+        for (auto position : absorbed)
+        {
+            erased[position] = true;
+            absorbed_columns.insert(actions[position].result_name);
+        }
+
+        /// The inputs of the terms may be removed right after the moved actions, keep them until the root.
+        for (size_t i = begin; i < static_cast<size_t>(root); ++i)
+        {
+            if (!erased[i] && actions[i].type == ExpressionAction::REMOVE_COLUMN && argument_positions.count(actions[i].source_name))
+            {
+                erased[i] = true;
+                moved_after[root].push_back(actions[i]);
+            }
+        }
+
+        /// The terms may have nested and / or themselves.
+        for (auto & term : terms)
+        {
+            if (term.actions)
+                term.actions->shortCircuitLogicalFunctions();
+        }
+
+        bool is_and = root_action.function->getName() == "and";
+        auto function = std::make_shared<FunctionShortCircuitLogical>(is_and, std::move(terms), root_action.result_type);
+        ExpressionAction & short_circuit = actions[root];
+        short_circuit.function_builder = nullptr;
+        short_circuit.function = std::make_shared<DefaultFunctionBase>(function, argument_types, short_circuit.result_type);
+        short_circuit.argument_names = std::move(argument_names);
+    }
+
+    if (absorbed_columns.empty())
+        return;
+
+    removeAbsorbedActions(erased, moved_after, absorbed_columns);
 }
 
 void ExpressionActions::optimizeArrayJoin()
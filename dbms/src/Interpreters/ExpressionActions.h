@@ -230,6 +230,12 @@ private:
     void optimize();
     /// Move all arrayJoin as close as possible to the end.
     void optimizeArrayJoin();
+    /// Replace the trees of numeric comparisons and logical functions by FunctionFusedPredicate.
+    void fusePredicates();
+    /// Replace `and` / `or` by FunctionShortCircuitLogical, moving the actions computing their terms into it.
+    void shortCircuitLogicalFunctions();
+    /// Drop the actions absorbed by an optimization, and the removals of the columns they produced.
+    void removeAbsorbedActions(const std::vector<bool> & erased, std::vector<Actions> & moved_after, const NameSet & absorbed_columns);
 };
 
 using ExpressionActionsPtr = std::shared_ptr<ExpressionActions>;
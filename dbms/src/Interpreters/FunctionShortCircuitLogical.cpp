@@ -0,0 +1,144 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <Interpreters/ExpressionActions.h>
+#include <Interpreters/FunctionShortCircuitLogical.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+} // namespace ErrorCodes
+
+namespace
+{
+/** The state of every row is (value, is_null). A row is decided once it holds the dominant value
+  * of the function, i.e. false for `and` and true for `or`, the other terms can not change it.
+  */
+inline bool isDecided(bool is_and, UInt8 value, UInt8 is_null)
+{
+    return !is_null && value != static_cast<UInt8>(is_and);
+}
+
+/// Merges the term evaluated on the rows selected by `selection` (all the rows if it is nullptr) into the state.
+void mergeTerm(
+    bool is_and,
+    const IColumn & term,
+    const IColumn::Filter * selection,
+    PaddedPODArray<UInt8> & values,
+    PaddedPODArray<UInt8> & nulls)
+{
+    const NullMap * null_map = nullptr;
+    const IColumn * nested = &term;
+    if (const auto * nullable = typeid_cast<const ColumnNullable *>(&term))
+    {
+        null_map = &nullable->getNullMapData();
+        nested = &nullable->getNestedColumn();
+    }
+    const auto * term_values = typeid_cast<const ColumnUInt8 *>(nested);
+    if (term_values == nullptr)
+        throw Exception("Unexpected column " + term.getName() + " of the term of " + String(FunctionShortCircuitLogical::name), ErrorCodes::LOGICAL_ERROR);
+    const auto & term_data = term_values->getData();
+
+    const auto dominant = static_cast<UInt8>(!is_and);
+    size_t rows = values.size();
+    for (size_t i = 0, k = 0; i < rows; ++i)
+    {
+        if (selection != nullptr && !(*selection)[i])
+            continue;
+        bool term_is_null = null_map != nullptr && (*null_map)[k];
+        UInt8 term_value = term_data[k] != 0;
+        ++k;
+
+        if (term_is_null)
+        {
+            if (!isDecided(is_and, values[i], nulls[i]))
+                nulls[i] = 1;
+        }
+        else if (term_value == dominant)
+        {
+            values[i] = dominant;
+            nulls[i] = 0;
+        }
+    }
+}
+} // namespace
+
+FunctionShortCircuitLogical::FunctionShortCircuitLogical(bool is_and_, std::vector<Term> terms_, DataTypePtr return_type_)
+    : is_and(is_and_)
+    , terms(std::move(terms_))
+    , return_type(std::move(return_type_))
+{
+    if (terms.empty() || terms[0].actions != nullptr)
+        throw Exception("The first term of " + getName() + " must be an argument", ErrorCodes::LOGICAL_ERROR);
+}
+
+void FunctionShortCircuitLogical::executeImpl(Block & block, const ColumnNumbers & arguments, size_t result) const
+{
+    size_t rows = block.rows();
+
+    auto col_values = ColumnUInt8::create(rows, static_cast<UInt8>(is_and));
+    auto col_nulls = ColumnUInt8::create(rows, 0);
+    auto & values = col_values->getData();
+    auto & nulls = col_nulls->getData();
+
+    IColumn::Filter alive(rows);
+    for (const auto & term : terms)
+    {
+        if (term.actions == nullptr)
+        {
+            auto column = block.getByPosition(arguments[term.argument]).column->convertToFullColumnIfConst();
+            mergeTerm(is_and, *column, nullptr, values, nulls);
+            continue;
+        }
+
+        size_t alive_rows = 0;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            alive[i] = !isDecided(is_and, values[i], nulls[i]);
+            alive_rows += alive[i];
+        }
+        /// All the rows are decided, skip the rest terms.
+        if (alive_rows == 0)
+            break;
+
+        bool filter = alive_rows != rows;
+        Block term_block;
+        for (auto position : term.input_arguments)
+        {
+            const auto & input = block.getByPosition(arguments[position]);
+            term_block.insert({filter ? input.column->filter(alive, alive_rows) : input.column, input.type, input.name});
+        }
+        term.actions->execute(term_block);
+
+        auto column = term_block.getByName(term.result_name).column->convertToFullColumnIfConst();
+        mergeTerm(is_and, *column, filter ? &alive : nullptr, values, nulls);
+    }
+
+    if (return_type->isNullable())
+    {
+        for (size_t i = 0; i < rows; ++i)
+            values[i] &= !nulls[i];
+        block.getByPosition(result).column = ColumnNullable::create(std::move(col_values), std::move(col_nulls));
+    }
+    else
+        block.getByPosition(result).column = std::move(col_values);
+}
+
+} // namespace DB
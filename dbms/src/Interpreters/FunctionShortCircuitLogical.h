@@ -0,0 +1,76 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Functions/IFunction.h>
+
+namespace DB
+{
+class ExpressionActions;
+using ExpressionActionsPtr = std::shared_ptr<ExpressionActions>;
+
+/** Evaluates `and` / `or` of UInt8 terms, computing every term after the first one only on the rows
+  * whose result is not decided yet.
+  *
+  * ExpressionActions computes every argument of `a and b and c` over the whole block before combining
+  * them, even if `a` is false for almost all the rows. Here the actions computing `b` and `c` are moved
+  * into the function: their inputs are filtered by the rows still alive, the actions are executed on
+  * the filtered block and the result is merged back. The result follows the three-valued logic of
+  * `and` and `or`.
+  *
+  * It is not registered in FunctionFactory, ExpressionActions builds it from the actions it replaces.
+  */
+class FunctionShortCircuitLogical : public IFunction
+{
+public:
+    static constexpr auto name = "shortCircuitLogical";
+
+    struct Term
+    {
+        /// The actions computing the term, nullptr if the term is an argument of the function.
+        ExpressionActionsPtr actions;
+        /// The position of the computed term in the arguments, if `actions` is nullptr.
+        size_t argument = 0;
+        /// The positions of the inputs of the actions in the arguments.
+        std::vector<size_t> input_arguments;
+        String result_name;
+    };
+
+    /// The first term is always an argument of the function.
+    FunctionShortCircuitLogical(bool is_and_, std::vector<Term> terms_, DataTypePtr return_type_);
+
+    String getName() const override { return name; }
+
+    bool isVariadic() const override { return true; }
+    size_t getNumberOfArguments() const override { return 0; }
+
+    bool useDefaultImplementationForNulls() const override { return false; }
+    bool useDefaultImplementationForConstants() const override { return false; }
+
+    DataTypePtr getReturnTypeImpl(const DataTypes &) const override { return return_type; }
+
+    void executeImpl(Block & block, const ColumnNumbers & arguments, size_t result) const override;
+
+    bool isAnd() const { return is_and; }
+    const std::vector<Term> & getTerms() const { return terms; }
+
+private:
+    bool is_and;
+    std::vector<Term> terms;
+    DataTypePtr return_type;
+};
+
+} // namespace DB
@@ -1178,6 +1178,7 @@ void InterpreterSelectQuery::executeOrder(Pipeline & pipeline)
         limit,
         settings.max_bytes_before_external_sort,
         context.getTemporaryPath(),
+        context.getFileProvider(),
         /*req_id=*/"");
 }
 
@@ -16,17 +16,33 @@
 #include <Columns/ColumnFixedString.h>
 #include <Columns/ColumnNullable.h>
 #include <Columns/ColumnString.h>
+#include <Columns/ColumnsCommon.h>
+#include <Common/ClickHouseRevision.h>
 #include <Common/ColumnsHashing.h>
 #include <Common/FailPoint.h>
+#include <Common/HugePages.h>
+#include <Common/MemoryTracker.h>
+#include <Common/Stopwatch.h>
+#include <Common/ThreadManager.h>
+#include <Common/TiFlashMetrics.h>
 #include <Common/typeid_cast.h>
 #include <Core/ColumnNumbers.h>
 #include <DataStreams/IProfilingBlockInputStream.h>
+#include <DataStreams/NativeBlockInputStream.h>
+#include <DataStreams/NativeBlockOutputStream.h>
+#include <DataStreams/NullBlockInputStream.h>
 #include <DataStreams/materializeBlock.h>
 #include <DataTypes/DataTypeNullable.h>
 #include <DataTypes/DataTypesNumber.h>
+#include <Encryption/ReadBufferFromFileProvider.h>
+#include <Encryption/WriteBufferFromFileProvider.h>
 #include <Functions/FunctionHelpers.h>
+#include <IO/CompressedReadBuffer.h>
+#include <IO/CompressedWriteBuffer.h>
+#include <Interpreters/CollatorSortKeys.h>
 #include <Interpreters/Join.h>
 #include <Interpreters/NullableUtils.h>
+#include <Poco/TemporaryFile.h>
 #include <common/logger_useful.h>
 
 
@@ -90,6 +106,18 @@ void convertColumnToNullable(ColumnWithTypeAndName & column)
         column.column = makeNullable(column.column);
 }
 
+/// The build block reduced to its key columns, for the existence-only joins.
+Block getKeyColumnsBlock(const Names & key_names, const Block & block)
+{
+    Block res;
+    for (const auto & name : key_names)
+    {
+        if (!res.has(name))
+            res.insert(block.getByName(name));
+    }
+    return res;
+}
+
 ColumnRawPtrs getKeyColumns(const Names & key_names, const Block & block)
 {
     size_t keys_size = key_names.size();
@@ -162,6 +190,124 @@ Join::Join(
         throw Exception("Not supported: non right join with right conditions");
 }
 
+/// A partition of the build or probe rows that is spilled into a temporary file.
+/// `write` could be called from different threads in parallel, while `finishWrite` and `read` are called only once.
+class Join::SpilledPartition
+{
+public:
+    SpilledPartition(const String & spill_path_, const FileProviderPtr & file_provider_)
+        : spill_path(spill_path_)
+        , file_provider(file_provider_)
+    {}
+
+    ~SpilledPartition()
+    {
+        block_in.reset();
+        compressed_in.reset();
+        file_in.reset();
+        if (file)
+            file_provider->deleteRegularFile(file->path(), EncryptionPath(file->path(), ""));
+    }
+
+    void write(const Block & block)
+    {
+        std::lock_guard lock(mutex);
+        if (!block_out)
+        {
+            file = std::make_unique<Poco::TemporaryFile>(spill_path);
+            const auto & path = file->path();
+            file_buf = std::make_unique<WriteBufferFromFileProvider>(file_provider, path, EncryptionPath(path, ""));
+            compressed_buf = std::make_unique<CompressedWriteBuffer>(*file_buf);
+            block_out = std::make_shared<NativeBlockOutputStream>(*compressed_buf, ClickHouseRevision::get(), block.cloneEmpty());
+        }
+        block_out->write(block);
+        rows += block.rows();
+    }
+
+    void finishWrite()
+    {
+        std::lock_guard lock(mutex);
+        if (!block_out)
+            return;
+        block_out->flush();
+        compressed_buf->next();
+        file_buf->next();
+        spilled_bytes = file_buf->count();
+        GET_METRIC(tiflash_spilled_bytes, type_join).Increment(spilled_bytes);
+        block_out.reset();
+        compressed_buf.reset();
+        file_buf.reset();
+    }
+
+    /// Return nullptr if nothing is written.
+    BlockInputStreamPtr read()
+    {
+        if (!file)
+            return nullptr;
+        const auto & path = file->path();
+        file_in = std::make_unique<ReadBufferFromFileProvider>(file_provider, path, EncryptionPath(path, ""));
+        compressed_in = std::make_unique<CompressedReadBuffer<>>(*file_in);
+        block_in = std::make_shared<NativeBlockInputStream>(*compressed_in, ClickHouseRevision::get());
+        return block_in;
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getSpilledBytes() const { return spilled_bytes; }
+
+private:
+    const String spill_path;
+    const FileProviderPtr file_provider;
+
+    std::mutex mutex;
+    std::unique_ptr<Poco::TemporaryFile> file;
+    std::unique_ptr<WriteBufferFromFileProvider> file_buf;
+    std::unique_ptr<CompressedWriteBuffer> compressed_buf;
+    BlockOutputStreamPtr block_out;
+    size_t rows = 0;
+    size_t spilled_bytes = 0;
+
+    std::unique_ptr<ReadBufferFromFileProvider> file_in;
+    std::unique_ptr<CompressedReadBuffer<>> compressed_in;
+    BlockInputStreamPtr block_in;
+};
+
+Join::~Join()
+{
+    if (memory_arbiter_id)
+        MemoryArbiter::instance().unregister(memory_arbiter_id);
+}
+
+void Join::setSpillConfig(size_t max_bytes_before_external_join_, size_t spill_partition_num_, const String & spill_path_, const FileProviderPtr & file_provider_)
+{
+    if (unlikely(initialized))
+        throw Exception("Logical error: `setSpillConfig` should be called before `init`", ErrorCodes::LOGICAL_ERROR);
+    max_bytes_before_external_join = max_bytes_before_external_join_;
+    spill_partition_num = spill_partition_num_;
+    spill_path = spill_path_;
+    file_provider = file_provider_;
+    if (!isSpillEnabled())
+        return;
+    for (size_t i = 0; i < spill_partition_num; ++i)
+    {
+        build_partitions.push_back(std::make_unique<SpilledPartition>(spill_path, file_provider));
+        probe_partitions.push_back(std::make_unique<SpilledPartition>(spill_path, file_provider));
+    }
+    memory_arbiter_id = MemoryArbiter::instance().registerSpillable(
+        "Join",
+        [this]() -> size_t { return spill_triggered.load() || spill_requested.load() ? 0 : getTotalByteCount(); },
+        [this]() { spill_requested.store(true); });
+}
+
+bool Join::isSpillEnabled() const
+{
+    return max_bytes_before_external_join > 0 && spill_partition_num > 0 && !isCrossJoin(kind);
+}
+
+bool Join::isPartitionedBuild() const
+{
+    return partitioned_build && build_concurrency > 1 && !isCrossJoin(kind) && !isSpillEnabled();
+}
+
 void Join::setBuildTableState(BuildTableState state_)
 {
     std::lock_guard lk(build_table_mutex);
@@ -169,6 +315,41 @@ void Join::setBuildTableState(BuildTableState state_)
     build_table_cv.notify_all();
 }
 
+void Join::cancelBuildIfWaiting()
+{
+    std::lock_guard lk(build_table_mutex);
+    if (build_table_state == BuildTableState::WAITING)
+    {
+        build_table_state = BuildTableState::FAILED;
+        build_table_cv.notify_all();
+    }
+}
+
+void Join::addProbePrefetcher(std::function<void()> && start_prefetch)
+{
+    std::lock_guard lk(build_table_mutex);
+    probe_prefetchers.push_back(std::move(start_prefetch));
+}
+
+void Join::startProbePrefetch()
+{
+    std::vector<std::function<void()>> prefetchers;
+    {
+        std::lock_guard lk(build_table_mutex);
+        prefetchers.swap(probe_prefetchers);
+    }
+    for (auto & start_prefetch : prefetchers)
+        start_prefetch();
+}
+
+void Join::waitBuildTableFinished() const
+{
+    std::unique_lock lk(build_table_mutex);
+    build_table_cv.wait(lk, [&]() { return build_table_state != BuildTableState::WAITING; });
+    if (build_table_state == BuildTableState::FAILED) /// throw this exception once failed to build the hash table
+        throw Exception("Build failed before join probe!");
+}
+
 
 Join::Type Join::chooseMethod(const ColumnRawPtrs & key_columns, Sizes & key_sizes)
 {
@@ -208,7 +389,9 @@ Join::Type Join::chooseMethod(const ColumnRawPtrs & key_columns, Sizes & key_siz
         throw Exception("Logical error: numeric column has sizeOfField not in 1, 2, 4, 8, 16.", ErrorCodes::LOGICAL_ERROR);
     }
 
-    /// If the keys fit in N bits, we will use a hash table for N-bit-packed keys
+    /// If the keys fit in N bits, we will use a hash table for N-bit-packed keys.
+    /// The nullable keys are passed as their nested columns (see `getKeyColumns`), and the rows with any null key
+    /// are filtered by the null map since they never match, so there is no need to pack the null bitmap.
     if (all_fixed && keys_bytes <= 16)
         return Type::keys128;
     if (all_fixed && keys_bytes <= 32)
@@ -229,7 +412,7 @@ Join::Type Join::chooseMethod(const ColumnRawPtrs & key_columns, Sizes & key_siz
 
 
 template <typename Maps>
-static void initImpl(Maps & maps, Join::Type type, size_t build_concurrency)
+static void initImpl(Maps & maps, Join::Type type, size_t build_concurrency, size_t reserve_rows_per_segment)
 {
     switch (type)
     {
@@ -240,7 +423,9 @@ static void initImpl(Maps & maps, Join::Type type, size_t build_concurrency)
 
 #define M(TYPE)                                                                                      \
     case Join::Type::TYPE:                                                                           \
-        maps.TYPE = std::make_unique<typename decltype(maps.TYPE)::element_type>(build_concurrency); \
+        maps.TYPE = std::make_unique<typename decltype(maps.TYPE)::element_type>(                    \
+            build_concurrency,                                                                       \
+            reserve_rows_per_segment);                                                               \
         break;
         APPLY_FOR_JOIN_VARIANTS(M)
 #undef M
@@ -359,19 +544,26 @@ void Join::initMapImpl(Type type_)
     if (isCrossJoin(kind))
         return;
 
-    if (!getFullness(kind))
+    /// The rows are distributed to the segments by hash, so each segment takes its share of the hint.
+    /// Don't reserve again after spilling, the build data lives on disk then.
+    size_t build_concurrency = getBuildConcurrencyInternal();
+    size_t reserve_rows_per_segment = spill_triggered.load() ? 0 : build_rows_hint / build_concurrency;
+
+    if (existence_only)
+        initImpl(maps_existence, type, build_concurrency, reserve_rows_per_segment);
+    else if (!getFullness(kind))
     {
         if (strictness == ASTTableJoin::Strictness::Any)
-            initImpl(maps_any, type, getBuildConcurrencyInternal());
+            initImpl(maps_any, type, build_concurrency, reserve_rows_per_segment);
         else
-            initImpl(maps_all, type, getBuildConcurrencyInternal());
+            initImpl(maps_all, type, build_concurrency, reserve_rows_per_segment);
     }
     else
     {
         if (strictness == ASTTableJoin::Strictness::Any)
-            initImpl(maps_any_full, type, getBuildConcurrencyInternal());
+            initImpl(maps_any_full, type, build_concurrency, reserve_rows_per_segment);
         else
-            initImpl(maps_all_full, type, getBuildConcurrencyInternal());
+            initImpl(maps_all_full, type, build_concurrency, reserve_rows_per_segment);
     }
 }
 
@@ -390,6 +582,7 @@ size_t Join::getTotalRowCount() const
         res += getTotalRowCountImpl(maps_all, type);
         res += getTotalRowCountImpl(maps_any_full, type);
         res += getTotalRowCountImpl(maps_all_full, type);
+        res += getTotalRowCountImpl(maps_existence, type);
     }
 
     return res;
@@ -410,6 +603,7 @@ size_t Join::getTotalByteCount() const
         res += getTotalByteCountImpl(maps_all, type);
         res += getTotalByteCountImpl(maps_any_full, type);
         res += getTotalByteCountImpl(maps_all_full, type);
+        res += getTotalByteCountImpl(maps_existence, type);
         for (const auto & pool : pools)
         {
             /// note the return value might not be accurate since it does not use lock, but should be enough for current usage
@@ -428,6 +622,8 @@ void Join::setBuildConcurrencyAndInitPool(size_t build_concurrency_)
 
     for (size_t i = 0; i < getBuildConcurrencyInternal(); ++i)
         pools.emplace_back(std::make_shared<Arena>());
+    if (isPartitionedBuild())
+        scattered_blocks.resize(getBuildConcurrencyInternal());
     // init for non-joined-streams.
     if (getFullness(kind))
     {
@@ -479,9 +675,17 @@ void Join::init(const Block & sample_block, size_t build_concurrency_)
         throw Exception("Logical error: Join has been initialized", ErrorCodes::LOGICAL_ERROR);
     initialized = true;
     setBuildConcurrencyAndInitPool(build_concurrency_);
+    /// The inner join with strictness ANY is a semi join if it outputs no build column.
+    bool only_key_columns = std::all_of(sample_block.begin(), sample_block.end(), [&](const auto & column) {
+        return std::find(key_names_right.begin(), key_names_right.end(), column.name) != key_names_right.end();
+    });
+    existence_only = strictness == ASTTableJoin::Strictness::Any && !isSpillEnabled()
+        && (kind == ASTTableJoin::Kind::Anti || kind == ASTTableJoin::Kind::LeftSemi || kind == ASTTableJoin::Kind::LeftAnti
+            || (kind == ASTTableJoin::Kind::Inner && only_key_columns));
     /// Choose data structure to use for JOIN.
     initMapImpl(chooseMethod(getKeyColumns(key_names_right, sample_block), key_sizes));
     setSampleBlock(sample_block);
+    build_sample_block = sample_block.cloneEmpty();
 }
 
 
@@ -507,8 +711,18 @@ struct Inserter<ASTTableJoin::Strictness::Any, Map, KeyGetter>
 {
     static void insert(Map & map, KeyGetter & key_getter, Block * stored_block, size_t i, Arena & pool, std::vector<String> & sort_key_container)
     {
-        auto emplace_result = key_getter.emplaceKey(map, i, pool, sort_key_container);
+        insertResult(key_getter.emplaceKey(map, i, pool, sort_key_container), stored_block, i);
+    }
+
+    /// Use the hash value calculated when choosing the segment, so that the key is not hashed again.
+    static void insert(Map & map, KeyGetter & key_getter, Block * stored_block, size_t i, Arena & pool, std::vector<String> & sort_key_container, size_t hash_value)
+    {
+        insertResult(key_getter.emplaceKey(map, i, pool, sort_key_container, hash_value), stored_block, i);
+    }
 
+    template <typename EmplaceResult>
+    static void insertResult(EmplaceResult && emplace_result, Block * stored_block, size_t i)
+    {
         if (emplace_result.isInserted())
             new (&emplace_result.getMapped()) typename Map::mapped_type(stored_block, i);
     }
@@ -520,8 +734,18 @@ struct Inserter<ASTTableJoin::Strictness::All, Map, KeyGetter>
     using MappedType = typename Map::mapped_type;
     static void insert(Map & map, KeyGetter & key_getter, Block * stored_block, size_t i, Arena & pool, std::vector<String> & sort_key_container)
     {
-        auto emplace_result = key_getter.emplaceKey(map, i, pool, sort_key_container);
+        insertResult(key_getter.emplaceKey(map, i, pool, sort_key_container), stored_block, i, pool);
+    }
 
+    /// Use the hash value calculated when choosing the segment, so that the key is not hashed again.
+    static void insert(Map & map, KeyGetter & key_getter, Block * stored_block, size_t i, Arena & pool, std::vector<String> & sort_key_container, size_t hash_value)
+    {
+        insertResult(key_getter.emplaceKey(map, i, pool, sort_key_container, hash_value), stored_block, i, pool);
+    }
+
+    template <typename EmplaceResult>
+    static void insertResult(EmplaceResult && emplace_result, Block * stored_block, size_t i, Arena & pool)
+    {
         if (emplace_result.isInserted())
             new (&emplace_result.getMapped()) typename Map::mapped_type(stored_block, i);
         else
@@ -592,9 +816,10 @@ void NO_INLINE insertFromBlockImplTypeCaseWithLock(
     /// insert the rows segment by segment to avoid too much conflict. This will introduce some overheads:
     /// 1. key_getter.getKey will be called twice, here we do not cache key because it can not be cached
     /// with relatively low cost(if key is stringRef, just cache a stringRef is meaningless, we need to cache the whole `sort_key_containers`)
-    /// 2. hash value is calculated twice, maybe we can refine the code to cache the hash value
-    /// 3. extra memory to store the segment index info
+    /// 2. extra memory to store the segment index info and the hash values, the hash values are saved to avoid
+    /// hashing the keys twice, which is expensive for the string keys
     std::vector<std::vector<size_t>> segment_index_info;
+    std::vector<std::vector<size_t>> segment_hash_info(segment_size);
     if (has_null_map && rows_not_inserted_to_map)
     {
         segment_index_info.resize(segment_size + 1);
@@ -608,6 +833,10 @@ void NO_INLINE insertFromBlockImplTypeCaseWithLock(
     {
         segment_index.reserve(rows_per_seg);
     }
+    for (auto & segment_hash : segment_hash_info)
+    {
+        segment_hash.reserve(rows_per_seg);
+    }
     for (size_t i = 0; i < rows; i++)
     {
         if (has_null_map && (*null_map)[i])
@@ -619,13 +848,11 @@ void NO_INLINE insertFromBlockImplTypeCaseWithLock(
         auto key_holder = key_getter.getKeyHolder(i, &pool, sort_key_containers);
         auto key = keyHolderGetKey(key_holder);
         size_t segment_index = 0;
-        size_t hash_value = 0;
+        const size_t hash_value = map.hash(key);
         if (!ZeroTraits::check(key))
-        {
-            hash_value = map.hash(key);
             segment_index = hash_value % segment_size;
-        }
         segment_index_info[segment_index].push_back(i);
+        segment_hash_info[segment_index].push_back(hash_value);
         keyHolderDiscardKey(key_holder);
     }
     for (size_t insert_index = 0; insert_index < segment_index_info.size(); insert_index++)
@@ -648,7 +875,7 @@ void NO_INLINE insertFromBlockImplTypeCaseWithLock(
             std::lock_guard lk(map.getSegmentMutex(segment_index));
             for (size_t i = 0; i < segment_index_info[segment_index].size(); i++)
             {
-                Inserter<STRICTNESS, typename Map::SegmentType::HashTable, KeyGetter>::insert(map.getSegmentTable(segment_index), key_getter, stored_block, segment_index_info[segment_index][i], pool, sort_key_containers);
+                Inserter<STRICTNESS, typename Map::SegmentType::HashTable, KeyGetter>::insert(map.getSegmentTable(segment_index), key_getter, stored_block, segment_index_info[segment_index][i], pool, sort_key_containers, segment_hash_info[segment_index][i]);
             }
         }
     }
@@ -738,6 +965,184 @@ void insertFromBlockImpl(
         throw Exception("Unknown JOIN keys variant.", ErrorCodes::UNKNOWN_SET_DATA_VARIANT);
     }
 }
+
+/// For the partitioned build, only compute the segment of every row here. The rows are inserted by
+/// `insertScatteredRowsImplType` after all the build streams finish, so the segments needn't be locked.
+template <typename KeyGetter, typename Map, bool has_null_map>
+void NO_INLINE scatterBlockImplTypeCase(
+    Map & map,
+    size_t rows,
+    const ColumnRawPtrs & key_columns,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & collators,
+    Block * stored_block,
+    ConstNullMapPtr null_map,
+    Join::RowRefList * rows_not_inserted_to_map,
+    Join::ScatteredBlock & scattered_block,
+    Arena & pool)
+{
+    KeyGetter key_getter(key_columns, key_sizes, collators);
+    std::vector<std::string> sort_key_containers;
+    sort_key_containers.resize(key_columns.size());
+    size_t segment_size = map.getSegmentSize();
+    auto & rows_per_segment = scattered_block.rows_per_segment;
+    auto & hashes_per_segment = scattered_block.hashes_per_segment;
+    rows_per_segment.resize(segment_size);
+    hashes_per_segment.resize(segment_size);
+    for (size_t segment_index = 0; segment_index < segment_size; ++segment_index)
+    {
+        rows_per_segment[segment_index].reserve(rows / segment_size);
+        hashes_per_segment[segment_index].reserve(rows / segment_size);
+    }
+
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (has_null_map && (*null_map)[i])
+        {
+            /// for right/full out join, need to record the rows not inserted to map
+            if (rows_not_inserted_to_map)
+            {
+                auto * elem = reinterpret_cast<Join::RowRefList *>(pool.alloc(sizeof(Join::RowRefList)));
+                insertRowToList(rows_not_inserted_to_map, elem, stored_block, i);
+            }
+            continue;
+        }
+        auto key_holder = key_getter.getKeyHolder(i, &pool, sort_key_containers);
+        auto key = keyHolderGetKey(key_holder);
+        size_t segment_index = 0;
+        const size_t hash_value = map.hash(key);
+        if (!ZeroTraits::check(key))
+            segment_index = hash_value % segment_size;
+        rows_per_segment[segment_index].push_back(i);
+        hashes_per_segment[segment_index].push_back(hash_value);
+        keyHolderDiscardKey(key_holder);
+    }
+}
+
+template <typename KeyGetter, typename Map>
+void scatterBlockImplType(
+    Map & map,
+    size_t rows,
+    const ColumnRawPtrs & key_columns,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & collators,
+    Block * stored_block,
+    ConstNullMapPtr null_map,
+    Join::RowRefList * rows_not_inserted_to_map,
+    Join::ScatteredBlock & scattered_block,
+    Arena & pool)
+{
+    if (null_map)
+        scatterBlockImplTypeCase<KeyGetter, Map, true>(map, rows, key_columns, key_sizes, collators, stored_block, null_map, rows_not_inserted_to_map, scattered_block, pool);
+    else
+        scatterBlockImplTypeCase<KeyGetter, Map, false>(map, rows, key_columns, key_sizes, collators, stored_block, null_map, rows_not_inserted_to_map, scattered_block, pool);
+}
+
+template <typename Maps>
+void scatterBlockImpl(
+    Join::Type type,
+    Maps & maps,
+    size_t rows,
+    const ColumnRawPtrs & key_columns,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & collators,
+    Block * stored_block,
+    ConstNullMapPtr null_map,
+    Join::RowRefList * rows_not_inserted_to_map,
+    Join::ScatteredBlock & scattered_block,
+    Arena & pool)
+{
+    switch (type)
+    {
+    case Join::Type::EMPTY:
+        break;
+    case Join::Type::CROSS:
+        break;
+
+#define M(TYPE)                                                                                                                 \
+    case Join::Type::TYPE:                                                                                                      \
+        scatterBlockImplType<typename KeyGetterForType<Join::Type::TYPE, std::remove_reference_t<decltype(*maps.TYPE)>>::Type>( \
+            *maps.TYPE,                                                                                                         \
+            rows,                                                                                                               \
+            key_columns,                                                                                                        \
+            key_sizes,                                                                                                          \
+            collators,                                                                                                          \
+            stored_block,                                                                                                       \
+            null_map,                                                                                                           \
+            rows_not_inserted_to_map,                                                                                           \
+            scattered_block,                                                                                                    \
+            pool);                                                                                                              \
+        break;
+        APPLY_FOR_JOIN_VARIANTS(M)
+#undef M
+
+    default:
+        throw Exception("Unknown JOIN keys variant.", ErrorCodes::UNKNOWN_SET_DATA_VARIANT);
+    }
+}
+
+template <ASTTableJoin::Strictness STRICTNESS, typename KeyGetter, typename Map>
+void NO_INLINE insertScatteredRowsImplType(
+    Map & map,
+    size_t segment_index,
+    const std::vector<std::vector<Join::ScatteredBlock>> & scattered_blocks,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & /*collators*/,
+    Arena & pool)
+{
+    auto & segment_map = map.getSegmentTable(segment_index);
+    std::vector<std::string> sort_key_containers;
+    for (const auto & stream_scattered_blocks : scattered_blocks)
+    {
+        for (const auto & scattered_block : stream_scattered_blocks)
+        {
+            const auto & segment_rows = scattered_block.rows_per_segment[segment_index];
+            if (segment_rows.empty())
+                continue;
+            /// The ci collated keys may be materialized to sort keys already, see `insertFromBlockInternal`.
+            KeyGetter key_getter(scattered_block.key_columns, key_sizes, scattered_block.key_collators);
+            sort_key_containers.resize(scattered_block.key_columns.size());
+            const auto & segment_hashes = scattered_block.hashes_per_segment[segment_index];
+            for (size_t i = 0; i < segment_rows.size(); ++i)
+                Inserter<STRICTNESS, typename Map::SegmentType::HashTable, KeyGetter>::insert(segment_map, key_getter, scattered_block.stored_block, segment_rows[i], pool, sort_key_containers, segment_hashes[i]);
+        }
+    }
+}
+
+template <ASTTableJoin::Strictness STRICTNESS, typename Maps>
+void insertScatteredRowsImpl(
+    Join::Type type,
+    Maps & maps,
+    size_t segment_index,
+    const std::vector<std::vector<Join::ScatteredBlock>> & scattered_blocks,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & collators,
+    Arena & pool)
+{
+    switch (type)
+    {
+    case Join::Type::EMPTY:
+        break;
+    case Join::Type::CROSS:
+        break;
+
+#define M(TYPE)                                                                                                                                    \
+    case Join::Type::TYPE:                                                                                                                         \
+        insertScatteredRowsImplType<STRICTNESS, typename KeyGetterForType<Join::Type::TYPE, std::remove_reference_t<decltype(*maps.TYPE)>>::Type>( \
+            *maps.TYPE,                                                                                                                            \
+            segment_index,                                                                                                                         \
+            scattered_blocks,                                                                                                                      \
+            key_sizes,                                                                                                                             \
+            collators,                                                                                                                             \
+            pool);                                                                                                                                 \
+        break;
+        APPLY_FOR_JOIN_VARIANTS(M)
+#undef M
+
+    default:
+        throw Exception("Unknown JOIN keys variant.", ErrorCodes::UNKNOWN_SET_DATA_VARIANT);
+    }
+}
 } // namespace
 
 void recordFilteredRows(const Block & block, const String & filter_column, ColumnPtr & null_map_holder, ConstNullMapPtr & null_map)
@@ -789,7 +1194,10 @@ bool Join::insertFromBlock(const Block & block)
     if (unlikely(!initialized))
         throw Exception("Logical error: Join was not initialized", ErrorCodes::LOGICAL_ERROR);
     total_input_build_rows += block.rows();
-    blocks.push_back(block);
+    if (runtime_filter)
+        runtime_filter->insert(*block.getByName(key_names_right[0]).column);
+    /// `block` holds the key columns until they are inserted.
+    blocks.push_back(existence_only ? getKeyColumnsBlock(key_names_right, block) : block);
     Block * stored_block = &blocks.back();
     return insertFromBlockInternal(stored_block, 0);
 }
@@ -803,24 +1211,44 @@ void Join::insertFromBlock(const Block & block, size_t stream_index)
 
     if (unlikely(!initialized))
         throw Exception("Logical error: Join was not initialized", ErrorCodes::LOGICAL_ERROR);
+    if (runtime_filter)
+        runtime_filter->insert(*block.getByName(key_names_right[0]).column);
+    if (spill_triggered.load())
+    {
+        total_input_build_rows += block.rows();
+        spillBlock(block, key_names_right, build_partitions);
+        return;
+    }
     Block * stored_block = nullptr;
     {
         std::lock_guard lk(blocks_lock);
         total_input_build_rows += block.rows();
-        blocks.push_back(block);
+        blocks.push_back(existence_only ? getKeyColumnsBlock(key_names_right, block) : block);
         stored_block = &blocks.back();
-        original_blocks.push_back(block);
+        original_blocks.push_back(*stored_block);
     }
     if (build_set_exceeded.load())
         return;
     if (!insertFromBlockInternal(stored_block, stream_index))
     {
         build_set_exceeded.store(true);
+        return;
+    }
+    if (isSpillEnabled() && !spill_triggered.load() && (checkSpillThreshold() || !reserveBuildMemory()))
+    {
+        if (!spill_triggered.exchange(true))
+        {
+            LOG_FMT_INFO(log, "Memory usage of join build passes {} bytes or spilling is requested by memory arbiter, start spilling build data into {} partitions", max_bytes_before_external_join, spill_partition_num);
+            std::lock_guard lock(memory_reservation_mutex);
+            memory_reservation.reset();
+        }
     }
 }
 
 bool Join::insertFromBlockInternal(Block * stored_block, size_t stream_index)
 {
+    /// The maps of join are accessed randomly, prefer huge pages for them.
+    HugePages::Scope huge_pages_scope;
     size_t keys_size = key_names_right.size();
     ColumnRawPtrs key_columns(keys_size);
 
@@ -830,10 +1258,15 @@ bool Join::insertFromBlockInternal(Block * stored_block, size_t stream_index)
     /// Note: this variable can't be removed because it will take smart pointers' lifecycle to the end of this function.
     Columns materialized_columns;
 
+    /// The key columns are kept for the partitioned build, see `ScatteredBlock`.
+    Columns key_column_holders;
+
     /// Memoize key columns to work.
     for (size_t i = 0; i < keys_size; ++i)
     {
         key_columns[i] = block.getByName(key_names_right[i]).column.get();
+        if (isPartitionedBuild())
+            key_column_holders.push_back(block.getByName(key_names_right[i]).column);
 
         if (ColumnPtr converted = key_columns[i]->convertToFullColumnIfConst())
         {
@@ -850,6 +1283,10 @@ bool Join::insertFromBlockInternal(Block * stored_block, size_t stream_index)
     /// match the join filter will not insert to the maps
     recordFilteredRows(block, right_filter_column, null_map_holder, null_map);
 
+    /// Convert the ci collated keys to their sort keys once, instead of once per row in the key getters.
+    TiDB::TiDBCollators key_collators = collators;
+    materializeSortKeys(key_columns, key_collators, materialized_columns);
+
     size_t rows = block.rows();
 
     if (getFullness(kind))
@@ -893,22 +1330,53 @@ bool Join::insertFromBlockInternal(Block * stored_block, size_t stream_index)
         }
     }
 
+    if (!isCrossJoin(kind) && isPartitionedBuild())
+    {
+        auto & scattered_block = scattered_blocks[stream_index].emplace_back();
+        scattered_block.stored_block = stored_block;
+        key_column_holders.insert(key_column_holders.end(), materialized_columns.begin(), materialized_columns.end());
+        scattered_block.key_column_holders = std::move(key_column_holders);
+        scattered_block.key_columns = key_columns;
+        scattered_block.key_collators = key_collators;
+        Arena & pool = *pools[stream_index];
+        if (existence_only)
+            scatterBlockImpl(type, maps_existence, rows, key_columns, key_sizes, key_collators, stored_block, null_map, nullptr, scattered_block, pool);
+        else if (!getFullness(kind))
+        {
+            if (strictness == ASTTableJoin::Strictness::Any)
+                scatterBlockImpl(type, maps_any, rows, key_columns, key_sizes, key_collators, stored_block, null_map, nullptr, scattered_block, pool);
+            else
+                scatterBlockImpl(type, maps_all, rows, key_columns, key_sizes, key_collators, stored_block, null_map, nullptr, scattered_block, pool);
+        }
+        else
+        {
+            if (strictness == ASTTableJoin::Strictness::Any)
+                scatterBlockImpl(type, maps_any_full, rows, key_columns, key_sizes, key_collators, stored_block, null_map, rows_not_inserted_to_map[stream_index].get(), scattered_block, pool);
+            else
+                scatterBlockImpl(type, maps_all_full, rows, key_columns, key_sizes, key_collators, stored_block, null_map, rows_not_inserted_to_map[stream_index].get(), scattered_block, pool);
+        }
+        /// The maps are empty until `finishBuild`, the limits are checked there.
+        return true;
+    }
+
     if (!isCrossJoin(kind))
     {
         /// Fill the hash table.
-        if (!getFullness(kind))
+        if (existence_only)
+            insertFromBlockImpl<ASTTableJoin::Strictness::Any>(type, maps_existence, rows, key_columns, key_sizes, key_collators, stored_block, null_map, nullptr, stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
+        else if (!getFullness(kind))
         {
             if (strictness == ASTTableJoin::Strictness::Any)
-                insertFromBlockImpl<ASTTableJoin::Strictness::Any>(type, maps_any, rows, key_columns, key_sizes, collators, stored_block, null_map, nullptr, stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
+                insertFromBlockImpl<ASTTableJoin::Strictness::Any>(type, maps_any, rows, key_columns, key_sizes, key_collators, stored_block, null_map, nullptr, stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
             else
-                insertFromBlockImpl<ASTTableJoin::Strictness::All>(type, maps_all, rows, key_columns, key_sizes, collators, stored_block, null_map, nullptr, stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
+                insertFromBlockImpl<ASTTableJoin::Strictness::All>(type, maps_all, rows, key_columns, key_sizes, key_collators, stored_block, null_map, nullptr, stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
         }
         else
         {
             if (strictness == ASTTableJoin::Strictness::Any)
-                insertFromBlockImpl<ASTTableJoin::Strictness::Any>(type, maps_any_full, rows, key_columns, key_sizes, collators, stored_block, null_map, rows_not_inserted_to_map[stream_index].get(), stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
+                insertFromBlockImpl<ASTTableJoin::Strictness::Any>(type, maps_any_full, rows, key_columns, key_sizes, key_collators, stored_block, null_map, rows_not_inserted_to_map[stream_index].get(), stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
             else
-                insertFromBlockImpl<ASTTableJoin::Strictness::All>(type, maps_all_full, rows, key_columns, key_sizes, collators, stored_block, null_map, rows_not_inserted_to_map[stream_index].get(), stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
+                insertFromBlockImpl<ASTTableJoin::Strictness::All>(type, maps_all_full, rows, key_columns, key_sizes, key_collators, stored_block, null_map, rows_not_inserted_to_map[stream_index].get(), stream_index, getBuildConcurrencyInternal(), *pools[stream_index]);
         }
     }
 
@@ -944,8 +1412,12 @@ struct Adder<ASTTableJoin::Kind::Inner, ASTTableJoin::Strictness::Any, Map>
     {
         (*filter)[i] = 1;
 
-        for (size_t j = 0; j < num_columns_to_add; ++j)
-            added_columns[j]->insertFrom(*it->getMapped().block->getByPosition(right_indexes[j]).column.get(), it->getMapped().row_num);
+        /// the existence-only semi join adds no column
+        if constexpr (std::is_base_of_v<Join::RowRef, typename Map::mapped_type>)
+        {
+            for (size_t j = 0; j < num_columns_to_add; ++j)
+                added_columns[j]->insertFrom(*it->getMapped().block->getByPosition(right_indexes[j]).column.get(), it->getMapped().row_num);
+        }
     }
 
     static void addNotFound(size_t /*num_columns_to_add*/, MutableColumns & /*added_columns*/, size_t i, IColumn::Filter * filter, IColumn::Offset & /*current_offset*/, IColumn::Offsets * /*offsets*/)
@@ -1079,55 +1551,96 @@ void NO_INLINE joinBlockImplTypeCase(
     sort_key_containers.resize(key_columns.size());
     Arena pool;
 
-    for (size_t i = 0; i < rows; ++i)
-    {
-        if (has_null_map && (*null_map)[i])
+    using Key = typename Map::key_type;
+    auto add_not_found = [&](size_t i) {
+        Adder<KIND, STRICTNESS, Map>::addNotFound(
+            num_columns_to_add,
+            added_columns,
+            i,
+            filter.get(),
+            current_offset,
+            offsets_to_replicate.get());
+    };
+    auto locate = [&](const Key & key, size_t & segment_index, size_t & hash_value) {
+        segment_index = 0;
+        hash_value = 0;
+        if (map.getSegmentSize() > 0 && !ZeroTraits::check(key))
         {
-            Adder<KIND, STRICTNESS, Map>::addNotFound(
+            hash_value = map.hash(key);
+            segment_index = hash_value % map.getSegmentSize();
+        }
+    };
+    auto probe = [&](size_t i, const Key & key, size_t segment_index, size_t hash_value) {
+        auto & internal_map = map.getSegmentTable(segment_index);
+        /// do not require segment lock because in join, the hash table can not be changed in probe stage.
+        auto it = map.getSegmentSize() > 0 ? internal_map.find(key, hash_value) : internal_map.find(key);
+
+        if (it != internal_map.end())
+        {
+            it->getMapped().setUsed();
+            Adder<KIND, STRICTNESS, Map>::addFound(
+                it,
                 num_columns_to_add,
                 added_columns,
                 i,
                 filter.get(),
                 current_offset,
-                offsets_to_replicate.get());
+                offsets_to_replicate.get(),
+                right_indexes);
         }
         else
+            add_not_found(i);
+    };
+
+    if constexpr (!std::is_same_v<Key, StringRef>)
+    {
+        /// The keys of fixed size are plain values, so a batch of them are hashed ahead
+        /// and their cells are prefetched before being looked up one by one.
+        static constexpr size_t probe_batch_size = 16;
+        Key keys[probe_batch_size];
+        size_t segment_indexes[probe_batch_size];
+        size_t hash_values[probe_batch_size];
+        for (size_t batch_start = 0; batch_start < rows; batch_start += probe_batch_size)
         {
-            auto key_holder = key_getter.getKeyHolder(i, &pool, sort_key_containers);
-            auto key = keyHolderGetKey(key_holder);
-            size_t segment_index = 0;
-            size_t hash_value = 0;
-            if (map.getSegmentSize() > 0 && !ZeroTraits::check(key))
+            size_t batch_rows = std::min(probe_batch_size, rows - batch_start);
+            for (size_t j = 0; j < batch_rows; ++j)
+            {
+                size_t i = batch_start + j;
+                if (has_null_map && (*null_map)[i])
+                    continue;
+                keys[j] = keyHolderGetKey(key_getter.getKeyHolder(i, &pool, sort_key_containers));
+                locate(keys[j], segment_indexes[j], hash_values[j]);
+                if (map.getSegmentSize() > 0 && !ZeroTraits::check(keys[j]))
+                    map.getSegmentTable(segment_indexes[j]).prefetchByHash(hash_values[j]);
+            }
+            for (size_t j = 0; j < batch_rows; ++j)
             {
-                hash_value = map.hash(key);
-                segment_index = hash_value % map.getSegmentSize();
+                size_t i = batch_start + j;
+                if (has_null_map && (*null_map)[i])
+                    add_not_found(i);
+                else
+                    probe(i, keys[j], segment_indexes[j], hash_values[j]);
             }
-            auto & internal_map = map.getSegmentTable(segment_index);
-            /// do not require segment lock because in join, the hash table can not be changed in probe stage.
-            auto it = map.getSegmentSize() > 0 ? internal_map.find(key, hash_value) : internal_map.find(key);
-
-            if (it != internal_map.end())
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            if (has_null_map && (*null_map)[i])
             {
-                it->getMapped().setUsed();
-                Adder<KIND, STRICTNESS, Map>::addFound(
-                    it,
-                    num_columns_to_add,
-                    added_columns,
-                    i,
-                    filter.get(),
-                    current_offset,
-                    offsets_to_replicate.get(),
-                    right_indexes);
+                add_not_found(i);
             }
             else
-                Adder<KIND, STRICTNESS, Map>::addNotFound(
-                    num_columns_to_add,
-                    added_columns,
-                    i,
-                    filter.get(),
-                    current_offset,
-                    offsets_to_replicate.get());
-            keyHolderDiscardKey(key_holder);
+            {
+                auto key_holder = key_getter.getKeyHolder(i, &pool, sort_key_containers);
+                auto key = keyHolderGetKey(key_holder);
+                size_t segment_index = 0;
+                size_t hash_value = 0;
+                locate(key, segment_index, hash_value);
+                probe(i, key, segment_index, hash_value);
+                keyHolderDiscardKey(key_holder);
+            }
         }
     }
 }
@@ -1427,6 +1940,10 @@ void Join::joinBlockImpl(Block & block, const Maps & maps) const
     /// match the join filter won't join to anything
     recordFilteredRows(block, left_filter_column, null_map_holder, null_map);
 
+    /// Probe with the sort keys if the build side has materialized them, see `insertFromBlockInternal`.
+    TiDB::TiDBCollators key_collators = collators;
+    materializeSortKeys(key_columns, key_collators, materialized_columns);
+
     size_t existing_columns = block.columns();
 
     /** If you use FULL or RIGHT JOIN, then the columns from the "left" table must be materialized.
@@ -1517,7 +2034,7 @@ void Join::joinBlockImpl(Block & block, const Maps & maps) const
             current_offset,                                                                                                                    \
             offsets_to_replicate,                                                                                                              \
             right_indexes,                                                                                                                     \
-            collators);                                                                                                                        \
+            key_collators);                                                                                                                    \
         break;
         APPLY_FOR_JOIN_VARIANTS(M)
 #undef M
@@ -1785,6 +2302,157 @@ void Join::joinBlockImplCrossInternal(Block & block, ConstNullMapPtr null_map [[
     }
 }
 
+template <ASTTableJoin::Kind KIND, bool has_null_map>
+void Join::joinBlockImplCrossNestedLoop(Block & block, ConstNullMapPtr null_map [[maybe_unused]]) const
+{
+    static_assert(KIND == ASTTableJoin::Kind::Cross || KIND == ASTTableJoin::Kind::Cross_Anti);
+
+    size_t num_existing_columns = block.columns();
+    size_t num_columns_to_add = sample_block_with_columns_to_add.columns();
+    size_t rows_left = block.rows();
+
+    Block header = block.cloneEmpty();
+    for (size_t i = 0; i < num_columns_to_add; ++i)
+        header.insert(sample_block_with_columns_to_add.getByPosition(i).cloneEmpty());
+
+    /// evaluate the other condition for the pairs of a chunk, result is the matched pairs.
+    auto match_chunk = [&](Block & chunk, IColumn::Filter & filter) {
+        other_condition_ptr->execute(chunk);
+        filter.assign(chunk.rows(), static_cast<UInt8>(1));
+        if (!other_filter_column.empty())
+            mergeNullAndFilterResult(chunk, filter, other_filter_column, false);
+        if (!other_eq_filter_from_in_column.empty())
+            mergeNullAndFilterResult(chunk, filter, other_eq_filter_from_in_column, isAntiJoin(KIND));
+    };
+
+    Blocks result_blocks;
+    size_t left_chunk_size = std::min(std::max(rows_left, 1), max_block_size_for_cross_join);
+    for (size_t left_start = 0; left_start < rows_left; left_start += left_chunk_size)
+    {
+        size_t left_rows = std::min(left_chunk_size, rows_left - left_start);
+        size_t right_chunk_size = std::max(max_block_size_for_cross_join / left_rows, 1);
+
+        /// for anti join, the left rows matched with any right row
+        IColumn::Filter left_matched(left_rows, 0);
+        size_t left_rows_to_match = left_rows;
+        if constexpr (has_null_map)
+        {
+            /// the rows filtered out by left conditions are treated as not joined
+            for (size_t i = 0; i < left_rows; ++i)
+                left_rows_to_match -= (*null_map)[left_start + i] != 0;
+        }
+
+        IColumn::Filter filter;
+        for (auto block_right = blocks.begin(); block_right != blocks.end() && left_rows_to_match > 0; ++block_right)
+        {
+            size_t rows_right = block_right->rows();
+            for (size_t right_start = 0; right_start < rows_right && left_rows_to_match > 0; right_start += right_chunk_size)
+            {
+                size_t right_rows = std::min(right_chunk_size, rows_right - right_start);
+
+                /// the pairs are ordered by the right row, then by the left row.
+                MutableColumns dst_columns(num_existing_columns + num_columns_to_add);
+                for (size_t col_num = 0; col_num < num_existing_columns; ++col_num)
+                {
+                    const auto & src_column = *block.getByPosition(col_num).column;
+                    dst_columns[col_num] = src_column.cloneEmpty();
+                    dst_columns[col_num]->reserve(left_rows * right_rows);
+                    for (size_t j = 0; j < right_rows; ++j)
+                        dst_columns[col_num]->insertRangeFrom(src_column, left_start, left_rows);
+                }
+                for (size_t col_num = 0; col_num < num_columns_to_add; ++col_num)
+                {
+                    const auto & src_column = *block_right->getByPosition(col_num).column;
+                    auto & dst_column = dst_columns[num_existing_columns + col_num];
+                    dst_column = src_column.cloneEmpty();
+                    dst_column->reserve(left_rows * right_rows);
+                    for (size_t j = 0; j < right_rows; ++j)
+                    {
+                        for (size_t i = 0; i < left_rows; ++i)
+                            dst_column->insertFrom(src_column, right_start + j);
+                    }
+                }
+                Block chunk = header.cloneWithColumns(std::move(dst_columns));
+                match_chunk(chunk, filter);
+
+                if constexpr (has_null_map)
+                {
+                    for (size_t index = 0; index < filter.size(); ++index)
+                        filter[index] &= !(*null_map)[left_start + index % left_rows];
+                }
+
+                if constexpr (KIND == ASTTableJoin::Kind::Cross)
+                {
+                    for (size_t i = 0; i < chunk.columns(); ++i)
+                        chunk.safeGetByPosition(i).column = chunk.safeGetByPosition(i).column->filter(filter, -1);
+                    if (chunk.rows() > 0)
+                        result_blocks.push_back(std::move(chunk));
+                }
+                else
+                {
+                    for (size_t index = 0; index < filter.size(); ++index)
+                    {
+                        size_t i = index % left_rows;
+                        if (filter[index] && !left_matched[i])
+                        {
+                            left_matched[i] = 1;
+                            --left_rows_to_match;
+                        }
+                    }
+                }
+            }
+        }
+
+        if constexpr (KIND == ASTTableJoin::Kind::Cross_Anti)
+        {
+            /// output the left rows not matched, the right columns are useless for anti join.
+            for (auto & matched : left_matched)
+                matched = !matched;
+            size_t result_rows = countBytesInFilter(left_matched);
+            if (result_rows > 0)
+            {
+                Block result = header.cloneEmpty();
+                for (size_t col_num = 0; col_num < num_existing_columns; ++col_num)
+                    result.getByPosition(col_num).column = block.getByPosition(col_num).column->cut(left_start, left_rows)->filter(left_matched, result_rows);
+                for (size_t col_num = 0; col_num < num_columns_to_add; ++col_num)
+                {
+                    auto column = sample_block_with_columns_to_add.getByPosition(col_num).column->cloneEmpty();
+                    for (size_t i = 0; i < result_rows; ++i)
+                        column->insertDefault();
+                    result.getByPosition(num_existing_columns + col_num).column = std::move(column);
+                }
+                other_condition_ptr->execute(result);
+                result_blocks.push_back(std::move(result));
+            }
+        }
+    }
+
+    if (result_blocks.empty())
+    {
+        /// always need to generate a block with the structure of the join result
+        Block result = header.cloneEmpty();
+        other_condition_ptr->execute(result);
+        block = std::move(result);
+    }
+    else if (result_blocks.size() == 1)
+    {
+        block = std::move(result_blocks[0]);
+    }
+    else
+    {
+        const auto & sample_block = result_blocks[0];
+        MutableColumns dst_columns(sample_block.columns());
+        for (size_t i = 0; i < sample_block.columns(); ++i)
+            dst_columns[i] = sample_block.getByPosition(i).column->cloneEmpty();
+        for (const auto & current_block : result_blocks)
+        {
+            for (size_t column = 0; column < current_block.columns(); ++column)
+                dst_columns[column]->insertRangeFrom(*current_block.getByPosition(column).column, 0, current_block.rows());
+        }
+        block = sample_block.cloneWithColumns(std::move(dst_columns));
+    }
+}
+
 template <ASTTableJoin::Kind KIND, ASTTableJoin::Strictness STRICTNESS>
 void Join::joinBlockImplCross(Block & block) const
 {
@@ -1793,6 +2461,18 @@ void Join::joinBlockImplCross(Block & block) const
     ConstNullMapPtr null_map{};
     recordFilteredRows(block, left_filter_column, null_map_holder, null_map);
 
+    if constexpr ((KIND == ASTTableJoin::Kind::Cross || KIND == ASTTableJoin::Kind::Cross_Anti) && STRICTNESS == ASTTableJoin::Strictness::All)
+    {
+        if (nested_loop_cross_join && other_condition_ptr != nullptr && max_block_size_for_cross_join > 0)
+        {
+            if (null_map)
+                joinBlockImplCrossNestedLoop<KIND, true>(block, null_map);
+            else
+                joinBlockImplCrossNestedLoop<KIND, false>(block, nullptr);
+            return;
+        }
+    }
+
     std::unique_ptr<IColumn::Filter> filter = std::make_unique<IColumn::Filter>(rows_left);
     std::unique_ptr<IColumn::Offsets> offsets_to_replicate = std::make_unique<IColumn::Offsets>(rows_left);
 
@@ -1827,13 +2507,7 @@ void Join::joinBlock(Block & block) const
     //    std::cerr << "joinBlock: " << block.dumpStructure() << "\n";
 
     // ck will use this function to generate header, that's why here is a check.
-    {
-        std::unique_lock lk(build_table_mutex);
-
-        build_table_cv.wait(lk, [&]() { return build_table_state != BuildTableState::WAITING; });
-        if (build_table_state == BuildTableState::FAILED) /// throw this exception once failed to build the hash table
-            throw Exception("Build failed before join probe!");
-    }
+    waitBuildTableFinished();
 
     std::shared_lock lock(rwlock);
 
@@ -1843,7 +2517,16 @@ void Join::joinBlock(Block & block) const
     /// using enum ASTTableJoin::Strictness;
     /// using enum ASTTableJoin::Kind;
 
-    if (kind == ASTTableJoin::Kind::Left && strictness == ASTTableJoin::Strictness::Any)
+    if (existence_only)
+    {
+        if (kind == ASTTableJoin::Kind::Inner)
+            joinBlockImpl<ASTTableJoin::Kind::Inner, ASTTableJoin::Strictness::Any>(block, maps_existence);
+        else if (kind == ASTTableJoin::Kind::Anti)
+            joinBlockImpl<ASTTableJoin::Kind::Anti, ASTTableJoin::Strictness::Any>(block, maps_existence);
+        else
+            joinBlockImpl<ASTTableJoin::Kind::LeftSemi, ASTTableJoin::Strictness::Any>(block, maps_existence);
+    }
+    else if (kind == ASTTableJoin::Kind::Left && strictness == ASTTableJoin::Strictness::Any)
         joinBlockImpl<ASTTableJoin::Kind::Left, ASTTableJoin::Strictness::Any>(block, maps_any);
     else if (kind == ASTTableJoin::Kind::Inner && strictness == ASTTableJoin::Strictness::Any)
         joinBlockImpl<ASTTableJoin::Kind::Inner, ASTTableJoin::Strictness::Any>(block, maps_any);
@@ -2212,4 +2895,350 @@ BlockInputStreamPtr Join::createStreamWithNonJoinedRows(const Block & left_sampl
     return std::make_shared<NonJoinedBlockInputStream>(*this, left_sample_block, index, step, max_block_size);
 }
 
+namespace
+{
+template <typename KeyGetter, typename Map, bool has_null_map>
+void NO_INLINE computeSpillSelectorTypeCase(
+    size_t rows,
+    const ColumnRawPtrs & key_columns,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & collators,
+    ConstNullMapPtr null_map,
+    size_t partition_num,
+    IColumn::Selector & selector)
+{
+    KeyGetter key_getter(key_columns, key_sizes, collators);
+    std::vector<std::string> sort_key_containers;
+    sort_key_containers.resize(key_columns.size());
+    typename Map::Hash hash;
+    Arena pool;
+
+    for (size_t i = 0; i < rows; ++i)
+    {
+        /// Rows with NULL keys never join to anything, just put them into the first partition.
+        if (has_null_map && (*null_map)[i])
+        {
+            selector[i] = 0;
+            continue;
+        }
+        auto key_holder = key_getter.getKeyHolder(i, &pool, sort_key_containers);
+        auto key = keyHolderGetKey(key_holder);
+        /// Rehash so that the rows of one partition are still well distributed in the hash table of the sub join.
+        selector[i] = intHash64(hash(key)) % partition_num;
+        keyHolderDiscardKey(key_holder);
+    }
+}
+
+template <typename Maps>
+void computeSpillSelector(
+    Join::Type type,
+    const Maps & maps,
+    size_t rows,
+    const ColumnRawPtrs & key_columns,
+    const Sizes & key_sizes,
+    const TiDB::TiDBCollators & collators,
+    ConstNullMapPtr null_map,
+    size_t partition_num,
+    IColumn::Selector & selector)
+{
+    switch (type)
+    {
+#define M(TYPE)                                                                                                                                  \
+    case Join::Type::TYPE:                                                                                                                       \
+    {                                                                                                                                            \
+        using MapType = std::remove_reference_t<decltype(*maps.TYPE)>;                                                                           \
+        using KeyGetter = typename KeyGetterForType<Join::Type::TYPE, MapType>::Type;                                                            \
+        if (null_map)                                                                                                                            \
+            computeSpillSelectorTypeCase<KeyGetter, MapType, true>(rows, key_columns, key_sizes, collators, null_map, partition_num, selector);  \
+        else                                                                                                                                     \
+            computeSpillSelectorTypeCase<KeyGetter, MapType, false>(rows, key_columns, key_sizes, collators, null_map, partition_num, selector); \
+        break;                                                                                                                                   \
+    }
+        APPLY_FOR_JOIN_VARIANTS(M)
+#undef M
+
+    default:
+        throw Exception("Unknown JOIN keys variant for spilling.", ErrorCodes::UNKNOWN_SET_DATA_VARIANT);
+    }
+}
+
+/// Restore a spilled partition: build a sub join from the build rows, probe it with the probe rows, and then
+/// output the non-joined rows for RIGHT and FULL joins.
+class SpilledPartitionJoinBlockInputStream : public IProfilingBlockInputStream
+{
+public:
+    SpilledPartitionJoinBlockInputStream(
+        const JoinPtr & sub_join_,
+        const BlockInputStreamPtr & build_in_,
+        const BlockInputStreamPtr & probe_in_,
+        const Block & build_sample_block_,
+        const Block & probe_header_,
+        const Block & result_header_,
+        size_t max_block_size_)
+        : sub_join(sub_join_)
+        , build_in(build_in_)
+        , probe_in(probe_in_)
+        , build_sample_block(build_sample_block_)
+        , probe_header(probe_header_)
+        , result_header(result_header_)
+        , max_block_size(max_block_size_)
+    {}
+
+    String getName() const override { return "SpilledPartitionJoin"; }
+
+    Block getHeader() const override { return result_header; }
+
+protected:
+    Block readImpl() override
+    {
+        if (!built)
+        {
+            sub_join->init(build_sample_block, 1);
+            if (build_in)
+            {
+                build_in->readPrefix();
+                while (Block block = build_in->read())
+                    sub_join->insertFromBlock(block, 0);
+                build_in->readSuffix();
+            }
+            if (probe_in)
+                probe_in->readPrefix();
+            built = true;
+        }
+
+        if (probe_in)
+        {
+            while (Block block = probe_in->read())
+            {
+                sub_join->joinBlock(block);
+                if (block.rows() > 0)
+                    return block;
+            }
+            probe_in->readSuffix();
+            probe_in.reset();
+        }
+
+        if (getFullness(sub_join->getKind()))
+        {
+            if (!non_joined_in)
+            {
+                non_joined_in = sub_join->createStreamWithNonJoinedRows(probe_header, 0, 1, max_block_size);
+                non_joined_in->readPrefix();
+            }
+            return non_joined_in->read();
+        }
+        return {};
+    }
+
+private:
+    JoinPtr sub_join;
+    BlockInputStreamPtr build_in;
+    BlockInputStreamPtr probe_in;
+    BlockInputStreamPtr non_joined_in;
+    Block build_sample_block;
+    Block probe_header;
+    Block result_header;
+    size_t max_block_size;
+    bool built = false;
+};
+} // namespace
+
+bool Join::checkSpillThreshold() const
+{
+    if (spill_requested.load())
+        return true;
+    if (current_memory_tracker)
+        return current_memory_tracker->get() > static_cast<Int64>(max_bytes_before_external_join);
+    return getTotalByteCount() > max_bytes_before_external_join;
+}
+
+bool Join::reserveBuildMemory()
+{
+    static constexpr size_t reserve_step = 64 * 1024 * 1024;
+    if (MemoryArbiter::instance().getLimit() == 0)
+        return true;
+
+    size_t bytes = getTotalByteCount();
+    std::lock_guard lock(memory_reservation_mutex);
+    while (memory_reservation.getReserved() < bytes)
+    {
+        if (!memory_reservation.tryReserve(reserve_step))
+            return false;
+    }
+    return true;
+}
+
+void Join::spillBlock(const Block & block, const Names & key_names, std::vector<SpilledPartitionPtr> & partitions)
+{
+    size_t rows = block.rows();
+    if (rows == 0)
+        return;
+
+    size_t keys_size = key_names.size();
+    ColumnRawPtrs key_columns(keys_size);
+    Columns materialized_columns;
+    for (size_t i = 0; i < keys_size; ++i)
+    {
+        key_columns[i] = block.getByName(key_names[i]).column.get();
+        if (ColumnPtr converted = key_columns[i]->convertToFullColumnIfConst())
+        {
+            materialized_columns.emplace_back(converted);
+            key_columns[i] = materialized_columns.back().get();
+        }
+    }
+    ColumnPtr null_map_holder;
+    ConstNullMapPtr null_map{};
+    extractNestedColumnsAndNullMap(key_columns, null_map_holder, null_map);
+
+    IColumn::Selector selector(rows);
+    computeSpillSelector(type, maps_any, rows, key_columns, key_sizes, collators, null_map, spill_partition_num, selector);
+
+    Blocks scattered_blocks(spill_partition_num);
+    for (auto & scattered_block : scattered_blocks)
+        scattered_block = block.cloneEmpty();
+    for (size_t i = 0; i < block.columns(); ++i)
+    {
+        auto scattered_columns = block.getByPosition(i).column->scatter(spill_partition_num, selector);
+        for (size_t partition_index = 0; partition_index < spill_partition_num; ++partition_index)
+            scattered_blocks[partition_index].getByPosition(i).column = std::move(scattered_columns[partition_index]);
+    }
+    for (size_t partition_index = 0; partition_index < spill_partition_num; ++partition_index)
+    {
+        if (scattered_blocks[partition_index].rows() > 0)
+            partitions[partition_index]->write(scattered_blocks[partition_index]);
+    }
+}
+
+void Join::finishBuild()
+{
+    std::unique_lock lock(rwlock);
+    if (isPartitionedBuild())
+        insertScatteredRows();
+    if (build_rows_hint > 0)
+        LOG_FMT_DEBUG(log, "Join hash table is reserved for {} rows, {} rows are built actually", build_rows_hint, getTotalBuildInputRows());
+    if (!spill_triggered.load() || spilled)
+        return;
+
+    /// The rows inserted before spilling is triggered are spilled too, so that every partition is complete on disk.
+    for (const auto & block : original_blocks)
+        spillBlock(block, key_names_right, build_partitions);
+    size_t spilled_rows = 0;
+    size_t spilled_bytes = 0;
+    for (auto & partition : build_partitions)
+    {
+        partition->finishWrite();
+        spilled_rows += partition->getRows();
+        spilled_bytes += partition->getSpilledBytes();
+    }
+
+    /// Release the in-memory build data.
+    initMapImpl(type);
+    blocks.clear();
+    original_blocks.clear();
+    for (auto & pool : pools)
+        pool = std::make_shared<Arena>();
+    for (auto & rows_not_inserted : rows_not_inserted_to_map)
+        rows_not_inserted = std::make_unique<RowRefList>();
+
+    spilled = true;
+    LOG_FMT_INFO(log, "Join build side is spilled into {} partitions, {} rows, {:.3f} MiB compressed", spill_partition_num, spilled_rows, spilled_bytes / 1048576.0);
+}
+
+void Join::insertScatteredRows()
+{
+    Stopwatch watch;
+    auto insert_segment = [&](size_t segment_index) {
+        FAIL_POINT_TRIGGER_EXCEPTION(FailPoints::random_join_build_failpoint);
+        /// The arenas are no longer used by the build streams, each thread takes the one of its segment.
+        Arena & pool = *pools[segment_index];
+        if (existence_only)
+            insertScatteredRowsImpl<ASTTableJoin::Strictness::Any>(type, maps_existence, segment_index, scattered_blocks, key_sizes, collators, pool);
+        else if (!getFullness(kind))
+        {
+            if (strictness == ASTTableJoin::Strictness::Any)
+                insertScatteredRowsImpl<ASTTableJoin::Strictness::Any>(type, maps_any, segment_index, scattered_blocks, key_sizes, collators, pool);
+            else
+                insertScatteredRowsImpl<ASTTableJoin::Strictness::All>(type, maps_all, segment_index, scattered_blocks, key_sizes, collators, pool);
+        }
+        else
+        {
+            if (strictness == ASTTableJoin::Strictness::Any)
+                insertScatteredRowsImpl<ASTTableJoin::Strictness::Any>(type, maps_any_full, segment_index, scattered_blocks, key_sizes, collators, pool);
+            else
+                insertScatteredRowsImpl<ASTTableJoin::Strictness::All>(type, maps_all_full, segment_index, scattered_blocks, key_sizes, collators, pool);
+        }
+    };
+
+    auto thread_manager = newThreadManager();
+    for (size_t segment_index = 0; segment_index < getBuildConcurrencyInternal(); ++segment_index)
+        thread_manager->schedule(true, "JoinBuild", [&insert_segment, segment_index] { insert_segment(segment_index); });
+    thread_manager->wait();
+
+    for (auto & stream_scattered_blocks : scattered_blocks)
+        std::vector<ScatteredBlock>().swap(stream_scattered_blocks);
+
+    LOG_FMT_DEBUG(log, "Join build inserts {} rows into {} segments in {:.3f} sec", getTotalRowCount(), getBuildConcurrencyInternal(), watch.elapsedSeconds());
+
+    if (!limits.check(getTotalRowCount(), getTotalByteCount(), "JOIN", ErrorCodes::SET_SIZE_LIMIT_EXCEEDED))
+        build_set_exceeded.store(true);
+}
+
+void Join::spillProbeBlock(const Block & block)
+{
+    if (unlikely(!spilled))
+        throw Exception("Logical error: spill probe block for a join that is not spilled", ErrorCodes::LOGICAL_ERROR);
+    std::shared_lock lock(rwlock);
+    spillBlock(block, key_names_left, probe_partitions);
+}
+
+void Join::finishOneProbe()
+{
+    std::unique_lock lock(probe_finish_mutex);
+    ++finished_probe_streams;
+    if (finished_probe_streams == probe_concurrency)
+    {
+        for (auto & partition : probe_partitions)
+            partition->finishWrite();
+        probe_finish_cv.notify_all();
+    }
+}
+
+bool Join::waitProbeFinished(std::chrono::milliseconds timeout) const
+{
+    std::unique_lock lock(probe_finish_mutex);
+    return probe_finish_cv.wait_for(lock, timeout, [&] { return finished_probe_streams >= probe_concurrency; });
+}
+
+JoinPtr Join::createSubJoin() const
+{
+    return std::make_shared<Join>(
+        key_names_left,
+        key_names_right,
+        use_nulls,
+        limits,
+        kind,
+        original_strictness,
+        log->identifier(),
+        collators,
+        left_filter_column,
+        right_filter_column,
+        other_filter_column,
+        other_eq_filter_from_in_column,
+        other_condition_ptr,
+        max_block_size_for_cross_join,
+        match_helper_name);
+}
+
+BlockInputStreamPtr Join::createStreamForSpilledPartition(size_t partition_index, const Block & probe_header, const Block & result_header, size_t max_block_size)
+{
+    if (unlikely(!spilled || partition_index >= spill_partition_num))
+        throw Exception("Logical error: invalid spilled partition of join", ErrorCodes::LOGICAL_ERROR);
+    auto build_in = build_partitions[partition_index]->read();
+    auto probe_in = probe_partitions[partition_index]->read();
+    /// Only RIGHT and FULL joins output rows when there is nothing to probe.
+    if (!probe_in && !getFullness(kind))
+        return std::make_shared<NullBlockInputStream>(result_header);
+    return std::make_shared<SpilledPartitionJoinBlockInputStream>(createSubJoin(), build_in, probe_in, build_sample_block, probe_header, result_header, max_block_size);
+}
+
 } // namespace DB
@@ -20,19 +20,29 @@
 #include <Common/Arena.h>
 #include <Common/HashTable/HashMap.h>
 #include <Common/Logger.h>
+#include <Common/MemoryArbiter.h>
+#include <Common/ProfilingMutex.h>
 #include <DataStreams/IBlockInputStream.h>
 #include <DataStreams/SizeLimits.h>
 #include <Interpreters/AggregationCommon.h>
 #include <Interpreters/ExpressionActions.h>
+#include <Interpreters/JoinRuntimeFilter.h>
 #include <Interpreters/SettingsCommon.h>
 #include <Parsers/ASTTablesInSelectQuery.h>
 #include <common/ThreadPool.h>
 
+#include <chrono>
+#include <functional>
 #include <shared_mutex>
 
 
 namespace DB
 {
+class FileProvider;
+using FileProviderPtr = std::shared_ptr<FileProvider>;
+class Join;
+using JoinPtr = std::shared_ptr<Join>;
+
 /** Data structure for implementation of JOIN.
   * It is just a hash table: keys -> rows of joined ("right") table.
   * Additionally, CROSS JOIN is supported: instead of hash table, it use just set of blocks without keys.
@@ -88,6 +98,16 @@ namespace DB
   *  (zero, empty string, etc. and NULL for Nullable data types).
   * If it is true, we always generate Nullable column and substitute NULLs for non-joined rows,
   *  as in standard SQL.
+  *
+  * Spilling (grace hash join):
+  *
+  * If `setSpillConfig` is called with a non-zero `max_bytes_before_external_join`, once the memory tracked by
+  *  `MemoryTracker` passes the threshold during building, all the build rows are partitioned by the hash of their
+  *  join keys into temporary files, and so are the rows of the probe side. After all the probe streams finish
+  *  spilling, each partition is restored and joined independently by a sub join, including the non-joined rows
+  *  of RIGHT and FULL joins. CROSS joins are never spilled.
+  * A join with spilling enabled is also registered to `MemoryArbiter`, which may ask it to spill before the threshold
+  *  is reached when the memory of the whole process is under pressure.
   */
 class Join
 {
@@ -108,6 +128,35 @@ public:
          size_t max_block_size = 0,
          const String & match_helper_name = "");
 
+    ~Join();
+
+    /** Enable spilling the build and probe data into `spill_partition_num` partitions under `spill_path`
+      * when the memory usage passes `max_bytes_before_external_join`.
+      * You must call this method before `init`.
+      */
+    void setSpillConfig(size_t max_bytes_before_external_join_, size_t spill_partition_num_, const String & spill_path_, const FileProviderPtr & file_provider_);
+
+    /** Reserve the hash maps for about `build_rows_hint_` build rows ahead, so that they needn't be rehashed
+      * again and again while building. 0 means growing on demand. You must call this method before `init`.
+      */
+    void setBuildRowsHint(size_t build_rows_hint_) { build_rows_hint = build_rows_hint_; }
+    size_t getBuildRowsHint() const { return build_rows_hint; }
+
+    /** Build the hash maps in two phases, so that the build streams needn't lock the segments of the maps:
+      * `insertFromBlock` only scatters the rows to the segments by the hash of the keys, then `finishBuild`
+      * inserts the rows of every segment by a thread that owns it. It doesn't work with spilling.
+      * You must call this method before `init`.
+      */
+    void setPartitionedBuild(bool partitioned_build_) { partitioned_build = partitioned_build_; }
+
+    /** Join the cartesian inner and anti joins with other conditions by a nested loop: the other condition is evaluated
+      * for a chunk of the left rows against a chunk of the right rows at a time, no more than `max_block_size` pairs,
+      * and only the matched rows are kept, instead of expanding every left row with all the right rows.
+      * The anti join stops scanning the right rows once all the left rows are matched, which is common for `NOT IN`
+      * with NULL in the subquery.
+      */
+    void setNestedLoopCrossJoin(bool nested_loop_cross_join_) { nested_loop_cross_join = nested_loop_cross_join_; }
+
     /** Call `setBuildConcurrencyAndInitPool`, `initMapImpl` and `setSampleBlock`.
       * You must call this method before subsequent calls to insertFromBlock.
       */
@@ -145,6 +194,12 @@ public:
 
     ASTTableJoin::Kind getKind() const { return kind; }
 
+    /** The semi and anti joins without other conditions, which don't read any column of the build rows, only check the existence
+      * of the probe keys. They use `maps_existence` without references to the rows and store only the key columns of the build blocks.
+      * Decided by `init`, not for the joins with spilling enabled.
+      */
+    bool isExistenceOnly() const { return existence_only; }
+
     bool useNulls() const { return use_nulls; }
     const Names & getLeftJoinKeys() const { return key_names_left; }
 
@@ -168,6 +223,40 @@ public:
         SUCCEED
     };
     void setBuildTableState(BuildTableState state_);
+    /// Mark the build as failed if it has not finished, to wake up the probes waiting for it.
+    void cancelBuildIfWaiting();
+
+    /// Block until the build side finishes, throw if it failed.
+    void waitBuildTableFinished() const;
+
+    /// The runtime filter is fed with the join key of every build block, it must be set before the build starts.
+    void setRuntimeFilter(const JoinRuntimeFilterPtr & runtime_filter_) { runtime_filter = runtime_filter_; }
+    const JoinRuntimeFilterPtr & getRuntimeFilter() const { return runtime_filter; }
+
+    /// The probe side registers the work that does not depend on the hash table, e.g. prefetching the probe blocks.
+    /// They are started together with the build by `startProbePrefetch`, which is called once by CreatingSetsBlockInputStream.
+    void addProbePrefetcher(std::function<void()> && start_prefetch);
+    void startProbePrefetch();
+
+    /// Called after all the build blocks are inserted. Flush the in-memory build data to disk if spilling is triggered.
+    void finishBuild();
+
+    bool isSpilled() const { return spilled; }
+    size_t getSpillPartitionNum() const { return spill_partition_num; }
+
+    /// Methods for the probe side of a spilled join.
+    /// `probe_concurrency` is the number of probe streams that should call `finishOneProbe` before any partition is restored.
+    void setProbeConcurrency(size_t probe_concurrency_) { probe_concurrency = probe_concurrency_; }
+    void spillProbeBlock(const Block & block);
+    void finishOneProbe();
+    /// Return false if not all probe streams have finished spilling after waiting for `timeout`.
+    bool waitProbeFinished(std::chrono::milliseconds timeout) const;
+    /// Return the index of the next spilled partition to be restored, or `spill_partition_num` if no partition remains.
+    size_t fetchNextRestorePartition() { return next_restore_partition.fetch_add(1); }
+    /** Restore the build and probe data of a spilled partition and join them.
+      * The returned stream contains the joined blocks as well as the non-joined rows for RIGHT and FULL joins.
+      */
+    BlockInputStreamPtr createStreamForSpilledPartition(size_t partition_index, const Block & probe_header, const Block & result_header, size_t max_block_size);
 
     /// Reference to the row in block.
     struct RowRef
@@ -193,6 +282,27 @@ public:
         {}
     };
 
+    /// No reference to the row, only the existence of the key is recorded. Used for the existence-only joins, see `isExistenceOnly`.
+    struct Existence
+    {
+        Existence() = default;
+        Existence(const Block * /*block_*/, size_t /*row_num_*/) {}
+    };
+
+
+    /// The rows of a build block scattered to the segments of the maps, see `setPartitionedBuild`.
+    struct ScatteredBlock
+    {
+        Block * stored_block = nullptr;
+        /// Hold the key columns, which are removed from `stored_block` for the joins other than RIGHT and FULL.
+        Columns key_column_holders;
+        ColumnRawPtrs key_columns;
+        TiDB::TiDBCollators key_collators;
+        std::vector<std::vector<UInt32>> rows_per_segment;
+        /// The hash values of the keys of `rows_per_segment`, so that the keys are not hashed again when inserted.
+        std::vector<std::vector<size_t>> hashes_per_segment;
+    };
+
 
     /** Depending on template parameter, adds or doesn't add a flag, that element was used (row was joined).
       * For implementation of RIGHT and FULL JOINs.
@@ -263,6 +373,7 @@ public:
     using MapsAll = MapsTemplate<WithUsedFlag<false, RowRefList>>;
     using MapsAnyFull = MapsTemplate<WithUsedFlag<true, RowRef>>;
     using MapsAllFull = MapsTemplate<WithUsedFlag<true, RowRefList>>;
+    using MapsExistence = MapsTemplate<WithUsedFlag<false, Existence>>;
 
     static const String match_helper_prefix;
     static const DataTypePtr match_helper_type;
@@ -308,6 +419,10 @@ private:
     MapsAll maps_all; /// For ALL LEFT|INNER JOIN
     MapsAnyFull maps_any_full; /// For ANY RIGHT|FULL JOIN
     MapsAllFull maps_all_full; /// For ALL RIGHT|FULL JOIN
+    MapsExistence maps_existence; /// For ANY SEMI|ANTI JOIN that only checks the existence of the keys
+
+    /// See `isExistenceOnly`.
+    bool existence_only = false;
 
     /// For right/full join, including
     /// 1. Rows with NULL join keys
@@ -317,6 +432,13 @@ private:
     /// Additional data - strings for string keys and continuation elements of single-linked lists of references to rows.
     Arenas pools;
 
+    /// For the partitioned build, the blocks scattered by each build stream.
+    bool partitioned_build = false;
+
+    /// See `setNestedLoopCrossJoin`.
+    bool nested_loop_cross_join = false;
+    std::vector<std::vector<ScatteredBlock>> scattered_blocks;
+
 private:
     Type type = Type::EMPTY;
 
@@ -340,15 +462,56 @@ private:
 
     Block totals;
     std::atomic<size_t> total_input_build_rows{0};
+    size_t build_rows_hint = 0;
     /** Protect state for concurrent use in insertFromBlock and joinBlock.
       * Note that these methods could be called simultaneously only while use of StorageJoin,
       *  and StorageJoin only calls these two methods.
       * That's why another methods are not guarded.
       */
-    mutable std::shared_mutex rwlock;
+    mutable ProfilingSharedMutex rwlock{ProfilingLockType::Join};
 
     bool initialized = false;
 
+    /// For spilling, see `setSpillConfig`.
+    class SpilledPartition;
+    using SpilledPartitionPtr = std::unique_ptr<SpilledPartition>;
+    size_t max_bytes_before_external_join = 0;
+    size_t spill_partition_num = 0;
+    String spill_path;
+    FileProviderPtr file_provider;
+    JoinRuntimeFilterPtr runtime_filter;
+    std::vector<std::function<void()>> probe_prefetchers;
+
+    /// The original header of build side, used to init the sub joins.
+    Block build_sample_block;
+    /// Set by the first build stream that finds the memory threshold exceeded.
+    std::atomic_bool spill_triggered{false};
+    /// Set by `MemoryArbiter` under memory pressure, the build data is spilled as if the threshold were exceeded.
+    std::atomic_bool spill_requested{false};
+    MemoryArbiter::ConsumerId memory_arbiter_id = 0;
+    std::mutex memory_reservation_mutex;
+    MemoryReservation memory_reservation;
+    /// Set by `finishBuild`, after that all the build data is on disk.
+    bool spilled = false;
+    std::vector<SpilledPartitionPtr> build_partitions;
+    std::vector<SpilledPartitionPtr> probe_partitions;
+    size_t probe_concurrency = 0;
+    mutable std::mutex probe_finish_mutex;
+    mutable std::condition_variable probe_finish_cv;
+    size_t finished_probe_streams = 0;
+    std::atomic<size_t> next_restore_partition{0};
+
+    bool isSpillEnabled() const;
+    bool isPartitionedBuild() const;
+    /// Insert the rows scattered by the build streams into the maps, every segment by a thread.
+    void insertScatteredRows();
+    bool checkSpillThreshold() const;
+    /// Reserve the memory of the build data from `MemoryArbiter` step by step, return false if there is not enough memory.
+    bool reserveBuildMemory();
+    /// Scatter `block` by the hash of keys `key_names` into `partitions`.
+    void spillBlock(const Block & block, const Names & key_names, std::vector<SpilledPartitionPtr> & partitions) const;
+    JoinPtr createSubJoin() const;
+
     size_t getBuildConcurrencyInternal() const
     {
         if (unlikely(build_concurrency == 0))
@@ -396,6 +559,9 @@ private:
 
     template <ASTTableJoin::Kind KIND, ASTTableJoin::Strictness STRICTNESS, bool has_null_map>
     void joinBlockImplCrossInternal(Block & block, ConstNullMapPtr null_map) const;
+
+    template <ASTTableJoin::Kind KIND, bool has_null_map>
+    void joinBlockImplCrossNestedLoop(Block & block, ConstNullMapPtr null_map) const;
 };
 
 using JoinPtr = std::shared_ptr<Join>;
@@ -0,0 +1,189 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <Interpreters/JoinRuntimeFilter.h>
+#include <fmt/core.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+} // namespace ErrorCodes
+
+#define APPLY_FOR_RUNTIME_FILTER_KEY_TYPES(M) \
+    M(UInt8)                                  \
+    M(UInt16)                                 \
+    M(UInt32)                                 \
+    M(UInt64)                                 \
+    M(Int8)                                   \
+    M(Int16)                                  \
+    M(Int32)                                  \
+    M(Int64)
+
+namespace
+{
+/// Return the nested column and fill `null_map` if the column is nullable.
+const IColumn & extractNestedColumn(const IColumn & column, const NullMap *& null_map)
+{
+    if (const auto * nullable_column = typeid_cast<const ColumnNullable *>(&column))
+    {
+        null_map = &nullable_column->getNullMapData();
+        return nullable_column->getNestedColumn();
+    }
+    null_map = nullptr;
+    return column;
+}
+} // namespace
+
+JoinRuntimeFilter::JoinRuntimeFilter(const DataTypePtr & key_type, size_t max_in_values_)
+    : key_type_index(removeNullable(key_type)->getTypeId())
+    , max_in_values(max_in_values_)
+    , use_in_values(max_in_values_ > 0)
+{
+    if (unlikely(!isSupportedKeyType(key_type)))
+        throw Exception(fmt::format("Unsupported key type {} of join runtime filter", key_type->getName()), ErrorCodes::LOGICAL_ERROR);
+}
+
+bool JoinRuntimeFilter::isSupportedKeyType(const DataTypePtr & key_type)
+{
+    switch (removeNullable(key_type)->getTypeId())
+    {
+#define M(TYPE)           \
+    case TypeIndex::TYPE: \
+        return true;
+        APPLY_FOR_RUNTIME_FILTER_KEY_TYPES(M)
+#undef M
+    default:
+        return false;
+    }
+}
+
+void JoinRuntimeFilter::insert(const IColumn & key_column)
+{
+    ColumnPtr full_column = key_column.convertToFullColumnIfConst();
+    const NullMap * null_map = nullptr;
+    const auto & nested_column = extractNestedColumn(full_column ? *full_column : key_column, null_map);
+    switch (key_type_index)
+    {
+#define M(TYPE)                                    \
+    case TypeIndex::TYPE:                          \
+        insertImpl<TYPE>(nested_column, null_map); \
+        break;
+        APPLY_FOR_RUNTIME_FILTER_KEY_TYPES(M)
+#undef M
+    default:
+        throw Exception("Unsupported key type of join runtime filter", ErrorCodes::LOGICAL_ERROR);
+    }
+}
+
+template <typename T>
+void JoinRuntimeFilter::insertImpl(const IColumn & column, const NullMap * null_map)
+{
+    const auto & data = typeid_cast<const ColumnVector<T> &>(column).getData();
+
+    /// Collect the block locally, and merge it under the lock.
+    bool block_has_value = false;
+    UInt64 block_min = std::numeric_limits<UInt64>::max();
+    UInt64 block_max = 0;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        if (null_map && (*null_map)[i])
+            continue;
+        UInt64 key = toOrderedKey(data[i]);
+        block_has_value = true;
+        block_min = std::min(block_min, key);
+        block_max = std::max(block_max, key);
+    }
+    if (!block_has_value)
+        return;
+
+    std::lock_guard lock(mu);
+    has_value = true;
+    min_value = std::min(min_value, block_min);
+    max_value = std::max(max_value, block_max);
+    if (!use_in_values)
+        return;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        if (null_map && (*null_map)[i])
+            continue;
+        in_values.insert(toOrderedKey(data[i]));
+        if (in_values.size() > max_in_values)
+        {
+            /// Too many keys, the range is the only thing left to filter by.
+            use_in_values = false;
+            in_values.clear();
+            return;
+        }
+    }
+}
+
+void JoinRuntimeFilter::filter(const IColumn & key_column, IColumn::Filter & filter) const
+{
+    ColumnPtr full_column = key_column.convertToFullColumnIfConst();
+    const NullMap * null_map = nullptr;
+    const auto & nested_column = extractNestedColumn(full_column ? *full_column : key_column, null_map);
+    switch (key_type_index)
+    {
+#define M(TYPE)                                            \
+    case TypeIndex::TYPE:                                  \
+        filterImpl<TYPE>(nested_column, null_map, filter); \
+        break;
+        APPLY_FOR_RUNTIME_FILTER_KEY_TYPES(M)
+#undef M
+    default:
+        throw Exception("Unsupported key type of join runtime filter", ErrorCodes::LOGICAL_ERROR);
+    }
+}
+
+template <typename T>
+void JoinRuntimeFilter::filterImpl(const IColumn & column, const NullMap * null_map, IColumn::Filter & filter) const
+{
+    /// No lock is needed, the build side has finished.
+    const auto & data = typeid_cast<const ColumnVector<T> &>(column).getData();
+    if (!has_value)
+    {
+        std::fill(filter.begin(), filter.end(), 0);
+        return;
+    }
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        if (null_map && (*null_map)[i])
+        {
+            filter[i] = 0;
+            continue;
+        }
+        UInt64 key = toOrderedKey(data[i]);
+        if (key < min_value || key > max_value || (use_in_values && !in_values.has(key)))
+            filter[i] = 0;
+    }
+}
+
+String JoinRuntimeFilter::toString() const
+{
+    std::lock_guard lock(mu);
+    if (!has_value)
+        return "empty";
+    return fmt::format("range [{}, {}] of ordered keys, {}", min_value, max_value, use_in_values ? fmt::format("{} in values", in_values.size()) : "no in values");
+}
+
+#undef APPLY_FOR_RUNTIME_FILTER_KEY_TYPES
+
+} // namespace DB
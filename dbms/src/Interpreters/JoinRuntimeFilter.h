@@ -0,0 +1,82 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Columns/IColumn.h>
+#include <Common/HashTable/HashSet.h>
+#include <DataTypes/IDataType.h>
+
+#include <memory>
+#include <mutex>
+
+namespace DB
+{
+/** A runtime filter collected from the join key of the build side of a hash join, and applied to the probe side
+  * to drop the rows that can not match before they reach the hash table probe.
+  * It keeps the min/max range of the keys, and also the exact set of keys until there are more than `max_in_values` of them.
+  * Only a single integer join key is supported. The filter is a superset of the keys in the hash table, so it is only
+  * correct for the joins that drop the unmatched probe rows, such as inner join.
+  */
+class JoinRuntimeFilter
+{
+public:
+    JoinRuntimeFilter(const DataTypePtr & key_type, size_t max_in_values_);
+
+    static bool isSupportedKeyType(const DataTypePtr & key_type);
+
+    /// Add the keys of a build block, thread safe. The NULL keys never match, so they are skipped.
+    void insert(const IColumn & key_column);
+
+    /// Set `filter[i]` to 0 for the rows of the probe keys that can not match any build key.
+    /// Must be called after all the build blocks are inserted.
+    void filter(const IColumn & key_column, IColumn::Filter & filter) const;
+
+    bool hasInValues() const { return use_in_values; }
+    size_t inValuesSize() const { return in_values.size(); }
+    String toString() const;
+
+private:
+    /// The keys are mapped to UInt64 in an order preserving way, so that signed and unsigned keys share the same code.
+    template <typename T>
+    static UInt64 toOrderedKey(T value)
+    {
+        if constexpr (std::is_signed_v<T>)
+            return static_cast<UInt64>(static_cast<Int64>(value)) ^ (1ULL << 63);
+        else
+            return static_cast<UInt64>(value);
+    }
+
+    template <typename T>
+    void insertImpl(const IColumn & column, const NullMap * null_map);
+    template <typename T>
+    void filterImpl(const IColumn & column, const NullMap * null_map, IColumn::Filter & filter) const;
+
+    using KeySet = HashSet<UInt64, HashCRC32<UInt64>>;
+
+    const TypeIndex key_type_index;
+    const size_t max_in_values;
+
+    mutable std::mutex mu;
+    bool has_value = false;
+    UInt64 min_value = std::numeric_limits<UInt64>::max();
+    UInt64 max_value = 0;
+    bool use_in_values;
+    KeySet in_values;
+};
+
+using JoinRuntimeFilterPtr = std::shared_ptr<JoinRuntimeFilter>;
+
+} // namespace DB
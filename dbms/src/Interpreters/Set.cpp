@@ -31,6 +31,8 @@
 #include <Parsers/ASTLiteral.h>
 #include <Storages/Transaction/TypeMapping.h>
 
+#include <algorithm>
+
 
 namespace DB
 {
@@ -177,6 +179,8 @@ bool Set::insertFromBlock(const Block & block, bool fill_set_elements)
         }
     }
 
+    buildSmallSet();
+
     return limits.check(getTotalRowCount(), getTotalByteCount(), "IN-set", ErrorCodes::SET_SIZE_LIMIT_EXCEEDED);
 }
 
@@ -415,6 +419,72 @@ void NO_INLINE Set::executeImplCase(
 }
 
 
+void Set::buildSmallSet()
+{
+    use_small_set = false;
+    small_set_keys.clear();
+    if (getTotalRowCount() > SMALL_SET_MAX_SIZE)
+        return;
+
+    switch (data.type)
+    {
+    case SetVariants::Type::key32:
+        for (const auto & cell : data.key32->data)
+            small_set_keys.push_back(cell.getValue());
+        break;
+    case SetVariants::Type::key64:
+        for (const auto & cell : data.key64->data)
+            small_set_keys.push_back(cell.getValue());
+        break;
+    default:
+        return;
+    }
+    std::sort(small_set_keys.begin(), small_set_keys.end());
+    use_small_set = true;
+}
+
+
+template <typename T>
+void NO_INLINE Set::executeSmallSet(
+    const IColumn & key_column,
+    ColumnUInt8::Container & vec_res,
+    bool negative,
+    ConstNullMapPtr null_map) const
+{
+    const auto * key_data = reinterpret_cast<const T *>(key_column.getRawData().data);
+    size_t rows = key_column.size();
+
+    /// The keys are zero extended from T, so they are still sorted after cast back to T.
+    std::vector<T> keys(small_set_keys.begin(), small_set_keys.end());
+    if (keys.size() <= SMALL_SET_LINEAR_MAX_SIZE)
+    {
+        /// Compare all rows with one key at a time, so that the loop is branch-free and can be vectorized.
+        memset(vec_res.data(), 0, rows);
+        for (const T key : keys)
+        {
+            for (size_t i = 0; i < rows; ++i)
+                vec_res[i] |= (key_data[i] == key);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < rows; ++i)
+            vec_res[i] = std::binary_search(keys.begin(), keys.end(), key_data[i]);
+    }
+
+    if (null_map)
+    {
+        for (size_t i = 0; i < rows; ++i)
+            vec_res[i] = (*null_map)[i] ? negative : (vec_res[i] ^ negative);
+    }
+    else if (negative)
+    {
+        for (size_t i = 0; i < rows; ++i)
+            vec_res[i] ^= 1;
+    }
+}
+
+
 void Set::executeOrdinary(
     const ColumnRawPtrs & key_columns,
     ColumnUInt8::Container & vec_res,
@@ -423,6 +493,15 @@ void Set::executeOrdinary(
 {
     size_t rows = key_columns[0]->size();
 
+    if (use_small_set)
+    {
+        if (data.type == SetVariants::Type::key32)
+            executeSmallSet<UInt32>(*key_columns[0], vec_res, negative, null_map);
+        else
+            executeSmallSet<UInt64>(*key_columns[0], vec_res, negative, null_map);
+        return;
+    }
+
     switch (data.type)
     {
     case SetVariants::Type::EMPTY:
@@ -149,6 +149,23 @@ private:
 
     TiDB::TiDBCollators collators;
 
+    /** The sorted keys of a set with one 32 or 64-bit numeric key and no more than SMALL_SET_MAX_SIZE elements, like the IN lists sent by TiDB.
+      * Rows are checked by a linear compare with every key (up to SMALL_SET_LINEAR_MAX_SIZE keys) or a binary search instead of probing the hash table.
+      */
+    static constexpr size_t SMALL_SET_LINEAR_MAX_SIZE = 16;
+    static constexpr size_t SMALL_SET_MAX_SIZE = 256;
+    bool use_small_set = false;
+    std::vector<UInt64> small_set_keys;
+
+    void buildSmallSet();
+
+    template <typename T>
+    void executeSmallSet(
+        const IColumn & key_column,
+        ColumnUInt8::Container & vec_res,
+        bool negative,
+        ConstNullMapPtr null_map) const;
+
     template <typename Method>
     void insertFromBlockImpl(
         Method & method,
@@ -51,6 +51,7 @@ struct Settings
     M(SettingInt64, dag_records_per_chunk, DEFAULT_DAG_RECORDS_PER_CHUNK, "default chunk size of a DAG response.")                                                                                                                      \
     M(SettingInt64, batch_send_min_limit, DEFAULT_BATCH_SEND_MIN_LIMIT, "default minimal chunk size of exchanging data among TiFlash.")                                                                                                 \
     M(SettingInt64, schema_version, DEFAULT_UNSPECIFIED_SCHEMA_VERSION, "tmt schema version.")                                                                                                                                          \
+    M(SettingUInt64, schema_sync_fetch_concurrency, 8, "The number of threads to fetch the table infos of different databases and the schema diffs concurrently while syncing schemas.")                                                \
     M(SettingUInt64, mpp_task_timeout, DEFAULT_MPP_TASK_TIMEOUT, "mpp task max endurable time.")                                                                                                                                        \
     M(SettingUInt64, mpp_task_running_timeout, DEFAULT_MPP_TASK_RUNNING_TIMEOUT, "mpp task max time that running without any progress.")                                                                                                \
     M(SettingUInt64, mpp_task_waiting_timeout, DEFAULT_MPP_TASK_WAITING_TIMEOUT, "mpp task max time that waiting first data block from source input stream.")                                                                           \
@@ -66,6 +67,7 @@ struct Settings
     M(SettingMaxThreads, max_threads, 0, "The maximum number of threads to execute the request. By default, it is determined automatically.")                                                                                           \
     M(SettingUInt64, cop_pool_size, 0, "The number of threads to handle cop requests. By default, it is determined automatically.")                                                                                                     \
     M(SettingUInt64, batch_cop_pool_size, 0, "The number of threads to handle batch cop requests. By default, it is determined automatically.")                                                                                         \
+    M(SettingUInt64, max_remote_read_streams, 0, "The maximum number of streams reading the remote regions of a table scan. Every stream keeps at most one cop response in flight. 0 means - same as 'max_threads'.")                   \
     M(SettingUInt64, max_read_buffer_size, DBMS_DEFAULT_BUFFER_SIZE, "The maximum size of the buffer to read from the filesystem.")                                                                                                     \
     M(SettingUInt64, max_distributed_connections, DEFAULT_MAX_DISTRIBUTED_CONNECTIONS, "The maximum number of connections for distributed processing of one query (should be greater than max_threads).")                               \
     M(SettingUInt64, max_query_size, DEFAULT_MAX_QUERY_SIZE, "Which part of the query can be read into RAM for parsing (the remaining data for INSERT, if any, is read later)")                                                         \
@@ -93,9 +95,15 @@ struct Settings
                                                                                                                                                                                                                                         \
     M(SettingBool, compile, false, "Whether query compilation is enabled.")                                                                                                                                                             \
     M(SettingUInt64, min_count_to_compile, 3, "The number of structurally identical queries before they are compiled.")                                                                                                                 \
+    M(SettingBool, enable_expression_fusion, false, "Evaluate trees of numeric comparisons combined by and / or / not in one pass over the input columns, instead of materializing a column for every function.")                       \
+    M(SettingBool, enable_short_circuit_evaluation, false, "Evaluate the terms of and / or after the first one only on the rows whose result is not decided by the previous terms.")                                                    \
     M(SettingUInt64, group_by_two_level_threshold, 100000, "From what number of keys, a two-level aggregation starts. 0 - the threshold is not set.")                                                                                   \
     M(SettingUInt64, group_by_two_level_threshold_bytes, 100000000, "From what size of the aggregation state in bytes, a two-level aggregation begins to be used. 0 - the threshold is not set. "                                       \
                                                                     "Two-level aggregation is used when at least one of the thresholds is triggered.")                                                                                  \
+    M(SettingBool, enable_streaming_aggregation, false, "Aggregate the rows read from the table scan in order by streaming without hash table, when the group by keys are a prefix of the integer primary key.")                        \
+    M(SettingBool, enable_adaptive_partial_aggregation, false, "Stop building the hash table of the partial aggregation of a stream and pass the rows through, when the sampled rows are not reduced by the group by keys.")            \
+    M(SettingUInt64, adaptive_partial_aggregation_sample_rows, 65536, "The number of rows of a stream sampled to decide whether its partial aggregation is skipped.")                                                                   \
+    M(SettingFloat, adaptive_partial_aggregation_ratio, 0.9, "The partial aggregation of a stream is skipped when its groups divided by the sampled rows is not less than this ratio.")                                                 \
     M(SettingBool, distributed_aggregation_memory_efficient, false, "Is the memory-saving mode of distributed aggregation enabled.")                                                                                                    \
     M(SettingUInt64, aggregation_memory_efficient_merge_threads, 0, "Number of threads to use for merge intermediate aggregation results in memory efficient mode. When bigger, then more memory is "                                   \
                                                                     "consumed. 0 means - same as 'max_threads'.")                                                                                                                       \
@@ -121,6 +129,8 @@ struct Settings
                                                                                                                                                                                                                                         \
     M(SettingInt64, network_zstd_compression_level, 1, "Allows you to select the level of ZSTD compression.")                                                                                                                           \
     M(SettingUInt64, priority, 0, "Priority of the query. 1 - the highest, higher value - lower priority; 0 - do not use priorities.")                                                                                                  \
+    M(SettingString, io_scheduling_group, "", "The I/O scheduling class of the queries, e.g. the tenant. The foreground I/O of different classes shares the limited I/O bandwidth by their weights. Empty - do not use I/O classes unless priority is set.") \
+    M(SettingUInt64, io_scheduling_weight, 100, "The I/O scheduling weight of io_scheduling_group. It is divided by priority when priority is set.")                                                                                    \
                                                                                                                                                                                                                                         \
     M(SettingBool, log_queries, 0, "Log requests and write the log to the system table.")                                                                                                                                               \
                                                                                                                                                                                                                                         \
@@ -259,6 +269,13 @@ struct Settings
     M(SettingUInt64, dt_segment_force_split_size, 1610612736, "The threshold of the foreground split segment. in DeltaTree Engine. 1.5GB by default.")                                                                                  \
     M(SettingUInt64, dt_segment_delta_limit_rows, 80000, "Max rows of segment delta in DeltaTree Engine")                                                                                                                               \
     M(SettingUInt64, dt_segment_delta_limit_size, 42991616, "Max size of segment delta in DeltaTree Engine. 41 MB by default.")                                                                                                         \
+    M(SettingUInt64, dt_segment_delta_read_merge_factor, 32, "Merge the delta of a segment in background when its delta rows times the reads since its last merge reach this factor times dt_segment_delta_limit_rows. 0 to disable.")  \
+    M(SettingUInt64, dt_segment_adaptive_hot_write_rows, 0, "Adapt the segment size to the workload. A segment written more rows per second than this is split at dt_segment_limit_rows, and a segment written less than 1/10 of it is merged at 2/3 of dt_segment_limit_rows. 0 to disable.") \
+    M(SettingUInt64, dt_segment_merge_max_segments, 16, "Max number of consecutive small segments merged into one segment by a background merge. 2 to only merge a segment with its next segment.")                                     \
+    M(SettingUInt64, dt_stable_fast_path_hot_reads_per_minute, 0, "Put the stable DTFiles of the segments read more times per minute than this on the fast paths, i.e. the latest paths that are not main paths, and move them back to the main paths when read less than half of it. The DTFiles are moved by rewriting the stable in background GC. 0 - disabled.") \
+    M(SettingUInt64, dt_segment_rewrite_concurrency, 1, "The number of threads to rewrite one segment larger than dt_segment_limit_size by merge delta or physical split. 1 to disable.")                                               \
+    M(SettingUInt64, dt_ingest_prepare_concurrency, 4, "The number of threads to generate the column files split on the segment boundaries when ingesting DTFiles into one table. 1 to disable.")                                       \
+    M(SettingUInt64, dt_merge_delta_column_group_size, 0, "Write the columns of the new DTFile in groups of this many columns in merge delta, for tables wider than it. 0 to disable.")                                                 \
     M(SettingUInt64, dt_segment_force_merge_delta_deletes, 10, "Delta delete ranges before force merge into stable.")                                                                                                                   \
     M(SettingUInt64, dt_segment_force_merge_delta_rows, 134217728, "Delta rows before force merge into stable.")                                                                                                                        \
     M(SettingUInt64, dt_segment_force_merge_delta_size, 1073741824, "Delta size before force merge into stable. 1 GB by default.")                                                                                                      \
@@ -266,17 +283,21 @@ struct Settings
     M(SettingUInt64, dt_segment_stop_write_delta_size, 2147483648, "Delta size before stop new writes. 2 GB by default.")                                                                                                               \
     M(SettingUInt64, dt_segment_delta_cache_limit_rows, 4096, "Max rows of cache in segment delta in DeltaTree Engine.")                                                                                                                \
     M(SettingUInt64, dt_segment_delta_cache_limit_size, 4194304, "Max size of cache in segment delta in DeltaTree Engine. 4 MB by default.")                                                                                            \
+    M(SettingBool, dt_segment_delta_cache_compress, false, "Compress the sealed in-memory column files of segment delta in DeltaTree Engine, so that more data can be cached before flushing.")                                         \
     M(SettingUInt64, dt_segment_delta_small_pack_rows, 2048, "Deprecated. Reserved for backward compatibility. Use dt_segment_delta_small_column_file_rows instead")                                                                    \
     M(SettingUInt64, dt_segment_delta_small_pack_size, 8388608, "Deprecated. Reserved for backward compatibility. Use dt_segment_delta_small_column_file_size instead")                                                                 \
     M(SettingUInt64, dt_segment_delta_small_column_file_rows, 2048, "Determine whether a column file in delta is small or not. 8MB by default.")                                                                                        \
     M(SettingUInt64, dt_segment_delta_small_column_file_size, 8388608, "Determine whether a column file in delta is small or not. 8MB by default.")                                                                                     \
     M(SettingUInt64, dt_segment_stable_pack_rows, DEFAULT_MERGE_BLOCK_SIZE, "Expected stable pack rows in DeltaTree Engine.")                                                                                                           \
     M(SettingFloat, dt_segment_wait_duration_factor, 1, "The factor of wait duration in a write stall.")                                                                                                                                \
+    M(SettingUInt64, dt_snapshot_prehandle_write_concurrency, 1, "The number of threads writing the DTFiles when pre-handling one snapshot. 1 means writing all rows into one DTFile serially.")                                        \
+    M(SettingUInt64, dt_snapshot_prehandle_split_file_rows, 262144, "Rows of each DTFile generated when pre-handling one snapshot with dt_snapshot_prehandle_write_concurrency > 1.")                                                   \
     M(SettingUInt64, dt_bg_gc_check_interval, 60, "Background gc thread check interval, the unit is second.")                                                                                                                           \
     M(SettingInt64, dt_bg_gc_max_segments_to_check_every_round, 100, "Max segments to check in every gc round, value less than or equal to 0 means gc no segments.")                                                                    \
     M(SettingFloat, dt_bg_gc_ratio_threhold_to_trigger_gc, 1.2, "Trigger segment's gc when the ratio of invalid version exceed this threhold. Values smaller than or equal to 1.0 means gc all "                                        \
                                                                 "segments")                                                                                                                                                             \
     M(SettingFloat, dt_bg_gc_delta_delete_ratio_to_trigger_gc, 0.3, "Trigger segment's gc when the ratio of delta delete range to stable exceeds this ratio.")                                                                          \
+    M(SettingFloat, dt_read_gc_garbage_ratio_threshold, 0.5, "Merge the delta of a segment right after reading it when the ratio of obsolete versions in its stable exceeds this threshold. 0 means disabled.")                         \
     M(SettingUInt64, dt_insert_max_rows, 0, "Max rows of insert blocks when write into DeltaTree Engine. By default 0 means no limit.")                                                                                                 \
     M(SettingBool, dt_enable_rough_set_filter, true, "Whether to parse where expression as Rough Set Index filter or not.")                                                                                                             \
     M(SettingBool, dt_raw_filter_range, true, "[unused] Do range filter or not when read data in raw mode in DeltaTree Engine.")                                                                                                        \
@@ -316,14 +337,52 @@ struct Settings
     M(SettingUInt64, dt_checksum_frame_size, DBMS_DEFAULT_BUFFER_SIZE, "Frame size for delta tree stable storage")                                                                                                                      \
                                                                                                                                                                                                                                         \
     M(SettingDouble, dt_storage_blob_heavy_gc_valid_rate, 0.2, "Max valid rate of deciding a blob can be compact")                                                                                                                      \
+    M(SettingUInt64, dt_storage_blob_heavy_gc_max_bytes_per_round, 0, "Max valid bytes of the blobs migrated by one round of blob heavy gc, the blobs reclaiming more space per copied byte are picked first. 0 means unlimited")       \
+    M(SettingUInt64, dt_storage_page_cache_size, 0, "Max bytes of the cache for the small pages read from the blob files of each PageStorage V3 instance. 0 means disabled")                                                            \
+    M(SettingUInt64, dt_storage_blob_prealloc_bytes, 0, "The bytes reserved by fallocate beyond the end of a blob file of PageStorage V3 before appending to it, to reduce the block allocation of small writes. 0 means disabled")     \
     M(SettingDouble, dt_storage_blob_block_alignment_bytes, 0, "Blob IO alignment size")                                                                                                                                                \
+    M(SettingUInt64, dt_storage_restore_concurrency, 1, "The number of threads for restoring PageStorage V3 on startup")                                                                                                                \
     M(SettingBool, dt_enable_read_thread, false, "Enable storage read thread or not")                                                                                                                                                          \
+    M(SettingBool, dt_read_thread_adaptive, false, "Adjust the number of the storage read threads that read tasks by their blocking time and the CPU utilization. Takes effect after restart.")                                                \
+    M(SettingFloat, dt_read_thread_max_ratio, 2, "The maximum number of the storage read threads relative to the CPU cores when dt_read_thread_adaptive is enabled. Takes effect after restart.")                                              \
+    M(SettingBool, dt_enable_cooperative_scan, false, "Let a fast mode read join the in-progress scan of the same DTFile at its current pack and read the skipped packs afterwards. Requires dt_enable_read_thread.")                          \
+    M(SettingBool, dt_enable_read_rows_only, true, "Skip reading the column values of the clean stable packs when only the row count of the table scan is used, such as count(*) without filter.")                                      \
+    M(SettingBool, dt_enable_top_n_pushdown, true, "Skip the stable packs which could not be in the result of the TopN on a single column right above the table scan, such as order by a column with limit and without filter.")        \
+    M(SettingBool, dt_enable_limit_pushdown, true, "Stop reading new segments once enough rows are read for the Limit without order right above the table scan, such as select with limit and without filter.")                         \
+    M(SettingUInt64, dt_io_uring_prefetch_packs, 0, "Read ahead the column data of at least this number of packs of a DTFile by one batch of io_uring. 0 means disabled.")                                                              \
+    M(SettingUInt64, dt_read_ahead_packs, 0, "Load the data of at most this number of following packs of a DTFile in background while decoding the current packs. 0 means disabled.")                                                   \
+    M(SettingUInt64, dt_read_ahead_bytes, 16777216, "The max bytes of the data of a DTFile being loaded in background by dt_read_ahead_packs.")                                                                                         \
+    M(SettingUInt64, dt_read_block_size_bytes, 0, "The expected bytes of the blocks read from DeltaTree Engine, by which the rows of a block are adapted to the average bytes per row of the columns to read. 0 means always use the max_block_size rows.") \
+    M(SettingUInt64, dt_decompressed_block_cache_max_column_bytes, 67108864, "Only the decompressed blocks of the key columns and late materialization filter columns whose data size in a DTFile is not larger than this value are put into the decompressed block cache. 0 means disabled.") \
+    M(SettingUInt64, dt_single_file_read_plan_packs, 0, "For the DTFiles in single file mode, load the data of the read columns for at most this number of packs by a few merged reads. 0 means disabled.")                             \
+    M(SettingUInt64, dt_single_file_read_merge_gap_bytes, 65536, "The byte ranges of the columns in a single file mode DTFile whose gap is not larger than this value are loaded by one read.")                                         \
+    M(SettingBool, dt_enable_mmap_mark_and_index, false, "Read the mark and min-max index files of the not encrypted DTFiles by mmap. The plain marks are used in the mapped memory without being copied into the mark cache.")         \
+    M(SettingUInt64, dt_rough_set_result_cache_per_file, 8, "The number of rough set filter results cached in each DTFile, keyed by the digest of the pushed down filter. 0 to disable the cache.")                                     \
+    M(SettingBool, dt_enable_segment_snapshot_reuse, true, "Let the concurrent reads of a segment share the snapshot of it if the segment has not been written, flushed or compacted since the snapshot is created.")                   \
+    M(SettingBool, dt_enable_exact_fast_mode, false, "Make the reads in fast mode return only the latest version of each row, by filtering out the stable rows superseded by the delta instead of placing the delta.")                  \
     M(SettingDouble, dt_block_slots_scale, 1.0, "Block slots limit of a read request")                                                                                                                                                          \
     M(SettingDouble, dt_active_segments_scale, 1.0, "Acitve segments limit of a read request")                                                                                                                                                          \
+    M(SettingBool, dt_enable_late_materialization, false, "Read the columns of pushed down filter at first and skip reading the other columns of the filtered out rows when doing clean read.")                                         \
+    M(SettingBool, dt_enable_persisted_delta_index, false, "Persist the delta index along with the metadata of delta layer after placing it in background, so that it can be restored lazily instead of rebuilt after reboot.")         \
+    M(SettingBool, region_persister_enable_delta, false, "Persist the changes of a region since its last full snapshot as a delta page, and rewrite the full snapshot only when the changes grow beyond half of the region data size.") \
+    M(SettingUInt64, region_persister_restore_concurrency, 4, "The number of threads to decode the regions persisted in KVStore on restore. 1 to disable.")                                                                             \
+    M(SettingUInt64, region_persister_transform_batch_bytes, 16 * 1024 * 1024, "The max bytes of the pages rewritten into PageStorage V3 by one write batch when transforming KVStore from V2.")                                        \
+    M(SettingUInt64, raft_async_flush_threads, 0, "The number of threads to write the committed rows of raft apply into storage asynchronously. The applied index is advanced after the rows are written. 0 to disable.")               \
+    M(SettingUInt64, raft_async_flush_max_pending_tasks, 64, "The max number of pending flush tasks of each async flush thread, raft apply is blocked when it is exceeded.")                                                            \
+    M(SettingUInt64, raft_async_pre_decode_threads, 0, "The number of threads to decode the committed rows of the async flush tasks into blocks before they are written, only with raft_async_flush_threads. 0 to disable.")            \
+    M(SettingUInt64, raft_batch_apply_concurrency, 4, "The number of threads to apply the write commands of the regions passed by one batched call from proxy. 1 to apply them in the calling thread.")                                 \
+    M(SettingUInt64, raft_hot_region_write_bytes_per_second, 8388608, "A region whose write rate since its last compact log exceeds it is regarded as hot, and its flush thresholds are multiplied by `raft_hot_region_flush_threshold_factor` to coalesce bigger delta writes. 0 to disable.") \
+    M(SettingUInt64, raft_hot_region_flush_threshold_factor, 4, "The factor to multiply the flush thresholds of rows and bytes of hot regions.")                                                                                        \
+    M(SettingUInt64, raft_region_mem_cache_limit_bytes, 0, "The memory budget of the data written by raft apply but not flushed in storage of all regions. Once exceeded, regions holding more than the average are flushed regardless of the thresholds. 0 means unlimited.") \
+    M(SettingUInt64, raft_write_stall_region_cache_bytes, 0, "The max bytes of the committed data kept in a region when the storage segments it writes into are stalled by too large delta, instead of blocking the raft apply. 0 to disable.")                                \
                                                                                                                                                                                                                                         \
     M(SettingChecksumAlgorithm, dt_checksum_algorithm, ChecksumAlgo::XXH3, "Checksum algorithm for delta tree stable storage")                                                                                                          \
     M(SettingCompressionMethod, dt_compression_method, CompressionMethod::LZ4, "The method of data compression when writing.")                                                                                                          \
     M(SettingInt64, dt_compression_level, 1, "The compression level.")                                                                                                                                                                  \
+    M(SettingString, dt_bloom_filter_index_columns, "", "Comma separated names of the columns to build bloom filter index for in DTFiles. Only integer columns are supported.")                                                         \
+    M(SettingUInt64, dt_bloom_filter_bits_per_key, 10, "The number of bits for each value in the bloom filter index, more bits means lower false positive rate.")                                                                       \
+    M(SettingString, dt_delta_for_compression_columns, "", "Comma separated names of the columns to compress by delta and frame of reference in DTFiles, like `_tidb_rowid,_INTERNAL_VERSION,_INTERNAL_DELMARK`. Only fixed-width integer types benefit from it, others fall back to LZ4.") \
+    M(SettingBool, dt_enable_ndv_sketch, false, "Build a HyperLogLog sketch of the distinct values of each column in new DTFiles, see system.dt_segment_columns.")                                                                      \
     M(SettingUInt64, max_rows_in_set, 0, "Maximum size of the set (in number of elements) resulting from the execution of the IN section.")                                                                                             \
     M(SettingUInt64, max_bytes_in_set, 0, "Maximum size of the set (in bytes in memory) resulting from the execution of the IN section.")                                                                                               \
     M(SettingOverflowMode<false>, set_overflow_mode, OverflowMode::THROW, "What to do when the limit is exceeded.")                                                                                                                     \
@@ -341,6 +400,16 @@ struct Settings
     M(SettingOverflowMode<false>, distinct_overflow_mode, OverflowMode::THROW, "What to do when the limit is exceeded.")                                                                                                                \
                                                                                                                                                                                                                                         \
     M(SettingBool, join_concurrent_build, true, "Build hash table concurrently for join.")                                                                                                                                              \
+    M(SettingBool, join_partitioned_build, false, "Scatter the build rows to the segments of the join hash table first, then build every segment by a thread without locking. Only works with join_concurrent_build.")                  \
+    M(SettingUInt64, max_bytes_before_external_join, 0, "Spill the build and probe data of hash join into temporary files when the memory usage passes this threshold. 0 means never spill.")                                           \
+    M(SettingUInt64, join_spill_partition_num, 16, "The number of partitions that the data of a spilled hash join is split into.")                                                                                                      \
+    M(SettingBool, enable_join_runtime_filter, false, "Drop the probe rows of inner and right joins that can not match, by the min/max range and the set of the integer join key of the build side.")                                   \
+    M(SettingBool, enable_broadcast_join_sharing, false, "Build the hash table of a broadcast join only once for all the MPP tasks of the query on this node running the join, the other tasks probe the shared table. Does not work with the joins spilling or outputting the non-joined build rows.") \
+    M(SettingUInt64, join_runtime_filter_max_in_values, 1024, "The maximum number of distinct build keys kept in a join runtime filter, beyond which only the min/max range is used. 0 means only the range.")                          \
+    M(SettingUInt64, join_probe_prefetch_blocks, 0, "The number of probe blocks each join probe stream reads ahead while the hash table is being built, so the probe can start without waiting for its input. 0 means disabled.")       \
+    M(SettingBool, join_nested_loop_cross_join, false, "Evaluate the other conditions of the cartesian inner and anti joins by a nested loop over chunks of the left and right rows, instead of expanding every left row with all the right rows.") \
+    M(SettingUInt64, hash_table_reserve_max_rows, 0, "Reserve the hash tables of join and aggregation ahead for the approximate rows read from the storage, capped by this value. 0 means grow them on demand.")                        \
+    M(SettingBool, enable_window_local_shuffle, false, "Hash partition the input of the window functions by the partition keys into max_threads streams to sort and compute in parallel, when fine grained shuffle is not used.")       \
     M(SettingUInt64, max_memory_usage, 0, "Maximum memory usage for processing of single query. Zero means unlimited.")                                                                                                                 \
     M(SettingUInt64, max_memory_usage_for_user, 0, "Maximum memory usage for processing all concurrently running queries for the user. Zero means unlimited.")                                                                          \
     M(SettingUInt64, max_memory_usage_for_all_queries, 0, "Maximum memory usage for processing all concurrently running queries on the server. Zero means unlimited.")                                                                  \
@@ -353,14 +422,27 @@ struct Settings
                                                              "unlimited.")                                                                                                                                                              \
     M(SettingUInt64, task_scheduler_thread_soft_limit, 5000, "The soft limit of threads for min_tso task scheduler.")                                                                                                                   \
     M(SettingUInt64, task_scheduler_thread_hard_limit, 10000, "The hard limit of threads for min_tso task scheduler.")                                                                                                                  \
+    M(SettingUInt64, task_scheduler_memory_limit, 0, "The memory limit in bytes for min_tso task scheduler to admit the queries newer than the min_tso query, 0 means no memory admission control.")                                    \
+    M(SettingUInt64, task_scheduler_memory_per_stateful_executor, 268435456, "The estimated memory in bytes of each join, aggregation, topn or window executor of a MPP task for the memory admission of min_tso task scheduler.")      \
     M(SettingUInt64, max_grpc_pollers, 200, "The maximum number of grpc thread pool's non-temporary threads, better tune it up to avoid frequent creation/destruction of threads.")                                                     \
     M(SettingBool, enable_elastic_threadpool, true, "Enable elastic thread pool for thread create usages.")                                                                                                                             \
     M(SettingUInt64, elastic_threadpool_init_cap, 400, "The size of elastic thread pool.")                                                                                                                                              \
     M(SettingUInt64, elastic_threadpool_shrink_period_ms, 300000, "The shrink period(ms) of elastic thread pool.")                                                                                                                      \
     M(SettingBool, enable_local_tunnel, true, "Enable local data transfer between local MPP tasks.")                                                                                                                                    \
+    M(SettingBool, enable_local_tunnel_block_exchange, true, "Pass the blocks through the local tunnels directly, without encoding them into the MPP data packets.")                                                                    \
+    M(SettingBool, enable_mpp_exchange_compression, false, "Compress the chunks sent to the remote TiFlash nodes by mpp exchange. The receivers must be able to decode the compressed chunks.")                                         \
+    M(SettingCompressionMethod, mpp_exchange_compression_method, CompressionMethod::LZ4, "The method of compressing the mpp exchange chunks, lz4 or zstd.")                                                                             \
+    M(SettingUInt64, mpp_broadcast_compression_threshold, 0, "Compress the chunks broadcast to the remote TiFlash nodes by mpp_exchange_compression_method once the exchange has sent more bytes than it, 0 means never.")              \
+    M(SettingUInt64, mpp_exchange_batch_bytes, 0, "Squash the blocks of the hash exchange until each partition has about this many bytes before encoding them, instead of batching by batch_send_min_limit rows. 0 disables it.")       \
+    M(SettingUInt64, mpp_exchange_batch_max_delay_ms, 100, "The max time the squashed blocks of mpp_exchange_batch_bytes wait before being sent, so that a slow stream does not stall its receivers.")                                  \
+    M(SettingUInt64, batch_cop_batch_bytes, 0, "Squash the blocks of a batch coprocessor stream until about this many bytes before encoding them into one response, so bulk reads send fewer responses. 0 disables it.")                \
+    M(SettingUInt64, batch_cop_batch_max_delay_ms, 100, "The max time the squashed blocks of batch_cop_batch_bytes wait before being sent.")                                                                                            \
+    M(SettingUInt64, mpp_tunnel_max_inflight_bytes, 0, "The max bytes of the packets in flight of each MPPTunnel, the writer waits for the receiver to consume them when exceeded. 0 means unlimited.")                                 \
+    M(SettingBool, enable_ordered_exchange_receiver, false, "Merge the data of every sender of the exchange receiver under a TopN in order, instead of sorting all of them again. The senders must sort by the same order.")            \
     M(SettingBool, enable_async_grpc_client, true, "Enable async grpc in MPP.")                                                                                                                                                         \
     M(SettingUInt64, grpc_completion_queue_pool_size, 0, "The size of gRPC completion queue pool. 0 means using hardware_concurrency.")                                                                                                 \
     M(SettingBool, enable_async_server, true, "Enable async rpc server.")                                                                                                                                                               \
+    M(SettingBool, enable_async_cop, false, "Handle the cop requests by the async rpc server without blocking its threads. Only works when enable_async_server is true.")                                                               \
     M(SettingUInt64, async_pollers_per_cq, 200, "grpc async pollers per cqs")                                                                                                                                                           \
     M(SettingUInt64, async_cqs, 1, "grpc async cqs")                                                                                                                                                                                    \
     M(SettingUInt64, preallocated_request_count_per_poller, 20, "grpc preallocated_request_count_per_poller")                                                                                                                           \
@@ -803,6 +803,8 @@ public:
             return "city128";
         if (value == ChecksumAlgo::CRC32)
             return "crc32";
+        if (value == ChecksumAlgo::CRC32C)
+            return "crc32c";
         if (value == ChecksumAlgo::CRC64)
             return "crc64";
         if (value == ChecksumAlgo::None)
@@ -820,12 +822,14 @@ private:
             return ChecksumAlgo::City128;
         if (s == "crc32")
             return ChecksumAlgo::CRC32;
+        if (s == "crc32c")
+            return ChecksumAlgo::CRC32C;
         if (s == "crc64")
             return ChecksumAlgo::CRC64;
         if (s == "none")
             return ChecksumAlgo::None;
 
-        throw Exception("Unknown checksum algorithm: '" + s + "', must be one of 'xxh3', 'city128', 'crc32', 'crc64', 'none'", ErrorCodes::INVALID_CONFIG_PARAMETER);
+        throw Exception("Unknown checksum algorithm: '" + s + "', must be one of 'xxh3', 'city128', 'crc32', 'crc32c', 'crc64', 'none'", ErrorCodes::INVALID_CONFIG_PARAMETER);
     }
     ChecksumAlgo value;
 };
@@ -46,6 +46,8 @@ struct SubqueryForSet
     /// If set, build it from result.
     SetPtr set;
     JoinPtr join;
+    /// The join is built by another task sharing it, the source is only read to the end to not block its senders.
+    bool drain_only = false;
 
     /// If set, put the result into the table.
     /// This is a temporary table for transferring to remote servers for distributed query processing.
@@ -114,6 +114,31 @@ struct PartialSortingLessWithCollation
 };
 
 
+/// Sort by the permutation of the leading column, which is radix sorted for the integer columns, and then sort
+/// the rows of the equal leading keys by the other columns. Only the groups overlapping the first `limit` rows
+/// are sorted if `limit` is not 0.
+template <typename Less>
+static void sortByLeadingColumn(const ColumnsWithSortDescriptions & columns, size_t limit, IColumn::Permutation & perm)
+{
+    const auto & [leading_column, leading_description] = columns[0];
+    leading_column->getPermutation(leading_description.direction == -1, 0, leading_description.nulls_direction, perm);
+
+    ColumnsWithSortDescriptions other_columns(columns.begin() + 1, columns.end());
+    Less less(other_columns);
+
+    const size_t size = perm.size();
+    const size_t end = limit ? limit : size;
+    for (size_t i = 0; i < end;)
+    {
+        size_t j = i + 1;
+        while (j < size && leading_column->compareAt(perm[i], perm[j], *leading_column, leading_description.nulls_direction) == 0)
+            ++j;
+        if (j - i > 1)
+            std::sort(perm.begin() + i, perm.begin() + j, less);
+        i = j;
+    }
+}
+
 void sortBlock(Block & block, const SortDescription & description, size_t limit)
 {
     if (!block)
@@ -160,7 +185,17 @@ void sortBlock(Block & block, const SortDescription & description, size_t limit)
             }
         }
 
-        if (need_collation)
+        /// A large limit is cheaper to serve by sorting all the rows by the leading column.
+        const bool sort_by_leading_column = columns_with_sort_desc[0].first->isNumeric() && (limit == 0 || limit * 16 >= size);
+
+        if (sort_by_leading_column)
+        {
+            if (need_collation)
+                sortByLeadingColumn<PartialSortingLessWithCollation>(columns_with_sort_desc, limit, perm);
+            else
+                sortByLeadingColumn<PartialSortingLess>(columns_with_sort_desc, limit, perm);
+        }
+        else if (need_collation)
         {
             PartialSortingLessWithCollation less_with_collation(columns_with_sort_desc);
 
@@ -201,6 +236,57 @@ void stableGetPermutation(const Block & block, const SortDescription & descripti
     std::stable_sort(out_permutation.begin(), out_permutation.end(), PartialSortingLess(columns_with_sort_desc));
 }
 
+void stableGetPermutationByMergingRuns(const Block & block, const SortDescription & description, IColumn::Permutation & out_permutation)
+{
+    if (!block)
+        return;
+
+    size_t size = block.rows();
+    ColumnsWithSortDescriptions columns_with_sort_desc = getColumnsWithSortDescription(block, description);
+    PartialSortingLess less(columns_with_sort_desc);
+
+    /// More runs than this means the rows are mostly random, and sorting them directly is cheaper.
+    const size_t max_runs = std::max<size_t>(1, size / 8);
+    std::vector<size_t> run_starts{0};
+    for (size_t i = 1; i < size; ++i)
+    {
+        if (less(i, i - 1))
+        {
+            run_starts.push_back(i);
+            if (run_starts.size() > max_runs)
+            {
+                stableGetPermutation(block, description, out_permutation);
+                return;
+            }
+        }
+    }
+    run_starts.push_back(size);
+
+    out_permutation.resize(size);
+    for (size_t i = 0; i < size; ++i)
+        out_permutation[i] = i;
+
+    /// Merge the neighbouring runs level by level. `std::inplace_merge` is stable, and the earlier run is always
+    /// the left one, so the result is the same as `stableGetPermutation`.
+    while (run_starts.size() > 2)
+    {
+        std::vector<size_t> merged_starts;
+        size_t i = 0;
+        for (; i + 2 < run_starts.size(); i += 2)
+        {
+            std::inplace_merge(
+                out_permutation.begin() + run_starts[i],
+                out_permutation.begin() + run_starts[i + 1],
+                out_permutation.begin() + run_starts[i + 2],
+                less);
+            merged_starts.push_back(run_starts[i]);
+        }
+        for (; i < run_starts.size(); ++i)
+            merged_starts.push_back(run_starts[i]);
+        run_starts = std::move(merged_starts);
+    }
+}
+
 
 bool isAlreadySorted(const Block & block, const SortDescription & description)
 {
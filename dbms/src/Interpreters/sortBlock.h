@@ -36,6 +36,12 @@ void stableSortBlock(Block & block, const SortDescription & description);
   */
 void stableGetPermutation(const Block & block, const SortDescription & description, IColumn::Permutation & out_permutation);
 
+/** Same as stableGetPermutation, but faster for a block that is made of a few sorted runs, like the delta of a segment,
+  *  which is appended by many small blocks sorted by the primary key. The runs are merged in O(n * log(runs)) instead of
+  *  sorting the whole block. Falls back to stableGetPermutation if the block looks random.
+  */
+void stableGetPermutationByMergingRuns(const Block & block, const SortDescription & description, IColumn::Permutation & out_permutation);
+
 
 /** Quickly check whether the block is already sorted. If the block is not sorted - returns false as fast as possible.
   * Collations are not supported.
@@ -0,0 +1,105 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnString.h>
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <Interpreters/CollatorSortKeys.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+void checkSortKeys(const ColumnString & column, const ColumnString & sort_keys, const TiDB::TiDBCollatorPtr & collator)
+{
+    ASSERT_EQ(sort_keys.size(), column.size());
+    String container;
+    for (size_t i = 0; i < column.size(); ++i)
+    {
+        StringRef value = column.getDataAt(i);
+        StringRef expected = collator->sortKey(value.data, value.size, container);
+        ASSERT_EQ(sort_keys.getDataAt(i).toString(), expected.toString()) << "row " << i;
+    }
+}
+} // namespace
+
+TEST(CollatorSortKeysTest, String)
+{
+    for (auto collation : {TiDB::ITiDBCollator::UTF8MB4_GENERAL_CI, TiDB::ITiDBCollator::UTF8MB4_UNICODE_CI, TiDB::ITiDBCollator::UTF8MB4_BIN})
+    {
+        auto collator = TiDB::ITiDBCollator::getCollator(collation);
+        auto column = ColumnString::create();
+        /// Many repeated values to go through the cache, and distinct ones to get it disabled.
+        for (size_t i = 0; i < 3000; ++i)
+        {
+            if (i < 1500)
+                column->insert(Field(String(i % 3 == 0 ? "Abc " : (i % 3 == 1 ? "aBC" : "ß\xC3\x80"))));
+            else
+                column->insert(Field("Value" + std::to_string(i)));
+        }
+        auto sort_keys = materializeSortKeys(*column, collator);
+        ASSERT_NE(sort_keys, nullptr);
+        checkSortKeys(*column, typeid_cast<const ColumnString &>(*sort_keys), collator);
+    }
+}
+
+TEST(CollatorSortKeysTest, Nullable)
+{
+    auto collator = TiDB::ITiDBCollator::getCollator(TiDB::ITiDBCollator::UTF8MB4_GENERAL_CI);
+    auto nested = ColumnString::create();
+    auto null_map = ColumnUInt8::create();
+    for (const auto * value : {"a", "", "A ", "b"})
+    {
+        nested->insert(Field(String(value)));
+        null_map->insert(Field(static_cast<UInt64>(value[0] == 0)));
+    }
+    auto column = ColumnNullable::create(std::move(nested), std::move(null_map));
+    auto sort_keys = materializeSortKeys(*column, collator);
+    ASSERT_NE(sort_keys, nullptr);
+    const auto & nullable_sort_keys = typeid_cast<const ColumnNullable &>(*sort_keys);
+    ASSERT_EQ(&nullable_sort_keys.getNullMapColumn(), &column->getNullMapColumn());
+    checkSortKeys(typeid_cast<const ColumnString &>(column->getNestedColumn()), typeid_cast<const ColumnString &>(nullable_sort_keys.getNestedColumn()), collator);
+}
+
+TEST(CollatorSortKeysTest, KeyColumns)
+{
+    auto collator = TiDB::ITiDBCollator::getCollator(TiDB::ITiDBCollator::UTF8MB4_GENERAL_CI);
+    auto bin_collator = TiDB::ITiDBCollator::getCollator(TiDB::ITiDBCollator::UTF8MB4_BIN);
+    auto strings = ColumnString::create();
+    strings->insert(Field(String("a")));
+    auto numbers = ColumnInt64::create();
+    numbers->insert(Field(static_cast<Int64>(1)));
+
+    ColumnRawPtrs key_columns{strings.get(), strings.get(), numbers.get()};
+    TiDB::TiDBCollators collators{collator, bin_collator, collator};
+    Columns materialized_columns;
+    materializeSortKeys(key_columns, collators, materialized_columns);
+
+    ASSERT_EQ(materialized_columns.size(), 1);
+    ASSERT_EQ(key_columns[0], materialized_columns[0].get());
+    ASSERT_EQ(collators[0], nullptr);
+    /// The binary collators and the non string columns are untouched.
+    ASSERT_EQ(key_columns[1], strings.get());
+    ASSERT_EQ(collators[1], bin_collator);
+    ASSERT_EQ(key_columns[2], numbers.get());
+    ASSERT_EQ(collators[2], collator);
+}
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,175 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Functions/FunctionFactory.h>
+#include <Functions/FunctionFusedPredicate.h>
+#include <Interpreters/Context.h>
+#include <Interpreters/ExpressionActions.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+class ExpressionFusionTest : public FunctionTest
+{
+protected:
+    struct FunctionDesc
+    {
+        String name;
+        Names arguments;
+        String result;
+    };
+
+    ExpressionActionsPtr buildActions(
+        const Block & input,
+        const ColumnsWithTypeAndName & constants,
+        const std::vector<FunctionDesc> & functions,
+        const String & output,
+        bool enable_fusion)
+    {
+        Settings settings = context.getSettings();
+        settings.enable_expression_fusion = enable_fusion;
+        auto actions = std::make_shared<ExpressionActions>(input.getNamesAndTypesList(), settings);
+        for (const auto & constant : constants)
+            actions->add(ExpressionAction::addColumn(constant));
+        for (const auto & function : functions)
+            actions->add(ExpressionAction::applyFunction(FunctionFactory::instance().get(function.name, context), function.arguments, function.result));
+        actions->finalize({output});
+        return actions;
+    }
+
+    static size_t countFunctions(const ExpressionActions & actions, const String & name)
+    {
+        size_t count = 0;
+        for (const auto & action : actions.getActions())
+        {
+            if (action.type == ExpressionAction::APPLY_FUNCTION && action.function->getName() == name)
+                ++count;
+        }
+        return count;
+    }
+
+    void checkFusion(
+        const Block & input,
+        const ColumnsWithTypeAndName & constants,
+        const std::vector<FunctionDesc> & functions,
+        size_t expected_fused)
+    {
+        const String & output = functions.back().result;
+        auto interpreted = buildActions(input, constants, functions, output, false);
+        auto fused = buildActions(input, constants, functions, output, true);
+        ASSERT_EQ(countFunctions(*interpreted, FunctionFusedPredicate::name), 0);
+        ASSERT_EQ(countFunctions(*fused, FunctionFusedPredicate::name), expected_fused);
+
+        Block expected = input;
+        interpreted->execute(expected);
+        Block actual = input;
+        fused->execute(actual);
+        ASSERT_COLUMN_EQ(expected.getByName(output), actual.getByName(output));
+    }
+};
+
+TEST_F(ExpressionFusionTest, ComparisonsAndLogical)
+try
+{
+    /// More rows than a chunk to check the chunks are continued correctly.
+    const size_t rows = FunctionFusedPredicate::chunk_rows * 2 + 100;
+    InferredDataVector<Nullable<Int32>> a;
+    InferredDataVector<UInt64> b;
+    InferredDataVector<Float64> c;
+    InferredDataVector<Nullable<UInt8>> d;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (i % 7 == 0)
+            a.push_back(std::nullopt);
+        else
+            a.push_back(static_cast<Int32>(i % 23) - 11);
+        b.push_back(i % 5);
+        c.push_back(static_cast<Float64>(i % 11) / 2);
+        if (i % 3 == 0)
+            d.push_back(std::nullopt);
+        else
+            d.push_back(static_cast<UInt8>(i % 2));
+    }
+    Block input{
+        createColumn<Nullable<Int32>>(a, "a"),
+        createColumn<UInt64>(b, "b"),
+        createColumn<Float64>(c, "c"),
+        createColumn<Nullable<UInt8>>(d, "d")};
+    ColumnsWithTypeAndName constants{
+        createConstColumn<Float64>(1, 2.5, "c_2.5"),
+        createConstColumn<Int64>(1, -1, "c_-1")};
+
+    /// (a > b and c < 2.5) or not d or a = -1
+    checkFusion(
+        input,
+        constants,
+        {{"greater", {"a", "b"}, "gt"},
+         {"less", {"c", "c_2.5"}, "lt"},
+         {"and", {"gt", "lt"}, "and"},
+         {"not", {"d"}, "not"},
+         {"equals", {"a", "c_-1"}, "eq"},
+         {"or", {"and", "not", "eq"}, "res"}},
+        1);
+
+    /// The logical functions on the inputs directly, and comparisons of booleans.
+    checkFusion(
+        input,
+        constants,
+        {{"and", {"d", "a"}, "and"},
+         {"notEquals", {"and", "d"}, "ne"},
+         {"or", {"ne", "b"}, "res"}},
+        1);
+
+    /// `gt` is also read by `or`, so it is an input of the fused `and` instead of a part of it.
+    checkFusion(
+        input,
+        constants,
+        {{"greater", {"a", "b"}, "gt"},
+         {"lessOrEquals", {"c", "b"}, "le"},
+         {"and", {"gt", "le"}, "and"},
+         {"or", {"and", "gt"}, "res"}},
+        1);
+}
+CATCH
+
+TEST_F(ExpressionFusionTest, NotFusable)
+try
+{
+    Block input{
+        createColumn<String>({"x", "y"}, "s"),
+        createColumn<Int64>({1, 2}, "i")};
+    ColumnsWithTypeAndName constants{createConstColumn<String>(1, "x", "c_x")};
+
+    /// Strings are not fused, and a single comparison is left as it is.
+    checkFusion(
+        input,
+        constants,
+        {{"equals", {"s", "c_x"}, "eq"},
+         {"greater", {"i", "i"}, "gt"},
+         {"and", {"eq", "gt"}, "res"}},
+        1);
+    checkFusion(
+        input,
+        constants,
+        {{"equals", {"s", "c_x"}, "res"}},
+        0);
+}
+CATCH
+
+} // namespace tests
+} // namespace DB
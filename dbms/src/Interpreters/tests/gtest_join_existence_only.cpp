@@ -0,0 +1,72 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Interpreters/Join.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+JoinPtr buildJoin(ASTTableJoin::Kind kind, const Block & build_block)
+{
+    auto join = std::make_shared<Join>(Names{"a"}, Names{"b"}, false, SizeLimits(), kind, ASTTableJoin::Strictness::Any, "test");
+    join->init(build_block.cloneEmpty());
+    join->insertFromBlock(build_block);
+    return join;
+}
+
+std::vector<Int64> probe(const Join & join, const std::vector<Int64> & keys)
+{
+    Block block{createColumn<Int64>(InferredDataVector<Int64>(keys), "a")};
+    join.joinBlock(block);
+    const auto & data = typeid_cast<const ColumnInt64 &>(*block.getByName("a").column).getData();
+    return std::vector<Int64>(data.begin(), data.end());
+}
+} // namespace
+
+TEST(JoinExistenceOnlyTest, SemiJoin)
+{
+    Block build_block{createColumn<Int64>({2, 3, 3, 4}, "b")};
+    auto join = buildJoin(ASTTableJoin::Kind::Inner, build_block);
+    ASSERT_TRUE(join->isExistenceOnly());
+    ASSERT_EQ(join->getTotalRowCount(), 3);
+    ASSERT_EQ(probe(*join, {1, 2, 3, 5}), (std::vector<Int64>{2, 3}));
+}
+
+TEST(JoinExistenceOnlyTest, AntiJoin)
+{
+    Block build_block{createColumn<Int64>({2, 3, 4}, "b"), createColumn<String>({"x", "y", "z"}, "c")};
+    auto join = buildJoin(ASTTableJoin::Kind::Anti, build_block);
+    ASSERT_TRUE(join->isExistenceOnly());
+    ASSERT_EQ(probe(*join, {1, 2, 3, 5}), (std::vector<Int64>{1, 5}));
+}
+
+TEST(JoinExistenceOnlyTest, InnerJoinWithBuildColumns)
+{
+    Block build_block{createColumn<Int64>({2, 3}, "b"), createColumn<String>({"x", "y"}, "c")};
+    auto join = buildJoin(ASTTableJoin::Kind::Inner, build_block);
+    ASSERT_FALSE(join->isExistenceOnly());
+    ASSERT_EQ(probe(*join, {1, 2, 3}), (std::vector<Int64>{2, 3}));
+}
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,117 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Interpreters/JoinRuntimeFilter.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+template <typename T>
+ColumnPtr createColumn(const std::vector<T> & values)
+{
+    auto column = ColumnVector<T>::create();
+    for (const auto & value : values)
+        column->insert(Field(value));
+    return column;
+}
+
+template <typename T>
+IColumn::Filter applyFilter(const JoinRuntimeFilter & runtime_filter, const std::vector<T> & values)
+{
+    auto column = createColumn(values);
+    IColumn::Filter filter(values.size(), 1);
+    runtime_filter.filter(*column, filter);
+    return filter;
+}
+} // namespace
+
+TEST(JoinRuntimeFilterTest, SupportedKeyType)
+{
+    ASSERT_TRUE(JoinRuntimeFilter::isSupportedKeyType(std::make_shared<DataTypeInt64>()));
+    ASSERT_TRUE(JoinRuntimeFilter::isSupportedKeyType(std::make_shared<DataTypeUInt8>()));
+    ASSERT_TRUE(JoinRuntimeFilter::isSupportedKeyType(makeNullable(std::make_shared<DataTypeInt32>())));
+    ASSERT_FALSE(JoinRuntimeFilter::isSupportedKeyType(std::make_shared<DataTypeString>()));
+    ASSERT_FALSE(JoinRuntimeFilter::isSupportedKeyType(std::make_shared<DataTypeFloat64>()));
+}
+
+TEST(JoinRuntimeFilterTest, InValuesAndRange)
+try
+{
+    JoinRuntimeFilter runtime_filter(std::make_shared<DataTypeInt64>(), 10);
+    runtime_filter.insert(*createColumn<Int64>({-5, 3}));
+    runtime_filter.insert(*createColumn<Int64>({7, 3}));
+    ASSERT_TRUE(runtime_filter.hasInValues());
+    ASSERT_EQ(runtime_filter.inValuesSize(), 3);
+
+    auto filter = applyFilter<Int64>(runtime_filter, {-6, -5, 0, 3, 7, 8});
+    ASSERT_EQ(filter, IColumn::Filter({0, 1, 0, 1, 1, 0}));
+}
+CATCH
+
+TEST(JoinRuntimeFilterTest, RangeOnly)
+try
+{
+    /// More keys than `max_in_values`, only the range is kept.
+    JoinRuntimeFilter runtime_filter(std::make_shared<DataTypeUInt64>(), 2);
+    runtime_filter.insert(*createColumn<UInt64>({10, 20, 30}));
+    ASSERT_FALSE(runtime_filter.hasInValues());
+
+    auto filter = applyFilter<UInt64>(runtime_filter, {9, 10, 15, 30, 31});
+    ASSERT_EQ(filter, IColumn::Filter({0, 1, 1, 1, 0}));
+}
+CATCH
+
+TEST(JoinRuntimeFilterTest, NullKeys)
+try
+{
+    auto key_type = makeNullable(std::make_shared<DataTypeInt32>());
+    JoinRuntimeFilter runtime_filter(key_type, 10);
+
+    auto build_column = key_type->createColumn();
+    build_column->insert(Field(static_cast<Int64>(1)));
+    build_column->insert(Field());
+    runtime_filter.insert(*build_column);
+    ASSERT_EQ(runtime_filter.inValuesSize(), 1);
+
+    auto probe_column = key_type->createColumn();
+    probe_column->insert(Field(static_cast<Int64>(1)));
+    probe_column->insert(Field());
+    probe_column->insert(Field(static_cast<Int64>(0)));
+    IColumn::Filter filter(3, 1);
+    runtime_filter.filter(*probe_column, filter);
+    ASSERT_EQ(filter, IColumn::Filter({1, 0, 0}));
+}
+CATCH
+
+TEST(JoinRuntimeFilterTest, EmptyBuild)
+try
+{
+    JoinRuntimeFilter runtime_filter(std::make_shared<DataTypeInt64>(), 10);
+    auto filter = applyFilter<Int64>(runtime_filter, {1, 2});
+    ASSERT_EQ(filter, IColumn::Filter({0, 0}));
+}
+CATCH
+
+} // namespace tests
+} // namespace DB
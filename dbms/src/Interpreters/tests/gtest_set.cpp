@@ -0,0 +1,95 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Interpreters/Set.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <set>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+template <typename T>
+void checkSetExecute(size_t set_size, bool nullable)
+{
+    auto type = std::make_shared<DataTypeNumber<T>>();
+    Set set(SizeLimits{});
+    set.setHeader(Block{{type->createColumn(), type, "_0"}});
+
+    std::set<T> expected_set;
+    auto set_column = type->createColumn();
+    for (size_t i = 0; i < set_size; ++i)
+    {
+        // keep zero in the set
+        T value = static_cast<T>(i * 3 / 2);
+        set_column->insert(Field(static_cast<typename NearestFieldType<T>::Type>(value)));
+        expected_set.insert(value);
+    }
+    set.insertFromBlock(Block{{std::move(set_column), type, "_0"}}, false);
+
+    const size_t rows = set_size * 3 + 10;
+    auto column = ColumnVector<T>::create();
+    auto null_map = ColumnUInt8::create();
+    for (size_t i = 0; i < rows; ++i)
+    {
+        column->insert(Field(static_cast<typename NearestFieldType<T>::Type>(static_cast<T>(i))));
+        null_map->insert(Field(static_cast<UInt64>(i % 7 == 0)));
+    }
+
+    Block block;
+    if (nullable)
+        block.insert({ColumnNullable::create(std::move(column), std::move(null_map)), makeNullable(type), "a"});
+    else
+        block.insert({std::move(column), type, "a"});
+
+    for (bool negative : {false, true})
+    {
+        auto res = set.execute(block, negative);
+        const auto & res_data = typeid_cast<const ColumnUInt8 &>(*res).getData();
+        ASSERT_EQ(res_data.size(), rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            bool found = expected_set.count(static_cast<T>(i)) > 0;
+            if (nullable && i % 7 == 0)
+                found = false;
+            ASSERT_EQ(res_data[i], static_cast<UInt8>(negative ^ found)) << "set_size=" << set_size << " row=" << i;
+        }
+    }
+}
+} // namespace
+
+TEST(SetTest, Execute)
+{
+    // cover the linear compare, binary search and hash table
+    for (size_t set_size : {0, 1, 3, 16, 17, 100, 256, 500})
+    {
+        for (bool nullable : {false, true})
+        {
+            checkSetExecute<Int64>(set_size, nullable);
+            checkSetExecute<UInt32>(set_size, nullable);
+            checkSetExecute<Int16>(set_size, nullable);
+        }
+    }
+}
+
+} // namespace tests
+} // namespace DB
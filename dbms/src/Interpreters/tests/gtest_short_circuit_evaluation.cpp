@@ -0,0 +1,169 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Functions/FunctionFactory.h>
+#include <Interpreters/Context.h>
+#include <Interpreters/ExpressionActions.h>
+#include <Interpreters/FunctionShortCircuitLogical.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+namespace DB
+{
+namespace tests
+{
+class ShortCircuitEvaluationTest : public FunctionTest
+{
+protected:
+    struct FunctionDesc
+    {
+        String name;
+        Names arguments;
+        String result;
+    };
+
+    ExpressionActionsPtr buildActions(
+        const Block & input,
+        const ColumnsWithTypeAndName & constants,
+        const std::vector<FunctionDesc> & functions,
+        const String & output,
+        bool enable_short_circuit)
+    {
+        Settings settings = context.getSettings();
+        settings.enable_short_circuit_evaluation = enable_short_circuit;
+        auto actions = std::make_shared<ExpressionActions>(input.getNamesAndTypesList(), settings);
+        for (const auto & constant : constants)
+            actions->add(ExpressionAction::addColumn(constant));
+        for (const auto & function : functions)
+            actions->add(ExpressionAction::applyFunction(FunctionFactory::instance().get(function.name, context), function.arguments, function.result));
+        actions->finalize({output});
+        return actions;
+    }
+
+    static size_t countFunctions(const ExpressionActions & actions, const String & name)
+    {
+        size_t count = 0;
+        for (const auto & action : actions.getActions())
+        {
+            if (action.type == ExpressionAction::APPLY_FUNCTION && action.function->getName() == name)
+                ++count;
+        }
+        return count;
+    }
+
+    void checkShortCircuit(
+        const Block & input,
+        const ColumnsWithTypeAndName & constants,
+        const std::vector<FunctionDesc> & functions,
+        size_t expected_short_circuit,
+        size_t expected_remaining_functions)
+    {
+        const String & output = functions.back().result;
+        auto eager = buildActions(input, constants, functions, output, false);
+        auto lazy = buildActions(input, constants, functions, output, true);
+        ASSERT_EQ(countFunctions(*eager, FunctionShortCircuitLogical::name), 0);
+        ASSERT_EQ(countFunctions(*lazy, FunctionShortCircuitLogical::name), expected_short_circuit);
+
+        size_t remaining_functions = 0;
+        for (const auto & action : lazy->getActions())
+            remaining_functions += action.type == ExpressionAction::APPLY_FUNCTION;
+        ASSERT_EQ(remaining_functions, expected_remaining_functions);
+
+        Block expected = input;
+        eager->execute(expected);
+        Block actual = input;
+        lazy->execute(actual);
+        ASSERT_COLUMN_EQ(expected.getByName(output), actual.getByName(output));
+    }
+};
+
+TEST_F(ShortCircuitEvaluationTest, AndOr)
+try
+{
+    const size_t rows = 1000;
+    InferredDataVector<Nullable<String>> s;
+    InferredDataVector<Nullable<Int64>> i;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        if (row % 7 == 0)
+            s.push_back(std::nullopt);
+        else
+            s.push_back(String(row % 5, 'x'));
+        if (row % 11 == 0)
+            i.push_back(std::nullopt);
+        else
+            i.push_back(static_cast<Int64>(row % 13) - 6);
+    }
+    Block input{
+        createColumn<Nullable<String>>(s, "s"),
+        createColumn<Nullable<Int64>>(i, "i")};
+    ColumnsWithTypeAndName constants{
+        createConstColumn<Int64>(1, 0, "c_0"),
+        createConstColumn<Int64>(1, 3, "c_3")};
+
+    /// i > 0 and length(s) + i = 3
+    checkShortCircuit(
+        input,
+        constants,
+        {{"greater", {"i", "c_0"}, "gt"},
+         {"length", {"s"}, "len"},
+         {"plus", {"len", "i"}, "sum"},
+         {"equals", {"sum", "c_3"}, "eq"},
+         {"and", {"gt", "eq"}, "res"}},
+        1,
+        2);
+
+    /// i > 0 or (length(s) = 3 and i < 0), the nested `and` is moved into the term of `or`.
+    checkShortCircuit(
+        input,
+        constants,
+        {{"greater", {"i", "c_0"}, "gt"},
+         {"length", {"s"}, "len"},
+         {"equals", {"len", "c_3"}, "eq"},
+         {"less", {"i", "c_0"}, "lt"},
+         {"and", {"eq", "lt"}, "and"},
+         {"or", {"gt", "and"}, "res"}},
+        1,
+        2);
+
+    /// `len` is also read by `ne`, so it is computed on all the rows, and both `and` and `or` evaluate their last terms lazily.
+    checkShortCircuit(
+        input,
+        constants,
+        {{"greater", {"i", "c_0"}, "gt"},
+         {"length", {"s"}, "len"},
+         {"equals", {"len", "c_3"}, "eq"},
+         {"and", {"gt", "eq"}, "and"},
+         {"notEquals", {"len", "c_0"}, "ne"},
+         {"or", {"and", "ne"}, "res"}},
+        2,
+        4);
+}
+CATCH
+
+TEST_F(ShortCircuitEvaluationTest, NothingToShortCircuit)
+try
+{
+    Block input{
+        createColumn<Nullable<UInt8>>({1, 0, {}, 1}, "a"),
+        createColumn<UInt8>({0, 1, 1, 1}, "b")};
+
+    /// The terms are inputs, there is no action to evaluate lazily.
+    checkShortCircuit(input, {}, {{"and", {"a", "b"}, "res"}}, 0, 1);
+}
+CATCH
+
+} // namespace tests
+} // namespace DB
@@ -0,0 +1,125 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnsNumber.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Interpreters/sortBlock.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <random>
+
+namespace DB
+{
+namespace tests
+{
+namespace
+{
+Block createBlock(const std::vector<std::pair<Int64, UInt64>> & rows)
+{
+    auto handle = ColumnInt64::create();
+    auto version = ColumnUInt64::create();
+    for (const auto & [h, v] : rows)
+    {
+        handle->insert(h);
+        version->insert(v);
+    }
+    return Block{
+        {std::move(handle), std::make_shared<DataTypeInt64>(), "handle"},
+        {std::move(version), std::make_shared<DataTypeUInt64>(), "version"}};
+}
+
+void checkSameAsStableSort(const std::vector<std::pair<Int64, UInt64>> & rows)
+{
+    Block block = createBlock(rows);
+    SortDescription sort{{"handle", 1, 1}, {"version", 1, 1}};
+
+    IColumn::Permutation expected;
+    stableGetPermutation(block, sort, expected);
+    IColumn::Permutation actual;
+    stableGetPermutationByMergingRuns(block, sort, actual);
+    ASSERT_EQ(std::vector<UInt64>(actual.begin(), actual.end()), std::vector<UInt64>(expected.begin(), expected.end()));
+}
+
+/// The rows equal on all the sort columns are the same, so the values must be the same as the stable sort.
+void checkSortBlock(const Block & block, const SortDescription & sort, size_t limit)
+{
+    IColumn::Permutation expected_perm;
+    stableGetPermutation(block, sort, expected_perm);
+    size_t expected_rows = limit ? std::min(limit, block.rows()) : block.rows();
+
+    Block sorted = block;
+    sortBlock(sorted, sort, limit);
+    ASSERT_EQ(sorted.rows(), expected_rows);
+    for (size_t col = 0; col < block.columns(); ++col)
+    {
+        const auto & origin = *block.getByPosition(col).column;
+        const auto & actual = *sorted.getByPosition(col).column;
+        for (size_t i = 0; i < expected_rows; ++i)
+            ASSERT_EQ(actual.getInt(i), origin.getInt(expected_perm[i])) << "column=" << col << " row=" << i << " limit=" << limit;
+    }
+}
+} // namespace
+
+TEST(SortBlockTest, IntegerKeys)
+{
+    std::mt19937_64 rng(42);
+    std::vector<std::pair<Int64, UInt64>> rows;
+    for (size_t i = 0; i < 1000; ++i)
+        rows.emplace_back(static_cast<Int64>(rng() % 200) - 100, rng() % 10);
+    Block block = createBlock(rows);
+
+    for (size_t limit : {0, 10, 100, 1000, 2000})
+    {
+        for (int direction : {1, -1})
+        {
+            checkSortBlock(block, {{"handle", direction, 1}}, limit);
+            checkSortBlock(block, {{"version", direction, 1}}, limit);
+            // The leading integer column is sorted first, and the ties by the other column.
+            checkSortBlock(block, {{"handle", direction, 1}, {"version", -direction, 1}}, limit);
+            checkSortBlock(block, {{"version", direction, 1}, {"handle", direction, 1}}, limit);
+        }
+    }
+}
+
+TEST(SortBlockTest, MergingRuns)
+{
+    checkSameAsStableSort({});
+    checkSameAsStableSort({{1, 1}});
+
+    // Several sorted runs, with duplicated keys across the runs, like writes to hot keys.
+    std::vector<std::pair<Int64, UInt64>> rows;
+    for (UInt64 version = 1; version <= 20; ++version)
+    {
+        for (Int64 handle = 0; handle < 100; handle += version % 3 + 1)
+            rows.emplace_back(handle, version);
+        rows.emplace_back(50, version - 1);
+        rows.emplace_back(50, version - 1);
+    }
+    checkSameAsStableSort(rows);
+
+    // The number of runs is odd.
+    rows.emplace_back(-1, 0);
+    checkSameAsStableSort(rows);
+
+    // Random rows, which falls back to sorting.
+    std::mt19937_64 rng(42);
+    rows.clear();
+    for (size_t i = 0; i < 1000; ++i)
+        rows.emplace_back(static_cast<Int64>(rng() % 100), rng() % 10);
+    checkSameAsStableSort(rows);
+}
+
+} // namespace tests
+} // namespace DB
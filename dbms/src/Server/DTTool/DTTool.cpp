@@ -12,10 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/Exception.h>
+#include <Common/Stopwatch.h>
 #include <Server/DTTool/DTTool.h>
+#include <Storages/DeltaMerge/File/DMFile.h>
+#include <common/ThreadPool.h>
+#include <common/logger_useful.h>
+#include <fmt/ranges.h>
 
+#include <atomic>
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <mutex>
 
 namespace bpo = boost::program_options;
 
@@ -97,4 +105,75 @@ int mainEntryTiFlashDTTool(int argc, char ** argv)
 
     return 0;
 }
+
+namespace detail
+{
+std::vector<size_t> listTargetFiles(const DB::Context & context, const std::string & workdir, bool all_files, size_t file_id)
+{
+    if (!all_files)
+        return {file_id};
+
+    auto file_ids = DB::DM::DMFile::listAllInPath(context.getFileProvider(), workdir, DB::DM::DMFile::ListOptions{.only_list_can_gc = false, .clean_up = false});
+    return std::vector<size_t>(file_ids.begin(), file_ids.end());
+}
+
+DB::WriteLimiterPtr createIOLimiter(size_t io_rate_limit)
+{
+    if (io_rate_limit == 0)
+        return nullptr;
+    return std::make_shared<DB::WriteLimiter>(io_rate_limit, DB::LimiterType::UNKNOW);
+}
+
+size_t processFiles(
+    const std::vector<size_t> & file_ids,
+    size_t threads,
+    const std::string & action,
+    Poco::Logger * logger,
+    const std::function<size_t(size_t)> & task)
+{
+    Stopwatch watch;
+    std::atomic<size_t> total_bytes = 0;
+    std::mutex failed_mutex;
+    std::vector<size_t> failed_files;
+    auto run = [&](size_t file_id) {
+        try
+        {
+            total_bytes += task(file_id);
+        }
+        catch (...)
+        {
+            DB::tryLogCurrentException(logger, fmt::format("{} dmf_{} failed", action, file_id));
+            std::lock_guard lock(failed_mutex);
+            failed_files.push_back(file_id);
+        }
+    };
+
+    threads = std::max<size_t>(1, std::min(threads, file_ids.size()));
+    if (threads == 1)
+    {
+        for (auto file_id : file_ids)
+            run(file_id);
+    }
+    else
+    {
+        ThreadPool pool(threads);
+        for (auto file_id : file_ids)
+            pool.schedule([&run, file_id] { run(file_id); });
+        pool.wait();
+    }
+
+    auto seconds = watch.elapsedSeconds();
+    LOG_FMT_INFO(
+        logger,
+        "{} {} files done, failed: {} {}, bytes: {}, time: {:.3f}s, throughput: {:.3f} MiB/s",
+        action,
+        file_ids.size(),
+        failed_files.size(),
+        failed_files,
+        total_bytes.load(),
+        seconds,
+        seconds > 0 ? total_bytes.load() / 1024.0 / 1024.0 / seconds : 0.0);
+    return failed_files.size();
+}
+} // namespace detail
 } // namespace DTTool
@@ -17,6 +17,7 @@
 #include <Common/UnifiedLogPatternFormatter.h>
 #include <Encryption/DataKeyManager.h>
 #include <Encryption/MockKeyManager.h>
+#include <Encryption/RateLimiter.h>
 #include <Poco/ConsoleChannel.h>
 #include <Poco/File.h>
 #include <Poco/FormattingChannel.h>
@@ -31,6 +32,7 @@
 #include <pingcap/Config.h>
 
 #include <ext/scope_guard.h>
+#include <functional>
 #include <string>
 #include <vector>
 #define _TO_STRING(X) #X
@@ -54,6 +56,11 @@ struct InspectArgs
     bool check;
     size_t file_id;
     std::string workdir;
+    // Inspect all the DTFiles under `workdir` instead of `file_id`.
+    bool all_files = false;
+    size_t threads = 1;
+    // The max bytes read per second, 0 means no limit.
+    size_t io_rate_limit = 0;
 };
 int inspectEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_function);
 } // namespace DTTool::Inspect
@@ -71,6 +78,11 @@ struct MigrateArgs
     std::string workdir;
     DB::CompressionMethod compression_method;
     int compression_level;
+    // Migrate all the DTFiles under `workdir` instead of `file_id`.
+    bool all_files = false;
+    size_t threads = 1;
+    // The max bytes read per second, 0 means no limit.
+    size_t io_rate_limit = 0;
 };
 int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_function);
 } // namespace DTTool::Migrate
@@ -80,6 +92,22 @@ namespace DTTool
 namespace detail
 {
 using namespace DB;
+
+/// Return `file_id`, or the ids of all the readable DTFiles under `workdir` if `all_files` is set.
+std::vector<size_t> listTargetFiles(const DB::Context & context, const std::string & workdir, bool all_files, size_t file_id);
+
+/// Throttle the IO of a subcommand so that it can run beside a live server, nullptr if `io_rate_limit` is 0.
+DB::WriteLimiterPtr createIOLimiter(size_t io_rate_limit);
+
+/// Run `task` on each of `file_ids` by `threads` workers, `task` returns the bytes it has processed.
+/// A failed file is logged without stopping the others, and the throughput is summarized at last.
+/// Return the number of failed files.
+size_t processFiles(
+    const std::vector<size_t> & file_ids,
+    size_t threads,
+    const std::string & action,
+    Poco::Logger * logger,
+    const std::function<size_t(size_t)> & task);
 class ImitativeEnv
 {
     DB::ContextPtr createImitativeContext(const std::string & workdir, bool encryption = false)
@@ -45,7 +45,7 @@ static constexpr char BENCH_HELP[] =
     "Available Arguments:\n"
     "  --help        Print help message and exit.\n"
     "  --version     DTFile version. [default: 2] [available: 1, 2]\n"
-    "  --algorithm   Checksum algorithm. [default: xxh3] [available: xxh3, city128, crc32, crc64, none]\n"
+    "  --algorithm   Checksum algorithm. [default: xxh3] [available: xxh3, city128, crc32, crc32c, crc64, none]\n"
     "  --frame       Checksum frame length. [default: " TO_STRING(TIFLASH_DEFAULT_CHECKSUM_FRAME_SIZE) "]\n"
     "  --column      Column number. [default: 100]\n"
     "  --size        Column size.   [default: 1000]\n"
@@ -242,6 +242,10 @@ int benchEntry(const std::vector<std::string> & opts)
         {
             algorithm = DB::ChecksumAlgo::CRC32;
         }
+        else if (algorithm_config == "crc32c")
+        {
+            algorithm = DB::ChecksumAlgo::CRC32C;
+        }
         else if (algorithm_config == "crc64")
         {
             algorithm = DB::ChecksumAlgo::CRC64;
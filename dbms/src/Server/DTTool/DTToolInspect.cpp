@@ -33,57 +33,67 @@ static constexpr char INSPECT_HELP[] =
     "  --config-file TiFlash config file.\n"
     "  --check       Iterate data files to check integrity.\n"
     "  --file-id     Target DTFile ID.\n"
+    "  --all         Inspect all DTFiles in the target directory instead of --file-id.\n"
+    "  --threads     Number of DTFiles inspected concurrently. [default: 1]\n"
+    "  --io-limit    Max bytes read per second, so it can run beside a live server. [default: 0, no limit]\n"
     "  --imitative   Use imitative context instead. (encryption is not supported in this mode)\n"
     "  --workdir     Target directory.";
 
 // clang-format on
 
-int inspectServiceMain(DB::Context & context, const InspectArgs & args)
+namespace
+{
+// Inspect the DMFile at `workdir/dmf_<file_id>`, return the bytes it takes on disk.
+size_t inspectFile(DB::Context & context, const InspectArgs & args, size_t file_id, const DB::WriteLimiterPtr & io_limiter, Poco::Logger * logger)
 {
-    // from this part, the base daemon is running, so we use logger instead
-    auto * logger = &Poco::Logger::get("DTToolInspect");
-
     // black_hole is used to consume data manually.
     // we use SCOPE_EXIT to ensure the release of memory area.
     auto * black_hole = reinterpret_cast<char *>(::operator new (DBMS_DEFAULT_BUFFER_SIZE, std::align_val_t{64}));
     SCOPE_EXIT({ ::operator delete (black_hole, std::align_val_t{64}); });
     auto consume = [&](DB::ReadBuffer & t) {
-        while (t.readBig(black_hole, DBMS_DEFAULT_BUFFER_SIZE) != 0) {}
+        while (auto n = t.readBig(black_hole, DBMS_DEFAULT_BUFFER_SIZE))
+        {
+            if (io_limiter)
+                io_limiter->request(n);
+        }
     };
 
     // Open the DMFile at `workdir/dmf_<file-id>`
     auto fp = context.getFileProvider();
-    auto dmfile = DB::DM::DMFile::restore(fp, args.file_id, 0, args.workdir, DB::DM::DMFile::ReadMetaMode::all());
+    auto dmfile = DB::DM::DMFile::restore(fp, file_id, 0, args.workdir, DB::DM::DMFile::ReadMetaMode::all());
 
-    LOG_FMT_INFO(logger, "bytes on disk: {}", dmfile->getBytesOnDisk());
-    LOG_FMT_INFO(logger, "single file: {}", dmfile->isSingleFileMode());
+    LOG_FMT_INFO(logger, "dmf_{} bytes on disk: {}", file_id, dmfile->getBytesOnDisk());
+    LOG_FMT_INFO(logger, "dmf_{} single file: {}", file_id, dmfile->isSingleFileMode());
 
     // if the DMFile has a config file, there may be additional debugging information
     // we also log the content of dmfile checksum config
     if (auto conf = dmfile->getConfiguration())
     {
-        LOG_FMT_INFO(logger, "with new checksum: true");
+        LOG_FMT_INFO(logger, "dmf_{} with new checksum: true", file_id);
         switch (conf->getChecksumAlgorithm())
         {
         case DB::ChecksumAlgo::None:
-            LOG_FMT_INFO(logger, "checksum algorithm: none");
+            LOG_FMT_INFO(logger, "dmf_{} checksum algorithm: none", file_id);
             break;
         case DB::ChecksumAlgo::CRC32:
-            LOG_FMT_INFO(logger, "checksum algorithm: crc32");
+            LOG_FMT_INFO(logger, "dmf_{} checksum algorithm: crc32", file_id);
+            break;
+        case DB::ChecksumAlgo::CRC32C:
+            LOG_FMT_INFO(logger, "dmf_{} checksum algorithm: crc32c", file_id);
             break;
         case DB::ChecksumAlgo::CRC64:
-            LOG_FMT_INFO(logger, "checksum algorithm: crc64");
+            LOG_FMT_INFO(logger, "dmf_{} checksum algorithm: crc64", file_id);
             break;
         case DB::ChecksumAlgo::City128:
-            LOG_FMT_INFO(logger, "checksum algorithm: city128");
+            LOG_FMT_INFO(logger, "dmf_{} checksum algorithm: city128", file_id);
             break;
         case DB::ChecksumAlgo::XXH3:
-            LOG_FMT_INFO(logger, "checksum algorithm: xxh3");
+            LOG_FMT_INFO(logger, "dmf_{} checksum algorithm: xxh3", file_id);
             break;
         }
         for (const auto & [name, msg] : conf->getDebugInfo())
         {
-            LOG_FMT_INFO(logger, "{}: {}", name, msg);
+            LOG_FMT_INFO(logger, "dmf_{} {}: {}", file_id, name, msg);
         }
     }
 
@@ -92,7 +102,7 @@ int inspectServiceMain(DB::Context & context, const InspectArgs & args)
         // for directory mode file, we can consume each file to check its integrity.
         if (!dmfile->isSingleFileMode())
         {
-            auto prefix = args.workdir + "/dmf_" + DB::toString(args.file_id);
+            auto prefix = args.workdir + "/dmf_" + DB::toString(file_id);
             auto file = Poco::File{prefix};
             std::vector<std::string> sub;
             file.list(sub);
@@ -103,7 +113,7 @@ int inspectServiceMain(DB::Context & context, const InspectArgs & args)
                     auto full_path = prefix;
                     full_path += "/";
                     full_path += i;
-                    LOG_FMT_INFO(logger, "checking {}: ", i);
+                    LOG_FMT_INFO(logger, "dmf_{} checking {}: ", file_id, i);
                     if (dmfile->getConfiguration())
                     {
                         consume(*DB::createReadBufferFromFileBaseByFileProvider(
@@ -125,26 +135,44 @@ int inspectServiceMain(DB::Context & context, const InspectArgs & args)
                             0,
                             nullptr));
                     }
-                    LOG_FMT_INFO(logger, "[success]");
+                    LOG_FMT_INFO(logger, "dmf_{} [success]", file_id);
                 }
             }
         }
         // for both directory file and single mode file, we can read out all blocks from the file.
         // this procedure will also trigger the checksum checking in the compression buffer.
-        LOG_FMT_INFO(logger, "examine all data blocks: ");
+        LOG_FMT_INFO(logger, "dmf_{} examine all data blocks: ", file_id);
         {
+            // The blocks are read pack by pack, throttle them by the average bytes of a pack on disk.
+            const size_t pack_bytes = dmfile->getBytesOnDisk() / std::max<size_t>(1, dmfile->getPacks());
             auto stream = DB::DM::createSimpleBlockInputStream(context, dmfile);
             size_t counter = 0;
             stream->readPrefix();
             while (stream->read())
             {
+                if (io_limiter)
+                    io_limiter->request(pack_bytes);
                 counter++;
             }
             stream->readSuffix();
-            LOG_FMT_INFO(logger, "[success] ( {} blocks )", counter);
+            LOG_FMT_INFO(logger, "dmf_{} [success] ( {} blocks )", file_id, counter);
         }
     }
-    return 0;
+    return dmfile->getBytesOnDisk();
+}
+} // namespace
+
+int inspectServiceMain(DB::Context & context, const InspectArgs & args)
+{
+    // from this part, the base daemon is running, so we use logger instead
+    auto * logger = &Poco::Logger::get("DTToolInspect");
+
+    auto file_ids = detail::listTargetFiles(context, args.workdir, args.all_files, args.file_id);
+    auto io_limiter = detail::createIOLimiter(args.io_rate_limit);
+    auto failed = detail::processFiles(file_ids, args.threads, "inspect", logger, [&](size_t file_id) {
+        return inspectFile(context, args, file_id, io_limiter, logger);
+    });
+    return failed == 0 ? 0 : 1;
 }
 
 
@@ -155,12 +183,16 @@ int inspectEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
     bpo::positional_options_description positional;
     bool check = false;
     bool imitative = false;
+    bool all_files = false;
     // clang-format off
     options.add_options()
         ("help", "")
         ("check", bpo::bool_switch(&check))
         ("workdir", bpo::value<std::string>()->required())
-        ("file-id", bpo::value<size_t>()->required())
+        ("file-id", bpo::value<size_t>())
+        ("all", bpo::bool_switch(&all_files))
+        ("threads", bpo::value<size_t>()->default_value(1))
+        ("io-limit", bpo::value<size_t>()->default_value(0))
         ("imitative", bpo::bool_switch(&imitative))
         ("config-file", bpo::value<std::string>());
     // clang-format on
@@ -191,9 +223,15 @@ int inspectEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
             return -EINVAL;
         }
 
+        if (all_files == (vm.count("file-id") != 0))
+        {
+            std::cerr << "exactly one of file-id and all is required" << std::endl;
+            return -EINVAL;
+        }
+
         auto workdir = vm["workdir"].as<std::string>();
-        auto file_id = vm["file-id"].as<size_t>();
-        auto args = InspectArgs{check, file_id, workdir};
+        auto file_id = all_files ? 0 : vm["file-id"].as<size_t>();
+        auto args = InspectArgs{check, file_id, workdir, all_files, vm["threads"].as<size_t>(), vm["io-limit"].as<size_t>()};
 
         if (imitative)
         {
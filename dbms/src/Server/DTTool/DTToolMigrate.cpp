@@ -55,11 +55,14 @@ static constexpr char MIGRATE_HELP[] =
     "Available Arguments:\n"
     "  --help        Print help message and exit.\n"
     "  --version     Target dtfile version. [default: 2] [available: 1, 2]\n"
-    "  --algorithm   Checksum algorithm. [default: xxh3] [available: xxh3, city128, crc32, crc64, none]\n"
+    "  --algorithm   Checksum algorithm. [default: xxh3] [available: xxh3, city128, crc32, crc32c, crc64, none]\n"
     "  --frame       Checksum frame length. [default: " TO_STRING(TIFLASH_DEFAULT_CHECKSUM_FRAME_SIZE) "]\n"
     "  --compression Compression method. [default: lz4] [available: lz4, lz4hc, zstd, none]\n"
     "  --level       Compression level. [default: lz4: 1, lz4hc: 9, zstd: 1]\n"
     "  --file-id     Target file id.\n"
+    "  --all         Migrate all DTFiles in the target directory instead of --file-id.\n"
+    "  --threads     Number of DTFiles migrated concurrently. [default: 1]\n"
+    "  --io-limit    Max bytes read per second, so it can run beside a live server. [default: 0, no limit]\n"
     "  --workdir     Target directory.\n"
     "  --nokeep      Do not keep old version.\n"
     "  --dry         Dry run: only print change list.\n"
@@ -120,7 +123,6 @@ struct MigrationHouseKeeper
     Poco::File migration_target_dir;
     size_t migration_file;
 
-    DB::StorageFormatVersion old_version;
     MigrationHouseKeeper(std::string migration_temp_dir,
                          std::string migration_target_dir,
                          size_t migration_file,
@@ -130,7 +132,6 @@ struct MigrationHouseKeeper
         , migration_temp_dir(migration_temp_dir)
         , migration_target_dir(migration_target_dir)
         , migration_file(migration_file)
-        , old_version(DB::STORAGE_FORMAT_CURRENT)
     {
         if (!this->migration_temp_dir.createDirectory())
         {
@@ -143,15 +144,8 @@ struct MigrationHouseKeeper
         success = true;
     }
 
-    void setStorageVersion(DB::StorageFormatVersion version)
-    {
-        old_version = DB::STORAGE_FORMAT_CURRENT;
-        DB::STORAGE_FORMAT_CURRENT = version;
-    }
-
     ~MigrationHouseKeeper() noexcept(false)
     {
-        DB::STORAGE_FORMAT_CURRENT = old_version;
         if (success)
         {
             auto target_path = fmt::format("{}/dmf_{}", migration_target_dir.path(), migration_file);
@@ -171,6 +165,90 @@ struct MigrationHouseKeeper
     }
 };
 
+/// The storage format decides the format of the new dtfiles, it is shared by all the files migrated concurrently.
+struct StorageVersionGuard
+{
+    DB::StorageFormatVersion old_version;
+
+    explicit StorageVersionGuard(DB::StorageFormatVersion version)
+        : old_version(DB::STORAGE_FORMAT_CURRENT)
+    {
+        DB::STORAGE_FORMAT_CURRENT = version;
+    }
+
+    ~StorageVersionGuard()
+    {
+        DB::STORAGE_FORMAT_CURRENT = old_version;
+    }
+};
+
+size_t migrateFile(DB::Context & context, const MigrateArgs & args, size_t file_id, const DB::WriteLimiterPtr & io_limiter)
+{
+    auto * logger = &Poco::Logger::get("DTToolMigration");
+    // the HouseKeeper is to make sure the directories will be removed or renamed
+    // after the running.
+    MigrationHouseKeeper keeper{
+        fmt::format("{}/.migration_{}", args.workdir, file_id),
+        args.workdir,
+        file_id,
+        args.no_keep};
+    auto src_file = DB::DM::DMFile::restore(context.getFileProvider(), file_id, 0, args.workdir, DB::DM::DMFile::ReadMetaMode::all());
+    LOG_FMT_INFO(logger, "dmf_{} source version: {}", file_id, (src_file->getConfiguration() ? 2 : 1));
+    LOG_FMT_INFO(logger, "dmf_{} source bytes: {}", file_id, src_file->getBytesOnDisk());
+    LOG_FMT_INFO(logger, "dmf_{} migration temporary directory: {}", file_id, keeper.migration_temp_dir.path().c_str());
+    DB::DM::DMConfigurationOpt option{};
+
+    // if new format is the target, we construct a config file.
+    if (args.version == DB::DMFileFormat::V2)
+        option.emplace(std::map<std::string, std::string>{}, args.frame, args.algorithm);
+
+    LOG_FMT_INFO(logger, "dmf_{} creating new dtfile", file_id);
+    auto new_file = DB::DM::DMFile::create(file_id, keeper.migration_temp_dir.path(), false, std::move(option));
+
+    LOG_FMT_INFO(logger, "dmf_{} creating input stream", file_id);
+    auto input_stream = DB::DM::createSimpleBlockInputStream(context, src_file);
+
+    LOG_FMT_INFO(logger, "dmf_{} creating output stream", file_id);
+    auto output_stream = DB::DM::DMFileBlockOutputStream(
+        context,
+        new_file,
+        src_file->getColumnDefines());
+
+    // The blocks are read pack by pack, throttle them by the average bytes of a pack on disk.
+    const size_t pack_bytes = src_file->getBytesOnDisk() / std::max<size_t>(1, src_file->getPacks());
+    input_stream->readPrefix();
+    if (!args.dry_mode)
+        output_stream.writePrefix();
+    auto stat_iter = src_file->pack_stats.begin();
+    auto properties_iter = src_file->pack_properties.property().begin();
+    size_t counter = 0;
+    // iterate all blocks and rewrite them to new dtfile
+    while (auto block = input_stream->read())
+    {
+        if (io_limiter)
+            io_limiter->request(pack_bytes);
+        LOG_FMT_INFO(logger, "dmf_{} migrating block {} ( size: {} )", file_id, counter++, block.bytes());
+        if (!args.dry_mode)
+            output_stream.write(
+                block,
+                {stat_iter->not_clean, properties_iter->num_rows(), properties_iter->gc_hint_version()});
+        stat_iter++;
+        properties_iter++;
+    }
+    input_stream->readSuffix();
+    if (!args.dry_mode)
+    {
+        output_stream.writeSuffix();
+        keeper.markSuccess();
+    }
+
+    LOG_FMT_INFO(logger, "dmf_{} checking meta status for new file", file_id);
+    if (!args.dry_mode)
+    {
+        DB::DM::DMFile::restore(context.getFileProvider(), file_id, 1, keeper.migration_temp_dir.path(), DB::DM::DMFile::ReadMetaMode::all());
+    }
+    return src_file->getBytesOnDisk();
+}
 
 int migrateServiceMain(DB::Context & context, const MigrateArgs & args)
 {
@@ -178,83 +256,33 @@ int migrateServiceMain(DB::Context & context, const MigrateArgs & args)
     DirLock lock{args.workdir};
     // from this part, the base daemon is running, so we use logger instead
     auto * logger = &Poco::Logger::get("DTToolMigration");
-    {
-        // the HouseKeeper is to make sure the directories will be removed or renamed
-        // after the running.
-        MigrationHouseKeeper keeper{
-            fmt::format("{}/.migration", args.workdir),
-            args.workdir,
-            args.file_id,
-            args.no_keep};
-        auto src_file = DB::DM::DMFile::restore(context.getFileProvider(), args.file_id, 0, args.workdir, DB::DM::DMFile::ReadMetaMode::all());
-        LOG_FMT_INFO(logger, "source version: {}", (src_file->getConfiguration() ? 2 : 1));
-        LOG_FMT_INFO(logger, "source bytes: {}", src_file->getBytesOnDisk());
-        LOG_FMT_INFO(logger, "migration temporary directory: {}", keeper.migration_temp_dir.path().c_str());
-        LOG_FMT_INFO(logger, "target version: {}", args.version);
-        LOG_FMT_INFO(logger, "target frame size: {}", args.frame);
-        DB::DM::DMConfigurationOpt option{};
-
-        // if new format is the target, we construct a config file.
-        switch (args.version)
-        {
-        case DB::DMFileFormat::V2:
-            keeper.setStorageVersion(DB::STORAGE_FORMAT_V3);
-            option.emplace(std::map<std::string, std::string>{}, args.frame, args.algorithm);
-            break;
-        case DB::DMFileFormat::V1:
-            keeper.setStorageVersion(DB::STORAGE_FORMAT_V2);
-            break;
-        default:
-            throw DB::Exception(fmt::format("invalid dtfile version: {}", args.version));
-        }
-
-        LOG_FMT_INFO(logger, "creating new dtfile");
-        auto new_file = DB::DM::DMFile::create(args.file_id, keeper.migration_temp_dir.path(), false, std::move(option));
-
-        LOG_FMT_INFO(logger, "creating input stream");
-        auto input_stream = DB::DM::createSimpleBlockInputStream(context, src_file);
-
-        LOG_FMT_INFO(logger, "creating output stream");
-        context.getSettingsRef().dt_compression_method.set(args.compression_method);
-        context.getSettingsRef().dt_compression_level.set(args.compression_level);
-        auto output_stream = DB::DM::DMFileBlockOutputStream(
-            context,
-            new_file,
-            src_file->getColumnDefines());
-
-        input_stream->readPrefix();
-        if (!args.dry_mode)
-            output_stream.writePrefix();
-        auto stat_iter = src_file->pack_stats.begin();
-        auto properties_iter = src_file->pack_properties.property().begin();
-        size_t counter = 0;
-        // iterate all blocks and rewrite them to new dtfile
-        while (auto block = input_stream->read())
-        {
-            LOG_FMT_INFO(logger, "migrating block {} ( size: {} )", counter++, block.bytes());
-            if (!args.dry_mode)
-                output_stream.write(
-                    block,
-                    {stat_iter->not_clean, properties_iter->num_rows(), properties_iter->gc_hint_version()});
-            stat_iter++;
-            properties_iter++;
-        }
-        input_stream->readSuffix();
-        if (!args.dry_mode)
-        {
-            output_stream.writeSuffix();
-            keeper.markSuccess();
-        }
+    LOG_FMT_INFO(logger, "target version: {}", args.version);
+    LOG_FMT_INFO(logger, "target frame size: {}", args.frame);
 
-        LOG_FMT_INFO(logger, "checking meta status for new file");
-        if (!args.dry_mode)
-        {
-            DB::DM::DMFile::restore(context.getFileProvider(), args.file_id, 1, keeper.migration_temp_dir.path(), DB::DM::DMFile::ReadMetaMode::all());
-        }
+    DB::StorageFormatVersion storage_version;
+    switch (args.version)
+    {
+    case DB::DMFileFormat::V2:
+        storage_version = DB::STORAGE_FORMAT_V3;
+        break;
+    case DB::DMFileFormat::V1:
+        storage_version = DB::STORAGE_FORMAT_V2;
+        break;
+    default:
+        throw DB::Exception(fmt::format("invalid dtfile version: {}", args.version));
     }
+    StorageVersionGuard version_guard{storage_version};
+    context.getSettingsRef().dt_compression_method.set(args.compression_method);
+    context.getSettingsRef().dt_compression_level.set(args.compression_level);
+
+    auto file_ids = detail::listTargetFiles(context, args.workdir, args.all_files, args.file_id);
+    auto io_limiter = detail::createIOLimiter(args.io_rate_limit);
+    auto failed = detail::processFiles(file_ids, args.threads, "migrate", logger, [&](size_t file_id) {
+        return migrateFile(context, args, file_id, io_limiter);
+    });
     LOG_FMT_INFO(logger, "migration finished");
 
-    return 0;
+    return failed == 0 ? 0 : 1;
 }
 
 int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_function)
@@ -265,6 +293,7 @@ int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
     bool dry_mode = false;
     bool no_keep = false;
     bool imitative = false;
+    bool all_files = false;
     // clang-format off
     options.add_options()
         ("help", "")
@@ -273,7 +302,10 @@ int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
         ("frame", bpo::value<size_t>()->default_value(TIFLASH_DEFAULT_CHECKSUM_FRAME_SIZE))
         ("workdir", bpo::value<std::string>()->required())
         ("config-file", bpo::value<std::string>())
-        ("file-id", bpo::value<size_t>()->required())
+        ("file-id", bpo::value<size_t>())
+        ("all", bpo::bool_switch(&all_files))
+        ("threads", bpo::value<size_t>()->default_value(1))
+        ("io-limit", bpo::value<size_t>()->default_value(0))
         ("dry", bpo::bool_switch(&dry_mode))
         ("compression", bpo::value<std::string>()->default_value("lz4"))
         ("level", bpo::value<int>())
@@ -308,6 +340,12 @@ int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
             return -EINVAL;
         }
 
+        if (all_files == (vm.count("file-id") != 0))
+        {
+            std::cerr << "exactly one of file-id and all is required" << std::endl;
+            return -EINVAL;
+        }
+
         MigrateArgs args{};
         args.version = vm["version"].as<size_t>();
         if (args.version < 1 || args.version > 2)
@@ -318,7 +356,10 @@ int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
         args.no_keep = no_keep;
         args.dry_mode = dry_mode;
         args.workdir = vm["workdir"].as<std::string>();
-        args.file_id = vm["file-id"].as<size_t>();
+        args.file_id = all_files ? 0 : vm["file-id"].as<size_t>();
+        args.all_files = all_files;
+        args.threads = vm["threads"].as<size_t>();
+        args.io_rate_limit = vm["io-limit"].as<size_t>();
 
         {
             auto compression_method = vm["compression"].as<std::string>();
@@ -365,6 +406,10 @@ int migrateEntry(const std::vector<std::string> & opts, RaftStoreFFIFunc ffi_fun
             {
                 args.algorithm = DB::ChecksumAlgo::CRC32;
             }
+            else if (algorithm == "crc32c")
+            {
+                args.algorithm = DB::ChecksumAlgo::CRC32C;
+            }
             else if (algorithm == "crc64")
             {
                 args.algorithm = DB::ChecksumAlgo::CRC64;
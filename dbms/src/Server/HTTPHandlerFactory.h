@@ -23,6 +23,7 @@
 #include "IServer.h"
 #include "NotFoundHandler.h"
 #include "PingRequestHandler.h"
+#include "ProfileRequestHandler.h"
 #include "RootRequestHandler.h"
 
 
@@ -62,6 +63,8 @@ public:
                 return new RootRequestHandler(server);
             if (uri == "/ping")
                 return new PingRequestHandler(server);
+            if (uri == "/profile" || uri.rfind("/profile?", 0) == 0)
+                return new ProfileRequestHandler(server);
         }
 
         if (uri.find('?') != std::string::npos || request.getMethod() == Poco::Net::HTTPRequest::HTTP_POST)
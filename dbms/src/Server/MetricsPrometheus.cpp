@@ -234,6 +234,8 @@ MetricsPrometheus::~MetricsPrometheus()
 void MetricsPrometheus::run()
 {
     auto & tiflash_metrics = TiFlashMetrics::instance();
+    ShardedMetrics::instance().flush();
+
     for (ProfileEvents::Event event = 0; event < ProfileEvents::end(); event++)
     {
         const auto value = ProfileEvents::counters[event].load(std::memory_order_relaxed);
@@ -28,6 +28,7 @@ class Context;
 
 /**    Automatically sends
   * - difference of ProfileEvents;
+  * - the updates accumulated by the sharded metrics;
   * - values of CurrentMetrics;
   * - values of AsynchronousMetrics;
   *  to Prometheus
@@ -0,0 +1,84 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ProfileRequestHandler.h"
+
+#include <Common/Exception.h>
+#include <Common/HTMLForm.h>
+#include <Common/SamplingProfiler.h>
+#include <IO/HTTPCommon.h>
+#include <Poco/Net/HTTPServerRequest.h>
+#include <Poco/Net/HTTPServerResponse.h>
+#include <fmt/core.h>
+
+namespace DB
+{
+void ProfileRequestHandler::handleRequest(
+    Poco::Net::HTTPServerRequest & request,
+    Poco::Net::HTTPServerResponse & response)
+{
+    try
+    {
+        const auto & config = server.config();
+        setResponseDefaultHeaders(response, config.getUInt("keep_alive_timeout", 10));
+
+        HTMLForm params(request);
+        const auto action = params.get("action", "dump");
+        auto & profiler = SamplingProfiler::instance();
+
+        String data;
+        if (action == "start")
+        {
+            auto interval_us = std::stoull(params.get("interval_us", "10000"));
+            data = profiler.start(interval_us) ? "Started.\n" : "Already running.\n";
+        }
+        else if (action == "stop")
+        {
+            profiler.stop();
+            auto stats = profiler.getStats();
+            data = fmt::format("Stopped, samples: {}, dropped: {}.\n", stats.samples, stats.dropped);
+        }
+        else if (action == "reset")
+        {
+            profiler.reset();
+            data = "Reset.\n";
+        }
+        else if (action == "dump")
+        {
+            data = profiler.dumpFolded();
+        }
+        else
+        {
+            response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+            data = fmt::format("Unknown action: {}\n", action);
+        }
+        response.sendBuffer(data.data(), data.size());
+    }
+    catch (...)
+    {
+        tryLogCurrentException("ProfileRequestHandler");
+        try
+        {
+            response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+            auto message = getCurrentExceptionMessage(false) + "\n";
+            response.sendBuffer(message.data(), message.size());
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+} // namespace DB
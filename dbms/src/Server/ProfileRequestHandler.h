@@ -0,0 +1,46 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Poco/Net/HTTPRequestHandler.h>
+
+#include "IServer.h"
+
+
+namespace DB
+{
+/// Control the sampling profiler and dump its samples, see `SamplingProfiler`.
+///   /profile?action=start&interval_us=10000  start sampling
+///   /profile?action=stop                     stop sampling
+///   /profile?action=reset                    clear the samples
+///   /profile                                 dump the samples in the folded format of flame graph tools
+class ProfileRequestHandler : public Poco::Net::HTTPRequestHandler
+{
+private:
+    IServer & server;
+
+public:
+    explicit ProfileRequestHandler(IServer & server_)
+        : server(server_)
+    {
+    }
+
+    void handleRequest(
+        Poco::Net::HTTPServerRequest & request,
+        Poco::Net::HTTPServerResponse & response) override;
+};
+
+} // namespace DB
@@ -15,11 +15,15 @@
 #include <AggregateFunctions/registerAggregateFunctions.h>
 #include <Common/CPUAffinityManager.h>
 #include <Common/ClickHouseRevision.h>
+#include <Common/ColumnBufferPool.h>
 #include <Common/Config/ConfigReloader.h>
 #include <Common/CurrentMetrics.h>
 #include <Common/DynamicThreadPool.h>
 #include <Common/FailPoint.h>
+#include <Common/HugePages.h>
 #include <Common/Macros.h>
+#include <Common/MemoryArbiter.h>
+#include <Common/ProfilingMutex.h>
 #include <Common/RedactHelpers.h>
 #include <Common/StringUtils/StringUtils.h>
 #include <Common/ThreadManager.h>
@@ -38,6 +42,7 @@
 #include <Encryption/FileProvider.h>
 #include <Encryption/MockKeyManager.h>
 #include <Encryption/RateLimiter.h>
+#include <Flash/CoprocessorCall.h>
 #include <Flash/DiagnosticsService.h>
 #include <Flash/FlashService.h>
 #include <Flash/Mpp/GRPCCompletionQueuePool.h>
@@ -474,8 +479,16 @@ private:
 };
 
 // We only need this task run once.
-void initStores(Context & global_context, Poco::Logger * log, bool lazily_init_store)
+void initStores(Context & global_context, Poco::Logger * log, bool lazily_init_store, bool init_store_on_demand)
 {
+    if (init_store_on_demand)
+    {
+        // The segments, storage pool and background tasks of each store are restored by
+        // `StorageDeltaMerge::getAndMaybeInitStore` on the first read or write of the table.
+        LOG_FMT_INFO(log, "Init store on demand, skip initing stores on startup.");
+        return;
+    }
+
     auto do_init_stores = [&global_context, log]() {
         auto storages = global_context.getTMTContext().getStorages().getAllStorage();
         int init_cnt = 0;
@@ -533,7 +546,7 @@ void handleRpcs(grpc::ServerCompletionQueue * curcq, Poco::Logger * log)
         {
             // Block waiting to read the next event from the completion queue. The
             // event is uniquely identified by its tag, which in this case is the
-            // memory address of a EstablishCallData instance.
+            // memory address of a IAsyncCallData instance.
             // The return value of Next should always be checked. This return value
             // tells us whether there is any kind of event or cq is shutting down.
             if (!curcq->Next(&tag, &ok))
@@ -548,9 +561,9 @@ void handleRpcs(grpc::ServerCompletionQueue * curcq, Poco::Logger * log)
             // If ok is false, it means server is shutdown.
             // We need not log all not ok events, since the volumn is large which will pollute the content of log.
             if (ok)
-                static_cast<EstablishCallData *>(tag)->proceed();
+                static_cast<IAsyncCallData *>(tag)->proceed();
             else
-                static_cast<EstablishCallData *>(tag)->cancel();
+                static_cast<IAsyncCallData *>(tag)->cancel();
         }
         catch (Exception & e)
         {
@@ -642,14 +655,17 @@ public:
         {
             int preallocated_request_count_per_poller = server.context().getSettingsRef().preallocated_request_count_per_poller;
             int pollers_per_cq = server.context().getSettingsRef().async_pollers_per_cq;
+            auto * async_flash_service = assert_cast<AsyncFlashService *>(flash_service.get());
             for (int i = 0; i < async_cq_num * pollers_per_cq; ++i)
             {
                 auto * cq = cqs[i / pollers_per_cq].get();
                 auto * notify_cq = notify_cqs[i / pollers_per_cq].get();
                 for (int j = 0; j < preallocated_request_count_per_poller; ++j)
                 {
-                    // EstablishCallData will handle its lifecycle by itself.
-                    EstablishCallData::spawn(assert_cast<AsyncFlashService *>(flash_service.get()), cq, notify_cq, is_shutdown);
+                    // EstablishCallData and CoprocessorCallData will handle their lifecycle by themselves.
+                    EstablishCallData::spawn(async_flash_service, cq, notify_cq, is_shutdown);
+                    if (async_flash_service->isAsyncCop())
+                        CoprocessorCallData::spawn(async_flash_service, cq, notify_cq, is_shutdown);
                 }
                 thread_manager->schedule(false, "async_poller", [cq, this] { handleRpcs(cq, log); });
                 thread_manager->schedule(false, "async_poller", [notify_cq, this] { handleRpcs(notify_cq, log); });
@@ -700,7 +716,7 @@ private:
     std::unique_ptr<FlashService> flash_service = nullptr;
     std::unique_ptr<DiagnosticsService> diagnostics_service = nullptr;
     std::unique_ptr<grpc::Server> flash_grpc_server = nullptr;
-    // cqs and notify_cqs are used for processing async grpc events (currently only EstablishMPPConnection).
+    // cqs and notify_cqs are used for processing async grpc events (EstablishMPPConnection, and Coprocessor if enable_async_cop).
     std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs;
     std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> notify_cqs;
     std::shared_ptr<ThreadManager> thread_manager;
@@ -1146,6 +1162,21 @@ int Server::main(const std::vector<std::string> & /*args*/)
         global_context->getPathCapacity(),
         global_context->getFileProvider());
 
+    /// Clear the data spilled by queries before restarting.
+    for (const auto & spill_path : global_context->getPathPool().listSpillPaths())
+    {
+        Poco::File(spill_path).createDirectories();
+        Poco::DirectoryIterator dir_end;
+        for (Poco::DirectoryIterator it(spill_path); it != dir_end; ++it)
+        {
+            if (it->isFile())
+            {
+                LOG_FMT_DEBUG(log, "Removing old spilled file {}", it->path());
+                global_context->getFileProvider()->deleteRegularFile(it->path(), EncryptionPath(it->path(), ""));
+            }
+        }
+    }
+
     /// Initialize the background & blockable background thread pool.
     Settings & settings = global_context->getSettingsRef();
     LOG_FMT_INFO(log, "Background & Blockable Background pool size: {}", settings.background_pool_size);
@@ -1281,6 +1312,7 @@ int Server::main(const std::vector<std::string> & /*args*/)
             global_context->getTMTContext().reloadConfig(*config);
             global_context->getIORateLimiter().updateConfig(*config);
             global_context->reloadDeltaTreeConfig(*config);
+            LockProfiler::setEnabled(config->getBool("enable_lock_profiling", false));
         },
         /* already_loaded = */ true);
 
@@ -1305,6 +1337,9 @@ int Server::main(const std::vector<std::string> & /*args*/)
     bool use_l0_opt = config().getBool("l0_optimize", false);
     global_context->setUseL0Opt(use_l0_opt);
 
+    /// Record the contention of the hot locks, see `ProfilingMutex`.
+    LockProfiler::setEnabled(config().getBool("enable_lock_profiling", false));
+
     /// Size of cache for marks (index of MergeTree family of tables). It is necessary.
     size_t mark_cache_size = config().getUInt64("mark_cache_size", DEFAULT_MARK_CACHE_SIZE);
     if (mark_cache_size)
@@ -1315,10 +1350,43 @@ int Server::main(const std::vector<std::string> & /*args*/)
     if (minmax_index_cache_size)
         global_context->setMinMaxIndexCache(minmax_index_cache_size);
 
+    /// Size of cache for decompressed blocks of the hot columns in DTFiles, used by DeltaMerge engine. Zero means disabled.
+    size_t decompressed_block_cache_size = config().getUInt64("dt_decompressed_block_cache_size", 0);
+    if (decompressed_block_cache_size)
+        global_context->setDecompressedBlockCache(decompressed_block_cache_size);
+
+    /// Number of the cached columns read by the table scans in coprocessor requests. Zero means disabled.
+    size_t table_scan_columns_cache_size = config().getUInt64("table_scan_columns_cache_size", 1024);
+    if (table_scan_columns_cache_size)
+        global_context->setTableScanColumnsCache(table_scan_columns_cache_size);
+
+    /// Size of cache for bloom filter index, used by DeltaMerge engine.
+    size_t bloom_filter_index_cache_size = config().getUInt64("bloom_filter_index_cache_size", mark_cache_size);
+    if (bloom_filter_index_cache_size)
+        global_context->setBloomFilterIndexCache(bloom_filter_index_cache_size);
+
     /// Size of max memory usage of DeltaIndex, used by DeltaMerge engine.
     size_t delta_index_cache_size = config().getUInt64("delta_index_cache_size", 0);
     global_context->setDeltaIndexManager(delta_index_cache_size);
 
+    /// Limit of the memory shared by queries and the caches above. Zero means disabled.
+    /// Under pressure, the caches are evicted and the spillable operators are asked to spill, see `MemoryArbiter`.
+    MemoryArbiter::instance().setLimit(config().getUInt64("memory_arbiter_limit", 0));
+    auto memory_arbiter_handle = bg_pool.addTask(
+        [] {
+            MemoryArbiter::instance().reclaimIfNeeded();
+            return false;
+        },
+        false,
+        /*interval_ms=*/1000);
+    SCOPE_EXIT({ bg_pool.removeTask(memory_arbiter_handle); });
+
+    /// Max bytes of the recycled column buffers of each query thread. Zero means disabled.
+    ColumnBufferPool::setMaxBytesPerThread(config().getUInt64("column_buffer_pool_bytes_per_thread", 16 * 1024 * 1024));
+
+    /// Min bytes of the join maps and two-level aggregation buckets that are backed by pre-faulted huge pages. Zero means disabled.
+    HugePages::setThreshold(config().getUInt64("hash_table_huge_page_threshold", 0));
+
     /// Set path for format schema files
     auto format_schema_path = Poco::File(config().getString("format_schema_path", path + "format_schemas/"));
     global_context->setFormatSchemaPath(format_schema_path.path() + "/");
@@ -1340,7 +1408,10 @@ int Server::main(const std::vector<std::string> & /*args*/)
 
     // Initialize the thread pool of storage before the storage engine is initialized.
     LOG_FMT_INFO(log, "dt_enable_read_thread {}", global_context->getSettingsRef().dt_enable_read_thread);
-    DM::SegmentReaderPoolManager::instance().init(server_info);
+    DM::SegmentReaderPoolManager::instance().init(
+        server_info,
+        global_context->getSettingsRef().dt_read_thread_adaptive,
+        global_context->getSettingsRef().dt_read_thread_max_ratio);
     DM::SegmentReadTaskScheduler::instance();
     DM::DMFileReaderPool::instance();
 
@@ -1389,7 +1460,7 @@ int Server::main(const std::vector<std::string> & /*args*/)
     }
     LOG_FMT_DEBUG(log, "Sync schemas done.");
 
-    initStores(*global_context, log, storage_config.lazily_init_store);
+    initStores(*global_context, log, storage_config.lazily_init_store, storage_config.init_store_on_demand);
 
     // After schema synced, set current database.
     global_context->setCurrentDatabase(default_database);
@@ -213,8 +213,9 @@ void TiFlashStorageConfig::parseMisc(const String & storage_section, Poco::Logge
     };
 
     lazily_init_store = get_bool_config_or_default("lazily_init_store", lazily_init_store);
+    init_store_on_demand = get_bool_config_or_default("init_store_on_demand", init_store_on_demand);
 
-    LOG_FMT_INFO(log, "format_version {} lazily_init_store {}", format_version, lazily_init_store);
+    LOG_FMT_INFO(log, "format_version {} lazily_init_store {} init_store_on_demand {}", format_version, lazily_init_store, init_store_on_demand);
 }
 
 Strings TiFlashStorageConfig::getAllNormalPaths() const
@@ -103,6 +103,10 @@ public:
 
     UInt64 format_version = 0;
     bool lazily_init_store = true;
+    // Do not init the stores containing data on startup, each store is only inited on the first read or write.
+    // It makes the startup faster and saves memory for the idle tables, but the used size of the stores not
+    // inited yet is not reported to PD.
+    bool init_store_on_demand = false;
 
 public:
     TiFlashStorageConfig() = default;
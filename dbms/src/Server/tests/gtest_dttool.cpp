@@ -138,6 +138,48 @@ TEST_F(DTToolTest, MigrationSuccess)
 }
 
 
+TEST_F(DTToolTest, MigrationAllFiles)
+{
+    // Copy the DTFile to more files under the same directory.
+    const size_t file_num = 4;
+    for (size_t file_id = 2; file_id <= file_num; ++file_id)
+        Poco::File(dmfile->path()).copyTo(DB::DM::DMFile::getPathByStatus(getTemporaryPath(), file_id, DB::DM::DMFile::Status::READABLE));
+
+    {
+        auto args = DTTool::Migrate::MigrateArgs{
+            .no_keep = true,
+            .dry_mode = false,
+            .file_id = 0,
+            .version = 2,
+            .frame = DBMS_DEFAULT_BUFFER_SIZE,
+            .algorithm = DB::ChecksumAlgo::XXH3,
+            .workdir = getTemporaryPath(),
+            .compression_method = DB::CompressionMethod::LZ4,
+            .compression_level = DB::CompressionSettings::getDefaultLevel(DB::CompressionMethod::LZ4),
+            .all_files = true,
+            .threads = 3,
+            .io_rate_limit = 1024 * 1024 * 1024,
+        };
+        EXPECT_EQ(DTTool::Migrate::migrateServiceMain(*db_context, args), 0);
+    }
+    for (size_t file_id = 1; file_id <= file_num; ++file_id)
+    {
+        auto file = DB::DM::DMFile::restore(db_context->getFileProvider(), file_id, 0, getTemporaryPath(), DB::DM::DMFile::ReadMetaMode::all());
+        ASSERT_TRUE(file->getConfiguration()) << "file: " << file_id;
+        EXPECT_EQ(file->getRows(), dmfile->getRows());
+    }
+    {
+        auto args = DTTool::Inspect::InspectArgs{
+            .check = true,
+            .file_id = 0,
+            .workdir = getTemporaryPath(),
+            .all_files = true,
+            .threads = 2};
+        EXPECT_EQ(DTTool::Inspect::inspectServiceMain(*db_context, args), 0);
+    }
+}
+
+
 void getHash(std::unordered_map<std::string, std::string> & records, const std::string & path)
 {
     std::fstream file{path};
@@ -549,6 +549,38 @@ max_bytes_per_sec=1024000
         ASSERT_EQ(storage.main_data_paths, paths);
         ASSERT_EQ(storage.format_version, 123);
         ASSERT_EQ(storage.lazily_init_store, 1);
+        ASSERT_EQ(storage.init_store_on_demand, 0);
+    }
+}
+CATCH
+
+TEST_F(StorageConfigTest, InitStoreOnDemand)
+try
+{
+    Strings tests = {
+        R"(
+[storage]
+init_store_on_demand = 1
+[storage.main]
+dir = [ "/data0/tiflash/" ]
+        )",
+        R"(
+[storage]
+init_store_on_demand = true
+[storage.main]
+dir = [ "/data0/tiflash/" ]
+        )",
+    };
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        const auto & test_case = tests[i];
+        auto config = loadConfigFromString(test_case);
+        LOG_FMT_INFO(log, "parsing [index={}] [content={}]", i, test_case);
+        auto [global_capacity_quota, storage] = TiFlashStorageConfig::parseSettings(*config, log);
+        std::ignore = global_capacity_quota;
+        ASSERT_TRUE(storage.init_store_on_demand);
+        ASSERT_TRUE(storage.lazily_init_store);
     }
 }
 CATCH
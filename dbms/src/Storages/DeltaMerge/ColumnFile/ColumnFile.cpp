@@ -77,6 +77,54 @@ size_t copyColumnsData(
     }
 }
 
+size_t gatherColumnsData(
+    const Columns & from,
+    const ColumnPtr & pk_col,
+    ColumnSlicesGatherer & gatherer,
+    size_t rows_offset,
+    size_t rows_limit,
+    const RowKeyRange * range)
+{
+    if (range)
+    {
+        RowKeyColumnContainer rkcc(pk_col, range->is_common_handle);
+        if (rows_limit == 1)
+        {
+            if (!range->check(rkcc.getRowKeyValue(rows_offset)))
+                return 0;
+            gatherer.add(from, rows_offset, 1);
+            return 1;
+        }
+        else
+        {
+            auto [actual_offset, actual_limit] = RowKeyFilter::getPosRangeOfSorted(*range, pk_col, rows_offset, rows_limit);
+            gatherer.add(from, actual_offset, actual_limit);
+            return actual_limit;
+        }
+    }
+    else
+    {
+        gatherer.add(from, rows_offset, rows_limit);
+        return rows_limit;
+    }
+}
+
+size_t ColumnFileReader::gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t rows_offset, size_t rows_limit, const RowKeyRange * range)
+{
+    MutableColumns tmp_cols;
+    tmp_cols.reserve(output_cols.size());
+    for (const auto & col : output_cols)
+        tmp_cols.push_back(col->cloneEmpty());
+    auto actual_read = readRows(tmp_cols, rows_offset, rows_limit, range);
+
+    Columns columns;
+    columns.reserve(tmp_cols.size());
+    for (auto & col : tmp_cols)
+        columns.push_back(std::move(col));
+    gatherer.add(gatherer.hold(std::move(columns)), 0, actual_read);
+    return actual_read;
+}
+
 ColumnFileInMemory * ColumnFile::tryToInMemoryFile()
 {
     return !isInMemoryFile() ? nullptr : static_cast<ColumnFileInMemory *>(this);
@@ -17,6 +17,7 @@
 #include <Common/nocopyable.h>
 #include <Core/Block.h>
 #include <IO/WriteHelpers.h>
+#include <Storages/DeltaMerge/ColumnFile/ColumnSlicesGatherer.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
 #include <Storages/DeltaMerge/RowKeyRange.h>
 #include <Storages/DeltaMerge/WriteBatches.h>
@@ -83,6 +84,9 @@ public:
 
         std::mutex mutex;
         Block block;
+        // The columns of `block` compressed by `ColumnFileInMemory::compress`, `block` is emptied after that.
+        std::vector<String> compressed_columns;
+        size_t compressed_rows = 0;
     };
     using CachePtr = std::shared_ptr<Cache>;
     using ColIdToOffset = std::unordered_map<ColId, size_t>;
@@ -93,6 +97,8 @@ public:
 
     virtual size_t getRows() const { return 0; }
     virtual size_t getBytes() const { return 0; };
+    /// The bytes actually taken in memory, which is less than `getBytes` if the data is compressed.
+    virtual size_t getMemoryBytes() const { return getBytes(); }
     virtual size_t getDeletes() const { return 0; };
 
     virtual Type getType() const = 0;
@@ -141,6 +147,11 @@ public:
         throw Exception("Unsupported operation", ErrorCodes::LOGICAL_ERROR);
     }
 
+    /// Like `readRows`, but add the rows into `gatherer` instead of copying them. The rows are copied into the
+    /// columns like `output_cols` when `gatherer.gather` is called.
+    /// By default the rows are read into some temporary columns held by `gatherer`.
+    virtual size_t gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t rows_offset, size_t rows_limit, const RowKeyRange * range);
+
     /// This method is only used to read raw data.
     virtual Block readNextBlock() { throw Exception("Unsupported operation", ErrorCodes::LOGICAL_ERROR); }
 
@@ -156,6 +167,14 @@ size_t copyColumnsData(
     size_t rows_limit,
     const RowKeyRange * range);
 
+/// Like `copyColumnsData`, but add the rows into `gatherer`. `from` must be alive until the rows are gathered.
+size_t gatherColumnsData(
+    const Columns & from,
+    const ColumnPtr & pk_col,
+    ColumnSlicesGatherer & gatherer,
+    size_t rows_offset,
+    size_t rows_limit,
+    const RowKeyRange * range);
 
 /// Debugging string
 template <typename T>
@@ -12,6 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <IO/CompressedReadBuffer.h>
+#include <IO/CompressedWriteBuffer.h>
+#include <IO/ReadBufferFromMemory.h>
+#include <IO/WriteBufferFromString.h>
+#include <Interpreters/Context.h>
 #include <Storages/DeltaMerge/ColumnFile/ColumnFileInMemory.h>
 #include <Storages/DeltaMerge/ColumnFile/ColumnFileTiny.h>
 #include <Storages/DeltaMerge/DMContext.h>
@@ -22,6 +27,32 @@ namespace DB
 {
 namespace DM
 {
+namespace
+{
+/// Decompress the first `rows` rows of a column compressed by `ColumnFileInMemory::compress`.
+MutableColumnPtr decompressColumn(const ColumnFile::Cache & cache, size_t col_offset, const DataTypePtr & type, size_t rows)
+{
+    const auto & data = cache.compressed_columns[col_offset];
+    ReadBufferFromMemory buf(data.data(), data.size());
+    CompressedReadBuffer compressed(buf);
+    auto col_data = type->createColumn();
+    type->deserializeBinaryBulkWithMultipleStreams(*col_data, //
+                                                   [&](const IDataType::SubstreamPath &) { return &compressed; },
+                                                   cache.compressed_rows,
+                                                   static_cast<double>(data.size()) / cache.compressed_rows,
+                                                   true,
+                                                   {});
+    // The column file of an old snapshot may contain less rows than the cache.
+    if (rows < cache.compressed_rows)
+    {
+        auto col_cut = type->createColumn();
+        col_cut->insertRangeFrom(*col_data, 0, rows);
+        return col_cut;
+    }
+    return col_data;
+}
+} // namespace
+
 void ColumnFileInMemory::fillColumns(const ColumnDefines & col_defs, size_t col_count, Columns & result) const
 {
     if (result.size() >= col_count)
@@ -40,8 +71,16 @@ void ColumnFileInMemory::fillColumns(const ColumnDefines & col_defs, size_t col_
             auto col_offset = it->second;
             // Copy data from cache
             const auto & type = getDataType(cd.id);
-            auto col_data = type->createColumn();
-            col_data->insertRangeFrom(*(cache->block.getByPosition(col_offset).column), 0, rows);
+            MutableColumnPtr col_data;
+            if (!cache->compressed_columns.empty())
+            {
+                col_data = decompressColumn(*cache, col_offset, type, rows);
+            }
+            else
+            {
+                col_data = type->createColumn();
+                col_data->insertRangeFrom(*(cache->block.getByPosition(col_offset).column), 0, rows);
+            }
             // Cast if need
             auto col_converted = convertColumnByColumnDefineIfNeed(type, std::move(col_data), cd);
             read_cols.push_back(std::move(col_converted));
@@ -67,7 +106,7 @@ bool ColumnFileInMemory::append(DMContext & context, const Block & data, size_t
         return false;
 
     std::scoped_lock lock(cache->mutex);
-    if (!isSameSchema(cache->block, data))
+    if (!cache->compressed_columns.empty() || !isSameSchema(cache->block, data))
         return false;
 
     // check whether this instance overflows
@@ -87,14 +126,66 @@ bool ColumnFileInMemory::append(DMContext & context, const Block & data, size_t
     return true;
 }
 
+size_t ColumnFileInMemory::compress(const DMContext & context)
+{
+    disable_append = true;
+
+    std::scoped_lock lock(cache->mutex);
+    if (!cache->compressed_columns.empty() || cache->block.rows() == 0)
+        return 0;
+
+    const auto & settings = context.db_context.getSettingsRef();
+    auto & cache_block = cache->block;
+    std::vector<String> compressed_columns;
+    compressed_columns.reserve(cache_block.columns());
+    size_t total_compressed_bytes = 0;
+    for (const auto & col : cache_block)
+    {
+        WriteBufferFromOwnString buf;
+        {
+            CompressedWriteBuffer compressed(buf, CompressionSettings(settings.dt_compression_method, settings.dt_compression_level));
+            col.type->serializeBinaryBulkWithMultipleStreams(*col.column, //
+                                                             [&](const IDataType::SubstreamPath &) { return &compressed; },
+                                                             0,
+                                                             cache_block.rows(),
+                                                             true,
+                                                             {});
+            compressed.next();
+        }
+        compressed_columns.emplace_back(buf.releaseStr());
+        total_compressed_bytes += compressed_columns.back().size();
+    }
+
+    // Not worth it, keep the data as it is.
+    if (total_compressed_bytes >= bytes)
+        return 0;
+
+    cache->compressed_rows = cache_block.rows();
+    cache->compressed_columns.swap(compressed_columns);
+    cache_block = cache_block.cloneEmpty();
+    compressed_bytes = total_compressed_bytes;
+    return bytes - compressed_bytes;
+}
+
 Block ColumnFileInMemory::readDataForFlush() const
 {
     std::scoped_lock lock(cache->mutex);
 
     auto & cache_block = cache->block;
-    MutableColumns columns = cache_block.cloneEmptyColumns();
+    MutableColumns columns(cache_block.columns());
     for (size_t i = 0; i < cache_block.columns(); ++i)
-        columns[i]->insertRangeFrom(*cache_block.getByPosition(i).column, 0, rows);
+    {
+        const auto & type = cache_block.getByPosition(i).type;
+        if (!cache->compressed_columns.empty())
+        {
+            columns[i] = decompressColumn(*cache, i, type, rows);
+        }
+        else
+        {
+            columns[i] = type->createColumn();
+            columns[i]->insertRangeFrom(*cache_block.getByPosition(i).column, 0, rows);
+        }
+    }
     return cache_block.cloneWithColumns(std::move(columns));
 }
 
@@ -119,6 +210,15 @@ size_t ColumnFileInMemoryReader::readRows(MutableColumns & output_cols, size_t r
     return copyColumnsData(cols_data_cache, pk_col, output_cols, rows_offset, rows_limit, range);
 }
 
+size_t ColumnFileInMemoryReader::gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t rows_offset, size_t rows_limit, const RowKeyRange * range)
+{
+    memory_file.fillColumns(*col_defs, output_cols.size(), cols_data_cache);
+
+    // The rows are gathered from the cached columns directly.
+    auto & pk_col = cols_data_cache[0];
+    return gatherColumnsData(cols_data_cache, pk_col, gatherer, rows_offset, rows_limit, range);
+}
+
 Block ColumnFileInMemoryReader::readNextBlock()
 {
     if (read_done)
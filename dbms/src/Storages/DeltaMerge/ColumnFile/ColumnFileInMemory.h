@@ -33,6 +33,8 @@ private:
 
     UInt64 rows = 0;
     UInt64 bytes = 0;
+    // The bytes of the compressed data, 0 means the data is not compressed.
+    UInt64 compressed_bytes = 0;
 
     // whether this instance can append any more data.
     bool disable_append = false;
@@ -66,6 +68,7 @@ public:
 
     size_t getRows() const override { return rows; }
     size_t getBytes() const override { return bytes; };
+    size_t getMemoryBytes() const override { return compressed_bytes ? compressed_bytes : bytes; }
 
     CachePtr getCache() { return cache; }
 
@@ -92,12 +95,17 @@ public:
     }
     bool append(DMContext & dm_context, const Block & data, size_t offset, size_t limit, size_t data_bytes) override;
 
+    /// Compress the data of this sealed column file, it is decompressed by each reader on demand.
+    /// No more data can be appended after that. Return the bytes saved in memory.
+    size_t compress(const DMContext & context);
+
     Block readDataForFlush() const;
 
     String toString() const override
     {
         String s = "{in_memory_file,rows:" + DB::toString(rows) //
             + ",bytes:" + DB::toString(bytes) //
+            + ",compressed_bytes:" + DB::toString(compressed_bytes) //
             + ",disable_append:" + DB::toString(disable_append) //
             + ",schema:" + (schema ? schema->dumpStructure() : "none") //
             + ",cache_block:" + (cache ? cache->block.dumpStructure() : "none") + "}";
@@ -137,6 +145,8 @@ public:
 
     size_t readRows(MutableColumns & output_cols, size_t rows_offset, size_t rows_limit, const RowKeyRange * range) override;
 
+    size_t gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t rows_offset, size_t rows_limit, const RowKeyRange * range) override;
+
     Block readNextBlock() override;
 
     ColumnFileReaderPtr createNewReader(const ColumnDefinesPtr & new_col_defs) override;
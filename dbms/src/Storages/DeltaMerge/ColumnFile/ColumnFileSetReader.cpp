@@ -162,6 +162,36 @@ size_t ColumnFileSetReader::readRows(MutableColumns & output_columns, size_t off
     return actual_read;
 }
 
+size_t ColumnFileSetReader::gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_columns, size_t offset, size_t limit, const RowKeyRange * range)
+{
+    // Filter out the out-of-range rows, see `readRows`.
+    auto total_delta_rows = snapshot->getRows();
+
+    auto start = std::min(offset, total_delta_rows);
+    auto end = std::min(offset + limit, total_delta_rows);
+    if (end == start)
+        return 0;
+
+    auto [start_file_index, rows_start_in_start_file] = locatePosByAccumulation(column_file_rows_end, start);
+    auto [end_file_index, rows_end_in_end_file] = locatePosByAccumulation(column_file_rows_end, end);
+
+    size_t actual_read = 0;
+    for (size_t file_index = start_file_index; file_index <= end_file_index; ++file_index)
+    {
+        size_t rows_start_in_file = file_index == start_file_index ? rows_start_in_start_file : 0;
+        size_t rows_end_in_file = file_index == end_file_index ? rows_end_in_end_file : column_file_rows[file_index];
+        size_t rows_in_file_limit = rows_end_in_file - rows_start_in_file;
+
+        // Nothing to read.
+        if (rows_in_file_limit == 0)
+            continue;
+
+        auto & column_file_reader = column_file_readers[file_index];
+        actual_read += column_file_reader->gatherRows(gatherer, output_columns, rows_start_in_file, rows_in_file_limit, range);
+    }
+    return actual_read;
+}
+
 void ColumnFileSetReader::getPlaceItems(BlockOrDeletes & place_items, size_t rows_begin, size_t deletes_begin, size_t rows_end, size_t deletes_end, size_t place_rows_offset)
 {
     /// Note that we merge the consecutive ColumnFileInMemory or ColumnFileTiny together, which are seperated in groups by ColumnFileDeleteRange and ColumnFileBig.
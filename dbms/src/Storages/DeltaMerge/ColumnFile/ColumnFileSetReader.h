@@ -57,6 +57,9 @@ public:
     // This method will check whether offset and limit are valid. It only return those valid rows.
     size_t readRows(MutableColumns & output_columns, size_t offset, size_t limit, const RowKeyRange * range);
 
+    // Like `readRows`, but add the rows into `gatherer`, so that the rows of many small reads can be copied column by column.
+    size_t gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_columns, size_t offset, size_t limit, const RowKeyRange * range);
+
     void getPlaceItems(BlockOrDeletes & place_items, size_t rows_begin, size_t deletes_begin, size_t rows_end, size_t deletes_end, size_t place_rows_offset = 0);
 
     bool shouldPlace(const DMContext & context,
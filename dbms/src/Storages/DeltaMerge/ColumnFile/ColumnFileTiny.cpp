@@ -240,6 +240,15 @@ size_t ColumnFileTinyReader::readRows(MutableColumns & output_cols, size_t rows_
     return copyColumnsData(cols_data_cache, pk_col, output_cols, rows_offset, rows_limit, range);
 }
 
+size_t ColumnFileTinyReader::gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t rows_offset, size_t rows_limit, const RowKeyRange * range)
+{
+    tiny_file.fillColumns(storage_snap->log_reader, *col_defs, output_cols.size(), cols_data_cache);
+
+    // The rows are gathered from the cached columns directly.
+    auto & pk_col = cols_data_cache[0];
+    return gatherColumnsData(cols_data_cache, pk_col, gatherer, rows_offset, rows_limit, range);
+}
+
 Block ColumnFileTinyReader::readNextBlock()
 {
     if (read_done)
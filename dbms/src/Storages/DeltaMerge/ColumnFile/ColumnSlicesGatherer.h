@@ -0,0 +1,87 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Columns/IColumn.h>
+
+#include <list>
+
+namespace DB
+{
+namespace DM
+{
+/// Collect the rows to copy from the columns of column files as slices, and then copy them column by column.
+/// It is used to read the rows of many small delta entries, which are expensive to copy one by one for all columns.
+class ColumnSlicesGatherer
+{
+public:
+    /// `columns` must be alive until `gather` is called, e.g. the columns cached by the column file readers.
+    void add(const Columns & columns, size_t offset, size_t rows)
+    {
+        if (rows == 0)
+            return;
+        if (!slices.empty() && slices.back().columns == &columns && slices.back().offset + slices.back().rows == offset)
+            slices.back().rows += rows;
+        else
+            slices.push_back(Slice{&columns, offset, rows});
+        total_rows += rows;
+    }
+
+    /// Keep the columns which are not cached by the column file readers alive until `gather` is called.
+    const Columns & hold(Columns && columns)
+    {
+        holders.push_back(std::move(columns));
+        return holders.back();
+    }
+
+    size_t rows() const { return total_rows; }
+
+    /// Append the rows of all slices to `to` and clear the slices. Returns the number of rows appended.
+    size_t gather(MutableColumns & to)
+    {
+        for (size_t col_index = 0; col_index < to.size(); ++col_index)
+        {
+            auto & column = *to[col_index];
+            for (const auto & slice : slices)
+            {
+                const auto & from = *(*slice.columns)[col_index];
+                if (slice.rows == 1)
+                    column.insertFrom(from, slice.offset);
+                else
+                    column.insertRangeFrom(from, slice.offset, slice.rows);
+            }
+        }
+        auto gathered_rows = total_rows;
+        slices.clear();
+        holders.clear();
+        total_rows = 0;
+        return gathered_rows;
+    }
+
+private:
+    struct Slice
+    {
+        const Columns * columns;
+        size_t offset;
+        size_t rows;
+    };
+    std::vector<Slice> slices;
+    std::list<Columns> holders;
+    size_t total_rows = 0;
+};
+
+} // namespace DM
+} // namespace DB
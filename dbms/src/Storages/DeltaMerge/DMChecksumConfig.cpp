@@ -54,6 +54,9 @@ DMChecksumConfig::DMChecksumConfig(std::istream & input)
     case static_cast<uint64_t>(DB::ChecksumAlgo::XXH3):
         digest = std::make_unique<DB::UnifiedDigest<DB::Digest::XXH3>>();
         break;
+    case static_cast<uint64_t>(DB::ChecksumAlgo::CRC32C):
+        digest = std::make_unique<DB::UnifiedDigest<DB::Digest::CRC32C>>();
+        break;
     default:
         throw TiFlashException("unrecognized checksum algorithm", Errors::Checksum::Internal);
     }
@@ -60,6 +60,8 @@ public:
             return sizeof(DB::ChecksumFrame<DB::Digest::City128>);
         case DB::ChecksumAlgo::XXH3:
             return sizeof(DB::ChecksumFrame<DB::Digest::XXH3>);
+        case DB::ChecksumAlgo::CRC32C:
+            return sizeof(DB::ChecksumFrame<DB::Digest::CRC32C>);
         }
         throw TiFlashException("unrecognized checksum algorithm", Errors::Checksum::Internal);
     }
@@ -83,6 +85,8 @@ public:
             return std::make_unique<DB::UnifiedDigest<DB::Digest::City128>>();
         case DB::ChecksumAlgo::XXH3:
             return std::make_unique<DB::UnifiedDigest<DB::Digest::XXH3>>();
+        case DB::ChecksumAlgo::CRC32C:
+            return std::make_unique<DB::UnifiedDigest<DB::Digest::CRC32C>>();
         default:
             throw TiFlashException("unrecognized checksum algorithm", Errors::Checksum::Internal);
         }
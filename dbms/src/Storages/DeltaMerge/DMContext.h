@@ -20,6 +20,7 @@
 #include <Interpreters/Settings.h>
 #include <Storages/DeltaMerge/DMChecksumConfig.h>
 #include <Storages/DeltaMerge/DeltaMergeDefines.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
 
 namespace DB
 {
@@ -32,6 +33,8 @@ class StoragePool;
 using NotCompress = std::unordered_set<ColId>;
 struct DMContext;
 using DMContextPtr = std::shared_ptr<DMContext>;
+struct LateMaterializationFilter;
+using LateMaterializationFilterPtr = std::shared_ptr<LateMaterializationFilter>;
 
 /**
  * This context object carries table infos. And those infos are only meaningful to current context.
@@ -63,10 +66,20 @@ struct DMContext : private boost::noncopyable
     const size_t delta_limit_rows;
     // The bytes threshold of delta.
     const size_t delta_limit_bytes;
+    // Merge the delta of a frequently read segment earlier, see `dt_segment_delta_read_merge_factor`.
+    const size_t delta_read_merge_factor;
+    // Merge the delta of a segment with many obsolete versions noticed by reads, see `dt_read_gc_garbage_ratio_threshold`.
+    const double read_gc_garbage_ratio_threshold;
+    // Adapt the segment size to the write and read rates, see `dt_segment_adaptive_hot_write_rows`.
+    const size_t segment_hot_write_rows;
+    // The max number of segments merged into one at a time, see `dt_segment_merge_max_segments`.
+    const size_t segment_merge_max_segments;
     // The threshold of cache in delta.
     const size_t delta_cache_limit_rows;
     // The size threshold of cache in delta.
     const size_t delta_cache_limit_bytes;
+    // Compress the sealed in-memory column files, see `dt_segment_delta_cache_compress`.
+    const bool delta_cache_compress;
     // Determine whether a column file is small or not in rows.
     const size_t delta_small_column_file_rows;
     // Determine whether a column file is small or not in bytes.
@@ -85,6 +98,17 @@ struct DMContext : private boost::noncopyable
 
     String tracing_id;
 
+    // The pushed down filter of current read request, only used by clean read on stable.
+    // Set by `DeltaMergeStore::read`, nullptr means late materialization is disabled.
+    LateMaterializationFilterPtr late_materialization_filter;
+
+    // Only the row count of the current read request is used, e.g. `select count(*)`, so the clean read on stable
+    // can skip reading the column values. Set by `DeltaMergeStore::read`.
+    bool read_rows_only = false;
+
+    // The time spent on the stages of current read request. Set by `DeltaMergeStore::read`, nullptr means not profiled.
+    ReadStageProfilePtr read_stage_profile;
+
 public:
     DMContext(const Context & db_context_,
               StoragePathPool & path_pool_,
@@ -109,8 +133,13 @@ public:
         , segment_force_split_bytes(settings.dt_segment_force_split_size)
         , delta_limit_rows(settings.dt_segment_delta_limit_rows)
         , delta_limit_bytes(settings.dt_segment_delta_limit_size)
+        , delta_read_merge_factor(settings.dt_segment_delta_read_merge_factor)
+        , read_gc_garbage_ratio_threshold(settings.dt_read_gc_garbage_ratio_threshold)
+        , segment_hot_write_rows(settings.dt_segment_adaptive_hot_write_rows)
+        , segment_merge_max_segments(settings.dt_segment_merge_max_segments)
         , delta_cache_limit_rows(settings.dt_segment_delta_cache_limit_rows)
         , delta_cache_limit_bytes(settings.dt_segment_delta_cache_limit_size)
+        , delta_cache_compress(settings.dt_segment_delta_cache_compress)
         , delta_small_column_file_rows(settings.dt_segment_delta_small_column_file_rows)
         , delta_small_column_file_bytes(settings.dt_segment_delta_small_column_file_size)
         , stable_pack_rows(settings.dt_segment_stable_pack_rows)
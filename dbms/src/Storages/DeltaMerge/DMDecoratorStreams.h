@@ -18,6 +18,7 @@
 #include <DataStreams/IBlockInputStream.h>
 #include <Storages/DeltaMerge/DMContext.h>
 #include <Storages/DeltaMerge/DeltaMergeHelpers.h>
+#include <Storages/DeltaMerge/RowKeyRange.h>
 #include <common/logger_useful.h>
 
 #include <unordered_set>
@@ -140,6 +141,78 @@ private:
     LoggerPtr log;
 };
 
+/// DMSupersededFilterBlockInputStream filters out the rows superseded by the delta from the sorted stable rows,
+/// i.e. the rows whose handle is written in the delta, or is covered by a delete range in the delta.
+/// `superseded_keys` should be sorted and unique.
+class DMSupersededFilterBlockInputStream : public IBlockInputStream
+{
+public:
+    DMSupersededFilterBlockInputStream(
+        const BlockInputStreamPtr & input,
+        std::vector<RowKeyValue> && superseded_keys_,
+        RowKeyRanges && delete_ranges_,
+        bool is_common_handle_)
+        : superseded_keys(std::move(superseded_keys_))
+        , delete_ranges(std::move(delete_ranges_))
+        , is_common_handle(is_common_handle_)
+    {
+        children.emplace_back(input);
+        handle_col_pos = input->getHeader().getPositionByName(EXTRA_HANDLE_COLUMN_NAME);
+    }
+
+    String getName() const override { return "DMSupersededFilter"; }
+
+    Block getHeader() const override { return children.back()->getHeader(); }
+
+    Block read() override
+    {
+        while (true)
+        {
+            Block block = children.back()->read();
+            if (!block)
+                return {};
+            const size_t rows = block.rows();
+            if (rows == 0)
+                continue;
+
+            RowKeyColumnContainer rowkey_column(block.getByPosition(handle_col_pos).column, is_common_handle);
+            filter.resize(rows);
+            for (size_t i = 0; i < rows; ++i)
+            {
+                auto rowkey_value = rowkey_column.getRowKeyValue(i);
+                // Both the rows and the keys are sorted, so the cursor only moves forward.
+                while (next_key < superseded_keys.size() && compare(superseded_keys[next_key].toRowKeyValueRef(), rowkey_value) < 0)
+                    ++next_key;
+                bool superseded = next_key < superseded_keys.size() && compare(superseded_keys[next_key].toRowKeyValueRef(), rowkey_value) == 0;
+                for (size_t r = 0; r < delete_ranges.size() && !superseded; ++r)
+                    superseded = delete_ranges[r].check(rowkey_value);
+                filter[i] = !superseded;
+            }
+
+            const size_t passed_count = countBytesInFilter(filter);
+            if (passed_count == 0)
+                continue;
+            if (passed_count == rows)
+                return block;
+            for (size_t i = 0; i < block.columns(); ++i)
+            {
+                auto & column = block.getByPosition(i);
+                column.column = column.column->filter(filter, passed_count);
+            }
+            return block;
+        }
+    }
+
+private:
+    const std::vector<RowKeyValue> superseded_keys;
+    const RowKeyRanges delete_ranges;
+    const bool is_common_handle;
+
+    size_t handle_col_pos;
+    size_t next_key = 0;
+    IColumn::Filter filter;
+};
+
 class DMColumnProjectionBlockInputStream : public IBlockInputStream
 {
 public:
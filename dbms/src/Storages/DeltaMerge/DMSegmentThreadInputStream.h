@@ -78,6 +78,10 @@ public:
 
     Block getHeader() const override { return header; }
 
+    size_t getExpectedBlockSize() const { return expected_block_size; }
+
+    const ReadStageProfilePtr & getReadStageProfile() const { return dm_context->read_stage_profile; }
+
 protected:
     Block readImpl() override
     {
@@ -89,6 +93,7 @@ protected:
     {
         if (done)
             return {};
+        ReadStageProfile::Scope profile_scope(dm_context->read_stage_profile.get());
         while (true)
         {
             while (!cur_stream)
@@ -139,6 +144,7 @@ protected:
                 else
                 {
                     total_rows += res.rows();
+                    task_pool->addReadRows(res.rows());
                     return res;
                 }
             }
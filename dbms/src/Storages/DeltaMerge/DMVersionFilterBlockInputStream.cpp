@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <Storages/DeltaMerge/DMVersionFilterBlockInputStream.h>
+#include <Storages/DeltaMerge/DMVersionFilterKernels.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
 
 namespace ProfileEvents
 {
@@ -44,6 +46,7 @@ void DMVersionFilterBlockInputStream<MODE>::readSuffix()
 template <int MODE>
 Block DMVersionFilterBlockInputStream<MODE>::read(FilterPtr & res_filter, bool return_filter)
 {
+    ReadStageTimer timer(ReadStage::VersionFilter);
     while (true)
     {
         if (!raw_block)
@@ -74,212 +77,59 @@ Block DMVersionFilterBlockInputStream<MODE>::read(FilterPtr & res_filter, bool r
 
         filter.resize(rows);
 
-        const size_t batch_rows = (rows - 1) / UNROLL_BATCH * UNROLL_BATCH;
+        // All the rows except the last one can be checked with the next row in current block.
+        const size_t batch_rows = rows - 1;
 
-        // The following is trying to unroll the filtering operations,
-        // so that optimizer could use vectorized optimization.
-        // The original logic can be seen in #checkWithNextIndex().
+        handle_not_equal_next.resize(batch_rows);
+        if (is_common_handle)
+        {
+            UInt8 * not_equal_pos = handle_not_equal_next.data();
+            for (size_t i = 0; i < batch_rows; ++i)
+                not_equal_pos[i] = compare(rowkey_column->getRowKeyValue(i), rowkey_column->getRowKeyValue(i + 1)) != 0;
+        }
+        else
+        {
+            calcIntHandleNotEqualNext(rowkey_column->int_data->data(), handle_not_equal_next.data(), batch_rows);
+        }
 
         if constexpr (MODE == DM_VERSION_FILTER_MODE_MVCC)
         {
-            /// filter[i] = !deleted && cur_version <= version_limit && (cur_handle != next_handle || next_version > version_limit)
-            {
-                UInt8 * filter_pos = filter.data();
-                auto * version_pos = const_cast<UInt64 *>(version_col_data->data()) + 1;
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) = (*version_pos) > version_limit;
-
-                    ++filter_pos;
-                    ++version_pos;
-                }
-            }
-
-            {
-                UInt8 * filter_pos = filter.data();
-                size_t handle_pos = 0;
-                size_t next_handle_pos = handle_pos + 1;
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos)
-                        |= compare(rowkey_column->getRowKeyValue(handle_pos), rowkey_column->getRowKeyValue(next_handle_pos)) != 0;
-                    ++filter_pos;
-                    ++handle_pos;
-                    ++next_handle_pos;
-                }
-            }
-
-            {
-                UInt8 * filter_pos = filter.data();
-                auto * version_pos = const_cast<UInt64 *>(version_col_data->data());
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) &= (*version_pos) <= version_limit;
-
-                    ++filter_pos;
-                    ++version_pos;
-                }
-            }
-
-            {
-                UInt8 * filter_pos = filter.data();
-                auto * delete_pos = const_cast<UInt8 *>(delete_col_data->data());
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) &= !(*delete_pos);
-
-                    ++filter_pos;
-                    ++delete_pos;
-                }
-            }
+            calcMVCCFilter(
+                handle_not_equal_next.data(),
+                version_col_data->data(),
+                delete_col_data->data(),
+                version_limit,
+                filter.data(),
+                batch_rows);
         }
         else if constexpr (MODE == DM_VERSION_FILTER_MODE_COMPACT)
         {
-            /// filter[i] = cur_version >= version_limit || ((cur_handle != next_handle || next_version > version_limit) && !deleted);
-
-            {
-                UInt8 * filter_pos = filter.data();
-                size_t handle_pos = 0;
-                size_t next_handle_pos = handle_pos + 1;
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) = compare(rowkey_column->getRowKeyValue(handle_pos), rowkey_column->getRowKeyValue(next_handle_pos)) != 0;
-                    ++filter_pos;
-                    ++handle_pos;
-                    ++next_handle_pos;
-                }
-            }
-
-            {
-                UInt8 * filter_pos = filter.data();
-                auto * version_pos = const_cast<UInt64 *>(version_col_data->data());
-                auto * next_version_pos = version_pos + 1;
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) |= (*next_version_pos) > version_limit;
-
-                    ++filter_pos;
-                    ++next_version_pos;
-                }
-            }
-
-            {
-                UInt8 * filter_pos = filter.data();
-                auto * delete_pos = const_cast<UInt8 *>(delete_col_data->data());
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) &= !(*delete_pos);
-
-                    ++filter_pos;
-                    ++delete_pos;
-                }
-            }
-
-            {
-                UInt8 * filter_pos = filter.data();
-                auto * version_pos = const_cast<UInt64 *>(version_col_data->data());
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*filter_pos) |= (*version_pos) >= version_limit;
-
-                    ++filter_pos;
-                    ++version_pos;
-                }
-            }
-
-            // Let's set effective.
             effective.resize(rows);
-
-            {
-                UInt8 * effective_pos = effective.data();
-                size_t handle_pos = 0;
-                size_t next_handle_pos = handle_pos + 1;
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*effective_pos)
-                        = compare(rowkey_column->getRowKeyValue(handle_pos), rowkey_column->getRowKeyValue(next_handle_pos)) != 0;
-                    ++effective_pos;
-                    ++handle_pos;
-                    ++next_handle_pos;
-                }
-            }
-
-            {
-                UInt8 * effective_pos = effective.data();
-                UInt8 * filter_pos = filter.data();
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*effective_pos) &= (*filter_pos);
-
-                    ++effective_pos;
-                    ++filter_pos;
-                }
-            }
-
-            // Let's set not_clean.
             not_clean.resize(rows);
-
-            {
-                UInt8 * not_clean_pos = not_clean.data();
-                size_t handle_pos = 0;
-                size_t next_handle_pos = handle_pos + 1;
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*not_clean_pos)
-                        = compare(rowkey_column->getRowKeyValue(handle_pos), rowkey_column->getRowKeyValue(next_handle_pos)) == 0;
-                    ++not_clean_pos;
-                    ++handle_pos;
-                    ++next_handle_pos;
-                }
-            }
-
-            {
-                UInt8 * not_clean_pos = not_clean.data();
-                auto * delete_pos = const_cast<UInt8 *>(delete_col_data->data());
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*not_clean_pos) |= (*delete_pos);
-
-                    ++not_clean_pos;
-                    ++delete_pos;
-                }
-            }
-
-            {
-                UInt8 * not_clean_pos = not_clean.data();
-                UInt8 * filter_pos = filter.data();
-                for (size_t i = 0; i < batch_rows; ++i)
-                {
-                    (*not_clean_pos) &= (*filter_pos);
-
-                    ++not_clean_pos;
-                    ++filter_pos;
-                }
-            }
+            calcCompactFilter(
+                handle_not_equal_next.data(),
+                version_col_data->data(),
+                delete_col_data->data(),
+                version_limit,
+                filter.data(),
+                effective.data(),
+                not_clean.data(),
+                batch_rows);
 
             // Let's calculate gc_hint_version
             gc_hint_version = std::numeric_limits<UInt64>::max();
             {
-                UInt8 * filter_pos = filter.data();
-                size_t handle_pos = 0;
-                size_t next_handle_pos = handle_pos + 1;
-                auto * version_pos = const_cast<UInt64 *>(version_col_data->data());
-                auto * delete_pos = const_cast<UInt8 *>(delete_col_data->data());
+                const auto & versions = *version_col_data;
+                const auto & deletes = *delete_col_data;
                 for (size_t i = 0; i < batch_rows; ++i)
                 {
-                    if (*filter_pos)
+                    if (filter[i])
                         gc_hint_version = std::min(gc_hint_version,
-                                                   calculateRowGcHintVersion(rowkey_column->getRowKeyValue(handle_pos),
-                                                                             *version_pos,
-                                                                             rowkey_column->getRowKeyValue(next_handle_pos),
+                                                   calculateRowGcHintVersion(rowkey_column->getRowKeyValue(i),
+                                                                             versions[i],
+                                                                             rowkey_column->getRowKeyValue(i + 1),
                                                                              true,
-                                                                             *delete_pos));
-
-                    ++filter_pos;
-                    ++handle_pos;
-                    ++next_handle_pos;
-                    ++version_pos;
-                    ++delete_pos;
+                                                                             deletes[i]));
                 }
             }
         }
@@ -288,9 +138,6 @@ Block DMVersionFilterBlockInputStream<MODE>::read(FilterPtr & res_filter, bool r
             throw Exception("Unsupported mode");
         }
 
-        for (size_t i = batch_rows; i < rows - 1; ++i)
-            checkWithNextIndex(i);
-
         {
             // Now let's handle the last row of current block.
             auto cur_handle = rowkey_column->getRowKeyValue(rows - 1);
@@ -36,7 +36,6 @@ static constexpr int DM_VERSION_FILTER_MODE_COMPACT = 1;
 template <int MODE>
 class DMVersionFilterBlockInputStream : public IBlockInputStream
 {
-    static constexpr size_t UNROLL_BATCH = 64;
     static_assert(MODE == DM_VERSION_FILTER_MODE_MVCC || MODE == DM_VERSION_FILTER_MODE_COMPACT);
 
     constexpr static const char * MVCC_FILTER_NAME = "DMVersionFilterBlockInputStream<MVCC>";
@@ -98,37 +97,6 @@ public:
     UInt64 getGCHintVersion() const { return gc_hint_version; }
 
 private:
-    inline void checkWithNextIndex(size_t i)
-    {
-#define cur_handle rowkey_column->getRowKeyValue(i)
-#define next_handle rowkey_column->getRowKeyValue(i + 1)
-#define cur_version (*version_col_data)[i]
-#define next_version (*version_col_data)[i + 1]
-#define deleted (*delete_col_data)[i]
-        if constexpr (MODE == DM_VERSION_FILTER_MODE_MVCC)
-        {
-            filter[i] = !deleted && cur_version <= version_limit && (compare(cur_handle, next_handle) != 0 || next_version > version_limit);
-        }
-        else if constexpr (MODE == DM_VERSION_FILTER_MODE_COMPACT)
-        {
-            filter[i]
-                = cur_version >= version_limit || ((compare(cur_handle, next_handle) != 0 || next_version > version_limit) && !deleted);
-            not_clean[i] = filter[i] && (compare(cur_handle, next_handle) == 0 || deleted);
-            effective[i] = filter[i] && (compare(cur_handle, next_handle) != 0);
-            if (filter[i])
-                gc_hint_version = std::min(gc_hint_version, calculateRowGcHintVersion(cur_handle, cur_version, next_handle, true, deleted));
-        }
-        else
-        {
-            throw Exception("Unsupported mode");
-        }
-#undef cur_handle
-#undef next_handle
-#undef cur_version
-#undef next_version
-#undef deleted
-    }
-
     bool initNextBlock()
     {
         raw_block = ::DB::DM::readNextBlock(children.back());
@@ -206,6 +174,8 @@ private:
     size_t delete_col_pos;
 
     IColumn::Filter filter{};
+    // handle_not_equal_next[i] = handle of row i not equals with handle of row i + 1
+    IColumn::Filter handle_not_equal_next{};
     // effective = selected & handle not equals with next
     IColumn::Filter effective{};
     // not_clean = selected & (handle equals with next || deleted)
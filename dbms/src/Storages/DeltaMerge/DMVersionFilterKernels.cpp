@@ -0,0 +1,79 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Common/TargetSpecific.h>
+#include <Storages/DeltaMerge/DMVersionFilterKernels.h>
+
+namespace DB
+{
+namespace DM
+{
+// The loops are written without branches, so that the compiler can vectorize them
+// with the instruction set of each target.
+
+TIFLASH_DECLARE_MULTITARGET_FUNCTION(
+    void,
+    calcIntHandleNotEqualNext,
+    (handles, handle_not_equal_next, rows),
+    (const Int64 * handles, UInt8 * handle_not_equal_next, size_t rows),
+    {
+        for (size_t i = 0; i < rows; ++i)
+            handle_not_equal_next[i] = handles[i] != handles[i + 1];
+    })
+
+TIFLASH_DECLARE_MULTITARGET_FUNCTION(
+    void,
+    calcMVCCFilter,
+    (handle_not_equal_next, versions, deleted, version_limit, filter, rows),
+    (const UInt8 * handle_not_equal_next,
+     const UInt64 * versions,
+     const UInt8 * deleted,
+     UInt64 version_limit,
+     UInt8 * filter,
+     size_t rows),
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            UInt8 is_latest = handle_not_equal_next[i] | static_cast<UInt8>(versions[i + 1] > version_limit);
+            filter[i] = is_latest & static_cast<UInt8>(versions[i] <= version_limit) & static_cast<UInt8>(!deleted[i]);
+        }
+    })
+
+TIFLASH_DECLARE_MULTITARGET_FUNCTION(
+    void,
+    calcCompactFilter,
+    (handle_not_equal_next, versions, deleted, version_limit, filter, effective, not_clean, rows),
+    (const UInt8 * handle_not_equal_next,
+     const UInt64 * versions,
+     const UInt8 * deleted,
+     UInt64 version_limit,
+     UInt8 * filter,
+     UInt8 * effective,
+     UInt8 * not_clean,
+     size_t rows),
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            UInt8 not_equal_next = handle_not_equal_next[i];
+            UInt8 is_deleted = static_cast<UInt8>(deleted[i] != 0);
+            UInt8 is_latest = not_equal_next | static_cast<UInt8>(versions[i + 1] > version_limit);
+            UInt8 selected = static_cast<UInt8>(versions[i] >= version_limit) | (is_latest & (is_deleted ^ 1));
+            filter[i] = selected;
+            effective[i] = selected & not_equal_next;
+            not_clean[i] = selected & ((not_equal_next ^ 1) | is_deleted);
+        }
+    })
+
+} // namespace DM
+} // namespace DB
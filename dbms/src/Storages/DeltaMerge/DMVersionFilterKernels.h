@@ -0,0 +1,57 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <common/types.h>
+
+#include <cstddef>
+
+namespace DB
+{
+namespace DM
+{
+/// Bulk kernels of DMVersionFilterBlockInputStream. They are dispatched to AVX512/AVX2/SSE4
+/// implementations at runtime, see `Common/TargetSpecific.h`.
+///
+/// All of them process the rows in [0, rows), and the values of row `i + 1` are accessed for
+/// row `i`. So the caller must make sure `handles` and `versions` contain at least `rows + 1` elements.
+
+/// handle_not_equal_next[i] = handles[i] != handles[i + 1]
+void calcIntHandleNotEqualNext(const Int64 * handles, UInt8 * handle_not_equal_next, size_t rows);
+
+/// filter[i] = !deleted[i] && versions[i] <= version_limit && (handle_not_equal_next[i] || versions[i + 1] > version_limit)
+void calcMVCCFilter(
+    const UInt8 * handle_not_equal_next,
+    const UInt64 * versions,
+    const UInt8 * deleted,
+    UInt64 version_limit,
+    UInt8 * filter,
+    size_t rows);
+
+/// filter[i] = versions[i] >= version_limit || ((handle_not_equal_next[i] || versions[i + 1] > version_limit) && !deleted[i])
+/// effective[i] = filter[i] && handle_not_equal_next[i]
+/// not_clean[i] = filter[i] && (!handle_not_equal_next[i] || deleted[i])
+void calcCompactFilter(
+    const UInt8 * handle_not_equal_next,
+    const UInt64 * versions,
+    const UInt8 * deleted,
+    UInt64 version_limit,
+    UInt8 * filter,
+    UInt8 * effective,
+    UInt8 * not_clean,
+    size_t rows);
+
+} // namespace DM
+} // namespace DB
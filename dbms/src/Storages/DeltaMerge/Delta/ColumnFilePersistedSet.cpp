@@ -41,13 +41,38 @@ inline ColumnFilePersisteds flattenColumnFileLevels(const ColumnFilePersistedSet
     return column_files;
 }
 
-inline void serializeColumnFilePersistedLevels(WriteBatches & wbs, PageId id, const ColumnFilePersistedSet::ColumnFilePersistedLevels & file_levels)
+/// The metadata page of column files may contain a second field, which is the delta index of these column files.
+/// Any rewrite of the metadata (e.g. flush, compaction) drops the second field, so the persisted delta index
+/// is always placed on exactly the column files in the first field.
+static constexpr size_t META_FIELD_COLUMN_FILES = 0;
+static constexpr size_t META_FIELD_DELTA_INDEX = 1;
+
+inline void serializeColumnFilePersistedLevels(WriteBatches & wbs, PageId id, const ColumnFilePersistedSet::ColumnFilePersistedLevels & file_levels, const DeltaIndexPtr & delta_index = nullptr)
 {
     MemoryWriteBuffer buf(0, COLUMN_FILE_SERIALIZE_BUFFER_SIZE);
     auto column_files = flattenColumnFileLevels(file_levels);
     serializeSavedColumnFiles(buf, column_files);
     auto data_size = buf.count();
-    wbs.meta.putPage(id, 0, buf.tryGetReadBuffer(), data_size);
+    if (!delta_index)
+    {
+        wbs.meta.putPage(id, 0, buf.tryGetReadBuffer(), data_size);
+        return;
+    }
+
+    // Tag the delta index with the column files, so that we can check whether it is still valid when restoring it.
+    UInt64 rows = 0;
+    UInt64 deletes = 0;
+    for (const auto & file : column_files)
+    {
+        rows += file->getRows();
+        deletes += file->getDeletes();
+    }
+    writeIntBinary(static_cast<UInt64>(column_files.size()), buf);
+    writeIntBinary(rows, buf);
+    writeIntBinary(deletes, buf);
+    delta_index->serialize(buf);
+    auto total_size = buf.count();
+    wbs.meta.putPage(id, 0, buf.tryGetReadBuffer(), total_size, PageFieldSizes{data_size, total_size - data_size});
 }
 
 void ColumnFilePersistedSet::updateColumnFileStats()
@@ -107,10 +132,73 @@ ColumnFilePersistedSet::ColumnFilePersistedSet(PageId metadata_id_, const Column
 
 ColumnFilePersistedSetPtr ColumnFilePersistedSet::restore(DMContext & context, const RowKeyRange & segment_range, PageId id)
 {
-    Page page = context.storage_pool.metaReader()->read(id);
-    ReadBufferFromMemory buf(page.data.begin(), page.data.size());
-    auto column_files = deserializeSavedColumnFiles(context, segment_range, buf);
-    return std::make_shared<ColumnFilePersistedSet>(id, column_files);
+    auto & meta_reader = context.storage_pool.metaReader();
+    // Only read the column files here, the persisted delta index (if any) is restored lazily on the first read.
+    const bool has_persisted_delta_index = meta_reader->getPageEntry(id).field_offsets.size() > META_FIELD_DELTA_INDEX;
+    ColumnFilePersisteds column_files;
+    if (has_persisted_delta_index)
+    {
+        auto page_map = meta_reader->read({PageReader::PageReadFields{id, {META_FIELD_COLUMN_FILES}}});
+        auto data = page_map[id].getFieldData(META_FIELD_COLUMN_FILES);
+        ReadBufferFromMemory buf(data.begin(), data.size());
+        column_files = deserializeSavedColumnFiles(context, segment_range, buf);
+    }
+    else
+    {
+        Page page = meta_reader->read(id);
+        ReadBufferFromMemory buf(page.data.begin(), page.data.size());
+        column_files = deserializeSavedColumnFiles(context, segment_range, buf);
+    }
+    auto persisted_file_set = std::make_shared<ColumnFilePersistedSet>(id, column_files);
+    persisted_file_set->has_persisted_delta_index = has_persisted_delta_index;
+    return persisted_file_set;
+}
+
+DeltaIndexPtr ColumnFilePersistedSet::tryRestoreDeltaIndex(const DMContext & context)
+{
+    // Only try once, the delta index in memory is always newer after that.
+    if (!has_persisted_delta_index.exchange(false))
+        return nullptr;
+
+    try
+    {
+        auto & meta_reader = context.storage_pool.metaReader();
+        // The metadata could be rewritten without delta index since reboot.
+        if (meta_reader->getPageEntry(metadata_id).field_offsets.size() <= META_FIELD_DELTA_INDEX)
+            return nullptr;
+
+        auto page_map = meta_reader->read({PageReader::PageReadFields{metadata_id, {META_FIELD_DELTA_INDEX}}});
+        auto data = page_map[metadata_id].getFieldData(META_FIELD_DELTA_INDEX);
+        ReadBufferFromMemory buf(data.begin(), data.size());
+
+        UInt64 tag_files_count;
+        UInt64 tag_rows;
+        UInt64 tag_deletes;
+        readIntBinary(tag_files_count, buf);
+        readIntBinary(tag_rows, buf);
+        readIntBinary(tag_deletes, buf);
+        if (tag_files_count != persisted_files_count || tag_rows != rows || tag_deletes != deletes)
+        {
+            LOG_FMT_DEBUG(log, "{} Ignore the persisted delta index because column files changed. Persisted: files[{}] rows[{}] deletes[{}]", info(), tag_files_count, tag_rows, tag_deletes);
+            return nullptr;
+        }
+
+        auto delta_index = DeltaIndex::deserialize(buf);
+        auto [placed_rows, placed_deletes] = delta_index->getPlacedStatus();
+        if (placed_rows > rows || placed_deletes > deletes)
+        {
+            LOG_FMT_WARNING(log, "{} Ignore the persisted delta index because it is placed beyond the column files: placed rows[{}] deletes[{}]", info(), placed_rows, placed_deletes);
+            return nullptr;
+        }
+        LOG_FMT_DEBUG(log, "{} Restored delta index: {}", simpleInfo(), delta_index->toString());
+        return delta_index;
+    }
+    catch (...)
+    {
+        // The delta index can always be rebuilt by placing the delta again.
+        tryLogCurrentException(log, simpleInfo() + " Failed to restore the persisted delta index");
+        return nullptr;
+    }
 }
 
 void ColumnFilePersistedSet::saveMeta(WriteBatches & wbs) const
@@ -118,6 +206,11 @@ void ColumnFilePersistedSet::saveMeta(WriteBatches & wbs) const
     serializeColumnFilePersistedLevels(wbs, metadata_id, persisted_files_levels);
 }
 
+void ColumnFilePersistedSet::saveMetaWithDeltaIndex(WriteBatches & wbs, const DeltaIndexPtr & delta_index) const
+{
+    serializeColumnFilePersistedLevels(wbs, metadata_id, persisted_files_levels, delta_index);
+}
+
 void ColumnFilePersistedSet::recordRemoveColumnFilesPages(WriteBatches & wbs) const
 {
     for (const auto & level : persisted_files_levels)
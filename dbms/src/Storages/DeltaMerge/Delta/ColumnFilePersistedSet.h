@@ -64,6 +64,9 @@ private:
     std::atomic<size_t> bytes = 0;
     std::atomic<size_t> deletes = 0;
 
+    /// Whether the metadata page restored after reboot contains a delta index which is not restored yet.
+    std::atomic_bool has_persisted_delta_index = false;
+
     /// below are just state resides in memory
     UInt64 flush_version = 0;
     size_t next_compaction_level = 0;
@@ -106,6 +109,13 @@ public:
 
     void saveMeta(WriteBatches & wbs) const;
 
+    /// Save the metadata along with `delta_index`, which must be placed on the column files in this instance only.
+    void saveMetaWithDeltaIndex(WriteBatches & wbs, const DeltaIndexPtr & delta_index) const;
+
+    /// Restore the delta index persisted along with the metadata before reboot.
+    /// Returns nullptr if there is none, or it does not match the current column files.
+    DeltaIndexPtr tryRestoreDeltaIndex(const DMContext & context);
+
     void recordRemoveColumnFilesPages(WriteBatches & wbs) const;
 
     BlockPtr getLastSchema();
@@ -106,6 +106,7 @@ bool DeltaValueSpace::appendColumnFile(DMContext & /*context*/, const ColumnFile
         return false;
 
     mem_table_set->appendColumnFile(column_file);
+    version.fetch_add(1, std::memory_order_acq_rel);
     return true;
 }
 
@@ -116,6 +117,7 @@ bool DeltaValueSpace::appendToCache(DMContext & context, const Block & block, si
         return false;
 
     mem_table_set->appendToCache(context, block, offset, limit);
+    version.fetch_add(1, std::memory_order_acq_rel);
     return true;
 }
 
@@ -126,6 +128,7 @@ bool DeltaValueSpace::appendDeleteRange(DMContext & /*context*/, const RowKeyRan
         return false;
 
     mem_table_set->appendDeleteRange(delete_range);
+    version.fetch_add(1, std::memory_order_acq_rel);
     return true;
 }
 
@@ -136,6 +139,7 @@ bool DeltaValueSpace::ingestColumnFiles(DMContext & /*context*/, const RowKeyRan
         return false;
 
     mem_table_set->ingestColumnFiles(range, column_files, clear_data_in_range);
+    version.fetch_add(1, std::memory_order_acq_rel);
     return true;
 }
 
@@ -213,12 +217,35 @@ bool DeltaValueSpace::flush(DMContext & context)
         /// Update delta tree
         if (new_delta_index)
             delta_index = new_delta_index;
+        version.fetch_add(1, std::memory_order_acq_rel);
 
         LOG_FMT_DEBUG(log, "{} Flush end. Flushed {} column files, {} rows and {} deletes.", info(), flush_task->getTaskNum(), flush_task->getFlushRows(), flush_task->getFlushDeletes());
     }
     return true;
 }
 
+bool DeltaValueSpace::persistDeltaIndex(DMContext & context)
+{
+    /// Hold the lock during writing, so that no one else can rewrite the metadata concurrently.
+    std::scoped_lock lock(mutex);
+    if (abandoned.load(std::memory_order_relaxed))
+        return false;
+
+    auto placed_status = delta_index->getPlacedStatus();
+    if (placed_status.first != persisted_file_set->getRows() || placed_status.second != persisted_file_set->getDeletes())
+        return false;
+    if (placed_status == persisted_delta_index_status || placed_status == std::make_pair<size_t, size_t>(0, 0))
+        return false;
+
+    WriteBatches wbs(context.storage_pool, context.getWriteLimiter());
+    persisted_file_set->saveMetaWithDeltaIndex(wbs, delta_index);
+    wbs.writeMeta();
+    persisted_delta_index_status = placed_status;
+
+    LOG_FMT_DEBUG(log, "{} Persisted delta index: {}", simpleInfo(), delta_index->toString());
+    return true;
+}
+
 bool DeltaValueSpace::compact(DMContext & context)
 {
     bool v = false;
@@ -275,6 +302,7 @@ bool DeltaValueSpace::compact(DMContext & context)
             return false;
         }
 
+        version.fetch_add(1, std::memory_order_acq_rel);
         LOG_FMT_DEBUG(log, "{} {}", simpleInfo(), compaction_task->info());
     }
     wbs.writeRemoves();
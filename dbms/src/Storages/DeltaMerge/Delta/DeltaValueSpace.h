@@ -91,7 +91,13 @@ private:
     std::atomic<size_t> last_try_split_bytes = 0;
     std::atomic<size_t> last_try_place_delta_index_rows = 0;
 
+    /// Increased when the column files or the delta index are changed, e.g. by writes, flushes and compactions.
+    /// The snapshots created under the same version are the same, see `Segment::createSnapshot`.
+    std::atomic<UInt64> version = 0;
+
     DeltaIndexPtr delta_index;
+    /// The placed status of the delta index which is persisted along with the metadata last time.
+    std::pair<size_t, size_t> persisted_delta_index_status{0, 0};
 
     // Protects the operations in this instance.
     mutable std::mutex mutex;
@@ -159,6 +165,7 @@ public:
 
     size_t getUnsavedRows() const { return mem_table_set->getRows(); }
     size_t getUnsavedBytes() const { return mem_table_set->getBytes(); }
+    size_t getUnsavedMemoryBytes() const { return mem_table_set->getMemoryBytes(); }
 
     size_t getTotalCacheRows() const;
     size_t getTotalCacheBytes() const;
@@ -166,6 +173,8 @@ public:
 
     bool isFlushing() const { return is_flushing; }
 
+    UInt64 getVersion() const { return version.load(std::memory_order_acquire); }
+
     bool isUpdating() const { return is_updating; }
 
     bool tryLockUpdating()
@@ -246,6 +255,11 @@ public:
     /// a.k.a. minor compaction.
     bool compact(DMContext & context);
 
+    /// Persist the delta index along with the metadata of column files, so that we don't need to place
+    /// the delta again after reboot. Only the delta index placed on exactly the persisted column files is persisted.
+    /// Returns true if the delta index is persisted.
+    bool persistDeltaIndex(DMContext & context);
+
     /// Create a constant snapshot for read.
     /// Returns empty if this instance is abandoned, you should try again.
     /// for_update: true means this snapshot is created for Segment split/merge, delta merge, or flush.
@@ -368,6 +382,10 @@ public:
     // This method will check whether offset and limit are valid. It only return those valid rows.
     size_t readRows(MutableColumns & output_cols, size_t offset, size_t limit, const RowKeyRange * range);
 
+    // Like `readRows`, but add the rows into `gatherer`. DeltaMergeBlockInputStream collects the rows of the consecutive
+    // delta entries and copies them column by column.
+    size_t gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t offset, size_t limit, const RowKeyRange * range);
+
     // Get blocks or delete_ranges of `ExtraHandleColumn` and `VersionColumn`.
     // If there are continuous blocks, they will be squashed into one block.
     // We use the result to update DeltaTree.
@@ -66,6 +66,7 @@ void MemTableSet::appendColumnFileInner(const ColumnFilePtr & column_file)
 
     rows += column_file->getRows();
     bytes += column_file->getBytes();
+    memory_bytes += column_file->getMemoryBytes();
     deletes += column_file->getDeletes();
 }
 
@@ -135,7 +136,15 @@ void MemTableSet::appendToCache(DMContext & context, const Block & block, size_t
     {
         auto & last_column_file = column_files.back();
         if (last_column_file->isAppendable())
+        {
             success = last_column_file->append(context, block, offset, limit, append_bytes);
+            // The last column file is sealed, compress it to cache more data in memory before flushing.
+            if (!success && context.delta_cache_compress)
+            {
+                if (auto * m_file = last_column_file->tryToInMemoryFile(); m_file)
+                    memory_bytes -= m_file->compress(context);
+            }
+        }
     }
 
     if (!success)
@@ -152,6 +161,7 @@ void MemTableSet::appendToCache(DMContext & context, const Block & block, size_t
     }
     rows += limit;
     bytes += append_bytes;
+    memory_bytes += append_bytes;
 }
 
 void MemTableSet::appendDeleteRange(const RowKeyRange & delete_range)
@@ -267,12 +277,14 @@ void MemTableSet::removeColumnFilesInFlushTask(const ColumnFileFlushTask & flush
     ColumnFiles new_column_files;
     size_t new_rows = 0;
     size_t new_bytes = 0;
+    size_t new_memory_bytes = 0;
     size_t new_deletes = 0;
     while (column_file_iter != column_files.end())
     {
         new_column_files.emplace_back(*column_file_iter);
         new_rows += (*column_file_iter)->getRows();
         new_bytes += (*column_file_iter)->getBytes();
+        new_memory_bytes += (*column_file_iter)->getMemoryBytes();
         new_deletes += (*column_file_iter)->getDeletes();
         column_file_iter++;
     }
@@ -280,6 +292,7 @@ void MemTableSet::removeColumnFilesInFlushTask(const ColumnFileFlushTask & flush
     column_files_count = column_files.size();
     rows = new_rows;
     bytes = new_bytes;
+    memory_bytes = new_memory_bytes;
     deletes = new_deletes;
 
     ProfileEvents::increment(ProfileEvents::DMWriteBytes, flush_bytes);
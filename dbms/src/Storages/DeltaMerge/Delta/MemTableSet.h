@@ -44,6 +44,8 @@ private:
 
     std::atomic<size_t> rows = 0;
     std::atomic<size_t> bytes = 0;
+    // The bytes actually taken in memory, less than `bytes` if some column files are compressed.
+    std::atomic<size_t> memory_bytes = 0;
     std::atomic<size_t> deletes = 0;
 
     Poco::Logger * log;
@@ -62,6 +64,7 @@ public:
         {
             rows += file->getRows();
             bytes += file->getBytes();
+            memory_bytes += file->getMemoryBytes();
             deletes += file->getDeletes();
         }
     }
@@ -79,6 +82,7 @@ public:
     size_t getColumnFileCount() const { return column_files_count.load(); }
     size_t getRows() const { return rows.load(); }
     size_t getBytes() const { return bytes.load(); }
+    size_t getMemoryBytes() const { return memory_bytes.load(); }
     size_t getDeletes() const { return deletes.load(); }
     /// Thread safe part end
 
@@ -34,6 +34,17 @@ DeltaSnapshotPtr DeltaValueSpace::createSnapshot(const DMContext & context, bool
     if (abandoned.load(std::memory_order_relaxed))
         return {};
 
+    // Restore the delta index persisted before reboot lazily, on the first snapshot of this instance.
+    if (auto restored_index = persisted_file_set->tryRestoreDeltaIndex(context); restored_index)
+    {
+        if (delta_index->getPlacedStatus() == std::make_pair<size_t, size_t>(0, 0))
+        {
+            auto placed_status = restored_index->getPlacedStatus();
+            delta_index->update(restored_index->getDeltaTree(), placed_status.first, placed_status.second);
+            persisted_delta_index_status = placed_status;
+        }
+    }
+
     auto snap = std::make_shared<DeltaValueSnapshot>(type);
     snap->is_update = for_update;
     snap->_delta = this->shared_from_this();
@@ -122,6 +133,27 @@ size_t DeltaValueReader::readRows(MutableColumns & output_cols, size_t offset, s
     return actual_read;
 }
 
+size_t DeltaValueReader::gatherRows(ColumnSlicesGatherer & gatherer, const MutableColumns & output_cols, size_t offset, size_t limit, const RowKeyRange * range)
+{
+    // Filter out the out-of-range rows, see `readRows`.
+    auto mem_table_rows_offset = delta_snap->getMemTableSetRowsOffset();
+    auto total_delta_rows = delta_snap->getRows();
+
+    auto persisted_files_start = std::min(offset, mem_table_rows_offset);
+    auto persisted_files_end = std::min(offset + limit, mem_table_rows_offset);
+    auto mem_table_start = offset <= mem_table_rows_offset ? 0 : std::min(offset - mem_table_rows_offset, total_delta_rows - mem_table_rows_offset);
+    auto mem_table_end = offset + limit <= mem_table_rows_offset ? 0 : std::min(offset + limit - mem_table_rows_offset, total_delta_rows - mem_table_rows_offset);
+
+    size_t actual_read = 0;
+    if (persisted_files_start < persisted_files_end)
+        actual_read += persisted_files_reader->gatherRows(gatherer, output_cols, persisted_files_start, persisted_files_end - persisted_files_start, range);
+
+    if ((mem_table_start < mem_table_end) && mem_table_reader)
+        actual_read += mem_table_reader->gatherRows(gatherer, output_cols, mem_table_start, mem_table_end - mem_table_start, range);
+
+    return actual_read;
+}
+
 BlockOrDeletes DeltaValueReader::getPlaceItems(size_t rows_begin, size_t deletes_begin, size_t rows_end, size_t deletes_end)
 {
     /// Note that we merge the consecutive ColumnFileInMemory or ColumnFileTiny together, which are seperated in groups by ColumnFileDeleteRange and ColumnFileBig.
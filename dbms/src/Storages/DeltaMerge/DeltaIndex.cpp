@@ -0,0 +1,103 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <IO/ReadHelpers.h>
+#include <IO/WriteHelpers.h>
+#include <Storages/DeltaMerge/DeltaIndex.h>
+#include <fmt/format.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int CORRUPTED_DATA;
+} // namespace ErrorCodes
+
+namespace DM
+{
+static constexpr UInt64 DELTA_INDEX_FORMAT_V1 = 1;
+
+void DeltaIndex::serialize(WriteBuffer & buf)
+{
+    DeltaTreePtr delta_tree_copy;
+    size_t placed_rows_copy = 0;
+    size_t placed_deletes_copy = 0;
+    {
+        // The delta tree of a DeltaIndex is never modified in place, so it is safe to iterate it without holding the lock.
+        std::scoped_lock lock(mutex);
+        delta_tree_copy = delta_tree;
+        placed_rows_copy = placed_rows;
+        placed_deletes_copy = placed_deletes;
+    }
+
+    writeIntBinary(DELTA_INDEX_FORMAT_V1, buf);
+    writeIntBinary(static_cast<UInt64>(placed_rows_copy), buf);
+    writeIntBinary(static_cast<UInt64>(placed_deletes_copy), buf);
+    writeIntBinary(static_cast<UInt64>(delta_tree_copy->numEntries()), buf);
+    for (auto it = delta_tree_copy->begin(), end = delta_tree_copy->end(); it != end; ++it)
+    {
+        writeIntBinary(static_cast<UInt8>(it.isInsert()), buf);
+        writeIntBinary(it.getRid(), buf);
+        writeIntBinary(static_cast<UInt32>(it.getCount()), buf);
+        writeIntBinary(it.getValue(), buf);
+    }
+}
+
+DeltaIndexPtr DeltaIndex::deserialize(ReadBuffer & buf)
+{
+    UInt64 version;
+    readIntBinary(version, buf);
+    if (unlikely(version != DELTA_INDEX_FORMAT_V1))
+        throw Exception("Unexpected delta index format version: " + DB::toString(version), ErrorCodes::CORRUPTED_DATA);
+
+    UInt64 placed_rows;
+    UInt64 placed_deletes;
+    UInt64 num_entries;
+    readIntBinary(placed_rows, buf);
+    readIntBinary(placed_deletes, buf);
+    readIntBinary(num_entries, buf);
+
+    // Replaying the entries in the order of iteration builds an equivalent delta tree, because the rid of
+    // each entry is exactly the position it was placed at, given all the entries before it are placed.
+    auto delta_tree = std::make_shared<DefaultDeltaTree>();
+    for (UInt64 i = 0; i < num_entries; ++i)
+    {
+        UInt8 is_insert;
+        UInt64 rid;
+        UInt32 count;
+        UInt64 value;
+        readIntBinary(is_insert, buf);
+        readIntBinary(rid, buf);
+        readIntBinary(count, buf);
+        readIntBinary(value, buf);
+        if (is_insert)
+        {
+            delta_tree->addInsert(rid, value);
+        }
+        else
+        {
+            for (UInt32 c = 0; c < count; ++c)
+                delta_tree->addDelete(rid);
+        }
+    }
+
+    if (unlikely(delta_tree->numEntries() != num_entries))
+        throw Exception(fmt::format("Delta index entries check failed, expected: {}, actual: {}", num_entries, delta_tree->numEntries()),
+                        ErrorCodes::CORRUPTED_DATA);
+
+    return std::make_shared<DeltaIndex>(delta_tree, placed_rows, placed_deletes);
+}
+
+} // namespace DM
+} // namespace DB
@@ -20,6 +20,9 @@
 
 namespace DB
 {
+class ReadBuffer;
+class WriteBuffer;
+
 namespace DM
 {
 class DeltaIndex;
@@ -34,10 +37,17 @@ private:
     const UInt64 id;
 
     DeltaTreePtr delta_tree;
+    // Whether `delta_tree` may be referenced by other delta indexes. A shared delta tree is immutable, it is
+    // copied before placing anything into it, see `getMutableDeltaTree`. So that cloning an index is cheap,
+    // and the reads which do not need to place anything never copy the delta tree.
+    bool is_tree_shared = false;
 
     size_t placed_rows;
     size_t placed_deletes;
 
+    // Set when the index is freed by DeltaIndexManager, so that placing it again is counted as a rebuild.
+    std::atomic_bool evicted{false};
+
     mutable std::mutex mutex;
 
 public:
@@ -60,6 +70,15 @@ public:
     using Updates = std::vector<Update>;
 
 private:
+    void ensureTreeExclusive()
+    {
+        if (is_tree_shared)
+        {
+            delta_tree = std::make_shared<DefaultDeltaTree>(*delta_tree);
+            is_tree_shared = false;
+        }
+    }
+
     void applyUpdates(const Updates & updates)
     {
         for (auto & update : updates)
@@ -72,6 +91,7 @@ private:
             else if (placed_rows < update.rows_offset + update.idx_mapping.size())
             {
                 // Current index contains part of inserts which go shuffled, they should be removed.
+                ensureTreeExclusive();
                 delta_tree->removeInsertsStartFrom(update.rows_offset);
                 placed_rows = update.rows_offset;
                 break;
@@ -79,6 +99,7 @@ private:
             else
             {
                 // Current index contains all inserts which go shuffled, let's update them directly.
+                ensureTreeExclusive();
                 delta_tree->updateTupleId(update.idx_mapping, update.rows_offset);
             }
         }
@@ -104,8 +125,9 @@ private:
 
         if (delta_tree_copy)
         {
-            auto new_delta_tree = std::make_shared<DefaultDeltaTree>(*delta_tree_copy);
-            auto new_index = std::make_shared<DeltaIndex>(new_delta_tree, placed_rows_copy, placed_deletes_copy);
+            // Share the delta tree, it is copied only when the new index places or updates something.
+            auto new_index = std::make_shared<DeltaIndex>(delta_tree_copy, placed_rows_copy, placed_deletes_copy);
+            new_index->is_tree_shared = true;
             // try to do some updates before return it if need
             if (updates)
                 new_index->applyUpdates(*updates);
@@ -139,6 +161,7 @@ public:
     {
         std::scoped_lock lock(mutex, other.mutex);
         delta_tree.swap(other.delta_tree);
+        std::swap(is_tree_shared, other.is_tree_shared);
         std::swap(placed_rows, other.placed_rows);
         std::swap(placed_deletes, other.placed_deletes);
     }
@@ -153,6 +176,10 @@ public:
 
     UInt64 getId() const { return id; }
 
+    void markEvicted() { evicted.store(true, std::memory_order_relaxed); }
+    /// Returns whether the index was evicted, and clear the mark.
+    bool resetEvicted() { return evicted.exchange(false, std::memory_order_relaxed); }
+
     size_t getBytes() const
     {
         std::scoped_lock lock(mutex);
@@ -165,16 +192,26 @@ public:
         return {placed_rows, placed_deletes};
     }
 
+    /// The returned delta tree should not be modified, use `getMutableDeltaTree` instead.
     DeltaTreePtr getDeltaTree()
     {
         std::scoped_lock lock(mutex);
         return delta_tree;
     }
 
+    /// Get the delta tree exclusively owned by this index, copy it if it is shared with other indexes.
+    DeltaTreePtr getMutableDeltaTree()
+    {
+        std::scoped_lock lock(mutex);
+        ensureTreeExclusive();
+        return delta_tree;
+    }
+
     void update(const DeltaTreePtr & delta_tree_, size_t placed_rows_, size_t placed_deletes_)
     {
         std::scoped_lock lock(mutex);
         delta_tree = delta_tree_;
+        is_tree_shared = true;
         placed_rows = placed_rows_;
         placed_deletes = placed_deletes_;
     }
@@ -187,6 +224,7 @@ public:
             && !(maybe_advanced.placed_rows == placed_rows && maybe_advanced.placed_deletes == placed_deletes))
         {
             delta_tree = maybe_advanced.delta_tree;
+            is_tree_shared = true;
             placed_rows = maybe_advanced.placed_rows;
             placed_deletes = maybe_advanced.placed_deletes;
             return true;
@@ -196,6 +234,13 @@ public:
 
     DeltaIndexPtr tryClone(size_t /*rows*/, size_t deletes) { return tryCloneInner(deletes); }
 
+    /// Serialize the placed status and the entries of the delta tree, so that the delta tree
+    /// can be rebuilt without placing the delta again after reboot.
+    void serialize(WriteBuffer & buf);
+
+    /// Rebuild a delta index by replaying the entries written by `serialize`.
+    static DeltaIndexPtr deserialize(ReadBuffer & buf);
+
     DeltaIndexPtr cloneWithUpdates(const Updates & updates)
     {
         if (unlikely(updates.empty()))
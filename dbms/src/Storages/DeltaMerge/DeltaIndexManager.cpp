@@ -15,21 +15,44 @@
 #include <Storages/DeltaMerge/DeltaIndexManager.h>
 #include <Storages/DeltaMerge/Segment.h>
 
+#include <algorithm>
+
 namespace CurrentMetrics
 {
 extern const Metric DT_DeltaIndexCacheSize;
 } // namespace CurrentMetrics
 
+namespace ProfileEvents
+{
+extern const Event DMDeltaIndexEvict;
+extern const Event DMDeltaIndexEvictBytes;
+extern const Event DMDeltaIndexRebuild;
+} // namespace ProfileEvents
+
 namespace DB
 {
 namespace DM
 {
-void DeltaIndexManager::removeOverflow(std::vector<DeltaIndexPtr> & removed)
+namespace
+{
+// Placing a delete range searches the stable and the delta tree for the rows it covers, it costs much more than
+// placing a row.
+constexpr double DELETE_RANGE_COST_ROWS = 1024;
+} // namespace
+
+double DeltaIndexManager::getCostPerByte(size_t placed_rows, size_t placed_deletes, size_t bytes)
+{
+    double cost = 1 + placed_rows + placed_deletes * DELETE_RANGE_COST_ROWS;
+    return cost / std::max<size_t>(bytes, 1);
+}
+
+void DeltaIndexManager::removeOverflow(std::vector<DeltaIndexPtr> & removed, size_t limit_size)
 {
     size_t queue_size = index_map.size();
-    while ((current_size > max_size) && (queue_size > 1))
+    while ((current_size > limit_size) && (queue_size > 1))
     {
-        const auto & id = lru_queue.front();
+        auto queue_it = evict_queue.begin();
+        const auto id = queue_it->second;
 
         auto it = index_map.find(id);
         if (it == index_map.end())
@@ -39,16 +62,21 @@ void DeltaIndexManager::removeOverflow(std::vector<DeltaIndexPtr> & removed)
         if (auto p = holder.index.lock(); p)
         {
             LOG_FMT_TRACE(log, "Free DeltaIndex, [size {}]", p->getBytes());
+            ProfileEvents::increment(ProfileEvents::DMDeltaIndexEvict);
+            ProfileEvents::increment(ProfileEvents::DMDeltaIndexEvictBytes, holder.size);
 
             // We put the evicted index into removed list, and free them later.
             auto tmp = std::make_shared<DeltaIndex>();
             p->swap(*tmp);
+            p->markEvicted();
             removed.push_back(tmp);
         }
 
+        // The remaining indexes age by the priority of the freed one.
+        inflation = queue_it->first.first;
         current_size -= holder.size;
         --queue_size;
-        lru_queue.pop_front();
+        evict_queue.erase(queue_it);
         // Remove it later
         index_map.erase(it);
     }
@@ -79,21 +107,43 @@ void DeltaIndexManager::refreshRef(const DeltaIndexPtr & index)
 
         if (inserted)
         {
-            holder.queue_it = lru_queue.insert(lru_queue.end(), id);
+            if (index->resetEvicted())
+                ProfileEvents::increment(ProfileEvents::DMDeltaIndexRebuild);
         }
         else
         {
             current_size -= holder.size;
-            lru_queue.splice(lru_queue.end(), lru_queue, holder.queue_it);
+            evict_queue.erase(holder.queue_it);
         }
 
         holder.index = index;
         holder.size = index->getBytes();
         current_size += holder.size;
 
-        removeOverflow(removed);
+        auto [placed_rows, placed_deletes] = index->getPlacedStatus();
+        double priority = inflation + getCostPerByte(placed_rows, placed_deletes, holder.size);
+        holder.queue_it = evict_queue.emplace(std::make_pair(priority, ++refresh_sequence), id).first;
+
+        removeOverflow(removed, max_size);
+        CurrentMetrics::set(CurrentMetrics::DT_DeltaIndexCacheSize, current_size);
+    }
+}
+
+size_t DeltaIndexManager::evict(size_t bytes_to_free)
+{
+    if (max_size == 0)
+        return 0;
+
+    std::vector<DeltaIndexPtr> removed;
+    size_t freed = 0;
+    {
+        std::lock_guard lock(mutex);
+        auto size_before = current_size;
+        removeOverflow(removed, current_size > bytes_to_free ? current_size - bytes_to_free : 0);
+        freed = size_before - current_size;
         CurrentMetrics::set(CurrentMetrics::DT_DeltaIndexCacheSize, current_size);
     }
+    return freed;
 }
 
 void DeltaIndexManager::deleteRef(const DeltaIndexPtr & index)
@@ -120,7 +170,7 @@ void DeltaIndexManager::deleteRef(const DeltaIndexPtr & index)
         }
 
         current_size -= holder.size;
-        lru_queue.erase(holder.queue_it);
+        evict_queue.erase(holder.queue_it);
         // Remove it later
         index_map.erase(it);
         CurrentMetrics::set(CurrentMetrics::DT_DeltaIndexCacheSize, current_size);
@@ -17,12 +17,17 @@
 #include <Storages/DeltaMerge/DeltaIndex.h>
 #include <common/logger_useful.h>
 
+#include <map>
+
 namespace DB
 {
 namespace DM
 {
 /// This class mange the life time of DeltaIndies in memory.
-/// It will free the most rarely used DeltaIndex when the total memory usage exceeds the threshold.
+/// It will free the DeltaIndex with the lowest priority when the total memory usage exceeds the threshold.
+/// The priority is in the GreedyDual-Size style: the cost to rebuild the index (its placed rows and deletes) per
+/// byte, plus an inflation value which rises to the priority of each freed index. So a small index that is costly
+/// to rebuild is kept longer than a large cheap one, while the indexes not used for a long time still age out.
 class DeltaIndexManager
 {
 private:
@@ -31,8 +36,9 @@ private:
 
     struct Holder;
     using IndexMap = std::unordered_map<UInt64, Holder>;
-    using LRUQueue = std::list<UInt64>;
-    using LRUQueueItr = typename LRUQueue::iterator;
+    // (priority, sequence of refresh) -> index id, the sequence breaks the ties in LRU order.
+    using EvictQueue = std::map<std::pair<double, UInt64>, UInt64>;
+    using EvictQueueItr = typename EvictQueue::iterator;
 
     using WeakIndexPtr = std::weak_ptr<DeltaIndex>;
 
@@ -40,12 +46,15 @@ private:
     {
         WeakIndexPtr index;
         size_t size;
-        LRUQueueItr queue_it;
+        EvictQueueItr queue_it;
     };
 
 private:
     IndexMap index_map;
-    LRUQueue lru_queue;
+    EvictQueue evict_queue;
+
+    double inflation = 0;
+    UInt64 refresh_sequence = 0;
 
     size_t current_size = 0;
     const size_t max_size;
@@ -55,7 +64,11 @@ private:
     std::mutex mutex;
 
 private:
-    void removeOverflow(std::vector<DeltaIndexPtr> & removed);
+    void removeOverflow(std::vector<DeltaIndexPtr> & removed, size_t limit_size);
+
+public:
+    /// The priority of keeping an index of `bytes` with the placed rows and deletes, without the inflation.
+    static double getCostPerByte(size_t placed_rows, size_t placed_deletes, size_t bytes);
 
 public:
     explicit DeltaIndexManager(size_t max_size_)
@@ -68,6 +81,10 @@ public:
 
     bool isLimit() { return max_size != 0; }
 
+    /// Free the DeltaIndexes with the lowest priority until about `bytes_to_free` bytes are freed, return the bytes freed.
+    /// Used to reclaim memory under memory pressure, see `MemoryArbiter`.
+    size_t evict(size_t bytes_to_free);
+
     /// Put the reference of DeltaIndex into this manager.
     void refreshRef(const DeltaIndexPtr & index);
 
@@ -20,8 +20,10 @@
 #include <IO/ReadHelpers.h>
 #include <IO/WriteBufferFromFile.h>
 #include <IO/WriteHelpers.h>
+#include <Storages/DeltaMerge/ColumnFile/ColumnSlicesGatherer.h>
 #include <Storages/DeltaMerge/DeltaMergeDefines.h>
 #include <Storages/DeltaMerge/DeltaTree.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
 #include <Storages/DeltaMerge/RowKeyFilter.h>
 #include <Storages/DeltaMerge/SkippableBlockInputStream.h>
 
@@ -74,6 +76,12 @@ private:
     size_t use_delta_offset = 0;
     size_t use_delta_rows = 0;
 
+    // The delta rows of the consecutive insert entries are collected into `delta_gatherer`, and copied column by
+    // column before writing any stable rows or returning the block. `gathering_delta_rows` is the number of rows
+    // asked for, some of them may be filtered out by the range.
+    ColumnSlicesGatherer delta_gatherer;
+    size_t gathering_delta_rows = 0;
+
     Columns cur_stable_block_columns;
     size_t cur_stable_block_rows = 0;
     size_t cur_stable_block_pos = 0;
@@ -157,6 +165,7 @@ public:
 
     Block read() override
     {
+        ReadStageTimer timer(ReadStage::DeltaMerge);
         if constexpr (skippable_place)
         {
             if (sk_call_status == 0)
@@ -241,7 +250,11 @@ private:
                     else
                         next<false, false>(columns, limit);
                 }
+                // Some rows could be filtered out while gathering, then we can write more rows.
+                if (!limit)
+                    gatherDeltaRows(columns, limit);
             }
+            gatherDeltaRows(columns, limit);
 
             // Empty means we are out of data.
             if (limit == max_block_size)
@@ -262,6 +275,8 @@ private:
         {
             if (use_stable_rows)
             {
+                // Keep the order of the delta rows before the stable rows.
+                gatherDeltaRows(output_columns, output_write_limit);
                 writeFromStable<c_delta_done>(output_columns, output_write_limit);
                 return;
             }
@@ -482,6 +497,22 @@ private:
     {
         auto write_rows = std::min(output_write_limit, use_delta_rows);
 
+        // Note that the rows between [use_delta_offset, use_delta_offset + write_rows) are guaranteed sorted,
+        // otherwise we won't read them in the same range.
+        // The rows are copied into output columns later by `gatherDeltaRows`, assume all of them are written for now.
+        delta_value_reader->gatherRows(delta_gatherer, output_columns, use_delta_offset, write_rows, &rowkey_range);
+        gathering_delta_rows += write_rows;
+
+        output_write_limit -= write_rows;
+        use_delta_offset += write_rows;
+        use_delta_rows -= write_rows;
+    }
+
+    inline void gatherDeltaRows(MutableColumns & output_columns, size_t & output_write_limit)
+    {
+        if (!gathering_delta_rows)
+            return;
+
         // Prevent frequently reallocation.
         if (output_columns[0]->empty())
         {
@@ -489,18 +520,15 @@ private:
                 output_columns[column_id]->reserve(max_block_size);
         }
 
-        // Note that the rows between [use_delta_offset, use_delta_offset + write_rows) are guaranteed sorted,
-        // otherwise we won't read them in the same range.
-        auto actual_write = delta_value_reader->readRows(output_columns, use_delta_offset, write_rows, &rowkey_range);
+        auto actual_write = delta_gatherer.gather(output_columns);
 
         if constexpr (skippable_place)
         {
-            sk_skip_total_rows += write_rows - actual_write;
+            sk_skip_total_rows += gathering_delta_rows - actual_write;
         }
 
-        output_write_limit -= actual_write;
-        use_delta_offset += write_rows;
-        use_delta_rows -= write_rows;
+        output_write_limit += gathering_delta_rows - actual_write;
+        gathering_delta_rows = 0;
     }
 
     inline void writeDeleteFromDelta(size_t n) { stable_ignore += n; }
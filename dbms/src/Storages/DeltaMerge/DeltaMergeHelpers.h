@@ -17,6 +17,7 @@
 #pragma once
 
 #include <Columns/ColumnVector.h>
+#include <Common/RadixSort.h>
 #include <Common/assert_cast.h>
 #include <Core/Block.h>
 #include <Core/SortDescription.h>
@@ -84,13 +85,90 @@ inline SortDescription getPkSort(const ColumnDefine & handle)
     return sort;
 }
 
+/// Returns the number of the sorted runs of the rows by (handle, version), 1 means sorted.
+inline size_t countSortedRunsByIntHandle(const PaddedPODArray<Int64> & handles, const PaddedPODArray<UInt64> & versions)
+{
+    size_t runs = 1;
+    for (size_t i = 1; i < handles.size(); ++i)
+    {
+        if (handles[i - 1] > handles[i] || (handles[i - 1] == handles[i] && versions[i - 1] > versions[i]))
+            ++runs;
+    }
+    return runs;
+}
+
+/// Get the stable permutation that sorts the rows by (handle, version) with LSD radix sort, sorting by the version
+/// first and then by the handle.
+inline void stableGetPermutationByIntHandle(const PaddedPODArray<Int64> & handles, const PaddedPODArray<UInt64> & versions, IColumn::Permutation & perm)
+{
+    struct RadixElement
+    {
+        UInt64 key;
+        UInt32 row;
+    };
+    struct Traits
+    {
+        using Element = RadixElement;
+        using Key = UInt64;
+        using CountType = UInt32;
+        using KeyBits = UInt64;
+        static constexpr size_t PART_SIZE_BITS = 8;
+        using Transform = RadixSortIdentityTransform<KeyBits>;
+        using Allocator = RadixSortMallocAllocator;
+        static Key & extractKey(Element & elem) { return elem.key; }
+    };
+
+    const size_t rows = handles.size();
+    PODArray<RadixElement> elems(rows);
+    bool same_version = true;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        elems[i] = RadixElement{versions[i], static_cast<UInt32>(i)};
+        same_version &= versions[i] == versions[0];
+    }
+    if (!same_version)
+        RadixSort<Traits>::execute(elems.data(), rows);
+
+    // Flip the sign bit, so that the order of the unsigned keys is the same as the signed handles.
+    for (auto & elem : elems)
+        elem.key = static_cast<UInt64>(handles[elem.row]) ^ (1ULL << 63);
+    RadixSort<Traits>::execute(elems.data(), rows);
+
+    perm.resize(rows);
+    for (size_t i = 0; i < rows; ++i)
+        perm[i] = elems[i].row;
+}
+
+/// Sort the block by (handle, version) in ascending order. Returns false and keeps the block unchanged if it is
+/// already sorted, otherwise returns true with the permutation in `perm`.
 inline bool sortBlockByPk(const ColumnDefine & handle, Block & block, IColumn::Permutation & perm)
 {
+    // Radix sort is faster than merging the sorted runs only when the runs are many.
+    static constexpr size_t radix_sort_min_runs = 8;
+    static constexpr size_t radix_sort_min_rows = 256;
+
+    const auto * handle_col = checkAndGetColumn<ColumnVector<Int64>>(block.getByName(handle.name).column.get());
+    const auto * version_col = checkAndGetColumn<ColumnVector<UInt64>>(block.getByName(VERSION_COLUMN_NAME).column.get());
     SortDescription sort = getPkSort(handle);
-    if (isAlreadySorted(block, sort))
-        return false;
+    if (handle_col != nullptr && version_col != nullptr)
+    {
+        // Compare the int handles directly instead of comparing the columns row by row.
+        auto runs = countSortedRunsByIntHandle(handle_col->getData(), version_col->getData());
+        if (runs == 1)
+            return false;
+        if (runs > radix_sort_min_runs && block.rows() >= radix_sort_min_rows)
+            stableGetPermutationByIntHandle(handle_col->getData(), version_col->getData(), perm);
+        else
+            stableGetPermutationByMergingRuns(block, sort, perm);
+    }
+    else
+    {
+        if (isAlreadySorted(block, sort))
+            return false;
 
-    stableGetPermutation(block, sort, perm);
+        // The delta is appended by many small blocks that are usually sorted, so merge them instead of sorting.
+        stableGetPermutationByMergingRuns(block, sort, perm);
+    }
 
     for (size_t i = 0; i < block.columns(); ++i)
     {
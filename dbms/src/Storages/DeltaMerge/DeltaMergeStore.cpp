@@ -17,6 +17,7 @@
 #include <Common/Logger.h>
 #include <Common/TiFlashMetrics.h>
 #include <Common/assert_cast.h>
+#include <Common/setThreadName.h>
 #include <Core/SortDescription.h>
 #include <Functions/FunctionsConversion.h>
 #include <Interpreters/sortBlock.h>
@@ -24,7 +25,10 @@
 #include <Storages/DeltaMerge/DMSegmentThreadInputStream.h>
 #include <Storages/DeltaMerge/DeltaMergeHelpers.h>
 #include <Storages/DeltaMerge/DeltaMergeStore.h>
+#include <DataTypes/DataTypeNullable.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
+#include <Storages/DeltaMerge/File/DMFilePackFilter.h>
+#include <Storages/DeltaMerge/Filter/PushDownTopN.h>
 #include <Storages/DeltaMerge/Filter/RSOperator.h>
 #include <Storages/DeltaMerge/ReadThread/SegmentReadTaskScheduler.h>
 #include <Storages/DeltaMerge/ReadThread/UnorderedInputStream.h>
@@ -36,10 +40,14 @@
 #include <Storages/Page/V2/VersionSet/PageEntriesVersionSetWithDelta.h>
 #include <Storages/PathPool.h>
 #include <Storages/Transaction/TMTContext.h>
+#include <common/ThreadPool.h>
 #include <common/logger_useful.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <ext/scope_guard.h>
+#include <unordered_set>
 
 namespace ProfileEvents
 {
@@ -105,8 +113,76 @@ static std::atomic<UInt64> DELTA_MERGE_STORE_HASH_SALT{0};
 //   MergeDeltaTaskPool
 // ================================================
 
-std::pair<bool, bool> DeltaMergeStore::MergeDeltaTaskPool::tryAddTask(const BackgroundTask & task, const ThreadType & whom, const size_t max_task_num, const LoggerPtr & log_)
+namespace GC
+{
+double estimateStableGarbageRatio(const SegmentPtr & seg, DB::Timestamp gc_safepoint, double ratio_threshold, const LoggerPtr & log);
+} // namespace GC
+
+namespace
+{
+// A MergeDelta task of a segment that is all delta jumps ahead of the heavy tasks added up to this time earlier.
+constexpr double HEAVY_TASK_PRIORITY_BOOST_SECONDS = 60.0;
+
+void observeTaskWaitTime(const DeltaMergeStore::BackgroundTask & task)
+{
+    double wait_seconds = (clock_gettime_ns() - task.added_time_ns) / 1e9;
+    switch (task.type)
+    {
+    case DeltaMergeStore::TaskType::Split:
+        GET_METRIC(tiflash_storage_background_task_wait_seconds, type_seg_split).Observe(wait_seconds);
+        break;
+    case DeltaMergeStore::TaskType::Merge:
+        GET_METRIC(tiflash_storage_background_task_wait_seconds, type_seg_merge).Observe(wait_seconds);
+        break;
+    case DeltaMergeStore::TaskType::MergeDelta:
+        GET_METRIC(tiflash_storage_background_task_wait_seconds, type_delta_merge).Observe(wait_seconds);
+        break;
+    case DeltaMergeStore::TaskType::Compact:
+        GET_METRIC(tiflash_storage_background_task_wait_seconds, type_delta_compact).Observe(wait_seconds);
+        break;
+    case DeltaMergeStore::TaskType::Flush:
+        GET_METRIC(tiflash_storage_background_task_wait_seconds, type_delta_flush).Observe(wait_seconds);
+        break;
+    case DeltaMergeStore::TaskType::PlaceIndex:
+        GET_METRIC(tiflash_storage_background_task_wait_seconds, type_place_index_update).Observe(wait_seconds);
+        break;
+    }
+}
+} // namespace
+
+double DeltaMergeStore::MergeDeltaTaskPool::getHeavyTaskPriority(const BackgroundTask & task, UInt64 now_ns)
 {
+    if (task.urgent)
+        return std::numeric_limits<double>::max();
+    double boost = 1.0;
+    if (task.type == TaskType::MergeDelta)
+    {
+        size_t total_bytes = task.segment->getEstimatedBytes();
+        boost = total_bytes == 0 ? 0.0 : static_cast<double>(task.segment->getDelta()->getBytes()) / total_bytes;
+        // Frequently read segments are boosted by the same measure that triggers merge delta by reads.
+        const auto & dm_context = *task.dm_context;
+        if (dm_context.delta_read_merge_factor > 0 && dm_context.delta_limit_rows > 0)
+        {
+            double read_score = static_cast<double>(task.segment->getReadTimes()) * task.segment->getDelta()->getRows()
+                / (dm_context.delta_read_merge_factor * dm_context.delta_limit_rows);
+            boost = std::max(boost, std::min(read_score, 1.0));
+        }
+        boost = std::max(boost, task.garbage_ratio);
+    }
+    else if (task.type == TaskType::Merge)
+    {
+        // Every segment saved by the merge is a snapshot, a task and a stream less for each query on the range.
+        boost = std::log2(task.next_segments.size() + 1);
+    }
+    double wait_seconds = now_ns > task.added_time_ns ? (now_ns - task.added_time_ns) / 1e9 : 0.0;
+    return boost * HEAVY_TASK_PRIORITY_BOOST_SECONDS + wait_seconds;
+}
+
+std::pair<bool, bool> DeltaMergeStore::MergeDeltaTaskPool::tryAddTask(const BackgroundTask & task_, const ThreadType & whom, const size_t max_task_num, const LoggerPtr & log_)
+{
+    auto task = task_;
+    task.added_time_ns = clock_gettime_ns();
+
     std::scoped_lock lock(mutex);
     if (light_tasks.size() + heavy_tasks.size() >= max_task_num)
         return std::make_pair(false, false);
@@ -121,7 +197,7 @@ std::pair<bool, bool> DeltaMergeStore::MergeDeltaTaskPool::tryAddTask(const Back
         // reserve some task space for light tasks
         if (max_task_num > 1 && heavy_tasks.size() >= static_cast<size_t>(max_task_num * 0.9))
             return std::make_pair(false, is_heavy);
-        heavy_tasks.push(task);
+        heavy_tasks.push_back(task);
         break;
     case TaskType::Compact:
     case TaskType::Flush:
@@ -149,11 +225,35 @@ DeltaMergeStore::BackgroundTask DeltaMergeStore::MergeDeltaTaskPool::nextTask(bo
 {
     std::scoped_lock lock(mutex);
 
-    auto & tasks = is_heavy ? heavy_tasks : light_tasks;
-    if (tasks.empty())
-        return {};
-    auto task = tasks.front();
-    tasks.pop();
+    BackgroundTask task;
+    if (is_heavy)
+    {
+        if (heavy_tasks.empty())
+            return {};
+        // There are at most about twice as many tasks as segments, so a linear scan is fine.
+        auto now_ns = clock_gettime_ns();
+        auto best = heavy_tasks.begin();
+        double best_priority = getHeavyTaskPriority(*best, now_ns);
+        for (auto iter = std::next(heavy_tasks.begin()); iter != heavy_tasks.end(); ++iter)
+        {
+            double priority = getHeavyTaskPriority(*iter, now_ns);
+            if (priority > best_priority)
+            {
+                best = iter;
+                best_priority = priority;
+            }
+        }
+        task = *best;
+        heavy_tasks.erase(best);
+    }
+    else
+    {
+        if (light_tasks.empty())
+            return {};
+        task = light_tasks.front();
+        light_tasks.pop();
+    }
+    observeTaskWaitTime(task);
 
     LOG_FMT_DEBUG(log_, "Segment [{}] task [{}] pop from background task pool", task.segment->segmentId(), toString(task.type));
 
@@ -582,14 +682,11 @@ void DeltaMergeStore::write(const Context & db_context, const DB::Settings & db_
 
     const auto bytes = block.bytes();
 
+    if (rows > 1)
     {
         // Sort the block by handle & version in ascending order.
-        SortDescription sort;
-        sort.emplace_back(EXTRA_HANDLE_COLUMN_NAME, 1, 0);
-        sort.emplace_back(VERSION_COLUMN_NAME, 1, 0);
-
-        if (rows > 1 && !isAlreadySorted(block, sort))
-            stableSortBlock(block, sort);
+        IColumn::Permutation perm;
+        sortBlockByPk(getExtraHandleColumnDefine(is_common_handle), block, perm);
     }
 
     Segments updated_segments;
@@ -771,7 +868,6 @@ void DeltaMergeStore::ingestFiles(
         clear_data_in_range);
 
     Segments updated_segments;
-    RowKeyRange cur_range = range;
 
     // Put the ingest file ids into `storage_pool` and use ref id in each segments to ensure the atomic
     // of ingesting.
@@ -789,78 +885,165 @@ void DeltaMergeStore::ingestFiles(
         ingest_wbs.setRollback(); // rollback if exception thrown
     }
 
-    while (!cur_range.none())
-    {
-        RowKeyRange segment_range;
-
-        // Keep trying until succeeded.
-        while (true)
+    /// Generate the DMFile instances with new ref ids pointed to the file ids, and the column files
+    /// split on the boundary of `segment_range`. The ref pages are appended to `wb`.
+    auto prepare_column_files = [&](const RowKeyRange & segment_range, WriteBatch & wb) {
+        ColumnFiles column_files;
+        for (const auto & file : files)
         {
-            SegmentPtr segment;
-            {
-                std::shared_lock lock(read_write_mutex);
+            auto file_id = file->fileId();
+            const auto & file_parent_path = file->parentPath();
+            auto page_id = storage_pool->newDataPageIdForDTFile(delegate, __PRETTY_FUNCTION__);
 
-                auto segment_it = segments.upper_bound(cur_range.getStart());
-                if (segment_it == segments.end())
-                {
-                    throw Exception(
-                        fmt::format("Failed to locate segment begin with start in range: {}", cur_range.toDebugString()),
-                        ErrorCodes::LOGICAL_ERROR);
-                }
-                segment = segment_it->second;
+            auto ref_file = DMFile::restore(file_provider, file_id, page_id, file_parent_path, DMFile::ReadMetaMode::all());
+            auto column_file = std::make_shared<ColumnFileBig>(*dm_context, ref_file, segment_range);
+            if (column_file->getRows() != 0)
+            {
+                column_files.emplace_back(std::move(column_file));
+                wb.putRefPage(page_id, file->pageId());
             }
+        }
+        return column_files;
+    };
 
-            FAIL_POINT_PAUSE(FailPoints::pause_when_ingesting_to_dt_store);
-            waitForWrite(dm_context, segment);
-            if (segment->hasAbandoned())
-                continue;
-
-            segment_range = segment->getRowKeyRange();
-
-            // Write could fail, because other threads could already updated the instance. Like split/merge, merge delta.
+    /// Ingest into the segments located in one go first. Restoring the ref DMFiles and filtering
+    /// the packs by the segment ranges are done concurrently without any lock, and the ref pages
+    /// of all segments are committed by one write. Then each segment only need to lock its delta
+    /// shortly to append the column files.
+    /// The ranges of the segments which are updated by other threads (split/merge, merge delta)
+    /// in the meantime are ingested by the retry loop below.
+    RowKeyRanges retry_ranges;
+    {
+        struct IngestTask
+        {
+            SegmentPtr segment;
+            RowKeyRange segment_range;
             ColumnFiles column_files;
-            WriteBatches wbs(*storage_pool, dm_context->getWriteLimiter());
-
-            for (const auto & file : files)
+            WriteBatch wb;
+        };
+        std::vector<IngestTask> tasks;
+        {
+            std::shared_lock lock(read_write_mutex);
+            for (auto segment_it = segments.upper_bound(range.getStart()); segment_it != segments.end(); ++segment_it)
             {
-                /// Generate DMFile instance with a new ref_id pointed to the file_id.
-                auto file_id = file->fileId();
-                const auto & file_parent_path = file->parentPath();
-                auto page_id = storage_pool->newDataPageIdForDTFile(delegate, __PRETTY_FUNCTION__);
-
-                auto ref_file = DMFile::restore(file_provider, file_id, page_id, file_parent_path, DMFile::ReadMetaMode::all());
-                auto column_file = std::make_shared<ColumnFileBig>(*dm_context, ref_file, segment_range);
-                if (column_file->getRows() != 0)
-                {
-                    column_files.emplace_back(std::move(column_file));
-                    wbs.data.putRefPage(page_id, file->pageId());
-                }
+                const auto & segment = segment_it->second;
+                if (!(segment->getRowKeyRange().getStart() < range.getEnd()))
+                    break;
+                tasks.push_back(IngestTask{segment, segment->getRowKeyRange(), {}, WriteBatch(storage_pool->getNamespaceId())});
             }
+        }
 
-            // We have to commit those file_ids to PageStorage, because as soon as packs are written into segments,
-            // they are visible for readers who require file_ids to be found in PageStorage.
-            wbs.writeLogAndData();
+        const size_t concurrency = std::min(tasks.size(), std::max<size_t>(1, dm_context->db_context.getSettingsRef().dt_ingest_prepare_concurrency));
+        if (concurrency <= 1)
+        {
+            for (auto & task : tasks)
+                task.column_files = prepare_column_files(task.segment_range, task.wb);
+        }
+        else
+        {
+            ThreadPool pool(concurrency, [] { setThreadName("DMIngestPrep"); });
+            for (size_t i = 0; i < tasks.size(); ++i)
+                pool.schedule([&, i] { tasks[i].column_files = prepare_column_files(tasks[i].segment_range, tasks[i].wb); });
+            // Rethrow the exception of preparing if any
+            pool.wait();
+        }
 
-            bool ingest_success = segment->ingestColumnFiles(*dm_context, range.shrink(segment_range), column_files, clear_data_in_range);
+        // We have to commit those file_ids to PageStorage, because as soon as packs are written into segments,
+        // they are visible for readers who require file_ids to be found in PageStorage.
+        WriteBatches wbs(*storage_pool, dm_context->getWriteLimiter());
+        for (auto & task : tasks)
+        {
+            for (const auto & w : task.wb.getWrites())
+                wbs.data.putRefPage(w.page_id, w.ori_page_id);
+        }
+        wbs.writeLogAndData();
+
+        WriteBatch removed_refs(storage_pool->getNamespaceId());
+        for (auto & task : tasks)
+        {
+            FAIL_POINT_PAUSE(FailPoints::pause_when_ingesting_to_dt_store);
+            waitForWrite(dm_context, task.segment);
+
+            bool ingest_success = !task.segment->hasAbandoned()
+                && task.segment->ingestColumnFiles(*dm_context, range.shrink(task.segment_range), task.column_files, clear_data_in_range);
             fiu_do_on(FailPoints::force_set_segment_ingest_packs_fail, { ingest_success = false; });
             if (ingest_success)
             {
-                updated_segments.push_back(segment);
+                updated_segments.push_back(task.segment);
                 fiu_do_on(FailPoints::segment_merge_after_ingest_packs, {
-                    segment->flushCache(*dm_context);
-                    segmentMergeDelta(*dm_context, segment, TaskRunThread::BackgroundThreadPool);
+                    task.segment->flushCache(*dm_context);
+                    segmentMergeDelta(*dm_context, task.segment, TaskRunThread::BackgroundThreadPool);
                     storage_pool->gc(global_context.getSettingsRef(), StoragePool::Seconds(0));
                 });
-                break;
             }
             else
             {
-                wbs.rollbackWrittenLogAndData();
+                for (const auto & w : task.wb.getWrites())
+                    removed_refs.delPage(w.page_id);
+                retry_ranges.push_back(range.shrink(task.segment_range));
             }
         }
+        if (!removed_refs.empty())
+            storage_pool->dataWriter()->write(std::move(removed_refs), dm_context->getWriteLimiter());
+    }
 
-        cur_range.setStart(segment_range.end);
-        cur_range.setEnd(range.end);
+    for (const auto & retry_range : retry_ranges)
+    {
+        RowKeyRange cur_range = retry_range;
+        while (!cur_range.none())
+        {
+            RowKeyRange segment_range;
+
+            // Keep trying until succeeded.
+            while (true)
+            {
+                SegmentPtr segment;
+                {
+                    std::shared_lock lock(read_write_mutex);
+
+                    auto segment_it = segments.upper_bound(cur_range.getStart());
+                    if (segment_it == segments.end())
+                    {
+                        throw Exception(
+                            fmt::format("Failed to locate segment begin with start in range: {}", cur_range.toDebugString()),
+                            ErrorCodes::LOGICAL_ERROR);
+                    }
+                    segment = segment_it->second;
+                }
+
+                FAIL_POINT_PAUSE(FailPoints::pause_when_ingesting_to_dt_store);
+                waitForWrite(dm_context, segment);
+                if (segment->hasAbandoned())
+                    continue;
+
+                segment_range = segment->getRowKeyRange();
+
+                // Write could fail, because other threads could already updated the instance. Like split/merge, merge delta.
+                WriteBatches wbs(*storage_pool, dm_context->getWriteLimiter());
+                auto column_files = prepare_column_files(segment_range, wbs.data);
+                wbs.writeLogAndData();
+
+                bool ingest_success = segment->ingestColumnFiles(*dm_context, range.shrink(segment_range), column_files, clear_data_in_range);
+                fiu_do_on(FailPoints::force_set_segment_ingest_packs_fail, { ingest_success = false; });
+                if (ingest_success)
+                {
+                    updated_segments.push_back(segment);
+                    fiu_do_on(FailPoints::segment_merge_after_ingest_packs, {
+                        segment->flushCache(*dm_context);
+                        segmentMergeDelta(*dm_context, segment, TaskRunThread::BackgroundThreadPool);
+                        storage_pool->gc(global_context.getSettingsRef(), StoragePool::Seconds(0));
+                    });
+                    break;
+                }
+                else
+                {
+                    wbs.rollbackWrittenLogAndData();
+                }
+            }
+
+            cur_range.setStart(segment_range.end);
+            cur_range.setEnd(retry_range.end);
+        }
     }
 
     // Enable gc for DTFile after all segment applied.
@@ -1233,6 +1416,137 @@ BlockInputStreams DeltaMergeStore::readRaw(const Context & db_context,
     return res;
 }
 
+namespace
+{
+// The average bytes per row of `columns` in the stable of the segments to read, weighted by the rows of DTFiles.
+// The columns not in a DTFile (added by DDL later) are filled by the default value, count their fixed size only.
+double estimateBytesPerRow(const SegmentReadTasks & tasks, const ColumnDefines & columns)
+{
+    size_t total_rows = 0;
+    double total_bytes = 0;
+    for (const auto & task : tasks)
+    {
+        for (const auto & file : task->read_snapshot->stable->getDMFiles())
+        {
+            size_t file_rows = file->getRows();
+            if (file_rows == 0)
+                continue;
+            double row_bytes = 0;
+            for (const auto & cd : columns)
+            {
+                if (file->isColumnExist(cd.id))
+                    row_bytes += file->getColumnStat(cd.id).avg_size;
+                else if (cd.type->haveMaximumSizeOfValue())
+                    row_bytes += cd.type->getMaximumSizeOfValueInMemory();
+            }
+            total_rows += file_rows;
+            total_bytes += row_bytes * file_rows;
+        }
+    }
+    return total_rows == 0 ? 0 : total_bytes / total_rows;
+}
+
+/// Build the filter to skip the stable packs which could not be in the result of `top_n`.
+/// Take `order by column desc limit N` as an example. The rows of a pack without null values are all greater
+/// than or equal to its min. If there are at least N rows greater than or equal to a threshold in the packs
+/// whose rows are all visible and in the read ranges, then the packs whose max is less than the threshold
+/// could be skipped, as well as the null values which are the smallest. Only the clean packs of the segments
+/// without delta are counted, the rows of the other packs may be deleted or updated.
+/// For the int handle column, the tasks whose ranges are out of the threshold are removed from `tasks` as a whole.
+/// Return EMPTY_FILTER if no threshold is found.
+RSOperatorPtr buildTopNFilter(const DMContext & dm_context, SegmentReadTasks & tasks, const PushDownTopN & top_n, UInt64 max_version, bool is_common_handle)
+{
+    const auto & column = top_n.column;
+    const auto type = removeNullable(column.type);
+    // The order of the min-max index must be the same as the order of TopN. The null values are the first
+    // ones in the ascending order, so the packs with null values could not be skipped.
+    if (top_n.limit == 0 || !(type->isValueRepresentedByInteger() || type->isDecimal()) || (!top_n.is_desc && column.type->isNullable()))
+        return EMPTY_FILTER;
+
+    const auto & global_context = dm_context.db_context.getGlobalContext();
+    // The bound (min for desc, max for asc) of the values and the rows of each counted pack
+    std::vector<std::pair<Field, size_t>> bounds;
+    for (const auto & task : tasks)
+    {
+        const auto & snapshot = task->read_snapshot;
+        if (snapshot->delta->getRows() != 0 || snapshot->delta->getDeletes() != 0)
+            continue;
+        for (const auto & file : snapshot->stable->getDMFiles())
+        {
+            if (!file->isColIndexExist(column.id))
+                continue;
+            auto pack_filter = DMFilePackFilter::loadFrom(
+                file,
+                global_context.getMinMaxIndexCache(),
+                global_context.getBloomFilterIndexCache(),
+                /*set_cache_if_miss*/ true,
+                task->ranges,
+                EMPTY_FILTER,
+                /*read_packs*/ {},
+                dm_context.db_context.getFileProvider(),
+                dm_context.db_context.getReadLimiter(),
+                dm_context.tracing_id);
+            auto index = pack_filter.getMinMaxIndex(column.id);
+            if (!index)
+                continue;
+            const auto & handle_res = pack_filter.getHandleRes();
+            const auto & pack_stats = file->getPackStats();
+            for (size_t i = 0; i < pack_stats.size(); ++i)
+            {
+                if (handle_res[i] != All || pack_stats[i].not_clean != 0 || pack_filter.getMaxVersion(i) > max_version)
+                    continue;
+                if (!index->hasValue(i) || (top_n.is_desc && index->hasNull(i)))
+                    continue;
+                auto [min, max] = index->getFieldMinMax(i);
+                auto & bound = top_n.is_desc ? min : max;
+                if (!bound.isNull())
+                    bounds.emplace_back(std::move(bound), pack_stats[i].rows);
+            }
+        }
+    }
+
+    // Take the bounds in the order of TopN until there are enough rows
+    std::sort(bounds.begin(), bounds.end(), [&top_n](const auto & a, const auto & b) {
+        return top_n.is_desc ? b.first < a.first : a.first < b.first;
+    });
+    size_t rows = 0;
+    auto iter = bounds.begin();
+    for (; iter != bounds.end(); ++iter)
+    {
+        rows += iter->second;
+        if (rows >= top_n.limit)
+            break;
+    }
+    if (iter == bounds.end())
+        return EMPTY_FILTER;
+    const auto & threshold = iter->first;
+
+    if (column.id == EXTRA_HANDLE_COLUMN_ID && !is_common_handle)
+    {
+        const auto threshold_handle = threshold.get<Int64>();
+        tasks.remove_if([&](const SegmentReadTaskPtr & task) {
+            return std::all_of(task->ranges.begin(), task->ranges.end(), [&](const RowKeyRange & range) {
+                // The handles in range are all less than its end, and not less than its start
+                return top_n.is_desc ? (!range.isEndInfinite() && range.end.int_value <= threshold_handle)
+                                     : range.start.int_value > threshold_handle;
+            });
+        });
+    }
+
+    Attr attr{.col_name = column.name, .col_id = column.id, .type = column.type};
+    return top_n.is_desc ? createGreaterEqual(attr, threshold, -1) : createLessEqual(attr, threshold, -1);
+}
+} // namespace
+
+size_t DeltaMergeStore::getAdaptiveBlockSize(double bytes_per_row, size_t target_block_bytes, size_t default_rows, size_t min_rows)
+{
+    if (target_block_bytes == 0 || bytes_per_row <= 0)
+        return default_rows;
+    const size_t max_rows = std::max(default_rows * 4, min_rows);
+    auto rows = static_cast<size_t>(std::min(target_block_bytes / bytes_per_row, static_cast<double>(max_rows)));
+    return std::clamp(rows, min_rows, max_rows);
+}
+
 BlockInputStreams DeltaMergeStore::read(const Context & db_context,
                                         const DB::Settings & db_settings,
                                         const ColumnDefines & columns_to_read,
@@ -1245,16 +1559,25 @@ BlockInputStreams DeltaMergeStore::read(const Context & db_context,
                                         bool is_fast_mode,
                                         size_t expected_block_size,
                                         const SegmentIdSet & read_segments,
-                                        size_t extra_table_id_index)
+                                        size_t extra_table_id_index,
+                                        const LateMaterializationFilterPtr & late_materialization_filter,
+                                        bool read_rows_only,
+                                        const PushDownTopNPtr & top_n,
+                                        size_t limit)
 {
     // Use the id from MPP/Coprocessor level as tracing_id
     auto dm_context = newDMContext(db_context, db_settings, tracing_id);
+    dm_context->late_materialization_filter = late_materialization_filter;
+    dm_context->read_rows_only = read_rows_only;
+    dm_context->read_stage_profile = std::make_shared<ReadStageProfile>();
     // If keep order is required, disable read thread.
     auto enable_read_thread = db_context.getSettingsRef().dt_enable_read_thread && !keep_order;
     // SegmentReadTaskScheduler and SegmentReadTaskPool use table_id + segment id as unique ID when read thread is enabled.
     // 'try_split_task' can result in several read tasks with the same id that can cause some trouble.
     // Also, too many read tasks of a segment with different samll ranges is not good for data sharing cache.
+    Stopwatch snapshot_watch;
     SegmentReadTasks tasks = getReadTasksByRanges(*dm_context, sorted_ranges, num_streams, read_segments, /*try_split_task =*/!enable_read_thread);
+    dm_context->read_stage_profile->add(ReadStage::Snapshot, snapshot_watch.elapsed());
 
     auto tracing_logger = Logger::get(log->name(), dm_context->tracing_id);
     LOG_FMT_DEBUG(tracing_logger,
@@ -1263,6 +1586,23 @@ BlockInputStreams DeltaMergeStore::read(const Context & db_context,
                   db_context.getSettingsRef().dt_enable_read_thread,
                   enable_read_thread);
 
+    auto read_filter = filter;
+    if (top_n)
+    {
+        if (auto top_n_filter = buildTopNFilter(*dm_context, tasks, *top_n, max_version, is_common_handle); top_n_filter)
+        {
+            read_filter = read_filter ? createAnd({read_filter, top_n_filter}) : top_n_filter;
+            LOG_FMT_DEBUG(tracing_logger, "Read with TopN filter {}, tasks {}", top_n_filter->toDebugString(), tasks.size());
+        }
+    }
+
+    if (db_settings.dt_read_block_size_bytes > 0)
+    {
+        auto bytes_per_row = estimateBytesPerRow(tasks, columns_to_read);
+        expected_block_size = getAdaptiveBlockSize(bytes_per_row, db_settings.dt_read_block_size_bytes, expected_block_size, db_settings.dt_segment_stable_pack_rows);
+        LOG_FMT_DEBUG(tracing_logger, "Read with adaptive block size {} rows, estimated bytes per row {:.2f}", expected_block_size, bytes_per_row);
+    }
+
     auto after_segment_read = [&](const DMContextPtr & dm_context_, const SegmentPtr & segment_) {
         // TODO: Update the tracing_id before checkSegmentUpdate?
         this->checkSegmentUpdate(dm_context_, segment_, ThreadType::Read);
@@ -1270,17 +1610,31 @@ BlockInputStreams DeltaMergeStore::read(const Context & db_context,
 
     GET_METRIC(tiflash_storage_read_tasks_count).Increment(tasks.size());
     size_t final_num_stream = std::max(1, std::min(num_streams, tasks.size()));
+    // An upper bound of the rows to read, used by upper executors to size their hash tables.
+    // Tasks split from the same segment share the snapshot, only count them once.
+    size_t total_rows_approx = 0;
+    {
+        std::unordered_set<PageId> counted_segments;
+        for (const auto & task : tasks)
+        {
+            if (counted_segments.insert(task->segment->segmentId()).second)
+                total_rows_approx += task->getRowsAndBytes().first;
+        }
+    }
     auto read_task_pool = std::make_shared<SegmentReadTaskPool>(
         physical_table_id,
         dm_context,
         columns_to_read,
-        filter,
+        read_filter,
         max_version,
         expected_block_size,
         /* is_raw = */ is_fast_mode,
         /* do_delete_mark_filter_for_raw = */ is_fast_mode,
         std::move(tasks),
-        after_segment_read);
+        after_segment_read,
+        limit);
+    if (limit > 0)
+        LOG_FMT_DEBUG(tracing_logger, "Read with limit {}", limit);
 
     String req_info;
     if (db_context.getDAGContext() != nullptr && db_context.getDAGContext()->isMPPTask())
@@ -1305,7 +1659,7 @@ BlockInputStreams DeltaMergeStore::read(const Context & db_context,
                 read_task_pool,
                 after_segment_read,
                 columns_to_read,
-                filter,
+                read_filter,
                 max_version,
                 expected_block_size,
                 /* is_raw_ */ is_fast_mode,
@@ -1316,6 +1670,8 @@ BlockInputStreams DeltaMergeStore::read(const Context & db_context,
         }
         res.push_back(stream);
     }
+    if (auto * p_stream = dynamic_cast<IProfilingBlockInputStream *>(res.front().get()); p_stream)
+        p_stream->addTotalRowsApprox(total_rows_approx);
     if (enable_read_thread)
     {
         SegmentReadTaskScheduler::instance().add(read_task_pool);
@@ -1340,6 +1696,22 @@ size_t forceMergeDeltaDeletes(const DMContextPtr & dm_context)
     return dm_context->db_context.getSettingsRef().dt_segment_force_merge_delta_deletes;
 }
 
+DeltaMergeStore::SegmentHeat DeltaMergeStore::getSegmentHeat(UInt64 written_rows, UInt64 read_times, double age_seconds, UInt64 hot_write_rows)
+{
+    // The rates of a young segment are not reliable, e.g. the ones just restored or split.
+    static constexpr double min_age_seconds = 60;
+    if (hot_write_rows == 0 || age_seconds < min_age_seconds)
+        return SegmentHeat::Normal;
+
+    double write_rows_per_second = written_rows / age_seconds;
+    double reads_per_second = read_times / age_seconds;
+    if (write_rows_per_second >= hot_write_rows)
+        return SegmentHeat::Hot;
+    if (write_rows_per_second * 10 < hot_write_rows)
+        return SegmentHeat::Cold;
+    return reads_per_second >= 1 ? SegmentHeat::Hot : SegmentHeat::Normal;
+}
+
 void DeltaMergeStore::waitForWrite(const DMContextPtr & dm_context, const SegmentPtr & segment)
 {
     size_t delta_rows = segment->getDelta()->getRows();
@@ -1388,6 +1760,41 @@ void DeltaMergeStore::waitForWrite(const DMContextPtr & dm_context, const Segmen
     }
 }
 
+bool DeltaMergeStore::isWriteThrottled(const Context & db_context, const RowKeyRange & range)
+{
+    auto dm_context = newDMContext(db_context, db_context.getSettingsRef(), "isWriteThrottled");
+    Segments stalled_segments;
+    {
+        std::shared_lock lock(read_write_mutex);
+        for (auto segment_it = segments.upper_bound(range.getStart()); segment_it != segments.end(); ++segment_it)
+        {
+            const auto & segment = segment_it->second;
+            if (!(segment->getRowKeyRange().getStart() < range.getEnd()))
+                break;
+            // The same condition as `waitForWrite`.
+            const auto & delta = segment->getDelta();
+            if (delta->getRows() >= forceMergeDeltaRows(dm_context) || delta->getBytes() >= forceMergeDeltaBytes(dm_context))
+                stalled_segments.push_back(segment);
+        }
+    }
+
+    for (const auto & segment : stalled_segments)
+    {
+        const auto & delta = segment->getDelta();
+        auto & delta_last_try_merge_delta_rows = delta->getLastTryMergeDeltaRows();
+        size_t delta_rows = delta->getRows();
+        if (shutdown_called.load(std::memory_order_relaxed) || delta->isUpdating()
+            || delta_rows < delta_last_try_merge_delta_rows + dm_context->delta_cache_limit_rows)
+            continue;
+        delta_last_try_merge_delta_rows = delta_rows;
+        BackgroundTask task{TaskType::MergeDelta, dm_context, segment, {}};
+        task.urgent = true;
+        if (background_tasks.tryAddTask(task, ThreadType::Write, std::max(id_to_segment.size() * 2, background_pool.getNumberOfThreads() * 3), log).first)
+            blockable_background_pool_handle->wake();
+    }
+    return !stalled_segments.empty();
+}
+
 void DeltaMergeStore::waitForDeleteRange(const DB::DM::DMContextPtr &, const DB::DM::SegmentPtr &)
 {
     // TODO: maybe we should wait, if there are too many delete ranges?
@@ -1410,6 +1817,8 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
 
     size_t unsaved_rows = delta->getUnsavedRows();
     size_t unsaved_bytes = delta->getUnsavedBytes();
+    // The sealed in-memory column files may be compressed, flush by the bytes actually taken in memory.
+    size_t unsaved_memory_bytes = delta->getUnsavedMemoryBytes();
 
     size_t delta_rows = delta_saved_rows + unsaved_rows;
     size_t delta_bytes = delta_saved_bytes + unsaved_bytes;
@@ -1435,20 +1844,44 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
     auto delta_cache_limit_rows = dm_context->delta_cache_limit_rows;
     auto delta_cache_limit_bytes = dm_context->delta_cache_limit_bytes;
 
-    bool should_background_flush = (unsaved_rows >= delta_cache_limit_rows || unsaved_bytes >= delta_cache_limit_bytes) //
+    bool should_background_flush = (unsaved_rows >= delta_cache_limit_rows || unsaved_memory_bytes >= delta_cache_limit_bytes) //
         && (delta_rows - delta_last_try_flush_rows >= delta_cache_limit_rows
             || delta_bytes - delta_last_try_flush_bytes >= delta_cache_limit_bytes);
-    bool should_foreground_flush = unsaved_rows >= delta_cache_limit_rows * 3 || unsaved_bytes >= delta_cache_limit_bytes * 3;
+    bool should_foreground_flush = unsaved_rows >= delta_cache_limit_rows * 3 || unsaved_memory_bytes >= delta_cache_limit_bytes * 3;
     /// For write thread, we want to avoid foreground flush to block the process of apply raft command.
     /// So we increase the threshold of foreground flush for write thread.
     if (thread_type == ThreadType::Write)
     {
-        should_foreground_flush = unsaved_rows >= delta_cache_limit_rows * 10 || unsaved_bytes >= delta_cache_limit_bytes * 10;
+        should_foreground_flush = unsaved_rows >= delta_cache_limit_rows * 10 || unsaved_memory_bytes >= delta_cache_limit_bytes * 10;
     }
 
     bool should_background_merge_delta = ((delta_check_rows >= delta_limit_rows || delta_check_bytes >= delta_limit_bytes) //
                                           && (delta_rows - delta_last_try_merge_delta_rows >= delta_cache_limit_rows
                                               || delta_bytes - delta_last_try_merge_delta_bytes >= delta_cache_limit_bytes));
+    // A segment that is read frequently pays for placing and merging its delta on every read, so merge its delta
+    // even before reaching the limit above, when (read times * delta rows) is large enough.
+    bool should_background_merge_delta_by_reads = dm_context->delta_read_merge_factor > 0
+        && delta_rows >= delta_cache_limit_rows
+        && segment->getReadTimes() * delta_rows >= dm_context->delta_read_merge_factor * delta_limit_rows
+        && delta_rows - delta_last_try_merge_delta_rows >= delta_cache_limit_rows;
+    should_background_merge_delta |= should_background_merge_delta_by_reads;
+    // The reads notice the obsolete versions in the stable below the gc safe point and reclaim them by merging
+    // delta at once, instead of waiting for the gc thread to reach this segment. Checked once per gc safe point.
+    double read_gc_garbage_ratio = 0.0;
+    if (thread_type == ThreadType::Read && dm_context->read_gc_garbage_ratio_threshold > 0)
+    {
+        auto gc_safe_point = latest_gc_safe_point.load(std::memory_order_acquire);
+        if (gc_safe_point > 0 && segment->getLastCheckGCSafePoint() < gc_safe_point)
+        {
+            const double ratio_threshold = dm_context->db_context.getSettingsRef().dt_bg_gc_ratio_threhold_to_trigger_gc;
+            double ratio = GC::estimateStableGarbageRatio(segment, gc_safe_point, ratio_threshold, log);
+            if (ratio >= dm_context->read_gc_garbage_ratio_threshold)
+            {
+                read_gc_garbage_ratio = ratio;
+                segment->setLastCheckGCSafePoint(gc_safe_point);
+            }
+        }
+    }
     bool should_foreground_merge_delta_by_rows_or_bytes
         = delta_check_rows >= forceMergeDeltaRows(dm_context) || delta_check_bytes >= forceMergeDeltaBytes(dm_context);
     bool should_foreground_merge_delta_by_deletes = delta_deletes >= forceMergeDeltaDeletes(dm_context);
@@ -1458,12 +1891,20 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
     // Do background split in the following two cases:
     //   1. The segment is large enough, and there are some data in the delta layer. (A hot segment which is large enough)
     //   2. The segment is too large. (A segment which is too large, although it is cold)
-    bool should_bg_split = ((segment_rows >= segment_limit_rows * 2 || segment_bytes >= segment_limit_bytes * 2)
+    //
+    // The split and merge thresholds are adapted by the heat of the segment, see `getSegmentHeat`. The halves of a hot
+    // segment split at 1x are still larger than the merge threshold, and a cold segment merged up to 1x won't be split
+    // until it gets hot.
+    const auto heat = getSegmentHeat(segment->getWrittenRows(), segment->getReadTimes(), segment->getAgeSeconds(), dm_context->segment_hot_write_rows);
+    const size_t split_factor = heat == SegmentHeat::Hot ? 1 : 2;
+    bool should_bg_split = ((segment_rows >= segment_limit_rows * split_factor || segment_bytes >= segment_limit_bytes * split_factor)
                             && (delta_rows - delta_last_try_split_rows >= delta_cache_limit_rows
                                 || delta_bytes - delta_last_try_split_bytes >= delta_cache_limit_bytes))
         || (segment_rows >= segment_limit_rows * 3 || segment_bytes >= segment_limit_bytes * 3);
 
-    bool should_merge = segment_rows < segment_limit_rows / 3 && segment_bytes < segment_limit_bytes / 3;
+    bool should_merge = heat == SegmentHeat::Cold
+        ? segment_rows < segment_limit_rows * 2 / 3 && segment_bytes < segment_limit_bytes * 2 / 3
+        : segment_rows < segment_limit_rows / 3 && segment_bytes < segment_limit_bytes / 3;
 
     // Don't do compact on starting up.
     bool should_compact = (thread_type != ThreadType::Init) && std::max(static_cast<Int64>(column_file_count) - delta_last_try_compact_column_files, 0) >= 10;
@@ -1522,13 +1963,13 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
 
     /// Now start trying structure update.
 
-    auto get_merge_sibling = [&]() -> SegmentPtr {
-        /// For complexity reason, currently we only try to merge with next segment. Normally it is good enough.
+    auto get_merge_siblings = [&]() -> Segments {
+        /// Only try to merge with the next segments, the previous segments will try to merge with this one by themselves.
 
         // The last segment cannot be merged.
         if (segment->getRowKeyRange().isEndInfinite())
             return {};
-        SegmentPtr next_segment;
+        Segments siblings;
         {
             std::shared_lock read_write_lock(read_write_mutex);
 
@@ -1542,12 +1983,41 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
             ++it;
             if (it == segments.end())
                 return {};
-            next_segment = it->second;
+            auto next_segment = it->second;
+            // Merge a cold segment with a larger sibling, as long as the sibling is not hot.
             auto limit = dm_context->segment_limit_rows / 5;
+            if (heat == SegmentHeat::Cold)
+            {
+                auto next_heat = getSegmentHeat(next_segment->getWrittenRows(), next_segment->getReadTimes(), next_segment->getAgeSeconds(), dm_context->segment_hot_write_rows);
+                if (next_heat == SegmentHeat::Hot)
+                    return {};
+                limit = dm_context->segment_limit_rows / 3;
+            }
             if (next_segment->getEstimatedRows() >= limit)
                 return {};
+            siblings.push_back(next_segment);
+
+            // Coalesce the following small segments in the same merge, e.g. the empty segments left by
+            // deleting a large range, as long as the merged segment is not larger than a normal segment.
+            size_t merged_rows = segment_rows + next_segment->getEstimatedRows();
+            size_t merged_bytes = segment_bytes + next_segment->getEstimatedBytes();
+            for (++it; it != segments.end() && siblings.size() + 1 < dm_context->segment_merge_max_segments; ++it)
+            {
+                next_segment = it->second;
+                auto next_rows = next_segment->getEstimatedRows();
+                auto next_bytes = next_segment->getEstimatedBytes();
+                if (next_rows >= dm_context->segment_limit_rows / 5
+                    || merged_rows + next_rows >= dm_context->segment_limit_rows
+                    || merged_bytes + next_bytes >= dm_context->segment_limit_bytes)
+                    break;
+                if (getSegmentHeat(next_segment->getWrittenRows(), next_segment->getReadTimes(), next_segment->getAgeSeconds(), dm_context->segment_hot_write_rows) == SegmentHeat::Hot)
+                    break;
+                merged_rows += next_rows;
+                merged_bytes += next_bytes;
+                siblings.push_back(next_segment);
+            }
         }
-        return next_segment;
+        return siblings;
     };
 
     auto try_fg_merge_delta = [&]() -> SegmentPtr {
@@ -1570,10 +2040,22 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
         return {};
     };
     auto try_bg_merge_delta = [&]() {
-        if (should_background_merge_delta)
+        if (should_background_merge_delta || read_gc_garbage_ratio > 0)
         {
+            if (should_background_merge_delta_by_reads)
+                LOG_FMT_DEBUG(
+                    log,
+                    "Segment [{}] try merge delta by reads, read_times={} delta_rows={} read_delta_prepare_ms={}",
+                    segment->segmentId(),
+                    segment->getReadTimes(),
+                    delta_rows,
+                    segment->getReadDeltaPrepareNs() / 1000000);
+            if (read_gc_garbage_ratio > 0)
+                LOG_FMT_DEBUG(log, "Segment [{}] try merge delta to reclaim obsolete versions, garbage_ratio={:.2f}", segment->segmentId(), read_gc_garbage_ratio);
             delta_last_try_merge_delta_rows = delta_rows;
-            try_add_background_task(BackgroundTask{TaskType::MergeDelta, dm_context, segment, {}});
+            BackgroundTask task{TaskType::MergeDelta, dm_context, segment, {}};
+            task.garbage_ratio = read_gc_garbage_ratio;
+            try_add_background_task(task);
             return true;
         }
         return false;
@@ -1598,13 +2080,13 @@ void DeltaMergeStore::checkSegmentUpdate(const DMContextPtr & dm_context, const
         return false;
     };
     auto try_bg_merge = [&]() {
-        SegmentPtr merge_sibling;
-        if (should_merge && (merge_sibling = get_merge_sibling()))
-        {
-            try_add_background_task(BackgroundTask{TaskType::Merge, dm_context, segment, merge_sibling});
-            return true;
-        }
-        return false;
+        if (!should_merge)
+            return false;
+        auto merge_siblings = get_merge_siblings();
+        if (merge_siblings.empty())
+            return false;
+        try_add_background_task(BackgroundTask{TaskType::Merge, dm_context, segment, std::move(merge_siblings)});
+        return true;
     };
     auto try_bg_compact = [&]() {
         /// Compact task should be a really low priority task.
@@ -1704,9 +2186,13 @@ bool DeltaMergeStore::handleBackgroundTask(bool heavy)
             type = ThreadType::BG_Split;
             break;
         case TaskType::Merge:
-            segmentMerge(*task.dm_context, task.segment, task.next_segment, false);
+        {
+            Segments ordered_segments{task.segment};
+            ordered_segments.insert(ordered_segments.end(), task.next_segments.begin(), task.next_segments.end());
+            segmentMerge(*task.dm_context, ordered_segments, false);
             type = ThreadType::BG_Merge;
             break;
+        }
         case TaskType::MergeDelta:
         {
             FAIL_POINT_PAUSE(FailPoints::pause_before_dt_background_delta_merge);
@@ -1742,7 +2228,7 @@ bool DeltaMergeStore::handleBackgroundTask(bool heavy)
             "Task {} on Segment [{}]{} failed. Error msg: {}",
             DeltaMergeStore::toString(task.type),
             task.segment->segmentId(),
-            ((bool)task.next_segment ? (fmt::format(" and [{}]", task.next_segment->segmentId())) : ""),
+            (task.next_segments.empty() ? "" : fmt::format(" and {}", Segment::simpleInfo(task.next_segments))),
             e.message());
         e.rethrow();
     }
@@ -1808,6 +2294,66 @@ bool shouldCompactDeltaWithStable(const DMContext & context, const SegmentSnapsh
     bool should_compact = (delete_rows >= stable_rows * ratio_threshold) || (delete_bytes >= stable_bytes * ratio_threshold);
     return should_compact;
 }
+
+// Returns the estimated ratio of the stable versions could be reclaimed by gc, 0 means nothing to reclaim.
+// If the StableProperty is not calculated yet, it is estimated by the pack stats and the pack properties of the
+// whole DTFiles written by merge delta or split, so that the data is not read from disk for the clean segments.
+double estimateStableGarbageRatio(const SegmentPtr & seg, DB::Timestamp gc_safepoint, double ratio_threshold, const LoggerPtr & log)
+{
+    const auto & stable = seg->getStable();
+    if (stable->isStablePropertyCached())
+    {
+        if (!shouldCompactStable(seg, gc_safepoint, ratio_threshold, log))
+            return 0.0;
+        const auto & property = stable->getStableProperty();
+        if (property.num_versions == 0)
+            return 0.0;
+        return 1.0 - static_cast<double>(std::min(property.num_rows, property.num_puts)) / property.num_versions;
+    }
+
+    // The DTFiles may be shared with other segments, but the gc hint version of the whole file is not greater than
+    // the one of the packs in this segment, and the packs are all clean if there is no unclean row in the whole file.
+    UInt64 num_versions = 0;
+    UInt64 num_not_clean = 0;
+    UInt64 gc_hint_version = std::numeric_limits<UInt64>::max();
+    for (const auto & file : stable->getDMFiles())
+    {
+        for (const auto & pack_stat : file->getPackStats())
+        {
+            num_versions += pack_stat.rows;
+            num_not_clean += pack_stat.not_clean;
+        }
+        const auto & pack_properties = file->getPackProperties();
+        // An old format file without PackProperties, the gc hint version is unknown.
+        if (pack_properties.property_size() == 0)
+            gc_hint_version = 0;
+        for (const auto & pack_property : pack_properties.property())
+            gc_hint_version = std::min(gc_hint_version, pack_property.gc_hint_version());
+    }
+    if (num_not_clean == 0 || gc_hint_version > gc_safepoint)
+        return 0.0;
+    return static_cast<double>(num_not_clean) / num_versions;
+}
+
+// Returns a cheap estimation of how much could be reclaimed by applying gc on the segment per unit of IO,
+// only by the statistics in memory. The segments with higher scores are checked first, and the segments
+// with score 0 are known to be clean and will not be checked in this round.
+double estimateReclaimScore(const DMContext & context, const SegmentPtr & seg, DB::Timestamp gc_safepoint, double ratio_threshold, const LoggerPtr & log)
+{
+    // Empty segments are cheap to merge, and the delete ranges in delta may cover most of the stable.
+    if (seg->getEstimatedRows() == 0 || seg->getDelta()->getDeletes() != 0)
+        return 1.0;
+
+    double score = 0.0;
+    // The stable has been checked with this gc_safe_point, see `onSyncGc`.
+    if (seg->getLastCheckGCSafePoint() < gc_safepoint)
+        score = ratio_threshold < 1.0 ? 1.0 : estimateStableGarbageRatio(seg, gc_safepoint, ratio_threshold, log);
+
+    // Moving the stable between the fast paths and the main paths reclaims nothing, check it at last.
+    if (score == 0.0 && seg->shouldStableOnFastPath(context) != seg->isStableOnFastPath(context))
+        score = std::numeric_limits<double>::min();
+    return score;
+}
 } // namespace GC
 
 UInt64 DeltaMergeStore::onSyncGc(Int64 limit)
@@ -1837,31 +2383,47 @@ UInt64 DeltaMergeStore::onSyncGc(Int64 limit)
                   gc_safe_point,
                   limit);
 
-    UInt64 check_segments_num = 0;
+    // Rank the segments by the estimated reclaim per IO, so that the expensive checks and merge delta are applied on
+    // the segments with the most garbage first, and the segments known to be clean are skipped. The segments with the
+    // same score are checked round-robin from `next_gc_check_key`.
+    std::vector<std::pair<double, SegmentPtr>> candidates;
+    {
+        auto dm_context = newDMContext(global_context, global_context.getSettingsRef(), "onSyncGc");
+        const double ratio_threshold = global_context.getSettingsRef().dt_bg_gc_ratio_threhold_to_trigger_gc;
+
+        std::shared_lock lock(read_write_mutex);
+        auto segment_it = segments.upper_bound(next_gc_check_key.toRowKeyValueRef());
+        for (size_t i = 0; i < segments.size(); ++i, ++segment_it)
+        {
+            if (segment_it == segments.end())
+                segment_it = segments.begin();
+            const auto & segment = segment_it->second;
+            if (auto score = GC::estimateReclaimScore(*dm_context, segment, gc_safe_point, ratio_threshold, log); score > 0.0)
+                candidates.emplace_back(score, segment);
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto & lhs, const auto & rhs) { return lhs.first > rhs.first; });
+
     Int64 gc_segments_num = 0;
-    while (gc_segments_num < limit)
+    for (const auto & candidate : candidates)
     {
+        if (gc_segments_num >= limit)
+            break;
         // If the store is shut down, give up running GC on it.
         if (shutdown_called.load(std::memory_order_relaxed))
             break;
 
         auto dm_context = newDMContext(global_context, global_context.getSettingsRef(), "onSyncGc");
-        SegmentPtr segment;
+        SegmentPtr segment = candidate.second;
         SegmentSnapshotPtr segment_snap;
         {
             std::shared_lock lock(read_write_mutex);
 
-            auto segment_it = segments.upper_bound(next_gc_check_key.toRowKeyValueRef());
-            if (segment_it == segments.end())
-                segment_it = segments.begin();
-
-            // we have check all segments, stop here
-            if (check_segments_num >= segments.size())
-                break;
-            check_segments_num++;
+            // The segment could be updated by other threads since ranked.
+            if (!isSegmentValid(lock, segment))
+                continue;
 
-            segment = segment_it->second;
-            next_gc_check_key = segment_it->first.toRowKeyValue();
+            next_gc_check_key = segment->getRowKeyRange().end;
             segment_snap = segment->createSnapshot(*dm_context, /* for_update */ true, CurrentMetrics::DT_SnapshotOfDeltaMerge);
         }
 
@@ -1914,6 +2476,25 @@ UInt64 DeltaMergeStore::onSyncGc(Int64 limit)
                     global_context.getSettingsRef().dt_bg_gc_ratio_threhold_to_trigger_gc,
                     log);
             }
+            // Move the stable between the fast paths and the main paths by the read rate of the segment. It is rewritten
+            // by the background GC thread, so the I/O is limited by the background limiters of IORateLimiter.
+            if (!should_compact)
+            {
+                const bool should_on_fast_path = segment->shouldStableOnFastPath(*dm_context);
+                if (should_on_fast_path != segment->isStableOnFastPath(*dm_context))
+                {
+                    should_compact = true;
+                    LOG_FMT_DEBUG(
+                        log,
+                        "GC move the stable of Segment [{}] [range={}] [table={}] to the {} paths, read_times={} age={:.1f}s",
+                        segment_id,
+                        segment_range.toDebugString(),
+                        table_name,
+                        should_on_fast_path ? "fast" : "main",
+                        segment->getReadTimes(),
+                        segment->getAgeSeconds());
+                }
+            }
             bool finish_gc_on_segment = false;
             if (should_compact)
             {
@@ -2086,110 +2667,106 @@ SegmentPair DeltaMergeStore::segmentSplit(DMContext & dm_context, const SegmentP
     return {new_left, new_right};
 }
 
-void DeltaMergeStore::segmentMerge(DMContext & dm_context, const SegmentPtr & left, const SegmentPtr & right, bool is_foreground)
+void DeltaMergeStore::segmentMerge(DMContext & dm_context, const Segments & ordered_segments, bool is_foreground)
 {
     LOG_FMT_DEBUG(
         log,
-        "{} merge Segment [{}] and [{}], safe point: {}",
+        "{} merge Segments {}, safe point: {}",
         (is_foreground ? "Foreground" : "Background"),
-        left->info(),
-        right->info(),
+        Segment::info(ordered_segments),
         dm_context.min_version);
 
     /// This segment may contain some rows that not belong to this segment range which is left by previous split operation.
     /// And only saved data in this segment will be filtered by the segment range in the merge process,
     /// unsaved data will be directly copied to the new segment.
     /// So we flush here to make sure that all potential data left by previous split operation is saved.
-    while (!left->flushCache(dm_context))
-    {
-        // keep flush until success if not abandoned
-        if (left->hasAbandoned())
-        {
-            LOG_FMT_DEBUG(log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            return;
-        }
-    }
-    while (!right->flushCache(dm_context))
+    for (const auto & segment : ordered_segments)
     {
-        // keep flush until success if not abandoned
-        if (right->hasAbandoned())
+        while (!segment->flushCache(dm_context))
         {
-            LOG_FMT_DEBUG(log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            return;
+            // keep flush until success if not abandoned
+            if (segment->hasAbandoned())
+            {
+                LOG_FMT_DEBUG(log, "Give up merge segments {}", Segment::simpleInfo(ordered_segments));
+                return;
+            }
         }
     }
 
-    SegmentSnapshotPtr left_snap;
-    SegmentSnapshotPtr right_snap;
+    std::vector<SegmentSnapshotPtr> ordered_snapshots;
     ColumnDefinesPtr schema_snap;
 
     {
         std::shared_lock lock(read_write_mutex);
 
-        if (!isSegmentValid(lock, left))
-        {
-            LOG_FMT_DEBUG(log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            return;
-        }
-        if (!isSegmentValid(lock, right))
+        for (const auto & segment : ordered_segments)
         {
-            LOG_FMT_DEBUG(log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            return;
-        }
-
-        left_snap = left->createSnapshot(dm_context, /* for_update */ true, CurrentMetrics::DT_SnapshotOfSegmentMerge);
-        right_snap = right->createSnapshot(dm_context, /* for_update */ true, CurrentMetrics::DT_SnapshotOfSegmentMerge);
+            if (!isSegmentValid(lock, segment))
+            {
+                LOG_FMT_DEBUG(log, "Give up merge segments {}", Segment::simpleInfo(ordered_segments));
+                return;
+            }
 
-        if (!left_snap || !right_snap)
-        {
-            LOG_FMT_DEBUG(log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            return;
+            auto snap = segment->createSnapshot(dm_context, /* for_update */ true, CurrentMetrics::DT_SnapshotOfSegmentMerge);
+            if (!snap)
+            {
+                LOG_FMT_DEBUG(log, "Give up merge segments {}", Segment::simpleInfo(ordered_segments));
+                return;
+            }
+            ordered_snapshots.emplace_back(std::move(snap));
         }
         schema_snap = store_columns;
     }
 
     // Not counting the early give up action.
-    auto delta_bytes = static_cast<Int64>(left_snap->delta->getBytes()) + right_snap->getBytes();
-    auto delta_rows = static_cast<Int64>(left_snap->delta->getRows()) + right_snap->getRows();
+    Int64 delta_bytes = 0;
+    Int64 delta_rows = 0;
+    for (const auto & snap : ordered_snapshots)
+    {
+        delta_bytes += snap->delta->getBytes();
+        delta_rows += snap->delta->getRows();
+    }
 
     CurrentMetrics::Increment cur_dm_segments{CurrentMetrics::DT_SegmentMerge};
     GET_METRIC(tiflash_storage_subtask_count, type_seg_merge).Increment();
     Stopwatch watch_seg_merge;
     SCOPE_EXIT({ GET_METRIC(tiflash_storage_subtask_duration_seconds, type_seg_merge).Observe(watch_seg_merge.elapsedSeconds()); });
 
-    auto left_range = left->getRowKeyRange();
-    auto right_range = right->getRowKeyRange();
-
     WriteBatches wbs(*storage_pool, dm_context.getWriteLimiter());
-    auto merged_stable = Segment::prepareMerge(dm_context, schema_snap, left, left_snap, right, right_snap, wbs);
+    auto merged_stable = Segment::prepareMerge(dm_context, schema_snap, ordered_segments, ordered_snapshots, wbs);
     wbs.writeLogAndData();
     merged_stable->enableDMFilesGC();
 
     {
         std::unique_lock lock(read_write_mutex);
 
-        if (!isSegmentValid(lock, left) || !isSegmentValid(lock, right))
+        for (const auto & segment : ordered_segments)
         {
-            LOG_FMT_DEBUG(log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            wbs.setRollback();
-            return;
+            if (!isSegmentValid(lock, segment))
+            {
+                LOG_FMT_DEBUG(log, "Give up merge segments {}", Segment::simpleInfo(ordered_segments));
+                wbs.setRollback();
+                return;
+            }
         }
 
-        LOG_FMT_DEBUG(log, "Apply merge. Left [{}], right [{}]", left->segmentId(), right->segmentId());
+        LOG_FMT_DEBUG(log, "Apply merge. Segments {}", Segment::simpleInfo(ordered_segments));
 
-        auto left_lock = left->mustGetUpdateLock();
-        auto right_lock = right->mustGetUpdateLock();
+        std::vector<Segment::Lock> locks;
+        locks.reserve(ordered_segments.size());
+        for (const auto & segment : ordered_segments)
+            locks.emplace_back(segment->mustGetUpdateLock());
 
-        auto merged = Segment::applyMerge(dm_context, left, left_snap, right, right_snap, wbs, merged_stable);
+        auto merged = Segment::applyMerge(dm_context, ordered_segments, ordered_snapshots, wbs, merged_stable);
 
         wbs.writeMeta();
 
-        left->abandon(dm_context);
-        right->abandon(dm_context);
-        segments.erase(left_range.getEnd());
-        segments.erase(right_range.getEnd());
-        id_to_segment.erase(left->segmentId());
-        id_to_segment.erase(right->segmentId());
+        for (const auto & segment : ordered_segments)
+        {
+            segment->abandon(dm_context);
+            segments.erase(segment->getRowKeyRange().getEnd());
+            id_to_segment.erase(segment->segmentId());
+        }
 
         segments.emplace(merged->getRowKeyRange().getEnd(), merged);
         id_to_segment.emplace(merged->segmentId(), merged);
@@ -2199,7 +2776,7 @@ void DeltaMergeStore::segmentMerge(DMContext & dm_context, const SegmentPtr & le
             merged->check(dm_context, "After segment merge");
         }
 
-        LOG_FMT_DEBUG(log, "Apply merge done. [{}] and [{}]", left->info(), right->info());
+        LOG_FMT_DEBUG(log, "Apply merge done. {}", Segment::info(ordered_segments));
     }
 
     wbs.writeRemoves();
@@ -2659,6 +3236,19 @@ DeltaMergeStoreStat DeltaMergeStore::getStat()
     return stat;
 }
 
+DeltaMergeStoreSnapshotStat DeltaMergeStore::getSnapshotStat()
+{
+    DeltaMergeStoreSnapshotStat stat;
+    if (shutdown_called.load(std::memory_order_relaxed))
+        return stat;
+
+    stat.storage_stable_oldest_snapshot_lifetime = storage_pool->dataReader()->getSnapshotsStat().longest_living_seconds;
+    stat.storage_delta_oldest_snapshot_lifetime = storage_pool->logReader()->getSnapshotsStat().longest_living_seconds;
+    stat.storage_meta_oldest_snapshot_lifetime = storage_pool->metaReader()->getSnapshotsStat().longest_living_seconds;
+    stat.background_tasks_length = background_tasks.length();
+    return stat;
+}
+
 SegmentStats DeltaMergeStore::getSegmentStats()
 {
     std::shared_lock lock(read_write_mutex);
@@ -2697,6 +3287,41 @@ SegmentStats DeltaMergeStore::getSegmentStats()
     return stats;
 }
 
+SegmentColumnStats DeltaMergeStore::getSegmentColumnStats(const Context & db_context)
+{
+    std::vector<SegmentPtr> segments_copy;
+    {
+        std::shared_lock lock(read_write_mutex);
+        for (const auto & [handle, segment] : segments)
+        {
+            (void)handle;
+            segments_copy.push_back(segment);
+        }
+    }
+
+    // Read the sketches out of the lock.
+    SegmentColumnStats stats;
+    for (const auto & segment : segments_copy)
+    {
+        const auto & stable = segment->getStable();
+        auto sketches = stable->getNDVSketches(db_context.getFileProvider(), db_context.getReadLimiter());
+        for (const auto & cd : original_table_columns)
+        {
+            auto it = sketches.find(cd.id);
+            if (it == sketches.end())
+                continue;
+            SegmentColumnStat stat;
+            stat.segment_id = segment->segmentId();
+            stat.column_id = cd.id;
+            stat.column_name = cd.name;
+            stat.stable_rows = stable->getRows();
+            stat.ndv = it->second.estimate();
+            stats.push_back(std::move(stat));
+        }
+    }
+    return stats;
+}
+
 SegmentReadTasks DeltaMergeStore::getReadTasksByRanges(
     DMContext & dm_context,
     const RowKeyRanges & sorted_ranges,
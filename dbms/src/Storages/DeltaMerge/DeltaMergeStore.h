@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/ProfilingMutex.h>
 #include <Core/Block.h>
 #include <Core/SortDescription.h>
 #include <DataStreams/IBlockInputStream.h>
@@ -21,6 +22,8 @@
 #include <Storages/AlterCommands.h>
 #include <Storages/BackgroundProcessingPool.h>
 #include <Storages/DeltaMerge/DeltaMergeDefines.h>
+#include <Storages/DeltaMerge/Filter/LateMaterializationFilter.h>
+#include <Storages/DeltaMerge/Filter/PushDownTopN.h>
 #include <Storages/DeltaMerge/RowKeyRange.h>
 #include <Storages/DeltaMerge/SegmentReadTaskPool.h>
 #include <Storages/DeltaMerge/StoragePool.h>
@@ -73,6 +76,18 @@ struct SegmentStat
 };
 using SegmentStats = std::vector<SegmentStat>;
 
+// Estimated by the `NDVSketch`s of the stable, only for the columns that every DMFile of the stable has a sketch of.
+struct SegmentColumnStat
+{
+    UInt64 segment_id = 0;
+    ColId column_id = 0;
+    String column_name;
+
+    UInt64 stable_rows = 0;
+    UInt64 ndv = 0;
+};
+using SegmentColumnStats = std::vector<SegmentColumnStat>;
+
 struct DeltaMergeStoreStat
 {
     UInt64 segment_count = 0;
@@ -145,6 +160,17 @@ struct DeltaMergeStoreStat
     UInt64 background_tasks_length = 0;
 };
 
+/// The part of `DeltaMergeStoreStat` that is cheap to get, without locking the store or iterating the segments.
+/// Used by the periodic metrics collection, which goes through all the tables.
+struct DeltaMergeStoreSnapshotStat
+{
+    Float64 storage_stable_oldest_snapshot_lifetime = 0.0;
+    Float64 storage_delta_oldest_snapshot_lifetime = 0.0;
+    Float64 storage_meta_oldest_snapshot_lifetime = 0.0;
+
+    UInt64 background_tasks_length = 0;
+};
+
 class DeltaMergeStore : private boost::noncopyable
 {
 public:
@@ -258,7 +284,15 @@ public:
 
         DMContextPtr dm_context;
         SegmentPtr segment;
-        SegmentPtr next_segment;
+        // For merge tasks, the consecutive segments after `segment` which are merged with it.
+        Segments next_segments;
+
+        // Set when the task is added to `MergeDeltaTaskPool`.
+        UInt64 added_time_ns = 0;
+        // The writes of the segment are stalled, run it before the others.
+        bool urgent = false;
+        // For MergeDelta tasks added by the reads, the estimated ratio of the obsolete versions in the stable.
+        double garbage_ratio = 0.0;
 
         explicit operator bool() const { return segment != nullptr; }
     };
@@ -273,7 +307,8 @@ public:
 
         using TaskQueue = std::queue<BackgroundTask, std::list<BackgroundTask>>;
         TaskQueue light_tasks;
-        TaskQueue heavy_tasks;
+        // Heavy tasks are not popped in FIFO order, see `getHeavyTaskPriority`.
+        std::list<BackgroundTask> heavy_tasks;
 
         std::mutex mutex;
 
@@ -289,6 +324,11 @@ public:
         std::pair<bool, bool> tryAddTask(const BackgroundTask & task, const ThreadType & whom, size_t max_task_num, const LoggerPtr & log_);
 
         BackgroundTask nextTask(bool is_heavy, const LoggerPtr & log_);
+
+        // The heavy task with the highest priority is run first. An urgent task is always run first. A MergeDelta task gets a boost by the
+        // part of the delta in the bytes it rewrites, that is, the read amplification it removes for each byte
+        // it writes, or by how often the segment is read. Split and Merge always get the full boost. The waiting seconds are added so that tasks won't starve.
+        static double getHeavyTaskPriority(const BackgroundTask & task, UInt64 now_ns);
     };
 
     DeltaMergeStore(Context & db_context, //
@@ -319,8 +359,29 @@ public:
 
     static Block addExtraColumnIfNeed(const Context & db_context, const ColumnDefine & handle_define, Block && block);
 
+    enum class SegmentHeat
+    {
+        Normal,
+        // Split at `segment_limit_rows` instead of twice of it, for cheaper merge delta and more parallelism.
+        Hot,
+        // Merged at 2/3 of `segment_limit_rows` instead of 1/3 of it, for less segments and read tasks.
+        Cold,
+    };
+    // Decide by the rows written into and the read times of a segment in its age. A segment written more than
+    // `hot_write_rows` rows per second, or read more than once per second and written more than 1/10 of it, is hot.
+    // A segment written less than 1/10 of it is cold. Always `Normal` if `hot_write_rows` is 0.
+    static SegmentHeat getSegmentHeat(UInt64 written_rows, UInt64 read_times, double age_seconds, UInt64 hot_write_rows);
+
+    // The rows of the blocks to read, so that a block takes about `target_block_bytes` bytes by `bytes_per_row`.
+    // Limited in [`min_rows`, 4 * `default_rows`]. Return `default_rows` if `target_block_bytes` or `bytes_per_row` is 0.
+    static size_t getAdaptiveBlockSize(double bytes_per_row, size_t target_block_bytes, size_t default_rows, size_t min_rows);
+
     void write(const Context & db_context, const DB::Settings & db_settings, Block & block);
 
+    /// Returns true if the writes into `range` would be stalled by `waitForWrite`. The merge delta of the stalled
+    /// segments is added as urgent background tasks, so that the caller can postpone the writes instead of waiting.
+    bool isWriteThrottled(const Context & db_context, const RowKeyRange & range);
+
     void deleteRange(const Context & db_context, const DB::Settings & db_settings, const RowKeyRange & delete_range);
 
     std::tuple<String, PageId> preAllocateIngestFile();
@@ -356,6 +417,13 @@ public:
     ///     when is_fast_mode == false, we are in normal mode. Thus we will read rows with MVCC filtering, del mark !=0  filter and sorted merge
     ///     when is_fast_mode == true, we are in fast mode. Thus we will read rows without MVCC and sorted merge
     /// `sorted_ranges` should be already sorted and merged
+    /// `late_materialization_filter` is used to filter rows in advance when doing clean read on stable,
+    /// the caller still need to apply the filter on the output streams.
+    /// `read_rows_only` means only the row count of the output streams is used, the values may be fake.
+    /// `top_n` is used to skip the stable packs which could not be in the result of TopN, the caller still
+    /// need to apply the TopN on the output streams.
+    /// `limit` is the number of rows required by the caller without any order, 0 means no limit. The output
+    /// streams stop reading new segments once `limit` rows are read, but they may still return more rows.
     BlockInputStreams read(const Context & db_context,
                            const DB::Settings & db_settings,
                            const ColumnDefines & columns_to_read,
@@ -368,7 +436,11 @@ public:
                            bool is_fast_mode = false, // set true when read in fast mode
                            size_t expected_block_size = DEFAULT_BLOCK_SIZE,
                            const SegmentIdSet & read_segments = {},
-                           size_t extra_table_id_index = InvalidColumnID);
+                           size_t extra_table_id_index = InvalidColumnID,
+                           const LateMaterializationFilterPtr & late_materialization_filter = nullptr,
+                           bool read_rows_only = false,
+                           const PushDownTopNPtr & top_n = nullptr,
+                           size_t limit = 0);
 
     /// Try flush all data in `range` to disk and return whether the task succeed.
     bool flushCache(const Context & context, const RowKeyRange & range, bool try_until_succeed = true)
@@ -418,7 +490,10 @@ public:
 
     void check(const Context & db_context);
     DeltaMergeStoreStat getStat();
+    DeltaMergeStoreSnapshotStat getSnapshotStat();
     SegmentStats getSegmentStats();
+    // Load the sketches from disk, mainly for diagnostics. See `dt_enable_ndv_sketch`.
+    SegmentColumnStats getSegmentColumnStats(const Context & db_context);
     bool isCommonHandle() const { return is_common_handle; }
     size_t getRowKeyColumnSize() const { return rowkey_column_size; }
 
@@ -462,7 +537,8 @@ private:
 
     /// Merge two segments into one.
     /// After merging, both segments will be abandoned (with `segment->hasAbandoned() == true`).
-    void segmentMerge(DMContext & dm_context, const SegmentPtr & left, const SegmentPtr & right, bool is_foreground);
+    /// Merge the consecutive segments in `ordered_segments` into one.
+    void segmentMerge(DMContext & dm_context, const Segments & ordered_segments, bool is_foreground);
 
     /// Merge the delta (major compaction) in the segment.
     /// After delta-merging, the segment will be abandoned (with `segment->hasAbandoned() == true`) and a new segment will be returned.
@@ -477,11 +553,11 @@ private:
     bool handleBackgroundTask(bool heavy);
 
     // isSegmentValid should be protected by lock on `read_write_mutex`
-    inline bool isSegmentValid(std::shared_lock<std::shared_mutex> &, const SegmentPtr & segment)
+    inline bool isSegmentValid(std::shared_lock<ProfilingSharedMutex> &, const SegmentPtr & segment)
     {
         return doIsSegmentValid(segment);
     }
-    inline bool isSegmentValid(std::unique_lock<std::shared_mutex> &, const SegmentPtr & segment)
+    inline bool isSegmentValid(std::unique_lock<ProfilingSharedMutex> &, const SegmentPtr & segment)
     {
         return doIsSegmentValid(segment);
     }
@@ -545,7 +621,7 @@ public:
     RowKeyValue next_gc_check_key;
 
     // Synchronize between write threads and read threads.
-    mutable std::shared_mutex read_write_mutex;
+    mutable ProfilingSharedMutex read_write_mutex{ProfilingLockType::DeltaMergeStore};
 
     UInt64 hash_salt;
 
@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <queue>
 
 namespace DB
@@ -775,6 +776,11 @@ private:
 
     Poco::Logger * log = nullptr;
 
+    /// The compacted entries are cached until the tree is modified. A delta tree shared by delta indexes is
+    /// immutable, so the concurrent reads on it build the compacted entries only once.
+    std::mutex compacted_entries_mutex;
+    CompactedEntriesPtr compacted_entries;
+
 public:
     // For test cases only.
     ValueSpacePtr insert_value_space;
@@ -782,6 +788,12 @@ public:
 private:
     inline bool isRootOnly() const { return height == 1; }
 
+    void resetCompactedEntries()
+    {
+        std::scoped_lock lock(compacted_entries_mutex);
+        compacted_entries.reset();
+    }
+
     void check(NodePtr node, bool recursive) const;
 
     template <bool is_rid, bool is_left>
@@ -933,6 +945,9 @@ public:
         std::swap(allocator, allocator);
 
         insert_value_space.swap(other.insert_value_space);
+
+        resetCompactedEntries();
+        other.resetCompactedEntries();
     }
 
     ~DeltaTree()
@@ -982,7 +997,14 @@ public:
         return std::make_shared<DTEntriesCopy<M, F, S, CopyAllocator>>(left_leaf, num_entries, delta);
     }
 
-    CompactedEntriesPtr getCompactedEntries() { return std::make_shared<CompactedEntries>(begin(), end(), num_entries); }
+    /// The returned entries are shared by the callers and should not be modified.
+    CompactedEntriesPtr getCompactedEntries()
+    {
+        std::scoped_lock lock(compacted_entries_mutex);
+        if (!compacted_entries)
+            compacted_entries = std::make_shared<CompactedEntries>(begin(), end(), num_entries);
+        return compacted_entries;
+    }
 
     size_t numEntries() const { return num_entries; }
     size_t numInserts() const { return num_inserts; }
@@ -1124,6 +1146,7 @@ DT_TEMPLATE
 void DT_CLASS::addDelete(const UInt64 rid)
 {
     checkId(rid);
+    resetCompactedEntries();
 
     EntryIterator leaf_end(this->end());
     auto it = findRightLeaf<true>(rid);
@@ -1192,6 +1215,7 @@ void DT_CLASS::addInsert(const UInt64 rid, const UInt64 tuple_id)
 {
     checkId(rid);
     checkId(tuple_id);
+    resetCompactedEntries();
 
     EntryIterator leaf_end(this->end());
     auto it = findRightLeaf<true>(rid);
@@ -1244,6 +1268,7 @@ void DT_CLASS::removeInsertsStartFrom(UInt64 tuple_id_start)
 DT_TEMPLATE
 void DT_CLASS::updateTupleId(const TupleRefs & tuple_refs, size_t offset)
 {
+    resetCompactedEntries();
     size_t tuple_id_end = offset + tuple_refs.size();
     for (EntryIterator entry_it(this->begin()), entry_end(this->end()); entry_it != entry_end; ++entry_it)
     {
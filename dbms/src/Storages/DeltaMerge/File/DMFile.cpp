@@ -54,6 +54,8 @@ inline constexpr static const char * FOLDER_PREFIX_DROPPED = ".del.dmf_";
 inline constexpr static const char * DATA_FILE_SUFFIX = ".dat";
 inline constexpr static const char * INDEX_FILE_SUFFIX = ".idx";
 inline constexpr static const char * MARK_FILE_SUFFIX = ".mrk";
+inline constexpr static const char * BLOOM_FILTER_FILE_SUFFIX = ".bf";
+inline constexpr static const char * NDV_SKETCH_FILE_SUFFIX = ".ndv";
 
 inline String getNGCPath(const String & prefix, bool is_single_mode)
 {
@@ -194,6 +196,18 @@ String DMFile::colMarkCacheKey(const FileNameBase & file_name_base) const
     }
 }
 
+String DMFile::colBloomFilterCacheKey(const FileNameBase & file_name_base) const
+{
+    if (isSingleFileMode())
+    {
+        return path() + "/" + DMFile::colBloomFilterFileName(file_name_base);
+    }
+    else
+    {
+        return colBloomFilterPath(file_name_base);
+    }
+}
+
 bool DMFile::isColIndexExist(const ColId & col_id) const
 {
     if (isSingleFileMode())
@@ -207,6 +221,32 @@ bool DMFile::isColIndexExist(const ColId & col_id) const
     }
 }
 
+bool DMFile::isColBloomFilterExist(const ColId & col_id) const
+{
+    if (isSingleFileMode())
+    {
+        const auto bloom_filter_identifier = DMFile::colBloomFilterFileName(DMFile::getFileNameBase(col_id));
+        return isSubFileExists(bloom_filter_identifier);
+    }
+    else
+    {
+        return column_bloom_filters.count(col_id) != 0;
+    }
+}
+
+bool DMFile::isColNDVSketchExist(const ColId & col_id) const
+{
+    if (isSingleFileMode())
+    {
+        const auto ndv_sketch_identifier = DMFile::colNDVSketchFileName(DMFile::getFileNameBase(col_id));
+        return isSubFileExists(ndv_sketch_identifier);
+    }
+    else
+    {
+        return column_ndv_sketches.count(col_id) != 0;
+    }
+}
+
 String DMFile::encryptionBasePath() const
 {
     return getPathByStatus(parent_path, file_id, DMFile::Status::READABLE);
@@ -228,6 +268,16 @@ EncryptionPath DMFile::encryptionMarkPath(const FileNameBase & file_name_base) c
     return EncryptionPath(encryptionBasePath(), isSingleFileMode() ? "" : file_name_base + details::MARK_FILE_SUFFIX);
 }
 
+EncryptionPath DMFile::encryptionBloomFilterPath(const FileNameBase & file_name_base) const
+{
+    return EncryptionPath(encryptionBasePath(), isSingleFileMode() ? "" : file_name_base + details::BLOOM_FILTER_FILE_SUFFIX);
+}
+
+EncryptionPath DMFile::encryptionNDVSketchPath(const FileNameBase & file_name_base) const
+{
+    return EncryptionPath(encryptionBasePath(), isSingleFileMode() ? "" : file_name_base + details::NDV_SKETCH_FILE_SUFFIX);
+}
+
 EncryptionPath DMFile::encryptionMetaPath() const
 {
     return EncryptionPath(encryptionBasePath(), isSingleFileMode() ? "" : metaFileName());
@@ -260,6 +310,14 @@ String DMFile::colMarkFileName(const FileNameBase & file_name_base)
 {
     return file_name_base + details::MARK_FILE_SUFFIX;
 }
+String DMFile::colBloomFilterFileName(const FileNameBase & file_name_base)
+{
+    return file_name_base + details::BLOOM_FILTER_FILE_SUFFIX;
+}
+String DMFile::colNDVSketchFileName(const FileNameBase & file_name_base)
+{
+    return file_name_base + details::NDV_SKETCH_FILE_SUFFIX;
+}
 
 DMFile::OffsetAndSize DMFile::writeMetaToBuffer(WriteBuffer & buffer)
 {
@@ -856,6 +914,14 @@ void DMFile::initializeIndices()
         {
             column_indices.insert(decode(removeSuffix(name, strlen(details::INDEX_FILE_SUFFIX)))); // strip tailing `.idx`
         }
+        else if (endsWith(name, details::BLOOM_FILTER_FILE_SUFFIX))
+        {
+            column_bloom_filters.insert(decode(removeSuffix(name, strlen(details::BLOOM_FILTER_FILE_SUFFIX)))); // strip tailing `.bf`
+        }
+        else if (endsWith(name, details::NDV_SKETCH_FILE_SUFFIX))
+        {
+            column_ndv_sketches.insert(decode(removeSuffix(name, strlen(details::NDV_SKETCH_FILE_SUFFIX)))); // strip tailing `.ndv`
+        }
     }
 }
 
@@ -26,9 +26,13 @@
 #include <Storages/DeltaMerge/ColumnStat.h>
 #include <Storages/DeltaMerge/DMChecksumConfig.h>
 #include <Storages/DeltaMerge/DeltaMergeDefines.h>
+#include <Storages/DeltaMerge/Index/RSResult.h>
 #include <Storages/FormatVersion.h>
 #include <common/logger_useful.h>
 
+#include <list>
+#include <mutex>
+
 namespace DB::DM
 {
 class DMFile;
@@ -39,6 +43,7 @@ struct MigrateArgs;
 bool isRecognizable(const DB::DM::DMFile & file, const std::string & target);
 bool needFrameMigration(const DB::DM::DMFile & file, const std::string & target);
 int migrateServiceMain(DB::Context & context, const MigrateArgs & args);
+size_t migrateFile(DB::Context & context, const MigrateArgs & args, size_t file_id, const DB::WriteLimiterPtr & io_limiter);
 } // namespace DTTool::Migrate
 
 namespace DB
@@ -322,22 +327,33 @@ private:
     String colDataPath(const FileNameBase & file_name_base) const { return subFilePath(colDataFileName(file_name_base)); }
     String colIndexPath(const FileNameBase & file_name_base) const { return subFilePath(colIndexFileName(file_name_base)); }
     String colMarkPath(const FileNameBase & file_name_base) const { return subFilePath(colMarkFileName(file_name_base)); }
+    String colBloomFilterPath(const FileNameBase & file_name_base) const { return subFilePath(colBloomFilterFileName(file_name_base)); }
+    String colNDVSketchPath(const FileNameBase & file_name_base) const { return subFilePath(colNDVSketchFileName(file_name_base)); }
 
     String colIndexCacheKey(const FileNameBase & file_name_base) const;
     String colMarkCacheKey(const FileNameBase & file_name_base) const;
+    String colBloomFilterCacheKey(const FileNameBase & file_name_base) const;
 
     size_t colIndexOffset(const FileNameBase & file_name_base) const { return subFileOffset(colIndexFileName(file_name_base)); }
     size_t colMarkOffset(const FileNameBase & file_name_base) const { return subFileOffset(colMarkFileName(file_name_base)); }
+    size_t colBloomFilterOffset(const FileNameBase & file_name_base) const { return subFileOffset(colBloomFilterFileName(file_name_base)); }
+    size_t colNDVSketchOffset(const FileNameBase & file_name_base) const { return subFileOffset(colNDVSketchFileName(file_name_base)); }
     size_t colIndexSize(const FileNameBase & file_name_base) const { return subFileSize(colIndexFileName(file_name_base)); }
     size_t colMarkSize(const FileNameBase & file_name_base) const { return subFileSize(colMarkFileName(file_name_base)); }
     size_t colDataSize(const FileNameBase & file_name_base) const { return subFileSize(colDataFileName(file_name_base)); }
+    size_t colBloomFilterSize(const FileNameBase & file_name_base) const { return subFileSize(colBloomFilterFileName(file_name_base)); }
+    size_t colNDVSketchSize(const FileNameBase & file_name_base) const { return subFileSize(colNDVSketchFileName(file_name_base)); }
 
     bool isColIndexExist(const ColId & col_id) const;
+    bool isColBloomFilterExist(const ColId & col_id) const;
+    bool isColNDVSketchExist(const ColId & col_id) const;
 
     String encryptionBasePath() const;
     EncryptionPath encryptionDataPath(const FileNameBase & file_name_base) const;
     EncryptionPath encryptionIndexPath(const FileNameBase & file_name_base) const;
     EncryptionPath encryptionMarkPath(const FileNameBase & file_name_base) const;
+    EncryptionPath encryptionBloomFilterPath(const FileNameBase & file_name_base) const;
+    EncryptionPath encryptionNDVSketchPath(const FileNameBase & file_name_base) const;
     EncryptionPath encryptionMetaPath() const;
     EncryptionPath encryptionPackStatPath() const;
     EncryptionPath encryptionPackPropertyPath() const;
@@ -356,6 +372,8 @@ private:
     static String colDataFileName(const FileNameBase & file_name_base);
     static String colIndexFileName(const FileNameBase & file_name_base);
     static String colMarkFileName(const FileNameBase & file_name_base);
+    static String colBloomFilterFileName(const FileNameBase & file_name_base);
+    static String colNDVSketchFileName(const FileNameBase & file_name_base);
 
     using OffsetAndSize = std::tuple<size_t, size_t>;
     OffsetAndSize writeMetaToBuffer(WriteBuffer & buffer);
@@ -409,6 +427,8 @@ private:
     PackProperties pack_properties;
     ColumnStats column_stats;
     std::unordered_set<ColId> column_indices;
+    std::unordered_set<ColId> column_bloom_filters;
+    std::unordered_set<ColId> column_ndv_sketches;
 
     Mode mode;
     Status status;
@@ -416,6 +436,11 @@ private:
 
     SubFileStats sub_file_stats;
 
+    // The rough set results of the recently checked filters on all the packs, keyed by the digest of the filter.
+    // The DMFile is immutable once it is readable, so the results could be reused by the later reads. See `DMFilePackFilter`.
+    std::mutex rs_results_mutex;
+    std::list<std::pair<String, std::shared_ptr<const RSResults>>> rs_results;
+
     Poco::Logger * log;
 
     friend class DMFileWriter;
@@ -423,6 +448,7 @@ private:
     friend class DMFilePackFilter;
     friend class DMFileBlockInputStreamBuilder;
     friend int ::DTTool::Migrate::migrateServiceMain(DB::Context & context, const ::DTTool::Migrate::MigrateArgs & args);
+    friend size_t ::DTTool::Migrate::migrateFile(DB::Context & context, const ::DTTool::Migrate::MigrateArgs & args, size_t file_id, const DB::WriteLimiterPtr & io_limiter);
     friend bool ::DTTool::Migrate::isRecognizable(const DB::DM::DMFile & file, const std::string & target);
     friend bool ::DTTool::Migrate::needFrameMigration(const DB::DM::DMFile & file, const std::string & target);
 };
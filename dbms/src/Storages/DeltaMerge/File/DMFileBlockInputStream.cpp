@@ -14,6 +14,7 @@
 
 #include <Interpreters/Context.h>
 #include <Storages/DeltaMerge/File/DMFileBlockInputStream.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
 
 namespace DB::DM
 {
@@ -24,6 +25,8 @@ DMFileBlockInputStreamBuilder::DMFileBlockInputStreamBuilder(const Context & con
     // init from global context
     const auto & global_context = context.getGlobalContext();
     setCaches(global_context.getMarkCache(), global_context.getMinMaxIndexCache());
+    bloom_filter_cache = global_context.getBloomFilterIndexCache();
+    decompressed_block_cache = global_context.getDecompressedBlockCache();
     // init from settings
     setFromSettings(context.getSettingsRef());
 }
@@ -45,16 +48,22 @@ DMFileBlockInputStreamPtr DMFileBlockInputStreamBuilder::build(const DMFilePtr &
 
     bool is_common_handle = !rowkey_ranges.empty() && rowkey_ranges[0].is_common_handle;
 
-    DMFilePackFilter pack_filter = DMFilePackFilter::loadFrom(
-        dmfile,
-        index_cache,
-        /*set_cache_if_miss*/ true,
-        rowkey_ranges,
-        rs_filter,
-        read_packs,
-        file_provider,
-        read_limiter,
-        tracing_id);
+    DMFilePackFilter pack_filter = [&] {
+        ReadStageTimer timer(ReadStage::RoughSetFilter);
+        return DMFilePackFilter::loadFrom(
+            dmfile,
+            index_cache,
+            bloom_filter_cache,
+            /*set_cache_if_miss*/ true,
+            rowkey_ranges,
+            rs_filter,
+            read_packs,
+            file_provider,
+            read_limiter,
+            tracing_id,
+            use_mmap_mark_and_index,
+            rs_result_cache_entries);
+    }();
 
     bool enable_read_thread = SegmentReaderPoolManager::instance().isSegmentReader();
 
@@ -66,6 +75,7 @@ DMFileBlockInputStreamPtr DMFileBlockInputStreamBuilder::build(const DMFilePtr &
         is_fast_mode,
         max_data_version,
         std::move(pack_filter),
+        late_materialization_filter,
         mark_cache,
         enable_column_cache,
         column_cache,
@@ -76,7 +86,17 @@ DMFileBlockInputStreamPtr DMFileBlockInputStreamBuilder::build(const DMFilePtr &
         rows_threshold_per_read,
         read_one_pack_every_time,
         tracing_id,
-        enable_read_thread);
+        enable_read_thread,
+        enable_read_thread && enable_cooperative_scan,
+        io_uring_prefetch_packs,
+        read_ahead_packs,
+        read_ahead_bytes,
+        read_rows_only,
+        decompressed_block_cache,
+        decompressed_block_cache_max_column_bytes,
+        single_file_read_plan_packs,
+        single_file_read_merge_gap_bytes,
+        use_mmap_mark_and_index);
 
     return std::make_shared<DMFileBlockInputStream>(std::move(reader), enable_read_thread);
 }
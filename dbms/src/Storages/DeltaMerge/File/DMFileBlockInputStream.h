@@ -67,7 +67,7 @@ class DMFileBlockInputStreamBuilder
 public:
     // Construct a builder by `context`.
     // It implicitly set the params by
-    // - mark cache and min-max-index cache from global context
+    // - mark cache, min-max-index cache and decompressed block cache from global context
     // - current settings from this context
     // - current read limiter form this context
     // - current file provider from this context
@@ -104,6 +104,21 @@ public:
         return *this;
     }
 
+    // Filter applied on the clean read blocks before reading the columns not required by the filter.
+    // Set it to nullptr to disable late materialization.
+    DMFileBlockInputStreamBuilder & setLateMaterializationFilter(const LateMaterializationFilterPtr & late_materialization_filter_)
+    {
+        late_materialization_filter = late_materialization_filter_;
+        return *this;
+    }
+
+    // Only the row count of the result is used. Only set it with clean read, see `DMFileReader`.
+    DMFileBlockInputStreamBuilder & setReadRowsOnly(bool read_rows_only_)
+    {
+        read_rows_only = read_rows_only_;
+        return *this;
+    }
+
     DMFileBlockInputStreamBuilder & setReadPacks(const IdSetPtr & read_packs_)
     {
         read_packs = read_packs_;
@@ -143,6 +158,15 @@ private:
         aio_threshold = settings.min_bytes_to_use_direct_io;
         max_read_buffer_size = settings.max_read_buffer_size;
         enable_read_thread = settings.dt_enable_read_thread;
+        enable_cooperative_scan = settings.dt_enable_cooperative_scan;
+        io_uring_prefetch_packs = settings.dt_io_uring_prefetch_packs;
+        read_ahead_packs = settings.dt_read_ahead_packs;
+        read_ahead_bytes = settings.dt_read_ahead_bytes;
+        decompressed_block_cache_max_column_bytes = settings.dt_decompressed_block_cache_max_column_bytes;
+        single_file_read_plan_packs = settings.dt_single_file_read_plan_packs;
+        single_file_read_merge_gap_bytes = settings.dt_single_file_read_merge_gap_bytes;
+        use_mmap_mark_and_index = settings.dt_enable_mmap_mark_and_index;
+        rs_result_cache_entries = settings.dt_rough_set_result_cache_per_file;
         return *this;
     }
     DMFileBlockInputStreamBuilder & setCaches(const MarkCachePtr & mark_cache_, const MinMaxIndexCachePtr & index_cache_)
@@ -161,10 +185,14 @@ private:
     UInt64 max_data_version = std::numeric_limits<UInt64>::max();
     // Rough set filter
     RSOperatorPtr rs_filter;
+    // Pushed down filter for late materialization
+    LateMaterializationFilterPtr late_materialization_filter;
+    bool read_rows_only = false;
     // packs filter (filter by pack index)
     IdSetPtr read_packs;
     MarkCachePtr mark_cache;
     MinMaxIndexCachePtr index_cache;
+    BloomFilterIndexCachePtr bloom_filter_cache;
     // column cache
     bool enable_column_cache = false;
     ColumnCachePtr column_cache;
@@ -174,6 +202,16 @@ private:
     size_t rows_threshold_per_read = DMFILE_READ_ROWS_THRESHOLD;
     bool read_one_pack_every_time = false;
     bool enable_read_thread = false;
+    bool enable_cooperative_scan = false;
+    size_t io_uring_prefetch_packs = 0;
+    size_t read_ahead_packs = 0;
+    size_t read_ahead_bytes = 0;
+    DecompressedBlockCachePtr decompressed_block_cache;
+    size_t decompressed_block_cache_max_column_bytes = 0;
+    size_t single_file_read_plan_packs = 0;
+    size_t single_file_read_merge_gap_bytes = 0;
+    bool use_mmap_mark_and_index = false;
+    size_t rs_result_cache_entries = 0;
     String tracing_id;
 };
 
@@ -16,6 +16,7 @@
 
 #include <Core/Block.h>
 #include <Interpreters/Context.h>
+#include <Poco/StringTokenizer.h>
 #include <Storages/DeltaMerge/File/DMFileWriter.h>
 
 namespace DB
@@ -43,11 +44,7 @@ public:
             write_columns,
             context.getFileProvider(),
             context.getWriteLimiter(),
-            DMFileWriter::Options{
-                CompressionSettings(context.getSettingsRef().dt_compression_method, context.getSettingsRef().dt_compression_level),
-                context.getSettingsRef().min_compress_block_size,
-                context.getSettingsRef().max_compress_block_size,
-                flags})
+            buildOptions(context.getSettingsRef(), write_columns, flags))
     {
     }
 
@@ -60,7 +57,47 @@ public:
 
     void writeSuffix() { writer.finalize(); }
 
+    // Only for `Flags::isVertical`, see `DMFileWriter::beginColumnGroup`.
+    void beginColumnGroup(const ColumnDefines & group_columns) { writer.beginColumnGroup(group_columns); }
+    void endColumnGroup() { writer.endColumnGroup(); }
+
 private:
+    static DMFileWriter::Options buildOptions(const Settings & settings, const ColumnDefines & write_columns, const Flags flags)
+    {
+        DMFileWriter::Options options{
+            CompressionSettings(settings.dt_compression_method, settings.dt_compression_level),
+            settings.min_compress_block_size,
+            settings.max_compress_block_size,
+            flags};
+
+        const String & bloom_filter_columns = settings.dt_bloom_filter_index_columns;
+        if (!bloom_filter_columns.empty())
+        {
+            Poco::StringTokenizer tokens(bloom_filter_columns, ",", Poco::StringTokenizer::TOK_TRIM | Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+            std::unordered_set<String> names(tokens.begin(), tokens.end());
+            for (const auto & cd : write_columns)
+            {
+                if (names.count(cd.name))
+                    options.bloom_filter_columns.insert(cd.id);
+            }
+            options.bloom_filter_bits_per_key = std::max<UInt64>(1, settings.dt_bloom_filter_bits_per_key);
+        }
+
+        const String & delta_for_columns = settings.dt_delta_for_compression_columns;
+        if (!delta_for_columns.empty())
+        {
+            Poco::StringTokenizer tokens(delta_for_columns, ",", Poco::StringTokenizer::TOK_TRIM | Poco::StringTokenizer::TOK_IGNORE_EMPTY);
+            std::unordered_set<String> names(tokens.begin(), tokens.end());
+            for (const auto & cd : write_columns)
+            {
+                if (names.count(cd.name))
+                    options.delta_for_columns.insert(cd.id);
+            }
+        }
+        options.build_ndv_sketch = settings.dt_enable_ndv_sketch;
+        return options;
+    }
+
     DMFileWriter writer;
 };
 
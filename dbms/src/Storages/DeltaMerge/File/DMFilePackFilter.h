@@ -16,12 +16,16 @@
 
 #include <Common/Exception.h>
 #include <Common/Logger.h>
+#include <Common/TiFlashException.h>
 #include <Common/TiFlashMetrics.h>
+#include <Encryption/MMapRandomAccessFile.h>
 #include <Encryption/ReadBufferFromFileProvider.h>
 #include <Encryption/createReadBufferFromFileBaseByFileProvider.h>
+#include <IO/ReadBufferFromMemory.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
 #include <Storages/DeltaMerge/Filter/FilterHelper.h>
 #include <Storages/DeltaMerge/Filter/RSOperator.h>
+#include <Storages/DeltaMerge/Index/BloomFilterIndex.h>
 #include <Storages/DeltaMerge/RowKeyRange.h>
 
 namespace ProfileEvents
@@ -44,15 +48,20 @@ public:
     static DMFilePackFilter loadFrom(
         const DMFilePtr & dmfile,
         const MinMaxIndexCachePtr & index_cache,
+        const BloomFilterIndexCachePtr & bloom_filter_cache,
         bool set_cache_if_miss,
         const RowKeyRanges & rowkey_ranges,
         const RSOperatorPtr & filter,
         const IdSetPtr & read_packs,
         const FileProviderPtr & file_provider,
         const ReadLimiterPtr & read_limiter,
-        const String & tracing_id)
+        const String & tracing_id,
+        // Read the min-max indexes from the memory mapped files, see `dt_enable_mmap_mark_and_index`
+        bool use_mmap = false,
+        // Cache the results of `filter` in the DMFile, see `dt_rough_set_result_cache_per_file`
+        size_t rs_result_cache_entries = 0)
     {
-        auto pack_filter = DMFilePackFilter(dmfile, index_cache, set_cache_if_miss, rowkey_ranges, filter, read_packs, file_provider, read_limiter, tracing_id);
+        auto pack_filter = DMFilePackFilter(dmfile, index_cache, bloom_filter_cache, set_cache_if_miss, rowkey_ranges, filter, read_packs, file_provider, read_limiter, tracing_id, use_mmap, rs_result_cache_entries);
         pack_filter.init();
         return pack_filter;
     }
@@ -76,6 +85,14 @@ public:
         return minmax_index->getStringMinMax(pack_id).first;
     }
 
+    // Return nullptr if the column has no min-max index in this file
+    MinMaxIndexPtr getMinMaxIndex(ColId col_id)
+    {
+        tryLoadIndex(col_id);
+        auto iter = param.indexes.find(col_id);
+        return iter == param.indexes.end() ? nullptr : iter->second.minmax;
+    }
+
     UInt64 getMaxVersion(size_t pack_id)
     {
         if (!param.indexes.count(VERSION_COLUMN_ID))
@@ -104,15 +121,19 @@ public:
 private:
     DMFilePackFilter(const DMFilePtr & dmfile_,
                      const MinMaxIndexCachePtr & index_cache_,
+                     const BloomFilterIndexCachePtr & bloom_filter_cache_,
                      bool set_cache_if_miss_,
                      const RowKeyRanges & rowkey_ranges_, // filter by handle range
                      const RSOperatorPtr & filter_, // filter by push down where clause
                      const IdSetPtr & read_packs_, // filter by pack index
                      const FileProviderPtr & file_provider_,
                      const ReadLimiterPtr & read_limiter_,
-                     const String & tracing_id)
+                     const String & tracing_id,
+                     bool use_mmap_,
+                     size_t rs_result_cache_entries_)
         : dmfile(dmfile_)
         , index_cache(index_cache_)
+        , bloom_filter_cache(bloom_filter_cache_)
         , set_cache_if_miss(set_cache_if_miss_)
         , rowkey_ranges(rowkey_ranges_)
         , filter(filter_)
@@ -122,6 +143,8 @@ private:
         , use_packs(dmfile->getPacks())
         , log(Logger::get("DMFilePackFilter", tracing_id))
         , read_limiter(read_limiter_)
+        , use_mmap(use_mmap_)
+        , rs_result_cache_entries(rs_result_cache_entries_)
     {
     }
 
@@ -139,15 +162,8 @@ private:
             {
                 handle_res[i] = RSResult::None;
             }
-            for (size_t i = 0; i < pack_count; ++i)
-            {
-                for (auto & handle_filter : handle_filters)
-                {
-                    handle_res[i] = handle_res[i] || handle_filter->roughCheck(i, param);
-                    if (handle_res[i] == RSResult::All)
-                        break;
-                }
-            }
+            for (auto & handle_filter : handle_filters)
+                batchOr(handle_res, handle_filter->batchRoughCheck(0, pack_count, param));
         }
 
         ProfileEvents::increment(ProfileEvents::DMFileFilterNoFilter, pack_count);
@@ -182,16 +198,10 @@ private:
         /// Check packs by filter in where clause
         if (filter)
         {
-            // Load index based on filter.
-            Attrs attrs = filter->getAttrs();
-            for (auto & attr : attrs)
-            {
-                tryLoadIndex(attr.col_id);
-            }
-
+            auto filter_res = checkFilter(pack_count);
             for (size_t i = 0; i < pack_count; ++i)
             {
-                use_packs[i] = (static_cast<bool>(use_packs[i])) && (filter->roughCheck(i, param) != None);
+                use_packs[i] = (static_cast<bool>(use_packs[i])) && ((*filter_res)[i] != None);
             }
         }
 
@@ -223,7 +233,8 @@ private:
                           const MinMaxIndexCachePtr & index_cache,
                           bool set_cache_if_miss,
                           ColId col_id,
-                          const ReadLimiterPtr & read_limiter)
+                          const ReadLimiterPtr & read_limiter,
+                          bool use_mmap)
     {
         const auto & type = dmfile->getColumnStat(col_id).type;
         const auto file_name_base = DMFile::getFileNameBase(col_id);
@@ -232,7 +243,22 @@ private:
             auto index_file_size = dmfile->colIndexSize(file_name_base);
             if (index_file_size == 0)
                 return std::make_shared<MinMaxIndex>(*type);
-            if (!dmfile->configuration)
+            // The index files of single file mode are the merged data files, which are not small.
+            MMapRandomAccessFilePtr mapped_file;
+            if (use_mmap && !dmfile->isSingleFileMode())
+                mapped_file = file_provider->newMMapRandomAccessFile(dmfile->colIndexPath(file_name_base), dmfile->encryptionIndexPath(file_name_base), read_limiter);
+            if (!dmfile->configuration && mapped_file)
+            {
+                // Deserialize the index from the mapped memory directly.
+                auto index_offset = dmfile->colIndexOffset(file_name_base);
+                if (unlikely(mapped_file->size() < index_offset + index_file_size))
+                    throw TiFlashException(
+                        fmt::format("Bad DMFile format, expected index file size: {} vs. actual: {}", index_offset + index_file_size, mapped_file->size()),
+                        Errors::DeltaTree::Internal);
+                ReadBufferFromMemory index_buf(mapped_file->data() + index_offset, index_file_size);
+                return MinMaxIndex::read(*type, index_buf, index_file_size);
+            }
+            else if (!dmfile->configuration)
             {
                 auto index_buf = ReadBufferFromFileProvider(
                     file_provider,
@@ -245,13 +271,18 @@ private:
             }
             else
             {
-                auto index_buf = createReadBufferFromFileBaseByFileProvider(file_provider,
-                                                                            dmfile->colIndexPath(file_name_base),
-                                                                            dmfile->encryptionIndexPath(file_name_base),
-                                                                            dmfile->colIndexSize(file_name_base),
-                                                                            read_limiter,
-                                                                            dmfile->configuration->getChecksumAlgorithm(),
-                                                                            dmfile->configuration->getChecksumFrameLength());
+                auto index_buf = mapped_file
+                    ? createReadBufferFromFileBaseByFileProvider(mapped_file,
+                                                                 dmfile->colIndexSize(file_name_base),
+                                                                 dmfile->configuration->getChecksumAlgorithm(),
+                                                                 dmfile->configuration->getChecksumFrameLength())
+                    : createReadBufferFromFileBaseByFileProvider(file_provider,
+                                                                 dmfile->colIndexPath(file_name_base),
+                                                                 dmfile->encryptionIndexPath(file_name_base),
+                                                                 dmfile->colIndexSize(file_name_base),
+                                                                 read_limiter,
+                                                                 dmfile->configuration->getChecksumAlgorithm(),
+                                                                 dmfile->configuration->getChecksumFrameLength());
                 index_buf->seek(dmfile->colIndexOffset(file_name_base));
                 auto header_size = dmfile->configuration->getChecksumHeaderLength();
                 auto frame_total_size = dmfile->configuration->getChecksumFrameLength() + header_size;
@@ -275,6 +306,107 @@ private:
         indexes.emplace(col_id, RSIndex(type, minmax_index));
     }
 
+    static BloomFilterIndexPtr loadBloomFilter(const DMFilePtr & dmfile,
+                                               const FileProviderPtr & file_provider,
+                                               const BloomFilterIndexCachePtr & bloom_filter_cache,
+                                               bool set_cache_if_miss,
+                                               ColId col_id,
+                                               const ReadLimiterPtr & read_limiter)
+    {
+        const auto file_name_base = DMFile::getFileNameBase(col_id);
+
+        auto load = [&]() {
+            auto file_size = dmfile->colBloomFilterSize(file_name_base);
+            if (!dmfile->configuration)
+            {
+                auto buf = ReadBufferFromFileProvider(
+                    file_provider,
+                    dmfile->colBloomFilterPath(file_name_base),
+                    dmfile->encryptionBloomFilterPath(file_name_base),
+                    std::min(static_cast<size_t>(DBMS_DEFAULT_BUFFER_SIZE), file_size),
+                    read_limiter);
+                buf.seek(dmfile->colBloomFilterOffset(file_name_base));
+                return BloomFilterIndex::read(buf, file_size);
+            }
+            else
+            {
+                auto buf = createReadBufferFromFileBaseByFileProvider(file_provider,
+                                                                      dmfile->colBloomFilterPath(file_name_base),
+                                                                      dmfile->encryptionBloomFilterPath(file_name_base),
+                                                                      file_size,
+                                                                      read_limiter,
+                                                                      dmfile->configuration->getChecksumAlgorithm(),
+                                                                      dmfile->configuration->getChecksumFrameLength());
+                buf->seek(dmfile->colBloomFilterOffset(file_name_base));
+                auto header_size = dmfile->configuration->getChecksumHeaderLength();
+                auto frame_total_size = dmfile->configuration->getChecksumFrameLength() + header_size;
+                auto frame_count = file_size / frame_total_size + (file_size % frame_total_size != 0);
+                return BloomFilterIndex::read(*buf, file_size - header_size * frame_count);
+            }
+        };
+        BloomFilterIndexPtr bloom_filter;
+        if (bloom_filter_cache && set_cache_if_miss)
+        {
+            bloom_filter = bloom_filter_cache->getOrSet(dmfile->colBloomFilterCacheKey(file_name_base), load);
+        }
+        else
+        {
+            if (bloom_filter_cache)
+                bloom_filter = bloom_filter_cache->get(dmfile->colBloomFilterCacheKey(file_name_base));
+            if (!bloom_filter)
+                bloom_filter = load();
+        }
+        return bloom_filter;
+    }
+
+    /// Check all the packs by `filter`. The results only depend on the filter and the DMFile, so they are
+    /// cached in the DMFile and reused by the following reads with the same filter.
+    std::shared_ptr<const RSResults> checkFilter(size_t pack_count)
+    {
+        Attrs attrs = filter->getAttrs();
+
+        String digest;
+        if (rs_result_cache_entries > 0)
+        {
+            // The types are a part of the digest because the indexes of the columns whose type is changed are not used.
+            digest = filter->toDebugString();
+            for (const auto & attr : attrs)
+                digest += "," + attr.type->getName();
+
+            std::lock_guard lock(dmfile->rs_results_mutex);
+            auto & cached = dmfile->rs_results;
+            for (auto iter = cached.begin(); iter != cached.end(); ++iter)
+            {
+                if (iter->first == digest)
+                {
+                    cached.splice(cached.begin(), cached, iter);
+                    return cached.front().second;
+                }
+            }
+        }
+
+        // Load index based on filter.
+        for (auto & attr : attrs)
+        {
+            tryLoadIndex(attr.col_id);
+            tryLoadBloomFilter(attr.col_id);
+        }
+        auto results = std::make_shared<const RSResults>(filter->batchRoughCheck(0, pack_count, param));
+
+        if (rs_result_cache_entries > 0)
+        {
+            std::lock_guard lock(dmfile->rs_results_mutex);
+            auto & cached = dmfile->rs_results;
+            if (std::none_of(cached.begin(), cached.end(), [&](const auto & e) { return e.first == digest; }))
+            {
+                cached.emplace_front(std::move(digest), results);
+                while (cached.size() > rs_result_cache_entries)
+                    cached.pop_back();
+            }
+        }
+        return results;
+    }
+
     void tryLoadIndex(const ColId col_id)
     {
         if (param.indexes.count(col_id))
@@ -283,12 +415,26 @@ private:
         if (!dmfile->isColIndexExist(col_id))
             return;
 
-        loadIndex(param.indexes, dmfile, file_provider, index_cache, set_cache_if_miss, col_id, read_limiter);
+        loadIndex(param.indexes, dmfile, file_provider, index_cache, set_cache_if_miss, col_id, read_limiter, use_mmap);
+    }
+
+    /// Attach the bloom filter to the loaded minmax index of `col_id`, so that RSOperators could check it by `RSIndex::equal`.
+    void tryLoadBloomFilter(const ColId col_id)
+    {
+        auto iter = param.indexes.find(col_id);
+        if (iter == param.indexes.end() || iter->second.equal)
+            return;
+
+        if (!dmfile->isColBloomFilterExist(col_id))
+            return;
+
+        iter->second.equal = loadBloomFilter(dmfile, file_provider, bloom_filter_cache, set_cache_if_miss, col_id, read_limiter);
     }
 
 private:
     DMFilePtr dmfile;
     MinMaxIndexCachePtr index_cache;
+    BloomFilterIndexCachePtr bloom_filter_cache;
     bool set_cache_if_miss;
     RowKeyRanges rowkey_ranges;
     RSOperatorPtr filter;
@@ -302,6 +448,8 @@ private:
 
     LoggerPtr log;
     ReadLimiterPtr read_limiter;
+    bool use_mmap;
+    size_t rs_result_cache_entries;
 };
 
 } // namespace DM
@@ -12,19 +12,27 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Columns/ColumnsCommon.h>
+#include <Columns/FilterDescription.h>
 #include <Common/CurrentMetrics.h>
 #include <Common/escapeForFileName.h>
 #include <DataTypes/IDataType.h>
 #include <Encryption/FileProvider.h>
+#include <Encryption/IOUringRandomAccessFile.h>
 #include <Encryption/createReadBufferFromFileBaseByFileProvider.h>
+#include <IO/CompressedReadBufferBase.h>
 #include <Poco/File.h>
 #include <Storages/DeltaMerge/File/DMFileBlockInputStream.h>
 #include <Storages/DeltaMerge/File/DMFilePackFilter.h>
 #include <Storages/DeltaMerge/File/DMFileReader.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
 #include <Storages/DeltaMerge/convertColumnTypeHelpers.h>
 #include <Storages/Page/PageUtil.h>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <ext/scope_guard.h>
+#include <optional>
 #include <string>
 
 namespace CurrentMetrics
@@ -42,14 +50,15 @@ namespace DM
 {
 DMFileReader::Stream::Stream(
     DMFileReader & reader,
-    ColId col_id,
+    ColId col_id_,
     const String & file_name_base,
     size_t aio_threshold,
     size_t max_read_buffer_size,
     const LoggerPtr & log,
     const ReadLimiterPtr & read_limiter)
     : single_file_mode(reader.single_file_mode)
-    , avg_size_hint(reader.dmfile->getColumnStat(col_id).avg_size)
+    , col_id(col_id_)
+    , avg_size_hint(reader.dmfile->getColumnStat(col_id_).avg_size)
 {
     // load mark data
     if (reader.single_file_mode)
@@ -86,14 +95,26 @@ DMFileReader::Stream::Stream(
             size_t size = sizeof(MarkInCompressedFile) * reader.dmfile->getPacks();
             if (reader.dmfile->configuration)
             {
-                auto buffer = createReadBufferFromFileBaseByFileProvider(
-                    reader.file_provider,
-                    reader.dmfile->colMarkPath(file_name_base),
-                    reader.dmfile->encryptionMarkPath(file_name_base),
-                    reader.dmfile->getConfiguration()->getChecksumFrameLength(),
-                    read_limiter,
-                    reader.dmfile->getConfiguration()->getChecksumAlgorithm(),
-                    reader.dmfile->getConfiguration()->getChecksumFrameLength());
+                // Verify the checksum frames in the mapped memory if possible, which saves the read syscalls.
+                MMapRandomAccessFilePtr mapped_file;
+                if (reader.use_mmap)
+                    mapped_file = reader.file_provider->newMMapRandomAccessFile(reader.dmfile->colMarkPath(file_name_base),
+                                                                                reader.dmfile->encryptionMarkPath(file_name_base),
+                                                                                read_limiter);
+                auto buffer = mapped_file
+                    ? createReadBufferFromFileBaseByFileProvider(
+                        mapped_file,
+                        reader.dmfile->getConfiguration()->getChecksumFrameLength(),
+                        reader.dmfile->getConfiguration()->getChecksumAlgorithm(),
+                        reader.dmfile->getConfiguration()->getChecksumFrameLength())
+                    : createReadBufferFromFileBaseByFileProvider(
+                        reader.file_provider,
+                        reader.dmfile->colMarkPath(file_name_base),
+                        reader.dmfile->encryptionMarkPath(file_name_base),
+                        reader.dmfile->getConfiguration()->getChecksumFrameLength(),
+                        read_limiter,
+                        reader.dmfile->getConfiguration()->getChecksumAlgorithm(),
+                        reader.dmfile->getConfiguration()->getChecksumFrameLength());
                 buffer->readBig(reinterpret_cast<char *>(res->data()), size);
             }
             else
@@ -104,14 +125,32 @@ DMFileReader::Stream::Stream(
             }
             return res;
         };
-        if (reader.mark_cache)
-            marks = reader.mark_cache->getOrSet(reader.dmfile->colMarkCacheKey(file_name_base), mark_load);
-        else
-            marks = mark_load();
+        // The plain marks are used in the mapped memory without copying, they are neither loaded
+        // nor put into the mark cache.
+        if (reader.use_mmap && !reader.dmfile->configuration && reader.dmfile->getPacks() > 0)
+        {
+            mapped_marks = reader.file_provider->newMMapRandomAccessFile(reader.dmfile->colMarkPath(file_name_base),
+                                                                         reader.dmfile->encryptionMarkPath(file_name_base),
+                                                                         read_limiter);
+            if (mapped_marks && unlikely(mapped_marks->size() != sizeof(MarkInCompressedFile) * reader.dmfile->getPacks()))
+            {
+                throw DB::TiFlashException(fmt::format("Bad DMFile format, expected mark file content size: {} vs. actual: {}",
+                                                       sizeof(MarkInCompressedFile) * reader.dmfile->getPacks(),
+                                                       mapped_marks->size()),
+                                           Errors::DeltaTree::Internal);
+            }
+        }
+        if (!mapped_marks)
+        {
+            if (reader.mark_cache)
+                marks = reader.mark_cache->getOrSet(reader.dmfile->colMarkCacheKey(file_name_base), mark_load);
+            else
+                marks = mark_load();
+        }
     }
 
     const String data_path = reader.dmfile->colDataPath(file_name_base);
-    size_t data_file_size = reader.dmfile->colDataSize(file_name_base);
+    data_file_size = reader.dmfile->colDataSize(file_name_base);
     size_t packs = reader.dmfile->getPacks();
     size_t buffer_size = 0;
     size_t estimated_size = 0;
@@ -183,15 +222,27 @@ DMFileReader::Stream::Stream(
                   aio_threshold,
                   max_read_buffer_size);
 
-    if (!reader.dmfile->configuration)
+    const bool use_io_uring = reader.prefetch_packs > 0 && !reader.single_file_mode;
+    // Large scans of the cold columns bypass the page cache, so that they do not evict the pages of PageStorage
+    // and the hot columns, which are read by most of the queries (see `isHotColumn`).
+    const bool use_direct_io = aio_threshold > 0 && estimated_size >= aio_threshold && !use_io_uring && !reader.isHotColumn(col_id);
+    if (use_direct_io)
+        LOG_FMT_TRACE(log, "read by direct io, file: {}, estimated read size: {}", data_path, estimated_size);
+    if (reader.single_file_planner)
+    {
+        // Read the shared data loaded by the planner.
+        buf = std::make_unique<CompressedReadBufferFromFileProvider<true>>(reader.single_file_planner->newFile(), buffer_size);
+    }
+    else if (!reader.dmfile->configuration)
     {
         buf = std::make_unique<CompressedReadBufferFromFileProvider<true>>(reader.file_provider,
                                                                            reader.dmfile->colDataPath(file_name_base),
                                                                            reader.dmfile->encryptionDataPath(file_name_base),
                                                                            estimated_size,
-                                                                           aio_threshold,
+                                                                           use_direct_io ? aio_threshold : 0,
                                                                            read_limiter,
-                                                                           buffer_size);
+                                                                           buffer_size,
+                                                                           use_io_uring);
     }
     else
     {
@@ -202,8 +253,32 @@ DMFileReader::Stream::Stream(
             estimated_size,
             read_limiter,
             reader.dmfile->configuration->getChecksumAlgorithm(),
-            reader.dmfile->configuration->getChecksumFrameLength());
+            reader.dmfile->configuration->getChecksumFrameLength(),
+            use_io_uring,
+            use_direct_io);
     }
+
+    // Only the small and hot columns are admitted into the decompressed block cache, so that a large scan
+    // can not flush it.
+    if (reader.decompressed_block_cache && data_file_size <= reader.decompressed_block_cache_max_column_bytes && reader.isHotColumn(col_id))
+        buf->setDecompressedBlockCache(reader.decompressed_block_cache.get(), data_path);
+}
+
+size_t DMFileReader::Stream::getEndOffsetInFile(size_t end_pack_id) const
+{
+    const size_t packs = reader.dmfile->getPacks();
+    if (end_pack_id < packs && getOffsetInDecompressedBlock(end_pack_id) > 0)
+    {
+        const size_t last_offset_in_file = getOffsetInFile(end_pack_id);
+        while (end_pack_id < packs && getOffsetInFile(end_pack_id) == last_offset_in_file)
+            ++end_pack_id;
+    }
+    return end_pack_id >= packs ? data_file_size : getOffsetInFile(end_pack_id);
+}
+
+inline bool isExtraColumn(const ColumnDefine & cd)
+{
+    return cd.id == EXTRA_HANDLE_COLUMN_ID || cd.id == VERSION_COLUMN_ID || cd.id == TAG_COLUMN_ID;
 }
 
 DMFileReader::DMFileReader(
@@ -216,6 +291,7 @@ DMFileReader::DMFileReader(
     UInt64 max_read_version_,
     // filters
     DMFilePackFilter && pack_filter_,
+    const LateMaterializationFilterPtr & late_materialization_filter_,
     // caches
     const MarkCachePtr & mark_cache_,
     bool enable_column_cache_,
@@ -227,7 +303,17 @@ DMFileReader::DMFileReader(
     size_t rows_threshold_per_read_,
     bool read_one_pack_every_time_,
     const String & tracing_id_,
-    bool enable_col_sharing_cache)
+    bool enable_col_sharing_cache,
+    bool enable_cooperative_scan_,
+    size_t prefetch_packs_,
+    size_t read_ahead_packs_,
+    size_t read_ahead_bytes_,
+    bool read_rows_only_,
+    const DecompressedBlockCachePtr & decompressed_block_cache_,
+    size_t decompressed_block_cache_max_column_bytes_,
+    size_t single_file_read_plan_packs_,
+    size_t single_file_read_merge_gap_bytes_,
+    bool use_mmap_)
     : dmfile(dmfile_)
     , read_columns(read_columns_)
     , is_common_handle(is_common_handle_)
@@ -236,15 +322,33 @@ DMFileReader::DMFileReader(
     , enable_clean_read(enable_clean_read_)
     , is_fast_mode(is_fast_mode_)
     , max_read_version(max_read_version_)
+    , read_rows_only(read_rows_only_)
     , pack_filter(std::move(pack_filter_))
+    , late_materialization_filter(late_materialization_filter_)
     , skip_packs_by_column(read_columns.size(), 0)
     , mark_cache(mark_cache_)
+    , use_mmap(use_mmap_)
     , enable_column_cache(enable_column_cache_ && column_cache_)
     , column_cache(column_cache_)
+    , decompressed_block_cache(decompressed_block_cache_)
+    , decompressed_block_cache_max_column_bytes(decompressed_block_cache_max_column_bytes_)
     , rows_threshold_per_read(rows_threshold_per_read_)
+    , enable_cooperative_scan(enable_cooperative_scan_)
+    , scan_end_pack_id(pack_filter.getUsePacks().size())
+    , prefetch_packs(prefetch_packs_)
+    , read_ahead_packs(read_ahead_packs_)
+    , read_ahead_bytes(read_ahead_bytes_)
+    // The checksum framed single file is read through the frames.
+    , single_file_read_plan_packs((single_file_mode && !dmfile_->configuration) ? single_file_read_plan_packs_ : 0)
     , file_provider(file_provider_)
     , log(Logger::get("DMFileReader", tracing_id_))
 {
+    if (single_file_read_plan_packs > 0)
+    {
+        // All the sub files are in one file, the column streams share one opened file and the loaded data.
+        auto file = file_provider->newRandomAccessFile(dmfile->path(), EncryptionPath(dmfile->encryptionBasePath(), ""));
+        single_file_planner = std::make_shared<DMFileSingleFileReadPlanner>(std::move(file), single_file_read_merge_gap_bytes_, read_limiter);
+    }
     for (const auto & cd : read_columns)
     {
         // New inserted column, will be filled with default value later
@@ -267,6 +371,23 @@ DMFileReader::DMFileReader(
         const auto data_type = dmfile->getColumnStat(cd.id).type;
         data_type->enumerateStreams(callback, {});
     }
+    if (late_materialization_filter)
+    {
+        // All the columns required by the filter must be read and can not be the placeholder columns
+        // of clean read, otherwise we just give up late materialization.
+        for (const auto & filter_cd : late_materialization_filter->filter_columns)
+        {
+            auto iter = std::find_if(read_columns.begin(), read_columns.end(), [&](const ColumnDefine & cd) { return cd.id == filter_cd.id; });
+            if (iter == read_columns.end() || isExtraColumn(*iter))
+            {
+                LOG_FMT_DEBUG(log, "Disable late materialization because column [id: {}, name: {}] can not be read in advance", filter_cd.id, filter_cd.name);
+                late_materialization_filter = nullptr;
+                late_materialization_column_indices.clear();
+                break;
+            }
+            late_materialization_column_indices.push_back(iter - read_columns.begin());
+        }
+    }
     if (enable_col_sharing_cache)
     {
         col_data_cache = std::make_unique<ColumnSharingCacheMap>(path(), read_columns, log);
@@ -277,6 +398,20 @@ DMFileReader::DMFileReader(
     }
 }
 
+bool DMFileReader::isHotColumn(ColId col_id) const
+{
+    // The key columns are read by almost every query of this DMFile.
+    if (col_id == EXTRA_HANDLE_COLUMN_ID || col_id == VERSION_COLUMN_ID || col_id == TAG_COLUMN_ID)
+        return true;
+    // The filter columns are read before other columns.
+    if (late_materialization_filter)
+    {
+        const auto & filter_columns = late_materialization_filter->filter_columns;
+        return std::any_of(filter_columns.begin(), filter_columns.end(), [&](const ColumnDefine & cd) { return cd.id == col_id; });
+    }
+    return false;
+}
+
 bool DMFileReader::shouldSeek(size_t pack_id)
 {
     // If current pack is the first one, or we just finished reading the last pack, then no need to seek.
@@ -288,16 +423,148 @@ bool DMFileReader::getSkippedRows(size_t & skip_rows)
     skip_rows = 0;
     const auto & use_packs = pack_filter.getUsePacks();
     const auto & pack_stats = dmfile->getPackStats();
-    for (; next_pack_id < use_packs.size() && !use_packs[next_pack_id]; ++next_pack_id)
+    while (true)
     {
-        skip_rows += pack_stats[next_pack_id].rows;
+        for (; next_pack_id < scan_end_pack_id && !use_packs[next_pack_id]; ++next_pack_id)
+        {
+            skip_rows += pack_stats[next_pack_id].rows;
+        }
+        if (next_pack_id < scan_end_pack_id || !wrapAround())
+            break;
     }
-    return next_pack_id < use_packs.size();
+    return next_pack_id < scan_end_pack_id;
 }
 
-inline bool isExtraColumn(const ColumnDefine & cd)
+bool DMFileReader::joinScanAt(size_t pack_id)
 {
-    return cd.id == EXTRA_HANDLE_COLUMN_ID || cd.id == VERSION_COLUMN_ID || cd.id == TAG_COLUMN_ID;
+    if (!canJoinScan() || next_pack_id != 0 || scan_join_pack_id != 0 || pack_id == 0 || pack_id >= scan_end_pack_id)
+        return false;
+
+    next_pack_id = pack_id;
+    scan_join_pack_id = pack_id;
+    // The streams are at the beginning of the file, make the next read of every column seek.
+    std::fill(skip_packs_by_column.begin(), skip_packs_by_column.end(), 1);
+    LOG_FMT_DEBUG(log, "Join the scan of DMFile {} at pack {}", path(), pack_id);
+    return true;
+}
+
+bool DMFileReader::wrapAround()
+{
+    if (scan_join_pack_id == 0)
+        return false;
+
+    next_pack_id = 0;
+    scan_end_pack_id = scan_join_pack_id;
+    scan_join_pack_id = 0;
+    // The streams are at the end of the file, make the next read of every column seek.
+    std::fill(skip_packs_by_column.begin(), skip_packs_by_column.end(), 1);
+    return true;
+}
+
+void DMFileReader::prefetchPacks(size_t start_pack_id, size_t end_pack_id, bool do_clean_read_on_normal_mode, bool do_clean_read_on_handle, bool do_read_rows_only)
+{
+    if (prefetch_packs == 0 || single_file_mode)
+        return;
+    if (start_pack_id >= prefetched_begin_pack_id && end_pack_id <= prefetched_end_pack_id)
+        return;
+
+    // Extend the window through the following continuous used packs.
+    const auto & use_packs = pack_filter.getUsePacks();
+    const size_t window_end = std::min(std::max(end_pack_id, start_pack_id + prefetch_packs), scan_end_pack_id);
+    size_t prefetch_end_pack_id = end_pack_id;
+    while (prefetch_end_pack_id < window_end && use_packs[prefetch_end_pack_id])
+        ++prefetch_end_pack_id;
+
+    std::vector<IOUringPrefetchRange> ranges;
+    ranges.reserve(column_streams.size());
+    for (auto & [stream_name, stream] : column_streams)
+    {
+        // Placeholder columns of clean read do not need the data.
+        const bool is_extra_column = stream->col_id == EXTRA_HANDLE_COLUMN_ID || stream->col_id == VERSION_COLUMN_ID || stream->col_id == TAG_COLUMN_ID;
+        if ((do_clean_read_on_handle && stream->col_id == EXTRA_HANDLE_COLUMN_ID)
+            || (do_clean_read_on_normal_mode && is_extra_column)
+            || (do_read_rows_only && !is_extra_column))
+            continue;
+
+        const size_t begin_offset = stream->getOffsetInFile(start_pack_id);
+        const size_t end_offset = stream->getEndOffsetInFile(prefetch_end_pack_id);
+
+        IOUringPrefetchRange range;
+        if (stream->buf->getIOUringPrefetchRange(begin_offset, end_offset, range))
+            ranges.push_back(range);
+    }
+    IOUringRandomAccessFile::prefetch(ranges);
+
+    prefetched_begin_pack_id = start_pack_id;
+    prefetched_end_pack_id = prefetch_end_pack_id;
+}
+
+void DMFileReader::readAheadPacks(size_t start_pack_id)
+{
+    if (read_ahead_packs == 0 || single_file_mode || start_pack_id >= scan_end_pack_id)
+        return;
+    // Start after the packs hinted before, if they are still ahead.
+    size_t begin_pack_id = read_ahead_end_pack_id > start_pack_id && read_ahead_end_pack_id <= scan_end_pack_id ? read_ahead_end_pack_id : start_pack_id;
+    const auto & use_packs = pack_filter.getUsePacks();
+    const size_t window_end = std::min(start_pack_id + read_ahead_packs, scan_end_pack_id);
+    if (begin_pack_id >= window_end)
+        return;
+
+    // The bytes from `start_pack_id` are counted, since the data hinted before is still being loaded or not read yet.
+    auto bytes_of = [&](size_t end_pack_id) {
+        size_t bytes = 0;
+        for (const auto & [stream_name, stream] : column_streams)
+            bytes += stream->getEndOffsetInFile(end_pack_id) - stream->getOffsetInFile(start_pack_id);
+        return bytes;
+    };
+    // Only the continuous used packs are read ahead.
+    size_t end_pack_id = begin_pack_id;
+    while (end_pack_id < window_end && use_packs[end_pack_id] && bytes_of(end_pack_id + 1) <= read_ahead_bytes)
+        ++end_pack_id;
+    if (end_pack_id <= begin_pack_id)
+        return;
+
+    for (auto & [stream_name, stream] : column_streams)
+        stream->buf->readAhead(stream->getOffsetInFile(begin_pack_id), stream->getEndOffsetInFile(end_pack_id));
+    read_ahead_end_pack_id = end_pack_id;
+}
+
+void DMFileReader::planSingleFileReads(size_t start_pack_id, bool do_clean_read_on_normal_mode, bool do_clean_read_on_handle, bool do_read_rows_only)
+{
+    if (!single_file_planner)
+        return;
+    if (start_pack_id >= planned_begin_pack_id && start_pack_id < planned_end_pack_id)
+        return;
+
+    // Only the continuous used packs are planned.
+    const auto & use_packs = pack_filter.getUsePacks();
+    const size_t window_end = std::min(start_pack_id + single_file_read_plan_packs, scan_end_pack_id);
+    size_t end_pack_id = start_pack_id;
+    while (end_pack_id < window_end && use_packs[end_pack_id])
+        ++end_pack_id;
+
+    std::vector<DMFileSingleFileReadPlanner::Range> ranges;
+    ranges.reserve(column_streams.size() * (end_pack_id - start_pack_id));
+    for (auto & [stream_name, stream] : column_streams)
+    {
+        // Placeholder columns of clean read do not need the data. The flags are decided by the first pack,
+        // the following packs fallback to read the file if they need more columns.
+        const bool is_extra_column = stream->col_id == EXTRA_HANDLE_COLUMN_ID || stream->col_id == VERSION_COLUMN_ID || stream->col_id == TAG_COLUMN_ID;
+        if ((do_clean_read_on_handle && stream->col_id == EXTRA_HANDLE_COLUMN_ID)
+            || (do_clean_read_on_normal_mode && is_extra_column)
+            || (do_read_rows_only && !is_extra_column))
+            continue;
+        for (size_t pack_id = start_pack_id; pack_id < end_pack_id; ++pack_id)
+        {
+            const size_t offset = stream->getOffsetInFile(pack_id);
+            ranges.emplace_back(offset, offset + stream->getSizeInFile(pack_id));
+        }
+    }
+    const size_t reads = single_file_planner->load(std::move(ranges));
+    LOG_FMT_TRACE(log, "Load packs [{}, {}) of {} streams by {} reads", start_pack_id, end_pack_id, column_streams.size(), reads);
+
+    planned_begin_pack_id = start_pack_id;
+    planned_end_pack_id = end_pack_id;
 }
 
 inline bool isCacheableColumn(const ColumnDefine & cd)
@@ -306,13 +573,28 @@ inline bool isCacheableColumn(const ColumnDefine & cd)
 }
 
 Block DMFileReader::read()
+{
+    ReadStageTimer timer(ReadStage::FileIO);
+    const auto decompress_ns = getThreadDecompressNanoseconds();
+    SCOPE_EXIT({ timer.addNested(ReadStage::Decompress, getThreadDecompressNanoseconds() - decompress_ns); });
+    while (true)
+    {
+        bool filtered_out = false;
+        Block res = readImpl(filtered_out);
+        // All rows of current packs are filtered out by late materialization, go on with the next packs.
+        if (!filtered_out)
+            return res;
+    }
+}
+
+Block DMFileReader::readImpl(bool & filtered_out)
 {
     // Go to next available pack.
     size_t skip_rows;
     getSkippedRows(skip_rows);
 
     const auto & use_packs = pack_filter.getUsePacks();
-    if (next_pack_id >= use_packs.size())
+    if (next_pack_id >= scan_end_pack_id)
         return {};
     // Find max continuing rows we can read.
     size_t start_pack_id = next_pack_id;
@@ -326,7 +608,7 @@ Block DMFileReader::read()
 
     const std::vector<RSResult> & handle_res = pack_filter.getHandleRes(); // alias of handle_res in pack_filter
     RSResult expected_handle_res = handle_res[next_pack_id];
-    for (; next_pack_id < use_packs.size() && use_packs[next_pack_id] && read_rows < rows_threshold_per_read; ++next_pack_id)
+    for (; next_pack_id < scan_end_pack_id && use_packs[next_pack_id] && read_rows < rows_threshold_per_read; ++next_pack_id)
     {
         if (read_pack_limit != 0 && next_pack_id - start_pack_id >= read_pack_limit)
             break;
@@ -362,149 +644,230 @@ Block DMFileReader::read()
         do_clean_read_on_normal_mode = max_version <= max_read_version;
     }
 
-    for (size_t i = 0; i < read_columns.size(); ++i)
+    const bool do_late_materialization = late_materialization_filter != nullptr && (do_clean_read_on_normal_mode || do_clean_read_on_handle);
+
+    // No row of the clean read packs is dropped by MVCC, so the values are not needed if only the row count is used.
+    const bool do_read_rows_only = read_rows_only && !do_late_materialization && (do_clean_read_on_normal_mode || do_clean_read_on_handle);
+
+    prefetchPacks(start_pack_id, next_pack_id, do_clean_read_on_normal_mode, do_clean_read_on_handle, do_read_rows_only);
+    // Load the data of the following packs in background while the current packs are being decoded.
+    readAheadPacks(next_pack_id);
+    planSingleFileReads(start_pack_id, do_clean_read_on_normal_mode, do_clean_read_on_handle, do_read_rows_only);
+
+    try
     {
-        try
+        if (!do_late_materialization)
+        {
+            for (size_t i = 0; i < read_columns.size(); ++i)
+                res.insert(readColumnOfPacks(i, start_pack_id, read_packs, read_rows, do_clean_read_on_normal_mode, do_clean_read_on_handle, do_read_rows_only));
+            return res;
+        }
+
+        // Read the columns required by the pushed down filter at first.
+        std::vector<ColumnWithTypeAndName> columns(read_columns.size());
+        std::vector<bool> is_read(read_columns.size(), false);
+        Block filter_block;
+        for (auto i : late_materialization_column_indices)
+        {
+            columns[i] = readColumnOfPacks(i, start_pack_id, read_packs, read_rows, do_clean_read_on_normal_mode, do_clean_read_on_handle, do_read_rows_only);
+            is_read[i] = true;
+            filter_block.insert(columns[i]);
+        }
+
+        late_materialization_filter->before_where->execute(filter_block);
+        const auto & filter_column = filter_block.getByName(late_materialization_filter->filter_column_name).column;
+
+        size_t passed_rows = read_rows;
+        const IColumn::Filter * filter = nullptr;
+        ConstantFilterDescription constant_filter_description(*filter_column);
+        std::optional<FilterDescription> filter_description;
+        if (constant_filter_description.always_false)
         {
-            // For clean read of column pk, version, tag, instead of loading data from disk, just create placeholder column is OK.
-            auto & cd = read_columns[i];
-            if (cd.id == EXTRA_HANDLE_COLUMN_ID && do_clean_read_on_handle)
+            passed_rows = 0;
+        }
+        else if (!constant_filter_description.always_true)
+        {
+            filter_description.emplace(*filter_column);
+            filter = filter_description->data;
+            passed_rows = countBytesInFilter(*filter);
+        }
+
+        if (passed_rows == 0)
+        {
+            // No row can pass the filter, skip reading the rest columns of these packs.
+            for (size_t i = 0; i < read_columns.size(); ++i)
             {
-                // Return the first row's handle
-                ColumnPtr column;
-                if (is_common_handle)
-                {
-                    StringRef min_handle = pack_filter.getMinStringHandle(start_pack_id);
-                    column = cd.type->createColumnConst(read_rows, Field(min_handle.data, min_handle.size));
-                }
-                else
-                {
-                    Handle min_handle = pack_filter.getMinHandle(start_pack_id);
-                    column = cd.type->createColumnConst(read_rows, Field(min_handle));
-                }
-                res.insert(ColumnWithTypeAndName{column, cd.type, cd.name, cd.id});
-                skip_packs_by_column[i] = read_packs;
+                if (!is_read[i])
+                    skip_packs_by_column[i] += read_packs;
             }
-            else if (do_clean_read_on_normal_mode && isExtraColumn(cd))
-            {
-                ColumnPtr column;
-                if (cd.id == EXTRA_HANDLE_COLUMN_ID)
-                {
-                    // Return the first row's handle
-                    if (is_common_handle)
-                    {
-                        StringRef min_handle = pack_filter.getMinStringHandle(start_pack_id);
-                        column = cd.type->createColumnConst(read_rows, Field(min_handle.data, min_handle.size));
-                    }
-                    else
-                    {
-                        Handle min_handle = pack_filter.getMinHandle(start_pack_id);
-                        column = cd.type->createColumnConst(read_rows, Field(min_handle));
-                    }
-                }
-                else if (cd.id == VERSION_COLUMN_ID)
-                {
-                    column = cd.type->createColumnConst(read_rows, Field(pack_stats[start_pack_id].first_version));
-                }
-                else if (cd.id == TAG_COLUMN_ID)
-                {
-                    column = cd.type->createColumnConst(read_rows, Field(static_cast<UInt64>(pack_stats[start_pack_id].first_tag)));
-                }
+            filtered_out = true;
+            return {};
+        }
 
-                res.insert(ColumnWithTypeAndName{column, cd.type, cd.name, cd.id});
+        for (size_t i = 0; i < read_columns.size(); ++i)
+        {
+            if (!is_read[i])
+                columns[i] = readColumnOfPacks(i, start_pack_id, read_packs, read_rows, do_clean_read_on_normal_mode, do_clean_read_on_handle, do_read_rows_only);
+            if (filter != nullptr && passed_rows != read_rows)
+                columns[i].column = columns[i].column->filter(*filter, passed_rows);
+            res.insert(std::move(columns[i]));
+        }
+        return res;
+    }
+    catch (DB::Exception & e)
+    {
+        e.addMessage("(while reading from DTFile: " + this->dmfile->path() + ")");
+        e.rethrow();
+    }
+    return {};
+}
 
-                skip_packs_by_column[i] = read_packs;
+ColumnWithTypeAndName DMFileReader::readColumnOfPacks(
+    size_t col_index,
+    size_t start_pack_id,
+    size_t read_packs,
+    size_t read_rows,
+    bool do_clean_read_on_normal_mode,
+    bool do_clean_read_on_handle,
+    bool do_read_rows_only)
+{
+    const auto & pack_stats = dmfile->getPackStats();
+    // For clean read of column pk, version, tag, instead of loading data from disk, just create placeholder column is OK.
+    auto & cd = read_columns[col_index];
+    if (do_read_rows_only && !isExtraColumn(cd))
+    {
+        // Materialize the placeholder, the streams above may not expect a const column of a normal column.
+        ColumnPtr column = createColumnWithDefaultValue(cd, read_rows);
+        skip_packs_by_column[col_index] += read_packs;
+        return ColumnWithTypeAndName{std::move(column), cd.type, cd.name, cd.id};
+    }
+    if (cd.id == EXTRA_HANDLE_COLUMN_ID && do_clean_read_on_handle)
+    {
+        // Return the first row's handle
+        ColumnPtr column;
+        if (is_common_handle)
+        {
+            StringRef min_handle = pack_filter.getMinStringHandle(start_pack_id);
+            column = cd.type->createColumnConst(read_rows, Field(min_handle.data, min_handle.size));
+        }
+        else
+        {
+            Handle min_handle = pack_filter.getMinHandle(start_pack_id);
+            column = cd.type->createColumnConst(read_rows, Field(min_handle));
+        }
+        skip_packs_by_column[col_index] = read_packs;
+        return ColumnWithTypeAndName{column, cd.type, cd.name, cd.id};
+    }
+    else if (do_clean_read_on_normal_mode && isExtraColumn(cd))
+    {
+        ColumnPtr column;
+        if (cd.id == EXTRA_HANDLE_COLUMN_ID)
+        {
+            // Return the first row's handle
+            if (is_common_handle)
+            {
+                StringRef min_handle = pack_filter.getMinStringHandle(start_pack_id);
+                column = cd.type->createColumnConst(read_rows, Field(min_handle.data, min_handle.size));
             }
             else
             {
-                const auto stream_name = DMFile::getFileNameBase(cd.id);
-                if (auto iter = column_streams.find(stream_name); iter != column_streams.end())
+                Handle min_handle = pack_filter.getMinHandle(start_pack_id);
+                column = cd.type->createColumnConst(read_rows, Field(min_handle));
+            }
+        }
+        else if (cd.id == VERSION_COLUMN_ID)
+        {
+            column = cd.type->createColumnConst(read_rows, Field(pack_stats[start_pack_id].first_version));
+        }
+        else if (cd.id == TAG_COLUMN_ID)
+        {
+            column = cd.type->createColumnConst(read_rows, Field(static_cast<UInt64>(pack_stats[start_pack_id].first_tag)));
+        }
+
+        skip_packs_by_column[col_index] = read_packs;
+        return ColumnWithTypeAndName{column, cd.type, cd.name, cd.id};
+    }
+    else
+    {
+        const auto stream_name = DMFile::getFileNameBase(cd.id);
+        if (auto iter = column_streams.find(stream_name); iter != column_streams.end())
+        {
+            if (enable_column_cache && isCacheableColumn(cd))
+            {
+                auto read_strategy = column_cache->getReadStrategy(start_pack_id, read_packs, cd.id);
+
+                auto data_type = dmfile->getColumnStat(cd.id).type;
+                auto column = data_type->createColumn();
+                column->reserve(read_rows);
+                for (auto & [range, strategy] : read_strategy)
                 {
-                    if (enable_column_cache && isCacheableColumn(cd))
+                    if (strategy == ColumnCache::Strategy::Memory)
                     {
-                        auto read_strategy = column_cache->getReadStrategy(start_pack_id, read_packs, cd.id);
-
-                        auto data_type = dmfile->getColumnStat(cd.id).type;
-                        auto column = data_type->createColumn();
-                        column->reserve(read_rows);
-                        for (auto & [range, strategy] : read_strategy)
+                        for (size_t cursor = range.first; cursor < range.second; cursor++)
                         {
-                            if (strategy == ColumnCache::Strategy::Memory)
-                            {
-                                for (size_t cursor = range.first; cursor < range.second; cursor++)
-                                {
-                                    auto cache_element = column_cache->getColumn(cursor, cd.id);
-                                    column->insertRangeFrom(
-                                        *(cache_element.first),
-                                        cache_element.second.first,
-                                        cache_element.second.second);
-                                }
-                                skip_packs_by_column[i] += (range.second - range.first);
-                            }
-                            else if (strategy == ColumnCache::Strategy::Disk)
-                            {
-                                size_t rows_count = 0;
-                                for (size_t cursor = range.first; cursor < range.second; cursor++)
-                                {
-                                    rows_count += pack_stats[cursor].rows;
-                                }
-                                ColumnPtr col;
-                                readColumn(cd, col, range.first, range.second - range.first, rows_count, skip_packs_by_column[i], single_file_mode);
-                                column->insertRangeFrom(*col, 0, col->size());
-                                skip_packs_by_column[i] = 0;
-                            }
-                            else
-                            {
-                                throw Exception("Unknown strategy", ErrorCodes::LOGICAL_ERROR);
-                            }
+                            auto cache_element = column_cache->getColumn(cursor, cd.id);
+                            column->insertRangeFrom(
+                                *(cache_element.first),
+                                cache_element.second.first,
+                                cache_element.second.second);
                         }
-                        ColumnPtr result_column = std::move(column);
-                        size_t rows_offset = 0;
-                        for (size_t cursor = start_pack_id; cursor < start_pack_id + read_packs; cursor++)
+                        skip_packs_by_column[col_index] += (range.second - range.first);
+                    }
+                    else if (strategy == ColumnCache::Strategy::Disk)
+                    {
+                        size_t rows_count = 0;
+                        for (size_t cursor = range.first; cursor < range.second; cursor++)
                         {
-                            column_cache->tryPutColumn(cursor, cd.id, result_column, rows_offset, pack_stats[cursor].rows);
-                            rows_offset += pack_stats[cursor].rows;
+                            rows_count += pack_stats[cursor].rows;
                         }
-                        // Cast column's data from DataType in disk to what we need now
-                        auto converted_column = convertColumnByColumnDefineIfNeed(data_type, std::move(result_column), cd);
-                        res.insert(ColumnWithTypeAndName{converted_column, cd.type, cd.name, cd.id});
+                        ColumnPtr col;
+                        readColumn(cd, col, range.first, range.second - range.first, rows_count, skip_packs_by_column[col_index], single_file_mode);
+                        column->insertRangeFrom(*col, 0, col->size());
+                        skip_packs_by_column[col_index] = 0;
                     }
                     else
                     {
-                        auto data_type = dmfile->getColumnStat(cd.id).type;
-                        ColumnPtr column;
-                        readColumn(cd, column, start_pack_id, read_packs, read_rows, skip_packs_by_column[i], single_file_mode);
-                        auto converted_column = convertColumnByColumnDefineIfNeed(data_type, std::move(column), cd);
-
-                        res.insert(ColumnWithTypeAndName{std::move(converted_column), cd.type, cd.name, cd.id});
-                        skip_packs_by_column[i] = 0;
+                        throw Exception("Unknown strategy", ErrorCodes::LOGICAL_ERROR);
                     }
                 }
-                else
+                ColumnPtr result_column = std::move(column);
+                size_t rows_offset = 0;
+                for (size_t cursor = start_pack_id; cursor < start_pack_id + read_packs; cursor++)
                 {
-                    LOG_FMT_TRACE(
-                        log,
-                        "Column [id: {}, name: {}, type: {}] not found, use default value. DMFile: {}",
-                        cd.id,
-                        cd.name,
-                        cd.type->getName(),
-                        dmfile->path());
-                    // New column after ddl is not exist in this DMFile, fill with default value
-                    ColumnPtr column = createColumnWithDefaultValue(cd, read_rows);
-
-                    res.insert(ColumnWithTypeAndName{std::move(column), cd.type, cd.name, cd.id});
-                    skip_packs_by_column[i] = 0;
+                    column_cache->tryPutColumn(cursor, cd.id, result_column, rows_offset, pack_stats[cursor].rows);
+                    rows_offset += pack_stats[cursor].rows;
                 }
+                // Cast column's data from DataType in disk to what we need now
+                auto converted_column = convertColumnByColumnDefineIfNeed(data_type, std::move(result_column), cd);
+                return ColumnWithTypeAndName{converted_column, cd.type, cd.name, cd.id};
+            }
+            else
+            {
+                auto data_type = dmfile->getColumnStat(cd.id).type;
+                ColumnPtr column;
+                readColumn(cd, column, start_pack_id, read_packs, read_rows, skip_packs_by_column[col_index], single_file_mode);
+                auto converted_column = convertColumnByColumnDefineIfNeed(data_type, std::move(column), cd);
+
+                skip_packs_by_column[col_index] = 0;
+                return ColumnWithTypeAndName{std::move(converted_column), cd.type, cd.name, cd.id};
             }
         }
-        catch (DB::Exception & e)
+        else
         {
-            e.addMessage("(while reading from DTFile: " + this->dmfile->path() + ")");
-            e.rethrow();
+            LOG_FMT_TRACE(
+                log,
+                "Column [id: {}, name: {}, type: {}] not found, use default value. DMFile: {}",
+                cd.id,
+                cd.name,
+                cd.type->getName(),
+                dmfile->path());
+            // New column after ddl is not exist in this DMFile, fill with default value
+            ColumnPtr column = createColumnWithDefaultValue(cd, read_rows);
+
+            skip_packs_by_column[col_index] = 0;
+            return ColumnWithTypeAndName{std::move(column), cd.type, cd.name, cd.id};
         }
     }
-
-    return res;
 }
 
 void DMFileReader::readFromDisk(
@@ -552,17 +915,53 @@ void DMFileReader::readColumn(ColumnDefine & column_define,
                               size_t skip_packs,
                               bool force_seek)
 {
-    if (!getCachedPacks(column_define.id, start_pack_id, pack_count, read_rows, column))
+    auto cached = getCachedPacks(column_define.id, start_pack_id, pack_count);
+    if (cached.status == ColumnCacheStatus::GET_HIT || cached.status == ColumnCacheStatus::GET_COPY)
+    {
+        column = std::move(cached.prefix);
+        last_read_from_cache[column_define.id] = true;
+    }
+    else if (cached.status == ColumnCacheStatus::GET_PART)
     {
+        // Only read the packs between the cached prefix and suffix from disk.
+        const auto & pack_stats = dmfile->getPackStats();
+        auto disk_start_pack_id = start_pack_id + cached.prefix_packs;
+        auto disk_end_pack_id = start_pack_id + pack_count - cached.suffix_packs;
+        size_t disk_rows = 0;
+        for (auto i = disk_start_pack_id; i < disk_end_pack_id; ++i)
+        {
+            disk_rows += pack_stats[i].rows;
+        }
+
         auto data_type = dmfile->getColumnStat(column_define.id).type;
         auto col = data_type->createColumn();
-        readFromDisk(column_define, col, start_pack_id, read_rows, skip_packs, force_seek || last_read_from_cache[column_define.id]);
+        col->reserve(read_rows);
+        if (cached.prefix != nullptr)
+        {
+            col->insertRangeFrom(*cached.prefix, 0, cached.prefix->size());
+        }
+        readFromDisk(
+            column_define,
+            col,
+            disk_start_pack_id,
+            disk_rows,
+            cached.prefix_packs > 0 ? 0 : skip_packs,
+            force_seek || last_read_from_cache[column_define.id] || cached.prefix_packs > 0);
+        if (cached.suffix != nullptr)
+        {
+            col->insertRangeFrom(*cached.suffix, 0, cached.suffix->size());
+        }
         column = std::move(col);
-        last_read_from_cache[column_define.id] = false;
+        // The streams are not at the end of the packs if the suffix is served by cache.
+        last_read_from_cache[column_define.id] = cached.suffix_packs > 0;
     }
     else
     {
-        last_read_from_cache[column_define.id] = true;
+        auto data_type = dmfile->getColumnStat(column_define.id).type;
+        auto col = data_type->createColumn();
+        readFromDisk(column_define, col, start_pack_id, read_rows, skip_packs, force_seek || last_read_from_cache[column_define.id]);
+        column = std::move(col);
+        last_read_from_cache[column_define.id] = false;
     }
 
     if (col_data_cache != nullptr)
@@ -577,7 +976,8 @@ void DMFileReader::addCachedPacks(ColId col_id, size_t start_pack_id, size_t pac
     {
         return;
     }
-    if (next_pack_id >= start_pack_id + pack_count)
+    // The packs are already read, or will not be read after going back to read the packs skipped by cooperative scan.
+    if (next_pack_id >= start_pack_id + pack_count || start_pack_id >= scan_end_pack_id)
     {
         col_data_cache->addStale();
     }
@@ -587,15 +987,15 @@ void DMFileReader::addCachedPacks(ColId col_id, size_t start_pack_id, size_t pac
     }
 }
 
-bool DMFileReader::getCachedPacks(ColId col_id, size_t start_pack_id, size_t pack_count, size_t read_rows, ColumnPtr & col)
+ColumnCacheResult DMFileReader::getCachedPacks(ColId col_id, size_t start_pack_id, size_t pack_count)
 {
     if (col_data_cache == nullptr)
     {
-        return false;
+        return {};
     }
-    auto found = col_data_cache->get(col_id, start_pack_id, pack_count, read_rows, col, dmfile->getColumnStat(col_id).type);
+    auto res = col_data_cache->get(col_id, start_pack_id, pack_count, dmfile->getPackStats(), dmfile->getColumnStat(col_id).type);
     col_data_cache->del(col_id, next_pack_id);
-    return found;
+    return res;
 }
 } // namespace DM
 } // namespace DB
@@ -16,11 +16,14 @@
 
 #include <DataStreams/MarkInCompressedFile.h>
 #include <Encryption/CompressedReadBufferFromFileProvider.h>
+#include <Encryption/MMapRandomAccessFile.h>
 #include <Storages/DeltaMerge/DeltaMergeDefines.h>
 #include <Storages/DeltaMerge/DeltaMergeHelpers.h>
 #include <Storages/DeltaMerge/File/ColumnCache.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
 #include <Storages/DeltaMerge/File/DMFilePackFilter.h>
+#include <Storages/DeltaMerge/File/DMFileSingleFileReadPlanner.h>
+#include <Storages/DeltaMerge/Filter/LateMaterializationFilter.h>
 #include <Storages/DeltaMerge/ReadThread/ColumnSharingCache.h>
 #include <Storages/DeltaMerge/RowKeyRange.h>
 #include <Storages/MarkCache.h>
@@ -49,20 +52,36 @@ public:
                const ReadLimiterPtr & read_limiter);
 
         const bool single_file_mode;
+        const ColId col_id;
         double avg_size_hint;
+        size_t data_file_size;
         MarksInCompressedFilePtr marks;
+        // The marks are used in the mapped memory if it is not nullptr, instead of `marks`.
+        MMapRandomAccessFilePtr mapped_marks;
         MarkWithSizesInCompressedFilePtr mark_with_sizes;
 
+        const MarkInCompressedFile & getMark(size_t i) const
+        {
+            return mapped_marks ? reinterpret_cast<const MarkInCompressedFile *>(mapped_marks->data())[i] : (*marks)[i];
+        }
+
         size_t getOffsetInFile(size_t i) const
         {
-            return single_file_mode ? (*mark_with_sizes)[i].mark.offset_in_compressed_file : (*marks)[i].offset_in_compressed_file;
+            return single_file_mode ? (*mark_with_sizes)[i].mark.offset_in_compressed_file : getMark(i).offset_in_compressed_file;
         }
 
         size_t getOffsetInDecompressedBlock(size_t i) const
         {
-            return single_file_mode ? (*mark_with_sizes)[i].mark.offset_in_decompressed_block : (*marks)[i].offset_in_decompressed_block;
+            return single_file_mode ? (*mark_with_sizes)[i].mark.offset_in_decompressed_block : getMark(i).offset_in_decompressed_block;
         }
 
+        // The end offset in file of the data of packs before `end_pack_id`, including the whole compressed block
+        // which contains the beginning of `end_pack_id`. Not for single file mode.
+        size_t getEndOffsetInFile(size_t end_pack_id) const;
+
+        // The size of the data of pack `i` in file. Only for single file mode.
+        size_t getSizeInFile(size_t i) const { return (*mark_with_sizes)[i].mark_size; }
+
         std::unique_ptr<CompressedSeekableReaderBuffer> buf;
     };
     using StreamPtr = std::unique_ptr<Stream>;
@@ -82,6 +101,8 @@ public:
         UInt64 max_read_version_,
         // filters
         DMFilePackFilter && pack_filter_,
+        // Used to filter the clean read packs in advance, can be nullptr
+        const LateMaterializationFilterPtr & late_materialization_filter_,
         // caches
         const MarkCachePtr & mark_cache_,
         bool enable_column_cache_,
@@ -93,7 +114,27 @@ public:
         size_t rows_threshold_per_read_,
         bool read_one_pack_every_time_,
         const String & tracing_id_,
-        bool enable_col_sharing_cache);
+        bool enable_col_sharing_cache,
+        bool enable_cooperative_scan_ = false,
+        // Read ahead the data of all columns for at least this number of packs by one batch of io_uring, 0 means disabled.
+        size_t prefetch_packs_ = 0,
+        // Hint the OS to load the data of the following packs in background while decoding current packs, 0 means disabled.
+        size_t read_ahead_packs_ = 0,
+        // The max bytes of the data being read ahead in background.
+        size_t read_ahead_bytes_ = 0,
+        // Only the row count of the result is used, the values of the non-extra columns of the clean read packs
+        // are filled with default values instead of being read.
+        bool read_rows_only_ = false,
+        // Cache of the decompressed blocks of the hot columns, can be nullptr.
+        const DecompressedBlockCachePtr & decompressed_block_cache_ = nullptr,
+        // Only the key columns and late materialization filter columns not larger than this value use `decompressed_block_cache_`.
+        size_t decompressed_block_cache_max_column_bytes_ = 0,
+        // In single file mode, load the data of the columns for this number of packs by a few merged reads, 0 means disabled.
+        size_t single_file_read_plan_packs_ = 0,
+        // The ranges of the columns whose gap is not larger than this value are merged into one read.
+        size_t single_file_read_merge_gap_bytes_ = 0,
+        // Read the mark files from the memory mapped files, see `dt_enable_mmap_mark_and_index`.
+        bool use_mmap_ = false);
 
     Block getHeader() const { return toEmptyBlock(read_columns); }
 
@@ -111,8 +152,46 @@ public:
     }
     void addCachedPacks(ColId col_id, size_t start_pack_id, size_t pack_count, ColumnPtr & col);
 
+    size_t getNextPackId() const { return next_pack_id; }
+
+    /// Cooperative scan
+    // Only the reads whose result does not depend on the order of packs can join other scans,
+    // e.g. fast mode reads, which neither do MVCC filtering nor sorted merge.
+    bool canJoinScan() const { return enable_cooperative_scan && is_fast_mode && col_data_cache != nullptr; }
+    // Start reading from `pack_id` where another reader of the same DMFile is reading, so that the packs
+    // read by that reader can be shared. The packs before `pack_id` are read after reaching the end.
+    // Returns false if this reader has started reading or can not join.
+    bool joinScanAt(size_t pack_id);
+
 private:
     bool shouldSeek(size_t pack_id);
+    // Whether the decompressed blocks of the column are worth caching.
+    bool isHotColumn(ColId col_id) const;
+
+    // Go back to read the packs skipped by joining other scan. Returns false if there is none.
+    bool wrapAround();
+
+    // Read ahead the data of the columns for packs in [start_pack_id, end_pack_id) and maybe some more packs after them.
+    void prefetchPacks(size_t start_pack_id, size_t end_pack_id, bool do_clean_read_on_normal_mode, bool do_clean_read_on_handle, bool do_read_rows_only);
+
+    // Hint to load the data of the packs after `start_pack_id` in background, bounded by `read_ahead_packs` and `read_ahead_bytes`.
+    void readAheadPacks(size_t start_pack_id);
+
+    // In single file mode, load the data of the columns for the packs from `start_pack_id` by `single_file_planner`.
+    void planSingleFileReads(size_t start_pack_id, bool do_clean_read_on_normal_mode, bool do_clean_read_on_handle, bool do_read_rows_only);
+
+    // Read the next continuous packs. `filtered_out` is set to true if all the rows
+    // are filtered out by late materialization.
+    Block readImpl(bool & filtered_out);
+
+    ColumnWithTypeAndName readColumnOfPacks(
+        size_t col_index,
+        size_t start_pack_id,
+        size_t read_packs,
+        size_t read_rows,
+        bool do_clean_read_on_normal_mode,
+        bool do_clean_read_on_handle,
+        bool do_read_rows_only);
 
     void readFromDisk(ColumnDefine & column_define,
                       MutableColumnPtr & column,
@@ -127,7 +206,7 @@ private:
                     size_t read_rows,
                     size_t skip_packs,
                     bool force_seek);
-    bool getCachedPacks(ColId col_id, size_t start_pack_id, size_t pack_count, size_t read_rows, ColumnPtr & col);
+    ColumnCacheResult getCachedPacks(ColId col_id, size_t start_pack_id, size_t pack_count);
 
 private:
     DMFilePtr dmfile;
@@ -147,21 +226,54 @@ private:
     const bool enable_clean_read;
     const bool is_fast_mode;
     const UInt64 max_read_version;
+    const bool read_rows_only;
 
     /// Filters
     DMFilePackFilter pack_filter;
 
+    /// Late materialization
+    LateMaterializationFilterPtr late_materialization_filter;
+    // The positions in `read_columns` of the columns required by `late_materialization_filter`
+    std::vector<size_t> late_materialization_column_indices;
+
     std::vector<size_t> skip_packs_by_column;
 
     /// Caches
     MarkCachePtr mark_cache;
+    const bool use_mmap;
     const bool enable_column_cache;
     ColumnCachePtr column_cache;
+    // Used by the blocks missed in `column_cache`.
+    DecompressedBlockCachePtr decompressed_block_cache;
+    const size_t decompressed_block_cache_max_column_bytes;
 
     const size_t rows_threshold_per_read;
 
     size_t next_pack_id = 0;
 
+    const bool enable_cooperative_scan;
+    // The end (exclusive) of the packs to read in current round.
+    size_t scan_end_pack_id = 0;
+    // The pack where this reader joined other scan, the packs before it will be read in the next round.
+    size_t scan_join_pack_id = 0;
+
+    const size_t prefetch_packs;
+    // The packs [prefetched_begin_pack_id, prefetched_end_pack_id) have been read ahead.
+    size_t prefetched_begin_pack_id = 0;
+    size_t prefetched_end_pack_id = 0;
+
+    const size_t read_ahead_packs;
+    const size_t read_ahead_bytes;
+    // The packs before it have been hinted to read ahead.
+    size_t read_ahead_end_pack_id = 0;
+
+    const size_t single_file_read_plan_packs;
+    // Shared by the column streams in single file mode, nullptr if disabled.
+    DMFileSingleFileReadPlannerPtr single_file_planner;
+    // The data of packs [planned_begin_pack_id, planned_end_pack_id) have been loaded by `single_file_planner`.
+    size_t planned_begin_pack_id = 0;
+    size_t planned_end_pack_id = 0;
+
     FileProviderPtr file_provider;
 
     LoggerPtr log;
@@ -0,0 +1,159 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <Common/ProfileEvents.h>
+#include <Encryption/RateLimiter.h>
+#include <Storages/DeltaMerge/File/DMFileSingleFileReadPlanner.h>
+#include <Storages/Page/PageUtil.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ProfileEvents
+{
+extern const Event DMFileSingleFileMergedReads;
+extern const Event DMFileSingleFileMergedReadBytes;
+} // namespace ProfileEvents
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int ARGUMENT_OUT_OF_BOUND;
+} // namespace ErrorCodes
+
+namespace DM
+{
+namespace
+{
+/// A view of the file of `DMFileSingleFileReadPlanner` with its own offset for `read`.
+class PlannedRandomAccessFile : public RandomAccessFile
+{
+public:
+    explicit PlannedRandomAccessFile(DMFileSingleFileReadPlannerPtr planner_)
+        : planner(std::move(planner_))
+    {}
+
+    off_t seek(off_t offset, int whence) override
+    {
+        if (whence == SEEK_SET)
+            file_offset = offset;
+        else if (whence == SEEK_CUR)
+            file_offset += offset;
+        else
+            throw Exception("PlannedRandomAccessFile::seek expects SEEK_SET or SEEK_CUR as whence", ErrorCodes::ARGUMENT_OUT_OF_BOUND);
+        return file_offset;
+    }
+
+    ssize_t read(char * buf, size_t size) override
+    {
+        ssize_t bytes_read = pread(buf, size, file_offset);
+        if (bytes_read > 0)
+            file_offset += bytes_read;
+        return bytes_read;
+    }
+
+    ssize_t pread(char * buf, size_t size, off_t offset) const override
+    {
+        // A short read is fine for the callers, the rest is read by the next call.
+        if (size_t copied = planner->readLoaded(buf, size, offset); copied > 0)
+            return static_cast<ssize_t>(copied);
+        if (const auto & read_limiter = planner->getReadLimiter(); read_limiter != nullptr)
+            read_limiter->request(size);
+        return planner->getFile()->pread(buf, size, offset);
+    }
+
+    std::string getFileName() const override { return planner->getFile()->getFileName(); }
+
+    int getFd() const override { return planner->getFile()->getFd(); }
+
+    // The underlying file is shared by all the column streams and closed with the planner.
+    bool isClosed() const override { return closed; }
+
+    void close() override { closed = true; }
+
+private:
+    DMFileSingleFileReadPlannerPtr planner;
+    off_t file_offset = 0;
+    bool closed = false;
+};
+} // namespace
+
+DMFileSingleFileReadPlanner::DMFileSingleFileReadPlanner(RandomAccessFilePtr file_, size_t merge_gap_bytes_, const ReadLimiterPtr & read_limiter_)
+    : file(std::move(file_))
+    , merge_gap_bytes(merge_gap_bytes_)
+    , read_limiter(read_limiter_)
+{}
+
+size_t DMFileSingleFileReadPlanner::load(std::vector<Range> ranges)
+{
+    loaded_ranges.clear();
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [](const Range & r) { return r.second <= r.first; }), ranges.end());
+    if (ranges.empty())
+        return 0;
+
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<Range> merged;
+    merged.push_back(ranges[0]);
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+        auto & last = merged.back();
+        if (ranges[i].first <= last.second + merge_gap_bytes)
+            last.second = std::max(last.second, ranges[i].second);
+        else
+            merged.push_back(ranges[i]);
+    }
+
+    size_t total_bytes = 0;
+    for (const auto & r : merged)
+        total_bytes += r.second - r.first;
+    buffer.resize(total_bytes);
+
+    size_t offset_in_buffer = 0;
+    for (const auto & [begin, end] : merged)
+    {
+        PageUtil::readFile(file, begin, buffer.data() + offset_in_buffer, end - begin, read_limiter);
+        loaded_ranges.push_back(LoadedRange{begin, end, offset_in_buffer});
+        offset_in_buffer += end - begin;
+    }
+    ProfileEvents::increment(ProfileEvents::DMFileSingleFileMergedReads, merged.size());
+    ProfileEvents::increment(ProfileEvents::DMFileSingleFileMergedReadBytes, total_bytes);
+    return merged.size();
+}
+
+size_t DMFileSingleFileReadPlanner::readLoaded(char * buf, size_t size, size_t offset) const
+{
+    // The last range whose begin is not greater than `offset`.
+    auto iter = std::upper_bound(loaded_ranges.begin(), loaded_ranges.end(), offset, [](size_t off, const LoadedRange & r) {
+        return off < r.begin;
+    });
+    if (iter == loaded_ranges.begin())
+        return 0;
+    --iter;
+    if (offset >= iter->end)
+        return 0;
+    const size_t n = std::min(size, iter->end - offset);
+    memcpy(buf, buffer.data() + iter->offset_in_buffer + (offset - iter->begin), n);
+    return n;
+}
+
+RandomAccessFilePtr DMFileSingleFileReadPlanner::newFile()
+{
+    return std::make_shared<PlannedRandomAccessFile>(shared_from_this());
+}
+
+} // namespace DM
+} // namespace DB
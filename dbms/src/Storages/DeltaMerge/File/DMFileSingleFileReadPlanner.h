@@ -0,0 +1,80 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/PODArray.h>
+#include <Encryption/RandomAccessFile.h>
+
+#include <memory>
+#include <vector>
+
+namespace DB
+{
+class ReadLimiter;
+using ReadLimiterPtr = std::shared_ptr<ReadLimiter>;
+
+namespace DM
+{
+/// In single file mode, the data of all the columns of a DMFile are sub ranges of one file, and the data
+/// of the columns of a pack are adjacent. Reading each column stream separately costs a seek and a read
+/// per column per pack.
+///
+/// The planner loads the union of the byte ranges of the requested columns for a batch of packs. The
+/// ranges whose gaps are not larger than `merge_gap_bytes` are merged, and each merged range is loaded by
+/// one large read into a shared buffer. The column streams read the file through `newFile()`, which serves
+/// the reads from the shared buffer and falls back to the file for the ranges not loaded.
+class DMFileSingleFileReadPlanner : public std::enable_shared_from_this<DMFileSingleFileReadPlanner>
+{
+public:
+    /// [begin, end) in the file.
+    using Range = std::pair<size_t, size_t>;
+
+    DMFileSingleFileReadPlanner(RandomAccessFilePtr file_, size_t merge_gap_bytes_, const ReadLimiterPtr & read_limiter_);
+
+    /// Load `ranges` and drop the ranges loaded before. Returns the number of reads issued.
+    size_t load(std::vector<Range> ranges);
+
+    /// Copy the data of [offset, offset + size) into `buf`, stopping at the end of the loaded range
+    /// which contains `offset`. Returns the number of bytes copied, 0 if `offset` is not loaded.
+    size_t readLoaded(char * buf, size_t size, size_t offset) const;
+
+    /// A file reading through this planner, each column stream should have its own one.
+    RandomAccessFilePtr newFile();
+
+    const RandomAccessFilePtr & getFile() const { return file; }
+    const ReadLimiterPtr & getReadLimiter() const { return read_limiter; }
+
+private:
+    struct LoadedRange
+    {
+        size_t begin;
+        size_t end;
+        size_t offset_in_buffer;
+    };
+
+    const RandomAccessFilePtr file;
+    const size_t merge_gap_bytes;
+    const ReadLimiterPtr read_limiter;
+
+    PODArray<char> buffer;
+    // Sorted by `begin` and not overlapped.
+    std::vector<LoadedRange> loaded_ranges;
+};
+
+using DMFileSingleFileReadPlannerPtr = std::shared_ptr<DMFileSingleFileReadPlanner>;
+
+} // namespace DM
+} // namespace DB
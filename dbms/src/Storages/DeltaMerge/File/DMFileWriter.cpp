@@ -68,13 +68,15 @@ DMFileWriter::DMFileWriter(const DMFilePtr & dmfile_,
     , file_provider(file_provider_)
     , write_limiter(write_limiter_)
 {
+    if (unlikely(options.flags.isVertical() && options.flags.isSingleFile()))
+        throw DB::TiFlashException("Vertical write is not supported in single file mode", Errors::DeltaTree::Internal);
+
     dmfile->setStatus(DMFile::Status::WRITING);
     for (auto & cd : write_columns)
     {
-        // TODO: currently we only generate index for Integers, Date, DateTime types, and this should be configurable by user.
-        /// for handle column always generate index
-        auto type = removeNullable(cd.type);
-        bool do_index = cd.id == EXTRA_HANDLE_COLUMN_ID || type->isInteger() || type->isDateOrDateTime();
+        bool do_index = needMinMaxIndex(cd);
+        bool do_bloom_filter = needBloomFilter(cd);
+        bool do_ndv_sketch = needNDVSketch(cd);
         if (options.flags.isSingleFile())
         {
             if (do_index)
@@ -82,6 +84,16 @@ DMFileWriter::DMFileWriter(const DMFilePtr & dmfile_,
                 const auto column_name = DMFile::getFileNameBase(cd.id, {});
                 single_file_stream->minmax_indexs.emplace(column_name, std::make_shared<MinMaxIndex>(*cd.type));
             }
+            if (do_bloom_filter)
+            {
+                const auto column_name = DMFile::getFileNameBase(cd.id, {});
+                single_file_stream->bloom_filter_indexs.emplace(column_name, std::make_shared<BloomFilterIndex>(options.bloom_filter_bits_per_key));
+            }
+            if (do_ndv_sketch)
+            {
+                const auto column_name = DMFile::getFileNameBase(cd.id, {});
+                single_file_stream->ndv_sketches.emplace(column_name, std::make_shared<NDVSketch>());
+            }
 
             auto callback = [&](const IDataType::SubstreamPath & substream_path) {
                 const auto stream_name = DMFile::getFileNameBase(cd.id, substream_path);
@@ -90,15 +102,34 @@ DMFileWriter::DMFileWriter(const DMFilePtr & dmfile_,
             };
             cd.type->enumerateStreams(callback, {});
         }
-        else
+        else if (!options.flags.isVertical())
         {
-            addStreams(cd.id, cd.type, do_index);
+            // In vertical mode, the streams are added by `beginColumnGroup`.
+            addStreams(cd.id, cd.type, do_index, do_bloom_filter, do_ndv_sketch);
         }
         dmfile->column_stats.emplace(cd.id, ColumnStat{cd.id, cd.type, /*avg_size=*/0});
     }
 }
 
-void DMFileWriter::addStreams(ColId col_id, DataTypePtr type, bool do_index)
+bool DMFileWriter::needMinMaxIndex(const ColumnDefine & cd)
+{
+    // TODO: currently we only generate index for Integers, Date, DateTime types, and this should be configurable by user.
+    /// for handle column always generate index
+    auto type = removeNullable(cd.type);
+    return cd.id == EXTRA_HANDLE_COLUMN_ID || type->isInteger() || type->isDateOrDateTime();
+}
+
+bool DMFileWriter::needBloomFilter(const ColumnDefine & cd) const
+{
+    return options.bloom_filter_columns.count(cd.id) && BloomFilterIndex::isSupportedType(*cd.type);
+}
+
+bool DMFileWriter::needNDVSketch(const ColumnDefine & cd) const
+{
+    return options.build_ndv_sketch && NDVSketch::isSupportedType(cd.type);
+}
+
+void DMFileWriter::addStreams(ColId col_id, DataTypePtr type, bool do_index, bool do_bloom_filter, bool do_ndv_sketch)
 {
     auto callback = [&](const IDataType::SubstreamPath & substream_path) {
         const auto stream_name = DMFile::getFileNameBase(col_id, substream_path);
@@ -106,34 +137,118 @@ void DMFileWriter::addStreams(ColId col_id, DataTypePtr type, bool do_index)
             dmfile,
             stream_name,
             type,
-            options.compression_settings,
+            getCompressionSettings(col_id, type, substream_path),
             options.max_compress_block_size,
             file_provider,
             write_limiter,
             IDataType::isNullMap(substream_path) ? false : do_index);
+        if (do_bloom_filter && !IDataType::isNullMap(substream_path))
+            stream->bloom_filter = std::make_shared<BloomFilterIndex>(options.bloom_filter_bits_per_key);
+        if (do_ndv_sketch && !IDataType::isNullMap(substream_path))
+            stream->ndv_sketch = std::make_shared<NDVSketch>();
         column_streams.emplace(stream_name, std::move(stream));
     };
 
     type->enumerateStreams(callback, {});
 }
 
+CompressionSettings DMFileWriter::getCompressionSettings(ColId col_id, const DataTypePtr & type, const IDataType::SubstreamPath & substream_path) const
+{
+    if (!options.delta_for_columns.count(col_id))
+        return options.compression_settings;
+
+    CompressionSettings settings(CompressionMethod::DeltaFOR);
+    if (IDataType::isNullMap(substream_path))
+    {
+        settings.value_size = sizeof(UInt8);
+    }
+    else if (std::none_of(substream_path.begin(), substream_path.end(), [](const auto & s) { return s.type == IDataType::Substream::ArrayElements || s.type == IDataType::Substream::ArraySizes; }))
+    {
+        // `value_size` is left 0 for the others, so that they fall back to LZ4.
+        auto nested_type = removeNullable(type);
+        if (nested_type->isInteger() || nested_type->isDateOrDateTime() || nested_type->isEnum())
+            settings.value_size = nested_type->getSizeOfValueInMemory();
+    }
+    return settings;
+}
+
+
+void DMFileWriter::beginColumnGroup(const ColumnDefines & group_columns_)
+{
+    if (unlikely(!options.flags.isVertical() || is_in_column_group))
+        throw DB::TiFlashException("beginColumnGroup is called out of vertical mode or twice", Errors::DeltaTree::Internal);
+
+    group_columns = group_columns_;
+    for (const auto & cd : group_columns)
+        addStreams(cd.id, cd.type, needMinMaxIndex(cd), needBloomFilter(cd), needNDVSketch(cd));
+    is_in_column_group = true;
+    group_pack_index = 0;
+}
+
+void DMFileWriter::endColumnGroup()
+{
+    if (unlikely(!is_in_column_group))
+        throw DB::TiFlashException("endColumnGroup is called without beginColumnGroup", Errors::DeltaTree::Internal);
+    if (unlikely(finished_column_groups > 0 && group_pack_index != dmfile->getPacks()))
+        throw DB::TiFlashException(
+            fmt::format("Column group has written {} packs, but {} packs are expected", group_pack_index, dmfile->getPacks()),
+            Errors::DeltaTree::Internal);
+
+    // Close the streams of this group to release their buffers and files.
+    for (const auto & cd : group_columns)
+    {
+        finalizeColumn(cd.id, cd.type);
+        cd.type->enumerateStreams([&](const IDataType::SubstreamPath & substream) { column_streams.erase(DMFile::getFileNameBase(cd.id, substream)); }, {});
+    }
+    group_columns.clear();
+    is_in_column_group = false;
+    ++finished_column_groups;
+}
 
 void DMFileWriter::write(const Block & block, const BlockProperty & block_property)
 {
-    is_empty_file = false;
-    DMFile::PackStat stat{};
-    stat.rows = block.rows();
-    stat.not_clean = block_property.not_clean_rows;
-    stat.bytes = block.bytes(); // This is bytes of pack data in memory.
+    const bool is_vertical = options.flags.isVertical();
+    if (unlikely(is_vertical && !is_in_column_group))
+        throw DB::TiFlashException("Writing to a vertical DMFileWriter without beginColumnGroup", Errors::DeltaTree::Internal);
 
     auto del_mark_column = tryGetByColumnId(block, TAG_COLUMN_ID).column;
 
     const ColumnVector<UInt8> * del_mark = !del_mark_column ? nullptr : static_cast<const ColumnVector<UInt8> *>(del_mark_column.get());
 
-    for (auto & cd : write_columns)
+    if (is_vertical && finished_column_groups > 0)
+    {
+        // The pack has been added by the first group, only append the columns of this group to it.
+        if (unlikely(group_pack_index >= dmfile->getPacks() || dmfile->pack_stats[group_pack_index].rows != block.rows()))
+            throw DB::TiFlashException(
+                fmt::format("The block of pack {} in column group {} has {} rows, which does not match the first column group",
+                            group_pack_index,
+                            finished_column_groups,
+                            block.rows()),
+                Errors::DeltaTree::Internal);
+
+        auto & stat = dmfile->pack_stats[group_pack_index];
+        for (auto & cd : group_columns)
+        {
+            const auto & col = getByColumnId(block, cd.id).column;
+            writeColumn(cd.id, *cd.type, *col, del_mark);
+            stat.bytes += col->byteSize();
+        }
+        ++group_pack_index;
+        return;
+    }
+
+    is_empty_file = false;
+    DMFile::PackStat stat{};
+    stat.rows = block.rows();
+    stat.not_clean = block_property.not_clean_rows;
+    stat.bytes = is_vertical ? 0 : block.bytes(); // This is bytes of pack data in memory.
+
+    for (auto & cd : is_vertical ? group_columns : write_columns)
     {
         const auto & col = getByColumnId(block, cd.id).column;
         writeColumn(cd.id, *cd.type, *col, del_mark);
+        if (is_vertical)
+            stat.bytes += col->byteSize();
 
         if (cd.id == VERSION_COLUMN_ID)
             stat.first_version = col->get64(0);
@@ -141,10 +256,12 @@ void DMFileWriter::write(const Block & block, const BlockProperty & block_proper
             stat.first_tag = static_cast<UInt8>(col->get64(0));
     }
 
-    if (!options.flags.isSingleFile())
+    // In vertical mode, the bytes of the pack are not known until all the groups are written.
+    if (!options.flags.isSingleFile() && !is_vertical)
     {
         writePODBinary(stat, *pack_stat_file);
     }
+    ++group_pack_index;
 
     dmfile->addPack(stat);
 
@@ -156,14 +273,24 @@ void DMFileWriter::write(const Block & block, const BlockProperty & block_proper
 
 void DMFileWriter::finalize()
 {
+    if (options.flags.isVertical())
+    {
+        if (unlikely(is_in_column_group))
+            throw DB::TiFlashException("finalize is called before endColumnGroup", Errors::DeltaTree::Internal);
+        for (const auto & stat : dmfile->getPackStats())
+            writePODBinary(stat, *pack_stat_file);
+    }
+
     if (!options.flags.isSingleFile())
     {
         pack_stat_file->sync();
     }
 
-    for (auto & cd : write_columns)
+    // In vertical mode, the columns are finalized by `endColumnGroup`.
+    if (!options.flags.isVertical())
     {
-        finalizeColumn(cd.id, cd.type);
+        for (auto & cd : write_columns)
+            finalizeColumn(cd.id, cd.type);
     }
 
     if (options.flags.isSingleFile())
@@ -194,8 +321,14 @@ void DMFileWriter::writeColumn(ColId col_id, const IDataType & type, const IColu
             {
                 // For EXTRA_HANDLE_COLUMN_ID, we ignore del_mark when add minmax index.
                 // Because we need all rows which satisfy a certain range when place delta index no matter whether the row is a delete row.
-                iter->second->addPack(column, col_id == EXTRA_HANDLE_COLUMN_ID ? nullptr : del_mark);
+                iter->second->addPack(column, col_id == EXTRA_HANDLE_COLUMN_ID ? nullptr : del_mark, /*truncate_string_bounds*/ col_id != EXTRA_HANDLE_COLUMN_ID);
             }
+            auto & bloom_filter_indexs = single_file_stream->bloom_filter_indexs;
+            if (auto iter = bloom_filter_indexs.find(stream_name); iter != bloom_filter_indexs.end())
+                iter->second->addPack(column);
+            auto & ndv_sketches = single_file_stream->ndv_sketches;
+            if (auto iter = ndv_sketches.find(stream_name); iter != ndv_sketches.end())
+                iter->second->addPack(column);
 
             auto offset_in_compressed_block = single_file_stream->original_layer.offset();
             if (unlikely(offset_in_compressed_block != 0))
@@ -259,8 +392,12 @@ void DMFileWriter::writeColumn(ColId col_id, const IDataType & type, const IColu
                 {
                     // For EXTRA_HANDLE_COLUMN_ID, we ignore del_mark when add minmax index.
                     // Because we need all rows which satisfy a certain range when place delta index no matter whether the row is a delete row.
-                    stream->minmaxes->addPack(column, col_id == EXTRA_HANDLE_COLUMN_ID ? nullptr : del_mark);
+                    stream->minmaxes->addPack(column, col_id == EXTRA_HANDLE_COLUMN_ID ? nullptr : del_mark, /*truncate_string_bounds*/ col_id != EXTRA_HANDLE_COLUMN_ID);
                 }
+                if (stream->bloom_filter)
+                    stream->bloom_filter->addPack(column);
+                if (stream->ndv_sketch)
+                    stream->ndv_sketch->addPack(column);
 
                 /// There could already be enough data to compress into the new block.
                 if (stream->compressed_buf->offset() >= options.min_compress_block_size)
@@ -340,6 +477,28 @@ void DMFileWriter::finalizeColumn(ColId col_id, DataTypePtr type)
                 bytes_written += minmax_size_in_file;
                 dmfile->addSubFileStat(DMFile::colIndexFileName(stream_name), minmax_offset_in_file, minmax_size_in_file);
             }
+
+            // write bloom filter
+            auto & bloom_filter_indexs = single_file_stream->bloom_filter_indexs;
+            if (auto iter = bloom_filter_indexs.find(stream_name); iter != bloom_filter_indexs.end())
+            {
+                size_t bloom_filter_offset_in_file = single_file_stream->plain_layer.count();
+                iter->second->write(single_file_stream->plain_layer);
+                size_t bloom_filter_size_in_file = single_file_stream->plain_layer.count() - bloom_filter_offset_in_file;
+                bytes_written += bloom_filter_size_in_file;
+                dmfile->addSubFileStat(DMFile::colBloomFilterFileName(stream_name), bloom_filter_offset_in_file, bloom_filter_size_in_file);
+            }
+
+            // write ndv sketch
+            auto & ndv_sketches = single_file_stream->ndv_sketches;
+            if (auto iter = ndv_sketches.find(stream_name); iter != ndv_sketches.end())
+            {
+                size_t ndv_sketch_offset_in_file = single_file_stream->plain_layer.count();
+                iter->second->write(single_file_stream->plain_layer);
+                size_t ndv_sketch_size_in_file = single_file_stream->plain_layer.count() - ndv_sketch_offset_in_file;
+                bytes_written += ndv_sketch_size_in_file;
+                dmfile->addSubFileStat(DMFile::colNDVSketchFileName(stream_name), ndv_sketch_offset_in_file, ndv_sketch_size_in_file);
+            }
         };
         type->enumerateStreams(callback, {});
     }
@@ -394,6 +553,40 @@ void DMFileWriter::finalizeColumn(ColId col_id, DataTypePtr type)
 #endif
                 }
             }
+
+            if (stream->bloom_filter)
+            {
+                auto buf = WriteBufferByFileProviderBuilder(
+                               dmfile->configuration.has_value(),
+                               file_provider,
+                               dmfile->colBloomFilterPath(stream_name),
+                               dmfile->encryptionBloomFilterPath(stream_name),
+                               false,
+                               write_limiter)
+                               .with_checksum_algorithm(detail::getAlgorithmOrNone(*dmfile))
+                               .with_checksum_frame_size(detail::getFrameSizeOrDefault(*dmfile))
+                               .build();
+                stream->bloom_filter->write(*buf);
+                buf->sync();
+                bytes_written += is_empty_file ? 0 : buf->getMaterializedBytes();
+            }
+
+            if (stream->ndv_sketch)
+            {
+                auto buf = WriteBufferByFileProviderBuilder(
+                               dmfile->configuration.has_value(),
+                               file_provider,
+                               dmfile->colNDVSketchPath(stream_name),
+                               dmfile->encryptionNDVSketchPath(stream_name),
+                               false,
+                               write_limiter)
+                               .with_checksum_algorithm(detail::getAlgorithmOrNone(*dmfile))
+                               .with_checksum_frame_size(detail::getFrameSizeOrDefault(*dmfile))
+                               .build();
+                stream->ndv_sketch->write(*buf);
+                buf->sync();
+                bytes_written += is_empty_file ? 0 : buf->getMaterializedBytes();
+            }
         };
         type->enumerateStreams(callback, {});
     }
@@ -22,7 +22,9 @@
 #include <IO/WriteBufferFromOStream.h>
 #include <Storages/DeltaMerge/DMChecksumConfig.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
+#include <Storages/DeltaMerge/Index/BloomFilterIndex.h>
 #include <Storages/DeltaMerge/Index/MinMaxIndex.h>
+#include <Storages/DeltaMerge/Index/NDVSketch.h>
 
 namespace DB
 {
@@ -103,6 +105,10 @@ public:
         WriteBufferPtr compressed_buf;
 
         MinMaxIndexPtr minmaxes;
+        // Only created for the columns in `Options::bloom_filter_columns`.
+        BloomFilterIndexPtr bloom_filter;
+        // Only created if `Options::build_ndv_sketch` is true.
+        NDVSketchPtr ndv_sketch;
         WriteBufferFromFileBasePtr mark_file;
     };
     using StreamPtr = std::unique_ptr<Stream>;
@@ -146,6 +152,12 @@ public:
         using ColumnMinMaxIndexs = std::unordered_map<String, MinMaxIndexPtr>;
         ColumnMinMaxIndexs minmax_indexs;
 
+        using ColumnBloomFilterIndexs = std::unordered_map<String, BloomFilterIndexPtr>;
+        ColumnBloomFilterIndexs bloom_filter_indexs;
+
+        using ColumnNDVSketches = std::unordered_map<String, NDVSketchPtr>;
+        ColumnNDVSketches ndv_sketches;
+
         using ColumnDataSizes = std::unordered_map<String, size_t>;
         ColumnDataSizes column_data_sizes;
 
@@ -172,6 +184,7 @@ public:
     {
     private:
         static constexpr size_t IS_SINGLE_FILE = 0x01;
+        static constexpr size_t IS_VERTICAL = 0x02;
 
         size_t value;
 
@@ -182,6 +195,9 @@ public:
 
         inline void setSingleFile(bool v) { value = (v ? (value | IS_SINGLE_FILE) : (value & ~IS_SINGLE_FILE)); }
         inline bool isSingleFile() const { return (value & IS_SINGLE_FILE); }
+        // Write the columns group by group, see `DMFileWriter::beginColumnGroup`. Only supported in folder mode.
+        inline void setVertical(bool v) { value = (v ? (value | IS_VERTICAL) : (value & ~IS_VERTICAL)); }
+        inline bool isVertical() const { return (value & IS_VERTICAL); }
     };
 
     struct Options
@@ -190,6 +206,13 @@ public:
         size_t min_compress_block_size;
         size_t max_compress_block_size;
         Flags flags;
+        // The columns to build bloom filter index for, unsupported types are ignored.
+        std::unordered_set<ColId> bloom_filter_columns;
+        size_t bloom_filter_bits_per_key = 10;
+        // The columns to compress by `CompressionMethod::DeltaFOR` instead of `compression_settings`.
+        std::unordered_set<ColId> delta_for_columns;
+        // Build a `NDVSketch` for each column of the supported types.
+        bool build_ndv_sketch = false;
 
         Options() = default;
 
@@ -206,6 +229,10 @@ public:
             , min_compress_block_size(from.min_compress_block_size)
             , max_compress_block_size(from.max_compress_block_size)
             , flags(from.flags)
+            , bloom_filter_columns(from.bloom_filter_columns)
+            , bloom_filter_bits_per_key(from.bloom_filter_bits_per_key)
+            , delta_for_columns(from.delta_for_columns)
+            , build_ndv_sketch(from.build_ndv_sketch)
         {
             flags.setSingleFile(file->isSingleFileMode());
         }
@@ -222,6 +249,18 @@ public:
     void write(const Block & block, const BlockProperty & block_property);
     void finalize();
 
+    /// In vertical mode, only the streams of one group of columns are opened at a time, which bounds the memory
+    /// of the compression buffers and the number of opened files for wide tables. The caller writes all the
+    /// blocks once for each group:
+    ///
+    ///     for each group: beginColumnGroup(group), write(block, property) for each block, endColumnGroup()
+    ///     finalize()
+    ///
+    /// The packs are decided by the blocks of the first group, and the blocks of the other groups must have the
+    /// same number of rows as them. `block_property` is ignored except in the first group.
+    void beginColumnGroup(const ColumnDefines & group_columns);
+    void endColumnGroup();
+
     const DMFilePtr getFile() const
     {
         return dmfile;
@@ -234,7 +273,11 @@ private:
     /// Add streams with specified column id. Since a single column may have more than one Stream,
     /// for example Nullable column has a NullMap column, we would track them with a mapping
     /// FileNameBase -> Stream.
-    void addStreams(ColId col_id, DataTypePtr type, bool do_index);
+    void addStreams(ColId col_id, DataTypePtr type, bool do_index, bool do_bloom_filter, bool do_ndv_sketch);
+    static bool needMinMaxIndex(const ColumnDefine & cd);
+    bool needBloomFilter(const ColumnDefine & cd) const;
+    bool needNDVSketch(const ColumnDefine & cd) const;
+    CompressionSettings getCompressionSettings(ColId col_id, const DataTypePtr & type, const IDataType::SubstreamPath & substream_path) const;
 
 private:
     DMFilePtr dmfile;
@@ -252,6 +295,12 @@ private:
 
     // use to avoid count data written in index file for empty dmfile
     bool is_empty_file = true;
+
+    // For vertical mode.
+    ColumnDefines group_columns;
+    bool is_in_column_group = false;
+    size_t finished_column_groups = 0;
+    size_t group_pack_index = 0;
 };
 
 } // namespace DM
@@ -46,6 +46,19 @@ public:
         return res;
     }
 
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        auto results = children[0]->batchRoughCheck(start_pack, pack_count, param);
+        for (size_t i = 1; i < children.size(); ++i)
+        {
+            // Stop checking the rest children once all the packs are excluded.
+            if (std::all_of(results.begin(), results.end(), [](RSResult r) { return r == None; }))
+                break;
+            batchAnd(results, children[i]->batchRoughCheck(start_pack, pack_count, param));
+        }
+        return results;
+    }
+
     // TODO: override applyOptimize()
 };
 
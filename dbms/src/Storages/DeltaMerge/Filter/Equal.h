@@ -32,7 +32,13 @@ public:
     RSResult roughCheck(size_t pack_id, const RSCheckParam & param) override
     {
         GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOME(param, attr, rsindex);
-        return rsindex.minmax->checkEqual(pack_id, value, rsindex.type);
+        return rsindex.checkEqual(pack_id, value);
+    }
+
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        return rsindex.checkEqual(start_pack, pack_count, value);
     }
 };
 
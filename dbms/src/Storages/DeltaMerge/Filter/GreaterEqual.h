@@ -35,6 +35,12 @@ public:
         return rsindex.minmax->checkGreaterEqual(pack_id, value, rsindex.type, null_direction);
     }
 
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        return rsindex.minmax->checkGreaterEqual(start_pack, pack_count, value, rsindex.type, null_direction);
+    }
+
     RSOperatorPtr switchDirection() override { return createLessEqual(attr, value, null_direction); }
 };
 
@@ -52,11 +52,20 @@ public:
     {
         GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOME(param, attr, rsindex);
         // TODO optimize for IN
-        RSResult res = rsindex.minmax->checkEqual(pack_id, values[0], rsindex.type);
+        RSResult res = rsindex.checkEqual(pack_id, values[0]);
         for (size_t i = 1; i < values.size(); ++i)
-            res = res || rsindex.minmax->checkEqual(pack_id, values[i], rsindex.type);
+            res = res || rsindex.checkEqual(pack_id, values[i]);
         return res;
     }
+
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        RSResults results = rsindex.checkEqual(start_pack, pack_count, values[0]);
+        for (size_t i = 1; i < values.size(); ++i)
+            batchOr(results, rsindex.checkEqual(start_pack, pack_count, values[i]));
+        return results;
+    }
 };
 
 
@@ -0,0 +1,50 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Interpreters/ExpressionActions.h>
+#include <Storages/DeltaMerge/DeltaMergeDefines.h>
+
+namespace DB
+{
+namespace DM
+{
+struct LateMaterializationFilter;
+using LateMaterializationFilterPtr = std::shared_ptr<LateMaterializationFilter>;
+
+/// The pushed down filter used for late materialization when reading DTFiles.
+/// The reader reads `filter_columns` first and evaluates `before_where` on them, the
+/// rest columns are only read for packs with at least one row passing the filter.
+/// Rows are only filtered in advance, the caller still need to apply the filter on the
+/// output of the storage.
+struct LateMaterializationFilter
+{
+    LateMaterializationFilter(
+        const ExpressionActionsPtr & before_where_,
+        const String & filter_column_name_,
+        const ColumnDefines & filter_columns_)
+        : before_where(before_where_)
+        , filter_column_name(filter_column_name_)
+        , filter_columns(filter_columns_)
+    {}
+
+    const ExpressionActionsPtr before_where;
+    const String filter_column_name;
+    // The columns required by `before_where`. They must be the columns read from storage.
+    const ColumnDefines filter_columns;
+};
+
+} // namespace DM
+} // namespace DB
@@ -35,6 +35,14 @@ public:
         return !rsindex.minmax->checkGreater(pack_id, value, rsindex.type, null_direction);
     }
 
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        auto results = rsindex.minmax->checkGreater(start_pack, pack_count, value, rsindex.type, null_direction);
+        batchNot(results);
+        return results;
+    }
+
     RSOperatorPtr switchDirection() override { return createGreater(attr, value, null_direction); }
 };
 
@@ -20,16 +20,56 @@ namespace DB
 {
 namespace DM
 {
+/// `column LIKE pattern` is checked by the constant prefix of the pattern, the `value` is the prefix
+/// with the escape characters removed. A row could match only if it is in the range of
+/// [prefix, the next string after all the strings starting with prefix), so the packs out of the
+/// range are excluded. The rest part of the pattern is not checked, so `All` is never returned.
 class Like : public ColCmpVal
 {
 public:
     Like(const Attr & attr_, const Field & value_)
         : ColCmpVal(attr_, value_, 0)
-    {}
+    {
+        const auto & prefix = value.safeGet<String>();
+        // The smallest string greater than all the strings starting with prefix. Remove the trailing
+        // 0xFF and increase the last byte. There is no upper bound if the prefix is made of 0xFF.
+        auto end = prefix.find_last_not_of('\xFF');
+        if (end != String::npos)
+        {
+            String upper = prefix.substr(0, end + 1);
+            upper.back() = static_cast<char>(static_cast<UInt8>(upper.back()) + 1);
+            upper_bound = Field(upper);
+        }
+    }
 
     String name() override { return "like"; }
 
-    RSResult roughCheck(size_t /*pack_id*/, const RSCheckParam & /*param*/) override { return Some; }
+    RSResult roughCheck(size_t pack_id, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOME(param, attr, rsindex);
+        auto res = rsindex.minmax->checkGreaterEqual(pack_id, value, rsindex.type, null_direction);
+        if (!upper_bound.isNull() && res != None)
+            res = res && !rsindex.minmax->checkGreaterEqual(pack_id, upper_bound, rsindex.type, null_direction);
+        return res == None ? None : Some;
+    }
+
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        auto results = rsindex.minmax->checkGreaterEqual(start_pack, pack_count, value, rsindex.type, null_direction);
+        if (!upper_bound.isNull())
+        {
+            auto less_results = rsindex.minmax->checkGreaterEqual(start_pack, pack_count, upper_bound, rsindex.type, null_direction);
+            batchNot(less_results);
+            batchAnd(results, less_results);
+        }
+        for (auto & res : results)
+            res = res == None ? None : Some;
+        return results;
+    }
+
+private:
+    Field upper_bound;
 };
 
 
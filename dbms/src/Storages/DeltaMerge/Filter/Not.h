@@ -30,6 +30,13 @@ public:
     String name() override { return "not"; }
 
     RSResult roughCheck(size_t pack_id, const RSCheckParam & param) override { return !children[0]->roughCheck(pack_id, param); }
+
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        auto results = children[0]->batchRoughCheck(start_pack, pack_count, param);
+        batchNot(results);
+        return results;
+    }
 };
 
 } // namespace DM
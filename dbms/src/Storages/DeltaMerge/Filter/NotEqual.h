@@ -34,6 +34,14 @@ public:
         GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOME(param, attr, rsindex);
         return !rsindex.minmax->checkEqual(pack_id, value, rsindex.type);
     }
+
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        auto results = rsindex.minmax->checkEqual(start_pack, pack_count, value, rsindex.type);
+        batchNot(results);
+        return results;
+    }
 };
 
 } // namespace DM
@@ -57,6 +57,17 @@ public:
             res = res && !rsindex.minmax->checkEqual(pack_id, values[i], rsindex.type);
         return res;
     }
+
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count);
+        // not (v0 or v1 ...) is equal to (not v0) and (not v1) ...
+        RSResults results = rsindex.minmax->checkEqual(start_pack, pack_count, values[0], rsindex.type);
+        for (size_t i = 1; i < values.size(); ++i)
+            batchOr(results, rsindex.minmax->checkEqual(start_pack, pack_count, values[i], rsindex.type));
+        batchNot(results);
+        return results;
+    }
 };
 
 } // namespace DM
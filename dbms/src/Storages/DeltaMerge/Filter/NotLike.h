@@ -30,6 +30,8 @@ public:
     String name() override { return "not_like"; }
 
     RSResult roughCheck(size_t /*pack_id*/, const RSCheckParam & /*param*/) override { return Some; }
+
+    RSResults batchRoughCheck(size_t /*start_pack*/, size_t pack_count, const RSCheckParam & /*param*/) override { return RSResults(pack_count, Some); }
 };
 
 } // namespace DM
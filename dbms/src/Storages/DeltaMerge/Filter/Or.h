@@ -40,6 +40,14 @@ public:
         return res;
     }
 
+    RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param) override
+    {
+        auto results = children[0]->batchRoughCheck(start_pack, pack_count, param);
+        for (size_t i = 1; i < children.size(); ++i)
+            batchOr(results, children[i]->batchRoughCheck(start_pack, pack_count, param));
+        return results;
+    }
+
     // TODO: override applyOptimize()
 };
 
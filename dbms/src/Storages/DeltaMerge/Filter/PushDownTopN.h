@@ -0,0 +1,44 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Storages/DeltaMerge/DeltaMergeDefines.h>
+
+namespace DB
+{
+namespace DM
+{
+struct PushDownTopN;
+using PushDownTopNPtr = std::shared_ptr<PushDownTopN>;
+
+/// The TopN on a single column pushed down to the storage. The storage skips the stable packs
+/// which could not be in the result, e.g. for `order by column desc limit N`, the packs whose max
+/// is less than the N-th largest value. The caller still need to apply the TopN on the output
+/// of the storage.
+struct PushDownTopN
+{
+    PushDownTopN(const ColumnDefine & column_, bool is_desc_, size_t limit_)
+        : column(column_)
+        , is_desc(is_desc_)
+        , limit(limit_)
+    {}
+
+    const ColumnDefine column;
+    const bool is_desc;
+    const size_t limit;
+};
+
+} // namespace DM
+} // namespace DB
@@ -52,10 +52,18 @@ public:
     virtual String name() = 0;
     virtual String toDebugString() = 0;
 
-    // TODO: implement a batch check version
-
     virtual RSResult roughCheck(size_t pack_id, const RSCheckParam & param) = 0;
 
+    // Check the packs in [start_pack, start_pack + pack_count) in one pass. The leaf operators check the
+    // min-max arrays of all the packs together, and the logical operators combine the results element-wise.
+    virtual RSResults batchRoughCheck(size_t start_pack, size_t pack_count, const RSCheckParam & param)
+    {
+        RSResults results(pack_count, RSResult::Some);
+        for (size_t i = 0; i < pack_count; ++i)
+            results[i] = roughCheck(start_pack + i, param);
+        return results;
+    }
+
     virtual Attrs getAttrs() = 0;
 
     virtual RSOperatorPtr optimize() { return shared_from_this(); };
@@ -124,6 +132,14 @@ public:
     if (!rsindex.type->equals(*attr.type))                                 \
         return Some;
 
+#define GET_RSINDEX_FROM_PARAM_NOT_FOUND_RETURN_SOMES(param, attr, rsindex, pack_count) \
+    auto it = param.indexes.find(attr.col_id);                                          \
+    if (it == param.indexes.end())                                                      \
+        return RSResults(pack_count, Some);                                             \
+    auto rsindex = it->second;                                                          \
+    if (!rsindex.type->equals(*attr.type))                                              \
+        return RSResults(pack_count, Some);
+
 
 // logical
 RSOperatorPtr createNot(const RSOperatorPtr & op);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/MyTime.h>
 #include <Common/TiFlashException.h>
 #include <Flash/Coprocessor/DAGCodec.h>
 #include <Flash/Coprocessor/DAGQueryInfo.h>
@@ -55,7 +56,10 @@ inline bool isRoughSetFilterSupportType(const Int32 field_type)
     case TiDB::TypeDatetime:
     case TiDB::TypeTimestamp: // For timestamp, should take time_zone into consideration while parsing `literal`
         return true;
-    // For these types, should take collation into consideration. Disable them.
+    // The decimal literals are compared with the decimal values of any scale.
+    case TiDB::TypeNewDecimal:
+        return true;
+    // For these types, should take collation into consideration, see `isRoughSetFilterSupportColumn`.
     case TiDB::TypeVarchar:
     case TiDB::TypeJSON:
     case TiDB::TypeTinyBlob:
@@ -67,7 +71,6 @@ inline bool isRoughSetFilterSupportType(const Int32 field_type)
         return false;
     // Unknown.
     case TiDB::TypeDecimal:
-    case TiDB::TypeNewDecimal:
     case TiDB::TypeFloat:
     case TiDB::TypeDouble:
     case TiDB::TypeNull:
@@ -80,6 +83,32 @@ inline bool isRoughSetFilterSupportType(const Int32 field_type)
     return false;
 }
 
+/// The string values are compared in binary by the min-max index, so the string columns are only supported
+/// when they are compared by the binary collation. The other collations, including the `_bin` ones which
+/// ignore the trailing spaces, do not compare in the same order as the min-max index.
+inline bool isRoughSetFilterSupportColumn(const tipb::Expr & column, const tipb::Expr & expr)
+{
+    const auto field_type = column.field_type().tp();
+    if (isRoughSetFilterSupportType(field_type))
+        return true;
+    switch (field_type)
+    {
+    case TiDB::TypeVarchar:
+    case TiDB::TypeTinyBlob:
+    case TiDB::TypeMediumBlob:
+    case TiDB::TypeLongBlob:
+    case TiDB::TypeBlob:
+    case TiDB::TypeVarString:
+    case TiDB::TypeString:
+    {
+        const auto * collator = getCollatorFromExpr(expr);
+        return collator != nullptr && collator->isBinary();
+    }
+    default:
+        return false;
+    }
+}
+
 ColumnID getColumnIDForColumnExpr(const tipb::Expr & expr, const ColumnDefines & columns_to_read)
 {
     assert(isColumnExpr(expr));
@@ -100,6 +129,138 @@ enum class OperandType
     Literal,
 };
 
+/// Convert the literal compared with a timestamp column from the timezone specified in cop request to UTC.
+/// Return false if the type of literal can not be compared with timestamp.
+inline bool convertTimestampLiteral(const tipb::Expr & literal, Field & value, const TimezoneInfo & timezone_info)
+{
+    auto literal_type = literal.field_type().tp();
+    if (unlikely(literal_type != TiDB::TypeTimestamp && literal_type != TiDB::TypeDatetime))
+        return false;
+    if (literal_type == TiDB::TypeDatetime && !timezone_info.is_utc_timezone)
+    {
+        static const auto & time_zone_utc = DateLUT::instance("UTC");
+        UInt64 from_time = value.get<UInt64>();
+        UInt64 result_time = from_time;
+        if (timezone_info.is_name_based)
+            convertTimeZone(from_time, result_time, *timezone_info.timezone, time_zone_utc);
+        else if (timezone_info.timezone_offset != 0)
+            convertTimeZoneByOffset(from_time, result_time, false, timezone_info.timezone_offset);
+        value = Field(result_time);
+    }
+    return true;
+}
+
+/// The functions truncating the date and time values, `func(column)` is monotonic so the compare with
+/// a literal could be rewritten to a range check on `column`, see `getDateFuncBucket`.
+inline bool isDateTruncateFunc(const tipb::Expr & expr)
+{
+    return expr.sig() == tipb::ScalarFuncSig::Year || expr.sig() == tipb::ScalarFuncSig::Date;
+}
+
+/// Get the range [lower, upper) of the packed time of `column` in which `func(column)` equals to `value`.
+/// Return false if `value` is not a possible result of `func`, like `date(column) = '2022-01-01 10:00:00'`.
+inline bool getDateFuncBucket(const tipb::Expr & func, const Field & value, UInt64 & lower, UInt64 & upper)
+{
+    static constexpr Int64 MAX_YEAR = 9999;
+    if (func.sig() == tipb::ScalarFuncSig::Year)
+    {
+        // The zero month or day is valid in the packed time, so the min value of a year is `Y-00-00 00:00:00`.
+        Int64 year;
+        if (value.getType() == Field::Types::UInt64 && value.get<UInt64>() <= MAX_YEAR)
+            year = value.get<UInt64>();
+        else if (value.getType() == Field::Types::Int64 && value.get<Int64>() >= 0 && value.get<Int64>() <= MAX_YEAR)
+            year = value.get<Int64>();
+        else
+            return false;
+        lower = MyDateTime(static_cast<UInt16>(year), 0, 0, 0, 0, 0, 0).toPackedUInt();
+        upper = MyDateTime(static_cast<UInt16>(year + 1), 0, 0, 0, 0, 0, 0).toPackedUInt();
+        return true;
+    }
+    else
+    {
+        // The literal must be a date without time part. The next packed value of the days is the
+        // next day, or the zero day of the next month after the last day of a month.
+        if (value.getType() != Field::Types::UInt64 || (value.get<UInt64>() & ~MyTimeBase::YMD_MASK) != 0)
+            return false;
+        lower = value.get<UInt64>();
+        upper = lower + (1ULL << MyTimeBase::DAY_BIT_FIELD_OFFSET);
+        return true;
+    }
+}
+
+/// Rewrite `year(column)` `op` `literal` and `date(column)` `op` `literal` to the range check on `column`,
+/// so that the min-max index of `column` could be used.
+inline RSOperatorPtr parseTiCompareDateFuncExpr( //
+    const tipb::Expr & expr,
+    const FilterParser::RSFilterType filter_type,
+    const ColumnDefines & columns_to_read,
+    const FilterParser::AttrCreatorByColumnID & creator)
+{
+    bool inverse_cmp = isFunctionExpr(expr.children(1));
+    const auto & func = expr.children(inverse_cmp ? 1 : 0);
+    const auto & literal = expr.children(inverse_cmp ? 0 : 1);
+    if (!isDateTruncateFunc(func) || func.children_size() != 1 || !isLiteralExpr(literal))
+        return createUnsupported(expr.ShortDebugString(), "compare function with " + tipb::ScalarFuncSig_Name(func.sig()) + " is not supported", false);
+
+    // The timestamp column is not supported, the result of function depends on the time_zone
+    // and the boundaries may not be monotonic after converted to UTC because of the DST.
+    const auto & column = func.children(0);
+    if (!isColumnExpr(column) || !column.has_field_type())
+        return createUnsupported(expr.ShortDebugString(), "the argument of " + tipb::ScalarFuncSig_Name(func.sig()) + " is not column", false);
+    auto field_type = column.field_type().tp();
+    if (field_type != TiDB::TypeDate && field_type != TiDB::TypeNewDate && field_type != TiDB::TypeDatetime)
+        return createUnsupported(
+            expr.ShortDebugString(),
+            tipb::ScalarFuncSig_Name(func.sig()) + " of ColumnRef with field type(" + DB::toString(field_type) + ") is not supported",
+            false);
+
+    UInt64 lower = 0;
+    UInt64 upper = 0;
+    if (!getDateFuncBucket(func, decodeLiteral(literal), lower, upper))
+        return createUnsupported(expr.ShortDebugString(), "the literal compared with " + tipb::ScalarFuncSig_Name(func.sig()) + " is not supported", false);
+
+    auto filter_type_with_direction = filter_type;
+    if (inverse_cmp)
+    {
+        switch (filter_type)
+        {
+        case FilterParser::RSFilterType::Greater:
+            filter_type_with_direction = FilterParser::RSFilterType::Less;
+            break;
+        case FilterParser::RSFilterType::GreaterEqual:
+            filter_type_with_direction = FilterParser::RSFilterType::LessEqual;
+            break;
+        case FilterParser::RSFilterType::Less:
+            filter_type_with_direction = FilterParser::RSFilterType::Greater;
+            break;
+        case FilterParser::RSFilterType::LessEqual:
+            filter_type_with_direction = FilterParser::RSFilterType::GreaterEqual;
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto attr = creator(getColumnIDForColumnExpr(column, columns_to_read));
+    switch (filter_type_with_direction)
+    {
+    case FilterParser::RSFilterType::Equal:
+        return createAnd({createGreaterEqual(attr, Field(lower), -1), createLess(attr, Field(upper), -1)});
+    case FilterParser::RSFilterType::NotEqual:
+        return createNot(createAnd({createGreaterEqual(attr, Field(lower), -1), createLess(attr, Field(upper), -1)}));
+    case FilterParser::RSFilterType::Greater:
+        return createGreaterEqual(attr, Field(upper), -1);
+    case FilterParser::RSFilterType::GreaterEqual:
+        return createGreaterEqual(attr, Field(lower), -1);
+    case FilterParser::RSFilterType::Less:
+        return createLess(attr, Field(lower), -1);
+    case FilterParser::RSFilterType::LessEqual:
+        return createLess(attr, Field(upper), -1);
+    default:
+        return createUnsupported(expr.ShortDebugString(), "Unknown compare type: " + tipb::ExprType_Name(expr.tp()), false);
+    }
+}
+
 inline RSOperatorPtr parseTiCompareExpr( //
     const tipb::Expr & expr,
     const FilterParser::RSFilterType filter_type,
@@ -114,7 +275,13 @@ inline RSOperatorPtr parseTiCompareExpr( //
                                      + " children is not supported",
                                  false);
 
-    /// Only support `column` `op` `literal` now.
+    /// Only support `column` `op` `literal` and `func(column)` `op` `literal` now.
+
+    for (const auto & child : expr.children())
+    {
+        if (isFunctionExpr(child))
+            return parseTiCompareDateFuncExpr(expr, filter_type, columns_to_read, creator);
+    }
 
     Attr attr;
     Field value;
@@ -135,7 +302,7 @@ inline RSOperatorPtr parseTiCompareExpr( //
                 return createUnsupported(expr.ShortDebugString(), "ColumnRef with no field type is not supported", false);
 
             auto field_type = child.field_type().tp();
-            if (!isRoughSetFilterSupportType(field_type))
+            if (!isRoughSetFilterSupportColumn(child, expr))
                 return createUnsupported(
                     expr.ShortDebugString(),
                     "ColumnRef with field type(" + DB::toString(field_type) + ") is not supported",
@@ -156,27 +323,11 @@ inline RSOperatorPtr parseTiCompareExpr( //
             else if (child_idx == 1)
                 right = OperandType::Literal;
 
-            if (is_timestamp_column)
-            {
-                auto literal_type = child.field_type().tp();
-                if (unlikely(literal_type != TiDB::TypeTimestamp && literal_type != TiDB::TypeDatetime))
-                    return createUnsupported(expr.ShortDebugString(),
-                                             "Compare timestamp column with literal type(" + DB::toString(literal_type)
-                                                 + ") is not supported",
-                                             false);
-                // convert literal value from timezone specified in cop request to UTC
-                if (literal_type == TiDB::TypeDatetime && !timezone_info.is_utc_timezone)
-                {
-                    static const auto & time_zone_utc = DateLUT::instance("UTC");
-                    UInt64 from_time = value.get<UInt64>();
-                    UInt64 result_time = from_time;
-                    if (timezone_info.is_name_based)
-                        convertTimeZone(from_time, result_time, *timezone_info.timezone, time_zone_utc);
-                    else if (timezone_info.timezone_offset != 0)
-                        convertTimeZoneByOffset(from_time, result_time, false, timezone_info.timezone_offset);
-                    value = Field(result_time);
-                }
-            }
+            if (is_timestamp_column && !convertTimestampLiteral(child, value, timezone_info))
+                return createUnsupported(expr.ShortDebugString(),
+                                         "Compare timestamp column with literal type(" + DB::toString(child.field_type().tp())
+                                             + ") is not supported",
+                                         false);
         }
     }
 
@@ -243,6 +394,108 @@ inline RSOperatorPtr parseTiCompareExpr( //
     return op;
 }
 
+/// Only support `column` IN (`literal`, ...) now.
+inline RSOperatorPtr parseTiInExpr( //
+    const tipb::Expr & expr,
+    const ColumnDefines & columns_to_read,
+    const FilterParser::AttrCreatorByColumnID & creator,
+    const TimezoneInfo & timezone_info)
+{
+    if (unlikely(expr.children_size() < 2))
+        return createUnsupported(expr.ShortDebugString(), tipb::ScalarFuncSig_Name(expr.sig()) + " without values is not supported", false);
+
+    const auto & column = expr.children(0);
+    if (!isColumnExpr(column))
+        return createUnsupported(expr.ShortDebugString(), "the left side of in is not column", false);
+    if (unlikely(!column.has_field_type()))
+        return createUnsupported(expr.ShortDebugString(), "ColumnRef with no field type is not supported", false);
+    auto field_type = column.field_type().tp();
+    if (!isRoughSetFilterSupportColumn(column, expr))
+        return createUnsupported(
+            expr.ShortDebugString(),
+            "ColumnRef with field type(" + DB::toString(field_type) + ") is not supported",
+            false);
+    bool is_timestamp_column = (field_type == TiDB::TypeTimestamp);
+
+    Fields values;
+    values.reserve(expr.children_size() - 1);
+    for (Int32 i = 1; i < expr.children_size(); ++i)
+    {
+        const auto & child = expr.children(i);
+        if (!isLiteralExpr(child))
+            return createUnsupported(expr.ShortDebugString(), "value of in is not literal", false);
+        Field value = decodeLiteral(child);
+        // NULL never matches any row, ignore it
+        if (value.isNull())
+            continue;
+        if (is_timestamp_column && !convertTimestampLiteral(child, value, timezone_info))
+            return createUnsupported(expr.ShortDebugString(),
+                                     "Compare timestamp column with literal type(" + DB::toString(child.field_type().tp())
+                                         + ") is not supported",
+                                     false);
+        values.emplace_back(std::move(value));
+    }
+    if (values.empty())
+        return createUnsupported(expr.ShortDebugString(), "all values of in are null", false);
+
+    return createIn(creator(getColumnIDForColumnExpr(column, columns_to_read)), values);
+}
+
+/// Only support `column` LIKE `literal` with the binary collation now, the packs are filtered by the constant
+/// prefix of the pattern.
+inline RSOperatorPtr parseTiLikeExpr( //
+    const tipb::Expr & expr,
+    const ColumnDefines & columns_to_read,
+    const FilterParser::AttrCreatorByColumnID & creator)
+{
+    if (unlikely(expr.children_size() != 3))
+        return createUnsupported(expr.ShortDebugString(), "like with " + DB::toString(expr.children_size()) + " children is not supported", false);
+
+    const auto & column = expr.children(0);
+    const auto & pattern_expr = expr.children(1);
+    const auto & escape_expr = expr.children(2);
+    if (!isColumnExpr(column) || !isLiteralExpr(pattern_expr) || !isLiteralExpr(escape_expr))
+        return createUnsupported(expr.ShortDebugString(), "only `column` like `literal` is supported", false);
+    if (unlikely(!column.has_field_type()))
+        return createUnsupported(expr.ShortDebugString(), "ColumnRef with no field type is not supported", false);
+    // The string columns are only supported with the binary collation
+    auto field_type = column.field_type().tp();
+    if (isRoughSetFilterSupportType(field_type) || !isRoughSetFilterSupportColumn(column, expr))
+        return createUnsupported(
+            expr.ShortDebugString(),
+            "like on ColumnRef with field type(" + DB::toString(field_type) + ") is not supported",
+            false);
+
+    Field pattern_field = decodeLiteral(pattern_expr);
+    Field escape_field = decodeLiteral(escape_expr);
+    if (pattern_field.getType() != Field::Types::String
+        || (escape_field.getType() != Field::Types::Int64 && escape_field.getType() != Field::Types::UInt64))
+        return createUnsupported(expr.ShortDebugString(), "the pattern or escape of like is not supported", false);
+    const auto & pattern = pattern_field.get<String>();
+    const auto escape_char = static_cast<UInt8>(escape_field.getType() == Field::Types::Int64 ? escape_field.get<Int64>() : escape_field.get<UInt64>());
+
+    // Extract the constant prefix before the first wildcard
+    String prefix;
+    size_t pos = 0;
+    for (; pos < pattern.size(); ++pos)
+    {
+        char c = pattern[pos];
+        if (c == '%' || c == '_')
+            break;
+        if (static_cast<UInt8>(c) == escape_char && pos + 1 < pattern.size())
+            c = pattern[++pos];
+        prefix.push_back(c);
+    }
+
+    auto attr = creator(getColumnIDForColumnExpr(column, columns_to_read));
+    // No wildcard at all, it is the same as `column` = `literal` with the binary collation
+    if (pos == pattern.size())
+        return createEqual(attr, Field(prefix));
+    if (prefix.empty())
+        return createUnsupported(expr.ShortDebugString(), "the pattern of like starts with a wildcard", false);
+    return createLike(attr, Field(prefix));
+}
+
 RSOperatorPtr parseTiExpr(const tipb::Expr & expr,
                           const ColumnDefines & columns_to_read,
                           const FilterParser::AttrCreatorByColumnID & creator,
@@ -311,8 +564,14 @@ RSOperatorPtr parseTiExpr(const tipb::Expr & expr,
             break;
 
         case FilterParser::RSFilterType::In:
-        case FilterParser::RSFilterType::NotIn:
+            op = parseTiInExpr(expr, columns_to_read, creator, timezone_info);
+            break;
+
         case FilterParser::RSFilterType::Like:
+            op = parseTiLikeExpr(expr, columns_to_read, creator);
+            break;
+
+        case FilterParser::RSFilterType::NotIn:
         case FilterParser::RSFilterType::NotLike:
         case FilterParser::RSFilterType::Unsupported:
             op = createUnsupported(expr.ShortDebugString(), tipb::ScalarFuncSig_Name(expr.sig()) + " is not supported", false);
@@ -436,6 +695,12 @@ std::unordered_map<tipb::ScalarFuncSig, FilterParser::RSFilterType> FilterParser
     {tipb::ScalarFuncSig::CoalesceJson, "coalesce"},
     */
 
+    {tipb::ScalarFuncSig::InInt, FilterParser::RSFilterType::In},
+    {tipb::ScalarFuncSig::InReal, FilterParser::RSFilterType::In},
+    {tipb::ScalarFuncSig::InDecimal, FilterParser::RSFilterType::In},
+    {tipb::ScalarFuncSig::InTime, FilterParser::RSFilterType::In},
+    {tipb::ScalarFuncSig::InDuration, FilterParser::RSFilterType::In},
+
     {tipb::ScalarFuncSig::LTInt, FilterParser::RSFilterType::Less},
     {tipb::ScalarFuncSig::LTReal, FilterParser::RSFilterType::Less},
     {tipb::ScalarFuncSig::LTString, FilterParser::RSFilterType::Less},
@@ -705,7 +970,7 @@ std::unordered_map<tipb::ScalarFuncSig, FilterParser::RSFilterType> FilterParser
     //{tipb::ScalarFuncSig::IsIPv6, "cast"},
     //{tipb::ScalarFuncSig::UUID, "cast"},
 
-    // {tipb::ScalarFuncSig::LikeSig, "like3Args"},
+    {tipb::ScalarFuncSig::LikeSig, FilterParser::RSFilterType::Like},
     //{tipb::ScalarFuncSig::RegexpBinarySig, "cast"},
     //{tipb::ScalarFuncSig::RegexpSig, "cast"},
 
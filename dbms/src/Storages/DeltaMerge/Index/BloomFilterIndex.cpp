@@ -0,0 +1,172 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <Common/HashTable/Hash.h>
+#include <Common/TiFlashException.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <IO/ReadHelpers.h>
+#include <IO/WriteHelpers.h>
+#include <Storages/DeltaMerge/Index/BloomFilterIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace DB
+{
+namespace DM
+{
+namespace
+{
+inline UInt32 calculateHashCount(size_t bits_per_key)
+{
+    // ln(2) * bits_per_key is the optimal hash count, limit it in a reasonable range to reduce probing cost.
+    auto count = static_cast<UInt32>(std::round(bits_per_key * 0.69));
+    return std::clamp<UInt32>(count, 1, 30);
+}
+
+/// Apply `f(bit_position)` for each bit of `key` by double hashing on `num_bits` bits.
+template <typename F>
+inline void forEachBit(UInt64 key, UInt32 hash_count, UInt64 num_bits, F && f)
+{
+    UInt64 h1 = intHash64(key);
+    UInt64 h2 = (h1 >> 32) | (h1 << 32) | 1; // make sure h2 is odd
+    for (UInt32 i = 0; i < hash_count; ++i)
+    {
+        if (!f((h1 + i * h2) % num_bits))
+            break;
+    }
+}
+
+/// Map the field to the same bits of `IColumn::get64` on integer columns.
+/// Return false if the field can not be compared with an integer column by bits.
+inline bool fieldToKey(const Field & value, UInt64 & key)
+{
+    switch (value.getType())
+    {
+    case Field::Types::UInt64:
+        key = value.get<UInt64>();
+        return true;
+    case Field::Types::Int64:
+        key = static_cast<UInt64>(value.get<Int64>());
+        return true;
+    default:
+        return false;
+    }
+}
+} // namespace
+
+BloomFilterIndex::BloomFilterIndex(size_t bits_per_key_)
+    : hash_count(calculateHashCount(bits_per_key_))
+    , bits_per_key(bits_per_key_)
+    , word_offsets(1, 0)
+{}
+
+bool BloomFilterIndex::isSupportedType(const IDataType & type)
+{
+    if (type.isNullable())
+        return static_cast<const DataTypeNullable &>(type).getNestedType()->isInteger();
+    return type.isInteger();
+}
+
+void BloomFilterIndex::addPack(const IColumn & column)
+{
+    const IColumn * nested = &column;
+    const NullMap * null_map = nullptr;
+    if (column.isColumnNullable())
+    {
+        const auto & nullable_column = static_cast<const ColumnNullable &>(column);
+        nested = &nullable_column.getNestedColumn();
+        null_map = &nullable_column.getNullMapData();
+    }
+
+    size_t rows = column.size();
+    size_t num_words = (rows * bits_per_key + 63) / 64;
+    size_t begin = words.size();
+    words.resize_fill(begin + num_words, 0);
+    word_offsets.push_back(words.size());
+    if (num_words == 0)
+        return;
+
+    UInt64 * bitmap = words.data() + begin;
+    UInt64 num_bits = num_words * 64;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (null_map && (*null_map)[i])
+            continue;
+        forEachBit(nested->get64(i), hash_count, num_bits, [&](UInt64 pos) {
+            bitmap[pos / 64] |= (1ULL << (pos % 64));
+            return true;
+        });
+    }
+}
+
+void BloomFilterIndex::write(WriteBuffer & buf) const
+{
+    UInt64 size = packCount();
+    DB::writeIntBinary(size, buf);
+    DB::writeIntBinary(hash_count, buf);
+    buf.write(reinterpret_cast<const char *>(word_offsets.data()), sizeof(UInt64) * (size + 1));
+    buf.write(reinterpret_cast<const char *>(words.data()), sizeof(UInt64) * words.size());
+}
+
+BloomFilterIndexPtr BloomFilterIndex::read(ReadBuffer & buf, size_t bytes_limit)
+{
+    size_t buf_pos = buf.count();
+    UInt64 size = 0;
+    UInt32 hash_count = 0;
+    DB::readIntBinary(size, buf);
+    DB::readIntBinary(hash_count, buf);
+    PaddedPODArray<UInt64> word_offsets(size + 1);
+    buf.readStrict(reinterpret_cast<char *>(word_offsets.data()), sizeof(UInt64) * (size + 1));
+    PaddedPODArray<UInt64> words(word_offsets.back());
+    buf.readStrict(reinterpret_cast<char *>(words.data()), sizeof(UInt64) * words.size());
+
+    size_t bytes_read = buf.count() - buf_pos;
+    if (unlikely(bytes_read != bytes_limit))
+    {
+        throw DB::TiFlashException("Bad file format: expected read bloom filter content size: " + std::to_string(bytes_limit)
+                                       + " vs. actual: " + std::to_string(bytes_read),
+                                   Errors::DeltaTree::Internal);
+    }
+    return BloomFilterIndexPtr(new BloomFilterIndex(hash_count, std::move(word_offsets), std::move(words)));
+}
+
+bool BloomFilterIndex::mayContain(size_t pack_index, UInt64 key) const
+{
+    UInt64 begin = word_offsets[pack_index];
+    UInt64 num_words = word_offsets[pack_index + 1] - begin;
+    if (num_words == 0)
+        return false;
+
+    const UInt64 * bitmap = words.data() + begin;
+    bool found = true;
+    forEachBit(key, hash_count, num_words * 64, [&](UInt64 pos) {
+        found = bitmap[pos / 64] & (1ULL << (pos % 64));
+        return found;
+    });
+    return found;
+}
+
+RSResult BloomFilterIndex::checkEqual(size_t pack_index, const Field & value, const DataTypePtr & type) const
+{
+    UInt64 key = 0;
+    if (!isSupportedType(*type) || !fieldToKey(value, key))
+        return RSResult::Some;
+    return mayContain(pack_index, key) ? RSResult::Some : RSResult::None;
+}
+
+} // namespace DM
+} // namespace DB
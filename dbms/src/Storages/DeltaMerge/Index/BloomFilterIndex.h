@@ -0,0 +1,107 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/LRUCache.h>
+#include <Common/PODArray.h>
+#include <Core/Field.h>
+#include <DataTypes/IDataType.h>
+#include <IO/ReadBuffer.h>
+#include <IO/WriteBuffer.h>
+#include <Storages/DeltaMerge/Index/RSIndex.h>
+
+namespace DB
+{
+namespace DM
+{
+class BloomFilterIndex;
+using BloomFilterIndexPtr = std::shared_ptr<BloomFilterIndex>;
+
+/// A per-pack bloom filter for checking `col = value` and `col in (...)`.
+/// Unlike MinMaxIndex, it could exclude packs with scattered values, which is common for high cardinality columns like ids.
+/// Only integer columns are supported for now. The bloom filter never gives false negative, so it could only turn a `Some` into `None`.
+class BloomFilterIndex : public EqualIndex
+{
+private:
+    /// The number of bits set for each value.
+    UInt32 hash_count;
+    /// The number of bits used for each value when building the index. Not serialized.
+    size_t bits_per_key;
+
+    /// The bitmap of the i-th pack is `words[word_offsets[i], word_offsets[i + 1])`.
+    PaddedPODArray<UInt64> word_offsets;
+    PaddedPODArray<UInt64> words;
+
+    BloomFilterIndex(UInt32 hash_count_, PaddedPODArray<UInt64> && word_offsets_, PaddedPODArray<UInt64> && words_)
+        : hash_count(hash_count_)
+        , bits_per_key(0)
+        , word_offsets(std::move(word_offsets_))
+        , words(std::move(words_))
+    {}
+
+public:
+    explicit BloomFilterIndex(size_t bits_per_key_);
+
+    static bool isSupportedType(const IDataType & type);
+
+    size_t byteSize() const { return sizeof(UInt64) * word_offsets.size() + sizeof(UInt64) * words.size(); }
+
+    size_t packCount() const { return word_offsets.size() - 1; }
+
+    /// Null values and deleted rows are also added, which only makes the filter less selective.
+    void addPack(const IColumn & column);
+
+    void write(WriteBuffer & buf) const;
+
+    static BloomFilterIndexPtr read(ReadBuffer & buf, size_t bytes_limit);
+
+    /// Return `None` if `value` is definitely not in the pack, otherwise `Some`.
+    RSResult checkEqual(size_t pack_index, const Field & value, const DataTypePtr & type) const override;
+
+private:
+    bool mayContain(size_t pack_index, UInt64 key) const;
+};
+
+
+struct BloomFilterIndexWeightFunction
+{
+    size_t operator()(const BloomFilterIndex & index) const { return index.byteSize(); }
+};
+
+
+class BloomFilterIndexCache : public LRUCache<String, BloomFilterIndex, std::hash<String>, BloomFilterIndexWeightFunction>
+{
+private:
+    using Base = LRUCache<String, BloomFilterIndex, std::hash<String>, BloomFilterIndexWeightFunction>;
+
+public:
+    BloomFilterIndexCache(size_t max_size_in_bytes, const Delay & expiration_delay)
+        : Base(max_size_in_bytes, expiration_delay)
+    {}
+
+    template <typename LoadFunc>
+    MappedPtr getOrSet(const Key & key, LoadFunc && load)
+    {
+        auto result = Base::getOrSet(key, load);
+        return result.first;
+    }
+};
+
+using BloomFilterIndexCachePtr = std::shared_ptr<BloomFilterIndexCache>;
+
+} // namespace DM
+
+} // namespace DB
@@ -12,11 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Columns/ColumnDecimal.h>
 #include <Columns/ColumnString.h>
 #include <Columns/ColumnVector.h>
 #include <Columns/IColumn.h>
 #include <DataTypes/DataTypeDate.h>
 #include <DataTypes/DataTypeDateTime.h>
+#include <DataTypes/DataTypeDecimal.h>
 #include <DataTypes/DataTypeEnum.h>
 #include <DataTypes/DataTypeFixedString.h>
 #include <DataTypes/DataTypeMyDate.h>
@@ -37,16 +39,18 @@ static constexpr size_t NONE_EXIST = std::numeric_limits<size_t>::max();
 
 namespace details
 {
+/// The min max of the not deleted and not null values.
 inline std::pair<size_t, size_t> minmax(const IColumn & column, const ColumnVector<UInt8> * del_mark, size_t offset, size_t limit)
 {
     const auto * del_mark_data = (!del_mark) ? nullptr : &(del_mark->getData());
+    const auto * null_map = column.isColumnNullable() ? &(static_cast<const ColumnNullable &>(column).getNullMapData()) : nullptr;
 
     size_t batch_min_idx = NONE_EXIST;
     size_t batch_max_idx = NONE_EXIST;
 
     for (size_t i = offset; i < offset + limit; ++i)
     {
-        if (!del_mark_data || !(*del_mark_data)[i])
+        if ((!del_mark_data || !(*del_mark_data)[i]) && (!null_map || !(*null_map)[i]))
         {
             if (batch_min_idx == NONE_EXIST || column.compareAt(i, batch_min_idx, column, -1) < 0)
                 batch_min_idx = i;
@@ -57,9 +61,35 @@ inline std::pair<size_t, size_t> minmax(const IColumn & column, const ColumnVect
 
     return {batch_min_idx, batch_max_idx};
 }
+
+/// Truncate the string bounds longer than `MinMaxIndex::STRING_BOUND_MAX_BYTES`. The min is truncated to its prefix.
+/// The max is truncated to its prefix with the last byte increased, or kept as it is if all the bytes are 0xFF.
+/// The truncated bounds are still the lower and upper bounds of the values.
+inline void insertStringBound(IColumn & minmaxes, const IColumn & column, const IColumn & string_column, size_t index, bool is_max)
+{
+    auto value = string_column.getDataAt(index);
+    if (value.size <= MinMaxIndex::STRING_BOUND_MAX_BYTES)
+    {
+        minmaxes.insertFrom(column, index);
+        return;
+    }
+    String bound(value.data, MinMaxIndex::STRING_BOUND_MAX_BYTES);
+    if (is_max)
+    {
+        while (!bound.empty() && static_cast<UInt8>(bound.back()) == 0xFF)
+            bound.pop_back();
+        if (bound.empty())
+        {
+            minmaxes.insertFrom(column, index);
+            return;
+        }
+        bound.back() = static_cast<char>(static_cast<UInt8>(bound.back()) + 1);
+    }
+    minmaxes.insert(Field(bound));
+}
 } // namespace details
 
-void MinMaxIndex::addPack(const IColumn & column, const ColumnVector<UInt8> * del_mark)
+void MinMaxIndex::addPack(const IColumn & column, const ColumnVector<UInt8> * del_mark, bool truncate_string_bounds)
 {
     auto size = column.size();
     bool has_null = false;
@@ -85,13 +115,23 @@ void MinMaxIndex::addPack(const IColumn & column, const ColumnVector<UInt8> * de
     {
         has_null_marks->push_back(has_null);
         has_value_marks->push_back(1);
-        minmaxes->insertFrom(column, min_index);
-        minmaxes->insertFrom(column, max_index);
+        const auto & nested_column = column.isColumnNullable() ? static_cast<const ColumnNullable &>(column).getNestedColumn() : column;
+        if (truncate_string_bounds && checkAndGetColumn<ColumnString>(&nested_column))
+        {
+            details::insertStringBound(*minmaxes, column, nested_column, min_index, false);
+            details::insertStringBound(*minmaxes, column, nested_column, max_index, true);
+        }
+        else
+        {
+            minmaxes->insertFrom(column, min_index);
+            minmaxes->insertFrom(column, max_index);
+        }
     }
     else
     {
+        // If all the not deleted values are null, the pack has value and its min max are null.
         has_null_marks->push_back(has_null);
-        has_value_marks->push_back(0);
+        has_value_marks->push_back(has_null);
         minmaxes->insertDefault();
         minmaxes->insertDefault();
     }
@@ -155,358 +195,179 @@ std::pair<UInt64, UInt64> MinMaxIndex::getUInt64MinMax(size_t pack_index)
     return {minmaxes->get64(pack_index * 2), minmaxes->get64(pack_index * 2 + 1)};
 }
 
-RSResult MinMaxIndex::checkNullableEqual(size_t pack_index, const Field & value, const DataTypePtr & type)
+std::pair<Field, Field> MinMaxIndex::getFieldMinMax(size_t pack_index)
 {
-    const auto & column_nullable = static_cast<const ColumnNullable &>(*minmaxes);
-
-    const auto * raw_type = type.get();
+    if (!(*has_value_marks)[pack_index])
+        return {Field{}, Field{}};
+    return {(*minmaxes)[pack_index * 2], (*minmaxes)[pack_index * 2 + 1]};
+}
 
-#define DISPATCH(TYPE)                                                                         \
-    if (typeid_cast<const DataType##TYPE *>(raw_type))                                         \
-    {                                                                                          \
-        auto & minmaxes_data = toColumnVectorData<TYPE>(column_nullable.getNestedColumnPtr()); \
-        auto min = minmaxes_data[pack_index * 2];                                              \
-        auto max = minmaxes_data[pack_index * 2 + 1];                                          \
-        return RoughCheck::checkEqual<TYPE>(value, type, min, max);                            \
-    }
-    FOR_NUMERIC_TYPES(DISPATCH)
-#undef DISPATCH
-    if (typeid_cast<const DataTypeDate *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDate::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkEqual<DataTypeDate::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeDateTime *>(raw_type))
+namespace details
+{
+struct CheckEqual
+{
+    template <typename T>
+    static RSResult check(const Field & value, const DataTypePtr & type, const T & min, const T & max)
     {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDateTime::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkEqual<DataTypeDateTime::FieldType>(value, type, min, max);
+        return RoughCheck::checkEqual<T>(value, type, min, max);
     }
-    if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
+};
+
+struct CheckGreater
+{
+    template <typename T>
+    static RSResult check(const Field & value, const DataTypePtr & type, const T & min, const T & max)
     {
-        // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
-        // Check `struct MyTimeBase` for more details.
-        const auto & minmaxes_data = toColumnVectorData<DataTypeMyTimeBase::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkEqual<DataTypeMyTimeBase::FieldType>(value, type, min, max);
+        return RoughCheck::checkGreater<T>(value, type, min, max);
     }
-    if (typeid_cast<const DataTypeString *>(raw_type))
+};
+
+struct CheckGreaterEqual
+{
+    template <typename T>
+    static RSResult check(const Field & value, const DataTypePtr & type, const T & min, const T & max)
     {
-        const auto * string_column = checkAndGetColumn<ColumnString>(column_nullable.getNestedColumnPtr().get());
-        const auto & chars = string_column->getChars();
-        const auto & offsets = string_column->getOffsets();
-        size_t pos = pack_index * 2;
-        size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
-        // todo use StringRef instead of String
-        auto min = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        pos = pack_index * 2 + 1;
-        prev_offset = offsets[pos - 1];
-        auto max = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        return RoughCheck::checkEqual<String>(value, type, min, max);
+        return RoughCheck::checkGreaterEqual<T>(value, type, min, max);
     }
-    return RSResult::Some;
-}
+};
+} // namespace details
 
-RSResult MinMaxIndex::checkEqual(size_t pack_index, const Field & value, const DataTypePtr & type)
+template <typename Checker>
+RSResults MinMaxIndex::checkBatch(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type)
 {
-    if ((*has_null_marks)[pack_index] || value.isNull())
-        return RSResult::Some;
-    if (!(*has_value_marks)[pack_index])
-        return RSResult::None;
+    RSResults results(pack_count, RSResult::Some);
+    if (value.isNull())
+        return results;
 
-    // if minmaxes_data has null value, the value of minmaxes_data[i] is meaningless and maybe just some random value.
-    // But we have checked the has_null_marks above and ensured that there is no null value in MinMax Indexes.
-    const auto * raw_type = type.get();
-    if (typeid_cast<const DataTypeNullable *>(raw_type))
+    // The min max of a nullable column are the min max of its not null values, check them by the nested type and column.
+    DataTypePtr check_type = type;
+    const IColumn * column = minmaxes.get();
+    const ColumnNullable * nullable_minmaxes = nullptr;
+    if (typeid_cast<const DataTypeNullable *>(type.get()))
     {
-        return checkNullableEqual(pack_index, value, removeNullable(type));
+        check_type = removeNullable(type);
+        nullable_minmaxes = &static_cast<const ColumnNullable &>(*minmaxes);
+        column = &nullable_minmaxes->getNestedColumn();
     }
-#define DISPATCH(TYPE)                                              \
-    if (typeid_cast<const DataType##TYPE *>(raw_type))              \
-    {                                                               \
-        auto & minmaxes_data = toColumnVectorData<TYPE>(minmaxes);  \
-        auto min = minmaxes_data[pack_index * 2];                   \
-        auto max = minmaxes_data[pack_index * 2 + 1];               \
-        return RoughCheck::checkEqual<TYPE>(value, type, min, max); \
+    const auto * raw_type = check_type.get();
+
+    const auto & null_marks = *has_null_marks;
+    const auto & value_marks = *has_value_marks;
+    auto check_packs = [&](auto && check_pack) {
+        for (size_t i = 0; i < pack_count; ++i)
+        {
+            const size_t pack_index = start_pack + i;
+            if (!value_marks[pack_index])
+            {
+                results[i] = RSResult::None;
+            }
+            else if (null_marks[pack_index])
+            {
+                // Comparing with null is never true, so the values out of the min max could be excluded.
+                // But the pack is never All because of the null values.
+                if (nullable_minmaxes->isNullAt(pack_index * 2 + 1))
+                    results[i] = RSResult::None; // All the values are null.
+                else if (nullable_minmaxes->isNullAt(pack_index * 2))
+                    results[i] = RSResult::Some; // The min is null in the files written by the old versions.
+                else if (auto res = check_pack(pack_index); res != RSResult::All)
+                    results[i] = res;
+            }
+            else
+            {
+                results[i] = check_pack(pack_index);
+            }
+        }
+    };
+    auto check_vector = [&](const auto & minmaxes_data) {
+        check_packs([&](size_t pack_index) {
+            return Checker::check(value, check_type, minmaxes_data[pack_index * 2], minmaxes_data[pack_index * 2 + 1]);
+        });
+    };
+
+#define DISPATCH(TYPE)                                   \
+    if (typeid_cast<const DataType##TYPE *>(raw_type))   \
+    {                                                    \
+        check_vector(toColumnVectorData<TYPE>(*column)); \
+        return results;                                  \
     }
     FOR_NUMERIC_TYPES(DISPATCH)
+#undef DISPATCH
+#define DISPATCH(TYPE)                                                                                     \
+    if (const auto * decimal_type = typeid_cast<const DataTypeDecimal<TYPE> *>(raw_type))                  \
+    {                                                                                                      \
+        const auto & minmaxes_data = static_cast<const ColumnDecimal<TYPE> &>(*column).getData();          \
+        const auto scale = decimal_type->getScale();                                                       \
+        check_packs([&](size_t pack_index) {                                                               \
+            return Checker::check(value,                                                                   \
+                                  check_type,                                                              \
+                                  DecimalField<TYPE>(minmaxes_data[pack_index * 2], scale),                \
+                                  DecimalField<TYPE>(minmaxes_data[pack_index * 2 + 1], scale));           \
+        });                                                                                                \
+        return results;                                                                                    \
+    }
+    DISPATCH(Decimal32)
+    DISPATCH(Decimal64)
+    DISPATCH(Decimal128)
+    DISPATCH(Decimal256)
 #undef DISPATCH
     if (typeid_cast<const DataTypeDate *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDate::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkEqual<DataTypeDate::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeDateTime *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDateTime::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkEqual<DataTypeDateTime::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
-    {
-        // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
-        // Check `struct MyTimeBase` for more details.
-        const auto & minmaxes_data = toColumnVectorData<DataTypeMyTimeBase::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkEqual<DataTypeMyTimeBase::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeString *>(raw_type))
-    {
-        const auto * string_column = checkAndGetColumn<ColumnString>(minmaxes.get());
+        check_vector(toColumnVectorData<DataTypeDate::FieldType>(*column));
+    else if (typeid_cast<const DataTypeDateTime *>(raw_type))
+        check_vector(toColumnVectorData<DataTypeDateTime::FieldType>(*column));
+    // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
+    // Check `struct MyTimeBase` for more details.
+    else if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
+        check_vector(toColumnVectorData<DataTypeMyTimeBase::FieldType>(*column));
+    else if (typeid_cast<const DataTypeString *>(raw_type))
+    {
+        // The min max could be the truncated bounds, see `addPack`. They are still the lower and upper bounds
+        // of the pack, and the min is never equal to the max after truncation.
+        const auto * string_column = checkAndGetColumn<ColumnString>(column);
         const auto & chars = string_column->getChars();
         const auto & offsets = string_column->getOffsets();
-        size_t pos = pack_index * 2;
-        size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
-        // todo use StringRef instead of String
-        auto min = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        pos = pack_index * 2 + 1;
-        prev_offset = offsets[pos - 1];
-        auto max = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        return RoughCheck::checkEqual<String>(value, type, min, max);
+        auto get_string = [&](size_t pos) {
+            size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
+            return String(reinterpret_cast<const char *>(&chars[prev_offset]), offsets[pos] - prev_offset - 1);
+        };
+        check_packs([&](size_t pack_index) {
+            return Checker::check(value, check_type, get_string(pack_index * 2), get_string(pack_index * 2 + 1));
+        });
+    }
+    else
+    {
+        check_packs([](size_t) { return RSResult::Some; });
     }
-    return RSResult::Some;
+    return results;
 }
 
-RSResult MinMaxIndex::checkNullableGreater(size_t pack_index, const Field & value, const DataTypePtr & type)
+RSResults MinMaxIndex::checkEqual(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type)
 {
-    const auto & column_nullable = static_cast<const ColumnNullable &>(*minmaxes);
-    const auto * raw_type = type.get();
-
-#define DISPATCH(TYPE)                                                                         \
-    if (typeid_cast<const DataType##TYPE *>(raw_type))                                         \
-    {                                                                                          \
-        auto & minmaxes_data = toColumnVectorData<TYPE>(column_nullable.getNestedColumnPtr()); \
-        auto min = minmaxes_data[pack_index * 2];                                              \
-        auto max = minmaxes_data[pack_index * 2 + 1];                                          \
-        return RoughCheck::checkGreater<TYPE>(value, type, min, max);                          \
-    }
-    FOR_NUMERIC_TYPES(DISPATCH)
-#undef DISPATCH
-    if (typeid_cast<const DataTypeDate *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDate::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreater<DataTypeDate::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeDateTime *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDateTime::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreater<DataTypeDateTime::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
-    {
-        // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
-        // Check `struct MyTimeBase` for more details.
-        const auto & minmaxes_data = toColumnVectorData<DataTypeMyTimeBase::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreater<DataTypeMyTimeBase::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeString *>(raw_type))
-    {
-        const auto * string_column = checkAndGetColumn<ColumnString>(column_nullable.getNestedColumnPtr().get());
-        const auto & chars = string_column->getChars();
-        const auto & offsets = string_column->getOffsets();
-        size_t pos = pack_index * 2;
-        size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
-        // todo use StringRef instead of String
-        auto min = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        pos = pack_index * 2 + 1;
-        prev_offset = offsets[pos - 1];
-        auto max = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        return RoughCheck::checkGreater<String>(value, type, min, max);
-    }
-    return RSResult::Some;
+    return checkBatch<details::CheckEqual>(start_pack, pack_count, value, type);
 }
 
-RSResult MinMaxIndex::checkGreater(size_t pack_index, const Field & value, const DataTypePtr & type, int /*nan_direction_hint*/)
+RSResults MinMaxIndex::checkGreater(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type, int /*nan_direction_hint*/)
 {
-    if ((*has_null_marks)[pack_index] || value.isNull())
-        return RSResult::Some;
-    if (!(*has_value_marks)[pack_index])
-        return RSResult::None;
+    return checkBatch<details::CheckGreater>(start_pack, pack_count, value, type);
+}
 
-    const auto * raw_type = type.get();
-    if (typeid_cast<const DataTypeNullable *>(raw_type))
-    {
-        return checkNullableGreater(pack_index, value, removeNullable(type));
-    }
-#define DISPATCH(TYPE)                                                \
-    if (typeid_cast<const DataType##TYPE *>(raw_type))                \
-    {                                                                 \
-        auto & minmaxes_data = toColumnVectorData<TYPE>(minmaxes);    \
-        auto min = minmaxes_data[pack_index * 2];                     \
-        auto max = minmaxes_data[pack_index * 2 + 1];                 \
-        return RoughCheck::checkGreater<TYPE>(value, type, min, max); \
-    }
-    FOR_NUMERIC_TYPES(DISPATCH)
-#undef DISPATCH
-    if (typeid_cast<const DataTypeDate *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDate::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreater<DataTypeDate::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeDateTime *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDateTime::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreater<DataTypeDateTime::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
-    {
-        // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
-        // Check `struct MyTimeBase` for more details.
-        const auto & minmaxes_data = toColumnVectorData<DataTypeMyTimeBase::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreater<DataTypeMyTimeBase::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeString *>(raw_type))
-    {
-        const auto * string_column = checkAndGetColumn<ColumnString>(minmaxes.get());
-        const auto & chars = string_column->getChars();
-        const auto & offsets = string_column->getOffsets();
-        size_t pos = pack_index * 2;
-        size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
-        // todo use StringRef instead of String
-        auto min = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        pos = pack_index * 2 + 1;
-        prev_offset = offsets[pos - 1];
-        auto max = String(chars[prev_offset], offsets[pos] - prev_offset - 1);
-        return RoughCheck::checkGreater<String>(value, type, min, max);
-    }
-    return RSResult::Some;
+RSResults MinMaxIndex::checkGreaterEqual(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type, int /*nan_direction_hint*/)
+{
+    return checkBatch<details::CheckGreaterEqual>(start_pack, pack_count, value, type);
 }
 
-RSResult MinMaxIndex::checkNullableGreaterEqual(size_t pack_index, const Field & value, const DataTypePtr & type)
+RSResult MinMaxIndex::checkEqual(size_t pack_index, const Field & value, const DataTypePtr & type)
 {
-    const auto & column_nullable = static_cast<const ColumnNullable &>(*minmaxes);
-
-    const auto * raw_type = type.get();
-#define DISPATCH(TYPE)                                                                         \
-    if (typeid_cast<const DataType##TYPE *>(raw_type))                                         \
-    {                                                                                          \
-        auto & minmaxes_data = toColumnVectorData<TYPE>(column_nullable.getNestedColumnPtr()); \
-        auto min = minmaxes_data[pack_index * 2];                                              \
-        auto max = minmaxes_data[pack_index * 2 + 1];                                          \
-        return RoughCheck::checkGreaterEqual<TYPE>(value, type, min, max);                     \
-    }
-    FOR_NUMERIC_TYPES(DISPATCH)
-#undef DISPATCH
-    if (typeid_cast<const DataTypeDate *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDate::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreaterEqual<DataTypeDate::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeDateTime *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDateTime::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreaterEqual<DataTypeDateTime::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
-    {
-        // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
-        // Check `struct MyTimeBase` for more details.
-        const auto & minmaxes_data = toColumnVectorData<DataTypeMyTimeBase::FieldType>(column_nullable.getNestedColumnPtr());
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreaterEqual<DataTypeMyTimeBase::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeString *>(raw_type))
-    {
-        const auto * string_column = checkAndGetColumn<ColumnString>(column_nullable.getNestedColumnPtr().get());
-        const auto & chars = string_column->getChars();
-        const auto & offsets = string_column->getOffsets();
-        size_t pos = pack_index * 2;
-        size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
-        // todo use StringRef instead of String
-        auto min = String(reinterpret_cast<const char *>(&chars[prev_offset]), offsets[pos] - prev_offset - 1);
-        pos = pack_index * 2 + 1;
-        prev_offset = offsets[pos - 1];
-        auto max = String(reinterpret_cast<const char *>(&chars[prev_offset]), offsets[pos] - prev_offset - 1);
-        return RoughCheck::checkGreaterEqual<String>(value, type, min, max);
-    }
-    return RSResult::Some;
+    return checkBatch<details::CheckEqual>(pack_index, 1, value, type)[0];
 }
 
-RSResult MinMaxIndex::checkGreaterEqual(size_t pack_index, const Field & value, const DataTypePtr & type, int /*nan_direction_hint*/)
+RSResult MinMaxIndex::checkGreater(size_t pack_index, const Field & value, const DataTypePtr & type, int /*nan_direction_hint*/)
 {
-    if ((*has_null_marks)[pack_index] || value.isNull())
-        return RSResult::Some;
-    if (!(*has_value_marks)[pack_index])
-        return RSResult::None;
+    return checkBatch<details::CheckGreater>(pack_index, 1, value, type)[0];
+}
 
-    const auto * raw_type = type.get();
-    if (typeid_cast<const DataTypeNullable *>(raw_type))
-    {
-        return checkNullableGreaterEqual(pack_index, value, removeNullable(type));
-    }
-#define DISPATCH(TYPE)                                                     \
-    if (typeid_cast<const DataType##TYPE *>(raw_type))                     \
-    {                                                                      \
-        auto & minmaxes_data = toColumnVectorData<TYPE>(minmaxes);         \
-        auto min = minmaxes_data[pack_index * 2];                          \
-        auto max = minmaxes_data[pack_index * 2 + 1];                      \
-        return RoughCheck::checkGreaterEqual<TYPE>(value, type, min, max); \
-    }
-    FOR_NUMERIC_TYPES(DISPATCH)
-#undef DISPATCH
-    if (typeid_cast<const DataTypeDate *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDate::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreaterEqual<DataTypeDate::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeDateTime *>(raw_type))
-    {
-        const auto & minmaxes_data = toColumnVectorData<DataTypeDateTime::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreaterEqual<DataTypeDateTime::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeMyDateTime *>(raw_type) || typeid_cast<const DataTypeMyDate *>(raw_type))
-    {
-        // For DataTypeMyDateTime / DataTypeMyDate, simply compare them as comparing UInt64 is OK.
-        // Check `struct MyTimeBase` for more details.
-        const auto & minmaxes_data = toColumnVectorData<DataTypeMyTimeBase::FieldType>(minmaxes);
-        auto min = minmaxes_data[pack_index * 2];
-        auto max = minmaxes_data[pack_index * 2 + 1];
-        return RoughCheck::checkGreaterEqual<DataTypeMyTimeBase::FieldType>(value, type, min, max);
-    }
-    if (typeid_cast<const DataTypeString *>(raw_type))
-    {
-        const auto * string_column = checkAndGetColumn<ColumnString>(minmaxes.get());
-        const auto & chars = string_column->getChars();
-        const auto & offsets = string_column->getOffsets();
-        size_t pos = pack_index * 2;
-        size_t prev_offset = pos == 0 ? 0 : offsets[pos - 1];
-        // todo use StringRef instead of String
-        auto min = String(reinterpret_cast<const char *>(&chars[prev_offset]), offsets[pos] - prev_offset - 1);
-        pos = pack_index * 2 + 1;
-        prev_offset = offsets[pos - 1];
-        auto max = String(reinterpret_cast<const char *>(&chars[prev_offset]), offsets[pos] - prev_offset - 1);
-        return RoughCheck::checkGreaterEqual<String>(value, type, min, max);
-    }
-    return RSResult::Some;
+RSResult MinMaxIndex::checkGreaterEqual(size_t pack_index, const Field & value, const DataTypePtr & type, int /*nan_direction_hint*/)
+{
+    return checkBatch<details::CheckGreaterEqual>(pack_index, 1, value, type)[0];
 }
 
 String MinMaxIndex::toString()
@@ -17,7 +17,7 @@
 #include <AggregateFunctions/Helpers.h>
 #include <Columns/ColumnNullable.h>
 #include <Columns/ColumnsCommon.h>
-#include <Common/LRUCache.h>
+#include <Common/ShardedSLRUCache.h>
 #include <DataTypes/DataTypeEnum.h>
 #include <DataTypes/DataTypeString.h>
 #include <DataTypes/DataTypesNumber.h>
@@ -50,6 +50,10 @@ private:
     }
 
 public:
+    // The min max of the string values longer than it are stored as the truncated bounds, so that
+    // the index of a pack with long strings does not grow as large as the values.
+    static constexpr size_t STRING_BOUND_MAX_BYTES = 64;
+
     explicit MinMaxIndex(const IDataType & type)
         : has_null_marks(std::make_shared<PaddedPODArray<UInt8>>())
         , has_value_marks(std::make_shared<PaddedPODArray<UInt8>>())
@@ -62,7 +66,8 @@ public:
         return sizeof(UInt8) * has_null_marks->size() + sizeof(UInt8) * has_value_marks->size() + minmaxes->byteSize();
     }
 
-    void addPack(const IColumn & column, const ColumnVector<UInt8> * del_mark);
+    // `truncate_string_bounds` should not be set for the handle column, whose min is used as the exact first handle of a pack.
+    void addPack(const IColumn & column, const ColumnVector<UInt8> * del_mark, bool truncate_string_bounds = false);
 
     void write(const IDataType & type, WriteBuffer & buf);
 
@@ -74,16 +79,31 @@ public:
 
     std::pair<UInt64, UInt64> getUInt64MinMax(size_t pack_index);
 
-    // TODO: Use has_null and value.isNull to check.
+    bool hasNull(size_t pack_index) const { return (*has_null_marks)[pack_index]; }
+    bool hasValue(size_t pack_index) const { return (*has_value_marks)[pack_index]; }
+
+    // The min max of any type. They are Null if the pack has no values not null, or the pack
+    // with null values is written by an old version, whose min is always Null.
+    std::pair<Field, Field> getFieldMinMax(size_t pack_index);
+
+    // The checks of the packs with null values are based on the min max of the not null values, since
+    // comparing with null is never true. They never return All for these packs.
 
     RSResult checkEqual(size_t pack_index, const Field & value, const DataTypePtr & type);
     RSResult checkGreater(size_t pack_index, const Field & value, const DataTypePtr & type, int nan_direction);
     RSResult checkGreaterEqual(size_t pack_index, const Field & value, const DataTypePtr & type, int nan_direction);
 
+    // The batch versions of the checks above, over the packs in [start_pack, start_pack + pack_count).
+    // The type of the index is dispatched once for all the packs instead of once per pack.
+    RSResults checkEqual(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type);
+    RSResults checkGreater(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type, int nan_direction);
+    RSResults checkGreaterEqual(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type, int nan_direction);
+
     static String toString();
-    RSResult checkNullableEqual(size_t pack_index, const Field & value, const DataTypePtr & type);
-    RSResult checkNullableGreater(size_t pack_index, const Field & value, const DataTypePtr & type);
-    RSResult checkNullableGreaterEqual(size_t pack_index, const Field & value, const DataTypePtr & type);
+
+private:
+    template <typename Checker>
+    RSResults checkBatch(size_t start_pack, size_t pack_count, const Field & value, const DataTypePtr & type);
 };
 
 
@@ -93,10 +113,11 @@ struct MinMaxIndexWeightFunction
 };
 
 
-class MinMaxIndexCache : public LRUCache<String, MinMaxIndex, std::hash<String>, MinMaxIndexWeightFunction>
+/// It is accessed by every read thread, so it is sharded and resistant to full table scans, see `ShardedSLRUCache`.
+class MinMaxIndexCache : public ShardedSLRUCache<String, MinMaxIndex, std::hash<String>, MinMaxIndexWeightFunction>
 {
 private:
-    using Base = LRUCache<String, MinMaxIndex, std::hash<String>, MinMaxIndexWeightFunction>;
+    using Base = ShardedSLRUCache<String, MinMaxIndex, std::hash<String>, MinMaxIndexWeightFunction>;
 
 public:
     MinMaxIndexCache(size_t max_size_in_bytes, const Delay & expiration_delay)
@@ -0,0 +1,59 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Columns/ColumnNullable.h>
+#include <DataTypes/DataTypeNullable.h>
+#include <Storages/DeltaMerge/Index/NDVSketch.h>
+#include <city.h>
+
+namespace DB
+{
+namespace DM
+{
+bool NDVSketch::isSupportedType(const DataTypePtr & type)
+{
+    auto nested_type = removeNullable(type);
+    return nested_type->isValueRepresentedByNumber() || nested_type->isStringOrFixedString();
+}
+
+void NDVSketch::addPack(const IColumn & column)
+{
+    const IColumn * data_column = &column;
+    const NullMap * null_map = nullptr;
+    if (const auto * nullable_column = typeid_cast<const ColumnNullable *>(&column); nullable_column)
+    {
+        data_column = &nullable_column->getNestedColumn();
+        null_map = &nullable_column->getNullMapData();
+    }
+
+    const size_t rows = data_column->size();
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (null_map && (*null_map)[i])
+            continue;
+        auto value = data_column->getDataAt(i);
+        hll.insert(CityHash_v1_0_2::CityHash64(value.data, value.size));
+    }
+}
+
+NDVSketchPtr NDVSketch::read(ReadBuffer & buf)
+{
+    auto sketch = std::make_shared<NDVSketch>();
+    sketch->hll.read(buf);
+    return sketch;
+}
+
+} // namespace DM
+} // namespace DB
@@ -0,0 +1,58 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Columns/IColumn.h>
+#include <Common/HyperLogLogCounter.h>
+#include <DataTypes/IDataType.h>
+#include <IO/ReadBuffer.h>
+#include <IO/WriteBuffer.h>
+
+#include <memory>
+
+namespace DB
+{
+namespace DM
+{
+class NDVSketch;
+using NDVSketchPtr = std::shared_ptr<NDVSketch>;
+
+/// A HyperLogLog sketch for estimating the number of distinct values of a column in a DTFile.
+/// The sketches of several DTFiles can be merged to estimate the distinct values of a segment or table.
+/// Null values are skipped, and deleted rows are added, which only makes the estimation larger.
+class NDVSketch
+{
+public:
+    static bool isSupportedType(const DataTypePtr & type);
+
+    void addPack(const IColumn & column);
+
+    void merge(const NDVSketch & other) { hll.merge(other.hll); }
+
+    UInt64 estimate() const { return hll.size(); }
+
+    static constexpr size_t byteSize() { return sizeof(HLL12); }
+
+    void write(WriteBuffer & buf) const { hll.write(buf); }
+
+    static NDVSketchPtr read(ReadBuffer & buf);
+
+private:
+    HLL12 hll;
+};
+
+} // namespace DM
+} // namespace DB
@@ -28,6 +28,8 @@ class EqualIndex
 {
 public:
     virtual ~EqualIndex() = default;
+
+    virtual RSResult checkEqual(size_t /*pack_index*/, const Field & /*value*/, const DataTypePtr & /*type*/) const { return RSResult::Some; }
 };
 
 struct RSIndex
@@ -47,6 +49,30 @@ struct RSIndex
         , equal(equal_)
     {
     }
+
+    /// Check `col = value` by the minmax index, and then by the equal index when minmax could not exclude the pack.
+    RSResult checkEqual(size_t pack_index, const Field & value) const
+    {
+        auto res = minmax->checkEqual(pack_index, value, type);
+        if (res == RSResult::Some && equal)
+            res = equal->checkEqual(pack_index, value, type);
+        return res;
+    }
+
+    /// The batch version of `checkEqual` over the packs in [start_pack, start_pack + pack_count).
+    RSResults checkEqual(size_t start_pack, size_t pack_count, const Field & value) const
+    {
+        auto results = minmax->checkEqual(start_pack, pack_count, value, type);
+        if (equal)
+        {
+            for (size_t i = 0; i < pack_count; ++i)
+            {
+                if (results[i] == RSResult::Some)
+                    results[i] = equal->checkEqual(start_pack + i, value, type);
+            }
+        }
+        return results;
+    }
 };
 
 using ColumnIndexes = std::unordered_map<ColId, RSIndex>;
@@ -41,6 +41,8 @@ static constexpr RSResult Some = RSResult::Some;
 static constexpr RSResult None = RSResult::None;
 static constexpr RSResult All = RSResult::All;
 
+using RSResults = std::vector<RSResult>;
+
 inline RSResult operator!(RSResult v)
 {
     if (unlikely(v == Unknown))
@@ -74,6 +76,39 @@ inline RSResult operator&&(RSResult v0, RSResult v1)
     return Some;
 }
 
+/// The batch versions of the operators above, applied element-wise on the results of a range of packs.
+/// They are branchless so that the compiler could vectorize them, and `Unknown` is not checked here.
+
+inline void batchNot(RSResults & res)
+{
+    for (auto & v : res)
+        v = v == All ? None : (v == None ? All : v);
+}
+
+inline void batchOr(RSResults & res, const RSResults & other)
+{
+    assert(res.size() == other.size());
+    const size_t size = res.size();
+    for (size_t i = 0; i < size; ++i)
+    {
+        const auto v0 = res[i];
+        const auto v1 = other[i];
+        res[i] = (v0 == All || v1 == All) ? All : ((v0 == Some || v1 == Some) ? Some : None);
+    }
+}
+
+inline void batchAnd(RSResults & res, const RSResults & other)
+{
+    assert(res.size() == other.size());
+    const size_t size = res.size();
+    for (size_t i = 0; i < size; ++i)
+    {
+        const auto v0 = res[i];
+        const auto v1 = other[i];
+        res[i] = (v0 == None || v1 == None) ? None : ((v0 == All && v1 == All) ? All : Some);
+    }
+}
+
 } // namespace DM
 
 } // namespace DB
\ No newline at end of file
@@ -147,22 +147,20 @@ private:
                 throw Exception(fmt::format("Illegal compare {} with {}", left_field.getTypeName(), compareTypeToString(right)));
             return true;
         }
-        else if constexpr (LeftGroupType == Decimal || RightGroupType == Decimal)
+        else if constexpr (RightGroupType == Decimal)
         {
-            // TODO: support decimal comparison.
-            // clang-format off
-//            if (!(compareDecimalLeftType<Field::Types::Which::UInt64, UInt64, Number>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Int64, Int64, Number>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Float64, Float64, Number>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Int128, Int128, Number>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Int256, Int256, Number>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Decimal32, DecimalField<Decimal32>, Decimal>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Decimal64, DecimalField<Decimal64>, Decimal>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Decimal128, DecimalField<Decimal128>, Decimal>(left_field, right, res)
-//                  || compareDecimalLeftType<Field::Types::Which::Decimal256, DecimalField<Decimal256>, Decimal>(left_field, right, res)))
-//                throw Exception("Illegal compare " + std::string(left_field.getTypeName()) + " with " + compareTypeToString(right));
-            // clang-format on
-            // return true;
+            // Compare the literal with the decimal values in the index, the scales are aligned by `DecimalField`.
+            return compareDecimalLeftType<Field::Types::Which::Decimal32, DecimalField<Decimal32>>(left_field, right, res)
+                || compareDecimalLeftType<Field::Types::Which::Decimal64, DecimalField<Decimal64>>(left_field, right, res)
+                || compareDecimalLeftType<Field::Types::Which::Decimal128, DecimalField<Decimal128>>(left_field, right, res)
+                || compareDecimalLeftType<Field::Types::Which::Decimal256, DecimalField<Decimal256>>(left_field, right, res)
+                || compareIntegerWithDecimal<Field::Types::Which::UInt64, UInt64>(left_field, right, res)
+                || compareIntegerWithDecimal<Field::Types::Which::Int64, Int64>(left_field, right, res)
+                || compareIntegerWithDecimal<Field::Types::Which::Int128, Int128>(left_field, right, res);
+        }
+        else if constexpr (LeftGroupType == Decimal)
+        {
+            // TODO: support comparing decimal literal with the other types.
             return false;
         }
         else if constexpr (LeftGroupType == String && RightGroupType == String)
@@ -214,29 +212,40 @@ private:
         return true;
     }
 
-    template <Field::Types::Which LeftFieldType,
-              typename Left,
-              ValueGroupType LeftGroupType,
-              typename Right,
-              ValueGroupType RightGroupType = getGroupType<Right>()>
+    template <typename Left, typename Right>
+    static void applyDecimal(const Left & left, const Right & right, bool & res)
+    {
+        if constexpr (std::is_same_v<OpInt, EqualsInt>)
+            res = left == right;
+        else if constexpr (std::is_same_v<OpInt, LessInt>)
+            res = left < right;
+        else if constexpr (std::is_same_v<OpInt, GreaterInt>)
+            res = left > right;
+        else if constexpr (std::is_same_v<OpInt, LessOrEqualsInt>)
+            res = left <= right;
+        else if constexpr (std::is_same_v<OpInt, GreaterOrEqualsInt>)
+            res = left >= right;
+        else
+            throw Exception("Unsupported operation");
+    }
+
+    template <Field::Types::Which LeftFieldType, typename Left, typename Right>
     static bool compareDecimalLeftType(const Field & left_field, const Right & right, bool & res)
     {
         if (left_field.getType() != LeftFieldType)
             return false;
-        if constexpr (LeftGroupType != Decimal && RightGroupType != Decimal)
-            return false;
-
-        auto & left = left_field.safeGet<Left>();
-        UInt32 left_scale = 1;
-        UInt32 right_scale = 1;
-
-        if constexpr (LeftGroupType == Decimal)
-            left_scale = left.getScale();
-        if constexpr (RightGroupType == Decimal)
-            right_scale = right.getScale();
-        else if constexpr ((LeftGroupType == Number || LeftGroupType == Decimal) && (RightGroupType == Number || RightGroupType == Decimal))
-            res = DecimalComparison<Left, Right, Op, true>::compare(left, right, left_scale, right_scale);
+        applyDecimal(left_field.safeGet<Left>(), right, res);
+        return true;
+    }
 
+    template <Field::Types::Which LeftFieldType, typename Left, typename Right>
+    static bool compareIntegerWithDecimal(const Field & left_field, const Right & right, bool & res)
+    {
+        if (left_field.getType() != LeftFieldType)
+            return false;
+        // Integers are compared as the decimals with scale 0. UInt64 and Int128 could be out of the range of Decimal128.
+        const Int256 left = static_cast<Int256>(left_field.safeGet<Left>());
+        applyDecimal(DecimalField<Decimal256>(Decimal256(left), 0), right, res);
         return true;
     }
 
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <Columns/ColumnsNumber.h>
+#include <Common/typeid_cast.h>
 #include <DataStreams/IBlockInputStream.h>
 #include <Interpreters/sortBlock.h>
 #include <Storages/DeltaMerge/DeltaMergeHelpers.h>
@@ -152,7 +154,7 @@ private:
         return cut_offset;
     }
 
-    static Block finializeBlock(Block && block)
+    Block finializeBlock(Block && block) const
     {
         if constexpr (need_extra_sort)
         {
@@ -160,11 +162,59 @@ private:
             static SortDescription sort{SortColumnDescription{EXTRA_HANDLE_COLUMN_NAME, 1, 0},
                                         SortColumnDescription{VERSION_COLUMN_NAME, 1, 0}};
             if (block.rows() > 1 && !isAlreadySorted(block, sort))
-                stableSortBlock(block, sort);
+            {
+                IColumn::Permutation perm;
+                if (getPermutationByReversingVersions(block, perm))
+                {
+                    for (size_t i = 0; i < block.columns(); ++i)
+                    {
+                        auto & col = block.safeGetByPosition(i);
+                        col.column = col.column->permute(perm, 0);
+                    }
+                }
+                else
+                    stableSortBlock(block, sort);
+            }
         }
         return std::move(block);
     }
 
+    // The rows decoded from SSTFiles are sorted by handle asc and version desc. If so, get the permutation
+    // sorting them by handle asc and version asc by reversing the rows of each handle, which is much cheaper
+    // than sorting the whole block. Return false if the rows are not sorted in that way.
+    bool getPermutationByReversingVersions(const Block & block, IColumn::Permutation & perm) const
+    {
+        const auto & handle_col = block.getByName(EXTRA_HANDLE_COLUMN_NAME).column;
+        const auto * version_col = typeid_cast<const ColumnUInt64 *>(block.getByName(VERSION_COLUMN_NAME).column.get());
+        if (version_col == nullptr)
+            return false;
+        RowKeyColumnContainer rowkey_column(handle_col, is_common_handle);
+        const auto & versions = version_col->getData();
+
+        const size_t rows = block.rows();
+        perm.resize(rows);
+        size_t run_begin = 0;
+        for (size_t i = 1; i <= rows; ++i)
+        {
+            int cmp = 1;
+            if (i < rows)
+            {
+                cmp = compare(rowkey_column.getRowKeyValue(i), rowkey_column.getRowKeyValue(i - 1));
+                // Keep the same order as the stable sort for the rows with the same handle and version.
+                if (cmp < 0 || (cmp == 0 && versions[i] >= versions[i - 1]))
+                    return false;
+            }
+            if (cmp != 0)
+            {
+                // Reverse the rows of the same handle in [run_begin, i)
+                for (size_t j = run_begin; j < i; ++j)
+                    perm[j] = run_begin + i - 1 - j;
+                run_begin = i;
+            }
+        }
+        return true;
+    }
+
 private:
     BlockInputStreamPtr sorted_input_stream;
     const ColId pk_column_id;
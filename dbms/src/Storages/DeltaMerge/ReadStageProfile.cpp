@@ -0,0 +1,119 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/TiFlashMetrics.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
+
+namespace DB
+{
+namespace DM
+{
+namespace
+{
+thread_local ReadStageProfile * current_profile = nullptr;
+// The time measured by the timers nested in the innermost running timer of current thread
+thread_local UInt64 nested_ns = 0;
+} // namespace
+
+const char * readStageToString(ReadStage stage)
+{
+    switch (stage)
+    {
+    case ReadStage::Snapshot:
+        return "snapshot";
+    case ReadStage::ReadInfo:
+        return "read_info";
+    case ReadStage::RoughSetFilter:
+        return "rough_set_filter";
+    case ReadStage::FileIO:
+        return "file_io";
+    case ReadStage::Decompress:
+        return "decompress";
+    case ReadStage::DeltaMerge:
+        return "delta_merge";
+    case ReadStage::VersionFilter:
+        return "version_filter";
+    default:
+        return "unknown";
+    }
+}
+
+ReadStageProfile::~ReadStageProfile()
+{
+    auto observe = [this](ReadStage stage, ShardedHistogram & histogram) {
+        if (auto ns = get(stage); ns > 0)
+            histogram.Observe(ns / 1e9);
+    };
+    observe(ReadStage::Snapshot, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_snapshot));
+    observe(ReadStage::ReadInfo, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_read_info));
+    observe(ReadStage::RoughSetFilter, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_rough_set_filter));
+    observe(ReadStage::FileIO, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_file_io));
+    observe(ReadStage::Decompress, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_decompress));
+    observe(ReadStage::DeltaMerge, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_delta_merge));
+    observe(ReadStage::VersionFilter, GET_METRIC(tiflash_storage_read_stage_duration_seconds, type_version_filter));
+}
+
+void ReadStageProfile::mergeTo(std::array<UInt64, static_cast<size_t>(ReadStage::Count)> & other) const
+{
+    for (size_t i = 0; i < stage_ns.size(); ++i)
+        other[i] += stage_ns[i].load(std::memory_order_relaxed);
+}
+
+ReadStageProfile * ReadStageProfile::current()
+{
+    return current_profile;
+}
+
+ReadStageProfile::Scope::Scope(ReadStageProfile * profile)
+    : prev(current_profile)
+{
+    current_profile = profile;
+}
+
+ReadStageProfile::Scope::~Scope()
+{
+    current_profile = prev;
+}
+
+ReadStageTimer::ReadStageTimer(ReadStage stage_)
+    : profile(current_profile)
+    , stage(stage_)
+{
+    if (profile == nullptr)
+        return;
+    start_ns = clock_gettime_ns();
+    outer_nested_ns = nested_ns;
+    nested_ns = 0;
+}
+
+ReadStageTimer::~ReadStageTimer()
+{
+    if (profile == nullptr)
+        return;
+    auto elapsed_ns = clock_gettime_ns() - start_ns;
+    profile->add(stage, elapsed_ns > nested_ns ? elapsed_ns - nested_ns : 0);
+    nested_ns = outer_nested_ns + elapsed_ns;
+}
+
+void ReadStageTimer::addNested(ReadStage nested_stage, UInt64 ns)
+{
+    if (profile == nullptr)
+        return;
+    profile->add(nested_stage, ns);
+    nested_ns += ns;
+}
+
+} // namespace DM
+} // namespace DB
@@ -0,0 +1,107 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/Stopwatch.h>
+#include <common/types.h>
+
+#include <array>
+#include <atomic>
+#include <boost/noncopyable.hpp>
+#include <memory>
+
+namespace DB
+{
+namespace DM
+{
+enum class ReadStage : size_t
+{
+    // Create the snapshots of segments
+    Snapshot = 0,
+    // `Segment::getReadInfo`, including placing the delta index
+    ReadInfo,
+    // Load the min-max indexes and filter the packs of DMFiles
+    RoughSetFilter,
+    // Read the column data of DMFiles, not including decompression
+    FileIO,
+    // Decompress the column data of DMFiles
+    Decompress,
+    // Merge the delta into the stable
+    DeltaMerge,
+    // Filter the rows by the read version
+    VersionFilter,
+
+    Count,
+};
+
+const char * readStageToString(ReadStage stage);
+
+/// The time spent on the stages of a DeltaMerge read, accumulated by all the segments and threads of the read.
+/// The time of a stage does not include the time of the stages nested in it, e.g. the time of `DeltaMerge` does
+/// not include the time of reading the stable, see `ReadStageTimer`.
+/// The total time of the stages is observed by `tiflash_storage_read_stage_duration_seconds` when the read is done.
+class ReadStageProfile : private boost::noncopyable
+{
+public:
+    ~ReadStageProfile();
+
+    void add(ReadStage stage, UInt64 ns) { stage_ns[static_cast<size_t>(stage)].fetch_add(ns, std::memory_order_relaxed); }
+
+    UInt64 get(ReadStage stage) const { return stage_ns[static_cast<size_t>(stage)].load(std::memory_order_relaxed); }
+
+    /// Merge into `other`, e.g. the profiles of different partitions of a table scan.
+    void mergeTo(std::array<UInt64, static_cast<size_t>(ReadStage::Count)> & other) const;
+
+    /// The profile of current thread. The read thread and the segment streams set it before reading the segments,
+    /// so that the stages deep in the streams are profiled without passing the profile around.
+    static ReadStageProfile * current();
+
+    class Scope : private boost::noncopyable
+    {
+    public:
+        explicit Scope(ReadStageProfile * profile);
+        ~Scope();
+
+    private:
+        ReadStageProfile * prev;
+    };
+
+private:
+    std::array<std::atomic<UInt64>, static_cast<size_t>(ReadStage::Count)> stage_ns{};
+};
+
+using ReadStageProfilePtr = std::shared_ptr<ReadStageProfile>;
+
+/// Measure the time of a stage into the profile of current thread, do nothing if there is no profile.
+/// The time of the timers nested in the scope is excluded.
+class ReadStageTimer : private boost::noncopyable
+{
+public:
+    explicit ReadStageTimer(ReadStage stage_);
+    ~ReadStageTimer();
+
+    /// Move `ns` of the time of this stage to the nested `nested_stage`.
+    void addNested(ReadStage nested_stage, UInt64 ns);
+
+private:
+    ReadStageProfile * profile;
+    ReadStage stage;
+    UInt64 start_ns = 0;
+    UInt64 outer_nested_ns = 0;
+};
+
+} // namespace DM
+} // namespace DB
@@ -16,6 +16,121 @@
 
 namespace DB::DM
 {
+namespace
+{
+size_t packRows(const DMFile::PackStats & pack_stats, size_t start_pack_id, size_t end_pack_id)
+{
+    size_t rows = 0;
+    for (auto i = start_pack_id; i < end_pack_id; ++i)
+    {
+        rows += pack_stats[i].rows;
+    }
+    return rows;
+}
+} // namespace
+
+std::map<PackId, ColumnSharingCache::ColumnData>::const_iterator ColumnSharingCache::findCovering(size_t pack_id, bool prefer_end) const
+{
+    auto found = packs.end();
+    // The cached ranges may overlap, check all the ranges starting before `pack_id`. There are only a few of them
+    // because the ranges before the next pack of the reader are deleted.
+    for (auto itr = packs.upper_bound(pack_id); itr != packs.begin();)
+    {
+        --itr;
+        if (itr->first + itr->second.pack_count <= pack_id)
+        {
+            continue;
+        }
+        // Iterating backward, the later one always starts first.
+        if (found == packs.end() || !prefer_end || itr->first + itr->second.pack_count > found->first + found->second.pack_count)
+        {
+            found = itr;
+        }
+    }
+    return found;
+}
+
+ColumnCacheResult ColumnSharingCache::get(size_t start_pack_id, size_t pack_count, const DMFile::PackStats & pack_stats, const DataTypePtr & data_type)
+{
+    ColumnCacheResult res;
+    const auto end_pack_id = start_pack_id + pack_count;
+    // Copy the packs [from, to) of the cached range.
+    auto copy_packs = [&](MutableColumnPtr & to_col, std::map<PackId, ColumnData>::const_iterator itr, size_t from, size_t to) {
+        if (to_col == nullptr)
+        {
+            to_col = data_type->createColumn();
+        }
+        to_col->insertRangeFrom(*itr->second.col_data, packRows(pack_stats, itr->first, from), packRows(pack_stats, from, to));
+    };
+
+    std::lock_guard lock(mtx);
+    if (auto itr = packs.find(start_pack_id); itr != packs.end() && itr->second.pack_count == pack_count)
+    {
+        GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_hit).Increment();
+        res.status = ColumnCacheStatus::GET_HIT;
+        res.prefix = itr->second.col_data;
+        res.prefix_packs = pack_count;
+        return res;
+    }
+
+    // The longest cached prefix, may be served by several cached ranges.
+    MutableColumnPtr prefix;
+    auto prefix_end = start_pack_id;
+    while (prefix_end < end_pack_id)
+    {
+        auto itr = findCovering(prefix_end, /*prefer_end*/ true);
+        if (itr == packs.end())
+        {
+            break;
+        }
+        auto to = std::min(end_pack_id, itr->first + itr->second.pack_count);
+        copy_packs(prefix, itr, prefix_end, to);
+        prefix_end = to;
+    }
+    if (prefix_end == end_pack_id)
+    {
+        GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_copy).Increment();
+        res.status = ColumnCacheStatus::GET_COPY;
+        res.prefix = std::move(prefix);
+        res.prefix_packs = pack_count;
+        return res;
+    }
+
+    // The longest cached suffix after the prefix.
+    std::vector<std::tuple<std::map<PackId, ColumnData>::const_iterator, size_t, size_t>> suffix_ranges;
+    auto suffix_begin = end_pack_id;
+    while (suffix_begin > prefix_end)
+    {
+        auto itr = findCovering(suffix_begin - 1, /*prefer_end*/ false);
+        if (itr == packs.end())
+        {
+            break;
+        }
+        auto from = std::max(prefix_end, itr->first);
+        suffix_ranges.emplace_back(itr, from, suffix_begin);
+        suffix_begin = from;
+    }
+    MutableColumnPtr suffix;
+    for (auto r = suffix_ranges.rbegin(); r != suffix_ranges.rend(); ++r)
+    {
+        copy_packs(suffix, std::get<0>(*r), std::get<1>(*r), std::get<2>(*r));
+    }
+
+    if (prefix == nullptr && suffix == nullptr)
+    {
+        GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_miss).Increment();
+        res.status = ColumnCacheStatus::GET_MISS;
+        return res;
+    }
+    GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_part).Increment();
+    res.status = ColumnCacheStatus::GET_PART;
+    res.prefix = std::move(prefix);
+    res.prefix_packs = prefix_end - start_pack_id;
+    res.suffix = std::move(suffix);
+    res.suffix_packs = end_pack_id - suffix_begin;
+    return res;
+}
+
 DMFileReaderPool & DMFileReaderPool::instance()
 {
     static DMFileReaderPool reader_pool;
@@ -25,7 +140,21 @@ DMFileReaderPool & DMFileReaderPool::instance()
 void DMFileReaderPool::add(DMFileReader & reader)
 {
     std::lock_guard lock(mtx);
-    readers[reader.path()].insert(&reader);
+    auto & file_readers = readers[reader.path()];
+    if (reader.canJoinScan())
+    {
+        // Join the in-progress scan which has the most packs left, so that most packs can be shared.
+        size_t join_pack_id = 0;
+        for (auto * r : file_readers)
+        {
+            auto pack_id = r->getNextPackId();
+            if (pack_id > 0 && (join_pack_id == 0 || pack_id < join_pack_id))
+                join_pack_id = pack_id;
+        }
+        if (reader.joinScanAt(join_pack_id))
+            GET_METRIC(tiflash_storage_read_thread_counter, type_join_scan).Increment();
+    }
+    file_readers.insert(&reader);
 }
 
 void DMFileReaderPool::del(DMFileReader & reader)
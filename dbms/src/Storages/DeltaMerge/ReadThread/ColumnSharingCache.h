@@ -37,6 +37,21 @@ enum class ColumnCacheStatus
     _TOTAL_COUNT,
 };
 
+// The packs of a read served by `ColumnSharingCache`.
+struct ColumnCacheResult
+{
+    ColumnCacheStatus status = ColumnCacheStatus::GET_MISS;
+    // GET_HIT or GET_COPY: the column data of all the packs.
+    // GET_PART: the column data of the cached prefix packs, nullptr if the first pack is not cached.
+    ColumnPtr prefix;
+    size_t prefix_packs = 0;
+    // GET_PART: the column data of the cached suffix packs, nullptr if the last pack is not cached.
+    ColumnPtr suffix;
+    size_t suffix_packs = 0;
+
+    size_t cachedBytes() const { return (prefix != nullptr ? prefix->byteSize() : 0) + (suffix != nullptr ? suffix->byteSize() : 0); }
+};
+
 class ColumnSharingCache
 {
 public:
@@ -58,37 +73,11 @@ public:
         }
     }
 
-    ColumnCacheStatus get(size_t start_pack_id, size_t pack_count, size_t read_rows, ColumnPtr & col_data, DataTypePtr data_type)
-    {
-        ColumnCacheStatus status;
-        std::lock_guard lock(mtx);
-        auto target = packs.find(start_pack_id);
-        if (target == packs.end())
-        {
-            GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_miss).Increment();
-            status = ColumnCacheStatus::GET_MISS;
-        }
-        else if (target->second.pack_count < pack_count)
-        {
-            GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_part).Increment();
-            status = ColumnCacheStatus::GET_PART;
-        }
-        else if (target->second.pack_count == pack_count)
-        {
-            GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_hit).Increment();
-            status = ColumnCacheStatus::GET_HIT;
-            col_data = target->second.col_data;
-        }
-        else
-        {
-            GET_METRIC(tiflash_storage_read_thread_counter, type_get_cache_copy).Increment();
-            status = ColumnCacheStatus::GET_COPY;
-            auto column = data_type->createColumn();
-            column->insertRangeFrom(*(target->second.col_data), 0, read_rows);
-            col_data = std::move(column);
-        }
-        return status;
-    }
+    // Returns the packs [start_pack_id, start_pack_id + pack_count) served by the cache.
+    // The cached ranges may not be aligned with the read: a read can be served by a part of a cached range,
+    // or by several adjacent cached ranges. If only some packs are cached, the cached prefix and suffix are
+    // returned and the caller reads the packs between them.
+    ColumnCacheResult get(size_t start_pack_id, size_t pack_count, const DMFile::PackStats & pack_stats, const DataTypePtr & data_type);
 
     void del(size_t upper_start_pack_id)
     {
@@ -107,6 +96,9 @@ public:
     }
 
 private:
+    // Returns the cached range covering `pack_id`, which ends last if `prefer_end`, or starts first otherwise.
+    std::map<PackId, ColumnData>::const_iterator findCovering(size_t pack_id, bool prefer_end) const;
+
     std::mutex mtx;
     // start_pack_id -> <pack_count, col_data>
     std::map<PackId, ColumnData> packs;
@@ -155,16 +147,20 @@ public:
         itr->second.add(start_pack_id, pack_count, col_data);
     }
 
-    bool get(int64_t col_id, size_t start_pack_id, size_t pack_count, size_t read_rows, ColumnPtr & col_data, DataTypePtr data_type)
+    ColumnCacheResult get(int64_t col_id, size_t start_pack_id, size_t pack_count, const DMFile::PackStats & pack_stats, const DataTypePtr & data_type)
     {
-        auto status = ColumnCacheStatus::GET_MISS;
+        ColumnCacheResult res;
         auto itr = cols.find(col_id);
         if (itr != cols.end())
         {
-            status = itr->second.get(start_pack_id, pack_count, read_rows, col_data, data_type);
+            res = itr->second.get(start_pack_id, pack_count, pack_stats, data_type);
+        }
+        stats[static_cast<int>(res.status)].fetch_add(1, std::memory_order_relaxed);
+        if (res.status != ColumnCacheStatus::GET_MISS)
+        {
+            GET_METRIC(tiflash_storage_read_thread_shared_bytes).Increment(res.cachedBytes());
         }
-        stats[static_cast<int>(status)].fetch_add(1, std::memory_order_relaxed);
-        return status == ColumnCacheStatus::GET_HIT || status == ColumnCacheStatus::GET_COPY;
+        return res;
     }
 
     // Each read operator of DMFileReader will advance the next_pack_id.
@@ -11,10 +11,31 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <Common/Stopwatch.h>
+#include <Storages/DeltaMerge/File/DMFile.h>
 #include <Storages/DeltaMerge/ReadThread/MergedTask.h>
+#include <Storages/DeltaMerge/Segment.h>
+#include <Storages/DeltaMerge/StableValueSpace.h>
 
 namespace DB::DM
 {
+uint64_t MergedTask::computeLocalityKey(uint64_t seg_id, const std::vector<MergedUnit> & units)
+{
+    for (const auto & unit : units)
+    {
+        if (unit.task == nullptr || unit.task->read_snapshot == nullptr || unit.task->read_snapshot->stable == nullptr)
+        {
+            continue;
+        }
+        const auto & dmfiles = unit.task->read_snapshot->stable->getDMFiles();
+        if (!dmfiles.empty())
+        {
+            return dmfiles.front()->fileId();
+        }
+    }
+    return seg_id;
+}
+
 int MergedTask::readBlock()
 {
     initOnce();
@@ -65,7 +86,10 @@ int MergedTask::readOneBlock()
             continue;
         }
 
-        if (pool->readOneBlock(stream, task->segment))
+        Stopwatch watch;
+        bool has_block = pool->readOneBlock(stream, task->segment);
+        pool->addReadThreadTime(watch.elapsed());
+        if (has_block)
         {
             read_block_count++;
         }
@@ -44,6 +44,7 @@ public:
     MergedTask(uint64_t seg_id_, std::vector<MergedUnit> && units_)
         : seg_id(seg_id_)
         , units(std::move(units_))
+        , locality_key(computeLocalityKey(seg_id, units))
         , inited(false)
         , cur_idx(-1)
         , finished_count(0)
@@ -71,6 +72,14 @@ public:
         return seg_id;
     }
 
+    // `getLocalityKey` returns the key used to choose the NUMA node that reads this task.
+    // Segments that share the same stable DTFile (e.g. after split) get the same key, so the
+    // stable data is likely read by the same NUMA node.
+    uint64_t getLocalityKey() const
+    {
+        return locality_key;
+    }
+
     size_t getPoolCount() const
     {
         return units.size();
@@ -104,6 +113,7 @@ public:
     void setException(const DB::Exception & e);
 
 private:
+    static uint64_t computeLocalityKey(uint64_t seg_id, const std::vector<MergedUnit> & units);
     void initOnce();
     int readOneBlock();
 
@@ -125,6 +135,7 @@ private:
 
     uint64_t seg_id;
     std::vector<MergedUnit> units;
+    uint64_t locality_key;
     bool inited;
     int cur_idx;
     size_t finished_count;
@@ -15,6 +15,8 @@
 #include <Storages/DeltaMerge/ReadThread/SegmentReader.h>
 #include <Storages/DeltaMerge/Segment.h>
 
+#include <unordered_map>
+
 namespace DB::DM
 {
 SegmentReadTaskScheduler::SegmentReadTaskScheduler()
@@ -98,7 +100,40 @@ std::pair<MergedTaskPtr, bool> SegmentReadTaskScheduler::scheduleMergedTask()
     }
     GET_METRIC(tiflash_storage_read_thread_counter, type_sche_new_task).Increment();
 
-    return {std::make_shared<MergedTask>(segment->first, std::move(units)), true};
+    merged_task = std::make_shared<MergedTask>(segment->first, std::move(units));
+    if (pool->enableCooperativeScan())
+    {
+        reading_segments[pool->tableId()][segment->first] = merged_task;
+    }
+    return {merged_task, true};
+}
+
+std::unordered_set<uint64_t> SegmentReadTaskScheduler::getReadingSegmentsUnlock(int64_t table_id)
+{
+    std::unordered_set<uint64_t> seg_ids;
+    auto itr = reading_segments.find(table_id);
+    if (itr == reading_segments.end())
+    {
+        return seg_ids;
+    }
+    auto & segments = itr->second;
+    for (auto seg_itr = segments.begin(); seg_itr != segments.end();)
+    {
+        if (seg_itr->second.expired())
+        {
+            seg_itr = segments.erase(seg_itr);
+        }
+        else
+        {
+            seg_ids.insert(seg_itr->first);
+            ++seg_itr;
+        }
+    }
+    if (segments.empty())
+    {
+        reading_segments.erase(itr);
+    }
+    return seg_ids;
 }
 
 SegmentReadTaskPools SegmentReadTaskScheduler::getPoolsUnlock(const std::vector<uint64_t> & pool_ids)
@@ -118,15 +153,52 @@ SegmentReadTaskPools SegmentReadTaskScheduler::getPoolsUnlock(const std::vector<
 
 SegmentReadTaskPoolPtr SegmentReadTaskScheduler::scheduleSegmentReadTaskPoolUnlock()
 {
+    // The read threads are shared by the scheduling classes by their weights: the class with the least read thread
+    // time divided by its weight is chosen. In the class, the pool with the least remaining segments is chosen, so
+    // that the short queries are finished first. The pools with the same remaining segments share the read threads
+    // evenly.
+    struct ClassState
+    {
+        UInt64 read_thread_ns = 0;
+        UInt64 weight = 1;
+        SegmentReadTaskPoolPtr pool;
+        size_t pool_remaining = 0;
+    };
+    std::unordered_map<String, ClassState> classes;
     auto [unexpired, expired] = read_pools.count(0);
     for (int64_t i = 0; i < unexpired; i++)
     {
         auto pool = read_pools.next();
-        if (pool != nullptr && pool->getFreeBlockSlots() > 0)
+        if (pool == nullptr)
+            continue;
+        auto & state = classes[pool->schedulingClass()];
+        state.read_thread_ns += pool->getReadThreadTime();
+        state.weight = pool->schedulingWeight();
+        if (pool->getFreeBlockSlots() <= 0)
+            continue;
+        auto remaining = pool->getRemainingTaskCount();
+        if (state.pool == nullptr || remaining < state.pool_remaining
+            || (remaining == state.pool_remaining && pool->getReadThreadTime() < state.pool->getReadThreadTime()))
         {
-            return pool;
+            state.pool = pool;
+            state.pool_remaining = remaining;
         }
     }
+
+    const ClassState * chosen = nullptr;
+    for (const auto & [name, state] : classes)
+    {
+        std::ignore = name;
+        if (state.pool == nullptr)
+            continue;
+        // Compare read_thread_ns / weight without division.
+        if (chosen == nullptr
+            || static_cast<unsigned __int128>(state.read_thread_ns) * chosen->weight < static_cast<unsigned __int128>(chosen->read_thread_ns) * state.weight)
+            chosen = &state;
+    }
+    if (chosen != nullptr)
+        return chosen->pool;
+
     if (unexpired == 0)
     {
         GET_METRIC(tiflash_storage_read_thread_counter, type_sche_no_pool).Increment();
@@ -150,7 +222,8 @@ std::optional<std::pair<uint64_t, std::vector<uint64_t>>> SegmentReadTaskSchedul
     }
     std::optional<std::pair<uint64_t, std::vector<uint64_t>>> result;
     auto & segments = itr->second;
-    auto target = pool->scheduleSegment(segments, expected_merge_seg_count);
+    auto reading_segment_ids = pool->enableCooperativeScan() ? getReadingSegmentsUnlock(pool->tableId()) : std::unordered_set<uint64_t>{};
+    auto target = pool->scheduleSegment(segments, expected_merge_seg_count, reading_segment_ids);
     if (target != segments.end())
     {
         if (MergedTask::getPassiveMergedSegments() < 100 || target->second.size() == 1)
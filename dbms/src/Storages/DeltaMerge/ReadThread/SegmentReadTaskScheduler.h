@@ -29,7 +29,11 @@ using SegmentReadTaskPoolList = CircularScanList<SegmentReadTaskPool>;
 // index segments information into `merging_segments`.
 // 2. A schedule-thread will scheduling read tasks:
 //   a. It scans the read_pools list and choosing a SegmentReadTaskPool.
+//      The read threads are shared by the scheduling classes (`io_scheduling_group` and `priority`) by their weights,
+//      and the pool with the least remaining segments in the chosen class is preferred.
 //   b. Chooses a segment of the SegmentReadTaskPool and build a MergedTask.
+//      With cooperative scan, the segments being read by other MergedTasks are preferred, so that the pool can
+//      join the in-progress scans at their current packs (see `DMFileReaderPool::add`).
 //   c. Sends the MergedTask to read threads(SegmentReader).
 class SegmentReadTaskScheduler
 {
@@ -67,11 +71,16 @@ private:
     // <seg_id, pool_ids>
     std::optional<std::pair<uint64_t, std::vector<uint64_t>>> scheduleSegmentUnlock(const SegmentReadTaskPoolPtr & pool);
     SegmentReadTaskPoolPtr scheduleSegmentReadTaskPoolUnlock();
+    // Returns the segments of `table_id` which are being read by MergedTasks.
+    std::unordered_set<uint64_t> getReadingSegmentsUnlock(int64_t table_id);
 
     std::mutex mtx;
     SegmentReadTaskPoolList read_pools;
     // table_id -> {seg_id -> pool_ids, seg_id -> pool_ids, ...}
     std::unordered_map<int64_t, std::unordered_map<uint64_t, std::vector<uint64_t>>> merging_segments;
+    // table_id -> {seg_id -> merged_task, ...}
+    // The MergedTasks of cooperative scan which are in progress, so that the pools arrive later can join them.
+    std::unordered_map<int64_t, std::unordered_map<uint64_t, std::weak_ptr<MergedTask>>> reading_segments;
 
     MergedTaskPool merged_task_pool;
 
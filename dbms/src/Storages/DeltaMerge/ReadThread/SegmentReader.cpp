@@ -11,14 +11,22 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <Common/Stopwatch.h>
+#include <Common/TiFlashMetrics.h>
 #include <Common/setThreadName.h>
 #include <Storages/DeltaMerge/ReadThread/CPU.h>
 #include <Storages/DeltaMerge/ReadThread/SegmentReadTaskScheduler.h>
 #include <Storages/DeltaMerge/ReadThread/SegmentReader.h>
 #include <Storages/DeltaMerge/SegmentReadTaskPool.h>
 
+#include <common/config_common.h>
+
 #include <ext/scope_guard.h>
 
+#if USE_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+
 namespace DB::DM
 {
 class SegmentReader
@@ -26,11 +34,21 @@ class SegmentReader
     inline static const std::string name{"SegmentReader"};
 
 public:
-    SegmentReader(WorkQueue<MergedTaskPtr> & task_queue_, const std::vector<int> & cpus_)
+    SegmentReader(
+        WorkQueue<MergedTaskPtr> & task_queue_,
+        std::atomic<int64_t> & active_readers_,
+        ReadConcurrencyController & controller_,
+        size_t index_,
+        const std::vector<int> & cpus_,
+        unsigned arena_index_)
         : task_queue(task_queue_)
+        , active_readers(active_readers_)
+        , controller(controller_)
+        , index(index_)
         , stop(false)
         , log(&Poco::Logger::get(name))
         , cpus(cpus_)
+        , arena_index(arena_index_)
     {
         t = std::thread(&SegmentReader::run, this);
     }
@@ -79,6 +97,21 @@ private:
 #endif
     }
 
+    void setArena()
+    {
+        if (arena_index == 0)
+        {
+            return;
+        }
+#if USE_JEMALLOC
+        unsigned arena = arena_index;
+        if (je_mallctl("thread.arena", nullptr, nullptr, &arena, sizeof(arena)) != 0)
+        {
+            LOG_FMT_ERROR(log, "Set jemalloc thread.arena {} fail", arena);
+        }
+#endif
+    }
+
     bool isStop()
     {
         return stop.load(std::memory_order_relaxed);
@@ -89,13 +122,22 @@ private:
         MergedTaskPtr merged_task;
         try
         {
+            if (!controller.waitForTurn(index))
+            {
+                return;
+            }
             if (!task_queue.pop(merged_task))
             {
                 LOG_FMT_INFO(log, "pop fail, stop {}", isStop());
                 return;
             }
 
+            active_readers.fetch_add(1, std::memory_order_relaxed);
+            Stopwatch watch;
+            auto start_cpu_ns = clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID);
             SCOPE_EXIT({
+                controller.report(watch.elapsed(), clock_gettime_ns(CLOCK_THREAD_CPUTIME_ID) - start_cpu_ns, task_queue.size());
+                active_readers.fetch_sub(1, std::memory_order_relaxed);
                 if (!merged_task->allStreamsFinished())
                 {
                     SegmentReadTaskScheduler::instance().pushMergedTask(merged_task);
@@ -146,6 +188,7 @@ private:
     void run()
     {
         setCPUAffinity();
+        setArena();
         setThreadName(name.c_str());
         while (!isStop())
         {
@@ -154,10 +197,14 @@ private:
     }
 
     WorkQueue<MergedTaskPtr> & task_queue;
+    std::atomic<int64_t> & active_readers;
+    ReadConcurrencyController & controller;
+    const size_t index;
     std::atomic<bool> stop;
     Poco::Logger * log;
     std::thread t;
     std::vector<int> cpus;
+    unsigned arena_index;
 };
 
 void SegmentReaderPool::addTask(MergedTaskPtr && task)
@@ -168,15 +215,125 @@ void SegmentReaderPool::addTask(MergedTaskPtr && task)
     }
 }
 
-SegmentReaderPool::SegmentReaderPool(int thread_count, const std::vector<int> & cpus)
-    : log(&Poco::Logger::get("SegmentReaderPool"))
+ReadConcurrencyController::ReadConcurrencyController(size_t init_concurrency_, size_t min_concurrency_, size_t max_concurrency_, bool adaptive_)
+    : init_concurrency(init_concurrency_)
+    , min_concurrency(std::min(min_concurrency_, init_concurrency_))
+    , max_concurrency(std::max(max_concurrency_, init_concurrency_))
+    , adaptive(adaptive_)
+    , concurrency(init_concurrency_)
+    , last_adjust_ns(clock_gettime_ns(CLOCK_MONOTONIC))
+    , last_process_cpu_ns(clock_gettime_ns(CLOCK_PROCESS_CPUTIME_ID))
+    , log(&Poco::Logger::get("ReadConcurrencyController"))
+{
+    GET_METRIC(tiflash_storage_read_thread_gauge, type_concurrency).Increment(init_concurrency);
+}
+
+bool ReadConcurrencyController::waitForTurn(size_t index)
+{
+    if (index < concurrency.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] { return finished || index < concurrency.load(std::memory_order_relaxed); });
+    return !finished;
+}
+
+void ReadConcurrencyController::finish()
+{
+    {
+        std::lock_guard lock(mutex);
+        finished = true;
+    }
+    cv.notify_all();
+    GET_METRIC(tiflash_storage_read_thread_gauge, type_concurrency).Decrement(concurrency.load(std::memory_order_relaxed));
+}
+
+void ReadConcurrencyController::report(UInt64 wall_ns, UInt64 cpu_ns, size_t pending_tasks)
+{
+    if (!adaptive)
+    {
+        return;
+    }
+    wall_ns_sum.fetch_add(wall_ns, std::memory_order_relaxed);
+    cpu_ns_sum.fetch_add(cpu_ns, std::memory_order_relaxed);
+    adjust(pending_tasks);
+}
+
+void ReadConcurrencyController::adjust(size_t pending_tasks)
+{
+    static constexpr UInt64 adjust_interval_ns = 1'000'000'000;
+    // The reads spend less than this ratio of their time on CPU are regarded as blocked on I/O.
+    static constexpr double io_bound_cpu_ratio = 0.5;
+    // The reads spend more than this ratio of their time on CPU are regarded as CPU-bound.
+    static constexpr double cpu_bound_cpu_ratio = 0.8;
+    static constexpr double cpu_saturated_utilization = 0.9;
+
+    std::unique_lock lock(adjust_mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        return;
+    }
+    auto now_ns = clock_gettime_ns(CLOCK_MONOTONIC);
+    if (now_ns - last_adjust_ns < adjust_interval_ns)
+    {
+        return;
+    }
+    auto process_cpu_ns = clock_gettime_ns(CLOCK_PROCESS_CPUTIME_ID);
+    auto wall_ns = wall_ns_sum.exchange(0, std::memory_order_relaxed);
+    auto cpu_ns = cpu_ns_sum.exchange(0, std::memory_order_relaxed);
+    auto cpu_ratio = wall_ns == 0 ? 1.0 : static_cast<double>(cpu_ns) / wall_ns;
+    auto cpu_utilization = static_cast<double>(process_cpu_ns - last_process_cpu_ns) / (now_ns - last_adjust_ns) / std::max(std::thread::hardware_concurrency(), 1u);
+    last_adjust_ns = now_ns;
+    last_process_cpu_ns = process_cpu_ns;
+
+    auto cur = concurrency.load(std::memory_order_relaxed);
+    auto step = std::max<size_t>(init_concurrency / 4, 1);
+    auto target = cur;
+    if (cpu_ratio < io_bound_cpu_ratio && pending_tasks > 0)
+    {
+        target = std::min(cur + step, max_concurrency);
+    }
+    else if (cpu_ratio > cpu_bound_cpu_ratio && cpu_utilization > cpu_saturated_utilization)
+    {
+        target = cur > min_concurrency + step ? cur - step : min_concurrency;
+    }
+    else if (cpu_ratio > cpu_bound_cpu_ratio && cur > init_concurrency)
+    {
+        target = cur > init_concurrency + step ? cur - step : init_concurrency;
+    }
+    if (target != cur)
+    {
+        LOG_FMT_DEBUG(log, "concurrency {} => {} cpu_ratio {:.2f} cpu_utilization {:.2f} pending_tasks {}", cur, target, cpu_ratio, cpu_utilization, pending_tasks);
+        setConcurrency(target);
+    }
+}
+
+void ReadConcurrencyController::setConcurrency(size_t new_concurrency)
+{
+    size_t old_concurrency;
+    {
+        std::lock_guard lock(mutex);
+        old_concurrency = concurrency.exchange(new_concurrency, std::memory_order_relaxed);
+    }
+    GET_METRIC(tiflash_storage_read_thread_gauge, type_concurrency).Increment(static_cast<double>(new_concurrency) - old_concurrency);
+    if (new_concurrency > old_concurrency)
+    {
+        cv.notify_all();
+    }
+}
+
+SegmentReaderPool::SegmentReaderPool(int thread_count, const std::vector<int> & cpus, unsigned arena_index, int max_thread_count, bool adaptive)
+    : controller(thread_count, std::max(thread_count / 2, 1), adaptive ? std::max(max_thread_count, thread_count) : thread_count, adaptive)
+    , log(&Poco::Logger::get("SegmentReaderPool"))
 {
-    LOG_FMT_INFO(log, "Create SegmentReaderPool thread_count {} cpus {} start", thread_count, cpus);
-    for (int i = 0; i < thread_count; i++)
+    auto reader_count = adaptive ? std::max(max_thread_count, thread_count) : thread_count;
+    LOG_FMT_INFO(log, "Create SegmentReaderPool thread_count {} max_thread_count {} cpus {} arena {} start", thread_count, reader_count, cpus, arena_index);
+    for (int i = 0; i < reader_count; i++)
     {
-        readers.push_back(std::make_unique<SegmentReader>(task_queue, cpus));
+        readers.push_back(std::make_unique<SegmentReader>(task_queue, active_readers, controller, i, cpus, arena_index));
     }
-    LOG_FMT_INFO(log, "Create SegmentReaderPool thread_count {} cpus {} end", thread_count, cpus);
+    LOG_FMT_INFO(log, "Create SegmentReaderPool thread_count {} max_thread_count {} cpus {} arena {} end", thread_count, reader_count, cpus, arena_index);
 }
 
 SegmentReaderPool::~SegmentReaderPool()
@@ -185,6 +342,7 @@ SegmentReaderPool::~SegmentReaderPool()
     {
         reader->setStop();
     }
+    controller.finish();
     task_queue.finish();
 }
 
@@ -204,27 +362,109 @@ SegmentReaderPoolManager::SegmentReaderPoolManager()
 
 SegmentReaderPoolManager::~SegmentReaderPoolManager() = default;
 
-void SegmentReaderPoolManager::init(const ServerInfo & server_info)
+// Create a jemalloc arena for the read threads of a NUMA node, return 0 if it is not supported.
+static unsigned createNumaArena(Poco::Logger * log)
+{
+#if USE_JEMALLOC
+    unsigned arena = 0;
+    size_t sz = sizeof(arena);
+    if (je_mallctl("arenas.create", &arena, &sz, nullptr, 0) != 0)
+    {
+        LOG_FMT_ERROR(log, "Create jemalloc arena fail");
+        return 0;
+    }
+    return arena;
+#else
+    UNUSED(log);
+    return 0;
+#endif
+}
+
+void SegmentReaderPoolManager::init(const ServerInfo & server_info, bool adaptive, double max_thread_ratio)
 {
     auto numa_nodes = getNumaNodes(log);
-    LOG_FMT_INFO(log, "numa_nodes {} => {}", numa_nodes.size(), numa_nodes);
+    LOG_FMT_INFO(log, "numa_nodes {} => {} adaptive {} max_thread_ratio {}", numa_nodes.size(), numa_nodes, adaptive, max_thread_ratio);
     for (const auto & node : numa_nodes)
     {
         int thread_count = node.empty() ? server_info.cpu_info.logical_cores : node.size();
-        reader_pools.push_back(std::make_unique<SegmentReaderPool>(thread_count, node));
+        int max_thread_count = std::max(static_cast<int>(thread_count * max_thread_ratio), thread_count);
+        unsigned arena_index = numa_nodes.size() > 1 && !node.empty() ? createNumaArena(log) : 0;
+        reader_pools.push_back(std::make_unique<SegmentReaderPool>(thread_count, node, arena_index, max_thread_count, adaptive));
         auto ids = reader_pools.back()->getReaderIds();
         reader_ids.insert(ids.begin(), ids.end());
     }
     LOG_FMT_INFO(log, "readers count {}", reader_ids.size());
 }
 
+// `choosePool` returns the pool of the NUMA node that the locality key belongs to.
+// If that pool is overloaded, returns the least loaded pool instead.
+size_t SegmentReaderPoolManager::choosePool(uint64_t locality_key) const
+{
+    static std::hash<uint64_t> hash_func;
+    auto local_idx = hash_func(locality_key) % reader_pools.size();
+    if (reader_pools.size() <= 1)
+    {
+        return local_idx;
+    }
+
+    auto load = [](const SegmentReaderPoolPtr & pool) {
+        return static_cast<double>(pool->getPendingTaskCount() + pool->getActiveReaderCount()) / std::max<size_t>(pool->getConcurrency(), 1);
+    };
+    // Leave the NUMA node only if it has more than one pending task for each read thread.
+    static constexpr double overload_ratio = 2.0;
+    auto local_load = load(reader_pools[local_idx]);
+    if (local_load <= overload_ratio)
+    {
+        return local_idx;
+    }
+
+    auto min_idx = local_idx;
+    auto min_load = local_load;
+    for (size_t i = 0; i < reader_pools.size(); ++i)
+    {
+        auto l = load(reader_pools[i]);
+        if (l < min_load)
+        {
+            min_idx = i;
+            min_load = l;
+        }
+    }
+    // Only move the task when it is much cheaper than waiting in the local NUMA node.
+    return min_load * 2 < local_load ? min_idx : local_idx;
+}
+
 void SegmentReaderPoolManager::addTask(MergedTaskPtr && task)
 {
     static std::hash<uint64_t> hash_func;
-    auto idx = hash_func(task->getSegmentId()) % reader_pools.size();
+    auto local_idx = hash_func(task->getLocalityKey()) % reader_pools.size();
+    auto idx = choosePool(task->getLocalityKey());
+    if (idx == local_idx)
+    {
+        GET_METRIC(tiflash_storage_read_thread_counter, type_numa_local_task).Increment();
+    }
+    else
+    {
+        GET_METRIC(tiflash_storage_read_thread_counter, type_numa_cross_node_task).Increment();
+    }
     reader_pools[idx]->addTask(std::move(task));
 }
 
+std::vector<SegmentReaderPoolStat> SegmentReaderPoolManager::getPoolStats() const
+{
+    std::vector<SegmentReaderPoolStat> stats;
+    stats.reserve(reader_pools.size());
+    for (const auto & pool : reader_pools)
+    {
+        stats.push_back(SegmentReaderPoolStat{
+            .thread_count = pool->getThreadCount(),
+            .concurrency = pool->getConcurrency(),
+            .pending_tasks = pool->getPendingTaskCount(),
+            .active_readers = pool->getActiveReaderCount(),
+        });
+    }
+    return stats;
+}
+
 // `isSegmentReader` checks whether this thread is a `SegmentReader`.
 // Use this function in DMFileBlockInputSteam to check whether enable read thread of this read request,
 // Maybe we can pass the argument from DeltaMerge -> SegmentReadTaskPool -> ... -> DMFileBlockInputSteam.
@@ -26,10 +26,54 @@ using MergedTaskPtr = std::shared_ptr<MergedTask>;
 class SegmentReader;
 using SegmentReaderUPtr = std::unique_ptr<SegmentReader>;
 
+// ReadConcurrencyController limits the number of read threads of a SegmentReaderPool that can read tasks.
+// The read threads out of the limit are parked. With `adaptive`, the limit is adjusted by the ratio of the CPU time
+// to the wall time of the reads: the limit grows when the reads are mostly blocked on I/O and tasks are pending,
+// and shrinks back when the reads are CPU-bound, down to `min_concurrency` if the CPU of the process is saturated.
+class ReadConcurrencyController
+{
+public:
+    ReadConcurrencyController(size_t init_concurrency_, size_t min_concurrency_, size_t max_concurrency_, bool adaptive_);
+
+    // Blocks the read thread `index` while it is out of the limit. Returns false if the controller is finished.
+    bool waitForTurn(size_t index);
+    // Reports the wall time and the CPU time of a read, and adjusts the limit periodically.
+    void report(UInt64 wall_ns, UInt64 cpu_ns, size_t pending_tasks);
+    void finish();
+
+    size_t getConcurrency() const { return concurrency.load(std::memory_order_relaxed); }
+
+private:
+    void adjust(size_t pending_tasks);
+    void setConcurrency(size_t new_concurrency);
+
+    const size_t init_concurrency;
+    const size_t min_concurrency;
+    const size_t max_concurrency;
+    const bool adaptive;
+
+    std::atomic<size_t> concurrency;
+    std::atomic<UInt64> wall_ns_sum{0};
+    std::atomic<UInt64> cpu_ns_sum{0};
+
+    std::mutex adjust_mutex;
+    UInt64 last_adjust_ns;
+    UInt64 last_process_cpu_ns;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool finished = false;
+
+    Poco::Logger * log;
+};
+
 class SegmentReaderPool
 {
 public:
-    SegmentReaderPool(int thread_count, const std::vector<int> & cpus);
+    // `arena_index` is the jemalloc arena used by the read threads of this pool, 0 means the default arenas.
+    // `max_thread_count` read threads are created and `thread_count` of them read tasks at first. If `adaptive`,
+    // the number of reading threads is adjusted between `thread_count / 2` and `max_thread_count`.
+    SegmentReaderPool(int thread_count, const std::vector<int> & cpus, unsigned arena_index = 0, int max_thread_count = 0, bool adaptive = false);
     ~SegmentReaderPool();
     SegmentReaderPool(const SegmentReaderPool &) = delete;
     SegmentReaderPool & operator=(const SegmentReaderPool &) = delete;
@@ -39,19 +83,36 @@ public:
     void addTask(MergedTaskPtr && task);
     std::vector<std::thread::id> getReaderIds() const;
 
-private:
-    void init(int thread_count, const std::vector<int> & cpus);
+    size_t getThreadCount() const { return readers.size(); }
+    size_t getConcurrency() const { return controller.getConcurrency(); }
+    size_t getPendingTaskCount() { return task_queue.size(); }
+    int64_t getActiveReaderCount() const { return active_readers.load(std::memory_order_relaxed); }
 
+private:
     WorkQueue<MergedTaskPtr> task_queue;
+    ReadConcurrencyController controller;
+    // The number of readers that are reading a task.
+    std::atomic<int64_t> active_readers{0};
     std::vector<SegmentReaderUPtr> readers;
     Poco::Logger * log;
 };
 
+struct SegmentReaderPoolStat
+{
+    size_t thread_count = 0;
+    size_t concurrency = 0;
+    size_t pending_tasks = 0;
+    int64_t active_readers = 0;
+};
+
 // SegmentReaderPoolManager is a NUMA-aware singleton that manages several SegmentReaderPool objects.
 // The number of SegmentReadPool object is the same as the number of CPU NUMA node.
 // Thread number of a SegmentReadPool object is the same as the number of CPU logical core of a CPU NUMA node.
-// Function `addTask` dispatches MergedTask to SegmentReadPool by their segment id, so a segment read task
-// wouldn't be processed across NUMA nodes.
+// Function `addTask` dispatches MergedTask to SegmentReadPool by the locality key of their stable data, so a segment read task
+// wouldn't be processed across NUMA nodes unless its NUMA node is overloaded.
+// When there are several NUMA nodes, the read threads of a NUMA node allocate memory from their own jemalloc arena,
+// so the memory first touched (and later reused) by them stays on the local NUMA node.
+// With `adaptive`, the number of reading threads of each pool follows the current bottleneck, see `ReadConcurrencyController`.
 class SegmentReaderPoolManager
 {
 public:
@@ -60,16 +121,21 @@ public:
         static SegmentReaderPoolManager pool_manager;
         return pool_manager;
     }
-    void init(const ServerInfo & server_info);
+    // `max_thread_ratio` is the maximum number of read threads of a pool relative to its CPU cores, used only if `adaptive`.
+    void init(const ServerInfo & server_info, bool adaptive = false, double max_thread_ratio = 1.0);
     ~SegmentReaderPoolManager();
     DISALLOW_COPY_AND_MOVE(SegmentReaderPoolManager);
 
     void addTask(MergedTaskPtr && task);
     bool isSegmentReader() const;
 
+    std::vector<SegmentReaderPoolStat> getPoolStats() const;
+
 private:
     SegmentReaderPoolManager();
-    std::vector<std::unique_ptr<SegmentReaderPool>> reader_pools;
+    size_t choosePool(uint64_t locality_key) const;
+    using SegmentReaderPoolPtr = std::unique_ptr<SegmentReaderPool>;
+    std::vector<SegmentReaderPoolPtr> reader_pools;
     std::unordered_set<std::thread::id> reader_ids;
     Poco::Logger * log;
 };
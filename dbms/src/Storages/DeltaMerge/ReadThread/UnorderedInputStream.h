@@ -63,6 +63,10 @@ public:
 
     Block getHeader() const override { return header; }
 
+    size_t getExpectedBlockSize() const { return task_pool->getExpectedBlockSize(); }
+
+    const ReadStageProfilePtr & getReadStageProfile() const { return task_pool->getReadStageProfile(); }
+
 protected:
     Block readImpl() override
     {
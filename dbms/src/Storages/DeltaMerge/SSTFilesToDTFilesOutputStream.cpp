@@ -39,6 +39,7 @@ namespace DB
 namespace ErrorCodes
 {
 extern const int ILLFORMAT_RAFT_ROW;
+extern const int LOGICAL_ERROR;
 } // namespace ErrorCodes
 
 namespace DM
@@ -58,10 +59,19 @@ SSTFilesToDTFilesOutputStream::SSTFilesToDTFilesOutputStream( //
     , job_type(job_type_)
     , tmt(tmt_)
     , log(&Poco::Logger::get("SSTFilesToDTFilesOutputStream"))
+    , split_file_rows(std::max<size_t>(1, tmt.getContext().getSettingsRef().dt_snapshot_prehandle_split_file_rows))
 {
+    const size_t write_concurrency = tmt.getContext().getSettingsRef().dt_snapshot_prehandle_write_concurrency;
+    if (write_concurrency > 1)
+        write_pool = std::make_unique<ThreadPool>(write_concurrency);
 }
 
-SSTFilesToDTFilesOutputStream::~SSTFilesToDTFilesOutputStream() = default;
+SSTFilesToDTFilesOutputStream::~SSTFilesToDTFilesOutputStream()
+{
+    // Wake up the job blocked on popping blocks, or `write_pool` can not be joined.
+    if (pending_blocks != nullptr)
+        pending_blocks->cancel();
+}
 
 void SSTFilesToDTFilesOutputStream::writePrefix()
 {
@@ -78,18 +88,19 @@ void SSTFilesToDTFilesOutputStream::writeSuffix()
     if (dt_stream != nullptr)
     {
         dt_stream->writeSuffix();
-        auto dt_file = dt_stream->getFile();
-        assert(!dt_file->canGC()); // The DTFile should not be able to gc until it is ingested.
-        // Add the DTFile to StoragePathPool so that we can restore it later
-        const auto bytes_written = dt_file->getBytesOnDisk();
-        storage->getStore()->preIngestFile(dt_file->parentPath(), dt_file->fileId(), bytes_written);
-
-        // Report DMWriteBytes for calculating write amplification
-        ProfileEvents::increment(ProfileEvents::DMWriteBytes, bytes_written);
-
+        preIngestFile(dt_stream->getFile());
         dt_stream.reset();
     }
 
+    if (write_pool != nullptr)
+    {
+        finishPendingBlocks();
+        // Rethrow the exception of writing DTFiles if any
+        write_pool->wait();
+        for (const auto & dt_file : ingest_files)
+            preIngestFile(dt_file);
+    }
+
     const auto process_keys = child->getProcessKeys();
     if (job_type == FileConvertJobType::ApplySnapshot)
     {
@@ -114,6 +125,17 @@ void SSTFilesToDTFilesOutputStream::writeSuffix()
         process_keys.lock_cf);
 }
 
+void SSTFilesToDTFilesOutputStream::preIngestFile(const DMFilePtr & dt_file)
+{
+    assert(!dt_file->canGC()); // The DTFile should not be able to gc until it is ingested.
+    // Add the DTFile to StoragePathPool so that we can restore it later
+    const auto bytes_written = dt_file->getBytesOnDisk();
+    storage->getStore()->preIngestFile(dt_file->parentPath(), dt_file->fileId(), bytes_written);
+
+    // Report DMWriteBytes for calculating write amplification
+    ProfileEvents::increment(ProfileEvents::DMWriteBytes, bytes_written);
+}
+
 bool SSTFilesToDTFilesOutputStream::newDTFileStream()
 {
     // Generate a DMFilePtr and its DMFileBlockOutputStream
@@ -145,12 +167,58 @@ bool SSTFilesToDTFilesOutputStream::newDTFileStream()
         child->getRegion()->toString(true),
         dt_file->path(),
         flags.isSingleFile());
-    dt_stream = std::make_unique<DMFileBlockOutputStream>(tmt.getContext(), dt_file, *(schema_snap->column_defines), flags);
-    dt_stream->writePrefix();
+    if (write_pool == nullptr)
+    {
+        dt_stream = std::make_unique<DMFileBlockOutputStream>(tmt.getContext(), dt_file, *(schema_snap->column_defines), flags);
+        dt_stream->writePrefix();
+    }
+    else
+    {
+        scheduleDTFileWrite(dt_file, flags);
+    }
     ingest_files.emplace_back(dt_file);
     return true;
 }
 
+void SSTFilesToDTFilesOutputStream::scheduleDTFileWrite(const DMFilePtr & dt_file, const DMFileBlockOutputStream::Flags & flags)
+{
+    // A few blocks are enough to keep the writer busy, and it limits the memory used by the decoded blocks.
+    constexpr Int64 max_pending_blocks = 4;
+    auto queue = std::make_shared<PendingBlockQueue>(max_pending_blocks);
+    pending_blocks = queue;
+    pending_file_rows = 0;
+    // Block until there is a free thread, so at most `write_concurrency` DTFiles are being written at the same time.
+    write_pool->schedule([this, dt_file, flags, queue] {
+        try
+        {
+            DMFileBlockOutputStream stream(tmt.getContext(), dt_file, *(schema_snap->column_defines), flags);
+            stream.writePrefix();
+            PendingBlock pending;
+            while (queue->pop(pending))
+                stream.write(pending.block, pending.property);
+            // Cancelled by `cancel` or the dtor, the DTFile will be removed
+            if (queue->getStatus() == PendingBlockQueue::Status::CANCELLED)
+                return;
+            stream.writeSuffix();
+        }
+        catch (...)
+        {
+            // Make the decoding thread stop pushing blocks
+            queue->cancel();
+            throw;
+        }
+    });
+}
+
+void SSTFilesToDTFilesOutputStream::finishPendingBlocks()
+{
+    if (pending_blocks == nullptr)
+        return;
+    pending_blocks->finish();
+    pending_blocks.reset();
+    pending_file_rows = 0;
+}
+
 void SSTFilesToDTFilesOutputStream::write()
 {
     size_t last_effective_num_rows = 0;
@@ -165,7 +233,13 @@ void SSTFilesToDTFilesOutputStream::write()
         if (unlikely(block.rows() == 0))
             continue;
 
-        if (dt_stream == nullptr)
+        if (write_pool != nullptr && pending_file_rows >= split_file_rows)
+        {
+            // Blocks are bounded by the handle, so the rows of the same handle won't be split into different DTFiles.
+            finishPendingBlocks();
+        }
+
+        if (dt_stream == nullptr && pending_blocks == nullptr)
         {
             // If can not create DTFile stream (the storage may be dropped / shutdown),
             // break the writing loop.
@@ -209,9 +283,23 @@ void SSTFilesToDTFilesOutputStream::write()
             = child->getMvccStatistics();
         property.effective_num_rows = cur_effective_num_rows - last_effective_num_rows;
         property.not_clean_rows = cur_not_clean_rows - last_not_clean_rows;
-        dt_stream->write(block, property);
+        const size_t block_rows = block.rows();
+        if (write_pool == nullptr)
+        {
+            dt_stream->write(block, property);
+        }
+        else
+        {
+            if (!pending_blocks->push(PendingBlock{std::move(block), property}))
+            {
+                // The writing job failed, rethrow its exception
+                write_pool->wait();
+                throw Exception(fmt::format("The job writing DTFile is cancelled {}", child->getRegion()->toString(true)), ErrorCodes::LOGICAL_ERROR);
+            }
+            pending_file_rows += block_rows;
+        }
 
-        commit_rows += block.rows();
+        commit_rows += block_rows;
         last_effective_num_rows = cur_effective_num_rows;
         last_not_clean_rows = cur_not_clean_rows;
     }
@@ -229,6 +317,21 @@ PageIds SSTFilesToDTFilesOutputStream::ingestIds() const
 
 void SSTFilesToDTFilesOutputStream::cancel()
 {
+    if (write_pool != nullptr)
+    {
+        if (pending_blocks != nullptr)
+            pending_blocks->cancel();
+        try
+        {
+            write_pool->wait();
+        }
+        catch (...)
+        {
+            tryLogCurrentException(log, "ignore exception while waiting the jobs writing DTFiles");
+        }
+        pending_blocks.reset();
+    }
+
     // Try a lightweight cleanup the file generated by this stream (marking them able to be GC-ed).
     for (auto & file : ingest_files)
     {
@@ -14,10 +14,13 @@
 
 #pragma once
 
+#include <Common/MPMCQueue.h>
 #include <Common/Stopwatch.h>
 #include <RaftStoreProxyFFI/ColumnFamily.h>
+#include <Storages/DeltaMerge/File/DMFileBlockOutputStream.h>
 #include <Storages/DeltaMerge/SSTFilesToBlockInputStream.h>
 #include <Storages/Page/PageDefines.h>
+#include <common/ThreadPool.h>
 
 #include <memory>
 #include <string_view>
@@ -48,7 +51,6 @@ using ColumnDefinesPtr = std::shared_ptr<ColumnDefines>;
 
 class DMFile;
 using DMFilePtr = std::shared_ptr<DMFile>;
-class DMFileBlockOutputStream;
 
 enum class FileConvertJobType
 {
@@ -59,6 +61,11 @@ enum class FileConvertJobType
 
 // This class is tightly coupling with BoundedSSTFilesToBlockInputStream
 // to get some info of the decoding process.
+//
+// The decoding of SST files is done by the calling thread. If `dt_snapshot_prehandle_write_concurrency`
+// is greater than 1, the sorted blocks are split into DTFiles of about `dt_snapshot_prehandle_split_file_rows`
+// rows, and these DTFiles are written (compressed, checksummed, flushed) by a thread pool of that size.
+// Because the blocks are bounded by the handle, the DTFiles are not overlapped and are kept in key order.
 class SSTFilesToDTFilesOutputStream : private boost::noncopyable
 {
 public:
@@ -82,9 +89,24 @@ public:
 private:
     bool newDTFileStream();
 
+    // Schedule a job writing the blocks pushed into `pending_blocks` to `dt_file`.
+    void scheduleDTFileWrite(const DMFilePtr & dt_file, const DMFileBlockOutputStream::Flags & flags);
+    // Notify the job of current DTFile that there are no more blocks.
+    void finishPendingBlocks();
+
+    void preIngestFile(const DMFilePtr & dt_file);
+
     // Stop the process for decoding committed data into DTFiles
     void stop();
 
+    struct PendingBlock
+    {
+        Block block;
+        DMFileBlockOutputStream::BlockProperty property;
+    };
+    using PendingBlockQueue = MPMCQueue<PendingBlock>;
+    using PendingBlockQueuePtr = std::shared_ptr<PendingBlockQueue>;
+
 private:
     BoundedSSTFilesToBlockInputStreamPtr child;
     StorageDeltaMergePtr storage;
@@ -101,6 +123,14 @@ private:
     size_t schema_sync_trigger_count = 0;
     size_t commit_rows = 0;
     Stopwatch watch;
+
+    const size_t split_file_rows;
+    // The blocks of the DTFile being written by `write_pool`, and the number of rows pushed.
+    PendingBlockQueuePtr pending_blocks;
+    size_t pending_file_rows = 0;
+    // Only created when the write concurrency is greater than 1.
+    // Keep it as the last member so that the jobs are done before other members are destroyed.
+    std::unique_ptr<ThreadPool> write_pool;
 };
 
 } // namespace DM
@@ -12,9 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/FmtUtils.h>
+#include <Common/ThreadManager.h>
 #include <Common/TiFlashMetrics.h>
 #include <DataStreams/ConcatBlockInputStream.h>
 #include <DataStreams/EmptyBlockInputStream.h>
+#include <DataStreams/OneBlockInputStream.h>
 #include <DataStreams/SquashingBlockInputStream.h>
 #include <DataTypes/DataTypeFactory.h>
 #include <Poco/Logger.h>
@@ -39,6 +42,7 @@
 #include <fmt/core.h>
 
 #include <ext/scope_guard.h>
+#include <algorithm>
 #include <memory>
 #include <numeric>
 
@@ -96,19 +100,11 @@ namespace DM
 {
 const static size_t SEGMENT_BUFFER_SIZE = 128; // More than enough.
 
-DMFilePtr writeIntoNewDMFile(DMContext & dm_context, //
-                             const ColumnDefinesPtr & schema_snap,
-                             const BlockInputStreamPtr & input_stream,
-                             UInt64 file_id,
-                             const String & parent_path,
-                             DMFileBlockOutputStream::Flags flags)
+void copyBlocks(const BlockInputStreamPtr & input_stream, DMFileBlockOutputStream & output_stream)
 {
-    auto dmfile = DMFile::create(file_id, parent_path, flags.isSingleFile(), dm_context.createChecksumConfig(flags.isSingleFile()));
-    auto output_stream = std::make_shared<DMFileBlockOutputStream>(dm_context.db_context, dmfile, *schema_snap, flags);
     const auto * mvcc_stream = typeid_cast<const DMVersionFilterBlockInputStream<DM_VERSION_FILTER_MODE_COMPACT> *>(input_stream.get());
 
     input_stream->readPrefix();
-    output_stream->writePrefix();
     while (true)
     {
         size_t last_effective_num_rows = 0;
@@ -140,38 +136,160 @@ DMFilePtr writeIntoNewDMFile(DMContext & dm_context, //
         block_property.effective_num_rows = cur_effective_num_rows - last_effective_num_rows;
         block_property.not_clean_rows = cur_not_clean_rows - last_not_clean_rows;
         block_property.gc_hint_version = gc_hint_version;
-        output_stream->write(block, block_property);
+        output_stream.write(block, block_property);
     }
-
     input_stream->readSuffix();
+}
+
+DMFilePtr writeIntoNewDMFile(DMContext & dm_context, //
+                             const ColumnDefinesPtr & schema_snap,
+                             const BlockInputStreamPtr & input_stream,
+                             UInt64 file_id,
+                             const String & parent_path,
+                             DMFileBlockOutputStream::Flags flags)
+{
+    auto dmfile = DMFile::create(file_id, parent_path, flags.isSingleFile(), dm_context.createChecksumConfig(flags.isSingleFile()));
+    auto output_stream = std::make_shared<DMFileBlockOutputStream>(dm_context.db_context, dmfile, *schema_snap, flags);
+
+    output_stream->writePrefix();
+    copyBlocks(input_stream, *output_stream);
     output_stream->writeSuffix();
 
     return dmfile;
 }
 
-StableValueSpacePtr createNewStable(DMContext & context,
-                                    const ColumnDefinesPtr & schema_snap,
-                                    const BlockInputStreamPtr & input_stream,
-                                    PageId stable_id,
-                                    WriteBatches & wbs)
+/// Return the stream of the same rows in the same blocks for any `columns` that include the handle, version and tag columns.
+using CreateStreamByColumns = std::function<BlockInputStreamPtr(const ColumnDefinesPtr & columns)>;
+
+/// Write a new DTFile in vertical mode. The handle, version and tag columns and the first `group_size` other columns
+/// are written first, then every `group_size` other columns. The input is read once for each group, by the stream
+/// which only reads the handle, version and tag columns and the columns of the group.
+/// It trades reading the extra columns these times for the memory of the opened streams.
+DMFilePtr writeIntoNewDMFileVertically(DMContext & dm_context,
+                                       const ColumnDefinesPtr & schema_snap,
+                                       const CreateStreamByColumns & create_stream,
+                                       size_t group_size,
+                                       UInt64 file_id,
+                                       const String & parent_path)
+{
+    ColumnDefines base_columns;
+    ColumnDefines other_columns;
+    for (const auto & cd : *schema_snap)
+    {
+        if (cd.id == EXTRA_HANDLE_COLUMN_ID || cd.id == VERSION_COLUMN_ID || cd.id == TAG_COLUMN_ID)
+            base_columns.push_back(cd);
+        else
+            other_columns.push_back(cd);
+    }
+
+    DMFileBlockOutputStream::Flags flags;
+    flags.setVertical(true);
+    auto dmfile = DMFile::create(file_id, parent_path, /*single_file_mode*/ false, dm_context.createChecksumConfig(false));
+    auto output_stream = std::make_shared<DMFileBlockOutputStream>(dm_context.db_context, dmfile, *schema_snap, flags);
+
+    output_stream->writePrefix();
+    size_t group_begin = 0;
+    do
+    {
+        auto group_end = std::min(group_begin + group_size, other_columns.size());
+        auto read_columns = std::make_shared<ColumnDefines>(base_columns);
+        ColumnDefines group_columns(other_columns.begin() + group_begin, other_columns.begin() + group_end);
+        read_columns->insert(read_columns->end(), group_columns.begin(), group_columns.end());
+
+        output_stream->beginColumnGroup(group_begin == 0 ? *read_columns : group_columns);
+        copyBlocks(create_stream(read_columns), *output_stream);
+        output_stream->endColumnGroup();
+        group_begin = group_end;
+    } while (group_begin < other_columns.size());
+    output_stream->writeSuffix();
+
+    return dmfile;
+}
+
+/// Write each of `input_streams` into a new DTFile. The streams are written concurrently if there are more than one,
+/// so they must not share any state. `wbs` is not touched here, see `createNewStable`.
+/// The DTFiles are put on the fast paths if `on_fast_path` is true, see `Segment::shouldStableOnFastPath`.
+DMFiles writeIntoNewDMFiles(DMContext & context,
+                            const ColumnDefinesPtr & schema_snap,
+                            const BlockInputStreams & input_streams,
+                            bool on_fast_path = false)
 {
     auto delegator = context.path_pool.getStableDiskDelegator();
-    auto store_path = delegator.choosePath();
 
     DMFileBlockOutputStream::Flags flags;
     flags.setSingleFile(context.db_context.getSettingsRef().dt_enable_single_file_mode_dmfile);
 
-    PageId dtfile_id = context.storage_pool.newDataPageIdForDTFile(delegator, __PRETTY_FUNCTION__);
-    auto dtfile = writeIntoNewDMFile(context, schema_snap, input_stream, dtfile_id, store_path, flags);
+    std::vector<PageId> dtfile_ids;
+    std::vector<String> store_paths;
+    for (size_t i = 0; i < input_streams.size(); ++i)
+    {
+        store_paths.push_back(delegator.choosePath(on_fast_path));
+        dtfile_ids.push_back(context.storage_pool.newDataPageIdForDTFile(delegator, __PRETTY_FUNCTION__));
+    }
+
+    DMFiles dtfiles(input_streams.size());
+    if (input_streams.size() == 1)
+    {
+        dtfiles[0] = writeIntoNewDMFile(context, schema_snap, input_streams[0], dtfile_ids[0], store_paths[0], flags);
+    }
+    else
+    {
+        auto thread_manager = newThreadManager();
+        for (size_t i = 0; i < input_streams.size(); ++i)
+        {
+            thread_manager->schedule(false, "WriteDTFile", [&, i] {
+                dtfiles[i] = writeIntoNewDMFile(context, schema_snap, input_streams[i], dtfile_ids[i], store_paths[i], flags);
+            });
+        }
+        thread_manager->wait();
+    }
+    return dtfiles;
+}
+
+/// Create a stable of the DTFiles written by `writeIntoNewDMFiles`, which must be ordered by their key ranges.
+StableValueSpacePtr createNewStable(DMContext & context,
+                                    const DMFiles & dtfiles,
+                                    PageId stable_id,
+                                    WriteBatches & wbs)
+{
+    auto delegator = context.path_pool.getStableDiskDelegator();
     auto stable = std::make_shared<StableValueSpace>(stable_id);
-    stable->setFiles({dtfile}, RowKeyRange::newAll(context.is_common_handle, context.rowkey_column_size));
+    stable->setFiles(dtfiles, RowKeyRange::newAll(context.is_common_handle, context.rowkey_column_size));
     stable->saveMeta(wbs.meta);
-    wbs.data.putExternal(dtfile_id, 0);
-    delegator.addDTFile(dtfile_id, dtfile->getBytesOnDisk(), store_path);
+    for (const auto & dtfile : dtfiles)
+    {
+        wbs.data.putExternal(dtfile->fileId(), 0);
+        delegator.addDTFile(dtfile->fileId(), dtfile->getBytesOnDisk(), dtfile->parentPath());
+    }
 
     return stable;
 }
 
+StableValueSpacePtr createNewStable(DMContext & context,
+                                    const ColumnDefinesPtr & schema_snap,
+                                    const BlockInputStreamPtr & input_stream,
+                                    PageId stable_id,
+                                    WriteBatches & wbs,
+                                    bool on_fast_path = false)
+{
+    return createNewStable(context, writeIntoNewDMFiles(context, schema_snap, {input_stream}, on_fast_path), stable_id, wbs);
+}
+
+StableValueSpacePtr createNewStableVertically(DMContext & context,
+                                              const ColumnDefinesPtr & schema_snap,
+                                              const CreateStreamByColumns & create_stream,
+                                              size_t group_size,
+                                              PageId stable_id,
+                                              WriteBatches & wbs,
+                                              bool on_fast_path)
+{
+    auto delegator = context.path_pool.getStableDiskDelegator();
+    auto store_path = delegator.choosePath(on_fast_path);
+    auto dtfile_id = context.storage_pool.newDataPageIdForDTFile(delegator, __PRETTY_FUNCTION__);
+    auto dtfile = writeIntoNewDMFileVertically(context, schema_snap, create_stream, group_size, dtfile_id, store_path);
+    return createNewStable(context, DMFiles{dtfile}, stable_id, wbs);
+}
+
 //==========================================================================================
 // Segment ser/deser
 //==========================================================================================
@@ -296,7 +414,10 @@ void Segment::serialize(WriteBatch & wb)
 bool Segment::writeToDisk(DMContext & dm_context, const ColumnFilePtr & column_file)
 {
     LOG_FMT_TRACE(log, "Segment [{}] write to disk rows: {}, isBigFile{}", segment_id, column_file->getRows(), column_file->isBigFile());
-    return delta->appendColumnFile(dm_context, column_file);
+    if (!delta->appendColumnFile(dm_context, column_file))
+        return false;
+    written_rows.fetch_add(column_file->getRows(), std::memory_order_relaxed);
+    return true;
 }
 
 bool Segment::writeToCache(DMContext & dm_context, const Block & block, size_t offset, size_t limit)
@@ -304,7 +425,10 @@ bool Segment::writeToCache(DMContext & dm_context, const Block & block, size_t o
     LOG_FMT_TRACE(log, "Segment [{}] write to cache rows: {}", segment_id, limit);
     if (unlikely(limit == 0))
         return true;
-    return delta->appendToCache(dm_context, block, offset, limit);
+    if (!delta->appendToCache(dm_context, block, offset, limit))
+        return false;
+    written_rows.fetch_add(limit, std::memory_order_relaxed);
+    return true;
 }
 
 bool Segment::write(DMContext & dm_context, const Block & block, bool flush_cache)
@@ -317,6 +441,7 @@ bool Segment::write(DMContext & dm_context, const Block & block, bool flush_cach
 
     if (delta->appendColumnFile(dm_context, column_file))
     {
+        written_rows.fetch_add(block.rows(), std::memory_order_relaxed);
         if (flush_cache)
         {
             while (!flushCache(dm_context))
@@ -356,13 +481,38 @@ bool Segment::ingestColumnFiles(DMContext & dm_context, const RowKeyRange & rang
 
 SegmentSnapshotPtr Segment::createSnapshot(const DMContext & dm_context, bool for_update, CurrentMetrics::Metric metric) const
 {
-    // If the snapshot is created for read, then the snapshot will contain all packs (cached and persisted) for read.
-    // If the snapshot is created for update, then the snapshot will only contain the persisted packs.
-    auto delta_snap = delta->createSnapshot(dm_context, for_update, metric);
-    auto stable_snap = stable->createSnapshot();
-    if (!delta_snap || !stable_snap)
+    auto create = [&]() -> SegmentSnapshotPtr {
+        // If the snapshot is created for read, then the snapshot will contain all packs (cached and persisted) for read.
+        // If the snapshot is created for update, then the snapshot will only contain the persisted packs.
+        auto delta_snap = delta->createSnapshot(dm_context, for_update, metric);
+        auto stable_snap = stable->createSnapshot();
+        if (!delta_snap || !stable_snap)
+            return {};
+        return std::make_shared<SegmentSnapshot>(std::move(delta_snap), std::move(stable_snap));
+    };
+    if (for_update || !dm_context.db_context.getSettingsRef().dt_enable_segment_snapshot_reuse)
+        return create();
+
+    // The snapshots of the same version of the delta are the same, so the reads just clone the shared one,
+    // which only copies the lists of column files and creates new column caches.
+    std::scoped_lock lock(shared_read_snap_mutex);
+    if (delta->hasAbandoned())
         return {};
-    return std::make_shared<SegmentSnapshot>(std::move(delta_snap), std::move(stable_snap));
+    // Get the version before creating the snapshot, so that the content of a snapshot is never older than its version.
+    const auto version = delta->getVersion();
+    auto origin = shared_read_snap.lock();
+    if (!origin || shared_read_snap_version != version || shared_read_snap_metric != metric)
+    {
+        origin = create();
+        if (!origin)
+            return {};
+        shared_read_snap = origin;
+        shared_read_snap_version = version;
+        shared_read_snap_metric = metric;
+    }
+    auto snap = origin->clone();
+    snap->origin = origin;
+    return snap;
 }
 
 BlockInputStreamPtr Segment::getInputStream(const DMContext & dm_context,
@@ -375,7 +525,13 @@ BlockInputStreamPtr Segment::getInputStream(const DMContext & dm_context,
 {
     LOG_FMT_TRACE(log, "Segment [{}] [epoch={}] create InputStream", segment_id, epoch);
 
-    auto read_info = getReadInfo(dm_context, columns_to_read, segment_snap, read_ranges, max_version);
+    Stopwatch watch;
+    auto read_info = [&] {
+        ReadStageTimer timer(ReadStage::ReadInfo);
+        return getReadInfo(dm_context, columns_to_read, segment_snap, read_ranges, max_version);
+    }();
+    read_times.fetch_add(1, std::memory_order_relaxed);
+    read_delta_prepare_ns.fetch_add(watch.elapsed(), std::memory_order_relaxed);
 
     RowKeyRanges real_ranges;
     for (const auto & read_range : read_ranges)
@@ -404,7 +560,7 @@ BlockInputStreamPtr Segment::getInputStream(const DMContext & dm_context,
             false);
     }
     else if (segment_snap->delta->getRows() == 0 && segment_snap->delta->getDeletes() == 0 //
-             && !hasColumn(columns_to_read, EXTRA_HANDLE_COLUMN_ID) //
+             && (dm_context.read_rows_only || !hasColumn(columns_to_read, EXTRA_HANDLE_COLUMN_ID)) //
              && !hasColumn(columns_to_read, VERSION_COLUMN_ID) //
              && !hasColumn(columns_to_read, TAG_COLUMN_ID))
     {
@@ -470,14 +626,23 @@ BlockInputStreamPtr Segment::getInputStreamForDataExport(const DMContext & dm_co
                                                          size_t expected_block_size,
                                                          bool reorganize_block) const
 {
-    RowKeyRanges data_ranges{data_range};
-    auto read_info = getReadInfo(dm_context, columns_to_read, segment_snap, data_ranges);
+    auto read_info = getReadInfo(dm_context, columns_to_read, segment_snap, {data_range});
+    return getInputStreamForDataExport(dm_context, read_info, segment_snap->stable, data_range, expected_block_size, reorganize_block);
+}
 
+BlockInputStreamPtr Segment::getInputStreamForDataExport(const DMContext & dm_context,
+                                                         const ReadInfo & read_info,
+                                                         const StableSnapshotPtr & stable_snap,
+                                                         const RowKeyRange & data_range,
+                                                         size_t expected_block_size,
+                                                         bool reorganize_block) const
+{
+    RowKeyRanges data_ranges{data_range};
     BlockInputStreamPtr data_stream = getPlacedStream(dm_context,
                                                       *read_info.read_columns,
                                                       data_ranges,
                                                       EMPTY_FILTER,
-                                                      segment_snap->stable,
+                                                      stable_snap,
                                                       read_info.getDeltaReader(),
                                                       read_info.index_begin,
                                                       read_info.index_end,
@@ -516,6 +681,9 @@ BlockInputStreamPtr Segment::getInputStreamRaw(const DMContext & dm_context,
 {
     /// Now, we use filter_delete_mark to determine whether it is in fast mode or just from `selraw * xxxx`
     /// But this way seems not to be robustness enough, maybe we need another flag?
+    if (filter_delete_mark && dm_context.db_context.getSettingsRef().dt_enable_exact_fast_mode)
+        return getInputStreamExactFast(dm_context, columns_to_read, segment_snap, data_ranges, filter, expected_block_size);
+
     auto new_columns_to_read = std::make_shared<ColumnDefines>();
 
 
@@ -534,7 +702,7 @@ BlockInputStreamPtr Segment::getInputStreamRaw(const DMContext & dm_context,
             if (!(filter_delete_mark && c.id == TAG_COLUMN_ID))
                 new_columns_to_read->push_back(c);
         }
-        else
+        else if (!dm_context.read_rows_only)
         {
             enable_clean_read = false;
         }
@@ -592,6 +760,129 @@ BlockInputStreamPtr Segment::getInputStreamRaw(const DMContext & dm_context,
     return std::make_shared<ConcatBlockInputStream>(streams, dm_context.tracing_id);
 }
 
+BlockInputStreamPtr Segment::getInputStreamExactFast(const DMContext & dm_context,
+                                                     const ColumnDefines & columns_to_read,
+                                                     const SegmentSnapshotPtr & segment_snap,
+                                                     const RowKeyRanges & data_ranges,
+                                                     const RSOperatorPtr & filter,
+                                                     size_t expected_block_size)
+{
+    auto new_columns_to_read = std::make_shared<ColumnDefines>();
+    new_columns_to_read->push_back(getExtraHandleColumnDefine(is_common_handle));
+    new_columns_to_read->push_back(getVersionColumnDefine());
+    new_columns_to_read->push_back(getTagColumnDefine());
+    for (const auto & c : columns_to_read)
+    {
+        if (c.id != EXTRA_HANDLE_COLUMN_ID && c.id != VERSION_COLUMN_ID && c.id != TAG_COLUMN_ID)
+            new_columns_to_read->push_back(c);
+    }
+
+    const auto & delta_snap = segment_snap->delta;
+    const size_t delta_rows = delta_snap->getRows();
+    auto pk_ver_col_defs
+        = std::make_shared<ColumnDefines>(ColumnDefines{getExtraHandleColumnDefine(is_common_handle), getVersionColumnDefine()});
+    auto delta_reader = std::make_shared<DeltaValueReader>(dm_context, delta_snap, pk_ver_col_defs, this->rowkey_range);
+
+    // Read all the rows of the delta, in the order they are written.
+    Block delta_block = toEmptyBlock(*new_columns_to_read);
+    {
+        auto columns = delta_block.cloneEmptyColumns();
+        delta_reader->createNewReader(new_columns_to_read)->readRows(columns, 0, delta_rows, nullptr);
+        delta_block.setColumns(std::move(columns));
+    }
+    RowKeyColumnContainer delta_rowkeys(delta_block.getByPosition(0).column, is_common_handle);
+    const auto & delta_versions = getColumnVectorData<UInt64>(delta_block, 1);
+    const auto & delta_tags = getColumnVectorData<UInt8>(delta_block, 2);
+
+    // A delete range deletes the rows written before it, in both the delta and the stable.
+    RowKeyRanges delete_ranges;
+    IColumn::Filter alive(delta_block.rows(), 1);
+    size_t written_rows = 0;
+    for (auto & item : delta_reader->getPlaceItems(0, 0, delta_rows, delta_snap->getDeletes()))
+    {
+        if (item.isBlock())
+        {
+            written_rows = std::min(item.getBlockOffset() + item.getBlock().rows(), delta_block.rows());
+            continue;
+        }
+        const auto & delete_range = item.getDeleteRange();
+        for (size_t i = 0; i < written_rows; ++i)
+            alive[i] &= !delete_range.check(delta_rowkeys.getRowKeyValue(i));
+        delete_ranges.push_back(delete_range);
+    }
+
+    // Sort the alive delta rows by handle and version, the rows of the same handle and version are kept in the order they are written.
+    IColumn::Permutation sorted;
+    sorted.reserve(delta_block.rows());
+    for (size_t i = 0; i < delta_block.rows(); ++i)
+    {
+        if (alive[i])
+            sorted.push_back(i);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b) {
+        int res = compare(delta_rowkeys.getRowKeyValue(a), delta_rowkeys.getRowKeyValue(b));
+        return res != 0 ? res < 0 : delta_versions[a] < delta_versions[b];
+    });
+
+    // Only the latest version of each handle is returned unless it is deleted. The stable rows of the handles written
+    // in the delta are superseded. Note that the rows in the delta are assumed to be newer than the rows in the stable.
+    IColumn::Permutation latest;
+    std::vector<RowKeyValue> superseded_keys;
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        auto rowkey_value = delta_rowkeys.getRowKeyValue(sorted[i]);
+        if (i + 1 < sorted.size() && compare(rowkey_value, delta_rowkeys.getRowKeyValue(sorted[i + 1])) == 0)
+            continue;
+        superseded_keys.emplace_back(rowkey_value);
+        if (!delta_tags[sorted[i]])
+            latest.push_back(sorted[i]);
+    }
+    for (size_t i = 0; i < delta_block.columns(); ++i)
+    {
+        auto & column = delta_block.getByPosition(i);
+        column.column = column.column->permute(latest, latest.size());
+    }
+
+    BlockInputStreamPtr delta_stream = std::make_shared<OneBlockInputStream>(delta_block);
+    delta_stream = std::make_shared<DMRowKeyFilterBlockInputStream<true>>(delta_stream, data_ranges, 0);
+    delta_stream = std::make_shared<DMColumnProjectionBlockInputStream>(delta_stream, columns_to_read);
+
+    BlockInputStreamPtr stable_stream = segment_snap->stable->getInputStream(
+        dm_context,
+        *new_columns_to_read,
+        data_ranges,
+        filter,
+        std::numeric_limits<UInt64>::max(),
+        expected_block_size,
+        /* enable_clean_read */ false);
+    stable_stream = std::make_shared<DMRowKeyFilterBlockInputStream<true>>(stable_stream, data_ranges, 0);
+    // Deduplicate the versions in the stable and filter out the deleted rows.
+    stable_stream = std::make_shared<DMVersionFilterBlockInputStream<DM_VERSION_FILTER_MODE_MVCC>>(
+        stable_stream,
+        *new_columns_to_read,
+        std::numeric_limits<UInt64>::max(),
+        is_common_handle,
+        dm_context.tracing_id);
+    stable_stream = std::make_shared<DMSupersededFilterBlockInputStream>(stable_stream, std::move(superseded_keys), std::move(delete_ranges), is_common_handle);
+    stable_stream = std::make_shared<DMColumnProjectionBlockInputStream>(stable_stream, columns_to_read);
+
+    BlockInputStreams streams;
+    if (dm_context.read_delta_only)
+    {
+        streams.push_back(delta_stream);
+    }
+    else if (dm_context.read_stable_only)
+    {
+        streams.push_back(stable_stream);
+    }
+    else
+    {
+        streams.push_back(delta_stream);
+        streams.push_back(stable_stream);
+    }
+    return std::make_shared<ConcatBlockInputStream>(streams, dm_context.tracing_id);
+}
+
 BlockInputStreamPtr Segment::getInputStreamRaw(const DMContext & dm_context, const ColumnDefines & columns_to_read, bool filter_delete_mark)
 {
     auto segment_snap = createSnapshot(dm_context, false, CurrentMetrics::DT_SnapshotOfReadRaw);
@@ -633,15 +924,64 @@ StableValueSpacePtr Segment::prepareMergeDelta(DMContext & dm_context,
 
     EventRecorder recorder(ProfileEvents::DMDeltaMerge, ProfileEvents::DMDeltaMergeNS);
 
-    auto data_stream = getInputStreamForDataExport(
-        dm_context,
-        *schema_snap,
-        segment_snap,
-        rowkey_range,
-        dm_context.stable_pack_rows,
-        /*reorginize_block*/ true);
+    const auto & settings = dm_context.db_context.getSettingsRef();
+    const size_t column_group_size = settings.dt_merge_delta_column_group_size;
+    // Besides the handle, version and tag columns.
+    const bool is_vertical = column_group_size > 0 && !settings.dt_enable_single_file_mode_dmfile
+        && schema_snap->size() > column_group_size + 3;
+
+    auto sub_ranges = getRewriteSubRanges(dm_context, segment_snap);
+    bool on_fast_path = shouldStableOnFastPath(dm_context);
+    StableValueSpacePtr new_stable;
+    if (sub_ranges.size() <= 1 && is_vertical)
+    {
+        // Place the delta index once, and read the segment once for each column group by it.
+        auto read_info = getReadInfo(dm_context, *schema_snap, segment_snap, {rowkey_range});
+        auto create_stream = [&](const ColumnDefinesPtr & columns) {
+            auto group_read_info = read_info;
+            group_read_info.read_columns = arrangeReadColumns(getExtraHandleColumnDefine(is_common_handle), *columns);
+            return getInputStreamForDataExport(
+                dm_context,
+                group_read_info,
+                segment_snap->stable,
+                rowkey_range,
+                dm_context.stable_pack_rows,
+                /*reorginize_block*/ true);
+        };
+        new_stable = createNewStableVertically(dm_context, schema_snap, create_stream, column_group_size, segment_snap->stable->getId(), wbs, on_fast_path);
+    }
+    else if (sub_ranges.size() <= 1)
+    {
+        auto data_stream = getInputStreamForDataExport(
+            dm_context,
+            *schema_snap,
+            segment_snap,
+            rowkey_range,
+            dm_context.stable_pack_rows,
+            /*reorginize_block*/ true);
 
-    auto new_stable = createNewStable(dm_context, schema_snap, data_stream, segment_snap->stable->getId(), wbs);
+        new_stable = createNewStable(dm_context, schema_snap, data_stream, segment_snap->stable->getId(), wbs, on_fast_path);
+    }
+    else
+    {
+        // Rewrite each sub range into its own DTFile concurrently. The DTFiles make up the new stable, which is
+        // still applied as a whole by `applyMergeDelta`.
+        auto read_info = getReadInfo(dm_context, *schema_snap, segment_snap, {rowkey_range});
+        BlockInputStreams data_streams;
+        for (const auto & sub_range : sub_ranges)
+        {
+            // The column caches of a stable snapshot are not thread safe, so every stream reads from its own clone.
+            data_streams.push_back(getInputStreamForDataExport(
+                dm_context,
+                read_info,
+                segment_snap->stable->clone(),
+                sub_range,
+                dm_context.stable_pack_rows,
+                /*reorginize_block*/ true));
+        }
+        auto dtfiles = writeIntoNewDMFiles(dm_context, schema_snap, data_streams, on_fast_path);
+        new_stable = createNewStable(dm_context, dtfiles, segment_snap->stable->getId(), wbs);
+    }
 
     LOG_FMT_INFO(log, "Segment [{}] prepare merge delta done.", segment_id);
 
@@ -719,8 +1059,11 @@ std::optional<RowKeyValue> Segment::getSplitPointFast(DMContext & dm_context, co
     if (unlikely(!stable_rows))
         throw Exception("No stable rows");
 
-    size_t split_row_index = stable_rows / 2;
+    return getStableRowKeyAt(dm_context, stable_snap, stable_rows / 2);
+}
 
+std::optional<RowKeyValue> Segment::getStableRowKeyAt(DMContext & dm_context, const StableSnapshotPtr & stable_snap, size_t split_row_index) const
+{
     const auto & dmfiles = stable_snap->getDMFiles();
 
     DMFilePtr read_file;
@@ -797,6 +1140,64 @@ std::optional<RowKeyValue> Segment::getSplitPointFast(DMContext & dm_context, co
     return {split_point};
 }
 
+bool Segment::isStableOnFastPath(const DMContext & dm_context) const
+{
+    auto delegator = dm_context.path_pool.getStableDiskDelegator();
+    const auto & dmfiles = stable->getDMFiles();
+    return !dmfiles.empty() && std::all_of(dmfiles.begin(), dmfiles.end(), [&](const DMFilePtr & dmfile) {
+               return delegator.isOnFastPath(dmfile->fileId());
+           });
+}
+
+bool Segment::shouldStableOnFastPath(const DMContext & dm_context) const
+{
+    const UInt64 hot_reads_per_minute = dm_context.db_context.getSettingsRef().dt_stable_fast_path_hot_reads_per_minute;
+    if (hot_reads_per_minute == 0 || !dm_context.path_pool.getStableDiskDelegator().hasFastPaths())
+        return false;
+
+    // The read rate of a young segment is not reliable, e.g. the ones just restored, split or merged delta.
+    static constexpr double min_age_seconds = 300;
+    const bool on_fast_path = isStableOnFastPath(dm_context);
+    const double age_seconds = getAgeSeconds();
+    if (age_seconds < min_age_seconds)
+        return on_fast_path;
+
+    // Only move it back to the main paths when it is read less than half of the threshold,
+    // so that a segment read around the threshold is not moved back and forth.
+    const double reads_per_minute = getReadTimes() * 60 / age_seconds;
+    return on_fast_path ? reads_per_minute * 2 >= hot_reads_per_minute : reads_per_minute >= hot_reads_per_minute;
+}
+
+size_t Segment::getRewriteConcurrency(const DMContext & dm_context, const SegmentSnapshotPtr & segment_snap) const
+{
+    // Only the segments larger than the expected size are worth it, e.g. the ones that are going to be split.
+    if (segment_snap->getBytes() < dm_context.segment_limit_bytes || segment_snap->stable->getRows() == 0)
+        return 1;
+    return std::max<size_t>(1, dm_context.db_context.getSettingsRef().dt_segment_rewrite_concurrency);
+}
+
+RowKeyRanges Segment::getRewriteSubRanges(DMContext & dm_context, const SegmentSnapshotPtr & segment_snap) const
+{
+    const auto concurrency = getRewriteConcurrency(dm_context, segment_snap);
+    if (concurrency <= 1)
+        return {rowkey_range};
+    auto stable_rows = segment_snap->stable->getRows();
+
+    // The sub ranges have about the same number of rows in stable. The delta is not considered.
+    RowKeyRanges sub_ranges;
+    RowKeyValue start = rowkey_range.start;
+    for (size_t i = 1; i < concurrency; ++i)
+    {
+        auto point = getStableRowKeyAt(dm_context, segment_snap->stable, stable_rows * i / concurrency);
+        if (!point || !(start.toRowKeyValueRef() < point->toRowKeyValueRef()))
+            continue;
+        sub_ranges.emplace_back(start, *point, is_common_handle, rowkey_column_size);
+        start = *point;
+    }
+    sub_ranges.emplace_back(start, rowkey_range.end, is_common_handle, rowkey_column_size);
+    return sub_ranges;
+}
+
 std::optional<RowKeyValue> Segment::getSplitPointSlow(
     DMContext & dm_context,
     const ReadInfo & read_info,
@@ -1028,71 +1429,63 @@ std::optional<Segment::SplitInfo> Segment::prepareSplitPhysical(DMContext & dm_c
         return {};
     }
 
+    auto create_data_stream = [&](const RowKeyRange & range, const StableSnapshotPtr & stable_snap) -> BlockInputStreamPtr {
+        auto delta_reader = read_info.getDeltaReader(schema_snap);
+
+        RowKeyRanges ranges{range};
+        BlockInputStreamPtr data = getPlacedStream(dm_context,
+                                                   *read_info.read_columns,
+                                                   ranges,
+                                                   EMPTY_FILTER,
+                                                   stable_snap,
+                                                   delta_reader,
+                                                   read_info.index_begin,
+                                                   read_info.index_end,
+                                                   dm_context.stable_pack_rows);
+
+        data = std::make_shared<DMRowKeyFilterBlockInputStream<true>>(data, ranges, 0);
+        data = std::make_shared<PKSquashingBlockInputStream<false>>(data, EXTRA_HANDLE_COLUMN_ID, is_common_handle);
+        data = std::make_shared<DMVersionFilterBlockInputStream<DM_VERSION_FILTER_MODE_COMPACT>>(
+            data,
+            *read_info.read_columns,
+            dm_context.min_version,
+            is_common_handle);
+        return data;
+    };
+
     StableValueSpacePtr my_new_stable;
     StableValueSpacePtr other_stable;
 
+    auto my_stable_id = segment_snap->stable->getId();
+    bool on_fast_path = shouldStableOnFastPath(dm_context);
+    if (getRewriteConcurrency(dm_context, segment_snap) > 1)
+    {
+        // Write the two new stables concurrently. The column caches of a stable snapshot are not thread safe,
+        // so the other one reads from a clone.
+        LOG_FMT_DEBUG(log, "Created my and other placed streams");
+        auto dtfiles = writeIntoNewDMFiles(
+            dm_context,
+            schema_snap,
+            {create_data_stream(my_range, segment_snap->stable), create_data_stream(other_range, segment_snap->stable->clone())},
+            on_fast_path);
+        my_new_stable = createNewStable(dm_context, {dtfiles[0]}, my_stable_id, wbs);
+        other_stable = createNewStable(dm_context, {dtfiles[1]}, dm_context.storage_pool.newMetaPageId(), wbs);
+        LOG_FMT_INFO(log, "prepare my_new_stable and other_stable done");
+    }
+    else
     {
         // Write my data
         LOG_FMT_DEBUG(log, "Created my placed stream");
+        my_new_stable = createNewStable(dm_context, schema_snap, create_data_stream(my_range, segment_snap->stable), my_stable_id, wbs, on_fast_path);
+        LOG_FMT_INFO(log, "prepare my_new_stable done");
 
-        auto my_delta_reader = read_info.getDeltaReader(schema_snap);
-
-        RowKeyRanges my_ranges{my_range};
-        BlockInputStreamPtr my_data = getPlacedStream(dm_context,
-                                                      *read_info.read_columns,
-                                                      my_ranges,
-                                                      EMPTY_FILTER,
-                                                      segment_snap->stable,
-                                                      my_delta_reader,
-                                                      read_info.index_begin,
-                                                      read_info.index_end,
-                                                      dm_context.stable_pack_rows);
-
-
-        my_data = std::make_shared<DMRowKeyFilterBlockInputStream<true>>(my_data, my_ranges, 0);
-        my_data = std::make_shared<PKSquashingBlockInputStream<false>>(my_data, EXTRA_HANDLE_COLUMN_ID, is_common_handle);
-        my_data = std::make_shared<DMVersionFilterBlockInputStream<DM_VERSION_FILTER_MODE_COMPACT>>(
-            my_data,
-            *read_info.read_columns,
-            dm_context.min_version,
-            is_common_handle);
-        auto my_stable_id = segment_snap->stable->getId();
-        my_new_stable = createNewStable(dm_context, schema_snap, my_data, my_stable_id, wbs);
-    }
-
-    LOG_FMT_INFO(log, "prepare my_new_stable done");
-
-    {
         // Write new segment's data
         LOG_FMT_DEBUG(log, "Created other placed stream");
-
-        auto other_delta_reader = read_info.getDeltaReader(schema_snap);
-
-        RowKeyRanges other_ranges{other_range};
-        BlockInputStreamPtr other_data = getPlacedStream(dm_context,
-                                                         *read_info.read_columns,
-                                                         other_ranges,
-                                                         EMPTY_FILTER,
-                                                         segment_snap->stable,
-                                                         other_delta_reader,
-                                                         read_info.index_begin,
-                                                         read_info.index_end,
-                                                         dm_context.stable_pack_rows);
-
-
-        other_data = std::make_shared<DMRowKeyFilterBlockInputStream<true>>(other_data, other_ranges, 0);
-        other_data = std::make_shared<PKSquashingBlockInputStream<false>>(other_data, EXTRA_HANDLE_COLUMN_ID, is_common_handle);
-        other_data = std::make_shared<DMVersionFilterBlockInputStream<DM_VERSION_FILTER_MODE_COMPACT>>(
-            other_data,
-            *read_info.read_columns,
-            dm_context.min_version,
-            is_common_handle);
         auto other_stable_id = dm_context.storage_pool.newMetaPageId();
-        other_stable = createNewStable(dm_context, schema_snap, other_data, other_stable_id, wbs);
+        other_stable = createNewStable(dm_context, schema_snap, create_data_stream(other_range, segment_snap->stable), other_stable_id, wbs, on_fast_path);
+        LOG_FMT_INFO(log, "prepare other_stable done");
     }
 
-    LOG_FMT_INFO(log, "prepare other_stable done");
-
     // Remove old stable's files.
     for (const auto & file : stable->getDMFiles())
     {
@@ -1163,55 +1556,56 @@ SegmentPair Segment::applySplit(DMContext & dm_context, //
 }
 
 SegmentPtr Segment::merge(DMContext & dm_context, const ColumnDefinesPtr & schema_snap, const SegmentPtr & left, const SegmentPtr & right)
+{
+    return merge(dm_context, schema_snap, Segments{left, right});
+}
+
+SegmentPtr Segment::merge(DMContext & dm_context, const ColumnDefinesPtr & schema_snap, const Segments & ordered_segments)
 {
     WriteBatches wbs(dm_context.storage_pool, dm_context.getWriteLimiter());
     /// This segment may contain some rows that not belong to this segment range which is left by previous split operation.
     /// And only saved data in this segment will be filtered by the segment range in the merge process,
     /// unsaved data will be directly copied to the new segment.
     /// So we flush here to make sure that all potential data left by previous split operation is saved.
-    while (!left->flushCache(dm_context))
+    for (const auto & segment : ordered_segments)
     {
-        // keep flush until success if not abandoned
-        if (left->hasAbandoned())
+        while (!segment->flushCache(dm_context))
         {
-            LOG_FMT_DEBUG(left->log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
-            return {};
+            // keep flush until success if not abandoned
+            if (segment->hasAbandoned())
+            {
+                LOG_FMT_DEBUG(segment->log, "Give up merge segments {}", simpleInfo(ordered_segments));
+                return {};
+            }
         }
     }
-    while (!right->flushCache(dm_context))
+
+    std::vector<SegmentSnapshotPtr> ordered_snapshots;
+    ordered_snapshots.reserve(ordered_segments.size());
+    for (const auto & segment : ordered_segments)
     {
-        // keep flush until success if not abandoned
-        if (right->hasAbandoned())
-        {
-            LOG_FMT_DEBUG(right->log, "Give up merge segments left [{}], right [{}]", left->segmentId(), right->segmentId());
+        auto snap = segment->createSnapshot(dm_context, true, CurrentMetrics::DT_SnapshotOfSegmentMerge);
+        if (!snap)
             return {};
-        }
+        ordered_snapshots.emplace_back(std::move(snap));
     }
 
-
-    auto left_snap = left->createSnapshot(dm_context, true, CurrentMetrics::DT_SnapshotOfSegmentMerge);
-    auto right_snap = right->createSnapshot(dm_context, true, CurrentMetrics::DT_SnapshotOfSegmentMerge);
-    if (!left_snap || !right_snap)
-        return {};
-
-    auto merged_stable = prepareMerge(dm_context, schema_snap, left, left_snap, right, right_snap, wbs);
+    auto merged_stable = prepareMerge(dm_context, schema_snap, ordered_segments, ordered_snapshots, wbs);
 
     wbs.writeLogAndData();
     merged_stable->enableDMFilesGC();
 
-    auto left_lock = left->mustGetUpdateLock();
-    auto right_lock = right->mustGetUpdateLock();
+    std::vector<Segment::Lock> locks;
+    locks.reserve(ordered_segments.size());
+    for (const auto & segment : ordered_segments)
+        locks.emplace_back(segment->mustGetUpdateLock());
 
-    auto merged = applyMerge(dm_context, left, left_snap, right, right_snap, wbs, merged_stable);
+    auto merged = applyMerge(dm_context, ordered_segments, ordered_snapshots, wbs, merged_stable);
 
     wbs.writeAll();
     return merged;
 }
 
-/// Segments may contain some rows that not belong to its range which is left by previous split operation.
-/// And only saved data in the segment will be filtered by the segment range in the merge process,
-/// unsaved data will be directly copied to the new segment.
-/// So remember to do a flush for the segments before merge.
 StableValueSpacePtr Segment::prepareMerge(DMContext & dm_context, //
                                           const ColumnDefinesPtr & schema_snap,
                                           const SegmentPtr & left,
@@ -1220,20 +1614,41 @@ StableValueSpacePtr Segment::prepareMerge(DMContext & dm_context, //
                                           const SegmentSnapshotPtr & right_snap,
                                           WriteBatches & wbs)
 {
-    LOG_FMT_INFO(left->log, "Segment [{}] and [{}] prepare merge start", left->segmentId(), right->segmentId());
+    return prepareMerge(dm_context, schema_snap, Segments{left, right}, {left_snap, right_snap}, wbs);
+}
 
-    if (unlikely(compare(left->rowkey_range.getEnd(), right->rowkey_range.getStart()) != 0 || left->next_segment_id != right->segment_id))
-        throw Exception(
-            fmt::format("The ranges of merge segments are not consecutive: first end: {}, second start: {}",
-                        left->rowkey_range.getEnd().toDebugString(),
-                        right->rowkey_range.getStart().toDebugString()));
+/// Segments may contain some rows that not belong to its range which is left by previous split operation.
+/// And only saved data in the segment will be filtered by the segment range in the merge process,
+/// unsaved data will be directly copied to the new segment.
+/// So remember to do a flush for the segments before merge.
+StableValueSpacePtr Segment::prepareMerge(DMContext & dm_context, //
+                                          const ColumnDefinesPtr & schema_snap,
+                                          const Segments & ordered_segments,
+                                          const std::vector<SegmentSnapshotPtr> & ordered_snapshots,
+                                          WriteBatches & wbs)
+{
+    RUNTIME_CHECK(ordered_segments.size() >= 2 && ordered_segments.size() == ordered_snapshots.size(), Exception, "Invalid segments to merge");
+
+    const auto & first = ordered_segments.front();
+    LOG_FMT_INFO(first->log, "Segments {} prepare merge start", simpleInfo(ordered_segments));
+
+    for (size_t i = 1; i < ordered_segments.size(); ++i)
+    {
+        const auto & prev = ordered_segments[i - 1];
+        const auto & cur = ordered_segments[i];
+        if (unlikely(compare(prev->rowkey_range.getEnd(), cur->rowkey_range.getStart()) != 0 || prev->next_segment_id != cur->segment_id))
+            throw Exception(
+                fmt::format("The ranges of merge segments are not consecutive: first end: {}, second start: {}",
+                            prev->rowkey_range.getEnd().toDebugString(),
+                            cur->rowkey_range.getStart().toDebugString()));
+    }
 
     auto get_stream = [&](const SegmentPtr & segment, const SegmentSnapshotPtr & segment_snap) {
         auto read_info = segment->getReadInfo(
             dm_context,
             *schema_snap,
             segment_snap,
-            {RowKeyRange::newAll(left->is_common_handle, left->rowkey_column_size)});
+            {RowKeyRange::newAll(first->is_common_handle, first->rowkey_column_size)});
         RowKeyRanges rowkey_ranges{segment->rowkey_range};
         BlockInputStreamPtr stream = getPlacedStream(dm_context,
                                                      *read_info.read_columns,
@@ -1256,10 +1671,16 @@ StableValueSpacePtr Segment::prepareMerge(DMContext & dm_context, //
         return stream;
     };
 
-    auto left_stream = get_stream(left, left_snap);
-    auto right_stream = get_stream(right, right_snap);
+    BlockInputStreams streams;
+    streams.reserve(ordered_segments.size());
+    bool on_fast_path = false;
+    for (size_t i = 0; i < ordered_segments.size(); ++i)
+    {
+        streams.emplace_back(get_stream(ordered_segments[i], ordered_snapshots[i]));
+        on_fast_path = on_fast_path || ordered_segments[i]->shouldStableOnFastPath(dm_context);
+    }
 
-    BlockInputStreamPtr merged_stream = std::make_shared<ConcatBlockInputStream>(BlockInputStreams{left_stream, right_stream}, /*req_id=*/"");
+    BlockInputStreamPtr merged_stream = std::make_shared<ConcatBlockInputStream>(streams, /*req_id=*/"");
     // for the purpose to calculate StableProperty of the new segment
     merged_stream = std::make_shared<DMVersionFilterBlockInputStream<DM_VERSION_FILTER_MODE_COMPACT>>(
         merged_stream,
@@ -1267,10 +1688,10 @@ StableValueSpacePtr Segment::prepareMerge(DMContext & dm_context, //
         dm_context.min_version,
         dm_context.is_common_handle);
 
-    auto merged_stable_id = left->stable->getId();
-    auto merged_stable = createNewStable(dm_context, schema_snap, merged_stream, merged_stable_id, wbs);
+    auto merged_stable_id = first->stable->getId();
+    auto merged_stable = createNewStable(dm_context, schema_snap, merged_stream, merged_stable_id, wbs, on_fast_path);
 
-    LOG_FMT_INFO(left->log, "Segment [{}] and [{}] prepare merge done", left->segmentId(), right->segmentId());
+    LOG_FMT_INFO(first->log, "Segments {} prepare merge done", simpleInfo(ordered_segments));
 
     return merged_stable;
 }
@@ -1283,28 +1704,45 @@ SegmentPtr Segment::applyMerge(DMContext & dm_context, //
                                WriteBatches & wbs,
                                const StableValueSpacePtr & merged_stable)
 {
-    LOG_FMT_INFO(left->log, "Segment [{}] and [{}] apply merge", left->segmentId(), right->segmentId());
+    return applyMerge(dm_context, Segments{left, right}, {left_snap, right_snap}, wbs, merged_stable);
+}
 
-    RowKeyRange merged_range(left->rowkey_range.start, right->rowkey_range.end, left->is_common_handle, left->rowkey_column_size);
+SegmentPtr Segment::applyMerge(DMContext & dm_context, //
+                               const Segments & ordered_segments,
+                               const std::vector<SegmentSnapshotPtr> & ordered_snapshots,
+                               WriteBatches & wbs,
+                               const StableValueSpacePtr & merged_stable)
+{
+    RUNTIME_CHECK(ordered_segments.size() >= 2 && ordered_segments.size() == ordered_snapshots.size(), Exception, "Invalid segments to merge");
 
-    auto [left_persisted_files, left_in_memory_files] = left->delta->checkHeadAndCloneTail(dm_context, merged_range, left_snap->delta->getColumnFilesInSnapshot(), wbs);
-    auto [right_persisted_files, right_in_memory_files] = right->delta->checkHeadAndCloneTail(dm_context, merged_range, right_snap->delta->getColumnFilesInSnapshot(), wbs);
+    const auto & first = ordered_segments.front();
+    const auto & last = ordered_segments.back();
+    LOG_FMT_INFO(first->log, "Segments {} apply merge", simpleInfo(ordered_segments));
 
-    // Created references to tail pages' pages in "log" storage, we need to write them down.
-    wbs.writeLogAndData();
+    RowKeyRange merged_range(first->rowkey_range.start, last->rowkey_range.end, first->is_common_handle, first->rowkey_column_size);
 
-    ColumnFilePersisteds merged_persisted_column_files = std::move(left_persisted_files);
-    ColumnFiles merged_in_memory_files = std::move(left_in_memory_files);
+    ColumnFilePersisteds merged_persisted_column_files;
+    ColumnFiles merged_in_memory_files;
+    for (size_t i = 0; i < ordered_segments.size(); ++i)
+    {
+        auto [persisted_files, in_memory_files] = ordered_segments[i]->delta->checkHeadAndCloneTail(
+            dm_context,
+            merged_range,
+            ordered_snapshots[i]->delta->getColumnFilesInSnapshot(),
+            wbs);
+        merged_persisted_column_files.insert(merged_persisted_column_files.end(), persisted_files.begin(), persisted_files.end());
+        merged_in_memory_files.insert(merged_in_memory_files.end(), in_memory_files.begin(), in_memory_files.end());
+    }
 
-    merged_persisted_column_files.insert(merged_persisted_column_files.end(), right_persisted_files.begin(), right_persisted_files.end());
-    merged_in_memory_files.insert(merged_in_memory_files.end(), right_in_memory_files.begin(), right_in_memory_files.end());
+    // Created references to tail pages' pages in "log" storage, we need to write them down.
+    wbs.writeLogAndData();
 
-    auto merged_delta = std::make_shared<DeltaValueSpace>(left->delta->getId(), merged_persisted_column_files, merged_in_memory_files);
+    auto merged_delta = std::make_shared<DeltaValueSpace>(first->delta->getId(), merged_persisted_column_files, merged_in_memory_files);
 
-    auto merged = std::make_shared<Segment>(left->epoch + 1, //
+    auto merged = std::make_shared<Segment>(first->epoch + 1, //
                                             merged_range,
-                                            left->segment_id,
-                                            right->next_segment_id,
+                                            first->segment_id,
+                                            last->next_segment_id,
                                             merged_delta,
                                             merged_stable);
 
@@ -1313,17 +1751,21 @@ SegmentPtr Segment::applyMerge(DMContext & dm_context, //
     merged->stable->saveMeta(wbs.meta);
     merged->serialize(wbs.meta);
 
-    left->delta->recordRemoveColumnFilesPages(wbs);
-    left->stable->recordRemovePacksPages(wbs);
-
-    right->delta->recordRemoveColumnFilesPages(wbs);
-    right->stable->recordRemovePacksPages(wbs);
-
-    wbs.removed_meta.delPage(right->segmentId());
-    wbs.removed_meta.delPage(right->delta->getId());
-    wbs.removed_meta.delPage(right->stable->getId());
+    for (size_t i = 0; i < ordered_segments.size(); ++i)
+    {
+        const auto & segment = ordered_segments[i];
+        segment->delta->recordRemoveColumnFilesPages(wbs);
+        segment->stable->recordRemovePacksPages(wbs);
+        // The merged segment reuses the ids of the first segment.
+        if (i > 0)
+        {
+            wbs.removed_meta.delPage(segment->segmentId());
+            wbs.removed_meta.delPage(segment->delta->getId());
+            wbs.removed_meta.delPage(segment->stable->getId());
+        }
+    }
 
-    LOG_FMT_INFO(left->log, "Segment [{}] and [{}] merged into {}", left->info(), right->info(), merged->info());
+    LOG_FMT_INFO(first->log, "Segments {} merged into {}", info(ordered_segments), merged->info());
 
     return merged;
 }
@@ -1377,6 +1819,8 @@ void Segment::placeDeltaIndex(DMContext & dm_context)
                 /*read_columns=*/{getExtraHandleColumnDefine(is_common_handle)},
                 segment_snap,
                 {RowKeyRange::newAll(is_common_handle, rowkey_column_size)});
+    if (dm_context.db_context.getSettingsRef().dt_enable_persisted_delta_index)
+        delta->persistDeltaIndex(dm_context);
 }
 
 String Segment::simpleInfo() const
@@ -1399,6 +1843,30 @@ String Segment::info() const
                        stable->getBytes());
 }
 
+String Segment::simpleInfo(const Segments & segments)
+{
+    FmtBuffer buf;
+    buf.append("[");
+    buf.joinStr(
+        segments.begin(),
+        segments.end(),
+        [](const SegmentPtr & segment, FmtBuffer & fb) { fb.append(segment->simpleInfo()); },
+        ", ");
+    buf.append("]");
+    return buf.toString();
+}
+
+String Segment::info(const Segments & segments)
+{
+    FmtBuffer buf;
+    buf.joinStr(
+        segments.begin(),
+        segments.end(),
+        [](const SegmentPtr & segment, FmtBuffer & fb) { fb.fmtAppend("[{}]", segment->info()); },
+        ", ");
+    return buf.toString();
+}
+
 void Segment::drop(const FileProviderPtr & file_provider, WriteBatches & wbs)
 {
     delta->recordRemoveColumnFilesPages(wbs);
@@ -1504,7 +1972,6 @@ std::pair<DeltaIndexPtr, bool> Segment::ensurePlace(const DMContext & dm_context
     auto delta_snap = delta_reader->getDeltaSnap();
     // Clone a new delta index.
     auto my_delta_index = delta_snap->getSharedDeltaIndex()->tryClone(delta_snap->getRows(), delta_snap->getDeletes());
-    auto my_delta_tree = my_delta_index->getDeltaTree();
 
     bool relevant_place = dm_context.enable_relevant_place;
     bool skippable_place = dm_context.enable_skippable_place;
@@ -1528,6 +1995,9 @@ std::pair<DeltaIndexPtr, bool> Segment::ensurePlace(const DMContext & dm_context
 
     EventRecorder recorder(ProfileEvents::DMPlace, ProfileEvents::DMPlaceNS);
 
+    // The delta tree of the cloned index is shared with the shared delta index until now.
+    auto my_delta_tree = my_delta_index->getMutableDeltaTree();
+
     auto items = delta_reader->getPlaceItems(my_placed_rows, my_placed_deletes, delta_snap->getRows(), delta_snap->getDeletes());
 
     bool fully_indexed = true;
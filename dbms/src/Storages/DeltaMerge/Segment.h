@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <Common/Stopwatch.h>
 #include <Common/nocopyable.h>
 #include <Core/Block.h>
 #include <Interpreters/ExpressionActions.h>
@@ -55,6 +56,10 @@ struct SegmentSnapshot : private boost::noncopyable
         , stable(std::move(stable_))
     {}
 
+    /// The snapshot this one is cloned from, if it is shared by the concurrent reads, see `Segment::createSnapshot`.
+    /// Each read holds the origin, so that it can be shared as long as any of the reads is alive.
+    SegmentSnapshotPtr origin;
+
     SegmentSnapshotPtr clone() { return std::make_shared<SegmentSnapshot>(delta->clone(), stable->clone()); }
 
     UInt64 getBytes() { return delta->getBytes() + stable->getBytes(); }
@@ -177,6 +182,15 @@ public:
         const RowKeyRange & data_range,
         size_t expected_block_size = DEFAULT_BLOCK_SIZE,
         bool reorganize_block = true) const;
+    /// Same as above, but reuse a `read_info` of `data_range` and read the stable by `stable_snap`, so that several
+    /// streams can be created from one placed delta index.
+    BlockInputStreamPtr getInputStreamForDataExport(
+        const DMContext & dm_context,
+        const ReadInfo & read_info,
+        const StableSnapshotPtr & stable_snap,
+        const RowKeyRange & data_range,
+        size_t expected_block_size,
+        bool reorganize_block) const;
 
     BlockInputStreamPtr getInputStreamRaw(
         const DMContext & dm_context,
@@ -192,6 +206,17 @@ public:
         const ColumnDefines & columns_to_read,
         bool filter_delete_mark = false);
 
+    /// Read in fast mode, but return only the latest version of each row, see `dt_enable_exact_fast_mode`.
+    /// The stable rows superseded by the delta are filtered out by the handles and delete ranges in the delta,
+    /// and the delta rows are sorted and deduplicated in memory, so that the delta is never placed.
+    BlockInputStreamPtr getInputStreamExactFast(
+        const DMContext & dm_context,
+        const ColumnDefines & columns_to_read,
+        const SegmentSnapshotPtr & segment_snap,
+        const RowKeyRanges & data_ranges,
+        const RSOperatorPtr & filter,
+        size_t expected_block_size = DEFAULT_BLOCK_SIZE);
+
     /// For those split, merge and mergeDelta methods, we should use prepareXXX/applyXXX combo in real production.
     /// split(), merge() and mergeDelta() are only used in test cases.
 
@@ -230,6 +255,25 @@ public:
         WriteBatches & wbs,
         const StableValueSpacePtr & merged_stable);
 
+    /// Merge multiple consecutive segments into one, `ordered_segments` must be sorted by the range and
+    /// contain at least two segments. The merged segment reuses the ids of the first segment.
+    static SegmentPtr merge(
+        DMContext & dm_context,
+        const ColumnDefinesPtr & schema_snap,
+        const Segments & ordered_segments);
+    static StableValueSpacePtr prepareMerge(
+        DMContext & dm_context,
+        const ColumnDefinesPtr & schema_snap,
+        const Segments & ordered_segments,
+        const std::vector<SegmentSnapshotPtr> & ordered_snapshots,
+        WriteBatches & wbs);
+    static SegmentPtr applyMerge(
+        DMContext & dm_context,
+        const Segments & ordered_segments,
+        const std::vector<SegmentSnapshotPtr> & ordered_snapshots,
+        WriteBatches & wbs,
+        const StableValueSpacePtr & merged_stable);
+
     /// Merge the delta (major compaction) and return the new segment.
     ///
     /// Note: This is only a shortcut function used in tests.
@@ -273,6 +317,9 @@ public:
     String simpleInfo() const;
     String info() const;
 
+    static String simpleInfo(const Segments & segments);
+    static String info(const Segments & segments);
+
     using Lock = DeltaValueSpace::Lock;
     bool getUpdateLock(Lock & lock) const { return delta->getLock(lock); }
 
@@ -315,6 +362,20 @@ public:
 
     void setLastCheckGCSafePoint(DB::Timestamp gc_safe_point) { last_check_gc_safe_point.store(gc_safe_point, std::memory_order_relaxed); }
 
+    /// The number of reads of this segment, and the time they spent on preparing the delta (mostly placing the delta index).
+    /// Counted since this segment is created, that is, since the last split / merge / merge delta.
+    UInt64 getReadTimes() const { return read_times.load(std::memory_order_relaxed); }
+    UInt64 getReadDeltaPrepareNs() const { return read_delta_prepare_ns.load(std::memory_order_relaxed); }
+    /// The number of rows written into this segment, and the seconds passed, since this segment is created.
+    UInt64 getWrittenRows() const { return written_rows.load(std::memory_order_relaxed); }
+    double getAgeSeconds() const { return age_watch.elapsedSeconds(); }
+
+    /// Whether the DTFiles of the stable are all on the fast paths, see `StableDiskDelegator::hasFastPaths`.
+    bool isStableOnFastPath(const DMContext & dm_context) const;
+    /// Whether the stable should be put on the fast paths when it is rewritten, decided by the read rate of this
+    /// segment, see `dt_stable_fast_path_hot_reads_per_minute`. A young segment keeps its stable where it is.
+    bool shouldStableOnFastPath(const DMContext & dm_context) const;
+
 private:
     ReadInfo getReadInfo(
         const DMContext & dm_context,
@@ -350,6 +411,15 @@ private:
     std::optional<RowKeyValue> getSplitPointFast(
         DMContext & dm_context,
         const StableSnapshotPtr & stable_snap) const;
+    /// The row key of the `split_row_index`-th row in the stable. Returns nothing if it is not inside this segment, or at the start of it.
+    std::optional<RowKeyValue> getStableRowKeyAt(
+        DMContext & dm_context,
+        const StableSnapshotPtr & stable_snap,
+        size_t split_row_index) const;
+    /// The number of threads to rewrite this segment, `dt_segment_rewrite_concurrency` or 1 if it is not worth it.
+    size_t getRewriteConcurrency(const DMContext & dm_context, const SegmentSnapshotPtr & segment_snap) const;
+    /// Split the range of this segment into `getRewriteConcurrency` sub ranges, for rewriting them concurrently.
+    RowKeyRanges getRewriteSubRanges(DMContext & dm_context, const SegmentSnapshotPtr & segment_snap) const;
 
     std::optional<SplitInfo> prepareSplitLogical(
         DMContext & dm_context,
@@ -410,9 +480,21 @@ private:
 
     std::atomic<DB::Timestamp> last_check_gc_safe_point = 0;
 
+    std::atomic<UInt64> read_times = 0;
+    std::atomic<UInt64> read_delta_prepare_ns = 0;
+    std::atomic<UInt64> written_rows = 0;
+    const Stopwatch age_watch{CLOCK_MONOTONIC_COARSE};
+
     const DeltaValueSpacePtr delta;
     const StableValueSpacePtr stable;
 
+    /// The snapshot for read shared by the concurrent reads, with the version of the delta when it is created.
+    /// It is weakly referenced, so that the PageStorage snapshot is released once all the reads sharing it are done.
+    mutable std::mutex shared_read_snap_mutex;
+    mutable std::weak_ptr<SegmentSnapshot> shared_read_snap;
+    mutable UInt64 shared_read_snap_version = 0;
+    mutable CurrentMetrics::Metric shared_read_snap_metric = 0;
+
     bool split_forbidden = false;
 
     Poco::Logger * log;
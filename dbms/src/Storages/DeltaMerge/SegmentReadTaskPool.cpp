@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Common/CurrentMetrics.h>
+#include <Common/TiFlashMetrics.h>
 #include <Storages/DeltaMerge/Segment.h>
 #include <Storages/DeltaMerge/SegmentReadTaskPool.h>
 
@@ -98,6 +99,7 @@ SegmentReadTasks SegmentReadTask::trySplitReadTasks(const SegmentReadTasks & tas
 BlockInputStreamPtr SegmentReadTaskPool::buildInputStream(SegmentReadTaskPtr & t)
 {
     MemoryTrackerSetter setter(true, mem_tracker);
+    ReadStageProfile::Scope profile_scope(dm_context->read_stage_profile.get());
     auto seg = t->segment;
     BlockInputStreamPtr stream;
     if (is_raw)
@@ -120,7 +122,12 @@ void SegmentReadTaskPool::finishSegment(const SegmentPtr & seg)
     {
         std::lock_guard lock(mutex);
         active_segment_ids.erase(seg->segmentId());
-        pool_finished = active_segment_ids.empty() && tasks.empty();
+        if (auto itr = active_segment_rows_by_id.find(seg->segmentId()); itr != active_segment_rows_by_id.end())
+        {
+            active_segment_rows -= itr->second;
+            active_segment_rows_by_id.erase(itr);
+        }
+        pool_finished = active_segment_ids.empty() && (tasks.empty() || limitReached());
     }
     LOG_FMT_DEBUG(log, "finishSegment pool {} seg_id {} pool_finished {}", pool_id, seg->segmentId(), pool_finished);
     if (pool_finished)
@@ -141,12 +148,21 @@ SegmentReadTaskPtr SegmentReadTaskPool::getTask(uint64_t seg_id)
     auto t = *(itr);
     tasks.erase(itr);
     active_segment_ids.insert(seg_id);
+    if (limit > 0)
+    {
+        auto rows = t->getRowsAndBytes().first;
+        active_segment_rows += rows;
+        active_segment_rows_by_id[seg_id] = rows;
+    }
     return t;
 }
 
 // Choose a segment to read.
 // Returns <segment_id, pool_ids>.
-std::unordered_map<uint64_t, std::vector<uint64_t>>::const_iterator SegmentReadTaskPool::scheduleSegment(const std::unordered_map<uint64_t, std::vector<uint64_t>> & segments, uint64_t expected_merge_count)
+std::unordered_map<uint64_t, std::vector<uint64_t>>::const_iterator SegmentReadTaskPool::scheduleSegment(
+    const std::unordered_map<uint64_t, std::vector<uint64_t>> & segments,
+    uint64_t expected_merge_count,
+    const std::unordered_set<uint64_t> & reading_segments)
 {
     auto target = segments.end();
     std::lock_guard lock(mutex);
@@ -154,6 +170,23 @@ std::unordered_map<uint64_t, std::vector<uint64_t>>::const_iterator SegmentReadT
     {
         return target;
     }
+    if (enable_cooperative_scan && !reading_segments.empty())
+    {
+        // Prefer the segments being read by other pools, so that we can join their scans and share the packs they read.
+        for (const auto & task : tasks)
+        {
+            auto seg_id = task->segment->segmentId();
+            if (reading_segments.count(seg_id) > 0)
+            {
+                auto itr = segments.find(seg_id);
+                if (itr != segments.end())
+                {
+                    GET_METRIC(tiflash_storage_read_thread_counter, type_sche_join_scan).Increment();
+                    return itr;
+                }
+            }
+        }
+    }
     for (const auto & task : tasks)
     {
         auto itr = segments.find(task->segment->segmentId());
@@ -180,17 +213,20 @@ std::unordered_map<uint64_t, std::vector<uint64_t>>::const_iterator SegmentReadT
 bool SegmentReadTaskPool::readOneBlock(BlockInputStreamPtr & stream, const SegmentPtr & seg)
 {
     MemoryTrackerSetter setter(true, mem_tracker);
-    auto block = stream->read();
+    ReadStageProfile::Scope profile_scope(dm_context->read_stage_profile.get());
+    // The segment may be scheduled with other pools by cooperative scan after the limit of this pool is reached.
+    auto block = limitReached() ? Block{} : stream->read();
     if (block)
     {
+        addReadRows(block.rows());
         pushBlock(std::move(block));
-        return true;
-    }
-    else
-    {
-        finishSegment(seg);
-        return false;
+        if (!limitReached())
+            return true;
+        // Enough rows are read, stop reading the rest of this segment.
+        LOG_FMT_DEBUG(log, "readOneBlock pool {} seg_id {} limit {} reached", pool_id, seg->segmentId(), limit);
     }
+    finishSegment(seg);
+    return false;
 }
 
 void SegmentReadTaskPool::popBlock(Block & block)
@@ -239,6 +275,16 @@ int64_t SegmentReadTaskPool::getFreeActiveSegmentCountUnlock()
     {
         active_segment_limit = 2;
     }
+    if (limit > 0)
+    {
+        auto rows = read_rows.load(std::memory_order_relaxed);
+        if (rows >= limit)
+            return 0;
+        // Only schedule one more segment if the active segments may not have enough rows for the limit,
+        // so that a small limit does not read many segments at once.
+        if (!active_segment_ids.empty() && active_segment_rows >= limit - rows)
+            return 0;
+    }
     return active_segment_limit - static_cast<int64_t>(active_segment_ids.size());
 }
 
@@ -14,6 +14,7 @@
 
 #pragma once
 #include <Common/MemoryTrackerSetter.h>
+#include <Common/TiFlashMetrics.h>
 #include <Storages/DeltaMerge/DMContext.h>
 #include <Storages/DeltaMerge/Filter/RSOperator.h>
 #include <Storages/DeltaMerge/ReadThread/WorkQueue.h>
@@ -124,7 +125,8 @@ public:
         bool is_raw_,
         bool do_range_filter_for_raw_,
         SegmentReadTasks && tasks_,
-        AfterSegmentRead after_segment_read_)
+        AfterSegmentRead after_segment_read_,
+        size_t limit_ = 0)
         : pool_id(nextPoolId())
         , table_id(table_id_)
         , dm_context(dm_context_)
@@ -134,8 +136,12 @@ public:
         , expected_block_size(expected_block_size_)
         , is_raw(is_raw_)
         , do_range_filter_for_raw(do_range_filter_for_raw_)
+        , enable_cooperative_scan(is_raw_ && dm_context_->db_context.getSettingsRef().dt_enable_cooperative_scan)
+        , scheduling_class(schedulingClassOf(dm_context_->db_context.getSettingsRef()))
+        , scheduling_weight(schedulingWeightOf(dm_context_->db_context.getSettingsRef()))
         , tasks(std::move(tasks_))
         , after_segment_read(after_segment_read_)
+        , limit(limit_)
         , log(&Poco::Logger::get("SegmentReadTaskPool"))
         , unordered_input_stream_ref_count(0)
         , exception_happened(false)
@@ -150,9 +156,12 @@ public:
         auto total_bytes = blk_stat.totalBytes();
         auto blk_avg_bytes = total_count > 0 ? total_bytes / total_count : 0;
         auto approximate_max_pending_block_bytes = blk_avg_bytes * max_queue_size;
-        LOG_FMT_DEBUG(log, "pool {} table {} pop {} pop_empty {} pop_empty_ratio {} max_queue_size {} blk_avg_bytes {} approximate_max_pending_block_bytes {} MB total_count {} total_bytes {} MB", //
+        auto read_thread_seconds = read_thread_ns.load(std::memory_order_relaxed) / 1'000'000'000.0;
+        GET_METRIC(tiflash_storage_read_thread_seconds, type_pool).Observe(read_thread_seconds);
+        LOG_FMT_DEBUG(log, "pool {} table {} read_thread_seconds {:.3f} pop {} pop_empty {} pop_empty_ratio {} max_queue_size {} blk_avg_bytes {} approximate_max_pending_block_bytes {} MB total_count {} total_bytes {} MB", //
                       pool_id,
                       table_id,
+                      read_thread_seconds,
                       pop_times,
                       pop_empty_times,
                       pop_empty_ratio,
@@ -166,7 +175,7 @@ public:
     SegmentReadTaskPtr nextTask()
     {
         std::lock_guard lock(mutex);
-        if (tasks.empty())
+        if (tasks.empty() || limitReached())
             return {};
         auto task = tasks.front();
         tasks.pop_front();
@@ -179,23 +188,63 @@ public:
 
     const SegmentReadTasks & getTasks() const { return tasks; }
 
+    size_t getExpectedBlockSize() const { return expected_block_size; }
+
+    const ReadStageProfilePtr & getReadStageProfile() const { return dm_context->read_stage_profile; }
+
     BlockInputStreamPtr buildInputStream(SegmentReadTaskPtr & t);
 
     bool readOneBlock(BlockInputStreamPtr & stream, const SegmentPtr & seg);
     void popBlock(Block & block);
 
+    // `reading_segments` are the segments of this table being read by other pools now.
     std::unordered_map<uint64_t, std::vector<uint64_t>>::const_iterator scheduleSegment(
         const std::unordered_map<uint64_t, std::vector<uint64_t>> & segments,
-        uint64_t expected_merge_count);
+        uint64_t expected_merge_count,
+        const std::unordered_set<uint64_t> & reading_segments);
+
+    bool enableCooperativeScan() const { return enable_cooperative_scan; }
+
+    // The pools of the queries with the same `io_scheduling_group` and `priority` are in the same scheduling class,
+    // the read threads are shared by the classes by their weights, see `SegmentReadTaskScheduler`.
+    const String & schedulingClass() const { return scheduling_class; }
+    UInt64 schedulingWeight() const { return scheduling_weight; }
+    // The time spent by the read threads on reading the blocks of this pool.
+    void addReadThreadTime(UInt64 ns) { read_thread_ns.fetch_add(ns, std::memory_order_relaxed); }
+    UInt64 getReadThreadTime() const { return read_thread_ns.load(std::memory_order_relaxed); }
+    // The number of segments not finished yet.
+    size_t getRemainingTaskCount()
+    {
+        std::lock_guard lock(mutex);
+        return tasks.size() + active_segment_ids.size();
+    }
 
     int64_t increaseUnorderedInputStreamRefCount();
     int64_t decreaseUnorderedInputStreamRefCount();
     int64_t getFreeBlockSlots() const;
     bool valid() const;
+
+    // Called by the streams reading segments by themselves, see `DMSegmentThreadInputStream`.
+    void addReadRows(size_t rows) { read_rows.fetch_add(rows, std::memory_order_relaxed); }
+    // No more segments need to be read if `limit` rows have been read.
+    bool limitReached() const { return limit > 0 && read_rows.load(std::memory_order_relaxed) >= limit; }
     void setException(const DB::Exception & e);
     SegmentReadTaskPtr getTask(uint64_t seg_id);
 
 private:
+    static String schedulingClassOf(const Settings & settings)
+    {
+        return fmt::format("{}#{}", settings.io_scheduling_group.toString(), settings.priority);
+    }
+    // The same as the weight of I/O class, see `getIOClass`.
+    static UInt64 schedulingWeightOf(const Settings & settings)
+    {
+        UInt64 weight = settings.io_scheduling_weight;
+        if (settings.priority > 0)
+            weight /= settings.priority;
+        return std::max<UInt64>(weight, 1);
+    }
+
     int64_t getFreeActiveSegmentCountUnlock();
     bool exceptionHappened() const;
     void finishSegment(const SegmentPtr & seg);
@@ -210,10 +259,20 @@ private:
     const size_t expected_block_size;
     const bool is_raw;
     const bool do_range_filter_for_raw;
+    const bool enable_cooperative_scan;
+    const String scheduling_class;
+    const UInt64 scheduling_weight;
+    std::atomic<UInt64> read_thread_ns{0};
     SegmentReadTasks tasks;
     AfterSegmentRead after_segment_read;
+    // The number of rows required by the caller without any order, 0 means no limit.
+    const size_t limit;
+    std::atomic<size_t> read_rows{0};
     std::mutex mutex;
     std::unordered_set<uint64_t> active_segment_ids;
+    // The approximate rows of the active segments, used to schedule the segments gradually if `limit` is set.
+    size_t active_segment_rows = 0;
+    std::unordered_map<uint64_t, size_t> active_segment_rows_by_id;
     WorkQueue<Block> q;
     BlockStat blk_stat;
     Poco::Logger * log;
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <Storages/DeltaMerge/DMContext.h>
+#include <Encryption/ReadBufferFromFileProvider.h>
+#include <Encryption/createReadBufferFromFileBaseByFileProvider.h>
 #include <Storages/DeltaMerge/DMVersionFilterBlockInputStream.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
 #include <Storages/DeltaMerge/File/DMFileBlockInputStream.h>
@@ -54,6 +56,7 @@ void StableValueSpace::setFiles(const DMFiles & files_, const RowKeyRange & rang
             auto pack_filter = DMFilePackFilter::loadFrom(
                 file,
                 index_cache,
+                /*bloom_filter_cache*/ nullptr,
                 /*set_cache_if_miss*/ true,
                 {range},
                 EMPTY_FILTER,
@@ -138,6 +141,71 @@ size_t StableValueSpace::getBytesOnDisk() const
     return bytes;
 }
 
+namespace
+{
+NDVSketchPtr loadNDVSketch(const DMFilePtr & dmfile, const FileProviderPtr & file_provider, ColId col_id, const ReadLimiterPtr & read_limiter)
+{
+    const auto file_name_base = DMFile::getFileNameBase(col_id);
+    auto file_size = dmfile->colNDVSketchSize(file_name_base);
+    if (!dmfile->getConfiguration())
+    {
+        auto buf = ReadBufferFromFileProvider(
+            file_provider,
+            dmfile->colNDVSketchPath(file_name_base),
+            dmfile->encryptionNDVSketchPath(file_name_base),
+            std::min(static_cast<size_t>(DBMS_DEFAULT_BUFFER_SIZE), file_size),
+            read_limiter);
+        buf.seek(dmfile->colNDVSketchOffset(file_name_base));
+        return NDVSketch::read(buf);
+    }
+    else
+    {
+        auto buf = createReadBufferFromFileBaseByFileProvider(file_provider,
+                                                              dmfile->colNDVSketchPath(file_name_base),
+                                                              dmfile->encryptionNDVSketchPath(file_name_base),
+                                                              file_size,
+                                                              read_limiter,
+                                                              dmfile->getConfiguration()->getChecksumAlgorithm(),
+                                                              dmfile->getConfiguration()->getChecksumFrameLength());
+        buf->seek(dmfile->colNDVSketchOffset(file_name_base));
+        return NDVSketch::read(*buf);
+    }
+}
+} // namespace
+
+std::unordered_map<ColId, NDVSketch> StableValueSpace::getNDVSketches(const FileProviderPtr & file_provider, const ReadLimiterPtr & read_limiter) const
+{
+    std::unordered_map<ColId, NDVSketch> sketches;
+    std::unordered_set<ColId> incomplete_columns;
+    for (const auto & file : files)
+    {
+        if (file->getRows() == 0)
+            continue;
+        for (const auto & cd : file->getColumnDefines())
+        {
+            if (incomplete_columns.count(cd.id))
+                continue;
+            if (!file->isColNDVSketchExist(cd.id))
+            {
+                incomplete_columns.insert(cd.id);
+                sketches.erase(cd.id);
+                continue;
+            }
+            auto sketch = loadNDVSketch(file, file_provider, cd.id, read_limiter);
+            sketches[cd.id].merge(*sketch);
+        }
+    }
+    // The columns that are missing in some of the files, e.g. added by DDL after them.
+    for (auto it = sketches.begin(); it != sketches.end();)
+    {
+        bool in_all_files = std::all_of(files.begin(), files.end(), [&](const DMFilePtr & file) {
+            return file->getRows() == 0 || file->isColumnExist(it->first);
+        });
+        it = in_all_files ? std::next(it) : sketches.erase(it);
+    }
+    return sketches;
+}
+
 size_t StableValueSpace::getPacks() const
 {
     size_t packs = 0;
@@ -238,6 +306,7 @@ void StableValueSpace::calculateStableProperty(const DMContext & context, const
         auto pack_filter = DMFilePackFilter::loadFrom(
             file,
             context.db_context.getGlobalContext().getMinMaxIndexCache(),
+            /*bloom_filter_cache*/ nullptr,
             /*set_cache_if_miss*/ false,
             {rowkey_range},
             EMPTY_FILTER,
@@ -343,6 +412,12 @@ StableValueSpace::Snapshot::getInputStream(
             .setColumnCache(column_caches[i])
             .setTracingID(context.tracing_id)
             .setRowsThreshold(expected_block_size);
+        // Filtering rows in advance is only safe for clean read, the reader will check it for each block.
+        if (enable_clean_read)
+        {
+            builder.setLateMaterializationFilter(context.late_materialization_filter);
+            builder.setReadRowsOnly(context.read_rows_only);
+        }
         streams.push_back(builder.build(stable->files[i], read_columns, rowkey_ranges));
     }
     return std::make_shared<ConcatSkippableBlockInputStream>(streams);
@@ -365,6 +440,7 @@ RowsAndBytes StableValueSpace::Snapshot::getApproxRowsAndBytes(const DMContext &
         auto filter = DMFilePackFilter::loadFrom(
             f,
             context.db_context.getGlobalContext().getMinMaxIndexCache(),
+            /*bloom_filter_cache*/ nullptr,
             /*set_cache_if_miss*/ false,
             {range},
             RSOperatorPtr{},
@@ -16,6 +16,7 @@
 
 #include <Storages/DeltaMerge/File/ColumnCache.h>
 #include <Storages/DeltaMerge/File/DMFile.h>
+#include <Storages/DeltaMerge/Index/NDVSketch.h>
 #include <Storages/DeltaMerge/RowKeyRange.h>
 #include <Storages/DeltaMerge/SkippableBlockInputStream.h>
 #include <Storages/Page/Page.h>
@@ -57,6 +58,10 @@ public:
     size_t getBytesOnDisk() const;
     size_t getPacks() const;
 
+    // Merge the `NDVSketch`s of the columns in all the DMFiles. A column is left out if some file with rows has no
+    // sketch for it. Like `getBytesOnDisk`, the whole files are counted if this value space is logical split.
+    std::unordered_map<ColId, NDVSketch> getNDVSketches(const FileProviderPtr & file_provider, const ReadLimiterPtr & read_limiter) const;
+
     void enableDMFilesGC();
 
     static StableValueSpacePtr restore(DMContext & context, PageId id);
@@ -14,6 +14,7 @@
 
 #include <Common/CurrentMetrics.h>
 #include <Common/FailPoint.h>
+#include <Common/TiFlashMetrics.h>
 #include <Interpreters/Context.h>
 #include <Interpreters/Settings.h>
 #include <Storages/DeltaMerge/StoragePool.h>
@@ -313,7 +314,9 @@ void StoragePool::forceTransformMetaV2toV3()
     }
 
     // Will rewrite into V3.
-    meta_transform_storage_writer->write(std::move(write_batch_transform), nullptr);
+    const auto transform_bytes = write_batch_transform.getTotalDataSize();
+    meta_transform_storage_writer->write(std::move(write_batch_transform), global_context.getWriteLimiter());
+    GET_METRIC(tiflash_storage_page_transform_bytes, type_meta).Increment(transform_bytes);
 
     // DEL must call after rewrite.
     meta_transform_storage_writer->writeIntoV2(std::move(write_batch_del_v2), nullptr);
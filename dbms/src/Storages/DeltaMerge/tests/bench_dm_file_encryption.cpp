@@ -0,0 +1,163 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Encryption/FileProvider.h>
+#include <Encryption/MockKeyManager.h>
+#include <Storages/DeltaMerge/File/DMFile.h>
+#include <Storages/DeltaMerge/File/DMFileReader.h>
+#include <Storages/DeltaMerge/File/DMFileWriter.h>
+#include <Storages/DeltaMerge/tests/DMTestEnv.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestEnv.h>
+#include <benchmark/benchmark.h>
+
+#include <Poco/File.h>
+
+/// Compare the scan throughput of the DMFiles written with and without encryption at rest.
+
+namespace DB
+{
+namespace DM
+{
+namespace tests
+{
+namespace
+{
+constexpr Int64 rows_per_block = DEFAULT_MERGE_BLOCK_SIZE;
+constexpr Int64 num_blocks = 128;
+
+const ColumnDefine i64_cd(100, "i64", typeFromString("Int64"));
+const ColumnDefine str_cd(101, "str", typeFromString("String"));
+
+FileProviderPtr createFileProvider(bool encrypted)
+{
+    if (!encrypted)
+        return std::make_shared<FileProvider>(std::make_shared<MockKeyManager>(false), false);
+    return std::make_shared<FileProvider>(std::make_shared<MockKeyManager>(true), true);
+}
+
+DMFilePtr prepareDMFile(const String & parent_path, UInt64 file_id, const FileProviderPtr & file_provider)
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    cols->emplace_back(i64_cd);
+    cols->emplace_back(str_cd);
+
+    auto dm_file = DMFile::create(file_id, parent_path);
+    const auto & settings = DB::tests::TiFlashTestEnv::getGlobalContext().getSettingsRef();
+    DMFileWriter::Options options{
+        CompressionSettings(settings.dt_compression_method, settings.dt_compression_level),
+        settings.min_compress_block_size,
+        settings.max_compress_block_size,
+        DMFileWriter::Flags()};
+    DMFileWriter writer(dm_file, *cols, file_provider, nullptr, options);
+    DMFileWriter::BlockProperty block_property{};
+    for (Int64 i = 0; i < num_blocks; ++i)
+    {
+        const Int64 beg = i * rows_per_block;
+        const Int64 end = beg + rows_per_block;
+        Block block = DMTestEnv::prepareSimpleWriteBlock(beg, end, false);
+        std::vector<Int64> ints;
+        Strings strs;
+        for (Int64 v = beg; v < end; ++v)
+        {
+            ints.push_back(v);
+            strs.emplace_back(fmt::format("value_{}", v));
+        }
+        block.insert(DB::tests::createColumn<Int64>(ints, i64_cd.name, i64_cd.id));
+        block.insert(DB::tests::createColumn<String>(strs, str_cd.name, str_cd.id));
+        writer.write(block, block_property);
+    }
+    writer.finalize();
+    return dm_file;
+}
+
+size_t scanDMFile(const DMFilePtr & dm_file, const FileProviderPtr & file_provider)
+{
+    const auto & settings = DB::tests::TiFlashTestEnv::getGlobalContext().getSettingsRef();
+    auto pack_filter = DMFilePackFilter::loadFrom(
+        dm_file,
+        /*index_cache*/ nullptr,
+        /*bloom_filter_cache*/ nullptr,
+        false,
+        RowKeyRanges{RowKeyRange::newAll(false, 1)},
+        EMPTY_FILTER,
+        {},
+        file_provider,
+        nullptr,
+        "");
+    DMFileReader reader(
+        dm_file,
+        ColumnDefines{i64_cd, str_cd},
+        /*is_common_handle*/ false,
+        /*enable_clean_read*/ false,
+        /*is_fast_mode*/ false,
+        std::numeric_limits<UInt64>::max(),
+        std::move(pack_filter),
+        nullptr,
+        /*mark_cache*/ nullptr,
+        /*enable_column_cache*/ false,
+        nullptr,
+        settings.min_bytes_to_use_direct_io,
+        settings.max_read_buffer_size,
+        file_provider,
+        nullptr,
+        DMFILE_READ_ROWS_THRESHOLD,
+        /*read_one_pack_every_time*/ false,
+        "",
+        /*enable_col_sharing_cache*/ false);
+    size_t rows = 0;
+    while (Block block = reader.read())
+        rows += block.rows();
+    return rows;
+}
+
+void runScan(benchmark::State & state, bool encrypted)
+{
+    const String parent_path = DB::tests::TiFlashTestEnv::getTemporaryPath("bench_dm_file_encryption");
+    Poco::File(parent_path).createDirectories();
+    auto file_provider = createFileProvider(encrypted);
+    auto dm_file = prepareDMFile(parent_path, encrypted ? 2 : 1, file_provider);
+
+    // The whole file is read on each iteration, decryption covers data, marks and indexes.
+    const size_t bytes = dm_file->getBytesOnDisk();
+
+    for (auto _ : state)
+    {
+        size_t rows = scanDMFile(dm_file, file_provider);
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(state.iterations() * num_blocks * rows_per_block);
+    state.SetBytesProcessed(state.iterations() * bytes);
+
+    dm_file->enableGC();
+    dm_file->remove(file_provider);
+}
+} // namespace
+
+static void ScanPlainDMFile(benchmark::State & state)
+{
+    runScan(state, false);
+}
+BENCHMARK(ScanPlainDMFile);
+
+static void ScanEncryptedDMFile(benchmark::State & state)
+{
+    runScan(state, true);
+}
+BENCHMARK(ScanEncryptedDMFile);
+
+} // namespace tests
+} // namespace DM
+} // namespace DB
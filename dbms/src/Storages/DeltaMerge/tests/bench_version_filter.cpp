@@ -0,0 +1,98 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <DataStreams/BlocksListBlockInputStream.h>
+#include <Storages/DeltaMerge/DMVersionFilterBlockInputStream.h>
+#include <Storages/DeltaMerge/tests/DMTestEnv.h>
+#include <benchmark/benchmark.h>
+
+namespace DB
+{
+namespace DM
+{
+namespace tests
+{
+namespace
+{
+constexpr size_t rows_per_block = DEFAULT_MERGE_BLOCK_SIZE;
+constexpr size_t num_blocks = 64;
+
+BlocksList prepareBlocks(bool is_common_handle)
+{
+    BlocksList blocks;
+    for (size_t i = 0; i < num_blocks; ++i)
+    {
+        blocks.push_back(DMTestEnv::prepareSimpleWriteBlock(
+            i * rows_per_block,
+            (i + 1) * rows_per_block,
+            false,
+            /*tso*/ 2,
+            DMTestEnv::pk_name,
+            EXTRA_HANDLE_COLUMN_ID,
+            is_common_handle ? EXTRA_HANDLE_COLUMN_STRING_TYPE : EXTRA_HANDLE_COLUMN_INT_TYPE,
+            is_common_handle));
+    }
+    return blocks;
+}
+
+template <int MODE>
+void runVersionFilter(benchmark::State & state, bool is_common_handle)
+{
+    const auto blocks = prepareBlocks(is_common_handle);
+    auto columns = DMTestEnv::getDefaultColumns(is_common_handle ? DMTestEnv::PkType::CommonHandle : DMTestEnv::PkType::HiddenTiDBRowID);
+    for (auto _ : state)
+    {
+        auto stream = std::make_shared<DMVersionFilterBlockInputStream<MODE>>(
+            std::make_shared<BlocksListBlockInputStream>(BlocksList(blocks)),
+            *columns,
+            /*version_limit*/ 10,
+            is_common_handle);
+        size_t rows = 0;
+        stream->readPrefix();
+        while (Block block = stream->read())
+            rows += block.rows();
+        stream->readSuffix();
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(state.iterations() * num_blocks * rows_per_block);
+}
+} // namespace
+
+static void MVCCIntHandle(benchmark::State & state)
+{
+    runVersionFilter<DM_VERSION_FILTER_MODE_MVCC>(state, false);
+}
+BENCHMARK(MVCCIntHandle);
+
+static void MVCCCommonHandle(benchmark::State & state)
+{
+    runVersionFilter<DM_VERSION_FILTER_MODE_MVCC>(state, true);
+}
+BENCHMARK(MVCCCommonHandle);
+
+static void CompactIntHandle(benchmark::State & state)
+{
+    runVersionFilter<DM_VERSION_FILTER_MODE_COMPACT>(state, false);
+}
+BENCHMARK(CompactIntHandle);
+
+static void CompactCommonHandle(benchmark::State & state)
+{
+    runVersionFilter<DM_VERSION_FILTER_MODE_COMPACT>(state, true);
+}
+BENCHMARK(CompactCommonHandle);
+
+} // namespace tests
+} // namespace DM
+} // namespace DB
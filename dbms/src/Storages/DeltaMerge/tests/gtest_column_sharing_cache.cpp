@@ -37,63 +37,118 @@ ColumnPtr createColumn(int packs)
     return std::move(mut_col);
 }
 
-void compareColumn(ColumnPtr & col1, ColumnPtr & col2, int rows)
+void compareColumn(const ColumnPtr & col1, const ColumnPtr & col2, int rows, int offset2 = 0)
 {
     for (int i = 0; i < rows; i++)
     {
-        ASSERT_EQ((*col1)[i].toString(), (*col2)[i].toString());
+        ASSERT_EQ((*col1)[i].toString(), (*col2)[offset2 + i].toString());
     }
 }
 
+DMFile::PackStats createPackStats(int packs)
+{
+    DMFile::PackStats pack_stats(packs);
+    for (auto & stat : pack_stats)
+    {
+        stat.rows = TEST_PACK_ROWS;
+    }
+    return pack_stats;
+}
+
 TEST(ColumnSharingCacheTest, AddAndGet)
 {
     ColumnSharingCache cache;
+    auto pack_stats = createPackStats(32);
 
     auto col = createColumn(8);
     cache.add(1, 8, col);
 
-    ColumnPtr col1;
-    auto st = cache.get(1, 8, 8 * TEST_PACK_ROWS, col1, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_HIT);
-    ASSERT_EQ(col1->size(), 8 * TEST_PACK_ROWS);
-    compareColumn(col1, col, col1->size());
+    auto res1 = cache.get(1, 8, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res1.status, ColumnCacheStatus::GET_HIT);
+    ASSERT_EQ(res1.prefix->size(), 8 * TEST_PACK_ROWS);
+    compareColumn(res1.prefix, col, res1.prefix->size());
 
-    ColumnPtr col2;
-    st = cache.get(1, 7, 7 * TEST_PACK_ROWS, col2, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_COPY);
-    ASSERT_EQ(col2->size(), 7 * TEST_PACK_ROWS);
-    compareColumn(col2, col, col2->size());
+    auto res2 = cache.get(1, 7, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res2.status, ColumnCacheStatus::GET_COPY);
+    ASSERT_EQ(res2.prefix->size(), 7 * TEST_PACK_ROWS);
+    compareColumn(res2.prefix, col, res2.prefix->size());
 
-    ColumnPtr col3;
-    st = cache.get(1, 9, 9 * TEST_PACK_ROWS, col3, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_PART);
-    ASSERT_EQ(col3, nullptr);
+    auto res3 = cache.get(1, 9, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res3.status, ColumnCacheStatus::GET_PART);
+    ASSERT_EQ(res3.prefix_packs, 8);
+    ASSERT_EQ(res3.prefix->size(), 8 * TEST_PACK_ROWS);
+    ASSERT_EQ(res3.suffix, nullptr);
+    ASSERT_EQ(res3.suffix_packs, 0);
 
-    ColumnPtr col4;
-    st = cache.get(2, 8, 8 * TEST_PACK_ROWS, col4, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_MISS);
-    ASSERT_EQ(col4, nullptr);
+    auto res4 = cache.get(9, 8, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res4.status, ColumnCacheStatus::GET_MISS);
+    ASSERT_EQ(res4.prefix, nullptr);
+    ASSERT_EQ(res4.suffix, nullptr);
 
     auto col5 = createColumn(7);
     cache.add(1, 7, col5);
-    ColumnPtr col6;
-    st = cache.get(1, 8, 8 * TEST_PACK_ROWS, col6, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_HIT);
-    ASSERT_EQ(col6->size(), 8 * TEST_PACK_ROWS);
-    compareColumn(col6, col, col6->size());
+    auto res6 = cache.get(1, 8, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res6.status, ColumnCacheStatus::GET_HIT);
+    ASSERT_EQ(res6.prefix->size(), 8 * TEST_PACK_ROWS);
+    compareColumn(res6.prefix, col, res6.prefix->size());
 
     auto col7 = createColumn(9);
     cache.add(1, 9, col7);
-    ColumnPtr col8;
-    st = cache.get(1, 8, 8 * TEST_PACK_ROWS, col8, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_COPY);
-    ASSERT_EQ(col8->size(), 8 * TEST_PACK_ROWS);
-    compareColumn(col8, col7, col8->size());
+    auto res8 = cache.get(1, 8, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res8.status, ColumnCacheStatus::GET_COPY);
+    ASSERT_EQ(res8.prefix->size(), 8 * TEST_PACK_ROWS);
+    compareColumn(res8.prefix, col7, res8.prefix->size());
+}
+
+TEST(ColumnSharingCacheTest, GetOverlap)
+{
+    ColumnSharingCache cache;
+    auto pack_stats = createPackStats(32);
+
+    // Cached packs: [4, 8), [8, 12), [20, 24)
+    auto col1 = createColumn(4);
+    cache.add(4, 4, col1);
+    auto col2 = createColumn(4);
+    cache.add(8, 4, col2);
+    auto col3 = createColumn(4);
+    cache.add(20, 4, col3);
+
+    // In the middle of a cached range.
+    auto res1 = cache.get(5, 2, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res1.status, ColumnCacheStatus::GET_COPY);
+    ASSERT_EQ(res1.prefix->size(), 2 * TEST_PACK_ROWS);
+    compareColumn(res1.prefix, col1, res1.prefix->size(), TEST_PACK_ROWS);
+
+    // Across the adjacent cached ranges.
+    auto res2 = cache.get(6, 4, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res2.status, ColumnCacheStatus::GET_COPY);
+    ASSERT_EQ(res2.prefix->size(), 4 * TEST_PACK_ROWS);
+    compareColumn(res2.prefix, col1, 2 * TEST_PACK_ROWS, 2 * TEST_PACK_ROWS);
+    ColumnPtr res2_tail = res2.prefix->cut(2 * TEST_PACK_ROWS, 2 * TEST_PACK_ROWS);
+    compareColumn(res2_tail, col2, 2 * TEST_PACK_ROWS);
+
+    // The prefix [10, 12) and the suffix [20, 22) are cached, [12, 20) is not.
+    auto res3 = cache.get(10, 12, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res3.status, ColumnCacheStatus::GET_PART);
+    ASSERT_EQ(res3.prefix_packs, 2);
+    compareColumn(res3.prefix, col2, 2 * TEST_PACK_ROWS, 2 * TEST_PACK_ROWS);
+    ASSERT_EQ(res3.suffix_packs, 2);
+    ASSERT_EQ(res3.suffix->size(), 2 * TEST_PACK_ROWS);
+    compareColumn(res3.suffix, col3, 2 * TEST_PACK_ROWS);
+
+    // Only the suffix is cached.
+    auto res4 = cache.get(2, 4, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res4.status, ColumnCacheStatus::GET_PART);
+    ASSERT_EQ(res4.prefix, nullptr);
+    ASSERT_EQ(res4.prefix_packs, 0);
+    ASSERT_EQ(res4.suffix_packs, 2);
+    compareColumn(res4.suffix, col1, 2 * TEST_PACK_ROWS);
 }
 
 TEST(ColumnSharingCacheTest, Del)
 {
     ColumnSharingCache cache;
+    auto pack_stats = createPackStats(32);
 
     auto col1 = createColumn(8);
     cache.add(1, 8, col1);
@@ -106,17 +161,18 @@ TEST(ColumnSharingCacheTest, Del)
 
     cache.del(10);
 
-    ColumnPtr col4;
-    auto st = cache.get(9, 8, 8 * TEST_PACK_ROWS, col4, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_HIT);
-    ASSERT_EQ(col4->size(), 8 * TEST_PACK_ROWS);
-    compareColumn(col4, col2, col4->size());
-
-    ColumnPtr col5;
-    st = cache.get(17, 6, 6 * TEST_PACK_ROWS, col5, TEST_DATA_TYPE);
-    ASSERT_EQ(st, ColumnCacheStatus::GET_COPY);
-    ASSERT_EQ(col5->size(), 6 * TEST_PACK_ROWS);
-    compareColumn(col5, col2, col5->size());
+    auto res4 = cache.get(9, 8, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res4.status, ColumnCacheStatus::GET_HIT);
+    ASSERT_EQ(res4.prefix->size(), 8 * TEST_PACK_ROWS);
+    compareColumn(res4.prefix, col2, res4.prefix->size());
+
+    auto res5 = cache.get(17, 6, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res5.status, ColumnCacheStatus::GET_COPY);
+    ASSERT_EQ(res5.prefix->size(), 6 * TEST_PACK_ROWS);
+    compareColumn(res5.prefix, col2, res5.prefix->size());
+
+    auto res6 = cache.get(1, 8, pack_stats, TEST_DATA_TYPE);
+    ASSERT_EQ(res6.status, ColumnCacheStatus::GET_MISS);
 }
 
-} // namespace DB::DM::tests
\ No newline at end of file
+} // namespace DB::DM::tests
@@ -103,6 +103,32 @@ TEST(PKSquash_test, WithExtraSort)
     }
 }
 
+TEST(PKSquash_test, WithExtraSortUnorderedVersions)
+{
+    size_t rows_per_block = 10;
+    // The versions of pk == 4 are neither asc nor desc, which can not be sorted by reversing the versions.
+    Block block = DMTestEnv::prepareBlockWithTso(4, 10000 + rows_per_block, 10000 + rows_per_block * 2, true);
+    concat(block, DMTestEnv::prepareBlockWithTso(4, 10000, 10000 + rows_per_block, false));
+    concat(block, DMTestEnv::prepareBlockWithTso(5, 10000, 10000 + rows_per_block, true));
+    BlocksList blocks{block};
+
+    SortDescription sort //
+        = SortDescription{//
+                          SortColumnDescription{EXTRA_HANDLE_COLUMN_NAME, 1, 0},
+                          SortColumnDescription{VERSION_COLUMN_NAME, 1, 0}};
+
+    auto in = std::make_shared<PKSquashingBlockInputStream</*need_extra_sort*/ true>>(
+        std::make_shared<BlocksListBlockInputStream>(blocks.begin(), blocks.end()),
+        TiDBPkColumnID,
+        false);
+    in->readPrefix();
+    Block res = in->read();
+    ASSERT_EQ(res.rows(), rows_per_block * 3);
+    ASSERT_TRUE(isAlreadySorted(res, sort));
+    ASSERT_FALSE(in->read());
+    in->readSuffix();
+}
+
 } // namespace tests
 } // namespace DM
 } // namespace DB
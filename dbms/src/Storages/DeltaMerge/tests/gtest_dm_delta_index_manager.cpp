@@ -12,10 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/ProfileEvents.h>
 #include <Storages/DeltaMerge/DeltaIndexManager.h>
 #include <Storages/DeltaMerge/DeltaTree.h>
 #include <TestUtils/TiFlashTestBasic.h>
 
+namespace ProfileEvents
+{
+extern const Event DMDeltaIndexEvict;
+extern const Event DMDeltaIndexRebuild;
+} // namespace ProfileEvents
+
 namespace DB
 {
 namespace DM
@@ -93,6 +100,40 @@ try
 }
 CATCH
 
+TEST_F(DeltaIndexManager_test, CostAware)
+try
+{
+    DeltaIndexManager manager(one_node_size * 10);
+
+    auto delta_tree = std::make_shared<DefaultDeltaTree>();
+    delta_tree->addInsert(1, 0);
+    // The same size as the others, but placed some delete ranges.
+    auto costly = std::make_shared<DeltaIndex>(delta_tree, 1, 10);
+    manager.refreshRef(costly);
+
+    const auto evict_before = ProfileEvents::counters[ProfileEvents::DMDeltaIndexEvict].load();
+    std::vector<DeltaIndexPtr> indies;
+    for (int i = 0; i < 20; ++i)
+    {
+        indies.push_back(genDeltaIndex());
+        manager.refreshRef(indies.back());
+    }
+    ASSERT_EQ(ProfileEvents::counters[ProfileEvents::DMDeltaIndexEvict].load() - evict_before, 11);
+
+    // The least recently used one is kept because it is costly to rebuild.
+    ASSERT_EQ(manager.getRef(costly->getId()), costly);
+    ASSERT_EQ(manager.getRef(indies[0]->getId()), DeltaIndexPtr());
+    ASSERT_EQ(manager.getRef(indies[19]->getId()), indies[19]);
+
+    // Refreshing an evicted index means it is rebuilt.
+    const auto rebuild_before = ProfileEvents::counters[ProfileEvents::DMDeltaIndexRebuild].load();
+    manager.refreshRef(indies[0]);
+    ASSERT_EQ(ProfileEvents::counters[ProfileEvents::DMDeltaIndexRebuild].load() - rebuild_before, 1);
+    manager.refreshRef(indies[0]);
+    ASSERT_EQ(ProfileEvents::counters[ProfileEvents::DMDeltaIndexRebuild].load() - rebuild_before, 1);
+}
+CATCH
+
 } // namespace tests
 } // namespace DM
 } // namespace DB
@@ -14,6 +14,7 @@
 
 #include <Common/Exception.h>
 #include <Common/FailPoint.h>
+#include <Storages/DeltaMerge/Filter/PushDownTopN.h>
 #include <Storages/DeltaMerge/Filter/RSOperator.h>
 #include <Storages/DeltaMerge/PKSquashingBlockInputStream.h>
 #include <Storages/DeltaMerge/tests/gtest_dm_delta_merge_store_test_basic.h>
@@ -78,6 +79,199 @@ try
 }
 CATCH
 
+TEST_F(DeltaMergeStoreTest, SegmentHeat)
+try
+{
+    using Heat = DeltaMergeStore::SegmentHeat;
+    // Disabled
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(1000000, 1000, 100, 0), Heat::Normal);
+    // Too young to tell
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(1000000, 1000, 10, 1000), Heat::Normal);
+
+    // 1000 rows per second
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(100000, 0, 100, 1000), Heat::Hot);
+    // 500 rows per second, hot only if it is read frequently
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(50000, 10, 100, 1000), Heat::Normal);
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(50000, 200, 100, 1000), Heat::Hot);
+    // 50 rows per second, cold even if it is read frequently
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(5000, 0, 100, 1000), Heat::Cold);
+    ASSERT_EQ(DeltaMergeStore::getSegmentHeat(5000, 200, 100, 1000), Heat::Cold);
+}
+CATCH
+
+TEST_F(DeltaMergeStoreTest, AdaptiveBlockSize)
+try
+{
+    // Disabled or unknown size of rows
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(100, 0, DEFAULT_BLOCK_SIZE, 8192), DEFAULT_BLOCK_SIZE);
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(0, 1 << 20, DEFAULT_BLOCK_SIZE, 8192), DEFAULT_BLOCK_SIZE);
+
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(64, 4 << 20, DEFAULT_BLOCK_SIZE, 8192), 65536);
+    // Wide rows make smaller blocks, but not smaller than a pack
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(256, 4 << 20, DEFAULT_BLOCK_SIZE, 8192), 16384);
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(4096, 4 << 20, DEFAULT_BLOCK_SIZE, 8192), 8192);
+    // Narrow rows make larger blocks, but not larger than 4x of the default
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(32, 4 << 20, DEFAULT_BLOCK_SIZE, 8192), 131072);
+    ASSERT_EQ(DeltaMergeStore::getAdaptiveBlockSize(1, 4 << 20, DEFAULT_BLOCK_SIZE, 8192), 4 * DEFAULT_BLOCK_SIZE);
+}
+CATCH
+
+TEST_F(DeltaMergeStoreTest, WriteThrottled)
+try
+{
+    const auto all_range = RowKeyRange::newAll(store->isCommonHandle(), store->getRowKeyColumnSize());
+    store->write(*db_context, db_context->getSettingsRef(), DMTestEnv::prepareSimpleWriteBlock(0, 1000, false));
+    ASSERT_FALSE(store->isWriteThrottled(*db_context, all_range));
+
+    // The delta exceeds the force merge threshold, the writes would be stalled.
+    auto & settings = db_context->getSettingsRef();
+    const auto origin_force_merge_delta_rows = settings.dt_segment_force_merge_delta_rows.get();
+    settings.dt_segment_force_merge_delta_rows = 500;
+    ASSERT_TRUE(store->isWriteThrottled(*db_context, all_range));
+    settings.dt_segment_force_merge_delta_rows = origin_force_merge_delta_rows;
+    ASSERT_FALSE(store->isWriteThrottled(*db_context, all_range));
+}
+CATCH
+
+TEST_F(DeltaMergeStoreTest, ReadWithTopN)
+try
+{
+    const size_t num_rows_write = 1000;
+    store->write(*db_context, db_context->getSettingsRef(), DMTestEnv::prepareSimpleWriteBlock(0, num_rows_write, false));
+    // Make the stable packs of 100 rows
+    db_context->getSettingsRef().dt_segment_stable_pack_rows = 100;
+    store->mergeDeltaAll(*db_context);
+
+    // Return the rows read and the min max handles
+    auto read_with_top_n = [&](const PushDownTopNPtr & top_n) {
+        const auto & columns = store->getTableColumns();
+        auto in = store->read(*db_context,
+                              db_context->getSettingsRef(),
+                              columns,
+                              {RowKeyRange::newAll(store->isCommonHandle(), store->getRowKeyColumnSize())},
+                              /* num_streams= */ 1,
+                              /* max_version= */ std::numeric_limits<UInt64>::max(),
+                              EMPTY_FILTER,
+                              TRACING_NAME,
+                              /* keep_order= */ false,
+                              /* is_fast_mode= */ false,
+                              /* expected_block_size= */ 1024,
+                              /* read_segments= */ {},
+                              /* extra_table_id_index= */ InvalidColumnID,
+                              /* late_materialization_filter= */ nullptr,
+                              /* read_rows_only= */ false,
+                              top_n)[0];
+        size_t rows = 0;
+        Int64 min_handle = std::numeric_limits<Int64>::max();
+        Int64 max_handle = std::numeric_limits<Int64>::min();
+        in->readPrefix();
+        while (Block block = in->read())
+        {
+            rows += block.rows();
+            const auto & handles = block.getByName(DMTestEnv::pk_name).column;
+            for (size_t i = 0; i < handles->size(); ++i)
+            {
+                min_handle = std::min(min_handle, handles->getInt(i));
+                max_handle = std::max(max_handle, handles->getInt(i));
+            }
+        }
+        in->readSuffix();
+        return std::make_tuple(rows, min_handle, max_handle);
+    };
+    const auto handle_define = getExtraHandleColumnDefine(/*is_common_handle=*/false);
+
+    {
+        // Only the last pack is read for the largest 10 rows
+        auto [rows, min_handle, max_handle] = read_with_top_n(std::make_shared<PushDownTopN>(handle_define, /*is_desc*/ true, 10));
+        ASSERT_EQ(rows, 100UL);
+        ASSERT_EQ(min_handle, 900);
+        ASSERT_EQ(max_handle, 999);
+    }
+
+    {
+        // The smallest 150 rows are in the first two packs
+        auto [rows, min_handle, max_handle] = read_with_top_n(std::make_shared<PushDownTopN>(handle_define, /*is_desc*/ false, 150));
+        ASSERT_EQ(rows, 200UL);
+        ASSERT_EQ(min_handle, 0);
+        ASSERT_EQ(max_handle, 199);
+    }
+
+    {
+        // More rows than the table
+        auto [rows, min_handle, max_handle] = read_with_top_n(std::make_shared<PushDownTopN>(handle_define, /*is_desc*/ true, 2000));
+        ASSERT_EQ(rows, num_rows_write);
+    }
+
+    // The segment with delta is not counted, since the stable rows may be deleted by the delta
+    store->write(*db_context, db_context->getSettingsRef(), DMTestEnv::prepareSimpleWriteBlock(num_rows_write, num_rows_write + 10, false));
+    {
+        auto [rows, min_handle, max_handle] = read_with_top_n(std::make_shared<PushDownTopN>(handle_define, /*is_desc*/ true, 10));
+        ASSERT_EQ(rows, num_rows_write + 10);
+        ASSERT_EQ(min_handle, 0);
+        ASSERT_EQ(max_handle, static_cast<Int64>(num_rows_write + 9));
+    }
+}
+CATCH
+
+TEST_F(DeltaMergeStoreTest, ReadWithLimit)
+try
+{
+    const size_t num_rows_write = 1000;
+    store->write(*db_context, db_context->getSettingsRef(), DMTestEnv::prepareSimpleWriteBlock(0, num_rows_write, false));
+    store->mergeDeltaAll(*db_context);
+    // Split into 4 segments
+    for (size_t i = 0; i < 2; ++i)
+    {
+        auto dm_context = store->newDMContext(*db_context, db_context->getSettingsRef());
+        std::vector<SegmentPtr> segments;
+        for (const auto & [end, seg] : store->segments)
+            segments.push_back(seg);
+        for (const auto & seg : segments)
+            store->segmentSplit(*dm_context, seg, /*is_foreground*/ true);
+    }
+    ASSERT_EQ(store->segments.size(), 4UL);
+
+    // Only the streams reading the segments by themselves are tested, the read thread schedules the segments asynchronously.
+    db_context->getSettingsRef().dt_enable_read_thread = false;
+    auto read_with_limit = [&](size_t limit) {
+        const auto & columns = store->getTableColumns();
+        auto in = store->read(*db_context,
+                              db_context->getSettingsRef(),
+                              columns,
+                              {RowKeyRange::newAll(store->isCommonHandle(), store->getRowKeyColumnSize())},
+                              /* num_streams= */ 1,
+                              /* max_version= */ std::numeric_limits<UInt64>::max(),
+                              EMPTY_FILTER,
+                              TRACING_NAME,
+                              /* keep_order= */ false,
+                              /* is_fast_mode= */ false,
+                              /* expected_block_size= */ 1024,
+                              /* read_segments= */ {},
+                              /* extra_table_id_index= */ InvalidColumnID,
+                              /* late_materialization_filter= */ nullptr,
+                              /* read_rows_only= */ false,
+                              /* top_n= */ nullptr,
+                              limit)[0];
+        size_t rows = 0;
+        in->readPrefix();
+        while (Block block = in->read())
+            rows += block.rows();
+        in->readSuffix();
+        return rows;
+    };
+
+    // Stop reading new segments once enough rows are read
+    {
+        auto rows = read_with_limit(10);
+        ASSERT_GE(rows, 10UL);
+        ASSERT_LT(rows, num_rows_write);
+    }
+    // No limit
+    ASSERT_EQ(read_with_limit(0), num_rows_write);
+    ASSERT_EQ(read_with_limit(2000), num_rows_write);
+}
+CATCH
+
 TEST_F(DeltaMergeStoreTest, OpenWithExtraColumns)
 try
 {
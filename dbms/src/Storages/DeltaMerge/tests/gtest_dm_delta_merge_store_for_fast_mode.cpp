@@ -1602,6 +1602,83 @@ try
     }
 }
 CATCH
+
+TEST_P(DeltaMergeStoreRWTest, TestExactFastModeWithUpdateAndDeleteRange)
+try
+{
+    auto write_block = [&](Block block) {
+        switch (mode)
+        {
+        case TestMode::V1_BlockOnly:
+        case TestMode::V2_BlockOnly:
+            store->write(*db_context, db_context->getSettingsRef(), block);
+            break;
+        default:
+        {
+            auto dm_context = store->newDMContext(*db_context, db_context->getSettingsRef());
+            auto [range, file_ids] = genDMFile(*dm_context, block);
+            store->ingestFiles(dm_context, range, file_ids, false);
+            break;
+        }
+        }
+    };
+    auto read_handles = [&](std::set<Int64> & handles) {
+        const auto & columns = store->getTableColumns();
+        BlockInputStreamPtr in = store->read(*db_context,
+                                             db_context->getSettingsRef(),
+                                             columns,
+                                             {RowKeyRange::newAll(store->isCommonHandle(), store->getRowKeyColumnSize())},
+                                             /* num_streams= */ 1,
+                                             /* max_version= */ std::numeric_limits<UInt64>::max(),
+                                             EMPTY_FILTER,
+                                             TRACING_NAME,
+                                             /* keep_order= */ false,
+                                             /* is_raw_read= */ true,
+                                             /* expected_block_size= */ 1024)[0];
+        size_t num_rows_read = 0;
+        in->readPrefix();
+        while (Block block = in->read())
+        {
+            num_rows_read += block.rows();
+            const auto & c = block.getByName(DMTestEnv::pk_name).column;
+            for (size_t i = 0; i < c->size(); ++i)
+                handles.insert(c->getInt(i));
+        }
+        in->readSuffix();
+        return num_rows_read;
+    };
+
+    // Write [0, 128) into the stable.
+    write_block(DMTestEnv::prepareSimpleWriteBlock(0, 128, false, /*tso*/ 2));
+    store->flushCache(*db_context, RowKeyRange::newAll(store->isCommonHandle(), store->getRowKeyColumnSize()));
+    store->mergeDeltaAll(*db_context);
+
+    // Update [0, 32) and insert [128, 160) in the delta, then delete [100, 110).
+    write_block(DMTestEnv::prepareSimpleWriteBlock(0, 32, false, /*tso*/ 3));
+    write_block(DMTestEnv::prepareSimpleWriteBlock(128, 160, false, /*tso*/ 3));
+    store->deleteRange(*db_context, db_context->getSettingsRef(), RowKeyRange::fromHandleRange(HandleRange(100, 110)));
+    // The rows written after the delete range are not deleted.
+    write_block(DMTestEnv::prepareSimpleWriteBlock(105, 106, false, /*tso*/ 4));
+
+    const size_t num_rows_expected = 160 - 10 + 1;
+    {
+        // The normal fast mode returns the superseded rows too.
+        std::set<Int64> handles;
+        ASSERT_GT(read_handles(handles), num_rows_expected);
+    }
+
+    db_context->getSettingsRef().dt_enable_exact_fast_mode = true;
+    {
+        std::set<Int64> handles;
+        ASSERT_EQ(read_handles(handles), num_rows_expected);
+        ASSERT_EQ(handles.size(), num_rows_expected);
+        ASSERT_EQ(handles.count(100), 0);
+        ASSERT_EQ(handles.count(105), 1);
+        ASSERT_EQ(handles.count(159), 1);
+    }
+    db_context->getSettingsRef().dt_enable_exact_fast_mode = false;
+}
+CATCH
 } // namespace tests
 } // namespace DM
 } // namespace DB
\ No newline at end of file
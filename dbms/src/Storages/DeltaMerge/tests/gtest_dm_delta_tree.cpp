@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <IO/ReadBufferFromString.h>
+#include <IO/WriteBufferFromString.h>
+#include <Storages/DeltaMerge/DeltaIndex.h>
 #include <Storages/DeltaMerge/DeltaMergeDefines.h>
 #include <Storages/DeltaMerge/DeltaTree.h>
 #include <Storages/DeltaMerge/Tuple.h>
@@ -76,7 +79,8 @@ void printTree(const FakeDeltaTree & tree)
     std::cout << std::endl;
 }
 
-std::string treeToString(const FakeDeltaTree & tree)
+template <class Tree>
+std::string treeToString(const Tree & tree)
 {
     std::string result = "";
     std::string temp;
@@ -316,6 +320,87 @@ TEST_F(DeltaTree_test, InsertSkipDelete)
     checkCopy(tree);
 }
 
+TEST_F(DeltaTree_test, CompactedEntriesCache)
+{
+    for (int i = 0; i < 100; ++i)
+        tree.addInsert(i, i);
+    auto compacted = tree.getCompactedEntries();
+    ASSERT_EQ(tree.getCompactedEntries(), compacted);
+
+    tree.addDelete(0);
+    auto after_delete = tree.getCompactedEntries();
+    ASSERT_NE(after_delete, compacted);
+
+    size_t count = 0;
+    for (auto it = after_delete->begin(); it != after_delete->end(); ++it)
+        count += it.getCount();
+    ASSERT_EQ(count, 99);
+
+    tree.addInsert(0, 100);
+    ASSERT_NE(tree.getCompactedEntries(), after_delete);
+}
+
+TEST(DeltaIndex_test, SerializeAndRestore)
+{
+    auto delta_tree = std::make_shared<DefaultDeltaTree>();
+    size_t tuple_id = 0;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        // Mix of inserts, deletes on stable rows and deletes on inserted rows.
+        delta_tree->addInsert((i * 7) % (i + 1), tuple_id++);
+        if (i % 3 == 0)
+            delta_tree->addDelete(i / 2);
+        if (i % 5 == 0)
+            delta_tree->addDelete(i);
+    }
+    DeltaIndex delta_index(delta_tree, tuple_id, 10);
+
+    WriteBufferFromOwnString write_buf;
+    delta_index.serialize(write_buf);
+    auto data = write_buf.releaseStr();
+
+    ReadBufferFromString read_buf(data);
+    auto restored = DeltaIndex::deserialize(read_buf);
+    ASSERT_TRUE(read_buf.eof());
+    ASSERT_EQ(restored->getPlacedStatus(), delta_index.getPlacedStatus());
+
+    auto restored_tree = restored->getDeltaTree();
+    ASSERT_EQ(restored_tree->numEntries(), delta_tree->numEntries());
+    ASSERT_EQ(restored_tree->numInserts(), delta_tree->numInserts());
+    ASSERT_EQ(restored_tree->numDeletes(), delta_tree->numDeletes());
+    ASSERT_EQ(treeToString(*restored_tree), treeToString(*delta_tree));
+}
+
+TEST(DeltaIndex_test, CloneCopyOnWrite)
+{
+    auto delta_tree = std::make_shared<DefaultDeltaTree>();
+    for (size_t i = 0; i < 100; ++i)
+        delta_tree->addInsert(i, i);
+    DeltaIndex delta_index(delta_tree, 100, 0);
+    const auto expected = treeToString(*delta_tree);
+
+    // The clone shares the delta tree until it is going to be modified.
+    auto cloned = delta_index.tryClone(100, 0);
+    ASSERT_EQ(cloned->getDeltaTree(), delta_tree);
+    ASSERT_EQ(cloned->getPlacedStatus(), delta_index.getPlacedStatus());
+
+    auto mutable_tree = cloned->getMutableDeltaTree();
+    ASSERT_NE(mutable_tree, delta_tree);
+    ASSERT_EQ(cloned->getMutableDeltaTree(), mutable_tree);
+    mutable_tree->addDelete(0);
+    mutable_tree->checkAll();
+    ASSERT_EQ(treeToString(*delta_tree), expected);
+    ASSERT_NE(treeToString(*mutable_tree), expected);
+
+    // The updates on inserts copy the shared delta tree too.
+    IColumn::Permutation perm(100);
+    for (size_t i = 0; i < perm.size(); ++i)
+        perm[i] = perm.size() - 1 - i;
+    auto updated = delta_index.cloneWithUpdates({DeltaIndex::Update(0, 0, perm)});
+    ASSERT_NE(updated->getDeltaTree(), delta_tree);
+    ASSERT_EQ(treeToString(*delta_tree), expected);
+}
+
 } // namespace tests
 } // namespace DM
 } // namespace DB
@@ -209,6 +209,26 @@ static void checkDeltaValueSpaceData(
         RowKeyRange read_range = RowKeyRange::fromHandleRange(handle_range);
         ASSERT_EQ(reader->readRows(columns, 0, expected_all_rows, &read_range), expected_range_rows);
     }
+
+    // gather all rows by many small reads
+    {
+        auto reader = std::make_shared<DeltaValueReader>(
+            dm_context,
+            snapshot,
+            table_columns,
+            RowKeyRange::newAll(false, 1));
+        auto columns = expected_all_blocks[0].cloneEmptyColumns();
+        ColumnSlicesGatherer gatherer;
+        const size_t rows_per_read = 7;
+        size_t gathered_rows = 0;
+        for (size_t offset = 0; offset < expected_all_rows; offset += rows_per_read)
+            gathered_rows += reader->gatherRows(gatherer, columns, offset, rows_per_read, nullptr);
+        ASSERT_EQ(gathered_rows, expected_all_rows);
+        ASSERT_EQ(gatherer.gather(columns), expected_all_rows);
+        Blocks result_blocks;
+        result_blocks.push_back(expected_all_blocks[0].cloneWithColumns(std::move(columns)));
+        assertBlocksEqual(expected_all_blocks, result_blocks);
+    }
 }
 
 TEST_F(DeltaValueSpaceTest, WriteRead)
@@ -269,6 +289,44 @@ TEST_F(DeltaValueSpaceTest, WriteRead)
 }
 
 // Write data to MemTableSet when do flush at the same time
+TEST_F(DeltaValueSpaceTest, CompressCache)
+{
+    DB::Settings db_settings;
+    db_settings.dt_segment_delta_cache_compress = true;
+    // Seal the in-memory column file after each batch.
+    db_settings.dt_segment_delta_cache_limit_rows = num_rows_write_per_batch;
+    delta = reload({}, std::move(db_settings));
+
+    Blocks write_blocks;
+    size_t total_rows_write = 0;
+    write_blocks.push_back(appendBlockToDeltaValueSpace(dmContext(), delta, total_rows_write, num_rows_write_per_batch));
+    total_rows_write += num_rows_write_per_batch;
+    ASSERT_EQ(delta->getUnsavedMemoryBytes(), delta->getUnsavedBytes());
+    // The snapshot shares the cache of the column file which is compressed later.
+    auto old_snapshot = delta->createSnapshot(dmContext(), false, CurrentMetrics::DT_SnapshotOfRead);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        write_blocks.push_back(appendBlockToDeltaValueSpace(dmContext(), delta, total_rows_write, num_rows_write_per_batch));
+        total_rows_write += num_rows_write_per_batch;
+    }
+    ASSERT_EQ(delta->getColumnFileCount(), 3);
+    ASSERT_LT(delta->getUnsavedMemoryBytes(), delta->getUnsavedBytes());
+    checkDeltaValueSpaceData(delta, dmContext(), table_columns, write_blocks, total_rows_write, HandleRange(0, num_rows_write_per_batch / 2), num_rows_write_per_batch / 2);
+
+    {
+        auto reader = std::make_shared<DeltaValueReader>(dmContext(), old_snapshot, table_columns, RowKeyRange::newAll(false, 1));
+        auto columns = write_blocks[0].cloneEmptyColumns();
+        ASSERT_EQ(reader->readRows(columns, 0, num_rows_write_per_batch, nullptr), num_rows_write_per_batch);
+        assertBlocksEqual({write_blocks[0]}, {write_blocks[0].cloneWithColumns(std::move(columns))});
+    }
+
+    // The compressed column files are decompressed when flushing.
+    ASSERT_TRUE(delta->flush(dmContext()));
+    ASSERT_EQ(delta->getUnsavedMemoryBytes(), 0);
+    checkDeltaValueSpaceData(delta, dmContext(), table_columns, write_blocks, total_rows_write, HandleRange(0, num_rows_write_per_batch / 2), num_rows_write_per_batch / 2);
+}
+
 TEST_F(DeltaValueSpaceTest, Flush)
 {
     auto mem_table_set = delta->getMemTableSet();
@@ -13,11 +13,13 @@
 // limitations under the License.
 
 #include <Common/FailPoint.h>
+#include <Common/ProfileEvents.h>
 #include <Interpreters/Context.h>
 #include <Storages/DeltaMerge/DMContext.h>
 #include <Storages/DeltaMerge/DeltaMergeStore.h>
 #include <Storages/DeltaMerge/File/DMFileBlockInputStream.h>
 #include <Storages/DeltaMerge/File/DMFileBlockOutputStream.h>
+#include <Storages/DeltaMerge/File/DMFileReader.h>
 #include <Storages/DeltaMerge/File/DMFileWriter.h>
 #include <Storages/DeltaMerge/RowKeyRange.h>
 #include <Storages/DeltaMerge/tests/DMTestEnv.h>
@@ -26,6 +28,12 @@
 
 #include <vector>
 
+namespace ProfileEvents
+{
+extern const Event DMFileSingleFileMergedReads;
+extern const Event MMapFileOpen;
+} // namespace ProfileEvents
+
 namespace DB
 {
 namespace FailPoints
@@ -829,6 +837,776 @@ try
 }
 CATCH
 
+// Test rough filter with bloom filter index, the values in each pack are scattered so that minmax index could not exclude any pack
+TEST_P(DMFile_Test, ReadFilteredByBloomFilter)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    // Prepare columns
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    cols->push_back(i64_cd);
+
+    reload(cols);
+    dbContext().setSetting("dt_bloom_filter_index_columns", "i64");
+    dbContext().setSetting("dt_bloom_filter_bits_per_key", Field(static_cast<UInt64>(16)));
+
+    const Int64 num_rows_write = 1024;
+    const Int64 nparts = 4;
+    const Int64 span_per_part = num_rows_write / nparts;
+
+    {
+        // Prepare some packs in DMFile, the i-th pack contains `j * nparts * 2 + i`
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            std::vector<Int64> values;
+            for (Int64 j = 0; j < span_per_part; ++j)
+                values.push_back(j * nparts * 2 + i);
+            block.insert(DB::tests::createColumn<Int64>(values, i64_cd.name, i64_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+    ASSERT_TRUE(dm_file->isColBloomFilterExist(i64_cd.id));
+    ASSERT_FALSE(dm_file->isColBloomFilterExist(EXTRA_HANDLE_COLUMN_ID));
+
+    auto attr = Attr{i64_cd.name, i64_cd.id, i64_cd.type};
+    auto test_read_filter = [&](const RSOperatorPtr & filter, Int64 expect_rows) {
+        DMFileBlockInputStreamBuilder builder(dbContext());
+        auto stream = builder
+                          .setColumnCache(column_cache_)
+                          .setRSOperator(filter)
+                          .build(dm_file, *cols, RowKeyRanges{RowKeyRange::newAll(false, 1)});
+        Int64 num_rows_read = 0;
+        stream->readPrefix();
+        while (Block in = stream->read())
+            num_rows_read += in.rows();
+        stream->readSuffix();
+        ASSERT_EQ(num_rows_read, expect_rows) << filter->toDebugString();
+    };
+
+    auto test_read_filters = [&]() {
+        // Only the pack contains the value is read
+        test_read_filter(createEqual(attr, Field(static_cast<Int64>(10 * nparts * 2 + 2))), span_per_part);
+        test_read_filter(createIn(attr, {Field(static_cast<Int64>(nparts * 2)), Field(static_cast<Int64>(5 * nparts * 2 + 3))}), 2 * span_per_part);
+        // The values are in the range of minmax index, but not exist in any pack
+        test_read_filter(createEqual(attr, Field(static_cast<Int64>(10 * nparts * 2 + nparts))), 0);
+        test_read_filter(createIn(attr, {Field(static_cast<Int64>(nparts + 1)), Field(static_cast<Int64>(7 * nparts * 2 + nparts + 2))}), 0);
+        // Not supported by bloom filter
+        test_read_filter(createNotEqual(attr, Field(static_cast<Int64>(10))), num_rows_write);
+    };
+
+    test_read_filters();
+
+    // Restore file from disk and read again
+    dm_file = restoreDMFile();
+    ASSERT_TRUE(dm_file->isColBloomFilterExist(i64_cd.id));
+    test_read_filters();
+}
+CATCH
+
+TEST_P(DMFile_Test, NDVSketch)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    ColumnDefine str_cd(3, "str", typeFromString("Nullable(String)"));
+    cols->push_back(i64_cd);
+    cols->push_back(str_cd);
+
+    reload(cols);
+    dbContext().setSetting("dt_enable_ndv_sketch", Field(static_cast<UInt64>(1)));
+
+    const Int64 num_rows_write = 1024;
+    auto write_file = [&](const DMFilePtr & file, Int64 begin, Int64 end) {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), file, *cols);
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 pack_begin = begin; pack_begin < end; pack_begin += 128)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(pack_begin, pack_begin + 128, false);
+            std::vector<Int64> values;
+            std::vector<std::optional<String>> strs;
+            for (Int64 i = pack_begin; i < pack_begin + 128; ++i)
+            {
+                // 500 distinct values in total, and 10 distinct strings besides null
+                values.push_back(i % 500);
+                strs.push_back(i % 11 == 0 ? std::nullopt : std::make_optional(std::to_string(i % 11)));
+            }
+            block.insert(DB::tests::createColumn<Int64>(values, i64_cd.name, i64_cd.id));
+            block.insert(DB::tests::createColumn<Nullable<String>>(strs, str_cd.name, str_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    };
+
+    write_file(dm_file, 0, num_rows_write / 2);
+    auto mode = GetParam();
+    auto other_file = DMFile::create(2, parent_path, mode == DMFileMode::SingleFile, mode == DMFileMode::DirectoryChecksum ? std::make_optional<DMChecksumConfig>() : std::nullopt);
+    write_file(other_file, num_rows_write / 2, num_rows_write);
+    ASSERT_TRUE(dm_file->isColNDVSketchExist(i64_cd.id));
+    ASSERT_TRUE(dm_file->isColNDVSketchExist(str_cd.id));
+
+    auto check = [&](const DMFiles & files, UInt64 expected_i64_ndv) {
+        StableValueSpace stable(1);
+        stable.setFiles(files, RowKeyRange::newAll(false, 1));
+        auto sketches = stable.getNDVSketches(dbContext().getFileProvider(), nullptr);
+        ASSERT_TRUE(sketches.count(i64_cd.id));
+        ASSERT_TRUE(sketches.count(str_cd.id));
+        ASSERT_NEAR(sketches.at(i64_cd.id).estimate(), expected_i64_ndv, expected_i64_ndv * 0.05);
+        ASSERT_NEAR(sketches.at(str_cd.id).estimate(), 10, 1);
+    };
+    // The first file has 512 rows with all of the 500 values
+    check({dm_file}, 500);
+    // Merged with the other file, whose values are all in the first file
+    check({dm_file, other_file}, 500);
+
+    // The sketches are not built by default, so a stable with such a file has no sketches
+    dbContext().setSetting("dt_enable_ndv_sketch", Field(static_cast<UInt64>(0)));
+    auto file_without_sketch = DMFile::create(3, parent_path, mode == DMFileMode::SingleFile, mode == DMFileMode::DirectoryChecksum ? std::make_optional<DMChecksumConfig>() : std::nullopt);
+    write_file(file_without_sketch, num_rows_write, num_rows_write * 2);
+    ASSERT_FALSE(file_without_sketch->isColNDVSketchExist(i64_cd.id));
+    StableValueSpace stable(1);
+    stable.setFiles({dm_file, file_without_sketch}, RowKeyRange::newAll(false, 1));
+    ASSERT_TRUE(stable.getNDVSketches(dbContext().getFileProvider(), nullptr).empty());
+}
+CATCH
+
+TEST_P(DMFile_Test, ReadWithLateMaterialization)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    // Prepare columns
+    ColumnDefine flag_cd(2, "flag", typeFromString("UInt8"));
+    ColumnDefine i64_cd(3, "i64", typeFromString("Int64"));
+    cols->push_back(flag_cd);
+    cols->push_back(i64_cd);
+
+    reload(cols);
+
+    const Int64 nparts = 4;
+    const Int64 span_per_part = 256;
+    // The pack 0 and 3 are all filtered out, pack 1 all pass, pack 2 half pass
+    auto get_flag = [&](Int64 row) -> UInt8 {
+        Int64 part = row / span_per_part;
+        return part == 1 || (part == 2 && row % 2 == 0);
+    };
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            std::vector<UInt64> flags;
+            for (Int64 row = i * span_per_part; row < (i + 1) * span_per_part; ++row)
+                flags.push_back(get_flag(row));
+            block.insert(DB::tests::createColumn<UInt8>(flags, flag_cd.name, flag_cd.id));
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part, (i + 1) * span_per_part), i64_cd.name, i64_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    // Use the flag column as the filter column directly
+    auto before_where = std::make_shared<ExpressionActions>(NamesAndTypesList{{flag_cd.name, flag_cd.type}}, dbContext().getSettingsRef());
+    auto filter = std::make_shared<LateMaterializationFilter>(before_where, flag_cd.name, ColumnDefines{flag_cd});
+    ColumnDefines read_cols{flag_cd, i64_cd};
+
+    auto test_read = [&](bool enable_clean_read, bool read_one_pack_every_time) {
+        DMFileBlockInputStreamBuilder builder(dbContext());
+        builder
+            .setColumnCache(column_cache_)
+            .enableCleanRead(enable_clean_read, false, std::numeric_limits<UInt64>::max())
+            .setLateMaterializationFilter(filter);
+        if (read_one_pack_every_time)
+            builder.onlyReadOnePackEveryTime();
+        auto stream = builder.build(dm_file, read_cols, RowKeyRanges{RowKeyRange::newAll(false, 1)});
+
+        std::vector<Int64> expected_rows;
+        for (Int64 row = 0; row < nparts * span_per_part; ++row)
+        {
+            // Rows are only filtered in advance when doing clean read
+            if (!enable_clean_read || get_flag(row))
+                expected_rows.push_back(row);
+        }
+
+        size_t num_rows_read = 0;
+        stream->readPrefix();
+        while (Block in = stream->read())
+        {
+            ASSERT_EQ(in.columns(), read_cols.size());
+            const auto & flag_c = in.getByName(flag_cd.name).column;
+            const auto & i64_c = in.getByName(i64_cd.name).column;
+            for (size_t i = 0; i < in.rows(); ++i)
+            {
+                ASSERT_LT(num_rows_read, expected_rows.size());
+                EXPECT_EQ(i64_c->getInt(i), expected_rows[num_rows_read]);
+                EXPECT_EQ(flag_c->getUInt(i), get_flag(expected_rows[num_rows_read]));
+                ++num_rows_read;
+            }
+        }
+        stream->readSuffix();
+        ASSERT_EQ(num_rows_read, expected_rows.size()) << enable_clean_read << " " << read_one_pack_every_time;
+    };
+
+    test_read(true, false);
+    test_read(true, true);
+    test_read(false, false);
+
+    // Restore file from disk and read again
+    dm_file = restoreDMFile();
+    test_read(true, false);
+    test_read(true, true);
+}
+CATCH
+
+TEST_P(DMFile_Test, ReadRowsOnly)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    cols->push_back(i64_cd);
+
+    reload(cols);
+
+    const Int64 nparts = 4;
+    const Int64 span_per_part = 256;
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part + 1, (i + 1) * span_per_part + 1), i64_cd.name, i64_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    ColumnDefines read_cols{i64_cd};
+    // The first pack is not fully inside the range, so only its values are read.
+    auto range = RowKeyRange::fromHandleRange(HandleRange{100, HandleRange::MAX});
+    DMFileBlockInputStreamBuilder builder(dbContext());
+    auto stream = builder
+                      .enableCleanRead(true, false, std::numeric_limits<UInt64>::max())
+                      .setReadRowsOnly(true)
+                      .build(dm_file, read_cols, RowKeyRanges{range});
+
+    Int64 num_rows_read = 0;
+    stream->readPrefix();
+    while (Block in = stream->read())
+    {
+        const auto & i64_c = in.getByName(i64_cd.name).column;
+        for (size_t i = 0; i < in.rows(); ++i)
+        {
+            EXPECT_EQ(i64_c->getInt(i), num_rows_read < span_per_part ? num_rows_read + 1 : 0);
+            ++num_rows_read;
+        }
+    }
+    stream->readSuffix();
+    ASSERT_EQ(num_rows_read, nparts * span_per_part);
+}
+CATCH
+
+TEST_P(DMFile_Test, CooperativeScan)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    cols->push_back(i64_cd);
+    reload(cols);
+
+    const Int64 nparts = 4;
+    const Int64 span_per_part = 256;
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part, (i + 1) * span_per_part), i64_cd.name, i64_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    ColumnDefines read_cols{i64_cd};
+    auto create_reader = [&](bool enable_cooperative_scan) {
+        auto pack_filter = DMFilePackFilter::loadFrom(
+            dm_file,
+            dbContext().getGlobalContext().getMinMaxIndexCache(),
+            nullptr,
+            true,
+            RowKeyRanges{RowKeyRange::newAll(false, 1)},
+            EMPTY_FILTER,
+            {},
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            "");
+        return std::make_unique<DMFileReader>(
+            dm_file,
+            read_cols,
+            /*is_common_handle*/ false,
+            /*enable_clean_read*/ true,
+            /*is_fast_mode*/ true,
+            std::numeric_limits<UInt64>::max(),
+            std::move(pack_filter),
+            nullptr,
+            dbContext().getGlobalContext().getMarkCache(),
+            /*enable_column_cache*/ false,
+            column_cache_,
+            dbContext().getSettingsRef().min_bytes_to_use_direct_io,
+            dbContext().getSettingsRef().max_read_buffer_size,
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            DMFILE_READ_ROWS_THRESHOLD,
+            /*read_one_pack_every_time*/ true,
+            "",
+            /*enable_col_sharing_cache*/ true,
+            enable_cooperative_scan);
+    };
+    auto first_value = [&](const Block & block) {
+        return block.getByName(i64_cd.name).column->getInt(0);
+    };
+
+    // The first reader has read 2 packs.
+    auto reader = create_reader(false);
+    DMFileReaderPool::instance().add(*reader);
+    ASSERT_EQ(first_value(reader->read()), 0);
+    ASSERT_EQ(first_value(reader->read()), span_per_part);
+    ASSERT_EQ(reader->getNextPackId(), 2UL);
+
+    // The reader without cooperative scan always reads from the beginning.
+    {
+        auto other = create_reader(false);
+        DMFileReaderPool::instance().add(*other);
+        ASSERT_EQ(other->getNextPackId(), 0UL);
+        DMFileReaderPool::instance().del(*other);
+    }
+
+    // The late reader joins the scan at pack 2, and then reads pack 0 and 1.
+    auto late_reader = create_reader(true);
+    DMFileReaderPool::instance().add(*late_reader);
+    ASSERT_EQ(late_reader->getNextPackId(), 2UL);
+    std::vector<Int64> expected_first_values{2 * span_per_part, 3 * span_per_part, 0, span_per_part};
+    std::vector<Int64> first_values;
+    size_t num_rows_read = 0;
+    while (Block block = late_reader->read())
+    {
+        first_values.push_back(first_value(block));
+        const auto & col = block.getByName(i64_cd.name).column;
+        for (size_t i = 0; i < block.rows(); ++i)
+            ASSERT_EQ(col->getInt(i), first_values.back() + static_cast<Int64>(i));
+        num_rows_read += block.rows();
+    }
+    ASSERT_EQ(first_values, expected_first_values);
+    ASSERT_EQ(num_rows_read, static_cast<size_t>(nparts * span_per_part));
+
+    DMFileReaderPool::instance().del(*late_reader);
+    DMFileReaderPool::instance().del(*reader);
+}
+CATCH
+
+TEST_P(DMFile_Test, ReadAheadPacks)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    ColumnDefine str_cd(3, "str", typeFromString("String"));
+    cols->push_back(i64_cd);
+    cols->push_back(str_cd);
+    reload(cols);
+
+    const Int64 nparts = 10;
+    const Int64 span_per_part = 1000;
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part, (i + 1) * span_per_part), i64_cd.name, i64_cd.id));
+            Strings strs;
+            for (Int64 v = i * span_per_part; v < (i + 1) * span_per_part; ++v)
+                strs.emplace_back(fmt::format("value_{}", v));
+            block.insert(DB::tests::createColumn<String>(strs, str_cd.name, str_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    ColumnDefines read_cols{i64_cd, str_cd};
+    auto read_all = [&](size_t prefetch_packs, size_t read_ahead_packs, size_t read_ahead_bytes) {
+        auto pack_filter = DMFilePackFilter::loadFrom(
+            dm_file,
+            dbContext().getGlobalContext().getMinMaxIndexCache(),
+            nullptr,
+            true,
+            RowKeyRanges{RowKeyRange::newAll(false, 1)},
+            EMPTY_FILTER,
+            {},
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            "");
+        DMFileReader reader(
+            dm_file,
+            read_cols,
+            /*is_common_handle*/ false,
+            /*enable_clean_read*/ false,
+            /*is_fast_mode*/ false,
+            std::numeric_limits<UInt64>::max(),
+            std::move(pack_filter),
+            nullptr,
+            dbContext().getGlobalContext().getMarkCache(),
+            /*enable_column_cache*/ false,
+            column_cache_,
+            dbContext().getSettingsRef().min_bytes_to_use_direct_io,
+            dbContext().getSettingsRef().max_read_buffer_size,
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            DMFILE_READ_ROWS_THRESHOLD,
+            /*read_one_pack_every_time*/ true,
+            "",
+            /*enable_col_sharing_cache*/ false,
+            /*enable_cooperative_scan*/ false,
+            prefetch_packs,
+            read_ahead_packs,
+            read_ahead_bytes);
+        Int64 num_rows_read = 0;
+        while (Block block = reader.read())
+        {
+            const auto & i64_col = block.getByName(i64_cd.name).column;
+            const auto & str_col = block.getByName(str_cd.name).column;
+            for (size_t i = 0; i < block.rows(); ++i)
+            {
+                ASSERT_EQ(i64_col->getInt(i), num_rows_read);
+                ASSERT_EQ((*str_col)[i].get<String>(), fmt::format("value_{}", num_rows_read));
+                ++num_rows_read;
+            }
+        }
+        ASSERT_EQ(num_rows_read, nparts * span_per_part);
+    };
+
+    read_all(0, 0, 0);
+    // Read ahead in background, with or without the limit of bytes.
+    read_all(0, 3, 16 * 1024 * 1024);
+    read_all(0, 3, 1024);
+    read_all(0, nparts * 2, 16 * 1024 * 1024);
+    // Read ahead by io_uring, which falls back to normal reads if not supported.
+    read_all(2, 0, 0);
+    read_all(nparts * 2, 0, 0);
+    read_all(2, 4, 16 * 1024 * 1024);
+}
+CATCH
+
+TEST_P(DMFile_Test, SingleFileMergedReads)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    ColumnDefine str_cd(3, "str", typeFromString("String"));
+    cols->push_back(i64_cd);
+    cols->push_back(str_cd);
+    reload(cols);
+
+    const Int64 nparts = 10;
+    const Int64 span_per_part = 1000;
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part, (i + 1) * span_per_part), i64_cd.name, i64_cd.id));
+            Strings strs;
+            for (Int64 v = i * span_per_part; v < (i + 1) * span_per_part; ++v)
+                strs.emplace_back(fmt::format("value_{}", v));
+            block.insert(DB::tests::createColumn<String>(strs, str_cd.name, str_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    ColumnDefines read_cols{i64_cd, str_cd};
+    // Returns the number of merged reads.
+    auto read_all = [&](size_t plan_packs, size_t merge_gap_bytes) -> size_t {
+        const auto reads_before = ProfileEvents::counters[ProfileEvents::DMFileSingleFileMergedReads].load();
+        auto pack_filter = DMFilePackFilter::loadFrom(
+            dm_file,
+            dbContext().getGlobalContext().getMinMaxIndexCache(),
+            nullptr,
+            true,
+            RowKeyRanges{RowKeyRange::newAll(false, 1)},
+            EMPTY_FILTER,
+            {},
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            "");
+        DMFileReader reader(
+            dm_file,
+            read_cols,
+            /*is_common_handle*/ false,
+            /*enable_clean_read*/ false,
+            /*is_fast_mode*/ false,
+            std::numeric_limits<UInt64>::max(),
+            std::move(pack_filter),
+            nullptr,
+            dbContext().getGlobalContext().getMarkCache(),
+            /*enable_column_cache*/ false,
+            column_cache_,
+            dbContext().getSettingsRef().min_bytes_to_use_direct_io,
+            dbContext().getSettingsRef().max_read_buffer_size,
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            DMFILE_READ_ROWS_THRESHOLD,
+            /*read_one_pack_every_time*/ true,
+            "",
+            /*enable_col_sharing_cache*/ false,
+            /*enable_cooperative_scan*/ false,
+            /*prefetch_packs*/ 0,
+            /*read_ahead_packs*/ 0,
+            /*read_ahead_bytes*/ 0,
+            /*read_rows_only*/ false,
+            /*decompressed_block_cache*/ nullptr,
+            /*decompressed_block_cache_max_column_bytes*/ 0,
+            plan_packs,
+            merge_gap_bytes);
+        Int64 num_rows_read = 0;
+        while (Block block = reader.read())
+        {
+            const auto & i64_col = block.getByName(i64_cd.name).column;
+            const auto & str_col = block.getByName(str_cd.name).column;
+            for (size_t i = 0; i < block.rows(); ++i)
+            {
+                EXPECT_EQ(i64_col->getInt(i), num_rows_read);
+                EXPECT_EQ((*str_col)[i].get<String>(), fmt::format("value_{}", num_rows_read));
+                ++num_rows_read;
+            }
+        }
+        EXPECT_EQ(num_rows_read, nparts * span_per_part);
+        return ProfileEvents::counters[ProfileEvents::DMFileSingleFileMergedReads].load() - reads_before;
+    };
+
+    ASSERT_EQ(read_all(0, 0), 0);
+    if (GetParam() != DMFileMode::SingleFile)
+    {
+        // Only for single file mode.
+        ASSERT_EQ(read_all(3, 1024 * 1024), 0);
+        return;
+    }
+    // The columns of all the planned packs are loaded by one read if all the gaps are merged.
+    ASSERT_EQ(read_all(nparts * 2, 1024 * 1024 * 1024), 1);
+    ASSERT_EQ(read_all(3, 1024 * 1024 * 1024), 4);
+    // The ranges of different columns are not adjacent, more reads without merging the gaps.
+    ASSERT_GT(read_all(nparts, 0), 1);
+}
+CATCH
+
+TEST_P(DMFile_Test, ReadMarkAndIndexByMMap)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    cols->push_back(i64_cd);
+    reload(cols);
+
+    const Int64 nparts = 10;
+    const Int64 span_per_part = 1000;
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part, (i + 1) * span_per_part), i64_cd.name, i64_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    ColumnDefines read_cols{getExtraHandleColumnDefine(false), i64_cd};
+    // Returns the number of the mapped files.
+    auto read_range = [&](bool use_mmap) -> size_t {
+        const auto mmap_before = ProfileEvents::counters[ProfileEvents::MMapFileOpen].load();
+        // No cache, so that the marks and the indexes are loaded from the files.
+        auto pack_filter = DMFilePackFilter::loadFrom(
+            dm_file,
+            nullptr,
+            nullptr,
+            true,
+            RowKeyRanges{RowKeyRange::fromHandleRange(HandleRange{span_per_part, span_per_part * 3 + 10})},
+            EMPTY_FILTER,
+            {},
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            "",
+            use_mmap);
+        DMFileReader reader(
+            dm_file,
+            read_cols,
+            /*is_common_handle*/ false,
+            /*enable_clean_read*/ false,
+            /*is_fast_mode*/ false,
+            std::numeric_limits<UInt64>::max(),
+            std::move(pack_filter),
+            nullptr,
+            /*mark_cache*/ nullptr,
+            /*enable_column_cache*/ false,
+            column_cache_,
+            dbContext().getSettingsRef().min_bytes_to_use_direct_io,
+            dbContext().getSettingsRef().max_read_buffer_size,
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            DMFILE_READ_ROWS_THRESHOLD,
+            /*read_one_pack_every_time*/ true,
+            "",
+            /*enable_col_sharing_cache*/ false,
+            /*enable_cooperative_scan*/ false,
+            /*prefetch_packs*/ 0,
+            /*read_ahead_packs*/ 0,
+            /*read_ahead_bytes*/ 0,
+            /*read_rows_only*/ false,
+            /*decompressed_block_cache*/ nullptr,
+            /*decompressed_block_cache_max_column_bytes*/ 0,
+            /*single_file_read_plan_packs*/ 0,
+            /*single_file_read_merge_gap_bytes*/ 0,
+            use_mmap);
+        // The packs [1, 4) are read.
+        Int64 expect = span_per_part;
+        while (Block block = reader.read())
+        {
+            const auto & handle_col = block.getByName(EXTRA_HANDLE_COLUMN_NAME).column;
+            const auto & i64_col = block.getByName(i64_cd.name).column;
+            for (size_t i = 0; i < block.rows(); ++i)
+            {
+                EXPECT_EQ(handle_col->getInt(i), expect);
+                EXPECT_EQ(i64_col->getInt(i), expect);
+                ++expect;
+            }
+        }
+        EXPECT_EQ(expect, span_per_part * 4);
+        return ProfileEvents::counters[ProfileEvents::MMapFileOpen].load() - mmap_before;
+    };
+
+    ASSERT_EQ(read_range(false), 0);
+    const auto mapped_files = read_range(true);
+    if (GetParam() == DMFileMode::SingleFile || dbContext().getFileProvider()->isEncryptionEnabled())
+        ASSERT_EQ(mapped_files, 0);
+    else
+        ASSERT_GT(mapped_files, 0);
+}
+CATCH
+
+TEST_P(DMFile_Test, ReadWithDecompressedBlockCache)
+try
+{
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_cd(2, "i64", typeFromString("Int64"));
+    cols->push_back(i64_cd);
+    reload(cols);
+
+    const Int64 nparts = 10;
+    const Int64 span_per_part = 1000;
+    {
+        auto stream = std::make_shared<DMFileBlockOutputStream>(dbContext(), dm_file, *cols);
+        DMFileBlockOutputStream::BlockProperty block_property;
+        stream->writePrefix();
+        for (Int64 i = 0; i < nparts; ++i)
+        {
+            Block block = DMTestEnv::prepareSimpleWriteBlock(i * span_per_part, (i + 1) * span_per_part, false);
+            block.insert(DB::tests::createColumn<Int64>(createNumbers<Int64>(i * span_per_part, (i + 1) * span_per_part), i64_cd.name, i64_cd.id));
+            stream->write(block, block_property);
+        }
+        stream->writeSuffix();
+    }
+
+    auto cache = std::make_shared<DecompressedBlockCache>(64 * 1024 * 1024);
+    ColumnDefines read_cols{getExtraHandleColumnDefine(false), i64_cd};
+    auto read_all = [&](size_t max_column_bytes) {
+        auto pack_filter = DMFilePackFilter::loadFrom(
+            dm_file,
+            dbContext().getGlobalContext().getMinMaxIndexCache(),
+            nullptr,
+            true,
+            RowKeyRanges{RowKeyRange::newAll(false, 1)},
+            EMPTY_FILTER,
+            {},
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            "");
+        DMFileReader reader(
+            dm_file,
+            read_cols,
+            /*is_common_handle*/ false,
+            /*enable_clean_read*/ false,
+            /*is_fast_mode*/ false,
+            std::numeric_limits<UInt64>::max(),
+            std::move(pack_filter),
+            nullptr,
+            dbContext().getGlobalContext().getMarkCache(),
+            /*enable_column_cache*/ false,
+            column_cache_,
+            dbContext().getSettingsRef().min_bytes_to_use_direct_io,
+            dbContext().getSettingsRef().max_read_buffer_size,
+            dbContext().getFileProvider(),
+            dbContext().getReadLimiter(),
+            DMFILE_READ_ROWS_THRESHOLD,
+            /*read_one_pack_every_time*/ true,
+            "",
+            /*enable_col_sharing_cache*/ false,
+            /*enable_cooperative_scan*/ false,
+            /*prefetch_packs*/ 0,
+            /*read_ahead_packs*/ 0,
+            /*read_ahead_bytes*/ 0,
+            /*read_rows_only*/ false,
+            cache,
+            max_column_bytes);
+        Int64 num_rows_read = 0;
+        while (Block block = reader.read())
+        {
+            const auto & handle_col = block.getByName(DMTestEnv::pk_name).column;
+            const auto & i64_col = block.getByName(i64_cd.name).column;
+            for (size_t i = 0; i < block.rows(); ++i)
+            {
+                ASSERT_EQ(handle_col->getInt(i), num_rows_read);
+                ASSERT_EQ(i64_col->getInt(i), num_rows_read);
+                ++num_rows_read;
+            }
+        }
+        ASSERT_EQ(num_rows_read, nparts * span_per_part);
+    };
+
+    // Too large to be admitted
+    read_all(1);
+    ASSERT_EQ(cache->count(), 0);
+
+    // Only the blocks of the handle column are cached, the second read hits them
+    read_all(64 * 1024 * 1024);
+    size_t cached_blocks = cache->count();
+    ASSERT_GT(cached_blocks, 0);
+    size_t hits = 0, misses = 0;
+    cache->getStats(hits, misses);
+    read_all(64 * 1024 * 1024);
+    size_t new_hits = 0, new_misses = 0;
+    cache->getStats(new_hits, new_misses);
+    ASSERT_EQ(cache->count(), cached_blocks);
+    ASSERT_GT(new_hits, hits);
+    ASSERT_EQ(new_misses, misses);
+}
+CATCH
+
 /// Test reading different column types
 
 TEST_P(DMFile_Test, NumberTypes)
@@ -895,6 +1673,120 @@ try
 }
 CATCH
 
+TEST_P(DMFile_Test, WriteVertically)
+try
+{
+    if (GetParam() == DMFileMode::SingleFile)
+        return; // Vertical write is only supported in folder mode
+
+    auto cols = DMTestEnv::getDefaultColumns();
+    ColumnDefine i64_col(2, "i64", typeFromString("Int64"));
+    ColumnDefine f64_col(3, "f64", typeFromString("Float64"));
+    cols->push_back(i64_col);
+    cols->push_back(f64_col);
+
+    reload(cols);
+
+    const size_t num_rows_write = 128;
+    std::vector<Block> blocks;
+    for (size_t start = 0; start < num_rows_write; start += num_rows_write / 4)
+    {
+        Block block = DMTestEnv::prepareSimpleWriteBlock(start, start + num_rows_write / 4, false);
+        block.insert(DB::tests::createColumn<Int64>(
+            createNumbers<Int64>(start, start + num_rows_write / 4),
+            i64_col.name,
+            i64_col.id));
+        block.insert(DB::tests::createColumn<Float64>(
+            std::vector<Float64>(num_rows_write / 4, 0.125),
+            f64_col.name,
+            f64_col.id));
+        blocks.push_back(std::move(block));
+    }
+
+    {
+        DMFileBlockOutputStream::Flags flags;
+        flags.setVertical(true);
+        auto stream = std::make_unique<DMFileBlockOutputStream>(dbContext(), dm_file, *cols, flags);
+
+        DMFileBlockOutputStream::BlockProperty block_property{.not_clean_rows = 0, .effective_num_rows = num_rows_write / 4, .gc_hint_version = 1};
+        stream->writePrefix();
+        // Writing before the first group begins is not allowed
+        ASSERT_THROW(stream->write(blocks[0], block_property), DB::TiFlashException);
+
+        stream->beginColumnGroup(ColumnDefines(cols->begin(), cols->begin() + 4));
+        for (const auto & block : blocks)
+            stream->write(block, block_property);
+        stream->endColumnGroup();
+
+        stream->beginColumnGroup({f64_col});
+        // The blocks of the other groups must match the packs of the first group
+        Block small_block{DB::tests::createColumn<Float64>(std::vector<Float64>{0.125}, f64_col.name, f64_col.id)};
+        ASSERT_THROW(stream->write(small_block, block_property), DB::TiFlashException);
+        for (size_t i = 1; i < blocks.size(); ++i)
+            stream->write(blocks[i], block_property);
+        // Lack of the last pack
+        ASSERT_THROW(stream->endColumnGroup(), DB::TiFlashException);
+    }
+
+    // Write again with the expected packs
+    dm_file = DMFile::create(2, parent_path, false, GetParam() == DMFileMode::DirectoryChecksum ? std::make_optional<DMChecksumConfig>() : std::nullopt);
+    {
+        DMFileBlockOutputStream::Flags flags;
+        flags.setVertical(true);
+        auto stream = std::make_unique<DMFileBlockOutputStream>(dbContext(), dm_file, *cols, flags);
+
+        DMFileBlockOutputStream::BlockProperty block_property{.not_clean_rows = 0, .effective_num_rows = num_rows_write / 4, .gc_hint_version = 1};
+        stream->writePrefix();
+        stream->beginColumnGroup(ColumnDefines(cols->begin(), cols->begin() + 4));
+        for (const auto & block : blocks)
+            stream->write(block, block_property);
+        stream->endColumnGroup();
+        stream->beginColumnGroup({f64_col});
+        for (const auto & block : blocks)
+            stream->write(block, block_property);
+        stream->endColumnGroup();
+        stream->writeSuffix();
+    }
+
+    auto check_read = [&]() {
+        ASSERT_EQ(dm_file->getPacks(), blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i)
+            ASSERT_EQ(dm_file->getPackStats()[i].bytes, blocks[i].bytes());
+
+        DMFileBlockInputStreamBuilder builder(dbContext());
+        auto stream = builder
+                          .setColumnCache(column_cache_)
+                          .build(dm_file, *cols, RowKeyRanges{RowKeyRange::newAll(false, 1)});
+
+        size_t num_rows_read = 0;
+        stream->readPrefix();
+        Int64 cur_pk = 0;
+        while (Block in = stream->read())
+        {
+            auto pk_c = in.getByName(DMTestEnv::pk_name).column;
+            auto i64_c = in.getByName(i64_col.name).column;
+            auto f64_c = in.getByName(f64_col.name).column;
+            for (size_t i = 0; i < in.rows(); i++)
+            {
+                EXPECT_EQ(pk_c->getInt(i), cur_pk);
+                EXPECT_EQ(i64_c->getInt(i), cur_pk);
+                Field f = (*f64_c)[i];
+                EXPECT_FLOAT_EQ(f.get<Float64>(), 0.125);
+                ++cur_pk;
+            }
+            num_rows_read += in.rows();
+        }
+        stream->readSuffix();
+        ASSERT_EQ(num_rows_read, num_rows_write);
+    };
+    check_read();
+
+    // The pack stats are written to disk after all the groups
+    dm_file = restoreDMFile();
+    check_read();
+}
+CATCH
+
 TEST_P(DMFile_Test, StringType)
 try
 {
@@ -1048,7 +1048,7 @@ try
 
     for (size_t operater_type = Test_Equal; operater_type < Test_MaxOperator; operater_type++)
     {
-        for (size_t datatype = Test_Int64; datatype < Test_Decimal64; datatype++)
+        for (size_t datatype = Test_Int64; datatype < Test_Max; datatype++)
         {
             {
                 // not null
@@ -1064,27 +1064,8 @@ try
                 }
                 auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), true);
                 ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), true)));
-                ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), false)));
-            }
-        }
-        // datatypes which not support minmax index
-        for (size_t datatype = Test_Decimal64; datatype < Test_Max; datatype++)
-        {
-            {
-                // not null
-                auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), false);
-                ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), true)));
-                ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), false)));
-            }
-            {
-                // has null
-                if (!isNullableDateType(static_cast<MinMaxTestDatatype>(datatype)))
-                {
-                    continue;
-                }
-                auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), true);
-                ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), true)));
-                ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), false)));
+                // The null values never match
+                ASSERT_EQ(false, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_type), false)));
             }
         }
     }
@@ -1098,7 +1079,7 @@ try
 
     for (size_t operater_type = Test_Equal; operater_type < Test_MaxOperator; operater_type++)
     {
-        for (size_t datatype = Test_Int64; datatype < Test_Decimal64; datatype++)
+        for (size_t datatype = Test_Int64; datatype < Test_Max; datatype++)
         {
             {
                 // not null
@@ -1130,7 +1111,7 @@ try
     {
         for (size_t operater_right_type = Test_Equal; operater_right_type < Test_MaxOperator; operater_right_type++)
         {
-            for (size_t datatype = Test_Int64; datatype < Test_Decimal64; datatype++)
+            for (size_t datatype = Test_Int64; datatype < Test_Max; datatype++)
             {
                 {
                     // not null
@@ -1151,33 +1132,7 @@ try
                     auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), true);
                     auto left_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_left_type), true);
                     auto right_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_right_type), false);
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
-                }
-            }
-            // datatypes which not support minmax index
-            for (size_t datatype = Test_Decimal64; datatype < Test_Max; datatype++)
-            {
-                {
-                    // not null
-                    auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), false);
-                    auto left_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_left_type), true);
-                    auto right_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_right_type), false);
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
-                }
-                {
-                    // has null
-                    if (!isNullableDateType(static_cast<MinMaxTestDatatype>(datatype)))
-                    {
-                        continue;
-                    }
-                    auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), true);
-                    auto left_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_left_type), true);
-                    auto right_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_right_type), false);
-
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
+                    ASSERT_EQ(false, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createAnd({left_rs_operator, right_rs_operator})));
                 }
             }
         }
@@ -1194,7 +1149,7 @@ try
     {
         for (size_t operater_right_type = Test_Equal; operater_right_type < Test_MaxOperator; operater_right_type++)
         {
-            for (size_t datatype = Test_Int64; datatype < Test_Decimal64; datatype++)
+            for (size_t datatype = Test_Int64; datatype < Test_Max; datatype++)
             {
                 {
                     // not null
@@ -1219,29 +1174,6 @@ try
                     ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createOr({left_rs_operator, right_rs_operator})));
                 }
             }
-            // datatypes which not support minmax index
-            for (size_t datatype = Test_Decimal64; datatype < Test_Max; datatype++)
-            {
-                {
-                    // not null
-                    auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), false);
-                    auto left_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_left_type), false);
-                    auto right_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_right_type), false);
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createOr({left_rs_operator, right_rs_operator})));
-                }
-                {
-                    // has null
-                    if (!isNullableDateType(static_cast<MinMaxTestDatatype>(datatype)))
-                    {
-                        continue;
-                    }
-                    auto type_value_pair = generateTypeValue(MinMaxTestDatatype(datatype), true);
-                    auto left_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_left_type), false);
-                    auto right_rs_operator = generateRSOperator(static_cast<MinMaxTestDatatype>(datatype), static_cast<MinMaxTestOperator>(operater_right_type), false);
-
-                    ASSERT_EQ(true, checkMatch(case_name, *context, type_value_pair.first, type_value_pair.second, createOr({left_rs_operator, right_rs_operator})));
-                }
-            }
         }
     }
 }
@@ -1324,6 +1256,190 @@ try
     ASSERT_EQ(RoughCheck::Cmp<LessOrEqualsOp>::compare(Field((String) "test_2"), enum16_type, (Int16)101), ValueCompareResult::True);
 }
 CATCH
+
+TEST_F(DMMinMaxIndexTest, BatchRoughCheck)
+try
+{
+    auto check_type = [](const String & type_name, const std::vector<std::vector<Field>> & packs, const RSOperators & filters) {
+        auto type = DataTypeFactory::instance().get(type_name);
+        auto minmax = std::make_shared<MinMaxIndex>(*type);
+        for (const auto & pack : packs)
+        {
+            auto column = type->createColumn();
+            for (const auto & v : pack)
+                column->insert(v);
+            minmax->addPack(*column, nullptr);
+        }
+        RSCheckParam param;
+        param.indexes.emplace(DEFAULT_COL_ID, RSIndex(type, minmax));
+
+        for (const auto & filter : filters)
+        {
+            // Both the whole range and a sub range of the packs should be the same as checking pack by pack.
+            for (size_t start_pack : {0, 1})
+            {
+                const size_t pack_count = packs.size() - start_pack;
+                auto results = filter->batchRoughCheck(start_pack, pack_count, param);
+                ASSERT_EQ(results.size(), pack_count);
+                for (size_t i = 0; i < pack_count; ++i)
+                    ASSERT_EQ(results[i], filter->roughCheck(start_pack + i, param)) << filter->toDebugString() << " pack: " << start_pack + i;
+            }
+        }
+    };
+
+    {
+        auto a = attr("Int64");
+        check_type("Int64",
+                   {{Field(Int64(0)), Field(Int64(9))}, {Field(Int64(10)), Field(Int64(19))}, {Field(Int64(15)), Field(Int64(15))}, {Field(Int64(30)), Field(Int64(39))}},
+                   {createEqual(a, Field(Int64(15))),
+                    createNotEqual(a, Field(Int64(15))),
+                    createGreater(a, Field(Int64(10)), 0),
+                    createGreaterEqual(a, Field(Int64(10)), 0),
+                    createLess(a, Field(Int64(15)), 0),
+                    createLessEqual(a, Field(Int64(15)), 0),
+                    createIn(a, {Field(Int64(5)), Field(Int64(35))}),
+                    createNotIn(a, {Field(Int64(15)), Field(Int64(16))}),
+                    createNot(createEqual(a, Field(Int64(15)))),
+                    createAnd({createGreater(a, Field(Int64(5)), 0), createLess(a, Field(Int64(35)), 0)}),
+                    createAnd({createEqual(a, Field(Int64(100))), createLess(a, Field(Int64(35)), 0)}),
+                    createOr({createEqual(a, Field(Int64(5))), createGreaterEqual(a, Field(Int64(30)), 0), createUnsupported("", "", false)})});
+    }
+    {
+        auto a = attr("Nullable(Int64)");
+        check_type("Nullable(Int64)",
+                   {{Field(Int64(0)), Field(Int64(9))}, {Field(), Field(Int64(19))}, {Field(Int64(20)), Field(Int64(29))}},
+                   {createEqual(a, Field(Int64(5))),
+                    createGreater(a, Field(Int64(10)), 0),
+                    createIn(a, {Field(Int64(5)), Field(Int64(25))}),
+                    createOr({createEqual(a, Field()), createLess(a, Field(Int64(10)), 0)})});
+    }
+    {
+        auto a = attr("String");
+        check_type("String",
+                   {{Field(String("a")), Field(String("c"))}, {Field(String("d")), Field(String("f"))}, {Field(String("x")), Field(String("x"))}},
+                   {createEqual(a, Field(String("b"))),
+                    createEqual(a, Field(String("x"))),
+                    createGreaterEqual(a, Field(String("d")), 0),
+                    createLess(a, Field(String("e")), 0)});
+    }
+}
+CATCH
+
+TEST_F(DMMinMaxIndexTest, StringTruncatedBounds)
+try
+{
+    auto type = DataTypeFactory::instance().get("String");
+    const String prefix(MinMaxIndex::STRING_BOUND_MAX_BYTES, 'a');
+    const String long_min = prefix + "b";
+    const String long_max = prefix + "c";
+
+    auto column = type->createColumn();
+    column->insert(Field(long_min));
+    column->insert(Field(long_max));
+    MinMaxIndex truncated(*type);
+    truncated.addPack(*column, nullptr, /*truncate_string_bounds*/ true);
+    MinMaxIndex exact(*type);
+    exact.addPack(*column, nullptr, /*truncate_string_bounds*/ false);
+
+    auto [min, max] = truncated.getStringMinMax(0);
+    ASSERT_EQ(min.toString(), prefix);
+    ASSERT_EQ(max.toString(), String(MinMaxIndex::STRING_BOUND_MAX_BYTES - 1, 'a') + "b");
+    ASSERT_EQ(exact.getStringMinMax(0).first.toString(), long_min);
+
+    // The truncated bounds are still the bounds of the values.
+    for (const auto & v : {long_min, long_max, prefix + "bb"})
+        ASSERT_NE(truncated.checkEqual(0, Field(v), type), RSResult::None) << v;
+    ASSERT_EQ(truncated.checkEqual(0, Field(String("b")), type), RSResult::None);
+    ASSERT_EQ(truncated.checkGreater(0, Field(String("b")), type, 0), RSResult::None);
+    ASSERT_EQ(truncated.checkGreaterEqual(0, Field(String("b")), type, 0), RSResult::None);
+    ASSERT_EQ(truncated.checkGreater(0, Field(String("a")), type, 0), RSResult::All);
+
+    // A single long value does not make the pack All for equal after truncated.
+    auto single = type->createColumn();
+    single->insert(Field(long_min));
+    MinMaxIndex single_index(*type);
+    single_index.addPack(*single, nullptr, true);
+    ASSERT_EQ(single_index.checkEqual(0, Field(long_min), type), RSResult::Some);
+}
+CATCH
+
+TEST_F(DMMinMaxIndexTest, NullableMarks)
+try
+{
+    auto type = DataTypeFactory::instance().get("Nullable(Int64)");
+    auto minmax = std::make_shared<MinMaxIndex>(*type);
+    {
+        // Some null values
+        auto column = type->createColumn();
+        column->insert(Field(Int64(10)));
+        column->insert(Field());
+        column->insert(Field(Int64(20)));
+        minmax->addPack(*column, nullptr);
+    }
+    {
+        // All null values
+        auto column = type->createColumn();
+        column->insert(Field());
+        column->insert(Field());
+        minmax->addPack(*column, nullptr);
+    }
+
+    ASSERT_EQ(minmax->checkEqual(0, Field(Int64(5)), type), RSResult::None);
+    ASSERT_EQ(minmax->checkEqual(0, Field(Int64(15)), type), RSResult::Some);
+    // Never All with the null values
+    ASSERT_EQ(minmax->checkGreater(0, Field(Int64(5)), type, 0), RSResult::Some);
+    ASSERT_EQ(minmax->checkGreater(0, Field(Int64(20)), type, 0), RSResult::None);
+
+    ASSERT_EQ(minmax->checkEqual(1, Field(Int64(5)), type), RSResult::None);
+    ASSERT_EQ(minmax->checkGreaterEqual(1, Field(Int64(5)), type, 0), RSResult::None);
+    ASSERT_EQ(minmax->checkEqual(1, Field(), type), RSResult::Some);
+}
+CATCH
+
+TEST_F(DMMinMaxIndexTest, DecimalCompare)
+try
+{
+    auto type = DataTypeFactory::instance().get("Decimal(20,2)");
+    auto column = type->createColumn();
+    column->insert(Field(DecimalField<Decimal128>(Decimal128(1050), 2))); // 10.50
+    column->insert(Field(DecimalField<Decimal128>(Decimal128(2000), 2))); // 20.00
+    MinMaxIndex minmax(*type);
+    minmax.addPack(*column, nullptr);
+
+    // Literals of different scales and decimal types
+    ASSERT_EQ(minmax.checkEqual(0, Field(DecimalField<Decimal64>(Decimal64(105), 1)), type), RSResult::Some);
+    ASSERT_EQ(minmax.checkEqual(0, Field(DecimalField<Decimal32>(Decimal32(999), 2)), type), RSResult::None);
+    ASSERT_EQ(minmax.checkGreater(0, Field(DecimalField<Decimal256>(Decimal256(1000), 3)), type, 0), RSResult::All);
+    ASSERT_EQ(minmax.checkGreater(0, Field(DecimalField<Decimal256>(Decimal256(20000), 3)), type, 0), RSResult::None);
+    ASSERT_EQ(minmax.checkGreaterEqual(0, Field(DecimalField<Decimal64>(Decimal64(20001), 3)), type, 0), RSResult::None);
+    // Integer literals
+    ASSERT_EQ(minmax.checkEqual(0, Field(Int64(15)), type), RSResult::Some);
+    ASSERT_EQ(minmax.checkEqual(0, Field(UInt64(21)), type), RSResult::None);
+    ASSERT_EQ(minmax.checkGreater(0, Field(Int64(-1)), type, 0), RSResult::All);
+    // Float literals are not supported
+    ASSERT_EQ(minmax.checkEqual(0, Field(Float64(30.0)), type), RSResult::Some);
+}
+CATCH
+
+TEST_F(DMMinMaxIndexTest, BatchLogicalResults)
+try
+{
+    const RSResults values{Some, None, All};
+    for (auto v0 : values)
+    {
+        for (auto v1 : values)
+        {
+            RSResults and_res{v0}, or_res{v0}, not_res{v0};
+            batchAnd(and_res, RSResults{v1});
+            batchOr(or_res, RSResults{v1});
+            batchNot(not_res);
+            ASSERT_EQ(and_res[0], v0 && v1);
+            ASSERT_EQ(or_res[0], v0 || v1);
+            ASSERT_EQ(not_res[0], !v0);
+        }
+    }
+}
+CATCH
 } // namespace tests
 } // namespace DM
 } // namespace DB
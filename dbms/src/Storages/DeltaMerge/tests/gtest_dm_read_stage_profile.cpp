@@ -0,0 +1,83 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Storages/DeltaMerge/ReadStageProfile.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <chrono>
+#include <thread>
+
+namespace DB
+{
+namespace DM
+{
+namespace tests
+{
+TEST(ReadStageProfileTest, NoProfile)
+{
+    ASSERT_EQ(ReadStageProfile::current(), nullptr);
+    // Do nothing without a profile of current thread
+    ReadStageTimer timer(ReadStage::FileIO);
+    timer.addNested(ReadStage::Decompress, 100);
+}
+
+TEST(ReadStageProfileTest, Scope)
+{
+    ReadStageProfile outer, inner;
+    {
+        ReadStageProfile::Scope outer_scope(&outer);
+        ASSERT_EQ(ReadStageProfile::current(), &outer);
+        {
+            ReadStageProfile::Scope inner_scope(&inner);
+            ASSERT_EQ(ReadStageProfile::current(), &inner);
+        }
+        ASSERT_EQ(ReadStageProfile::current(), &outer);
+    }
+    ASSERT_EQ(ReadStageProfile::current(), nullptr);
+}
+
+TEST(ReadStageProfileTest, NestedTimers)
+{
+    using namespace std::chrono_literals;
+    ReadStageProfile profile;
+    {
+        ReadStageProfile::Scope scope(&profile);
+        ReadStageTimer delta_merge_timer(ReadStage::DeltaMerge);
+        {
+            ReadStageTimer file_io_timer(ReadStage::FileIO);
+            std::this_thread::sleep_for(20ms);
+            file_io_timer.addNested(ReadStage::Decompress, 5'000'000);
+        }
+        std::this_thread::sleep_for(10ms);
+    }
+
+    // The time of the nested stages is excluded from the outer ones
+    auto delta_merge_ns = profile.get(ReadStage::DeltaMerge);
+    auto file_io_ns = profile.get(ReadStage::FileIO);
+    ASSERT_EQ(profile.get(ReadStage::Decompress), 5'000'000);
+    ASSERT_GE(file_io_ns, 15'000'000);
+    ASSERT_GE(delta_merge_ns, 10'000'000);
+    ASSERT_LT(delta_merge_ns, 20'000'000 + file_io_ns);
+
+    std::array<UInt64, static_cast<size_t>(ReadStage::Count)> total{};
+    profile.mergeTo(total);
+    profile.mergeTo(total);
+    ASSERT_EQ(total[static_cast<size_t>(ReadStage::FileIO)], 2 * file_io_ns);
+    ASSERT_EQ(total[static_cast<size_t>(ReadStage::Snapshot)], 0);
+}
+
+} // namespace tests
+} // namespace DM
+} // namespace DB
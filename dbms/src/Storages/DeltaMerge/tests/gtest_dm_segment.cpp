@@ -355,6 +355,39 @@ try
 }
 CATCH
 
+TEST_F(SegmentTest, ShareReadSnapshot)
+try
+{
+    {
+        Block block = DMTestEnv::prepareSimpleWriteBlock(0, 100, false);
+        segment->write(dmContext(), block);
+    }
+
+    auto snap1 = segment->createSnapshot(dmContext(), false, CurrentMetrics::DT_SnapshotOfRead);
+    auto snap2 = segment->createSnapshot(dmContext(), false, CurrentMetrics::DT_SnapshotOfRead);
+    ASSERT_NE(snap1->origin, nullptr);
+    ASSERT_EQ(snap1->origin, snap2->origin);
+    // The clones have their own column caches.
+    ASSERT_NE(snap1->stable, snap2->stable);
+    ASSERT_EQ(snap2->getRows(), 100);
+
+    {
+        Block block = DMTestEnv::prepareSimpleWriteBlock(100, 150, false);
+        segment->write(dmContext(), block);
+    }
+    auto snap3 = segment->createSnapshot(dmContext(), false, CurrentMetrics::DT_SnapshotOfRead);
+    ASSERT_NE(snap3->origin, snap1->origin);
+    ASSERT_EQ(snap3->getRows(), 150);
+    ASSERT_EQ(snap1->getRows(), 100);
+
+    // The snapshot is not shared after all the reads sharing it are done.
+    snap3.reset();
+    auto snap4 = segment->createSnapshot(dmContext(), false, CurrentMetrics::DT_SnapshotOfRead);
+    ASSERT_EQ(snap4->getRows(), 150);
+    ASSERT_NE(snap4->origin, nullptr);
+}
+CATCH
+
 TEST_F(SegmentTest, ReadWithMoreAdvacedDeltaIndex)
 try
 {
@@ -0,0 +1,87 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <Storages/DeltaMerge/DeltaMergeHelpers.h>
+#include <TestUtils/FunctionTestUtils.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <numeric>
+#include <random>
+
+namespace DB::DM::tests
+{
+namespace
+{
+Block createPkBlock(const std::vector<Int64> & handles, const std::vector<UInt64> & versions)
+{
+    std::vector<Int64> rows(handles.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    return Block{
+        DB::tests::createColumn<Int64>(handles, EXTRA_HANDLE_COLUMN_NAME),
+        DB::tests::createColumn<UInt64>(versions, VERSION_COLUMN_NAME),
+        DB::tests::createColumn<Int64>(rows, "row")};
+}
+
+// Check the block is sorted by (handle, version) and the rows with the same (handle, version) keep their order.
+void checkSortedStably(const Block & block)
+{
+    const auto & handles = typeid_cast<const ColumnVector<Int64> &>(*block.getByName(EXTRA_HANDLE_COLUMN_NAME).column).getData();
+    const auto & versions = typeid_cast<const ColumnVector<UInt64> &>(*block.getByName(VERSION_COLUMN_NAME).column).getData();
+    const auto & rows = typeid_cast<const ColumnVector<Int64> &>(*block.getByName("row").column).getData();
+    for (size_t i = 1; i < block.rows(); ++i)
+    {
+        auto prev = std::make_tuple(handles[i - 1], versions[i - 1], rows[i - 1]);
+        auto cur = std::make_tuple(handles[i], versions[i], rows[i]);
+        ASSERT_LT(prev, cur) << "row " << i;
+    }
+}
+} // namespace
+
+TEST(SortBlockByPkTest, AlreadySorted)
+{
+    auto block = createPkBlock({-3, 1, 1, 5}, {1, 1, 2, 1});
+    IColumn::Permutation perm;
+    ASSERT_FALSE(sortBlockByPk(getExtraHandleColumnDefine(false), block, perm));
+    ASSERT_EQ(countSortedRunsByIntHandle(
+                  typeid_cast<const ColumnVector<Int64> &>(*block.getByName(EXTRA_HANDLE_COLUMN_NAME).column).getData(),
+                  typeid_cast<const ColumnVector<UInt64> &>(*block.getByName(VERSION_COLUMN_NAME).column).getData()),
+              1);
+}
+
+TEST(SortBlockByPkTest, FewRuns)
+{
+    auto block = createPkBlock({4, 5, 6, 1, 2, 2, 3}, {1, 1, 1, 1, 2, 1, 1});
+    IColumn::Permutation perm;
+    ASSERT_TRUE(sortBlockByPk(getExtraHandleColumnDefine(false), block, perm));
+    checkSortedStably(block);
+}
+
+TEST(SortBlockByPkTest, RadixSort)
+{
+    std::mt19937_64 rng(0);
+    std::vector<Int64> handles(10000);
+    std::vector<UInt64> versions(handles.size());
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        // Negative handles and duplicated (handle, version) are included.
+        handles[i] = static_cast<Int64>(rng() % 2000) - 1000;
+        versions[i] = rng() % 4;
+    }
+    auto block = createPkBlock(handles, versions);
+    IColumn::Permutation perm;
+    ASSERT_TRUE(sortBlockByPk(getExtraHandleColumnDefine(false), block, perm));
+    ASSERT_EQ(perm.size(), handles.size());
+    checkSortedStably(block);
+}
+
+} // namespace DB::DM::tests
@@ -0,0 +1,66 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <Storages/DeltaMerge/ReadThread/SegmentReader.h>
+#include <TestUtils/TiFlashTestBasic.h>
+
+#include <future>
+
+namespace DB::DM::tests
+{
+TEST(ReadConcurrencyControllerTest, WaitForTurn)
+{
+    ReadConcurrencyController controller(2, 1, 4, false);
+    ASSERT_EQ(controller.getConcurrency(), 2);
+    ASSERT_TRUE(controller.waitForTurn(0));
+    ASSERT_TRUE(controller.waitForTurn(1));
+
+    // The reader out of the limit is parked until the controller is finished.
+    auto parked = std::async(std::launch::async, [&] { return controller.waitForTurn(2); });
+    ASSERT_EQ(parked.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+    controller.finish();
+    ASSERT_FALSE(parked.get());
+}
+
+TEST(ReadConcurrencyControllerTest, NotAdaptive)
+{
+    ReadConcurrencyController controller(2, 1, 4, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    // Blocked on I/O with pending tasks, but not adaptive.
+    controller.report(1'000'000'000, 1'000'000, 10);
+    ASSERT_EQ(controller.getConcurrency(), 2);
+    controller.finish();
+}
+
+TEST(ReadConcurrencyControllerTest, GrowWhenBlocked)
+{
+    ReadConcurrencyController controller(2, 1, 4, true);
+    // Not adjusted before the interval elapsed.
+    controller.report(1'000'000'000, 1'000'000, 10);
+    ASSERT_EQ(controller.getConcurrency(), 2);
+
+    auto parked = std::async(std::launch::async, [&] { return controller.waitForTurn(2); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    controller.report(1'000'000'000, 1'000'000, 10);
+    ASSERT_EQ(controller.getConcurrency(), 3);
+    // The parked reader is woken up.
+    ASSERT_TRUE(parked.get());
+
+    // No pending tasks, not grown any more.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    controller.report(1'000'000'000, 1'000'000, 0);
+    ASSERT_EQ(controller.getConcurrency(), 3);
+    controller.finish();
+}
+
+} // namespace DB::DM::tests
@@ -72,6 +72,39 @@ try
 }
 CATCH
 
+TEST_F(SegmentOperationTest, MergeMultipleSegments)
+try
+{
+    SegmentTestOptions options;
+    reloadWithOptions(options);
+    writeSegment(DELTA_MERGE_FIRST_SEGMENT_ID, 1000);
+    flushSegmentCache(DELTA_MERGE_FIRST_SEGMENT_ID);
+    mergeSegmentDelta(DELTA_MERGE_FIRST_SEGMENT_ID);
+    size_t origin_rows = getSegmentRowNum(DELTA_MERGE_FIRST_SEGMENT_ID);
+
+    auto second_id = splitSegment(DELTA_MERGE_FIRST_SEGMENT_ID);
+    ASSERT_TRUE(second_id.has_value());
+    auto third_id = splitSegment(*second_id);
+    ASSERT_TRUE(third_id.has_value());
+    auto fourth_id = splitSegment(*third_id);
+    ASSERT_TRUE(fourth_id.has_value());
+
+    // Update some rows in the delta of the middle segments, which should be kept by the merge.
+    writeSegment(*second_id);
+    flushSegmentCache(*second_id);
+    writeSegment(*third_id);
+
+    size_t expected_rows = getSegmentRowNum(DELTA_MERGE_FIRST_SEGMENT_ID) + getSegmentRowNum(*second_id)
+        + getSegmentRowNum(*third_id) + getSegmentRowNum(*fourth_id);
+    ASSERT_EQ(expected_rows, origin_rows);
+
+    mergeSegments({DELTA_MERGE_FIRST_SEGMENT_ID, *second_id, *third_id, *fourth_id});
+    ASSERT_EQ(segments.size(), 1);
+    EXPECT_EQ(getSegmentRowNum(DELTA_MERGE_FIRST_SEGMENT_ID), expected_rows);
+    EXPECT_TRUE(segments[DELTA_MERGE_FIRST_SEGMENT_ID]->getRowKeyRange().isEndInfinite());
+}
+CATCH
+
 TEST_F(SegmentOperationTest, TestSegmentRandom)
 try
 {
@@ -141,6 +141,23 @@ void SegmentTestBasic::mergeSegment(PageId left_segment_id, PageId right_segment
     EXPECT_EQ(getSegmentRowNum(merged_segment->segmentId()), left_segment_row_num + right_segment_row_num);
 }
 
+void SegmentTestBasic::mergeSegments(const std::vector<PageId> & segment_ids)
+{
+    Segments ordered_segments;
+    size_t expected_row_num = 0;
+    for (auto segment_id : segment_ids)
+    {
+        ordered_segments.push_back(segments[segment_id]);
+        expected_row_num += getSegmentRowNum(segment_id);
+    }
+
+    SegmentPtr merged_segment = Segment::merge(dmContext(), tableColumns(), ordered_segments);
+    for (auto segment_id : segment_ids)
+        segments.erase(segment_id);
+    segments[merged_segment->segmentId()] = merged_segment;
+    EXPECT_EQ(getSegmentRowNum(merged_segment->segmentId()), expected_row_num);
+}
+
 void SegmentTestBasic::mergeSegmentDelta(PageId segment_id)
 {
     auto segment = segments[segment_id];
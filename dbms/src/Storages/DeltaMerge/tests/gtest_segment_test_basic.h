@@ -40,6 +40,7 @@ public:
 
     std::optional<PageId> splitSegment(PageId segment_id);
     void mergeSegment(PageId left_segment_id, PageId right_segment_id);
+    void mergeSegments(const std::vector<PageId> & segment_ids);
     void mergeSegmentDelta(PageId segment_id);
     void flushSegmentCache(PageId segment_id);
     void writeSegment(PageId segment_id, UInt64 write_rows = 100);
@@ -15,8 +15,11 @@
 #include <Core/Block.h>
 #include <DataStreams/IProfilingBlockInputStream.h>
 #include <Storages/DeltaMerge/DMVersionFilterBlockInputStream.h>
+#include <Storages/DeltaMerge/DMVersionFilterKernels.h>
 #include <Storages/DeltaMerge/tests/DMTestEnv.h>
 
+#include <random>
+
 namespace DB
 {
 namespace DM
@@ -397,6 +400,52 @@ TEST(VersionFilter_test, CompactCommonHandle)
     }
 }
 
+TEST(VersionFilter_test, BulkKernels)
+{
+    std::mt19937_64 rng(std::random_device{}());
+    // Cover both the vectorized body and the tail of the loops
+    for (size_t rows : {1, 7, 64, 1000, 8191})
+    {
+        std::vector<Int64> handles(rows + 1);
+        std::vector<UInt64> versions(rows + 1);
+        std::vector<UInt8> deleted(rows + 1);
+        Int64 handle = 0;
+        for (size_t i = 0; i < rows + 1; ++i)
+        {
+            // Make about half of the rows have the same handle with the next row
+            handle += rng() % 2;
+            handles[i] = handle;
+            versions[i] = rng() % 100;
+            deleted[i] = rng() % 4 == 0;
+        }
+        const UInt64 version_limit = 50;
+
+        std::vector<UInt8> not_equal_next(rows);
+        calcIntHandleNotEqualNext(handles.data(), not_equal_next.data(), rows);
+        for (size_t i = 0; i < rows; ++i)
+            ASSERT_EQ(not_equal_next[i], handles[i] != handles[i + 1]) << i;
+
+        std::vector<UInt8> filter(rows);
+        calcMVCCFilter(not_equal_next.data(), versions.data(), deleted.data(), version_limit, filter.data(), rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            bool expected = !deleted[i] && versions[i] <= version_limit && (handles[i] != handles[i + 1] || versions[i + 1] > version_limit);
+            ASSERT_EQ(filter[i], expected) << i;
+        }
+
+        std::vector<UInt8> effective(rows);
+        std::vector<UInt8> not_clean(rows);
+        calcCompactFilter(not_equal_next.data(), versions.data(), deleted.data(), version_limit, filter.data(), effective.data(), not_clean.data(), rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            bool expected = versions[i] >= version_limit || ((handles[i] != handles[i + 1] || versions[i + 1] > version_limit) && !deleted[i]);
+            ASSERT_EQ(filter[i], expected) << i;
+            ASSERT_EQ(effective[i], expected && handles[i] != handles[i + 1]) << i;
+            ASSERT_EQ(not_clean[i], expected && (handles[i] == handles[i + 1] || deleted[i])) << i;
+        }
+    }
+}
+
 } // namespace tests
 } // namespace DM
 } // namespace DB
@@ -15,10 +15,16 @@
 #include <Common/Config/TOMLConfiguration.h>
 #include <Common/Exception.h>
 #include <Common/Logger.h>
+#include <Common/ProfileEvents.h>
 #include <Poco/Logger.h>
 #include <Poco/Util/LayeredConfiguration.h>
+#include <Storages/DeltaMerge/DMChecksumConfig.h>
+#include <Storages/DeltaMerge/DMSegmentThreadInputStream.h>
 #include <Storages/DeltaMerge/DeltaMergeStore.h>
+#include <Storages/DeltaMerge/File/DMFileBlockOutputStream.h>
 #include <Storages/DeltaMerge/Filter/RSOperator.h>
+#include <Storages/DeltaMerge/ReadStageProfile.h>
+#include <Storages/DeltaMerge/ReadThread/UnorderedInputStream.h>
 #include <Storages/DeltaMerge/workload/DTWorkload.h>
 #include <Storages/DeltaMerge/workload/DataGenerator.h>
 #include <Storages/DeltaMerge/workload/Handle.h>
@@ -32,8 +38,31 @@
 #include <TestUtils/TiFlashTestEnv.h>
 #include <cpptoml.h>
 
+#include <functional>
+#include <random>
+
+namespace ProfileEvents
+{
+extern const Event ReadBufferFromFileDescriptorReadBytes;
+} // namespace ProfileEvents
+
 namespace DB::DM::tests
 {
+namespace
+{
+ReadStageProfilePtr getReadStageProfile(const BlockInputStreams & streams)
+{
+    for (const auto & stream : streams)
+    {
+        if (auto * segment_stream = dynamic_cast<DMSegmentThreadInputStream *>(stream.get()); segment_stream != nullptr)
+            return segment_stream->getReadStageProfile();
+        if (auto * unordered_stream = dynamic_cast<UnorderedInputStream *>(stream.get()); unordered_stream != nullptr)
+            return unordered_stream->getReadStageProfile();
+    }
+    return nullptr;
+}
+} // namespace
+
 DB::Settings createSettings(const WorkloadOptions & opts)
 {
     DB::Settings settings;
@@ -184,13 +213,13 @@ void DTWorkload::write(ThreadStat & write_stat)
 }
 
 template <typename T>
-void DTWorkload::read(const ColumnDefines & columns, int stream_count, T func)
+ReadStageProfilePtr DTWorkload::read(const ColumnDefines & columns, int stream_count, bool is_fast_mode, T func)
 {
     auto ranges = {RowKeyRange::newAll(store->isCommonHandle(), store->getRowKeyColumnSize())};
     auto filter = EMPTY_FILTER;
     int excepted_block_size = 1024;
     uint64_t read_ts = ts_gen->get();
-    auto streams = store->read(*context, context->getSettingsRef(), columns, ranges, stream_count, read_ts, filter, "DTWorkload", false, opts->is_fast_mode, excepted_block_size);
+    auto streams = store->read(*context, context->getSettingsRef(), columns, ranges, stream_count, read_ts, filter, "DTWorkload", false, is_fast_mode, excepted_block_size);
     std::vector<std::thread> threads;
     threads.reserve(streams.size());
     for (auto & stream : streams)
@@ -201,6 +230,13 @@ void DTWorkload::read(const ColumnDefines & columns, int stream_count, T func)
     {
         t.join();
     }
+    return getReadStageProfile(streams);
+}
+
+void DTWorkload::addLatency(const std::string & name, uint64_t us)
+{
+    std::lock_guard lock(stat_mutex);
+    stat.latencies_us[name].push_back(us);
 }
 
 void DTWorkload::verifyHandle(uint64_t r)
@@ -249,7 +285,7 @@ void DTWorkload::verifyHandle(uint64_t r)
     try
     {
         Stopwatch sw;
-        read(columns, stream_count, verify);
+        read(columns, stream_count, opts->is_fast_mode, verify);
 
         auto handle_count = handle_table->count();
         if (read_count.load(std::memory_order_relaxed) != handle_count)
@@ -270,22 +306,39 @@ void DTWorkload::scanAll(ThreadStat & read_stat)
 {
     try
     {
-        while (writing_threads.load(std::memory_order_relaxed) > 0)
+        for (uint64_t i = 0; writing_threads.load(std::memory_order_relaxed) > 0; i++)
         {
             const auto & columns = store->getTableColumns();
             int stream_count = opts->read_stream_count;
+            // Alternate the modes so that both of them are measured under the same writes.
+            bool is_fast_mode = opts->mixed_read_mode ? (i % 2 == 1) : opts->is_fast_mode;
             std::atomic<uint64_t> read_count = 0;
-            auto count_row = [&read_count](BlockInputStreamPtr in, [[maybe_unused]] uint64_t read_ts) {
+            std::atomic<uint64_t> read_bytes = 0;
+            auto count_row = [&read_count, &read_bytes](BlockInputStreamPtr in, [[maybe_unused]] uint64_t read_ts) {
                 while (Block block = in->read())
                 {
                     read_count.fetch_add(block.rows(), std::memory_order_relaxed);
+                    read_bytes.fetch_add(block.bytes(), std::memory_order_relaxed);
                 }
             };
             Stopwatch sw;
-            read(columns, stream_count, count_row);
+            auto profile = read(columns, stream_count, is_fast_mode, count_row);
             read_stat.ms = sw.elapsedMilliseconds();
             read_stat.count = read_count;
-            LOG_FMT_INFO(log, "scanAll: columns {} streams {} read_stat {}", columns.size(), stream_count, read_stat.toString());
+            LOG_FMT_INFO(log, "scanAll: columns {} streams {} fast_mode {} read_stat {}", columns.size(), stream_count, is_fast_mode, read_stat.toString());
+
+            std::lock_guard lock(stat_mutex);
+            stat.latencies_us[is_fast_mode ? "scan_fast" : "scan_normal"].push_back(sw.elapsedMicroseconds());
+            stat.scan_bytes += read_bytes.load(std::memory_order_relaxed);
+            if (profile != nullptr)
+            {
+                // The time of a stage is accumulated by all the streams of the scan.
+                for (size_t s = 0; s < static_cast<size_t>(ReadStage::Count); s++)
+                {
+                    auto stage = static_cast<ReadStage>(s);
+                    stat.latencies_us[fmt::format("stage_{}", readStageToString(stage))].push_back(profile->get(stage) / 1000);
+                }
+            }
         }
     }
     catch (...)
@@ -295,8 +348,93 @@ void DTWorkload::scanAll(ThreadStat & read_stat)
     }
 }
 
+void DTWorkload::deleteRange(uint64_t start_key)
+{
+    auto range = RowKeyRange::fromHandleRange(HandleRange(start_key, start_key + opts->delete_range_keys));
+    store->deleteRange(*context, context->getSettingsRef(), range);
+}
+
+void DTWorkload::ingest(DataGenerator & data_gen, uint64_t start_key)
+{
+    auto [parent_path, file_id] = store->preAllocateIngestFile();
+    if (parent_path.empty())
+    {
+        return;
+    }
+
+    // The keys are consecutive, so the rows are sorted by the handle as the DMFile requires.
+    auto block = std::get<0>(data_gen.get(start_key));
+    {
+        auto columns = block.cloneEmptyColumns();
+        for (uint64_t key = start_key; key < start_key + opts->ingest_keys; key++)
+        {
+            auto row = std::get<0>(data_gen.get(key));
+            for (size_t i = 0; i < columns.size(); i++)
+            {
+                columns[i]->insertFrom(*row.getByPosition(i).column, 0);
+            }
+        }
+        block = block.cloneWithColumns(std::move(columns));
+    }
+
+    auto dmfile = DMFile::create(file_id, parent_path, false, DMChecksumConfig::fromDBContext(*context, false));
+    DMFileBlockOutputStream stream(*context, dmfile, *store->getStoreColumns());
+    DMFileBlockOutputStream::BlockProperty property;
+    property.not_clean_rows = 0;
+    property.effective_num_rows = block.rows();
+    property.gc_hint_version = std::numeric_limits<UInt64>::max();
+    stream.writePrefix();
+    stream.write(block, property);
+    stream.writeSuffix();
+
+    store->preIngestFile(parent_path, file_id, dmfile->getBytesOnDisk());
+    auto range = RowKeyRange::fromHandleRange(HandleRange(start_key, start_key + opts->ingest_keys));
+    store->ingestFiles(*context, context->getSettingsRef(), range, {file_id}, /*clear_data_in_range*/ true);
+}
+
+void DTWorkload::runBackgroundTasks()
+{
+    try
+    {
+        auto data_gen = DataGenerator::create(*opts, *table_info, *ts_gen);
+        std::vector<std::pair<std::string, std::function<void(uint64_t)>>> tasks;
+        if (opts->bg_merge_delta)
+        {
+            tasks.emplace_back("merge_delta", [this](uint64_t) { store->mergeDeltaAll(*context); });
+        }
+        if (opts->bg_delete_range)
+        {
+            tasks.emplace_back("delete_range", [this](uint64_t start_key) { deleteRange(start_key); });
+        }
+        if (opts->bg_ingest)
+        {
+            tasks.emplace_back("ingest", [this, &data_gen](uint64_t start_key) { ingest(*data_gen, start_key); });
+        }
+
+        std::mt19937_64 rand_gen{std::random_device{}()};
+        std::uniform_int_distribution<uint64_t> dist(0, opts->max_key_count - std::max(opts->delete_range_keys, opts->ingest_keys));
+        for (uint64_t i = 0; writing_threads.load(std::memory_order_relaxed) > 0; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(opts->bg_task_interval_ms));
+            const auto & [name, task] = tasks[i % tasks.size()];
+            auto start_key = dist(rand_gen);
+            Stopwatch sw;
+            task(start_key);
+            addLatency(name, sw.elapsedMicroseconds());
+            LOG_FMT_INFO(log, "runBackgroundTasks: {} start_key {} ms {}", name, start_key, sw.elapsedMilliseconds());
+        }
+    }
+    catch (...)
+    {
+        tryLogCurrentException("exception thrown in runBackgroundTasks");
+        throw;
+    }
+}
+
 void DTWorkload::run(uint64_t r)
 {
+    auto file_read_bytes = ProfileEvents::counters[ProfileEvents::ReadBufferFromFileDescriptorReadBytes].load(std::memory_order_relaxed);
+
     std::vector<std::thread> write_threads;
     for (uint64_t i = 0; i < opts->write_thread_count; i++)
     {
@@ -309,6 +447,12 @@ void DTWorkload::run(uint64_t r)
         read_threads.push_back(std::thread(&DTWorkload::scanAll, this, std::ref(stat.read_stats[i])));
     }
 
+    std::thread bg_task_thread;
+    if (opts->hasBackgroundTasks())
+    {
+        bg_task_thread = std::thread(&DTWorkload::runBackgroundTasks, this);
+    }
+
     for (auto & t : write_threads)
     {
         t.join();
@@ -317,6 +461,14 @@ void DTWorkload::run(uint64_t r)
     {
         t.join();
     }
+    if (bg_task_thread.joinable())
+    {
+        bg_task_thread.join();
+    }
+    {
+        std::lock_guard lock(stat_mutex);
+        stat.file_read_bytes += ProfileEvents::counters[ProfileEvents::ReadBufferFromFileDescriptorReadBytes].load(std::memory_order_relaxed) - file_read_bytes;
+    }
     if (opts->verification)
     {
         verifyHandle(r);
@@ -16,8 +16,11 @@
 
 #include <fmt/ranges.h>
 
+#include <algorithm>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -32,6 +35,8 @@ namespace DB::DM
 class DeltaMergeStore;
 struct ColumnDefine;
 using ColumnDefines = std::vector<ColumnDefine>;
+class ReadStageProfile;
+using ReadStageProfilePtr = std::shared_ptr<ReadStageProfile>;
 } // namespace DB::DM
 
 namespace Poco
@@ -95,6 +100,12 @@ public:
 
     uint64_t initMS() const { return init_ms; }
 
+    // The bytes read from files per byte returned by the scans, including the files read by the background tasks.
+    double readAmplification() const
+    {
+        return scan_bytes == 0 ? 0 : static_cast<double>(file_read_bytes) / scan_bytes;
+    }
+
     std::vector<std::string> toStrings() const
     {
         std::vector<std::string> v;
@@ -107,14 +118,41 @@ public:
         {
             v.push_back(fmt::format("read_{}: {}", i, read_stats[i].toString()));
         }
+        for (const auto & [name, latencies] : latencies_us)
+        {
+            v.push_back(fmt::format(
+                "latency_us {}: count {} p50 {} p90 {} p99 {} max {}",
+                name,
+                latencies.size(),
+                percentile(latencies, 0.5),
+                percentile(latencies, 0.9),
+                percentile(latencies, 0.99),
+                percentile(latencies, 1.0)));
+        }
+        v.push_back(fmt::format("read_amplification {:.2f} file_read_bytes {} scan_bytes {}", readAmplification(), file_read_bytes, scan_bytes));
         return v;
     }
 
+    // `p` in [0, 1], 0 if `latencies` is empty.
+    static uint64_t percentile(std::vector<uint64_t> latencies, double p)
+    {
+        if (latencies.empty())
+            return 0;
+        size_t n = std::min(static_cast<size_t>(latencies.size() * p), latencies.size() - 1);
+        std::nth_element(latencies.begin(), latencies.begin() + n, latencies.end());
+        return latencies[n];
+    }
+
 private:
     uint64_t init_ms;
     std::vector<ThreadStat> write_stats;
     std::vector<ThreadStat> read_stats;
 
+    // The latencies of the scans, the stages of the scans and the background tasks, keyed by the name of them.
+    std::map<std::string, std::vector<uint64_t>> latencies_us;
+    uint64_t file_read_bytes = 0;
+    uint64_t scan_bytes = 0;
+
     friend class DTWorkload;
 };
 
@@ -137,9 +175,15 @@ private:
     void write(ThreadStat & write_stat);
     void verifyHandle(uint64_t r);
     void scanAll(ThreadStat & read_stat);
+    // Run the background tasks of `WorkloadOptions::workload_profile` until the writing is done.
+    void runBackgroundTasks();
+    void deleteRange(uint64_t start_key);
+    // Ingest a DMFile of `WorkloadOptions::ingest_keys` keys starting from `start_key`, which replaces the data in the range.
+    void ingest(DataGenerator & data_gen, uint64_t start_key);
     template <typename T>
-    void read(const ColumnDefines & columns, int stream_count, T func);
+    ReadStageProfilePtr read(const ColumnDefines & columns, int stream_count, bool is_fast_mode, T func);
     uint64_t updateBlock(Block & block, uint64_t key);
+    void addLatency(const std::string & name, uint64_t us);
 
     Poco::Logger * log;
 
@@ -155,6 +199,8 @@ private:
 
     std::atomic<int> writing_threads;
 
+    // Protect the latencies and bytes of `stat`, which are updated by the read threads and background tasks.
+    std::mutex stat_mutex;
     Statistics stat;
 };
 } // namespace DB::DM::tests
@@ -48,7 +48,11 @@ std::string WorkloadOptions::toString(std::string seperator) const
         fmt::format("bg_thread_count {}{}", bg_thread_count, seperator) + //
         fmt::format("table_id {}{}", table_id, seperator) + //
         fmt::format("table_name {}{}", table_name, seperator) + //
-        fmt::format("is_fast_mode {}{}", is_fast_mode, seperator);
+        fmt::format("is_fast_mode {}{}", is_fast_mode, seperator) + //
+        fmt::format("workload_profile {}{}", workload_profile, seperator) + //
+        fmt::format("bg_task_interval_ms {}{}", bg_task_interval_ms, seperator) + //
+        fmt::format("delete_range_keys {}{}", delete_range_keys, seperator) + //
+        fmt::format("ingest_keys {}{}", ingest_keys, seperator);
 }
 
 std::pair<bool, std::string> WorkloadOptions::parseOptions(int argc, char * argv[])
@@ -96,6 +100,11 @@ std::pair<bool, std::string> WorkloadOptions::parseOptions(int argc, char * argv
         ("table_name", value<std::string>()->default_value(""), "") //
         ("table_id", value<int64_t>()->default_value(-1), "") //
         ("is_fast_mode", value<bool>()->default_value(false), "default is false, means normal mode. When we in fast mode, we should set verification as false") //
+        //
+        ("workload_profile", value<std::string>()->default_value("write_scan"), "write_scan/scan_under_write/merge_delta_under_read/delete_range_under_read/ingest_under_read/mixed") //
+        ("bg_task_interval_ms", value<uint64_t>()->default_value(1000), "Interval of the background tasks of the workload profile") //
+        ("delete_range_keys", value<uint64_t>()->default_value(1000), "Count of keys deleted by each delete range task") //
+        ("ingest_keys", value<uint64_t>()->default_value(10000), "Count of keys ingested by each ingest task") //
         ;
 
     boost::program_options::variables_map vm;
@@ -183,6 +192,48 @@ std::pair<bool, std::string> WorkloadOptions::parseOptions(int argc, char * argv
         return {false, fmt::format("When in_fast_mode, we should set verification as false")};
     }
 
+    workload_profile = vm["workload_profile"].as<std::string>();
+    bg_task_interval_ms = vm["bg_task_interval_ms"].as<uint64_t>();
+    delete_range_keys = vm["delete_range_keys"].as<uint64_t>();
+    ingest_keys = vm["ingest_keys"].as<uint64_t>();
+    if (workload_profile == "scan_under_write")
+    {
+        mixed_read_mode = true;
+    }
+    else if (workload_profile == "merge_delta_under_read")
+    {
+        bg_merge_delta = true;
+    }
+    else if (workload_profile == "delete_range_under_read")
+    {
+        bg_delete_range = true;
+    }
+    else if (workload_profile == "ingest_under_read")
+    {
+        bg_ingest = true;
+    }
+    else if (workload_profile == "mixed")
+    {
+        mixed_read_mode = true;
+        bg_merge_delta = true;
+        bg_delete_range = true;
+        bg_ingest = true;
+    }
+    else if (workload_profile != "write_scan")
+    {
+        return {false, fmt::format("unknown workload_profile {}.", workload_profile)};
+    }
+
+    // The data deleted or ingested by the background tasks is not recorded in the handle table.
+    if ((bg_delete_range || bg_ingest) && verification)
+    {
+        return {false, fmt::format("When workload_profile is {}, we should set verification as false", workload_profile)};
+    }
+    if ((bg_delete_range && delete_range_keys == 0) || (bg_ingest && (ingest_keys == 0 || ingest_keys > max_key_count)))
+    {
+        return {false, fmt::format("Invalid delete_range_keys {} or ingest_keys {}.", delete_range_keys, ingest_keys)};
+    }
+
     return {true, toString()};
 }
 
@@ -64,6 +64,21 @@ struct WorkloadOptions
 
     bool is_fast_mode;
 
+    // write_scan/scan_under_write/merge_delta_under_read/delete_range_under_read/ingest_under_read/mixed
+    std::string workload_profile;
+    uint64_t bg_task_interval_ms;
+    uint64_t delete_range_keys;
+    uint64_t ingest_keys;
+
+    // Parsed from `workload_profile`.
+    // Whether the scans alternate between the normal mode and the fast mode, instead of following `is_fast_mode`.
+    bool mixed_read_mode = false;
+    bool bg_merge_delta = false;
+    bool bg_delete_range = false;
+    bool bg_ingest = false;
+
+    bool hasBackgroundTasks() const { return bg_merge_delta || bg_delete_range || bg_ingest; }
+
     std::string toString(std::string seperator = "\n") const;
     std::pair<bool, std::string> parseOptions(int argc, char * argv[]);
     void initFailpoints() const;
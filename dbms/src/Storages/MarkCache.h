@@ -14,8 +14,8 @@
 
 #pragma once
 
-#include <Common/LRUCache.h>
 #include <Common/ProfileEvents.h>
+#include <Common/ShardedSLRUCache.h>
 #include <Common/SipHash.h>
 #include <DataStreams/MarkInCompressedFile.h>
 #include <Interpreters/AggregationCommon.h>
@@ -44,11 +44,12 @@ struct MarksWeightFunction
 
 /** Cache of 'marks' for StorageMergeTree.
   * Marks is an index structure that addresses ranges in column file, corresponding to ranges of primary key.
+  * It is accessed by every read thread, so it is sharded and resistant to full table scans, see `ShardedSLRUCache`.
   */
-class MarkCache : public LRUCache<String, MarksInCompressedFile, std::hash<String>, MarksWeightFunction>
+class MarkCache : public ShardedSLRUCache<String, MarksInCompressedFile, std::hash<String>, MarksWeightFunction>
 {
 private:
-    using Base = LRUCache<String, MarksInCompressedFile, std::hash<String>, MarksWeightFunction>;
+    using Base = ShardedSLRUCache<String, MarksInCompressedFile, std::hash<String>, MarksWeightFunction>;
 
 public:
     MarkCache(size_t max_size_in_bytes, const Delay & expiration_delay)
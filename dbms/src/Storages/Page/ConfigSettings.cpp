@@ -36,7 +36,11 @@ void mergeConfigFromSettings(const DB::Settings & settings, PageStorage::Config
 
     // V3 setting which export to global setting
     config.blob_heavy_gc_valid_rate = settings.dt_storage_blob_heavy_gc_valid_rate;
+    config.blob_heavy_gc_max_bytes_per_round = settings.dt_storage_blob_heavy_gc_max_bytes_per_round;
     config.blob_block_alignment_bytes = settings.dt_storage_blob_block_alignment_bytes;
+    config.blob_page_cache_size = settings.dt_storage_page_cache_size;
+    config.blob_prealloc_bytes = settings.dt_storage_blob_prealloc_bytes;
+    config.restore_concurrency = settings.dt_storage_restore_concurrency;
 }
 
 PageStorage::Config getConfigFromSettings(const DB::Settings & settings)
@@ -298,6 +298,8 @@ public:
             statistics_total.longest_living_from_thread_id = statistics_from_v3.longest_living_from_thread_id;
             statistics_total.longest_living_from_tracing_id = statistics_from_v3.longest_living_from_tracing_id;
         }
+        statistics_total.most_pinned_bytes = statistics_from_v3.most_pinned_bytes;
+        statistics_total.most_pinned_from_tracing_id = statistics_from_v3.most_pinned_from_tracing_id;
 
         return statistics_total;
     }
@@ -139,12 +139,18 @@ public:
         SettingUInt64 blob_spacemap_type = 2;
         SettingUInt64 blob_cached_fd_size = BLOBSTORE_CACHED_FD_SIZE;
         SettingDouble blob_heavy_gc_valid_rate = 0.5;
+        SettingUInt64 blob_heavy_gc_max_bytes_per_round = 0;
         SettingUInt64 blob_block_alignment_bytes = 0;
+        SettingUInt64 blob_page_cache_size = 0;
+        SettingUInt64 blob_prealloc_bytes = 0;
 
         SettingUInt64 wal_roll_size = PAGE_META_ROLL_SIZE;
         SettingUInt64 wal_recover_mode = static_cast<UInt64>(WALRecoveryMode::TolerateCorruptedTailRecords);
         SettingUInt64 wal_max_persisted_log_files = MAX_PERSISTED_LOG_FILES;
 
+        // The number of threads for decoding WAL files and restoring blob space maps when restoring, 1 means restoring in the current thread.
+        SettingUInt64 restore_concurrency = 1;
+
         void reload(const Config & rhs)
         {
             // Reload is not atomic, but should be good enough
@@ -164,11 +170,15 @@ public:
             blob_spacemap_type = rhs.blob_spacemap_type;
             blob_cached_fd_size = rhs.blob_cached_fd_size;
             blob_heavy_gc_valid_rate = rhs.blob_heavy_gc_valid_rate;
+            blob_heavy_gc_max_bytes_per_round = rhs.blob_heavy_gc_max_bytes_per_round;
             blob_block_alignment_bytes = rhs.blob_block_alignment_bytes;
+            blob_page_cache_size = rhs.blob_page_cache_size;
+            blob_prealloc_bytes = rhs.blob_prealloc_bytes;
 
             wal_roll_size = rhs.wal_roll_size;
             wal_recover_mode = rhs.wal_recover_mode;
             wal_max_persisted_log_files = rhs.wal_max_persisted_log_files;
+            restore_concurrency = rhs.restore_concurrency;
         }
 
         String toDebugStringV2() const
@@ -193,16 +203,20 @@ public:
             return fmt::format(
                 "PageStorage::Config V3 {{"
                 "blob_file_limit_size: {}, blob_spacemap_type: {}, "
-                "blob_cached_fd_size: {}, blob_heavy_gc_valid_rate: {:.3f}, blob_block_alignment_bytes: {}, "
-                "wal_roll_size: {}, wal_recover_mode: {}, wal_max_persisted_log_files: {}}}",
+                "blob_cached_fd_size: {}, blob_heavy_gc_valid_rate: {:.3f}, blob_heavy_gc_max_bytes_per_round: {}, blob_block_alignment_bytes: {}, blob_page_cache_size: {}, blob_prealloc_bytes: {}, "
+                "wal_roll_size: {}, wal_recover_mode: {}, wal_max_persisted_log_files: {}, restore_concurrency: {}}}",
                 blob_file_limit_size.get(),
                 blob_spacemap_type.get(),
                 blob_cached_fd_size.get(),
                 blob_heavy_gc_valid_rate.get(),
+                blob_heavy_gc_max_bytes_per_round.get(),
                 blob_block_alignment_bytes.get(),
+                blob_page_cache_size.get(),
+                blob_prealloc_bytes.get(),
                 wal_roll_size.get(),
                 wal_recover_mode.get(),
-                wal_max_persisted_log_files.get());
+                wal_max_persisted_log_files.get(),
+                restore_concurrency.get());
         }
     };
     void reloadSettings(const Config & new_config) { config.reload(new_config); };
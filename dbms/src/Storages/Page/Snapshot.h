@@ -26,6 +26,9 @@ struct SnapshotsStatistics
     double longest_living_seconds = 0.0;
     unsigned longest_living_from_thread_id = 0;
     String longest_living_from_tracing_id;
+    // The snapshot pinning the most bytes of outdated pages, updated by the in-memory MVCC gc.
+    UInt64 most_pinned_bytes = 0;
+    String most_pinned_from_tracing_id;
 };
 class PageStorageSnapshot
 {
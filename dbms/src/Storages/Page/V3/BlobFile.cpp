@@ -12,9 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/Logger.h>
 #include <Encryption/WriteReadableFile.h>
 #include <Storages/Page/PageUtil.h>
 #include <Storages/Page/V3/BlobFile.h>
+#include <common/logger_useful.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
 
 namespace DB
 {
@@ -28,11 +34,13 @@ namespace PS::V3
 BlobFile::BlobFile(String parent_path_,
                    BlobFileId blob_id_,
                    FileProviderPtr file_provider_,
-                   PSDiskDelegatorPtr delegator_)
+                   PSDiskDelegatorPtr delegator_,
+                   UInt64 prealloc_bytes_)
     : blob_id(blob_id_)
     , file_provider{std::move(file_provider_)}
     , delegator(std::move(delegator_))
     , parent_path(std::move(parent_path_))
+    , prealloc_bytes(prealloc_bytes_)
 {
     Poco::File file_in_disk(getPath());
     wrfile = file_provider->newWriteReadableFile(
@@ -42,6 +50,7 @@ BlobFile::BlobFile(String parent_path_,
         /*create_new_encryption_info_*/ !file_in_disk.exists());
 
     file_size = file_in_disk.getSize();
+    preallocated_end = file_size;
     {
         std::lock_guard lock(file_size_lock);
 
@@ -90,6 +99,8 @@ void BlobFile::write(char * buffer, size_t offset, size_t size, const WriteLimit
                                   ErrorCodes::FAIL_POINT_ERROR);
               });
 
+    preallocate(offset + size);
+
 #ifndef NDEBUG
     PageUtil::writeFile(wrfile, offset, buffer, size, write_limiter, background, /*truncate_if_failed=*/false, /*enable_failpoint=*/true);
 #else
@@ -116,6 +127,29 @@ void BlobFile::write(char * buffer, size_t offset, size_t size, const WriteLimit
     }
 }
 
+void BlobFile::preallocate(size_t end)
+{
+#ifdef __linux__
+    std::lock_guard lock(file_size_lock);
+    if (prealloc_bytes == 0 || end <= preallocated_end)
+        return;
+
+    const size_t begin = std::max(preallocated_end, file_size);
+    const size_t new_end = end + prealloc_bytes;
+    if (::fallocate(wrfile->getFd(), FALLOC_FL_KEEP_SIZE, begin, new_end - begin) != 0)
+    {
+        // Not supported by the file system or out of space, just write without preallocation. The
+        // real error of writing (if any) is thrown by the write itself.
+        LOG_FMT_WARNING(Logger::get("BlobFile"), "Disable preallocation of blob file [path={}] [begin={}] [size={}] [errno={}]", getPath(), begin, new_end - begin, errno);
+        prealloc_bytes = 0;
+        return;
+    }
+    preallocated_end = new_end;
+#else
+    (void)end;
+#endif
+}
+
 void BlobFile::truncate(size_t size)
 {
     PageUtil::ftruncateFile(wrfile, size);
@@ -125,6 +159,8 @@ void BlobFile::truncate(size_t size)
         assert(size <= file_size);
         shrink_size = file_size - size;
         file_size = size;
+        // The space reserved beyond the end of file is released by truncating.
+        preallocated_end = size;
     }
     delegator->freePageFileUsedSize(std::make_pair(blob_id, 0), shrink_size, parent_path);
 }
@@ -35,7 +35,8 @@ public:
     BlobFile(String parent_path_,
              BlobFileId blob_id_,
              FileProviderPtr file_provider_,
-             PSDiskDelegatorPtr delegator_);
+             PSDiskDelegatorPtr delegator_,
+             UInt64 prealloc_bytes_ = 0);
 
     ~BlobFile();
 
@@ -57,6 +58,11 @@ public:
 
     void remove();
 
+private:
+    /// Reserve the disk space up to `end` plus `prealloc_bytes` beyond the end of file, without changing the file size,
+    /// so that the appending writes do not allocate the blocks one by one.
+    void preallocate(size_t end);
+
 private:
     const BlobFileId blob_id;
 
@@ -68,6 +74,10 @@ private:
 
     std::mutex file_size_lock;
     BlobFileOffset file_size;
+    /// The end of the space reserved by `preallocate`, protected by `file_size_lock`.
+    BlobFileOffset preallocated_end;
+    /// 0 means preallocation is disabled or not supported by the file system.
+    UInt64 prealloc_bytes;
 };
 using BlobFilePtr = std::shared_ptr<BlobFile>;
 
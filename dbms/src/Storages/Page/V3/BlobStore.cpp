@@ -27,12 +27,14 @@
 #include <Storages/Page/V3/PageDirectory.h>
 #include <Storages/Page/V3/PageEntriesEdit.h>
 #include <Storages/Page/V3/PageEntry.h>
+#include <common/ThreadPool.h>
 #include <common/logger_useful.h>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <ext/scope_guard.h>
 #include <iterator>
+#include <limits>
 #include <mutex>
 
 namespace ProfileEvents
@@ -75,6 +77,7 @@ BlobStore::BlobStore(String storage_name, const FileProviderPtr & file_provider_
     , log(Logger::get("BlobStore", std::move(storage_name)))
     , blob_stats(log, delegator, config_)
     , cached_files(config.cached_fd_size)
+    , page_cache(config.page_cache_size > 0 ? std::make_unique<PageCache>(config.page_cache_size) : nullptr)
 {
 }
 
@@ -401,6 +404,10 @@ void BlobStore::remove(const PageEntriesV3 & del_entries)
             continue;
         }
 
+        // The space is going to be reused
+        if (page_cache)
+            page_cache->remove(entry);
+
         try
         {
             removePosFromStats(entry.file_id, entry.offset, entry.getTotalSize());
@@ -593,11 +600,12 @@ PageMap BlobStore::read(FieldReadInfos & to_read, const ReadLimiterPtr & read_li
 
     ProfileEvents::increment(ProfileEvents::PSMReadPages, to_read.size());
 
-    // Sort in ascending order by offset in file.
+    // Sort in ascending order by the position in files, so that the adjacent fields of the
+    // pages in the same blob file are placed next to each other in `data_buf`.
     std::sort(
         to_read.begin(),
         to_read.end(),
-        [](const FieldReadInfo & a, const FieldReadInfo & b) { return a.entry.offset < b.entry.offset; });
+        [](const FieldReadInfo & a, const FieldReadInfo & b) { return std::tie(a.entry.file_id, a.entry.offset) < std::tie(b.entry.file_id, b.entry.offset); });
 
     // allocate data_buf that can hold all pages with specify fields
 
@@ -624,8 +632,53 @@ PageMap BlobStore::read(FieldReadInfos & to_read, const ReadLimiterPtr & read_li
         free(p, buf_size);
     });
 
-    std::set<Page::FieldOffset> fields_offset_in_page;
+    // The fields which are continuous both in the blob file and in `data_buf` are merged
+    // into one range and read by one system call.
+    PageIdV3Internal range_page_id = buildV3Id(0, 0);
+    BlobFileId range_file_id = INVALID_BLOBFILE_ID;
+    BlobFileOffset range_offset = 0;
+    char * range_buf = nullptr;
+    size_t range_size = 0;
+    auto flush_range = [&]() {
+        if (range_size == 0)
+            return;
+        read(range_page_id, range_file_id, range_offset, range_buf, range_size, read_limiter);
+        range_size = 0;
+    };
+
     char * pos = data_buf;
+    for (const auto & [page_id_v3, entry, fields] : to_read)
+    {
+        // The fields are copied from the whole page if it is cached
+        auto cached = page_cache ? page_cache->get(entry) : nullptr;
+        for (const auto field_index : fields)
+        {
+            const auto [beg_offset, end_offset] = entry.getFieldOffsets(field_index);
+            const auto size_to_read = end_offset - beg_offset;
+            if (cached)
+            {
+                memcpy(pos, cached->data.data() + beg_offset, size_to_read);
+            }
+            else if (range_size != 0 && range_file_id == entry.file_id && range_offset + range_size == entry.offset + beg_offset && range_buf + range_size == pos)
+            {
+                range_size += size_to_read;
+            }
+            else
+            {
+                flush_range();
+                range_page_id = page_id_v3;
+                range_file_id = entry.file_id;
+                range_offset = entry.offset + beg_offset;
+                range_buf = pos;
+                range_size = size_to_read;
+            }
+            pos += size_to_read;
+        }
+    }
+    flush_range();
+
+    std::set<Page::FieldOffset> fields_offset_in_page;
+    pos = data_buf;
     PageMap page_map;
     for (const auto & [page_id_v3, entry, fields] : to_read)
     {
@@ -633,10 +686,8 @@ PageMap BlobStore::read(FieldReadInfos & to_read, const ReadLimiterPtr & read_li
         char * write_offset = pos;
         for (const auto field_index : fields)
         {
-            // TODO: Continuously fields can read by one system call.
             const auto [beg_offset, end_offset] = entry.getFieldOffsets(field_index);
             const auto size_to_read = end_offset - beg_offset;
-            auto blob_file = read(page_id_v3, entry.file_id, entry.offset + beg_offset, write_offset, size_to_read, read_limiter);
             fields_offset_in_page.emplace(field_index, read_size_this_entry);
 
             if constexpr (BLOBSTORE_CHECKSUM_ON_READ)
@@ -659,7 +710,7 @@ PageMap BlobStore::read(FieldReadInfos & to_read, const ReadLimiterPtr & read_li
                                     beg_offset,
                                     size_to_read,
                                     toDebugString(entry),
-                                    blob_file->getPath()),
+                                    getBlobFile(entry.file_id)->getPath()),
                         ErrorCodes::CHECKSUM_DOESNT_MATCH);
                 }
             }
@@ -696,14 +747,31 @@ PageMap BlobStore::read(PageIDAndEntriesV3 & entries, const ReadLimiterPtr & rea
 
     ProfileEvents::increment(ProfileEvents::PSMReadPages, entries.size());
 
+    PageMap page_map;
+    // Serve the cached pages, and only read the rest from disk
+    PageIDAndEntriesV3 entries_not_cached;
+    if (page_cache)
+    {
+        for (const auto & [page_id_v3, entry] : entries)
+        {
+            if (auto cached = page_cache->get(entry); cached)
+                page_map.emplace(page_id_v3.low, PageCache::toPage(page_id_v3.low, cached));
+            else
+                entries_not_cached.emplace_back(page_id_v3, entry);
+        }
+        if (entries_not_cached.empty())
+            return page_map;
+    }
+    auto & entries_to_read = page_cache ? entries_not_cached : entries;
+
     // Sort in ascending order by offset in file.
-    std::sort(entries.begin(), entries.end(), [](const PageIDAndEntryV3 & a, const PageIDAndEntryV3 & b) {
+    std::sort(entries_to_read.begin(), entries_to_read.end(), [](const PageIDAndEntryV3 & a, const PageIDAndEntryV3 & b) {
         return a.second.offset < b.second.offset;
     });
 
     // allocate data_buf that can hold all pages
     size_t buf_size = 0;
-    for (const auto & p : entries)
+    for (const auto & p : entries_to_read)
     {
         buf_size += p.second.size;
     }
@@ -712,8 +780,7 @@ PageMap BlobStore::read(PageIDAndEntriesV3 & entries, const ReadLimiterPtr & rea
     // The `buf_size` will be 0, we need avoid calling malloc/free with size 0.
     if (buf_size == 0)
     {
-        PageMap page_map;
-        for (const auto & [page_id_v3, entry] : entries)
+        for (const auto & [page_id_v3, entry] : entries_to_read)
         {
             (void)entry;
             LOG_FMT_DEBUG(log, "Read entry [page_id={}] without entry size.", page_id_v3);
@@ -730,8 +797,7 @@ PageMap BlobStore::read(PageIDAndEntriesV3 & entries, const ReadLimiterPtr & rea
     });
 
     char * pos = data_buf;
-    PageMap page_map;
-    for (const auto & [page_id_v3, entry] : entries)
+    for (const auto & [page_id_v3, entry] : entries_to_read)
     {
         auto blob_file = read(page_id_v3, entry.file_id, entry.offset, pos, entry.size, read_limiter);
 
@@ -753,6 +819,9 @@ PageMap BlobStore::read(PageIDAndEntriesV3 & entries, const ReadLimiterPtr & rea
             }
         }
 
+        if (page_cache)
+            page_cache->set(entry, pos);
+
         Page page;
         page.page_id = page_id_v3.low;
         page.data = ByteBuffer(pos, pos + entry.size);
@@ -793,6 +862,12 @@ Page BlobStore::read(const PageIDAndEntryV3 & id_entry, const ReadLimiterPtr & r
         return page;
     }
 
+    if (page_cache)
+    {
+        if (auto cached = page_cache->get(entry); cached)
+            return PageCache::toPage(page_id_v3.low, cached);
+    }
+
     char * data_buf = static_cast<char *>(alloc(buf_size));
     MemHolder mem_holder = createMemHolder(data_buf, [&, buf_size](char * p) {
         free(p, buf_size);
@@ -817,6 +892,9 @@ Page BlobStore::read(const PageIDAndEntryV3 & id_entry, const ReadLimiterPtr & r
         }
     }
 
+    if (page_cache)
+        page_cache->set(entry, data_buf);
+
     Page page;
     page.page_id = page_id_v3.low;
     page.data = ByteBuffer(data_buf, data_buf + buf_size);
@@ -847,11 +925,12 @@ struct BlobStoreGCInfo
 {
     String toString() const
     {
-        return fmt::format("{}. {}. {}. {}. {}.",
+        return fmt::format("{}. {}. {}. {}. {}. {}.",
                            toTypeString("Read-Only Blob", 0),
                            toTypeString("No GC Blob", 1),
                            toTypeString("Full GC Blob", 2),
                            toTypeString("Big Blob", 3),
+                           toTypeString("Deferred GC Blob", 4),
                            toTypeTruncateString("Truncated Blob"));
     }
 
@@ -875,6 +954,11 @@ struct BlobStoreGCInfo
         blob_gc_info[3].emplace_back(std::make_pair(blob_id, valid_rate));
     }
 
+    void appendToDeferredGCBlob(const BlobFileId blob_id, double valid_rate)
+    {
+        blob_gc_info[4].emplace_back(std::make_pair(blob_id, valid_rate));
+    }
+
     void appendToTruncatedBlob(const BlobFileId blob_id, UInt64 origin_size, UInt64 truncated_size, double valid_rate)
     {
         blob_gc_truncate_info.emplace_back(std::make_tuple(blob_id, origin_size, truncated_size, valid_rate));
@@ -885,7 +969,8 @@ private:
     // 2. no need gc blob
     // 3. full gc blob
     // 4. big blob
-    std::vector<std::pair<BlobFileId, double>> blob_gc_info[4];
+    // 5. need gc blob but deferred to the next rounds
+    std::vector<std::pair<BlobFileId, double>> blob_gc_info[5];
 
     std::vector<std::tuple<BlobFileId, UInt64, UInt64, double>> blob_gc_truncate_info;
 
@@ -945,6 +1030,7 @@ std::vector<BlobFileId> BlobStore::getGCStats()
     // Get a copy of stats map to avoid the big lock on stats map
     const auto stats_list = blob_stats.getStats();
     std::vector<BlobFileId> blob_need_gc;
+    std::vector<BlobStatPtr> blob_gc_candidates;
     BlobStoreGCInfo blobstore_gc_info;
 
     fiu_do_on(FailPoints::force_change_all_blobs_to_read_only,
@@ -1023,11 +1109,7 @@ std::vector<BlobFileId> BlobStore::getGCStats()
             if (stat->sm_valid_rate <= config.heavy_gc_valid_rate)
             {
                 LOG_FMT_TRACE(log, "Current [blob_id={}] valid rate is {:.2f}, Need do compact GC", stat->id, stat->sm_valid_rate);
-                blob_need_gc.emplace_back(stat->id);
-
-                // Change current stat to read only
-                stat->changeToReadOnly();
-                blobstore_gc_info.appendToNeedGCBlob(stat->id, stat->sm_valid_rate);
+                blob_gc_candidates.emplace_back(stat);
             }
             else
             {
@@ -1048,7 +1130,36 @@ std::vector<BlobFileId> BlobStore::getGCStats()
         }
     }
 
-    LOG_FMT_INFO(log, "BlobStore gc get status done. gc info: {}", blobstore_gc_info.toString());
+    // Pick the blobs that reclaim more space per copied byte first, until the valid bytes to be copied
+    // reach `heavy_gc_max_bytes_per_round`. So that one round of heavy gc does not compete with the
+    // foreground IO for too long. The rest blobs are kept writable and will be checked in the next rounds.
+    auto reclaim_ratio = [](const BlobStatPtr & stat) {
+        if (stat->sm_valid_size == 0)
+            return std::numeric_limits<double>::max();
+        return 1.0 * (stat->sm_total_size - stat->sm_valid_size) / stat->sm_valid_size;
+    };
+    std::sort(blob_gc_candidates.begin(), blob_gc_candidates.end(), [&](const BlobStatPtr & lhs, const BlobStatPtr & rhs) {
+        return reclaim_ratio(lhs) > reclaim_ratio(rhs);
+    });
+    const UInt64 max_bytes_per_round = config.heavy_gc_max_bytes_per_round;
+    UInt64 bytes_to_migrate = 0;
+    for (const auto & stat : blob_gc_candidates)
+    {
+        // Always pick at least one blob, or the gc can not make any progress
+        if (max_bytes_per_round != 0 && !blob_need_gc.empty() && bytes_to_migrate + stat->sm_valid_size > max_bytes_per_round)
+        {
+            blobstore_gc_info.appendToDeferredGCBlob(stat->id, stat->sm_valid_rate);
+            continue;
+        }
+        bytes_to_migrate += stat->sm_valid_size;
+        blob_need_gc.emplace_back(stat->id);
+
+        // Change current stat to read only
+        stat->changeToReadOnly();
+        blobstore_gc_info.appendToNeedGCBlob(stat->id, stat->sm_valid_rate);
+    }
+
+    LOG_FMT_INFO(log, "BlobStore gc get status done. [bytes_to_migrate={}] gc info: {}", bytes_to_migrate, blobstore_gc_info.toString());
 
     return blob_need_gc;
 }
@@ -1201,7 +1312,7 @@ String BlobStore::getBlobFileParentPath(BlobFileId blob_id)
 BlobFilePtr BlobStore::getBlobFile(BlobFileId blob_id)
 {
     return cached_files.getOrSet(blob_id, [this, blob_id]() -> BlobFilePtr {
-                           return std::make_shared<BlobFile>(getBlobFileParentPath(blob_id), blob_id, file_provider, delegator);
+                           return std::make_shared<BlobFile>(getBlobFileParentPath(blob_id), blob_id, file_provider, delegator, config.prealloc_bytes);
                        })
         .first;
 }
@@ -1255,19 +1366,27 @@ std::pair<BlobFileId, String> BlobStore::BlobStats::getBlobIdFromName(String blo
     return {INVALID_BLOBFILE_ID, err_msg};
 }
 
-void BlobStore::BlobStats::restore()
+void BlobStore::BlobStats::restore(size_t concurrency)
 {
     BlobFileId max_restored_file_id = 0;
 
+    std::unique_ptr<::ThreadPool> pool;
+    if (concurrency > 1)
+        pool = std::make_unique<::ThreadPool>(concurrency);
     for (auto & [path, stats] : stats_map)
     {
         (void)path;
         for (const auto & stat : stats)
         {
-            stat->recalculateSpaceMap();
+            if (pool)
+                pool->schedule([stat] { stat->recalculateSpaceMap(); });
+            else
+                stat->recalculateSpaceMap();
             max_restored_file_id = std::max(stat->id, max_restored_file_id);
         }
     }
+    if (pool)
+        pool->wait();
 
     // restore `roll_id`
     roll_id = max_restored_file_id + 1;
@@ -19,6 +19,7 @@
 #include <Interpreters/SettingsCommon.h>
 #include <Storages/Page/FileUsage.h>
 #include <Storages/Page/V3/BlobFile.h>
+#include <Storages/Page/V3/PageCache.h>
 #include <Storages/Page/V3/PageEntriesEdit.h>
 #include <Storages/Page/V3/PageEntry.h>
 #include <Storages/Page/V3/spacemap/SpaceMap.h>
@@ -47,18 +48,28 @@ public:
         SettingUInt64 cached_fd_size = BLOBSTORE_CACHED_FD_SIZE;
         SettingUInt64 block_alignment_bytes = 0;
         SettingDouble heavy_gc_valid_rate = 0.2;
+        // Limit the valid bytes of the blobs migrated by one round of heavy gc, 0 means unlimited.
+        SettingUInt64 heavy_gc_max_bytes_per_round = 0;
+        // The max bytes of `page_cache`, 0 means disabled.
+        SettingUInt64 page_cache_size = 0;
+        // The bytes reserved beyond the end of a blob file by fallocate before appending to it, 0 means disabled.
+        SettingUInt64 prealloc_bytes = 0;
 
         String toString()
         {
             return fmt::format("BlobStore Config Info: "
                                "[file_limit_size={}],[spacemap_type={}],"
                                "[cached_fd_size={}],[block_alignment_bytes={}],"
-                               "[heavy_gc_valid_rate={}]",
+                               "[heavy_gc_valid_rate={}],[heavy_gc_max_bytes_per_round={}],"
+                               "[page_cache_size={}],[prealloc_bytes={}]",
                                file_limit_size,
                                spacemap_type,
                                cached_fd_size,
                                block_alignment_bytes,
-                               heavy_gc_valid_rate);
+                               heavy_gc_valid_rate,
+                               heavy_gc_max_bytes_per_round,
+                               page_cache_size,
+                               prealloc_bytes);
         }
     };
 
@@ -235,7 +246,8 @@ public:
     private:
 #endif
         void restoreByEntry(const PageEntryV3 & entry);
-        void restore();
+        // Recalculate the space maps after restoring by entries, by `concurrency` threads.
+        void restore(size_t concurrency = 1);
         friend class PageDirectoryFactory;
 
 #ifndef DBMS_PUBLIC_GTEST
@@ -332,6 +344,9 @@ private:
     BlobStats blob_stats;
 
     DB::LRUCache<BlobFileId, BlobFile> cached_files;
+
+    // Cache of the small pages, nullptr if disabled
+    PageCachePtr page_cache;
 };
 using BlobStorePtr = std::shared_ptr<BlobStore>;
 
@@ -0,0 +1,115 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Common/LRUCache.h>
+#include <Common/TiFlashMetrics.h>
+#include <Storages/Page/Page.h>
+#include <Storages/Page/V3/PageEntry.h>
+#include <common/types.h>
+
+#include <memory>
+
+namespace DB::PS::V3
+{
+// The location of a page in the blob files
+struct PageCacheKey
+{
+    BlobFileId file_id;
+    BlobFileOffset offset;
+
+    bool operator==(const PageCacheKey & rhs) const { return file_id == rhs.file_id && offset == rhs.offset; }
+};
+
+struct PageCacheKeyHash
+{
+    size_t operator()(const PageCacheKey & key) const { return std::hash<UInt64>()(key.file_id) ^ (std::hash<UInt64>()(key.offset) << 1); }
+};
+
+struct CachedPage
+{
+    // The checksum of `data`, used to check whether the cached data is the one `PageEntryV3` points to.
+    UInt64 checksum = 0;
+    String data;
+};
+
+struct CachedPageWeightFunction
+{
+    size_t operator()(const CachedPage & page) const { return sizeof(CachedPage) + page.data.size(); }
+};
+
+/** Cache the data of the small and hot pages read from the blob files, such as the tiny column files in
+  * the delta layer and the meta of segments.
+  * It is keyed by the location of the page in the blob files. The entries moved by GC are cached as new
+  * pages, and the locations are invalidated when they are removed from BlobStore, so that they will not
+  * be served when the space is reused.
+  */
+class PageCache : public LRUCache<PageCacheKey, CachedPage, PageCacheKeyHash, CachedPageWeightFunction>
+{
+private:
+    using Base = LRUCache<PageCacheKey, CachedPage, PageCacheKeyHash, CachedPageWeightFunction>;
+
+public:
+    // The pages larger than this are not cached, they are unlikely to be the hot pages.
+    static constexpr size_t MAX_CACHED_PAGE_SIZE = 1024 * 1024;
+
+    explicit PageCache(size_t max_size_in_bytes)
+        : Base(max_size_in_bytes)
+    {}
+
+    static bool shouldCache(const PageEntryV3 & entry) { return entry.size != 0 && entry.size <= MAX_CACHED_PAGE_SIZE; }
+
+    // Return nullptr if the page is not cached
+    MappedPtr get(const PageEntryV3 & entry)
+    {
+        if (!shouldCache(entry))
+            return nullptr;
+        auto cached = Base::get(PageCacheKey{entry.file_id, entry.offset});
+        if (cached != nullptr && cached->checksum == entry.checksum && cached->data.size() == entry.size)
+        {
+            GET_METRIC(tiflash_storage_page_cache_count, type_hit).Increment();
+            return cached;
+        }
+        GET_METRIC(tiflash_storage_page_cache_count, type_miss).Increment();
+        return nullptr;
+    }
+
+    // `data` should be the verified data of `entry`
+    void set(const PageEntryV3 & entry, const char * data)
+    {
+        if (!shouldCache(entry))
+            return;
+        auto page = std::make_shared<CachedPage>();
+        page->checksum = entry.checksum;
+        page->data.assign(data, entry.size);
+        Base::set(PageCacheKey{entry.file_id, entry.offset}, page);
+    }
+
+    void remove(const PageEntryV3 & entry) { Base::remove(PageCacheKey{entry.file_id, entry.offset}); }
+
+    // Make a page sharing the memory of the cached data
+    static Page toPage(PageId page_id, const MappedPtr & cached)
+    {
+        Page page;
+        page.page_id = page_id;
+        page.data = ByteBuffer(cached->data.data(), cached->data.data() + cached->data.size());
+        page.mem_holder = MemHolder(cached, cached->data.data());
+        return page;
+    }
+};
+
+using PageCachePtr = std::unique_ptr<PageCache>;
+} // namespace DB::PS::V3
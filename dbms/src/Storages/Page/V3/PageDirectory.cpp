@@ -28,6 +28,7 @@
 #include <Storages/Page/WriteBatch.h>
 #include <common/logger_useful.h>
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -577,6 +578,49 @@ bool VersionedPageEntries::cleanOutdatedEntries(
     return entries.empty() || (entries.size() == 1 && entries.begin()->second.isDelete());
 }
 
+bool VersionedPageEntries::cleanInvisibleEntries(
+    const std::vector<UInt64> & snapshot_seqs,
+    UInt64 max_seq,
+    std::vector<UInt64> & pinned_bytes,
+    PageEntriesV3 * entries_removed,
+    const PageLock & /*page_lock*/)
+{
+    if (type != EditRecordType::VAR_ENTRY || entries.size() < 2)
+        return false;
+
+    for (auto iter = entries.begin(); iter != entries.end(); /* empty */)
+    {
+        auto next_iter = std::next(iter);
+        // The snapshots created after `max_seq` may see the last versions not newer than it.
+        if (next_iter == entries.end() || next_iter->first.sequence > max_seq)
+            break;
+        if (!iter->second.isEntry())
+        {
+            iter = next_iter;
+            continue;
+        }
+
+        auto visible_begin = std::lower_bound(snapshot_seqs.begin(), snapshot_seqs.end(), iter->first.sequence);
+        auto visible_end = std::lower_bound(visible_begin, snapshot_seqs.end(), next_iter->first.sequence);
+        if (visible_begin != visible_end)
+        {
+            for (auto seq_iter = visible_begin; seq_iter != visible_end; ++seq_iter)
+                pinned_bytes[seq_iter - snapshot_seqs.begin()] += iter->second.entry.size;
+        }
+        else if (iter->second.being_ref_count == 1)
+        {
+            if (entries_removed)
+            {
+                entries_removed->emplace_back(iter->second.entry);
+            }
+            entries.erase(iter);
+        }
+        iter = next_iter;
+    }
+
+    return entries.empty() || (entries.size() == 1 && entries.begin()->second.isDelete());
+}
+
 bool VersionedPageEntries::derefAndClean(UInt64 lowest_seq, PageIdV3Internal page_id, const PageVersion & deref_ver, const Int64 deref_count, PageEntriesV3 * entries_removed, bool keep_last_valid_var_entry)
 {
     auto page_lock = acquireLock();
@@ -756,6 +800,11 @@ SnapshotsStatistics PageDirectory::getSnapshotsStat() const
                     stat.longest_living_from_thread_id = snapshot_ptr->create_thread;
                     stat.longest_living_from_tracing_id = snapshot_ptr->tracing_id;
                 }
+                if (auto pinned_bytes = snapshot_ptr->pinned_bytes.load(std::memory_order_relaxed); pinned_bytes > stat.most_pinned_bytes)
+                {
+                    stat.most_pinned_bytes = pinned_bytes;
+                    stat.most_pinned_from_tracing_id = snapshot_ptr->tracing_id;
+                }
                 stat.num_snapshots++;
                 ++iter;
             }
@@ -776,28 +825,28 @@ PageIDAndEntryV3 PageDirectory::get(PageIdV3Internal page_id, const PageDirector
     bool ok = true;
     while (ok)
     {
-        MVCCMapType::const_iterator iter;
+        auto version_list = findVersionList(id_to_resolve);
+        if (version_list == nullptr)
         {
-            std::shared_lock read_lock(table_rw_mutex);
-            iter = mvcc_table_directory.find(id_to_resolve);
-            if (iter == mvcc_table_directory.end())
+            if (throw_on_not_exist)
             {
-                if (throw_on_not_exist)
+                LOG_FMT_WARNING(log, "Dump state for invalid page id [page_id={}]", page_id);
+                for (const auto & shard : mvcc_table_shards)
                 {
-                    LOG_FMT_WARNING(log, "Dump state for invalid page id [page_id={}]", page_id);
-                    for (const auto & [dump_id, dump_entry] : mvcc_table_directory)
+                    std::shared_lock read_lock(shard.mutex);
+                    for (const auto & [dump_id, dump_entry] : shard.table)
                     {
                         LOG_FMT_WARNING(log, "Dumping state [page_id={}] [entry={}]", dump_id, dump_entry == nullptr ? "<null>" : dump_entry->toDebugString());
                     }
-                    throw Exception(fmt::format("Invalid page id, entry not exist [page_id={}] [resolve_id={}]", page_id, id_to_resolve), ErrorCodes::PS_ENTRY_NOT_EXISTS);
-                }
-                else
-                {
-                    return PageIDAndEntryV3{page_id, PageEntryV3{.file_id = INVALID_BLOBFILE_ID}};
                 }
+                throw Exception(fmt::format("Invalid page id, entry not exist [page_id={}] [resolve_id={}]", page_id, id_to_resolve), ErrorCodes::PS_ENTRY_NOT_EXISTS);
+            }
+            else
+            {
+                return PageIDAndEntryV3{page_id, PageEntryV3{.file_id = INVALID_BLOBFILE_ID}};
             }
         }
-        auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = iter->second->resolveToPageId(ver_to_resolve.sequence, id_to_resolve != page_id, &entry_got);
+        auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = version_list->resolveToPageId(ver_to_resolve.sequence, id_to_resolve != page_id, &entry_got);
         switch (need_collapse)
         {
         case VersionedPageEntries::RESOLVE_TO_NORMAL:
@@ -841,23 +890,19 @@ std::pair<PageIDAndEntriesV3, PageIds> PageDirectory::get(const PageIdV3Internal
         bool ok = true;
         while (ok)
         {
-            MVCCMapType::const_iterator iter;
+            auto version_list = findVersionList(id_to_resolve);
+            if (version_list == nullptr)
             {
-                std::shared_lock read_lock(table_rw_mutex);
-                iter = mvcc_table_directory.find(id_to_resolve);
-                if (iter == mvcc_table_directory.end())
+                if (throw_on_not_exist)
                 {
-                    if (throw_on_not_exist)
-                    {
-                        throw Exception(fmt::format("Invalid page id, entry not exist [page_id={}] [resolve_id={}]", page_id, id_to_resolve), ErrorCodes::PS_ENTRY_NOT_EXISTS);
-                    }
-                    else
-                    {
-                        return false;
-                    }
+                    throw Exception(fmt::format("Invalid page id, entry not exist [page_id={}] [resolve_id={}]", page_id, id_to_resolve), ErrorCodes::PS_ENTRY_NOT_EXISTS);
+                }
+                else
+                {
+                    return false;
                 }
             }
-            auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = iter->second->resolveToPageId(ver_to_resolve.sequence, id_to_resolve != page_id, &entry_got);
+            auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = version_list->resolveToPageId(ver_to_resolve.sequence, id_to_resolve != page_id, &entry_got);
             switch (need_collapse)
             {
             case VersionedPageEntries::RESOLVE_TO_NORMAL:
@@ -910,23 +955,19 @@ PageIdV3Internal PageDirectory::getNormalPageId(PageIdV3Internal page_id, const
     bool keep_resolve = true;
     while (keep_resolve)
     {
-        MVCCMapType::const_iterator iter;
+        auto version_list = findVersionList(id_to_resolve);
+        if (version_list == nullptr)
         {
-            std::shared_lock read_lock(table_rw_mutex);
-            iter = mvcc_table_directory.find(id_to_resolve);
-            if (iter == mvcc_table_directory.end())
+            if (throw_on_not_exist)
             {
-                if (throw_on_not_exist)
-                {
-                    throw Exception(fmt::format("Invalid page id [page_id={}] [resolve_id={}]", page_id, id_to_resolve));
-                }
-                else
-                {
-                    return buildV3Id(0, INVALID_PAGE_ID);
-                }
+                throw Exception(fmt::format("Invalid page id [page_id={}] [resolve_id={}]", page_id, id_to_resolve));
+            }
+            else
+            {
+                return buildV3Id(0, INVALID_PAGE_ID);
             }
         }
-        auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = iter->second->resolveToPageId(ver_to_resolve.sequence, id_to_resolve != page_id, nullptr);
+        auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = version_list->resolveToPageId(ver_to_resolve.sequence, id_to_resolve != page_id, nullptr);
         switch (need_collapse)
         {
         case VersionedPageEntries::RESOLVE_TO_NORMAL:
@@ -965,40 +1006,72 @@ PageIdV3Internal PageDirectory::getNormalPageId(PageIdV3Internal page_id, const
 
 PageId PageDirectory::getMaxId() const
 {
-    std::shared_lock read_lock(table_rw_mutex);
-    return max_page_id;
+    return max_page_id.load();
 }
 
 std::set<PageIdV3Internal> PageDirectory::getAllPageIds()
 {
     std::set<PageIdV3Internal> page_ids;
-    std::shared_lock read_lock(table_rw_mutex);
-
-    for (auto & [page_id, versioned] : mvcc_table_directory)
+    for (const auto & shard : mvcc_table_shards)
     {
-        (void)versioned;
-        page_ids.insert(page_id);
+        std::shared_lock read_lock(shard.mutex);
+        for (const auto & [page_id, versioned] : shard.table)
+        {
+            (void)versioned;
+            page_ids.insert(page_id);
+        }
     }
     return page_ids;
 }
 
+VersionedPageEntriesPtr PageDirectory::findVersionList(PageIdV3Internal page_id) const
+{
+    const auto & shard = mvcc_table_shards[shardIndex(page_id)];
+    std::shared_lock read_lock(shard.mutex);
+    if (auto iter = shard.table.find(page_id); iter != shard.table.end())
+        return iter->second;
+    return nullptr;
+}
+
+VersionedPageEntriesPtr PageDirectory::findVersionListForApply(PageIdV3Internal page_id, const MVCCTableShardLocks * shard_locks) const
+{
+    const auto shard_idx = shardIndex(page_id);
+    if (shard_locks != nullptr && !(*shard_locks)[shard_idx].owns_lock())
+        return findVersionList(page_id);
+
+    const auto & shard = mvcc_table_shards[shard_idx];
+    if (auto iter = shard.table.find(page_id); iter != shard.table.end())
+        return iter->second;
+    return nullptr;
+}
+
+PageDirectory::MVCCMapType PageDirectory::mergeMVCCTableShards() const
+{
+    MVCCMapType merged;
+    for (const auto & shard : mvcc_table_shards)
+    {
+        std::shared_lock read_lock(shard.mutex);
+        merged.insert(shard.table.begin(), shard.table.end());
+    }
+    return merged;
+}
+
 void PageDirectory::applyRefEditRecord(
-    MVCCMapType & mvcc_table_directory,
     const VersionedPageEntriesPtr & version_list,
     const PageEntriesEdit::EditRecord & rec,
-    const PageVersion & version)
+    const PageVersion & version,
+    const MVCCTableShardLocks * shard_locks)
 {
     // applying ref 3->2, existing ref 2->1, normal entry 1, then we should collapse
     // the ref to be 3->1, increase the refcounting of normal entry 1
-    auto [resolve_success, resolved_id, resolved_ver] = [&mvcc_table_directory](PageIdV3Internal id_to_resolve, PageVersion ver_to_resolve)
+    auto [resolve_success, resolved_id, resolved_ver] = [this, shard_locks](PageIdV3Internal id_to_resolve, PageVersion ver_to_resolve)
         -> std::tuple<bool, PageIdV3Internal, PageVersion> {
         while (true)
         {
-            auto resolve_ver_iter = mvcc_table_directory.find(id_to_resolve);
-            if (resolve_ver_iter == mvcc_table_directory.end())
+            auto resolve_version_list = findVersionListForApply(id_to_resolve, shard_locks);
+            if (resolve_version_list == nullptr)
                 return {false, buildV3Id(0, 0), PageVersion(0)};
 
-            const VersionedPageEntriesPtr & resolve_version_list = resolve_ver_iter->second;
             // If we already hold the lock from `id_to_resolve`, then we should not request it again.
             // This can happen when `id_to_resolve` have other operating in current writebatch
             auto [need_collapse, next_id_to_resolve, next_ver_to_resolve] = resolve_version_list->resolveToPageId(
@@ -1038,9 +1111,9 @@ void PageDirectory::applyRefEditRecord(
     if (is_ref_created)
     {
         // Add the ref-count of being-ref entry
-        if (auto resolved_iter = mvcc_table_directory.find(resolved_id); resolved_iter != mvcc_table_directory.end())
+        if (auto resolved_version_list = findVersionListForApply(resolved_id, shard_locks); resolved_version_list != nullptr)
         {
-            resolved_iter->second->incrRefCount(resolved_ver);
+            resolved_version_list->incrRefCount(resolved_ver);
         }
         else
         {
@@ -1055,25 +1128,143 @@ void PageDirectory::applyRefEditRecord(
     }
 }
 
+namespace
+{
+// Limit the size of a group, so that the followers are not blocked for too long.
+constexpr size_t MAX_GROUP_COMMIT_RECORDS = 16384;
+} // namespace
+
 void PageDirectory::apply(PageEntriesEdit && edit, const WriteLimiterPtr & write_limiter)
 {
-    // Note that we need to make sure increasing `sequence` in order, so it
-    // also needs to be protected by `write_lock` throughout the `apply`
-    // TODO: It is totally serialized, make it a pipeline
-    std::unique_lock write_lock(table_rw_mutex);
-    UInt64 last_sequence = sequence.load();
-    PageVersion new_version(last_sequence + 1, 0);
+    Writer w;
+    w.edit = &edit;
+
+    std::unique_lock apply_lock(apply_mutex);
+    writers.push_back(&w);
+    w.cv.wait(apply_lock, [&] { return w.done || writers.front() == &w; });
+    if (w.done)
+    {
+        // Applied by the leader
+        if (w.error)
+            std::rethrow_exception(w.error);
+        return;
+    }
+
+    // This writer is the leader, take the queued writers as a group.
+    std::vector<Writer *> group;
+    size_t num_records = 0;
+    for (auto * writer : writers)
+    {
+        if (!group.empty() && num_records + writer->edit->size() > MAX_GROUP_COMMIT_RECORDS)
+            break;
+        group.push_back(writer);
+        num_records += writer->edit->size();
+    }
+    apply_lock.unlock();
+
+    // Note that we need to make sure increasing `sequence` in order. As there is only one leader at the
+    // same time, the sequence is only modified by the leader.
+    const UInt64 last_sequence = sequence.load();
+
+    // stage 1, persisted the changes to WAL with version [seq=last_seq + i, epoch=0]
+    // It is not protected by the locks of MVCC table so that the readers are not blocked by IO.
+    try
+    {
+        if (group.size() == 1)
+        {
+            wal->apply(*w.edit, PageVersion(last_sequence + 1, 0), write_limiter);
+        }
+        else
+        {
+            PageEntriesEdit group_edit(num_records);
+            for (size_t i = 0; i < group.size(); ++i)
+            {
+                const PageVersion version(last_sequence + i + 1, 0);
+                for (auto & r : group[i]->edit->getMutRecords())
+                {
+                    r.version = version;
+                    group_edit.appendRecord(r);
+                }
+            }
+            wal->apply(group_edit, write_limiter);
+        }
+    }
+    catch (...)
+    {
+        for (auto * writer : group)
+            writer->error = std::current_exception();
+    }
+
+    if (!w.error)
+    {
+        // stage 2, create entry version list for page_id. Only the shards touched by the edits are locked,
+        // in the order of shard index. The shards of ref chains reaching out of them are locked on demand
+        // by `findVersionListForApply`.
+        MVCCTableShardLocks shard_locks;
+        {
+            std::array<bool, NUM_MVCC_TABLE_SHARDS> touched{};
+            for (const auto * writer : group)
+            {
+                for (const auto & r : writer->edit->getRecords())
+                {
+                    touched[shardIndex(r.page_id)] = true;
+                    if (r.type == EditRecordType::REF)
+                        touched[shardIndex(r.ori_page_id)] = true;
+                }
+            }
+            for (size_t shard_idx = 0; shard_idx < NUM_MVCC_TABLE_SHARDS; ++shard_idx)
+            {
+                if (touched[shard_idx])
+                    shard_locks[shard_idx] = std::unique_lock(mvcc_table_shards[shard_idx].mutex);
+            }
+        }
+        for (size_t i = 0; i < group.size(); ++i)
+        {
+            try
+            {
+                applyToMVCCTable(*group[i]->edit, PageVersion(last_sequence + i + 1, 0), shard_locks);
+            }
+            catch (...)
+            {
+                group[i]->error = std::current_exception();
+            }
+        }
+        // stage 3, the edits committed, incr the sequence number to publish changes for `createSnapshot`.
+        // The sequence numbers of the edits failed to be applied are also consumed, since they have been persisted.
+        sequence.store(last_sequence + group.size());
+    }
 
-    // stage 1, persisted the changes to WAL with version [seq=last_seq + 1, epoch=0]
-    wal->apply(edit, new_version, write_limiter);
+    apply_lock.lock();
+    for (auto * writer : group)
+    {
+        assert(writers.front() == writer);
+        writers.pop_front();
+        if (writer != &w)
+        {
+            writer->done = true;
+            writer->cv.notify_one();
+        }
+    }
+    // Make the next writer be the leader
+    if (!writers.empty())
+        writers.front()->cv.notify_one();
+    apply_lock.unlock();
+
+    if (w.error)
+        std::rethrow_exception(w.error);
+}
 
-    // stage 2, create entry version list for page_id.
+void PageDirectory::applyToMVCCTable(const PageEntriesEdit & edit, const PageVersion & version, const MVCCTableShardLocks & shard_locks)
+{
     for (const auto & r : edit.getRecords())
     {
-        // Protected in write_lock
-        max_page_id = std::max(max_page_id, r.page_id.low);
+        // Only the leader of `apply` modify `max_page_id`
+        if (r.page_id.low > max_page_id.load())
+            max_page_id.store(r.page_id.low);
 
-        auto [iter, created] = mvcc_table_directory.insert(std::make_pair(r.page_id, nullptr));
+        auto & shard = mvcc_table_shards[shardIndex(r.page_id)];
+        assert(shard_locks[shardIndex(r.page_id)].owns_lock());
+        auto [iter, created] = shard.table.insert(std::make_pair(r.page_id, nullptr));
         if (created)
         {
             iter->second = std::make_shared<VersionedPageEntries>();
@@ -1086,7 +1277,7 @@ void PageDirectory::apply(PageEntriesEdit && edit, const WriteLimiterPtr & write
             {
             case EditRecordType::PUT_EXTERNAL:
             {
-                auto holder = version_list->createNewExternal(new_version);
+                auto holder = version_list->createNewExternal(version);
                 if (holder)
                 {
                     // put the new created holder into `external_ids`
@@ -1097,13 +1288,13 @@ void PageDirectory::apply(PageEntriesEdit && edit, const WriteLimiterPtr & write
                 break;
             }
             case EditRecordType::PUT:
-                version_list->createNewEntry(new_version, r.entry);
+                version_list->createNewEntry(version, r.entry);
                 break;
             case EditRecordType::DEL:
-                version_list->createDelete(new_version);
+                version_list->createDelete(version);
                 break;
             case EditRecordType::REF:
-                applyRefEditRecord(mvcc_table_directory, version_list, r, new_version);
+                applyRefEditRecord(version_list, r, version, &shard_locks);
                 break;
             case EditRecordType::UPSERT:
             case EditRecordType::VAR_DELETE:
@@ -1115,13 +1306,10 @@ void PageDirectory::apply(PageEntriesEdit && edit, const WriteLimiterPtr & write
         }
         catch (DB::Exception & e)
         {
-            e.addMessage(fmt::format(" [type={}] [page_id={}] [ver={}] [edit_size={}]", r.type, r.page_id, new_version, edit.size()));
+            e.addMessage(fmt::format(" [type={}] [page_id={}] [ver={}] [edit_size={}]", r.type, r.page_id, version, edit.size()));
             e.rethrow();
         }
     }
-
-    // stage 3, the edit committed, incr the sequence number to publish changes for `createSnapshot`
-    sequence.fetch_add(1);
 }
 
 void PageDirectory::gcApply(PageEntriesEdit && migrated_edit, const WriteLimiterPtr & write_limiter)
@@ -1138,18 +1326,13 @@ void PageDirectory::gcApply(PageEntriesEdit && migrated_edit, const WriteLimiter
     // Apply migrate edit to the mvcc map
     for (const auto & record : migrated_edit.getRecords())
     {
-        MVCCMapType::const_iterator iter;
+        auto versioned_entries = findVersionList(record.page_id);
+        if (unlikely(versioned_entries == nullptr))
         {
-            std::shared_lock read_lock(table_rw_mutex);
-            iter = mvcc_table_directory.find(record.page_id);
-            if (unlikely(iter == mvcc_table_directory.end()))
-            {
-                throw Exception(fmt::format("Can't find [page_id={}] while doing gcApply", record.page_id), ErrorCodes::LOGICAL_ERROR);
-            }
-        } // release the read lock on `table_rw_mutex`
+            throw Exception(fmt::format("Can't find [page_id={}] while doing gcApply", record.page_id), ErrorCodes::LOGICAL_ERROR);
+        }
 
         // Append the gc version to version list
-        const auto & versioned_entries = iter->second;
         versioned_entries->createNewEntry(record.version, record.entry);
     }
 
@@ -1187,35 +1370,42 @@ PageDirectory::getEntriesByBlobIds(const std::vector<BlobFileId> & blob_ids) con
     std::map<BlobFileId, PageIdAndVersionedEntries> blob_versioned_entries;
     PageSize total_page_size = 0;
 
-    MVCCMapType::const_iterator iter;
-    {
-        std::shared_lock read_lock(table_rw_mutex);
-        iter = mvcc_table_directory.cbegin();
-        if (iter == mvcc_table_directory.end())
-            return {blob_versioned_entries, total_page_size};
-    }
-
     UInt64 total_page_nums = 0;
-    while (true)
+    bool is_empty = true;
+    for (const auto & shard : mvcc_table_shards)
     {
-        // `iter` is an iter that won't be invalid cause by `apply`/`gcApply`.
-        // do scan on the version list without lock on `mvcc_table_directory`.
-        auto page_id = iter->first;
-        const auto & version_entries = iter->second;
-        auto single_page_size = version_entries->getEntriesByBlobIds(blob_id_set, page_id, blob_versioned_entries);
-        total_page_size += single_page_size;
-        if (single_page_size != 0)
+        MVCCMapType::const_iterator iter;
         {
-            total_page_nums++;
+            std::shared_lock read_lock(shard.mutex);
+            iter = shard.table.cbegin();
+            if (iter == shard.table.end())
+                continue;
         }
+        is_empty = false;
 
+        while (true)
         {
-            std::shared_lock read_lock(table_rw_mutex);
-            iter++;
-            if (iter == mvcc_table_directory.end())
-                break;
+            // `iter` is an iter that won't be invalid cause by `apply`/`gcApply`.
+            // do scan on the version list without lock on the shard.
+            auto page_id = iter->first;
+            const auto & version_entries = iter->second;
+            auto single_page_size = version_entries->getEntriesByBlobIds(blob_id_set, page_id, blob_versioned_entries);
+            total_page_size += single_page_size;
+            if (single_page_size != 0)
+            {
+                total_page_nums++;
+            }
+
+            {
+                std::shared_lock read_lock(shard.mutex);
+                iter++;
+                if (iter == shard.table.end())
+                    break;
+            }
         }
     }
+    if (is_empty)
+        return {blob_versioned_entries, total_page_size};
     for (const auto blob_id : blob_ids)
     {
         if (blob_versioned_entries.find(blob_id) == blob_versioned_entries.end())
@@ -1262,7 +1452,10 @@ bool PageDirectory::tryDumpSnapshot(const ReadLimiterPtr & read_limiter, const W
 
 PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool keep_last_valid_var_entry)
 {
-    UInt64 lowest_seq = sequence.load();
+    const UInt64 max_seq = sequence.load();
+    UInt64 lowest_seq = max_seq;
+    // The alive snapshots sorted by sequence, the versions not visible to any of them are removed.
+    std::vector<std::pair<UInt64, std::weak_ptr<PageDirectorySnapshot>>> alive_snapshots;
 
     UInt64 invalid_snapshot_nums = 0;
     UInt64 valid_snapshot_nums = 0;
@@ -1282,6 +1475,7 @@ PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool ke
             else
             {
                 lowest_seq = std::min(lowest_seq, snap->sequence);
+                alive_snapshots.emplace_back(snap->sequence, *iter);
                 ++iter;
                 valid_snapshot_nums++;
                 const auto alive_time_seconds = snap->elapsedSeconds();
@@ -1301,15 +1495,16 @@ PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool ke
         }
     }
 
-    PageEntriesV3 all_del_entries;
-    MVCCMapType::iterator iter;
-    {
-        std::shared_lock read_lock(table_rw_mutex);
-        iter = mvcc_table_directory.begin();
-        if (iter == mvcc_table_directory.end())
-            return all_del_entries;
-    }
+    std::sort(alive_snapshots.begin(), alive_snapshots.end(), [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; });
+    std::vector<UInt64> snapshot_seqs;
+    snapshot_seqs.reserve(alive_snapshots.size());
+    for (const auto & alive_snapshot : alive_snapshots)
+        snapshot_seqs.emplace_back(alive_snapshot.first);
+    std::vector<UInt64> snapshot_pinned_bytes(snapshot_seqs.size(), 0);
+    // Keep the last valid entries for dumping snapshot, see `cleanOutdatedEntries`.
+    const bool clean_invisible_entries = !keep_last_valid_var_entry && !snapshot_seqs.empty();
 
+    PageEntriesV3 all_del_entries;
     UInt64 invalid_page_nums = 0;
     UInt64 valid_page_nums = 0;
 
@@ -1317,32 +1512,57 @@ PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool ke
     // { id_0: <version, num to decrease>, id_1: <...>, ... }
     std::map<PageIdV3Internal, std::pair<PageVersion, Int64>> normal_entries_to_deref;
     // Iterate all page_id and try to clean up useless var entries
-    while (true)
+    for (auto & shard : mvcc_table_shards)
     {
-        // `iter` is an iter that won't be invalid cause by `apply`/`gcApply`.
-        // do gc on the version list without lock on `mvcc_table_directory`.
-        const bool all_deleted = iter->second->cleanOutdatedEntries(
-            lowest_seq,
-            &normal_entries_to_deref,
-            return_removed_entries ? &all_del_entries : nullptr,
-            iter->second->acquireLock(),
-            keep_last_valid_var_entry);
+        MVCCMapType::iterator iter;
+        {
+            std::shared_lock read_lock(shard.mutex);
+            iter = shard.table.begin();
+            if (iter == shard.table.end())
+                continue;
+        }
 
+        while (true)
         {
-            std::unique_lock write_lock(table_rw_mutex);
-            if (all_deleted)
+            // `iter` is an iter that won't be invalid cause by `apply`/`gcApply`.
+            // do gc on the version list without lock on the shard.
+            bool all_deleted = false;
             {
-                iter = mvcc_table_directory.erase(iter);
-                invalid_page_nums++;
+                auto page_lock = iter->second->acquireLock();
+                all_deleted = iter->second->cleanOutdatedEntries(
+                    lowest_seq,
+                    &normal_entries_to_deref,
+                    return_removed_entries ? &all_del_entries : nullptr,
+                    page_lock,
+                    keep_last_valid_var_entry);
+                // Don't let the long living snapshots pin all the versions written after them.
+                if (!all_deleted && clean_invisible_entries)
+                {
+                    all_deleted = iter->second->cleanInvisibleEntries(
+                        snapshot_seqs,
+                        max_seq,
+                        snapshot_pinned_bytes,
+                        return_removed_entries ? &all_del_entries : nullptr,
+                        page_lock);
+                }
             }
-            else
+
             {
-                valid_page_nums++;
-                iter++;
-            }
+                std::unique_lock write_lock(shard.mutex);
+                if (all_deleted)
+                {
+                    iter = shard.table.erase(iter);
+                    invalid_page_nums++;
+                }
+                else
+                {
+                    valid_page_nums++;
+                    iter++;
+                }
 
-            if (iter == mvcc_table_directory.end())
-                break;
+                if (iter == shard.table.end())
+                    break;
+            }
         }
     }
 
@@ -1351,11 +1571,12 @@ PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool ke
     // Iterate all page_id that need to decrease ref count of specified version.
     for (const auto & [page_id, deref_counter] : normal_entries_to_deref)
     {
+        auto & shard = mvcc_table_shards[shardIndex(page_id)];
         MVCCMapType::iterator iter;
         {
-            std::shared_lock read_lock(table_rw_mutex);
-            iter = mvcc_table_directory.find(page_id);
-            if (iter == mvcc_table_directory.end())
+            std::shared_lock read_lock(shard.mutex);
+            iter = shard.table.find(page_id);
+            if (iter == shard.table.end())
                 continue;
         }
 
@@ -1369,19 +1590,35 @@ PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool ke
 
         if (all_deleted)
         {
-            std::unique_lock write_lock(table_rw_mutex);
-            mvcc_table_directory.erase(iter);
+            std::unique_lock write_lock(shard.mutex);
+            shard.table.erase(iter);
             invalid_page_nums++;
             valid_page_nums--;
         }
     }
 
+    UInt64 most_pinned_bytes = 0;
+    String most_pinned_tracing_id;
+    for (size_t i = 0; i < alive_snapshots.size(); ++i)
+    {
+        if (auto snap = alive_snapshots[i].second.lock(); snap != nullptr)
+        {
+            snap->pinned_bytes.store(snapshot_pinned_bytes[i], std::memory_order_relaxed);
+            if (snapshot_pinned_bytes[i] > most_pinned_bytes)
+            {
+                most_pinned_bytes = snapshot_pinned_bytes[i];
+                most_pinned_tracing_id = snap->tracing_id;
+            }
+        }
+    }
+
     LOG_FMT_INFO(log, "After MVCC gc in memory [lowest_seq={}] "
                       "clean [invalid_snapshot_nums={}] [invalid_page_nums={}] "
                       "[total_deref_counter={}] [all_del_entries={}]. "
                       "Still exist [snapshot_nums={}], [page_nums={}]. "
                       "Longest alive snapshot: [longest_alive_snapshot_time={}] "
-                      "[longest_alive_snapshot_seq={}] [stale_snapshot_nums={}]",
+                      "[longest_alive_snapshot_seq={}] [stale_snapshot_nums={}]. "
+                      "Most pinned snapshot: [most_pinned_bytes={}] [most_pinned_tracing_id={}]",
                  lowest_seq,
                  invalid_snapshot_nums,
                  invalid_page_nums,
@@ -1391,7 +1628,9 @@ PageEntriesV3 PageDirectory::gcInMemEntries(bool return_removed_entries, bool ke
                  valid_page_nums,
                  longest_alive_snapshot_time,
                  longest_alive_snapshot_seq,
-                 stale_snapshot_nums);
+                 stale_snapshot_nums,
+                 most_pinned_bytes,
+                 most_pinned_tracing_id);
 
     return all_del_entries;
 }
@@ -1404,22 +1643,25 @@ PageEntriesEdit PageDirectory::dumpSnapshotToEdit(PageDirectorySnapshotPtr snap)
     }
 
     PageEntriesEdit edit;
-    MVCCMapType::iterator iter;
+    for (auto & shard : mvcc_table_shards)
     {
-        std::shared_lock read_lock(table_rw_mutex);
-        iter = mvcc_table_directory.begin();
-        if (iter == mvcc_table_directory.end())
-            return edit;
-    }
-    while (true)
-    {
-        iter->second->collapseTo(snap->sequence, iter->first, edit);
-
+        MVCCMapType::iterator iter;
         {
-            std::shared_lock read_lock(table_rw_mutex);
-            ++iter;
-            if (iter == mvcc_table_directory.end())
-                break;
+            std::shared_lock read_lock(shard.mutex);
+            iter = shard.table.begin();
+            if (iter == shard.table.end())
+                continue;
+        }
+        while (true)
+        {
+            iter->second->collapseTo(snap->sequence, iter->first, edit);
+
+            {
+                std::shared_lock read_lock(shard.mutex);
+                ++iter;
+                if (iter == shard.table.end())
+                    break;
+            }
         }
     }
 
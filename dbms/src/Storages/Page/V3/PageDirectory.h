@@ -16,6 +16,7 @@
 
 #include <Common/CurrentMetrics.h>
 #include <Common/Logger.h>
+#include <Common/ProfilingMutex.h>
 #include <Common/nocopyable.h>
 #include <Encryption/FileProvider.h>
 #include <Poco/Ext/ThreadNumber.h>
@@ -28,6 +29,10 @@
 #include <Storages/Page/V3/WALStore.h>
 #include <common/types.h>
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
@@ -70,6 +75,9 @@ public:
     const UInt64 sequence;
     const unsigned create_thread;
     const String tracing_id;
+    // The bytes of the outdated page entries visible to this snapshot, which can not be reclaimed until it is
+    // released. Updated by `PageDirectory::gcInMemEntries`.
+    std::atomic<UInt64> pinned_bytes{0};
 
 private:
     const TimePoint create_time;
@@ -226,6 +234,30 @@ public:
         PageEntriesV3 * entries_removed,
         const PageLock & page_lock,
         bool keep_last_valid_var_entry = false);
+    /**
+     * `cleanOutdatedEntries` keeps all the entries newer than the one visible to the oldest snapshot, so a long
+     * living snapshot pins every version written after it. This removes the entries not visible to any alive
+     * snapshot instead: an entry is visible to the snapshots with sequence in [its sequence, the sequence of
+     * the next version).
+     * Only the entries replaced by a version not newer than `max_seq` are checked, `snapshot_seqs` must be the
+     * sorted sequences of all alive snapshots created before `max_seq` is taken.
+     * The bytes of the kept outdated entries are added to `pinned_bytes`, in the same order as `snapshot_seqs`.
+     *
+     * Ex.
+     *    entry 1 : seq 2
+     *    entry 2 : seq 4
+     *    entry 3 : seq 6
+     *    entry 4 : seq 8
+     *
+     *    snapshot_seqs : [3], max_seq : 8
+     *    Then (entry 2, entry 3) will be deleted, and the size of entry 1 is pinned by the snapshot.
+     */
+    bool cleanInvisibleEntries(
+        const std::vector<UInt64> & snapshot_seqs,
+        UInt64 max_seq,
+        std::vector<UInt64> & pinned_bytes,
+        PageEntriesV3 * entries_removed,
+        const PageLock & page_lock);
     bool derefAndClean(
         UInt64 lowest_seq,
         PageIdV3Internal page_id,
@@ -353,6 +385,8 @@ public:
 
     std::set<PageIdV3Internal> getAllPageIds();
 
+    // Persist the edit to WAL and apply it to the in-memory directory.
+    // The edits applied concurrently are grouped into one WAL record, see `Writer`.
     void apply(PageEntriesEdit && edit, const WriteLimiterPtr & write_limiter = nullptr);
 
     std::pair<std::map<BlobFileId, PageIdAndVersionedEntries>, PageSize>
@@ -376,8 +410,13 @@ public:
 
     size_t numPages() const
     {
-        std::shared_lock read_lock(table_rw_mutex);
-        return mvcc_table_directory.size();
+        size_t num_pages = 0;
+        for (const auto & shard : mvcc_table_shards)
+        {
+            std::shared_lock read_lock(shard.mutex);
+            num_pages += shard.table.size();
+        }
+        return num_pages;
     }
 
     // No copying and no moving
@@ -392,11 +431,38 @@ private:
     // https://en.cppreference.com/w/cpp/container/map/insert
     using MVCCMapType = std::map<PageIdV3Internal, VersionedPageEntriesPtr>;
 
-    static void applyRefEditRecord(
-        MVCCMapType & mvcc_table_directory,
+    // The MVCC table is sharded by page id and every shard is protected by its own lock, so that the
+    // lookups from read threads, `apply` and the in-memory gc on different shards do not compete on
+    // one lock. The snapshot semantic is kept by `sequence`, which is increased after the edits are
+    // applied to all the shards they touch.
+    static constexpr size_t NUM_MVCC_TABLE_SHARDS = 16;
+    struct MVCCTableShard
+    {
+        mutable ProfilingSharedMutex mutex{ProfilingLockType::PageDirectory};
+        MVCCMapType table;
+    };
+    using MVCCTableShardLocks = std::array<std::unique_lock<ProfilingSharedMutex>, NUM_MVCC_TABLE_SHARDS>;
+
+    static size_t shardIndex(PageIdV3Internal page_id) { return page_id.low % NUM_MVCC_TABLE_SHARDS; }
+
+    // Return nullptr if `page_id` is not exist.
+    VersionedPageEntriesPtr findVersionList(PageIdV3Internal page_id) const;
+
+    // Same as `findVersionList`, but do not acquire the lock of the shards already locked in `shard_locks`.
+    // If `shard_locks` is nullptr, the caller should have exclusive access to the whole table (e.g. restoring).
+    VersionedPageEntriesPtr findVersionListForApply(PageIdV3Internal page_id, const MVCCTableShardLocks * shard_locks) const;
+
+    // Merge the shards into one ordered table. Only for the tools.
+    MVCCMapType mergeMVCCTableShards() const;
+
+    // Apply the edit with `version` to the MVCC table, the shards touched by `edit` should be locked in `shard_locks`.
+    void applyToMVCCTable(const PageEntriesEdit & edit, const PageVersion & version, const MVCCTableShardLocks & shard_locks);
+
+    void applyRefEditRecord(
         const VersionedPageEntriesPtr & version_list,
         const PageEntriesEdit::EditRecord & rec,
-        const PageVersion & version);
+        const PageVersion & version,
+        const MVCCTableShardLocks * shard_locks);
 
     static inline PageDirectorySnapshotPtr
     toConcreteSnapshot(const DB::PageStorageSnapshotPtr & ptr)
@@ -405,10 +471,9 @@ private:
     }
 
 private:
-    PageId max_page_id;
+    std::atomic<PageId> max_page_id;
     std::atomic<UInt64> sequence;
-    mutable std::shared_mutex table_rw_mutex;
-    MVCCMapType mvcc_table_directory;
+    std::array<MVCCTableShard, NUM_MVCC_TABLE_SHARDS> mvcc_table_shards;
 
     mutable std::mutex snapshots_mutex;
     mutable std::list<std::weak_ptr<PageDirectorySnapshot>> snapshots;
@@ -416,6 +481,19 @@ private:
     mutable std::mutex external_ids_mutex;
     mutable std::list<std::weak_ptr<PageIdV3Internal>> external_ids;
 
+    // Group commit in a leader/follower style. The writer at the front of `writers` is the leader, it
+    // persists the edits of all the queued writers into WAL by one record (and one sync), applies them
+    // in order and then wakes up the followers.
+    struct Writer
+    {
+        PageEntriesEdit * edit;
+        bool done = false;
+        std::exception_ptr error;
+        std::condition_variable cv;
+    };
+    std::mutex apply_mutex;
+    std::deque<Writer *> writers;
+
     WALStorePtr wal;
     const UInt64 max_persisted_log_files;
     LoggerPtr log;
@@ -12,12 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/Stopwatch.h>
+#include <Common/TiFlashMetrics.h>
 #include <Storages/Page/V3/PageDirectory.h>
 #include <Storages/Page/V3/PageDirectoryFactory.h>
 #include <Storages/Page/V3/PageEntriesEdit.h>
 #include <Storages/Page/V3/WAL/WALReader.h>
 #include <Storages/Page/V3/WALStore.h>
 
+#include <common/ThreadPool.h>
+
 #include <memory>
 
 namespace DB
@@ -25,6 +29,7 @@ namespace DB
 namespace ErrorCodes
 {
 extern const int PS_DIR_APPLY_INVALID_STATUS;
+extern const int LOGICAL_ERROR;
 } // namespace ErrorCodes
 namespace PS::V3
 {
@@ -36,8 +41,15 @@ PageDirectoryPtr PageDirectoryFactory::create(String storage_name, FileProviderP
 
 PageDirectoryPtr PageDirectoryFactory::createFromReader(String storage_name, WALStoreReaderPtr reader, WALStorePtr wal, bool for_dump_snapshot)
 {
+    auto log = DB::Logger::get("PageDirectoryFactory", storage_name);
     PageDirectoryPtr dir = std::make_unique<PageDirectory>(storage_name, std::move(wal));
-    loadFromDisk(dir, std::move(reader));
+
+    Stopwatch watch;
+    if (restore_concurrency > 1)
+        loadFromDiskConcurrently(dir, reader->splitByFile(storage_name));
+    else
+        loadFromDisk(dir, std::move(reader));
+    const double wal_seconds = watch.elapsedSecondsFromLastTime();
 
     // Reset the `sequence` to the maximum of persisted.
     dir->sequence = max_applied_ver.sequence;
@@ -46,29 +58,29 @@ PageDirectoryPtr PageDirectoryFactory::createFromReader(String storage_name, WAL
     // try to run GC again on some entries that are already marked as invalid in BlobStore.
     // It's no need to remove the expired entries in BlobStore, so skip filling removed_entries to improve performance.
     dir->gcInMemEntries(/*return_removed_entries=*/false, /* keep_last_delete_entry */ for_dump_snapshot);
-    LOG_FMT_INFO(DB::Logger::get("PageDirectoryFactory", storage_name), "PageDirectory restored [max_page_id={}] [max_applied_ver={}]", dir->getMaxId(), dir->sequence);
+    const double gc_in_mem_seconds = watch.elapsedSecondsFromLastTime();
+    LOG_FMT_INFO(log, "PageDirectory restored [max_page_id={}] [max_applied_ver={}]", dir->getMaxId(), dir->sequence);
 
     if (!for_dump_snapshot && blob_stats)
     {
-        // After all entries restored to `mvcc_table_directory`, only apply
-        // the latest entry to `blob_stats`, or we may meet error since
-        // some entries may be removed in memory but not get compacted
-        // in the log file.
-        for (const auto & [page_id, entries] : dir->mvcc_table_directory)
-        {
-            (void)page_id;
-
-            // We should restore the entry to `blob_stats` even if it is marked as "deleted",
-            // or we will mistakenly reuse the space to write other blobs down into that space.
-            // So we need to use `getLastEntry` instead of `getEntry(version)` here.
-            if (auto entry = entries->getLastEntry(); entry)
-            {
-                blob_stats->restoreByEntry(*entry);
-            }
-        }
+        restoreBlobStats(dir);
+    }
+    const double blob_stats_seconds = watch.elapsedSecondsFromLastTime();
 
-        blob_stats->restore();
+    if (!for_dump_snapshot)
+    {
+        GET_METRIC(tiflash_storage_page_restore_duration_seconds, type_wal).Observe(wal_seconds);
+        GET_METRIC(tiflash_storage_page_restore_duration_seconds, type_gc_in_mem).Observe(gc_in_mem_seconds);
+        GET_METRIC(tiflash_storage_page_restore_duration_seconds, type_blob_stats).Observe(blob_stats_seconds);
     }
+    LOG_FMT_INFO(
+        log,
+        "PageDirectory restore done [num_pages={}] [concurrency={}] [wal={:.3f}s] [gc_in_mem={:.3f}s] [blob_stats={:.3f}s]",
+        dir->numPages(),
+        restore_concurrency,
+        wal_seconds,
+        gc_in_mem_seconds,
+        blob_stats_seconds);
 
     // TODO: After restored ends, set the last offset of log file for `wal`
     return dir;
@@ -90,27 +102,73 @@ PageDirectoryPtr PageDirectoryFactory::createFromEdit(String storage_name, FileP
 
     if (blob_stats)
     {
-        // After all entries restored to `mvcc_table_directory`, only apply
-        // the latest entry to `blob_stats`, or we may meet error since
-        // some entries may be removed in memory but not get compacted
-        // in the log file.
-        for (const auto & [page_id, entries] : dir->mvcc_table_directory)
-        {
-            (void)page_id;
+        restoreBlobStats(dir);
+    }
+
+    return dir;
+}
 
-            // We should restore the entry to `blob_stats` even if it is marked as "deleted",
-            // or we will mistakenly reuse the space to write other blobs down into that space.
-            // So we need to use `getLastEntry` instead of `getEntry(version)` here.
-            if (auto entry = entries->getLastEntry(); entry)
+void PageDirectoryFactory::restoreBlobStats(const PageDirectoryPtr & dir)
+{
+    // After all entries restored to the MVCC table, only apply
+    // the latest entry to `blob_stats`, or we may meet error since
+    // some entries may be removed in memory but not get compacted
+    // in the log file.
+    // We should restore the entry to `blob_stats` even if it is marked as "deleted",
+    // or we will mistakenly reuse the space to write other blobs down into that space.
+    // So we need to use `getLastEntry` instead of `getEntry(version)` here.
+    if (restore_concurrency <= 1)
+    {
+        for (const auto & shard : dir->mvcc_table_shards)
+        {
+            for (const auto & [page_id, entries] : shard.table)
             {
-                blob_stats->restoreByEntry(*entry);
+                (void)page_id;
+                if (auto entry = entries->getLastEntry(); entry)
+                {
+                    blob_stats->restoreByEntry(*entry);
+                }
             }
         }
 
         blob_stats->restore();
+        return;
     }
 
-    return dir;
+    // The space map of each blob is only modified by one thread, the blobs are dispatched by their id.
+    std::unordered_map<BlobFileId, BlobStore::BlobStats::BlobStatPtr> stats_by_id;
+    for (const auto & [path, stats] : blob_stats->getStats())
+    {
+        (void)path;
+        for (const auto & stat : stats)
+            stats_by_id.emplace(stat->id, stat);
+    }
+
+    ::ThreadPool pool(restore_concurrency);
+    for (size_t worker = 0; worker < restore_concurrency; ++worker)
+    {
+        pool.schedule([&, worker] {
+            for (const auto & shard : dir->mvcc_table_shards)
+            {
+                for (const auto & [page_id, entries] : shard.table)
+                {
+                    (void)page_id;
+                    auto entry = entries->getLastEntry();
+                    if (!entry || entry->file_id % restore_concurrency != worker)
+                        continue;
+                    auto iter = stats_by_id.find(entry->file_id);
+                    if (unlikely(iter == stats_by_id.end()))
+                    {
+                        throw Exception(fmt::format("Can't find BlobStat with [blob_id={}]", entry->file_id), ErrorCodes::LOGICAL_ERROR);
+                    }
+                    iter->second->restoreSpaceMap(entry->offset, entry->getTotalSize());
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    blob_stats->restore(restore_concurrency);
 }
 
 void PageDirectoryFactory::loadEdit(const PageDirectoryPtr & dir, const PageEntriesEdit & edit)
@@ -128,13 +186,16 @@ void PageDirectoryFactory::applyRecord(
     const PageDirectoryPtr & dir,
     const PageEntriesEdit::EditRecord & r)
 {
-    auto [iter, created] = dir->mvcc_table_directory.insert(std::make_pair(r.page_id, nullptr));
+    // Restoring is done by one thread, no need to acquire the locks of the shards.
+    auto & table = dir->mvcc_table_shards[PageDirectory::shardIndex(r.page_id)].table;
+    auto [iter, created] = table.insert(std::make_pair(r.page_id, nullptr));
     if (created)
     {
         iter->second = std::make_shared<VersionedPageEntries>();
     }
 
-    dir->max_page_id = std::max(dir->max_page_id, r.page_id.low);
+    if (r.page_id.low > dir->max_page_id.load())
+        dir->max_page_id.store(r.page_id.low);
 
     const auto & version_list = iter->second;
     const auto & restored_version = r.version;
@@ -174,11 +235,11 @@ void PageDirectoryFactory::applyRecord(
             version_list->createDelete(restored_version);
             break;
         case EditRecordType::REF:
-            PageDirectory::applyRefEditRecord(
-                dir->mvcc_table_directory,
+            dir->applyRefEditRecord(
                 version_list,
                 r,
-                restored_version);
+                restored_version,
+                /*shard_locks*/ nullptr);
             break;
         case EditRecordType::UPSERT:
             version_list->createNewEntry(restored_version, r.entry);
@@ -211,5 +272,60 @@ void PageDirectoryFactory::loadFromDisk(const PageDirectoryPtr & dir, WALStoreRe
         loadEdit(dir, edit);
     }
 }
+
+void PageDirectoryFactory::loadFromDiskConcurrently(const PageDirectoryPtr & dir, std::vector<WALStoreReaderPtr> && readers)
+{
+    // Read all the edits of a file
+    auto read_file = [](const WALStoreReaderPtr & reader) {
+        std::vector<PageEntriesEdit> edits;
+        while (reader->remained())
+        {
+            auto [ok, edit] = reader->next();
+            if (!ok)
+            {
+                reader->throwIfError();
+                break;
+            }
+            edits.emplace_back(std::move(edit));
+        }
+        return edits;
+    };
+
+    // The files are decoded concurrently in batches of `restore_concurrency` files, while the edits
+    // of the previous batch are being applied in order. The edits can not be applied concurrently
+    // because the ref records depend on the state of other pages at their versions.
+    ::ThreadPool pool(restore_concurrency);
+    std::vector<std::vector<PageEntriesEdit>> decoding;
+    std::vector<std::vector<PageEntriesEdit>> decoded;
+    auto schedule_batch = [&](size_t begin) {
+        const size_t end = std::min(begin + restore_concurrency, readers.size());
+        decoding.clear();
+        decoding.resize(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            pool.schedule([&, i, begin] {
+                decoding[i - begin] = read_file(readers[i]);
+                readers[i].reset();
+            });
+        }
+    };
+
+    if (!readers.empty())
+        schedule_batch(0);
+    for (size_t begin = 0; begin < readers.size(); begin += restore_concurrency)
+    {
+        pool.wait();
+        decoded.swap(decoding);
+        if (begin + restore_concurrency < readers.size())
+            schedule_batch(begin + restore_concurrency);
+
+        for (auto & edits : decoded)
+        {
+            for (const auto & edit : edits)
+                loadEdit(dir, edit);
+            edits = {};
+        }
+    }
+}
 } // namespace PS::V3
 } // namespace DB
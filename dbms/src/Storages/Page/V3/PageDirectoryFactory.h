@@ -53,6 +53,13 @@ public:
     // just for test
     PageDirectoryPtr createFromEdit(String storage_name, FileProviderPtr & file_provider, PSDiskDelegatorPtr & delegator, const PageEntriesEdit & edit);
 
+    // The number of threads for decoding WAL files and restoring `blob_stats`.
+    PageDirectoryFactory & setRestoreConcurrency(size_t restore_concurrency_)
+    {
+        restore_concurrency = std::max<size_t>(restore_concurrency_, 1);
+        return *this;
+    }
+
     // just for test
     PageDirectoryFactory & setBlobStats(BlobStore::BlobStats & blob_stats_)
     {
@@ -62,12 +69,15 @@ public:
 
 private:
     void loadFromDisk(const PageDirectoryPtr & dir, WALStoreReaderPtr && reader);
+    void loadFromDiskConcurrently(const PageDirectoryPtr & dir, std::vector<WALStoreReaderPtr> && readers);
     void loadEdit(const PageDirectoryPtr & dir, const PageEntriesEdit & edit);
+    void restoreBlobStats(const PageDirectoryPtr & dir);
     static void applyRecord(
         const PageDirectoryPtr & dir,
         const PageEntriesEdit::EditRecord & r);
 
     BlobStore::BlobStats * blob_stats = nullptr;
+    size_t restore_concurrency = 1;
 };
 
 } // namespace PS::V3
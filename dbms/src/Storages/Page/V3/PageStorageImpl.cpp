@@ -46,12 +46,12 @@ PageStorageImpl::~PageStorageImpl() = default;
 void PageStorageImpl::restore()
 {
     // TODO: clean up blobstore.
-    // TODO: Speedup restoring
     blob_store.registerPaths();
 
     PageDirectoryFactory factory;
     page_directory = factory
                          .setBlobStore(blob_store)
+                         .setRestoreConcurrency(config.restore_concurrency)
                          .create(storage_name, file_provider, delegator, parseWALConfig(config));
 }
 
@@ -44,7 +44,10 @@ public:
         blob_config.cached_fd_size = config.blob_cached_fd_size;
         blob_config.spacemap_type = config.blob_spacemap_type;
         blob_config.heavy_gc_valid_rate = config.blob_heavy_gc_valid_rate;
+        blob_config.heavy_gc_max_bytes_per_round = config.blob_heavy_gc_max_bytes_per_round;
         blob_config.block_alignment_bytes = config.blob_block_alignment_bytes;
+        blob_config.page_cache_size = config.blob_page_cache_size;
+        blob_config.prealloc_bytes = config.blob_prealloc_bytes;
 
         return blob_config;
     }
@@ -191,6 +191,22 @@ std::tuple<bool, PageEntriesEdit> WALStoreReader::next()
     } while (true);
 }
 
+std::vector<WALStoreReaderPtr> WALStoreReader::splitByFile(const String & storage_name)
+{
+    std::vector<WALStoreReaderPtr> readers;
+    auto add_reader = [&](std::optional<LogFilename> checkpoint, LogFilenameSet && files) {
+        auto reader = std::make_shared<WALStoreReader>(storage_name, provider, checkpoint, std::move(files), recovery_mode, read_limiter);
+        reader->openNextFile();
+        readers.emplace_back(std::move(reader));
+    };
+    if (checkpoint_file)
+        add_reader(checkpoint_file, LogFilenameSet{});
+    for (const auto & file : files_to_read)
+        add_reader(std::nullopt, LogFilenameSet{file});
+    reader.reset();
+    return readers;
+}
+
 bool WALStoreReader::openNextFile()
 {
     if (checkpoint_read_done && next_reading_file == files_to_read.end())
@@ -73,6 +73,10 @@ public:
 
     std::tuple<bool, PageEntriesEdit> next();
 
+    // Split into the readers of each file in the reading order, so that the files can be decoded
+    // concurrently. This reader should not be used after splitting.
+    std::vector<WALStoreReaderPtr> splitByFile(const String & storage_name);
+
     void throwIfError() const
     {
         if (reporter.hasError())
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Common/Logger.h>
+#include <Common/ProfileEvents.h>
 #include <Encryption/RateLimiter.h>
 #include <IO/ReadBufferFromMemory.h>
 #include <Poco/Logger.h>
@@ -28,6 +29,11 @@
 #include <TestUtils/MockReadLimiter.h>
 #include <TestUtils/TiFlashTestBasic.h>
 
+namespace ProfileEvents
+{
+extern const Event PSMReadIOCalls;
+} // namespace ProfileEvents
+
 namespace DB::PS::V3::tests
 {
 using BlobStat = BlobStore::BlobStats::BlobStat;
@@ -583,6 +589,127 @@ TEST_F(BlobStoreTest, testWriteRead)
     ASSERT_EQ(index, buff_nums);
 }
 
+TEST_F(BlobStoreTest, ReadWithPageCache)
+try
+{
+    const auto file_provider = DB::tests::TiFlashTestEnv::getContext().getFileProvider();
+
+    PageId page_id = 50;
+    size_t buff_nums = 5;
+    size_t buff_size = 123;
+
+    auto cache_config = config;
+    cache_config.page_cache_size = 1024 * 1024;
+    auto blob_store = BlobStore(getCurrentTestName(), file_provider, delegator, cache_config);
+    char c_buff[buff_size * buff_nums];
+    for (size_t i = 0; i < buff_size * buff_nums; ++i)
+        c_buff[i] = static_cast<char>(i & 0xff);
+
+    WriteBatch wb;
+    for (size_t i = 0; i < buff_nums; ++i)
+    {
+        ReadBufferPtr buff = std::make_shared<ReadBufferFromMemory>(const_cast<char *>(c_buff + i * buff_size), buff_size);
+        wb.putPage(page_id + i, /* tag */ 0, buff, buff_size);
+    }
+    PageEntriesEdit edit = blob_store.write(wb, nullptr);
+    ASSERT_EQ(edit.size(), buff_nums);
+
+    PageIDAndEntriesV3 entries;
+    for (size_t i = 0; i < buff_nums; ++i)
+        entries.emplace_back(buildV3Id(TEST_NAMESPACE_ID, page_id + i), edit.getRecords()[i].entry);
+
+    auto check_pages = [&](const PageMap & page_map) {
+        ASSERT_EQ(page_map.size(), buff_nums);
+        for (size_t i = 0; i < buff_nums; ++i)
+        {
+            const auto & page = page_map.at(page_id + i);
+            ASSERT_EQ(page.data.size(), buff_size);
+            ASSERT_EQ(strncmp(c_buff + i * buff_size, page.data.begin(), buff_size), 0);
+        }
+    };
+
+    // Only the first page is cached by the single read
+    {
+        auto page = blob_store.read(entries[0]);
+        ASSERT_EQ(strncmp(c_buff, page.data.begin(), buff_size), 0);
+        ASSERT_EQ(blob_store.page_cache->count(), 1);
+    }
+    // The rest are read from disk and then cached
+    check_pages(blob_store.read(entries));
+    ASSERT_EQ(blob_store.page_cache->count(), buff_nums);
+
+    // All pages can be read without the data on disk
+    blob_store.getBlobFile(1)->truncate(0);
+    check_pages(blob_store.read(entries));
+    {
+        auto page = blob_store.read(entries[buff_nums - 1]);
+        ASSERT_EQ(strncmp(c_buff + (buff_nums - 1) * buff_size, page.data.begin(), buff_size), 0);
+    }
+
+    // The cached pages are invalidated after being removed
+    PageEntriesV3 entries_del;
+    for (const auto & [id, entry] : entries)
+    {
+        (void)id;
+        entries_del.emplace_back(entry);
+    }
+    blob_store.remove(entries_del);
+    ASSERT_EQ(blob_store.page_cache->count(), 0);
+}
+CATCH
+
+TEST_F(BlobStoreTest, WriteWithPreallocation)
+try
+{
+    const auto file_provider = DB::tests::TiFlashTestEnv::getContext().getFileProvider();
+
+    PageId page_id = 50;
+    size_t buff_nums = 5;
+    size_t buff_size = 123;
+
+    auto prealloc_config = config;
+    prealloc_config.prealloc_bytes = 1024 * 1024;
+    auto blob_store = BlobStore(getCurrentTestName(), file_provider, delegator, prealloc_config);
+    char c_buff[buff_size * buff_nums];
+    for (size_t i = 0; i < buff_size * buff_nums; ++i)
+        c_buff[i] = static_cast<char>(i & 0xff);
+
+    PageIDAndEntriesV3 entries;
+    for (size_t i = 0; i < buff_nums; ++i)
+    {
+        WriteBatch wb;
+        ReadBufferPtr buff = std::make_shared<ReadBufferFromMemory>(const_cast<char *>(c_buff + i * buff_size), buff_size);
+        wb.putPage(page_id + i, /* tag */ 0, buff, buff_size);
+        PageEntriesEdit edit = blob_store.write(wb, nullptr);
+        ASSERT_EQ(edit.size(), 1);
+        entries.emplace_back(buildV3Id(TEST_NAMESPACE_ID, page_id + i), edit.getRecords()[0].entry);
+    }
+
+    // The reserved space does not change the size of the blob file
+    Poco::File blob_file(blob_store.getBlobFile(1)->getPath());
+    ASSERT_EQ(blob_file.getSize(), buff_size * buff_nums);
+
+    auto page_map = blob_store.read(entries);
+    ASSERT_EQ(page_map.size(), buff_nums);
+    for (size_t i = 0; i < buff_nums; ++i)
+    {
+        const auto & page = page_map.at(page_id + i);
+        ASSERT_EQ(page.data.size(), buff_size);
+        ASSERT_EQ(strncmp(c_buff + i * buff_size, page.data.begin(), buff_size), 0);
+    }
+
+    // Still writable after the reserved space is released by truncating
+    blob_store.getBlobFile(1)->truncate(0);
+    ASSERT_EQ(blob_file.getSize(), 0);
+    WriteBatch wb;
+    ReadBufferPtr buff = std::make_shared<ReadBufferFromMemory>(const_cast<char *>(c_buff), buff_size);
+    wb.putPage(page_id, /* tag */ 0, buff, buff_size);
+    PageEntriesEdit edit = blob_store.write(wb, nullptr);
+    auto page = blob_store.read(std::make_pair(buildV3Id(TEST_NAMESPACE_ID, page_id), edit.getRecords()[0].entry));
+    ASSERT_EQ(strncmp(c_buff, page.data.begin(), buff_size), 0);
+}
+CATCH
+
 TEST_F(BlobStoreTest, testWriteReadWithIOLimiter)
 {
     const auto file_provider = DB::tests::TiFlashTestEnv::getContext().getFileProvider();
@@ -1149,6 +1276,56 @@ TEST_F(BlobStoreTest, testBlobStoreGcStats2)
     ASSERT_EQ(*gc_stats.begin(), 1);
 }
 
+TEST_F(BlobStoreTest, GCStatsLimitBytesPerRound)
+{
+    const auto file_provider = DB::tests::TiFlashTestEnv::getContext().getFileProvider();
+    size_t buff_size = 1024;
+    size_t buff_nums = 10;
+    PageId page_id = 50;
+    auto gc_config = config;
+    // One write batch per blob
+    gc_config.file_limit_size = buff_size * buff_nums;
+    gc_config.heavy_gc_valid_rate = 0.5;
+    gc_config.heavy_gc_max_bytes_per_round = buff_size * 3;
+    auto blob_store = BlobStore(getCurrentTestName(), file_provider, delegator, gc_config);
+
+    char c_buff[buff_size * buff_nums];
+    memset(c_buff, 0x1, buff_size * buff_nums);
+    // blob 1 remain 2 pages, blob 2 remain 1 page, blob 3 remain 4 pages
+    for (size_t num_remain : {2, 1, 4})
+    {
+        WriteBatch wb;
+        for (size_t i = 0; i < buff_nums; ++i)
+        {
+            ReadBufferPtr buff = std::make_shared<ReadBufferFromMemory>(const_cast<char *>(c_buff + i * buff_size), buff_size);
+            wb.putPage(page_id, /* tag */ 0, buff, buff_size);
+        }
+        auto edit = blob_store.write(wb, nullptr);
+        PageEntriesV3 entries_del;
+        for (const auto & record : edit.getRecords())
+        {
+            if (entries_del.size() + num_remain < buff_nums)
+                entries_del.emplace_back(record.entry);
+        }
+        blob_store.remove(entries_del);
+    }
+
+    // blob 2 reclaims the most space per copied byte, then blob 1. blob 3 is deferred by the limit.
+    {
+        const auto & gc_stats = blob_store.getGCStats();
+        ASSERT_EQ(gc_stats, std::vector<BlobFileId>({2, 1}));
+        ASSERT_TRUE(blob_store.blob_stats.blobIdToStat(1)->isReadOnly());
+        ASSERT_TRUE(blob_store.blob_stats.blobIdToStat(2)->isReadOnly());
+        ASSERT_FALSE(blob_store.blob_stats.blobIdToStat(3)->isReadOnly());
+    }
+    // At least one blob is picked even if it exceeds the limit
+    {
+        const auto & gc_stats = blob_store.getGCStats();
+        ASSERT_EQ(gc_stats, std::vector<BlobFileId>({3}));
+        ASSERT_TRUE(blob_store.blob_stats.blobIdToStat(3)->isReadOnly());
+    }
+}
+
 
 TEST_F(BlobStoreTest, GC)
 {
@@ -1311,6 +1488,55 @@ try
 }
 CATCH
 
+TEST_F(BlobStoreTest, ReadByFieldReadInfosMergeAdjacentFields)
+try
+{
+    const auto file_provider = DB::tests::TiFlashTestEnv::getContext().getFileProvider();
+    PageId page_id = 50;
+    size_t buff_nums = 4;
+    size_t buff_size = 20;
+
+    auto blob_store = BlobStore(getCurrentTestName(), file_provider, delegator, config);
+    char c_buff[buff_size * buff_nums];
+    for (size_t i = 0; i < buff_size * buff_nums; ++i)
+        c_buff[i] = static_cast<char>(i & 0xff);
+
+    BlobStore::FieldReadInfos read_infos;
+    for (size_t i = 0; i < buff_nums; ++i)
+    {
+        WriteBatch wb;
+        ReadBufferPtr buff = std::make_shared<ReadBufferFromMemory>(const_cast<char *>(c_buff + i * buff_size), buff_size);
+        PageFieldSizes field_sizes{1, 2, 4, 8, (buff_size - 1 - 2 - 4 - 8)};
+        wb.putPage(page_id + i, /* tag */ 0, buff, buff_size, field_sizes);
+        PageEntriesEdit edit = blob_store.write(wb, nullptr);
+        ASSERT_EQ(edit.size(), 1);
+        // Read in the reverse order and skip field 2
+        read_infos.emplace(read_infos.begin(), buildV3Id(TEST_NAMESPACE_ID, page_id + i), edit.getRecords()[0].entry, std::vector<size_t>{4, 3, 1, 0});
+    }
+
+    const auto read_calls_before = ProfileEvents::counters[ProfileEvents::PSMReadIOCalls].load();
+    auto page_map = blob_store.read(read_infos);
+    // The fields 3, 4 of a page are continuous with the fields 0, 1 of the next page in the blob file
+    ASSERT_EQ(ProfileEvents::counters[ProfileEvents::PSMReadIOCalls].load() - read_calls_before, buff_nums + 1);
+
+    ASSERT_EQ(page_map.size(), buff_nums);
+    for (size_t i = 0; i < buff_nums; ++i)
+    {
+        const auto & page = page_map.at(page_id + i);
+        const char * expected = c_buff + i * buff_size;
+        auto field_data = [&](size_t index) {
+            auto data = page.getFieldData(index);
+            return std::string_view(data.begin(), data.size());
+        };
+        ASSERT_EQ(page.fieldSize(), 4);
+        ASSERT_EQ(field_data(0), std::string_view(expected, 1));
+        ASSERT_EQ(field_data(1), std::string_view(expected + 1, 2));
+        ASSERT_EQ(field_data(3), std::string_view(expected + 7, 8));
+        ASSERT_EQ(field_data(4), std::string_view(expected + 15, buff_size - 15));
+    }
+}
+CATCH
+
 TEST_F(BlobStoreTest, TestBigBlob)
 try
 {
@@ -23,6 +23,7 @@
 #include <Storages/Page/V3/PageDirectoryFactory.h>
 #include <Storages/Page/V3/PageEntriesEdit.h>
 #include <Storages/Page/V3/PageEntry.h>
+#include <Storages/Page/V3/WAL/WALReader.h>
 #include <Storages/Page/V3/WAL/serialize.h>
 #include <Storages/Page/V3/WALStore.h>
 #include <Storages/Page/V3/tests/entries_helper.h>
@@ -34,6 +35,7 @@
 #include <fmt/format.h>
 
 #include <memory>
+#include <thread>
 
 namespace DB
 {
@@ -467,6 +469,188 @@ try
 }
 CATCH
 
+TEST_F(PageDirectoryTest, ConcurrentApply)
+try
+{
+    const size_t num_threads = 8;
+    const size_t num_edits_per_thread = 200;
+    auto make_entry = [](PageId page_id) {
+        return PageEntryV3{.file_id = 1, .size = 1024, .padded_size = 0, .tag = 0, .offset = page_id * 1024, .checksum = page_id};
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < num_edits_per_thread; ++i)
+            {
+                PageId page_id = t * num_edits_per_thread + i + 1;
+                PageEntriesEdit edit;
+                edit.put(page_id, make_entry(page_id));
+                // Every edit of one thread also updates a shared page
+                edit.put(100000 + t, make_entry(page_id));
+                dir->apply(std::move(edit));
+            }
+        });
+    }
+    for (auto & thread : threads)
+        thread.join();
+
+    auto check = [&](const PageDirectoryPtr & d) {
+        auto snap = d->createSnapshot();
+        // Every edit consumes its own sequence, no matter it is grouped with others or not
+        ASSERT_EQ(snap->sequence, num_threads * num_edits_per_thread);
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            for (size_t i = 0; i < num_edits_per_thread; ++i)
+            {
+                PageId page_id = t * num_edits_per_thread + i + 1;
+                EXPECT_ENTRY_EQ(make_entry(page_id), d, page_id, snap);
+            }
+            // The last edit of each thread wins
+            EXPECT_ENTRY_EQ(make_entry((t + 1) * num_edits_per_thread), d, 100000 + t, snap);
+        }
+    };
+    check(dir);
+
+    // The grouped WAL records can be restored
+    dir.reset();
+    dir = restoreFromDisk();
+    check(dir);
+}
+CATCH
+
+TEST_F(PageDirectoryTest, ConcurrentReadWriteGC)
+try
+{
+    const PageId num_edits = 1000;
+    const PageId ref_id_base = 100001; // make the ref and the ori page live in different shards
+    auto make_entry = [](PageId page_id) {
+        return PageEntryV3{.file_id = 1, .size = 1024, .padded_size = 0, .tag = 0, .offset = page_id * 1024, .checksum = page_id};
+    };
+
+    std::atomic<bool> finished = false;
+    std::thread writer([&]() {
+        for (PageId page_id = 1; page_id <= num_edits; ++page_id)
+        {
+            PageEntriesEdit edit;
+            edit.put(page_id, make_entry(page_id));
+            edit.ref(ref_id_base + page_id, page_id);
+            if (page_id > 1)
+                edit.del(page_id - 1);
+            dir->apply(std::move(edit));
+        }
+        finished = true;
+    });
+    std::thread gc([&]() {
+        while (!finished)
+            dir->gcInMemEntries();
+    });
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&]() {
+            while (!finished)
+            {
+                auto snap = dir->createSnapshot();
+                const PageId seq = snap->sequence;
+                if (seq == 0)
+                    continue;
+                EXPECT_ENTRY_EQ(make_entry(seq), dir, seq, snap);
+                for (PageId page_id = seq > 10 ? seq - 10 : 1; page_id <= seq; ++page_id)
+                    EXPECT_ENTRY_EQ(make_entry(page_id), dir, ref_id_base + page_id, snap);
+                if (seq > 1)
+                    EXPECT_ENTRY_NOT_EXIST(dir, seq - 1, snap);
+            }
+        });
+    }
+    writer.join();
+    gc.join();
+    for (auto & reader : readers)
+        reader.join();
+
+    dir->gcInMemEntries();
+    auto snap = dir->createSnapshot();
+    ASSERT_EQ(snap->sequence, num_edits);
+    ASSERT_EQ(dir->getMaxId(), ref_id_base + num_edits);
+    // The deleted pages are kept because of being ref, and one for each ref
+    ASSERT_EQ(dir->numPages(), 2 * num_edits);
+    for (PageId page_id = 1; page_id <= num_edits; ++page_id)
+        EXPECT_ENTRY_EQ(make_entry(page_id), dir, ref_id_base + page_id, snap);
+}
+CATCH
+
+TEST_F(PageDirectoryTest, ConcurrentRestore)
+try
+{
+    auto path = getTemporaryPath();
+    auto provider = DB::tests::TiFlashTestEnv::getContext().getFileProvider();
+    PSDiskDelegatorPtr delegator = std::make_shared<DB::tests::MockDiskDelegatorSingle>(path);
+    WALStore::Config config;
+    // Roll to many small log files
+    config.roll_size = 1024;
+    const BlobFileId num_blobs = 4;
+    auto restore = [&](size_t concurrency, BlobStore::BlobStats & stats) {
+        {
+            const auto & lock = stats.lock();
+            for (BlobFileId id = 1; id <= num_blobs; ++id)
+                stats.createStatNotChecking(id, lock);
+        }
+        PageDirectoryFactory factory;
+        return factory.setBlobStats(stats).setRestoreConcurrency(concurrency).create("PageDirectoryTest", provider, delegator, config);
+    };
+    auto make_entry = [](PageId page_id) {
+        return PageEntryV3{.file_id = page_id % num_blobs + 1, .size = 50, .padded_size = 0, .tag = 0, .offset = page_id * 100, .checksum = page_id};
+    };
+
+    const PageId num_pages = 300;
+    {
+        dir.reset();
+        BlobStore::BlobStats stats(log, delegator, BlobStore::Config{});
+        dir = restore(1, stats);
+        for (PageId page_id = 1; page_id <= num_pages; ++page_id)
+        {
+            PageEntriesEdit edit;
+            edit.put(page_id, make_entry(page_id));
+            if (page_id % 10 == 0)
+                edit.ref(page_id + 1000, page_id);
+            if (page_id % 7 == 0)
+                edit.del(page_id - 5);
+            dir->apply(std::move(edit));
+        }
+    }
+    ASSERT_GT(WALStoreReader::listAllFiles(delegator, log).size(), 10);
+
+    auto check = [&](const PageDirectoryPtr & d, BlobStore::BlobStats & stats) {
+        auto snap = d->createSnapshot();
+        ASSERT_EQ(snap->sequence, num_pages);
+        for (PageId page_id = 1; page_id <= num_pages; ++page_id)
+        {
+            const auto entry = make_entry(page_id);
+            const bool deleted = page_id + 5 <= num_pages && (page_id + 5) % 7 == 0;
+            if (deleted)
+                EXPECT_ENTRY_NOT_EXIST(d, page_id, snap);
+            else
+                EXPECT_ENTRY_EQ(entry, d, page_id, snap);
+            if (page_id % 10 == 0)
+                EXPECT_ENTRY_EQ(entry, d, page_id + 1000, snap);
+            if (!deleted || page_id % 10 == 0)
+            {
+                auto stat = stats.blobIdToStat(entry.file_id);
+                EXPECT_TRUE(stat->smap->isMarkUsed(entry.offset, entry.size)) << page_id;
+            }
+        }
+    };
+    for (size_t concurrency : {1, 4})
+    {
+        dir.reset();
+        BlobStore::BlobStats stats(log, delegator, BlobStore::Config{});
+        dir = restore(concurrency, stats);
+        check(dir, stats);
+    }
+}
+CATCH
+
 TEST_F(PageDirectoryTest, TestRefWontDeadLock)
 {
     PageEntriesEdit edit;
@@ -1367,23 +1551,27 @@ try
 
     /**
      * after GC =>  {
-     *     50  -> [v3,v4,v5]
+     *     50  -> [v3,v5]
      *   }
      *   snapshot remain: [v3,v5]
      */
     auto del_entries = dir->gcInMemEntries();
-    // v1, v2 have been removed.
-    ASSERT_EQ(del_entries.size(), 2);
+    // v1, v2 have been removed, and v4 is not visible to any snapshot.
+    ASSERT_EQ(del_entries.size(), 3);
 
     EXPECT_ENTRY_EQ(entry_v3, dir, page_id, snapshot3);
     EXPECT_ENTRY_EQ(entry_v5, dir, page_id, snapshot5);
+    // The outdated v3 is pinned by snapshot3.
+    EXPECT_EQ(snapshot3->pinned_bytes.load(), entry_v3.size);
+    EXPECT_EQ(snapshot5->pinned_bytes.load(), 0);
+    EXPECT_EQ(dir->getSnapshotsStat().most_pinned_bytes, entry_v3.size);
 
     // Release all snapshots and run gc again, (min gc version get pushed forward and)
     // all versions get compacted.
     snapshot3.reset();
     snapshot5.reset();
     del_entries = dir->gcInMemEntries();
-    ASSERT_EQ(del_entries.size(), 2);
+    ASSERT_EQ(del_entries.size(), 1);
 
     auto snapshot_after_gc = dir->createSnapshot();
     EXPECT_ENTRY_EQ(entry_v5, dir, page_id, snapshot_after_gc);
@@ -1419,14 +1607,14 @@ try
     {
         /**
          * after GC => {
-         *     50  -> [v5,v10]
-         *     512 -> [v3,v4,v6,v7,v8,v9]
+         *     50  -> [v2,v5,v10]
+         *     512 -> [v3,v4,v9]
          *   }
          *   snapshot remain: [v3, v5]
          */
         const auto & del_entries = dir->gcInMemEntries();
-        // page_id: []; another_page_id: v1 have been removed.
-        EXPECT_EQ(del_entries.size(), 1);
+        // page_id: []; another_page_id: v1, and v6,v7,v8 which are not visible to any snapshot have been removed.
+        EXPECT_EQ(del_entries.size(), 4);
     }
 
     {
@@ -1434,7 +1622,7 @@ try
         /**
          * after GC => {
          *     50  -> [v5,v10]
-         *     512 -> [v6,v7,v8,v9]
+         *     512 -> [v4,v9]
          *   }
          *   snapshot remain: [v5]
          */
@@ -1453,8 +1641,8 @@ try
          *   snapshot remain: []
          */
         const auto & del_entries = dir->gcInMemEntries();
-        // page_id: v5; another_page_id: v6,v7,v8 have been removed.
-        EXPECT_EQ(del_entries.size(), 5);
+        // page_id: v5; another_page_id: v4 have been removed.
+        EXPECT_EQ(del_entries.size(), 2);
     }
 }
 CATCH
@@ -1494,12 +1682,13 @@ try
         /**
          * after GC => [
          *     50  -> [v3,v5,v10]
-         *     512 -> [v1,v2,v4,v6,v7,v8,v9]
+         *     512 -> [v1,v2,v4,v9]
          *   }
          *   snapshot remain: [v1,v3,v5,v10]
          */
-        auto removed_entries = dir->gcInMemEntries(); // The GC on page_id=50 is blocked by previous `snapshot1`
-        EXPECT_EQ(removed_entries.size(), 0);
+        // The old `snapshot1` only pins the versions visible to it, another_page_id: v6,v7,v8 get removed
+        auto removed_entries = dir->gcInMemEntries();
+        EXPECT_EQ(removed_entries.size(), 3);
         EXPECT_ENTRY_EQ(entry_v1, dir, another_page_id, snapshot1);
         EXPECT_ENTRY_NOT_EXIST(dir, page_id, snapshot1);
         EXPECT_ENTRY_EQ(entry_v3, dir, page_id, snapshot3);
@@ -1509,18 +1698,19 @@ try
     {
         /**
          * after GC => [
-         *     50  -> [v3,v5,v10]
-         *     512 -> [v1,v2,v4,v6,v7,v8,v9]
+         *     50  -> [v10]
+         *     512 -> [v1,v9]
          *   }
          *   snapshot remain: [v1]
          */
-        // The GC on page_id=50 is blocked by previous `snapshot1`,
-        // release other snapshot won't change the result from `snapshot1`
+        // Release other snapshots, the versions only visible to them get removed,
+        // page_id: v3,v5; another_page_id: v2,v4 get removed.
+        // It won't change the result from `snapshot1`
         snapshot3.reset();
         snapshot5.reset();
         snapshot10.reset();
         auto removed_entries = dir->gcInMemEntries();
-        EXPECT_EQ(removed_entries.size(), 0);
+        EXPECT_EQ(removed_entries.size(), 4);
         EXPECT_ENTRY_EQ(entry_v1, dir, another_page_id, snapshot1);
         EXPECT_ENTRY_NOT_EXIST(dir, page_id, snapshot1);
     }
@@ -1535,8 +1725,8 @@ try
          */
         snapshot1.reset();
         auto removed_entries = dir->gcInMemEntries(); // this will compact all versions
-        // page_id: v3,v5; another_page_id: v1,v2,v4,v6,v7,v8 get removed
-        EXPECT_EQ(removed_entries.size(), 8);
+        // another_page_id: v1 get removed
+        EXPECT_EQ(removed_entries.size(), 1);
 
         auto snap_after_gc = dir->createSnapshot();
         EXPECT_ENTRY_EQ(entry_v10, dir, page_id, snap_after_gc);
@@ -1587,13 +1777,13 @@ try
         /**
          * after GC => [
          *     50  -> [v5,v8(delete)]
-         *     512 -> [v4,v6,v8,v9,v10(delete)]
+         *     512 -> [v4,v8,v9,v10(delete)]
          *   }
          *   snapshot remain: [v5,v8,v9]
          */
         auto del_entries = dir->gcInMemEntries();
-        // page_id: v3; another_page_id: v1,v2 have been removed.
-        EXPECT_EQ(del_entries.size(), 3);
+        // page_id: v3; another_page_id: v1,v2, and v6,v7 which are not visible to any snapshot have been removed.
+        EXPECT_EQ(del_entries.size(), 5);
         ASSERT_EQ(dir->numPages(), 2);
     }
 
@@ -1610,8 +1800,8 @@ try
         EXPECT_ENTRY_NOT_EXIST(dir, page_id, snapshot9);
         EXPECT_ENTRY_EQ(entry_v9, dir, another_page_id, snapshot9);
         auto del_entries = dir->gcInMemEntries();
-        // page_id: v5; another_page_id: v4,v6,v7 have been removed.
-        EXPECT_EQ(del_entries.size(), 4);
+        // page_id: v5; another_page_id: v4 have been removed.
+        EXPECT_EQ(del_entries.size(), 2);
         ASSERT_EQ(dir->numPages(), 1); // page_id should be removed.
     }
 
@@ -182,7 +182,7 @@ private:
         PageStorage::Config config;
         PageStorageImpl ps_v3("PageStorageControlV3", delegator, config, file_provider_ptr);
         ps_v3.restore();
-        PageDirectory::MVCCMapType & mvcc_table_directory = ps_v3.page_directory->mvcc_table_directory;
+        PageDirectory::MVCCMapType mvcc_table_directory = ps_v3.page_directory->mergeMVCCTableShards();
 
         switch (options.display_mode)
         {
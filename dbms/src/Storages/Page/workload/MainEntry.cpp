@@ -21,7 +21,11 @@
 #include <Storages/Page/workload/PSStressEnv.h>
 #include <Storages/Page/workload/PSWorkload.h>
 #include <Storages/Page/workload/PageStorageInMemoryCapacity.h>
+#include <Storages/Page/workload/RestoreTime.h>
+#include <Storages/Page/workload/SkewBlobGC.h>
+#include <Storages/Page/workload/SnapshotPinnedGC.h>
 #include <Storages/Page/workload/ThousandsOfOffset.h>
+#include <Storages/Page/workload/WALWriteLatency.h>
 
 using namespace DB::PS::tests;
 
@@ -37,6 +41,10 @@ int StressWorkload::mainEntry(int argc, char ** argv)
         work_load_register<PageStorageInMemoryCapacity>();
         work_load_register<NormalWorkload>();
         work_load_register<ThousandsOfOffset>();
+        work_load_register<WALWriteLatency>();
+        work_load_register<SkewBlobGC>();
+        work_load_register<RestoreTime>();
+        work_load_register<SnapshotPinnedGC>();
     }
     try
     {
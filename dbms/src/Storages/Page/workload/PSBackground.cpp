@@ -79,11 +79,13 @@ void PSScanner::onTime(Poco::Timer & /*timer*/)
         auto stat = ps->getSnapshotsStat();
         LOG_FMT_INFO(
             StressEnv::logger,
-            "Scanner get {} snapshots, longest lifetime: {:.3f}s longest from thread: {}, tracing_id: {}",
+            "Scanner get {} snapshots, longest lifetime: {:.3f}s longest from thread: {}, tracing_id: {}, most pinned bytes: {} tracing_id: {}",
             stat.num_snapshots,
             stat.longest_living_seconds,
             stat.longest_living_from_thread_id,
-            stat.longest_living_from_tracing_id);
+            stat.longest_living_from_tracing_id,
+            stat.most_pinned_bytes,
+            stat.most_pinned_from_tracing_id);
     }
     catch (...)
     {
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Common/MemoryTracker.h>
+#include <Common/Stopwatch.h>
 #include <Common/formatReadable.h>
 #include <Encryption/MockKeyManager.h>
 #include <IO/ReadBufferFromMemory.h>
@@ -186,7 +187,10 @@ bool PSCommonWriter::runImpl()
         bytes_used += buffptr->buffer().size();
     }
 
+    Stopwatch watch;
     ps->write(std::move(wb));
+    if (record_latency)
+        write_latencies_us.push_back(watch.elapsedMicroseconds());
     return (batch_buffer_limit == 0 || bytes_used < batch_buffer_limit);
 }
 
@@ -195,6 +199,11 @@ void PSCommonWriter::setBatchBufferNums(size_t numbers)
     batch_buffer_nums = numbers;
 }
 
+void PSCommonWriter::setRecordLatency(bool record_latency_)
+{
+    record_latency = record_latency_;
+}
+
 void PSCommonWriter::setBatchBufferSize(size_t size)
 {
     batch_buffer_size = size;
@@ -111,6 +111,11 @@ public:
 
     void setFieldSize(const DB::PageFieldSizes & data_sizes);
 
+    void setRecordLatency(bool record_latency_);
+
+    // The latency (in microseconds) of each write batch, only recorded when `record_latency` is set.
+    std::vector<UInt64> write_latencies_us;
+
 protected:
     std::vector<DB::ReadBufferPtr> buff_ptrs;
     size_t batch_buffer_nums = 100;
@@ -122,6 +127,8 @@ protected:
 
     DB::PageFieldSizes data_sizes = {};
 
+    bool record_latency = false;
+
     DB::PageId genRandomPageId() override;
     virtual size_t genBufferSize();
 };
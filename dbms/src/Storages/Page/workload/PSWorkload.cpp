@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/FmtUtils.h>
 #include <Common/MemoryTracker.h>
 #include <Encryption/MockKeyManager.h>
+#include <Poco/File.h>
 #include <Poco/Logger.h>
 #include <Storages/Page/V2/PageStorage.h>
 #include <Storages/Page/V3/PageStorageImpl.h>
@@ -65,7 +67,7 @@ void StressWorkload::onDumpResult()
     }
 }
 
-void StressWorkload::initPageStorage(DB::PageStorage::Config & config, String path_prefix)
+void StressWorkload::createPageStorage(DB::PageStorage::Config & config, String path_prefix)
 {
     DB::FileProviderPtr file_provider = std::make_shared<DB::FileProvider>(std::make_shared<DB::MockKeyManager>(false), false);
 
@@ -98,7 +100,11 @@ void StressWorkload::initPageStorage(DB::PageStorage::Config & config, String pa
         throw DB::Exception(fmt::format("Invalid PageStorage version {}",
                                         options.running_ps_version));
     }
+}
 
+void StressWorkload::initPageStorage(DB::PageStorage::Config & config, String path_prefix)
+{
+    createPageStorage(config, path_prefix);
     ps->restore();
 
     {
@@ -111,6 +117,42 @@ void StressWorkload::initPageStorage(DB::PageStorage::Config & config, String pa
     }
 }
 
+void StressWorkload::dumpJsonResult(const String & workload, const std::vector<std::pair<String, double>> & fields)
+{
+    FmtBuffer buf;
+    buf.fmtAppend(R"({{"workload":"{}")", workload);
+    for (const auto & [key, value] : fields)
+        buf.fmtAppend(R"(,"{}":{:.3f})", key, value);
+    buf.append("}\n");
+    fmt::print(stdout, "{}", buf.toString());
+    fflush(stdout);
+}
+
+double StressWorkload::percentile(std::vector<UInt64> & values, double p)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(std::ceil(p * values.size())) - 1);
+    return values[index];
+}
+
+size_t StressWorkload::getDirectorySize(const String & path)
+{
+    Poco::File dir(path);
+    if (!dir.exists())
+        return 0;
+    if (!dir.isDirectory())
+        return dir.getSize();
+
+    size_t total_size = 0;
+    std::vector<std::string> children;
+    dir.list(children);
+    for (const auto & child : children)
+        total_size += getDirectorySize(path + "/" + child);
+    return total_size;
+}
+
 void StressWorkload::startBackgroundTimer()
 {
     // A background thread that do GC
@@ -65,8 +65,20 @@ public:
     virtual void onDumpResult();
 
 protected:
+    // Create the PageStorage without restoring it.
+    void createPageStorage(DB::PageStorage::Config & config, String path_prefix = "");
+
     void initPageStorage(DB::PageStorage::Config & config, String path_prefix = "");
 
+    // Print the result as one line of json to stdout, so that it can be collected by scripts.
+    // The logs are printed to stderr, so they won't mix up with the results.
+    static void dumpJsonResult(const String & workload, const std::vector<std::pair<String, double>> & fields);
+
+    // Return the `p`-th percentile (0 < p <= 1) of `values`, `values` will be sorted.
+    static double percentile(std::vector<UInt64> & values, double p);
+
+    static size_t getDirectorySize(const String & path);
+
     void startBackgroundTimer();
 
     template <typename T>
@@ -0,0 +1,115 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <IO/ReadBufferFromMemory.h>
+#include <Storages/Page/workload/PSWorkload.h>
+
+namespace DB::PS::tests
+{
+// Write different numbers of small pages into PageStorage V3, then report the
+// time cost of restoring the PageStorage against the number of pages.
+class RestoreTime : public StressWorkload
+    , public StressWorkloadFunc<RestoreTime>
+{
+public:
+    explicit RestoreTime(const StressEnv & options_)
+        : StressWorkload(options_)
+    {}
+
+    static String name()
+    {
+        return "RestoreTime";
+    }
+
+    static UInt64 mask()
+    {
+        return 1 << 10;
+    }
+
+private:
+    String desc() override
+    {
+        return fmt::format("Some of options will be ignored"
+                           "`paths` will only used first one. which is {}. Data will store in {} ."
+                           "Please cleanup folder after this test."
+                           "Only PageStorage V3 is supported."
+                           "The current workload will write {} pages and restore the PageStorage.",
+                           options.paths[0],
+                           options.paths[0] + "/" + name(),
+                           fmt::join(page_nums, ","));
+    }
+
+    void run() override
+    {
+        if (options.running_ps_version != 3)
+            throw DB::Exception(fmt::format("{} only support PageStorage V3", name()));
+
+        stop_watch.start();
+        for (auto page_num : page_nums)
+        {
+            const auto path_prefix = fmt::format("{}/{}", name(), page_num);
+            DB::PageStorage::Config config;
+            initPageStorage(config, path_prefix);
+            writePages(page_num);
+            // Release the PageStorage before restoring it again.
+            ps.reset();
+
+            Stopwatch restore_watch;
+            createPageStorage(config, path_prefix);
+            ps->restore();
+            restore_ms.push_back(restore_watch.elapsedMilliseconds());
+            data_size.push_back(getDirectorySize(options.paths[0] + "/" + path_prefix));
+            LOG_INFO(StressEnv::logger, fmt::format("Restore {} pages in {}ms", page_num, restore_ms.back()));
+        }
+        stop_watch.stop();
+    }
+
+    void writePages(size_t page_num)
+    {
+        char data[page_size];
+        memset(data, 0xFF, page_size);
+        // Write the pages in batches, and update a part of them to generate more WAL records.
+        for (size_t round = 0; round < 2; ++round)
+        {
+            const size_t num_to_write = round == 0 ? page_num : page_num / 10;
+            for (DB::PageId begin = 0; begin < num_to_write; begin += batch_size)
+            {
+                DB::WriteBatch wb{DB::TEST_NAMESPACE_ID};
+                for (DB::PageId page_id = begin; page_id < std::min(num_to_write, begin + batch_size); ++page_id)
+                    wb.putPage(page_id, 0, std::make_shared<DB::ReadBufferFromMemory>(data, page_size), page_size);
+                ps->write(std::move(wb));
+            }
+        }
+    }
+
+    void onDumpResult() override
+    {
+        std::vector<std::pair<String, double>> fields;
+        for (size_t i = 0; i < restore_ms.size(); ++i)
+        {
+            fields.emplace_back(fmt::format("pages_{}_restore_ms", page_nums[i]), restore_ms[i]);
+            fields.emplace_back(fmt::format("pages_{}_size_mb", page_nums[i]), 1.0 * data_size[i] / DB::MB);
+        }
+        dumpJsonResult(name(), fields);
+    }
+
+private:
+    static constexpr size_t page_size = 64;
+    static constexpr size_t batch_size = 1000;
+
+    const std::vector<size_t> page_nums{10000, 100000, 1000000};
+    std::vector<UInt64> restore_ms;
+    std::vector<size_t> data_size;
+};
+} // namespace DB::PS::tests
@@ -0,0 +1,113 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Storages/Page/workload/PSWorkload.h>
+
+namespace DB::PS::tests
+{
+// Writers keep overwriting a small set of hot pages, which leaves a lot of
+// fragments in the blob files of PageStorage V3. Then run the GC rounds and
+// report the time cost of each round and the space reclaimed by them.
+class SkewBlobGC : public StressWorkload
+    , public StressWorkloadFunc<SkewBlobGC>
+{
+public:
+    explicit SkewBlobGC(const StressEnv & options_)
+        : StressWorkload(options_)
+    {}
+
+    static String name()
+    {
+        return "SkewBlobGC";
+    }
+
+    static UInt64 mask()
+    {
+        return 1 << 9;
+    }
+
+private:
+    String desc() override
+    {
+        return fmt::format("Some of options will be ignored"
+                           "`paths` will only used first one. which is {}. Data will store in {} ."
+                           "Please cleanup folder after this test."
+                           "Only PageStorage V3 is supported."
+                           "The current workload will elapse near 60 seconds, and GC will be performed at the end.",
+                           options.paths[0],
+                           options.paths[0] + "/" + name());
+    }
+
+    void run() override
+    {
+        if (options.running_ps_version != 3)
+            throw DB::Exception(fmt::format("{} only support PageStorage V3", name()));
+
+        pool.addCapacity(1 + options.num_writers);
+        DB::PageStorage::Config config;
+        // Use small blob files, so that there are enough blob files to be chosen by GC.
+        config.blob_file_limit_size = 256 * DB::MB;
+        initPageStorage(config, name());
+
+        stress_time = std::make_shared<StressTimeout>(60);
+        stress_time->start();
+        {
+            stop_watch.start();
+            startWriter<PSWindowWriter>(options.num_writers, [](std::shared_ptr<PSWindowWriter> writer) -> void {
+                writer->setBatchBufferNums(1);
+                writer->setBatchBufferRange(10 * 1024, 1 * DB::MB);
+                writer->setWindowSize(500);
+                // A small sigma makes most of the writes overwrite the hot pages.
+                writer->setNormalDistributionSigma(3);
+            });
+
+            pool.joinAll();
+            stop_watch.stop();
+        }
+
+        const auto data_path = options.paths[0] + "/" + name();
+        size_before_gc = getDirectorySize(data_path);
+        for (size_t round = 0; round < max_gc_rounds; ++round)
+        {
+            Stopwatch gc_watch;
+            bool done_anything = ps->gc();
+            gc_rounds_ms.push_back(gc_watch.elapsedMilliseconds());
+            if (!done_anything)
+                break;
+        }
+        size_after_gc = getDirectorySize(data_path);
+    }
+
+    void onDumpResult() override
+    {
+        StressWorkload::onDumpResult();
+
+        std::vector<std::pair<String, double>> fields{
+            {"size_before_gc_mb", 1.0 * size_before_gc / DB::MB},
+            {"size_after_gc_mb", 1.0 * size_after_gc / DB::MB},
+            {"gc_rounds", gc_rounds_ms.size()},
+        };
+        for (size_t i = 0; i < gc_rounds_ms.size(); ++i)
+            fields.emplace_back(fmt::format("gc_round_{}_ms", i), gc_rounds_ms[i]);
+        dumpJsonResult(name(), fields);
+    }
+
+private:
+    static constexpr size_t max_gc_rounds = 5;
+
+    size_t size_before_gc = 0;
+    size_t size_after_gc = 0;
+    std::vector<UInt64> gc_rounds_ms;
+};
+} // namespace DB::PS::tests
@@ -0,0 +1,131 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Storages/Page/workload/PSWorkload.h>
+
+namespace DB::PS::tests
+{
+// Writers keep updating the pages while a reader keeps acquiring snapshots and
+// holding them. Then compare the GC of PageStorage V3 with the snapshots pinned
+// and after the snapshots are released.
+class SnapshotPinnedGC : public StressWorkload
+    , public StressWorkloadFunc<SnapshotPinnedGC>
+{
+public:
+    explicit SnapshotPinnedGC(const StressEnv & options_)
+        : StressWorkload(options_)
+    {}
+
+    static String name()
+    {
+        return "SnapshotPinnedGC";
+    }
+
+    static UInt64 mask()
+    {
+        return 1 << 11;
+    }
+
+private:
+    String desc() override
+    {
+        return fmt::format("Some of options will be ignored"
+                           "`paths` will only used first one. which is {}. Data will store in {} ."
+                           "Please cleanup folder after this test."
+                           "Only PageStorage V3 is supported."
+                           "The current workload will elapse near 60 seconds and hold about 60 snapshots."
+                           "Then do GC with the snapshots pinned and GC after they are released.",
+                           options.paths[0],
+                           options.paths[0] + "/" + name());
+    }
+
+    void run() override
+    {
+        if (options.running_ps_version != 3)
+            throw DB::Exception(fmt::format("{} only support PageStorage V3", name()));
+
+        pool.addCapacity(1 + options.num_writers);
+        DB::PageStorage::Config config;
+        config.blob_file_limit_size = 256 * DB::MB;
+        initPageStorage(config, name());
+
+        stress_time = std::make_shared<StressTimeout>(60);
+        stress_time->start();
+        {
+            stop_watch.start();
+            startWriter<PSWindowWriter>(options.num_writers, [](std::shared_ptr<PSWindowWriter> writer) -> void {
+                writer->setBatchBufferNums(1);
+                writer->setBatchBufferRange(10 * 1024, 1 * DB::MB);
+                writer->setWindowSize(500);
+                writer->setNormalDistributionSigma(13);
+            });
+
+            startReader<PSSnapshotReader>(1, [](std::shared_ptr<PSSnapshotReader> reader) -> void {
+                reader->setSnapshotGetIntervalMs(1000);
+            });
+
+            pool.joinAll();
+            stop_watch.stop();
+        }
+
+        const auto data_path = options.paths[0] + "/" + name();
+        size_before_gc = getDirectorySize(data_path);
+        num_snapshots = ps->getSnapshotsStat().num_snapshots;
+        pinned_gc_ms = doGcRounds();
+        size_after_pinned_gc = getDirectorySize(data_path);
+
+        // Release all the snapshots held by the reader.
+        readers.clear();
+        released_gc_ms = doGcRounds();
+        size_after_released_gc = getDirectorySize(data_path);
+    }
+
+    UInt64 doGcRounds()
+    {
+        Stopwatch gc_watch;
+        for (size_t round = 0; round < max_gc_rounds; ++round)
+        {
+            if (!ps->gc())
+                break;
+        }
+        return gc_watch.elapsedMilliseconds();
+    }
+
+    void onDumpResult() override
+    {
+        StressWorkload::onDumpResult();
+
+        dumpJsonResult(
+            name(),
+            {
+                {"snapshots", num_snapshots},
+                {"size_before_gc_mb", 1.0 * size_before_gc / DB::MB},
+                {"pinned_gc_ms", pinned_gc_ms},
+                {"size_after_pinned_gc_mb", 1.0 * size_after_pinned_gc / DB::MB},
+                {"released_gc_ms", released_gc_ms},
+                {"size_after_released_gc_mb", 1.0 * size_after_released_gc / DB::MB},
+            });
+    }
+
+private:
+    static constexpr size_t max_gc_rounds = 5;
+
+    size_t num_snapshots = 0;
+    size_t size_before_gc = 0;
+    size_t size_after_pinned_gc = 0;
+    size_t size_after_released_gc = 0;
+    UInt64 pinned_gc_ms = 0;
+    UInt64 released_gc_ms = 0;
+};
+} // namespace DB::PS::tests
@@ -0,0 +1,105 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Storages/Page/workload/PSWorkload.h>
+
+namespace DB::PS::tests
+{
+// Concurrent writers keep writing small batches, which is dominated by the cost of
+// persisting the WAL of PageStorage V3. Report the latency percentiles of the writes.
+class WALWriteLatency : public StressWorkload
+    , public StressWorkloadFunc<WALWriteLatency>
+{
+public:
+    explicit WALWriteLatency(const StressEnv & options_)
+        : StressWorkload(options_)
+    {}
+
+    static String name()
+    {
+        return "WALWriteLatency";
+    }
+
+    static UInt64 mask()
+    {
+        return 1 << 8;
+    }
+
+private:
+    String desc() override
+    {
+        return fmt::format("Some of options will be ignored"
+                           "`paths` will only used first one. which is {}. Data will store in {} ."
+                           "Please cleanup folder after this test."
+                           "Only PageStorage V3 is supported."
+                           "The current workload will elapse near 60 seconds",
+                           options.paths[0],
+                           options.paths[0] + "/" + name());
+    }
+
+    void run() override
+    {
+        if (options.running_ps_version != 3)
+            throw DB::Exception(fmt::format("{} only support PageStorage V3", name()));
+
+        pool.addCapacity(1 + options.num_writers);
+        DB::PageStorage::Config config;
+        initPageStorage(config, name());
+
+        stress_time = std::make_shared<StressTimeout>(60);
+        stress_time->start();
+        {
+            stop_watch.start();
+            startWriter<PSWindowWriter>(options.num_writers, [](std::shared_ptr<PSWindowWriter> writer) -> void {
+                writer->setBatchBufferNums(1);
+                writer->setBatchBufferRange(1024, 16 * 1024);
+                writer->setWindowSize(10000);
+                writer->setNormalDistributionSigma(13);
+                writer->setRecordLatency(true);
+            });
+
+            pool.joinAll();
+            stop_watch.stop();
+        }
+    }
+
+    void onDumpResult() override
+    {
+        StressWorkload::onDumpResult();
+
+        std::vector<UInt64> latencies;
+        size_t total_bytes_written = 0;
+        for (const auto & writer : writers)
+        {
+            auto common_writer = std::dynamic_pointer_cast<PSCommonWriter>(writer);
+            latencies.insert(latencies.end(), common_writer->write_latencies_us.begin(), common_writer->write_latencies_us.end());
+            total_bytes_written += writer->bytes_used;
+        }
+        double seconds_run = stop_watch.elapsedSeconds();
+        dumpJsonResult(
+            name(),
+            {
+                {"writers", options.num_writers},
+                {"writes", latencies.size()},
+                {"writes_per_second", latencies.size() / seconds_run},
+                {"mb_per_second", 1.0 * total_bytes_written / DB::MB / seconds_run},
+                {"p50_us", percentile(latencies, 0.5)},
+                {"p90_us", percentile(latencies, 0.9)},
+                {"p99_us", percentile(latencies, 0.99)},
+                {"p999_us", percentile(latencies, 0.999)},
+                {"max_us", percentile(latencies, 1.0)},
+            });
+    }
+};
+} // namespace DB::PS::tests
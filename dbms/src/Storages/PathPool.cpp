@@ -27,8 +27,10 @@
 #include <common/likely.h>
 #include <fmt/core.h>
 
+#include <algorithm>
 #include <random>
 #include <set>
+#include <thread>
 #include <unordered_map>
 
 namespace DB
@@ -82,6 +84,12 @@ PathPool::PathPool(
         auto p = getNormalizedPath(s + "/page");
         global_page_paths.emplace_back(std::move(p));
     }
+    for (const auto & s : latest_data_paths)
+    {
+        // Get a normalized path without trailing '/'
+        auto p = getNormalizedPath(s + "/spill");
+        spill_paths.emplace_back(std::move(p));
+    }
 }
 
 StoragePathPool PathPool::withTable(const String & database_, const String & table_, bool path_need_database_name_) const
@@ -89,6 +97,17 @@ StoragePathPool PathPool::withTable(const String & database_, const String & tab
     return StoragePathPool(main_data_paths, latest_data_paths, database_, table_, path_need_database_name_, global_capacity, file_provider);
 }
 
+String PathPool::choosePathForSpill() const
+{
+    if (spill_paths.empty())
+        return "";
+    // Spread the spilled data of different threads over the latest disks.
+    size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % spill_paths.size();
+    const auto & spill_path = spill_paths[index];
+    Poco::File(spill_path).createDirectories();
+    return spill_path + "/";
+}
+
 Strings PathPool::listPaths() const
 {
     std::set<String> path_set;
@@ -150,12 +169,21 @@ StoragePathPool::StoragePathPool( //
         LatestPathInfo info;
         info.path = getStorePath(p + "/data", database, table);
         latest_path_infos.emplace_back(info);
+
+        auto is_main_path = [&](const MainPathInfo & main_info) { return main_info.path == info.path; };
+        if (std::none_of(main_path_infos.begin(), main_path_infos.end(), is_main_path))
+        {
+            MainPathInfo fast_info;
+            fast_info.path = info.path;
+            fast_path_infos.emplace_back(fast_info);
+        }
     }
 }
 
 StoragePathPool::StoragePathPool(const StoragePathPool & rhs)
     : main_path_infos(rhs.main_path_infos)
     , latest_path_infos(rhs.latest_path_infos)
+    , fast_path_infos(rhs.fast_path_infos)
     , dt_file_path_map(rhs.dt_file_path_map)
     , database(rhs.database)
     , table(rhs.table)
@@ -171,6 +199,7 @@ StoragePathPool & StoragePathPool::operator=(const StoragePathPool & rhs)
     {
         main_path_infos = rhs.main_path_infos;
         latest_path_infos = rhs.latest_path_infos;
+        fast_path_infos = rhs.fast_path_infos;
         dt_file_path_map = rhs.dt_file_path_map;
         database = rhs.database;
         table = rhs.table;
@@ -269,6 +298,11 @@ void StoragePathPool::rename(const String & new_database, const String & new_tab
                 p = p.parent();
             auto new_path = getStorePath(p.toString() + "/data", new_database, new_table);
             renamePath(info.path, new_path);
+            for (auto & fast_info : fast_path_infos)
+            {
+                if (fast_info.path == info.path)
+                    fast_info.path = new_path;
+            }
             info.path = new_path;
         }
 
@@ -322,6 +356,19 @@ void StoragePathPool::drop(bool recursive, bool must_success)
                 // When PageStorage is dropped, it will update the size in global_capacity.
                 // Don't need to update global_capacity here.
             }
+            // The stable data on the fast paths is dropped with the latest paths.
+            for (const auto & fast_info : fast_path_infos)
+            {
+                if (fast_info.path != path_info.path)
+                    continue;
+                size_t total_bytes = 0;
+                for (const auto & [file_id, file_size] : fast_info.file_size_map)
+                {
+                    (void)file_id;
+                    total_bytes += file_size;
+                }
+                global_capacity->freeUsedSize(fast_info.path, total_bytes);
+            }
         }
         catch (Poco::DirectoryNotEmptyException & e)
         {
@@ -428,10 +475,14 @@ Strings StableDiskDelegator::listPaths() const
     {
         paths.push_back(fmt::format("{}/{}", main_path_info.path, StoragePathPool::STABLE_FOLDER_NAME));
     }
+    for (auto & fast_path_info : pool.fast_path_infos)
+    {
+        paths.push_back(fmt::format("{}/{}", fast_path_info.path, StoragePathPool::STABLE_FOLDER_NAME));
+    }
     return paths;
 }
 
-String StableDiskDelegator::choosePath() const
+String StableDiskDelegator::choosePath(bool on_fast_path) const
 {
     std::function<String(const StoragePathPool::MainPathInfos & paths, size_t idx)> path_generator
         = [](const StoragePathPool::MainPathInfos & paths, size_t idx) -> String {
@@ -442,16 +493,33 @@ String StableDiskDelegator::choosePath() const
         return info.path;
     };
 
+    if (on_fast_path && hasFastPaths())
+    {
+        const String log_msg = fmt::format("[type=stable_fast] [database={}] [table={}]", pool.database, pool.table);
+        return genericChoosePath(pool.fast_path_infos, pool.global_capacity, path_generator, path_getter, pool.log, log_msg);
+    }
     const String log_msg = fmt::format("[type=stable] [database={}] [table={}]", pool.database, pool.table);
     return genericChoosePath(pool.main_path_infos, pool.global_capacity, path_generator, path_getter, pool.log, log_msg);
 }
 
+bool StableDiskDelegator::hasFastPaths() const
+{
+    return !pool.fast_path_infos.empty();
+}
+
+bool StableDiskDelegator::isOnFastPath(UInt64 file_id) const
+{
+    std::lock_guard lock{pool.mutex};
+    auto iter = pool.dt_file_path_map.find(file_id);
+    return iter != pool.dt_file_path_map.end() && iter->second >= pool.main_path_infos.size();
+}
+
 String StableDiskDelegator::getDTFilePath(UInt64 file_id, bool throw_on_not_exist) const
 {
     std::lock_guard lock{pool.mutex};
     auto iter = pool.dt_file_path_map.find(file_id);
     if (likely(iter != pool.dt_file_path_map.end()))
-        return fmt::format("{}/{}", pool.main_path_infos[iter->second].path, StoragePathPool::STABLE_FOLDER_NAME);
+        return fmt::format("{}/{}", pool.getStablePathInfo(iter->second).path, StoragePathPool::STABLE_FOLDER_NAME);
     if (likely(throw_on_not_exist))
         throw Exception(fmt::format("Can not find path for DMFile [id={}]", file_id));
     return "";
@@ -463,16 +531,16 @@ void StableDiskDelegator::addDTFile(UInt64 file_id, size_t file_size, std::strin
     std::lock_guard lock{pool.mutex};
     if (auto iter = pool.dt_file_path_map.find(file_id); unlikely(iter != pool.dt_file_path_map.end()))
     {
-        const auto & path_info = pool.main_path_infos[iter->second];
+        const auto & path_info = pool.getStablePathInfo(iter->second);
         throw DB::TiFlashException(
             fmt::format("Try to add a DTFile with duplicated id. [id={}] [path={}] [existed_path={}]", file_id, path, path_info.path),
             Errors::DeltaTree::Internal);
     }
 
     UInt32 index = UINT32_MAX;
-    for (size_t i = 0; i < pool.main_path_infos.size(); i++)
+    for (size_t i = 0; i < pool.main_path_infos.size() + pool.fast_path_infos.size(); i++)
     {
-        if (pool.main_path_infos[i].path == path)
+        if (pool.getStablePathInfo(i).path == path)
         {
             index = i;
             break;
@@ -483,7 +551,7 @@ void StableDiskDelegator::addDTFile(UInt64 file_id, size_t file_size, std::strin
             fmt::format("Try to add a DTFile to an unrecognized path. [id={}] [path={}]", file_id, path),
             Errors::DeltaTree::Internal);
     pool.dt_file_path_map.emplace(file_id, index);
-    pool.main_path_infos[index].file_size_map.emplace(file_id, file_size);
+    pool.getStablePathInfo(index).file_size_map.emplace(file_id, file_size);
 
 #ifndef NDEBUG
     try
@@ -548,11 +616,12 @@ void StableDiskDelegator::removeDTFile(UInt64 file_id)
     if (unlikely(iter == pool.dt_file_path_map.end()))
         throw Exception(fmt::format("Cannot find DMFile for id {}", file_id));
     UInt32 index = iter->second;
-    const auto file_size = pool.main_path_infos[index].file_size_map.at(file_id);
+    auto & path_info = pool.getStablePathInfo(index);
+    const auto file_size = path_info.file_size_map.at(file_id);
     pool.dt_file_path_map.erase(file_id);
-    pool.main_path_infos[index].file_size_map.erase(file_id);
+    path_info.file_size_map.erase(file_id);
     // update global used size
-    pool.global_capacity->freeUsedSize(pool.main_path_infos[index].path, file_size);
+    pool.global_capacity->freeUsedSize(path_info.path, file_size);
 }
 
 //==========================================================================================
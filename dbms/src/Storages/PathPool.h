@@ -84,6 +84,14 @@ public:
 
     const Strings & listGlobalPagePaths() const { return global_page_paths; }
 
+    // Paths for the temporary data spilled by queries, e.g. external aggregation and sort.
+    // Those paths are generated from `latest_data_paths`.
+    const Strings & listSpillPaths() const { return spill_paths; }
+
+    // Choose a path for the data spilled by a query, the path will be created if not exists.
+    // Return an empty string if there is no spill path.
+    String choosePathForSpill() const;
+
 public:
     struct PageFileIdLvlHasher
     {
@@ -103,6 +111,7 @@ private:
     Strings latest_data_paths;
     Strings kvstore_paths;
     Strings global_page_paths;
+    Strings spill_paths;
 
     bool enable_raft_compatible_mode;
 
@@ -122,7 +131,16 @@ public:
 
     Strings listPaths() const;
 
-    String choosePath() const;
+    // Choose a path for a new DTFile. If `on_fast_path` is true and there are fast paths, the
+    // path is chosen from the fast paths, otherwise from the main paths.
+    String choosePath(bool on_fast_path = false) const;
+
+    // The fast paths are the latest paths that are not main paths. The stable DTFiles of the hot
+    // segments can be put on them, see `Segment::isReadHot`.
+    bool hasFastPaths() const;
+
+    // Whether the DTFile with file_id is on a fast path.
+    bool isOnFastPath(UInt64 file_id) const;
 
     // Get the path of the DTFile with file_id.
     // If throw_on_not_exist is false, return empty string when the path is not exists.
@@ -432,6 +450,8 @@ private:
         std::unordered_map<UInt64, size_t> file_size_map;
     };
     using MainPathInfos = std::vector<MainPathInfo>;
+    // The stable paths are indexed by `main_path_infos` and then `fast_path_infos`.
+    MainPathInfo & getStablePathInfo(UInt32 index) { return index < main_path_infos.size() ? main_path_infos[index] : fast_path_infos[index - main_path_infos.size()]; }
     struct LatestPathInfo
     {
         String path;
@@ -446,7 +466,10 @@ private:
     // Path, size
     MainPathInfos main_path_infos;
     LatestPathInfos latest_path_infos;
-    // DMFileID -> path index
+    // The latest paths that are not main paths, for the stable data of the hot segments.
+    // Their directories are renamed and dropped with `latest_path_infos`.
+    MainPathInfos fast_path_infos;
+    // DMFileID -> stable path index, see `getStablePathInfo`
     DMFilePathMap dt_file_path_map;
 
     String database;
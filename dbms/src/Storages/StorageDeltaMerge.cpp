@@ -24,6 +24,7 @@
 #include <DataTypes/isSupportedDataTypeCast.h>
 #include <Databases/IDatabase.h>
 #include <Debug/MockTiDB.h>
+#include <Flash/Coprocessor/DAGQueryInfo.h>
 #include <Interpreters/Context.h>
 #include <Parsers/ASTCreateQuery.h>
 #include <Parsers/ASTExpressionList.h>
@@ -37,6 +38,8 @@
 #include <Storages/AlterCommands.h>
 #include <Storages/DeltaMerge/DeltaMergeHelpers.h>
 #include <Storages/DeltaMerge/DeltaMergeStore.h>
+#include <Storages/DeltaMerge/Filter/LateMaterializationFilter.h>
+#include <Storages/DeltaMerge/Filter/PushDownTopN.h>
 #include <Storages/DeltaMerge/Filter/RSOperator.h>
 #include <Storages/DeltaMerge/FilterParser/FilterParser.h>
 #include <Storages/MutableSupport.h>
@@ -463,6 +466,11 @@ BlockOutputStreamPtr StorageDeltaMerge::write(const ASTPtr & query, const Settin
     return std::make_shared<DMBlockOutputStream>(getAndMaybeInitStore(), decorator, global_context, settings);
 }
 
+bool StorageDeltaMerge::isWriteThrottled(const DM::RowKeyRange & range)
+{
+    return getAndMaybeInitStore()->isWriteThrottled(global_context, range);
+}
+
 void StorageDeltaMerge::write(Block & block, const Settings & settings)
 {
     auto & store = getAndMaybeInitStore();
@@ -583,6 +591,29 @@ std::unordered_set<UInt64> parseSegmentSet(const ASTPtr & ast)
     throw Exception(fmt::format("Unable to parse segment IDs in literal form: `{}`", partition_ast.fields_str.toString()));
 }
 
+DM::LateMaterializationFilterPtr buildLateMaterializationFilter(
+    const ExpressionActionsPtr & before_where,
+    const String & filter_column_name,
+    const DM::ColumnDefines & columns_to_read)
+{
+    DM::ColumnDefines filter_columns;
+    for (const auto & name : before_where->getRequiredColumns())
+    {
+        auto iter = std::find_if(
+            columns_to_read.begin(),
+            columns_to_read.end(),
+            [&name](const DM::ColumnDefine & d) -> bool { return d.name == name; });
+        // The filter depends on some columns not read from storage
+        if (iter == columns_to_read.end())
+            return nullptr;
+        filter_columns.push_back(*iter);
+    }
+    // Nothing can be saved if there are no columns to be read after filtering
+    if (filter_columns.empty() || filter_columns.size() >= columns_to_read.size())
+        return nullptr;
+    return std::make_shared<DM::LateMaterializationFilter>(before_where, filter_column_name, filter_columns);
+}
+
 BlockInputStreams StorageDeltaMerge::read(
     const Names & column_names,
     const SelectQueryInfo & query_info,
@@ -748,6 +779,30 @@ BlockInputStreams StorageDeltaMerge::read(
     else
         LOG_FMT_DEBUG(tracing_logger, "Rough set filter is disabled.");
 
+    /// Get the pushed down filter for late materialization
+    DM::LateMaterializationFilterPtr late_materialization_filter;
+    if (query_info.dag_query && query_info.dag_query->before_where)
+    {
+        late_materialization_filter = buildLateMaterializationFilter(
+            query_info.dag_query->before_where,
+            query_info.dag_query->filter_column_name,
+            columns_to_read);
+        if (late_materialization_filter)
+            LOG_FMT_DEBUG(tracing_logger, "Late materialization filter: {}", late_materialization_filter->before_where->dumpActions());
+    }
+
+    /// Get the pushed down TopN to skip the packs
+    DM::PushDownTopNPtr top_n;
+    if (query_info.dag_query && query_info.dag_query->top_n_column_index >= 0
+        && query_info.dag_query->top_n_column_index < static_cast<Int64>(columns_to_read.size()))
+    {
+        top_n = std::make_shared<DM::PushDownTopN>(
+            columns_to_read[query_info.dag_query->top_n_column_index],
+            query_info.dag_query->top_n_is_desc,
+            query_info.dag_query->top_n_limit);
+        LOG_FMT_DEBUG(tracing_logger, "Pushed down TopN: column {} desc {} limit {}", top_n->column.name, top_n->is_desc, top_n->limit);
+    }
+
     auto streams = store->read(
         context,
         context.getSettingsRef(),
@@ -761,7 +816,11 @@ BlockInputStreams StorageDeltaMerge::read(
         /* is_fast_mode */ tidb_table_info.tiflash_mode == TiDB::TiFlashMode::Fast, // read in normal mode or read in fast mode
         max_block_size,
         parseSegmentSet(select_query.segment_expression_list),
-        extra_table_id_index);
+        extra_table_id_index,
+        late_materialization_filter,
+        /* read_rows_only */ query_info.dag_query && query_info.dag_query->read_rows_only,
+        top_n,
+        /* limit */ query_info.dag_query ? query_info.dag_query->limit : 0);
 
     /// Ensure read_tso info after read.
     check_read_tso(mvcc_query_info.read_tso);
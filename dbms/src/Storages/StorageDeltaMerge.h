@@ -71,6 +71,9 @@ public:
     /// Write from raft layer.
     void write(Block & block, const Settings & settings);
 
+    /// Returns true if the writes into `range` would be stalled, see `DeltaMergeStore::isWriteThrottled`.
+    bool isWriteThrottled(const DM::RowKeyRange & range);
+
     void flushCache(const Context & context) override;
 
     bool flushCache(const Context & context, const DM::RowKeyRange & range_to_flush, bool try_until_succeed) override;
@@ -147,6 +150,14 @@ public:
         return getAndMaybeInitStore();
     }
 
+    /// Return nullptr instead of creating the store if it is not created yet.
+    DM::DeltaMergeStorePtr getStoreIfInited() const
+    {
+        if (storeInited())
+            return _store;
+        return nullptr;
+    }
+
     bool isCommonHandle() const override { return is_common_handle; }
 
     size_t getRowKeyColumnSize() const override { return rowkey_column_size; }
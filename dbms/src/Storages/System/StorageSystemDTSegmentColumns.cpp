@@ -0,0 +1,114 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <Columns/ColumnString.h>
+#include <DataStreams/OneBlockInputStream.h>
+#include <DataTypes/DataTypeString.h>
+#include <DataTypes/DataTypesNumber.h>
+#include <Databases/DatabaseTiFlash.h>
+#include <Databases/IDatabase.h>
+#include <Interpreters/Context.h>
+#include <Storages/DeltaMerge/DeltaMergeStore.h>
+#include <Storages/MutableSupport.h>
+#include <Storages/StorageDeltaMerge.h>
+#include <Storages/System/StorageSystemDTSegmentColumns.h>
+#include <Storages/Transaction/Types.h>
+#include <TiDB/Schema/SchemaNameMapper.h>
+
+namespace DB
+{
+StorageSystemDTSegmentColumns::StorageSystemDTSegmentColumns(const std::string & name_)
+    : name(name_)
+{
+    setColumns(ColumnsDescription({
+        {"database", std::make_shared<DataTypeString>()},
+        {"table", std::make_shared<DataTypeString>()},
+
+        {"tidb_database", std::make_shared<DataTypeString>()},
+        {"tidb_table", std::make_shared<DataTypeString>()},
+        {"table_id", std::make_shared<DataTypeInt64>()},
+        {"is_tombstone", std::make_shared<DataTypeUInt64>()},
+
+        {"segment_id", std::make_shared<DataTypeUInt64>()},
+        {"column_id", std::make_shared<DataTypeInt64>()},
+        {"column_name", std::make_shared<DataTypeString>()},
+
+        {"stable_rows", std::make_shared<DataTypeUInt64>()},
+        {"ndv", std::make_shared<DataTypeUInt64>()},
+    }));
+}
+
+BlockInputStreams StorageSystemDTSegmentColumns::read(const Names & column_names,
+                                                const SelectQueryInfo &,
+                                                const Context & context,
+                                                QueryProcessingStage::Enum & processed_stage,
+                                                const size_t /*max_block_size*/,
+                                                const unsigned /*num_streams*/)
+{
+    check(column_names);
+    processed_stage = QueryProcessingStage::FetchColumns;
+
+    MutableColumns res_columns = getSampleBlock().cloneEmptyColumns();
+
+    SchemaNameMapper mapper;
+
+    auto databases = context.getDatabases();
+    for (const auto & d : databases)
+    {
+        String database_name = d.first;
+        const auto & database = d.second;
+        const DatabaseTiFlash * db_tiflash = typeid_cast<DatabaseTiFlash *>(database.get());
+
+        auto it = database->getIterator(context);
+        for (; it->isValid(); it->next())
+        {
+            const auto & table_name = it->name();
+            auto & storage = it->table();
+            if (storage->getName() != MutableSupport::delta_tree_storage_name)
+                continue;
+
+            auto dm_storage = std::dynamic_pointer_cast<StorageDeltaMerge>(storage);
+            const auto & table_info = dm_storage->getTableInfo();
+            auto table_id = table_info.id;
+            auto column_stats = dm_storage->getStore()->getSegmentColumnStats(context);
+            for (auto & stat : column_stats)
+            {
+                size_t j = 0;
+                res_columns[j++]->insert(database_name);
+                res_columns[j++]->insert(table_name);
+
+                String tidb_db_name;
+                if (db_tiflash)
+                    tidb_db_name = mapper.displayDatabaseName(db_tiflash->getDatabaseInfo());
+                res_columns[j++]->insert(tidb_db_name);
+                String tidb_table_name = mapper.displayTableName(table_info);
+                res_columns[j++]->insert(tidb_table_name);
+                res_columns[j++]->insert(table_id);
+                res_columns[j++]->insert(dm_storage->getTombstone());
+
+                res_columns[j++]->insert(stat.segment_id);
+                res_columns[j++]->insert(stat.column_id);
+                res_columns[j++]->insert(stat.column_name);
+
+                res_columns[j++]->insert(stat.stable_rows);
+                res_columns[j++]->insert(stat.ndv);
+            }
+        }
+    }
+
+    return BlockInputStreams(1, std::make_shared<OneBlockInputStream>(getSampleBlock().cloneWithColumns(std::move(res_columns))));
+}
+
+
+} // namespace DB
@@ -16,6 +16,7 @@
 #include <Storages/System/StorageSystemAsynchronousMetrics.h>
 #include <Storages/System/StorageSystemBuildOptions.h>
 #include <Storages/System/StorageSystemColumns.h>
+#include <Storages/System/StorageSystemDTSegmentColumns.h>
 #include <Storages/System/StorageSystemDTSegments.h>
 #include <Storages/System/StorageSystemDTTables.h>
 #include <Storages/System/StorageSystemDatabases.h>
@@ -44,6 +45,7 @@ void attachSystemTablesLocal(IDatabase & system_database)
     system_database.attachTable("databases", StorageSystemDatabases::create("databases"));
     system_database.attachTable("dt_tables", StorageSystemDTTables::create("dt_tables"));
     system_database.attachTable("dt_segments", StorageSystemDTSegments::create("dt_segments"));
+    system_database.attachTable("dt_segment_columns", StorageSystemDTSegmentColumns::create("dt_segment_columns"));
     system_database.attachTable("tables", StorageSystemTables::create("tables"));
     system_database.attachTable("columns", StorageSystemColumns::create("columns"));
     system_database.attachTable("functions", StorageSystemFunctions::create("functions"));
@@ -61,6 +61,7 @@ void KVStore::checkAndApplySnapshot(const RegionPtrWrap & new_region, TMTContext
      */
     if (old_region)
     {
+        waitRegionFlushed(region_id);
         old_applied_index = old_region->appliedIndex();
         if (auto new_index = new_region->appliedIndex(); old_applied_index > new_index)
         {
@@ -469,6 +470,8 @@ EngineStoreApplyRes KVStore::handleIngestSST(UInt64 region_id, const SSTViewVec
         return EngineStoreApplyRes::NotFound;
     }
 
+    waitRegionFlushed(region_id);
+
     fiu_do_on(FailPoints::force_set_sst_decode_rand, {
         static int num_call = 0;
         switch (num_call++ % 2)
@@ -17,6 +17,7 @@
 #include <Storages/Transaction/Collator.h>
 #include <Storages/Transaction/CollatorUtils.h>
 
+#include <algorithm>
 #include <array>
 
 namespace DB::ErrorCodes
@@ -242,7 +243,22 @@ public:
         auto v1 = rtrim(s1, length1);
         auto v2 = rtrim(s2, length2);
 
-        size_t offset1 = 0, offset2 = 0;
+        // The weights of the common prefix are the same.
+        size_t prefix = DB::CommonPrefixLengthUTF8(v1.data(), v1.length(), v2.data(), v2.length());
+        if (DB::IsASCIIStr(s1 + prefix, v1.length() - prefix) && DB::IsASCIIStr(s2 + prefix, v2.length() - prefix))
+        {
+            // No need to decode the ascii characters.
+            size_t length = std::min(v1.length(), v2.length());
+            for (size_t i = prefix; i < length; ++i)
+            {
+                auto cmp = weight(static_cast<uint8_t>(s1[i])) - weight(static_cast<uint8_t>(s2[i]));
+                if (cmp != 0)
+                    return DB::signum(cmp);
+            }
+            return (length < v1.length()) - (length < v2.length());
+        }
+
+        size_t offset1 = prefix, offset2 = prefix;
         while (offset1 < v1.length() && offset2 < v2.length())
         {
             auto c1 = decodeChar(s1, offset1);
@@ -262,6 +278,18 @@ public:
         auto v = rtrim(s, length);
         if (length * sizeof(WeightType) > container.size())
             container.resize(length * sizeof(WeightType));
+
+        if (DB::IsASCIIStr(v.data(), v.length()))
+        {
+            for (size_t i = 0; i < v.length(); ++i)
+            {
+                auto sk = weight(static_cast<uint8_t>(s[i]));
+                container[2 * i] = char(sk >> 8);
+                container[2 * i + 1] = char(sk);
+            }
+            return StringRef(container.data(), v.length() * sizeof(WeightType));
+        }
+
         size_t offset = 0;
         size_t total_size = 0;
 
@@ -358,9 +386,15 @@ public:
         auto v1 = rtrim(s1, length1);
         auto v2 = rtrim(s2, length2);
 
-        size_t offset1 = 0, offset2 = 0;
         size_t v1_length = v1.length(), v2_length = v2.length();
 
+        // The weights of the common prefix are the same.
+        size_t prefix = DB::CommonPrefixLengthUTF8(v1.data(), v1_length, v2.data(), v2_length);
+        if (DB::IsASCIIStr(s1 + prefix, v1_length - prefix) && DB::IsASCIIStr(s2 + prefix, v2_length - prefix))
+            return compareASCII(s1, v1_length, s2, v2_length, prefix);
+
+        size_t offset1 = prefix, offset2 = prefix;
+
         // since the longest weight of character in unicode ci has 128bit, we divide it to 2 uint64.
         // The xx_first stand for the first 64bit, and the xx_second stand for the second 64bit.
         // If xx_first == 0, there is always has xx_second == 0
@@ -419,6 +453,17 @@ public:
 
         uint64_t first = 0, second = 0;
 
+        if (DB::IsASCIIStr(s, v_length))
+        {
+            // The weights of ascii characters are never longer than 16 bits.
+            for (; offset < v_length; ++offset)
+            {
+                first = UnicodeCI::weight_lut[static_cast<uint8_t>(s[offset])];
+                writeResult(first, container, total_size);
+            }
+            return StringRef(container.data(), total_size);
+        }
+
         while (offset < v_length)
         {
             weight(first, second, offset, v_length, s);
@@ -444,6 +489,28 @@ private:
         return decodeUtf8Char(s, offset);
     }
 
+    // Compare the ascii strings from `offset`, the weights of ascii characters are never longer than 16 bits.
+    static inline int compareASCII(const char * s1, size_t length1, const char * s2, size_t length2, size_t offset)
+    {
+        size_t offset1 = offset, offset2 = offset;
+        while (true)
+        {
+            uint64_t w1 = 0, w2 = 0;
+            // skip 0 weight char
+            while (offset1 < length1 && (w1 = UnicodeCI::weight_lut[static_cast<uint8_t>(s1[offset1])]) == 0)
+                ++offset1;
+            while (offset2 < length2 && (w2 = UnicodeCI::weight_lut[static_cast<uint8_t>(s2[offset2])]) == 0)
+                ++offset2;
+
+            if (offset1 == length1 || offset2 == length2)
+                return (offset1 < length1) - (offset2 < length2);
+            if (w1 != w2)
+                return w1 < w2 ? -1 : 1;
+            ++offset1;
+            ++offset2;
+        }
+    }
+
     static inline void writeResult(uint64_t & w, std::string & container, size_t & total_size)
     {
         while (w != 0)
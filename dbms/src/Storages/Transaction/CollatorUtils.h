@@ -17,8 +17,14 @@
 #include <common/StringRef.h>
 #include <common/defines.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define FLATTEN_INLINE_PURE __attribute__((flatten, always_inline, pure))
 
 namespace DB
@@ -72,6 +78,59 @@ FLATTEN_INLINE_PURE inline int RtrimStrCompare(const std::string_view & va, cons
     return RawStrCompare(RightTrim(va), RightTrim(vb));
 }
 
+// Check whether all the bytes are ASCII, 16 bytes at a time.
+FLATTEN_INLINE_PURE inline bool IsASCIIStr(const char * s, size_t length)
+{
+    size_t i = 0;
+#if __SSE2__
+    for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i))
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i))) != 0)
+            return false;
+    }
+#endif
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if (word & 0x8080808080808080ULL)
+            return false;
+    }
+    for (; i < length; ++i)
+    {
+        if (static_cast<uint8_t>(s[i]) >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+// Length of the common prefix of two utf-8 strings, 16 bytes at a time.
+// The prefix always ends at a character boundary, so the collation weights of it are the same for both strings.
+FLATTEN_INLINE_PURE inline size_t CommonPrefixLengthUTF8(const char * s1, size_t length1, const char * s2, size_t length2)
+{
+    const size_t length = std::min(length1, length2);
+    size_t i = 0;
+#if __SSE2__
+    for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i))
+    {
+        auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s1 + i));
+        auto v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s2 + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2)));
+        if (mask != 0xFFFF)
+        {
+            i += __builtin_ctz(~mask);
+            break;
+        }
+    }
+#endif
+    while (i < length && s1[i] == s2[i])
+        ++i;
+    // Do not stop at the middle of a character.
+    while (i > 0 && i < length1 && (static_cast<uint8_t>(s1[i]) & 0xC0) == 0x80)
+        --i;
+    return i;
+}
+
 template <bool padding>
 FLATTEN_INLINE_PURE inline int BinCollatorCompare(const char * s1, size_t length1, const char * s2, size_t length2)
 {
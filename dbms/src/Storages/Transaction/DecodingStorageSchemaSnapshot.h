@@ -69,12 +69,17 @@ struct DecodingStorageSchemaSnapshot
     TMTPKType pk_type = TMTPKType::UNSPECIFIED;
     // an internal increasing version for `DecodingStorageSchemaSnapshot`, has no relation with the table schema version
     Int64 decoding_schema_version;
+    // If true, `column_defines` is a projection of the table columns and the other columns in the rows are skipped
+    // when decoding, instead of being treated as a schema mismatch. The projection must still contain the
+    // extra handle, version, delmark and pk columns.
+    bool is_projection;
 
-    DecodingStorageSchemaSnapshot(DM::ColumnDefinesPtr column_defines_, const TiDB::TableInfo & table_info_, const DM::ColumnDefine & original_handle_, Int64 decoding_schema_version_)
+    DecodingStorageSchemaSnapshot(DM::ColumnDefinesPtr column_defines_, const TiDB::TableInfo & table_info_, const DM::ColumnDefine & original_handle_, Int64 decoding_schema_version_, bool is_projection_ = false)
         : column_defines{std::move(column_defines_)}
         , pk_is_handle{table_info_.pk_is_handle}
         , is_common_handle{table_info_.is_common_handle}
         , decoding_schema_version{decoding_schema_version_}
+        , is_projection{is_projection_}
     {
         std::unordered_map<ColumnID, size_t> column_lut;
         std::unordered_map<String, ColumnID> column_name_id_map;
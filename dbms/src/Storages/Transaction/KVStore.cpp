@@ -25,11 +25,15 @@
 #include <Storages/Transaction/ReadIndexWorker.h>
 #include <Storages/Transaction/Region.h>
 #include <Storages/Transaction/RegionExecutionResult.h>
+#include <Storages/Transaction/RegionFlushPipeline.h>
 #include <Storages/Transaction/RegionPersister.h>
 #include <Storages/Transaction/RegionTable.h>
 #include <Storages/Transaction/TMTContext.h>
+#include <common/ThreadPool.h>
 #include <common/likely.h>
 
+#include <future>
+
 namespace DB
 {
 namespace ErrorCodes
@@ -48,6 +52,15 @@ KVStore::KVStore(Context & context, TiDB::SnapshotApplyMethod snapshot_apply_met
     , region_compact_log_min_bytes(32 * 1024 * 1024)
 {
     // default config about compact-log: period 120s, rows 40k, bytes 32MB.
+    const auto & settings = context.getSettingsRef();
+    if (settings.raft_async_flush_threads > 0)
+        flush_pipeline = std::make_unique<RegionFlushPipeline>(
+            context,
+            settings.raft_async_flush_threads,
+            settings.raft_async_flush_max_pending_tasks,
+            settings.raft_async_pre_decode_threads);
+    if (settings.raft_batch_apply_concurrency > 1)
+        batch_apply_pool = std::make_unique<::ThreadPool>(settings.raft_batch_apply_concurrency);
 }
 
 void KVStore::restore(const TiFlashRaftProxyHelper * proxy_helper)
@@ -55,10 +68,11 @@ void KVStore::restore(const TiFlashRaftProxyHelper * proxy_helper)
     auto task_lock = genTaskLock();
     auto manage_lock = genRegionWriteLock(task_lock);
 
+    Stopwatch watch;
     this->proxy_helper = proxy_helper;
     manage_lock.regions = region_persister->restore(proxy_helper);
 
-    LOG_FMT_INFO(log, "Restored {} regions", manage_lock.regions.size());
+    LOG_FMT_INFO(log, "Restored {} regions, cost {}ms", manage_lock.regions.size(), watch.elapsedMillisecondsFromLastTime());
 
     // init range index
     for (const auto & [id, region] : manage_lock.regions)
@@ -66,6 +80,7 @@ void KVStore::restore(const TiFlashRaftProxyHelper * proxy_helper)
         std::ignore = id;
         manage_lock.index.add(region);
     }
+    LOG_FMT_INFO(log, "Built range index of regions, cost {}ms", watch.elapsedMillisecondsFromLastTime());
 
     {
         const size_t batch = 512;
@@ -96,8 +111,7 @@ RegionPtr KVStore::getRegion(RegionID region_id) const
 }
 RegionMap KVStore::getRegionsByRangeOverlap(const RegionRange & range) const
 {
-    auto manage_lock = genRegionReadLock();
-    return manage_lock.index.findByRangeOverlap(range);
+    return region_manager.findRegionsByRangeOverlap(range);
 }
 
 RegionTaskLock RegionTaskCtrl::genRegionTaskLock(RegionID region_id) const
@@ -168,6 +182,7 @@ void KVStore::tryPersist(RegionID region_id)
     if (region)
     {
         LOG_FMT_INFO(log, "Try to persist {}", region->toString(false));
+        waitRegionFlushed(region_id);
         region_persister->persist(*region);
         LOG_FMT_INFO(log, "After persisted {}, cache {} bytes", region->toString(false), region->dataSize());
     }
@@ -191,6 +206,8 @@ void KVStore::removeRegion(RegionID region_id, bool remove_data, RegionTable & r
 {
     LOG_FMT_INFO(log, "Start to remove [region {}]", region_id);
 
+    waitRegionFlushed(region_id);
+
     {
         auto manage_lock = genRegionWriteLock(task_lock);
         auto it = manage_lock.regions.find(region_id);
@@ -288,6 +305,71 @@ EngineStoreApplyRes KVStore::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt
     return res;
 }
 
+void KVStore::handleBatchWriteRaftCmd(
+    const WriteCmdsView * cmds,
+    const RaftCmdHeader * headers,
+    size_t len,
+    EngineStoreApplyRes * results,
+    TMTContext & tmt)
+{
+    auto apply = [&](size_t i) {
+        results[i] = handleWriteRaftCmd(cmds[i], headers[i].region_id, headers[i].index, headers[i].term, tmt);
+    };
+    if (!batch_apply_pool || len <= 1)
+    {
+        for (size_t i = 0; i < len; ++i)
+            apply(i);
+        return;
+    }
+
+    // Shard by region id, so that the commands of a region are applied in order by the same thread.
+    const size_t concurrency = std::min(len, static_cast<size_t>(batch_apply_pool->size()));
+    std::vector<std::vector<size_t>> shards(concurrency);
+    for (size_t i = 0; i < len; ++i)
+        shards[headers[i].region_id % concurrency].push_back(i);
+
+    // The pool is shared by the concurrent batches, so wait for the tasks of this batch by their own futures
+    // instead of `ThreadPool::wait`.
+    std::vector<std::future<void>> futures;
+    for (size_t shard = 1; shard < concurrency; ++shard)
+    {
+        if (shards[shard].empty())
+            continue;
+        auto task = std::make_shared<std::packaged_task<void()>>([&apply, &indexes = shards[shard]] {
+            for (auto i : indexes)
+                apply(i);
+        });
+        futures.emplace_back(task->get_future());
+        batch_apply_pool->schedule([task] { (*task)(); });
+    }
+
+    // The first shard is applied by the calling thread.
+    std::exception_ptr first_exception;
+    try
+    {
+        for (auto i : shards[0])
+            apply(i);
+    }
+    catch (...)
+    {
+        first_exception = std::current_exception();
+    }
+    for (auto & future : futures)
+    {
+        try
+        {
+            future.get();
+        }
+        catch (...)
+        {
+            if (!first_exception)
+                first_exception = std::current_exception();
+        }
+    }
+    if (first_exception)
+        std::rethrow_exception(first_exception);
+}
+
 void KVStore::handleDestroy(UInt64 region_id, TMTContext & tmt)
 {
     handleDestroy(region_id, tmt, genTaskLock());
@@ -320,8 +402,15 @@ void KVStore::setRegionCompactLogConfig(UInt64 sec, UInt64 rows, UInt64 bytes)
         bytes);
 }
 
+void KVStore::waitRegionFlushed(RegionID region_id)
+{
+    if (flush_pipeline)
+        flush_pipeline->waitRegion(region_id);
+}
+
 void KVStore::persistRegion(const Region & region, const RegionTaskLock & region_task_lock, const char * caller)
 {
+    waitRegionFlushed(region.id());
     LOG_FMT_INFO(log, "Start to persist {}, cache size: {} bytes for `{}`", region.toString(true), region.dataSize(), caller);
     region_persister->persist(region, region_task_lock);
     LOG_FMT_DEBUG(log, "Persist {} done", region.toString(false));
@@ -353,9 +442,34 @@ bool KVStore::canFlushRegionDataImpl(const RegionPtr & curr_region_ptr, UInt8 fl
 
     LOG_FMT_DEBUG(log, "{} approx mem cache info: rows {}, bytes {}", curr_region.toString(false), rows, size_bytes);
 
+    const auto & settings = tmt.getContext().getSettingsRef();
+    auto min_rows = region_compact_log_min_rows.load(std::memory_order_relaxed);
+    auto min_bytes = region_compact_log_min_bytes.load(std::memory_order_relaxed);
+
+    // Under memory pressure, flush the regions holding more than the average regardless of the thresholds.
+    bool memory_pressure = false;
+    if (UInt64 mem_limit = settings.raft_region_mem_cache_limit_bytes; mem_limit > 0)
+    {
+        auto [total_bytes, region_count] = getApproxMemCacheStat();
+        memory_pressure = total_bytes >= mem_limit && size_bytes > 0 && size_bytes * std::max<size_t>(region_count, 1) >= total_bytes;
+    }
+
+    // Let hot regions coalesce into bigger delta writes if memory is not under pressure.
+    if (UInt64 hot_rate = settings.raft_hot_region_write_bytes_per_second; !memory_pressure && hot_rate > 0 && settings.raft_hot_region_flush_threshold_factor > 1)
+    {
+        if (auto last_compact_log_time = curr_region.lastCompactLogTime(); last_compact_log_time != Timepoint::min())
+        {
+            auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(Clock::now() - last_compact_log_time).count();
+            if (seconds > 0 && size_bytes >= hot_rate * seconds)
+            {
+                min_rows *= settings.raft_hot_region_flush_threshold_factor;
+                min_bytes *= settings.raft_hot_region_flush_threshold_factor;
+            }
+        }
+    }
+
     bool can_flush = false;
-    if (rows >= region_compact_log_min_rows.load(std::memory_order_relaxed)
-        || size_bytes >= region_compact_log_min_bytes.load(std::memory_order_relaxed))
+    if (memory_pressure || rows >= min_rows || size_bytes >= min_bytes)
     {
         // if rows or bytes more than threshold, flush cache and persist mem data.
         can_flush = true;
@@ -370,6 +484,7 @@ bool KVStore::canFlushRegionDataImpl(const RegionPtr & curr_region_ptr, UInt8 fl
     if (can_flush && flush_if_possible)
     {
         LOG_FMT_DEBUG(log, "{} flush region due to canFlushRegionData", curr_region.toString(false));
+        waitRegionFlushed(curr_region.id());
         if (tryFlushRegionCacheInStorage(tmt, curr_region, log, try_until_succeed))
         {
             persistRegion(curr_region, region_task_lock, "canFlushRegionData before compact raft log");
@@ -385,6 +500,23 @@ bool KVStore::canFlushRegionDataImpl(const RegionPtr & curr_region_ptr, UInt8 fl
     return can_flush;
 }
 
+std::pair<size_t, size_t> KVStore::getApproxMemCacheStat()
+{
+    auto now = Clock::now();
+    if (now >= last_mem_cache_stat_time.load() + Seconds(1))
+    {
+        last_mem_cache_stat_time = now;
+        size_t total_bytes = 0, region_count = 0;
+        traverseRegions([&](RegionID, const RegionPtr & region) {
+            total_bytes += region->getApproxMemCacheInfo().second;
+            ++region_count;
+        });
+        mem_cache_total_bytes = total_bytes;
+        mem_cache_region_count = region_count;
+    }
+    return {mem_cache_total_bytes.load(), mem_cache_region_count.load()};
+}
+
 EngineStoreApplyRes KVStore::handleUselessAdminRaftCmd(
     raft_cmdpb::AdminCmdType cmd_type,
     UInt64 curr_region_id,
@@ -408,6 +540,7 @@ EngineStoreApplyRes KVStore::handleUselessAdminRaftCmd(
                   term,
                   index);
 
+    waitRegionFlushed(curr_region_id);
     curr_region.handleWriteRaftCmd({}, index, term, tmt);
 
     if (cmd_type == raft_cmdpb::AdminCmdType::CompactLog)
@@ -463,6 +596,12 @@ EngineStoreApplyRes KVStore::handleAdminRaftCmd(raft_cmdpb::AdminRequest && requ
         }
 
         auto & curr_region = *curr_region_ptr;
+
+        // Admin commands change the meta of region, make sure the data before them are written.
+        waitRegionFlushed(curr_region_id);
+        if (type == raft_cmdpb::AdminCmdType::CommitMerge)
+            waitRegionFlushed(request.commit_merge().source().id());
+
         curr_region.makeRaftCommandDelegate(task_lock).handleAdminRaftCmd(
             request,
             response,
@@ -795,6 +934,7 @@ void KVStore::StoreMeta::update(Base && base_)
 KVStore::~KVStore()
 {
     releaseReadIndexWorkers();
+    flush_pipeline.reset();
 }
 
 FileUsageStatistics KVStore::getFileUsageStatistics() const
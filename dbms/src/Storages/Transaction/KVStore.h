@@ -14,10 +14,13 @@
 
 #pragma once
 
+#include <Common/ProfilingMutex.h>
 #include <Storages/Transaction/RegionDataRead.h>
 #include <Storages/Transaction/RegionManager.h>
 #include <Storages/Transaction/StorageEngineType.h>
 
+class ThreadPool;
+
 namespace TiDB
 {
 struct TableInfo;
@@ -60,6 +63,7 @@ class TMTContext;
 
 struct SSTViewVec;
 struct WriteCmdsView;
+struct RaftCmdHeader;
 
 enum class EngineStoreApplyRes : uint32_t;
 
@@ -71,6 +75,7 @@ using BatchReadIndexRes = std::vector<std::pair<kvrpcpb::ReadIndexResponse, uint
 class ReadIndexStressTest;
 struct FileUsageStatistics;
 class RegionPersister;
+class RegionFlushPipeline;
 
 /// TODO: brief design document.
 class KVStore final : private boost::noncopyable
@@ -107,6 +112,15 @@ public:
         UInt64 term,
         TMTContext & tmt);
     EngineStoreApplyRes handleWriteRaftCmd(const WriteCmdsView & cmds, UInt64 region_id, UInt64 index, UInt64 term, TMTContext & tmt);
+    /// Apply the write commands of many regions, `results[i]` is the result of `cmds[i]` with `headers[i]`.
+    /// The commands of the same region are applied in order, and the regions are sharded to
+    /// `raft_batch_apply_concurrency` threads.
+    void handleBatchWriteRaftCmd(
+        const WriteCmdsView * cmds,
+        const RaftCmdHeader * headers,
+        size_t len,
+        EngineStoreApplyRes * results,
+        TMTContext & tmt);
 
     bool needFlushRegionData(UInt64 region_id, TMTContext & tmt);
     bool tryFlushRegionData(UInt64 region_id, bool try_until_succeed, TMTContext & tmt);
@@ -133,6 +147,9 @@ public:
     void addReadIndexEvent(Int64 f) { read_index_event_flag += f; }
     Int64 getReadIndexEvent() const { return read_index_event_flag; }
 
+    /// Return nullptr if the async flush of raft apply is disabled.
+    RegionFlushPipeline * getFlushPipeline() const { return flush_pipeline.get(); }
+
     void setStore(metapb::Store);
 
     // May return 0 if uninitialized
@@ -227,7 +244,12 @@ private:
     /// In other words, `canFlushRegionDataImpl(flush_if_possible=true)` can return false.
     bool canFlushRegionDataImpl(const RegionPtr & curr_region_ptr, UInt8 flush_if_possible, bool try_until_succeed, TMTContext & tmt, const RegionTaskLock & region_task_lock);
 
+    /// Return <total bytes, number of regions> of the approx mem cache of all regions, refreshed at most once per second.
+    std::pair<size_t, size_t> getApproxMemCacheStat();
+
     void persistRegion(const Region & region, const RegionTaskLock & region_task_lock, const char * caller);
+    /// Wait for the committed data of the region in `flush_pipeline` to be written, so that its applied index is up to date.
+    void waitRegionFlushed(RegionID region_id);
     void releaseReadIndexWorkers();
     void handleDestroy(UInt64 region_id, TMTContext & tmt, const KVStoreTaskLock &);
 
@@ -236,9 +258,14 @@ private:
 
     std::unique_ptr<RegionPersister> region_persister;
 
+    std::unique_ptr<RegionFlushPipeline> flush_pipeline;
+
+    /// The threads to apply the batched write commands, nullptr if they are applied by the calling thread.
+    std::unique_ptr<::ThreadPool> batch_apply_pool;
+
     std::atomic<Timepoint> last_gc_time = Timepoint::min();
 
-    mutable std::mutex task_mutex;
+    mutable ProfilingMutex task_mutex{ProfilingLockType::KVStoreTask};
 
     // raft_cmd_res stores the result of applying raft cmd. It must be protected by task_mutex.
     std::unique_ptr<RaftCommandResult> raft_cmd_res;
@@ -251,6 +278,10 @@ private:
     std::atomic<UInt64> region_compact_log_min_rows;
     std::atomic<UInt64> region_compact_log_min_bytes;
 
+    std::atomic<Timepoint> last_mem_cache_stat_time = Timepoint::min();
+    std::atomic<size_t> mem_cache_total_bytes{0};
+    std::atomic<size_t> mem_cache_region_count{0};
+
     mutable std::mutex bg_gc_region_data_mutex;
     std::list<RegionDataReadInfoList> bg_gc_region_data;
 
@@ -269,10 +300,10 @@ private:
 class KVStoreTaskLock : private boost::noncopyable
 {
     friend class KVStore;
-    explicit KVStoreTaskLock(std::mutex & mutex_)
+    explicit KVStoreTaskLock(ProfilingMutex & mutex_)
         : lock(mutex_)
     {}
-    std::lock_guard<std::mutex> lock;
+    std::lock_guard<ProfilingMutex> lock;
 };
 
 void WaitCheckRegionReady(const TMTContext &, const std::atomic_size_t & terminate_signals_counter);
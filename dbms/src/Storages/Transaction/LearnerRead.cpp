@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <Common/Logger.h>
+#include <Common/ProfileEvents.h>
 #include <Common/Stopwatch.h>
 #include <Common/TiFlashMetrics.h>
 #include <Flash/Coprocessor/DAGContext.h>
@@ -33,6 +34,11 @@
 
 #include <ext/scope_guard.h>
 
+namespace ProfileEvents
+{
+extern const Event RaftWaitIndexTimeout;
+} // namespace ProfileEvents
+
 namespace DB
 {
 class LockWrap
@@ -321,40 +327,54 @@ LearnerReadSnapshot doLearnerRead(
             // TODO: Maybe collect all the Regions that happen wait index timeout instead of just throwing one Region id
             throw TiFlashException(fmt::format("Region {} is unavailable", region_id), Errors::Coprocessor::RegionError);
         };
+        // Register all the regions to wait for in one batch, the apply path marks each of them ready, so this thread
+        // sleeps once until the last region is ready instead of once for each region.
         const auto wait_index_timeout_ms = tmt.waitIndexTimeout();
-        for (size_t region_idx = region_begin_idx, read_index_res_idx = 0; region_idx < region_end_idx; ++region_idx, ++read_index_res_idx)
+        auto wait_index_batch = std::make_shared<WaitIndexBatch>();
+        std::vector<bool> need_check_index(region_end_idx - region_begin_idx, false);
+        for (size_t region_idx = region_begin_idx; region_idx < region_end_idx; ++region_idx)
         {
             const auto & region_to_query = regions_info[region_idx];
-            Int64 physical_table_id = region_to_query.physical_table_id;
-
-            // if region is unavailable, skip wait index.
             if (unavailable_regions.contains(region_to_query.region_id))
                 continue;
-
-            auto & region = regions_snapshot.find(region_to_query.region_id)->second;
-
-            auto total_wait_index_elapsed_ms = watch.elapsedMilliseconds();
+            const auto & region = regions_snapshot.find(region_to_query.region_id)->second;
             auto index_to_wait = batch_read_index_result.find(region_to_query.region_id)->second.read_index();
+            need_check_index[region_idx - region_begin_idx] = region->addIndexWaiter(index_to_wait, wait_index_batch);
+        }
+        if (size_t num_waiting = wait_index_batch->pendingCount(); num_waiting > 0)
+        {
+            // Wait index timeout is disabled; or timeout is enabled but not happen yet, wait index for the batch.
+            // Otherwise simply check the indexes of the regions below.
+            auto total_wait_index_elapsed_ms = watch.elapsedMilliseconds();
             if (wait_index_timeout_ms == 0 || total_wait_index_elapsed_ms <= wait_index_timeout_ms)
             {
-                // Wait index timeout is disabled; or timeout is enabled but not happen yet, wait index for
-                // a specify Region.
-                auto [wait_res, time_cost] = region->waitIndex(index_to_wait, tmt.waitIndexTimeout(), [&tmt]() { return tmt.checkRunning(); });
-                if (wait_res != WaitIndexResult::Finished)
+                Stopwatch wait_index_watch;
+                LOG_FMT_DEBUG(log, "{} regions need to wait learner index", num_waiting);
+                auto wait_res = wait_index_batch->wait(wait_index_timeout_ms, [&tmt]() { return tmt.checkRunning(); });
+                // Only record information if wait-index does happen
+                GET_METRIC(tiflash_raft_wait_index_duration_seconds).Observe(wait_index_watch.elapsedSeconds());
+                if (wait_res == WaitIndexResult::Timeout)
                 {
-                    handle_wait_timeout_region(region_to_query.region_id);
-                    continue;
-                }
-                if (time_cost > 0)
-                {
-                    // Only record information if wait-index does happen
-                    GET_METRIC(tiflash_raft_wait_index_duration_seconds).Observe(time_cost);
+                    ProfileEvents::increment(ProfileEvents::RaftWaitIndexTimeout);
+                    LOG_FMT_WARNING(log, "{} of {} regions wait learner index timeout", wait_index_batch->pendingCount(), num_waiting);
                 }
             }
-            else
+        }
+
+        for (size_t region_idx = region_begin_idx; region_idx < region_end_idx; ++region_idx)
+        {
+            const auto & region_to_query = regions_info[region_idx];
+            Int64 physical_table_id = region_to_query.physical_table_id;
+
+            // if region is unavailable, skip wait index.
+            if (unavailable_regions.contains(region_to_query.region_id))
+                continue;
+
+            auto & region = regions_snapshot.find(region_to_query.region_id)->second;
+
+            if (need_check_index[region_idx - region_begin_idx])
             {
-                // Wait index timeout is enabled && timeout happens, simply check the Region index instead of wait index
-                // for Regions one by one.
+                auto index_to_wait = batch_read_index_result.find(region_to_query.region_id)->second.read_index();
                 if (!region->checkIndex(index_to_wait))
                 {
                     handle_wait_timeout_region(region_to_query.region_id);
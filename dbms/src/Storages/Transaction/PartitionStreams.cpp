@@ -339,6 +339,24 @@ static inline void reportUpstreamLatency(const RegionDataReadInfoList & data_lis
     }
 }
 
+bool RegionTable::isWriteThrottled(Context & context, const Region & region)
+{
+    UInt64 budget = context.getSettingsRef().raft_write_stall_region_cache_bytes;
+    if (budget == 0 || region.dataSize() >= budget)
+        return false;
+
+    const auto & tmt = context.getTMTContext();
+    auto storage = tmt.getStorages().get(region.getMappedTableID());
+    if (storage == nullptr || storage->isTombstone() || storage->engineType() != ::TiDB::StorageEngine::DT)
+        return false;
+    auto dm_storage = std::dynamic_pointer_cast<StorageDeltaMerge>(storage);
+    auto range = DM::RowKeyRange::fromRegionRange(region.getRange(), region.getMappedTableID(), dm_storage->isCommonHandle(), dm_storage->getRowKeyColumnSize());
+    if (!dm_storage->isWriteThrottled(range))
+        return false;
+    GET_METRIC(tiflash_raft_write_postponed_count).Increment();
+    return true;
+}
+
 void RegionTable::writeBlockByRegion(
     Context & context,
     const RegionPtrWithBlock & region,
@@ -369,6 +387,49 @@ void RegionTable::writeBlockByRegion(
     data_list_to_remove = std::move(*data_list_read);
 }
 
+std::optional<RegionDataReadInfoList> RegionTable::takeCommittedDataByRegion(const RegionPtr & region, bool lock_region)
+{
+    auto data_list_read = ReadRegionCommitCache(region, lock_region);
+    if (data_list_read)
+        RemoveRegionCommitCache(region, *data_list_read, lock_region);
+    return data_list_read;
+}
+
+void RegionTable::writeCommittedDataByRegion(
+    Context & context,
+    const RegionPtr & region,
+    RegionDataReadInfoList & data_list_read,
+    Poco::Logger * log,
+    RegionPtrWithBlock::CachePtr pre_decode_cache)
+{
+    reportUpstreamLatency(data_list_read);
+    writeRegionDataToStorage(context, RegionPtrWithBlock{region, std::move(pre_decode_cache)}, data_list_read, log);
+}
+
+RegionPtrWithBlock::CachePtr RegionTable::preDecodeCommittedData(
+    Context & context,
+    const RegionPtr & region,
+    const RegionDataReadInfoList & data_list_read)
+{
+    const auto & tmt = context.getTMTContext();
+    auto storage = tmt.getStorages().get(region->getMappedTableID());
+    if (storage == nullptr || storage->isTombstone() || storage->engineType() != ::TiDB::StorageEngine::DT)
+        return nullptr;
+
+    Stopwatch watch;
+    /// The schema must not change during decode, the write checks the schema version again before using the block.
+    auto lock = storage->lockStructureForShare(getThreadName());
+    Int64 schema_version = storage->getTableInfo().schema_version;
+    DecodingStorageSchemaSnapshotConstPtr decoding_schema_snapshot;
+    std::tie(decoding_schema_snapshot, std::ignore) = storage->getSchemaSnapshotAndBlockForDecoding(lock, false);
+    Block block = createBlockSortByColumnID(decoding_schema_snapshot);
+    auto reader = RegionBlockReader(decoding_schema_snapshot);
+    if (!reader.read(block, data_list_read, /*force_decode=*/false))
+        return nullptr;
+    GET_METRIC(tiflash_raft_write_data_to_storage_duration_seconds, type_decode).Observe(watch.elapsedSeconds());
+    return std::make_unique<RegionPreDecodeBlockData>(std::move(block), schema_version, RegionDataReadInfoList{});
+}
+
 RegionTable::ResolveLocksAndWriteRegionRes RegionTable::resolveLocksAndWriteRegion(TMTContext & tmt,
                                                                                    const TiDB::TableID table_id,
                                                                                    const RegionPtr & region,
@@ -100,6 +100,24 @@ EngineStoreApplyRes HandleWriteRaftCmd(
     }
 }
 
+void HandleBatchWriteRaftCmd(
+    const EngineStoreServerWrap * server,
+    const WriteCmdsView * cmds,
+    const RaftCmdHeader * headers,
+    uint64_t len,
+    EngineStoreApplyRes * results)
+{
+    try
+    {
+        server->tmt->getKVStore()->handleBatchWriteRaftCmd(cmds, headers, len, results, *server->tmt);
+    }
+    catch (...)
+    {
+        tryLogCurrentException(__PRETTY_FUNCTION__);
+        exit(-1);
+    }
+}
+
 EngineStoreApplyRes HandleAdminRaftCmd(
     const EngineStoreServerWrap * server,
     BaseBuffView req_buff,
@@ -125,6 +125,12 @@ EngineStoreApplyRes HandleAdminRaftCmd(
 EngineStoreApplyRes HandleWriteRaftCmd(const EngineStoreServerWrap * server,
                                        WriteCmdsView cmds,
                                        RaftCmdHeader header);
+/// Apply the write commands of `len` regions by one call, `results[i]` is the result of `cmds[i]` with `headers[i]`.
+void HandleBatchWriteRaftCmd(const EngineStoreServerWrap * server,
+                             const WriteCmdsView * cmds,
+                             const RaftCmdHeader * headers,
+                             uint64_t len,
+                             EngineStoreApplyRes * results);
 uint8_t NeedFlushData(EngineStoreServerWrap * server, uint64_t region_id);
 uint8_t TryFlushData(EngineStoreServerWrap * server, uint64_t region_id, uint8_t until_succeed);
 void AtomicUpdateProxy(EngineStoreServerWrap * server, RaftStoreProxyFFIHelper * proxy);
@@ -552,12 +552,50 @@ void ReadIndexDataNode::runOneRound(const TiFlashRaftProxyHelper & helper, const
 
     auto _ = genLockGuard();
 
+    // Requests of the same region are deduplicated: a request is answered by the history success record, or joins the
+    // earliest running task, whose start-ts is not smaller than its own. Only the rest share one new read-index task.
+    WaitingTasks::Data rest_tasks;
+    std::vector<Timestamp> joined_running_tasks;
+    for (auto && e : waiting_tasks)
+    {
+        const auto ts = e.first;
+        // start-ts `0` will be used to only get the latest index, do not use history
+        if (history_success_tasks && history_success_tasks->first >= ts && ts)
+        {
+            TEST_LOG_FMT("find history_tasks resp {} for ts {}", history_success_tasks->second.ShortDebugString(), ts);
+            e.second->update(history_success_tasks->second);
+            ++cnt_use_history_tasks;
+        }
+        else if (auto run_it = running_tasks.lower_bound(ts); run_it != running_tasks.end())
+        {
+            TEST_LOG_FMT("join running_tasks ts {} for ts {}", run_it->first, ts);
+            run_it->second.callbacks.emplace_back(std::move(e.second));
+            joined_running_tasks.emplace_back(run_it->first);
+        }
+        else
+        {
+            rest_tasks.emplace_back(ts, std::move(e.second));
+        }
+    }
+
+    // Poll the joined tasks in case they have been done. `doConsume` may erase other running tasks, so do not keep iterators.
+    std::sort(joined_running_tasks.begin(), joined_running_tasks.end());
+    joined_running_tasks.erase(std::unique(joined_running_tasks.begin(), joined_running_tasks.end()), joined_running_tasks.end());
+    for (const auto ts : joined_running_tasks)
+    {
+        if (auto run_it = running_tasks.find(ts); run_it != running_tasks.end())
+            doConsume(helper, run_it);
+    }
+
+    if (rest_tasks.empty())
+        return;
+
     {
         Timestamp max_ts = 0;
         ReadIndexFuturePtr max_ts_task = nullptr;
         {
             const ReadIndexFuturePtr * x = nullptr;
-            for (auto & e : waiting_tasks)
+            for (auto & e : rest_tasks)
             {
                 if (e.first >= max_ts)
                 {
@@ -571,53 +609,36 @@ void ReadIndexDataNode::runOneRound(const TiFlashRaftProxyHelper & helper, const
         auto region_id = max_ts_task->req.context().region_id();
 
         TEST_LOG_FMT(
-            "try to use max_ts {}, from request for region {}, waiting_tasks size {}, running_tasks {}",
+            "try to use max_ts {}, from request for region {}, waiting_tasks size {}, rest_tasks size {}, running_tasks {}",
             max_ts,
             region_id,
             waiting_tasks.size(),
+            rest_tasks.size(),
             running_tasks.size());
 
-        // start-ts `0` will be used to only get the latest index, do not use history
-        if (history_success_tasks && history_success_tasks->first >= max_ts && max_ts)
+        // All the running tasks have smaller start-ts, make a new one.
+        TEST_LOG_FMT("no exist running_tasks for ts {}", max_ts);
+        RunningTasks::iterator run_it;
+        if (auto t = makeReadIndexTask(helper, max_ts_task->req); t)
         {
-            TEST_LOG_FMT("find history_tasks resp {}", history_success_tasks->second.ShortDebugString());
-
-            for (const auto & e : waiting_tasks)
-            {
-                e.second->update(history_success_tasks->second);
-            }
-
-            cnt_use_history_tasks += waiting_tasks.size();
+            TEST_LOG_FMT("successfully make ReadIndexTask for region {} ts {}", region_id, max_ts);
+            AsyncWaker waker{helper, new RegionReadIndexNotifier(region_id, max_ts, notify)};
+            run_it = running_tasks.try_emplace(max_ts, region_id, max_ts).first;
+            run_it->second.task_pair.emplace(std::move(*t), std::move(waker));
         }
         else
         {
-            auto run_it = running_tasks.lower_bound(max_ts);
-            if (run_it == running_tasks.end())
-            {
-                TEST_LOG_FMT("no exist running_tasks for ts {}", max_ts);
-
-                if (auto t = makeReadIndexTask(helper, max_ts_task->req); t)
-                {
-                    TEST_LOG_FMT("successfully make ReadIndexTask for region {} ts {}", region_id, max_ts);
-                    AsyncWaker waker{helper, new RegionReadIndexNotifier(region_id, max_ts, notify)};
-                    run_it = running_tasks.try_emplace(max_ts, region_id, max_ts).first;
-                    run_it->second.task_pair.emplace(std::move(*t), std::move(waker));
-                }
-                else
-                {
-                    TEST_LOG_FMT("failed to make ReadIndexTask for region {} ts {}", region_id, max_ts);
-                    run_it = running_tasks.try_emplace(max_ts, region_id, max_ts).first;
-                    run_it->second.resp.mutable_region_error();
-                }
-            }
-
-            for (auto && e : waiting_tasks)
-            {
-                run_it->second.callbacks.emplace_back(std::move(e.second));
-            }
+            TEST_LOG_FMT("failed to make ReadIndexTask for region {} ts {}", region_id, max_ts);
+            run_it = running_tasks.try_emplace(max_ts, region_id, max_ts).first;
+            run_it->second.resp.mutable_region_error();
+        }
 
-            doConsume(helper, run_it);
+        for (auto && e : rest_tasks)
+        {
+            run_it->second.callbacks.emplace_back(std::move(e.second));
         }
+
+        doConsume(helper, run_it);
     }
 }
 
@@ -20,6 +20,7 @@
 #include <Storages/Transaction/ProxyFFI.h>
 #include <Storages/Transaction/Region.h>
 #include <Storages/Transaction/RegionExecutionResult.h>
+#include <Storages/Transaction/RegionFlushPipeline.h>
 #include <Storages/Transaction/RegionTable.h>
 #include <Storages/Transaction/SSTReader.h>
 #include <Storages/Transaction/TMTContext.h>
@@ -42,15 +43,18 @@ extern const int UNKNOWN_FORMAT_VERSION;
 } // namespace ErrorCodes
 
 const UInt32 Region::CURRENT_VERSION = 1;
+const UInt32 Region::DELTA_VERSION = 1;
 
 RegionData::WriteCFIter Region::removeDataByWriteIt(const RegionData::WriteCFIter & write_it)
 {
+    if (delta.isRecording())
+        delta.recordRemoveCommitted(*std::get<0>(write_it->second), data.dataSize());
     return data.removeDataByWriteIt(write_it);
 }
 
-RegionDataReadInfo Region::readDataByWriteIt(const RegionData::ConstWriteCFIter & write_it, bool need_value) const
+RegionDataReadInfo Region::readDataByWriteIt(const RegionData::ConstWriteCFIter & write_it, bool need_value, RegionData::ConstDefaultCFIter * default_cursor) const
 {
-    return data.readDataByWriteIt(write_it, need_value);
+    return data.readDataByWriteIt(write_it, need_value, default_cursor);
 }
 
 DecodedLockCFValuePtr Region::getLockInfo(const RegionLockReadQuery & query) const
@@ -69,9 +73,24 @@ void Region::insert(ColumnFamilyType type, TiKVKey && key, TiKVValue && value)
     return doInsert(type, std::move(key), std::move(value));
 }
 
-void Region::doInsert(ColumnFamilyType type, TiKVKey && key, TiKVValue && value)
+void Region::doInsert(ColumnFamilyType type, TiKVKey && key, TiKVValue && value, RegionData::InsertHint * hint)
 {
-    data.insert(type, std::move(key), std::move(value));
+    auto insert_data = [&](TiKVKey && key_, TiKVValue && value_) {
+        if (hint)
+            data.insert(type, std::move(key_), std::move(value_), *hint);
+        else
+            data.insert(type, std::move(key_), std::move(value_));
+    };
+
+    if (delta.isRecording())
+    {
+        auto delta_key = TiKVKey::copyFrom(key);
+        auto delta_value = TiKVValue::copyFrom(value);
+        insert_data(std::move(key), std::move(value));
+        delta.recordInsert(type, std::move(delta_key), std::move(delta_value), data.dataSize());
+        return;
+    }
+    insert_data(std::move(key), std::move(value));
 }
 
 void Region::remove(const std::string & cf, const TiKVKey & key)
@@ -83,12 +102,15 @@ void Region::remove(const std::string & cf, const TiKVKey & key)
 void Region::doRemove(ColumnFamilyType type, const TiKVKey & key)
 {
     data.remove(type, key);
+    if (delta.isRecording())
+        delta.recordRemove(type, key, data.dataSize());
 }
 
 void Region::clearAllData()
 {
     std::unique_lock lock(mutex);
     data = RegionData();
+    delta.reset();
 }
 
 UInt64 Region::appliedIndex() const
@@ -102,6 +124,7 @@ RegionPtr Region::splitInto(RegionMeta && meta)
 
     const auto range = new_region->getRange();
     data.splitInto(range->comparableKeys(), new_region->data);
+    delta.reset();
 
     return new_region;
 }
@@ -265,6 +288,7 @@ RegionID RegionRaftCommandDelegate::execCommitMerge(const raft_cmdpb::AdminReque
             std::shared_lock<std::shared_mutex> lock2(source_region->mutex);
             data.mergeFrom(source_region->data);
         }
+        delta.reset();
 
         meta_delegate.execCommitMerge(res, index, term, source_region_meta_delegate, response);
     }
@@ -349,7 +373,7 @@ void RegionRaftCommandDelegate::handleAdminRaftCmd(const raft_cmdpb::AdminReques
     meta.notifyAll();
 }
 
-std::tuple<size_t, UInt64> Region::serialize(WriteBuffer & buf) const
+std::tuple<size_t, UInt64> Region::serialize(WriteBuffer & buf, RegionDataDelta::Mark * delta_mark) const
 {
     size_t total_size = writeBinary2(Region::CURRENT_VERSION, buf);
     UInt64 applied_index = -1;
@@ -364,11 +388,65 @@ std::tuple<size_t, UInt64> Region::serialize(WriteBuffer & buf) const
         }
 
         total_size += data.serialize(buf);
+
+        if (delta_mark)
+            *delta_mark = delta.mark(applied_index);
     }
 
     return {total_size, applied_index};
 }
 
+std::optional<std::tuple<size_t, UInt64>> Region::trySerializeDelta(WriteBuffer & buf) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    if (!delta.hasBase() || delta.bytes() * 2 >= data.dataSize())
+        return std::nullopt;
+
+    size_t total_size = writeBinary2(Region::DELTA_VERSION, buf);
+    total_size += writeBinary2(delta.baseAppliedIndex(), buf);
+
+    auto [size, applied_index] = meta.serialize(buf);
+    total_size += size;
+
+    total_size += delta.serialize(buf);
+    return std::make_tuple(total_size, applied_index);
+}
+
+bool Region::applyDelta(ReadBuffer & buf)
+{
+    auto version = readBinary2<UInt32>(buf);
+    if (version != Region::DELTA_VERSION)
+        throw Exception(std::string(__PRETTY_FUNCTION__) + ": unexpected version: " + DB::toString(version)
+                            + ", expected: " + DB::toString(DELTA_VERSION),
+                        ErrorCodes::UNKNOWN_FORMAT_VERSION);
+
+    auto base_applied_index = readBinary2<UInt64>(buf);
+    if (base_applied_index != appliedIndex())
+        return false;
+
+    auto new_meta = RegionMeta::deserialize(buf);
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    RegionDataDelta::deserializeAndApply(buf, data);
+    meta.assignRegionMeta(std::move(new_meta));
+    return true;
+}
+
+void Region::onBasePersisted(const RegionDataDelta::Mark & delta_mark) const
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    delta.onBasePersisted(delta_mark);
+}
+
+void Region::resetDelta() const
+{
+    if (!delta.isRecording())
+        return;
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    delta.reset();
+}
+
 RegionPtr Region::deserialize(ReadBuffer & buf, const TiFlashRaftProxyHelper * proxy_helper)
 {
     auto version = readBinary2<UInt32>(buf);
@@ -554,6 +632,13 @@ std::tuple<WaitIndexResult, double> Region::waitIndex(UInt64 index, const UInt64
     return {WaitIndexResult::Finished, 0};
 }
 
+bool Region::addIndexWaiter(UInt64 index, const WaitIndexBatchPtr & batch) const
+{
+    if (proxy_helper == nullptr)
+        return false;
+    return meta.addIndexWaiter(index, batch);
+}
+
 UInt64 Region::version() const
 {
     return meta.version();
@@ -569,6 +654,7 @@ void Region::assignRegion(Region && new_region)
     std::unique_lock<std::shared_mutex> lock(mutex);
 
     data.assignRegionData(std::move(new_region.data));
+    delta.reset();
 
     meta.assignRegionMeta(std::move(new_region.meta));
     meta.notifyAll();
@@ -607,6 +693,8 @@ void Region::tryCompactionFilter(const Timestamp safe_point)
     // No need to check default cf. Because tikv will gc default cf before write cf.
     if (del_write)
     {
+        // The erased records are not recorded in the delta, write a full snapshot next time.
+        delta.reset();
         LOG_FMT_INFO(log,
                      "delete {} records in write cf for region {}",
                      del_write,
@@ -616,7 +704,7 @@ void Region::tryCompactionFilter(const Timestamp safe_point)
 
 EngineStoreApplyRes Region::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt64 index, UInt64 term, TMTContext & tmt)
 {
-    if (index <= appliedIndex())
+    if (index <= std::max(appliedIndex(), async_applied_index.load()))
     {
         return EngineStoreApplyRes::None;
     }
@@ -625,6 +713,9 @@ EngineStoreApplyRes Region::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt6
     Stopwatch watch;
     SCOPE_EXIT({ GET_METRIC(tiflash_raft_apply_write_command_duration_seconds, type_write).Observe(watch.elapsedSeconds()); });
 
+    // The keys of a batch are usually in ascending order, insert them one after another.
+    RegionData::InsertHint insert_hint;
+
     const auto handle_by_index_func = [&](auto i) {
         auto type = cmds.cmd_types[i];
         auto cf = cmds.cmd_cf[i];
@@ -636,7 +727,7 @@ EngineStoreApplyRes Region::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt6
             auto tikv_value = TiKVValue(cmds.vals[i].data, cmds.vals[i].len);
             try
             {
-                doInsert(cf, std::move(tikv_key), std::move(tikv_value));
+                doInsert(cf, std::move(tikv_key), std::move(tikv_value), &insert_hint);
             }
             catch (Exception & e)
             {
@@ -657,6 +748,7 @@ EngineStoreApplyRes Region::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt6
             try
             {
                 doRemove(cf, tikv_key);
+                insert_hint = data.initInsertHint();
             }
             catch (Exception & e)
             {
@@ -699,13 +791,34 @@ EngineStoreApplyRes Region::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt6
         approx_mem_cache_bytes += cache_written_size;
     };
 
+    if (auto * flush_pipeline = tmt.getKVStore() ? tmt.getKVStore()->getFlushPipeline() : nullptr; flush_pipeline)
+    {
+        std::optional<RegionDataReadInfoList> data_list;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+
+            insert_hint = data.initInsertHint();
+            handle_write_cmd_func();
+
+            // Take the committed data out and leave the applied index to be advanced after they are written.
+            if (0 != cmds.len)
+                data_list = RegionTable::takeCommittedDataByRegion(shared_from_this(), false);
+            async_applied_index = index;
+        }
+        flush_pipeline->submit(shared_from_this(), std::move(data_list), index, term);
+        return EngineStoreApplyRes::None;
+    }
+
     {
         std::unique_lock<std::shared_mutex> lock(mutex);
 
+        insert_hint = data.initInsertHint();
         handle_write_cmd_func();
 
         // If transfer-leader happened during ingest-sst, there might be illegal data.
-        if (0 != cmds.len)
+        // If the storage is stalled, keep the committed data in the region instead of blocking the apply thread. They
+        // are written into storage by the next write of the region or before the reads, and persisted with the region.
+        if (0 != cmds.len && !RegionTable::isWriteThrottled(context, *this))
         {
             /// Flush data right after they are committed.
             RegionDataReadInfoList data_list_to_remove;
@@ -720,6 +833,17 @@ EngineStoreApplyRes Region::handleWriteRaftCmd(const WriteCmdsView & cmds, UInt6
     return EngineStoreApplyRes::None;
 }
 
+void Region::setAppliedAfterFlush(UInt64 index, UInt64 term)
+{
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (index <= appliedIndex())
+            return;
+        meta.setApplied(index, term);
+    }
+    meta.notifyAll();
+}
+
 void Region::finishIngestSSTByDTFile(RegionPtr && rhs, UInt64 index, UInt64 term)
 {
     if (index <= appliedIndex())
@@ -733,6 +857,7 @@ void Region::finishIngestSSTByDTFile(RegionPtr && rhs, UInt64 index, UInt64 term
             // Merge the uncommitted data from `rhs`
             // (we have taken the ownership of `rhs`, so don't acquire lock on `rhs.mutex`)
             data.mergeFrom(rhs->data);
+            delta.reset();
         }
 
         meta.setApplied(index, term);
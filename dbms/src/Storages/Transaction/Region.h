@@ -15,10 +15,12 @@
 #pragma once
 
 #include <Storages/Transaction/RegionData.h>
+#include <Storages/Transaction/RegionDataDelta.h>
 #include <Storages/Transaction/RegionMeta.h>
 #include <Storages/Transaction/TiKVKeyValue.h>
 #include <common/logger_useful.h>
 
+#include <optional>
 #include <shared_mutex>
 
 namespace kvrpcpb
@@ -57,6 +59,7 @@ class Region : public std::enable_shared_from_this<Region>
 {
 public:
     const static UInt32 CURRENT_VERSION;
+    const static UInt32 DELTA_VERSION;
 
     static const auto PutFlag = RecordKVFormat::CFModifyFlag::PutFlag;
     static const auto DelFlag = RecordKVFormat::CFModifyFlag::DelFlag;
@@ -75,11 +78,12 @@ public:
             write_map_size = data.size();
             write_map_it = data.begin();
             write_map_it_end = data.end();
+            default_map_cursor = store->data.defaultCF().getData().begin();
         }
 
         bool hasNext() const { return write_map_size && write_map_it != write_map_it_end; }
 
-        auto next(bool need_value = true) { return store->readDataByWriteIt(write_map_it++, need_value); }
+        auto next(bool need_value = true) { return store->readDataByWriteIt(write_map_it++, need_value, &default_map_cursor); }
 
         DecodedLockCFValuePtr getLockInfo(const RegionLockReadQuery & query) { return store->getLockInfo(query); }
 
@@ -92,6 +96,8 @@ public:
         size_t write_map_size = 0;
         RegionData::ConstWriteCFIter write_map_it;
         RegionData::ConstWriteCFIter write_map_it_end;
+        // The values of the committed records are usually in the same order in default cf.
+        RegionData::ConstDefaultCFIter default_map_cursor;
     };
 
     class CommittedRemover : private boost::noncopyable
@@ -130,9 +136,22 @@ public:
     CommittedScanner createCommittedScanner(bool use_lock = true);
     CommittedRemover createCommittedRemover(bool use_lock = true);
 
-    std::tuple<size_t, UInt64> serialize(WriteBuffer & buf) const;
+    /// Serialize the full snapshot. If `delta_mark` is not null, start recording the changes after it,
+    /// and call `onBasePersisted` with it after the snapshot is persisted.
+    std::tuple<size_t, UInt64> serialize(WriteBuffer & buf, RegionDataDelta::Mark * delta_mark = nullptr) const;
     static RegionPtr deserialize(ReadBuffer & buf, const TiFlashRaftProxyHelper * proxy_helper = nullptr);
 
+    /// Serialize the meta and the data changes since the last persisted full snapshot.
+    /// Return std::nullopt if there is no such snapshot, or the changes are too large compared with the region data
+    /// and a full snapshot should be written instead.
+    std::optional<std::tuple<size_t, UInt64>> trySerializeDelta(WriteBuffer & buf) const;
+    /// Apply a delta serialized by `trySerializeDelta`. Return false without any change if the delta
+    /// is not based on the current applied index.
+    bool applyDelta(ReadBuffer & buf);
+
+    void onBasePersisted(const RegionDataDelta::Mark & delta_mark) const;
+    void resetDelta() const;
+
     std::string getDebugString() const;
     RegionID id() const;
     ImutRegionRangePtr getRange() const;
@@ -165,11 +184,17 @@ public:
 
     // Return <WaitIndexResult, time cost(seconds)> for wait-index.
     std::tuple<WaitIndexResult, double> waitIndex(UInt64 index, const UInt64 timeout_ms, std::function<bool(void)> && check_running);
+    // Register `batch` to wait for the applied index reaching `index` together with other regions, see `WaitIndexBatch`.
+    // Returns false if there is no need to wait.
+    bool addIndexWaiter(UInt64 index, const WaitIndexBatchPtr & batch) const;
 
     UInt64 appliedIndex() const;
 
     void notifyApplied() { meta.notifyAll(); }
 
+    /// Advance the applied index after the committed data of raft apply [index, term] are written by `RegionFlushPipeline`.
+    void setAppliedAfterFlush(UInt64 index, UInt64 term);
+
     RegionVersion version() const;
     RegionVersion confVer() const;
 
@@ -207,11 +232,11 @@ private:
 
     // Private methods no need to lock mutex, normally
 
-    void doInsert(ColumnFamilyType type, TiKVKey && key, TiKVValue && value);
+    void doInsert(ColumnFamilyType type, TiKVKey && key, TiKVValue && value, RegionData::InsertHint * hint = nullptr);
     void doCheckTable(const DecodedTiKVKey & key) const;
     void doRemove(ColumnFamilyType type, const TiKVKey & key);
 
-    RegionDataReadInfo readDataByWriteIt(const RegionData::ConstWriteCFIter & write_it, bool need_value = true) const;
+    RegionDataReadInfo readDataByWriteIt(const RegionData::ConstWriteCFIter & write_it, bool need_value = true, RegionData::ConstDefaultCFIter * default_cursor = nullptr) const;
     RegionData::WriteCFIter removeDataByWriteIt(const RegionData::WriteCFIter & write_it);
 
     DecodedLockCFValuePtr getLockInfo(const RegionLockReadQuery & query) const;
@@ -223,6 +248,9 @@ private:
     RegionData data;
     mutable std::shared_mutex mutex;
 
+    // Changes since the last persisted full snapshot, guarded by `mutex`.
+    mutable RegionDataDelta delta;
+
     RegionMeta meta;
 
     Poco::Logger * log;
@@ -234,6 +262,8 @@ private:
     mutable std::atomic<Timepoint> last_compact_log_time{Timepoint::min()};
     mutable std::atomic<size_t> approx_mem_cache_rows{0};
     mutable std::atomic<size_t> approx_mem_cache_bytes{0};
+    // The max index applied in memory whose committed data may be still flushing by `RegionFlushPipeline`.
+    std::atomic<UInt64> async_applied_index{0};
 };
 
 class RegionRaftCommandDelegate : public Region
@@ -109,6 +109,14 @@ bool RegionBlockReader::readImpl(Block & block, const RegionDataReadInfoList & d
             raw_column->reserve(expected_rows);
         }
     }
+    // Reused by all the rows decoded into this block
+    RowDecodeBuffer decode_buffer;
+    const ColumnID pk_handle_id = schema_snapshot->pk_is_handle ? schema_snapshot->pk_column_ids[0] : InvalidColumnID;
+    // The positions of pk columns in block, looked up once for all rows
+    std::vector<size_t> pk_column_pos;
+    pk_column_pos.reserve(pk_column_ids.size());
+    for (const auto pk_column_id : pk_column_ids)
+        pk_column_pos.emplace_back(pk_pos_map.at(pk_column_id));
     size_t index = 0;
     for (const auto & [pk, write_type, commit_ts, value_ptr] : data_list)
     {
@@ -128,8 +136,7 @@ bool RegionBlockReader::readImpl(Block & block, const RegionDataReadInfoList & d
                     // when pk is handle, we can decode the pk from the key
                     if (!(schema_snapshot->pk_is_handle && ci.hasPriKeyFlag()))
                     {
-                        auto * raw_column = const_cast<IColumn *>((block.getByPosition(next_column_pos_copy)).column.get());
-                        raw_column->insertDefault();
+                        decode_buffer.getColumn(block, next_column_pos_copy)->insertDefault();
                     }
                     column_ids_iter_copy++;
                     next_column_pos_copy++;
@@ -137,16 +144,8 @@ bool RegionBlockReader::readImpl(Block & block, const RegionDataReadInfoList & d
             }
             else
             {
-                if (schema_snapshot->pk_is_handle)
-                {
-                    if (!appendRowToBlock(*value_ptr, column_ids_iter, read_column_ids.end(), block, next_column_pos, schema_snapshot->column_infos, schema_snapshot->pk_column_ids[0], force_decode))
-                        return false;
-                }
-                else
-                {
-                    if (!appendRowToBlock(*value_ptr, column_ids_iter, read_column_ids.end(), block, next_column_pos, schema_snapshot->column_infos, InvalidColumnID, force_decode))
-                        return false;
-                }
+                if (!appendRowToBlock(*value_ptr, column_ids_iter, read_column_ids.end(), block, next_column_pos, schema_snapshot->column_infos, pk_handle_id, force_decode, &decode_buffer, schema_snapshot->is_projection))
+                    return false;
             }
         }
 
@@ -154,11 +153,11 @@ bool RegionBlockReader::readImpl(Block & block, const RegionDataReadInfoList & d
         if constexpr (pk_type != TMTPKType::STRING)
         {
             // extra handle column's type is always Int64
-            auto * raw_extra_column = const_cast<IColumn *>((block.getByPosition(extra_handle_column_pos)).column.get());
+            auto * raw_extra_column = decode_buffer.getColumn(block, extra_handle_column_pos);
             static_cast<ColumnInt64 *>(raw_extra_column)->getData().push_back(Int64(pk));
             if (!pk_column_ids.empty())
             {
-                auto * raw_pk_column = const_cast<IColumn *>((block.getByPosition(pk_pos_map.at(pk_column_ids[0]))).column.get());
+                auto * raw_pk_column = decode_buffer.getColumn(block, pk_column_pos[0]);
                 if constexpr (pk_type == TMTPKType::INT64)
                     static_cast<ColumnInt64 *>(raw_pk_column)->getData().push_back(Int64(pk));
                 else if constexpr (pk_type == TMTPKType::UINT64)
@@ -187,7 +186,7 @@ bool RegionBlockReader::readImpl(Block & block, const RegionDataReadInfoList & d
         else
         {
             // For common handle, sometimes we need to decode the value from encoded key instead of encoded value
-            auto * raw_extra_column = const_cast<IColumn *>((block.getByPosition(extra_handle_column_pos)).column.get());
+            auto * raw_extra_column = decode_buffer.getColumn(block, extra_handle_column_pos);
             raw_extra_column->insertData(pk->data(), pk->size());
             /// decode key and insert pk columns if needed
             size_t cursor = 0, pos = 0;
@@ -198,7 +197,7 @@ bool RegionBlockReader::readImpl(Block & block, const RegionDataReadInfoList & d
                 /// some examples that we must decode column value from value part
                 ///   1) if collation is enabled, the extra key may be a transformation of the original value of pk cols
                 ///   2) the primary key may just be a prefix of a column
-                auto * raw_pk_column = const_cast<IColumn *>(block.getByPosition(pk_pos_map.at(pk_column_ids[pos])).column.get());
+                auto * raw_pk_column = decode_buffer.getColumn(block, pk_column_pos[pos]);
                 if (raw_pk_column->size() == index)
                 {
                     raw_pk_column->insert(value);
@@ -50,6 +50,17 @@ RegionDataRes RegionCFDataBase<Trait>::insert(TiKVKey && key, TiKVValue && value
     return insert(std::move(*kv_pair));
 }
 
+template <typename Trait>
+RegionDataRes RegionCFDataBase<Trait>::insert(TiKVKey && key, TiKVValue && value, typename Map::iterator & hint)
+{
+    const auto & raw_key = RecordKVFormat::decodeTiKVKey(key);
+    auto kv_pair = Trait::genKVPair(std::move(key), raw_key, std::move(value));
+    if (!kv_pair)
+        return 0;
+
+    return insert(std::move(*kv_pair), hint);
+}
+
 template <>
 RegionDataRes RegionCFDataBase<RegionLockCFDataTrait>::insert(TiKVKey && key, TiKVValue && value)
 {
@@ -59,14 +70,61 @@ RegionDataRes RegionCFDataBase<RegionLockCFDataTrait>::insert(TiKVKey && key, Ti
     return 0;
 }
 
+template <>
+RegionDataRes RegionCFDataBase<RegionLockCFDataTrait>::insert(TiKVKey && key, TiKVValue && value, Map::iterator &)
+{
+    // The lock cf is a hash map, there is no order to make use of.
+    return insert(std::move(key), std::move(value));
+}
+
+template <typename Trait>
+void RegionCFDataBase<Trait>::sharePK(Key & key, typename Map::const_iterator pos) const
+{
+    if constexpr (std::is_same_v<Trait, RegionLockCFDataTrait>)
+    {
+        std::ignore = key;
+        std::ignore = pos;
+    }
+    else
+    {
+        auto & pk = key.first;
+        if (pos != data.end() && pos->first.first == pk)
+            pk = pos->first.first;
+        else if (pos != data.begin() && std::prev(pos)->first.first == pk)
+            pk = std::prev(pos)->first.first;
+    }
+}
+
 template <typename Trait>
 RegionDataRes RegionCFDataBase<Trait>::insert(std::pair<Key, Value> && kv_pair)
 {
     auto & map = data;
-    auto [it, ok] = map.emplace(std::move(kv_pair));
-    if (!ok)
+    if constexpr (std::is_same_v<Trait, RegionLockCFDataTrait>)
+    {
+        auto [it, ok] = map.emplace(std::move(kv_pair));
+        if (!ok)
+            throw Exception("Found existing key in hex: " + getTiKVKey(it->second).toDebugString(), ErrorCodes::LOGICAL_ERROR);
+        return calcTiKVKeyValueSize(it->second);
+    }
+    else
+    {
+        // Find the position by `lower_bound` and insert there, to share the pk with the adjacent versions.
+        auto pos = map.lower_bound(kv_pair.first);
+        return insert(std::move(kv_pair), pos);
+    }
+}
+
+template <typename Trait>
+RegionDataRes RegionCFDataBase<Trait>::insert(std::pair<Key, Value> && kv_pair, typename Map::iterator & hint)
+{
+    auto & map = data;
+    sharePK(kv_pair.first, hint);
+    const size_t ori_size = map.size();
+    auto it = map.emplace_hint(hint, std::move(kv_pair));
+    if (map.size() == ori_size)
         throw Exception("Found existing key in hex: " + getTiKVKey(it->second).toDebugString(), ErrorCodes::LOGICAL_ERROR);
 
+    hint = std::next(it);
     return calcTiKVKeyValueSize(it->second);
 }
 
@@ -174,11 +232,14 @@ size_t RegionCFDataBase<Trait>::mergeFrom(const RegionCFDataBase & ori_region_da
     const auto & ori_map = ori_region_data.data;
     auto & tar_map = data;
 
+    // The merged regions are adjacent, so the keys from `ori_map` are inserted in ascending order at one place.
+    auto hint = tar_map.end();
     for (auto it = ori_map.begin(); it != ori_map.end(); it++)
     {
         size_changed += calcTiKVKeyValueSize(it->second);
-        auto ok = tar_map.emplace(*it).second;
-        if (!ok)
+        const size_t ori_size = tar_map.size();
+        hint = std::next(tar_map.emplace_hint(hint, *it));
+        if (tar_map.size() == ori_size)
             throw Exception(std::string(__PRETTY_FUNCTION__) + ": got duplicate key", ErrorCodes::LOGICAL_ERROR);
     }
 
@@ -202,7 +263,7 @@ size_t RegionCFDataBase<Trait>::splitInto(const RegionRange & range, RegionCFDat
             if (start_key.compare(key) <= 0 && end_key.compare(key) > 0)
             {
                 size_changed += calcTiKVKeyValueSize(it->second);
-                tar_map.insert(std::move(*it));
+                tar_map.emplace_hint(tar_map.end(), std::move(*it));
                 it = ori_map.erase(it);
             }
             else
@@ -237,11 +298,13 @@ size_t RegionCFDataBase<Trait>::deserialize(ReadBuffer & buf, RegionCFDataBase &
 {
     size_t size = readBinary2<size_t>(buf);
     size_t cf_data_size = 0;
+    // The keys are serialized in order.
+    auto hint = new_region_data.data.end();
     for (size_t i = 0; i < size; ++i)
     {
         auto key = TiKVKey::deserialize(buf);
         auto value = TiKVValue::deserialize(buf);
-        cf_data_size += new_region_data.insert(std::move(key), std::move(value));
+        cf_data_size += new_region_data.insert(std::move(key), std::move(value), hint);
     }
     return cf_data_size;
 }
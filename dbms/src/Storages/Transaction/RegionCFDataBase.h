@@ -41,6 +41,14 @@ struct RegionCFDataBase
 
     RegionDataRes insert(TiKVKey && key, TiKVValue && value);
 
+    // Same as `insert`, but try to insert right before `hint` first and then set `hint` to the position after the
+    // inserted one. Inserting keys in ascending order this way takes amortized constant time instead of a lookup
+    // in the whole map. `hint` must be a valid iterator of `data`, e.g. `getDataMut().end()`.
+    RegionDataRes insert(TiKVKey && key, TiKVValue && value, typename Map::iterator & hint);
+
+    // Insert the decoded pair, e.g. whose pk is shared with another cf by `RegionData`.
+    RegionDataRes insert(std::pair<Key, Value> && kv_pair, typename Map::iterator & hint);
+
     static size_t calcTiKVKeyValueSize(const Value & value);
 
     static size_t calcTiKVKeyValueSize(const TiKVKey & key, const TiKVValue & value);
@@ -71,6 +79,9 @@ struct RegionCFDataBase
 private:
     static bool shouldIgnoreRemove(const Value & value);
     RegionDataRes insert(std::pair<Key, Value> && kv_pair);
+    // Make `key` share the pk with the entry at `pos` or the one before it if they are the versions of the same row,
+    // so that the pk of a row is kept in memory once.
+    void sharePK(Key & key, typename Map::const_iterator pos) const;
 
 private:
     Data data;
@@ -38,7 +38,7 @@ void RegionData::insert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value)
     {
     case ColumnFamilyType::Write:
     {
-        cf_data_size += write_cf.insert(std::move(key), std::move(value));
+        insertWriteCF(std::move(key), std::move(value), nullptr);
         return;
     }
     case ColumnFamilyType::Default:
@@ -54,6 +54,58 @@ void RegionData::insert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value)
     }
 }
 
+void RegionData::insertWriteCF(TiKVKey && key, TiKVValue && value, WriteCFIter * hint)
+{
+    const auto & raw_key = RecordKVFormat::decodeTiKVKey(key);
+    auto decoded_pair = RegionWriteCFDataTrait::genKVPair(std::move(key), raw_key, std::move(value));
+    if (!decoded_pair)
+        return;
+    std::pair<RegionWriteCFData::Key, RegionWriteCFData::Value> kv_pair(std::move(*decoded_pair));
+
+    // The committed row shares the pk with its prewritten value in default cf, which is usually inserted before.
+    auto & pk = kv_pair.first.first;
+    const auto & decoded_val = std::get<2>(kv_pair.second);
+    if (decoded_val.write_type == RecordKVFormat::CFModifyFlag::PutFlag && !decoded_val.short_value)
+    {
+        const auto & default_map = default_cf.getData();
+        if (auto data_it = default_map.find({pk, decoded_val.prewrite_ts}); data_it != default_map.end())
+            pk = data_it->first.first;
+    }
+
+    auto & write_map = write_cf.getDataMut();
+    auto pos = hint ? *hint : write_map.lower_bound(kv_pair.first);
+    cf_data_size += write_cf.insert(std::move(kv_pair), pos);
+    if (hint)
+        *hint = pos;
+}
+
+RegionData::InsertHint RegionData::initInsertHint()
+{
+    return InsertHint{write_cf.getDataMut().end(), default_cf.getDataMut().end()};
+}
+
+void RegionData::insert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value, InsertHint & hint)
+{
+    switch (cf)
+    {
+    case ColumnFamilyType::Write:
+    {
+        insertWriteCF(std::move(key), std::move(value), &hint.write_it);
+        return;
+    }
+    case ColumnFamilyType::Default:
+    {
+        cf_data_size += default_cf.insert(std::move(key), std::move(value), hint.default_it);
+        return;
+    }
+    case ColumnFamilyType::Lock:
+    {
+        lock_cf.insert(std::move(key), std::move(value));
+        return;
+    }
+    }
+}
+
 void RegionData::remove(ColumnFamilyType cf, const TiKVKey & key)
 {
     switch (cf)
@@ -109,7 +161,7 @@ RegionData::WriteCFIter RegionData::removeDataByWriteIt(const WriteCFIter & writ
     return write_cf.getDataMut().erase(write_it);
 }
 
-RegionDataReadInfo RegionData::readDataByWriteIt(const ConstWriteCFIter & write_it, bool need_value) const
+RegionDataReadInfo RegionData::readDataByWriteIt(const ConstWriteCFIter & write_it, bool need_value, ConstDefaultCFIter * default_cursor) const
 {
     const auto & [key, value, decoded_val] = write_it->second;
     const auto & [pk, ts] = write_it->first;
@@ -126,8 +178,19 @@ RegionDataReadInfo RegionData::readDataByWriteIt(const ConstWriteCFIter & write_
     if (!decoded_val.short_value)
     {
         const auto & map = default_cf.getData();
-        if (auto data_it = map.find({pk, decoded_val.prewrite_ts}); data_it != map.end())
+        const RegionDefaultCFData::Key default_key{pk, decoded_val.prewrite_ts};
+        auto data_it = map.end();
+        if (default_cursor && *default_cursor != map.end() && (*default_cursor)->first == default_key)
+            data_it = *default_cursor;
+        else
+            data_it = map.find(default_key);
+
+        if (data_it != map.end())
+        {
+            if (default_cursor)
+                *default_cursor = std::next(data_it);
             return std::make_tuple(pk, decoded_val.write_type, ts, RegionDefaultCFDataTrait::getTiKVValue(data_it));
+        }
         else
             throw Exception("Raw TiDB PK: " + (pk.toDebugString()) + ", Prewrite ts: " + std::to_string(decoded_val.prewrite_ts)
                                 + " can not found in default cf for key: " + key->toDebugString(),
@@ -36,13 +36,28 @@ class RegionData
 public:
     using WriteCFIter = RegionWriteCFData::Map::iterator;
     using ConstWriteCFIter = RegionWriteCFData::Map::const_iterator;
+    using DefaultCFIter = RegionDefaultCFData::Map::iterator;
+    using ConstDefaultCFIter = RegionDefaultCFData::Map::const_iterator;
+
+    // The positions to insert the next keys of write cf and default cf for a batch of keys, see `RegionCFDataBase::insert`.
+    // It must be reset by `initInsertHint` after removing any key.
+    struct InsertHint
+    {
+        WriteCFIter write_it;
+        DefaultCFIter default_it;
+    };
+
+    InsertHint initInsertHint();
 
     void insert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value);
+    void insert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value, InsertHint & hint);
     void remove(ColumnFamilyType cf, const TiKVKey & key);
 
     WriteCFIter removeDataByWriteIt(const WriteCFIter & write_it);
 
-    RegionDataReadInfo readDataByWriteIt(const ConstWriteCFIter & write_it, bool need_value = true) const;
+    // If `default_cursor` is not null, it is checked before looking up the value in default cf, and set to the position
+    // after the found one. Reading the write cf in order with it is a sequential scan on both cfs for the normal case.
+    RegionDataReadInfo readDataByWriteIt(const ConstWriteCFIter & write_it, bool need_value = true, ConstDefaultCFIter * default_cursor = nullptr) const;
 
     DecodedLockCFValuePtr getLockInfo(const RegionLockReadQuery & query) const;
 
@@ -76,6 +91,9 @@ public:
 private:
     friend class Region;
 
+    // Insert into write cf, `hint` is the same as `InsertHint::write_it` or nullptr.
+    void insertWriteCF(TiKVKey && key, TiKVValue && value, WriteCFIter * hint);
+
 private:
     RegionWriteCFData write_cf;
     RegionDefaultCFData default_cf;
@@ -0,0 +1,133 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Storages/Transaction/RegionData.h>
+#include <Storages/Transaction/RegionDataDelta.h>
+#include <Storages/Transaction/SerializationHelper.h>
+#include <Storages/Transaction/TiKVRecordFormat.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+} // namespace ErrorCodes
+
+namespace
+{
+// Keep recording until the delta is larger than the region data and this size, so that small
+// regions would not be forced to write a full snapshot on every persist.
+constexpr size_t DELTA_MIN_RESET_BYTES = 1024 * 1024;
+} // namespace
+
+RegionDataDelta::Mark RegionDataDelta::mark(UInt64 applied_index)
+{
+    recording.store(true, std::memory_order_relaxed);
+    return Mark{generation, ops.size(), applied_index};
+}
+
+void RegionDataDelta::onBasePersisted(const Mark & mark_)
+{
+    if (mark_.generation != generation)
+        return;
+
+    for (size_t i = 0; i < mark_.num_ops; ++i)
+    {
+        const auto & op = ops.front();
+        total_bytes -= op.key.dataSize() + op.value.dataSize();
+        ops.pop_front();
+    }
+    has_base = true;
+    base_applied_index = mark_.applied_index;
+}
+
+void RegionDataDelta::recordInsert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value, size_t data_size)
+{
+    push(OpType::Insert, cf, std::move(key), std::move(value), data_size);
+}
+
+void RegionDataDelta::recordRemove(ColumnFamilyType cf, const TiKVKey & key, size_t data_size)
+{
+    push(OpType::Remove, cf, TiKVKey::copyFrom(key), TiKVValue(), data_size);
+}
+
+void RegionDataDelta::recordRemoveCommitted(const TiKVKey & write_key, size_t data_size)
+{
+    push(OpType::RemoveCommitted, ColumnFamilyType::Write, TiKVKey::copyFrom(write_key), TiKVValue(), data_size);
+}
+
+void RegionDataDelta::push(OpType type, ColumnFamilyType cf, TiKVKey && key, TiKVValue && value, size_t data_size)
+{
+    total_bytes += key.dataSize() + value.dataSize();
+    ops.push_back(Op{type, cf, std::move(key), std::move(value)});
+    if (total_bytes > std::max(data_size, DELTA_MIN_RESET_BYTES))
+        reset();
+}
+
+void RegionDataDelta::reset()
+{
+    ops.clear();
+    total_bytes = 0;
+    recording.store(false, std::memory_order_relaxed);
+    has_base = false;
+    base_applied_index = 0;
+    ++generation;
+}
+
+size_t RegionDataDelta::serialize(WriteBuffer & buf) const
+{
+    size_t total_size = writeBinary2(static_cast<UInt64>(ops.size()), buf);
+    for (const auto & op : ops)
+    {
+        total_size += writeBinary2(static_cast<UInt8>(op.type), buf);
+        total_size += writeBinary2(static_cast<UInt8>(op.cf), buf);
+        total_size += op.key.serialize(buf);
+        if (op.type == OpType::Insert)
+            total_size += op.value.serialize(buf);
+    }
+    return total_size;
+}
+
+void RegionDataDelta::deserializeAndApply(ReadBuffer & buf, RegionData & region_data)
+{
+    auto num_ops = readBinary2<UInt64>(buf);
+    for (UInt64 i = 0; i < num_ops; ++i)
+    {
+        auto type = static_cast<OpType>(readBinary2<UInt8>(buf));
+        auto cf = static_cast<ColumnFamilyType>(readBinary2<UInt8>(buf));
+        auto key = TiKVKey::deserialize(buf);
+        switch (type)
+        {
+        case OpType::Insert:
+            region_data.insert(cf, std::move(key), TiKVValue::deserialize(buf));
+            break;
+        case OpType::Remove:
+            region_data.remove(cf, key);
+            break;
+        case OpType::RemoveCommitted:
+        {
+            auto raw_key = RecordKVFormat::decodeTiKVKey(key);
+            auto & write_map = region_data.writeCF().getDataMut();
+            if (auto it = write_map.find({RecordKVFormat::getRawTiDBPK(raw_key), RecordKVFormat::getTs(key)}); it != write_map.end())
+                region_data.removeDataByWriteIt(it);
+            break;
+        }
+        default:
+            throw Exception(fmt::format("Unknown op type {} in region data delta", static_cast<UInt8>(type)), ErrorCodes::LOGICAL_ERROR);
+        }
+    }
+}
+
+} // namespace DB
@@ -0,0 +1,94 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Storages/Transaction/ColumnFamily.h>
+#include <Storages/Transaction/TiKVKeyValue.h>
+
+#include <atomic>
+#include <deque>
+
+namespace DB
+{
+class RegionData;
+
+/// The changes applied to the RegionData of a Region since its last full snapshot was persisted.
+/// RegionPersister writes them as a delta page on top of the base page, so that the cost of a
+/// persist depends on the size of the changes instead of the size of the region.
+/// Not thread safe, it is guarded by the mutex of the Region.
+class RegionDataDelta
+{
+public:
+    enum class OpType : UInt8
+    {
+        Insert = 0,
+        Remove = 1,
+        // Remove a committed record from the write cf, as well as its value in the default cf.
+        RemoveCommitted = 2,
+    };
+
+    // The state of the delta when a full snapshot is serialized.
+    struct Mark
+    {
+        UInt64 generation = 0;
+        size_t num_ops = 0;
+        UInt64 applied_index = 0;
+    };
+
+    // Start recording the changes, the recorded ops are trimmed by `onBasePersisted` with the returned mark.
+    Mark mark(UInt64 applied_index);
+    // The full snapshot serialized at `mark_` has been persisted.
+    void onBasePersisted(const Mark & mark_);
+
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+    bool hasBase() const { return has_base; }
+    UInt64 baseAppliedIndex() const { return base_applied_index; }
+    size_t bytes() const { return total_bytes; }
+
+    void recordInsert(ColumnFamilyType cf, TiKVKey && key, TiKVValue && value, size_t data_size);
+    void recordRemove(ColumnFamilyType cf, const TiKVKey & key, size_t data_size);
+    void recordRemoveCommitted(const TiKVKey & write_key, size_t data_size);
+
+    // Drop all the recorded changes, the next persist must write a full snapshot.
+    void reset();
+
+    size_t serialize(WriteBuffer & buf) const;
+    static void deserializeAndApply(ReadBuffer & buf, RegionData & region_data);
+
+private:
+    void push(OpType type, ColumnFamilyType cf, TiKVKey && key, TiKVValue && value, size_t data_size);
+
+private:
+    struct Op
+    {
+        OpType type;
+        ColumnFamilyType cf;
+        TiKVKey key;
+        TiKVValue value;
+    };
+
+    std::deque<Op> ops;
+    size_t total_bytes = 0;
+
+    // Read without the mutex of the Region as a fast path.
+    std::atomic<bool> recording{false};
+    bool has_base = false;
+    UInt64 base_applied_index = 0;
+    // Increased by every `reset`, a full snapshot serialized before that can not be the base any more.
+    UInt64 generation = 0;
+};
+
+} // namespace DB
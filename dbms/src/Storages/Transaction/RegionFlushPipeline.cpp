@@ -0,0 +1,224 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <Common/setThreadName.h>
+#include <Storages/Transaction/Region.h>
+#include <Storages/Transaction/RegionFlushPipeline.h>
+#include <Storages/Transaction/RegionTable.h>
+#include <common/logger_useful.h>
+
+namespace DB
+{
+RegionFlushPipeline::RegionFlushPipeline(Context & context_, size_t num_threads, size_t max_pending_tasks_, size_t num_pre_decode_threads)
+    : context(context_)
+    , max_pending_tasks(std::max<size_t>(max_pending_tasks_, 1))
+    , log(&Poco::Logger::get("RegionFlushPipeline"))
+{
+    workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+        workers.emplace_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < num_threads; ++i)
+        workers[i]->thread = std::thread([this, i]() { run(i); });
+    pre_decode_threads.reserve(num_pre_decode_threads);
+    for (size_t i = 0; i < num_pre_decode_threads; ++i)
+        pre_decode_threads.emplace_back([this, i]() { runPreDecode(i); });
+    LOG_FMT_INFO(log, "Start {} async flush threads, {} pre-decode threads, max pending tasks {}", num_threads, num_pre_decode_threads, max_pending_tasks);
+}
+
+RegionFlushPipeline::~RegionFlushPipeline()
+{
+    {
+        std::lock_guard lock(mutex);
+        shutdown = true;
+    }
+    pre_decode_cv.notify_all();
+    for (auto & thread : pre_decode_threads)
+        thread.join();
+    for (auto & worker : workers)
+    {
+        worker->cv.notify_all();
+        worker->thread.join();
+    }
+}
+
+void RegionFlushPipeline::submit(const RegionPtr & region, std::optional<RegionDataReadInfoList> && data_list, UInt64 index, UInt64 term)
+{
+    const auto region_id = region->id();
+    auto & worker = *workers[region_id % workers.size()];
+    {
+        std::unique_lock lock(mutex);
+        auto it = region_states.find(region_id);
+        if (it != region_states.end() && it->second.exception)
+            std::rethrow_exception(it->second.exception);
+
+        // Nothing to write and no task ahead, the applied index can be advanced right now.
+        if (!data_list && it == region_states.end())
+        {
+            lock.unlock();
+            region->setAppliedAfterFlush(index, term);
+            return;
+        }
+
+        finished_cv.wait(lock, [&] { return worker.tasks.size() < max_pending_tasks; });
+        region_states[region_id].pending += 1;
+        PreDecodePtr pre_decode;
+        if (data_list && !pre_decode_threads.empty())
+        {
+            pre_decode = std::make_shared<PreDecode>();
+            pre_decode->region = region;
+            pre_decode->data_list = std::move(*data_list);
+            data_list.reset();
+            pre_decode_tasks.push_back(pre_decode);
+            pre_decode_cv.notify_one();
+        }
+        worker.tasks.emplace_back(Task{region, std::move(data_list), index, term, std::move(pre_decode)});
+    }
+    worker.cv.notify_one();
+}
+
+void RegionFlushPipeline::waitRegion(RegionID region_id)
+{
+    std::unique_lock lock(mutex);
+    finished_cv.wait(lock, [&] {
+        auto it = region_states.find(region_id);
+        return it == region_states.end() || it->second.pending == 0;
+    });
+    if (auto it = region_states.find(region_id); it != region_states.end())
+    {
+        // Clear the state so that the region can retry after the exception is handled by the caller.
+        auto exception = std::move(it->second.exception);
+        region_states.erase(it);
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+}
+
+void RegionFlushPipeline::run(size_t worker_id)
+{
+    setThreadName(fmt::format("RaftFlush-{}", worker_id).data());
+    auto & worker = *workers[worker_id];
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock lock(mutex);
+            worker.cv.wait(lock, [&] { return shutdown || !worker.tasks.empty(); });
+            if (worker.tasks.empty())
+                break;
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        handleTask(task);
+    }
+}
+
+void RegionFlushPipeline::handleTask(Task & task)
+{
+    const auto region_id = task.region->id();
+    bool failed = false;
+    {
+        std::lock_guard lock(mutex);
+        failed = region_states[region_id].exception != nullptr;
+    }
+
+    std::exception_ptr exception;
+    // Skip the following tasks of a failed region, its applied index must not be advanced any more.
+    if (!failed)
+    {
+        try
+        {
+            if (task.pre_decode)
+                RegionTable::writeCommittedDataByRegion(context, task.region, task.pre_decode->data_list, log, takePreDecoded(*task.pre_decode));
+            else if (task.data_list)
+                RegionTable::writeCommittedDataByRegion(context, task.region, *task.data_list, log);
+            task.region->setAppliedAfterFlush(task.index, task.term);
+        }
+        catch (...)
+        {
+            tryLogCurrentException(log, fmt::format("Failed to flush [region {}] at [term {}, index {}]", region_id, task.term, task.index));
+            exception = std::current_exception();
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        auto & state = region_states[region_id];
+        state.pending -= 1;
+        if (exception)
+            state.exception = exception;
+        if (state.pending == 0 && !state.exception)
+            region_states.erase(region_id);
+    }
+    finished_cv.notify_all();
+}
+
+void RegionFlushPipeline::runPreDecode(size_t decoder_id)
+{
+    setThreadName(fmt::format("RaftDecode-{}", decoder_id).data());
+    while (true)
+    {
+        PreDecodePtr pre_decode;
+        {
+            std::unique_lock lock(mutex);
+            pre_decode_cv.wait(lock, [&] { return shutdown || !pre_decode_tasks.empty(); });
+            if (shutdown)
+                break;
+            pre_decode = std::move(pre_decode_tasks.front());
+            pre_decode_tasks.pop_front();
+        }
+
+        {
+            std::lock_guard lock(pre_decode->mutex);
+            // The flush thread has given up waiting for it.
+            if (pre_decode->state != PreDecode::State::Pending)
+                continue;
+            pre_decode->state = PreDecode::State::Decoding;
+        }
+
+        std::unique_ptr<RegionPreDecodeBlockData> cache;
+        try
+        {
+            cache = RegionTable::preDecodeCommittedData(context, pre_decode->region, pre_decode->data_list);
+        }
+        catch (...)
+        {
+            // Leave the error to the flush thread, which decodes the rows again and syncs the schema if needed.
+            tryLogCurrentException(log, fmt::format("Failed to pre-decode [region {}]", pre_decode->region->id()));
+        }
+
+        {
+            std::lock_guard lock(pre_decode->mutex);
+            pre_decode->cache = std::move(cache);
+            pre_decode->state = PreDecode::State::Done;
+        }
+        pre_decode->cv.notify_all();
+    }
+}
+
+std::unique_ptr<RegionPreDecodeBlockData> RegionFlushPipeline::takePreDecoded(PreDecode & pre_decode)
+{
+    std::unique_lock lock(pre_decode.mutex);
+    if (pre_decode.state == PreDecode::State::Pending)
+    {
+        // Decoding it here is no faster than decoding it while writing.
+        pre_decode.state = PreDecode::State::Done;
+        return nullptr;
+    }
+    pre_decode.cv.wait(lock, [&] { return pre_decode.state == PreDecode::State::Done; });
+    return std::move(pre_decode.cache);
+}
+
+} // namespace DB
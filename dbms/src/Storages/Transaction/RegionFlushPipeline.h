@@ -0,0 +1,129 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <Storages/Transaction/RegionDataRead.h>
+#include <Storages/Transaction/Types.h>
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace Poco
+{
+class Logger;
+}
+
+namespace DB
+{
+class Context;
+class Region;
+using RegionPtr = std::shared_ptr<Region>;
+struct RegionPreDecodeBlockData;
+
+/// Write the committed rows of raft apply into storage in background threads, so that the apply of
+/// a region is not blocked by the write stall of storage.
+/// The committed rows are removed from the region into an immutable batch under the region lock,
+/// and the applied index of the region is only advanced after the batch is written into storage.
+/// The tasks of a region are always handled by the same thread in order of submission.
+/// With pre-decode threads, the committed rows of the pending tasks are decoded into blocks in advance, so that the
+/// flush threads mostly just write the ready blocks into storage.
+class RegionFlushPipeline : private boost::noncopyable
+{
+public:
+    RegionFlushPipeline(Context & context_, size_t num_threads, size_t max_pending_tasks_, size_t num_pre_decode_threads = 0);
+    ~RegionFlushPipeline();
+
+    /// Write `data_list` into storage and then set the applied index of `region` to `index`.
+    /// Block if there are too many pending tasks. Rethrow the exception of a previous failed task of the region.
+    void submit(const RegionPtr & region, std::optional<RegionDataReadInfoList> && data_list, UInt64 index, UInt64 term);
+
+    /// Wait until all submitted tasks of the region are finished. Rethrow the exception of a failed task if any.
+    void waitRegion(RegionID region_id);
+
+private:
+    /// The block decoded from the committed rows of a task, shared by the task and the pre-decode threads.
+    struct PreDecode
+    {
+        enum class State
+        {
+            Pending,
+            Decoding,
+            Done,
+        };
+
+        RegionPtr region;
+        RegionDataReadInfoList data_list;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        State state = State::Pending;
+        std::unique_ptr<RegionPreDecodeBlockData> cache;
+    };
+    using PreDecodePtr = std::shared_ptr<PreDecode>;
+
+    struct Task
+    {
+        RegionPtr region;
+        std::optional<RegionDataReadInfoList> data_list;
+        UInt64 index;
+        UInt64 term;
+        /// Holds the committed rows instead of `data_list` if they are pre-decoded.
+        PreDecodePtr pre_decode;
+    };
+
+    struct RegionState
+    {
+        size_t pending = 0;
+        std::exception_ptr exception;
+    };
+
+    struct Worker
+    {
+        std::deque<Task> tasks;
+        std::condition_variable cv;
+        std::thread thread;
+    };
+
+    void run(size_t worker_id);
+    void handleTask(Task & task);
+    void runPreDecode(size_t decoder_id);
+    /// Take the pre-decoded block of the task. Wait if it is being decoded, and give up decoding if it is not started yet.
+    static std::unique_ptr<RegionPreDecodeBlockData> takePreDecoded(PreDecode & pre_decode);
+
+    Context & context;
+    const size_t max_pending_tasks;
+
+    std::mutex mutex;
+    std::condition_variable finished_cv;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unordered_map<RegionID, RegionState> region_states;
+    bool shutdown = false;
+
+    /// Protected by `mutex`.
+    std::deque<PreDecodePtr> pre_decode_tasks;
+    std::condition_variable pre_decode_cv;
+    std::vector<std::thread> pre_decode_threads;
+
+    Poco::Logger * log;
+};
+
+} // namespace DB
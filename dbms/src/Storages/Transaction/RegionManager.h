@@ -68,6 +68,12 @@ struct RegionManager : SharedMutexLockWrap
     /// Encapsulate the task lock for region
     RegionTaskLock genRegionTaskLock(RegionID region_id) const;
 
+    /// Lock-free, see RegionsRangeIndex.
+    RegionMap findRegionsByRangeOverlap(const RegionRange & range) const
+    {
+        return region_range_index.findByRangeOverlap(range);
+    }
+
     /// RegionManager can only be constructed by KVStore.
     RegionManager() = default;
 
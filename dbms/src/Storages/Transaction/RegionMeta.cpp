@@ -16,6 +16,8 @@
 #include <Storages/Transaction/RegionMeta.h>
 #include <fmt/core.h>
 
+#include <algorithm>
+
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -97,6 +99,22 @@ void RegionMeta::doSetApplied(UInt64 index, UInt64 term)
 
 void RegionMeta::notifyAll() const
 {
+    std::vector<WaitIndexBatchPtr> ready_batches;
+    {
+        std::lock_guard lock(mutex);
+        auto it = std::remove_if(index_waiters.begin(), index_waiters.end(), [&](const auto & waiter) {
+            auto batch = waiter.second.lock();
+            if (!batch)
+                return true;
+            if (!doCheckIndex(waiter.first))
+                return false;
+            ready_batches.emplace_back(std::move(batch));
+            return true;
+        });
+        index_waiters.erase(it, index_waiters.end());
+    }
+    for (const auto & batch : ready_batches)
+        batch->markReady();
     cv.notify_all();
 }
 
@@ -197,11 +215,65 @@ bool RegionMeta::checkIndex(UInt64 index) const
     return doCheckIndex(index);
 }
 
+bool RegionMeta::addIndexWaiter(UInt64 index, const WaitIndexBatchPtr & batch) const
+{
+    std::lock_guard lock(mutex);
+    if (doCheckIndex(index))
+        return false;
+    batch->addPending();
+    index_waiters.emplace_back(index, batch);
+    return true;
+}
+
 bool RegionMeta::doCheckIndex(UInt64 index) const
 {
     return region_state.getState() != raft_serverpb::PeerState::Normal || apply_state.applied_index() >= index;
 }
 
+size_t WaitIndexBatch::pendingCount() const
+{
+    std::lock_guard lock(mutex);
+    return pending;
+}
+
+void WaitIndexBatch::addPending()
+{
+    std::lock_guard lock(mutex);
+    ++pending;
+}
+
+void WaitIndexBatch::markReady()
+{
+    std::lock_guard lock(mutex);
+    if (pending > 0 && --pending == 0)
+        cv.notify_all();
+}
+
+WaitIndexResult WaitIndexBatch::wait(UInt64 timeout_ms, const std::function<bool(void)> & check_running)
+{
+    std::unique_lock lock(mutex);
+    WaitIndexResult status = WaitIndexResult::Finished;
+    auto is_done = [&] {
+        if (!check_running())
+        {
+            status = WaitIndexResult::Terminated;
+            return true;
+        }
+        return pending == 0;
+    };
+    if (timeout_ms != 0)
+    {
+        auto timeout_timepoint = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        if (!cv.wait_until(lock, timeout_timepoint, is_done))
+            status = WaitIndexResult::Timeout;
+    }
+    else
+    {
+        cv.wait(lock, is_done);
+    }
+    return status;
+}
+
 UInt64 RegionMeta::version() const
 {
     std::lock_guard lock(mutex);
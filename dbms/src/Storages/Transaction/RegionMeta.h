@@ -17,6 +17,7 @@
 #include <Storages/Transaction/RegionState.h>
 
 #include <condition_variable>
+#include <memory>
 
 namespace pingcap::kv
 {
@@ -41,6 +42,30 @@ enum class WaitIndexResult
     Timeout,
 };
 
+// Waits for the applied indexes of a batch of regions at once. Each region to wait for is registered by
+// `RegionMeta::addIndexWaiter`, and is marked ready by the apply path in `RegionMeta::notifyAll`, so a reading
+// thread sleeps once until the last region is ready instead of once for each region.
+class WaitIndexBatch
+{
+public:
+    size_t pendingCount() const;
+
+    // Wait until all the registered regions are ready, with the same semantic of `timeout_ms` and `check_running`
+    // as `RegionMeta::waitIndex`.
+    WaitIndexResult wait(UInt64 timeout_ms, const std::function<bool(void)> & check_running);
+
+private:
+    friend class RegionMeta;
+
+    void addPending();
+    void markReady();
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending = 0;
+};
+using WaitIndexBatchPtr = std::shared_ptr<WaitIndexBatch>;
+
 struct RegionMetaSnapshot
 {
     RegionVersion ver;
@@ -103,6 +128,9 @@ public:
     // If `check_running` return false, returns WaitIndexResult::Terminated
     WaitIndexResult waitIndex(UInt64 index, const UInt64 timeout_ms, std::function<bool(void)> && check_running) const;
     bool checkIndex(UInt64 index) const;
+    // Register `batch` to be marked ready once the applied index reaches `index`.
+    // Returns false without registering if it is reached already.
+    bool addIndexWaiter(UInt64 index, const WaitIndexBatchPtr & batch) const;
 
     RegionMetaSnapshot dumpRegionMetaSnapshot() const;
     MetaRaftCommandDelegate & makeRaftCommandDelegate();
@@ -131,6 +159,8 @@ private:
 
     mutable std::mutex mutex;
     mutable std::condition_variable cv;
+    // The batches waiting for the applied index, see `addIndexWaiter`. The batches given up by timeout are expired.
+    mutable std::vector<std::pair<UInt64, std::weak_ptr<WaitIndexBatch>>> index_waiters;
     const RegionID region_id;
 };
 
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <Common/FailPoint.h>
+#include <Common/Stopwatch.h>
+#include <Common/TiFlashMetrics.h>
 #include <IO/MemoryReadWriteBuffer.h>
 #include <Interpreters/Context.h>
 #include <Interpreters/Settings.h>
@@ -26,8 +28,10 @@
 #include <Storages/Transaction/Region.h>
 #include <Storages/Transaction/RegionManager.h>
 #include <Storages/Transaction/RegionPersister.h>
+#include <common/ThreadPool.h>
 
 #include <memory>
+#include <unordered_set>
 
 namespace CurrentMetrics
 {
@@ -53,6 +57,8 @@ void RegionPersister::drop(RegionID region_id, const RegionTaskLock &)
     {
         DB::WriteBatch wb_v2{ns_id};
         wb_v2.delPage(region_id);
+        if (page_reader->getPageEntry(getDeltaPageId(region_id)).isValid())
+            wb_v2.delPage(getDeltaPageId(region_id));
         page_writer->write(std::move(wb_v2), global_context.getWriteLimiter());
     }
     else
@@ -63,12 +69,12 @@ void RegionPersister::drop(RegionID region_id, const RegionTaskLock &)
     }
 }
 
-void RegionPersister::computeRegionWriteBuffer(const Region & region, RegionCacheWriteElement & region_write_buffer)
+void RegionPersister::computeRegionWriteBuffer(const Region & region, RegionCacheWriteElement & region_write_buffer, RegionDataDelta::Mark * delta_mark)
 {
     auto & [region_id, buffer, region_size, applied_index] = region_write_buffer;
 
     region_id = region.id();
-    std::tie(region_size, applied_index) = region.serialize(buffer);
+    std::tie(region_size, applied_index) = region.serialize(buffer, delta_mark);
     if (unlikely(region_size > static_cast<size_t>(std::numeric_limits<UInt32>::max())))
     {
         LOG_FMT_WARNING(
@@ -93,34 +99,89 @@ void RegionPersister::persist(const Region & region)
 void RegionPersister::doPersist(const Region & region, const RegionTaskLock * lock)
 {
     // Support only one thread persist.
-    RegionCacheWriteElement region_buffer;
-    computeRegionWriteBuffer(region, region_buffer);
+    // The buffer is computed under the task lock of region, so that the changes recorded in the delta of
+    // region are taken by one persist at a time.
+    auto persist_under_lock = [&](const RegionTaskLock & task_lock) {
+        if (page_writer && global_context.getSettingsRef().region_persister_enable_delta)
+        {
+            if (doPersistDelta(region))
+                return;
+
+            RegionCacheWriteElement region_buffer;
+            RegionDataDelta::Mark delta_mark;
+            computeRegionWriteBuffer(region, region_buffer, &delta_mark);
+            doPersist(region_buffer, task_lock, region, &delta_mark);
+        }
+        else
+        {
+            RegionCacheWriteElement region_buffer;
+            computeRegionWriteBuffer(region, region_buffer);
+            doPersist(region_buffer, task_lock, region);
+        }
+    };
 
     if (lock)
-        doPersist(region_buffer, *lock, region);
+        persist_under_lock(*lock);
     else
-        doPersist(region_buffer, region_manager.genRegionTaskLock(region.id()), region);
+        persist_under_lock(region_manager.genRegionTaskLock(region.id()));
 }
 
-void RegionPersister::doPersist(RegionCacheWriteElement & region_write_buffer, const RegionTaskLock &, const Region & region)
+std::optional<UInt64> RegionPersister::getPersistedAppliedIndex(RegionID region_id)
 {
-    auto & [region_id, buffer, region_size, applied_index] = region_write_buffer;
-
-    std::lock_guard lock(mutex);
-
+    std::optional<UInt64> persisted_index;
     if (page_reader)
     {
-        auto entry = page_reader->getPageEntry(region_id);
-        if (entry.isValid() && entry.tag > applied_index)
-            return;
+        for (auto page_id : {region_id, getDeltaPageId(region_id)})
+        {
+            auto entry = page_reader->getPageEntry(page_id);
+            if (entry.isValid())
+                persisted_index = std::max(persisted_index.value_or(0), entry.tag);
+        }
     }
     else
     {
         auto entry = stable_page_storage->getEntry(region_id, nullptr);
-        if (entry.isValid() && entry.tag > applied_index)
-            return;
+        if (entry.isValid())
+            persisted_index = entry.tag;
+    }
+    return persisted_index;
+}
+
+bool RegionPersister::doPersistDelta(const Region & region)
+{
+    MemoryWriteBuffer buffer;
+    auto res = region.trySerializeDelta(buffer);
+    if (!res)
+        return false;
+    auto [delta_size, applied_index] = *res;
+    const auto region_id = region.id();
+
+    std::lock_guard lock(mutex);
+
+    if (auto persisted_index = getPersistedAppliedIndex(region_id); persisted_index && *persisted_index > applied_index)
+        return true;
+
+    if (region.isPendingRemove())
+    {
+        LOG_FMT_DEBUG(log, "no need to persist {} because of pending remove", region.toString(false));
+        return true;
     }
 
+    DB::WriteBatch wb{ns_id};
+    wb.putPage(getDeltaPageId(region_id), applied_index, buffer.tryGetReadBuffer(), delta_size);
+    page_writer->write(std::move(wb), global_context.getWriteLimiter());
+    return true;
+}
+
+void RegionPersister::doPersist(RegionCacheWriteElement & region_write_buffer, const RegionTaskLock &, const Region & region, const RegionDataDelta::Mark * delta_mark)
+{
+    auto & [region_id, buffer, region_size, applied_index] = region_write_buffer;
+
+    std::lock_guard lock(mutex);
+
+    if (auto persisted_index = getPersistedAppliedIndex(region_id); persisted_index && *persisted_index > applied_index)
+        return;
+
     if (region.isPendingRemove())
     {
         LOG_FMT_DEBUG(log, "no need to persist {} because of pending remove", region.toString(false));
@@ -132,7 +193,15 @@ void RegionPersister::doPersist(RegionCacheWriteElement & region_write_buffer, c
     {
         DB::WriteBatch wb{ns_id};
         wb.putPage(region_id, applied_index, read_buf, region_size);
+        // The delta page is based on the previous full snapshot, remove it along with writing the new one.
+        if (page_reader->getPageEntry(getDeltaPageId(region_id)).isValid())
+            wb.delPage(getDeltaPageId(region_id));
         page_writer->write(std::move(wb), global_context.getWriteLimiter());
+
+        if (delta_mark)
+            region.onBasePersisted(*delta_mark);
+        else
+            region.resetDelta();
     }
     else
     {
@@ -181,35 +250,82 @@ void RegionPersister::forceTransformKVStoreV2toV3()
     assert(page_reader != nullptr);
     assert(page_writer != nullptr);
 
-    WriteBatch write_batch_del_v2{KVSTORE_NAMESPACE_ID};
-    auto meta_transform_acceptor = [&](const DB::Page & page) {
+    // The region data is big, so the pages are rewritten into V3 in batches bounded by
+    // `region_persister_transform_batch_bytes` instead of one big batch, and the batches are
+    // written by `region_persister_restore_concurrency` threads under the write limiter.
+    const auto & settings = global_context.getSettingsRef();
+    const size_t batch_bytes = std::max<size_t>(1, settings.region_persister_transform_batch_bytes);
+    const size_t concurrency = std::max<size_t>(1, settings.region_persister_restore_concurrency);
+    std::unique_ptr<::ThreadPool> pool;
+    if (concurrency > 1)
+        pool = std::make_unique<::ThreadPool>(concurrency);
+    auto write_limiter = global_context.getWriteLimiter();
+
+    size_t transformed_pages = 0;
+    size_t transformed_bytes = 0;
+    // The pages of a batch are held by the batch until it is written.
+    auto write_batch = [&](Pages & pages) {
         WriteBatch write_batch_transform{KVSTORE_NAMESPACE_ID};
-        // Check pages have not contain field offset
-        // Also get the tag of page_id
-        const auto & page_transform_entry = page_reader->getPageEntry(page.page_id);
-        if (!page_transform_entry.field_offsets.empty())
+        size_t bytes = 0;
+        for (const auto & page : pages)
         {
-            throw Exception(fmt::format("Can't transform kvstore from V2 to V3, [page_id={}] {}",
-                                        page.page_id,
-                                        page_transform_entry.toDebugString()),
-                            ErrorCodes::LOGICAL_ERROR);
-        }
+            // Check pages have not contain field offset
+            // Also get the tag of page_id
+            const auto & page_transform_entry = page_reader->getPageEntry(page.page_id);
+            if (!page_transform_entry.field_offsets.empty())
+            {
+                throw Exception(fmt::format("Can't transform kvstore from V2 to V3, [page_id={}] {}",
+                                            page.page_id,
+                                            page_transform_entry.toDebugString()),
+                                ErrorCodes::LOGICAL_ERROR);
+            }
 
-        write_batch_transform.putPage(page.page_id, //
-                                      page_transform_entry.tag,
-                                      std::make_shared<ReadBufferFromMemory>(page.data.begin(),
-                                                                             page.data.size()),
-                                      page.data.size());
+            write_batch_transform.putPage(page.page_id, //
+                                          page_transform_entry.tag,
+                                          std::make_shared<ReadBufferFromMemory>(page.data.begin(),
+                                                                                 page.data.size()),
+                                          page.data.size());
+            bytes += page.data.size();
+        }
+        page_writer->write(std::move(write_batch_transform), write_limiter);
+        GET_METRIC(tiflash_storage_page_transform_bytes, type_kvstore).Increment(bytes);
+    };
+    auto flush = [&](Pages && pages) {
+        if (pages.empty())
+            return;
+        if (pool)
+            pool->schedule([&write_batch, pages = std::move(pages)]() mutable { write_batch(pages); });
+        else
+            write_batch(pages);
+    };
 
-        // Will rewrite into V3 one by one.
-        // The region data is big. It is not a good idea to combine pages.
-        page_writer->write(std::move(write_batch_transform), nullptr);
+    WriteBatch write_batch_del_v2{KVSTORE_NAMESPACE_ID};
+    Pages pages_to_transform;
+    size_t pending_bytes = 0;
+    auto meta_transform_acceptor = [&](const DB::Page & page) {
+        pages_to_transform.emplace_back(page);
+        pending_bytes += page.data.size();
+        ++transformed_pages;
+        transformed_bytes += page.data.size();
 
         // Record del page_id
         write_batch_del_v2.delPage(page.page_id);
+
+        if (pending_bytes >= batch_bytes)
+        {
+            // `schedule` blocks while all the threads are busy, so at most about
+            // `concurrency + 1` batches are held in memory.
+            flush(std::move(pages_to_transform));
+            pages_to_transform = {};
+            pending_bytes = 0;
+            LOG_FMT_INFO(log, "Transforming kvstore to V3 [ns_id={}] [pages={}] [bytes={}]", ns_id, transformed_pages, transformed_bytes);
+        }
     };
 
     page_reader->traverse(meta_transform_acceptor, /*only_v2*/ true, /*only_v3*/ false);
+    flush(std::move(pages_to_transform));
+    if (pool)
+        pool->wait();
 
     // DEL must call after rewrite.
     page_writer->writeIntoV2(std::move(write_batch_del_v2), nullptr);
@@ -217,6 +333,7 @@ void RegionPersister::forceTransformKVStoreV2toV3()
 
 RegionMap RegionPersister::restore(const TiFlashRaftProxyHelper * proxy_helper, PageStorage::Config config)
 {
+    Stopwatch watch;
     {
         auto & path_pool = global_context.getPathPool();
         auto delegator = path_pool.getPSDiskDelegatorRaft();
@@ -333,29 +450,89 @@ RegionMap RegionPersister::restore(const TiFlashRaftProxyHelper * proxy_helper,
         }
 
         CurrentMetrics::set(CurrentMetrics::RegionPersisterRunMode, static_cast<UInt8>(run_mode));
-        LOG_FMT_INFO(log, "RegionPersister running. Current Run Mode is {}", static_cast<UInt8>(run_mode));
+        LOG_FMT_INFO(log, "RegionPersister running. Current Run Mode is {}, restore page storage cost {}ms", static_cast<UInt8>(run_mode), watch.elapsedMillisecondsFromLastTime());
     }
 
     RegionMap regions;
     if (page_reader)
     {
+        // The pages are traversed by this thread, and the regions are decoded by `concurrency` threads into
+        // the shards of `sharded_regions` by page id.
+        const size_t concurrency = std::max<size_t>(1, global_context.getSettingsRef().region_persister_restore_concurrency);
+        std::unique_ptr<::ThreadPool> pool;
+        if (concurrency > 1)
+            pool = std::make_unique<::ThreadPool>(concurrency);
+        std::vector<RegionMap> sharded_regions(concurrency);
+        std::vector<std::mutex> shard_mutexes(concurrency);
+        auto decode_region = [&](const DB::Page & page) {
+            ReadBufferFromMemory buf(page.data.begin(), page.data.size());
+            auto region = Region::deserialize(buf, proxy_helper);
+            if (page.page_id != region->id())
+                throw Exception("region id and page id not match!", ErrorCodes::LOGICAL_ERROR);
+
+            const size_t shard = page.page_id % concurrency;
+            std::lock_guard lock(shard_mutexes[shard]);
+            sharded_regions[shard].emplace(page.page_id, region);
+        };
+
+        std::unordered_set<PageId> restored_page_ids;
+        std::unordered_map<RegionID, DB::Page> delta_pages;
         auto acceptor = [&](const DB::Page & page) {
+            if (page.page_id & DELTA_PAGE_ID_FLAG)
+            {
+                // Same as the full snapshots, the delta pages in V3 come first in MIX MODE.
+                delta_pages.emplace(page.page_id & ~DELTA_PAGE_ID_FLAG, page);
+                return;
+            }
+
             // We will traverse the pages in V3 before traverse the pages in V2 When we used MIX MODE
             // If we found the page_id has been restored, just skip it.
-            if (const auto it = regions.find(page.page_id); it != regions.end())
+            if (!restored_page_ids.insert(page.page_id).second)
             {
                 LOG_FMT_INFO(log, "Already exist [page_id={}], skip it.", page.page_id);
                 return;
             }
 
-            ReadBufferFromMemory buf(page.data.begin(), page.data.size());
-            auto region = Region::deserialize(buf, proxy_helper);
-            if (page.page_id != region->id())
-                throw Exception("region id and page id not match!", ErrorCodes::LOGICAL_ERROR);
-
-            regions.emplace(page.page_id, region);
+            if (pool)
+                pool->schedule([&decode_region, page] { decode_region(page); });
+            else
+                decode_region(page);
         };
         page_reader->traverse(acceptor);
+        if (pool)
+            pool->wait();
+
+        size_t num_regions = 0;
+        for (const auto & shard : sharded_regions)
+            num_regions += shard.size();
+        regions.reserve(num_regions);
+        for (auto & shard : sharded_regions)
+            regions.merge(shard);
+        LOG_FMT_INFO(log, "Decoded {} regions by {} threads, cost {}ms", regions.size(), concurrency, watch.elapsedMillisecondsFromLastTime());
+
+        auto apply_delta = [&](const RegionPtr & region, const DB::Page & page) {
+            ReadBufferFromMemory buf(page.data.begin(), page.data.size());
+            if (!region->applyDelta(buf))
+                LOG_FMT_WARNING(log, "Ignore the delta of {} which is not based on its full snapshot", region->toString(false));
+        };
+        for (const auto & [region_id, page] : delta_pages)
+        {
+            auto it = regions.find(region_id);
+            if (it == regions.end())
+            {
+                LOG_FMT_WARNING(log, "Ignore the delta of [region {}] without full snapshot", region_id);
+                continue;
+            }
+
+            if (pool)
+                pool->schedule([&apply_delta, region = it->second, &page = page] { apply_delta(region, page); });
+            else
+                apply_delta(it->second, page);
+        }
+        if (pool)
+            pool->wait();
+        if (!delta_pages.empty())
+            LOG_FMT_INFO(log, "Applied {} region deltas, cost {}ms", delta_pages.size(), watch.elapsedMillisecondsFromLastTime());
     }
     else
     {
@@ -367,6 +544,7 @@ RegionMap RegionPersister::restore(const TiFlashRaftProxyHelper * proxy_helper,
             regions.emplace(page.page_id, region);
         };
         stable_page_storage->traverse(acceptor, nullptr);
+        LOG_FMT_INFO(log, "Decoded {} regions, cost {}ms", regions.size(), watch.elapsedMillisecondsFromLastTime());
     }
 
     return regions;
@@ -19,8 +19,11 @@
 #include <Storages/Page/FileUsage.h>
 #include <Storages/Page/PageStorage.h>
 #include <Storages/Page/WriteBatch.h>
+#include <Storages/Transaction/RegionDataDelta.h>
 #include <Storages/Transaction/Types.h>
 
+#include <optional>
+
 namespace DB
 {
 class Context;
@@ -54,7 +57,11 @@ public:
     bool gc();
 
     using RegionCacheWriteElement = std::tuple<RegionID, MemoryWriteBuffer, size_t, UInt64>;
-    static void computeRegionWriteBuffer(const Region & region, RegionCacheWriteElement & region_write_buffer);
+    static void computeRegionWriteBuffer(const Region & region, RegionCacheWriteElement & region_write_buffer, RegionDataDelta::Mark * delta_mark = nullptr);
+
+    /// The changes of a region since its last full snapshot are written to this page, see `RegionDataDelta`.
+    static constexpr PageId DELTA_PAGE_ID_FLAG = 1ULL << 63;
+    static PageId getDeltaPageId(RegionID region_id) { return region_id | DELTA_PAGE_ID_FLAG; }
 
     PageStorage::Config getPageStorageSettings() const;
 
@@ -66,8 +73,11 @@ private:
 
     void forceTransformKVStoreV2toV3();
 
-    void doPersist(RegionCacheWriteElement & region_write_buffer, const RegionTaskLock & lock, const Region & region);
+    void doPersist(RegionCacheWriteElement & region_write_buffer, const RegionTaskLock & lock, const Region & region, const RegionDataDelta::Mark * delta_mark = nullptr);
     void doPersist(const Region & region, const RegionTaskLock * lock);
+    bool doPersistDelta(const Region & region);
+    // Return the max tag of the base page and the delta page of region.
+    std::optional<UInt64> getPersistedAppliedIndex(RegionID region_id);
 
 #ifndef DBMS_PUBLIC_GTEST
 private:
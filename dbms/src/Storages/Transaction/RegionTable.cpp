@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <Common/Stopwatch.h>
 #include <Common/setThreadName.h>
 #include <Storages/IManageableStorage.h>
 #include <Storages/StorageDeltaMerge.h>
@@ -167,11 +168,12 @@ void RegionTable::restore()
 {
     LOG_FMT_INFO(log, "Start to restore");
 
+    Stopwatch watch;
     const auto & tmt = context->getTMTContext();
 
     tmt.getKVStore()->traverseRegions([this](const RegionID, const RegionPtr & region) { updateRegion(*region); });
 
-    LOG_FMT_INFO(log, "Restore {} tables", tables.size());
+    LOG_FMT_INFO(log, "Restore {} tables, cost {}ms", tables.size(), watch.elapsedMilliseconds());
 }
 
 void RegionTable::removeTable(TableID table_id)
@@ -51,6 +51,7 @@ struct MockTiDBTable;
 class RegionRangeKeys;
 class RegionTaskLock;
 struct RegionPtrWithBlock;
+struct RegionPreDecodeBlockData;
 struct RegionPtrWithSnapshotFiles;
 class RegionScanFilter;
 using RegionScanFilterPtr = std::shared_ptr<RegionScanFilter>;
@@ -146,6 +147,27 @@ public:
                                    Poco::Logger * log,
                                    bool lock_region = true);
 
+    /// Returns true if the writes of the region into storage would be stalled and its committed data can be kept in
+    /// the region until the next flush, see `raft_write_stall_region_cache_bytes`. The stalled segments are merged
+    /// with priority meanwhile.
+    static bool isWriteThrottled(Context & context, const Region & region);
+
+    /// Remove the committed data from the region and return them, used by the async flush of raft apply.
+    /// The caller must write the returned data into storage by #writeCommittedDataByRegion before advancing the applied index.
+    static std::optional<RegionDataReadInfoList> takeCommittedDataByRegion(const RegionPtr & region, bool lock_region = true);
+    /// `pre_decode_cache` is the block decoded from `data_list_read` by #preDecodeCommittedData if any, it is decoded
+    /// again if the schema of the table has changed since then.
+    static void writeCommittedDataByRegion(Context & context,
+                                           const RegionPtr & region,
+                                           RegionDataReadInfoList & data_list_read,
+                                           Poco::Logger * log,
+                                           std::unique_ptr<RegionPreDecodeBlockData> pre_decode_cache = nullptr);
+    /// Decode the committed data taken by #takeCommittedDataByRegion into a block with the current schema of the table,
+    /// without syncing the schema. Returns nullptr if the data can not be decoded by the current schema.
+    static std::unique_ptr<RegionPreDecodeBlockData> preDecodeCommittedData(Context & context,
+                                                                            const RegionPtr & region,
+                                                                            const RegionDataReadInfoList & data_list_read);
+
     /// Check transaction locks in region, and write committed data in it into storage engine if check passed. Otherwise throw an LockException.
     /// The write logic is the same as #writeBlockByRegion, with some extra checks about region version and conf_version.
     using ResolveLocksAndWriteRegionRes = std::variant<LockInfoPtr, RegionException::RegionReadStatus>;
@@ -35,6 +35,10 @@ void RegionsRangeIndex::add(const RegionPtr & new_region)
 
     for (auto it = begin_it; it != end_it; ++it)
         it->second.region_map.emplace(new_region->id(), new_region);
+
+    std::lock_guard lock(mutex);
+    regions.emplace(new_region->id(), Item{region_range, new_region});
+    std::atomic_store(&version, VersionPtr{});
 }
 
 void RegionsRangeIndex::remove(const RegionRange & range, RegionID region_id)
@@ -58,18 +62,70 @@ void RegionsRangeIndex::remove(const RegionRange & range, RegionID region_id)
             throw Exception(std::string(__PRETTY_FUNCTION__) + ": not found region " + toString(region_id), ErrorCodes::LOGICAL_ERROR);
     }
     tryMergeEmpty(begin_it);
+
+    std::lock_guard lock(mutex);
+    regions.erase(region_id);
+    std::atomic_store(&version, VersionPtr{});
 }
 
-RegionMap RegionsRangeIndex::findByRangeOverlap(const RegionRange & range) const
+RegionsRangeIndex::VersionPtr RegionsRangeIndex::getVersion() const
 {
-    auto begin_it = root.lower_bound(range.first);
-    auto end_it = root.lower_bound(range.second);
-    if (begin_it->first.compare(range.first) != 0)
-        --begin_it;
+    if (auto current = std::atomic_load(&version); current)
+        return current;
+
+    std::lock_guard lock(mutex);
+    // Maybe rebuilt by another thread.
+    if (auto current = std::atomic_load(&version); current)
+        return current;
+
+    auto new_version = std::make_shared<Version>();
+    auto & items = new_version->items;
+    items.reserve(regions.size());
+    for (const auto & [region_id, item] : regions)
+    {
+        (void)region_id;
+        items.push_back(item);
+    }
+    std::sort(items.begin(), items.end(), [](const Item & lhs, const Item & rhs) {
+        return lhs.range->comparableKeys().first.compare(rhs.range->comparableKeys().first) < 0;
+    });
+    auto & max_end_pos = new_version->max_end_pos;
+    max_end_pos.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (i == 0 || items[i].range->comparableKeys().second.compare(items[max_end_pos[i - 1]].range->comparableKeys().second) > 0)
+            max_end_pos[i] = i;
+        else
+            max_end_pos[i] = max_end_pos[i - 1];
+    }
+
+    std::atomic_store(&version, VersionPtr(new_version));
+    return new_version;
+}
 
+RegionMap RegionsRangeIndex::findByRangeOverlap(const RegionRange & range) const
+{
+    auto current = getVersion();
+    const auto & items = current->items;
+    const auto & max_end_pos = current->max_end_pos;
+
+    // The items whose start key is less than the end of `range`.
+    size_t end = std::partition_point(items.begin(), items.end(), [&](const Item & item) {
+                     return item.range->comparableKeys().first.compare(range.second) < 0;
+                 })
+        - items.begin();
+
+    // Scan backward until none of the remaining items ends after the start of `range`. The
+    // ranges of regions seldom overlap, so only the overlapped ones are scanned usually.
     RegionMap res;
-    for (auto it = begin_it; it != end_it; ++it)
-        res.insert(it->second.region_map.begin(), it->second.region_map.end());
+    for (size_t i = end; i > 0; --i)
+    {
+        if (items[max_end_pos[i - 1]].range->comparableKeys().second.compare(range.first) <= 0)
+            break;
+        const auto & item = items[i - 1];
+        if (item.range->comparableKeys().second.compare(range.first) > 0)
+            res.emplace(item.region->id(), item.region);
+    }
     return res;
 }
 
@@ -88,6 +144,10 @@ void RegionsRangeIndex::clear()
     root.clear();
     min_it = root.emplace(TiKVRangeKey::makeTiKVRangeKey<true>(TiKVKey()), IndexNode{}).first;
     max_it = root.emplace(TiKVRangeKey::makeTiKVRangeKey<false>(TiKVKey()), IndexNode{}).first;
+
+    std::lock_guard lock(mutex);
+    regions.clear();
+    std::atomic_store(&version, VersionPtr{});
 }
 
 void RegionsRangeIndex::tryMergeEmpty(RootMap::iterator remove_it)
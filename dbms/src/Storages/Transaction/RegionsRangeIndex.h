@@ -17,6 +17,7 @@
 #include <Storages/Transaction/Types.h>
 
 #include <map>
+#include <mutex>
 
 namespace DB
 {
@@ -27,6 +28,8 @@ using RegionMap = std::unordered_map<RegionID, RegionPtr>;
 
 struct TiKVRangeKey;
 using RegionRange = std::pair<TiKVRangeKey, TiKVRangeKey>;
+class RegionRangeKeys;
+using ImutRegionRangePtr = std::shared_ptr<const RegionRangeKeys>;
 
 struct TiKVRangeKeyCmp
 {
@@ -38,6 +41,10 @@ struct IndexNode
     RegionMap region_map;
 };
 
+/// The split points in `root` are maintained by `add` and `remove`, which are called under the write lock of
+/// RegionManager. `findByRangeOverlap` searches an immutable sorted array of the region ranges instead, which is
+/// rebuilt by the first lookup after the regions are changed, so that the lookups are lock-free in most cases and
+/// can be called without the lock of RegionManager.
 class RegionsRangeIndex : private boost::noncopyable
 {
 public:
@@ -47,6 +54,7 @@ public:
 
     void remove(const RegionRange & range, RegionID region_id);
 
+    /// Thread safe.
     RegionMap findByRangeOverlap(const RegionRange & range) const;
 
     RegionsRangeIndex();
@@ -56,13 +64,37 @@ public:
     void clear();
 
 private:
+    struct Item
+    {
+        ImutRegionRangePtr range;
+        RegionPtr region;
+    };
+
+    struct Version
+    {
+        /// Sorted by the start keys.
+        std::vector<Item> items;
+        /// `max_end_pos[i]` is the position of the item with the max end key among `items[0..i]`.
+        std::vector<size_t> max_end_pos;
+    };
+    using VersionPtr = std::shared_ptr<const Version>;
+
     void tryMergeEmpty(RootMap::iterator remove_it);
     RootMap::iterator split(const TiKVRangeKey & new_start);
 
+    VersionPtr getVersion() const;
+
 private:
     RootMap root;
     RootMap::const_iterator min_it;
     RootMap::const_iterator max_it;
+
+    /// Protect `regions`, and the rebuild of `version`.
+    mutable std::mutex mutex;
+    /// The ranges of the regions when they are added.
+    std::unordered_map<RegionID, Item> regions;
+    /// Reset to nullptr once `regions` is changed, accessed by `std::atomic_load` and `std::atomic_store`.
+    mutable VersionPtr version;
 };
 
 } // namespace DB
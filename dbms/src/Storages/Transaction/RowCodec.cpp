@@ -19,6 +19,7 @@
 #include <Storages/Transaction/DatumCodec.h>
 #include <Storages/Transaction/RowCodec.h>
 
+#include <algorithm>
 
 namespace DB
 {
@@ -293,14 +294,20 @@ bool appendRowToBlock(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode)
+    bool force_decode,
+    RowDecodeBuffer * decode_buffer,
+    bool skip_extra_columns)
 {
+    std::optional<RowDecodeBuffer> local_buffer;
+    if (decode_buffer == nullptr)
+        decode_buffer = &local_buffer.emplace();
+
     switch (static_cast<UInt8>(raw_value[0]))
     {
     case static_cast<UInt8>(RowCodecVer::ROW_V2):
-        return appendRowV2ToBlock(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode);
+        return appendRowV2ToBlock(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode, *decode_buffer, skip_extra_columns);
     default:
-        return appendRowV1ToBlock(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode);
+        return appendRowV1ToBlock(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode, *decode_buffer, skip_extra_columns);
     }
 }
 
@@ -312,15 +319,23 @@ bool appendRowV2ToBlock(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode)
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer,
+    bool skip_extra_columns)
 {
     auto row_flag = readLittleEndian<UInt8>(&raw_value[1]);
     bool is_big = row_flag & RowV2::BigRowMask;
-    return is_big ? appendRowV2ToBlockImpl<true>(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode)
-                  : appendRowV2ToBlockImpl<false>(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode);
+    return is_big ? appendRowV2ToBlockImpl<true>(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode, decode_buffer, skip_extra_columns)
+                  : appendRowV2ToBlockImpl<false>(raw_value, column_ids_iter, column_ids_iter_end, block, block_column_pos, column_infos, pk_handle_id, force_decode, decode_buffer, skip_extra_columns);
 }
 
-inline bool addDefaultValueToColumnIfPossible(const ColumnInfo & column_info, Block & block, size_t block_column_pos, bool force_decode)
+inline bool addDefaultValueToColumnIfPossible(
+    const ColumnInfo & column_info,
+    size_t column_info_pos,
+    Block & block,
+    size_t block_column_pos,
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer)
 {
     // We consider a missing column could be safely filled with NULL, unless it has not default value and is NOT NULL.
     // This could saves lots of unnecessary schema syncs for old data with a schema that has newly added columns.
@@ -334,8 +349,8 @@ inline bool addDefaultValueToColumnIfPossible(const ColumnInfo & column_info, Bl
             return false;
     }
     // not null or has no default value, tidb will fill with specific value.
-    auto * raw_column = const_cast<IColumn *>((block.getByPosition(block_column_pos)).column.get());
-    raw_column->insert(column_info.defaultValueToField());
+    auto * raw_column = decode_buffer.getColumn(block, block_column_pos);
+    raw_column->insert(decode_buffer.getDefaultValue(column_info, column_info_pos));
     return true;
 }
 
@@ -348,14 +363,20 @@ bool appendRowV2ToBlockImpl(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode)
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer,
+    bool skip_extra_columns)
 {
     size_t cursor = 2; // Skip the initial codec ver and row flag.
     size_t num_not_null_columns = decodeUInt<UInt16>(cursor, raw_value);
     size_t num_null_columns = decodeUInt<UInt16>(cursor, raw_value);
-    std::vector<ColumnID> not_null_column_ids;
-    std::vector<ColumnID> null_column_ids;
-    std::vector<size_t> value_offsets;
+    // Reuse the memory of the previous rows
+    auto & not_null_column_ids = decode_buffer.not_null_column_ids;
+    auto & null_column_ids = decode_buffer.null_column_ids;
+    auto & value_offsets = decode_buffer.value_offsets;
+    not_null_column_ids.clear();
+    null_column_ids.clear();
+    value_offsets.clear();
     decodeUInts<ColumnID, typename RowV2::Types<is_big>::ColumnIDType>(cursor, raw_value, num_not_null_columns, not_null_column_ids);
     decodeUInts<ColumnID, typename RowV2::Types<is_big>::ColumnIDType>(cursor, raw_value, num_null_columns, null_column_ids);
     decodeUInts<size_t, typename RowV2::Types<is_big>::ValueOffsetType>(cursor, raw_value, num_not_null_columns, value_offsets);
@@ -368,7 +389,7 @@ bool appendRowV2ToBlockImpl(
         if (column_ids_iter == column_ids_iter_end)
         {
             // extra column
-            return force_decode;
+            return force_decode || skip_extra_columns;
         }
 
         bool is_null;
@@ -383,6 +404,16 @@ bool appendRowV2ToBlockImpl(
             // The next column id to read is bigger than the column id of next datum in encoded row.
             // It means this is the datum of extra column. May happen when reading after dropping
             // a column.
+            if (skip_extra_columns)
+            {
+                // The row is read with a projection, jump over all the datums before the next column to read.
+                // The column ids in row-format v2 are sorted and the values are located by offsets, so the
+                // skipped datums are never decoded.
+                const ColumnID next_column_id = column_ids_iter->first;
+                idx_not_null = std::lower_bound(not_null_column_ids.begin() + idx_not_null, not_null_column_ids.end(), next_column_id) - not_null_column_ids.begin();
+                idx_null = std::lower_bound(null_column_ids.begin() + idx_null, null_column_ids.end(), next_column_id) - null_column_ids.begin();
+                continue;
+            }
             if (!force_decode)
                 return false;
             // Ignore the extra column and continue to parse other datum
@@ -398,7 +429,7 @@ bool appendRowV2ToBlockImpl(
             // a column.
             // Fill with default value and continue to read data for next column id.
             const auto & column_info = column_infos[column_ids_iter->second];
-            if (!addDefaultValueToColumnIfPossible(column_info, block, block_column_pos, force_decode))
+            if (!addDefaultValueToColumnIfPossible(column_info, column_ids_iter->second, block, block_column_pos, force_decode, decode_buffer))
                 return false;
             column_ids_iter++;
             block_column_pos++;
@@ -423,7 +454,7 @@ bool appendRowV2ToBlockImpl(
             }
 
             // Parse the datum.
-            auto * raw_column = const_cast<IColumn *>((block.getByPosition(block_column_pos)).column.get());
+            auto * raw_column = decode_buffer.getColumn(block, block_column_pos);
             const auto & column_info = column_infos[column_ids_iter->second];
             if (is_null)
             {
@@ -460,7 +491,7 @@ bool appendRowV2ToBlockImpl(
         if (column_ids_iter->first != pk_handle_id)
         {
             const auto & column_info = column_infos[column_ids_iter->second];
-            if (!addDefaultValueToColumnIfPossible(column_info, block, block_column_pos, force_decode))
+            if (!addDefaultValueToColumnIfPossible(column_info, column_ids_iter->second, block, block_column_pos, force_decode, decode_buffer))
                 return false;
         }
         column_ids_iter++;
@@ -478,7 +509,9 @@ bool appendRowV1ToBlock(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode)
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer,
+    bool skip_extra_columns)
 {
     size_t cursor = 0;
     std::map<ColumnID, Field> decoded_fields;
@@ -488,6 +521,12 @@ bool appendRowV1ToBlock(
         if (f.isNull())
             break;
         ColumnID col_id = f.get<ColumnID>();
+        if (skip_extra_columns && std::none_of(column_ids_iter, column_ids_iter_end, [col_id](const auto & id_with_pos) { return id_with_pos.first == col_id; }))
+        {
+            // The column is not in the projection, skip its datum without decoding
+            SkipDatum(cursor, raw_value);
+            continue;
+        }
         decoded_fields.emplace(col_id, DecodeDatum(cursor, raw_value));
     }
     if (cursor != raw_value.size())
@@ -514,7 +553,7 @@ bool appendRowV1ToBlock(
         else if (column_ids_iter->first < next_field_column_id)
         {
             const auto & column_info = column_infos[column_ids_iter->second];
-            if (!addDefaultValueToColumnIfPossible(column_info, block, block_column_pos, force_decode))
+            if (!addDefaultValueToColumnIfPossible(column_info, column_ids_iter->second, block, block_column_pos, force_decode, decode_buffer))
                 return false;
             column_ids_iter++;
             block_column_pos++;
@@ -531,7 +570,7 @@ bool appendRowV1ToBlock(
                 continue;
             }
 
-            auto * raw_column = const_cast<IColumn *>((block.getByPosition(block_column_pos)).column.get());
+            auto * raw_column = decode_buffer.getColumn(block, block_column_pos);
             const auto & column_info = column_infos[column_ids_iter->second];
             DatumFlat datum(decoded_field_iter->second, column_info.tp);
             const Field & unflattened = datum.field();
@@ -574,7 +613,7 @@ bool appendRowV1ToBlock(
         if (column_ids_iter->first != pk_handle_id)
         {
             const auto & column_info = column_infos[column_ids_iter->second];
-            if (!addDefaultValueToColumnIfPossible(column_info, block, block_column_pos, force_decode))
+            if (!addDefaultValueToColumnIfPossible(column_info, column_ids_iter->second, block, block_column_pos, force_decode, decode_buffer))
                 return false;
         }
         column_ids_iter++;
@@ -18,6 +18,8 @@
 #include <Storages/Transaction/DecodingStorageSchemaSnapshot.h>
 #include <Storages/Transaction/TiKVKeyValue.h>
 
+#include <optional>
+
 namespace DB
 {
 using TiDB::ColumnInfo;
@@ -27,6 +29,44 @@ using TiDB::TableInfo;
 void encodeRowV1(const TiDB::TableInfo & table_info, const std::vector<Field> & fields, WriteBuffer & ss);
 void encodeRowV2(const TiDB::TableInfo & table_info, const std::vector<Field> & fields, WriteBuffer & ss);
 
+/// The states reused by `appendRowToBlock` between the rows appended to the same block,
+/// so that decoding a batch of rows does not allocate or look up the schema for every row.
+struct RowDecodeBuffer
+{
+    // The raw columns of the block, indexed by the position in block
+    std::vector<IColumn *> raw_columns;
+    // The default values of the missing columns, indexed by the position in `ColumnInfos`
+    std::vector<std::optional<Field>> default_values;
+
+    // The layout of current row in row-format v2
+    std::vector<ColumnID> not_null_column_ids;
+    std::vector<ColumnID> null_column_ids;
+    std::vector<size_t> value_offsets;
+
+    IColumn * getColumn(Block & block, size_t block_column_pos)
+    {
+        if (unlikely(raw_columns.size() != block.columns()))
+            raw_columns.assign(block.columns(), nullptr);
+        auto & raw_column = raw_columns[block_column_pos];
+        if (raw_column == nullptr)
+            raw_column = const_cast<IColumn *>(block.getByPosition(block_column_pos).column.get());
+        return raw_column;
+    }
+
+    const Field & getDefaultValue(const ColumnInfo & column_info, size_t column_info_pos)
+    {
+        if (unlikely(default_values.size() <= column_info_pos))
+            default_values.resize(column_info_pos + 1);
+        auto & value = default_values[column_info_pos];
+        if (!value)
+            value = column_info.defaultValueToField();
+        return *value;
+    }
+};
+
+/// `decode_buffer` should be reused when appending many rows to the same block, it is only valid for one block.
+/// If `skip_extra_columns` is true, `column_ids_iter` ~ `column_ids_iter_end` is a projection of the row and the datums
+/// of other columns are skipped without being decoded, instead of being treated as a schema mismatch.
 bool appendRowToBlock(
     const TiKVValue::Base & raw_value,
     SortedColumnIDWithPosConstIter column_ids_iter,
@@ -35,7 +75,9 @@ bool appendRowToBlock(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id, // when pk is handle, we need skip pk column when decoding value
-    bool force_decode);
+    bool force_decode,
+    RowDecodeBuffer * decode_buffer = nullptr,
+    bool skip_extra_columns = false);
 
 bool appendRowV2ToBlock(
     const TiKVValue::Base & raw_value,
@@ -45,7 +87,9 @@ bool appendRowV2ToBlock(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode);
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer,
+    bool skip_extra_columns);
 
 template <bool is_big>
 bool appendRowV2ToBlockImpl(
@@ -56,7 +100,9 @@ bool appendRowV2ToBlockImpl(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode);
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer,
+    bool skip_extra_columns);
 
 bool appendRowV1ToBlock(
     const TiKVValue::Base & raw_value,
@@ -66,6 +112,8 @@ bool appendRowV1ToBlock(
     size_t block_column_pos,
     const ColumnInfos & column_infos,
     ColumnID pk_handle_id,
-    bool force_decode);
+    bool force_decode,
+    RowDecodeBuffer & decode_buffer,
+    bool skip_extra_columns);
 
 } // namespace DB
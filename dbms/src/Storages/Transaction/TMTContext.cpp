@@ -53,7 +53,8 @@ TMTContext::TMTContext(Context & context_, const TiFlashRaftConfig & raft_config
     , mpp_task_manager(std::make_shared<MPPTaskManager>(
           std::make_unique<MinTSOScheduler>(
               context.getSettingsRef().task_scheduler_thread_soft_limit,
-              context.getSettingsRef().task_scheduler_thread_hard_limit)))
+              context.getSettingsRef().task_scheduler_thread_hard_limit,
+              context.getSettingsRef().task_scheduler_memory_limit)))
     , engine(raft_config.engine)
     , replica_read_max_thread(1)
     , batch_read_index_timeout_ms(DEFAULT_BATCH_READ_INDEX_TIMEOUT_MS)
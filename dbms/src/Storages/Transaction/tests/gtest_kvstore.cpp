@@ -310,6 +310,35 @@ void RegionKVStoreTest::testReadIndex()
                 region->handleWriteRaftCmd({}, 667 + 1, 6, ctx.getTMTContext());
             }
         }
+        {
+            // test wait index of a batch of regions
+            auto region1 = kvs.getRegion(1);
+            auto region2 = kvs.getRegion(2);
+            auto batch = std::make_shared<WaitIndexBatch>();
+            ASSERT_FALSE(region2->addIndexWaiter(667 + 1, batch));
+            ASSERT_TRUE(region1->addIndexWaiter(667 + 2, batch));
+            ASSERT_TRUE(region2->addIndexWaiter(667 + 2, batch));
+            ASSERT_EQ(batch->pendingCount(), 2);
+            ASSERT_EQ(batch->wait(2, []() { return true; }), WaitIndexResult::Timeout);
+            ASSERT_EQ(batch->wait(0, []() { return false; }), WaitIndexResult::Terminated);
+
+            region2->handleWriteRaftCmd({}, 667 + 2, 6, ctx.getTMTContext());
+            ASSERT_EQ(batch->pendingCount(), 1);
+            {
+                AsyncWaker::Notifier notifier;
+                std::thread t([&]() {
+                    notifier.wake();
+                    ASSERT_EQ(batch->wait(100000, []() { return true; }), WaitIndexResult::Finished);
+                });
+                SCOPE_EXIT({
+                    t.join();
+                });
+                ASSERT_EQ(notifier.blockedWaitFor(std::chrono::milliseconds(1000 * 3600)), AsyncNotifier::Status::Normal);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                region1->handleWriteRaftCmd({}, 667 + 2, 6, ctx.getTMTContext());
+            }
+            ASSERT_EQ(batch->pendingCount(), 0);
+        }
     }
     kvs.stopReadIndexWorkers();
     kvs.releaseReadIndexWorkers();
@@ -1011,6 +1040,20 @@ void RegionKVStoreTest::testKVStore()
         ASSERT_EQ(
             kvs.handleWriteRaftCmd(raft_cmdpb::RaftCmdRequest{}, 8192, 7, 6, ctx.getTMTContext()),
             EngineStoreApplyRes::NotFound);
+
+        {
+            // The write commands of many regions in one batch
+            std::vector<WriteCmdsView> cmds(3, WriteCmdsView{});
+            std::vector<RaftCmdHeader> headers{
+                {.region_id = 1, .index = 8, .term = 6},
+                {.region_id = 8192, .index = 8, .term = 6},
+                {.region_id = 1, .index = 9, .term = 6}};
+            std::vector<EngineStoreApplyRes> results(3, EngineStoreApplyRes::NotFound);
+            kvs.handleBatchWriteRaftCmd(cmds.data(), headers.data(), headers.size(), results.data(), ctx.getTMTContext());
+            ASSERT_EQ(results[0], EngineStoreApplyRes::None);
+            ASSERT_EQ(results[1], EngineStoreApplyRes::NotFound);
+            ASSERT_EQ(results[2], EngineStoreApplyRes::None);
+        }
     }
     {
         kvs.handleDestroy(2, ctx.getTMTContext());
@@ -1343,6 +1386,32 @@ void RegionKVStoreTest::testBasic()
         ASSERT_EQ(root_map.size(), 2);
     }
 
+    {
+        // Adjacent regions [0, 10), [10, 20), ..., [990, +inf)
+        RegionsRangeIndex region_index;
+        for (UInt64 i = 0; i < 100; ++i)
+            region_index.add(makeRegion(i, RecordKVFormat::genKey(1, i * 10), i == 99 ? TiKVKey() : RecordKVFormat::genKey(1, i * 10 + 10)));
+
+        auto res = region_index.findByRangeOverlap(RegionRangeKeys::makeComparableKeys(TiKVKey(""), TiKVKey("")));
+        ASSERT_EQ(res.size(), 100);
+        res = region_index.findByRangeOverlap(RegionRangeKeys::makeComparableKeys(RecordKVFormat::genKey(1, 15), RecordKVFormat::genKey(1, 30)));
+        ASSERT_EQ(res.size(), 2);
+        ASSERT_TRUE(res.count(1) && res.count(2));
+        res = region_index.findByRangeOverlap(RegionRangeKeys::makeComparableKeys(RecordKVFormat::genKey(1, 2000), TiKVKey("")));
+        ASSERT_EQ(res.size(), 1);
+        ASSERT_TRUE(res.count(99));
+
+        // The lookups see the changes of regions
+        region_index.remove(RegionRangeKeys::makeComparableKeys(RecordKVFormat::genKey(1, 10), RecordKVFormat::genKey(1, 20)), 1);
+        region_index.add(makeRegion(100, RecordKVFormat::genKey(1, 0), RecordKVFormat::genKey(1, 25)));
+        res = region_index.findByRangeOverlap(RegionRangeKeys::makeComparableKeys(RecordKVFormat::genKey(1, 15), RecordKVFormat::genKey(1, 30)));
+        ASSERT_EQ(res.size(), 2);
+        ASSERT_TRUE(res.count(100) && res.count(2));
+        res = region_index.findByRangeOverlap(RegionRangeKeys::makeComparableKeys(RecordKVFormat::genKey(1, 5), RecordKVFormat::genKey(1, 6)));
+        ASSERT_EQ(res.size(), 2);
+        ASSERT_TRUE(res.count(0) && res.count(100));
+    }
+
     {
         RegionsRangeIndex region_index;
         const auto & root_map = region_index.getRoot();
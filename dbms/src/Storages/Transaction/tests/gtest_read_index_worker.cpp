@@ -42,6 +42,7 @@ public:
     static void testBatch();
     static void testNormal();
     static void testError();
+    static void testCoalesce();
 };
 
 void ReadIndexTest::testError()
@@ -649,6 +650,75 @@ void ReadIndexTest::testBatch()
     ASSERT(!GCMonitor::instance().empty());
 }
 
+void ReadIndexTest::testCoalesce()
+{
+    // test requests of the same region share the running tasks and history record
+    MockRaftStoreProxy proxy_instance;
+    TiFlashRaftProxyHelper proxy_helper;
+    {
+        proxy_helper = MockRaftStoreProxy::SetRaftStoreProxyFFIHelper(RaftStoreProxyPtr{&proxy_instance});
+        proxy_instance.init(10);
+    }
+    auto manager = ReadIndexWorkerManager::newReadIndexWorkerManager(
+        proxy_helper,
+        5,
+        [&]() {
+            return std::chrono::milliseconds(10);
+        });
+    // DO NOT run manager and mock proxy in other threads.
+    {
+        proxy_instance.regions[0]->updateCommitIndex(700);
+        auto node = manager->getWorkerByRegion(0).data_map.getDataNode(0);
+
+        std::list<ReadIndexFuturePtr> futures;
+        futures.push_back(manager->genReadIndexFuture(make_read_index_reqs(0, 10)));
+        manager->runOneRoundAll();
+        ASSERT_EQ(1, node->running_tasks.size());
+        ASSERT_EQ(1, proxy_instance.tasks.size());
+
+        // ts 5 joins the running task of ts 10, only ts 20 makes a new task
+        futures.push_back(manager->genReadIndexFuture(make_read_index_reqs(0, 5)));
+        futures.push_back(manager->genReadIndexFuture(make_read_index_reqs(0, 20)));
+        manager->runOneRoundAll();
+        ASSERT_EQ(2, node->running_tasks.size());
+        ASSERT_EQ(2, proxy_instance.tasks.size());
+        ASSERT_EQ(2, node->running_tasks.at(10).callbacks.size());
+        ASSERT_EQ(1, node->running_tasks.at(20).callbacks.size());
+
+        proxy_instance.runOneRound();
+        manager->runOneRoundAll();
+        ASSERT_EQ(0, node->running_tasks.size());
+        for (auto & future : futures)
+        {
+            auto resp = future->poll();
+            ASSERT(resp);
+            ASSERT_EQ(resp->read_index(), 700);
+        }
+
+        // ts 15 uses the history record of ts 20, ts 30 makes a new task
+        proxy_instance.regions[0]->updateCommitIndex(701);
+        futures.clear();
+        futures.push_back(manager->genReadIndexFuture(make_read_index_reqs(0, 15)));
+        futures.push_back(manager->genReadIndexFuture(make_read_index_reqs(0, 30)));
+        auto ori_cnt_use_history_tasks = node->cnt_use_history_tasks;
+        manager->runOneRoundAll();
+        ASSERT_EQ(ori_cnt_use_history_tasks + 1, node->cnt_use_history_tasks);
+        ASSERT_EQ(1, node->running_tasks.size());
+        ASSERT_EQ(1, node->running_tasks.at(30).callbacks.size());
+        {
+            auto resp = futures.front()->poll();
+            ASSERT(resp);
+            ASSERT_EQ(resp->read_index(), 700);
+        }
+        proxy_instance.runOneRound();
+        manager->runOneRoundAll();
+        {
+            auto resp = futures.back()->poll();
+            ASSERT(resp);
+            ASSERT_EQ(resp->read_index(), 701);
+        }
+    }
+}
 
 TEST_F(ReadIndexTest, workers)
 try
@@ -657,6 +727,7 @@ try
     testNormal();
     testBatch();
     testError();
+    testCoalesce();
 }
 CATCH
 
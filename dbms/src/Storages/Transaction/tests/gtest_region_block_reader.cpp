@@ -210,6 +210,20 @@ protected:
         return table_info;
     }
 
+    // Only keep the extra handle, version, delmark columns and the columns in `column_ids`
+    static DecodingStorageSchemaSnapshotConstPtr getProjectedDecodingSchema(const TableInfo & table_info, const ColumnIDs & column_ids)
+    {
+        auto full_schema = getDecodingStorageSchemaSnapshot(table_info);
+        auto projected_columns = std::make_shared<ColumnDefines>();
+        for (const auto & cd : *full_schema->column_defines)
+        {
+            if (cd.id == EXTRA_HANDLE_COLUMN_ID || cd.id == VERSION_COLUMN_ID || cd.id == TAG_COLUMN_ID
+                || std::find(column_ids.begin(), column_ids.end(), cd.id) != column_ids.end())
+                projected_columns->emplace_back(cd);
+        }
+        return std::make_shared<DecodingStorageSchemaSnapshot>(projected_columns, table_info, (*projected_columns)[0], /* decoding_schema_version_ */ 1, /* is_projection_ */ true);
+    }
+
     TableInfo getTableInfoWithMoreNarrowIntType(const ColumnIDs & handle_ids, bool is_common_handle) const
     {
         TableInfo table_info;
@@ -283,6 +297,20 @@ TEST_F(RegionBlockReaderTestFixture, MissingColumnRowV1)
     ASSERT_TRUE(decodeAndCheckColumns(new_decoding_schema, false));
 }
 
+TEST_F(RegionBlockReaderTestFixture, MissingColumnMixedRowFormat)
+{
+    // The decoding states are reused between the rows of different row formats in the same block
+    auto [table_info, fields] = getNormalTableInfoFields({EXTRA_HANDLE_COLUMN_ID}, false);
+    rows = 2;
+    encodeColumns(table_info, fields, RowEncodeVersion::RowV1);
+    encodeColumns(table_info, fields, RowEncodeVersion::RowV2);
+    encodeColumns(table_info, fields, RowEncodeVersion::RowV1);
+    rows = 6;
+    auto new_table_info = getTableInfoWithMoreColumns({EXTRA_HANDLE_COLUMN_ID}, false);
+    auto new_decoding_schema = getDecodingStorageSchemaSnapshot(new_table_info);
+    ASSERT_TRUE(decodeAndCheckColumns(new_decoding_schema, false));
+}
+
 TEST_F(RegionBlockReaderTestFixture, ExtraColumnRowV2)
 {
     auto [table_info, fields] = getNormalTableInfoFields({EXTRA_HANDLE_COLUMN_ID}, false);
@@ -303,6 +331,25 @@ TEST_F(RegionBlockReaderTestFixture, ExtraColumnRowV1)
     ASSERT_TRUE(decodeAndCheckColumns(new_decoding_schema, true));
 }
 
+TEST_F(RegionBlockReaderTestFixture, ProjectionRowV2)
+{
+    auto [table_info, fields] = getNormalTableInfoFields({EXTRA_HANDLE_COLUMN_ID}, false);
+    encodeColumns(table_info, fields, RowEncodeVersion::RowV2);
+    // The columns not in the projection are skipped even if `force_decode` is false
+    ASSERT_TRUE(decodeAndCheckColumns(getProjectedDecodingSchema(table_info, {9}), false));
+    ASSERT_TRUE(decodeAndCheckColumns(getProjectedDecodingSchema(table_info, {3, 11}), false));
+    ASSERT_TRUE(decodeAndCheckColumns(getProjectedDecodingSchema(table_info, {}), false));
+}
+
+TEST_F(RegionBlockReaderTestFixture, ProjectionRowV1)
+{
+    auto [table_info, fields] = getNormalTableInfoFields({EXTRA_HANDLE_COLUMN_ID}, false);
+    encodeColumns(table_info, fields, RowEncodeVersion::RowV1);
+    ASSERT_TRUE(decodeAndCheckColumns(getProjectedDecodingSchema(table_info, {9}), false));
+    ASSERT_TRUE(decodeAndCheckColumns(getProjectedDecodingSchema(table_info, {3, 11}), false));
+    ASSERT_TRUE(decodeAndCheckColumns(getProjectedDecodingSchema(table_info, {}), false));
+}
+
 TEST_F(RegionBlockReaderTestFixture, OverflowColumnRowV2)
 {
     auto [table_info, fields] = getNormalTableInfoFields({EXTRA_HANDLE_COLUMN_ID}, false);
@@ -288,6 +288,84 @@ try
 }
 CATCH
 
+TEST_F(RegionPersister_test, persister_delta)
+try
+{
+    RegionManager region_manager;
+
+    std::string path = dir_path + "/delta";
+    DB::Settings settings;
+    settings.region_persister_enable_delta = true;
+    auto ctx = TiFlashTestEnv::getContext(settings,
+                                          Strings{
+                                              path,
+                                          });
+
+    TableID table_id = 100;
+    RegionID region_id = 1;
+    auto region = std::make_shared<Region>(createRegionMeta(region_id, table_id));
+    auto insert_row = [&](HandleID handle) {
+        region->insert("default", RecordKVFormat::genKey(table_id, handle, 1), TiKVValue(String(100, 'a')));
+        region->insert("write", RecordKVFormat::genKey(table_id, handle, 2), RecordKVFormat::encodeWriteCfValue('P', 1));
+        region->insert("lock", RecordKVFormat::genKey(table_id, handle), RecordKVFormat::encodeLockCfValue('P', "", 1, 0));
+    };
+    for (HandleID handle = 0; handle < 100; ++handle)
+        insert_row(handle);
+
+    PageStorage::Config config;
+    {
+        RegionPersister persister(ctx, region_manager);
+        persister.restore(nullptr, config);
+        const auto delta_page_id = RegionPersister::getDeltaPageId(region_id);
+
+        // The first persist writes the full snapshot
+        persister.persist(*region);
+        ASSERT_TRUE(persister.page_reader->getPageEntry(region_id).isValid());
+        ASSERT_FALSE(persister.page_reader->getPageEntry(delta_page_id).isValid());
+
+        // Small changes are written as delta
+        insert_row(100);
+        region->remove("lock", RecordKVFormat::genKey(table_id, 0));
+        {
+            auto remover = region->createCommittedRemover();
+            TiKVKey write_key = RecordKVFormat::genKey(table_id, 1, 2);
+            remover.remove({RecordKVFormat::getRawTiDBPK(RecordKVFormat::decodeTiKVKey(write_key)), RecordKVFormat::getTs(write_key)});
+        }
+        persister.persist(*region);
+        ASSERT_TRUE(persister.page_reader->getPageEntry(delta_page_id).isValid());
+    }
+
+    {
+        RegionPersister persister(ctx, region_manager);
+        auto new_regions = persister.restore(nullptr, config);
+        ASSERT_EQ(new_regions.size(), 1UL);
+        ASSERT_REGION_EQ(*new_regions[region_id], *region);
+        ASSERT_EQ(new_regions[region_id]->writeCFCount(), 100UL);
+
+        // The region restored from the delta writes a full snapshot again, and the delta page is removed
+        persister.persist(*new_regions[region_id]);
+        ASSERT_FALSE(persister.page_reader->getPageEntry(RegionPersister::getDeltaPageId(region_id)).isValid());
+
+        // Changes larger than half of the region data squash the delta into a new full snapshot
+        region = new_regions[region_id];
+        insert_row(101);
+        persister.persist(*region);
+        ASSERT_TRUE(persister.page_reader->getPageEntry(RegionPersister::getDeltaPageId(region_id)).isValid());
+        for (HandleID handle = 102; handle < 300; ++handle)
+            insert_row(handle);
+        persister.persist(*region);
+        ASSERT_FALSE(persister.page_reader->getPageEntry(RegionPersister::getDeltaPageId(region_id)).isValid());
+    }
+
+    {
+        RegionPersister persister(ctx, region_manager);
+        auto new_regions = persister.restore(nullptr, config);
+        ASSERT_EQ(new_regions.size(), 1UL);
+        ASSERT_REGION_EQ(*new_regions[region_id], *region);
+    }
+}
+CATCH
+
 TEST_F(RegionPersister_test, persister_compatible_mode)
 try
 {
@@ -58,6 +58,14 @@ const typename CollatorCases::CompareCase CollatorCases::cmp_cases[] = {
     {"𐐭", "𐐨", {1, 1, 0, 1, 0}},
     // Issue https://github.com/pingcap/tics/issues/1660
     {"謺", "譂", {-1, -1, -1, -1, -1}},
+    // Longer than 16 bytes, to check the vectorized prefix and ascii checks.
+    {"abcdefghijklmnopqrsÀ", "abcdefghijklmnopqrsA", {1, 1, 0, 1, 0}},
+    {"0123456789abcdefÀ", "0123456789abcdefÁ", {-1, -1, 0, -1, 0}},
+    {"The Quick Brown Fox Jumps", "the quick brown fox jumps  ", {-1, -1, 0, -1, 0}},
+    {"abc\x01"
+     "d",
+     "abcd",
+     {-1, -1, -1, -1, 0}},
 };
 #define PREVENT_TRUNC(s) \
     {                    \
@@ -176,6 +184,28 @@ struct UnicodeCICollator
     static constexpr auto collation_case = CollatorCases::UnicodeCI;
 };
 
+TEST(CollatorSuite, CollatorUtils)
+{
+    const std::string ascii = "0123456789abcdefghijklmnopqrstuvwxyz";
+    for (size_t length = 0; length <= ascii.length(); ++length)
+        ASSERT_TRUE(IsASCIIStr(ascii.data(), length));
+    for (size_t pos = 0; pos < ascii.length(); ++pos)
+    {
+        std::string s = ascii;
+        s[pos] = '\x80';
+        ASSERT_FALSE(IsASCIIStr(s.data(), s.length()));
+        ASSERT_TRUE(IsASCIIStr(s.data(), pos));
+    }
+
+    const std::string s1 = "0123456789abcdef0123À";
+    const std::string s2 = "0123456789abcdef0123Á";
+    // Stop before the first byte of `À`.
+    ASSERT_EQ(CommonPrefixLengthUTF8(s1.data(), s1.length(), s2.data(), s2.length()), 20);
+    ASSERT_EQ(CommonPrefixLengthUTF8(s1.data(), s1.length(), s1.data(), 20), 20);
+    ASSERT_EQ(CommonPrefixLengthUTF8(s1.data(), s1.length(), s1.data(), s1.length()), s1.length());
+    ASSERT_EQ(CommonPrefixLengthUTF8(s1.data(), s1.length(), ascii.data(), ascii.length()), 16);
+}
+
 TEST(CollatorSuite, BinCollator)
 {
     testCollator<BinCollator>();
@@ -481,6 +481,92 @@ TEST(TiKVKeyValueTest, PortedTests)
     ASSERT_TRUE(res);
 }
 
+TEST(TiKVKeyValueTest, InsertWithHint)
+{
+    RegionData expected, data;
+    auto insert = [](RegionData & d, HandleID handle, RegionData::InsertHint * hint) {
+        auto default_key = RecordKVFormat::genKey(1, handle, 1);
+        auto default_value = TiKVValue("value" + std::to_string(handle));
+        auto write_key = RecordKVFormat::genKey(1, handle, 2);
+        auto write_value = RecordKVFormat::encodeWriteCfValue(Region::PutFlag, 1);
+        if (hint)
+        {
+            d.insert(ColumnFamilyType::Default, std::move(default_key), std::move(default_value), *hint);
+            d.insert(ColumnFamilyType::Write, std::move(write_key), std::move(write_value), *hint);
+        }
+        else
+        {
+            d.insert(ColumnFamilyType::Default, std::move(default_key), std::move(default_value));
+            d.insert(ColumnFamilyType::Write, std::move(write_key), std::move(write_value));
+        }
+    };
+
+    // ascending keys, keys around the existing ones and descending keys
+    std::vector<HandleID> handles{10, 20, 30};
+    for (HandleID handle = 0; handle < 50; ++handle)
+    {
+        if (handle % 10 != 0)
+            handles.push_back(handle);
+    }
+    for (HandleID handle = 99; handle >= 50; --handle)
+        handles.push_back(handle);
+
+    auto hint = data.initInsertHint();
+    for (auto handle : handles)
+    {
+        insert(expected, handle, nullptr);
+        insert(data, handle, &hint);
+    }
+    ASSERT_EQ(data.writeCF().getSize(), 100UL);
+    ASSERT_EQ(data.dataSize(), expected.dataSize());
+    ASSERT_TRUE(data == expected);
+
+    // the existing key is still rejected
+    hint = data.initInsertHint();
+    ASSERT_ANY_THROW(insert(data, 10, &hint));
+
+    // read the values of the committed records with a cursor on default cf
+    auto default_cursor = data.defaultCF().getData().begin();
+    HandleID handle = 0;
+    for (auto it = data.writeCF().getData().begin(); it != data.writeCF().getData().end(); ++it, ++handle)
+    {
+        auto [pk, write_type, ts, value] = data.readDataByWriteIt(it, true, &default_cursor);
+        ASSERT_EQ(static_cast<HandleID>(pk), handle);
+        ASSERT_EQ(write_type, Region::PutFlag);
+        ASSERT_EQ(ts, 2UL);
+        ASSERT_EQ(value->toString(), "value" + std::to_string(handle));
+    }
+    ASSERT_TRUE(default_cursor == data.defaultCF().getData().end());
+}
+
+TEST(TiKVKeyValueTest, SharePKOfRow)
+{
+    RegionData data;
+    // Two versions of the same row, the pk is kept once by the entries of both cfs
+    data.insert(ColumnFamilyType::Default, RecordKVFormat::genKey(1, 7, 1), TiKVValue("v1"));
+    data.insert(ColumnFamilyType::Write, RecordKVFormat::genKey(1, 7, 2), RecordKVFormat::encodeWriteCfValue(Region::PutFlag, 1));
+    auto hint = data.initInsertHint();
+    data.insert(ColumnFamilyType::Default, RecordKVFormat::genKey(1, 7, 3), TiKVValue("v2"), hint);
+    data.insert(ColumnFamilyType::Write, RecordKVFormat::genKey(1, 7, 4), RecordKVFormat::encodeWriteCfValue(Region::PutFlag, 3), hint);
+    // Another row
+    data.insert(ColumnFamilyType::Write, RecordKVFormat::genKey(1, 8, 4), RecordKVFormat::encodeWriteCfValue(Region::DelFlag, 3));
+
+    std::set<const std::string *> pks;
+    for (const auto & [key, value] : data.defaultCF().getData())
+        pks.insert(key.first.get());
+    for (const auto & [key, value] : data.writeCF().getData())
+        pks.insert(key.first.get());
+    ASSERT_EQ(data.defaultCF().getSize(), 2);
+    ASSERT_EQ(data.writeCF().getSize(), 3);
+    ASSERT_EQ(pks.size(), 2);
+
+    auto [pk, write_type, ts, value] = data.readDataByWriteIt(data.writeCF().getData().begin());
+    ASSERT_EQ(static_cast<HandleID>(pk), 7);
+    ASSERT_EQ(write_type, Region::PutFlag);
+    ASSERT_EQ(ts, 2UL);
+    ASSERT_EQ(value->toString(), "v1");
+}
+
 TEST(TiKVKeyValueTest, Redact)
 try
 {
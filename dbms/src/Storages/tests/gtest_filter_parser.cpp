@@ -64,12 +64,12 @@ protected:
     LoggerPtr log;
     Context ctx;
     static TimezoneInfo default_timezone_info;
-    DM::RSOperatorPtr generateRsOperator(String table_info_json, const String & query, TimezoneInfo & timezone_info);
+    DM::RSOperatorPtr generateRsOperator(String table_info_json, const String & query, TimezoneInfo & timezone_info, const String & dag_properties);
 };
 
 TimezoneInfo FilterParserTest::default_timezone_info;
 
-DM::RSOperatorPtr FilterParserTest::generateRsOperator(const String table_info_json, const String & query, TimezoneInfo & timezone_info = default_timezone_info)
+DM::RSOperatorPtr FilterParserTest::generateRsOperator(const String table_info_json, const String & query, TimezoneInfo & timezone_info = default_timezone_info, const String & dag_properties = "")
 {
     const TiDB::TableInfo table_info(table_info_json);
 
@@ -80,7 +80,7 @@ DM::RSOperatorPtr FilterParserTest::generateRsOperator(const String table_info_j
         [&](const String &, const String &) {
             return table_info;
         },
-        getDAGProperties(""));
+        getDAGProperties(dag_properties));
     auto & dag_request = *query_tasks[0].dag_request;
     DAGContext dag_context(dag_request);
     ctx.setDAGContext(&dag_context);
@@ -184,6 +184,16 @@ try
         EXPECT_EQ(rs_operator->getAttrs()[0].col_id, 2);
         EXPECT_EQ(rs_operator->toDebugString(), "{\"op\":\"less_equal\",\"col\":\"col_2\",\"value\":\"776\"}");
     }
+
+    {
+        // In between col and literals
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_2 in (666, 777)");
+        EXPECT_EQ(rs_operator->name(), "in");
+        EXPECT_EQ(rs_operator->getAttrs().size(), 1);
+        EXPECT_EQ(rs_operator->getAttrs()[0].col_name, "col_2");
+        EXPECT_EQ(rs_operator->getAttrs()[0].col_id, 2);
+        EXPECT_EQ(rs_operator->toDebugString(), "{\"op\":\"in\",\"col\":\"col_2\",\"value\":\"[\"666\",\"777\"]}");
+    }
 }
 CATCH
 
@@ -493,6 +503,160 @@ try
 }
 CATCH
 
+TEST_F(FilterParserTest, DecimalColumn)
+try
+{
+    const String table_info_json = R"json({
+    "cols":[
+        {"comment":"","default":null,"default_bit":null,"id":1,"name":{"L":"col_1","O":"col_1"},"offset":-1,"origin_default":null,"state":0,"type":{"Charset":null,"Collate":null,"Decimal":2,"Elems":null,"Flag":4097,"Flen":10,"Tp":246}}
+    ],
+    "pk_is_handle":false,"index_info":[],"is_common_handle":false,
+    "name":{"L":"t_111","O":"t_111"},"partition":null,
+    "comment":"Mocked.","id":30,"schema_version":-1,"state":0,"tiflash_replica":{"Count":0},"update_timestamp":1636471547239654
+})json";
+
+    {
+        // The new decimal column could be compared with the integer literals
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_1 > 1");
+        EXPECT_EQ(rs_operator->name(), "greater");
+        EXPECT_EQ(rs_operator->getAttrs().size(), 1);
+        EXPECT_EQ(rs_operator->getAttrs()[0].col_name, "col_1");
+    }
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_1 in (1, 2)");
+        EXPECT_EQ(rs_operator->name(), "in");
+    }
+}
+CATCH
+
+TEST_F(FilterParserTest, LikeExpr)
+try
+{
+    const String table_info_json = R"json({
+    "cols":[
+        {"comment":"","default":null,"default_bit":null,"id":1,"name":{"L":"col_1","O":"col_1"},"offset":-1,"origin_default":null,"state":0,"type":{"Charset":null,"Collate":null,"Decimal":0,"Elems":null,"Flag":4097,"Flen":0,"Tp":254}},
+        {"comment":"","default":null,"default_bit":null,"id":2,"name":{"L":"col_2","O":"col_2"},"offset":-1,"origin_default":null,"state":0,"type":{"Charset":null,"Collate":null,"Decimal":0,"Elems":null,"Flag":4097,"Flen":0,"Tp":8}}
+    ],
+    "pk_is_handle":false,"index_info":[],"is_common_handle":false,
+    "name":{"L":"t_111","O":"t_111"},"partition":null,
+    "comment":"Mocked.","id":30,"schema_version":-1,"state":0,"tiflash_replica":{"Count":0},"update_timestamp":1636471547239654
+})json";
+    // The binary collation
+    const String binary_collation = "collator:63";
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_1 like 'abc%'", default_timezone_info, binary_collation);
+        EXPECT_EQ(rs_operator->name(), "like");
+        EXPECT_EQ(rs_operator->getAttrs().size(), 1);
+        EXPECT_EQ(rs_operator->getAttrs()[0].col_name, "col_1");
+        EXPECT_EQ(rs_operator->toDebugString(), R"({"op":"like","col":"col_1","value":"'abc'"})");
+    }
+
+    {
+        // The escaped wildcard is a part of the prefix
+        auto rs_operator = generateRsOperator(table_info_json, R"(select * from default.t_111 where col_1 like 'a\\%b_c')", default_timezone_info, binary_collation);
+        EXPECT_EQ(rs_operator->name(), "like");
+        EXPECT_EQ(rs_operator->toDebugString(), R"({"op":"like","col":"col_1","value":"'a%b'"})");
+    }
+
+    {
+        // The pattern without wildcard is the same as equal
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_1 like 'abc'", default_timezone_info, binary_collation);
+        EXPECT_EQ(rs_operator->name(), "equal");
+    }
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where not col_1 like 'abc%'", default_timezone_info, binary_collation);
+        EXPECT_EQ(rs_operator->name(), "not");
+        EXPECT_EQ(rs_operator->getAttrs().size(), 1);
+    }
+
+    {
+        // No constant prefix
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_1 like '%abc'", default_timezone_info, binary_collation);
+        EXPECT_EQ(rs_operator->name(), "unsupported");
+    }
+
+    {
+        // The collation other than binary is not supported
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where col_1 like 'abc%'", default_timezone_info, "collator:46");
+        EXPECT_EQ(rs_operator->name(), "unsupported");
+    }
+}
+CATCH
+
+TEST_F(FilterParserTest, DateFunctionExpr)
+try
+{
+    const String table_info_json = R"json({
+    "cols":[
+        {"comment":"","default":null,"default_bit":null,"id":4,"name":{"L":"col_timestamp","O":"col_time"},"offset":-1,"origin_default":null,"state":0,"type":{"Charset":null,"Collate":null,"Decimal":5,"Elems":null,"Flag":1,"Flen":0,"Tp":7}},
+        {"comment":"","default":null,"default_bit":null,"id":5,"name":{"L":"col_datetime","O":"col_datetime"},"offset":-1,"origin_default":null,"state":0,"type":{"Charset":null,"Collate":null,"Decimal":5,"Elems":null,"Flag":1,"Flen":0,"Tp":12}},
+        {"comment":"","default":null,"default_bit":null,"id":6,"name":{"L":"col_date","O":"col_date"},"offset":-1,"origin_default":null,"state":0,"type":{"Charset":null,"Collate":null,"Decimal":5,"Elems":null,"Flag":1,"Flen":0,"Tp":14}}
+    ],
+    "pk_is_handle":false,"index_info":[],"is_common_handle":false,
+    "name":{"L":"t_111","O":"t_111"},"partition":null,
+    "comment":"Mocked.","id":30,"schema_version":-1,"state":0,"tiflash_replica":{"Count":0},"update_timestamp":1636471547239654
+})json";
+
+    const auto year_2022 = toString(MyDateTime(2022, 0, 0, 0, 0, 0, 0).toPackedUInt());
+    const auto year_2023 = toString(MyDateTime(2023, 0, 0, 0, 0, 0, 0).toPackedUInt());
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where year(col_datetime) = 2022");
+        EXPECT_EQ(rs_operator->name(), "and");
+        EXPECT_EQ(rs_operator->getAttrs().size(), 2);
+        EXPECT_EQ(rs_operator->getAttrs()[0].col_name, "col_datetime");
+        EXPECT_EQ(rs_operator->toDebugString(),
+                  R"({"op":"and","children":[{"op":"greater_equal","col":"col_datetime","value":")" + year_2022
+                      + R"("},{"op":"less","col":"col_datetime","value":")" + year_2023 + R"("}]})");
+    }
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where year(col_date) > 2022");
+        EXPECT_EQ(rs_operator->toDebugString(), R"({"op":"greater_equal","col":"col_date","value":")" + year_2023 + R"("})");
+    }
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where 2022 >= year(col_date)");
+        EXPECT_EQ(rs_operator->toDebugString(), R"({"op":"less","col":"col_date","value":")" + year_2023 + R"("})");
+    }
+
+    {
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where year(col_datetime) != 2022");
+        EXPECT_EQ(rs_operator->name(), "not");
+    }
+
+    {
+        String date = "2022-01-31";
+        ReadBufferFromMemory read_buffer(date.c_str(), date.size());
+        UInt64 packed_date;
+        tryReadMyDateTimeText(packed_date, 6, read_buffer);
+        // The upper bound is the zero day of the next month
+        const auto upper = toString(MyDateTime(2022, 2, 0, 0, 0, 0, 0).toPackedUInt());
+
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where date(col_datetime) <= cast_string_datetime('" + date + "')");
+        EXPECT_EQ(rs_operator->toDebugString(), R"({"op":"less","col":"col_datetime","value":")" + upper + R"("})");
+
+        rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where date(col_datetime) >= cast_string_datetime('" + date + "')");
+        EXPECT_EQ(rs_operator->toDebugString(), R"({"op":"greater_equal","col":"col_datetime","value":")" + toString(packed_date) + R"("})");
+    }
+
+    {
+        // The literal with time part is never equal to the result of date
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where date(col_datetime) = cast_string_datetime('2022-01-31 10:00:00')");
+        EXPECT_EQ(rs_operator->name(), "unsupported");
+    }
+
+    {
+        // The result of function on timestamp column depends on the time_zone
+        auto rs_operator = generateRsOperator(table_info_json, "select * from default.t_111 where year(col_timestamp) = 2022");
+        EXPECT_EQ(rs_operator->name(), "unsupported");
+    }
+}
+CATCH
+
 // Test cases for not satisfy `column` `op` `literal`
 TEST_F(FilterParserTest, ComplicatedFilters)
 try
@@ -519,6 +683,7 @@ try
              "select * from default.t_111 where round_int(col_2) < 1",
              "select * from default.t_111 where bitand(col_2, 1) = col_5",
              "select * from default.t_111 where bitor(bitand(col_2, 1), col_2) > col_5",
+             "select * from default.t_111 where col_2 in (666, col_5)",
          })
     {
         auto rs_operator = generateRsOperator(table_info_json, test_case);
@@ -196,6 +196,52 @@ try
 }
 CATCH
 
+TEST_F(PathPoolTest, StableFastPaths)
+try
+{
+    Strings paths = getMultiTestPaths();
+    Strings main_paths(paths.begin(), paths.begin() + 3);
+    // The first latest path is also a main path, so it is not a fast path.
+    Strings latest_paths(paths.begin() + 2, paths.end());
+    auto ctx = TiFlashTestEnv::getContext();
+
+    PathPool pool(main_paths, latest_paths, Strings{}, ctx.getPathCapacity(), ctx.getFileProvider());
+    auto spool = pool.withTable("test", "t", false);
+    auto delegate = spool.getStableDiskDelegator();
+    ASSERT_TRUE(delegate.hasFastPaths());
+
+    auto res = delegate.listPaths();
+    ASSERT_EQ(res.size(), paths.size());
+    for (size_t i = 0; i < res.size(); ++i)
+        EXPECT_EQ(res[i], paths[i] + DIR_PREFIX_OF_TABLE + StoragePathPool::STABLE_FOLDER_NAME);
+    Strings main_res(res.begin(), res.begin() + 3);
+    Strings fast_res(res.begin() + 3, res.end());
+
+    for (size_t i = 0; i < TEST_NUMBER_FOR_CHOOSE; ++i)
+    {
+        bool on_fast_path = i % 2 == 0;
+        auto chosen = delegate.choosePath(on_fast_path);
+        const auto & expected_res = on_fast_path ? fast_res : main_res;
+        ASSERT_NE(std::find(expected_res.begin(), expected_res.end(), chosen), expected_res.end()) << chosen;
+        delegate.addDTFile(i, 200, chosen);
+        ASSERT_EQ(delegate.getDTFilePath(i), chosen);
+        ASSERT_EQ(delegate.isOnFastPath(i), on_fast_path);
+    }
+
+    for (size_t i = 0; i < TEST_NUMBER_FOR_CHOOSE; ++i)
+        delegate.removeDTFile(i);
+    ASSERT_FALSE(delegate.isOnFastPath(0));
+
+    // No fast path if all the latest paths are main paths.
+    PathPool aligned_pool(paths, paths, Strings{}, ctx.getPathCapacity(), ctx.getFileProvider());
+    auto aligned_spool = aligned_pool.withTable("test", "t", false);
+    auto aligned_delegate = aligned_spool.getStableDiskDelegator();
+    ASSERT_FALSE(aligned_delegate.hasFastPaths());
+    auto chosen = aligned_delegate.choosePath(true);
+    ASSERT_NE(std::find(res.begin(), res.end(), chosen), res.end());
+}
+CATCH
+
 TEST_F(PathPoolTest, UnalignPaths)
 try
 {
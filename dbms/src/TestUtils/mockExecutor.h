@@ -197,6 +197,7 @@ MockWindowFrame buildDefaultRowsFrame();
 #define Min(expr) makeASTFunction("min", (expr))
 #define Count(expr) makeASTFunction("count", (expr))
 #define Sum(expr) makeASTFunction("sum", (expr))
+#define Avg(expr) makeASTFunction("avg", (expr))
 
 /// Window functions
 #define RowNumber() makeASTFunction("RowNumber")
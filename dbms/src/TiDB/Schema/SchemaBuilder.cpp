@@ -14,6 +14,7 @@
 
 #include <Common/FailPoint.h>
 #include <Common/FmtUtils.h>
+#include <Common/Stopwatch.h>
 #include <Common/TiFlashException.h>
 #include <Common/TiFlashMetrics.h>
 #include <Common/setThreadName.h>
@@ -43,6 +44,8 @@
 #include <TiDB/Schema/SchemaNameMapper.h>
 #include <common/logger_useful.h>
 
+#include <common/ThreadPool.h>
+
 #include <boost/algorithm/string/join.hpp>
 #include <tuple>
 
@@ -1334,6 +1337,29 @@ void SchemaBuilder<Getter, NameMapper>::applySetTiFlashModeOnPhysicalTable(
 }
 
 
+template <typename Getter, typename NameMapper>
+std::vector<std::vector<TableInfoPtr>> SchemaBuilder<Getter, NameMapper>::fetchTablesOfDBs(const std::vector<DBInfoPtr> & dbs)
+{
+    std::vector<std::vector<TableInfoPtr>> tables_of_dbs(dbs.size());
+    size_t concurrency = std::min(static_cast<size_t>(context.getSettingsRef().schema_sync_fetch_concurrency), dbs.size());
+    if (concurrency <= 1)
+    {
+        for (size_t i = 0; i < dbs.size(); ++i)
+            tables_of_dbs[i] = getter.listTables(dbs[i]->id);
+        return tables_of_dbs;
+    }
+
+    // Fetching and parsing the table infos is the most time-consuming part of syncing all schemas
+    // for the clusters with many tables, and it is independent among databases.
+    ::ThreadPool pool(concurrency, [] { setThreadName("SchemaFetcher"); });
+    for (size_t i = 0; i < dbs.size(); ++i)
+    {
+        pool.schedule([&, i] { tables_of_dbs[i] = getter.listTables(dbs[i]->id); });
+    }
+    pool.wait();
+    return tables_of_dbs;
+}
+
 template <typename Getter, typename NameMapper>
 void SchemaBuilder<Getter, NameMapper>::syncAllSchema()
 {
@@ -1355,11 +1381,14 @@ void SchemaBuilder<Getter, NameMapper>::syncAllSchema()
     }
 
     /// Load all tables in each database.
+    Stopwatch watch;
+    auto tables_of_dbs = fetchTablesOfDBs(all_schemas);
+    LOG_FMT_INFO(log, "Fetched the tables of {} databases during sync all schemas, cost {} ms", all_schemas.size(), watch.elapsedMilliseconds());
     std::unordered_set<TableID> table_set;
-    for (const auto & db : all_schemas)
+    for (size_t db_index = 0; db_index < all_schemas.size(); ++db_index)
     {
-        std::vector<TableInfoPtr> tables = getter.listTables(db->id);
-        for (auto & table : tables)
+        const auto & db = all_schemas[db_index];
+        for (auto & table : tables_of_dbs[db_index])
         {
             LOG_FMT_DEBUG(log, "Table {} syncing during sync all schemas", name_mapper.debugCanonicalName(*db, *table));
 
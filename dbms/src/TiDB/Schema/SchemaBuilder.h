@@ -48,6 +48,9 @@ struct SchemaBuilder
     void syncAllSchema();
 
 private:
+    /// Fetch the tables of `dbs` concurrently by `schema_sync_fetch_concurrency` threads, the result is in the order of `dbs`.
+    std::vector<std::vector<TiDB::TableInfoPtr>> fetchTablesOfDBs(const std::vector<TiDB::DBInfoPtr> & dbs);
+
     void applyDropSchema(DatabaseID schema_id);
 
     /// Parameter db_name should be mapped.
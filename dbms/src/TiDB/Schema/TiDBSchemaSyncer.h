@@ -19,7 +19,9 @@
 #include <Debug/MockSchemaGetter.h>
 #include <Debug/MockSchemaNameMapper.h>
 #include <Storages/Transaction/TiDB.h>
+#include <Common/setThreadName.h>
 #include <TiDB/Schema/SchemaBuilder.h>
+#include <common/ThreadPool.h>
 #include <pingcap/kv/Cluster.h>
 #include <pingcap/kv/Snapshot.h>
 
@@ -172,12 +174,22 @@ struct TiDBSchemaSyncer : public SchemaSyncer
         Int64 used_version = cur_version;
         // First get all schema diff from `cur_version` to `latest_version`. Only apply the schema diff(s) if we fetch all
         // schema diff without any exception.
-        std::vector<std::optional<SchemaDiff>> diffs;
-        while (used_version < latest_version)
+        std::vector<std::optional<SchemaDiff>> diffs(latest_version - cur_version);
+        size_t concurrency = std::min(static_cast<size_t>(context.getSettingsRef().schema_sync_fetch_concurrency), diffs.size());
+        if (concurrency <= 1)
         {
-            used_version++;
-            diffs.push_back(getter.getSchemaDiff(used_version));
+            for (size_t i = 0; i < diffs.size(); ++i)
+                diffs[i] = getter.getSchemaDiff(cur_version + i + 1);
         }
+        else
+        {
+            // The schema diffs are independent of each other, fetch them concurrently to reduce the round trips.
+            ::ThreadPool pool(concurrency, [] { setThreadName("SchemaFetcher"); });
+            for (size_t i = 0; i < diffs.size(); ++i)
+                pool.schedule([&, i] { diffs[i] = getter.getSchemaDiff(cur_version + i + 1); });
+            pool.wait();
+        }
+        used_version = latest_version;
         LOG_FMT_DEBUG(log, "End load schema diffs with total {} entries.", diffs.size());
 
         try
@@ -0,0 +1,159 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <Common/Exception.h>
+#include <DataStreams/WindowBlockInputStream.h>
+#include <WindowFunctions/WindowFunctionAggregate.h>
+#include <ext/scope_guard.h>
+
+namespace DB
+{
+namespace ErrorCodes
+{
+extern const int LOGICAL_ERROR;
+} // namespace ErrorCodes
+
+namespace
+{
+/// The arena of the merged results is renewed when it is larger than this.
+constexpr size_t max_result_arena_bytes = 1024 * 1024;
+} // namespace
+
+SlidingWindowAggregation::SlidingWindowAggregation(const AggregateFunctionPtr & function_, bool removable_)
+    : function(function_)
+    , removable(removable_)
+    , front_arena(std::make_unique<Arena>())
+    , back_arena(std::make_unique<Arena>())
+    , result_arena(std::make_unique<Arena>())
+{}
+
+SlidingWindowAggregation::~SlidingWindowAggregation()
+{
+    for (size_t i = front_pos; i < front_states.size(); ++i)
+        function->destroy(front_states[i]);
+    if (back_state)
+        function->destroy(back_state);
+}
+
+AggregateDataPtr SlidingWindowAggregation::createState(Arena & arena)
+{
+    AggregateDataPtr place = arena.alignedAlloc(function->sizeOfData(), function->alignOfData());
+    function->create(place);
+    return place;
+}
+
+void SlidingWindowAggregation::add(const IColumn ** columns, size_t row)
+{
+    if (!back_state)
+        back_state = createState(*back_arena);
+    function->add(back_state, columns, row, back_arena.get());
+    if (removable)
+        back_rows.emplace_back(columns, row);
+    ++back_rows_count;
+}
+
+void SlidingWindowAggregation::remove()
+{
+    if (front_pos == front_states.size())
+        flip();
+    function->destroy(front_states[front_pos]);
+    ++front_pos;
+}
+
+void SlidingWindowAggregation::flip()
+{
+    if (unlikely(!removable || back_rows.empty()))
+        throw Exception("No row to remove from the window aggregation", ErrorCodes::LOGICAL_ERROR);
+
+    destroyFront();
+    const size_t rows = back_rows.size();
+    front_states.resize(rows);
+    /// The states in [front_pos, rows) are created, so that they can be destroyed on exceptions.
+    front_pos = rows;
+    for (size_t i = rows; i > 0; --i)
+    {
+        AggregateDataPtr place = createState(*front_arena);
+        front_states[i - 1] = place;
+        front_pos = i - 1;
+        if (i < rows)
+            function->merge(place, front_states[i], front_arena.get());
+        function->add(place, back_rows[i - 1].first, back_rows[i - 1].second, front_arena.get());
+    }
+    resetBack();
+}
+
+void SlidingWindowAggregation::destroyFront()
+{
+    for (size_t i = front_pos; i < front_states.size(); ++i)
+        function->destroy(front_states[i]);
+    front_states.clear();
+    front_pos = 0;
+    front_arena = std::make_unique<Arena>();
+}
+
+void SlidingWindowAggregation::resetBack()
+{
+    if (back_state)
+    {
+        function->destroy(back_state);
+        back_state = nullptr;
+    }
+    back_rows.clear();
+    back_rows_count = 0;
+    back_arena = std::make_unique<Arena>();
+}
+
+void SlidingWindowAggregation::reset()
+{
+    if (front_states.empty() && !back_state)
+        return;
+    destroyFront();
+    resetBack();
+}
+
+void SlidingWindowAggregation::insertResultInto(IColumn & to)
+{
+    const bool has_front = front_pos < front_states.size();
+    if (!has_front && back_state)
+    {
+        function->insertResultInto(back_state, to, back_arena.get());
+        return;
+    }
+    if (has_front && !back_state)
+    {
+        function->insertResultInto(front_states[front_pos], to, front_arena.get());
+        return;
+    }
+
+    /// Either the frame is empty, or both the front and the back have rows.
+    if (result_arena->size() > max_result_arena_bytes)
+        result_arena = std::make_unique<Arena>();
+    AggregateDataPtr place = createState(*result_arena);
+    SCOPE_EXIT({ function->destroy(place); });
+    if (has_front)
+    {
+        function->merge(place, front_states[front_pos], result_arena.get());
+        function->merge(place, back_state, result_arena.get());
+    }
+    function->insertResultInto(place, to, result_arena.get());
+}
+
+void WindowFunctionAggregate::windowInsertResultInto(WindowBlockInputStreamPtr stream, size_t function_index)
+{
+    IColumn & to = *stream->blockAt(stream->current_row).output_columns[function_index];
+    stream->workspaces[function_index].aggregation->insertResultInto(to);
+}
+
+} // namespace DB
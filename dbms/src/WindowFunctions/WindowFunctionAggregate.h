@@ -0,0 +1,99 @@
+// Copyright 2022 PingCAP, Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <AggregateFunctions/IAggregateFunction.h>
+#include <Common/Arena.h>
+#include <WindowFunctions/IWindowFunction.h>
+
+#include <vector>
+
+namespace DB
+{
+/** The aggregation over a frame that slides forward: rows are added at the frame end and
+  * removed at the frame start, both in order. Only `add` and `merge` of the aggregate function
+  * are used, so any aggregate function whose result does not depend on the order of the rows works.
+  *
+  * It is a queue of two stacks. The added rows are aggregated into one state (the back). When a row
+  * has to be removed and the front is empty, the rows of the back are turned into the suffix states
+  * of the front, so every row is merged once more at most, and the result is the front top merged
+  * with the back. If the frame start never moves, the result is simply the back state.
+  */
+class SlidingWindowAggregation : private boost::noncopyable
+{
+public:
+    /// `removable` is false when the frame start is UNBOUNDED PRECEDING, no row needs to be kept then.
+    SlidingWindowAggregation(const AggregateFunctionPtr & function_, bool removable_);
+
+    ~SlidingWindowAggregation();
+
+    /// `columns` must be alive until the row is removed.
+    void add(const IColumn ** columns, size_t row);
+
+    /// Remove the earliest added row.
+    void remove();
+
+    /// Remove all the rows, for a new partition.
+    void reset();
+
+    size_t size() const { return front_states.size() - front_pos + back_rows_count; }
+
+    void insertResultInto(IColumn & to);
+
+private:
+    AggregateDataPtr createState(Arena & arena);
+    void destroyFront();
+    void resetBack();
+    /// Turn the back rows into the suffix states of the front.
+    void flip();
+
+    AggregateFunctionPtr function;
+    const bool removable;
+
+    /// The suffix states, front_states[i] aggregates the rows from i to the end of the front.
+    std::vector<AggregateDataPtr> front_states;
+    size_t front_pos = 0;
+    std::unique_ptr<Arena> front_arena;
+
+    AggregateDataPtr back_state = nullptr;
+    std::vector<std::pair<const IColumn **, size_t>> back_rows;
+    size_t back_rows_count = 0;
+    std::unique_ptr<Arena> back_arena;
+
+    /// For the results that merge the front and the back.
+    std::unique_ptr<Arena> result_arena;
+};
+
+/// An aggregate function used as a window function, the frame is aggregated by `SlidingWindowAggregation`.
+class WindowFunctionAggregate final : public IWindowFunction
+{
+public:
+    WindowFunctionAggregate(const std::string & name_, const DataTypes & argument_types_, const AggregateFunctionPtr & aggregate_function_)
+        : IWindowFunction(name_, argument_types_)
+        , aggregate_function(aggregate_function_)
+    {}
+
+    DataTypePtr getReturnType() const override { return aggregate_function->getReturnType(); }
+
+    void windowInsertResultInto(WindowBlockInputStreamPtr stream, size_t function_index) override;
+
+    const AggregateFunctionPtr & getAggregateFunction() const { return aggregate_function; }
+
+private:
+    AggregateFunctionPtr aggregate_function;
+};
+
+} // namespace DB
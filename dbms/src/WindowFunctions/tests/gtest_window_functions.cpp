@@ -188,4 +188,76 @@ try
 }
 CATCH
 
+TEST_F(WindowExecutorTestRunner, testAggregateFunctionsOverFrames)
+try
+{
+    const ColumnsWithTypeAndName input_columns{
+        toNullableVec<Int64>("partition", {1, 1, 1, 1, 2, 2, 2, 2}),
+        toNullableVec<Int64>("order", {1, 1, 2, 2, 1, 1, 2, 2})};
+    auto with_result = [&](const ColumnWithTypeAndName & result) {
+        auto columns = input_columns;
+        columns.push_back(result);
+        return columns;
+    };
+
+    // select *, sum(order) over (partition by partition order by order rows between 1 preceding and 1 following) from test_table;
+    MockWindowFrame sliding_frame{tipb::WindowFrameType::Rows, std::make_tuple(tipb::WindowBoundType::Preceding, false, 1), std::make_tuple(tipb::WindowBoundType::Following, false, 1)};
+    auto request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window(Sum(col("order")), {"order", false}, {"partition", false}, sliding_frame).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request), with_result(toNullableVec<Int64>("sum", {2, 4, 5, 4, 2, 4, 5, 4})));
+
+    // rows between 2 preceding and 1 preceding, the frame of the first row is empty.
+    MockWindowFrame preceding_frame{tipb::WindowFrameType::Rows, std::make_tuple(tipb::WindowBoundType::Preceding, false, 2), std::make_tuple(tipb::WindowBoundType::Preceding, false, 1)};
+    request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window(Sum(col("order")), {"order", false}, {"partition", false}, preceding_frame).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request), with_result(toNullableVec<Int64>("sum", {{}, 1, 2, 3, {}, 1, 2, 3})));
+    request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window(Count(col("order")), {"order", false}, {"partition", false}, preceding_frame).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request), with_result(toNullableVec<Int64>("count", {0, 1, 2, 2, 0, 1, 2, 2})));
+
+    // rows between unbounded preceding and current row
+    MockWindowFrame running_frame{tipb::WindowFrameType::Rows, std::make_tuple(tipb::WindowBoundType::Preceding, true, 0), std::make_tuple(tipb::WindowBoundType::CurrentRow, false, 0)};
+    request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window(Sum(col("order")), {"order", false}, {"partition", false}, running_frame).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request), with_result(toNullableVec<Int64>("sum", {1, 2, 4, 6, 1, 2, 4, 6})));
+
+    // rows between current row and 1 following
+    MockWindowFrame following_frame{tipb::WindowFrameType::Rows, std::make_tuple(tipb::WindowBoundType::CurrentRow, false, 0), std::make_tuple(tipb::WindowBoundType::Following, false, 1)};
+    request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window(Avg(col("order")), {"order", false}, {"partition", false}, following_frame).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request), with_result(toNullableVec<Float64>("avg", {1.0, 1.5, 2.0, 2.0, 1.0, 1.5, 2.0, 2.0})));
+
+    // The default frame is range between unbounded preceding and current row, the peers are in the same frame.
+    request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window({Sum(col("order")), Count(col("order")), Max(col("order")), Min(col("order"))}, {{"order", false}}, {{"partition", false}}, MockWindowFrame{}).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request),
+                        createColumns({toNullableVec<Int64>("partition", {1, 1, 1, 1, 2, 2, 2, 2}),
+                                       toNullableVec<Int64>("order", {1, 1, 2, 2, 1, 1, 2, 2}),
+                                       toNullableVec<Int64>("sum", {2, 2, 6, 6, 2, 2, 6, 6}),
+                                       toNullableVec<Int64>("count", {2, 2, 4, 4, 2, 2, 4, 4}),
+                                       toNullableVec<Int64>("max", {1, 1, 2, 2, 1, 1, 2, 2}),
+                                       toNullableVec<Int64>("min", {1, 1, 1, 1, 1, 1, 1, 1})}));
+
+    // range between current row and unbounded following
+    MockWindowFrame range_frame{tipb::WindowFrameType::Ranges, std::make_tuple(tipb::WindowBoundType::CurrentRow, false, 0), std::make_tuple(tipb::WindowBoundType::Following, true, 0)};
+    request = context.scan("test_db", "test_table").sort({{"partition", false}, {"order", false}}, true).window(Sum(col("order")), {"order", false}, {"partition", false}, range_frame).build(context);
+    ASSERT_COLUMNS_EQ_R(executeStreams(request), with_result(toNullableVec<Int64>("sum", {6, 6, 4, 4, 6, 6, 4, 4})));
+}
+CATCH
+
+TEST_F(WindowExecutorTestRunner, testWindowLocalShuffle)
+try
+{
+    context.context.setSetting("enable_window_local_shuffle", Field(static_cast<UInt64>(1)));
+    auto request = context
+                       .scan("test_db", "test_table_more_cols")
+                       .sort({{"partition1", false}, {"partition2", false}, {"order1", false}, {"order2", false}}, true)
+                       .window(RowNumber(), {{"order1", false}, {"order2", false}}, {{"partition1", false}, {"partition2", false}}, buildDefaultRowsFrame())
+                       .build(context);
+    // The partitions are output by different streams, so only the rows are compared.
+    const auto expected = createColumns({toNullableVec<Int64>("partition1", {1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2}),
+                                         toNullableVec<Int64>("partition2", {1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2}),
+                                         toNullableVec<Int64>("order1", {1, 1, 2, 1, 1, 2, 1, 1, 2, 1, 1, 2}),
+                                         toNullableVec<Int64>("order2", {1, 2, 2, 1, 2, 2, 1, 2, 2, 1, 2, 2}),
+                                         toNullableVec<Int64>("row_number", {1, 2, 3, 1, 2, 3, 1, 2, 3, 1, 2, 3})});
+    for (size_t concurrency : {1, 2, 4})
+        ASSERT_COLUMNS_EQ_UR(expected, executeStreams(request, concurrency));
+    context.context.setSetting("enable_window_local_shuffle", Field(static_cast<UInt64>(0)));
+}
+CATCH
+
 } // namespace DB::tests